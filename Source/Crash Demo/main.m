@@ -31,9 +31,51 @@
 
 #import <sys/types.h>
 #import <sys/sysctl.h>
+#import <dirent.h>
+#import <dlfcn.h>
+#import <pthread.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <mach-o/dyld.h>
+
+/*
+ * Crash latency measurement.
+ *
+ * If the -crashType argument is supplied, the demo measures the time from the fault to the completion of the
+ * on-disk crash report (as signaled by the post-crash callback) and prints the result to stdout:
+ *
+ *   -crashType segv|bus|exception|overflow  The fault to trigger (required).
+ *   -handlerType bsd|mach                   The signal handler type (default: mach).
+ *   -threads N                              The number of additional idle threads to run (default: 0).
+ *   -images N                               The number of additional system frameworks to load (default: 0).
+ *
+ * See Tools/crash-latency.sh.
+ */
+
+/** The mach_absolute_time() at which the fault was triggered, or 0 if latency is not being measured. */
+static volatile uint64_t fault_time = 0;
+
+/** The latency measurement description, written alongside the measured latency. Populated prior to enabling the
+ * crash reporter. */
+static char latency_desc[256];
 
 /* A custom post-crash callback */
 void post_crash_callback (siginfo_t *info, ucontext_t *uap, void *context) {
+    /* The report has been written; note the latency */
+    if (fault_time != 0) {
+        uint64_t elapsed = mach_absolute_time() - fault_time;
+        mach_timebase_info_data_t timebase;
+        char line[384];
+
+        // this is not async-safe, but this is a test implementation
+        mach_timebase_info(&timebase);
+        int len = snprintf(line, sizeof(line), "%s signo=%d latency_ns=%llu\n", latency_desc, info->si_signo,
+                           (unsigned long long) (elapsed * timebase.numer / timebase.denom));
+        if (len > 0)
+            write(STDOUT_FILENO, line, MIN((size_t) len, sizeof(line) - 1));
+        return;
+    }
+
     // this is not async-safe, but this is a test implementation
     NSLog(@"post crash callback: signo=%d, uap=%p, context=%p", info->si_signo, uap, context);
 }
@@ -44,6 +86,99 @@ void stackFrame (void) {
     ((char *)NULL)[1] = 0;
 }
 
+/* Recurse until the stack is exhausted. The fault time is refreshed as the stack grows, bounding the measurement
+ * error to the time required to push a few hundred frames. */
+static int overflow_stack (int depth) {
+    volatile char frame[128];
+
+    frame[0] = (char) depth;
+    if ((depth % 256) == 0)
+        fault_time = mach_absolute_time();
+
+    return overflow_stack(depth + 1) + frame[0];
+}
+
+/* Idle thread entry point; recurses to a fixed depth, so that the reporter has a non-trivial stack to walk, and then
+ * blocks indefinitely. */
+static void *idle_thread (void *arg) {
+    intptr_t depth = (intptr_t) arg;
+
+    if (depth > 0)
+        return idle_thread((void *) (depth - 1));
+
+    while (true)
+        pause();
+
+    return NULL;
+}
+
+/* Start @a count idle threads. */
+static void spawn_idle_threads (NSUInteger count) {
+    for (NSUInteger i = 0; i < count; i++) {
+        pthread_t thr;
+        if (pthread_create(&thr, NULL, idle_thread, (void *) (intptr_t) 32) != 0) {
+            NSLog(@"Failed to create idle thread: %s", strerror(errno));
+            return;
+        }
+        pthread_detach(thr);
+    }
+}
+
+/* Load up to @a count additional system frameworks. */
+static void load_images (NSUInteger count) {
+    const char *frameworks = "/System/Library/Frameworks";
+    DIR *dir = opendir(frameworks);
+    struct dirent *ent;
+    NSUInteger loaded = 0;
+
+    if (dir == NULL) {
+        NSLog(@"Could not open %s: %s", frameworks, strerror(errno));
+        return;
+    }
+
+    while (loaded < count && (ent = readdir(dir)) != NULL) {
+        char path[PATH_MAX];
+        size_t namelen = strlen(ent->d_name);
+        const char *suffix = ".framework";
+
+        if (namelen <= strlen(suffix) || strcmp(ent->d_name + namelen - strlen(suffix), suffix) != 0)
+            continue;
+
+        snprintf(path, sizeof(path), "%s/%s/%.*s", frameworks, ent->d_name, (int) (namelen - strlen(suffix)), ent->d_name);
+        if (dlopen(path, RTLD_NOW) != NULL)
+            loaded++;
+    }
+
+    closedir(dir);
+}
+
+/* Trigger the named fault, recording the fault time. Returns only if the crash type is unknown. */
+static void trigger_crash (NSString *crashType) {
+    if ([crashType isEqualToString: @"segv"]) {
+        fault_time = mach_absolute_time();
+        stackFrame();
+    } else if ([crashType isEqualToString: @"bus"]) {
+        /* An access to mapped, but inaccessible memory; reported as EXC_BAD_ACCESS/KERN_PROTECTION_FAILURE */
+        vm_address_t page = 0;
+        if (vm_allocate(mach_task_self(), &page, vm_page_size, VM_FLAGS_ANYWHERE) != KERN_SUCCESS ||
+            vm_protect(mach_task_self(), page, vm_page_size, false, VM_PROT_NONE) != KERN_SUCCESS)
+        {
+            NSLog(@"Failed to allocate a protected page");
+            return;
+        }
+
+        fault_time = mach_absolute_time();
+        *(volatile char *) page = 0;
+    } else if ([crashType isEqualToString: @"exception"]) {
+        fault_time = mach_absolute_time();
+        [NSException raise: @"PLCrashDemoException" format: @"Uncaught exception"];
+    } else if ([crashType isEqualToString: @"overflow"]) {
+        overflow_stack(1);
+    }
+
+    NSLog(@"Unknown crash type: %@", crashType);
+}
+
 /* If a crash report exists, make it accessible via iTunes document sharing. This is a no-op on Mac OS X. */
 static void save_crash_report (PLCrashReporter *reporter) {
     if (![reporter hasPendingCrashReports]) 
@@ -127,14 +262,33 @@ int main (int argc, char *argv[]) {
         NSLog(@"The demo crash app should be run without a debugger present. Exiting ...");
         return 0;
     }
+
+    /* Parse any latency measurement arguments */
+    NSUserDefaults *args = [NSUserDefaults standardUserDefaults];
+    NSString *crashType = [args stringForKey: @"crashType"];
+    PLCrashReporterSignalHandlerType handlerType = PLCrashReporterSignalHandlerTypeMach;
+    if ([[args stringForKey: @"handlerType"] isEqualToString: @"bsd"])
+        handlerType = PLCrashReporterSignalHandlerTypeBSD;
+
+    if (crashType != nil) {
+        spawn_idle_threads((NSUInteger) MAX(0, [args integerForKey: @"threads"]));
+        load_images((NSUInteger) MAX(0, [args integerForKey: @"images"]));
+
+        snprintf(latency_desc, sizeof(latency_desc), "crash=%s handler=%s threads=%ld images=%u", [crashType UTF8String],
+                 handlerType == PLCrashReporterSignalHandlerTypeBSD ? "bsd" : "mach",
+                 (long) MAX(0, [args integerForKey: @"threads"]), _dyld_image_count());
+    }
     
     /* Configure our reporter */
-    PLCrashReporterConfig *config = [[[PLCrashReporterConfig alloc] initWithSignalHandlerType: PLCrashReporterSignalHandlerTypeMach
+    PLCrashReporterConfig *config = [[[PLCrashReporterConfig alloc] initWithSignalHandlerType: handlerType
                                                                         symbolicationStrategy: PLCrashReporterSymbolicationStrategyAll] autorelease];
     PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: config] autorelease];
 
-    /* Save any existing crash report. */
-    save_crash_report(reporter);
+    /* Save any existing crash report; when measuring latency, each run starts without a pending report. */
+    if (crashType != nil)
+        [reporter purgePendingCrashReports];
+    else
+        save_crash_report(reporter);
     
     /* Set up post-crash callbacks */
     PLCrashReporterCallbacks cb = {
@@ -149,8 +303,11 @@ int main (int argc, char *argv[]) {
         NSLog(@"Could not enable crash reporter: %@", error);
     }
 
-    /* Add another stack frame */
-    stackFrame();
+    /* Trigger the requested crash, or add another stack frame */
+    if (crashType != nil)
+        trigger_crash(crashType);
+    else
+        stackFrame();
 
     [pool release];
 }
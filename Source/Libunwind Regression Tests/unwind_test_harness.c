@@ -26,6 +26,8 @@
 #include <inttypes.h>
 
 #include <mach-o/dyld.h>
+#include <mach/mach_time.h>
+#include <libunwind.h>
 
 #include "PLCrashFrameWalker.h"
 
@@ -141,6 +143,56 @@ static struct unwind_test_case unwind_test_cases[] = {
 };
 
 
+/* The test shapes used by unwind_test_harness_compare() */
+struct unwind_test_shape {
+    /** The shape name */
+    const char *name;
+
+    /** A list of targetable test cases */
+    void *test_list;
+};
+
+static struct unwind_test_shape unwind_test_shapes[] = {
+#ifdef __x86_64__
+    { "disable_compact_frame",  unwind_tester_list_x86_64_disable_compact_frame },
+    { "frame",                  unwind_tester_list_x86_64_frame },
+    { "frameless",              unwind_tester_list_x86_64_frameless },
+    { "frameless_big",          unwind_tester_list_x86_64_frameless_big },
+    { "unusual",                unwind_tester_list_x86_64_unusual },
+#elif defined(__i386__)
+    { "disable_compact_frame",  unwind_tester_list_x86_disable_compact_frame },
+    { "frame",                  unwind_tester_list_x86_frame },
+    { "frameless",              unwind_tester_list_x86_frameless },
+    { "frameless_big",          unwind_tester_list_x86_frameless_big },
+    { "unusual",                unwind_tester_list_x86_unusual },
+#endif
+    { NULL, NULL }
+};
+
+/** The maximum number of unw_step() calls made while searching for the unwind_tester() frame. */
+#define UNWIND_TEST_LIBUNWIND_MAX_STEPS 16
+
+/* Comparison state used by unwind_test_harness_compare() */
+struct unwind_test_compare_state {
+    /** The unwinder being measured */
+    unwind_test_unwinder_t unwinder;
+
+    /** The number of unwinds to perform for each test case */
+    uint32_t iterations;
+
+    /** The images loaded in the current process */
+    plcrash_async_image_list_t *image_list;
+
+    /** The section cache shared across all unwinds */
+    plcrash_async_macho_section_cache_t *section_cache;
+
+    /** The stack pointer value that should be restored. This is populated by the unwind_tester() */
+    void *expected_sp;
+
+    /** The results for the current shape; elapsed_ns is accumulated in mach absolute time units */
+    unwind_test_comparison_t result;
+};
+
 /*
  * We abuse global state to pass configuration down to the test result handling
  * without having to modify all of Apple's test cases. This means the tests
@@ -149,6 +201,9 @@ static struct unwind_test_case unwind_test_cases[] = {
 struct  {
     /** The current test case */
     struct unwind_test_case *test_case;
+
+    /** The current comparison state, or NULL if the regression tests are being run */
+    struct unwind_test_compare_state *compare;
 } global_harness_state;
 
 /*
@@ -179,7 +234,246 @@ bool unwind_test_harness (void) {
     } \
 } while (0)
 
+/* Non-trapping equivalent of VERIFY_NV_REG() */
+static bool unwind_test_check_reg (plframe_cursor_t *cursor, plcrash_regnum_t rnum, plcrash_greg_t value) {
+    plcrash_greg_t reg;
+    if (plframe_cursor_get_reg(cursor, rnum, &reg) != PLFRAME_ESUCCESS)
+        return false;
+
+    return reg == value;
+}
+
+/* Non-trapping equivalent of VERIFY_NV_REG() for libunwind cursors */
+static bool unwind_test_check_unw_reg (unw_cursor_t *cursor, unw_regnum_t rnum, unw_word_t value) {
+    unw_word_t reg;
+    if (unw_get_reg(cursor, rnum, &reg) != 0)
+        return false;
+
+    return reg == value;
+}
+
+/*
+ * Unwind from @a state through the current test function using the comparison's plframe_cursor readers, adding the
+ * time spent unwinding the test function's frame to @a elapsed. Returns true if the expected state was recovered.
+ */
+static bool unwind_test_compare_plframe (struct unwind_test_compare_state *cs, plcrash_async_thread_state_t *state, uint64_t *elapsed) {
+    plframe_cursor_frame_reader_t **readers = NULL;
+    plframe_cursor_t cursor;
+    plframe_error_t err;
+    bool matched = false;
+
+    switch (cs->unwinder) {
+        case UNWIND_TEST_UNWINDER_FRAME_PTR:
+            readers = frame_readers_frame;
+            break;
+        case UNWIND_TEST_UNWINDER_COMPACT:
+            readers = frame_readers_compact;
+            break;
+        case UNWIND_TEST_UNWINDER_DWARF:
+            readers = frame_readers_dwarf;
+            break;
+        default:
+            break;
+    }
+
+    plframe_cursor_init(&cursor, mach_task_self(), state, cs->image_list);
+    plframe_cursor_set_section_cache(&cursor, cs->section_cache);
+
+    /* Step into the test function using the default readers */
+    if (plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+        size_t reader_count = 0;
+        if (readers != NULL) {
+            while (readers[reader_count] != NULL)
+                reader_count++;
+        } else if (cs->unwinder == UNWIND_TEST_UNWINDER_PIPELINE_FAST) {
+            plframe_cursor_set_pipeline(&cursor, PLFRAME_CURSOR_PIPELINE_FAST);
+        } else {
+            plframe_cursor_set_pipeline(&cursor, PLFRAME_CURSOR_PIPELINE_ACCURATE);
+        }
+
+        /* Unwind the test function's frame */
+        uint64_t start = mach_absolute_time();
+        if (readers != NULL)
+            err = plframe_cursor_next_with_readers(&cursor, readers, reader_count);
+        else
+            err = plframe_cursor_next(&cursor);
+        *elapsed += mach_absolute_time() - start;
+
+        plcrash_greg_t ip;
+        if (err == PLFRAME_ESUCCESS && plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &ip) == PLFRAME_ESUCCESS && ip == (plcrash_greg_t) unwind_tester_target_ip) {
+            /* The frame pointer reader does not restore callee-preserved registers */
+            if (cs->unwinder == UNWIND_TEST_UNWINDER_FRAME_PTR) {
+                matched = true;
+            } else {
+                matched = unwind_test_check_reg(&cursor, PLCRASH_REG_SP, (plcrash_greg_t) cs->expected_sp);
+#ifdef __x86_64__
+                matched = matched &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_64_RBX, 0x1234567887654321) &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_64_R12, 0x02468ACEECA86420) &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_64_R13, 0x13579BDFFDB97531) &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_64_R14, 0x1122334455667788) &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_64_R15, 0x0022446688AACCEE);
+#elif defined(__i386__)
+                matched = matched &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_EBX, 0x12344321) &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_ESI, 0x56788765) &&
+                    unwind_test_check_reg(&cursor, PLCRASH_X86_EDI, 0xABCDDCBA);
+#endif
+            }
+        }
+    }
+
+    plframe_cursor_free(&cursor);
+    return matched;
+}
+
+/*
+ * Unwind from the current frame through the current test function using the system unwinder, adding the time spent
+ * unwinding the test function's frame to @a elapsed. Returns true if the expected state was recovered.
+ */
+static bool unwind_test_compare_libunwind (struct unwind_test_compare_state *cs, uint64_t *elapsed) {
+    unw_context_t context;
+    unw_cursor_t cursor;
+
+    if (unw_getcontext(&context) != 0 || unw_init_local(&cursor, &context) != 0)
+        return false;
+
+    /* The number of harness frames between this function and the test function is not fixed; step until the
+     * unwind_tester() frame is reached, and time only the step that reached it. */
+    for (uint32_t i = 0; i < UNWIND_TEST_LIBUNWIND_MAX_STEPS; i++) {
+        uint64_t start = mach_absolute_time();
+        int ret = unw_step(&cursor);
+        uint64_t step_time = mach_absolute_time() - start;
+
+        unw_word_t ip;
+        if (ret <= 0 || unw_get_reg(&cursor, UNW_REG_IP, &ip) != 0)
+            return false;
+
+        if (ip != (unw_word_t) unwind_tester_target_ip)
+            continue;
+
+        *elapsed += step_time;
+
+#ifdef __x86_64__
+        return unwind_test_check_unw_reg(&cursor, UNW_REG_SP, (unw_word_t) cs->expected_sp) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_64_RBX, 0x1234567887654321) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_64_R12, 0x02468ACEECA86420) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_64_R13, 0x13579BDFFDB97531) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_64_R14, 0x1122334455667788) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_64_R15, 0x0022446688AACCEE);
+#elif defined(__i386__)
+        return unwind_test_check_unw_reg(&cursor, UNW_REG_SP, (unw_word_t) cs->expected_sp) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_EBX, 0x12344321) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_ESI, 0x56788765) &&
+            unwind_test_check_unw_reg(&cursor, UNW_X86_EDI, 0xABCDDCBA);
+#else
+        return unwind_test_check_unw_reg(&cursor, UNW_REG_SP, (unw_word_t) cs->expected_sp);
+#endif
+    }
+
+    return false;
+}
+
+/* Perform the comparison's unwinds from within the current test function */
+static plcrash_error_t unwind_test_compare_current_state (struct unwind_test_compare_state *cs, plcrash_async_thread_state_t *state) {
+    for (uint32_t i = 0; i < cs->iterations; i++) {
+        bool matched;
+        if (cs->unwinder == UNWIND_TEST_UNWINDER_LIBUNWIND)
+            matched = unwind_test_compare_libunwind(cs, &cs->result.elapsed_ns);
+        else
+            matched = unwind_test_compare_plframe(cs, state, &cs->result.elapsed_ns);
+
+        cs->result.unwinds++;
+        if (!matched)
+            cs->result.mismatches++;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return a short name for @a unwinder.
+ */
+const char *unwind_test_harness_unwinder_name (unwind_test_unwinder_t unwinder) {
+    switch (unwinder) {
+        case UNWIND_TEST_UNWINDER_FRAME_PTR:
+            return "frame pointer";
+        case UNWIND_TEST_UNWINDER_COMPACT:
+            return "compact unwind";
+        case UNWIND_TEST_UNWINDER_DWARF:
+            return "dwarf unwind";
+        case UNWIND_TEST_UNWINDER_PIPELINE_FAST:
+            return "pipeline (fast)";
+        case UNWIND_TEST_UNWINDER_PIPELINE_ACCURATE:
+            return "pipeline (accurate)";
+        case UNWIND_TEST_UNWINDER_LIBUNWIND:
+            return "unw_step";
+        case UNWIND_TEST_UNWINDER_COUNT:
+            break;
+    }
+
+    return "unknown";
+}
+
+/**
+ * Unwind through every test function of each test shape @a iterations times using @a unwinder, reporting the number
+ * of mismatched unwinds and the time spent unwinding the test function frames for each shape. Unlike
+ * unwind_test_harness(), unwinding failures are counted rather than treated as fatal.
+ *
+ * @param unwinder The unwinder to be measured.
+ * @param iterations The number of unwinds to perform for each test function.
+ * @param callback Callback to be called with the results for each test shape, or NULL.
+ * @param ctx Context to be passed to @a callback.
+ *
+ * @return Returns true on success, or false if @a unwinder is invalid.
+ */
+bool unwind_test_harness_compare (unwind_test_unwinder_t unwinder, uint32_t iterations, unwind_test_comparison_cb callback, void *ctx) {
+    plcrash_async_image_list_t image_list;
+    plcrash_async_macho_section_cache_t section_cache;
+    mach_timebase_info_data_t timebase;
+
+    if (unwinder >= UNWIND_TEST_UNWINDER_COUNT || mach_timebase_info(&timebase) != KERN_SUCCESS)
+        return false;
+
+    /* Initialize the image list; this is shared across all unwinds, rather than rebuilt per test case */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+    plcrash_async_macho_section_cache_init(&section_cache);
+
+    struct unwind_test_compare_state cs;
+    cs.unwinder = unwinder;
+    cs.iterations = iterations;
+    cs.image_list = &image_list;
+    cs.section_cache = &section_cache;
+
+    for (struct unwind_test_shape *shape = unwind_test_shapes; shape->test_list != NULL; shape++) {
+        cs.result.shape = shape->name;
+        cs.result.unwinder = unwind_test_harness_unwinder_name(unwinder);
+        cs.result.unwinds = 0;
+        cs.result.mismatches = 0;
+        cs.result.elapsed_ns = 0;
+
+        global_harness_state.compare = &cs;
+        for (void **tests = shape->test_list; *tests != NULL; tests++)
+            unwind_tester(*tests, &cs.expected_sp);
+        global_harness_state.compare = NULL;
+
+        cs.result.elapsed_ns = cs.result.elapsed_ns * timebase.numer / timebase.denom;
+        if (callback != NULL)
+            callback(&cs.result, ctx);
+    }
+
+    plcrash_async_macho_section_cache_free(&section_cache);
+    plcrash_nasync_image_list_free(&image_list);
+
+    return true;
+}
+
 plcrash_error_t unwind_current_state (plcrash_async_thread_state_t *state, void *context) {
+    if (global_harness_state.compare != NULL)
+        return unwind_test_compare_current_state(global_harness_state.compare, state);
+
     plframe_cursor_t cursor;
     plcrash_async_image_list_t image_list;
     plframe_cursor_frame_reader_t **readers = global_harness_state.test_case->frame_readers_dwarf;
@@ -22,11 +22,71 @@
 #ifndef PLCRASH_UNWIND_TEST_HARNESS_H
 #define PLCRASH_UNWIND_TEST_HARNESS_H
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Unwinders that may be compared via unwind_test_harness_compare().
+ */
+typedef enum {
+    /** The frame pointer reader. */
+    UNWIND_TEST_UNWINDER_FRAME_PTR = 0,
+
+    /** The compact unwind reader. */
+    UNWIND_TEST_UNWINDER_COMPACT,
+
+    /** The DWARF unwind reader. */
+    UNWIND_TEST_UNWINDER_DWARF,
+
+    /** The PLFRAME_CURSOR_PIPELINE_FAST reader pipeline. */
+    UNWIND_TEST_UNWINDER_PIPELINE_FAST,
+
+    /** The PLFRAME_CURSOR_PIPELINE_ACCURATE reader pipeline. */
+    UNWIND_TEST_UNWINDER_PIPELINE_ACCURATE,
+
+    /** The system unwinder, via libunwind's unw_step(). */
+    UNWIND_TEST_UNWINDER_LIBUNWIND,
+
+    /** The number of defined unwinders. */
+    UNWIND_TEST_UNWINDER_COUNT
+} unwind_test_unwinder_t;
+
+/**
+ * The result of unwinding all tests of a single test shape (eg, frameless) with a single unwinder.
+ */
+typedef struct unwind_test_comparison {
+    /** The test shape name. */
+    const char *shape;
+
+    /** The unwinder name. */
+    const char *unwinder;
+
+    /** The number of unwinds performed. */
+    uint64_t unwinds;
+
+    /** The number of unwinds that failed, or that did not recover the caller's IP and callee-preserved registers. */
+    uint64_t mismatches;
+
+    /** The total time spent unwinding through the test functions, in nanoseconds. */
+    uint64_t elapsed_ns;
+} unwind_test_comparison_t;
+
+/**
+ * Comparison result callback; see unwind_test_harness_compare().
+ *
+ * @param result The result for a single test shape.
+ * @param ctx The caller-supplied context.
+ */
+typedef void (*unwind_test_comparison_cb) (const unwind_test_comparison_t *result, void *ctx);
+
 bool unwind_test_harness (void);
+
+const char *unwind_test_harness_unwinder_name (unwind_test_unwinder_t unwinder);
+bool unwind_test_harness_compare (unwind_test_unwinder_t unwinder, uint32_t iterations, unwind_test_comparison_cb callback, void *ctx);
     
 #ifdef __cplusplus
 }
@@ -27,12 +27,18 @@
  */
 
 #import "PLCrashAsync.h"
+#import "PLCrashAsyncMemoryProvider.h"
+#import "PLCrashAsyncLZ4.h"
+#import "PLCrashAsyncCRC32C.h"
 
 #import <stdint.h>
 #import <errno.h>
 #import <string.h>
 #import <inttypes.h>
 
+#import <mach/mach_time.h>
+#import <sys/mman.h>
+
 /**
  * @internal
  * @defgroup plcrash_async Async Safe Utilities
@@ -136,6 +142,8 @@ const char *plcrash_async_strerror (plcrash_error_t error) {
             return "Access denied";
         case PLCRASH_ENOTFOUND:
             return "Not found";
+        case PLCRASH_EBUDGET:
+            return "Work budget exhausted";
     }
     
     /* Should be unreachable */
@@ -204,34 +212,26 @@ thread_t pl_mach_thread_self (void) {
 }
 
 /**
- * Copy @a len bytes from @a task, at @a address + @a offset, storing in @a dest. If the page(s) at the
- * given @a address + @a offset are unmapped or unreadable, no copy will be performed and an error will
- * be returned.
+ * Copy @a len bytes from the live Mach @a task at @a address into @a dest, bypassing any memory provider registered
+ * for @a task. Most callers should use plcrash_async_task_memcpy().
  *
- * @param task The task from which data from address @a source will be read.
- * @param address The base address within @a task from which the data will be read.
- * @param offset The offset from @a address at which data will be read.
+ * @param task The task from which data will be read.
+ * @param address The address within @a task from which the data will be read.
  * @param dest The destination address to which copied data will be written.
  * @param len The number of bytes to be read.
  *
- * @return On success, returns PLCRASH_ESUCCESS. If the pages containing @a source + len are unmapped, PLCRASH_ENOTFOUND
- * will be returned. If the pages can not be read due to access restrictions, PLCRASH_EACCESS will be returned. If
- * the proivded address + offset would overflow pl_vm_address_t, PLCRASH_ENOMEM is returned.
+ * @return On success, returns PLCRASH_ESUCCESS. If the pages containing @a address + len are unmapped, PLCRASH_ENOTFOUND
+ * will be returned. If the pages can not be read due to access restrictions, PLCRASH_EACCESS will be returned.
  */
-plcrash_error_t plcrash_async_task_memcpy (mach_port_t task, pl_vm_address_t address, pl_vm_off_t offset, void *dest, pl_vm_size_t len) {
-    pl_vm_address_t target;
+plcrash_error_t plcrash_async_task_vm_read (mach_port_t task, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
     kern_return_t kt;
 
-    /* Compute the target address and check for overflow */
-    if (!plcrash_async_address_apply_offset(address, offset, &target))
-        return PLCRASH_ENOMEM;
-
 #ifdef PL_HAVE_MACH_VM
     pl_vm_size_t read_size = len;
-    kt = mach_vm_read_overwrite(task, target, len, (pointer_t) dest, &read_size);
+    kt = mach_vm_read_overwrite(task, address, len, (pointer_t) dest, &read_size);
 #else
     vm_size_t read_size = len;
-    kt = vm_read_overwrite(task, target, len, (pointer_t) dest, &read_size);
+    kt = vm_read_overwrite(task, address, len, (pointer_t) dest, &read_size);
 #endif
     
     switch (kt) {
@@ -253,6 +253,45 @@ plcrash_error_t plcrash_async_task_memcpy (mach_port_t task, pl_vm_address_t add
     }
 }
 
+/**
+ * Copy @a len bytes from @a task, at @a address + @a offset, storing in @a dest. If the page(s) at the
+ * given @a address + @a offset are unmapped or unreadable, no copy will be performed and an error will
+ * be returned.
+ *
+ * If a memory provider has been registered for @a task via plcrash_nasync_memory_provider_register(), the data will
+ * be read from the provider, rather than the live Mach task. If @a task is the current task, and a local region map
+ * has been set via plcrash_async_memory_set_local_region_map(), reads that fall within a readable region will be
+ * copied directly.
+ *
+ * @param task The task from which data from address @a source will be read.
+ * @param address The base address within @a task from which the data will be read.
+ * @param offset The offset from @a address at which data will be read.
+ * @param dest The destination address to which copied data will be written.
+ * @param len The number of bytes to be read.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. If the pages containing @a source + len are unmapped, PLCRASH_ENOTFOUND
+ * will be returned. If the pages can not be read due to access restrictions, PLCRASH_EACCESS will be returned. If
+ * the proivded address + offset would overflow pl_vm_address_t, PLCRASH_ENOMEM is returned.
+ */
+plcrash_error_t plcrash_async_task_memcpy (mach_port_t task, pl_vm_address_t address, pl_vm_off_t offset, void *dest, pl_vm_size_t len) {
+    pl_vm_address_t target;
+
+    /* Compute the target address and check for overflow */
+    if (!plcrash_async_address_apply_offset(address, offset, &target))
+        return PLCRASH_ENOMEM;
+
+    /* Defer to a registered provider, if any */
+    const plcrash_async_memory_provider_t *provider = plcrash_async_memory_provider_find(task);
+    if (provider != NULL)
+        return plcrash_async_memory_provider_read(provider, target, 0, dest, len);
+
+    /* Reads of the current task that fall within a known-readable region do not require a Mach trap */
+    if (task == mach_task_self() && plcrash_async_memory_local_read(target, dest, len))
+        return PLCRASH_ESUCCESS;
+
+    return plcrash_async_task_vm_read(task, target, dest, len);
+}
+
 /**
  * Read an 8-bit value from @a task, at @a address + @a offset, storing in @a dest. If the page(s) at the
  * given @a address + @a offset are unmapped or unreadable, no copy will be performed and an error will
@@ -290,7 +329,7 @@ plcrash_error_t plcrash_async_task_read_uint16 (task_t task, const plcrash_async
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint16_t *result)
 {
     plcrash_error_t err = plcrash_async_task_memcpy(task, address, offset, result, sizeof(*result));
-    *result = byteorder->swap16(*result);
+    *result = plcrash_async_byteorder_swap16(byteorder, *result);
     return err;
 }
 
@@ -314,7 +353,7 @@ plcrash_error_t plcrash_async_task_read_uint32 (task_t task, const plcrash_async
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint32_t *result)
 {
     plcrash_error_t err = plcrash_async_task_memcpy(task, address, offset, result, sizeof(*result));
-    *result = byteorder->swap32(*result);
+    *result = plcrash_async_byteorder_swap32(byteorder, *result);
     return err;
 }
 
@@ -338,12 +377,71 @@ plcrash_error_t plcrash_async_task_read_uint64 (task_t task, const plcrash_async
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint64_t *result)
 {
     plcrash_error_t err = plcrash_async_task_memcpy(task, address, offset, result, sizeof(*result));
-    *result = byteorder->swap64(*result);
+    *result = plcrash_async_byteorder_swap64(byteorder, *result);
     return err;
 }
 
+/*
+ * Word-at-a-time string primitives.
+ *
+ * Aligned word reads never span a page boundary, and so may safely read past a string's terminator without
+ * faulting, provided that the terminator itself is readable. Unaligned leading and trailing bytes are handled
+ * individually.
+ */
+
+/** Machine word used by the string primitives. May alias any other type. */
+typedef uintptr_t __attribute__((__may_alias__)) plcrash_async_word_t;
+
+/** The size of plcrash_async_word_t, in bytes. */
+#define PLCRASH_ASYNC_WORD_SIZE sizeof(plcrash_async_word_t)
+
+/** A word with every byte set to 0x01. */
+#define PLCRASH_ASYNC_WORD_ONES (((plcrash_async_word_t) -1) / 0xFF)
+
+/** A word with every byte set to 0x80. */
+#define PLCRASH_ASYNC_WORD_HIGHS (PLCRASH_ASYNC_WORD_ONES * 0x80)
+
+/** Evaluate to non-zero if any byte of the word @a w is zero. */
+#define PLCRASH_ASYNC_WORD_HAS_ZERO(w) (((w) - PLCRASH_ASYNC_WORD_ONES) & ~(w) & PLCRASH_ASYNC_WORD_HIGHS)
+
+/** Evaluate to true if @a ptr is word-aligned. */
+#define PLCRASH_ASYNC_WORD_ALIGNED(ptr) ((((uintptr_t) (ptr)) & (PLCRASH_ASYNC_WORD_SIZE - 1)) == 0)
+
+/** Evaluate to true if @a p1 and @a p2 share the same offset from a word boundary. */
+#define PLCRASH_ASYNC_WORD_CO_ALIGNED(p1, p2) (((((uintptr_t) (p1)) ^ ((uintptr_t) (p2))) & (PLCRASH_ASYNC_WORD_SIZE - 1)) == 0)
+
+/**
+ * An async-safe implementation of strlen(). strlen() itself is not declared to be async-safe,
+ * though in reality, it is.
+ *
+ * @param s The string to measure.
+ * @return Returns the number of bytes preceding the terminating NUL.
+ */
+size_t plcrash_async_strlen (const char *s) {
+    const char *p = s;
+
+    /* Advance to a word boundary */
+    while (!PLCRASH_ASYNC_WORD_ALIGNED(p)) {
+        if (*p == '\0')
+            return p - s;
+        p++;
+    }
+
+    /* Scan a word at a time for the terminator */
+    const plcrash_async_word_t *w = (const plcrash_async_word_t *) p;
+    while (!PLCRASH_ASYNC_WORD_HAS_ZERO(*w))
+        w++;
+
+    /* Locate the terminator within the final word */
+    p = (const char *) w;
+    while (*p != '\0')
+        p++;
+
+    return p - s;
+}
+
 /**
- * An intentionally naive async-safe implementation of strcmp(). strcmp() itself is not declared to be async-safe,
+ * An async-safe implementation of strcmp(). strcmp() itself is not declared to be async-safe,
  * though in reality, it is.
  *
  * @param s1 First string.
@@ -352,16 +450,37 @@ plcrash_error_t plcrash_async_task_read_uint64 (task_t task, const plcrash_async
  * equal to, or less than the string @a s2.
  */
 int plcrash_async_strcmp(const char *s1, const char *s2) {
-    while (*s1 == *s2++) {
-        if (*s1++ == 0)
-            return (0);
+    /* Strings that share an alignment may be compared a word at a time */
+    if (PLCRASH_ASYNC_WORD_CO_ALIGNED(s1, s2)) {
+        while (!PLCRASH_ASYNC_WORD_ALIGNED(s1) && *s1 == *s2 && *s1 != '\0') {
+            s1++;
+            s2++;
+        }
+
+        if (PLCRASH_ASYNC_WORD_ALIGNED(s1)) {
+            const plcrash_async_word_t *w1 = (const plcrash_async_word_t *) s1;
+            const plcrash_async_word_t *w2 = (const plcrash_async_word_t *) s2;
+            while (*w1 == *w2 && !PLCRASH_ASYNC_WORD_HAS_ZERO(*w1)) {
+                w1++;
+                w2++;
+            }
+
+            s1 = (const char *) w1;
+            s2 = (const char *) w2;
+        }
     }
-    
-    return (*(const unsigned char *)s1 - *(const unsigned char *)(s2 - 1));
+
+    /* Compare the remaining bytes */
+    while (*s1 == *s2 && *s1 != '\0') {
+        s1++;
+        s2++;
+    }
+
+    return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
 }
 
 /**
- * An intentionally naive async-safe implementation of strncmp(). strncmp() itself is not declared to be async-safe,
+ * An async-safe implementation of strncmp(). strncmp() itself is not declared to be async-safe,
  * though in reality, it is.
  *
  * @param s1 First string.
@@ -371,19 +490,43 @@ int plcrash_async_strcmp(const char *s1, const char *s2) {
  * equal to, or less than the string @a s2.
  */
 int plcrash_async_strncmp(const char *s1, const char *s2, size_t n) {
-    while (*s1 == *s2++ && n-- > 0) {
-        if (*s1++ == 0)
-            return (0);
+    /* Strings that share an alignment may be compared a word at a time. Only words that fall entirely within
+     * the first @a n bytes are read, permitting comparison of fixed-width, non-terminated names. */
+    if (PLCRASH_ASYNC_WORD_CO_ALIGNED(s1, s2)) {
+        while (n > 0 && !PLCRASH_ASYNC_WORD_ALIGNED(s1) && *s1 == *s2 && *s1 != '\0') {
+            s1++;
+            s2++;
+            n--;
+        }
+
+        if (PLCRASH_ASYNC_WORD_ALIGNED(s1)) {
+            const plcrash_async_word_t *w1 = (const plcrash_async_word_t *) s1;
+            const plcrash_async_word_t *w2 = (const plcrash_async_word_t *) s2;
+            while (n >= PLCRASH_ASYNC_WORD_SIZE && *w1 == *w2 && !PLCRASH_ASYNC_WORD_HAS_ZERO(*w1)) {
+                w1++;
+                w2++;
+                n -= PLCRASH_ASYNC_WORD_SIZE;
+            }
+
+            s1 = (const char *) w1;
+            s2 = (const char *) w2;
+        }
+    }
+
+    /* Compare the remaining bytes */
+    for (; n > 0; n--, s1++, s2++) {
+        if (*s1 != *s2)
+            return (*(const unsigned char *)s1 - *(const unsigned char *)s2);
+
+        if (*s1 == '\0')
+            break;
     }
-    
-    if (n == 0)
-        return 0;
 
-    return (*(const unsigned char *)s1 - *(const unsigned char *)(s2 - 1));
+    return 0;
 }
 
 /**
- * An intentionally naive async-safe implementation of memcpy(). memcpy() itself is not declared to be async-safe,
+ * An async-safe implementation of memcpy(). memcpy() itself is not declared to be async-safe,
  * though in reality, it is.
  *
  * @param dest Destination.
@@ -391,17 +534,34 @@ int plcrash_async_strncmp(const char *s1, const char *s2, size_t n) {
  * @param n Number of bytes to copy.
  */
 void *plcrash_async_memcpy (void *dest, const void *source, size_t n) {
-    uint8_t *s = (uint8_t *) source;
+    const uint8_t *s = (const uint8_t *) source;
     uint8_t *d = (uint8_t *) dest;
 
-    for (size_t count = 0; count < n; count++)
+    /* Buffers that share an alignment may be copied a word at a time */
+    if (PLCRASH_ASYNC_WORD_CO_ALIGNED(s, d)) {
+        while (n > 0 && !PLCRASH_ASYNC_WORD_ALIGNED(s)) {
+            *d++ = *s++;
+            n--;
+        }
+
+        const plcrash_async_word_t *ws = (const plcrash_async_word_t *) s;
+        plcrash_async_word_t *wd = (plcrash_async_word_t *) d;
+        for (; n >= PLCRASH_ASYNC_WORD_SIZE; n -= PLCRASH_ASYNC_WORD_SIZE)
+            *wd++ = *ws++;
+
+        s = (const uint8_t *) ws;
+        d = (uint8_t *) wd;
+    }
+
+    /* Copy the remaining bytes */
+    while (n-- > 0)
         *d++ = *s++;
 
     return (void *) source;
 }
 
 /**
- * An intentionally naive async-safe implementation of memset(). memset() itself is not declared to be async-safe,
+ * An async-safe implementation of memset(). memset() itself is not declared to be async-safe,
  * though in reality, it is.
  *
  * @param dest Destination.
@@ -410,13 +570,65 @@ void *plcrash_async_memcpy (void *dest, const void *source, size_t n) {
  */
 void *plcrash_async_memset(void *dest, uint8_t value, size_t n) {
     uint8_t *d = (uint8_t *) dest;
-    
-    for (size_t count = 0; count < n; count++)
+
+    /* Advance to a word boundary */
+    while (n > 0 && !PLCRASH_ASYNC_WORD_ALIGNED(d)) {
+        *d++ = value;
+        n--;
+    }
+
+    /* Fill a word at a time */
+    plcrash_async_word_t word = PLCRASH_ASYNC_WORD_ONES * value;
+    plcrash_async_word_t *wd = (plcrash_async_word_t *) d;
+    for (; n >= PLCRASH_ASYNC_WORD_SIZE; n -= PLCRASH_ASYNC_WORD_SIZE)
+        *wd++ = word;
+
+    /* Fill the remaining bytes */
+    d = (uint8_t *) wd;
+    while (n-- > 0)
         *d++ = value;
 
     return (void *) dest;
 }
 
+/**
+ * Pre-fault and wire the pages backing @a len bytes at @a addr, such that later accesses from a crash handler do not
+ * incur page-fault or decompression latency, even under memory pressure.
+ *
+ * Each page is touched prior to wiring; if wiring fails (eg, due to RLIMIT_MEMLOCK), the pages will have been
+ * faulted in, but may later be reclaimed.
+ *
+ * @param addr The base address of the region. The region must be readable and writable, and its contents are
+ * not modified.
+ * @param len The length of the region, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the region was wired, or PLCRASH_ENOMEM if wiring failed.
+ *
+ * @warning This function is not async-safe, and must not be called while another thread may be writing to the
+ * region's first word or any page boundary within the region.
+ */
+plcrash_error_t plcrash_nasync_mem_wire (void *addr, size_t len) {
+    if (len == 0)
+        return PLCRASH_ESUCCESS;
+
+    vm_address_t start = (vm_address_t) addr;
+    vm_address_t end = start + len;
+
+    /* Touch every page, writing back the value read; only addresses within the region are touched, as the
+     * surrounding memory may be in use by other threads. */
+    for (vm_address_t page = start; page < end; page = trunc_page(page) + PAGE_SIZE) {
+        volatile uint8_t *p = (volatile uint8_t *) page;
+        *p = *p;
+    }
+
+    if (mlock((void *) trunc_page(start), round_page(end) - trunc_page(start)) != 0) {
+        PLCF_DEBUG("mlock() failure: %d", errno);
+        return PLCRASH_ENOMEM;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * @internal
  * @ingroup plcrash_async
@@ -456,6 +668,24 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len) {
 }
 
 
+/**
+ * @internal
+ *
+ * Write @a len bytes from @a data to @a file's descriptor, updating the file's system call statistics.
+ *
+ * @return Returns the number of bytes written on success, or -1 on failure.
+ */
+static ssize_t plcrash_async_file_writen (plcrash_async_file_t *file, const void *data, size_t len) {
+    uint64_t start = mach_absolute_time();
+    ssize_t rv = plcrash_async_writen(file->fd, data, len);
+
+    file->write_time += mach_absolute_time() - start;
+    file->syscall_count++;
+
+    return rv;
+}
+
+
 /**
  * Initialize the plcrash_async_file_t instance.
  *
@@ -466,18 +696,187 @@ ssize_t plcrash_async_writen (int fd, const void *data, size_t len) {
  * @param fd Open file descriptor.
  */
 void plcrash_async_file_init (plcrash_async_file_t *file, int fd, off_t output_limit) {
+    plcrash_async_file_init_buffer(file, fd, output_limit, NULL, 0);
+}
+
+/**
+ * Initialize the plcrash_async_file_t instance, using @a buffer for buffered output. A larger buffer reduces
+ * the number of write(2) calls required to write a report, which is of particular importance when writing
+ * from a signal handler.
+ *
+ * @param file File structure to initialize.
+ * @param fd Open file descriptor.
+ * @param output_limit Maximum number of bytes that will be written to disk. Specify 0 to disable any limits.
+ * @param buffer The buffer to be used for buffered output, or NULL to use the default internal buffer of
+ * PLCRASH_ASYNC_FILE_DEFAULT_BUFFER_SIZE bytes. As allocation is not async-safe, this must be pre-allocated by
+ * the caller, and must remain valid until the file has been closed.
+ * @param bufsize The size of @a buffer, in bytes. Ignored if @a buffer is NULL.
+ */
+void plcrash_async_file_init_buffer (plcrash_async_file_t *file, int fd, off_t output_limit, void *buffer, size_t bufsize) {
+    if (buffer == NULL || bufsize == 0) {
+        file->buffer = file->default_buffer;
+        file->bufsize = sizeof(file->default_buffer);
+    } else {
+        file->buffer = buffer;
+        file->bufsize = bufsize;
+    }
+
+    file->mapped = false;
     file->fd = fd;
     file->buflen = 0;
     file->total_bytes = 0;
+    file->position = 0;
+    file->syscall_count = 0;
+    file->write_time = 0;
     file->limit_bytes = output_limit;
+    file->checksum_enabled = false;
+    file->checksum_valid = false;
+
+    /* Record the starting offset; this is used to back-patch previously flushed output. Non-seekable descriptors will
+     * return -1, in which case back-patching is limited to buffered data. */
+    file->base_offset = lseek(fd, 0, SEEK_CUR);
 }
 
 
+/**
+ * Initialize the plcrash_async_file_t instance for output to a shared, writable file mapping of @a fd. All output is
+ * written directly to the mapped pages, and no write(2) calls are issued; the kernel is responsible for writing the
+ * pages back to the file. When the file is closed, @a fd will be truncated to the length of the written output.
+ *
+ * The mapping must be established (and the file sized) prior to calling this function, as neither mmap() nor
+ * ftruncate()-based growth is permitted during output.
+ *
+ * @param file File structure to initialize.
+ * @param fd The open file descriptor of the mapped file. The descriptor must be positioned at the start of the file.
+ * @param mapping A MAP_SHARED, writable mapping of at least @a size bytes of @a fd, starting at offset 0.
+ * @param size The size of @a mapping, in bytes. This is also the maximum number of bytes that may be written.
+ */
+void plcrash_async_file_init_mapped (plcrash_async_file_t *file, int fd, void *mapping, size_t size) {
+    plcrash_async_file_init_buffer(file, fd, 0, mapping, size);
+    file->mapped = true;
+    file->base_offset = 0;
+}
+
+/**
+ * Initialize the plcrash_async_file_t instance for output to caller-supplied memory. This is used to encode
+ * crash log data ahead of time, and to write live reports directly to memory; no system calls are issued, and
+ * plcrash_async_file_flush() and plcrash_async_file_close() are no-ops. The number of bytes written may be
+ * fetched via plcrash_async_file_tell().
+ *
+ * @param file File structure to initialize.
+ * @param buffer The output buffer.
+ * @param size The size of @a buffer, in bytes. This is also the maximum number of bytes that may be written.
+ */
+void plcrash_async_file_init_memory (plcrash_async_file_t *file, void *buffer, size_t size) {
+    plcrash_async_file_init_mapped(file, -1, buffer, size);
+}
+
+/**
+ * @internal
+ *
+ * Update @a file's running checksum with @a len bytes of newly written output.
+ */
+static inline void plcrash_async_file_checksum_update (plcrash_async_file_t *file, const void *data, size_t len) {
+    if (file->checksum_enabled)
+        file->checksum = plcrash_async_crc32c_update(file->checksum, data, len);
+}
+
+/**
+ * @internal
+ *
+ * Apply the effect of overwriting @a len bytes of output at @a offset with @a data to @a file's checksum. This must
+ * be called before the data is overwritten, as the original output is required to compute the checksum delta.
+ * Original output that has already been flushed is read back from the file descriptor.
+ *
+ * @return Returns true on success, or false if the original output could not be read.
+ */
+static bool plcrash_async_file_checksum_patch (plcrash_async_file_t *file, off_t offset, const uint8_t *data, size_t len) {
+    uint32_t delta = 0;
+    off_t end = offset + len;
+
+    /* Output preceding the checksummed range doesn't contribute to the checksum */
+    if (end <= file->checksum_start)
+        return true;
+
+    if (offset < file->checksum_start) {
+        data += file->checksum_start - offset;
+        len -= (size_t) (file->checksum_start - offset);
+        offset = file->checksum_start;
+    }
+
+    /* Read back any flushed output */
+    off_t buffer_start = file->position - file->buflen;
+    if (offset < buffer_start) {
+        size_t flushed = len;
+        if (buffer_start - offset < (off_t) len)
+            flushed = (size_t) (buffer_start - offset);
+        uint8_t original[64];
+
+        if (file->base_offset < 0)
+            return false;
+
+        file->syscall_count += 2;
+        off_t saved = lseek(file->fd, 0, SEEK_CUR);
+        if (saved < 0 || lseek(file->fd, file->base_offset + offset, SEEK_SET) < 0) {
+            PLCF_DEBUG("Error seeking in crash log: %s", strerror(errno));
+            return false;
+        }
+
+        bool result = true;
+        for (size_t done = 0; done < flushed;) {
+            size_t count = flushed - done;
+            if (count > sizeof(original))
+                count = sizeof(original);
+
+            ssize_t nread = read(file->fd, original, count);
+            file->syscall_count++;
+
+            if (nread < 0 && errno == EINTR)
+                continue;
+
+            if (nread <= 0) {
+                PLCF_DEBUG("Error reading back crash log: %s", nread < 0 ? strerror(errno) : "unexpected end of file");
+                result = false;
+                break;
+            }
+
+            delta = plcrash_async_crc32c_delta(delta, original, data + done, (size_t) nread);
+            done += (size_t) nread;
+        }
+
+        if (lseek(file->fd, saved, SEEK_SET) < 0) {
+            PLCF_DEBUG("Error seeking in crash log: %s", strerror(errno));
+            result = false;
+        }
+
+        if (!result)
+            return false;
+
+        data += flushed;
+        len -= flushed;
+        offset += flushed;
+    }
+
+    /* The remainder is still buffered */
+    delta = plcrash_async_crc32c_delta(delta, file->buffer + (offset - buffer_start), data, len);
+
+    /* Advance both the accumulated and new deltas to the current output position, and combine them */
+    file->checksum_delta = plcrash_async_crc32c_shift(file->checksum_delta, file->position - file->checksum_delta_position) ^
+                           plcrash_async_crc32c_shift(delta, file->position - end);
+    file->checksum_delta_position = file->position;
+
+    return true;
+}
+
 /**
  * Write all bytes from @a data to the file buffer. Returns true on success,
  * or false if an error occurs.
  */
 bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, size_t len) {
+    /* Checksummed output; the checksum is only updated once the data has been accepted. */
+    const void *output = data;
+    size_t output_len = len;
+
     /* Check and update output limit */
     if (file->limit_bytes != 0 && len + file->total_bytes > file->limit_bytes) {
         return false;
@@ -485,10 +884,35 @@ bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, siz
         file->total_bytes += len;
     }
 
+    /* Mapped output can't be flushed; the mapping bounds the total output */
+    if (file->mapped) {
+        if (len > file->bufsize - file->buflen) {
+            PLCF_DEBUG("Mapped crash log output limit of %zu bytes reached", file->bufsize);
+            return false;
+        }
+
+        plcrash_async_memcpy(file->buffer + file->buflen, data, len);
+        file->buflen += len;
+        file->position += len;
+        plcrash_async_file_checksum_update(file, output, output_len);
+        return true;
+    }
+
     /* Check if the buffer will fill */
-    if (file->buflen + len > sizeof(file->buffer)) {
+    if (file->buflen + len > file->bufsize) {
+        /* Top off the buffer before flushing it, so that each write(2) is a full buffer. */
+        if (file->buflen > 0) {
+            size_t avail = file->bufsize - file->buflen;
+            plcrash_async_memcpy(file->buffer + file->buflen, data, avail);
+            file->buflen += avail;
+            file->position += avail;
+
+            data = ((const uint8_t *) data) + avail;
+            len -= avail;
+        }
+
         /* Flush the buffer */
-        if (plcrash_async_writen(file->fd, file->buffer, file->buflen) < 0) {
+        if (plcrash_async_file_writen(file, file->buffer, file->buflen) < 0) {
             PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
             return false;
         }
@@ -497,34 +921,202 @@ bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, siz
     }
     
     /* Check if the new data fits within the buffer, if so, buffer it */
-    if (len + file->buflen <= sizeof(file->buffer)) {
+    if (len + file->buflen <= file->bufsize) {
         plcrash_async_memcpy(file->buffer + file->buflen, data, len);
         file->buflen += len;
+        file->position += len;
+        plcrash_async_file_checksum_update(file, output, output_len);
         
         return true;
         
     } else {
         /* Won't fit in the buffer, just write it */
-        if (plcrash_async_writen(file->fd, data, len) < 0) {
+        if (plcrash_async_file_writen(file, data, len) < 0) {
             PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
             return false;
         }
+        file->position += len;
+        plcrash_async_file_checksum_update(file, output, output_len);
         
         return true;
     } 
 }
 
+/**
+ * Return the current output position of @a file, including any buffered data. The position is relative to the
+ * descriptor's offset at the time plcrash_async_file_init() was called.
+ */
+off_t plcrash_async_file_tell (plcrash_async_file_t *file) {
+    return file->position;
+}
+
+/**
+ * Overwrite @a len bytes of previously written output at @a offset with @a data. This is used to back-patch
+ * values -- such as message length prefixes -- that are not known until after the data following them has been
+ * written.
+ *
+ * Patches that fall within the currently buffered data are applied in-memory. Patches to data that has already
+ * been flushed require a seekable file descriptor.
+ *
+ * @param file The file to be patched.
+ * @param offset The output position (as returned by plcrash_async_file_tell()) at which @a data will be written.
+ * @param data The replacement data.
+ * @param len The number of bytes to be written. The range must fall entirely within previously written output.
+ *
+ * @return Returns true on success, or false if the range is invalid or an error occurs.
+ */
+bool plcrash_async_file_pwrite (plcrash_async_file_t *file, off_t offset, const void *data, size_t len) {
+    const uint8_t *p = data;
+
+    /* The patched range must fall within previously written output */
+    if (offset < 0 || offset > file->position || (off_t) len > file->position - offset) {
+        PLCF_DEBUG("Patch range %" PRId64 "+%zu falls outside of the written output", (int64_t) offset, len);
+        return false;
+    }
+
+    /* Account for the patch in the output checksum; this requires the original output, and must be done first */
+    if (file->checksum_enabled && file->checksum_valid && !plcrash_async_file_checksum_patch(file, offset, p, len)) {
+        PLCF_DEBUG("Could not update the output checksum; the checksum will be unavailable");
+        file->checksum_valid = false;
+    }
+
+    /* Patch any bytes that are still held in the buffer */
+    off_t buffer_start = file->position - file->buflen;
+    if (offset + (off_t) len > buffer_start) {
+        size_t skip = 0;
+        if (offset < buffer_start)
+            skip = (size_t) (buffer_start - offset);
+
+        plcrash_async_memcpy(file->buffer + (offset + skip - buffer_start), p + skip, len - skip);
+        len = skip;
+    }
+
+    /* Anything remaining has already been flushed to disk */
+    if (len == 0)
+        return true;
+
+    if (file->base_offset < 0) {
+        PLCF_DEBUG("Cannot patch flushed output on a non-seekable file");
+        return false;
+    }
+
+    /* pwrite() is not included in the POSIX list of async-safe functions; lseek() and write() are. */
+    file->syscall_count += 2;
+    off_t saved = lseek(file->fd, 0, SEEK_CUR);
+    if (saved < 0 || lseek(file->fd, file->base_offset + offset, SEEK_SET) < 0) {
+        PLCF_DEBUG("Error seeking in crash log: %s", strerror(errno));
+        return false;
+    }
+
+    bool result = true;
+    if (plcrash_async_file_writen(file, p, len) < 0) {
+        PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
+        result = false;
+    }
+
+    if (lseek(file->fd, saved, SEEK_SET) < 0) {
+        PLCF_DEBUG("Error seeking in crash log: %s", strerror(errno));
+        result = false;
+    }
+
+    return result;
+}
+
+
+/**
+ * Begin computing a CRC-32C checksum (see plcrash_async_crc32c_update()) of all output subsequently written to
+ * @a file. The checksum is updated incrementally as output is written, and reflects any later changes made via
+ * plcrash_async_file_pwrite(); the final output need not be re-read to compute its checksum.
+ *
+ * If previously flushed output is patched, the original output must be read back from the file descriptor. If the
+ * descriptor is not readable, the checksum will be unavailable.
+ *
+ * @param file The file to be checksummed.
+ */
+void plcrash_async_file_checksum_begin (plcrash_async_file_t *file) {
+    file->checksum_enabled = true;
+    file->checksum_valid = true;
+    file->checksum_start = file->position;
+    file->checksum = 0;
+    file->checksum_delta = 0;
+    file->checksum_delta_position = file->position;
+}
+
+/**
+ * Fetch the CRC-32C checksum of all output written to @a file since plcrash_async_file_checksum_begin().
+ *
+ * @param file The checksummed file.
+ * @param checksum On success, the checksum.
+ *
+ * @return Returns true on success, or false if checksumming was not enabled, or the checksum could not be
+ * maintained. Compressing the file's output via plcrash_async_file_compress() invalidates the checksum.
+ */
+bool plcrash_async_file_checksum (plcrash_async_file_t *file, uint32_t *checksum) {
+    if (!file->checksum_enabled || !file->checksum_valid)
+        return false;
+
+    *checksum = file->checksum ^ plcrash_async_crc32c_shift(file->checksum_delta, file->position - file->checksum_delta_position);
+    return true;
+}
+
+/**
+ * Replace the output written to @a file following @a offset with its LZ4 compressed representation (see
+ * plcrash_async_lz4_compress()), prefixed with the uncompressed length as a little-endian 32-bit value.
+ *
+ * As previously written output may be back-patched via plcrash_async_file_pwrite(), output can't be compressed as it
+ * is written; instead, the completed output is compressed in place. This is only supported for mapped and memory
+ * output, in which all output remains resident until the file is closed.
+ *
+ * @param file The file to be compressed.
+ * @param offset The output position (as returned by plcrash_async_file_tell()) from which output will be compressed.
+ * @param state The compressor state.
+ * @param scratch A pre-allocated buffer into which the output will be compressed before being copied into place.
+ * @param scratch_size The size of @a scratch, in bytes. Must be at least 4 bytes larger than
+ * plcrash_async_lz4_bound() of the output length.
+ *
+ * @return Returns true if the output was compressed. If the output can't be compressed, or compressing it would not
+ * reduce its size, false is returned and the output is left unmodified.
+ */
+bool plcrash_async_file_compress (plcrash_async_file_t *file, off_t offset, plcrash_async_lz4_state_t *state, void *scratch, size_t scratch_size) {
+    uint8_t *output = scratch;
+    size_t compressed;
+
+    if (!file->mapped || offset < 0 || offset > file->position)
+        return false;
+
+    size_t length = (size_t) (file->position - offset);
+    if (length > UINT32_MAX || scratch_size < 4 || plcrash_async_lz4_compress(state, file->buffer + offset, length, output + 4, scratch_size - 4, &compressed) != PLCRASH_ESUCCESS)
+        return false;
+
+    if (compressed + 4 >= length)
+        return false;
+
+    output[0] = (uint8_t) (length & 0xFF);
+    output[1] = (uint8_t) ((length >> 8) & 0xFF);
+    output[2] = (uint8_t) ((length >> 16) & 0xFF);
+    output[3] = (uint8_t) ((length >> 24) & 0xFF);
+
+    /* Replace the uncompressed output */
+    plcrash_async_memcpy(file->buffer + offset, output, compressed + 4);
+    file->buflen = (size_t) offset + compressed + 4;
+    file->position = file->buflen;
+    file->checksum_valid = false;
+    if (file->limit_bytes != 0)
+        file->total_bytes -= length - (compressed + 4);
+
+    return true;
+}
 
 /**
  * Flush all buffered bytes from the file buffer.
  */
 bool plcrash_async_file_flush (plcrash_async_file_t *file) {
-    /* Anything to do? */
-    if (file->buflen == 0)
+    /* Anything to do? Mapped output is written back by the kernel. */
+    if (file->buflen == 0 || file->mapped)
         return true;
     
     /* Write remaining */
-    if (plcrash_async_writen(file->fd, file->buffer, file->buflen) < 0) {
+    if (plcrash_async_file_writen(file, file->buffer, file->buflen) < 0) {
         PLCF_DEBUG("Error occured writing to crash log: %s", strerror(errno));
         return false;
     }
@@ -543,6 +1135,16 @@ bool plcrash_async_file_close (plcrash_async_file_t *file) {
     if (!plcrash_async_file_flush(file))
         return false;
 
+    /* Memory output has no backing descriptor */
+    if (file->mapped && file->fd < 0)
+        return true;
+
+    /* Trim mapped output to the written length */
+    if (file->mapped && ftruncate(file->fd, file->position) != 0) {
+        PLCF_DEBUG("Error truncating mapped file: %s", strerror(errno));
+        return false;
+    }
+
     /* Close the file descriptor */
     if (close(file->fd) != 0) {
         PLCF_DEBUG("Error closing file: %s", strerror(errno));
@@ -141,6 +141,13 @@ typedef int64_t pl_vm_off_t;
 #define PLCF_ASSERT_STATIC_(name, cond, line) PLCF_ASSERT_STATIC__(name, cond, line)
 #define PLCF_ASSERT_STATIC__(name, cond, line) typedef int plcf_static_assert_##name##_##line [(cond) ? 1 : -1]
 
+/**
+ * Force a function to be inlined at every call site. This is used to specialize a function for a constant argument,
+ * such as an image's pointer width, allowing per-iteration branches on the argument to be folded away; the caller
+ * branches on the value once, and calls the function with a literal true or false.
+ */
+#define PLCF_ALWAYS_INLINE inline __attribute__((always_inline))
+
 // Debug output support. Lines are capped at 128 (stack space is scarce). This implemention
 // is not async-safe and should not be enabled in release builds
 #ifdef PLCF_RELEASE_BUILD
@@ -199,6 +206,9 @@ typedef enum  {
 
     /** The requested resource could not be found. */
     PLCRASH_ENOTFOUND,
+
+    /** The operation was abandoned once its work budget was exhausted. See plcrash_async_work_budget_t. */
+    PLCRASH_EBUDGET,
 } plcrash_error_t;
 
 const char *plcrash_async_strerror (plcrash_error_t error);
@@ -233,7 +243,68 @@ extern const plcrash_async_byteorder_t plcrash_async_byteorder_direct;
 extern const plcrash_async_byteorder_t *plcrash_async_byteorder_little_endian (void);
 extern const plcrash_async_byteorder_t *plcrash_async_byteorder_big_endian (void);
 
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Swap a 16-bit @a value from the target byte order described by @a byteorder to the host byte order.
+ *
+ * Unlike calling @a byteorder->swap16 directly, the standard direct and swapped byte orders are resolved inline,
+ * without an indirect function call; this is the common case when reading from the host task. Any other
+ * byte order is applied via its swap function.
+ *
+ * @param byteorder The target byte order.
+ * @param value The value to be swapped.
+ */
+static inline uint16_t plcrash_async_byteorder_swap16 (const plcrash_async_byteorder_t *byteorder, uint16_t value) {
+    if (byteorder == &plcrash_async_byteorder_direct)
+        return value;
+    else if (byteorder == &plcrash_async_byteorder_swapped)
+        return __builtin_bswap16(value);
+
+    return byteorder->swap16(value);
+}
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Swap a 32-bit @a value from the target byte order described by @a byteorder to the host byte order.
+ * @sa plcrash_async_byteorder_swap16()
+ *
+ * @param byteorder The target byte order.
+ * @param value The value to be swapped.
+ */
+static inline uint32_t plcrash_async_byteorder_swap32 (const plcrash_async_byteorder_t *byteorder, uint32_t value) {
+    if (byteorder == &plcrash_async_byteorder_direct)
+        return value;
+    else if (byteorder == &plcrash_async_byteorder_swapped)
+        return __builtin_bswap32(value);
+
+    return byteorder->swap32(value);
+}
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Swap a 64-bit @a value from the target byte order described by @a byteorder to the host byte order.
+ * @sa plcrash_async_byteorder_swap16()
+ *
+ * @param byteorder The target byte order.
+ * @param value The value to be swapped.
+ */
+static inline uint64_t plcrash_async_byteorder_swap64 (const plcrash_async_byteorder_t *byteorder, uint64_t value) {
+    if (byteorder == &plcrash_async_byteorder_direct)
+        return value;
+    else if (byteorder == &plcrash_async_byteorder_swapped)
+        return __builtin_bswap64(value);
+
+    return byteorder->swap64(value);
+}
+
 
+plcrash_error_t plcrash_async_task_vm_read (mach_port_t task, pl_vm_address_t address, void *dest, pl_vm_size_t len);
 plcrash_error_t plcrash_async_task_memcpy (mach_port_t task, pl_vm_address_t address, pl_vm_off_t offset, void *dest, pl_vm_size_t len);
 
 plcrash_error_t plcrash_async_task_read_uint8 (task_t task, pl_vm_address_t address, pl_vm_off_t offset, uint8_t *result);
@@ -247,13 +318,23 @@ plcrash_error_t plcrash_async_task_read_uint32 (task_t task, const plcrash_async
 plcrash_error_t plcrash_async_task_read_uint64 (task_t task, const plcrash_async_byteorder_t *byteorder,
                                                 pl_vm_address_t address, pl_vm_off_t offset, uint64_t *result);
 
+size_t plcrash_async_strlen (const char *s);
 int plcrash_async_strcmp(const char *s1, const char *s2);
 int plcrash_async_strncmp(const char *s1, const char *s2, size_t n);
 void *plcrash_async_memcpy(void *dest, const void *source, size_t n);
 void *plcrash_async_memset(void *dest, uint8_t value, size_t n);
+plcrash_error_t plcrash_nasync_mem_wire (void *addr, size_t len);
 
 ssize_t plcrash_async_writen (int fd, const void *data, size_t len);
 
+/**
+ * @internal
+ * @ingroup plcrash_async_bufio
+ *
+ * The size of the internal plcrash_async_file_t buffer used when no buffer is supplied to plcrash_async_file_init_buffer().
+ */
+#define PLCRASH_ASYNC_FILE_DEFAULT_BUFFER_SIZE 256
+
 /**
  * @internal
  * @ingroup plcrash_async_bufio
@@ -271,16 +352,69 @@ typedef struct plcrash_async_file {
     /** Total bytes written */
     off_t total_bytes;
 
+    /** The current output position, relative to the file offset at which the file was initialized. This
+     * includes any data still held in the buffer. */
+    off_t position;
+
+    /** The backing descriptor's file offset at initialization time, or -1 if the descriptor is not seekable. */
+    off_t base_offset;
+
     /** Current length of data in buffer */
     size_t buflen;
 
-    /** Buffered output */
-    char buffer[256];
+    /** Total size of @a buffer, in bytes */
+    size_t bufsize;
+
+    /** Buffered output. This is either @a default_buffer, or a caller-supplied buffer. */
+    char *buffer;
+
+    /** If true, @a buffer is a shared file mapping of @a fd (or caller-supplied memory, if @a fd is -1), and buffered
+     * data is never explicitly written. */
+    bool mapped;
+
+    /** The number of write(2) and lseek(2) system calls issued for this file. */
+    uint32_t syscall_count;
+
+    /** The total time spent in write(2) system calls, in mach_absolute_time() units. */
+    uint64_t write_time;
+
+    /** If true, a CRC-32C checksum is maintained over all output written since plcrash_async_file_checksum_begin(). */
+    bool checksum_enabled;
+
+    /** False if the checksum could not be maintained, eg, because flushed output could not be read back prior to
+     * being patched. */
+    bool checksum_valid;
+
+    /** The output position from which the checksum is computed. */
+    off_t checksum_start;
+
+    /** The checksum of all output written via plcrash_async_file_write(), excluding any patches. */
+    uint32_t checksum;
+
+    /** The accumulated checksum delta of all patches applied via plcrash_async_file_pwrite(), relative to
+     * @a checksum_delta_position. */
+    uint32_t checksum_delta;
+
+    /** The output position to which @a checksum_delta has been advanced. */
+    off_t checksum_delta_position;
+
+    /** Default buffer storage, used if no buffer is supplied */
+    char default_buffer[PLCRASH_ASYNC_FILE_DEFAULT_BUFFER_SIZE];
 } plcrash_async_file_t;
 
 
+struct plcrash_async_lz4_state;
+
 void plcrash_async_file_init (plcrash_async_file_t *file, int fd, off_t output_limit);
+void plcrash_async_file_init_buffer (plcrash_async_file_t *file, int fd, off_t output_limit, void *buffer, size_t bufsize);
+void plcrash_async_file_init_mapped (plcrash_async_file_t *file, int fd, void *mapping, size_t size);
+void plcrash_async_file_init_memory (plcrash_async_file_t *file, void *buffer, size_t size);
 bool plcrash_async_file_write (plcrash_async_file_t *file, const void *data, size_t len);
+off_t plcrash_async_file_tell (plcrash_async_file_t *file);
+bool plcrash_async_file_pwrite (plcrash_async_file_t *file, off_t offset, const void *data, size_t len);
+void plcrash_async_file_checksum_begin (plcrash_async_file_t *file);
+bool plcrash_async_file_checksum (plcrash_async_file_t *file, uint32_t *checksum);
+bool plcrash_async_file_compress (plcrash_async_file_t *file, off_t offset, struct plcrash_async_lz4_state *state, void *scratch, size_t scratch_size);
 bool plcrash_async_file_flush (plcrash_async_file_t *file);
 bool plcrash_async_file_close (plcrash_async_file_t *file);
     
@@ -32,7 +32,7 @@
 #include <libkern/OSAtomic.h>
 
 /* These assume 16-byte malloc() alignment, which is true for just about everything */
-#if defined(__arm__) || defined(__i386__) || defined(__x86_64__)
+#if defined(__arm__) || defined(__arm64__) || defined(__i386__) || defined(__x86_64__)
 #define PL_NATURAL_ALIGNMENT 16
 #else
 #error Define required alignment
@@ -42,6 +42,33 @@
 #define PL_ROUNDDOWN_ALIGN(x)   ((x) & (~(PL_NATURAL_ALIGNMENT - 1)))
 #define PL_ROUNDUP_ALIGN(x)     PL_ROUNDDOWN_ALIGN((x) + (PL_NATURAL_ALIGNMENT - 1))
 
+/** The smallest allocation size class, in bytes. */
+#define PL_ALLOCATOR_MIN_CLASS_SIZE PL_NATURAL_ALIGNMENT
+
+/** The number of allocation size classes. Classes are powers of two, from PL_ALLOCATOR_MIN_CLASS_SIZE to 4096 bytes. */
+#define PL_ALLOCATOR_CLASS_COUNT 9
+
+/** The size class assigned to allocations larger than the largest size class. These are never reclaimed. */
+#define PL_ALLOCATOR_CLASS_LARGE UINT32_MAX
+
+/**
+ * @internal
+ * Allocation header, placed immediately prior to each allocation's user-visible address. The header is never
+ * exposed to the user, allowing the free list linkage to be stored here without being overwritten by user
+ * data after allocation.
+ */
+typedef struct plcrash_async_allocator_block {
+    /** The block's size class index, or PL_ALLOCATOR_CLASS_LARGE. */
+    uint32_t size_class;
+
+    /** If the block is free, the offset from the allocator's usable_page of the next free block in this size class,
+     * or 0 if this is the last free block. */
+    uint32_t next;
+
+    /** Padding required to maintain natural alignment of the user allocation. */
+    uint8_t _reserved[PL_NATURAL_ALIGNMENT - (sizeof(uint32_t) * 2)];
+} plcrash_async_allocator_block_t;
+
 /**
  * @internal
  * An async-safe page-guarded and locking memory pool allocator. The allocator
@@ -66,6 +93,11 @@ struct plcrash_async_allocator {
 
     /** PLCrashAsyncAllocatorOptions used when creating the allocator. */
     uint32_t options;
+
+    /** Per-size-class free lists. Each entry packs the usable_page-relative offset of the first free block's header
+     * in the low 32 bits (or 0 if the list is empty), and a modification count in the high 32 bits; the count is
+     * incremented on every update to prevent ABA races between concurrent allocations and frees. */
+    volatile int64_t free_lists[PL_ALLOCATOR_CLASS_COUNT];
 };
 
 /**
@@ -88,7 +120,10 @@ plcrash_error_t plcrash_async_allocator_new (plcrash_async_allocator_t **allocat
     alloc.total_size = round_page(size + sizeof(plcrash_async_allocator_t));
     alloc.usable_size = alloc.total_size;
     alloc.options = options;
-    fprintf(stderr, "allocated: %lu\n", (unsigned long) alloc.usable_size);
+    memset((void *) alloc.free_lists, 0, sizeof(alloc.free_lists));
+
+    /* Free list entries are stored as 32-bit offsets */
+    PLCF_ASSERT(alloc.usable_size <= UINT32_MAX);
 
     /* Adjust total size to account for guard pages */
     if (options & PLCrashAsyncGuardLowPage)
@@ -146,14 +181,52 @@ plcrash_error_t plcrash_async_allocator_new (plcrash_async_allocator_t **allocat
 }
 
 /**
- * Allocate @a size bytes from @a allocator. If insufficient space is available, an assertion will be thrown
- * unless @a no_assert is true, in which case NULL will be returned.
+ * Release @a allocator's memory pool. All memory allocated from @a allocator is invalidated.
+ *
+ * @param allocator The allocator to be released.
+ *
+ * @warning This function is not async safe.
+ */
+void plcrash_async_allocator_delete (plcrash_async_allocator_t *allocator) {
+    /* The allocator structure resides within the pool itself */
+    vm_address_t base_page = allocator->base_page;
+    vm_size_t total_size = allocator->total_size;
+
+    kern_return_t kt = vm_deallocate(mach_task_self(), base_page, total_size);
+    if (kt != KERN_SUCCESS)
+        PLCF_DEBUG("vm_deallocate() failure: %d", kt);
+}
+
+/**
+ * Pre-fault and wire @a allocator's memory pool, excluding its guard pages, such that crash-time allocations
+ * do not incur page-fault latency. The pages remain wired until the allocator is deleted.
+ *
+ * @param allocator The allocator to be wired.
+ * @param wired_size On return, the number of bytes wired. May be NULL.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the pool could not be wired; the pool's pages
+ * will still have been faulted in.
+ *
+ * @warning This function is not async safe, and must not be called concurrently with allocation from the pool.
+ */
+plcrash_error_t plcrash_async_allocator_wire (plcrash_async_allocator_t *allocator, size_t *wired_size) {
+    plcrash_error_t err = plcrash_nasync_mem_wire((void *) allocator->usable_page, allocator->usable_size);
+    if (wired_size != NULL)
+        *wired_size = (err == PLCRASH_ESUCCESS) ? allocator->usable_size : 0;
+    return err;
+}
+
+/**
+ * @internal
+ *
+ * Allocate @a size bytes from @a allocator's unallocated space. If insufficient space is available, an assertion will
+ * be thrown unless @a no_assert is true, in which case NULL will be returned.
  *
  * @param allocator The allocator from which pages should be allocated
  * @param size The amount of memory to allocate, in bytes.
  * @param no_assert If true, NULL will be returned if insufficient space is available.
  */
-void *plcrash_async_allocator_alloc (plcrash_async_allocator_t *allocator, size_t size, bool no_assert) {
+static void *plcrash_async_allocator_bump (plcrash_async_allocator_t *allocator, size_t size, bool no_assert) {
     vm_address_t old_value;
     vm_address_t new_value;
 
@@ -174,3 +247,193 @@ void *plcrash_async_allocator_alloc (plcrash_async_allocator_t *allocator, size_
 
     return (void *) old_value;
 }
+
+/**
+ * @internal
+ *
+ * Return the size class index for an allocation of @a size bytes, or PL_ALLOCATOR_CLASS_LARGE if @a size exceeds
+ * the largest size class.
+ */
+static uint32_t plcrash_async_allocator_size_class (size_t size) {
+    size_t class_size = PL_ALLOCATOR_MIN_CLASS_SIZE;
+    for (uint32_t i = 0; i < PL_ALLOCATOR_CLASS_COUNT; i++) {
+        if (size <= class_size)
+            return i;
+        class_size <<= 1;
+    }
+
+    return PL_ALLOCATOR_CLASS_LARGE;
+}
+
+/**
+ * Allocate @a size bytes from @a allocator. If insufficient space is available, an assertion will be thrown
+ * unless @a no_assert is true, in which case NULL will be returned.
+ *
+ * Allocations are rounded up to a power-of-two size class, and are satisfied from the free list of blocks
+ * previously released via plcrash_async_allocator_free() when possible. Allocations larger than the largest size
+ * class (4096 bytes) are never reclaimed.
+ *
+ * @param allocator The allocator from which pages should be allocated
+ * @param size The amount of memory to allocate, in bytes.
+ * @param no_assert If true, NULL will be returned if insufficient space is available.
+ *
+ * @note This function is async-safe and lock-free, and may be called concurrently with itself and with
+ * plcrash_async_allocator_free().
+ */
+void *plcrash_async_allocator_alloc (plcrash_async_allocator_t *allocator, size_t size, bool no_assert) {
+    uint32_t size_class = plcrash_async_allocator_size_class(size);
+    plcrash_async_allocator_block_t *block;
+
+    /* Try to pop a free block of the requested class */
+    if (size_class != PL_ALLOCATOR_CLASS_LARGE) {
+        volatile int64_t *list = &allocator->free_lists[size_class];
+        int64_t head;
+        while ((uint32_t) (head = *list) != 0) {
+            block = (plcrash_async_allocator_block_t *) (allocator->usable_page + (uint32_t) head);
+
+            /* The block's next value may be stale if the block was concurrently popped; in that case, the
+             * modification count will have changed and the swap will fail. */
+            int64_t new_head = (int64_t) ((((uint64_t) head >> 32) + 1) << 32) | block->next;
+            if (OSAtomicCompareAndSwap64Barrier(head, new_head, list))
+                return block + 1;
+        }
+    }
+
+    /* Otherwise, allocate a new block */
+    size_t block_size = size;
+    if (size_class != PL_ALLOCATOR_CLASS_LARGE)
+        block_size = (size_t) PL_ALLOCATOR_MIN_CLASS_SIZE << size_class;
+
+    PLCF_ASSERT(SIZE_MAX - block_size > sizeof(*block));
+    block = plcrash_async_allocator_bump(allocator, sizeof(*block) + block_size, no_assert);
+    if (block == NULL)
+        return NULL;
+
+    block->size_class = size_class;
+    block->next = 0;
+    return block + 1;
+}
+
+/**
+ * Release an allocation previously returned by plcrash_async_allocator_alloc(), making it available to future
+ * allocations of the same size class. Allocations larger than the largest size class are not reclaimed.
+ *
+ * @param allocator The allocator from which @a ptr was allocated.
+ * @param ptr The allocation to be released. If NULL, no action will be taken.
+ *
+ * @note This function is async-safe and lock-free, and may be called concurrently with itself and with
+ * plcrash_async_allocator_alloc().
+ */
+void plcrash_async_allocator_free (plcrash_async_allocator_t *allocator, void *ptr) {
+    if (ptr == NULL)
+        return;
+
+    plcrash_async_allocator_block_t *block = ((plcrash_async_allocator_block_t *) ptr) - 1;
+    PLCF_ASSERT((vm_address_t) block >= allocator->usable_page && (vm_address_t) block < allocator->next_addr);
+
+    if (block->size_class == PL_ALLOCATOR_CLASS_LARGE)
+        return;
+
+    PLCF_ASSERT(block->size_class < PL_ALLOCATOR_CLASS_COUNT);
+    volatile int64_t *list = &allocator->free_lists[block->size_class];
+    uint32_t offset = (uint32_t) ((vm_address_t) block - allocator->usable_page);
+    int64_t head;
+    int64_t new_head;
+
+    do {
+        head = *list;
+        block->next = (uint32_t) head;
+        new_head = (int64_t) ((((uint64_t) head >> 32) + 1) << 32) | offset;
+    } while (!OSAtomicCompareAndSwap64Barrier(head, new_head, list));
+}
+
+/**
+ * Record the current position of @a allocator in @a mark. A subsequent call to plcrash_async_allocator_reset()
+ * will release all allocations made after the mark was recorded.
+ *
+ * @param allocator The allocator to be marked.
+ * @param mark[out] The mark to be initialized.
+ */
+void plcrash_async_allocator_mark (plcrash_async_allocator_t *allocator, plcrash_async_allocator_mark_t *mark) {
+    mark->next_addr = allocator->next_addr;
+}
+
+/**
+ * Release all allocations made from @a allocator since @a mark was recorded, returning the allocator's unallocated
+ * space to its size at the time of the mark. Freed blocks that were allocated prior to the mark remain available for
+ * reuse; any frees of such blocks that occur after the mark are preserved.
+ *
+ * The cost of a reset is proportional to the number of free blocks, rather than to the number of allocations
+ * made since the mark.
+ *
+ * @param allocator The allocator to be reset.
+ * @param mark A mark previously recorded for @a allocator via plcrash_async_allocator_mark(). Resetting to a mark
+ * that precedes a more recent reset is not supported.
+ *
+ * @warning This function is async-safe, but must not be called concurrently with any other use of @a allocator,
+ * and any allocations made since @a mark must no longer be referenced.
+ */
+void plcrash_async_allocator_reset (plcrash_async_allocator_t *allocator, const plcrash_async_allocator_mark_t *mark) {
+    PLCF_ASSERT(mark->next_addr >= allocator->usable_page && mark->next_addr <= allocator->next_addr);
+
+    /* Drop any free blocks that lie within the released range */
+    for (uint32_t i = 0; i < PL_ALLOCATOR_CLASS_COUNT; i++) {
+        int64_t head = allocator->free_lists[i];
+        uint32_t first = 0;
+        plcrash_async_allocator_block_t *last = NULL;
+
+        for (uint32_t offset = (uint32_t) head; offset != 0;) {
+            plcrash_async_allocator_block_t *block = (plcrash_async_allocator_block_t *) (allocator->usable_page + offset);
+            uint32_t next = block->next;
+
+            if ((vm_address_t) block < mark->next_addr) {
+                if (last == NULL) {
+                    first = offset;
+                } else {
+                    last->next = offset;
+                }
+                last = block;
+            }
+
+            offset = next;
+        }
+
+        if (last != NULL)
+            last->next = 0;
+
+        allocator->free_lists[i] = (int64_t) ((((uint64_t) head >> 32) + 1) << 32) | first;
+    }
+
+    /* Release the bump allocated space */
+    allocator->next_addr = mark->next_addr;
+    OSMemoryBarrier();
+}
+
+/**
+ * Fetch the usable region of @a allocator's memory pool, excluding its guard pages.
+ *
+ * @param allocator The allocator to be queried.
+ * @param base[out] On return, the base address of the usable region.
+ * @param size[out] On return, the size of the usable region, in bytes.
+ *
+ * @warning This function is async-safe.
+ */
+void plcrash_async_allocator_get_region (plcrash_async_allocator_t *allocator, void **base, size_t *size) {
+    *base = (void *) allocator->usable_page;
+    *size = allocator->usable_size;
+}
+
+/**
+ * Fetch the usage of @a allocator.
+ *
+ * @param allocator The allocator to be queried.
+ * @param reserved[out] On return, the allocator's usable size, in bytes.
+ * @param used[out] On return, the number of bytes below the allocator's bump allocation position. Freed blocks
+ * remain counted, as they are only available for reuse by the allocator itself.
+ *
+ * @warning This function is async-safe.
+ */
+void plcrash_async_allocator_get_usage (plcrash_async_allocator_t *allocator, size_t *reserved, size_t *used) {
+    *reserved = allocator->usable_size;
+    *used = allocator->next_addr - allocator->usable_page;
+}
@@ -67,8 +67,26 @@ typedef enum {
 
 typedef struct plcrash_async_allocator plcrash_async_allocator_t;
 
+/**
+ * An allocator position recorded by plcrash_async_allocator_mark(). All allocations made after the mark was
+ * recorded may be released in a single operation via plcrash_async_allocator_reset().
+ */
+typedef struct plcrash_async_allocator_mark {
+    /** The allocator's next bump allocation address at the time the mark was recorded. */
+    vm_address_t next_addr;
+} plcrash_async_allocator_mark_t;
+
 plcrash_error_t plcrash_async_allocator_new (plcrash_async_allocator_t **allocator, size_t size, uint32_t options);
+void plcrash_async_allocator_delete (plcrash_async_allocator_t *allocator);
+plcrash_error_t plcrash_async_allocator_wire (plcrash_async_allocator_t *allocator, size_t *wired_size);
 void *plcrash_async_allocator_alloc (plcrash_async_allocator_t *allocator, size_t size, bool no_assert);
+void plcrash_async_allocator_free (plcrash_async_allocator_t *allocator, void *ptr);
+
+void plcrash_async_allocator_mark (plcrash_async_allocator_t *allocator, plcrash_async_allocator_mark_t *mark);
+void plcrash_async_allocator_reset (plcrash_async_allocator_t *allocator, const plcrash_async_allocator_mark_t *mark);
+
+void plcrash_async_allocator_get_region (plcrash_async_allocator_t *allocator, void **base, size_t *size);
+void plcrash_async_allocator_get_usage (plcrash_async_allocator_t *allocator, size_t *reserved, size_t *used);
 
 /**
  * @}
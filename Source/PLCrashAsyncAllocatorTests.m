@@ -53,4 +53,140 @@
     // XXX missing free();
 }
 
+/**
+ * Test reuse of freed allocations.
+ */
+- (void) testFree {
+    plcrash_async_allocator_t *alloc;
+    plcrash_error_t err;
+    
+    err = plcrash_async_allocator_new(&alloc, PAGE_SIZE * 4, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize allocator");
+
+    /* A freed block should be reused by an allocation of the same size class */
+    void *first = plcrash_async_allocator_alloc(alloc, 24, true);
+    STAssertNotNULL(first, @"Failed to allocate");
+    plcrash_async_allocator_free(alloc, first);
+
+    void *reused = plcrash_async_allocator_alloc(alloc, 32, true);
+    STAssertEquals(first, reused, @"Freed block was not reused");
+
+    /* ... but not by an allocation of a different size class */
+    plcrash_async_allocator_free(alloc, reused);
+    void *other = plcrash_async_allocator_alloc(alloc, 64, true);
+    STAssertNotNULL(other, @"Failed to allocate");
+    STAssertNotEquals(first, other, @"Freed block was reused for a larger size class");
+
+    /* Blocks are released in LIFO order */
+    void *a = plcrash_async_allocator_alloc(alloc, 128, true);
+    void *b = plcrash_async_allocator_alloc(alloc, 128, true);
+    plcrash_async_allocator_free(alloc, a);
+    plcrash_async_allocator_free(alloc, b);
+    STAssertEquals(plcrash_async_allocator_alloc(alloc, 128, true), b, @"Unexpected free list order");
+    STAssertEquals(plcrash_async_allocator_alloc(alloc, 128, true), a, @"Unexpected free list order");
+
+    /* Repeated allocation and release must not exhaust the allocator */
+    for (size_t i = 0; i < 1000; i++) {
+        void *buffer = plcrash_async_allocator_alloc(alloc, 512, true);
+        STAssertNotNULL(buffer, @"Failed to allocate on iteration %zu", i);
+        plcrash_async_allocator_free(alloc, buffer);
+    }
+
+    /* Releasing NULL is a no-op */
+    plcrash_async_allocator_free(alloc, NULL);
+}
+
+/**
+ * Test releasing allocations via mark/reset.
+ */
+- (void) testMarkReset {
+    plcrash_async_allocator_t *alloc;
+    plcrash_async_allocator_mark_t mark;
+    plcrash_error_t err;
+
+    err = plcrash_async_allocator_new(&alloc, PAGE_SIZE * 4, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize allocator");
+
+    void *before = plcrash_async_allocator_alloc(alloc, 64, true);
+    STAssertNotNULL(before, @"Failed to allocate");
+
+    plcrash_async_allocator_mark(alloc, &mark);
+    void *after = plcrash_async_allocator_alloc(alloc, 64, true);
+    STAssertNotNULL(after, @"Failed to allocate");
+    STAssertNotNULL(plcrash_async_allocator_alloc(alloc, PAGE_SIZE, true), @"Failed to allocate");
+
+    /* Free both blocks; only the block allocated prior to the mark should survive the reset */
+    plcrash_async_allocator_free(alloc, before);
+    plcrash_async_allocator_free(alloc, after);
+    plcrash_async_allocator_reset(alloc, &mark);
+
+    STAssertEquals(plcrash_async_allocator_alloc(alloc, 64, true), before, @"Pre-mark free block was not preserved");
+    STAssertEquals(plcrash_async_allocator_alloc(alloc, 64, true), after, @"Released space was not reused");
+
+    /* Repeated mark/reset cycles must not exhaust the allocator */
+    for (size_t i = 0; i < 100; i++) {
+        plcrash_async_allocator_mark(alloc, &mark);
+        STAssertNotNULL(plcrash_async_allocator_alloc(alloc, PAGE_SIZE * 2, true), @"Failed to allocate on iteration %zu", i);
+        plcrash_async_allocator_reset(alloc, &mark);
+    }
+}
+
+/**
+ * Test fetching allocator usage.
+ */
+- (void) testUsage {
+    plcrash_async_allocator_t *alloc;
+    plcrash_async_allocator_mark_t mark;
+    size_t reserved, used;
+    plcrash_error_t err;
+
+    err = plcrash_async_allocator_new(&alloc, PAGE_SIZE * 4, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize allocator");
+
+    plcrash_async_allocator_get_usage(alloc, &reserved, &used);
+    STAssertTrue(reserved >= PAGE_SIZE * 4, @"Reserved size is smaller than requested");
+    size_t initial = used;
+
+    plcrash_async_allocator_mark(alloc, &mark);
+    STAssertNotNULL(plcrash_async_allocator_alloc(alloc, PAGE_SIZE, true), @"Failed to allocate");
+    plcrash_async_allocator_get_usage(alloc, &reserved, &used);
+    STAssertTrue(used >= initial + PAGE_SIZE, @"Allocation was not counted");
+
+    plcrash_async_allocator_reset(alloc, &mark);
+    plcrash_async_allocator_get_usage(alloc, &reserved, &used);
+    STAssertEquals(used, initial, @"Reset allocation was still counted");
+}
+
+/**
+ * Test pre-faulting and wiring the allocator's pool.
+ */
+- (void) testWire {
+    plcrash_async_allocator_t *alloc;
+    size_t reserved, used, wired;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_allocator_new(&alloc, PAGE_SIZE * 4, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage), @"Failed to initialize allocator");
+
+    /* Existing allocations must be preserved */
+    uint8_t *buf = plcrash_async_allocator_alloc(alloc, PAGE_SIZE, true);
+    STAssertNotNULL(buf, @"Failed to allocate");
+    memset(buf, 0xAB, PAGE_SIZE);
+
+    /* Wiring may fail if the wired memory limit has been reached; the pages must be faulted in regardless */
+    if (plcrash_async_allocator_wire(alloc, &wired) == PLCRASH_ESUCCESS) {
+        plcrash_async_allocator_get_usage(alloc, &reserved, &used);
+        STAssertTrue(wired >= reserved, @"Wired size %zu does not cover the pool size %zu", wired, reserved);
+    } else {
+        STAssertEquals(wired, (size_t) 0, @"Wired size reported on failure");
+    }
+
+    for (size_t i = 0; i < PAGE_SIZE; i++) {
+        if (buf[i] != 0xAB) {
+            STFail(@"Allocation was modified at offset %zu", i);
+            break;
+        }
+    }
+
+    plcrash_async_allocator_delete(alloc);
+}
+
 @end
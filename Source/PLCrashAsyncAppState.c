@@ -0,0 +1,311 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashAsyncAppState.h"
+
+#import <fcntl.h>
+#import <unistd.h>
+#import <errno.h>
+#import <string.h>
+#import <time.h>
+#import <sys/mman.h>
+#import <mach/mach.h>
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_app_state App State Journal
+ *
+ * Implements a small, memory mapped journal of the application's state. Jetsam (out-of-memory) and watchdog
+ * terminations are delivered via SIGKILL, and can not be observed by the signal or Mach exception handlers; by
+ * recording whether the application was in the foreground, whether its main thread was hung, its most recent memory
+ * footprint, and whether it exited cleanly or with a crash report, the probable cause of such a termination can be
+ * inferred on the next launch.
+ *
+ * The journal is updated with plain stores to the mapped record, without any system calls, and may be updated from
+ * any context, including a signal handler. The record's dirty page is written back to the journal file by the kernel
+ * after the process has exited.
+ *
+ * @{
+ */
+
+/* Copy the NUL-terminated @a src to @a dest, truncating to @a size bytes, including the NUL. */
+static void plcrash_app_state_strlcpy (char *dest, const char *src, size_t size) {
+    size_t i = 0;
+    if (src != NULL) {
+        for (; i + 1 < size && src[i] != '\0'; i++)
+            dest[i] = src[i];
+    }
+    dest[i] = '\0';
+}
+
+/**
+ * Open (or create) the app state journal at @a path, returning the record left by the previous session, if any. The
+ * journal is then reset to describe the current session, which is assumed to be in the foreground.
+ *
+ * @param state The state instance to initialize.
+ * @param path The journal file path.
+ * @param app_version The current application version. May be NULL.
+ * @param os_build The current OS build. May be NULL.
+ * @param boot_time The system boot time, in seconds since the epoch, or 0 if unknown.
+ * @param traced True if a debugger is attached to the current process.
+ * @param previous On return, the previous session's record, if @a has_previous is set to true.
+ * @param has_previous On return, set to true if a valid record was left by a previous session.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate error if the journal could not be opened or mapped.
+ * If an error is returned, @a state must not be used.
+ */
+plcrash_error_t plcrash_nasync_app_state_open (plcrash_async_app_state_t *state,
+                                               const char *path,
+                                               const char *app_version,
+                                               const char *os_build,
+                                               int64_t boot_time,
+                                               bool traced,
+                                               plcrash_async_app_state_record_t *previous,
+                                               bool *has_previous)
+{
+    const size_t length = sizeof(plcrash_async_app_state_record_t);
+
+    *has_previous = false;
+
+    state->fd = open(path, O_RDWR|O_CREAT, 0644);
+    if (state->fd < 0) {
+        PLCF_DEBUG("Could not open the app state journal %s: %s", path, strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Fetch the previous session's record */
+    if (pread(state->fd, previous, length, 0) == (ssize_t) length && previous->magic == PLCRASH_ASYNC_APP_STATE_MAGIC &&
+        previous->version == PLCRASH_ASYNC_APP_STATE_VERSION)
+    {
+        previous->app_version[sizeof(previous->app_version) - 1] = '\0';
+        previous->os_build[sizeof(previous->os_build) - 1] = '\0';
+        *has_previous = true;
+    }
+
+    /* Size and map the journal */
+    if (ftruncate(state->fd, length) != 0) {
+        PLCF_DEBUG("Could not size the app state journal: %s", strerror(errno));
+        close(state->fd);
+        return PLCRASH_EINTERNAL;
+    }
+
+    void *mapping = mmap(NULL, length, PROT_READ|PROT_WRITE, MAP_SHARED, state->fd, 0);
+    if (mapping == MAP_FAILED) {
+        PLCF_DEBUG("Could not map the app state journal: %s", strerror(errno));
+        close(state->fd);
+        return PLCRASH_EINTERNAL;
+    }
+    state->record = mapping;
+
+    /* Reset the record for the current session. The magic value is written last, such that a session terminated
+     * while the record is being reset will not leave a valid record behind. */
+    plcrash_async_app_state_record_t *record = state->record;
+    record->magic = 0;
+    OSMemoryBarrier();
+
+    plcrash_async_memset(record, 0, length);
+    record->version = PLCRASH_ASYNC_APP_STATE_VERSION;
+    record->pid = getpid();
+    record->traced = traced ? 1 : 0;
+    record->launch_time = time(NULL);
+    record->boot_time = boot_time;
+    plcrash_app_state_strlcpy(record->app_version, app_version, sizeof(record->app_version));
+    plcrash_app_state_strlcpy(record->os_build, os_build, sizeof(record->os_build));
+    record->foreground = 1;
+
+    OSMemoryBarrier();
+    record->magic = PLCRASH_ASYNC_APP_STATE_MAGIC;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Unmap and close the journal. The journal file is left in place, and will be read by the next session.
+ *
+ * @param state The journal to close.
+ */
+void plcrash_nasync_app_state_close (plcrash_async_app_state_t *state) {
+    munmap(state->record, sizeof(*state->record));
+    close(state->fd);
+    state->record = NULL;
+    state->fd = -1;
+}
+
+/**
+ * Infer the probable cause of the termination of the session that wrote @a previous.
+ *
+ * Sessions that exited cleanly, or that wrote a crash report, require no further explanation. Sessions that ended
+ * in an application update, an OS update or a reboot, or while a debugger was attached, are assumed to have been
+ * terminated for those reasons. Any other session was killed by SIGKILL; if its main thread was hung, the system
+ * watchdog is the most likely cause, and otherwise, a foreground termination is most likely to have been a jetsam
+ * memory limit kill.
+ *
+ * @param previous The previous session's record.
+ * @param current The current session's record.
+ */
+plcrash_async_app_state_termination_t plcrash_async_app_state_infer_termination (const plcrash_async_app_state_record_t *previous,
+                                                                                 const plcrash_async_app_state_record_t *current)
+{
+    if (previous->clean_exit || previous->crashed)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE;
+
+    if (previous->traced)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE;
+
+    if (strncmp(previous->app_version, current->app_version, sizeof(previous->app_version)) != 0)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE;
+
+    if (strncmp(previous->os_build, current->os_build, sizeof(previous->os_build)) != 0)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE;
+
+    if (previous->boot_time != 0 && current->boot_time != 0 && previous->boot_time != current->boot_time)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE;
+
+    if (previous->in_hang)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_WATCHDOG;
+
+    if (previous->foreground)
+        return PLCRASH_ASYNC_APP_STATE_TERMINATION_OOM;
+
+    return PLCRASH_ASYNC_APP_STATE_TERMINATION_BACKGROUND;
+}
+
+/**
+ * Record whether the application is in the foreground. Entering the foreground clears any recorded memory warning.
+ *
+ * @param state The journal.
+ * @param foreground True if the application is in the foreground.
+ *
+ * @par Async Safety
+ * This function may be called from any context.
+ */
+void plcrash_async_app_state_set_foreground (plcrash_async_app_state_t *state, bool foreground) {
+    if (foreground)
+        state->record->memory_warning = 0;
+    state->record->foreground = foreground ? 1 : 0;
+}
+
+/**
+ * Record whether the main thread is hung.
+ *
+ * @param state The journal.
+ * @param in_hang True if the main thread is hung.
+ *
+ * @par Async Safety
+ * This function may be called from any context.
+ */
+void plcrash_async_app_state_set_hang (plcrash_async_app_state_t *state, bool in_hang) {
+    state->record->in_hang = in_hang ? 1 : 0;
+}
+
+/**
+ * Record receipt of a low memory warning.
+ *
+ * @param state The journal.
+ *
+ * @par Async Safety
+ * This function may be called from any context.
+ */
+void plcrash_async_app_state_set_memory_warning (plcrash_async_app_state_t *state) {
+    state->record->memory_warning = 1;
+}
+
+/**
+ * Record a memory footprint sample.
+ *
+ * @param state The journal.
+ * @param footprint The physical footprint, in bytes.
+ * @param timestamp The time at which the footprint was sampled, in seconds since the epoch.
+ *
+ * @par Async Safety
+ * This function may be called from any context. The footprint and timestamp are written independently; a reader
+ * that races with the update may observe a mismatched pair.
+ */
+void plcrash_async_app_state_set_footprint (plcrash_async_app_state_t *state, uint64_t footprint, int64_t timestamp) {
+    state->record->footprint = footprint;
+    state->record->footprint_time = timestamp;
+}
+
+/**
+ * Record that the session is exiting normally.
+ *
+ * @param state The journal.
+ *
+ * @par Async Safety
+ * This function may be called from any context.
+ */
+void plcrash_async_app_state_set_clean_exit (plcrash_async_app_state_t *state) {
+    state->record->clean_exit = 1;
+}
+
+/**
+ * Record that a fatal crash report is being written.
+ *
+ * @param state The journal.
+ *
+ * @par Async Safety
+ * This function may be called from any context.
+ */
+void plcrash_async_app_state_set_crashed (plcrash_async_app_state_t *state) {
+    state->record->crashed = 1;
+}
+
+/**
+ * Sample the current task's physical footprint, and record it in @a state. If the physical footprint is unavailable,
+ * the resident size is recorded instead.
+ *
+ * @param state The journal.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINTERNAL if the task's memory statistics could not be
+ * fetched.
+ */
+plcrash_error_t plcrash_nasync_app_state_sample_footprint (plcrash_async_app_state_t *state) {
+#ifdef TASK_VM_INFO
+    task_vm_info_data_t vm_info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(mach_task_self(), TASK_VM_INFO, (task_info_t) &vm_info, &count) != KERN_SUCCESS)
+        return PLCRASH_EINTERNAL;
+
+    uint64_t footprint = vm_info.resident_size;
+#ifdef TASK_VM_INFO_REV1_COUNT
+    /* Older kernels return the shorter, revision 0 structure */
+    if (count >= TASK_VM_INFO_REV1_COUNT)
+        footprint = vm_info.phys_footprint;
+#endif
+
+    plcrash_async_app_state_set_footprint(state, footprint, time(NULL));
+    return PLCRASH_ESUCCESS;
+#else
+    return PLCRASH_ENOTSUP;
+#endif
+}
+
+/**
+ * @} plcrash_async_app_state
+ */
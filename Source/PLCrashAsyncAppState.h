@@ -0,0 +1,195 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef PLCRASH_ASYNC_APP_STATE_H
+#define PLCRASH_ASYNC_APP_STATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * The magic value identifying an app state journal ('plas').
+ */
+#define PLCRASH_ASYNC_APP_STATE_MAGIC 0x706c6173
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * The current app state journal format version. Journals written with any other version are ignored.
+ */
+#define PLCRASH_ASYNC_APP_STATE_VERSION 1
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * The maximum length of the application version recorded in the journal, including the trailing NUL.
+ */
+#define PLCRASH_ASYNC_APP_STATE_APP_VERSION_MAX 64
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * The maximum length of the OS build recorded in the journal, including the trailing NUL.
+ */
+#define PLCRASH_ASYNC_APP_STATE_OS_BUILD_MAX 32
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * The app state journal record. The record is memory mapped from the journal file, and is updated in place via plain
+ * word-sized stores; the kernel writes the dirty page back to the file after the process exits, however it exits.
+ *
+ * The layout is written verbatim to disk, and must only be changed alongside PLCRASH_ASYNC_APP_STATE_VERSION.
+ */
+typedef struct plcrash_async_app_state_record {
+    /** PLCRASH_ASYNC_APP_STATE_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_ASYNC_APP_STATE_VERSION. */
+    uint32_t version;
+
+    /** The process ID of the session that wrote the record. */
+    int32_t pid;
+
+    /** Non-zero if a debugger was attached when the session started. */
+    uint32_t traced;
+
+    /** The time at which the session started, in seconds since the epoch. */
+    int64_t launch_time;
+
+    /** The system boot time, in seconds since the epoch, used to identify sessions ended by a reboot. */
+    int64_t boot_time;
+
+    /** The NUL-terminated application version, used to identify sessions ended by an application update. */
+    char app_version[PLCRASH_ASYNC_APP_STATE_APP_VERSION_MAX];
+
+    /** The NUL-terminated OS build, used to identify sessions ended by an OS update. */
+    char os_build[PLCRASH_ASYNC_APP_STATE_OS_BUILD_MAX];
+
+    /** The most recently sampled physical footprint, in bytes, or 0 if never sampled. */
+    volatile uint64_t footprint;
+
+    /** The time at which @a footprint was sampled, in seconds since the epoch. */
+    volatile int64_t footprint_time;
+
+    /** Non-zero while the application is in the foreground. */
+    volatile uint32_t foreground;
+
+    /** Non-zero while the main thread is hung. */
+    volatile uint32_t in_hang;
+
+    /** Non-zero if a low memory warning has been received since the application last entered the foreground. */
+    volatile uint32_t memory_warning;
+
+    /** Non-zero if the session exited normally. */
+    volatile uint32_t clean_exit;
+
+    /** Non-zero if a fatal crash report was written during the session. */
+    volatile uint32_t crashed;
+
+    /** Reserved; always 0. */
+    uint32_t reserved;
+} plcrash_async_app_state_record_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * An open app state journal.
+ */
+typedef struct plcrash_async_app_state {
+    /** The journal file descriptor. */
+    int fd;
+
+    /** The mapped journal record. */
+    plcrash_async_app_state_record_t *record;
+} plcrash_async_app_state_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_app_state
+ *
+ * The probable cause of a session's termination, as inferred from its journal record.
+ */
+typedef enum plcrash_async_app_state_termination {
+    /** The session exited normally, crashed with a crash report, or was terminated for a known and benign reason,
+     * such as an application or OS update. */
+    PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE = 0,
+
+    /** The session was terminated while the main thread was hung, most likely by the system watchdog. */
+    PLCRASH_ASYNC_APP_STATE_TERMINATION_WATCHDOG = 1,
+
+    /** The session was terminated in the foreground without a crash report, most likely by the system for
+     * exceeding its memory limit. */
+    PLCRASH_ASYNC_APP_STATE_TERMINATION_OOM = 2,
+
+    /** The session was terminated in the background without a crash report. Background terminations are routine,
+     * and may be the result of memory pressure, or of the user quitting the application. */
+    PLCRASH_ASYNC_APP_STATE_TERMINATION_BACKGROUND = 3
+} plcrash_async_app_state_termination_t;
+
+plcrash_error_t plcrash_nasync_app_state_open (plcrash_async_app_state_t *state,
+                                               const char *path,
+                                               const char *app_version,
+                                               const char *os_build,
+                                               int64_t boot_time,
+                                               bool traced,
+                                               plcrash_async_app_state_record_t *previous,
+                                               bool *has_previous);
+void plcrash_nasync_app_state_close (plcrash_async_app_state_t *state);
+
+plcrash_async_app_state_termination_t plcrash_async_app_state_infer_termination (const plcrash_async_app_state_record_t *previous,
+                                                                                 const plcrash_async_app_state_record_t *current);
+
+void plcrash_async_app_state_set_foreground (plcrash_async_app_state_t *state, bool foreground);
+void plcrash_async_app_state_set_hang (plcrash_async_app_state_t *state, bool in_hang);
+void plcrash_async_app_state_set_memory_warning (plcrash_async_app_state_t *state);
+void plcrash_async_app_state_set_footprint (plcrash_async_app_state_t *state, uint64_t footprint, int64_t timestamp);
+void plcrash_async_app_state_set_clean_exit (plcrash_async_app_state_t *state);
+void plcrash_async_app_state_set_crashed (plcrash_async_app_state_t *state);
+
+plcrash_error_t plcrash_nasync_app_state_sample_footprint (plcrash_async_app_state_t *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_APP_STATE_H */
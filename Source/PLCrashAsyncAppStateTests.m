@@ -0,0 +1,170 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncAppState.h"
+
+@interface PLCrashAsyncAppStateTests : SenTestCase {
+@private
+    /** Journal path */
+    NSString *_path;
+}
+@end
+
+@implementation PLCrashAsyncAppStateTests
+
+- (void) setUp {
+    _path = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+}
+
+- (void) tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath: _path error: NULL];
+    [_path release];
+}
+
+/* Open the journal at _path with fixed session values */
+- (void) openState: (plcrash_async_app_state_t *) state previous: (plcrash_async_app_state_record_t *) previous hasPrevious: (bool *) hasPrevious {
+    plcrash_error_t err = plcrash_nasync_app_state_open(state, [_path fileSystemRepresentation], "1.0", "11A100", 1000, false, previous, hasPrevious);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to open the journal");
+}
+
+/**
+ * Verify that a new journal is initialized for the current session, and that its updates are visible to the
+ * next session.
+ */
+- (void) testReopen {
+    plcrash_async_app_state_t state;
+    plcrash_async_app_state_record_t previous;
+    bool hasPrevious;
+
+    [self openState: &state previous: &previous hasPrevious: &hasPrevious];
+    STAssertFalse(hasPrevious, @"A new journal should have no previous record");
+    STAssertEquals(state.record->pid, (int32_t) getpid(), @"Incorrect pid");
+    STAssertTrue(state.record->foreground != 0, @"Sessions should start in the foreground");
+    STAssertEqualCStrings(state.record->app_version, "1.0", @"Incorrect app version");
+
+    plcrash_async_app_state_set_foreground(&state, false);
+    plcrash_async_app_state_set_hang(&state, true);
+    plcrash_async_app_state_set_footprint(&state, 4096, 42);
+    plcrash_nasync_app_state_close(&state);
+
+    [self openState: &state previous: &previous hasPrevious: &hasPrevious];
+    STAssertTrue(hasPrevious, @"The previous record was not returned");
+    STAssertEquals(previous.foreground, (uint32_t) 0, @"Foreground state was not persisted");
+    STAssertEquals(previous.in_hang, (uint32_t) 1, @"Hang state was not persisted");
+    STAssertEquals(previous.footprint, (uint64_t) 4096, @"Footprint was not persisted");
+    STAssertEquals(previous.footprint_time, (int64_t) 42, @"Footprint time was not persisted");
+
+    /* The current session's record must have been reset */
+    STAssertEquals(state.record->in_hang, (uint32_t) 0, @"Record was not reset");
+    STAssertEquals(state.record->footprint, (uint64_t) 0, @"Record was not reset");
+    plcrash_nasync_app_state_close(&state);
+}
+
+/**
+ * Verify that an invalid journal is ignored.
+ */
+- (void) testInvalidJournal {
+    plcrash_async_app_state_t state;
+    plcrash_async_app_state_record_t previous;
+    bool hasPrevious;
+
+    [[NSData dataWithBytes: "garbage" length: 7] writeToFile: _path atomically: NO];
+
+    [self openState: &state previous: &previous hasPrevious: &hasPrevious];
+    STAssertFalse(hasPrevious, @"An invalid journal should not be returned");
+    STAssertEquals(state.record->magic, (uint32_t) PLCRASH_ASYNC_APP_STATE_MAGIC, @"Journal was not initialized");
+    plcrash_nasync_app_state_close(&state);
+}
+
+/**
+ * Verify the termination inference rules.
+ */
+- (void) testInferTermination {
+    plcrash_async_app_state_record_t previous;
+    plcrash_async_app_state_record_t current;
+
+    memset(&current, 0, sizeof(current));
+    strlcpy(current.app_version, "1.0", sizeof(current.app_version));
+    strlcpy(current.os_build, "11A100", sizeof(current.os_build));
+    current.boot_time = 1000;
+
+    /* Foreground termination */
+    previous = current;
+    previous.foreground = 1;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&previous, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_OOM, @"Expected OOM");
+
+    /* Background termination */
+    previous.foreground = 0;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&previous, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_BACKGROUND, @"Expected background");
+
+    /* Hung termination */
+    previous.in_hang = 1;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&previous, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_WATCHDOG, @"Expected watchdog");
+
+    /* Explained terminations */
+    plcrash_async_app_state_record_t explained = previous;
+    explained.crashed = 1;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&explained, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE, @"Crash should explain termination");
+
+    explained = previous;
+    explained.clean_exit = 1;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&explained, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE, @"Clean exit should explain termination");
+
+    explained = previous;
+    explained.traced = 1;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&explained, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE, @"Debugger should explain termination");
+
+    explained = previous;
+    strlcpy(explained.app_version, "0.9", sizeof(explained.app_version));
+    STAssertEquals(plcrash_async_app_state_infer_termination(&explained, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE, @"App update should explain termination");
+
+    explained = previous;
+    strlcpy(explained.os_build, "10A100", sizeof(explained.os_build));
+    STAssertEquals(plcrash_async_app_state_infer_termination(&explained, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE, @"OS update should explain termination");
+
+    explained = previous;
+    explained.boot_time = 500;
+    STAssertEquals(plcrash_async_app_state_infer_termination(&explained, &current), PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE, @"Reboot should explain termination");
+}
+
+/**
+ * Verify that the footprint may be sampled.
+ */
+- (void) testSampleFootprint {
+    plcrash_async_app_state_t state;
+    plcrash_async_app_state_record_t previous;
+    bool hasPrevious;
+
+    [self openState: &state previous: &previous hasPrevious: &hasPrevious];
+    STAssertEquals(plcrash_nasync_app_state_sample_footprint(&state), PLCRASH_ESUCCESS, @"Failed to sample footprint");
+    STAssertTrue(state.record->footprint > 0, @"Footprint was not recorded");
+    STAssertTrue(state.record->footprint_time > 0, @"Footprint time was not recorded");
+    plcrash_nasync_app_state_close(&state);
+}
+
+@end
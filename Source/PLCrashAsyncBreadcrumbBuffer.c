@@ -0,0 +1,152 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashAsyncBreadcrumbBuffer.h"
+
+#import <stdlib.h>
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_breadcrumb_buffer Breadcrumb Buffer
+ *
+ * Implements a pre-allocated, lock-free, multi-producer ring buffer of small fixed-size records, intended for
+ * application breadcrumbs that must survive a crash.
+ *
+ * Producers claim a slot with a single atomic increment of the buffer's sequence number, and publish the record by
+ * writing the slot's sequence number after the payload. No locks are taken, and no memory is allocated. At crash
+ * time, the slots are written to the report verbatim; records that were being written at the time of the crash
+ * are identified by a zero sequence number, and are discarded by the decoder.
+ *
+ * If producers lap the buffer faster than a single record can be written, a slot may be claimed by two producers
+ * at once; the decoder will then report whichever record was published last.
+ * @{
+ */
+
+/**
+ * Initialize @a buffer.
+ *
+ * @param buffer The buffer to initialize.
+ * @param capacity The number of records to be retained. Will be rounded up to a power of two, and must not exceed
+ * PLCRASH_ASYNC_BREADCRUMB_CAPACITY_MAX.
+ * @param record_size The maximum payload size of a record, in bytes. Must not exceed PLCRASH_ASYNC_BREADCRUMB_RECORD_MAX.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a capacity or @a record_size is zero or exceeds its
+ * maximum, or PLCRASH_ENOMEM if the record slots could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_breadcrumb_buffer_init (plcrash_async_breadcrumb_buffer_t *buffer, uint32_t capacity, uint32_t record_size) {
+    if (capacity == 0 || capacity > PLCRASH_ASYNC_BREADCRUMB_CAPACITY_MAX || record_size == 0 || record_size > PLCRASH_ASYNC_BREADCRUMB_RECORD_MAX)
+        return PLCRASH_EINVAL;
+
+    uint32_t slots = 1;
+    while (slots < capacity)
+        slots <<= 1;
+
+    buffer->sequence = 0;
+    buffer->capacity = slots;
+    buffer->record_size = record_size;
+    buffer->slot_size = (uint32_t) ((sizeof(plcrash_async_breadcrumb_header_t) + record_size + 7) & ~7);
+
+    /* Zero-filled slots are empty */
+    buffer->slots = calloc(buffer->capacity, buffer->slot_size);
+    if (buffer->slots == NULL) {
+        PLCF_DEBUG("Could not allocate %u breadcrumb slots", buffer->capacity);
+        return PLCRASH_ENOMEM;
+    }
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Append a record to @a buffer, replacing the oldest record if the buffer is full.
+ *
+ * @param buffer The buffer to which the record will be appended.
+ * @param data The record payload.
+ * @param length The length of @a data, in bytes. Payloads longer than the buffer's record size are truncated.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the record was appended in full, or PLCRASH_ENOMEM if the record was truncated.
+ *
+ * @par Async Safety
+ * This function is async-safe, lock-free, and may be called concurrently from any number of threads.
+ */
+plcrash_error_t plcrash_async_breadcrumb_buffer_append (plcrash_async_breadcrumb_buffer_t *buffer, const void *data, size_t length) {
+    plcrash_error_t err = PLCRASH_ESUCCESS;
+    if (length > buffer->record_size) {
+        length = buffer->record_size;
+        err = PLCRASH_ENOMEM;
+    }
+
+    /* Claim the next slot */
+    uint64_t sequence = (uint64_t) OSAtomicIncrement64Barrier(&buffer->sequence);
+    uint8_t *slot = buffer->slots + (size_t) ((sequence - 1) & (buffer->capacity - 1)) * buffer->slot_size;
+    volatile plcrash_async_breadcrumb_header_t *header = (volatile plcrash_async_breadcrumb_header_t *) slot;
+
+    /* Invalidate the slot while the payload is written, and then publish the record */
+    header->sequence = 0;
+    OSMemoryBarrier();
+
+    plcrash_async_memcpy(slot + sizeof(*header), data, length);
+    header->length = (uint32_t) length;
+    OSMemoryBarrier();
+
+    header->sequence = sequence;
+    return err;
+}
+
+/**
+ * Return the total size of @a buffer's record slots, in bytes.
+ *
+ * @param buffer The buffer.
+ */
+size_t plcrash_async_breadcrumb_buffer_length (const plcrash_async_breadcrumb_buffer_t *buffer) {
+    return (size_t) buffer->capacity * buffer->slot_size;
+}
+
+/**
+ * Free all resources associated with @a buffer.
+ *
+ * @param buffer The buffer to be freed.
+ *
+ * @warning This function is not async-safe, and must not be called while the buffer may be used by any producer,
+ * or by a crash report writer.
+ */
+void plcrash_nasync_breadcrumb_buffer_free (plcrash_async_breadcrumb_buffer_t *buffer) {
+    if (buffer->slots != NULL)
+        free(buffer->slots);
+    buffer->slots = NULL;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,105 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_BREADCRUMB_BUFFER_H
+#define PLCRASH_ASYNC_BREADCRUMB_BUFFER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_breadcrumb_buffer
+ *
+ * The maximum payload size of a single breadcrumb record.
+ */
+#define PLCRASH_ASYNC_BREADCRUMB_RECORD_MAX 1024
+
+/**
+ * @internal
+ * @ingroup plcrash_async_breadcrumb_buffer
+ *
+ * The maximum number of records that may be retained by a breadcrumb buffer.
+ */
+#define PLCRASH_ASYNC_BREADCRUMB_CAPACITY_MAX 65536
+
+/**
+ * @internal
+ * @ingroup plcrash_async_breadcrumb_buffer
+ *
+ * The header preceding each record slot's payload. The slot layout is written verbatim to crash reports
+ * (CrashReport.breadcrumbs), in host byte order, and must not be changed.
+ */
+typedef struct plcrash_async_breadcrumb_header {
+    /** The record's sequence number, starting at 1, or 0 if the slot is empty or its record is being written. */
+    uint64_t sequence;
+
+    /** The length of the record's payload, in bytes. */
+    uint32_t length;
+
+    /** Reserved; always 0. */
+    uint32_t reserved;
+} plcrash_async_breadcrumb_header_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_breadcrumb_buffer
+ *
+ * A pre-allocated, lock-free, multi-producer ring buffer of fixed-size records.
+ */
+typedef struct plcrash_async_breadcrumb_buffer {
+    /** The sequence number most recently claimed by a producer. */
+    volatile int64_t sequence;
+
+    /** The number of record slots. Always a power of two. */
+    uint32_t capacity;
+
+    /** The maximum payload size of a record, in bytes. */
+    uint32_t record_size;
+
+    /** The size of each slot, including its header, in bytes. A multiple of 8. */
+    uint32_t slot_size;
+
+    /** The record slots; @a capacity * @a slot_size bytes. */
+    uint8_t *slots;
+} plcrash_async_breadcrumb_buffer_t;
+
+plcrash_error_t plcrash_nasync_breadcrumb_buffer_init (plcrash_async_breadcrumb_buffer_t *buffer, uint32_t capacity, uint32_t record_size);
+plcrash_error_t plcrash_async_breadcrumb_buffer_append (plcrash_async_breadcrumb_buffer_t *buffer, const void *data, size_t length);
+size_t plcrash_async_breadcrumb_buffer_length (const plcrash_async_breadcrumb_buffer_t *buffer);
+void plcrash_nasync_breadcrumb_buffer_free (plcrash_async_breadcrumb_buffer_t *buffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_BREADCRUMB_BUFFER_H */
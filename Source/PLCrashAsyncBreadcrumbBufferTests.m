@@ -0,0 +1,114 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncBreadcrumbBuffer.h"
+
+@interface PLCrashAsyncBreadcrumbBufferTests : SenTestCase {
+@private
+    plcrash_async_breadcrumb_buffer_t _buffer;
+}
+@end
+
+@implementation PLCrashAsyncBreadcrumbBufferTests
+
+- (void) setUp {
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_breadcrumb_buffer_init(&_buffer, 3, 10), @"Failed to initialize buffer");
+}
+
+- (void) tearDown {
+    plcrash_nasync_breadcrumb_buffer_free(&_buffer);
+}
+
+/* Return the header of the slot at @a index */
+- (const plcrash_async_breadcrumb_header_t *) headerAtIndex: (uint32_t) index {
+    return (const plcrash_async_breadcrumb_header_t *) (_buffer.slots + (index * _buffer.slot_size));
+}
+
+/**
+ * Verify that the buffer geometry is rounded up as documented.
+ */
+- (void) testInit {
+    STAssertEquals(_buffer.capacity, (uint32_t) 4, @"Capacity was not rounded to a power of two");
+    STAssertEquals(_buffer.record_size, (uint32_t) 10, @"Incorrect record size");
+    STAssertEquals(_buffer.slot_size, (uint32_t) 24, @"Slot size was not rounded to an 8 byte multiple");
+    STAssertEquals(plcrash_async_breadcrumb_buffer_length(&_buffer), (size_t) 96, @"Incorrect buffer length");
+
+    for (uint32_t i = 0; i < _buffer.capacity; i++)
+        STAssertEquals([self headerAtIndex: i]->sequence, (uint64_t) 0, @"Slot %u is not empty", i);
+}
+
+/**
+ * Verify that invalid geometries are rejected.
+ */
+- (void) testInitInvalid {
+    plcrash_async_breadcrumb_buffer_t buffer;
+
+    STAssertEquals(PLCRASH_EINVAL, plcrash_nasync_breadcrumb_buffer_init(&buffer, 0, 10), @"Zero capacity was accepted");
+    STAssertEquals(PLCRASH_EINVAL, plcrash_nasync_breadcrumb_buffer_init(&buffer, 4, 0), @"Zero record size was accepted");
+    STAssertEquals(PLCRASH_EINVAL, plcrash_nasync_breadcrumb_buffer_init(&buffer, PLCRASH_ASYNC_BREADCRUMB_CAPACITY_MAX + 1, 10), @"Oversized capacity was accepted");
+    STAssertEquals(PLCRASH_EINVAL, plcrash_nasync_breadcrumb_buffer_init(&buffer, 4, PLCRASH_ASYNC_BREADCRUMB_RECORD_MAX + 1), @"Oversized record size was accepted");
+}
+
+/**
+ * Test appending records, including truncation of oversized records.
+ */
+- (void) testAppend {
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_breadcrumb_buffer_append(&_buffer, "first", 5), @"Append failed");
+    STAssertEquals(PLCRASH_ENOMEM, plcrash_async_breadcrumb_buffer_append(&_buffer, "second record", 13), @"Oversized record was not truncated");
+
+    const plcrash_async_breadcrumb_header_t *header = [self headerAtIndex: 0];
+    STAssertEquals(header->sequence, (uint64_t) 1, @"Incorrect sequence");
+    STAssertEquals(header->length, (uint32_t) 5, @"Incorrect length");
+    STAssertTrue(memcmp(header + 1, "first", 5) == 0, @"Incorrect payload");
+
+    header = [self headerAtIndex: 1];
+    STAssertEquals(header->sequence, (uint64_t) 2, @"Incorrect sequence");
+    STAssertEquals(header->length, (uint32_t) 10, @"Record was not truncated to the record size");
+    STAssertTrue(memcmp(header + 1, "second rec", 10) == 0, @"Incorrect payload");
+
+    STAssertEquals([self headerAtIndex: 2]->sequence, (uint64_t) 0, @"Unused slot is not empty");
+}
+
+/**
+ * Verify that the oldest records are replaced once the buffer wraps.
+ */
+- (void) testAppendWraps {
+    for (uint8_t i = 1; i <= 6; i++)
+        plcrash_async_breadcrumb_buffer_append(&_buffer, &i, sizeof(i));
+
+    /* Slots 0 and 1 hold records 5 and 6; slots 2 and 3 hold records 3 and 4 */
+    uint64_t expected[] = { 5, 6, 3, 4 };
+    for (uint32_t i = 0; i < _buffer.capacity; i++) {
+        const plcrash_async_breadcrumb_header_t *header = [self headerAtIndex: i];
+        STAssertEquals(header->sequence, expected[i], @"Incorrect sequence in slot %u", i);
+        STAssertEquals(*(const uint8_t *) (header + 1), (uint8_t) expected[i], @"Incorrect payload in slot %u", i);
+    }
+}
+
+@end
@@ -0,0 +1,231 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "PLCrashAsyncCRC32C.h"
+
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_crc32c CRC-32C Checksums
+ *
+ * Implements async-safe, allocation-free computation of CRC-32C (Castagnoli) checksums. When built for a target
+ * that provides the SSE4.2 or ARMv8 CRC32 instructions, the checksum is computed in hardware; otherwise, a
+ * table-driven implementation is used.
+ *
+ * As the CRC is linear, the effect of overwriting previously checksummed data may be applied to an existing
+ * checksum without re-reading the data; see plcrash_async_crc32c_delta() and plcrash_async_crc32c_shift().
+ * @{
+ */
+
+/** The reflected CRC-32C polynomial. */
+#define CRC32C_POLY 0x82F63B78
+
+/** The unit polynomial (x^0), in the reflected representation. */
+#define CRC32C_X0 0x80000000
+
+/** x^8, in the reflected representation. Feeding one zero byte to the CRC register multiplies it by this value. */
+#define CRC32C_X8 0x00800000
+
+#if !defined(__SSE4_2__) && !defined(__ARM_FEATURE_CRC32)
+/** Byte-wise CRC-32C lookup table. */
+static const uint32_t crc32c_table[256] = {
+    0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
+    0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+    0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24, 0x105ec76f, 0xe235446c,
+    0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+    0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+    0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+    0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35, 0xaa64d611, 0x580f5512,
+    0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+    0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad,
+    0x1642ae59, 0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+    0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc, 0xb3109ebf,
+    0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+    0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f,
+    0xed03a29b, 0x1f682198, 0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+    0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+    0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+    0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e,
+    0x4767748a, 0xb50cf789, 0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+    0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e,
+    0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+    0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de,
+    0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+    0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93, 0x082f63b7, 0xfa44e0b4,
+    0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+    0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+    0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+    0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033, 0xa24bb5a6, 0x502036a5,
+    0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+    0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975,
+    0x0e330a81, 0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+    0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06, 0xcaa7a905,
+    0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+    0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8,
+    0xe52cc12c, 0x1747422f, 0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+    0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+    0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+    0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78,
+    0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+    0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6,
+    0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+    0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69,
+    0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+    0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351
+};
+#endif
+
+/* Feed a single byte to the CRC register @a reg */
+static inline uint32_t crc32c_byte (uint32_t reg, uint8_t byte) {
+#if defined(__SSE4_2__)
+    return _mm_crc32_u8(reg, byte);
+#elif defined(__ARM_FEATURE_CRC32)
+    return __crc32cb(reg, byte);
+#else
+    return crc32c_table[(reg ^ byte) & 0xFF] ^ (reg >> 8);
+#endif
+}
+
+/* Feed @a length bytes from @a data to the CRC register @a reg, with no pre- or post-conditioning */
+static uint32_t crc32c_raw (uint32_t reg, const uint8_t *data, size_t length) {
+#if defined(__SSE4_2__) || defined(__ARM_FEATURE_CRC32)
+    /* Feed bytes individually until the input is aligned for word-sized loads */
+    while (length > 0 && ((uintptr_t) data & 0x7) != 0) {
+        reg = crc32c_byte(reg, *data++);
+        length--;
+    }
+
+    /* The CRC instructions consume little-endian words, matching the byte-wise input order on all supported hosts. */
+    while (length >= 8) {
+#if defined(__SSE4_2__) && defined(__x86_64__)
+        reg = (uint32_t) _mm_crc32_u64(reg, *(const uint64_t *) data);
+#elif defined(__SSE4_2__)
+        reg = _mm_crc32_u32(reg, ((const uint32_t *) data)[0]);
+        reg = _mm_crc32_u32(reg, ((const uint32_t *) data)[1]);
+#elif defined(__aarch64__) || defined(__arm64__)
+        reg = __crc32cd(reg, *(const uint64_t *) data);
+#else
+        reg = __crc32cw(reg, ((const uint32_t *) data)[0]);
+        reg = __crc32cw(reg, ((const uint32_t *) data)[1]);
+#endif
+        data += 8;
+        length -= 8;
+    }
+#endif
+
+    while (length > 0) {
+        reg = crc32c_byte(reg, *data++);
+        length--;
+    }
+
+    return reg;
+}
+
+/* Multiply @a a by @a b modulo the CRC-32C polynomial, in the reflected representation */
+static uint32_t crc32c_multmodp (uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+
+    for (uint32_t m = CRC32C_X0; m != 0; m >>= 1) {
+        if (a & m)
+            product ^= b;
+        b = (b & 1) ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+
+    return product;
+}
+
+/**
+ * Update the CRC-32C checksum @a crc with @a length bytes from @a data. To compute the checksum of a new
+ * sequence of bytes, pass an initial @a crc of 0.
+ *
+ * @param crc The checksum of all preceding data.
+ * @param data The data to be checksummed.
+ * @param length The number of bytes to be read from @a data.
+ *
+ * @return Returns the checksum of the preceding data, followed by @a data.
+ */
+uint32_t plcrash_async_crc32c_update (uint32_t crc, const void *data, size_t length) {
+    return ~crc32c_raw(~crc, data, length);
+}
+
+/**
+ * Accumulate the checksum delta that results from replacing @a length bytes of @a original data with
+ * @a replacement. Successive calls may be used to accumulate the delta of a contiguous range in pieces.
+ *
+ * The resulting value is relative to the end of the replaced range; before being applied to a checksum
+ * computed over subsequent data, the delta must be advanced past that data via plcrash_async_crc32c_shift().
+ * The delta may then be applied to the checksum by exclusive OR.
+ *
+ * @param delta The delta of any immediately preceding replaced bytes, or 0.
+ * @param original The original data.
+ * @param replacement The replacement data.
+ * @param length The number of bytes to be read from @a original and @a replacement.
+ */
+uint32_t plcrash_async_crc32c_delta (uint32_t delta, const void *original, const void *replacement, size_t length) {
+    const uint8_t *lhs = original;
+    const uint8_t *rhs = replacement;
+
+    for (size_t i = 0; i < length; i++)
+        delta = crc32c_byte(delta, lhs[i] ^ rhs[i]);
+
+    return delta;
+}
+
+/**
+ * Advance a checksum delta (see plcrash_async_crc32c_delta()) past @a length subsequent bytes. This requires
+ * time logarithmic in @a length, and does not require access to the data.
+ *
+ * @param delta The delta to be advanced.
+ * @param length The number of bytes following the replaced data.
+ */
+uint32_t plcrash_async_crc32c_shift (uint32_t delta, uint64_t length) {
+    /* Compute x^(8 * length) by repeated squaring */
+    uint32_t power = CRC32C_X0;
+    uint32_t square = CRC32C_X8;
+
+    if (delta == 0)
+        return 0;
+
+    while (length != 0) {
+        if (length & 1)
+            power = crc32c_multmodp(square, power);
+        square = crc32c_multmodp(square, square);
+        length >>= 1;
+    }
+
+    return crc32c_multmodp(power, delta);
+}
+
+/**
+ * @} plcrash_async_crc32c
+ */
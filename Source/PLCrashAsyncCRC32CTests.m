@@ -0,0 +1,87 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncCRC32C.h"
+
+@interface PLCrashAsyncCRC32CTests : SenTestCase @end
+
+@implementation PLCrashAsyncCRC32CTests
+
+/**
+ * Test the standard CRC-32C check values.
+ */
+- (void) testCheckValues {
+    const char *check = "123456789";
+    uint8_t zeros[32];
+    memset(zeros, 0, sizeof(zeros));
+
+    STAssertEquals((uint32_t) 0, plcrash_async_crc32c_update(0, check, 0), @"Incorrect checksum of empty input");
+    STAssertEquals((uint32_t) 0xE3069283, plcrash_async_crc32c_update(0, check, strlen(check)), @"Incorrect checksum");
+    STAssertEquals((uint32_t) 0x8A9136AA, plcrash_async_crc32c_update(0, zeros, sizeof(zeros)), @"Incorrect checksum");
+}
+
+/**
+ * Verify that incremental checksums match a single pass, regardless of how the input is split or aligned.
+ */
+- (void) testIncrementalUpdate {
+    uint8_t data[1027];
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t) arc4random();
+
+    uint32_t expected = plcrash_async_crc32c_update(0, data, sizeof(data));
+    for (size_t split = 0; split < 17; split++) {
+        uint32_t crc = plcrash_async_crc32c_update(0, data, split);
+        crc = plcrash_async_crc32c_update(crc, data + split, sizeof(data) - split);
+        STAssertEquals(expected, crc, @"Incorrect checksum when split at %zu", split);
+    }
+}
+
+/**
+ * Verify that a patch delta applied to an existing checksum matches the checksum of the patched data.
+ */
+- (void) testPatchDelta {
+    uint8_t data[512];
+    uint8_t patch[] = { 0xC, 0xA, 0xF, 0xE };
+    for (size_t i = 0; i < sizeof(data); i++)
+        data[i] = (uint8_t) arc4random();
+
+    uint32_t crc = plcrash_async_crc32c_update(0, data, sizeof(data));
+
+    /* Accumulate the delta in two pieces, and advance it to the end of the data */
+    uint32_t delta = plcrash_async_crc32c_delta(0, data + 100, patch, 2);
+    delta = plcrash_async_crc32c_delta(delta, data + 102, patch + 2, sizeof(patch) - 2);
+    crc ^= plcrash_async_crc32c_shift(delta, sizeof(data) - 100 - sizeof(patch));
+
+    memcpy(data + 100, patch, sizeof(patch));
+    STAssertEquals(plcrash_async_crc32c_update(0, data, sizeof(data)), crc, @"Incorrect patched checksum");
+
+    /* Identical replacement data has no effect */
+    STAssertEquals((uint32_t) 0, plcrash_async_crc32c_delta(0, data, data, sizeof(data)), @"Non-zero delta");
+}
+
+@end
@@ -49,6 +49,10 @@
 
 #pragma mark CFE Reader
 
+/* Evaluates to true if the length of @a _ecount * @a sizof(_etype) can not be represented
+ * by size_t. */
+#define VERIFY_SIZE_T(_etype, _ecount) (SIZE_MAX / sizeof(_etype) < _ecount)
+
 /**
  * Initialize a new CFE reader using the provided memory object. Any resources held by a successfully initialized
  * instance must be freed via plcrash_async_cfe_reader_free();
@@ -67,6 +71,7 @@ plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reade
     switch (cputype) {
         case CPU_TYPE_X86:
         case CPU_TYPE_X86_64:
+        case CPU_TYPE_ARM64:
             reader->byteorder = plcrash_async_byteorder_little_endian();
             break;
 
@@ -75,9 +80,15 @@ plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reade
             return PLCRASH_ENOTSUP;
     }
 
-    /* Fetch and verify the header */
+    /* Pin the full CFE range; individual tables are then remapped without re-verifying against the memory object */
     pl_vm_address_t base_addr = plcrash_async_mobject_base_address(mobj);
-    struct unwind_info_section_header *header = plcrash_async_mobject_remap_address(mobj, base_addr, 0, sizeof(*header));
+    if (plcrash_async_mobject_view_init(&reader->view, mobj, base_addr, 0, plcrash_async_mobject_length(mobj)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not map the unwind info section");
+        return PLCRASH_EINVAL;
+    }
+
+    /* Fetch and verify the header */
+    struct unwind_info_section_header *header = plcrash_async_mobject_view_remap(&reader->view, base_addr, 0, sizeof(*header));
     if (header == NULL) {
         PLCF_DEBUG("Could not map the unwind info section header");
         return PLCRASH_EINVAL;
@@ -91,6 +102,32 @@ plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reade
     }
 
     reader->header = *header;
+
+    /* Find and map the common encodings table */
+    reader->common_enc_count = reader->byteorder->swap32(reader->header.commonEncodingsArrayCount);
+    {
+        if (VERIFY_SIZE_T(uint32_t, reader->common_enc_count)) {
+            PLCF_DEBUG("CFE common encoding count extends beyond the range of size_t");
+            return PLCRASH_EINVAL;
+        }
+
+        size_t common_enc_len = reader->common_enc_count * sizeof(uint32_t);
+        uint32_t common_enc_off = reader->byteorder->swap32(reader->header.commonEncodingsArraySectionOffset);
+        reader->common_enc = plcrash_async_mobject_view_remap(&reader->view, base_addr, common_enc_off, common_enc_len);
+        if (reader->common_enc == NULL) {
+            PLCF_DEBUG("The declared common table lies outside the mapped CFE range");
+            return PLCRASH_EINVAL;
+        }
+    }
+
+    /* No work budget by default */
+    reader->work_budget = NULL;
+
+    /* Initialize the (empty) page cache */
+    reader->page_generation = 0;
+    for (size_t i = 0; i < PLCRASH_ASYNC_CFE_PAGE_CACHE_SIZE; i++)
+        reader->pages[i].valid = false;
+
     return PLCRASH_ESUCCESS;
 }
 
@@ -140,98 +177,104 @@ plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reade
     } \
 } while (0)
 
-/* Evaluates to true if the length of @a _ecount * @a sizof(_etype) can not be represented
- * by size_t. */
-#define VERIFY_SIZE_T(_etype, _ecount) (SIZE_MAX / sizeof(_etype) < _ecount)
-
 /**
- * Return the compact frame encoding entry for @a pc via @a encoding, if available.
+ * @internal
  *
- * @param reader The initialized CFE reader which will be searched for the entry.
- * @param pc The PC value to search for within the CFE data. Note that this value must be relative to
- * the target Mach-O image's __TEXT vmaddr.
- * @param function_base On success, will be populated with the base address of the function. This value is relative to
- * the image's load address, rather than the in-memory address of the loaded image.
- * @param encoding On success, will be populated with the compact frame encoding entry.
+ * Map the first-level index of @a reader.
  *
- * @return Returns PLFRAME_ESUCCCESS on success, or one of the remaining error codes if a CFE parsing error occurs. If
- * the entry can not be found, PLFRAME_ENOTFOUND will be returned.
+ * @param reader The initialized CFE reader.
+ * @param index_entries On success, the index entries, verified to lie within the reader's memory object.
+ * @param index_count On success, the number of entries in @a index_entries. This may be 0.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the index is empty, or PLCRASH_EINVAL if the index
+ * is malformed.
  */
-plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, uint32_t *encoding) {
+static plcrash_error_t plcrash_async_cfe_reader_map_index (plcrash_async_cfe_reader_t *reader,
+                                                           struct unwind_info_section_header_index_entry **index_entries,
+                                                           uint32_t *index_count)
+{
     const plcrash_async_byteorder_t *byteorder = reader->byteorder;
-    const pl_vm_address_t base_addr = plcrash_async_mobject_base_address(reader->mobj);
+    const pl_vm_address_t base_addr = reader->view.task_address;
 
-    /* Find and map the common encodings table */
-    uint32_t common_enc_count = byteorder->swap32(reader->header.commonEncodingsArrayCount);
-    uint32_t *common_enc;
-    {
-        if (VERIFY_SIZE_T(uint32_t, common_enc_count)) {
-            PLCF_DEBUG("CFE common encoding count extends beyond the range of size_t");
-            return PLCRASH_EINVAL;
-        }
+    /* Find and map the index */
+    uint32_t index_off = byteorder->swap32(reader->header.indexSectionOffset);
+    uint32_t count = byteorder->swap32(reader->header.indexCount);
 
-        size_t common_enc_len = common_enc_count * sizeof(uint32_t);
-        uint32_t common_enc_off = byteorder->swap32(reader->header.commonEncodingsArraySectionOffset);
-        common_enc = plcrash_async_mobject_remap_address(reader->mobj, base_addr, common_enc_off, common_enc_len);
-        if (common_enc == NULL) {
-            PLCF_DEBUG("The declared common table lies outside the mapped CFE range");
-            return PLCRASH_EINVAL;
-        }
+    if (VERIFY_SIZE_T(sizeof(struct unwind_info_section_header_index_entry), count)) {
+        PLCF_DEBUG("CFE index count extends beyond the range of size_t");
+        return PLCRASH_EINVAL;
     }
 
-    /* Find and load the first level entry */
-    struct unwind_info_section_header_index_entry *first_level_entry = NULL;
-    {
-        /* Find and map the index */
-        uint32_t index_off = byteorder->swap32(reader->header.indexSectionOffset);
-        uint32_t index_count = byteorder->swap32(reader->header.indexCount);
-        
-        if (VERIFY_SIZE_T(sizeof(struct unwind_info_section_header_index_entry), index_count)) {
-            PLCF_DEBUG("CFE index count extends beyond the range of size_t");
-            return PLCRASH_EINVAL;
-        }
-        
-        if (index_count == 0) {
-            PLCF_DEBUG("CFE index contains no entries");
-            return PLCRASH_ENOTFOUND;
-        }
-        
-        /*
-         * NOTE: CFE includes an extra entry in the total count of second-level pages, ie, from ld64:
-         * const uint32_t indexCount = secondLevelPageCount+1;
-         *
-         * There's no explanation as to why, and tools appear to explicitly ignore the entry entirely. We do the same
-         * here.
-         */
-        PLCF_ASSERT(index_count != 0);
-        index_count--;
-        
-        /* Load the index entries */
-        size_t index_len = index_count * sizeof(struct unwind_info_section_header_index_entry);
-        struct unwind_info_section_header_index_entry *index_entries = plcrash_async_mobject_remap_address(reader->mobj, base_addr, index_off, index_len);
-        if (index_entries == NULL) {
-            PLCF_DEBUG("The declared entries table lies outside the mapped CFE range");
-            return PLCRASH_EINVAL;
-        }
-        
-        /* Binary search for the first-level entry */
-#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (byteorder->swap32(_tval.functionOffset))
-        CFE_FUN_BINARY_SEARCH(pc, index_entries, index_count, first_level_entry);
-#undef CFE_FUN_BINARY_SEARCH_ENTVAL
-        
-        if (first_level_entry == NULL) {
-            PLCF_DEBUG("Could not find a first level CFE entry for pc=%" PRIx64, (uint64_t) pc);
-            return PLCRASH_ENOTFOUND;
-        }
+    if (count == 0) {
+        PLCF_DEBUG("CFE index contains no entries");
+        return PLCRASH_ENOTFOUND;
+    }
+
+    /*
+     * NOTE: CFE includes an extra entry in the total count of second-level pages, ie, from ld64:
+     * const uint32_t indexCount = secondLevelPageCount+1;
+     *
+     * There's no explanation as to why, and tools appear to explicitly ignore the entry entirely. We do the same
+     * here.
+     */
+    PLCF_ASSERT(count != 0);
+    count--;
+
+    /* Load the index entries */
+    size_t index_len = count * sizeof(struct unwind_info_section_header_index_entry);
+    *index_entries = plcrash_async_mobject_view_remap(&reader->view, base_addr, index_off, index_len);
+    if (*index_entries == NULL) {
+        PLCF_DEBUG("The declared entries table lies outside the mapped CFE range");
+        return PLCRASH_EINVAL;
     }
 
-    /* Locate and decode the second-level entry */
+    *index_count = count;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Validate and decode the second-level page referenced by @a first_level_entry, populating @a page.
+ *
+ * @param reader The initialized CFE reader.
+ * @param index_entries The first-level index, as returned by plcrash_async_cfe_reader_map_index().
+ * @param index_count The number of entries in @a index_entries.
+ * @param first_level_entry The first-level entry referencing the page to be decoded.
+ * @param page The page to be populated.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or one of the remaining error codes if a CFE parsing error occurs.
+ */
+static plcrash_error_t plcrash_async_cfe_reader_decode_page (plcrash_async_cfe_reader_t *reader,
+                                                             struct unwind_info_section_header_index_entry *index_entries,
+                                                             uint32_t index_count,
+                                                             struct unwind_info_section_header_index_entry *first_level_entry,
+                                                             plcrash_async_cfe_page_t *page)
+{
+    const plcrash_async_byteorder_t *byteorder = reader->byteorder;
+    const pl_vm_address_t base_addr = reader->view.task_address;
+
+    /* Record the range of function offsets covered by this page; the binary search above will match the last
+     * page for any PC beyond its start. */
+    page->start_offset = byteorder->swap32(first_level_entry->functionOffset);
+    if (first_level_entry + 1 < index_entries + index_count)
+        page->end_offset = byteorder->swap32((first_level_entry + 1)->functionOffset);
+    else
+        page->end_offset = UINT32_MAX;
+
+    /* Locate and validate the second-level page */
     uint32_t second_level_offset = byteorder->swap32(first_level_entry->secondLevelPagesSectionOffset);
-    uint32_t *second_level_kind = plcrash_async_mobject_remap_address(reader->mobj, base_addr, second_level_offset, sizeof(uint32_t));
-    switch (byteorder->swap32(*second_level_kind)) {
+    uint32_t *second_level_kind = plcrash_async_mobject_view_remap(&reader->view, base_addr, second_level_offset, sizeof(uint32_t));
+    if (second_level_kind == NULL) {
+        PLCF_DEBUG("The second-level page lies outside the mapped CFE range");
+        return PLCRASH_EINVAL;
+    }
+
+    page->kind = byteorder->swap32(*second_level_kind);
+    switch (page->kind) {
         case UNWIND_SECOND_LEVEL_REGULAR: {
             struct unwind_info_regular_second_level_page_header *header;
-            header = plcrash_async_mobject_remap_address(reader->mobj, base_addr, second_level_offset, sizeof(*header));
+            header = plcrash_async_mobject_view_remap(&reader->view, base_addr, second_level_offset, sizeof(*header));
             if (header == NULL) {
                 PLCF_DEBUG("The second-level page header lies outside the mapped CFE range");
                 return PLCRASH_EINVAL;
@@ -246,39 +289,25 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
                 return PLCRASH_EINVAL;
             }
             
-            if (!plcrash_async_mobject_verify_local_pointer(reader->mobj, header, entries_offset, entries_count * sizeof(struct unwind_info_regular_second_level_entry))) {
+            if (!plcrash_async_mobject_view_verify_local_pointer(&reader->view, header, entries_offset, entries_count * sizeof(struct unwind_info_regular_second_level_entry))) {
                 PLCF_DEBUG("CFE entries table lies outside the mapped CFE range");
                 return PLCRASH_EINVAL;
             }
-            
-            /* Binary search for the target entry */
-            struct unwind_info_regular_second_level_entry *entries = (struct unwind_info_regular_second_level_entry *) (((uintptr_t)header) + entries_offset);
-            struct unwind_info_regular_second_level_entry *entry = NULL;
-            
-#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (byteorder->swap32(_tval.functionOffset))
-            CFE_FUN_BINARY_SEARCH(pc, entries, entries_count, entry);
-#undef CFE_FUN_BINARY_SEARCH_ENTVAL
-            
-            if (entry == NULL) {
-                PLCF_DEBUG("Could not find a second level regular CFE entry for pc=%" PRIx64, (uint64_t) pc);
-                return PLCRASH_ENOTFOUND;
-            }
 
-            *encoding = byteorder->swap32(entry->encoding);
-            *function_base = byteorder->swap32(entry->functionOffset);
+            page->entries = (void *) (((uintptr_t)header) + entries_offset);
+            page->entries_count = entries_count;
+            page->encodings = NULL;
+            page->encodings_count = 0;
             return PLCRASH_ESUCCESS;
         }
 
         case UNWIND_SECOND_LEVEL_COMPRESSED: {
             struct unwind_info_compressed_second_level_page_header *header;
-            header = plcrash_async_mobject_remap_address(reader->mobj, base_addr, second_level_offset, sizeof(*header));
+            header = plcrash_async_mobject_view_remap(&reader->view, base_addr, second_level_offset, sizeof(*header));
             if (header == NULL) {
                 PLCF_DEBUG("The second-level page header lies outside the mapped CFE range");
                 return PLCRASH_EINVAL;
             }
-            
-            /* Record the base offset */
-            uint32_t base_foffset = byteorder->swap32(first_level_entry->functionOffset);
 
             /* Find the entries array */
             uint32_t entries_offset = byteorder->swap16(header->entryPageOffset);
@@ -289,39 +318,11 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
                 return PLCRASH_EINVAL;
             }
             
-            if (!plcrash_async_mobject_verify_local_pointer(reader->mobj, header, entries_offset, entries_count * sizeof(uint32_t))) {
+            if (!plcrash_async_mobject_view_verify_local_pointer(&reader->view, header, entries_offset, entries_count * sizeof(uint32_t))) {
                 PLCF_DEBUG("CFE entries table lies outside the mapped CFE range");
                 return PLCRASH_EINVAL;
             }
 
-            /* Binary search for the target entry */
-            uint32_t *compressed_entries = (uint32_t *) (((uintptr_t)header) + entries_offset);
-            uint32_t *c_entry_ptr = NULL;
-
-#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(_tval)))
-            CFE_FUN_BINARY_SEARCH(pc, compressed_entries, entries_count, c_entry_ptr);
-#undef CFE_FUN_BINARY_SEARCH_ENTVAL
-            
-            if (c_entry_ptr == NULL) {
-                PLCF_DEBUG("Could not find a second level compressed CFE entry for pc=%" PRIx64, (uint64_t) pc);
-                return PLCRASH_ENOTFOUND;
-            }
-
-            /* Find the actual encoding */
-            uint32_t c_entry = byteorder->swap32(*c_entry_ptr);
-            uint8_t c_encoding_idx = UNWIND_INFO_COMPRESSED_ENTRY_ENCODING_INDEX(c_entry);
-            
-            /* Save the function base */
-            *function_base = base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(c_entry));
-            
-            /* Handle common table entries */
-            if (c_encoding_idx < common_enc_count) {
-                /* Found in the common table. The offset is verified as being within the mapped memory range by
-                 * the < common_enc_count check above. */
-                *encoding = byteorder->swap32(common_enc[c_encoding_idx]);
-                return PLCRASH_ESUCCESS;
-            }
-
             /* Map in the encodings table */
             uint32_t encodings_offset = byteorder->swap16(header->encodingsPageOffset);
             uint32_t encodings_count = byteorder->swap16(header->encodingsCount);
@@ -331,27 +332,20 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
                 return PLCRASH_EINVAL;
             }
 
-            if (!plcrash_async_mobject_verify_local_pointer(reader->mobj, header, encodings_offset, encodings_count * sizeof(uint32_t))) {
+            if (!plcrash_async_mobject_view_verify_local_pointer(&reader->view, header, encodings_offset, encodings_count * sizeof(uint32_t))) {
                 PLCF_DEBUG("CFE compressed encodings table lies outside the mapped CFE range");
                 return PLCRASH_EINVAL;
             }
 
-            uint32_t *encodings = (uint32_t *) (((uintptr_t)header) + encodings_offset);
-
-            /* Verify that the entry is within range */
-            c_encoding_idx -= common_enc_count;
-            if (c_encoding_idx >= encodings_count) {
-                PLCF_DEBUG("Encoding index lies outside the second level encoding table");
-                return PLCRASH_EINVAL;
-            }
-
-            /* Save the results */
-            *encoding = byteorder->swap32(encodings[c_encoding_idx]);
+            page->entries = (void *) (((uintptr_t)header) + entries_offset);
+            page->entries_count = entries_count;
+            page->encodings = (uint32_t *) (((uintptr_t)header) + encodings_offset);
+            page->encodings_count = encodings_count;
             return PLCRASH_ESUCCESS;
         }
 
         default:
-            PLCF_DEBUG("Unsupported second-level CFE table kind: 0x%" PRIx32 " at 0x%" PRIx32, byteorder->swap32(*second_level_kind), second_level_offset);
+            PLCF_DEBUG("Unsupported second-level CFE table kind: 0x%" PRIx32 " at 0x%" PRIx32, page->kind, second_level_offset);
             return PLCRASH_EINVAL;
     }
 
@@ -360,6 +354,339 @@ plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *re
     return PLCRASH_ENOTFOUND;
 }
 
+/**
+ * @internal
+ *
+ * Locate, validate, and decode the second-level page containing @a pc, populating @a page.
+ *
+ * @param reader The initialized CFE reader.
+ * @param pc The PC value to search for, relative to the target Mach-O image's __TEXT vmaddr.
+ * @param page The page to be populated.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no page contains @a pc, or one of the remaining
+ * error codes if a CFE parsing error occurs.
+ */
+static plcrash_error_t plcrash_async_cfe_reader_load_page (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, plcrash_async_cfe_page_t *page) {
+    const plcrash_async_byteorder_t *byteorder = reader->byteorder;
+    struct unwind_info_section_header_index_entry *first_level_entry = NULL;
+    struct unwind_info_section_header_index_entry *index_entries;
+    uint32_t index_count;
+    plcrash_error_t err;
+
+    /* Find and map the index */
+    if ((err = plcrash_async_cfe_reader_map_index(reader, &index_entries, &index_count)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if (index_count == 0) {
+        PLCF_DEBUG("Could not find a first level CFE entry for pc=%" PRIx64, (uint64_t) pc);
+        return PLCRASH_ENOTFOUND;
+    }
+
+    /* Binary search for the first-level entry */
+#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (byteorder->swap32(_tval.functionOffset))
+    CFE_FUN_BINARY_SEARCH(pc, index_entries, index_count, first_level_entry);
+#undef CFE_FUN_BINARY_SEARCH_ENTVAL
+
+    if (first_level_entry == NULL) {
+        PLCF_DEBUG("Could not find a first level CFE entry for pc=%" PRIx64, (uint64_t) pc);
+        return PLCRASH_ENOTFOUND;
+    }
+
+    return plcrash_async_cfe_reader_decode_page(reader, index_entries, index_count, first_level_entry, page);
+}
+
+/**
+ * @internal
+ *
+ * Return the function offset of the entry at @a index within the decoded second-level @a page.
+ */
+static inline uint32_t plcrash_async_cfe_page_function_offset (plcrash_async_cfe_reader_t *reader, plcrash_async_cfe_page_t *page, uint32_t index) {
+    const plcrash_async_byteorder_t *byteorder = reader->byteorder;
+
+    if (page->kind == UNWIND_SECOND_LEVEL_REGULAR) {
+        struct unwind_info_regular_second_level_entry *entries = page->entries;
+        return byteorder->swap32(entries[index].functionOffset);
+    }
+
+    uint32_t *compressed_entries = page->entries;
+    return page->start_offset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(compressed_entries[index]));
+}
+
+/**
+ * @internal
+ *
+ * Fetch the function base and compact frame encoding of the entry at @a index within the decoded second-level
+ * @a page.
+ *
+ * @param reader The initialized CFE reader.
+ * @param page A page decoded by plcrash_async_cfe_reader_decode_page().
+ * @param index The index of the target entry; must be less than the page's entries_count.
+ * @param function_base On success, the function base address, relative to the image's load address.
+ * @param encoding On success, the compact frame encoding.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if the entry's encoding index is invalid.
+ */
+static plcrash_error_t plcrash_async_cfe_page_entry (plcrash_async_cfe_reader_t *reader, plcrash_async_cfe_page_t *page, uint32_t index,
+                                                     pl_vm_address_t *function_base, uint32_t *encoding)
+{
+    const plcrash_async_byteorder_t *byteorder = reader->byteorder;
+
+    PLCF_ASSERT(index < page->entries_count);
+
+    if (page->kind == UNWIND_SECOND_LEVEL_REGULAR) {
+        struct unwind_info_regular_second_level_entry *entries = page->entries;
+        *encoding = byteorder->swap32(entries[index].encoding);
+        *function_base = byteorder->swap32(entries[index].functionOffset);
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Find the actual encoding */
+    uint32_t *compressed_entries = page->entries;
+    uint32_t c_entry = byteorder->swap32(compressed_entries[index]);
+    uint8_t c_encoding_idx = UNWIND_INFO_COMPRESSED_ENTRY_ENCODING_INDEX(c_entry);
+
+    /* Save the function base */
+    *function_base = page->start_offset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(c_entry);
+
+    /* Handle common table entries */
+    if (c_encoding_idx < reader->common_enc_count) {
+        /* Found in the common table. The offset is verified as being within the mapped memory range by
+         * the < common_enc_count check above. */
+        *encoding = byteorder->swap32(reader->common_enc[c_encoding_idx]);
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Verify that the entry is within range */
+    c_encoding_idx -= reader->common_enc_count;
+    if (c_encoding_idx >= page->encodings_count) {
+        PLCF_DEBUG("Encoding index lies outside the second level encoding table");
+        return PLCRASH_EINVAL;
+    }
+
+    /* Save the results */
+    *encoding = byteorder->swap32(page->encodings[c_encoding_idx]);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Set the work budget to be charged by @a reader's lookups. One PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS unit is
+ * consumed per plcrash_async_cfe_reader_find_pc() call, and per PC passed to plcrash_async_cfe_reader_find_pcs().
+ *
+ * @param reader The reader instance.
+ * @param budget The borrowed work budget, or NULL to disable budgeting. The budget must remain valid for the lifetime
+ * of @a reader.
+ */
+void plcrash_async_cfe_reader_set_work_budget (plcrash_async_cfe_reader_t *reader, plcrash_async_work_budget_t *budget) {
+    reader->work_budget = budget;
+}
+
+/**
+ * Return the compact frame encoding entry for @a pc via @a encoding, if available.
+ *
+ * Decoded second-level pages are cached by @a reader; repeated lookups within recently used pages will skip the
+ * first-level index search and page validation.
+ *
+ * @param reader The initialized CFE reader which will be searched for the entry.
+ * @param pc The PC value to search for within the CFE data. Note that this value must be relative to
+ * the target Mach-O image's __TEXT vmaddr.
+ * @param function_base On success, will be populated with the base address of the function. This value is relative to
+ * the image's load address, rather than the in-memory address of the loaded image.
+ * @param encoding On success, will be populated with the compact frame encoding entry.
+ *
+ * @return Returns PLFRAME_ESUCCCESS on success, or one of the remaining error codes if a CFE parsing error occurs. If
+ * the entry can not be found, PLFRAME_ENOTFOUND will be returned. If the reader's work budget has been exhausted,
+ * PLCRASH_EBUDGET will be returned.
+ */
+plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, uint32_t *encoding) {
+    const plcrash_async_byteorder_t *byteorder = reader->byteorder;
+    plcrash_async_cfe_page_t *page = NULL;
+    plcrash_error_t err;
+
+    if (!plcrash_async_work_budget_consume(reader->work_budget, PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS, 1)) {
+        PLCF_DEBUG("Compact unwind lookup budget exhausted");
+        return PLCRASH_EBUDGET;
+    }
+
+    /* Check for a cached page, noting the least recently used slot in case of a miss */
+    plcrash_async_cfe_page_t *lru = &reader->pages[0];
+    for (size_t i = 0; i < PLCRASH_ASYNC_CFE_PAGE_CACHE_SIZE; i++) {
+        plcrash_async_cfe_page_t *candidate = &reader->pages[i];
+        if (!candidate->valid) {
+            if (lru->valid)
+                lru = candidate;
+            continue;
+        }
+
+        if (pc >= candidate->start_offset && pc < candidate->end_offset) {
+            page = candidate;
+            break;
+        }
+
+        if (lru->valid && candidate->last_used < lru->last_used)
+            lru = candidate;
+    }
+
+    /* Load and cache the page on a miss */
+    if (page == NULL) {
+        lru->valid = false;
+        if ((err = plcrash_async_cfe_reader_load_page(reader, pc, lru)) != PLCRASH_ESUCCESS)
+            return err;
+
+        lru->valid = true;
+        page = lru;
+    }
+    page->last_used = ++reader->page_generation;
+
+    /* Binary search the second-level page for the target entry */
+    uint32_t index;
+    switch (page->kind) {
+        case UNWIND_SECOND_LEVEL_REGULAR: {
+            struct unwind_info_regular_second_level_entry *entries = page->entries;
+            struct unwind_info_regular_second_level_entry *entry = NULL;
+
+#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (byteorder->swap32(_tval.functionOffset))
+            CFE_FUN_BINARY_SEARCH(pc, entries, page->entries_count, entry);
+#undef CFE_FUN_BINARY_SEARCH_ENTVAL
+
+            if (entry == NULL) {
+                PLCF_DEBUG("Could not find a second level regular CFE entry for pc=%" PRIx64, (uint64_t) pc);
+                return PLCRASH_ENOTFOUND;
+            }
+
+            index = (uint32_t) (entry - entries);
+            break;
+        }
+
+        case UNWIND_SECOND_LEVEL_COMPRESSED: {
+            uint32_t base_foffset = page->start_offset;
+            uint32_t *compressed_entries = page->entries;
+            uint32_t *c_entry_ptr = NULL;
+
+#define CFE_FUN_BINARY_SEARCH_ENTVAL(_tval) (base_foffset + UNWIND_INFO_COMPRESSED_ENTRY_FUNC_OFFSET(byteorder->swap32(_tval)))
+            CFE_FUN_BINARY_SEARCH(pc, compressed_entries, page->entries_count, c_entry_ptr);
+#undef CFE_FUN_BINARY_SEARCH_ENTVAL
+
+            if (c_entry_ptr == NULL) {
+                PLCF_DEBUG("Could not find a second level compressed CFE entry for pc=%" PRIx64, (uint64_t) pc);
+                return PLCRASH_ENOTFOUND;
+            }
+
+            index = (uint32_t) (c_entry_ptr - compressed_entries);
+            break;
+        }
+
+        default:
+            PLCF_DEBUG("Unsupported second-level CFE table kind: 0x%" PRIx32, page->kind);
+            return PLCRASH_EINVAL;
+    }
+
+    return plcrash_async_cfe_page_entry(reader, page, index, function_base, encoding);
+}
+
+/**
+ * Return the compact frame encoding entries for all of the sorted @a pcs.
+ *
+ * Rather than searching the first-level index and second-level pages for each PC, as plcrash_async_cfe_reader_find_pc()
+ * does, the index and each page's entries are walked once, in step with the sorted PCs. The cost of the lookup is thus
+ * linear in the number of PCs and the size of the pages they reference, making this suitable for bulk
+ * post-processing of sampled PC values. The reader's page cache is neither used nor modified.
+ *
+ * @param reader The initialized CFE reader which will be searched for the entries.
+ * @param pcs The PC values to search for, sorted in ascending order, and relative to the target Mach-O image's __TEXT
+ * vmaddr. Duplicate values are permitted.
+ * @param count The number of entries in @a pcs.
+ * @param function_bases On return, the base address of the function containing each PC for which
+ * PLCRASH_ESUCCESS was returned via @a results, relative to the image's load address.
+ * @param encodings On return, the compact frame encoding for each PC for which PLCRASH_ESUCCESS was returned via
+ * @a results.
+ * @param results On return, the lookup result for each PC; PLCRASH_ESUCCESS, PLCRASH_ENOTFOUND if no entry covers the
+ * PC, or another error code if the PC's page or entry is malformed.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the lookup was performed, in which case per-PC results are provided via
+ * @a results. Returns PLCRASH_EINVAL if @a pcs is not sorted, or the first-level index is malformed, and PLCRASH_EBUDGET
+ * if the reader's work budget can not cover @a count lookups.
+ */
+plcrash_error_t plcrash_async_cfe_reader_find_pcs (plcrash_async_cfe_reader_t *reader,
+                                                   const pl_vm_address_t *pcs,
+                                                   size_t count,
+                                                   pl_vm_address_t *function_bases,
+                                                   uint32_t *encodings,
+                                                   plcrash_error_t *results)
+{
+    const plcrash_async_byteorder_t *byteorder = reader->byteorder;
+    struct unwind_info_section_header_index_entry *index_entries;
+    uint32_t index_count;
+    plcrash_error_t err;
+
+    /* Verify the sort order up front; the merge below relies on it */
+    for (size_t i = 1; i < count; i++) {
+        if (pcs[i] < pcs[i-1]) {
+            PLCF_DEBUG("PCs are not sorted at index %zu", i);
+            return PLCRASH_EINVAL;
+        }
+    }
+
+    /* Each PC is charged as a single lookup */
+    if (count > UINT32_MAX || !plcrash_async_work_budget_consume(reader->work_budget, PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS, (uint32_t) count)) {
+        PLCF_DEBUG("Compact unwind lookup budget exhausted");
+        return PLCRASH_EBUDGET;
+    }
+
+    /* An empty index covers no PCs */
+    err = plcrash_async_cfe_reader_map_index(reader, &index_entries, &index_count);
+    if (err == PLCRASH_ENOTFOUND)
+        index_count = 0;
+    else if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    /* The current first-level entry and its decoded page, and the current entry within that page */
+    uint32_t page_idx = 0;
+    plcrash_async_cfe_page_t page;
+    plcrash_error_t page_err = PLCRASH_ENOTFOUND;
+    bool page_loaded = false;
+    uint32_t entry_idx = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        pl_vm_address_t pc = pcs[i];
+
+        /* Advance to the last first-level entry that starts at or before pc */
+        if (index_count == 0 || byteorder->swap32(index_entries[0].functionOffset) > pc) {
+            results[i] = PLCRASH_ENOTFOUND;
+            continue;
+        }
+
+        while (page_idx + 1 < index_count && byteorder->swap32(index_entries[page_idx + 1].functionOffset) <= pc) {
+            page_idx++;
+            page_loaded = false;
+        }
+
+        /* Decode the page on first use */
+        if (!page_loaded) {
+            page_err = plcrash_async_cfe_reader_decode_page(reader, index_entries, index_count, &index_entries[page_idx], &page);
+            page_loaded = true;
+            entry_idx = 0;
+        }
+
+        if (page_err != PLCRASH_ESUCCESS) {
+            results[i] = page_err;
+            continue;
+        }
+
+        /* Advance to the last second-level entry that starts at or before pc */
+        if (page.entries_count == 0 || plcrash_async_cfe_page_function_offset(reader, &page, 0) > pc) {
+            results[i] = PLCRASH_ENOTFOUND;
+            continue;
+        }
+
+        while (entry_idx + 1 < page.entries_count && plcrash_async_cfe_page_function_offset(reader, &page, entry_idx + 1) <= pc)
+            entry_idx++;
+
+        results[i] = plcrash_async_cfe_page_entry(reader, &page, entry_idx, &function_bases[i], &encodings[i]);
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Free all resources associated with @a reader.
  */
@@ -634,6 +961,50 @@ static plcrash_error_t plcrash_async_map_register_name (uint32_t orig_reg, plcra
     }
 }
 
+/**
+ * @internal
+ *
+ * Decode the ARM64 non-volatile register pairs saved by @a encoding into @a entry's register list.
+ *
+ * The pairs are saved at descending addresses, starting with x19; the entry's register list is ordered by ascending
+ * address, and is populated in reverse. Saved floating point register pairs are always stored below the general
+ * purpose registers, and do not affect their placement.
+ *
+ * @param entry The entry to be populated.
+ * @param encoding The ARM64 CFE encoding.
+ */
+static void plcrash_async_cfe_entry_arm64_registers (plcrash_async_cfe_entry_t *entry, uint32_t encoding) {
+    static const struct {
+        uint32_t flag;
+        plcrash_regnum_t regs[2];
+    } pairs[] = {
+        { UNWIND_ARM64_FRAME_X19_X20_PAIR, { PLCRASH_ARM64_X19, PLCRASH_ARM64_X20 } },
+        { UNWIND_ARM64_FRAME_X21_X22_PAIR, { PLCRASH_ARM64_X21, PLCRASH_ARM64_X22 } },
+        { UNWIND_ARM64_FRAME_X23_X24_PAIR, { PLCRASH_ARM64_X23, PLCRASH_ARM64_X24 } },
+        { UNWIND_ARM64_FRAME_X25_X26_PAIR, { PLCRASH_ARM64_X25, PLCRASH_ARM64_X26 } },
+        { UNWIND_ARM64_FRAME_X27_X28_PAIR, { PLCRASH_ARM64_X27, PLCRASH_ARM64_X28 } }
+    };
+    const size_t pair_count = sizeof(pairs) / sizeof(pairs[0]);
+
+    /* Sanity check; every pair must fit in the register list */
+    PLCF_ASSERT(pair_count * 2 <= PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX);
+
+    entry->register_count = 0;
+    for (size_t i = 0; i < pair_count; i++) {
+        if (encoding & pairs[i].flag)
+            entry->register_count += 2;
+    }
+
+    uint32_t idx = entry->register_count;
+    for (size_t i = 0; i < pair_count; i++) {
+        if ((encoding & pairs[i].flag) == 0)
+            continue;
+
+        entry->register_list[--idx] = pairs[i].regs[0];
+        entry->register_list[--idx] = pairs[i].regs[1];
+    }
+}
+
 /**
  * Initialize a new decoded CFE entry using the provided encoded CFE data. Any resources held by a successfully
  * initialized instance must be freed via plcrash_async_cfe_entry_free();
@@ -653,6 +1024,7 @@ plcrash_error_t plcrash_async_cfe_entry_init (plcrash_async_cfe_entry_t *entry,
     /* Target-neutral initialization */
     entry->cpu_type = cpu_type;
     entry->stack_adjust = 0;
+    entry->return_address_register = PLCRASH_REG_INVALID;
 
     /* Perform target-specific decoding */
     if (cpu_type == CPU_TYPE_X86) {
@@ -833,6 +1205,55 @@ plcrash_error_t plcrash_async_cfe_entry_init (plcrash_async_cfe_entry_t *entry,
                 return PLCRASH_ENOTSUP;
         }
         
+        // Unreachable
+        __builtin_trap();
+        return PLCRASH_EINTERNAL;
+
+    } else if (cpu_type == CPU_TYPE_ARM64) {
+        uint32_t mode = encoding & UNWIND_ARM64_MODE_MASK;
+        switch (mode) {
+            case UNWIND_ARM64_MODE_FRAME:
+                entry->type = PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAME_PTR;
+
+                /* The saved register pairs are found immediately below the saved fp/lr pair */
+                plcrash_async_cfe_entry_arm64_registers(entry, encoding);
+                entry->stack_offset = -(entry->register_count * sizeof(uint64_t));
+
+                return PLCRASH_ESUCCESS;
+
+            case UNWIND_ARM64_MODE_FRAMELESS:
+                entry->type = PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAMELESS_IMMD;
+
+                /* The stack size is encoded in 16 byte units. The saved register pairs are found at the top of the
+                 * stack frame, and the return address remains in the link register. */
+                entry->stack_offset = EXTRACT_BITS(encoding, UNWIND_ARM64_FRAMELESS_STACK_SIZE_MASK) * 16;
+                entry->return_address_register = PLCRASH_ARM64_LR;
+                plcrash_async_cfe_entry_arm64_registers(entry, encoding);
+
+                return PLCRASH_ESUCCESS;
+
+            case UNWIND_ARM64_MODE_DWARF:
+                entry->type = PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF;
+
+                /* Extract the register frame offset */
+                entry->stack_offset = EXTRACT_BITS(encoding, UNWIND_ARM64_DWARF_SECTION_OFFSET);
+                entry->register_count = 0;
+
+                return PLCRASH_ESUCCESS;
+
+            case 0:
+                /* Handle a NULL encoding. This interpretation is derived from Apple's actual implementation; the correct interpretation of
+                 * a 0x0 value is not defined in what documentation exists. */
+                entry->type = PLCRASH_ASYNC_CFE_ENTRY_TYPE_NONE;
+                entry->stack_offset = 0;
+                entry->register_count = 0;
+                return PLCRASH_ESUCCESS;
+
+            default:
+                PLCF_DEBUG("Unexpected entry mode of %" PRIx32, mode);
+                return PLCRASH_ENOTSUP;
+        }
+
         // Unreachable
         __builtin_trap();
         return PLCRASH_EINTERNAL;
@@ -865,7 +1286,7 @@ plcrash_async_cfe_entry_type_t plcrash_async_cfe_entry_type (plcrash_async_cfe_e
  *
  *   TODO: Need a mechanism to define the actual size of the offset. For x86-32/x86-64, it is defined as being
  *   encoded in a subl instruction.
- * - PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF: Unused.
+ * - PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF: The offset of the function's DWARF FDE within the __eh_frame section.
  *
  * @param entry The entry from which the stack offset value will be fetched.
  */
@@ -905,11 +1326,51 @@ void plcrash_async_cfe_entry_register_list (plcrash_async_cfe_entry_t *entry, pl
     memcpy(register_list, entry->register_list, sizeof(entry->register_list[0]) * entry->register_count);
 }
 
+/**
+ * Return the register containing the return address for PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAMELESS_IMMD entries, or
+ * PLCRASH_REG_INVALID if the return address is saved on the stack.
+ *
+ * @param entry The entry for which the return address register should be returned.
+ */
+plcrash_regnum_t plcrash_async_cfe_entry_return_address_register (plcrash_async_cfe_entry_t *entry) {
+    return entry->return_address_register;
+}
+
+/**
+ * @internal
+ *
+ * The capacity of the register area buffer used by plcrash_async_cfe_entry_apply(), in 64-bit slots; this is
+ * sufficient for the maximum number of saved registers, the saved frame pointer and return address, and a
+ * bounded gap between them.
+ */
+#define PLCRASH_ASYNC_CFE_REGISTER_AREA_MAX (PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX + 4)
+
+/**
+ * @internal
+ *
+ * Load a general purpose register value of the given width from @a data, which need not be aligned.
+ */
+static inline plcrash_greg_t plcrash_async_cfe_load_greg (const uint8_t *data, bool x64) {
+    if (x64) {
+        uint64_t value;
+        plcrash_async_memcpy(&value, data, sizeof(value));
+        return value;
+    } else {
+        uint32_t value;
+        plcrash_async_memcpy(&value, data, sizeof(value));
+        return value;
+    }
+}
+
 /**
  * Apply the decoded @a entry to @a thread_state, fetching data from @a task, populating @a new_thread_state
  * with the result.
  *
  * @param task The task containing any data referenced by @a thread_state.
+ * @param stack_window A pre-mapped window of the target thread's stack from which stack reads will be served when
+ * possible, or NULL.
+ * @param section_cache A section cache in which indirect stack sizes read for PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAMELESS_INDIRECT
+ * entries will be cached, or NULL.
  * @param function_address The task-relative in-memory address of the function containing @a entry. This may be computed
  * by adding the function_base returned by plcrash_async_cfe_reader_find_pc() to the base address of the loaded image.
  * @param thread_state The current thread state corresponding to @a entry.
@@ -921,39 +1382,36 @@ void plcrash_async_cfe_entry_register_list (plcrash_async_cfe_entry_t *entry, pl
  * @todo This implementation assumes downwards stack growth.
  */
 plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
+                                               plcrash_async_mobject_t *stack_window,
+                                               plcrash_async_macho_section_cache_t *section_cache,
                                                pl_vm_address_t function_address,
                                                const plcrash_async_thread_state_t *thread_state,
                                                plcrash_async_cfe_entry_t *entry,
                                                plcrash_async_thread_state_t *new_thread_state)
 {
-    /* Set up register load target */
     size_t greg_size = plcrash_async_thread_state_get_greg_size(thread_state);
     bool x64 = (greg_size == sizeof(uint64_t));
-    void *dest;
-    union {
-        /* Room for (frame pointer, return address) + saved registers */
-        uint64_t greg64[PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX];
-        uint32_t greg32[PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX];
-    } regs;
-
-    if (x64)
-        dest = regs.greg64;
-    else
-        dest = regs.greg32;
-    
-    /* Sanity check: We'll use this buffer for popping the fp and pc, as well as restoring the saved registers. */
-    PLCF_ASSERT(PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX >= 2);
+
+    /* The saved frame record (FP and/or return address), if any, and the saved registers are fetched from the
+     * stack in a single read of the frame's register area. */
+    uint64_t area[PLCRASH_ASYNC_CFE_REGISTER_AREA_MAX];
+    uint64_t record_buf[2];
+    const uint8_t *record_data;
+    const uint8_t *regs_data;
 
     /* Initialize the new thread state */
     *new_thread_state = *thread_state;
     plcrash_async_thread_state_clear_volatile_regs(new_thread_state);
 
+    /* Address and length of the saved frame record (FP + return address, or just the return address); the length
+     * is zero if the entry does not save a frame record on the stack. */
+    pl_vm_address_t record_addr = 0x0;
+    size_t record_len = 0;
+
     pl_vm_address_t saved_reg_addr = 0x0;
     plcrash_async_cfe_entry_type_t entry_type = plcrash_async_cfe_entry_type(entry);
     switch (entry_type) {
         case PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAME_PTR: {
-            plcrash_error_t err;
-
             /* Fetch the current frame pointer */
             if (!plcrash_async_thread_state_has_reg(thread_state, PLCRASH_REG_FP)) {
                 PLCF_DEBUG("Can't apply FRAME_PTR unwind type without a valid frame pointer");
@@ -975,21 +1433,10 @@ plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
     
             plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_SP, new_sp);
 
-            /* Read the saved fp and retaddr */
-            err = plcrash_async_task_memcpy(task, (pl_vm_address_t) fp, 0, dest, greg_size * 2);
-            if (err != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("Failed to read frame data at address 0x%" PRIx64 ": %d", (uint64_t) fp, err);
-                return err;
-            }
-
+            /* The saved fp and retaddr */
             // XXX: This assumes downward stack growth.
-            if (x64) {
-                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_FP, regs.greg64[0]);
-                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, regs.greg64[1]);
-            } else {
-                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_FP, regs.greg32[0]);
-                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, regs.greg32[1]);
-            }
+            record_addr = fp;
+            record_len = greg_size * 2;
             break;
         }
             
@@ -1012,12 +1459,18 @@ plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
                  * provided from the entry is used as an offset from the start of the function to the actual
                  * stack size. */
                 uint32_t indirect;
+                pl_vm_address_t indirect_addr = function_address + stack_size;
+
+                /* The immediate is constant for a given function; reuse any value read while unwinding an earlier frame */
+                if (!plcrash_async_macho_section_cache_find_stack_size(section_cache, indirect_addr, &indirect)) {
+                    err = plcrash_async_task_memcpy(task, function_address, stack_size, &indirect, sizeof(indirect));
+                    if (err != PLCRASH_ESUCCESS) {
+                        PLCF_DEBUG("Failed to read indirect stack size from 0x%" PRIx64 " + 0x%" PRIx64 ": %d",
+                                   (uint64_t) function_address, (uint64_t)stack_size, err);
+                        return err;
+                    }
 
-                err = plcrash_async_task_memcpy(task, function_address, stack_size, &indirect, sizeof(indirect));
-                if (err != PLCRASH_ESUCCESS) {
-                    PLCF_DEBUG("Failed to read indirect stack size from 0x%" PRIx64 " + 0x%" PRIx64 ": %d",
-                               (uint64_t) function_address, (uint64_t)stack_size, err);
-                    return err;
+                    plcrash_async_macho_section_cache_add_stack_size(section_cache, indirect_addr, indirect);
                 }
 
                 stack_size = indirect + entry->stack_adjust;
@@ -1025,24 +1478,30 @@ plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
 
             /* Compute the address of the saved registers */
             plcrash_greg_t sp = plcrash_async_thread_state_get_reg(thread_state, PLCRASH_REG_SP);
-            pl_vm_address_t retaddr = sp + stack_size - greg_size;
-            saved_reg_addr = retaddr - (greg_size * entry->register_count); /* retaddr - [saved registers] */
+            pl_vm_address_t frame_top = sp + stack_size;
 
-            /* Original SP is found just before the return address. */
-            plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_SP, retaddr + greg_size);
+            /* Original SP is found at the top of the frame. */
+            plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_SP, frame_top);
 
-            /* Read the saved return address */
-            err = plcrash_async_task_memcpy(task, (pl_vm_address_t) retaddr, 0, dest, greg_size);
-            if (err != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("Failed to read return address from 0x%" PRIx64 ": %d", (uint64_t) retaddr, err);
-                return err;
-            }
-            
-            if (x64) {
-                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, regs.greg64[0]);
-            } else {
-                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, regs.greg32[0]);
+            /* If the return address is held in a register, the saved registers are found at the top of the frame */
+            plcrash_regnum_t ra_reg = plcrash_async_cfe_entry_return_address_register(entry);
+            if (ra_reg != PLCRASH_REG_INVALID) {
+                if (!plcrash_async_thread_state_has_reg(thread_state, ra_reg)) {
+                    PLCF_DEBUG("Can't apply FRAME_IMMD unwind type without a valid return address register");
+                    return PLCRASH_ENOTFOUND;
+                }
+
+                saved_reg_addr = frame_top - (greg_size * entry->register_count);
+                plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, plcrash_async_thread_state_get_reg(thread_state, ra_reg));
+                break;
             }
+
+            /* Otherwise, the return address is found just below the top of the frame */
+            pl_vm_address_t retaddr = frame_top - greg_size;
+            saved_reg_addr = retaddr - (greg_size * entry->register_count); /* retaddr - [saved registers] */
+
+            record_addr = retaddr;
+            record_len = greg_size;
             break;
         }
 
@@ -1054,8 +1513,70 @@ plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
             return PLCRASH_ENOTSUP;
     }
 
-    /* Extract the saved registers */
+    /* Determine the extent of the register area */
     uint32_t register_count = plcrash_async_cfe_entry_register_count(entry);
+    size_t regs_len = greg_size * register_count;
+
+    pl_vm_address_t area_start = saved_reg_addr;
+    pl_vm_address_t area_end = saved_reg_addr + regs_len;
+    if (regs_len == 0) {
+        area_start = record_addr;
+        area_end = record_addr + record_len;
+    } else if (record_len > 0) {
+        if (record_addr < area_start)
+            area_start = record_addr;
+        if (record_addr + record_len > area_end)
+            area_end = record_addr + record_len;
+    }
+
+    /* Fetch the area in a single read if the record and saved registers are adjacent (as they are for all frameless
+     * entries, and for the standard frame pointer layouts); otherwise, fall back on separate reads. */
+    if (area_end >= area_start && area_end - area_start <= sizeof(area)) {
+        if (area_end > area_start) {
+            plcrash_error_t err = plcrash_async_mobject_task_memcpy(stack_window, task, area_start, 0, area, area_end - area_start);
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to read frame register data at address 0x%" PRIx64 ": %d", (uint64_t) area_start, err);
+                return err;
+            }
+        }
+
+        record_data = ((const uint8_t *) area) + (record_addr - area_start);
+        regs_data = ((const uint8_t *) area) + (saved_reg_addr - area_start);
+    } else {
+        plcrash_error_t err;
+
+        PLCF_ASSERT(record_len <= sizeof(record_buf));
+        PLCF_ASSERT(regs_len <= sizeof(area));
+
+        if (record_len > 0) {
+            err = plcrash_async_mobject_task_memcpy(stack_window, task, record_addr, 0, record_buf, record_len);
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to read frame data at address 0x%" PRIx64 ": %d", (uint64_t) record_addr, err);
+                return err;
+            }
+        }
+
+        if (regs_len > 0) {
+            err = plcrash_async_mobject_task_memcpy(stack_window, task, saved_reg_addr, 0, area, regs_len);
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to read register data at address 0x%" PRIx64 ": %d", (uint64_t) saved_reg_addr, err);
+                return err;
+            }
+        }
+
+        record_data = (const uint8_t *) record_buf;
+        regs_data = (const uint8_t *) area;
+    }
+
+    /* Restore the frame record */
+    if (entry_type == PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAME_PTR) {
+        plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_FP, plcrash_async_cfe_load_greg(record_data, x64));
+        plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, plcrash_async_cfe_load_greg(record_data + greg_size, x64));
+    } else if (record_len > 0) {
+        plcrash_async_thread_state_set_reg(new_thread_state, PLCRASH_REG_IP, plcrash_async_cfe_load_greg(record_data, x64));
+    }
+
+    /* Extract the saved registers */
     plcrash_regnum_t register_list[PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX];
     plcrash_async_cfe_entry_register_list(entry, register_list);
     for (uint32_t i = 0; i < register_count; i++) {
@@ -1063,21 +1584,8 @@ plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
         if (register_list[i] == PLCRASH_REG_INVALID)
             continue;
 
-        /* Fetch and save register data */
-        plcrash_error_t err;
-        err = plcrash_async_task_memcpy(task, (pl_vm_address_t) saved_reg_addr, i*greg_size, dest, greg_size);
-        if (err != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("Failed to read register data for index %s: %d", plcrash_async_thread_state_get_reg_name(thread_state, register_list[i]), err);
-            return err;
-        }
-
-        if (x64) {
-            plcrash_async_thread_state_set_reg(new_thread_state, register_list[i], regs.greg64[0]);
-        } else {
-            plcrash_async_thread_state_set_reg(new_thread_state, register_list[i], regs.greg32[0]);
-        }
+        plcrash_async_thread_state_set_reg(new_thread_state, register_list[i], plcrash_async_cfe_load_greg(regs_data + (i * greg_size), x64));
     }
-    
 
     return PLCRASH_ESUCCESS;
 }
@@ -30,6 +30,7 @@
 #include "PLCrashAsync.h"
 #include "PLCrashAsyncImageList.h"
 #include "PLCrashAsyncThread.h"
+#include "PLCrashAsyncWorkBudget.h"
 
 #include "PLCrashFeatureConfig.h"
 
@@ -37,12 +38,73 @@
 
 #if PLCRASH_FEATURE_UNWIND_COMPACT
 
+/* Older SDKs do not define the ARM64 compact unwind encodings; these values are defined by the ARM64 ABI, and
+ * are stable. */
+#ifndef UNWIND_ARM64_MODE_MASK
+#define UNWIND_ARM64_MODE_MASK                  0x0F000000
+#define UNWIND_ARM64_MODE_FRAMELESS             0x02000000
+#define UNWIND_ARM64_MODE_DWARF                 0x03000000
+#define UNWIND_ARM64_MODE_FRAME                 0x04000000
+
+#define UNWIND_ARM64_FRAME_X19_X20_PAIR         0x00000001
+#define UNWIND_ARM64_FRAME_X21_X22_PAIR         0x00000002
+#define UNWIND_ARM64_FRAME_X23_X24_PAIR         0x00000004
+#define UNWIND_ARM64_FRAME_X25_X26_PAIR         0x00000008
+#define UNWIND_ARM64_FRAME_X27_X28_PAIR         0x00000010
+
+#define UNWIND_ARM64_FRAMELESS_STACK_SIZE_MASK  0x00FFF000
+#define UNWIND_ARM64_DWARF_SECTION_OFFSET       0x00FFFFFF
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /**
  * @internal
  * @ingroup plcrash_async_cfe
  * @{
  */
 
+/**
+ * @internal
+ * The number of decoded second-level pages cached by a plcrash_async_cfe_reader_t instance.
+ */
+#define PLCRASH_ASYNC_CFE_PAGE_CACHE_SIZE 4
+
+/**
+ * @internal
+ * A validated, decoded second-level CFE page.
+ */
+typedef struct plcrash_async_cfe_page {
+    /** If false, this cache slot is unused. */
+    bool valid;
+
+    /** The second-level page kind; one of UNWIND_SECOND_LEVEL_REGULAR or UNWIND_SECOND_LEVEL_COMPRESSED. */
+    uint32_t kind;
+
+    /** The first function offset covered by this page. */
+    uint32_t start_offset;
+
+    /** The function offset at which the next page begins, or UINT32_MAX if this is the last page. */
+    uint32_t end_offset;
+
+    /** The page's entry table, verified to lie within the reader's memory object. */
+    void *entries;
+
+    /** The number of entries in @a entries. */
+    uint32_t entries_count;
+
+    /** The page's encodings table (compressed pages only), verified to lie within the reader's memory object. */
+    uint32_t *encodings;
+
+    /** The number of entries in @a encodings. */
+    uint32_t encodings_count;
+
+    /** The reader's lookup generation at which this page was last used. */
+    uint32_t last_used;
+} plcrash_async_cfe_page_t;
+
 /**
  * @internal
  * A CFE reader instance. Performs CFE data parsing from a backing memory object.
@@ -51,6 +113,10 @@ typedef struct plcrash_async_cfe_reader {
     /** A memory object containing the CFE data at the starting address. */
     plcrash_async_mobject_t *mobj;
 
+    /** The verified span of @a mobj's full range. All CFE tables are remapped via the view, avoiding repeated
+     * verification against @a mobj for each lookup. */
+    plcrash_async_mobject_view_t view;
+
     /** The target CPU type. */
     cpu_type_t cpu_type;
 
@@ -59,6 +125,22 @@ typedef struct plcrash_async_cfe_reader {
 
     /** The byte order of the encoded data (including the header). */
     const plcrash_async_byteorder_t *byteorder;
+
+    /** The common encodings table, verified to lie within @a mobj. */
+    uint32_t *common_enc;
+
+    /** The number of entries in @a common_enc. */
+    uint32_t common_enc_count;
+
+    /** The lookup generation; incremented on every page lookup, and used to select the least recently used page. */
+    uint32_t page_generation;
+
+    /** Recently used second-level pages. Stacks frequently hit the same pages repeatedly, and caching the decoded
+     * pages allows repeated lookups to skip the first-level search and page validation. */
+    plcrash_async_cfe_page_t pages[PLCRASH_ASYNC_CFE_PAGE_CACHE_SIZE];
+
+    /** The borrowed work budget charged for each lookup, or NULL if lookups are unbounded. */
+    plcrash_async_work_budget_t *work_budget;
 } plcrash_async_cfe_reader_t;
 
 /**
@@ -113,8 +195,9 @@ typedef enum {
 } plcrash_async_cfe_entry_type_t;
 
 
-/** Maximum number of saved non-volatile registers that may be represented in a CFE entry */
-#define PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX 6
+/** Maximum number of saved non-volatile registers that may be represented in a CFE entry. This is bounded by the
+ * ARM64 encoding, which may save up to five general purpose register pairs. */
+#define PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX 10
 
 /**
  * @internal
@@ -168,11 +251,22 @@ typedef struct plcrash_async_cfe_entry {
      * PLCRASH_REG_INVALID.
      */
     plcrash_regnum_t register_list[PLCRASH_ASYNC_CFE_SAVED_REGISTER_MAX];
+
+    /**
+     * The register containing the return address for PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAMELESS_IMMD entries, or
+     * PLCRASH_REG_INVALID if the return address is saved on the stack. On ARM64, frameless functions do not
+     * spill the link register.
+     */
+    plcrash_regnum_t return_address_register;
 } plcrash_async_cfe_entry_t;
 
 plcrash_error_t plcrash_async_cfe_reader_init (plcrash_async_cfe_reader_t *reader, plcrash_async_mobject_t *mobj, cpu_type_t cputype);
 
+void plcrash_async_cfe_reader_set_work_budget (plcrash_async_cfe_reader_t *reader, plcrash_async_work_budget_t *budget);
+
 plcrash_error_t plcrash_async_cfe_reader_find_pc (plcrash_async_cfe_reader_t *reader, pl_vm_address_t pc, pl_vm_address_t *function_base, uint32_t *encoding);
+plcrash_error_t plcrash_async_cfe_reader_find_pcs (plcrash_async_cfe_reader_t *reader, const pl_vm_address_t *pcs, size_t count,
+                                                   pl_vm_address_t *function_bases, uint32_t *encodings, plcrash_error_t *results);
 
 void plcrash_async_cfe_reader_free (plcrash_async_cfe_reader_t *reader);
 
@@ -184,8 +278,11 @@ intptr_t plcrash_async_cfe_entry_stack_offset (plcrash_async_cfe_entry_t *entry)
 uint32_t plcrash_async_cfe_entry_stack_adjustment (plcrash_async_cfe_entry_t *entry);
 uint32_t plcrash_async_cfe_entry_register_count (plcrash_async_cfe_entry_t *entry);
 void plcrash_async_cfe_entry_register_list (plcrash_async_cfe_entry_t *entry, plcrash_regnum_t register_list[]);
+plcrash_regnum_t plcrash_async_cfe_entry_return_address_register (plcrash_async_cfe_entry_t *entry);
 
 plcrash_error_t plcrash_async_cfe_entry_apply (task_t task,
+                                               plcrash_async_mobject_t *stack_window,
+                                               plcrash_async_macho_section_cache_t *section_cache,
                                                pl_vm_address_t function_address,
                                                const plcrash_async_thread_state_t *thread_state,
                                                plcrash_async_cfe_entry_t *entry,
@@ -200,6 +297,10 @@ void plcrash_async_cfe_register_decode (uint32_t permutation, uint32_t count, ui
  * @} plcrash_async_cfe
  */
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif /* PLCRASH_FEATURE_UNWIND_COMPACT */
 
 #endif /* PLCRASH_ASYNC_COMPACT_UNWIND_ENCODING_H */
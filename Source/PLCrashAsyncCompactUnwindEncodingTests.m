@@ -535,6 +535,91 @@
     plcrash_async_cfe_entry_free(&entry);
 }
 
+/**
+ * Decode an ARM64 frame encoding.
+ */
+- (void) testARM64DecodeFrame {
+    uint32_t encoding = UNWIND_ARM64_MODE_FRAME | UNWIND_ARM64_FRAME_X19_X20_PAIR | UNWIND_ARM64_FRAME_X23_X24_PAIR;
+
+    /* Try decoding it */
+    plcrash_async_cfe_entry_t entry;
+    plcrash_error_t res = plcrash_async_cfe_entry_init(&entry, CPU_TYPE_ARM64, encoding);
+    STAssertEquals(res, PLCRASH_ESUCCESS, @"Failed to decode entry");
+    STAssertEquals(PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAME_PTR, plcrash_async_cfe_entry_type(&entry), @"Incorrect entry type");
+    STAssertEquals(plcrash_async_cfe_entry_return_address_register(&entry), (plcrash_regnum_t) PLCRASH_REG_INVALID, @"Unexpected return address register");
+
+    /* The registers are saved immediately below the fp/lr pair */
+    intptr_t reg_fp_offset = plcrash_async_cfe_entry_stack_offset(&entry);
+    uint32_t reg_count = plcrash_async_cfe_entry_register_count(&entry);
+    STAssertEquals(reg_fp_offset, (intptr_t) -32, @"Incorrect offset extracted");
+    STAssertEquals(reg_count, (uint32_t)4, @"Incorrect register count extracted");
+
+    /* The register list is ordered by ascending address */
+    plcrash_regnum_t expected_reg[] = {
+        PLCRASH_ARM64_X24,
+        PLCRASH_ARM64_X23,
+        PLCRASH_ARM64_X20,
+        PLCRASH_ARM64_X19
+    };
+    plcrash_regnum_t reg[reg_count];
+
+    plcrash_async_cfe_entry_register_list(&entry, reg);
+    for (uint32_t i = 0; i < 4; i++) {
+        STAssertEquals(reg[i], expected_reg[i], @"Incorrect register value extracted for position %" PRId32, i);
+    }
+
+    plcrash_async_cfe_entry_free(&entry);
+}
+
+/**
+ * Decode an ARM64 'frameless' encoding.
+ */
+- (void) testARM64DecodeFrameless {
+    const uint32_t encoded_stack_size = 64;
+    uint32_t encoding = UNWIND_ARM64_MODE_FRAMELESS |
+        INSERT_BITS(encoded_stack_size/16, UNWIND_ARM64_FRAMELESS_STACK_SIZE_MASK) |
+        UNWIND_ARM64_FRAME_X27_X28_PAIR;
+
+    /* Try decoding it */
+    plcrash_async_cfe_entry_t entry;
+    plcrash_error_t res = plcrash_async_cfe_entry_init(&entry, CPU_TYPE_ARM64, encoding);
+    STAssertEquals(res, PLCRASH_ESUCCESS, @"Failed to decode entry");
+    STAssertEquals(PLCRASH_ASYNC_CFE_ENTRY_TYPE_FRAMELESS_IMMD, plcrash_async_cfe_entry_type(&entry), @"Incorrect entry type");
+    STAssertEquals(plcrash_async_cfe_entry_return_address_register(&entry), (plcrash_regnum_t) PLCRASH_ARM64_LR, @"Incorrect return address register");
+
+    uint32_t stack_size = plcrash_async_cfe_entry_stack_offset(&entry);
+    uint32_t reg_count = plcrash_async_cfe_entry_register_count(&entry);
+    STAssertEquals(stack_size, encoded_stack_size, @"Incorrect stack size decoded");
+    STAssertEquals(reg_count, (uint32_t)2, @"Incorrect register count decoded");
+
+    plcrash_regnum_t reg[reg_count];
+    plcrash_async_cfe_entry_register_list(&entry, reg);
+    STAssertEquals(reg[0], (plcrash_regnum_t) PLCRASH_ARM64_X28, @"Incorrect register value extracted");
+    STAssertEquals(reg[1], (plcrash_regnum_t) PLCRASH_ARM64_X27, @"Incorrect register value extracted");
+
+    plcrash_async_cfe_entry_free(&entry);
+}
+
+/**
+ * Decode an ARM64 DWARF encoding.
+ */
+- (void) testARM64DecodeDWARF {
+    const uint32_t encoded_dwarf_offset = 1016;
+    uint32_t encoding = UNWIND_ARM64_MODE_DWARF |
+        INSERT_BITS(encoded_dwarf_offset, UNWIND_ARM64_DWARF_SECTION_OFFSET);
+
+    /* Try decoding it */
+    plcrash_async_cfe_entry_t entry;
+    plcrash_error_t res = plcrash_async_cfe_entry_init(&entry, CPU_TYPE_ARM64, encoding);
+    STAssertEquals(res, PLCRASH_ESUCCESS, @"Failed to decode entry");
+    STAssertEquals(PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF, plcrash_async_cfe_entry_type(&entry), @"Incorrect entry type");
+
+    uint32_t dwarf_offset = plcrash_async_cfe_entry_stack_offset(&entry);
+    STAssertEquals(dwarf_offset, encoded_dwarf_offset, @"Incorrect dwarf offset decoded");
+
+    plcrash_async_cfe_entry_free(&entry);
+}
+
 /**
  * Test decoding of a single non-zero permuted register.
  *
@@ -663,6 +748,70 @@
 }
 
 
+/**
+ * Test repeated lookups across regular and compressed pages, verifying that cached pages return the same results.
+ */
+- (void) testReadCachedPages {
+    pl_vm_address_t pcs[] = { PC_COMPACT_COMMON, PC_REGULAR, PC_COMPACT_PRIVATE };
+    uint32_t encodings[] = { PC_COMPACT_COMMON_ENCODING, PC_REGULAR_ENCODING, PC_COMPACT_PRIVATE_ENCODING };
+
+    for (int iteration = 0; iteration < 3; iteration++) {
+        for (size_t i = 0; i < sizeof(pcs) / sizeof(pcs[0]); i++) {
+            pl_vm_address_t function_base;
+            uint32_t encoding;
+
+            plcrash_error_t err = plcrash_async_cfe_reader_find_pc(&_reader, pcs[i], &function_base, &encoding);
+            STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to locate CFE entry");
+            STAssertEquals(function_base, pcs[i], @"Incorrect function base returned");
+            STAssertEquals(encoding, encodings[i], @"Incorrect encoding returned");
+        }
+    }
+
+    /* Verify that at least one page was cached */
+    bool found_page = false;
+    for (size_t i = 0; i < PLCRASH_ASYNC_CFE_PAGE_CACHE_SIZE; i++) {
+        if (_reader.pages[i].valid)
+            found_page = true;
+    }
+    STAssertTrue(found_page, @"No pages were cached");
+}
+
+/**
+ * Test batch lookups, verifying that each result matches the equivalent single PC lookup.
+ */
+- (void) testReadBatch {
+    pl_vm_address_t pcs[] = { PC_COMPACT_COMMON, PC_COMPACT_COMMON, PC_COMPACT_PRIVATE, PC_COMPACT_PRIVATE + 1, PC_REGULAR, PC_REGULAR + 1, 0x10000000 };
+    const size_t count = sizeof(pcs) / sizeof(pcs[0]);
+    pl_vm_address_t function_bases[count];
+    uint32_t encodings[count];
+    plcrash_error_t results[count];
+
+    plcrash_error_t err = plcrash_async_cfe_reader_find_pcs(&_reader, pcs, count, function_bases, encodings, results);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Batch lookup failed");
+
+    for (size_t i = 0; i < count; i++) {
+        pl_vm_address_t function_base;
+        uint32_t encoding;
+
+        err = plcrash_async_cfe_reader_find_pc(&_reader, pcs[i], &function_base, &encoding);
+        STAssertEquals(results[i], err, @"Batch result differs from single lookup for PC at index %zu", i);
+        if (err != PLCRASH_ESUCCESS)
+            continue;
+
+        STAssertEquals(function_bases[i], function_base, @"Incorrect function base returned");
+        STAssertEquals(encodings[i], encoding, @"Incorrect encoding returned");
+    }
+
+    STAssertEquals(encodings[0], (uint32_t) PC_COMPACT_COMMON_ENCODING, @"Incorrect encoding returned");
+    STAssertEquals(encodings[2], (uint32_t) PC_COMPACT_PRIVATE_ENCODING, @"Incorrect encoding returned");
+    STAssertEquals(encodings[4], (uint32_t) PC_REGULAR_ENCODING, @"Incorrect encoding returned");
+
+    /* Unsorted input is rejected */
+    pl_vm_address_t unsorted[] = { PC_REGULAR, PC_COMPACT_COMMON };
+    err = plcrash_async_cfe_reader_find_pcs(&_reader, unsorted, 2, function_bases, encodings, results);
+    STAssertEquals(PLCRASH_EINVAL, err, @"Unsorted PCs were accepted");
+}
+
 /*
  * CFE is only supported on x86/x86-64, and the iOS SDK does not provide the thread state APIs necessary
  * to perform these tests on ARM
@@ -707,7 +856,7 @@
 
     /* Apply! */
     plcrash_async_thread_state_t nts;
-    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), 0x0, &ts, &entry, &nts);
+    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, 0x0, &ts, &entry, &nts);
     STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
     
     /* Verify! */
@@ -769,7 +918,7 @@
     
     /* Apply! */
     plcrash_async_thread_state_t nts;
-    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), 0x0, &ts, &entry, &nts);
+    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, 0x0, &ts, &entry, &nts);
     STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
     
     /* Verify! */
@@ -829,7 +978,7 @@
 
     /* Apply */
     plcrash_async_thread_state_t nts;
-    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), 0x0, &ts, &entry, &nts);
+    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, 0x0, &ts, &entry, &nts);
     STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
     
     /* Verify */
@@ -896,7 +1045,7 @@
     
     /* Apply */
     plcrash_async_thread_state_t nts;
-    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), function_address, &ts, &entry, &nts);
+    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, function_address, &ts, &entry, &nts);
     STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
     
     /* Verify */
@@ -919,8 +1068,155 @@
     plcrash_async_cfe_entry_free(&entry);
 }
 
+/**
+ * Verify that indirect stack sizes are cached in the supplied section cache, and reused by subsequent
+ * applications of the same entry.
+ */
+- (void) testX86_64_ApplyFramePTRState_IND_Cached {
+    plcrash_async_macho_section_cache_t section_cache;
+    plcrash_async_cfe_entry_t entry;
+    plcrash_async_thread_state_t ts;
+    plcrash_async_thread_state_t nts;
+    plcrash_error_t err;
+
+    /* Set up a faux frame */
+    uint64_t stackframe[] = {
+        10, // rbp
+        2,  // ret addr
+    };
+
+    /* Create a frame encoding */
+    const uint32_t encoded_stack_size = 128;
+    const uint32_t encoded_regs[] = { UNWIND_X86_64_REG_RBP };
+    const uint32_t encoded_regs_count = sizeof(encoded_regs) / sizeof(encoded_regs[0]);
+    const uint32_t encoded_regs_permutation = plcrash_async_cfe_register_encode(encoded_regs, encoded_regs_count);
+
+    /* Indirect address target */
+    uint32_t indirect_encoded_stack_size = 16;
+    pl_vm_address_t function_address = ((pl_vm_address_t) &indirect_encoded_stack_size) - encoded_stack_size;
+
+    uint32_t encoding = UNWIND_X86_64_MODE_STACK_IND |
+        INSERT_BITS(encoded_stack_size, UNWIND_X86_64_FRAMELESS_STACK_SIZE) |
+        INSERT_BITS(encoded_regs_count, UNWIND_X86_64_FRAMELESS_STACK_REG_COUNT) |
+        INSERT_BITS(encoded_regs_permutation, UNWIND_X86_64_FRAMELESS_STACK_REG_PERMUTATION);
+
+    STAssertEquals(plcrash_async_cfe_entry_init(&entry, CPU_TYPE_X86_64, encoding), PLCRASH_ESUCCESS, @"Failed to decode entry");
+    STAssertEquals(plcrash_async_thread_state_init(&ts, CPU_TYPE_X86_64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    plcrash_async_thread_state_set_reg(&ts, PLCRASH_REG_SP, &stackframe);
+
+    plcrash_async_macho_section_cache_init(&section_cache);
+
+    /* The first application reads the stack size from the function, and caches it */
+    err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, &section_cache, function_address, &ts, &entry, &nts);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_X86_64_RIP), (plcrash_greg_t)2, @"Incorrect register value");
+
+    uint32_t cached_size = 0;
+    STAssertTrue(plcrash_async_macho_section_cache_find_stack_size(&section_cache, (pl_vm_address_t) &indirect_encoded_stack_size, &cached_size), @"Stack size was not cached");
+    STAssertEquals(cached_size, indirect_encoded_stack_size, @"Incorrect cached stack size");
+
+    /* Modify the in-memory value; the cached value must be used by the second application */
+    indirect_encoded_stack_size = 1024;
+    err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, &section_cache, function_address, &ts, &entry, &nts);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_X86_64_RSP), (plcrash_greg_t)&stackframe[2], @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_X86_64_RIP), (plcrash_greg_t)2, @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_X86_64_RBP), (plcrash_greg_t)10, @"Incorrect register value");
+
+    plcrash_async_macho_section_cache_free(&section_cache);
+    plcrash_async_cfe_entry_free(&entry);
+}
+
 #endif /* PLCRASH_ASYNC_THREAD_X86_SUPPORT */
 
+#if PLCRASH_ASYNC_THREAD_ARM64_SUPPORT
+/**
+ * Apply an ARM64 frame encoding.
+ */
+- (void) testARM64_ApplyFramePTRState {
+    plcrash_async_cfe_entry_t entry;
+    plcrash_async_thread_state_t ts;
+
+    /* Set up a faux frame */
+    uint64_t stackframe[] = {
+        20, // x20
+        19, // x19
+
+        1,  // fp
+        2,  // lr
+    };
+
+    uint32_t encoding = UNWIND_ARM64_MODE_FRAME | UNWIND_ARM64_FRAME_X19_X20_PAIR;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_cfe_entry_init(&entry, CPU_TYPE_ARM64, encoding), @"Failed to initialize CFE entry");
+
+    /* Initialize default thread state */
+    plcrash_greg_t stack_addr = (plcrash_greg_t) &stackframe[2]; // fp
+    STAssertEquals(plcrash_async_thread_state_init(&ts, CPU_TYPE_ARM64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    plcrash_async_thread_state_set_reg(&ts, PLCRASH_REG_FP, stack_addr);
+
+    /* Apply! */
+    plcrash_async_thread_state_t nts;
+    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, 0x0, &ts, &entry, &nts);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
+
+    /* Verify! */
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_SP), stack_addr+(16), @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_FP), (plcrash_greg_t)1, @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_PC), (plcrash_greg_t)2, @"Incorrect register value");
+
+    STAssertTrue(plcrash_async_thread_state_has_reg(&nts, PLCRASH_ARM64_X19), @"Missing expected register");
+    STAssertTrue(plcrash_async_thread_state_has_reg(&nts, PLCRASH_ARM64_X20), @"Missing expected register");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_X19), (plcrash_greg_t)19, @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_X20), (plcrash_greg_t)20, @"Incorrect register value");
+
+    plcrash_async_cfe_entry_free(&entry);
+}
+
+/**
+ * Apply an ARM64 'frameless' encoding.
+ */
+- (void) testARM64_ApplyFramelessState {
+    plcrash_async_cfe_entry_t entry;
+    plcrash_async_thread_state_t ts;
+
+    /* Set up a faux frame */
+    uint64_t stackframe[] = {
+        0,  // unused
+        0,  // unused
+        20, // x20
+        19, // x19
+    };
+
+    uint32_t encoding = UNWIND_ARM64_MODE_FRAMELESS |
+        INSERT_BITS(sizeof(stackframe)/16, UNWIND_ARM64_FRAMELESS_STACK_SIZE_MASK) |
+        UNWIND_ARM64_FRAME_X19_X20_PAIR;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_cfe_entry_init(&entry, CPU_TYPE_ARM64, encoding), @"Failed to initialize CFE entry");
+
+    /* Initialize default thread state; the return address remains in the link register */
+    STAssertEquals(plcrash_async_thread_state_init(&ts, CPU_TYPE_ARM64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    plcrash_async_thread_state_set_reg(&ts, PLCRASH_REG_SP, (plcrash_greg_t) &stackframe);
+    plcrash_async_thread_state_set_reg(&ts, PLCRASH_ARM64_LR, 2);
+
+    /* Apply */
+    plcrash_async_thread_state_t nts;
+    plcrash_error_t err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, 0x0, &ts, &entry, &nts);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to apply state to thread");
+
+    /* Verify */
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_SP), (plcrash_greg_t)&stackframe[4], @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_PC), (plcrash_greg_t)2, @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_X19), (plcrash_greg_t)19, @"Incorrect register value");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&nts, PLCRASH_ARM64_X20), (plcrash_greg_t)20, @"Incorrect register value");
+
+    /* Without a link register value, the frame can't be unwound */
+    plcrash_async_thread_state_clear_reg(&ts, PLCRASH_ARM64_LR);
+    err = plcrash_async_cfe_entry_apply(mach_task_self(), NULL, NULL, 0x0, &ts, &entry, &nts);
+    STAssertEquals(err, PLCRASH_ENOTFOUND, @"Expected failure without a link register");
+
+    plcrash_async_cfe_entry_free(&entry);
+}
+#endif /* PLCRASH_ASYNC_THREAD_ARM64_SUPPORT */
+
 @end
 
 #endif /* PLCRASH_FEATURE_UNWIND_COMPACT */
@@ -40,8 +40,8 @@ using namespace plcrash::async;
  */
 
 /**
- * Push a state onto the state stack; all existing values will be saved on the stack, and registers
- * will be set to their default state.
+ * Push a state onto the state stack; all existing values will be saved on the stack, and the new current state
+ * will be initialized as a copy of the saved state.
  *
  * @return Returns true on success, or false if insufficient space is available on the state
  * stack.
@@ -53,11 +53,8 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::push_state (void) {
     if (_table_depth+1 == DWARF_CFA_STATE_MAX_STATES)
         return false;
     
+    plcrash_async_memcpy(&_states[_table_depth+1], &_states[_table_depth], sizeof(_states[0]));
     _table_depth++;
-    _register_count[_table_depth] = 0;
-    _cfa_value[_table_depth].set_undefined_rule();
-
-    plcrash_async_memset(_table_stack[_table_depth], DWARF_CFA_STATE_INVALID_ENTRY_IDX, sizeof(_table_stack[0]));
     
     return true;
 }
@@ -82,28 +79,33 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::pop_state (void) {
  */
 template <typename machine_ptr, typename machine_ptr_s>
 dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_state (void) {
-    /* The size must be smaller than the invalid entry index, which is used as a NULL flag */
-    PLCF_ASSERT_STATIC(max_size, DWARF_CFA_STATE_MAX_REGISTERS < DWARF_CFA_STATE_INVALID_ENTRY_IDX);
-    
-    /* Initialize the free list */
-    for (uint8_t i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++)
-        _entries[i].next = i+1;
-    
-    /* Set the terminator flag on the last entry */
-    _entries[DWARF_CFA_STATE_MAX_REGISTERS-1].next = DWARF_CFA_STATE_INVALID_ENTRY_IDX;
-    
-    /* First free entry is _entries[0] */
-    _free_list = 0;
-    
-    /* Initial register count */
-    _register_count[0] = 0;
-    
-    /* Set up the table */
+    /* The column bitmask must be able to represent all dense columns */
+    PLCF_ASSERT_STATIC(dense_columns, dwarf_cfa_state_config<machine_ptr>::dense_columns <= 64);
+
+    /* The register count must fit within the uint8_t counter */
+    PLCF_ASSERT_STATIC(max_registers, dwarf_cfa_state_config<machine_ptr>::dense_columns + DWARF_CFA_STATE_OVERFLOW_REGISTERS <= UINT8_MAX);
+
+    /* Set up the initial state */
     _table_depth = 0;
-    plcrash_async_memset(_table_stack[0], DWARF_CFA_STATE_INVALID_ENTRY_IDX, sizeof(_table_stack[0]));
-    
+    _work_budget = NULL;
+    _states[0].valid = 0;
+    _states[0].register_count = 0;
+    _states[0].overflow_count = 0;
+
     /* Default CFA */
-    _cfa_value[0].set_undefined_rule();
+    _states[0].cfa_value.set_undefined_rule();
+}
+
+/**
+ * Set the work budget to be consumed when evaluating CFA programs and DWARF expressions. Note that the budget is
+ * copied along with the state on assignment.
+ *
+ * @param budget The work budget, or NULL to perform unbounded evaluation. This is a borrowed reference, and must
+ * remain valid for the lifetime of the state, or until replaced.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_work_budget (plcrash_async_work_budget_t *budget) {
+    _work_budget = budget;
 }
 
 /**
@@ -112,58 +114,51 @@ dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_state (void) {
  * @param regnum The DWARF register number.
  * @param rule The DWARF CFA rule for @a regnum.
  * @param value The data value to be used when interpreting @a rule. May either be signed or unsigned.
+ *
+ * @return Returns true on success, or false if @a regnum falls outside of the dense column range and no
+ * overflow entries remain.
  */
 template <typename machine_ptr, typename machine_ptr_s>
 bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_register (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t rule, machine_ptr value) {
     PLCF_ASSERT(rule <= UINT8_MAX);
-    
-    /* Check for an existing entry, or find the target entry off which we'll chain our entry */
-    unsigned int bucket = regnum % (sizeof(_table_stack[0]) / sizeof(_table_stack[0][0]));
-    
-    dwarf_cfa_reg_entry_t *parent = NULL;
-    for (uint8_t parent_idx = _table_stack[_table_depth][bucket]; parent_idx != DWARF_CFA_STATE_INVALID_ENTRY_IDX; parent_idx = parent->next) {
-        parent = &_entries[parent_idx];
-        
-        /* If an existing entry is found, we can re-use it directly */
-        if (parent->regnum == regnum) {
-            parent->value = value;
-            parent->rule = rule;
+    dwarf_cfa_reg_state_t *state = &_states[_table_depth];
+
+    /* Dense columns are indexed directly */
+    if (regnum < _dense_columns) {
+        uint64_t bit = 1ULL << regnum;
+        if ((state->valid & bit) == 0) {
+            state->valid |= bit;
+            state->register_count++;
+        }
+
+        state->rules[regnum] = rule;
+        state->values[regnum] = value;
+        return true;
+    }
+
+    /* Check for an existing overflow entry */
+    for (uint8_t i = 0; i < state->overflow_count; i++) {
+        dwarf_cfa_reg_entry_t *entry = &state->overflow[i];
+        if (entry->regnum == regnum) {
+            entry->value = value;
+            entry->rule = rule;
             return true;
         }
-        
-        /* Otherwise, make sure we terminate with parent == last element */
-        if (parent->next == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
-            break;
     }
-    
-    /* 'parent' now either points to the end of the list, or is NULL (in which case the table
-     * slot was empty */
-    dwarf_cfa_reg_entry *entry = NULL;
-    uint8_t entry_idx;
-    
-    /* Fetch a free entry */
-    if (_free_list == DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
+
+    /* Otherwise, allocate a new overflow entry */
+    if (state->overflow_count == DWARF_CFA_STATE_OVERFLOW_REGISTERS) {
         /* No free entries */
         return false;
     }
-    entry_idx = _free_list;
-    entry = &_entries[entry_idx];
-    _free_list = entry->next;
-    
-    /* Intialize the entry */
+
+    dwarf_cfa_reg_entry_t *entry = &state->overflow[state->overflow_count];
     entry->regnum = regnum;
     entry->rule = rule;
     entry->value = value;
-    entry->next = DWARF_CFA_STATE_INVALID_ENTRY_IDX;
-    
-    /* Either insert in the parent, or insert as the first table element */
-    if (parent == NULL) {
-        _table_stack[_table_depth][bucket] = entry_idx;
-    } else {
-        parent->next = entry - _entries;
-    }
-    
-    _register_count[_table_depth]++;
+
+    state->overflow_count++;
+    state->register_count++;
     return true;
 }
 
@@ -177,21 +172,23 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_register (dwarf_cfa_state_
  */
 template <typename machine_ptr, typename machine_ptr_s>
 bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_register_rule (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t *rule, machine_ptr *value) {
-    /* Search for the entry */
-    unsigned int bucket = regnum % (sizeof(_table_stack[0]) / sizeof(_table_stack[0][0]));
-    
-    dwarf_cfa_reg_entry_t *entry = NULL;
-    for (uint8_t entry_idx = _table_stack[_table_depth][bucket]; entry_idx != DWARF_CFA_STATE_INVALID_ENTRY_IDX; entry_idx = entry->next) {
-        entry = &_entries[entry_idx];
-        
-        if (entry->regnum != regnum) {
-            if (entry->next == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
-                break;
-            
+    dwarf_cfa_reg_state_t *state = &_states[_table_depth];
+
+    if (regnum < _dense_columns) {
+        if ((state->valid & (1ULL << regnum)) == 0)
+            return false;
+
+        *value = state->values[regnum];
+        *rule = (plcrash_dwarf_cfa_reg_rule_t) state->rules[regnum];
+        return true;
+    }
+
+    /* Search the overflow entries */
+    for (uint8_t i = 0; i < state->overflow_count; i++) {
+        dwarf_cfa_reg_entry_t *entry = &state->overflow[i];
+        if (entry->regnum != regnum)
             continue;
-        }
-        
-        /* Existing entry found, we can re-use it directly */
+
         *value = entry->value;
         *rule = (plcrash_dwarf_cfa_reg_rule_t) entry->rule;
         return true;
@@ -208,31 +205,26 @@ bool dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_register_rule (dwarf_cfa_s
  */
 template <typename machine_ptr, typename machine_ptr_s>
 void dwarf_cfa_state<machine_ptr, machine_ptr_s>::remove_register (dwarf_cfa_state_regnum_t regnum) {
-    /* Search for the entry */
-    unsigned int bucket = regnum % (sizeof(_table_stack[0]) / sizeof(_table_stack[0][0]));
-    
-    dwarf_cfa_reg_entry *prev = NULL;
-    dwarf_cfa_reg_entry_t *entry = NULL;
-    for (uint8_t entry_idx = _table_stack[_table_depth][bucket]; entry_idx != DWARF_CFA_STATE_INVALID_ENTRY_IDX; entry_idx = entry->next) {
-        prev = entry;
-        entry = &_entries[entry_idx];
-        
-        if (entry->regnum != regnum)
-            continue;
-        
-        /* Remove from the bucket chain */
-        if (prev != NULL) {
-            prev->next = entry->next;
-        } else {
-            _table_stack[_table_depth][bucket] = entry->next;
+    dwarf_cfa_reg_state_t *state = &_states[_table_depth];
+
+    if (regnum < _dense_columns) {
+        uint64_t bit = 1ULL << regnum;
+        if (state->valid & bit) {
+            state->valid &= ~bit;
+            state->register_count--;
         }
-        
-        /* Re-insert in the free list */
-        entry->next = _free_list;
-        _free_list = entry_idx;
-        
-        /* Decrement the register count */
-        _register_count[_table_depth]--;
+        return;
+    }
+
+    /* Search the overflow entries, replacing a removed entry with the last entry */
+    for (uint8_t i = 0; i < state->overflow_count; i++) {
+        if (state->overflow[i].regnum != regnum)
+            continue;
+
+        state->overflow_count--;
+        state->overflow[i] = state->overflow[state->overflow_count];
+        state->register_count--;
+        return;
     }
 }
 
@@ -241,7 +233,7 @@ void dwarf_cfa_state<machine_ptr, machine_ptr_s>::remove_register (dwarf_cfa_sta
  */
 template <typename machine_ptr, typename machine_ptr_s>
 uint8_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_register_count (void) {
-    return _register_count[_table_depth];
+    return _states[_table_depth].register_count;
 }
 
 
@@ -253,7 +245,7 @@ uint8_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_register_count (void) {
  */
 template <typename machine_ptr, typename machine_ptr_s>
 void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_cfa_register (dwarf_cfa_state_regnum_t regnum, machine_ptr offset) {
-    _cfa_value[_table_depth].set_register_rule(regnum, offset);
+    _states[_table_depth].cfa_value.set_register_rule(regnum, offset);
 }
 
 /**
@@ -264,7 +256,7 @@ void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_cfa_register (dwarf_cfa_st
  */
 template <typename machine_ptr, typename machine_ptr_s>
 void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_cfa_register_signed (dwarf_cfa_state_regnum_t regnum, machine_ptr_s offset) {
-    _cfa_value[_table_depth].set_register_rule_signed(regnum, offset);
+    _states[_table_depth].cfa_value.set_register_rule_signed(regnum, offset);
 }
 
 /**
@@ -275,7 +267,7 @@ void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_cfa_register_signed (dwarf
  */
 template <typename machine_ptr, typename machine_ptr_s>
 void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_cfa_expression (pl_vm_address_t address, pl_vm_size_t length) {
-    _cfa_value[_table_depth].set_expression_rule(address, length);
+    _states[_table_depth].cfa_value.set_expression_rule(address, length);
 }
 
 /**
@@ -283,7 +275,7 @@ void dwarf_cfa_state<machine_ptr, machine_ptr_s>::set_cfa_expression (pl_vm_addr
  */
 template <typename machine_ptr, typename machine_ptr_s>
 dwarf_cfa_rule<machine_ptr, machine_ptr_s> dwarf_cfa_state<machine_ptr, machine_ptr_s>::get_cfa_rule (void) {
-    return _cfa_value[_table_depth];
+    return _states[_table_depth].cfa_value;
 }
 
 /**
@@ -295,8 +287,8 @@ dwarf_cfa_rule<machine_ptr, machine_ptr_s> dwarf_cfa_state<machine_ptr, machine_
 template <typename machine_ptr, typename machine_ptr_s>
 dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>::dwarf_cfa_state_iterator(dwarf_cfa_state<machine_ptr, machine_ptr_s> *stack) {
     _stack = stack;
-    _bucket_idx = 0;
-    _cur_entry_idx = DWARF_CFA_STATE_INVALID_ENTRY_IDX;
+    _remaining = stack->_states[stack->_table_depth].valid;
+    _overflow_idx = 0;
 }
 
 /**
@@ -308,38 +300,29 @@ dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>::dwarf_cfa_state_iterator(d
  */
 template <typename machine_ptr, typename machine_ptr_s>
 bool dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>::next (dwarf_cfa_state_regnum_t *regnum, plcrash_dwarf_cfa_reg_rule_t *rule, machine_ptr *value) {
-    /* Fetch the next entry in the bucket chain */
-    if (_cur_entry_idx != DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
-        _cur_entry_idx = _stack->_entries[_cur_entry_idx].next;
-        
-        /* Advance to the next bucket if we've reached the end of the current chain */
-        if (_cur_entry_idx == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
-            _bucket_idx++;
+    typename dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_reg_state_t *state = &_stack->_states[_stack->_table_depth];
+
+    /* Enumerate the defined dense columns, lowest register first */
+    if (_remaining != 0) {
+        dwarf_cfa_state_regnum_t column = __builtin_ctzll(_remaining);
+        _remaining &= _remaining - 1;
+
+        *regnum = column;
+        *value = state->values[column];
+        *rule = (plcrash_dwarf_cfa_reg_rule_t) state->rules[column];
+        return true;
     }
-    
-    /*
-     * On the first iteration, or after the end of a bucket chain has been reached, find the next valid bucket chain.
-     * Otherwise, we have a valid bucket chain and simply need the next entry.
-     */
-    if (_cur_entry_idx == DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
-        for (; _bucket_idx < DWARF_CFA_STATE_BUCKET_COUNT; _bucket_idx++) {
-            if (_stack->_table_stack[_stack->_table_depth][_bucket_idx] != DWARF_CFA_STATE_INVALID_ENTRY_IDX) {
-                _cur_entry_idx = _stack->_table_stack[_stack->_table_depth][_bucket_idx];
-                break;
-            }
-        }
-        
-        /* If we get here without a valid entry, we've hit the end of all bucket chains. */
-        if (_cur_entry_idx == DWARF_CFA_STATE_INVALID_ENTRY_IDX)
-            return false;
+
+    /* Then the overflow entries */
+    if (_overflow_idx < state->overflow_count) {
+        typename dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_reg_entry_t *entry = &state->overflow[_overflow_idx++];
+        *regnum = entry->regnum;
+        *value = entry->value;
+        *rule = (plcrash_dwarf_cfa_reg_rule_t) entry->rule;
+        return true;
     }
-    
-    
-    typename dwarf_cfa_state<machine_ptr, machine_ptr_s>::dwarf_cfa_reg_entry_t *entry = &_stack->_entries[_cur_entry_idx];
-    *regnum = entry->regnum;
-    *value = entry->value;
-    *rule = (plcrash_dwarf_cfa_reg_rule_t) entry->rule;
-    return true;
+
+    return false;
 }
 
 /* Provide explicit 32/64-bit instantiations */
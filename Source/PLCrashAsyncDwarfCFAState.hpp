@@ -31,9 +31,11 @@
 #include <stdint.h>
 
 #include "PLCrashAsync.h"
+#include "PLCrashAsyncMObject.h"
 #include "PLCrashAsyncDwarfFDE.hpp"
 #include "PLCrashAsyncDwarfCIE.hpp"
 #include "PLCrashAsyncDwarfPrimitives.hpp"
+#include "PLCrashAsyncWorkBudget.h"
 
 #include "PLCrashFeatureConfig.h"
 
@@ -50,8 +52,9 @@ namespace plcrash { namespace async {
 /* Maximum DWARF register number supported by dwarf_cfa_state and dwarf_cfa_state_regnum_t. */
 #define DWARF_CFA_STATE_REGNUM_MAX UINT32_MAX
 
-/* Consumes around 1.65k (on 32-bit and 64-bit systems). */
-#define DWARF_CFA_STATE_MAX_REGISTERS 100
+/* Maximum number of registers with DWARF register numbers outside of the dense column range that may be
+ * set in a single state. */
+#define DWARF_CFA_STATE_OVERFLOW_REGISTERS 8
 
 template <typename machine_ptr, typename machine_ptr_s> class dwarf_cfa_state_iterator;
 
@@ -234,80 +237,102 @@ public:
 /**
  * @internal
  *
- * Manages CFA register table row, using sparsely allocated register column entries. The class represents
- * a single address-based row within the CFA register table, and supports applying deltas to the row
- * register state as required for evaluation of a CFA opcode stream.
+ * Register column configuration for dwarf_cfa_state, specialized by target word size.
  *
- * Register numbers are sparsely allocated in the architecture-specific extensions to the DWARF spec,
- * requiring a solution other than allocating arrays large enough to hold the largest possible register number.
- * For example, ARM allocates or has set aside register values up to 8192, with 8192–16383 reserved for additional
- * vendor co-processor allocations.
+ * DWARF register numbers below @a dense_columns are stored in a directly indexed column array; the column
+ * count is chosen to cover the registers actually referenced by CFA programs on each supported architecture.
+ * Any other register numbers are stored in a small overflow table of DWARF_CFA_STATE_OVERFLOW_REGISTERS entries.
+ */
+template <typename machine_ptr> struct dwarf_cfa_state_config;
+
+/** 32-bit targets: i386 (0-8) and ARM core registers (0-15). */
+template <> struct dwarf_cfa_state_config<uint32_t> {
+    /** Number of directly indexed register columns. */
+    static const uint32_t dense_columns = 16;
+};
+
+/** 64-bit targets: x86-64 (0-16), and ARM64 general purpose registers (0-31). */
+template <> struct dwarf_cfa_state_config<uint64_t> {
+    /** Number of directly indexed register columns. */
+    static const uint32_t dense_columns = 32;
+};
+
+/**
+ * @internal
  *
- * The actual total number of supported, active registers is much smaller. This class is built to decrease the
- * total amount of fixed stack space to be allocated.
+ * Manages CFA register table row. The class represents a single address-based row within the CFA register table,
+ * and supports applying deltas to the row register state as required for evaluation of a CFA opcode stream.
  *
- * @todo If we introduce our own async-safe heap allocator, it may be preferrable to use the heap for entries.
+ * Register numbers are sparsely allocated in the architecture-specific extensions to the DWARF spec; for example,
+ * ARM allocates or has set aside register values up to 8192, with 8192–16383 reserved for additional vendor
+ * co-processor allocations. The registers actually referenced by CFA programs are generally limited to the
+ * low-numbered core registers, however, and these are stored in a dense, directly indexed column array
+ * sized by dwarf_cfa_state_config. Registers outside of that range are stored in a small overflow table.
+ *
+ * Each saved state (DW_CFA_remember_state) is a complete copy of the register row; up to DWARF_CFA_STATE_MAX_STATES
+ * states are available. The full state consumes around 1.3k on 32-bit targets, and 2.7k on 64-bit targets.
  */
 template <typename machine_ptr, typename machine_ptr_s>
 class dwarf_cfa_state {
 private:
     /* Private configuration defines */
 #define DWARF_CFA_STATE_MAX_STATES 6
-#define DWARF_CFA_STATE_BUCKET_COUNT 14
-#define DWARF_CFA_STATE_INVALID_ENTRY_IDX UINT8_MAX
 
-    /** A single register entry */
+    /** Number of directly indexed register columns */
+    static const uint32_t _dense_columns = dwarf_cfa_state_config<machine_ptr>::dense_columns;
+
+    /** An overflow register entry, used for registers outside of the dense column range. */
     typedef struct dwarf_cfa_reg_entry {
         /**
          * Associated rule value. Must be cast to a uint64_t value when evalating PLCRASH_DWARF_CFA_REG_RULE_EXPRESSION and
          * PLCRASH_DWARF_CFA_REG_RULE_VAL_EXPRESSION rules.
          */
-        int64_t value;
+        machine_ptr value;
 
         /** The DWARF register number */
         dwarf_cfa_state_regnum_t regnum;
 
         /** DWARF register rule */
         uint8_t rule;
-        
-        /** Next entry in the list, or NULL */
-        uint8_t next;
     } dwarf_cfa_reg_entry_t;
-    
-    /** Current call frame value configuration. */
-    dwarf_cfa_rule<machine_ptr,machine_ptr_s> _cfa_value[DWARF_CFA_STATE_MAX_STATES];
-    
-    /** Current number of defined register entries */
-    uint8_t _register_count[DWARF_CFA_STATE_MAX_STATES];
 
-    /**
-     * Active entry lookup table. Maps from regnum to a table index. Most architectures
-     * define <20 valid register numbers.
-     *
-     * This provides a maximum of MAX_STATES saved states (DW_CFA_remember_state), with BUCKET_COUNT register
-     * buckets available in each stack entry. Each bucket may hold multiple register entries; the
-     * maximum number of register entries depends on the configured size of _entries.
-     *
-     * The pre-allocated entry set is shared between each saved state, as to decrease total
-     * memory cost of unused states.
-     */
-    uint8_t _table_stack[DWARF_CFA_STATE_MAX_STATES][DWARF_CFA_STATE_BUCKET_COUNT];
+    /** A single register table row. */
+    typedef struct dwarf_cfa_reg_state {
+        /** Current call frame value configuration. */
+        dwarf_cfa_rule<machine_ptr,machine_ptr_s> cfa_value;
 
-    /** Current position in the table stack */
-    uint8_t _table_depth;
+        /** Bitmask of defined dense columns; bit N is set if a rule is defined for register N. */
+        uint64_t valid;
 
-    /** Free list of entries. These are unused records from the entries table. */
-    uint8_t _free_list;
+        /** Total number of defined register entries, including overflow entries */
+        uint8_t register_count;
 
-    /**
-     * Statically allocated set of entries; these will be inserted into the free
-     * list upon construction, and then moved into the entry table as registers
-     * are set.
-     */
-    dwarf_cfa_reg_entry_t _entries[DWARF_CFA_STATE_MAX_REGISTERS];
+        /** Number of defined overflow entries */
+        uint8_t overflow_count;
+
+        /** Dense column rules, indexed by register number. Only valid if the column's bit is set in @a valid. */
+        uint8_t rules[_dense_columns];
+
+        /** Dense column rule values, indexed by register number. Only valid if the column's bit is set in @a valid. */
+        machine_ptr values[_dense_columns];
+
+        /** Overflow entries, of which the first @a overflow_count are defined. */
+        dwarf_cfa_reg_entry_t overflow[DWARF_CFA_STATE_OVERFLOW_REGISTERS];
+    } dwarf_cfa_reg_state_t;
+
+    /** State stack. The current state is at _states[_table_depth]. */
+    dwarf_cfa_reg_state_t _states[DWARF_CFA_STATE_MAX_STATES];
+
+    /** Current position in the state stack */
+    uint8_t _table_depth;
+
+    /** The work budget consumed by eval_program() and apply_state(), or NULL. */
+    plcrash_async_work_budget_t *_work_budget;
 
 public:
     dwarf_cfa_state (void);
+
+    void set_work_budget (plcrash_async_work_budget_t *budget);
     
     plcrash_error_t eval_program (plcrash_async_mobject_t *mobj,
                                   machine_ptr pc,
@@ -317,13 +342,16 @@ public:
                                   const plcrash_async_byteorder_t *byteorder,
                                   pl_vm_address_t address,
                                   pl_vm_off_t offset,
-                                  pl_vm_size_t length);
+                                  pl_vm_size_t length,
+                                  bool *location_dependent = NULL,
+                                  machine_ptr *next_location = NULL);
     
     plcrash_error_t apply_state (task_t task,
                                  plcrash_async_dwarf_cie_info_t *cie_info,
                                  const plcrash_async_thread_state_t *thread_state,
                                  const plcrash_async_byteorder_t *byteorder,
-                                 plcrash_async_thread_state_t *new_thread_state);
+                                 plcrash_async_thread_state_t *new_thread_state,
+                                 plcrash_async_mobject_t *stack_window = NULL);
     
     bool set_register (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t rule, machine_ptr value);
     bool get_register_rule (dwarf_cfa_state_regnum_t regnum, plcrash_dwarf_cfa_reg_rule_t *rule, machine_ptr *value);
@@ -351,11 +379,11 @@ public:
 template <typename machine_ptr, typename machine_ptr_s>
 class dwarf_cfa_state_iterator {
 private:
-    /** Current bucket index */
-    uint8_t _bucket_idx;
-    
-    /** Current entry index, or DWARF_CFA_STATE_INVALID_ENTRY_IDX if iteration has not started */
-    uint8_t _cur_entry_idx;
+    /** Dense columns that have not yet been enumerated */
+    uint64_t _remaining;
+
+    /** Next overflow entry index */
+    uint8_t _overflow_idx;
     
     /** Borrowed reference to the backing DWARF CFA state */
     dwarf_cfa_state<machine_ptr, machine_ptr_s> *_stack;
@@ -46,13 +46,15 @@ using namespace plcrash::async;
 
 template <typename machine_ptr, typename machine_ptr_s>
 static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task,
+                                                                     plcrash_async_mobject_t *stack_window,
                                                                      const plcrash_async_thread_state_t *thread_state,
                                                                      const plcrash_async_byteorder_t *byteorder,
                                                                      plcrash_async_thread_state_t *new_thread_state,
                                                                      machine_ptr cfa_val,
                                                                      plcrash_regnum_t pl_regnum,
                                                                      plcrash_dwarf_cfa_reg_rule_t dw_rule,
-                                                                     machine_ptr dw_value);
+                                                                     machine_ptr dw_value,
+                                                                     plcrash_async_work_budget_t *budget);
 /**
  * Evaluate a DWARF CFA program, as defined in the DWARF 4 Specification, Section 6.4.2, fetching
  * any state -- and applying  any state changes -- to the target instance.
@@ -73,9 +75,16 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
  * @param address The task-relative address within @a mobj at which the opcodes will be fetched.
  * @param offset An offset to be applied to @a address.
  * @param length The total length of the opcodes readable at @a address + @a offset.
+ * @param location_dependent If non-NULL, on success will be set to true if the program modified the CFA location
+ * (eg, via DW_CFA_advance_loc or DW_CFA_set_loc), in which case the resulting state depends on @a pc and
+ * @a initial_pc_value. If false, the resulting state is independent of both values.
+ * @param next_location If non-NULL, on success will be set to the location at which the next row of the CFA table
+ * begins. The resulting state is valid for all addresses from @a pc up to (but not including) this location. If the
+ * program defines no further rows, or @a pc is 0, this will be set to 0.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t values
- * on failure. If an invalid opcode is detected, PLCRASH_ENOTSUP will be returned.
+ * on failure. If an invalid opcode is detected, PLCRASH_ENOTSUP will be returned. If the work budget supplied via
+ * set_work_budget() is exhausted, PLCRASH_EBUDGET will be returned.
  *
  * @todo Consider defining updated status codes or error handling to provide more structured
  * error data on failure.
@@ -89,7 +98,9 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
                                                                            const plcrash_async_byteorder_t *byteorder,
                                                                            pl_vm_address_t address,
                                                                            pl_vm_off_t offset,
-                                                                           pl_vm_size_t length)
+                                                                           pl_vm_size_t length,
+                                                                           bool *location_dependent,
+                                                                           machine_ptr *next_location)
 {
     plcrash::async::dwarf_opstream opstream;
     plcrash_error_t err;
@@ -188,6 +199,11 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
     while ((pc == 0 || location <= pc) && opstream.read_intU(&opcode)) {
         uint8_t const_operand = 0;
 
+        if (!plcrash_async_work_budget_consume(_work_budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 1)) {
+            PLCF_DEBUG("DWARF work budget exhausted while evaluating CFA opcodes");
+            return PLCRASH_EBUDGET;
+        }
+
         /* Check for opcodes encoded in the top two bits, with an operand
          * in the bottom 6 bits. */
         
@@ -442,6 +458,12 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
         }
     }
 
+    if (location_dependent != NULL)
+        *location_dependent = (location != initial_pc_value);
+
+    if (next_location != NULL)
+        *next_location = (pc != 0 && location > pc) ? location : 0;
+
     return PLCRASH_ESUCCESS;
 }
 
@@ -454,6 +476,8 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::eval_program (plcra
  * @param thread_state The current thread state corresponding to @a entry.
  * @param byteorder The target's byte order.
  * @param new_thread_state The new thread state to be initialized.
+ * @param stack_window A pre-mapped window of the target thread's stack from which saved register loads will be
+ * served when possible, or NULL.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or a standard pclrash_error_t code if an error occurs.
  */
@@ -462,7 +486,8 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
                                                                           plcrash_async_dwarf_cie_info_t *cie_info,
                                                                           const plcrash_async_thread_state_t *thread_state,
                                                                           const plcrash_async_byteorder_t *byteorder,
-                                                                          plcrash_async_thread_state_t *new_thread_state)
+                                                                          plcrash_async_thread_state_t *new_thread_state,
+                                                                          plcrash_async_mobject_t *stack_window)
 {
     plcrash_error_t err;
 
@@ -514,7 +539,7 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
                 return err;
             }
             
-            if ((err = plcrash_async_dwarf_expression_eval<machine_ptr, machine_ptr_s>(&mobj, task, thread_state, byteorder, cfa_rule.expression_address(), 0x0, cfa_rule.expression_length(), NULL, 0, &cfa_val)) != PLCRASH_ESUCCESS) {
+            if ((err = plcrash_async_dwarf_expression_eval<machine_ptr, machine_ptr_s>(&mobj, task, thread_state, byteorder, cfa_rule.expression_address(), 0x0, cfa_rule.expression_length(), NULL, 0, &cfa_val, _work_budget)) != PLCRASH_ESUCCESS) {
                 PLCF_DEBUG("CFA eval_64 failed");
                 return err;
             }
@@ -550,7 +575,7 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
         }
         
         /* Apply the register rule */
-        if ((err = plcrash_async_dwarf_cfa_state_apply_register<machine_ptr, machine_ptr_s>(task, thread_state, byteorder, new_thread_state, cfa_val, pl_regnum, dw_rule, dw_value)) != PLCRASH_ESUCCESS)
+        if ((err = plcrash_async_dwarf_cfa_state_apply_register<machine_ptr, machine_ptr_s>(task, stack_window, thread_state, byteorder, new_thread_state, cfa_val, pl_regnum, dw_rule, dw_value, _work_budget)) != PLCRASH_ESUCCESS)
             return err;
         
         /* If the target register is defined as the return address (and is not already the IP), copy the value to the IP.  */
@@ -567,6 +592,7 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
  * Apply a single register rule to @a new_thread_state.
  *
  * @param task The task containing any data referenced by @a thread_state.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
  * @param thread_state The current thread state corresponding to @a entry.
  * @param byteorder The target's byte order.
  * @param new_thread_state The new thread state to be initialized.
@@ -574,18 +600,21 @@ plcrash_error_t dwarf_cfa_state<machine_ptr, machine_ptr_s>::apply_state (task_t
  * @param pl_regnum The register to which @a dw_rule and @a dw_value will be applied.
  * @param dw_rule The DWARF register rule to be used to derive the value for @a pl_regnum.
  * @param dw_value The DWARF value to be used with @a dw_rule
+ * @param budget The work budget to be charged for any DWARF expression evaluation, or NULL.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or a standard pclrash_error_t code if an error occurs.
  */
 template <typename machine_ptr, typename machine_ptr_s>
 static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task,
+                                                                     plcrash_async_mobject_t *stack_window,
                                                                      const plcrash_async_thread_state_t *thread_state,
                                                                      const plcrash_async_byteorder_t *byteorder,
                                                                      plcrash_async_thread_state_t *new_thread_state,
                                                                      machine_ptr cfa_val,
                                                                      plcrash_regnum_t pl_regnum,
                                                                      plcrash_dwarf_cfa_reg_rule_t dw_rule,
-                                                                     machine_ptr dw_value)
+                                                                     machine_ptr dw_value,
+                                                                     plcrash_async_work_budget_t *budget)
 {
     plcrash_error_t err;
     uint8_t greg_size = plcrash_async_thread_state_get_greg_size(thread_state);
@@ -600,7 +629,7 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
     /* Apply the rule */
     switch (dw_rule) {
         case PLCRASH_DWARF_CFA_REG_RULE_OFFSET: {
-            if ((err = plcrash_async_task_memcpy(task, cfa_val, (machine_ptr_s)dw_value, vptr, greg_size)) != PLCRASH_ESUCCESS) {
+            if ((err = plcrash_async_mobject_task_memcpy(stack_window, task, cfa_val, (machine_ptr_s)dw_value, vptr, greg_size)) != PLCRASH_ESUCCESS) {
                 PLCF_DEBUG("Failed to read offset(N) register value: %d", err);
                 return err;
             }
@@ -663,7 +692,7 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
             plcrash_greg_t regval;
             if (m64) {
                 uint64_t initial_state[] = { cfa_val };
-                if ((err = plcrash_async_dwarf_expression_eval<uint64_t, int64_t>(&mobj, task, thread_state, byteorder, expr_addr, 0, expr_len, initial_state, 1, &rvalue.v64)) != PLCRASH_ESUCCESS) {
+                if ((err = plcrash_async_dwarf_expression_eval<uint64_t, int64_t>(&mobj, task, thread_state, byteorder, expr_addr, 0, expr_len, initial_state, 1, &rvalue.v64, budget)) != PLCRASH_ESUCCESS) {
                     plcrash_async_mobject_free(&mobj);
                     PLCF_DEBUG("CFA eval_64 failed");
                     return err;
@@ -672,7 +701,7 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
                 regval = rvalue.v64;
             } else {
                 uint32_t initial_state[] = { cfa_val };
-                if ((err = plcrash_async_dwarf_expression_eval<uint32_t, int32_t>(&mobj, task, thread_state, byteorder, expr_addr, 0, expr_len, initial_state, 1, &rvalue.v32)) != PLCRASH_ESUCCESS) {
+                if ((err = plcrash_async_dwarf_expression_eval<uint32_t, int32_t>(&mobj, task, thread_state, byteorder, expr_addr, 0, expr_len, initial_state, 1, &rvalue.v32, budget)) != PLCRASH_ESUCCESS) {
                     plcrash_async_mobject_free(&mobj);
                     PLCF_DEBUG("CFA eval_32 failed");
                     return err;
@@ -686,7 +715,7 @@ static plcrash_error_t plcrash_async_dwarf_cfa_state_apply_register (task_t task
             
             /* Dereference the target address, if using the non-value EXPRESSION rule */
             if (dw_rule == PLCRASH_DWARF_CFA_REG_RULE_EXPRESSION) {
-                if ((err = plcrash_async_task_memcpy(task, regval, 0, vptr, greg_size)) != PLCRASH_ESUCCESS) {
+                if ((err = plcrash_async_mobject_task_memcpy(stack_window, task, regval, 0, vptr, greg_size)) != PLCRASH_ESUCCESS) {
                     PLCF_DEBUG("Failed to read register value from expression result: %d", err);
                     return err;
                 }
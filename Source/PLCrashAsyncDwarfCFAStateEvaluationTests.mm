@@ -408,6 +408,28 @@ using namespace plcrash::async;
     PERFORM_EVAL_TEST(opcodes, 0, PLCRASH_ESUCCESS);
 }
 
+/** Test reporting of location-dependent evaluation results. */
+- (void) testLocationDependent {
+    plcrash_async_mobject_t mobj;
+    bool location_dependent;
+
+    /* A program that does not modify the location is location-independent */
+    uint8_t independent[] = { DW_CFA_def_cfa, 0x1, 0x8, DW_CFA_nop };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &independent, sizeof(independent), true), @"Failed to initialize mobj");
+    location_dependent = true;
+    STAssertEquals(PLCRASH_ESUCCESS, _stack.eval_program(&mobj, 0x10, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &independent, 0, sizeof(independent), &location_dependent), @"Evaluation failed");
+    STAssertFalse(location_dependent, @"Program should not be location dependent");
+    plcrash_async_mobject_free(&mobj);
+
+    /* A program that advances the location is location-dependent */
+    uint8_t dependent[] = { DW_CFA_advance_loc|0x1, DW_CFA_def_cfa, 0x1, 0x8 };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &dependent, sizeof(dependent), true), @"Failed to initialize mobj");
+    location_dependent = false;
+    STAssertEquals(PLCRASH_ESUCCESS, _stack.eval_program(&mobj, 0x10, 0x0, &_cie, _ptr_state, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &dependent, 0, sizeof(dependent), &location_dependent), @"Evaluation failed");
+    STAssertTrue(location_dependent, @"Program should be location dependent");
+    plcrash_async_mobject_free(&mobj);
+}
+
 #pragma mark CFA Application
 
 /**
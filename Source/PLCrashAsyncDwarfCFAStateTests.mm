@@ -37,6 +37,9 @@
 
 using namespace plcrash::async;
 
+/* The maximum number of registers that may be set in a 64-bit state, using sequential register numbers */
+#define TEST_MAX_REGISTERS (dwarf_cfa_state_config<uint64_t>::dense_columns + DWARF_CFA_STATE_OVERFLOW_REGISTERS)
+
 @interface PLCrashAsyncDwarfCFAStateTests : PLCrashTestCase {
 @private
 }
@@ -78,20 +81,20 @@ using namespace plcrash::async;
     dwarf_cfa_state<uint64_t, int64_t> stack;
 
     /* Try using all available entries */
-    for (int i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (int i = 0; i < TEST_MAX_REGISTERS; i++) {
         STAssertTrue(stack.set_register(i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, i), @"Failed to add register");
         STAssertEquals((uint8_t)(i+1), stack.get_register_count(), @"Incorrect number of registers");
     }
 
     /* Ensure that additional requests fail */
-    STAssertFalse(stack.set_register(DWARF_CFA_STATE_MAX_REGISTERS, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 100), @"A register was somehow allocated from an empty free list");
+    STAssertFalse(stack.set_register(TEST_MAX_REGISTERS, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 100), @"A register was somehow allocated from a full overflow table");
     
     /* Verify that modifying an already-added register succeeds */
     STAssertTrue(stack.set_register(0, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 0), @"Failed to modify existing register");
-    STAssertEquals((uint8_t)DWARF_CFA_STATE_MAX_REGISTERS, stack.get_register_count(), @"Register count was bumped when modifying an existing register");
+    STAssertEquals((uint8_t)TEST_MAX_REGISTERS, stack.get_register_count(), @"Register count was bumped when modifying an existing register");
 
     /* Verify the register values that were added */
-    for (uint32_t i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (uint32_t i = 0; i < TEST_MAX_REGISTERS; i++) {
         plcrash_dwarf_cfa_reg_rule_t rule;
         uint64_t value;
         
@@ -114,13 +117,42 @@ using namespace plcrash::async;
     STAssertEquals((int64_t)value, INT64_MIN, @"Incorrect value");
 }
 
+/**
+ * Test handling of register numbers outside of the dense column range.
+ */
+- (void) testSetOverflowRegister {
+    dwarf_cfa_state<uint64_t, int64_t> stack;
+    plcrash_dwarf_cfa_reg_rule_t rule;
+    uint64_t value;
+
+    /* Fill the overflow table with (ARM-style) high register numbers */
+    for (uint32_t i = 0; i < DWARF_CFA_STATE_OVERFLOW_REGISTERS; i++)
+        STAssertTrue(stack.set_register(8192 + i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, i), @"Failed to add register");
+
+    STAssertFalse(stack.set_register(8192 + DWARF_CFA_STATE_OVERFLOW_REGISTERS, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 0), @"Overflow table was somehow exceeded");
+
+    /* Dense columns remain available */
+    STAssertTrue(stack.set_register(0, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 0), @"Failed to add dense register");
+    STAssertEquals((uint8_t)(DWARF_CFA_STATE_OVERFLOW_REGISTERS + 1), stack.get_register_count(), @"Incorrect number of registers");
+
+    /* Removing an overflow entry frees its slot, and leaves the remaining entries intact */
+    stack.remove_register(8192);
+    STAssertFalse(stack.get_register_rule(8192, &rule, &value), @"Register info was returned for a removed register");
+    STAssertTrue(stack.set_register(8192 + DWARF_CFA_STATE_OVERFLOW_REGISTERS, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, 42), @"Failed to add register");
+
+    for (uint32_t i = 1; i <= DWARF_CFA_STATE_OVERFLOW_REGISTERS; i++) {
+        STAssertTrue(stack.get_register_rule(8192 + i, &rule, &value), @"Failed to fetch info for entry");
+        STAssertEquals((uint64_t)(i == DWARF_CFA_STATE_OVERFLOW_REGISTERS ? 42 : i), value, @"Incorrect value");
+    }
+}
+
 /**
  * Test enumerating registers in the current state.
  */
 - (void) testEnumerateRegisters {
     dwarf_cfa_state<uint64_t, int64_t> stack;
     
-    STAssertTrue(DWARF_CFA_STATE_MAX_REGISTERS > 32, @"This test assumes a minimum of 32 registers");
+    STAssertTrue(TEST_MAX_REGISTERS > 32, @"This test assumes a minimum of 32 registers");
 
     /* Allocate all available entries */
     for (int i = 0; i < 32; i++) {
@@ -155,24 +187,24 @@ using namespace plcrash::async;
     dwarf_cfa_state<uint64_t, int64_t> stack;
     
     /* Insert rules for all entries */
-    for (int i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (int i = 0; i < TEST_MAX_REGISTERS; i++) {
         STAssertTrue(stack.set_register(i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, i), @"Failed to add register");
         STAssertEquals((uint8_t)(i+1), stack.get_register_count(), @"Incorrect number of registers");
     }
 
     /* Remove a quarter of the entries */
     uint8_t remove_count = 0;
-    for (int i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (int i = 0; i < TEST_MAX_REGISTERS; i++) {
         if (i % 2) {
             stack.remove_register(i);
             remove_count++;
         }
     }
 
-    STAssertEquals(stack.get_register_count(), (uint8_t)(100-remove_count), @"Register count was not correctly updated");
+    STAssertEquals(stack.get_register_count(), (uint8_t)(TEST_MAX_REGISTERS-remove_count), @"Register count was not correctly updated");
     
     /* Verify the full set of registers (including verifying that the removed registers were, in fact, removed) */
-    for (uint32_t i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (uint32_t i = 0; i < TEST_MAX_REGISTERS; i++) {
         plcrash_dwarf_cfa_reg_rule_t rule;
         uint64_t value;
         
@@ -186,18 +218,18 @@ using namespace plcrash::async;
     }
     
     /* Re-add the missing registers (verifying that they were correctly added to the free list) */
-    for (int i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (int i = 0; i < TEST_MAX_REGISTERS; i++) {
         if (i % 2)
             STAssertTrue(stack.set_register(i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, i), @"Failed to add register");
     }
     
-    STAssertEquals(stack.get_register_count(), (uint8_t)100, @"Register count was not correctly updated");
+    STAssertEquals(stack.get_register_count(), (uint8_t)TEST_MAX_REGISTERS, @"Register count was not correctly updated");
     
     /* Ensure that additional requests fail */
-    STAssertFalse(stack.set_register(DWARF_CFA_STATE_MAX_REGISTERS+1, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, DWARF_CFA_STATE_MAX_REGISTERS+1), @"A register was somehow allocated from an empty free list");
+    STAssertFalse(stack.set_register(TEST_MAX_REGISTERS+1, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, TEST_MAX_REGISTERS+1), @"A register was somehow allocated from a full overflow table");
     
     /* Verify the register values that were added */
-    for (uint32_t i = 0; i < DWARF_CFA_STATE_MAX_REGISTERS; i++) {
+    for (uint32_t i = 0; i < TEST_MAX_REGISTERS; i++) {
         plcrash_dwarf_cfa_reg_rule_t rule;
         uint64_t value;
         
@@ -220,32 +252,34 @@ using namespace plcrash::async;
     STAssertFalse(stack.pop_state(), @"Popping succeeded on an empty state stack");
     
     /* Configure initial test state */
-    for (int i = 0; i < (DWARF_CFA_STATE_MAX_REGISTERS/4); i++) {
-        STAssertTrue(stack.set_register(i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, DWARF_CFA_STATE_MAX_REGISTERS-i), @"Failed to add register");
+    for (int i = 0; i < (TEST_MAX_REGISTERS/4); i++) {
+        STAssertTrue(stack.set_register(i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, TEST_MAX_REGISTERS-i), @"Failed to add register");
         STAssertEquals((uint8_t)(i+1), stack.get_register_count(), @"Incorrect number of registers");
     }
 
     stack.set_cfa_register(10, 20);
     
-    /* Try pushing and initializing new state */
+    /* Try pushing a new state; it should be initialized as a copy of the saved state */
     STAssertTrue(stack.push_state(), @"Failed to push a new state");
-    STAssertEquals((uint8_t)0, stack.get_register_count(), @"New state should have a register count of 0");
+    STAssertEquals((uint8_t)(TEST_MAX_REGISTERS/4), stack.get_register_count(), @"New state should copy the saved register count");
+    STAssertEquals(DWARF_CFA_STATE_CFA_TYPE_REGISTER, stack.get_cfa_rule().type(), @"New state should copy the saved CFA value");
 
-    for (int i = 0; i < (DWARF_CFA_STATE_MAX_REGISTERS/4); i++) {
+    for (int i = 0; i < (TEST_MAX_REGISTERS/4); i++) {
         STAssertTrue(stack.set_register(i, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, i), @"Failed to add register");
-        STAssertEquals((uint8_t)(i+1), stack.get_register_count(), @"Incorrect number of registers");
+        STAssertEquals((uint8_t)(TEST_MAX_REGISTERS/4), stack.get_register_count(), @"Incorrect number of registers");
     }
 
-    STAssertEquals(DWARF_CFA_STATE_CFA_TYPE_UNDEFINED, stack.get_cfa_rule().type(), @"Unexpected initial CFA value");
+    stack.set_cfa_expression(25, 10);
+    stack.remove_register(0);
     
     /* Pop the state, verify that our original state was saved */
     STAssertTrue(stack.pop_state(), @"Failed to pop current state");
-    for (uint32_t i = 0; i < (DWARF_CFA_STATE_MAX_REGISTERS/4); i++) {
+    for (uint32_t i = 0; i < (TEST_MAX_REGISTERS/4); i++) {
         plcrash_dwarf_cfa_reg_rule_t rule;
         uint64_t value;
         
         STAssertTrue(stack.get_register_rule(i, &rule, &value), @"Failed to fetch info for entry");
-        STAssertEquals((uint64_t)(DWARF_CFA_STATE_MAX_REGISTERS-i), value, @"Incorrect value");
+        STAssertEquals((uint64_t)(TEST_MAX_REGISTERS-i), value, @"Incorrect value");
         STAssertEquals(rule, PLCRASH_DWARF_CFA_REG_RULE_OFFSET, @"Incorrect rule");
     }
     
@@ -0,0 +1,415 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncDwarfCFATable.h"
+
+#include "PLCrashAsyncDwarfEncoding.hpp"
+#include "PLCrashAsyncDwarfCFAState.hpp"
+
+#include "PLCrashFeatureConfig.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <libkern/OSAtomic.h>
+
+#include <limits>
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+
+using namespace plcrash::async;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_dwarf
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Growable row and rule storage used while compiling a CFA table.
+ */
+struct plcrash_async_dwarf_cfa_table_builder {
+    /** The table being built. */
+    plcrash_async_dwarf_cfa_table_t table;
+
+    /** The allocated capacity of table.rows. */
+    size_t row_capacity;
+
+    /** The allocated capacity of table.rules. */
+    size_t rule_capacity;
+};
+
+/*
+ * Ensure that @a *array has capacity for at least @a count elements of @a size bytes, doubling its size as required.
+ * Returns false if the allocation fails.
+ */
+static bool plcrash_async_dwarf_cfa_table_reserve (void **array, size_t *capacity, size_t count, size_t size) {
+    if (count <= *capacity)
+        return true;
+
+    size_t new_capacity = (*capacity == 0) ? 64 : *capacity * 2;
+    while (new_capacity < count)
+        new_capacity *= 2;
+
+    void *new_array = realloc(*array, new_capacity * size);
+    if (new_array == NULL)
+        return false;
+
+    *array = new_array;
+    *capacity = new_capacity;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Append a row describing @a state to @a builder.
+ *
+ * @param builder The table builder.
+ * @param cie_info The CIE from which @a state was derived.
+ * @param pc_start The first address covered by the row.
+ * @param pc_end The end of the address range covered by the row (exclusive).
+ * @param state The CFA state that applies to [pc_start, pc_end).
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the row could not be allocated.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static plcrash_error_t plcrash_async_dwarf_cfa_table_append (plcrash_async_dwarf_cfa_table_builder *builder,
+                                                              plcrash_async_dwarf_cie_info_t *cie_info,
+                                                              uint64_t pc_start,
+                                                              uint64_t pc_end,
+                                                              dwarf_cfa_state<machine_ptr, machine_ptr_s> *state)
+{
+    plcrash_async_dwarf_cfa_table_t *table = &builder->table;
+
+    if (!plcrash_async_dwarf_cfa_table_reserve((void **) &table->rows, &builder->row_capacity, table->row_count + 1, sizeof(table->rows[0])))
+        return PLCRASH_ENOMEM;
+
+    if (!plcrash_async_dwarf_cfa_table_reserve((void **) &table->rules, &builder->rule_capacity, table->rule_count + state->get_register_count(), sizeof(table->rules[0])))
+        return PLCRASH_ENOMEM;
+
+    if (table->rule_count > UINT32_MAX - state->get_register_count()) {
+        PLCF_DEBUG("Exhausted the available CFA table rule indices");
+        return PLCRASH_ENOMEM;
+    }
+
+    plcrash_async_dwarf_cfa_table_row_t *row = &table->rows[table->row_count];
+    row->pc_start = pc_start;
+    row->pc_end = pc_end;
+    row->return_address_register = cie_info->return_address_register;
+    row->cfa_value = 0;
+    row->cfa_expression_length = 0;
+    row->cfa_regnum = 0;
+    row->rule_index = (uint32_t) table->rule_count;
+    row->rule_count = 0;
+
+    /* Save the CFA rule */
+    dwarf_cfa_rule<machine_ptr, machine_ptr_s> cfa_rule = state->get_cfa_rule();
+    row->cfa_type = cfa_rule.type();
+    switch (cfa_rule.type()) {
+        case DWARF_CFA_STATE_CFA_TYPE_UNDEFINED:
+            break;
+
+        case DWARF_CFA_STATE_CFA_TYPE_EXPRESSION:
+            row->cfa_value = cfa_rule.expression_address();
+            row->cfa_expression_length = cfa_rule.expression_length();
+            break;
+
+        case DWARF_CFA_STATE_CFA_TYPE_REGISTER:
+            row->cfa_regnum = cfa_rule.register_number();
+            row->cfa_value = cfa_rule.register_offset();
+            break;
+
+        case DWARF_CFA_STATE_CFA_TYPE_REGISTER_SIGNED:
+            row->cfa_regnum = cfa_rule.register_number();
+            row->cfa_value = (int64_t) cfa_rule.register_offset_signed();
+            break;
+    }
+
+    /* Save the register rules */
+    dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s> iter = dwarf_cfa_state_iterator<machine_ptr, machine_ptr_s>(state);
+    dwarf_cfa_state_regnum_t regnum;
+    plcrash_dwarf_cfa_reg_rule_t rule;
+    machine_ptr value;
+
+    while (iter.next(&regnum, &rule, &value)) {
+        plcrash_async_dwarf_cfa_table_rule_t *entry = &table->rules[table->rule_count++];
+        entry->regnum = regnum;
+        entry->rule = rule;
+        entry->value = (machine_ptr_s) value;
+        row->rule_count++;
+    }
+
+    table->row_count++;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Evaluate every FDE within @a dwarf_section, appending one row to @a builder for each distinct row of the FDE's
+ * CFA table.
+ *
+ * Each row is derived by evaluating the CIE and FDE programs up to the row's starting address, exactly as is done
+ * by the DWARF unwinder for a PC within the row. FDEs that can not be evaluated are skipped; the unwinder will fall
+ * back to interpreting the FDE directly for any addresses not covered by the table.
+ *
+ * @param image The image containing @a dwarf_section.
+ * @param dwarf_section The mapped eh_frame or debug_frame section.
+ * @param is_debug_frame True if @a dwarf_section is a debug_frame section.
+ * @param builder The table builder.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static plcrash_error_t plcrash_async_dwarf_cfa_table_compile_section (plcrash_async_macho_t *image,
+                                                                       plcrash_async_mobject_t *dwarf_section,
+                                                                       bool is_debug_frame,
+                                                                       plcrash_async_dwarf_cfa_table_builder *builder)
+{
+    gnu_ehptr_reader<machine_ptr> ptr_state(image->byteorder);
+    const pl_vm_address_t base_addr = plcrash_async_mobject_base_address(dwarf_section);
+    dwarf_frame_reader reader;
+    plcrash_error_t err;
+
+    if ((err = reader.init(dwarf_section, image->byteorder, image->m64, is_debug_frame, NULL)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not initialize a DWARF parser for %s: %d", image->name, err);
+        return err;
+    }
+
+    /* The most recently parsed CIE; FDEs sharing a CIE are generally adjacent. */
+    plcrash_async_dwarf_cie_info_t cie_info;
+    pl_vm_address_t cie_offset = 0;
+    bool did_init_cie = false;
+
+    plcrash_async_dwarf_fde_info_t fde_info;
+    pl_vm_off_t offset = 0;
+    while (reader.next_fde(&offset, &fde_info) == PLCRASH_ESUCCESS) {
+        /* A PC of 0 requests evaluation of the entire program, and can not be used as a row address. */
+        if (fde_info.pc_start == 0 || fde_info.pc_start >= fde_info.pc_end || fde_info.pc_end > std::numeric_limits<machine_ptr>::max()) {
+            plcrash_async_dwarf_fde_info_free(&fde_info);
+            continue;
+        }
+
+        /* Parse the FDE's CIE, if it differs from the previous FDE's */
+        if (!did_init_cie || cie_offset != fde_info.cie_offset) {
+            if (did_init_cie) {
+                plcrash_async_dwarf_cie_info_free(&cie_info);
+                did_init_cie = false;
+            }
+
+            if ((err = plcrash_async_dwarf_cie_info_init(&cie_info, dwarf_section, image->byteorder, &ptr_state, base_addr + fde_info.cie_offset)) != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to parse CIE at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.cie_offset, err);
+                plcrash_async_dwarf_fde_info_free(&fde_info);
+                continue;
+            }
+
+            cie_offset = fde_info.cie_offset;
+            did_init_cie = true;
+        }
+
+        /* Evaluate each row of the FDE's CFA table */
+        machine_ptr row_start = (machine_ptr) fde_info.pc_start;
+        while (row_start < fde_info.pc_end) {
+            dwarf_cfa_state<machine_ptr, machine_ptr_s> cfa_state;
+            machine_ptr cie_next;
+            machine_ptr fde_next;
+
+            err = cfa_state.eval_program(dwarf_section, row_start, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, base_addr, cie_info.initial_instructions_offset, cie_info.initial_instructions_length, NULL, &cie_next);
+            if (err != PLCRASH_ESUCCESS)
+                break;
+
+            err = cfa_state.eval_program(dwarf_section, row_start, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, base_addr, fde_info.instructions_offset, fde_info.instructions_length, NULL, &fde_next);
+            if (err != PLCRASH_ESUCCESS)
+                break;
+
+            /* Determine where the row ends; this is either the next row defined by either program, or the end of the FDE */
+            machine_ptr row_end = fde_info.pc_end;
+            if (cie_next != 0 && cie_next < row_end)
+                row_end = cie_next;
+            if (fde_next != 0 && fde_next < row_end)
+                row_end = fde_next;
+
+            /* Evaluation always terminates beyond the requested PC; this exists only to guarantee forward progress */
+            if (row_end <= row_start)
+                break;
+
+            if ((err = plcrash_async_dwarf_cfa_table_append(builder, &cie_info, row_start, row_end, &cfa_state)) != PLCRASH_ESUCCESS) {
+                plcrash_async_dwarf_fde_info_free(&fde_info);
+                if (did_init_cie)
+                    plcrash_async_dwarf_cie_info_free(&cie_info);
+                return err;
+            }
+
+            row_start = row_end;
+        }
+
+        plcrash_async_dwarf_fde_info_free(&fde_info);
+    }
+
+    if (did_init_cie)
+        plcrash_async_dwarf_cie_info_free(&cie_info);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/* qsort() comparison function for rows. */
+static int plcrash_async_dwarf_cfa_table_row_compare (const void *lhs, const void *rhs) {
+    const plcrash_async_dwarf_cfa_table_row_t *l = (const plcrash_async_dwarf_cfa_table_row_t *) lhs;
+    const plcrash_async_dwarf_cfa_table_row_t *r = (const plcrash_async_dwarf_cfa_table_row_t *) rhs;
+
+    if (l->pc_start < r->pc_start)
+        return -1;
+    else if (l->pc_start > r->pc_start)
+        return 1;
+    return 0;
+}
+
+/**
+ * Compile the DWARF eh_frame (or debug_frame) data of @a image into a sorted CFA table, and publish the table
+ * as @a image's dwarf_cfa_table. Once published, the DWARF unwinder will find the unwind rules for any PC covered by
+ * the table via binary search, rather than by evaluating the CFA opcodes.
+ *
+ * If a table has already been published for @a image, this method returns immediately.
+ *
+ * @param image The image to be compiled.
+ * @param outBytes If non-NULL, will be set to the number of bytes allocated for the published table, or 0 if no
+ * table was published by this call.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the image contains no DWARF frame data, or
+ * another plcrash_error_t code on failure.
+ *
+ * @warning This method is not async safe, and evaluates every FDE within the image; it is intended to be called
+ * off the crash path, for images that are unwound frequently.
+ */
+plcrash_error_t plcrash_nasync_dwarf_cfa_table_compile (plcrash_async_macho_t *image, size_t *outBytes) {
+    plcrash_async_mobject_t dwarf_section;
+    bool is_debug_frame = false;
+    plcrash_error_t err;
+
+    if (outBytes != NULL)
+        *outBytes = 0;
+
+    if (image->dwarf_cfa_table != NULL)
+        return PLCRASH_ESUCCESS;
+
+    /* Prefer eh_frame, falling back on debug_frame, as is done by the unwinder */
+    if ((err = plcrash_async_macho_map_section(image, "__TEXT", "__eh_frame", &dwarf_section)) != PLCRASH_ESUCCESS) {
+        if ((err = plcrash_async_macho_map_section(image, "__DWARF", "__debug_frame", &dwarf_section)) != PLCRASH_ESUCCESS)
+            return err;
+        is_debug_frame = true;
+    }
+
+    /* Evaluate all FDEs */
+    plcrash_async_dwarf_cfa_table_builder builder = {};
+    if (image->m64)
+        err = plcrash_async_dwarf_cfa_table_compile_section<uint64_t, int64_t>(image, &dwarf_section, is_debug_frame, &builder);
+    else
+        err = plcrash_async_dwarf_cfa_table_compile_section<uint32_t, int32_t>(image, &dwarf_section, is_debug_frame, &builder);
+
+    plcrash_async_mobject_free(&dwarf_section);
+
+    if (err != PLCRASH_ESUCCESS) {
+        free(builder.table.rows);
+        free(builder.table.rules);
+        return err;
+    }
+
+    /* Sort the rows; FDEs are not required to be emitted in address order */
+    qsort(builder.table.rows, builder.table.row_count, sizeof(builder.table.rows[0]), plcrash_async_dwarf_cfa_table_row_compare);
+
+    plcrash_async_dwarf_cfa_table_t *table = (plcrash_async_dwarf_cfa_table_t *) malloc(sizeof(*table));
+    if (table == NULL) {
+        PLCF_DEBUG("Failed to allocate the CFA table for %s", image->name);
+        free(builder.table.rows);
+        free(builder.table.rules);
+        return PLCRASH_ENOMEM;
+    }
+    *table = builder.table;
+
+    /* Publish the table; if another thread won the race, discard ours. */
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, table, (void * volatile *) &image->dwarf_cfa_table)) {
+        plcrash_nasync_dwarf_cfa_table_free(table);
+        return PLCRASH_ESUCCESS;
+    }
+
+    if (outBytes != NULL)
+        *outBytes = sizeof(*table) + (builder.row_capacity * sizeof(table->rows[0])) + (builder.rule_capacity * sizeof(table->rules[0]));
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free a CFA table previously allocated by plcrash_nasync_dwarf_cfa_table_compile().
+ *
+ * @param table The table to be freed.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_dwarf_cfa_table_free (plcrash_async_dwarf_cfa_table_t *table) {
+    free(table->rows);
+    free(table->rules);
+    free(table);
+}
+
+/**
+ * Find the row of @a table covering @a pc.
+ *
+ * @param table The table to search.
+ * @param pc The PC to search for.
+ *
+ * @return Returns the matching row, or NULL if @a pc is not covered by @a table.
+ */
+const plcrash_async_dwarf_cfa_table_row_t *plcrash_async_dwarf_cfa_table_find (const plcrash_async_dwarf_cfa_table_t *table, uint64_t pc) {
+    /* Find the last row with a pc_start <= pc */
+    size_t low = 0;
+    size_t high = table->row_count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (table->rows[mid].pc_start <= pc)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == 0)
+        return NULL;
+
+    const plcrash_async_dwarf_cfa_table_row_t *row = &table->rows[low - 1];
+    if (pc >= row->pc_end)
+        return NULL;
+
+    return row;
+}
+
+/**
+ * @}
+ */
+
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
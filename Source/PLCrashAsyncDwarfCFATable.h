@@ -0,0 +1,133 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_DWARF_CFA_TABLE_H
+#define PLCRASH_ASYNC_DWARF_CFA_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_async_dwarf
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A saved register rule within a compiled CFA table row.
+ */
+typedef struct plcrash_async_dwarf_cfa_table_rule {
+    /** The rule value, as defined by plcrash_dwarf_cfa_reg_rule_t. */
+    int64_t value;
+
+    /** The DWARF register number. */
+    uint32_t regnum;
+
+    /** The plcrash_dwarf_cfa_reg_rule_t register rule. */
+    uint8_t rule;
+} plcrash_async_dwarf_cfa_table_rule_t;
+
+/**
+ * @internal
+ *
+ * A single compiled CFA table row, providing the unwind rules that apply to all addresses within
+ * [pc_start, pc_end).
+ */
+typedef struct plcrash_async_dwarf_cfa_table_row {
+    /** The first address covered by this row. */
+    uint64_t pc_start;
+
+    /** The end of the address range covered by this row (exclusive). */
+    uint64_t pc_end;
+
+    /** The return address register defined by the row's CIE. */
+    uint64_t return_address_register;
+
+    /** The CFA register offset, or the task-relative address of the CFA expression, depending on @a cfa_type. */
+    uint64_t cfa_value;
+
+    /** The length of the CFA expression. Only valid for DWARF_CFA_STATE_CFA_TYPE_EXPRESSION rules. */
+    uint64_t cfa_expression_length;
+
+    /** The CFA register number. Only valid for DWARF_CFA_STATE_CFA_TYPE_REGISTER(_SIGNED) rules. */
+    uint32_t cfa_regnum;
+
+    /** The index of the row's first register rule within the table's rule array. */
+    uint32_t rule_index;
+
+    /** The dwarf_cfa_state_cfa_type_t CFA rule type. */
+    uint8_t cfa_type;
+
+    /** The number of register rules defined for this row. */
+    uint8_t rule_count;
+} plcrash_async_dwarf_cfa_table_row_t;
+
+/**
+ * @internal
+ *
+ * A compiled CFA table. The table contains the result of evaluating every FDE's CFA program within an image, sorted by
+ * address, allowing the unwind rules for a PC to be found via binary search rather than by interpreting the CFA
+ * opcodes. Tables are created by plcrash_nasync_dwarf_cfa_table_compile() and are immutable once published.
+ */
+typedef struct plcrash_async_dwarf_cfa_table {
+    /** The number of rows in @a rows. */
+    size_t row_count;
+
+    /** The rows, sorted by ascending pc_start. */
+    plcrash_async_dwarf_cfa_table_row_t *rows;
+
+    /** The number of rules in @a rules. */
+    size_t rule_count;
+
+    /** The register rules referenced by @a rows. */
+    plcrash_async_dwarf_cfa_table_rule_t *rules;
+} plcrash_async_dwarf_cfa_table_t;
+
+plcrash_error_t plcrash_nasync_dwarf_cfa_table_compile (plcrash_async_macho_t *image, size_t *outBytes);
+void plcrash_nasync_dwarf_cfa_table_free (plcrash_async_dwarf_cfa_table_t *table);
+
+const plcrash_async_dwarf_cfa_table_row_t *plcrash_async_dwarf_cfa_table_find (const plcrash_async_dwarf_cfa_table_t *table, uint64_t pc);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_DWARF_CFA_TABLE_H */
@@ -0,0 +1,116 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncDwarfCFATable.h"
+#import "PLCrashFeatureConfig.h"
+
+#import <dlfcn.h>
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+
+@interface PLCrashAsyncDwarfCFATableTests : SenTestCase {
+    /** The image containing our class. */
+    plcrash_async_macho_t _image;
+}
+@end
+
+@implementation PLCrashAsyncDwarfCFATableTests
+
+- (void) setUp {
+    Dl_info info;
+    STAssertTrue(dladdr([self class], &info) > 0, @"Could not fetch dyld info for %p", [self class]);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&_image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), @"Failed to initialize image");
+}
+
+- (void) tearDown {
+    plcrash_nasync_macho_free(&_image);
+}
+
+/**
+ * Test row lookup.
+ */
+- (void) testFind {
+    plcrash_async_dwarf_cfa_table_row_t rows[3] = {
+        { .pc_start = 0x10, .pc_end = 0x20 },
+        { .pc_start = 0x20, .pc_end = 0x30 },
+        { .pc_start = 0x40, .pc_end = 0x50 },
+    };
+    plcrash_async_dwarf_cfa_table_t table = {
+        .row_count = 3,
+        .rows = rows,
+        .rule_count = 0,
+        .rules = NULL
+    };
+
+    STAssertNULL(plcrash_async_dwarf_cfa_table_find(&table, 0x0F), @"Address prior to the first row should not match");
+    STAssertEquals(plcrash_async_dwarf_cfa_table_find(&table, 0x10), (const plcrash_async_dwarf_cfa_table_row_t *) &rows[0], @"Incorrect row");
+    STAssertEquals(plcrash_async_dwarf_cfa_table_find(&table, 0x2F), (const plcrash_async_dwarf_cfa_table_row_t *) &rows[1], @"Incorrect row");
+    STAssertNULL(plcrash_async_dwarf_cfa_table_find(&table, 0x35), @"Address between rows should not match");
+    STAssertEquals(plcrash_async_dwarf_cfa_table_find(&table, 0x4F), (const plcrash_async_dwarf_cfa_table_row_t *) &rows[2], @"Incorrect row");
+    STAssertNULL(plcrash_async_dwarf_cfa_table_find(&table, 0x50), @"Address following the last row should not match");
+}
+
+/**
+ * Test compilation and publication of an image's CFA table.
+ */
+- (void) testCompile {
+    size_t bytes;
+    plcrash_error_t err = plcrash_nasync_dwarf_cfa_table_compile(&_image, &bytes);
+    if (err == PLCRASH_ENOTFOUND) {
+        /* Our image does not contain any DWARF frame data */
+        return;
+    }
+
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to compile CFA table");
+    STAssertNotNULL(_image.dwarf_cfa_table, @"Table was not published");
+    STAssertTrue(bytes > 0, @"Allocation size was not reported");
+
+    /* Verify that the rows are sorted, non-empty, and reference valid rules */
+    plcrash_async_dwarf_cfa_table_t *table = _image.dwarf_cfa_table;
+    for (size_t i = 0; i < table->row_count; i++) {
+        plcrash_async_dwarf_cfa_table_row_t *row = &table->rows[i];
+        STAssertTrue(row->pc_start < row->pc_end, @"Row covers an empty range");
+        STAssertTrue(row->rule_index + row->rule_count <= table->rule_count, @"Row references rules outside the table");
+        if (i > 0)
+            STAssertTrue(table->rows[i-1].pc_start <= row->pc_start, @"Rows are not sorted");
+
+        STAssertEquals(plcrash_async_dwarf_cfa_table_find(table, row->pc_start), (const plcrash_async_dwarf_cfa_table_row_t *) row, @"Row lookup failed");
+    }
+
+    /* A second compilation should return the already-published table */
+    err = plcrash_nasync_dwarf_cfa_table_compile(&_image, &bytes);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to compile CFA table");
+    STAssertEquals(_image.dwarf_cfa_table, table, @"Table was replaced");
+    STAssertEquals(bytes, (size_t) 0, @"No allocation should have been reported");
+}
+
+@end
+
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
@@ -51,22 +51,284 @@ using namespace plcrash::async;
  * @param m64 True if the target system uses 64-bit pointers, false if it uses 32-bit pointers.
  * @param debug_frame If true, interpret the DWARF data as a debug_frame section. Otherwise, the
  * frame reader will assume eh_frame data.
+ * @param eh_frame_hdr The memory object containing the eh_frame_hdr section that indexes @a mobj, or NULL if
+ * unavailable. If provided, the eh_frame_hdr binary search table will be used to locate FDEs. This instance must
+ * survive for the lifetime of the reader. This value is ignored if @a debug_frame is true.
  *
  * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t value on error.
  */
 plcrash_error_t dwarf_frame_reader::init (plcrash_async_mobject_t *mobj,
                                           const plcrash_async_byteorder_t *byteorder,
                                           bool m64,
-                                          bool debug_frame)
+                                          bool debug_frame,
+                                          plcrash_async_mobject_t *eh_frame_hdr)
 {
     _mobj = mobj;
     _byteorder = byteorder;
     _debug_frame = debug_frame;
     _m64 = m64;
+    _fde_index = NULL;
+    _work_budget = NULL;
+
+    /* The eh_frame_hdr search table is only defined for eh_frame data */
+    if (debug_frame)
+        _eh_frame_hdr = NULL;
+    else
+        _eh_frame_hdr = eh_frame_hdr;
     
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Provide a sorted FDE index of the reader's DWARF data. If no eh_frame_hdr search table is available, the index
+ * will be used by find_fde() to locate FDEs via binary search.
+ *
+ * @param fde_index An FDE index built from the reader's DWARF data (see plcrash_nasync_dwarf_fde_index_build()), or
+ * NULL. This instance must survive for the lifetime of the reader.
+ */
+void dwarf_frame_reader::set_fde_index (const plcrash_async_dwarf_fde_index_t *fde_index) {
+    _fde_index = fde_index;
+}
+
+/**
+ * Set the work budget to be consumed when scanning the reader's CFI entries. Each CIE or FDE visited by find_fde(),
+ * next_fde(), and next_fde_address() is charged to the budget; once exhausted, PLCRASH_EBUDGET is returned.
+ *
+ * @param budget The work budget, or NULL to perform unbounded scans. This instance must survive for the lifetime
+ * of the reader.
+ */
+void dwarf_frame_reader::set_work_budget (plcrash_async_work_budget_t *budget) {
+    _work_budget = budget;
+}
+
+/**
+ * Locate the frame descriptor entry for @a pc using the eh_frame_hdr binary search table. The table format is
+ * defined in the Linux Standard Base Core Specification 4.1, section 10.6.2, The .eh_frame_hdr section.
+ *
+ * @param pc The PC value to search for within the frame data.
+ * @param fde_info If the FDE is found, PLFRAME_ESUCCESS will be returned and @a fde_info will be initialized with the
+ * FDE data. The caller is responsible for freeing the returned FDE record via plcrash_async_dwarf_fde_info_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOTFOUND if the search table does not contain an entry
+ * for @a pc. If the search table can not be used (eg, due to an unsupported table encoding), PLCRASH_ENOTSUP will
+ * be returned, and the caller should fall back on a linear scan of the eh_frame data. Other error codes will be
+ * returned if the search table is invalid.
+ *
+ * @tparam machine_ptr The target machine's unsigned native pointer type.
+ */
+template <typename machine_ptr>
+plcrash_error_t dwarf_frame_reader::find_fde_indexed (pl_vm_address_t pc, plcrash_async_dwarf_fde_info_t *fde_info) {
+    const pl_vm_address_t hdr_addr = plcrash_async_mobject_base_address(_eh_frame_hdr);
+    const pl_vm_size_t hdr_length = plcrash_async_mobject_length(_eh_frame_hdr);
+    gnu_ehptr_reader<machine_ptr> ptr_reader(_byteorder);
+    plcrash_error_t err;
+
+    /* DW_EH_PE_datarel values are relative to the start of the eh_frame_hdr section */
+    ptr_reader.set_data_base(hdr_addr);
+
+    /* Read the header */
+    uint8_t version;
+    uint8_t eh_frame_ptr_enc;
+    uint8_t fde_count_enc;
+    uint8_t table_enc;
+
+    if ((err = plcrash_async_mobject_read_uint8(_eh_frame_hdr, hdr_addr, 0, &version)) != PLCRASH_ESUCCESS ||
+        (err = plcrash_async_mobject_read_uint8(_eh_frame_hdr, hdr_addr, 1, &eh_frame_ptr_enc)) != PLCRASH_ESUCCESS ||
+        (err = plcrash_async_mobject_read_uint8(_eh_frame_hdr, hdr_addr, 2, &fde_count_enc)) != PLCRASH_ESUCCESS ||
+        (err = plcrash_async_mobject_read_uint8(_eh_frame_hdr, hdr_addr, 3, &table_enc)) != PLCRASH_ESUCCESS)
+    {
+        PLCF_DEBUG("The eh_frame_hdr header lies outside the mapped range");
+        return PLCRASH_EINVAL;
+    }
+
+    if (version != 1) {
+        PLCF_DEBUG("Unsupported eh_frame_hdr version %" PRIu8, version);
+        return PLCRASH_ENOTSUP;
+    }
+
+    /* The table is absent if either the count or the table entries are omitted */
+    if (fde_count_enc == DW_EH_PE_omit || table_enc == DW_EH_PE_omit)
+        return PLCRASH_ENOTSUP;
+
+    /* Skip the eh_frame_ptr; the eh_frame section has already been mapped by our caller. */
+    pl_vm_off_t offset = 4;
+    machine_ptr value;
+    size_t value_size;
+
+    if ((err = ptr_reader.read(_eh_frame_hdr, hdr_addr, offset, (DW_EH_PE_t) eh_frame_ptr_enc, &value, &value_size)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read the eh_frame_hdr eh_frame_ptr: %d", err);
+        return PLCRASH_ENOTSUP;
+    }
+    offset += value_size;
+
+    /* Read the FDE count */
+    machine_ptr fde_count;
+    if ((err = ptr_reader.read(_eh_frame_hdr, hdr_addr, offset, (DW_EH_PE_t) fde_count_enc, &fde_count, &value_size)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read the eh_frame_hdr fde_count: %d", err);
+        return PLCRASH_ENOTSUP;
+    }
+    offset += value_size;
+
+    /* A binary search requires fixed-width table entries. */
+    pl_vm_size_t field_size;
+    if (table_enc & DW_EH_PE_indirect)
+        return PLCRASH_ENOTSUP;
+
+    if ((table_enc & 0x70) == DW_EH_PE_aligned)
+        return PLCRASH_ENOTSUP;
+
+    switch (table_enc & DW_EH_PE_MASK_ENCODING) {
+        case DW_EH_PE_absptr:
+            field_size = sizeof(machine_ptr);
+            break;
+
+        case DW_EH_PE_udata2:
+        case DW_EH_PE_sdata2:
+            field_size = 2;
+            break;
+
+        case DW_EH_PE_udata4:
+        case DW_EH_PE_sdata4:
+            field_size = 4;
+            break;
+
+        case DW_EH_PE_udata8:
+        case DW_EH_PE_sdata8:
+            field_size = 8;
+            break;
+
+        default:
+            PLCF_DEBUG("Unsupported eh_frame_hdr table encoding 0x%" PRIx8, table_enc);
+            return PLCRASH_ENOTSUP;
+    }
+
+    /* Verify that the table fits within the mapped section. This also guarantees that the entry offsets
+     * computed below can not overflow. */
+    const pl_vm_size_t entry_size = field_size * 2;
+    if ((pl_vm_size_t) offset > hdr_length || fde_count > (hdr_length - offset) / entry_size) {
+        PLCF_DEBUG("The eh_frame_hdr table lies outside the mapped range");
+        return PLCRASH_EINVAL;
+    }
+
+    /* Find the last entry with an initial location <= pc; the table is sorted by initial location. */
+    machine_ptr low = 0;
+    machine_ptr high = fde_count;
+    bool found = false;
+    pl_vm_off_t found_offset = 0;
+
+    while (low < high) {
+        machine_ptr mid = low + ((high - low) / 2);
+        pl_vm_off_t entry_offset = offset + (mid * entry_size);
+
+        machine_ptr initial_location;
+        if ((err = ptr_reader.read(_eh_frame_hdr, hdr_addr, entry_offset, (DW_EH_PE_t) table_enc, &initial_location, &value_size)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to read eh_frame_hdr table entry %" PRIu64 ": %d", (uint64_t) mid, err);
+            return err;
+        }
+
+        if (initial_location <= pc) {
+            found = true;
+            found_offset = entry_offset;
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (!found)
+        return PLCRASH_ENOTFOUND;
+
+    /* Fetch the FDE address */
+    machine_ptr fde_address;
+    if ((err = ptr_reader.read(_eh_frame_hdr, hdr_addr, found_offset + field_size, (DW_EH_PE_t) table_enc, &fde_address, &value_size)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read eh_frame_hdr FDE address: %d", err);
+        return err;
+    }
+
+    /* Decode the FDE; the FDE's address is validated against the eh_frame mapping by the FDE parser. */
+    if ((err = plcrash_async_dwarf_fde_info_init<machine_ptr>(fde_info, _mobj, _byteorder, fde_address, false)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* The preceding entry may not cover our PC */
+    if (pc >= fde_info->pc_start && pc < fde_info->pc_end)
+        return PLCRASH_ESUCCESS;
+
+    plcrash_async_dwarf_fde_info_free(fde_info);
+    return PLCRASH_ENOTFOUND;
+}
+
+/**
+ * Locate the frame descriptor entry for @a pc using the sorted FDE index provided via set_fde_index().
+ *
+ * @param pc The PC value to search for.
+ * @param fde_info If the FDE is found, PLCRASH_ESUCCESS will be returned and @a fde_info will be initialized with the
+ * FDE data. The caller is responsible for freeing the returned FDE record via plcrash_async_dwarf_fde_info_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the index does not contain an entry for @a pc,
+ * or one of the remaining error codes if the indexed FDE can not be decoded.
+ */
+plcrash_error_t dwarf_frame_reader::find_fde_sorted (pl_vm_address_t pc, plcrash_async_dwarf_fde_info_t *fde_info) {
+    const plcrash_async_dwarf_fde_index_entry_t *entry = plcrash_async_dwarf_fde_index_find(_fde_index, pc);
+    if (entry == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    pl_vm_address_t fde_address;
+    if (!plcrash_async_address_apply_offset(plcrash_async_mobject_base_address(_mobj), entry->fde_offset, &fde_address)) {
+        PLCF_DEBUG("Indexed FDE offset overflows the mobject's base address");
+        return PLCRASH_EINVAL;
+    }
+
+    plcrash_error_t err;
+    if (_m64)
+        err = plcrash_async_dwarf_fde_info_init<uint64_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+    else
+        err = plcrash_async_dwarf_fde_info_init<uint32_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    /* The index was built from this data; verify the entry regardless */
+    if (pc >= fde_info->pc_start && pc < fde_info->pc_end)
+        return PLCRASH_ESUCCESS;
+
+    plcrash_async_dwarf_fde_info_free(fde_info);
+    return PLCRASH_EINVAL;
+}
+
+/**
+ * Decode the frame descriptor entry at @a offset, verifying that it covers @a pc. This is used with the FDE offset
+ * provided by a compact unwind encoding that defers to DWARF, and requires no search of the DWARF data.
+ *
+ * @param offset The section-relative offset of the FDE.
+ * @param pc The PC value that the FDE is expected to cover.
+ * @param fde_info If the FDE is decoded and covers @a pc, PLCRASH_ESUCCESS will be returned and @a fde_info will be
+ * initialized with the FDE data. The caller is responsible for freeing the returned FDE record via
+ * plcrash_async_dwarf_fde_info_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the FDE does not cover @a pc, or one of the
+ * remaining error codes if no FDE can be decoded at @a offset.
+ */
+plcrash_error_t dwarf_frame_reader::find_fde_at (pl_vm_off_t offset, pl_vm_address_t pc, plcrash_async_dwarf_fde_info_t *fde_info) {
+    pl_vm_address_t fde_address;
+    if (!plcrash_async_address_apply_offset(plcrash_async_mobject_base_address(_mobj), offset, &fde_address)) {
+        PLCF_DEBUG("FDE offset overflows the mobject's base address");
+        return PLCRASH_EINVAL;
+    }
+
+    plcrash_error_t err;
+    if (_m64)
+        err = plcrash_async_dwarf_fde_info_init<uint64_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+    else
+        err = plcrash_async_dwarf_fde_info_init<uint32_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    if (pc >= fde_info->pc_start && pc < fde_info->pc_end)
+        return PLCRASH_ESUCCESS;
+
+    plcrash_async_dwarf_fde_info_free(fde_info);
+    return PLCRASH_ENOTFOUND;
+}
+
 /**
  * Locate the frame descriptor entry for @a pc, if available.
  *
@@ -86,7 +348,6 @@ plcrash_error_t dwarf_frame_reader::find_fde (pl_vm_off_t offset,
                                               pl_vm_address_t pc,
                                               plcrash_async_dwarf_fde_info_t *fde_info)
 {
-    const plcrash_async_byteorder_t *byteorder = _byteorder;
     const pl_vm_address_t base_addr = plcrash_async_mobject_base_address(_mobj);
     const pl_vm_address_t end_addr = base_addr + plcrash_async_mobject_length(_mobj);
     
@@ -103,9 +364,109 @@ plcrash_error_t dwarf_frame_reader::find_fde (pl_vm_off_t offset,
         PLCF_DEBUG("FDE base address + offset falls outside the mapped range");
         return PLCRASH_EINVAL;
     }
+
+    /* If no offset hint was provided, try the eh_frame_hdr binary search table before falling back on a linear scan. */
+    if (_eh_frame_hdr != NULL && offset == 0) {
+        if (_m64)
+            err = find_fde_indexed<uint64_t>(pc, fde_info);
+        else
+            err = find_fde_indexed<uint32_t>(pc, fde_info);
+
+        if (err == PLCRASH_ESUCCESS || err == PLCRASH_ENOTFOUND)
+            return err;
+
+        PLCF_DEBUG("Could not use the eh_frame_hdr search table, falling back on a linear scan: %d", err);
+    } else if (_fde_index != NULL && offset == 0) {
+        /* Otherwise, try the FDE index built for images that do not provide an eh_frame_hdr */
+        err = find_fde_sorted(pc, fde_info);
+        if (err == PLCRASH_ESUCCESS || err == PLCRASH_ENOTFOUND)
+            return err;
+
+        PLCF_DEBUG("Could not use the FDE index, falling back on a linear scan: %d", err);
+    }
     
-    /* Iterate over table entries */
+    /* Iterate over table entries, decoding only the address range of each FDE until a match is found. Consecutive
+     * FDEs generally share a CIE, the pointer encoding of which is cached across the scan. */
+    plcrash_async_dwarf_fde_range_cache_t range_cache;
+    range_cache.valid = false;
+
+    pl_vm_off_t next_offset = offset;
+    pl_vm_address_t fde_address;
+    while ((err = next_fde_address(&next_offset, &fde_address)) == PLCRASH_ESUCCESS) {
+        plcrash_async_dwarf_fde_range_t range;
+        if (_m64)
+            err = plcrash_async_dwarf_fde_range_init<uint64_t>(&range, _mobj, _byteorder, fde_address, _debug_frame, &range_cache);
+        else
+            err = plcrash_async_dwarf_fde_range_init<uint32_t>(&range, _mobj, _byteorder, fde_address, _debug_frame, &range_cache);
+        if (err != PLCRASH_ESUCCESS)
+            return err;
+
+        /* Check if our PC is within range, and if so, perform the full decode */
+        if (pc >= range.pc_start && pc < range.pc_end) {
+            if (_m64)
+                return plcrash_async_dwarf_fde_info_init<uint64_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+            else
+                return plcrash_async_dwarf_fde_info_init<uint32_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+        }
+    }
+    
+    return err;
+}
+
+/**
+ * Decode the first FDE found at or after @a offset, skipping any CIE entries.
+ *
+ * @param offset On input, the offset of the CFI entry at which iteration should begin, relative to the start of the
+ * DWARF data. On success, will be set to the offset of the CFI entry following the returned FDE.
+ * @param fde_info If an FDE is found, PLCRASH_ESUCCESS will be returned and @a fde_info will be initialized with the
+ * FDE data. The caller is responsible for freeing the returned FDE record via plcrash_async_dwarf_fde_info_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no further FDEs are available, or one of the
+ * remaining error codes if a DWARF parsing error occurs.
+ */
+plcrash_error_t dwarf_frame_reader::next_fde (pl_vm_off_t *offset, plcrash_async_dwarf_fde_info_t *fde_info) {
+    pl_vm_address_t fde_address;
+    plcrash_error_t err;
+
+    if ((err = next_fde_address(offset, &fde_address)) != PLCRASH_ESUCCESS)
+        return err;
+
+    /* Decode the FDE */
+    if (_m64)
+        return plcrash_async_dwarf_fde_info_init<uint64_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+    else
+        return plcrash_async_dwarf_fde_info_init<uint32_t>(fde_info, _mobj, _byteorder, fde_address, _debug_frame);
+}
+
+/**
+ * Find the first FDE entry at or after @a offset, skipping any CIE entries, without decoding the FDE.
+ *
+ * @param offset On input, the offset of the CFI entry at which iteration should begin, relative to the start of the
+ * DWARF data. On success, will be set to the offset of the CFI entry following the returned FDE.
+ * @param fde_address On success, the target-relative address of the FDE, including its length field.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no further FDEs are available, or one of the
+ * remaining error codes if a DWARF parsing error occurs.
+ */
+plcrash_error_t dwarf_frame_reader::next_fde_address (pl_vm_off_t *offset, pl_vm_address_t *fde_address) {
+    const plcrash_async_byteorder_t *byteorder = _byteorder;
+    const pl_vm_address_t base_addr = plcrash_async_mobject_base_address(_mobj);
+    const pl_vm_address_t end_addr = base_addr + plcrash_async_mobject_length(_mobj);
+    
+    plcrash_error_t err;
+    
+    pl_vm_address_t cfi_entry;
+    if (!plcrash_async_address_apply_offset(base_addr, *offset, &cfi_entry)) {
+        PLCF_DEBUG("CFI offset overflows the mobject's base address");
+        return PLCRASH_EINVAL;
+    }
+
     while (cfi_entry < end_addr) {
+        if (!plcrash_async_work_budget_consume(_work_budget, PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES, 1)) {
+            PLCF_DEBUG("DWARF work budget exhausted while scanning CFI entries");
+            return PLCRASH_EBUDGET;
+        }
+
         /* Fetch the entry length (and determine wether it's 64-bit or 32-bit) */
         uint64_t length;
         pl_vm_size_t length_size;
@@ -118,18 +479,18 @@ plcrash_error_t dwarf_frame_reader::find_fde (pl_vm_off_t offset,
                 return PLCRASH_EINVAL;
             }
             
-            if (byteorder->swap32(*length32) == UINT32_MAX) {
+            if (plcrash_async_byteorder_swap32(byteorder, *length32) == UINT32_MAX) {
                 uint64_t *length64 = (uint64_t *) plcrash_async_mobject_remap_address(_mobj, cfi_entry, sizeof(uint32_t), sizeof(uint64_t));
                 if (length64 == NULL) {
                     PLCF_DEBUG("The current CFI entry 0x%" PRIx64 " header lies outside the mapped range", (uint64_t) cfi_entry);
                     return PLCRASH_EINVAL;
                 }
                 
-                length = byteorder->swap64(*length64);
+                length = plcrash_async_byteorder_swap64(byteorder, *length64);
                 length_size = sizeof(uint64_t) + sizeof(uint32_t);
                 dwarf_word_size = 8; // 64-bit DWARF
             } else {
-                length = byteorder->swap32(*length32);
+                length = plcrash_async_byteorder_swap32(byteorder, *length32);
                 length_size = sizeof(uint32_t);
                 dwarf_word_size = 4; // 32-bit DWARF
             }
@@ -188,20 +549,9 @@ plcrash_error_t dwarf_frame_reader::find_fde (pl_vm_off_t offset,
             }
         }
         
-        /* Decode the FDE */
-        if (_m64)
-            err = plcrash_async_dwarf_fde_info_init<uint64_t>(fde_info, _mobj, byteorder, cfi_entry, _debug_frame);
-        else
-            err = plcrash_async_dwarf_fde_info_init<uint32_t>(fde_info, _mobj, byteorder, cfi_entry, _debug_frame);
-        if (err != PLCRASH_ESUCCESS)
-            return err;
-        
-        /* Check if our PC is within range */
-        if (pc >= fde_info->pc_start && pc < fde_info->pc_end)
-            return PLCRASH_ESUCCESS;
-        
-        /* Skip to the next entry */
-        cfi_entry = next_cfi_entry;
+        *fde_address = cfi_entry;
+        *offset = next_cfi_entry - base_addr;
+        return PLCRASH_ESUCCESS;
     }
     
     return PLCRASH_ENOTFOUND;
@@ -33,6 +33,8 @@
 
 #include "PLCrashAsyncDwarfPrimitives.hpp"
 #include "PLCrashAsyncDwarfFDE.hpp"
+#include "PLCrashAsyncDwarfFDEIndex.h"
+#include "PLCrashAsyncWorkBudget.h"
 
 #include "PLCrashFeatureConfig.h"
 
@@ -59,15 +61,45 @@ public:
     plcrash_error_t init (plcrash_async_mobject_t *mobj,
                           const plcrash_async_byteorder_t *byteorder,
                           bool m64,
-                          bool debug_frame);
+                          bool debug_frame,
+                          plcrash_async_mobject_t *eh_frame_hdr);
+
+    void set_fde_index (const plcrash_async_dwarf_fde_index_t *fde_index);
+    void set_work_budget (plcrash_async_work_budget_t *budget);
     
     plcrash_error_t find_fde (pl_vm_off_t offset,
                               pl_vm_address_t pc,
                               plcrash_async_dwarf_fde_info_t *fde_info);
 
+    plcrash_error_t find_fde_at (pl_vm_off_t offset,
+                                 pl_vm_address_t pc,
+                                 plcrash_async_dwarf_fde_info_t *fde_info);
+
+    plcrash_error_t next_fde (pl_vm_off_t *offset,
+                              plcrash_async_dwarf_fde_info_t *fde_info);
+
+    plcrash_error_t next_fde_address (pl_vm_off_t *offset,
+                                      pl_vm_address_t *fde_address);
+
 private:
+
+    template <typename machine_ptr> plcrash_error_t find_fde_indexed (pl_vm_address_t pc,
+                                                                      plcrash_async_dwarf_fde_info_t *fde_info);
+
+    plcrash_error_t find_fde_sorted (pl_vm_address_t pc,
+                                     plcrash_async_dwarf_fde_info_t *fde_info);
+
     /** A memory object containing the DWARF data at the starting address. */
     plcrash_async_mobject_t *_mobj;
+
+    /** A memory object containing the eh_frame_hdr binary search table, or NULL if unavailable. */
+    plcrash_async_mobject_t *_eh_frame_hdr;
+
+    /** A sorted FDE index of the DWARF data, or NULL if unavailable. */
+    const plcrash_async_dwarf_fde_index_t *_fde_index;
+
+    /** The work budget consumed when scanning CFI entries, or NULL. */
+    plcrash_async_work_budget_t *_work_budget;
     
     /** The byte order of the encoded data. */
     const plcrash_async_byteorder_t *_byteorder;
@@ -116,10 +116,10 @@ using namespace plcrash::async;
     }
 
     /* Initialize eh/debug readers */
-    err = _eh_reader.init(&_eh_frame, byteorder, _m64, false);
+    err = _eh_reader.init(&_eh_frame, byteorder, _m64, false, NULL);
     STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize reader");
 
-    err = _debug_reader.init(&_debug_frame, byteorder, _m64, true);
+    err = _debug_reader.init(&_debug_frame, byteorder, _m64, true, NULL);
     STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize reader");
 }
 
@@ -154,6 +154,116 @@ using namespace plcrash::async;
     STAssertEquals(PLCRASH_ENOTFOUND, err, @"FDE should not have been found");
 }
 
+/**
+ * Verify direct decoding of an FDE at a known offset, as provided by a compact unwind encoding.
+ */
+- (void) testFindEHFrameDescriptorEntryAtOffset {
+    plcrash_error_t err;
+    plcrash_async_dwarf_fde_info_t fde_info;
+
+    /* The FDE is the second entry in the table */
+    err = _eh_reader.find_fde_at(sizeof(pl_cfi_entry), PL_CFI_EH_FRAME_PC+PL_CFI_EH_FRAME_PC_RANGE-1, &fde_info);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"FDE decode failed");
+    STAssertEquals(fde_info.pc_start, (uint64_t) PL_CFI_EH_FRAME_PC, @"Incorrect FDE returned");
+    plcrash_async_dwarf_fde_info_free(&fde_info);
+
+    /* A PC outside the FDE's range must not be matched */
+    err = _eh_reader.find_fde_at(sizeof(pl_cfi_entry), PL_CFI_EH_FRAME_PC+PL_CFI_EH_FRAME_PC_RANGE, &fde_info);
+    STAssertEquals(PLCRASH_ENOTFOUND, err, @"FDE should not cover the PC");
+}
+
+/**
+ * Verify iteration of FDE entries via next_fde().
+ */
+- (void) testNextFrameDescriptorEntry {
+    plcrash_async_dwarf_fde_info_t fde_info;
+    pl_vm_off_t offset = 0;
+    plcrash_error_t err;
+
+    /* The first FDE should be the second entry in the table (following the CIE), plus the initial length field. */
+    err = _eh_reader.next_fde(&offset, &fde_info);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"FDE iteration failed");
+    STAssertEquals(fde_info.pc_start, (uint64_t) PL_CFI_EH_FRAME_PC, @"Incorrect FDE returned");
+    if (_m64) {
+        STAssertEquals(fde_info.fde_offset, (pl_vm_address_t) ((sizeof(pl_cfi_entry)) + PL_CFI_LEN_SIZE_64), @"Incorrect offset");
+    } else {
+        STAssertEquals(fde_info.fde_offset, (pl_vm_address_t) ((sizeof(pl_cfi_entry)) + PL_CFI_LEN_SIZE_32), @"Incorrect offset");
+    }
+    STAssertTrue(offset > (pl_vm_off_t) fde_info.fde_offset, @"Offset was not advanced past the returned FDE");
+    plcrash_async_dwarf_fde_info_free(&fde_info);
+
+    /* Iteration must terminate */
+    while ((err = _eh_reader.next_fde(&offset, &fde_info)) == PLCRASH_ESUCCESS)
+        plcrash_async_dwarf_fde_info_free(&fde_info);
+    STAssertEquals(PLCRASH_ENOTFOUND, err, @"Iteration should terminate with ENOTFOUND");
+}
+
+/**
+ * Verify that FDE lookups are performed using the eh_frame_hdr binary search table, when available.
+ */
+- (void) testFindEHFrameDescriptorEntryIndexed {
+    const plcrash_async_byteorder_t *byteorder = plcrash_async_macho_byteorder(&_image);
+    plcrash_async_dwarf_fde_info_t fde_info;
+    plcrash_async_mobject_t hdr_mobj;
+    dwarf_frame_reader reader;
+    plcrash_error_t err;
+
+    /* Populate an eh_frame_hdr search table referencing the test FDE. Absolute 8-byte values are used, as the
+     * test table is not located at a fixed position relative to the test eh_frame data. */
+    struct __attribute__((packed)) {
+        uint8_t version;
+        uint8_t eh_frame_ptr_enc;
+        uint8_t fde_count_enc;
+        uint8_t table_enc;
+        uint64_t eh_frame_ptr;
+        uint32_t fde_count;
+        struct __attribute__((packed)) {
+            uint64_t initial_location;
+            uint64_t fde_address;
+        } table[1];
+    } hdr;
+
+    pl_vm_address_t eh_frame_addr = plcrash_async_mobject_base_address(&_eh_frame);
+
+    hdr.version = 1;
+    hdr.eh_frame_ptr_enc = DW_EH_PE_udata8;
+    hdr.fde_count_enc = DW_EH_PE_udata4;
+    hdr.table_enc = DW_EH_PE_udata8;
+    hdr.eh_frame_ptr = byteorder->swap64(eh_frame_addr);
+    hdr.fde_count = byteorder->swap32(1);
+    hdr.table[0].initial_location = byteorder->swap64(PL_CFI_EH_FRAME_PC);
+    hdr.table[0].fde_address = byteorder->swap64(eh_frame_addr + sizeof(pl_cfi_entry));
+
+    err = plcrash_async_mobject_init(&hdr_mobj, mach_task_self(), (pl_vm_address_t) &hdr, sizeof(hdr), true);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize mobj");
+
+    err = reader.init(&_eh_frame, byteorder, _m64, false, &hdr_mobj);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize reader");
+
+    /* Perform the lookup */
+    err = reader.find_fde(0x0, PL_CFI_EH_FRAME_PC+PL_CFI_EH_FRAME_PC_RANGE-1, &fde_info);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"FDE search failed");
+
+    if (_m64) {
+        STAssertEquals(fde_info.fde_offset, (pl_vm_address_t) ((sizeof(pl_cfi_entry)) + PL_CFI_LEN_SIZE_64), @"Incorrect offset");
+        STAssertEquals(fde_info.fde_length, (uint64_t)PL_CFI_SIZE_64, @"Incorrect length");
+    } else {
+        STAssertEquals(fde_info.fde_offset, (pl_vm_address_t) ((sizeof(pl_cfi_entry)) + PL_CFI_LEN_SIZE_32), @"Incorrect offset");
+        STAssertEquals(fde_info.fde_length, (uint64_t)PL_CFI_SIZE_32, @"Incorrect length");
+    }
+
+    plcrash_async_dwarf_fde_info_free(&fde_info);
+
+    /* Verify that PCs preceding the first table entry, or following the matching FDE, return ENOTFOUND */
+    err = reader.find_fde(0x0, PL_CFI_EH_FRAME_PC-1, &fde_info);
+    STAssertEquals(PLCRASH_ENOTFOUND, err, @"FDE should not have been found");
+
+    err = reader.find_fde(0x0, PL_CFI_EH_FRAME_PC+PL_CFI_EH_FRAME_PC_RANGE, &fde_info);
+    STAssertEquals(PLCRASH_ENOTFOUND, err, @"FDE should not have been found");
+
+    plcrash_async_mobject_free(&hdr_mobj);
+}
+
 - (void) testFindDebugFrameDescriptorEntry {
     plcrash_error_t err;
     plcrash_async_dwarf_fde_info_t fde_info;
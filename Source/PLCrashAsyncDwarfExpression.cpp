@@ -45,42 +45,25 @@ using namespace plcrash::async;
  */
 
 /**
- * Evaluate a DWARF expression, as defined in the DWARF 4 Specification, Section 2.5. This
- * internal implementation is templated to support 32-bit and 64-bit evaluation.
- *
- * @param mobj The memory object from which the expression opcodes will be read.
- * @param task The task from which any DWARF expression memory loads will be performed.
- * @param thread_state The thread state against which the expression will be evaluated.
- * @param byteorder The byte order of the data referenced by @a mobj and @a thread_state.
- * @param address The task-relative address within @a mobj at which the opcodes will be fetched.
- * @param offset An offset to be applied to @a address.
- * @param length The total length of the opcodes readable at @a address + @a offset.
- * @param initial_state Initial set of values to be pushed onto the evaluation stack. The values will be pushed
- * on their natural order; eg, the top of the stack will be the last value in this array. If the initial stack
- * state should be empty, this value may be NULL, and @a initial_count should be 0.
- * @param initial_count Number of values in the @a initial_state array.
- * @param result[out] On success, the evaluation result. As per DWARF 3 section 2.5.1, this will be
- * the top-most element on the evaluation stack. If the stack is empty, an error will be returned
- * and no value will be written to this parameter.
- *
- * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t values
- * on failure. If an invalid opcode is detected, PLCRASH_ENOTSUP will be returned. If the stack
- * is empty upon termination of evaluation, PLCRASH_EINVAL will be returned.
+ * @internal
  *
- * @todo Consider defining updated status codes or error handling to provide more structured
- * error data on failure.
+ * Evaluate a DWARF expression by directly interpreting the opcode stream. This is the general-purpose evaluator, and
+ * is used for any expression that can not be pre-decoded by plcrash_async_dwarf_expression_decode(). The parameters
+ * and return values are identical to those of plcrash_async_dwarf_expression_eval(). Each interpreted operation is
+ * charged to @a budget, bounding the evaluation of expressions that loop via DW_OP_skip or DW_OP_bra.
  */
 template <typename machine_ptr, typename machine_ptr_s>
-plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mobj,
-                                                     task_t task,
-                                                     const plcrash_async_thread_state_t *thread_state,
-                                                     const plcrash_async_byteorder_t *byteorder,
-                                                     pl_vm_address_t address,
-                                                     pl_vm_off_t offset,
-                                                     pl_vm_size_t length,
-                                                     machine_ptr initial_state[],
-                                                     size_t initial_count,
-                                                     machine_ptr *result)
+static plcrash_error_t plcrash_async_dwarf_expression_interpret (plcrash_async_mobject_t *mobj,
+                                                                 task_t task,
+                                                                 const plcrash_async_thread_state_t *thread_state,
+                                                                 const plcrash_async_byteorder_t *byteorder,
+                                                                 pl_vm_address_t address,
+                                                                 pl_vm_off_t offset,
+                                                                 pl_vm_size_t length,
+                                                                 machine_ptr initial_state[],
+                                                                 size_t initial_count,
+                                                                 machine_ptr *result,
+                                                                 plcrash_async_work_budget_t *budget)
 {
     // TODO: Review the use of an up-to-800 byte stack allocation; we may want to replace this with
     // use of the new async-safe allocator.
@@ -166,6 +149,11 @@ plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mo
 
     uint8_t opcode;
     while (opstream.read_intU(&opcode)) {
+        if (!plcrash_async_work_budget_consume(budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 1)) {
+            PLCF_DEBUG("DWARF work budget exhausted while evaluating expression");
+            return PLCRASH_EBUDGET;
+        }
+
         switch (opcode) {
             case DW_OP_lit0:
             case DW_OP_lit1:
@@ -278,7 +266,8 @@ plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mo
                 break;
                 
             case DW_OP_bregx:
-                dw_expr_push(dw_thread_regval(dw_expr_read_sleb128()) + dw_expr_read_sleb128());
+                dw_expr_push(dw_thread_regval(dw_expr_read_uleb128()) + dw_expr_read_sleb128());
+                break;
                 
             case DW_OP_dup:
                 if (!stack.dup()) {
@@ -697,6 +686,802 @@ plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mo
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * @internal
+ * Maximum number of operations in a pre-decoded expression. Longer expressions are interpreted directly.
+ */
+#define DWARF_EXPR_MAX_OPS 32
+
+/**
+ * @internal
+ * Depth of the evaluation stack.
+ */
+#define DWARF_EXPR_STACK_SIZE 100
+
+/**
+ * @internal
+ *
+ * Pre-decoded DWARF expression operations. The table order must match the dispatch table in
+ * plcrash_async_dwarf_expression_exec().
+ */
+typedef enum {
+    /** Push the operand. */
+    DWARF_EXPR_OP_CONST = 0,
+
+    /** Push the value of the register plus the operand. */
+    DWARF_EXPR_OP_REG,
+
+    /** Push the value found at the address given by the register plus the operand (fused DW_OP_bregN, DW_OP_deref). */
+    DWARF_EXPR_OP_REG_DEREF,
+
+    /** Add the operand to the top of the stack (DW_OP_plus_uconst, or fused DW_OP_constN, DW_OP_plus). */
+    DWARF_EXPR_OP_PLUS_CONST,
+
+    /** DW_OP_deref */
+    DWARF_EXPR_OP_DEREF,
+
+    /** DW_OP_deref_size, with the size as the operand. */
+    DWARF_EXPR_OP_DEREF_SIZE,
+
+    /** DW_OP_dup */
+    DWARF_EXPR_OP_DUP,
+
+    /** DW_OP_drop */
+    DWARF_EXPR_OP_DROP,
+
+    /** DW_OP_pick, with the index as the operand. */
+    DWARF_EXPR_OP_PICK,
+
+    /** DW_OP_swap */
+    DWARF_EXPR_OP_SWAP,
+
+    /** DW_OP_rot */
+    DWARF_EXPR_OP_ROT,
+
+    /** DW_OP_abs */
+    DWARF_EXPR_OP_ABS,
+
+    /** DW_OP_and */
+    DWARF_EXPR_OP_AND,
+
+    /** DW_OP_div */
+    DWARF_EXPR_OP_DIV,
+
+    /** DW_OP_minus */
+    DWARF_EXPR_OP_MINUS,
+
+    /** DW_OP_mod */
+    DWARF_EXPR_OP_MOD,
+
+    /** DW_OP_mul */
+    DWARF_EXPR_OP_MUL,
+
+    /** DW_OP_neg */
+    DWARF_EXPR_OP_NEG,
+
+    /** DW_OP_not */
+    DWARF_EXPR_OP_NOT,
+
+    /** DW_OP_or */
+    DWARF_EXPR_OP_OR,
+
+    /** DW_OP_plus */
+    DWARF_EXPR_OP_PLUS,
+
+    /** DW_OP_shl */
+    DWARF_EXPR_OP_SHL,
+
+    /** DW_OP_shr */
+    DWARF_EXPR_OP_SHR,
+
+    /** DW_OP_shra */
+    DWARF_EXPR_OP_SHRA,
+
+    /** DW_OP_xor */
+    DWARF_EXPR_OP_XOR,
+
+    /** DW_OP_le */
+    DWARF_EXPR_OP_LE,
+
+    /** DW_OP_ge */
+    DWARF_EXPR_OP_GE,
+
+    /** DW_OP_eq */
+    DWARF_EXPR_OP_EQ,
+
+    /** DW_OP_lt */
+    DWARF_EXPR_OP_LT,
+
+    /** DW_OP_gt */
+    DWARF_EXPR_OP_GT,
+
+    /** DW_OP_ne */
+    DWARF_EXPR_OP_NE,
+
+    /** End of the expression; the top of the stack is the result. */
+    DWARF_EXPR_OP_END
+} dwarf_expr_opcode_t;
+
+/**
+ * @internal
+ *
+ * A single pre-decoded DWARF expression operation.
+ */
+template <typename machine_ptr> struct dwarf_expr_op {
+    /** The immediate operand, if any. */
+    machine_ptr operand;
+
+    /** The register, for DWARF_EXPR_OP_REG and DWARF_EXPR_OP_REG_DEREF operations. */
+    plcrash_regnum_t regnum;
+
+    /** The dwarf_expr_opcode_t operation. */
+    uint8_t opcode;
+};
+
+/**
+ * @internal
+ *
+ * Validate and decode a DWARF expression into a compact array of pre-decoded operations, fusing common operation
+ * sequences. The expression's stack usage is verified during decoding, allowing the result to be executed by
+ * plcrash_async_dwarf_expression_exec() without any further bounds checking.
+ *
+ * Only expressions that are guaranteed to evaluate without decoding or stack errors are accepted. Expressions that use
+ * control flow (DW_OP_skip, DW_OP_bra), unsupported opcodes, or registers that are not defined for @a thread_state
+ * are rejected, and must be evaluated by plcrash_async_dwarf_expression_interpret(), which will report any errors
+ * exactly as they would be encountered during evaluation.
+ *
+ * @param mobj The memory object from which the expression opcodes will be read.
+ * @param thread_state The thread state against which the expression will be evaluated.
+ * @param byteorder The byte order of the data referenced by @a mobj.
+ * @param address The task-relative address within @a mobj at which the opcodes will be fetched.
+ * @param offset An offset to be applied to @a address.
+ * @param length The total length of the opcodes readable at @a address + @a offset.
+ * @param initial_count The number of values that will be pushed on the stack prior to evaluation.
+ * @param ops On success, the decoded operations, terminated by DWARF_EXPR_OP_END. Must have room for
+ * DWARF_EXPR_MAX_OPS + 1 entries.
+ *
+ * @return Returns true if the expression was decoded, or false if it must be interpreted directly.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static bool plcrash_async_dwarf_expression_decode (plcrash_async_mobject_t *mobj,
+                                                   const plcrash_async_thread_state_t *thread_state,
+                                                   const plcrash_async_byteorder_t *byteorder,
+                                                   pl_vm_address_t address,
+                                                   pl_vm_off_t offset,
+                                                   pl_vm_size_t length,
+                                                   size_t initial_count,
+                                                   dwarf_expr_op<machine_ptr> *ops)
+{
+    dwarf_opstream opstream;
+    size_t count = 0;
+    size_t depth = initial_count;
+
+    if (initial_count > DWARF_EXPR_STACK_SIZE)
+        return false;
+
+    if (opstream.init(mobj, byteorder, address, offset, length) != PLCRASH_ESUCCESS)
+        return false;
+
+    /* Operand read macros; any failure rejects the expression */
+#define dw_decode_read_int(_type) ({ \
+    _type v; \
+    if (!opstream.read_intU<_type>(&v)) \
+        return false; \
+    v; \
+})
+
+#define dw_decode_read_uleb128() ({ \
+    uint64_t v; \
+    if (!opstream.read_uleb128(&v)) \
+        return false; \
+    v; \
+})
+
+#define dw_decode_read_sleb128() ({ \
+    int64_t v; \
+    if (!opstream.read_sleb128(&v)) \
+        return false; \
+    v; \
+})
+
+    /* Map a DWARF register number, rejecting unsupported registers */
+#define dw_decode_regnum(_dw_regnum) ({ \
+    plcrash_regnum_t rn; \
+    if (!plcrash_async_thread_state_map_dwarf_to_reg(thread_state, _dw_regnum, &rn)) \
+        return false; \
+    rn; \
+})
+
+    /* Validate that the operation's stack requirements can be met, and apply its stack delta */
+#define dw_decode_stack(_required, _popped, _pushed) do { \
+    if (depth < (_required)) \
+        return false; \
+    depth -= (_popped); \
+    if (DWARF_EXPR_STACK_SIZE - depth < (_pushed)) \
+        return false; \
+    depth += (_pushed); \
+} while (0)
+
+    /* Append an operation */
+#define dw_decode_emit(_opcode, _operand, _regnum) do { \
+    if (count == DWARF_EXPR_MAX_OPS) \
+        return false; \
+    ops[count].opcode = (_opcode); \
+    ops[count].operand = (_operand); \
+    ops[count].regnum = (_regnum); \
+    count++; \
+} while (0)
+
+    /* Append an operation that pops @a _popped values and pushes @a _pushed values, without an operand. */
+#define dw_decode_simple(_opcode, _popped, _pushed) do { \
+    dw_decode_stack((_popped), (_popped), (_pushed)); \
+    dw_decode_emit((_opcode), 0, PLCRASH_REG_INVALID); \
+} while (0)
+
+    uint8_t opcode;
+    while (opstream.read_intU(&opcode)) {
+        switch (opcode) {
+            case DW_OP_lit0 ... DW_OP_lit31:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) (opcode - DW_OP_lit0), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const1u:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) dw_decode_read_int(uint8_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const1s:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) dw_decode_read_int(int8_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const2u:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) dw_decode_read_int(uint16_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const2s:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) (int16_t) dw_decode_read_int(int16_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const4u:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) dw_decode_read_int(uint32_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const4s:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) (int32_t) dw_decode_read_int(int32_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const8u:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) dw_decode_read_int(uint64_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_const8s:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) (int64_t) dw_decode_read_int(int64_t), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_constu:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) dw_decode_read_uleb128(), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_consts:
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_CONST, (machine_ptr) (machine_ptr_s) dw_decode_read_sleb128(), PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_breg0 ... DW_OP_breg31: {
+                plcrash_regnum_t regnum = dw_decode_regnum(opcode - DW_OP_breg0);
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_REG, (machine_ptr) (machine_ptr_s) dw_decode_read_sleb128(), regnum);
+                break;
+            }
+
+            case DW_OP_bregx: {
+                plcrash_regnum_t regnum = dw_decode_regnum((machine_ptr) dw_decode_read_uleb128());
+                dw_decode_stack(0, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_REG, (machine_ptr) (machine_ptr_s) dw_decode_read_sleb128(), regnum);
+                break;
+            }
+
+            case DW_OP_dup:
+                dw_decode_simple(DWARF_EXPR_OP_DUP, 1, 2);
+                break;
+
+            case DW_OP_drop:
+                dw_decode_simple(DWARF_EXPR_OP_DROP, 1, 0);
+                break;
+
+            case DW_OP_pick: {
+                uint8_t index = dw_decode_read_int(uint8_t);
+                dw_decode_stack((size_t) index + 1, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_PICK, index, PLCRASH_REG_INVALID);
+                break;
+            }
+
+            case DW_OP_over:
+                dw_decode_stack(2, 0, 1);
+                dw_decode_emit(DWARF_EXPR_OP_PICK, 1, PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_swap:
+                dw_decode_simple(DWARF_EXPR_OP_SWAP, 2, 2);
+                break;
+
+            case DW_OP_rot:
+                dw_decode_simple(DWARF_EXPR_OP_ROT, 3, 3);
+                break;
+
+            case DW_OP_xderef:
+                /* Excise the address space value, as is done by the interpreter */
+                dw_decode_simple(DWARF_EXPR_OP_SWAP, 2, 2);
+                dw_decode_simple(DWARF_EXPR_OP_DROP, 1, 0);
+                dw_decode_simple(DWARF_EXPR_OP_DEREF, 1, 1);
+                break;
+
+            case DW_OP_deref:
+                dw_decode_stack(1, 1, 1);
+
+                /* Fuse with a preceding register load */
+                if (count > 0 && ops[count - 1].opcode == DWARF_EXPR_OP_REG) {
+                    ops[count - 1].opcode = DWARF_EXPR_OP_REG_DEREF;
+                    break;
+                }
+
+                dw_decode_emit(DWARF_EXPR_OP_DEREF, 0, PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_xderef_size:
+            case DW_OP_deref_size: {
+                if (opcode == DW_OP_xderef_size) {
+                    /* Excise the address space value, as is done by the interpreter */
+                    dw_decode_simple(DWARF_EXPR_OP_SWAP, 2, 2);
+                    dw_decode_simple(DWARF_EXPR_OP_DROP, 1, 0);
+                }
+
+                uint8_t size = dw_decode_read_int(uint8_t);
+                if (size > sizeof(machine_ptr) || (size != 1 && size != 2 && size != 4 && size != 8))
+                    return false;
+
+                dw_decode_stack(1, 1, 1);
+                dw_decode_emit(DWARF_EXPR_OP_DEREF_SIZE, size, PLCRASH_REG_INVALID);
+                break;
+            }
+
+            case DW_OP_abs:
+                dw_decode_simple(DWARF_EXPR_OP_ABS, 1, 1);
+                break;
+
+            case DW_OP_and:
+                dw_decode_simple(DWARF_EXPR_OP_AND, 2, 1);
+                break;
+
+            case DW_OP_div:
+                dw_decode_simple(DWARF_EXPR_OP_DIV, 2, 1);
+                break;
+
+            case DW_OP_minus:
+                dw_decode_simple(DWARF_EXPR_OP_MINUS, 2, 1);
+                break;
+
+            case DW_OP_mod:
+                dw_decode_simple(DWARF_EXPR_OP_MOD, 2, 1);
+                break;
+
+            case DW_OP_mul:
+                dw_decode_simple(DWARF_EXPR_OP_MUL, 2, 1);
+                break;
+
+            case DW_OP_neg:
+                dw_decode_simple(DWARF_EXPR_OP_NEG, 1, 1);
+                break;
+
+            case DW_OP_not:
+                dw_decode_simple(DWARF_EXPR_OP_NOT, 1, 1);
+                break;
+
+            case DW_OP_or:
+                dw_decode_simple(DWARF_EXPR_OP_OR, 2, 1);
+                break;
+
+            case DW_OP_plus:
+                dw_decode_stack(2, 2, 1);
+
+                /* Fuse with a preceding constant */
+                if (count > 0 && ops[count - 1].opcode == DWARF_EXPR_OP_CONST) {
+                    ops[count - 1].opcode = DWARF_EXPR_OP_PLUS_CONST;
+                    break;
+                }
+
+                dw_decode_emit(DWARF_EXPR_OP_PLUS, 0, PLCRASH_REG_INVALID);
+                break;
+
+            case DW_OP_plus_uconst: {
+                machine_ptr value = (machine_ptr) dw_decode_read_uleb128();
+                dw_decode_stack(1, 1, 1);
+                dw_decode_emit(DWARF_EXPR_OP_PLUS_CONST, value, PLCRASH_REG_INVALID);
+                break;
+            }
+
+            case DW_OP_shl:
+                dw_decode_simple(DWARF_EXPR_OP_SHL, 2, 1);
+                break;
+
+            case DW_OP_shr:
+                dw_decode_simple(DWARF_EXPR_OP_SHR, 2, 1);
+                break;
+
+            case DW_OP_shra:
+                dw_decode_simple(DWARF_EXPR_OP_SHRA, 2, 1);
+                break;
+
+            case DW_OP_xor:
+                dw_decode_simple(DWARF_EXPR_OP_XOR, 2, 1);
+                break;
+
+            case DW_OP_le:
+                dw_decode_simple(DWARF_EXPR_OP_LE, 2, 1);
+                break;
+
+            case DW_OP_ge:
+                dw_decode_simple(DWARF_EXPR_OP_GE, 2, 1);
+                break;
+
+            case DW_OP_eq:
+                dw_decode_simple(DWARF_EXPR_OP_EQ, 2, 1);
+                break;
+
+            case DW_OP_lt:
+                dw_decode_simple(DWARF_EXPR_OP_LT, 2, 1);
+                break;
+
+            case DW_OP_gt:
+                dw_decode_simple(DWARF_EXPR_OP_GT, 2, 1);
+                break;
+
+            case DW_OP_ne:
+                dw_decode_simple(DWARF_EXPR_OP_NE, 2, 1);
+                break;
+
+            case DW_OP_nop:
+                break;
+
+            default:
+                /* Control flow and unsupported opcodes are left to the interpreter */
+                return false;
+        }
+    }
+
+    /* The expression must produce a result */
+    if (depth == 0)
+        return false;
+
+    ops[count].opcode = DWARF_EXPR_OP_END;
+
+#undef dw_decode_read_int
+#undef dw_decode_read_uleb128
+#undef dw_decode_read_sleb128
+#undef dw_decode_regnum
+#undef dw_decode_stack
+#undef dw_decode_emit
+#undef dw_decode_simple
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Execute a DWARF expression pre-decoded by plcrash_async_dwarf_expression_decode(). As the expression's stack usage
+ * was validated during decoding, no bounds checks are performed; the only errors that may occur are those that depend
+ * on the target's state, such as an unreadable address or unavailable register value.
+ *
+ * Operations are dispatched via a table of label addresses, with each operation branching directly to the
+ * next.
+ *
+ * @param ops The decoded operations.
+ * @param task The task from which any DWARF expression memory loads will be performed.
+ * @param thread_state The thread state against which the expression will be evaluated.
+ * @param initial_state Initial set of values to be pushed onto the evaluation stack.
+ * @param initial_count Number of values in the @a initial_state array.
+ * @param result[out] On success, the evaluation result.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t value on failure.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+static plcrash_error_t plcrash_async_dwarf_expression_exec (const dwarf_expr_op<machine_ptr> *ops,
+                                                            task_t task,
+                                                            const plcrash_async_thread_state_t *thread_state,
+                                                            machine_ptr initial_state[],
+                                                            size_t initial_count,
+                                                            machine_ptr *result)
+{
+    /* Must match the dwarf_expr_opcode_t declaration order */
+    static void * const dispatch[] = {
+        &&op_const, &&op_reg, &&op_reg_deref, &&op_plus_const, &&op_deref, &&op_deref_size,
+        &&op_dup, &&op_drop, &&op_pick, &&op_swap, &&op_rot,
+        &&op_abs, &&op_and, &&op_div, &&op_minus, &&op_mod, &&op_mul, &&op_neg, &&op_not, &&op_or, &&op_plus,
+        &&op_shl, &&op_shr, &&op_shra, &&op_xor,
+        &&op_le, &&op_ge, &&op_eq, &&op_lt, &&op_gt, &&op_ne,
+        &&op_end
+    };
+
+    machine_ptr stack[DWARF_EXPR_STACK_SIZE];
+    machine_ptr *sp = stack;
+    const dwarf_expr_op<machine_ptr> *op = ops;
+    plcrash_error_t err;
+
+    for (size_t i = 0; i < initial_count; i++)
+        *sp++ = initial_state[i];
+
+#define dw_exec_next() goto *dispatch[(++op)->opcode]
+
+    /* Fetch a register value; the register number was validated during decoding */
+#define dw_exec_regval(_regnum) ({ \
+    if (!plcrash_async_thread_state_has_reg(thread_state, _regnum)) { \
+        PLCF_DEBUG("Register value of %s unavailable in the current frame.", plcrash_async_thread_state_get_reg_name(thread_state, _regnum)); \
+        return PLCRASH_ENOTFOUND; \
+    } \
+    (machine_ptr) plcrash_async_thread_state_get_reg(thread_state, _regnum); \
+})
+
+    /* Apply a binary operation to the top two stack values, where _lhs is the second value and _rhs is the top */
+#define dw_exec_binary(_type, _expr) do { \
+    _type rhs = (_type) sp[-1]; \
+    _type lhs = (_type) sp[-2]; \
+    (void) lhs; (void) rhs; \
+    sp[-2] = (machine_ptr) (_expr); \
+    sp--; \
+} while (0)
+
+    goto *dispatch[op->opcode];
+
+op_const:
+    *sp++ = op->operand;
+    dw_exec_next();
+
+op_reg:
+    *sp++ = dw_exec_regval(op->regnum) + op->operand;
+    dw_exec_next();
+
+op_reg_deref: {
+    machine_ptr addr = dw_exec_regval(op->regnum) + op->operand;
+    machine_ptr value;
+    if ((err = plcrash_async_task_memcpy(task, addr, 0, &value, sizeof(value))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("DW_OP_deref referenced an invalid target address 0x%" PRIx64, (uint64_t) addr);
+        return err;
+    }
+    *sp++ = value;
+    dw_exec_next();
+}
+
+op_plus_const:
+    sp[-1] = op->operand + sp[-1];
+    dw_exec_next();
+
+op_deref: {
+    machine_ptr addr = sp[-1];
+    machine_ptr value;
+    if ((err = plcrash_async_task_memcpy(task, addr, 0, &value, sizeof(value))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("DW_OP_deref referenced an invalid target address 0x%" PRIx64, (uint64_t) addr);
+        return err;
+    }
+    sp[-1] = value;
+    dw_exec_next();
+}
+
+op_deref_size: {
+    machine_ptr addr = sp[-1];
+    machine_ptr value = 0;
+
+    #define readval(_type) case sizeof(_type): { \
+        _type r; \
+        if ((err = plcrash_async_task_memcpy(task, (pl_vm_address_t)addr, 0, &r, sizeof(_type))) != PLCRASH_ESUCCESS) { \
+            PLCF_DEBUG("DW_OP_deref_size referenced an invalid target address 0x%" PRIx64, (uint64_t) addr); \
+            return err; \
+        } \
+        value = r; \
+        break; \
+    }
+    switch (op->operand) {
+        readval(uint8_t);
+        readval(uint16_t);
+        readval(uint32_t);
+        readval(uint64_t);
+    }
+    #undef readval
+
+    sp[-1] = value;
+    dw_exec_next();
+}
+
+op_dup:
+    sp[0] = sp[-1];
+    sp++;
+    dw_exec_next();
+
+op_drop:
+    sp--;
+    dw_exec_next();
+
+op_pick:
+    sp[0] = sp[-1 - (ptrdiff_t) op->operand];
+    sp++;
+    dw_exec_next();
+
+op_swap: {
+    machine_ptr v = sp[-1];
+    sp[-1] = sp[-2];
+    sp[-2] = v;
+    dw_exec_next();
+}
+
+op_rot: {
+    machine_ptr v1 = sp[-1];
+    sp[-1] = sp[-2];
+    sp[-2] = sp[-3];
+    sp[-3] = v1;
+    dw_exec_next();
+}
+
+op_abs: {
+    machine_ptr_s v = (machine_ptr_s) sp[-1];
+    if (v < 0)
+        sp[-1] = -v;
+    dw_exec_next();
+}
+
+op_and:
+    dw_exec_binary(machine_ptr, lhs & rhs);
+    dw_exec_next();
+
+op_div:
+    if (sp[-1] == 0) {
+        PLCF_DEBUG("DW_OP_div attempted divide by zero");
+        return PLCRASH_EINVAL;
+    }
+    /* Matches the interpreter, in which the signed divisor is promoted to the unsigned dividend's type */
+    dw_exec_binary(machine_ptr, lhs / (machine_ptr) (machine_ptr_s) rhs);
+    dw_exec_next();
+
+op_minus:
+    dw_exec_binary(machine_ptr, lhs - rhs);
+    dw_exec_next();
+
+op_mod:
+    if (sp[-1] == 0) {
+        PLCF_DEBUG("DW_OP_mod attempted divide by zero");
+        return PLCRASH_EINVAL;
+    }
+    dw_exec_binary(machine_ptr, lhs % rhs);
+    dw_exec_next();
+
+op_mul:
+    dw_exec_binary(machine_ptr, lhs * rhs);
+    dw_exec_next();
+
+op_neg:
+    sp[-1] = 0 - (machine_ptr_s) sp[-1];
+    dw_exec_next();
+
+op_not:
+    sp[-1] = ~sp[-1];
+    dw_exec_next();
+
+op_or:
+    dw_exec_binary(machine_ptr, lhs | rhs);
+    dw_exec_next();
+
+op_plus:
+    dw_exec_binary(machine_ptr, lhs + rhs);
+    dw_exec_next();
+
+op_shl:
+    dw_exec_binary(machine_ptr, lhs << rhs);
+    dw_exec_next();
+
+op_shr:
+    dw_exec_binary(machine_ptr, lhs >> rhs);
+    dw_exec_next();
+
+op_shra:
+    dw_exec_binary(machine_ptr, ((machine_ptr_s) lhs) >> rhs);
+    dw_exec_next();
+
+op_xor:
+    dw_exec_binary(machine_ptr, lhs ^ rhs);
+    dw_exec_next();
+
+op_le:
+    dw_exec_binary(machine_ptr, lhs <= rhs);
+    dw_exec_next();
+
+op_ge:
+    dw_exec_binary(machine_ptr, lhs >= rhs);
+    dw_exec_next();
+
+op_eq:
+    dw_exec_binary(machine_ptr, lhs == rhs);
+    dw_exec_next();
+
+op_lt:
+    dw_exec_binary(machine_ptr, lhs < rhs);
+    dw_exec_next();
+
+op_gt:
+    dw_exec_binary(machine_ptr, lhs > rhs);
+    dw_exec_next();
+
+op_ne:
+    dw_exec_binary(machine_ptr, lhs != rhs);
+    dw_exec_next();
+
+op_end:
+    *result = sp[-1];
+
+#undef dw_exec_next
+#undef dw_exec_regval
+#undef dw_exec_binary
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Evaluate a DWARF expression, as defined in the DWARF 4 Specification, Section 2.5. This
+ * internal implementation is templated to support 32-bit and 64-bit evaluation.
+ *
+ * @param mobj The memory object from which the expression opcodes will be read.
+ * @param task The task from which any DWARF expression memory loads will be performed.
+ * @param thread_state The thread state against which the expression will be evaluated.
+ * @param byteorder The byte order of the data referenced by @a mobj and @a thread_state.
+ * @param address The task-relative address within @a mobj at which the opcodes will be fetched.
+ * @param offset An offset to be applied to @a address.
+ * @param length The total length of the opcodes readable at @a address + @a offset.
+ * @param initial_state Initial set of values to be pushed onto the evaluation stack. The values will be pushed
+ * on their natural order; eg, the top of the stack will be the last value in this array. If the initial stack
+ * state should be empty, this value may be NULL, and @a initial_count should be 0.
+ * @param initial_count Number of values in the @a initial_state array.
+ * @param result[out] On success, the evaluation result. As per DWARF 3 section 2.5.1, this will be
+ * the top-most element on the evaluation stack. If the stack is empty, an error will be returned
+ * and no value will be written to this parameter.
+ * @param budget The work budget to be consumed by the evaluation, or NULL.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate plcrash_error_t values
+ * on failure. If an invalid opcode is detected, PLCRASH_ENOTSUP will be returned. If the stack
+ * is empty upon termination of evaluation, PLCRASH_EINVAL will be returned. If @a budget is exhausted,
+ * PLCRASH_EBUDGET will be returned.
+ *
+ * @todo Consider defining updated status codes or error handling to provide more structured
+ * error data on failure.
+ */
+template <typename machine_ptr, typename machine_ptr_s>
+plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mobj,
+                                                     task_t task,
+                                                     const plcrash_async_thread_state_t *thread_state,
+                                                     const plcrash_async_byteorder_t *byteorder,
+                                                     pl_vm_address_t address,
+                                                     pl_vm_off_t offset,
+                                                     pl_vm_size_t length,
+                                                     machine_ptr initial_state[],
+                                                     size_t initial_count,
+                                                     machine_ptr *result,
+                                                     plcrash_async_work_budget_t *budget)
+{
+    /* Prefer the pre-decoded evaluator; expressions that it can not validate are interpreted directly, which also
+     * provides precise error reporting for invalid expressions. */
+    dwarf_expr_op<machine_ptr> ops[DWARF_EXPR_MAX_OPS + 1];
+    if (plcrash_async_dwarf_expression_decode<machine_ptr, machine_ptr_s>(mobj, thread_state, byteorder, address, offset, length, initial_count, ops))
+        return plcrash_async_dwarf_expression_exec<machine_ptr, machine_ptr_s>(ops, task, thread_state, initial_state, initial_count, result);
+
+    return plcrash_async_dwarf_expression_interpret<machine_ptr, machine_ptr_s>(mobj, task, thread_state, byteorder, address, offset, length, initial_state, initial_count, result, budget);
+}
+
 /* Provide explicit 32/64-bit instantiations */
 template plcrash_error_t plcrash_async_dwarf_expression_eval<uint32_t, int32_t> (plcrash_async_mobject_t *mobj,
                                                                                  task_t task,
@@ -707,7 +1492,8 @@ template plcrash_error_t plcrash_async_dwarf_expression_eval<uint32_t, int32_t>
                                                                                  pl_vm_size_t length,
                                                                                  uint32_t initial_state[],
                                                                                  size_t initial_count,
-                                                                                 uint32_t *result);
+                                                                                 uint32_t *result,
+                                                                                 plcrash_async_work_budget_t *budget);
 
 template plcrash_error_t plcrash_async_dwarf_expression_eval<uint64_t, int64_t> (plcrash_async_mobject_t *mobj,
                                                                                  task_t task,
@@ -718,7 +1504,8 @@ template plcrash_error_t plcrash_async_dwarf_expression_eval<uint64_t, int64_t>
                                                                                  pl_vm_size_t length,
                                                                                  uint64_t initial_state[],
                                                                                  size_t initial_count,
-                                                                                 uint64_t *result);
+                                                                                 uint64_t *result,
+                                                                                 plcrash_async_work_budget_t *budget);
 /**
  * @}
  */
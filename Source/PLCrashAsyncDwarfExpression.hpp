@@ -30,6 +30,7 @@
 #include "PLCrashAsync.h"
 #include "PLCrashAsyncMObject.h"
 #include "PLCrashAsyncThread.h"
+#include "PLCrashAsyncWorkBudget.h"
 
 #include "PLCrashFeatureConfig.h"
 
@@ -567,7 +568,8 @@ plcrash_error_t plcrash_async_dwarf_expression_eval (plcrash_async_mobject_t *mo
                                                      pl_vm_size_t length,
                                                      machine_ptr initial_state[],
                                                      size_t initial_count,
-                                                     machine_ptr *result);
+                                                     machine_ptr *result,
+                                                     plcrash_async_work_budget_t *budget = NULL);
 
 /**
  * @}
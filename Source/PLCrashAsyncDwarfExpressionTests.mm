@@ -55,8 +55,8 @@
 
 #elif PLCRASH_ASYNC_THREAD_ARM_SUPPORT
 
-#    define TEST_THREAD_64_CPU CPU_TYPE_ARM
-#    define TEST_THREAD_64_DWARF_REG1 14 // LR (r14)
+#    define TEST_THREAD_64_CPU CPU_TYPE_ARM64
+#    define TEST_THREAD_64_DWARF_REG1 30 // LR (x30)
 #    define TEST_THREAD_64_DWARF_REG_INVALID 31 // unhandled DWARF register number
 
 #    define TEST_THREAD_32_CPU CPU_TYPE_ARM
@@ -353,6 +353,42 @@
     PERFORM_EVAL_TEST(opcodes_negative, uint64_t, 0xFF-2);
 }
 
+/**
+ * Test evaluation of a register-relative load (DW_OP_bregN, DW_OP_deref, DW_OP_plus_uconst), a sequence
+ * that is fused during pre-decoding.
+ */
+- (void) testRegisterDereference {
+    uint64_t testval[2] = { 0x10, 0x10 };
+    uintptr_t addr = (uintptr_t) &testval[1];
+
+    /* We can only test the 32-bit case when our addresses are within the 32-bit addressable range. */
+    if ([self is32] && addr >= UINT32_MAX)
+        return;
+
+    /* Point the test register 8 bytes past the start of the value; it's loaded from breg - 8 */
+    plcrash_regnum_t regnum;
+    STAssertTrue(plcrash_async_thread_state_map_dwarf_to_reg(&_ts, [self dwarfTestRegister], &regnum), @"Failed to map DWARF register");
+    plcrash_async_thread_state_set_reg(&_ts, regnum, addr);
+
+    uint8_t opcodes[] = { DW_OP_breg0 + [self dwarfTestRegister], 0x78 /* -8 */, DW_OP_deref, DW_OP_lit5, DW_OP_plus };
+    PERFORM_EVAL_TEST(opcodes, uint8_t, 0x15);
+}
+
+/**
+ * Test evaluation of an expression that exceeds the pre-decoded operation limit, and must be interpreted directly.
+ */
+- (void) testLongExpression {
+    /* 64 constants, each summed with the next */
+    uint8_t opcodes[1 + 63 * 2];
+    opcodes[0] = DW_OP_lit1;
+    for (size_t i = 1; i < sizeof(opcodes); i += 2) {
+        opcodes[i] = DW_OP_lit1;
+        opcodes[i+1] = DW_OP_plus;
+    }
+
+    PERFORM_EVAL_TEST(opcodes, uint32_t, 64);
+}
+
 /** Test evaluation of DW_OP_dup */
 - (void) testDup {
     uint8_t opcodes[] = { DW_OP_const1u, 0x5, DW_OP_dup };
@@ -723,6 +759,32 @@
     PERFORM_EVAL_TEST_ERROR(opcodes, PLCRASH_EINVAL);
 }
 
+/** Test that evaluation of a non-terminating DW_OP_skip loop is bounded by the work budget */
+- (void) testSkipLoopBudget {
+    uint8_t opcodes[] = { DW_OP_lit1, DW_OP_skip, 0xFF, 0xFD /* -3; jump to self */ };
+    plcrash_async_mobject_t mobj;
+    plcrash_error_t err;
+
+    plcrash_async_work_budget_t budget;
+    plcrash_async_work_budget_init(&budget);
+    plcrash_async_work_budget_set_limit(&budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 64);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &opcodes, sizeof(opcodes), true), @"Failed to initialize mobj");
+
+    if (![self is32]) {
+        uint64_t result;
+        err = plcrash_async_dwarf_expression_eval<uint64_t, int64_t>(&mobj, mach_task_self(), &_ts, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes), NULL, 0, &result, &budget);
+    } else {
+        uint32_t result;
+        err = plcrash_async_dwarf_expression_eval<uint32_t, int32_t>(&mobj, mach_task_self(), &_ts, plcrash_async_byteorder_big_endian(), (pl_vm_address_t) &opcodes, 0, sizeof(opcodes), NULL, 0, &result, &budget);
+    }
+
+    STAssertEquals(err, PLCRASH_EBUDGET, @"Looping evaluation was not terminated by the work budget");
+    STAssertEquals(budget.exhausted[PLCRASH_ASYNC_WORK_DWARF_OPS], (int64_t) 1, @"Exhaustion was not recorded");
+
+    plcrash_async_mobject_free(&mobj);
+}
+
 /** Test basic evaluation of a NOP. */
 - (void) testNop {
     uint8_t opcodes[] = {
@@ -43,99 +43,200 @@ using namespace plcrash::async;
 
 
 /**
- * Decode FDE info at target-relative @a address.
+ * @internal
  *
- * Any resources held by a successfully initialized instance must be freed via plcrash_async_dwarf_fde_info_free();
+ * Decode the initial length and CIE pointer of the FDE at target-relative @a fde_address.
  *
- * @param info The FDE record to be initialized.
  * @param mobj The memory object containing frame data (eh_frame or debug_frame) at the start address.
- * @param byteoder The byte order of the data referenced by @a mobj.
- * @param address_size The native address size of the target architecture.
- * @param fde_address The target-relative address containing the FDE data to be decoded. This must include
- * the length field of the FDE.
- * @param debug_frame If true, interpret the DWARF data as a debug_frame section. Otherwise, the
- * frame reader will assume eh_frame data.
+ * @param byteorder The byte order of the data referenced by @a mobj.
+ * @param fde_address The target-relative address of the FDE, including its length field.
+ * @param debug_frame If true, interpret the DWARF data as a debug_frame section, otherwise as eh_frame data.
+ * @param fde_length[out] The FDE length, not including the initial length field.
+ * @param length_size[out] The size of the initial length field.
+ * @param cie_address[out] The target-relative address of the FDE's CIE.
+ * @param offset[out] The offset from @a fde_address of the data following the CIE pointer.
  */
-template <typename machine_ptr>
-plcrash_error_t plcrash::async::plcrash_async_dwarf_fde_info_init (plcrash_async_dwarf_fde_info_t *info,
-                                                                   plcrash_async_mobject_t *mobj,
-                                                                   const plcrash_async_byteorder_t *byteorder,
-                                                                   pl_vm_address_t fde_address,
-                                                                   bool debug_frame)
+static plcrash_error_t plcrash_async_dwarf_fde_read_header (plcrash_async_mobject_t *mobj,
+                                                           const plcrash_async_byteorder_t *byteorder,
+                                                           pl_vm_address_t fde_address,
+                                                           bool debug_frame,
+                                                           uint64_t *fde_length,
+                                                           pl_vm_size_t *length_size,
+                                                           pl_vm_address_t *cie_address,
+                                                           pl_vm_size_t *offset)
 {
     const pl_vm_address_t sect_addr = plcrash_async_mobject_base_address(mobj);
     plcrash_error_t err;
-    pl_vm_size_t offset = 0;
+    *offset = 0;
     
-    /* Extract and save the FDE length */
+    /* Extract the FDE length */
     uint8_t dwarf_word_size;
-    pl_vm_size_t length_size;
     {
         uint32_t length32;
         
-        if (plcrash_async_mobject_read_uint32(mobj, byteorder, fde_address, offset, &length32) != PLCRASH_ESUCCESS) {
+        if (plcrash_async_mobject_read_uint32(mobj, byteorder, fde_address, *offset, &length32) != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("The current FDE entry 0x%" PRIx64 " header lies outside the mapped range", (uint64_t) fde_address);
             return PLCRASH_EINVAL;
         }
         
-        offset += sizeof(uint32_t);
+        *offset += sizeof(uint32_t);
         
         if (length32 == UINT32_MAX) {
-            if ((err = plcrash_async_mobject_read_uint64(mobj, byteorder, fde_address, sizeof(uint32_t), &info->fde_length)) != PLCRASH_ESUCCESS) {
+            if ((err = plcrash_async_mobject_read_uint64(mobj, byteorder, fde_address, sizeof(uint32_t), fde_length)) != PLCRASH_ESUCCESS) {
                 PLCF_DEBUG("Failed to read FDE 64-bit length value value; FDE entry lies outside the mapped range");
                 return err;
             }
             
-            length_size = sizeof(uint64_t) + sizeof(uint32_t);
-            offset += sizeof(uint64_t);
+            *length_size = sizeof(uint64_t) + sizeof(uint32_t);
+            *offset += sizeof(uint64_t);
             dwarf_word_size = 8; // 64-bit DWARF
         } else {
-            info->fde_length = length32;
-            length_size = sizeof(uint32_t);
+            *fde_length = length32;
+            *length_size = sizeof(uint32_t);
             dwarf_word_size = 4; // 32-bit DWARF
         }
     }
     
-    /* Save the FDE offset; this is the FDE address, relative to the mobj base address, not including
-     * the FDE initial length. */
-    info->fde_offset = (fde_address - sect_addr) + length_size;
-    
     /*
      * Calculate the the offset to the CIE entry.
      */
-    pl_vm_address_t cie_target_address;
-    {
-        uint64_t raw_offset;
-        
-        if ((err = plcrash_async_dwarf_read_uintmax64(mobj, byteorder, fde_address, offset, dwarf_word_size, &raw_offset)) != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("FDE instruction offset falls outside the mapped range");
-            return err;
+    uint64_t raw_offset;
+    
+    if ((err = plcrash_async_dwarf_read_uintmax64(mobj, byteorder, fde_address, *offset, dwarf_word_size, &raw_offset)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("FDE instruction offset falls outside the mapped range");
+        return err;
+    }
+    *offset += dwarf_word_size;
+    
+    /* In a .debug_frame, the CIE offset is already relative to the start of the section;
+     * In a .eh_frame, the CIE offset is negative, relative to the current offset of the the FDE. */
+    if (debug_frame) {
+        /* (Safely) calculate the absolute, task-relative address */
+        if (raw_offset > PL_VM_OFF_MAX || !plcrash_async_address_apply_offset(sect_addr, raw_offset, cie_address)) {
+            PLCF_DEBUG("CIE offset of 0x%" PRIx64 " overflows representable range of pl_vm_address_t", raw_offset);
+            return PLCRASH_EINVAL;
         }
-        offset += dwarf_word_size;
-        
-        /* In a .debug_frame, the CIE offset is already relative to the start of the section;
-         * In a .eh_frame, the CIE offset is negative, relative to the current offset of the the FDE. */
-        if (debug_frame) {
-            info->cie_offset = raw_offset;
-            
-            /* (Safely) calculate the absolute, task-relative address */
-            if (raw_offset > PL_VM_OFF_MAX || !plcrash_async_address_apply_offset(sect_addr, raw_offset, &cie_target_address)) {
-                PLCF_DEBUG("CIE offset of 0x%" PRIx64 " overflows representable range of pl_vm_address_t", raw_offset);
-                return PLCRASH_EINVAL;
-            }
-        } else {
-            /* First, verify that the below subtraction won't overflow */
-            if (raw_offset > (fde_address+length_size)) {
-                PLCF_DEBUG("CIE offset 0x%" PRIx64 " would place the CIE value outside of the .eh_frame section", raw_offset);
-                return PLCRASH_EINVAL;
-            }
-            
-            cie_target_address = (fde_address+length_size) - raw_offset;
-            info->cie_offset = cie_target_address - sect_addr;
+    } else {
+        /* First, verify that the below subtraction won't overflow */
+        if (raw_offset > (fde_address + *length_size)) {
+            PLCF_DEBUG("CIE offset 0x%" PRIx64 " would place the CIE value outside of the .eh_frame section", raw_offset);
+            return PLCRASH_EINVAL;
         }
         
+        *cie_address = (fde_address + *length_size) - raw_offset;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Decode the FDE address range at @a fde_address + @a offset.
+ *
+ * @param ptr_reader The pointer reader to use when decoding the range.
+ * @param mobj The memory object containing the FDE.
+ * @param fde_address The target-relative address of the FDE.
+ * @param offset On input, the offset from @a fde_address of the FDE initial_location. On return, the offset of the
+ * data following the FDE address_range.
+ * @param pc_encoding The FDE pointer encoding defined by the FDE's CIE.
+ * @param pc_start[out] The start of the FDE's address range.
+ * @param pc_end[out] The end of the FDE's address range (exclusive).
+ */
+template <typename machine_ptr>
+static plcrash_error_t plcrash_async_dwarf_fde_read_pc_range (gnu_ehptr_reader<machine_ptr> *ptr_reader,
+                                                             plcrash_async_mobject_t *mobj,
+                                                             pl_vm_address_t fde_address,
+                                                             pl_vm_size_t *offset,
+                                                             DW_EH_PE_t pc_encoding,
+                                                             uint64_t *pc_start,
+                                                             uint64_t *pc_end)
+{
+    plcrash_error_t err;
+    machine_ptr value;
+    size_t ptr_size;
+
+    /* Fetch the base PC address */
+    if ((err = ptr_reader->read(mobj, fde_address, *offset, pc_encoding, &value, &ptr_size)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read FDE initial_location");
+        return err;
+    }
+
+    *pc_start = value;
+    *offset += ptr_size;
+    
+    /* Fetch the PC length. In DWARF 3&4 specifications, this value is defined to use the standard platform pointer size. The
+     * LSB 4.1.0 specification does not define the expected format, but a review of GNU's GDB implementation (along with
+     * other independent implementations), demonstrates that this value uses the FDE pointer encoding with all indirection
+     * flags cleared. */
+    machine_ptr pc_length;
+    if ((err = ptr_reader->read(mobj, fde_address, *offset, (DW_EH_PE_t) (pc_encoding & DW_EH_PE_MASK_ENCODING), &pc_length, &ptr_size))) {
+        PLCF_DEBUG("Failed to read FDE address_length");
+        return err;
     }
     
+    if (UINT64_MAX - pc_length < *pc_start) {
+        PLCF_DEBUG("FDE address_length + initial_location exceeds UINT64_MAX");
+        return PLCRASH_EINVAL;
+    }
+    
+    *pc_end = *pc_start + pc_length;
+    *offset += ptr_size;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Return the FDE pointer encoding defined by @a cie.
+ */
+static DW_EH_PE_t plcrash_async_dwarf_fde_pc_encoding (plcrash_async_dwarf_cie_info_t *cie) {
+    /* Determine the correct encoding to use. This will either be encoded using the standard plaform
+     * pointer size (as per DWARF), or using the encoding defined in the augmentation string
+     * (as per the LSB 4.1.0 eh_frame specification). */
+    if (cie->has_eh_augmentation && cie->eh_augmentation.has_pointer_encoding)
+        return (DW_EH_PE_t) cie->eh_augmentation.pointer_encoding;
+
+    return DW_EH_PE_absptr;
+}
+
+/**
+ * Decode FDE info at target-relative @a address.
+ *
+ * Any resources held by a successfully initialized instance must be freed via plcrash_async_dwarf_fde_info_free();
+ *
+ * @param info The FDE record to be initialized.
+ * @param mobj The memory object containing frame data (eh_frame or debug_frame) at the start address.
+ * @param byteoder The byte order of the data referenced by @a mobj.
+ * @param address_size The native address size of the target architecture.
+ * @param fde_address The target-relative address containing the FDE data to be decoded. This must include
+ * the length field of the FDE.
+ * @param debug_frame If true, interpret the DWARF data as a debug_frame section. Otherwise, the
+ * frame reader will assume eh_frame data.
+ */
+template <typename machine_ptr>
+plcrash_error_t plcrash::async::plcrash_async_dwarf_fde_info_init (plcrash_async_dwarf_fde_info_t *info,
+                                                                   plcrash_async_mobject_t *mobj,
+                                                                   const plcrash_async_byteorder_t *byteorder,
+                                                                   pl_vm_address_t fde_address,
+                                                                   bool debug_frame)
+{
+    const pl_vm_address_t sect_addr = plcrash_async_mobject_base_address(mobj);
+    plcrash_error_t err;
+    pl_vm_size_t offset;
+    pl_vm_size_t length_size;
+    pl_vm_address_t cie_target_address;
+
+    /* Decode the FDE length and CIE pointer */
+    if ((err = plcrash_async_dwarf_fde_read_header(mobj, byteorder, fde_address, debug_frame, &info->fde_length, &length_size, &cie_target_address, &offset)) != PLCRASH_ESUCCESS)
+        return err;
+    
+    /* Save the FDE offset; this is the FDE address, relative to the mobj base address, not including
+     * the FDE initial length. */
+    info->fde_offset = (fde_address - sect_addr) + length_size;
+    info->cie_offset = cie_target_address - sect_addr;
+    
     /*
      * Set up default pointer state. TODO: Mac OS X and iOS do not currently use any relative-based encodings other
      * than pcrel. This matches libunwind-35.1, but we should ammend our API to support supplying the remainder of
@@ -150,47 +251,11 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_fde_info_init (plcrash_async
         return err;
     }
     
-    /*
-     * Fetch the address range described by this entry
-     */
-    {
-        machine_ptr value;
-        size_t ptr_size;
-        
-        /* Determine the correct encoding to use. This will either be encoded using the standard plaform
-         * pointer size (as per DWARF), or using the encoding defined in the augmentation string
-         * (as per the LSB 4.1.0 eh_frame specification). */
-        DW_EH_PE_t pc_encoding = DW_EH_PE_absptr;
-        if (cie.has_eh_augmentation && cie.eh_augmentation.has_pointer_encoding)
-            pc_encoding = (DW_EH_PE_t) cie.eh_augmentation.pointer_encoding;
-
-        /* Fetch the base PC address */
-        if ((err = ptr_reader.read(mobj, fde_address, offset, pc_encoding, &value, &ptr_size)) != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("Failed to read FDE initial_location");
-            return err;
-        }
-
-        info->pc_start = value;
-        offset += ptr_size;
-        
-        /* Fetch the PC length. In DWARF 3&4 specifications, this value is defined to use the standard platform pointer size. The
-         * LSB 4.1.0 specification does not define the expected format, but a review of GNU's GDB implementation (along with
-         * other independent implementations), demonstrates that this value uses the FDE pointer encoding with all indirection
-         * flags cleared. */
-        machine_ptr pc_length;
-        if ((err = ptr_reader.read(mobj, fde_address, offset, (DW_EH_PE_t) (pc_encoding & DW_EH_PE_MASK_ENCODING), &pc_length, &ptr_size))) {
-            PLCF_DEBUG("Failed to read FDE address_length");
-            return err;
-        }
-        
-        if (UINT64_MAX - pc_length < info->pc_start) {
-            PLCF_DEBUG("FDE address_length + initial_location exceeds UINT64_MAX");
-            return PLCRASH_EINVAL;
-        }
-        
-        info->pc_end = info->pc_start + pc_length;
-        offset += ptr_size;
-    }
+    /* Fetch the address range described by this entry */
+    err = plcrash_async_dwarf_fde_read_pc_range(&ptr_reader, mobj, fde_address, &offset, plcrash_async_dwarf_fde_pc_encoding(&cie), &info->pc_start, &info->pc_end);
+    plcrash_async_dwarf_cie_info_free(&cie);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
     
     /* The remainder of the FDE data is comprised of call frame instructions; we calculate the offset to the instructions,
      * as well as their length.
@@ -208,13 +273,68 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_fde_info_init (plcrash_async
     }
 
     info->instructions_length = info->fde_length - (info->instructions_offset - info->fde_offset);
-
-    /* Clean up */
-    plcrash_async_dwarf_cie_info_free(&cie);
     
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Decode only the address range of the FDE at target-relative @a fde_address. This is intended for use when scanning
+ * for the FDE matching a PC; the CIE is decoded only to determine the FDE pointer encoding, and only if the encoding
+ * is not already held by @a cache. The augmentation data, LSDA and instructions are not decoded; once a matching range
+ * is found, the full FDE may be decoded via plcrash_async_dwarf_fde_info_init().
+ *
+ * @param range The range to be initialized.
+ * @param mobj The memory object containing frame data (eh_frame or debug_frame) at the start address.
+ * @param byteorder The byte order of the data referenced by @a mobj.
+ * @param fde_address The target-relative address of the FDE, including its length field.
+ * @param debug_frame If true, interpret the DWARF data as a debug_frame section. Otherwise, the
+ * frame reader will assume eh_frame data.
+ * @param cache The CIE pointer encoding cache to be used across a scan, or NULL. The cache must be zero-initialized
+ * prior to first use, and must only be used with FDEs from @a mobj.
+ */
+template <typename machine_ptr>
+plcrash_error_t plcrash::async::plcrash_async_dwarf_fde_range_init (plcrash_async_dwarf_fde_range_t *range,
+                                                                    plcrash_async_mobject_t *mobj,
+                                                                    const plcrash_async_byteorder_t *byteorder,
+                                                                    pl_vm_address_t fde_address,
+                                                                    bool debug_frame,
+                                                                    plcrash_async_dwarf_fde_range_cache_t *cache)
+{
+    plcrash_error_t err;
+    pl_vm_size_t offset;
+    pl_vm_size_t length_size;
+    pl_vm_address_t cie_address;
+    uint64_t fde_length;
+
+    if ((err = plcrash_async_dwarf_fde_read_header(mobj, byteorder, fde_address, debug_frame, &fde_length, &length_size, &cie_address, &offset)) != PLCRASH_ESUCCESS)
+        return err;
+
+    gnu_ehptr_reader<machine_ptr> ptr_reader(byteorder);
+
+    /* Fetch the pointer encoding, decoding the CIE only if the previous FDE referenced a different CIE */
+    DW_EH_PE_t pc_encoding;
+    if (cache != NULL && cache->valid && cache->cie_address == cie_address) {
+        pc_encoding = (DW_EH_PE_t) cache->pc_encoding;
+    } else {
+        plcrash_async_dwarf_cie_info_t cie;
+        if ((err = plcrash_async_dwarf_cie_info_init(&cie, mobj, byteorder, &ptr_reader, cie_address)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to parse CFE for FDE");
+            return err;
+        }
+
+        pc_encoding = plcrash_async_dwarf_fde_pc_encoding(&cie);
+        plcrash_async_dwarf_cie_info_free(&cie);
+
+        if (cache != NULL) {
+            cache->cie_address = cie_address;
+            cache->pc_encoding = (uint8_t) pc_encoding;
+            cache->valid = true;
+        }
+    }
+
+    return plcrash_async_dwarf_fde_read_pc_range(&ptr_reader, mobj, fde_address, &offset, pc_encoding, &range->pc_start, &range->pc_end);
+}
+
 /**
  * Return the offset of the FDE instructions, relative to the eh_frame/debug_frame section base.
  *
@@ -257,6 +377,22 @@ plcrash_error_t plcrash_async_dwarf_fde_info_init<uint64_t> (plcrash_async_dwarf
                                                              pl_vm_address_t fde_address,
                                                              bool debug_frame);
 
+template
+plcrash_error_t plcrash_async_dwarf_fde_range_init<uint32_t> (plcrash_async_dwarf_fde_range_t *range,
+                                                              plcrash_async_mobject_t *mobj,
+                                                              const plcrash_async_byteorder_t *byteorder,
+                                                              pl_vm_address_t fde_address,
+                                                              bool debug_frame,
+                                                              plcrash_async_dwarf_fde_range_cache_t *cache);
+
+template
+plcrash_error_t plcrash_async_dwarf_fde_range_init<uint64_t> (plcrash_async_dwarf_fde_range_t *range,
+                                                              plcrash_async_mobject_t *mobj,
+                                                              const plcrash_async_byteorder_t *byteorder,
+                                                              pl_vm_address_t fde_address,
+                                                              bool debug_frame,
+                                                              plcrash_async_dwarf_fde_range_cache_t *cache);
+
 /**
  * @}
  */
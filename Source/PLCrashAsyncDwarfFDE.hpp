@@ -71,6 +71,36 @@ typedef struct plcrash_async_dwarf_fde_info {
     pl_vm_size_t instructions_length;
 } plcrash_async_dwarf_fde_info_t;
 
+/**
+ * @internal
+ *
+ * The address range covered by a DWARF Frame Descriptor Entry; see plcrash_async_dwarf_fde_range_init().
+ */
+typedef struct plcrash_async_dwarf_fde_range {
+    /** The start of the IP range covered by the FDE. */
+    uint64_t pc_start;
+
+    /** The end of the IP range covered by the FDE (exclusive). */
+    uint64_t pc_end;
+} plcrash_async_dwarf_fde_range_t;
+
+/**
+ * @internal
+ *
+ * The FDE pointer encoding of the most recently decoded CIE, allowing consecutive FDEs that share a CIE to be
+ * range-decoded without re-parsing the CIE.
+ */
+typedef struct plcrash_async_dwarf_fde_range_cache {
+    /** True if the cache contains a valid entry. */
+    bool valid;
+
+    /** The target-relative address of the cached CIE. */
+    pl_vm_address_t cie_address;
+
+    /** The CIE's FDE pointer encoding. */
+    uint8_t pc_encoding;
+} plcrash_async_dwarf_fde_range_cache_t;
+
 template <typename machine_ptr>
 plcrash_error_t plcrash_async_dwarf_fde_info_init (plcrash_async_dwarf_fde_info_t *info,
                                                    plcrash_async_mobject_t *mobj,
@@ -78,6 +108,14 @@ plcrash_error_t plcrash_async_dwarf_fde_info_init (plcrash_async_dwarf_fde_info_
                                                    pl_vm_address_t fde_address,
                                                    bool debug_frame);
 
+template <typename machine_ptr>
+plcrash_error_t plcrash_async_dwarf_fde_range_init (plcrash_async_dwarf_fde_range_t *range,
+                                                    plcrash_async_mobject_t *mobj,
+                                                    const plcrash_async_byteorder_t *byteorder,
+                                                    pl_vm_address_t fde_address,
+                                                    bool debug_frame,
+                                                    plcrash_async_dwarf_fde_range_cache_t *cache);
+
 pl_vm_address_t plcrash_async_dwarf_fde_info_instructions_offset (plcrash_async_dwarf_fde_info_t *info);
 pl_vm_size_t plcrash_async_dwarf_fde_info_instructions_length (plcrash_async_dwarf_fde_info_t *info);
 
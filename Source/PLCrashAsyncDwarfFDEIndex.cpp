@@ -0,0 +1,286 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncDwarfFDEIndex.h"
+
+#include "PLCrashAsyncDwarfEncoding.hpp"
+
+#include "PLCrashFeatureConfig.h"
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <libkern/OSAtomic.h>
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+
+using namespace plcrash::async;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_dwarf
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Growable entry storage used while building an FDE index.
+ */
+struct plcrash_async_dwarf_fde_index_builder {
+    /** The index being built, or NULL if no entries have been appended. */
+    plcrash_async_dwarf_fde_index_t *index;
+
+    /** The allocated capacity of @a index, in entries. */
+    size_t capacity;
+};
+
+/**
+ * @internal
+ *
+ * Append a new entry to @a builder.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ */
+static plcrash_error_t plcrash_async_dwarf_fde_index_append (plcrash_async_dwarf_fde_index_builder *builder,
+                                                              uint64_t pc_start,
+                                                              uint64_t pc_end,
+                                                              pl_vm_off_t fde_offset)
+{
+    size_t count = builder->index != NULL ? builder->index->count : 0;
+
+    if (count == builder->capacity) {
+        size_t capacity = builder->capacity == 0 ? 256 : builder->capacity * 2;
+        plcrash_async_dwarf_fde_index_t *index = (plcrash_async_dwarf_fde_index_t *) realloc(builder->index, sizeof(*index) + (capacity * sizeof(index->entries[0])));
+        if (index == NULL)
+            return PLCRASH_ENOMEM;
+
+        index->count = count;
+        builder->index = index;
+        builder->capacity = capacity;
+    }
+
+    plcrash_async_dwarf_fde_index_entry_t *entry = &builder->index->entries[builder->index->count++];
+    entry->pc_start = pc_start;
+    entry->pc_end = pc_end;
+    entry->fde_offset = fde_offset;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Append an entry to @a builder for every FDE within @a dwarf_section. Only the address range of each FDE is decoded.
+ *
+ * @param image The image containing @a dwarf_section.
+ * @param dwarf_section The mapped eh_frame or debug_frame section.
+ * @param is_debug_frame True if @a dwarf_section is a debug_frame section.
+ * @param builder The index builder.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOMEM if allocation fails, or another plcrash_error_t code if
+ * the section could not be parsed in its entirety. A partial index must not be published, as a linear scan would
+ * return a parse error for PCs that would not be found in the index.
+ */
+template <typename machine_ptr>
+static plcrash_error_t plcrash_async_dwarf_fde_index_build_section (plcrash_async_macho_t *image,
+                                                                     plcrash_async_mobject_t *dwarf_section,
+                                                                     bool is_debug_frame,
+                                                                     plcrash_async_dwarf_fde_index_builder *builder)
+{
+    const pl_vm_address_t base_addr = plcrash_async_mobject_base_address(dwarf_section);
+    dwarf_frame_reader reader;
+    plcrash_error_t err;
+
+    if ((err = reader.init(dwarf_section, image->byteorder, image->m64, is_debug_frame, NULL)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not initialize a DWARF parser for %s: %d", image->name, err);
+        return err;
+    }
+
+    /* Consecutive FDEs generally share a CIE, the pointer encoding of which is cached across the scan. */
+    plcrash_async_dwarf_fde_range_cache_t range_cache;
+    range_cache.valid = false;
+
+    pl_vm_off_t offset = 0;
+    pl_vm_address_t fde_address;
+    while ((err = reader.next_fde_address(&offset, &fde_address)) == PLCRASH_ESUCCESS) {
+        plcrash_async_dwarf_fde_range_t range;
+        if ((err = plcrash_async_dwarf_fde_range_init<machine_ptr>(&range, dwarf_section, image->byteorder, fde_address, is_debug_frame, &range_cache)) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Failed to decode FDE at 0x%" PRIx64 " in %s: %d", (uint64_t) fde_address, image->name, err);
+            return err;
+        }
+
+        /* Empty FDEs can never match a PC */
+        if (range.pc_start >= range.pc_end)
+            continue;
+
+        if ((err = plcrash_async_dwarf_fde_index_append(builder, range.pc_start, range.pc_end, fde_address - base_addr)) != PLCRASH_ESUCCESS)
+            return err;
+    }
+
+    /* PLCRASH_ENOTFOUND signals the end of the section */
+    if (err != PLCRASH_ENOTFOUND)
+        return err;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/* qsort() comparison function for index entries. */
+static int plcrash_async_dwarf_fde_index_entry_compare (const void *lhs, const void *rhs) {
+    const plcrash_async_dwarf_fde_index_entry_t *l = (const plcrash_async_dwarf_fde_index_entry_t *) lhs;
+    const plcrash_async_dwarf_fde_index_entry_t *r = (const plcrash_async_dwarf_fde_index_entry_t *) rhs;
+
+    if (l->pc_start < r->pc_start)
+        return -1;
+    else if (l->pc_start > r->pc_start)
+        return 1;
+    return 0;
+}
+
+/**
+ * Build a sorted FDE index for the DWARF eh_frame (or debug_frame) data of @a image, and publish the index as
+ * @a image's dwarf_fde_index. Once published, the DWARF unwinder will locate the FDE for any PC within the image via
+ * binary search, rather than by scanning the image's DWARF data.
+ *
+ * Images that provide an eh_frame_hdr search table do not require an index; for these images, and for images that
+ * already have a published index, this method returns immediately.
+ *
+ * @param image The image to be indexed.
+ * @param outBytes If non-NULL, will be set to the number of bytes allocated for the published index, or 0 if no
+ * index was published by this call.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the image contains no DWARF frame data, or
+ * another plcrash_error_t code on failure.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_dwarf_fde_index_build (plcrash_async_macho_t *image, size_t *outBytes) {
+    plcrash_async_mobject_t dwarf_section;
+    bool is_debug_frame = false;
+    plcrash_error_t err;
+
+    if (outBytes != NULL)
+        *outBytes = 0;
+
+    if (image->dwarf_fde_index != NULL)
+        return PLCRASH_ESUCCESS;
+
+    /* Prefer eh_frame, falling back on debug_frame, as is done by the unwinder */
+    if ((err = plcrash_async_macho_map_section(image, "__TEXT", "__eh_frame", &dwarf_section)) == PLCRASH_ESUCCESS) {
+        plcrash_async_mobject_t eh_frame_hdr;
+        if (plcrash_async_macho_map_section(image, "__TEXT", "__eh_frame_hdr", &eh_frame_hdr) == PLCRASH_ESUCCESS) {
+            /* The image's own search table will be used by the unwinder */
+            plcrash_async_mobject_free(&eh_frame_hdr);
+            plcrash_async_mobject_free(&dwarf_section);
+            return PLCRASH_ESUCCESS;
+        }
+    } else {
+        if ((err = plcrash_async_macho_map_section(image, "__DWARF", "__debug_frame", &dwarf_section)) != PLCRASH_ESUCCESS)
+            return err;
+        is_debug_frame = true;
+    }
+
+    /* Decode the FDE address ranges */
+    plcrash_async_dwarf_fde_index_builder builder = {};
+    if (image->m64)
+        err = plcrash_async_dwarf_fde_index_build_section<uint64_t>(image, &dwarf_section, is_debug_frame, &builder);
+    else
+        err = plcrash_async_dwarf_fde_index_build_section<uint32_t>(image, &dwarf_section, is_debug_frame, &builder);
+
+    plcrash_async_mobject_free(&dwarf_section);
+
+    if (err != PLCRASH_ESUCCESS) {
+        free(builder.index);
+        return err;
+    }
+
+    /* An image without FDEs gains nothing from an index */
+    if (builder.index == NULL)
+        return PLCRASH_ESUCCESS;
+
+    /* Sort the entries; FDEs are not required to be emitted in address order */
+    plcrash_async_dwarf_fde_index_t *index = builder.index;
+    qsort(index->entries, index->count, sizeof(index->entries[0]), plcrash_async_dwarf_fde_index_entry_compare);
+
+    /* Publish the index; if another thread won the race, discard ours. */
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, index, (void * volatile *) &image->dwarf_fde_index)) {
+        plcrash_nasync_dwarf_fde_index_free(index);
+        return PLCRASH_ESUCCESS;
+    }
+
+    if (outBytes != NULL)
+        *outBytes = sizeof(*index) + (builder.capacity * sizeof(index->entries[0]));
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free an FDE index previously allocated by plcrash_nasync_dwarf_fde_index_build().
+ *
+ * @param index The index to be freed.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_dwarf_fde_index_free (plcrash_async_dwarf_fde_index_t *index) {
+    free(index);
+}
+
+/**
+ * Find the entry of @a index covering @a pc.
+ *
+ * @param index The index to search.
+ * @param pc The PC to search for.
+ *
+ * @return Returns the matching entry, or NULL if @a pc is not covered by any FDE within @a index.
+ */
+const plcrash_async_dwarf_fde_index_entry_t *plcrash_async_dwarf_fde_index_find (const plcrash_async_dwarf_fde_index_t *index, uint64_t pc) {
+    /* Find the last entry with a pc_start <= pc */
+    size_t low = 0;
+    size_t high = index->count;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (index->entries[mid].pc_start <= pc)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == 0)
+        return NULL;
+
+    const plcrash_async_dwarf_fde_index_entry_t *entry = &index->entries[low - 1];
+    if (pc >= entry->pc_end)
+        return NULL;
+
+    return entry;
+}
+
+/**
+ * @}
+ */
+
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
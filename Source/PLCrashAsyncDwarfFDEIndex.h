@@ -0,0 +1,92 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_DWARF_FDE_INDEX_H
+#define PLCRASH_ASYNC_DWARF_FDE_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_async_dwarf
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A single FDE index entry, mapping the address range [pc_start, pc_end) to the FDE that describes it.
+ */
+typedef struct plcrash_async_dwarf_fde_index_entry {
+    /** The first address covered by the FDE. */
+    uint64_t pc_start;
+
+    /** The end of the address range covered by the FDE (exclusive). */
+    uint64_t pc_end;
+
+    /** The offset of the FDE (including its length field) relative to the start of the indexed DWARF section. */
+    pl_vm_off_t fde_offset;
+} plcrash_async_dwarf_fde_index_entry_t;
+
+/**
+ * @internal
+ *
+ * A sorted FDE index. The index provides a binary search table for the eh_frame (or debug_frame) data of images that
+ * do not provide an eh_frame_hdr search table, allowing the FDE for a PC to be located without a linear scan of the
+ * image's DWARF data. Indices are created by plcrash_nasync_dwarf_fde_index_build() and are immutable once published.
+ */
+typedef struct plcrash_async_dwarf_fde_index {
+    /** The number of entries in @a entries. */
+    size_t count;
+
+    /** The entries, sorted by ascending pc_start. */
+    plcrash_async_dwarf_fde_index_entry_t entries[];
+} plcrash_async_dwarf_fde_index_t;
+
+plcrash_error_t plcrash_nasync_dwarf_fde_index_build (plcrash_async_macho_t *image, size_t *outBytes);
+void plcrash_nasync_dwarf_fde_index_free (plcrash_async_dwarf_fde_index_t *index);
+
+const plcrash_async_dwarf_fde_index_entry_t *plcrash_async_dwarf_fde_index_find (const plcrash_async_dwarf_fde_index_t *index, uint64_t pc);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_DWARF_FDE_INDEX_H */
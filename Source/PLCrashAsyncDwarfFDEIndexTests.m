@@ -0,0 +1,117 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncDwarfFDEIndex.h"
+#import "PLCrashFeatureConfig.h"
+
+#import <dlfcn.h>
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+
+@interface PLCrashAsyncDwarfFDEIndexTests : SenTestCase {
+    /** The image containing our class. */
+    plcrash_async_macho_t _image;
+}
+@end
+
+@implementation PLCrashAsyncDwarfFDEIndexTests
+
+- (void) setUp {
+    Dl_info info;
+    STAssertTrue(dladdr([self class], &info) > 0, @"Could not fetch dyld info for %p", [self class]);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&_image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), @"Failed to initialize image");
+}
+
+- (void) tearDown {
+    plcrash_nasync_macho_free(&_image);
+}
+
+/**
+ * Test entry lookup.
+ */
+- (void) testFind {
+    plcrash_async_dwarf_fde_index_t *index = malloc(sizeof(*index) + (3 * sizeof(index->entries[0])));
+    index->count = 3;
+    index->entries[0] = (plcrash_async_dwarf_fde_index_entry_t) { .pc_start = 0x10, .pc_end = 0x20, .fde_offset = 0x0 };
+    index->entries[1] = (plcrash_async_dwarf_fde_index_entry_t) { .pc_start = 0x20, .pc_end = 0x30, .fde_offset = 0x20 };
+    index->entries[2] = (plcrash_async_dwarf_fde_index_entry_t) { .pc_start = 0x40, .pc_end = 0x50, .fde_offset = 0x40 };
+
+    STAssertNULL(plcrash_async_dwarf_fde_index_find(index, 0x0F), @"Address prior to the first entry should not match");
+    STAssertEquals(plcrash_async_dwarf_fde_index_find(index, 0x10), (const plcrash_async_dwarf_fde_index_entry_t *) &index->entries[0], @"Incorrect entry");
+    STAssertEquals(plcrash_async_dwarf_fde_index_find(index, 0x2F), (const plcrash_async_dwarf_fde_index_entry_t *) &index->entries[1], @"Incorrect entry");
+    STAssertNULL(plcrash_async_dwarf_fde_index_find(index, 0x35), @"Address between entries should not match");
+    STAssertEquals(plcrash_async_dwarf_fde_index_find(index, 0x4F), (const plcrash_async_dwarf_fde_index_entry_t *) &index->entries[2], @"Incorrect entry");
+    STAssertNULL(plcrash_async_dwarf_fde_index_find(index, 0x50), @"Address following the last entry should not match");
+
+    plcrash_nasync_dwarf_fde_index_free(index);
+}
+
+/**
+ * Test building and publication of an image's FDE index.
+ */
+- (void) testBuild {
+    size_t bytes;
+    plcrash_error_t err = plcrash_nasync_dwarf_fde_index_build(&_image, &bytes);
+    if (err == PLCRASH_ENOTFOUND) {
+        /* Our image does not contain any DWARF frame data */
+        return;
+    }
+
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to build FDE index");
+
+    /* Images that provide an eh_frame_hdr are not indexed */
+    plcrash_async_dwarf_fde_index_t *index = _image.dwarf_fde_index;
+    if (index == NULL) {
+        STAssertEquals(bytes, (size_t) 0, @"No allocation should have been reported");
+        return;
+    }
+
+    STAssertTrue(bytes > 0, @"Allocation size was not reported");
+
+    /* Verify that the entries are sorted, non-empty, and can be found */
+    for (size_t i = 0; i < index->count; i++) {
+        plcrash_async_dwarf_fde_index_entry_t *entry = &index->entries[i];
+        STAssertTrue(entry->pc_start < entry->pc_end, @"Entry covers an empty range");
+        if (i > 0)
+            STAssertTrue(index->entries[i-1].pc_start <= entry->pc_start, @"Entries are not sorted");
+
+        STAssertNotNULL(plcrash_async_dwarf_fde_index_find(index, entry->pc_start), @"Entry lookup failed");
+    }
+
+    /* A second build should return the already-published index */
+    err = plcrash_nasync_dwarf_fde_index_build(&_image, &bytes);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to build FDE index");
+    STAssertEquals(_image.dwarf_fde_index, index, @"Index was replaced");
+    STAssertEquals(bytes, (size_t) 0, @"No allocation should have been reported");
+}
+
+@end
+
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
@@ -154,6 +154,38 @@ struct __attribute__((packed)) fde_data {
     plcrash_async_mobject_free(&mobj);
 }
 
+/**
+ * Test range-only FDE decoding, including reuse of the cached CIE pointer encoding.
+ */
+- (void) testParseFDERange {
+    plcrash_async_dwarf_fde_range_t range;
+    plcrash_async_dwarf_fde_range_cache_t cache = { .valid = false };
+    plcrash_async_mobject_t mobj;
+    plcrash_error_t err;
+
+    err = plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) &_data, sizeof(_data), true);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize memory mapping");
+
+    err = plcrash_async_dwarf_fde_range_init<uint64_t>(&range, &mobj, &plcrash_async_byteorder_direct, (pl_vm_address_t) &_data.fde, true, &cache);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to parse FDE range");
+    STAssertEquals(range.pc_start, _data.fde.pc_start, @"Incorrect PC start value");
+    STAssertEquals(range.pc_end, (uint64_t)_data.fde.pc_start + _data.fde.pc_length, @"Incorrect PC end value");
+
+    STAssertTrue(cache.valid, @"CIE encoding was not cached");
+    STAssertEquals(cache.cie_address, (pl_vm_address_t) &_data.cie, @"Incorrect cached CIE address");
+    STAssertEquals(cache.pc_encoding, (uint8_t) DW_EH_PE_udata8, @"Incorrect cached pointer encoding");
+
+    /* Substitute a 4-byte encoding; if the cached encoding is used in place of the CIE's, the upper (zero) half of
+     * the 8-byte initial_location will be decoded as the address_range. */
+    cache.pc_encoding = DW_EH_PE_udata4;
+    err = plcrash_async_dwarf_fde_range_init<uint64_t>(&range, &mobj, &plcrash_async_byteorder_direct, (pl_vm_address_t) &_data.fde, true, &cache);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to parse FDE range");
+    STAssertEquals(range.pc_start, _data.fde.pc_start, @"Incorrect PC start value");
+    STAssertEquals(range.pc_end, range.pc_start, @"Cached CIE encoding was not used");
+
+    plcrash_async_mobject_free(&mobj);
+}
+
 /**
  * Test FDE pointer encoding handling.
  */
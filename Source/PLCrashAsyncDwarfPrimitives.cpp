@@ -435,6 +435,37 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_read_task_uleb128 (task_t ta
     return err;
 }
 
+/**
+ * @internal
+ *
+ * Map the span of @a mobj that may contain a LEB128 value at @a location + @a offset, verifying the bounds once.
+ *
+ * @param mobj The memory object from which the LEB128 data will be read.
+ * @param location A task-relative location within @a mobj.
+ * @param offset Offset to be applied to @a location.
+ * @param available On success, the number of bytes readable at the returned pointer. This will not exceed
+ * PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE.
+ *
+ * @return Returns a locally mapped pointer to the LEB128 data, or NULL if @a location + @a offset falls outside
+ * the mapped range.
+ */
+static const uint8_t *plcrash_async_dwarf_map_leb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, pl_vm_size_t *available) {
+    pl_vm_address_t target;
+    if (!plcrash_async_address_apply_offset(location, offset, &target))
+        return NULL;
+
+    const pl_vm_address_t base = plcrash_async_mobject_base_address(mobj);
+    const pl_vm_address_t end = base + plcrash_async_mobject_length(mobj);
+    if (target < base || target >= end)
+        return NULL;
+
+    *available = end - target;
+    if (*available > PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE)
+        *available = PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE;
+
+    return (const uint8_t *) plcrash_async_mobject_remap_address(mobj, location, offset, *available);
+}
+
 /**
  * Read a ULEB128 value from @a location within @a mobj.
  *
@@ -445,39 +476,15 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_read_task_uleb128 (task_t ta
  * @param size On success, will be set to the total size of the decoded LEB128 value at @a location, in bytes.
  */
 plcrash_error_t plcrash::async::plcrash_async_dwarf_read_uleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, uint64_t *result, pl_vm_size_t *size) {
-    unsigned int shift = 0;
-    pl_vm_off_t position = 0;
-    *result = 0;
-    
-    uint8_t *p;
-    while ((p = (uint8_t *) plcrash_async_mobject_remap_address(mobj, location, position + offset, 1)) != NULL) {
-        /* LEB128 uses 7 bits for the number, the final bit to signal completion */
-        uint8_t byte = *p;
-        *result |= ((uint64_t) (byte & 0x7f)) << shift;
-        shift += 7;
-        
-        /* This is used to track length, so we must set it before
-         * potentially terminating the loop below */
-        position++;
-        
-        /* Check for terminating bit */
-        if ((byte & 0x80) == 0)
-            break;
-        
-        /* Check for a ULEB128 larger than 64-bits */
-        if (shift >= 64) {
-            PLCF_DEBUG("ULEB128 is larger than the maximum supported size of 64 bits");
-            return PLCRASH_ENOTSUP;
-        }
-    }
-    
-    if (p == NULL) {
+    const uint8_t *p;
+    pl_vm_size_t available;
+
+    if ((p = plcrash_async_dwarf_map_leb128(mobj, location, offset, &available)) == NULL) {
         PLCF_DEBUG("ULEB128 value did not terminate within mapped memory range");
         return PLCRASH_EINVAL;
     }
-    
-    *size = position;
-    return PLCRASH_ESUCCESS;
+
+    return plcrash_async_dwarf_decode_uleb128(p, available, result, size);
 }
 
 /**
@@ -490,43 +497,15 @@ plcrash_error_t plcrash::async::plcrash_async_dwarf_read_uleb128 (plcrash_async_
  * @param size On success, will be set to the total size of the decoded LEB128 value, in bytes.
  */
 plcrash_error_t plcrash::async::plcrash_async_dwarf_read_sleb128 (plcrash_async_mobject_t *mobj, pl_vm_address_t location, pl_vm_off_t offset, int64_t *result, pl_vm_size_t *size) {
-    unsigned int shift = 0;
-    pl_vm_off_t position = 0;
-    *result = 0;
-    
-    uint8_t *p;
-    while ((p = (uint8_t *) plcrash_async_mobject_remap_address(mobj, location, position + offset, 1)) != NULL) {
-        /* LEB128 uses 7 bits for the number, the final bit to signal completion */
-        uint8_t byte = *p;
-        *result |= ((uint64_t) (byte & 0x7f)) << shift;
-        shift += 7;
-        
-        /* This is used to track length, so we must set it before
-         * potentially terminating the loop below */
-        position++;
-        
-        /* Check for terminating bit */
-        if ((byte & 0x80) == 0)
-            break;
-        
-        /* Check for a ULEB128 larger than 64-bits */
-        if (shift >= 64) {
-            PLCF_DEBUG("ULEB128 is larger than the maximum supported size of 64 bits");
-            return PLCRASH_ENOTSUP;
-        }
-    }
-    
-    if (p == NULL) {
-        PLCF_DEBUG("ULEB128 value did not terminate within mapped memory range");
+    const uint8_t *p;
+    pl_vm_size_t available;
+
+    if ((p = plcrash_async_dwarf_map_leb128(mobj, location, offset, &available)) == NULL) {
+        PLCF_DEBUG("SLEB128 value did not terminate within mapped memory range");
         return PLCRASH_EINVAL;
     }
-    
-    /* Sign bit is 2nd high order bit */
-    if (shift < 64 && (*p & 0x40))
-        *result |= -(1ULL << shift);
-    
-    *size = position;
-    return PLCRASH_ESUCCESS;
+
+    return plcrash_async_dwarf_decode_sleb128(p, available, result, size);
 }
 
 /* Provide explicit 32/64-bit instantiations */
@@ -34,6 +34,7 @@
 #include "PLCrashFeatureConfig.h"
 
 #include <inttypes.h>
+#include <string.h>
 
 #if PLCRASH_FEATURE_UNWIND_DWARF
 
@@ -343,65 +344,226 @@ plcrash_error_t plcrash_async_dwarf_read_sleb128 (plcrash_async_mobject_t *mobj,
 plcrash_error_t plcrash_async_dwarf_read_task_sleb128 (task_t task, pl_vm_address_t location, pl_vm_off_t offset, int64_t *result, pl_vm_size_t *size);
 plcrash_error_t plcrash_async_dwarf_read_task_uleb128 (task_t task, pl_vm_address_t location, pl_vm_off_t offset, uint64_t *result, pl_vm_size_t *size);
 
+/**
+ * @internal
+ * The maximum encoded size of a LEB128 value that fits within 64 bits.
+ */
+#define PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE 10
+
 /**
  * @internal
  *
- * Read a value that is either 1, 2, 4, or 8 bytes in size, allowing natural unsigned integer overflow
- * to occur.
+ * Find the encoded length of the LEB128 value at @a p.
  *
- * Returns true on success, false on failure.
+ * The terminating byte is located a machine word at a time where possible; a LEB128 value terminates at the first
+ * byte with a clear high-order bit.
  *
- * @param mobj Memory object from which to read the value.
+ * @param p A locally mapped pointer to the LEB128 data.
+ * @param available The number of bytes readable at @a p.
+ * @param size On success, the encoded length, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the value exceeds 64 bits, or PLCRASH_EINVAL if
+ * the value does not terminate within @a available bytes.
+ */
+static inline plcrash_error_t plcrash_async_dwarf_leb128_size (const uint8_t *p, pl_vm_size_t available, pl_vm_size_t *size) {
+    pl_vm_size_t limit = available < PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE ? available : PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE;
+    pl_vm_size_t pos = 0;
+
+#if defined(__LITTLE_ENDIAN__)
+    if (limit >= sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+
+        /* Locate the first byte with a clear continuation bit */
+        uint64_t stop = ~word & 0x8080808080808080ULL;
+        if (stop != 0) {
+            *size = (__builtin_ctzll(stop) >> 3) + 1;
+            return PLCRASH_ESUCCESS;
+        }
+        pos = sizeof(uint64_t);
+    }
+#endif
+
+    for (; pos < limit; pos++) {
+        if ((p[pos] & 0x80) == 0) {
+            *size = pos + 1;
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
+    if (limit == PLCRASH_ASYNC_DWARF_LEB128_MAX_SIZE) {
+        PLCF_DEBUG("LEB128 is larger than the maximum supported size of 64 bits");
+        return PLCRASH_ENOTSUP;
+    }
+
+    PLCF_DEBUG("LEB128 value did not terminate within mapped memory range");
+    return PLCRASH_EINVAL;
+}
+
+/**
+ * @internal
+ *
+ * Decode a ULEB128 value from locally mapped memory. The bounds are verified once, after which the value is decoded
+ * without further checks.
+ *
+ * @param p A locally mapped pointer to the ULEB128 data.
+ * @param available The number of bytes readable at @a p.
+ * @param result On success, the ULEB128 value.
+ * @param size On success, will be set to the total size of the decoded LEB128 value at @a p, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the value exceeds 64 bits, or PLCRASH_EINVAL if
+ * the value does not terminate within @a available bytes.
+ */
+static inline plcrash_error_t plcrash_async_dwarf_decode_uleb128 (const uint8_t *p, pl_vm_size_t available, uint64_t *result, pl_vm_size_t *size) {
+    /* Single-byte values are by far the most common */
+    if (available > 0 && (p[0] & 0x80) == 0) {
+        *result = p[0];
+        *size = 1;
+        return PLCRASH_ESUCCESS;
+    }
+
+    pl_vm_size_t length;
+    plcrash_error_t err;
+    if ((err = plcrash_async_dwarf_leb128_size(p, available, &length)) != PLCRASH_ESUCCESS)
+        return err;
+
+    uint64_t value = 0;
+    for (pl_vm_size_t i = 0; i < length; i++)
+        value |= ((uint64_t) (p[i] & 0x7f)) << (7 * i);
+
+    *result = value;
+    *size = length;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Decode a SLEB128 value from locally mapped memory. The bounds are verified once, after which the value is decoded
+ * without further checks.
+ *
+ * @param p A locally mapped pointer to the SLEB128 data.
+ * @param available The number of bytes readable at @a p.
+ * @param result On success, the SLEB128 value.
+ * @param size On success, will be set to the total size of the decoded LEB128 value at @a p, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the value exceeds 64 bits, or PLCRASH_EINVAL if
+ * the value does not terminate within @a available bytes.
+ */
+static inline plcrash_error_t plcrash_async_dwarf_decode_sleb128 (const uint8_t *p, pl_vm_size_t available, int64_t *result, pl_vm_size_t *size) {
+    /* Single-byte values are by far the most common; the sign bit is the 2nd high order bit */
+    if (available > 0 && (p[0] & 0x80) == 0) {
+        *result = (int64_t) (p[0] & 0x3f) - (int64_t) (p[0] & 0x40);
+        *size = 1;
+        return PLCRASH_ESUCCESS;
+    }
+
+    pl_vm_size_t length;
+    plcrash_error_t err;
+    if ((err = plcrash_async_dwarf_leb128_size(p, available, &length)) != PLCRASH_ESUCCESS)
+        return err;
+
+    uint64_t value = 0;
+    for (pl_vm_size_t i = 0; i < length; i++)
+        value |= ((uint64_t) (p[i] & 0x7f)) << (7 * i);
+
+    /* Sign bit is 2nd high order bit */
+    unsigned int shift = 7 * length;
+    if (shift < 64 && (p[length - 1] & 0x40))
+        value |= -(1ULL << shift);
+
+    *result = (int64_t) value;
+    *size = length;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Decode a value that is either 1, 2, 4, or 8 bytes in size from locally mapped memory, allowing natural unsigned
+ * integer overflow to occur.
+ *
+ * @param p A locally mapped pointer to the value.
+ * @param available The number of bytes readable at @a p.
  * @param byteorder Byte order of the target value.
- * @param base_addr The base address (within @a mobj's address space) from which to perform the read.
- * @param offset An offset to be applied to base_addr.
- * @param data_size The size of the value to be read. If an unsupported size is supplied, false will be returned.
+ * @param data_size The size of the value to be read. If an unsupported size is supplied, PLCRASH_EINVAL will be returned.
  * @param dest The destination value.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if @a data_size is unsupported or exceeds
+ * @a available.
  */
 template <typename T>
-plcrash_error_t plcrash_async_dwarf_read_uintmax64 (plcrash_async_mobject_t *mobj,
-                                                    const plcrash_async_byteorder_t *byteorder,
-                                                    pl_vm_address_t base_addr,
-                                                    pl_vm_off_t offset,
-                                                    uint8_t data_size,
-                                                    T *dest)
+static inline plcrash_error_t plcrash_async_dwarf_decode_uintmax64 (const uint8_t *p,
+                                                                    pl_vm_size_t available,
+                                                                    const plcrash_async_byteorder_t *byteorder,
+                                                                    uint8_t data_size,
+                                                                    T *dest)
 {
-    union udata {
+    const union udata {
         uint8_t u8;
         uint16_t u16;
         uint32_t u32;
         uint64_t u64;
-    } *data;
-    
-    data = (union udata *) plcrash_async_mobject_remap_address(mobj, base_addr, offset, data_size);
-    if (data == NULL)
+    } *data = (const union udata *) p;
+
+    if (data_size > available)
         return PLCRASH_EINVAL;
-    
+
     switch (data_size) {
         case 1:
             *dest = data->u8;
             break;
-            
+
         case 2:
-            *dest = byteorder->swap16(data->u16);
+            *dest = plcrash_async_byteorder_swap16(byteorder, data->u16);
             break;
-            
+
         case 4:
-            *dest = byteorder->swap32(data->u32);
+            *dest = plcrash_async_byteorder_swap32(byteorder, data->u32);
             break;
-            
+
         case 8:
-            *dest = byteorder->swap64(data->u64);
+            *dest = plcrash_async_byteorder_swap64(byteorder, data->u64);
             break;
-            
+
         default:
             PLCF_DEBUG("Unhandled data width %" PRIu64, (uint64_t) data_size);
             return PLCRASH_EINVAL;
     }
-    
+
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * @internal
+ *
+ * Read a value that is either 1, 2, 4, or 8 bytes in size, allowing natural unsigned integer overflow
+ * to occur.
+ *
+ * Returns true on success, false on failure.
+ *
+ * @param mobj Memory object from which to read the value.
+ * @param byteorder Byte order of the target value.
+ * @param base_addr The base address (within @a mobj's address space) from which to perform the read.
+ * @param offset An offset to be applied to base_addr.
+ * @param data_size The size of the value to be read. If an unsupported size is supplied, false will be returned.
+ * @param dest The destination value.
+ */
+template <typename T>
+plcrash_error_t plcrash_async_dwarf_read_uintmax64 (plcrash_async_mobject_t *mobj,
+                                                    const plcrash_async_byteorder_t *byteorder,
+                                                    pl_vm_address_t base_addr,
+                                                    pl_vm_off_t offset,
+                                                    uint8_t data_size,
+                                                    T *dest)
+{
+    const uint8_t *data = (const uint8_t *) plcrash_async_mobject_remap_address(mobj, base_addr, offset, data_size);
+    if (data == NULL)
+        return PLCRASH_EINVAL;
+
+    return plcrash_async_dwarf_decode_uintmax64(data, data_size, byteorder, data_size, dest);
+}
+
 /**
  * @internal
  *
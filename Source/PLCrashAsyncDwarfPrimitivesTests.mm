@@ -362,6 +362,42 @@ using namespace plcrash::async;
     plcrash_async_mobject_free(&mobj);
 }
 
+/**
+ * Test decoding of LEB128 values from locally mapped memory, including values that terminate beyond the first
+ * machine word.
+ */
+- (void) testDecodeLEB128 {
+    uint8_t buffer[11];
+    plcrash_error_t err;
+    uint64_t uresult;
+    int64_t sresult;
+    pl_vm_size_t size;
+
+    /* Terminates within the first word */
+    uint8_t short_value[] = { 0x80, 0x80, 0x01, 0xFF };
+    err = plcrash_async_dwarf_decode_uleb128(short_value, sizeof(short_value), &uresult, &size);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode uleb128");
+    STAssertEquals(uresult, (uint64_t) (1 << 14), @"Incorrect value decoded");
+    STAssertEquals(size, (pl_vm_size_t)3, @"Incorrect byte length");
+
+    /* Terminates beyond the first word */
+    memset(buffer, 0xFF, sizeof(buffer));
+    buffer[8] = 0x7F;
+    err = plcrash_async_dwarf_decode_sleb128(buffer, sizeof(buffer), &sresult, &size);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to decode sleb128");
+    STAssertEquals(sresult, (int64_t)-1, @"Incorrect value decoded");
+    STAssertEquals(size, (pl_vm_size_t)9, @"Incorrect byte length");
+
+    /* Fails to terminate within the available bytes */
+    err = plcrash_async_dwarf_decode_uleb128(buffer, 8, &uresult, &size);
+    STAssertEquals(err, PLCRASH_EINVAL, @"Unterminated value should fail");
+
+    /* Exceeds 64 bits */
+    memset(buffer, 0xFF, sizeof(buffer));
+    err = plcrash_async_dwarf_decode_uleb128(buffer, sizeof(buffer), &uresult, &size);
+    STAssertEquals(err, PLCRASH_ENOTSUP, @"Oversized value should not be supported");
+}
+
 /**
  * Test direct task-based reading of a ULEB128 value. This uses the same ULEB128 parser as the plcrash_async_dwarf_read_uleb128() code,
  * so we only test that the out-of-process memory read works as expected.
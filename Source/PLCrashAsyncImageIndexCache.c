@@ -0,0 +1,222 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncImageIndexCache.h"
+#include "PLCrashAsyncDwarfFDEIndex.h"
+#include "PLCrashFeatureConfig.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_image_index_cache Shared Image Index Cache
+ *
+ * Implements a cache of symbol and unwind indices that may be shared by the image lists of multiple tasks.
+ *
+ * A process that writes reports for several tasks, such as an out-of-process capture service, will find most of
+ * each task's images, including the entire dyld shared cache, loaded by every other task. Rather than building the
+ * same symbol and DWARF FDE indices for each report, the first instance of each image, as identified by its LC_UUID
+ * and header address, is retained as a donor; its indices are built once, and borrowed by every later instance via
+ * plcrash_nasync_macho_share_indices().
+ *
+ * Donor images are retained until the cache is freed. A donor's indices remain valid once the task from which it
+ * was read has terminated; only the donor's load commands, which remain mapped, are read after it is indexed.
+ * @{
+ */
+
+/**
+ * Initialize @a cache.
+ *
+ * @param cache The cache to initialize.
+ * @param max_count The maximum number of images to be cached, or 0 to use PLCRASH_ASYNC_IMAGE_INDEX_CACHE_DEFAULT_COUNT.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache table could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_image_index_cache_init (plcrash_async_image_index_cache_t *cache, size_t max_count) {
+    if (max_count == 0)
+        max_count = PLCRASH_ASYNC_IMAGE_INDEX_CACHE_DEFAULT_COUNT;
+
+    /* Keep the table at most half full */
+    size_t capacity = 2;
+    while (capacity < max_count * 2)
+        capacity <<= 1;
+
+    cache->entries = calloc(capacity, sizeof(cache->entries[0]));
+    if (cache->entries == NULL) {
+        PLCF_DEBUG("Failed to allocate an image index cache of %zu entries", capacity);
+        return PLCRASH_ENOMEM;
+    }
+
+    cache->capacity = capacity;
+    cache->count = 0;
+    cache->max_count = max_count;
+    pthread_mutex_init(&cache->lock, NULL);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Return the entry for @a uuid and @a header_addr, or the empty entry at which it would be inserted. The
+ * cache lock must be held.
+ */
+static plcrash_async_image_index_cache_entry_t *image_index_cache_lookup (plcrash_async_image_index_cache_t *cache,
+                                                                          const uint8_t uuid[16],
+                                                                          pl_vm_address_t header_addr)
+{
+    uint64_t key;
+    memcpy(&key, uuid, sizeof(key));
+    key ^= header_addr;
+
+    size_t mask = cache->capacity - 1;
+    for (size_t slot = (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask; ; slot = (slot + 1) & mask) {
+        plcrash_async_image_index_cache_entry_t *entry = &cache->entries[slot];
+        if (!entry->valid)
+            return entry;
+
+        if (entry->header_addr == header_addr && memcmp(entry->uuid, uuid, sizeof(entry->uuid)) == 0)
+            return entry;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Initialize and index the donor of @a entry from @a image. Returns false if the donor could not be initialized.
+ */
+static bool image_index_cache_build_donor (plcrash_async_image_index_cache_entry_t *entry, plcrash_async_macho_t *image) {
+    plcrash_error_t err;
+
+    if ((err = plcrash_nasync_macho_init(&entry->donor, image->task, image->name, image->header_addr)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to initialize the shared image record for %s: %d", image->name, err);
+        return false;
+    }
+
+    if ((err = plcrash_nasync_macho_index_symbols(&entry->donor)) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Failed to build the shared symbol index for %s: %d", image->name, err);
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /* Images without DWARF unwind data have no index to build; any other failure will recur, and the image's
+     * instances will fall back to a linear FDE search. */
+    size_t bytes;
+    plcrash_nasync_dwarf_fde_index_build(&entry->donor, &bytes);
+#endif
+
+    return true;
+}
+
+/**
+ * Borrow the cached indices of @a image, building them on first use. The indices are shared by all instances of the
+ * image that share its LC_UUID; the DWARF indices are only shared by instances loaded at the same header address
+ * (see plcrash_nasync_macho_share_indices()).
+ *
+ * Images without an LC_UUID are not cached. If the cache is full, images that are not already cached will not be
+ * added.
+ *
+ * @param cache The index cache.
+ * @param image The image that will borrow the cached indices. The image must not be freed after @a cache.
+ *
+ * @return Returns true if @a image borrowed at least one index.
+ *
+ * @warning This function is not async-safe, and must not be called while other threads are reading @a image.
+ */
+bool plcrash_nasync_image_index_cache_share (plcrash_async_image_index_cache_t *cache, plcrash_async_macho_t *image) {
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid == NULL)
+        return false;
+
+    /* Donors are built with the lock held, ensuring that concurrent reports index each image only once */
+    uint32_t shared = 0;
+    pthread_mutex_lock(&cache->lock); {
+        plcrash_async_image_index_cache_entry_t *entry = image_index_cache_lookup(cache, uuid->uuid, image->header_addr);
+        if (!entry->valid && cache->count < cache->max_count) {
+            memcpy(entry->uuid, uuid->uuid, sizeof(entry->uuid));
+            entry->header_addr = image->header_addr;
+            entry->failed = !image_index_cache_build_donor(entry, image);
+            entry->valid = true;
+            cache->count++;
+        }
+
+        if (entry->valid && !entry->failed)
+            shared = plcrash_nasync_macho_share_indices(image, &entry->donor);
+    } pthread_mutex_unlock(&cache->lock);
+
+    return (shared != 0);
+}
+
+/**
+ * Borrow the cached indices of every image in @a list; see plcrash_nasync_image_index_cache_share().
+ *
+ * @param cache The index cache.
+ * @param list The list of images that will borrow the cached indices. The list must not be freed after @a cache.
+ *
+ * @return Returns the number of images that borrowed at least one index.
+ *
+ * @warning This function is not async-safe, and must not be called while other threads are reading @a list.
+ */
+size_t plcrash_nasync_image_index_cache_share_list (plcrash_async_image_index_cache_t *cache, plcrash_async_image_list_t *list) {
+    size_t count = 0;
+
+    plcrash_async_image_list_set_reading(list, true); {
+        plcrash_async_image_t *image = NULL;
+        while ((image = plcrash_async_image_list_next(list, image)) != NULL) {
+            if (plcrash_nasync_image_index_cache_share(cache, &image->macho_image))
+                count++;
+        }
+    } plcrash_async_image_list_set_reading(list, false);
+
+    return count;
+}
+
+/**
+ * Free all resources associated with @a cache, including all cached indices. Any image that borrowed an index from
+ * @a cache must be freed first.
+ *
+ * @param cache The cache to free.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_image_index_cache_free (plcrash_async_image_index_cache_t *cache) {
+    for (size_t i = 0; i < cache->capacity; i++) {
+        plcrash_async_image_index_cache_entry_t *entry = &cache->entries[i];
+        if (entry->valid && !entry->failed)
+            plcrash_nasync_macho_free(&entry->donor);
+    }
+
+    free(cache->entries);
+    pthread_mutex_destroy(&cache->lock);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,109 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_IMAGE_INDEX_CACHE_H
+#define PLCRASH_ASYNC_IMAGE_INDEX_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+#include "PLCrashAsyncImageList.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_cache
+ *
+ * The default maximum number of images retained by an index cache.
+ */
+#define PLCRASH_ASYNC_IMAGE_INDEX_CACHE_DEFAULT_COUNT 4096
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_cache
+ *
+ * An index cache entry.
+ */
+typedef struct plcrash_async_image_index_cache_entry {
+    /** If true, this entry is in use. */
+    bool valid;
+
+    /** If true, @a donor could not be initialized, and no indices will be shared for this image. */
+    bool failed;
+
+    /** The image's LC_UUID. */
+    uint8_t uuid[16];
+
+    /** The image's header address. */
+    pl_vm_address_t header_addr;
+
+    /** The indexed image instance from which other instances borrow their indices. Only initialized if @a failed
+     * is false. */
+    plcrash_async_macho_t donor;
+} plcrash_async_image_index_cache_entry_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_cache
+ *
+ * A cache of image indices, keyed by image UUID and load address, that may be shared by the image lists of
+ * multiple tasks.
+ */
+typedef struct plcrash_async_image_index_cache {
+    /** An open-addressed, linearly probed table of @a capacity entries. */
+    plcrash_async_image_index_cache_entry_t *entries;
+
+    /** The number of entries in @a entries. Always a power of two. */
+    size_t capacity;
+
+    /** The number of valid entries. */
+    size_t count;
+
+    /** The maximum number of valid entries; once reached, no further images are cached. */
+    size_t max_count;
+
+    /** Serializes all cache access. */
+    pthread_mutex_t lock;
+} plcrash_async_image_index_cache_t;
+
+plcrash_error_t plcrash_nasync_image_index_cache_init (plcrash_async_image_index_cache_t *cache, size_t max_count);
+bool plcrash_nasync_image_index_cache_share (plcrash_async_image_index_cache_t *cache, plcrash_async_macho_t *image);
+size_t plcrash_nasync_image_index_cache_share_list (plcrash_async_image_index_cache_t *cache, plcrash_async_image_list_t *list);
+void plcrash_nasync_image_index_cache_free (plcrash_async_image_index_cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_IMAGE_INDEX_CACHE_H */
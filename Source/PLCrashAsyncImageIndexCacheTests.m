@@ -0,0 +1,142 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncImageIndexCache.h"
+
+#import <dlfcn.h>
+#import <mach-o/dyld.h>
+
+@interface PLCrashAsyncImageIndexCacheTests : SenTestCase {
+@private
+    plcrash_async_image_index_cache_t _cache;
+}
+@end
+
+/* Record the address of a found symbol */
+static void found_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    *((pl_vm_address_t *) ctx) = address;
+}
+
+@implementation PLCrashAsyncImageIndexCacheTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_nasync_image_index_cache_init(&_cache, 0), PLCRASH_ESUCCESS, @"Failed to initialize the cache");
+}
+
+- (void) tearDown {
+    plcrash_nasync_image_index_cache_free(&_cache);
+}
+
+/* Initialize @a image from the image containing @a address */
+- (void) loadImage: (plcrash_async_macho_t *) image containingAddress: (const void *) address {
+    Dl_info info;
+    STAssertTrue(dladdr(address, &info) > 0, @"Could not fetch dyld info for %p", address);
+    STAssertEquals(plcrash_nasync_macho_init(image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), PLCRASH_ESUCCESS,
+                   @"Failed to initialize image");
+}
+
+/**
+ * Verify that every instance of an image borrows the same indices, and that borrowed indices are not freed with
+ * the borrowing image.
+ */
+- (void) testShareIndices {
+    plcrash_async_macho_t first;
+    plcrash_async_macho_t second;
+
+    [self loadImage: &first containingAddress: [self class]];
+    [self loadImage: &second containingAddress: [self class]];
+
+    STAssertTrue(plcrash_nasync_image_index_cache_share(&_cache, &first), @"No indices were shared");
+    STAssertTrue(plcrash_nasync_image_index_cache_share(&_cache, &second), @"No indices were shared");
+    STAssertEquals(_cache.count, (size_t) 1, @"Both instances should share a single cache entry");
+
+    STAssertNotNULL(first.symbol_index, @"Symbol index was not shared");
+    STAssertEquals(first.symbol_index, second.symbol_index, @"Instances should share the same symbol index");
+    STAssertTrue(first.shared_indices & PLCRASH_ASYNC_MACHO_SHARED_SYMBOL_INDEX, @"Symbol index was not marked as shared");
+
+    /* Freeing the borrowing image must not release the shared index */
+    plcrash_async_macho_symbol_index_t *index = second.symbol_index;
+    uint32_t count = index->count;
+    plcrash_nasync_macho_free(&first);
+    STAssertEquals(second.symbol_index->count, count, @"Shared index was modified");
+
+    /* Instances that already have an index keep their own */
+    STAssertFalse(plcrash_nasync_image_index_cache_share(&_cache, &second), @"Indices were shared twice");
+
+    plcrash_nasync_macho_free(&second);
+}
+
+/**
+ * Verify that lookups via a borrowed symbol index match those of an unindexed image.
+ */
+- (void) testSharedSymbolLookup {
+    plcrash_async_macho_t shared;
+    plcrash_async_macho_t unindexed;
+
+    [self loadImage: &shared containingAddress: [self class]];
+    [self loadImage: &unindexed containingAddress: [self class]];
+    STAssertTrue(plcrash_nasync_image_index_cache_share(&_cache, &shared), @"No indices were shared");
+    STAssertNULL(unindexed.symbol_index, @"Image should not be indexed");
+
+    pl_vm_address_t pc = (pl_vm_address_t) [self methodForSelector: _cmd];
+    pl_vm_address_t expected = 0;
+    pl_vm_address_t found = 0;
+
+    STAssertEquals(plcrash_async_macho_find_symbol_by_pc(&unindexed, pc, found_symbol_cb, &expected), PLCRASH_ESUCCESS, @"Symbol lookup failed");
+    STAssertEquals(plcrash_async_macho_find_symbol_by_pc(&shared, pc, found_symbol_cb, &found), PLCRASH_ESUCCESS, @"Symbol lookup failed");
+    STAssertEquals(found, expected, @"Borrowed index returned a different symbol");
+
+    plcrash_nasync_macho_free(&shared);
+    plcrash_nasync_macho_free(&unindexed);
+}
+
+/**
+ * Verify that no further images are cached once the cache is full.
+ */
+- (void) testMaximumCount {
+    plcrash_async_image_index_cache_t cache;
+    plcrash_async_macho_t own;
+    plcrash_async_macho_t libc;
+
+    STAssertEquals(plcrash_nasync_image_index_cache_init(&cache, 1), PLCRASH_ESUCCESS, @"Failed to initialize the cache");
+    [self loadImage: &own containingAddress: [self class]];
+    [self loadImage: &libc containingAddress: (void *) &strlen];
+
+    STAssertTrue(plcrash_nasync_image_index_cache_share(&cache, &own), @"No indices were shared");
+    if (own.header_addr != libc.header_addr)
+        STAssertFalse(plcrash_nasync_image_index_cache_share(&cache, &libc), @"An image was cached beyond the maximum count");
+    STAssertEquals(cache.count, (size_t) 1, @"Incorrect cache count");
+
+    plcrash_nasync_macho_free(&own);
+    plcrash_nasync_macho_free(&libc);
+    plcrash_nasync_image_index_cache_free(&cache);
+}
+
+@end
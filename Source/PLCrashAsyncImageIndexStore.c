@@ -0,0 +1,782 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncImageIndexStore.h"
+#include "PLCrashAsyncDwarfFDEIndex.h"
+#include "PLCrashAsyncObjCSection.h"
+#include "PLCrashFeatureConfig.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <mach-o/loader.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_image_index_store Persistent Image Index Store
+ *
+ * Persists the symbol, Objective-C and DWARF FDE indices built for an image across launches.
+ *
+ * An image's indices do not change until the image itself is updated, but would otherwise be rebuilt by the
+ * background warmup of every launch. Once built, the indices of each image are written to a single file within the
+ * store directory, named by the image's LC_UUID. On the next launch, the file is validated against the image, and
+ * its indices are mapped rather than rebuilt.
+ *
+ * Indices are stored with unslid addresses. The symbol index already records unslid addresses; it is mapped
+ * read-only, and borrowed by the image (see plcrash_async_macho_shared_index_t). The Objective-C and DWARF FDE
+ * indices record runtime addresses, and are mapped privately and rebased to the image's current slide. Objective-C
+ * indices that reference strings outside of the image's own __TEXT segment, such as selectors uniqued into the dyld
+ * shared cache, can not be rebased, and are not stored.
+ *
+ * Files are written in host byte order and layout, and are only loaded by an image of the same LC_UUID and CPU type.
+ * @{
+ */
+
+/** @internal The magic value of a stored index file ('plix'). */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAGIC 0x78696c70
+
+/** @internal The version of the stored index file format. */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_VERSION 1
+
+/** @internal The alignment of each stored index within its file; a multiple of every supported page size. */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT 16384
+
+/** @internal The maximum number of indices within a stored index file. */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_SECTION_COUNT 3
+
+/** @internal The file name extension of stored index files. */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_EXTENSION "plindex"
+
+/** @internal The number of entries rebased per write when storing a runtime address index. */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK 64
+
+/**
+ * @internal
+ *
+ * A single stored index.
+ */
+typedef struct image_index_store_section {
+    /** The stored index; one of plcrash_async_image_index_store_index_t. */
+    uint32_t index;
+
+    /** The size of each index entry, in bytes. */
+    uint32_t entry_size;
+
+    /** The number of index entries. */
+    uint64_t count;
+
+    /** The file offset of the index. Always a multiple of PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT. */
+    uint64_t offset;
+
+    /** The length of the index, in bytes. */
+    uint64_t length;
+} image_index_store_section_t;
+
+/**
+ * @internal
+ *
+ * The header of a stored index file, written at the start of the file.
+ */
+typedef struct image_index_store_header {
+    /** PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_ASYNC_IMAGE_INDEX_STORE_VERSION. */
+    uint32_t version;
+
+    /** The image's LC_UUID. */
+    uint8_t uuid[16];
+
+    /** The image's CPU type. */
+    uint32_t cputype;
+
+    /** The image's CPU subtype. */
+    uint32_t cpusubtype;
+
+    /** The image's unslid __TEXT address. */
+    uint64_t text_vmaddr;
+
+    /** The image's __TEXT size. */
+    uint64_t text_size;
+
+    /** The indices that had been built for the image, but could not be stored; a bitwise OR of
+     * plcrash_async_image_index_store_index_t values. */
+    uint32_t omitted;
+
+    /** The number of valid entries in @a sections. */
+    uint32_t section_count;
+
+    /** The stored indices. */
+    image_index_store_section_t sections[PLCRASH_ASYNC_IMAGE_INDEX_STORE_SECTION_COUNT];
+} image_index_store_header_t;
+
+/**
+ * @internal
+ *
+ * Remove all files within @a store that have been neither read nor written within
+ * PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAX_AGE, including the indices of images that are no longer loaded, and any
+ * temporary files abandoned by an interrupted write.
+ */
+static void image_index_store_prune (plcrash_async_image_index_store_t *store) {
+    DIR *dir = opendir(store->path);
+    if (dir == NULL)
+        return;
+
+    time_t now = time(NULL);
+    struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL) {
+        char path[PATH_MAX];
+        struct stat sb;
+
+        if (ent->d_name[0] == '.')
+            continue;
+
+        if (snprintf(path, sizeof(path), "%s/%s", store->path, ent->d_name) >= (int) sizeof(path))
+            continue;
+
+        if (lstat(path, &sb) != 0 || !S_ISREG(sb.st_mode) || now - sb.st_mtime < PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAX_AGE)
+            continue;
+
+        if (unlink(path) != 0)
+            PLCF_DEBUG("Failed to remove expired index file %s: %s", path, strerror(errno));
+    }
+
+    closedir(dir);
+}
+
+/**
+ * Initialize @a store, removing any expired index files.
+ *
+ * @param store The store to initialize.
+ * @param path The store directory. The directory must already exist, and should not be used for other files.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if allocation fails.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_image_index_store_init (plcrash_async_image_index_store_t *store, const char *path) {
+    store->mappings = NULL;
+    if ((store->path = strdup(path)) == NULL)
+        return PLCRASH_ENOMEM;
+
+    image_index_store_prune(store);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Format the path of the index file for @a uuid within @a store to @a buffer. Returns false if the path does not fit.
+ */
+static bool image_index_store_path (plcrash_async_image_index_store_t *store, const uint8_t uuid[16], char *buffer, size_t length) {
+    char hex[33];
+    for (size_t i = 0; i < 16; i++)
+        snprintf(hex + (i * 2), 3, "%02X", uuid[i]);
+
+    return snprintf(buffer, length, "%s/%s." PLCRASH_ASYNC_IMAGE_INDEX_STORE_EXTENSION, store->path, hex) < (int) length;
+}
+
+/**
+ * Return the indices that have been built for @a image and may be stored, as a bitwise OR of
+ * plcrash_async_image_index_store_index_t values.
+ *
+ * @param image The image to query.
+ */
+uint32_t plcrash_nasync_image_index_store_available (plcrash_async_macho_t *image) {
+    uint32_t indices = 0;
+
+    if (image->symbol_index != NULL)
+        indices |= PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS;
+
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+    if (image->objc_index != NULL)
+        indices |= PLCRASH_ASYNC_IMAGE_INDEX_STORE_OBJC;
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (image->dwarf_fde_index != NULL)
+        indices |= PLCRASH_ASYNC_IMAGE_INDEX_STORE_DWARF_FDE;
+#endif
+
+    return indices;
+}
+
+/**
+ * @internal
+ *
+ * Write all @a length bytes of @a data to @a fd at @a offset.
+ */
+static bool image_index_store_pwrite (int fd, const void *data, size_t length, off_t offset) {
+    const uint8_t *p = (const uint8_t *) data;
+    while (length > 0) {
+        ssize_t written = pwrite(fd, p, length, offset);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        p += written;
+        length -= (size_t) written;
+        offset += written;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Append an index section to @a header, returning the file offset at which its @a length bytes are to be written.
+ * @a next_offset is advanced to the offset of the following section.
+ */
+static off_t image_index_store_add_section (image_index_store_header_t *header, uint64_t *next_offset, uint32_t index,
+                                            uint32_t entry_size, uint64_t count, uint64_t length)
+{
+    image_index_store_section_t *section = &header->sections[header->section_count++];
+    section->index = index;
+    section->entry_size = entry_size;
+    section->count = count;
+    section->offset = *next_offset;
+    section->length = length;
+
+    *next_offset += (length + PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT - 1) & ~((uint64_t) PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT - 1);
+    return (off_t) section->offset;
+}
+
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+/**
+ * @internal
+ *
+ * Return true if every address recorded by @a index lies within the __TEXT segment of @a image, and may be rebased
+ * by the image's slide alone.
+ */
+static bool image_index_store_objc_rebasable (plcrash_async_macho_t *image, const plcrash_async_objc_imp_index_t *index) {
+    pl_vm_address_t start = (pl_vm_address_t) (image->text_vmaddr + image->vmaddr_slide);
+    pl_vm_size_t size = image->text_size;
+
+    for (size_t i = 0; i < index->count; i++) {
+        const plcrash_async_objc_imp_entry_t *entry = &index->entries[i];
+        if (entry->imp - start >= size || entry->className - start >= size || entry->methodName - start >= size)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Write the entries of @a index to @a fd at @a offset with their slide subtracted.
+ */
+static bool image_index_store_write_objc (int fd, off_t offset, const plcrash_async_objc_imp_index_t *index, pl_vm_off_t slide) {
+    plcrash_async_objc_imp_entry_t chunk[PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK];
+
+    for (size_t i = 0; i < index->count; i += PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK) {
+        size_t n = index->count - i;
+        if (n > PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK)
+            n = PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK;
+
+        /* Zero-fill, such that no uninitialized padding is written */
+        memset(chunk, 0, sizeof(chunk));
+        for (size_t j = 0; j < n; j++) {
+            const plcrash_async_objc_imp_entry_t *entry = &index->entries[i + j];
+            chunk[j].imp = entry->imp - slide;
+            chunk[j].className = entry->className - slide;
+            chunk[j].methodName = entry->methodName - slide;
+            chunk[j].order = entry->order;
+            chunk[j].isClassMethod = entry->isClassMethod;
+        }
+
+        if (!image_index_store_pwrite(fd, chunk, n * sizeof(chunk[0]), offset + (off_t) (i * sizeof(chunk[0]))))
+            return false;
+    }
+
+    return true;
+}
+#endif /* PLCRASH_FEATURE_SYMBOLICATE_OBJC */
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+/**
+ * @internal
+ *
+ * Write @a index to @a fd at @a offset with the slide subtracted from its entries' addresses.
+ */
+static bool image_index_store_write_fde (int fd, off_t offset, const plcrash_async_dwarf_fde_index_t *index, pl_vm_off_t slide) {
+    plcrash_async_dwarf_fde_index_entry_t chunk[PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK];
+    plcrash_async_dwarf_fde_index_t header;
+
+    memset(&header, 0, sizeof(header));
+    header.count = index->count;
+    if (!image_index_store_pwrite(fd, &header, sizeof(header), offset))
+        return false;
+    offset += sizeof(header);
+
+    for (size_t i = 0; i < index->count; i += PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK) {
+        size_t n = index->count - i;
+        if (n > PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK)
+            n = PLCRASH_ASYNC_IMAGE_INDEX_STORE_CHUNK;
+
+        for (size_t j = 0; j < n; j++) {
+            chunk[j] = index->entries[i + j];
+            chunk[j].pc_start -= slide;
+            chunk[j].pc_end -= slide;
+        }
+
+        if (!image_index_store_pwrite(fd, chunk, n * sizeof(chunk[0]), offset + (off_t) (i * sizeof(chunk[0]))))
+            return false;
+    }
+
+    return true;
+}
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
+
+/**
+ * Write all indices that have been built for @a image to @a store, replacing any indices previously stored for the
+ * image. The file is written in full before it replaces its predecessor, such that an interrupted write leaves the
+ * previous file intact.
+ *
+ * @param store The index store.
+ * @param image The image whose indices are to be stored.
+ * @param outStored On success, will be set to the indices that are stored for @a image, including those that
+ * were built but could not be stored, as a bitwise OR of plcrash_async_image_index_store_index_t values.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the image has no LC_UUID, or PLCRASH_EINTERNAL if
+ * the file could not be written.
+ *
+ * @warning This function is not async-safe, and must not be called concurrently with other users of @a store.
+ */
+plcrash_error_t plcrash_nasync_image_index_store_save (plcrash_async_image_index_store_t *store, plcrash_async_macho_t *image, uint32_t *outStored) {
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX];
+
+    *outStored = 0;
+
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid == NULL)
+        return PLCRASH_ENOTSUP;
+
+    if (!image_index_store_path(store, uuid->uuid, path, sizeof(path)) ||
+        snprintf(tmp_path, sizeof(tmp_path), "%s.%d.tmp", path, (int) getpid()) >= (int) sizeof(tmp_path))
+    {
+        PLCF_DEBUG("Index store path exceeds PATH_MAX for %s", image->name);
+        return PLCRASH_EINTERNAL;
+    }
+
+    image_index_store_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAGIC;
+    header.version = PLCRASH_ASYNC_IMAGE_INDEX_STORE_VERSION;
+    memcpy(header.uuid, uuid->uuid, sizeof(header.uuid));
+    header.cputype = image->byteorder->swap32(image->header.cputype);
+    header.cpusubtype = image->byteorder->swap32(image->header.cpusubtype);
+    header.text_vmaddr = image->text_vmaddr;
+    header.text_size = image->text_size;
+
+    int fd = open(tmp_path, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0) {
+        PLCF_DEBUG("Failed to create index file %s: %s", tmp_path, strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* The header occupies the first aligned block */
+    uint64_t next_offset = PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT;
+    bool written = true;
+
+    plcrash_async_macho_symbol_index_t *symbols = image->symbol_index;
+    if (written && symbols != NULL) {
+        uint64_t length = sizeof(*symbols) + (sizeof(symbols->entries[0]) * symbols->count);
+        off_t offset = image_index_store_add_section(&header, &next_offset, PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS,
+                                                     sizeof(symbols->entries[0]), symbols->count, length);
+        written = image_index_store_pwrite(fd, symbols, (size_t) length, offset);
+    }
+
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+    plcrash_async_objc_imp_index_t *objc = image->objc_index;
+    if (written && objc != NULL) {
+        if (objc->count > 0 && image_index_store_objc_rebasable(image, objc)) {
+            off_t offset = image_index_store_add_section(&header, &next_offset, PLCRASH_ASYNC_IMAGE_INDEX_STORE_OBJC,
+                                                         sizeof(objc->entries[0]), objc->count, sizeof(objc->entries[0]) * objc->count);
+            written = image_index_store_write_objc(fd, offset, objc, image->vmaddr_slide);
+        } else {
+            header.omitted |= PLCRASH_ASYNC_IMAGE_INDEX_STORE_OBJC;
+        }
+    }
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    plcrash_async_dwarf_fde_index_t *fde = image->dwarf_fde_index;
+    if (written && fde != NULL) {
+        uint64_t length = sizeof(*fde) + (sizeof(fde->entries[0]) * fde->count);
+        off_t offset = image_index_store_add_section(&header, &next_offset, PLCRASH_ASYNC_IMAGE_INDEX_STORE_DWARF_FDE,
+                                                     sizeof(fde->entries[0]), fde->count, length);
+        written = image_index_store_write_fde(fd, offset, fde, image->vmaddr_slide);
+    }
+#endif
+
+    /* The header is written last; a file without a valid header is never loaded */
+    if (written)
+        written = image_index_store_pwrite(fd, &header, sizeof(header), 0);
+
+    if (close(fd) != 0)
+        written = false;
+
+    if (!written || rename(tmp_path, path) != 0) {
+        PLCF_DEBUG("Failed to write index file %s: %s", path, strerror(errno));
+        unlink(tmp_path);
+        return PLCRASH_EINTERNAL;
+    }
+
+    for (uint32_t i = 0; i < header.section_count; i++)
+        *outStored |= header.sections[i].index;
+    *outStored |= header.omitted;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a header describes a valid index file of @a file_size bytes for @a image.
+ */
+static bool image_index_store_validate (const image_index_store_header_t *header, plcrash_async_macho_t *image,
+                                        const uint8_t uuid[16], uint64_t file_size)
+{
+    if (header->magic != PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAGIC || header->version != PLCRASH_ASYNC_IMAGE_INDEX_STORE_VERSION)
+        return false;
+
+    if (memcmp(header->uuid, uuid, sizeof(header->uuid)) != 0 ||
+        header->cputype != image->byteorder->swap32(image->header.cputype) ||
+        header->cpusubtype != image->byteorder->swap32(image->header.cpusubtype) ||
+        header->text_vmaddr != image->text_vmaddr ||
+        header->text_size != image->text_size)
+    {
+        return false;
+    }
+
+    if (header->section_count > PLCRASH_ASYNC_IMAGE_INDEX_STORE_SECTION_COUNT)
+        return false;
+
+    uint32_t seen = 0;
+    for (uint32_t i = 0; i < header->section_count; i++) {
+        const image_index_store_section_t *section = &header->sections[i];
+        uint64_t header_size;
+        uint32_t entry_size;
+
+        switch (section->index) {
+            case PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS:
+                header_size = sizeof(plcrash_async_macho_symbol_index_t);
+                entry_size = sizeof(plcrash_async_macho_symbol_index_entry_t);
+                break;
+
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+            case PLCRASH_ASYNC_IMAGE_INDEX_STORE_OBJC:
+                header_size = 0;
+                entry_size = sizeof(plcrash_async_objc_imp_entry_t);
+                break;
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+            case PLCRASH_ASYNC_IMAGE_INDEX_STORE_DWARF_FDE:
+                header_size = sizeof(plcrash_async_dwarf_fde_index_t);
+                entry_size = sizeof(plcrash_async_dwarf_fde_index_entry_t);
+                break;
+#endif
+
+            default:
+                return false;
+        }
+
+        /* Each index may only be stored once */
+        if (seen & section->index)
+            return false;
+        seen |= section->index;
+
+        if (section->entry_size != entry_size || section->length == 0 || section->length < header_size)
+            return false;
+
+        if (section->count != (section->length - header_size) / entry_size || (section->length - header_size) % entry_size != 0)
+            return false;
+
+        if (section->offset < PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT || section->offset % PLCRASH_ASYNC_IMAGE_INDEX_STORE_ALIGNMENT != 0)
+            return false;
+
+        if (section->length > file_size || section->offset > file_size - section->length)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Map @a section of @a fd privately, returning NULL on failure.
+ */
+static void *image_index_store_map (int fd, const image_index_store_section_t *section, bool writable) {
+    int prot = writable ? (PROT_READ|PROT_WRITE) : PROT_READ;
+    void *address = mmap(NULL, (size_t) section->length, prot, MAP_FILE|MAP_PRIVATE, fd, (off_t) section->offset);
+    if (address == MAP_FAILED) {
+        PLCF_DEBUG("Failed to map stored index: %s", strerror(errno));
+        return NULL;
+    }
+
+    return address;
+}
+
+/**
+ * @internal
+ *
+ * Publish the mapped index at @a address to @a target, recording the mapping in @a store. If an index has already
+ * been published to @a target, or the mapping can not be recorded, the mapping is released and false is returned.
+ */
+static bool image_index_store_publish_mapping (plcrash_async_image_index_store_t *store, void *address, size_t length, void * volatile *target) {
+    plcrash_async_image_index_store_mapping_t *mapping = malloc(sizeof(*mapping));
+    if (mapping == NULL || !OSAtomicCompareAndSwapPtrBarrier(NULL, address, target)) {
+        free(mapping);
+        munmap(address, length);
+        return false;
+    }
+
+    mapping->address = address;
+    mapping->length = length;
+    mapping->next = store->mappings;
+    store->mappings = mapping;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Map and publish the stored index described by @a section to @a image. Returns true if the index was published.
+ */
+static bool image_index_store_load_section (plcrash_async_image_index_store_t *store, plcrash_async_macho_t *image, int fd,
+                                            const image_index_store_section_t *section)
+{
+    pl_vm_off_t slide = image->vmaddr_slide;
+
+    switch (section->index) {
+        case PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS: {
+            /* Symbol indices record unslid addresses, and are mapped read-only */
+            plcrash_async_macho_symbol_index_t *index = image_index_store_map(fd, section, false);
+            if (index == NULL)
+                return false;
+
+            if (index->count != section->count) {
+                munmap(index, (size_t) section->length);
+                return false;
+            }
+
+            if (!image_index_store_publish_mapping(store, index, (size_t) section->length, (void * volatile *) &image->symbol_index))
+                return false;
+
+            image->shared_indices |= PLCRASH_ASYNC_MACHO_SHARED_SYMBOL_INDEX;
+            return true;
+        }
+
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+        case PLCRASH_ASYNC_IMAGE_INDEX_STORE_OBJC: {
+            plcrash_async_objc_imp_entry_t *entries = image_index_store_map(fd, section, true);
+            if (entries == NULL)
+                return false;
+
+            for (uint64_t i = 0; i < section->count; i++) {
+                entries[i].imp += slide;
+                entries[i].className += slide;
+                entries[i].methodName += slide;
+            }
+            mprotect(entries, (size_t) section->length, PROT_READ);
+
+            /* The index is owned by the image; the page-aligned mapping is released by plcrash_nasync_objc_free_index()
+             * as if it had been allocated with vm_allocate(). */
+            plcrash_async_objc_imp_index_t *index = malloc(sizeof(*index));
+            if (index == NULL) {
+                munmap(entries, (size_t) section->length);
+                return false;
+            }
+
+            index->image = image;
+            index->entries = entries;
+            index->count = (size_t) section->count;
+            index->allocationSize = (size_t) section->length;
+            index->lastUsed = 0;
+
+            if (!OSAtomicCompareAndSwapPtrBarrier(NULL, index, (void * volatile *) &image->objc_index)) {
+                plcrash_nasync_objc_free_index(index);
+                return false;
+            }
+
+            return true;
+        }
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        case PLCRASH_ASYNC_IMAGE_INDEX_STORE_DWARF_FDE: {
+            plcrash_async_dwarf_fde_index_t *index = image_index_store_map(fd, section, true);
+            if (index == NULL)
+                return false;
+
+            if (index->count != section->count) {
+                munmap(index, (size_t) section->length);
+                return false;
+            }
+
+            for (size_t i = 0; i < index->count; i++) {
+                index->entries[i].pc_start += slide;
+                index->entries[i].pc_end += slide;
+            }
+            mprotect(index, (size_t) section->length, PROT_READ);
+
+            if (!image_index_store_publish_mapping(store, index, (size_t) section->length, (void * volatile *) &image->dwarf_fde_index))
+                return false;
+
+            image->shared_indices |= PLCRASH_ASYNC_MACHO_SHARED_DWARF_FDE_INDEX;
+            return true;
+        }
+#endif
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Load the indices stored for @a image, publishing each index that has not already been built for the image. Loaded
+ * symbol and DWARF FDE indices are borrowed from @a store, and remain mapped until the store is freed; a loaded
+ * Objective-C index is owned by the image.
+ *
+ * A stored file that does not match @a image, or is otherwise invalid, is removed.
+ *
+ * @param store The index store.
+ * @param image The image for which indices should be loaded. The image must not be freed after @a store.
+ * @param outStored On success, will be set to the indices stored for @a image, including those that were built
+ * but could not be stored, as a bitwise OR of plcrash_async_image_index_store_index_t values. Indices that could not
+ * be mapped are excluded.
+ * @param outBytes On success, will be set to the number of bytes mapped for the loaded indices.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no indices are stored for @a image,
+ * PLCRASH_ENOTSUP if the image has no LC_UUID, PLCRASH_EINVAL if the stored file was invalid, or PLCRASH_EINTERNAL
+ * if the file could not be read.
+ *
+ * @warning This function is not async-safe, and must not be called concurrently with other users of @a store, or
+ * with other writers of @a image.
+ */
+plcrash_error_t plcrash_nasync_image_index_store_load (plcrash_async_image_index_store_t *store, plcrash_async_macho_t *image, uint32_t *outStored, size_t *outBytes) {
+    char path[PATH_MAX];
+
+    *outStored = 0;
+    *outBytes = 0;
+
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid == NULL)
+        return PLCRASH_ENOTSUP;
+
+    if (!image_index_store_path(store, uuid->uuid, path, sizeof(path)))
+        return PLCRASH_EINTERNAL;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errno == ENOENT)
+            return PLCRASH_ENOTFOUND;
+
+        PLCF_DEBUG("Failed to open index file %s: %s", path, strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+
+    image_index_store_header_t header;
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header) ||
+        !image_index_store_validate(&header, image, uuid->uuid, (uint64_t) sb.st_size))
+    {
+        PLCF_DEBUG("Discarding invalid index file for %s", image->name);
+        close(fd);
+        unlink(path);
+        return PLCRASH_EINVAL;
+    }
+
+    /* Refresh the file's modification time; files that go unused are eventually pruned */
+    futimes(fd, NULL);
+
+    uint32_t stored = header.omitted;
+    size_t bytes = 0;
+    uint32_t available = plcrash_nasync_image_index_store_available(image);
+    for (uint32_t i = 0; i < header.section_count; i++) {
+        const image_index_store_section_t *section = &header.sections[i];
+
+        /* An index built prior to loading is retained, and is equivalent to the stored index */
+        if (available & section->index) {
+            stored |= section->index;
+            continue;
+        }
+
+        if (image_index_store_load_section(store, image, fd, section)) {
+            stored |= section->index;
+            bytes += (size_t) section->length;
+        }
+    }
+
+    close(fd);
+
+    *outStored = stored;
+    *outBytes = bytes;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free all resources associated with @a store, unmapping all borrowed indices. Any image that borrowed an index from
+ * @a store must be freed first.
+ *
+ * @param store The store to free.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_image_index_store_free (plcrash_async_image_index_store_t *store) {
+    while (store->mappings != NULL) {
+        plcrash_async_image_index_store_mapping_t *next = store->mappings->next;
+        munmap(store->mappings->address, store->mappings->length);
+        free(store->mappings);
+        store->mappings = next;
+    }
+
+    free(store->path);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,110 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_IMAGE_INDEX_STORE_H
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_store
+ *
+ * The indices that may be persisted by an index store.
+ */
+typedef enum {
+    /** The symbol address index (plcrash_async_macho::symbol_index). */
+    PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS = 1 << 0,
+
+    /** The Objective-C IMP index (plcrash_async_macho::objc_index). */
+    PLCRASH_ASYNC_IMAGE_INDEX_STORE_OBJC = 1 << 1,
+
+    /** The sorted DWARF FDE index (plcrash_async_macho::dwarf_fde_index). */
+    PLCRASH_ASYNC_IMAGE_INDEX_STORE_DWARF_FDE = 1 << 2,
+} plcrash_async_image_index_store_index_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_store
+ *
+ * The maximum age, in seconds, of a stored index file that has been neither read nor written. Older files are
+ * removed when a store is initialized.
+ */
+#define PLCRASH_ASYNC_IMAGE_INDEX_STORE_MAX_AGE (30 * 24 * 60 * 60)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_store
+ *
+ * A mapping of a stored index, borrowed by one or more images.
+ */
+typedef struct plcrash_async_image_index_store_mapping {
+    /** The next mapping, or NULL. */
+    struct plcrash_async_image_index_store_mapping *next;
+
+    /** The mapped address. */
+    void *address;
+
+    /** The mapped length, in bytes. */
+    size_t length;
+} plcrash_async_image_index_store_mapping_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_index_store
+ *
+ * A directory of image indices persisted across launches, keyed by image LC_UUID.
+ */
+typedef struct plcrash_async_image_index_store {
+    /** The store directory. */
+    char *path;
+
+    /** The mappings borrowed by loaded images, released when the store is freed. */
+    plcrash_async_image_index_store_mapping_t *mappings;
+} plcrash_async_image_index_store_t;
+
+plcrash_error_t plcrash_nasync_image_index_store_init (plcrash_async_image_index_store_t *store, const char *path);
+uint32_t plcrash_nasync_image_index_store_available (plcrash_async_macho_t *image);
+plcrash_error_t plcrash_nasync_image_index_store_load (plcrash_async_image_index_store_t *store, plcrash_async_macho_t *image, uint32_t *outStored, size_t *outBytes);
+plcrash_error_t plcrash_nasync_image_index_store_save (plcrash_async_image_index_store_t *store, plcrash_async_macho_t *image, uint32_t *outStored);
+void plcrash_nasync_image_index_store_free (plcrash_async_image_index_store_t *store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_IMAGE_INDEX_STORE_H */
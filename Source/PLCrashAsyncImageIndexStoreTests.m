@@ -0,0 +1,161 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncImageIndexStore.h"
+
+#import <dlfcn.h>
+
+@interface PLCrashAsyncImageIndexStoreTests : SenTestCase {
+@private
+    /** Store directory */
+    NSString *_directory;
+
+    /** Store under test */
+    plcrash_async_image_index_store_t _store;
+}
+@end
+
+/* Record the address of a found symbol */
+static void found_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    *((pl_vm_address_t *) ctx) = address;
+}
+
+@implementation PLCrashAsyncImageIndexStoreTests
+
+- (void) setUp {
+    _directory = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: _directory withIntermediateDirectories: YES attributes: nil error: NULL], @"Could not create directory");
+    STAssertEquals(plcrash_nasync_image_index_store_init(&_store, [_directory fileSystemRepresentation]), PLCRASH_ESUCCESS, @"Failed to initialize the store");
+}
+
+- (void) tearDown {
+    plcrash_nasync_image_index_store_free(&_store);
+    [[NSFileManager defaultManager] removeItemAtPath: _directory error: NULL];
+    [_directory release];
+}
+
+/* Initialize @a image from the image containing this test case */
+- (void) loadImage: (plcrash_async_macho_t *) image {
+    Dl_info info;
+    STAssertTrue(dladdr([self class], &info) > 0, @"Could not fetch dyld info");
+    STAssertEquals(plcrash_nasync_macho_init(image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), PLCRASH_ESUCCESS,
+                   @"Failed to initialize image");
+}
+
+/* Write the symbol index of this test case's image to the store */
+- (void) saveSymbolIndex {
+    plcrash_async_macho_t image;
+    uint32_t stored;
+
+    [self loadImage: &image];
+    STAssertEquals(plcrash_nasync_macho_index_symbols(&image), PLCRASH_ESUCCESS, @"Failed to index symbols");
+    STAssertEquals(plcrash_nasync_image_index_store_save(&_store, &image, &stored), PLCRASH_ESUCCESS, @"Failed to save indices");
+    STAssertTrue(stored & PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS, @"Symbol index was not stored");
+    plcrash_nasync_macho_free(&image);
+}
+
+/* Return the index files in the store directory */
+- (NSArray *) indexFiles {
+    NSArray *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath: _directory error: NULL];
+    return [files filteredArrayUsingPredicate: [NSPredicate predicateWithFormat: @"pathExtension == 'plindex'"]];
+}
+
+/**
+ * Verify that a stored symbol index is mapped by a later instance of the same image, and that lookups via the
+ * mapped index match those of an unindexed image.
+ */
+- (void) testSaveAndLoad {
+    plcrash_async_macho_t loaded;
+    plcrash_async_macho_t unindexed;
+    uint32_t stored;
+    size_t bytes;
+
+    [self saveSymbolIndex];
+    STAssertEquals([[self indexFiles] count], (NSUInteger) 1, @"Expected a single index file");
+
+    [self loadImage: &loaded];
+    [self loadImage: &unindexed];
+    STAssertEquals(plcrash_nasync_image_index_store_load(&_store, &loaded, &stored, &bytes), PLCRASH_ESUCCESS, @"Failed to load indices");
+    STAssertTrue(stored & PLCRASH_ASYNC_IMAGE_INDEX_STORE_SYMBOLS, @"Symbol index was not loaded");
+    STAssertTrue(bytes > 0, @"No bytes were mapped");
+    STAssertNotNULL(loaded.symbol_index, @"Symbol index was not loaded");
+    STAssertTrue(loaded.shared_indices & PLCRASH_ASYNC_MACHO_SHARED_SYMBOL_INDEX, @"Mapped index was not marked as shared");
+
+    pl_vm_address_t pc = (pl_vm_address_t) [self methodForSelector: _cmd];
+    pl_vm_address_t expected = 0;
+    pl_vm_address_t found = 0;
+
+    STAssertEquals(plcrash_async_macho_find_symbol_by_pc(&unindexed, pc, found_symbol_cb, &expected), PLCRASH_ESUCCESS, @"Symbol lookup failed");
+    STAssertEquals(plcrash_async_macho_find_symbol_by_pc(&loaded, pc, found_symbol_cb, &found), PLCRASH_ESUCCESS, @"Symbol lookup failed");
+    STAssertEquals(found, expected, @"Mapped index returned a different symbol");
+
+    /* Mapped indices are owned by the store, and must outlive the image */
+    plcrash_nasync_macho_free(&loaded);
+    plcrash_nasync_macho_free(&unindexed);
+}
+
+/**
+ * Verify that loading from an empty store reports that no index was found.
+ */
+- (void) testLoadMissing {
+    plcrash_async_macho_t image;
+    uint32_t stored;
+    size_t bytes;
+
+    [self loadImage: &image];
+    STAssertEquals(plcrash_nasync_image_index_store_load(&_store, &image, &stored, &bytes), PLCRASH_ENOTFOUND, @"Unexpected result for a missing index");
+    STAssertEquals(stored, (uint32_t) 0, @"Indices were reported as loaded");
+    STAssertNULL(image.symbol_index, @"An index was loaded");
+    plcrash_nasync_macho_free(&image);
+}
+
+/**
+ * Verify that a corrupt index file is rejected and removed.
+ */
+- (void) testLoadCorrupt {
+    plcrash_async_macho_t image;
+    uint32_t stored;
+    size_t bytes;
+
+    [self saveSymbolIndex];
+    NSArray *files = [self indexFiles];
+    STAssertEquals([files count], (NSUInteger) 1, @"Expected a single index file");
+
+    NSString *path = [_directory stringByAppendingPathComponent: [files objectAtIndex: 0]];
+    STAssertEquals(truncate([path fileSystemRepresentation], 64), 0, @"Failed to truncate the index file");
+
+    [self loadImage: &image];
+    STAssertEquals(plcrash_nasync_image_index_store_load(&_store, &image, &stored, &bytes), PLCRASH_EINVAL, @"Corrupt index was not rejected");
+    STAssertNULL(image.symbol_index, @"An index was loaded");
+    STAssertFalse([[NSFileManager defaultManager] fileExistsAtPath: path], @"Corrupt index file was not removed");
+    plcrash_nasync_macho_free(&image);
+}
+
+@end
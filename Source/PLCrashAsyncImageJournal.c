@@ -0,0 +1,391 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashAsyncImageJournal.h"
+
+#import <stdlib.h>
+#import <string.h>
+#import <inttypes.h>
+#import <sys/param.h>
+#import <libkern/OSAtomic.h>
+#import <mach-o/loader.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_image_journal Shared Image Journal
+ *
+ * Implements an append-only journal of image loads and unloads within a shared memory region, allowing an
+ * out-of-process capture helper to maintain an up-to-date image table without enumerating the target's images
+ * via TASK_DYLD_INFO and dyld_all_image_infos at crash time.
+ *
+ * The journal is written by a single process, under the journal's writer lock, and read by mapping the region's
+ * read-only memory entry (see plcrash_nasync_image_journal_memory_entry()). Records are published by advancing the
+ * header's committed length after the record has been written; committed records are never modified. When the
+ * region is full, the journal is compacted in place to the ADD records of the currently loaded images. Compaction is
+ * bracketed by increments of the header's epoch, and readers discard any snapshot taken while the epoch changed
+ * (see plcrash_async_image_journal_snapshot()).
+ *
+ * Readers replay the records in order: an ADD record adds (or replaces) the image at its header address, and a
+ * REMOVE record removes it. The header's generation is incremented for every record, and may be polled to
+ * determine whether a previously replayed table is still current.
+ * @{
+ */
+
+/** Maximum number of attempts made by plcrash_async_image_journal_snapshot() to read a consistent snapshot. */
+#define PLCRASH_ASYNC_IMAGE_JOURNAL_SNAPSHOT_ATTEMPTS 64
+
+/* Return the size of a record with a name of @a name_length bytes, including the NUL and padding */
+static size_t image_journal_record_size (size_t name_length) {
+    return (sizeof(plcrash_async_image_journal_record_t) + name_length + 1 + 7) & ~(size_t) 7;
+}
+
+/**
+ * Initialize @a journal, allocating a zero-filled shared region of @a size bytes and its read-only memory entry.
+ *
+ * @param journal The journal to initialize.
+ * @param size The region size, in bytes. Will be rounded up to a multiple of the page size. If 0,
+ * PLCRASH_ASYNC_IMAGE_JOURNAL_DEFAULT_SIZE is used.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the region or its memory entry could not be
+ * allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_image_journal_init (plcrash_async_image_journal_t *journal, size_t size) {
+    if (size == 0)
+        size = PLCRASH_ASYNC_IMAGE_JOURNAL_DEFAULT_SIZE;
+    size = round_page(MAX(size, sizeof(plcrash_async_image_journal_header_t) + image_journal_record_size(PATH_MAX)));
+
+    vm_address_t addr = 0;
+    kern_return_t kr = vm_allocate(mach_task_self(), &addr, size, VM_FLAGS_ANYWHERE);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("vm_allocate() failure: %d", kr);
+        return PLCRASH_ENOMEM;
+    }
+
+    /* Populate the header before the entry is created; readers may map the region as soon as the entry is available */
+    plcrash_async_image_journal_header_t *header = (plcrash_async_image_journal_header_t *) addr;
+    header->magic = PLCRASH_ASYNC_IMAGE_JOURNAL_MAGIC;
+    header->version = PLCRASH_ASYNC_IMAGE_JOURNAL_VERSION;
+    header->size = size;
+    header->epoch = 0;
+    header->generation = 0;
+    header->length = 0;
+
+    memory_object_size_t entry_size = size;
+    mach_port_t entry = MACH_PORT_NULL;
+    kr = mach_make_memory_entry_64(mach_task_self(), &entry_size, addr, VM_PROT_READ, &entry, MACH_PORT_NULL);
+    if (kr != KERN_SUCCESS || entry_size < size) {
+        PLCF_DEBUG("mach_make_memory_entry_64() failure: %d", kr);
+        if (kr == KERN_SUCCESS)
+            mach_port_deallocate(mach_task_self(), entry);
+        vm_deallocate(mach_task_self(), addr, size);
+        return PLCRASH_ENOMEM;
+    }
+
+    journal->header = header;
+    journal->size = size;
+    journal->memory_entry = entry;
+    pthread_mutex_init(&journal->lock, NULL);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Compact @a journal in place to the ADD records of the images that have not since been removed. Must be called
+ * with the writer lock held.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the compaction buffer could not be allocated.
+ */
+static plcrash_error_t image_journal_compact (plcrash_async_image_journal_t *journal) {
+    uint8_t *records = (uint8_t *) (journal->header + 1);
+    size_t length = (size_t) journal->header->length;
+
+    uint8_t *compacted = malloc(length);
+    if (compacted == NULL)
+        return PLCRASH_ENOMEM;
+
+    /* An ADD record is live if no later record refers to the same header address; any later ADD replaces it, and
+     * any later REMOVE removes it. Journals hold at most a few thousand records, and compaction is rare. */
+    size_t compacted_length = 0;
+    size_t offset = 0;
+    const plcrash_async_image_journal_record_t *record;
+    while ((record = plcrash_async_image_journal_next(records, length, &offset)) != NULL) {
+        if (record->op != PLCRASH_ASYNC_IMAGE_JOURNAL_ADD)
+            continue;
+
+        bool live = true;
+        size_t later_offset = offset;
+        const plcrash_async_image_journal_record_t *later;
+        while ((later = plcrash_async_image_journal_next(records, length, &later_offset)) != NULL) {
+            if (later->header_addr == record->header_addr) {
+                live = false;
+                break;
+            }
+        }
+
+        if (live) {
+            memcpy(compacted + compacted_length, record, record->length);
+            compacted_length += record->length;
+        }
+    }
+
+    /* Readers discard any snapshot that overlaps the odd epoch */
+    journal->header->epoch++;
+    OSMemoryBarrier();
+
+    memcpy(records, compacted, compacted_length);
+    journal->header->length = compacted_length;
+    OSMemoryBarrier();
+
+    journal->header->epoch++;
+    OSMemoryBarrier();
+
+    free(compacted);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Append a record to @a journal, compacting the journal if required. Must be called with the writer lock held.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the record does not fit within the journal.
+ */
+static plcrash_error_t image_journal_append (plcrash_async_image_journal_t *journal, const plcrash_async_image_journal_record_t *record) {
+    size_t capacity = journal->size - sizeof(plcrash_async_image_journal_header_t);
+    plcrash_error_t err;
+
+    if (capacity - journal->header->length < record->length) {
+        if ((err = image_journal_compact(journal)) != PLCRASH_ESUCCESS)
+            return err;
+
+        if (capacity - journal->header->length < record->length) {
+            PLCF_DEBUG("Image journal is full; dropping record for 0x%" PRIx64, record->header_addr);
+            return PLCRASH_ENOMEM;
+        }
+    }
+
+    /* Write the record, and then publish it */
+    uint8_t *records = (uint8_t *) (journal->header + 1);
+    memcpy(records + journal->header->length, record, record->length);
+    OSMemoryBarrier();
+
+    journal->header->length += record->length;
+    journal->header->generation++;
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Append an ADD record for @a image to @a journal.
+ *
+ * @param journal The journal to which the record will be appended.
+ * @param image The loaded image.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the record could not be allocated or does not fit
+ * within the journal.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_image_journal_add (plcrash_async_image_journal_t *journal, plcrash_async_macho_t *image) {
+    size_t name_length = image->name != NULL ? image->name_length : 0;
+    size_t record_size = image_journal_record_size(name_length);
+
+    plcrash_async_image_journal_record_t *record = calloc(1, record_size);
+    if (record == NULL)
+        return PLCRASH_ENOMEM;
+
+    record->length = (uint32_t) record_size;
+    record->op = PLCRASH_ASYNC_IMAGE_JOURNAL_ADD;
+    record->header_addr = image->header_addr;
+    record->vmaddr_slide = image->vmaddr_slide;
+    record->text_vmaddr = image->text_vmaddr;
+    record->text_size = image->text_size;
+    record->cpu_type = image->byteorder->swap32(image->header.cputype);
+    record->cpu_subtype = image->byteorder->swap32(image->header.cpusubtype);
+    record->name_length = (uint32_t) name_length;
+    if (name_length > 0)
+        memcpy(record->name, image->name, name_length);
+
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid != NULL)
+        memcpy(record->uuid, uuid->uuid, sizeof(record->uuid));
+
+    pthread_mutex_lock(&journal->lock);
+    plcrash_error_t err = image_journal_append(journal, record);
+    pthread_mutex_unlock(&journal->lock);
+
+    free(record);
+    return err;
+}
+
+/**
+ * Append a REMOVE record for the image at @a header_addr to @a journal.
+ *
+ * @param journal The journal to which the record will be appended.
+ * @param header_addr The header address of the unloaded image.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the record does not fit within the journal.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_image_journal_remove (plcrash_async_image_journal_t *journal, pl_vm_address_t header_addr) {
+    union {
+        plcrash_async_image_journal_record_t record;
+        uint8_t bytes[(sizeof(plcrash_async_image_journal_record_t) + 1 + 7) & ~7];
+    } storage;
+
+    memset(&storage, 0, sizeof(storage));
+    storage.record.length = (uint32_t) image_journal_record_size(0);
+    storage.record.op = PLCRASH_ASYNC_IMAGE_JOURNAL_REMOVE;
+    storage.record.header_addr = header_addr;
+
+    pthread_mutex_lock(&journal->lock);
+    plcrash_error_t err = image_journal_append(journal, &storage.record);
+    pthread_mutex_unlock(&journal->lock);
+
+    return err;
+}
+
+/**
+ * Return the read-only memory entry for @a journal's region. The entry remains owned by the journal; callers that
+ * transfer the entry to another process should do so with a MACH_MSG_TYPE_COPY_SEND disposition.
+ *
+ * @param journal The journal.
+ */
+mach_port_t plcrash_nasync_image_journal_memory_entry (plcrash_async_image_journal_t *journal) {
+    return journal->memory_entry;
+}
+
+/**
+ * Free all resources associated with @a journal. Mappings of the journal's memory entry held by other processes
+ * remain valid.
+ *
+ * @param journal The journal to free.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_image_journal_free (plcrash_async_image_journal_t *journal) {
+    mach_port_deallocate(mach_task_self(), journal->memory_entry);
+    vm_deallocate(mach_task_self(), (vm_address_t) journal->header, journal->size);
+    pthread_mutex_destroy(&journal->lock);
+}
+
+/**
+ * Copy a consistent snapshot of the committed records from a mapped journal @a region to @a buffer. The copied
+ * records may then be iterated with plcrash_async_image_journal_next().
+ *
+ * @param region The mapped journal region.
+ * @param region_size The size of the mapping, in bytes.
+ * @param buffer The destination buffer.
+ * @param buffer_size The size of @a buffer, in bytes. The journal's records may occupy up to the region's size,
+ * less the size of the journal header.
+ * @param[out] length On success, the length of the copied records, in bytes.
+ * @param[out] generation On success, the journal generation as of the snapshot. May be NULL.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a region is not a valid journal, PLCRASH_ENOMEM
+ * if @a buffer is too small, or PLCRASH_EBUDGET if a consistent snapshot could not be read because the journal was
+ * repeatedly compacted during the copy.
+ *
+ * @par Async Safety
+ * This function is async-safe.
+ */
+plcrash_error_t plcrash_async_image_journal_snapshot (const void *region, size_t region_size, void *buffer, size_t buffer_size,
+                                                      size_t *length, uint64_t *generation)
+{
+    const volatile plcrash_async_image_journal_header_t *header = region;
+
+    if (region_size < sizeof(*header) || header->magic != PLCRASH_ASYNC_IMAGE_JOURNAL_MAGIC || header->version != PLCRASH_ASYNC_IMAGE_JOURNAL_VERSION)
+        return PLCRASH_EINVAL;
+
+    size_t capacity = MIN((size_t) header->size, region_size) - sizeof(*header);
+    for (unsigned int attempt = 0; attempt < PLCRASH_ASYNC_IMAGE_JOURNAL_SNAPSHOT_ATTEMPTS; attempt++) {
+        uint64_t epoch = header->epoch;
+        OSMemoryBarrier();
+
+        /* Compaction in progress */
+        if (epoch & 1)
+            continue;
+
+        uint64_t committed = header->length;
+        uint64_t committed_generation = header->generation;
+        if (committed > capacity)
+            return PLCRASH_EINVAL;
+
+        if (committed > buffer_size)
+            return PLCRASH_ENOMEM;
+
+        OSMemoryBarrier();
+        plcrash_async_memcpy(buffer, (const uint8_t *) region + sizeof(*header), (size_t) committed);
+        OSMemoryBarrier();
+
+        if (header->epoch != epoch)
+            continue;
+
+        *length = (size_t) committed;
+        if (generation != NULL)
+            *generation = committed_generation;
+        return PLCRASH_ESUCCESS;
+    }
+
+    return PLCRASH_EBUDGET;
+}
+
+/**
+ * Return the record at @a offset within @a records, advancing @a offset to the following record.
+ *
+ * @param records The journal records, as copied by plcrash_async_image_journal_snapshot().
+ * @param length The length of @a records, in bytes.
+ * @param offset The offset of the record to return. Should be initialized to 0 to fetch the first record.
+ *
+ * @return Returns the record, or NULL if no further records are available or the record at @a offset is malformed.
+ *
+ * @par Async Safety
+ * This function is async-safe.
+ */
+const plcrash_async_image_journal_record_t *plcrash_async_image_journal_next (const void *records, size_t length, size_t *offset) {
+    if (*offset >= length || length - *offset < sizeof(plcrash_async_image_journal_record_t))
+        return NULL;
+
+    const plcrash_async_image_journal_record_t *record = (const plcrash_async_image_journal_record_t *) ((const uint8_t *) records + *offset);
+
+    /* Verify that the record, and its terminated name, lie within the records */
+    if (record->length < sizeof(*record) || record->length > length - *offset || (record->length & 7) != 0)
+        return NULL;
+
+    if (record->name_length >= record->length - sizeof(*record) || record->name[record->name_length] != '\0')
+        return NULL;
+
+    *offset += record->length;
+    return record;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,192 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_IMAGE_JOURNAL_H
+#define PLCRASH_ASYNC_IMAGE_JOURNAL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <mach/mach.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * The journal header magic ('PLIJ').
+ */
+#define PLCRASH_ASYNC_IMAGE_JOURNAL_MAGIC 0x4a494c50
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * The journal layout version.
+ */
+#define PLCRASH_ASYNC_IMAGE_JOURNAL_VERSION 1
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * The default journal region size, in bytes; sufficient for several thousand image records.
+ */
+#define PLCRASH_ASYNC_IMAGE_JOURNAL_DEFAULT_SIZE (512 * 1024)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * Journal record operations.
+ */
+typedef enum {
+    /** An image was loaded. If a record for the same header address was previously added, it is replaced. */
+    PLCRASH_ASYNC_IMAGE_JOURNAL_ADD = 1,
+
+    /** An image was unloaded. */
+    PLCRASH_ASYNC_IMAGE_JOURNAL_REMOVE = 2,
+} plcrash_async_image_journal_op_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * The header at the start of a journal region. The region layout is shared with other processes, in host byte
+ * order, and must only be changed along with PLCRASH_ASYNC_IMAGE_JOURNAL_VERSION.
+ */
+typedef struct plcrash_async_image_journal_header {
+    /** PLCRASH_ASYNC_IMAGE_JOURNAL_MAGIC. */
+    uint32_t magic;
+
+    /** PLCRASH_ASYNC_IMAGE_JOURNAL_VERSION. */
+    uint32_t version;
+
+    /** The total size of the region, including this header, in bytes. */
+    uint64_t size;
+
+    /** Incremented before and after the journal is compacted; odd while a compaction is in progress. */
+    volatile uint64_t epoch;
+
+    /** The number of records appended since the journal was created. Not reset by compaction. */
+    volatile uint64_t generation;
+
+    /** The length of the committed records following this header, in bytes. */
+    volatile uint64_t length;
+
+    /** Reserved; always 0. */
+    uint64_t reserved[3];
+} plcrash_async_image_journal_header_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * A journal record. Records are appended following the journal header, and are padded to a multiple of 8 bytes.
+ * REMOVE records populate only @a op and @a header_addr.
+ */
+typedef struct plcrash_async_image_journal_record {
+    /** The total length of the record, including its name and padding, in bytes. */
+    uint32_t length;
+
+    /** The record's plcrash_async_image_journal_op_t operation. */
+    uint32_t op;
+
+    /** The image's header address. */
+    uint64_t header_addr;
+
+    /** The image's vmaddr slide. */
+    int64_t vmaddr_slide;
+
+    /** The image's unslid __TEXT address. */
+    uint64_t text_vmaddr;
+
+    /** The image's __TEXT size, in bytes. */
+    uint64_t text_size;
+
+    /** The image's Mach-O CPU type. */
+    uint32_t cpu_type;
+
+    /** The image's Mach-O CPU subtype. */
+    uint32_t cpu_subtype;
+
+    /** The image's LC_UUID, or all zeros if the image does not have a UUID. */
+    uint8_t uuid[16];
+
+    /** The length of @a name, in bytes, excluding the NUL terminator. */
+    uint32_t name_length;
+
+    /** Reserved; always 0. */
+    uint32_t reserved;
+
+    /** The image's NUL-terminated name. */
+    char name[];
+} plcrash_async_image_journal_record_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image_journal
+ *
+ * An append-only journal of image loads and unloads, mirrored into a shared memory region that may be mapped
+ * read-only by another process.
+ */
+typedef struct plcrash_async_image_journal {
+    /** The journal region. */
+    plcrash_async_image_journal_header_t *header;
+
+    /** The size of the journal region, in bytes. */
+    size_t size;
+
+    /** A read-only memory entry for the journal region. */
+    mach_port_t memory_entry;
+
+    /** Writer lock. */
+    pthread_mutex_t lock;
+} plcrash_async_image_journal_t;
+
+plcrash_error_t plcrash_nasync_image_journal_init (plcrash_async_image_journal_t *journal, size_t size);
+plcrash_error_t plcrash_nasync_image_journal_add (plcrash_async_image_journal_t *journal, plcrash_async_macho_t *image);
+plcrash_error_t plcrash_nasync_image_journal_remove (plcrash_async_image_journal_t *journal, pl_vm_address_t header_addr);
+mach_port_t plcrash_nasync_image_journal_memory_entry (plcrash_async_image_journal_t *journal);
+void plcrash_nasync_image_journal_free (plcrash_async_image_journal_t *journal);
+
+plcrash_error_t plcrash_async_image_journal_snapshot (const void *region, size_t region_size, void *buffer, size_t buffer_size,
+                                                      size_t *length, uint64_t *generation);
+const plcrash_async_image_journal_record_t *plcrash_async_image_journal_next (const void *records, size_t length, size_t *offset);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_IMAGE_JOURNAL_H */
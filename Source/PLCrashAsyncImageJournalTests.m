@@ -0,0 +1,198 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncImageJournal.h"
+#import "PLCrashAsyncImageList.h"
+
+#import <mach-o/dyld.h>
+
+@interface PLCrashAsyncImageJournalTests : SenTestCase {
+@private
+    plcrash_async_image_journal_t _journal;
+    plcrash_async_image_list_t _list;
+}
+@end
+
+@implementation PLCrashAsyncImageJournalTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_nasync_image_journal_init(&_journal, 0), PLCRASH_ESUCCESS, @"Failed to initialize journal");
+    plcrash_nasync_image_list_init(&_list, mach_task_self());
+}
+
+- (void) tearDown {
+    plcrash_nasync_image_list_free(&_list);
+    plcrash_nasync_image_journal_free(&_journal);
+}
+
+/**
+ * Snapshot @a region and replay its records, returning the set of live image header addresses.
+ */
+- (NSSet *) replayRegion: (const void *) region size: (size_t) size generation: (uint64_t *) generation {
+    NSMutableData *buffer = [NSMutableData dataWithLength: size];
+    size_t length;
+
+    plcrash_error_t err = plcrash_async_image_journal_snapshot(region, size, [buffer mutableBytes], [buffer length], &length, generation);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to snapshot journal");
+    if (err != PLCRASH_ESUCCESS)
+        return nil;
+
+    NSMutableSet *images = [NSMutableSet set];
+    const plcrash_async_image_journal_record_t *record;
+    size_t offset = 0;
+    while ((record = plcrash_async_image_journal_next([buffer bytes], length, &offset)) != NULL) {
+        NSNumber *header = [NSNumber numberWithUnsignedLongLong: record->header_addr];
+        if (record->op == PLCRASH_ASYNC_IMAGE_JOURNAL_ADD) {
+            [images addObject: header];
+        } else {
+            [images removeObject: header];
+        }
+    }
+    STAssertEquals(offset, length, @"Journal contains malformed records");
+
+    return images;
+}
+
+/**
+ * Verify that list updates are mirrored to the journal, including images present before the journal was attached.
+ */
+- (void) testListJournal {
+    STAssertTrue(_dyld_image_count() >= 3, @"We need at least three Mach-O images for this test");
+
+    pl_vm_address_t headers[3];
+    for (uint32_t i = 0; i < 3; i++)
+        headers[i] = (pl_vm_address_t) _dyld_get_image_header(i);
+
+    plcrash_nasync_image_list_append(&_list, headers[0], _dyld_get_image_name(0));
+    plcrash_nasync_image_list_set_journal(&_list, &_journal);
+    plcrash_nasync_image_list_append(&_list, headers[1], _dyld_get_image_name(1));
+    plcrash_nasync_image_list_append(&_list, headers[2], _dyld_get_image_name(2));
+    plcrash_nasync_image_list_remove(&_list, headers[1]);
+
+    uint64_t generation;
+    NSSet *images = [self replayRegion: _journal.header size: _journal.size generation: &generation];
+    STAssertEquals(generation, (uint64_t) 4, @"Incorrect generation");
+    STAssertEquals([images count], (NSUInteger) 2, @"Incorrect image count");
+    STAssertTrue([images containsObject: [NSNumber numberWithUnsignedLongLong: headers[0]]], @"Pre-existing image was not journaled");
+    STAssertTrue([images containsObject: [NSNumber numberWithUnsignedLongLong: headers[2]]], @"Appended image was not journaled");
+
+    /* Verify the record contents */
+    size_t length;
+    NSMutableData *buffer = [NSMutableData dataWithLength: _journal.size];
+    STAssertEquals(plcrash_async_image_journal_snapshot(_journal.header, _journal.size, [buffer mutableBytes], [buffer length], &length, NULL),
+                   PLCRASH_ESUCCESS, @"Failed to snapshot journal");
+
+    size_t offset = 0;
+    const plcrash_async_image_journal_record_t *record = plcrash_async_image_journal_next([buffer bytes], length, &offset);
+    STAssertNotNULL(record, @"Missing record");
+    STAssertEquals(record->header_addr, (uint64_t) headers[0], @"Incorrect header address");
+    STAssertEquals(record->vmaddr_slide, (int64_t) _dyld_get_image_vmaddr_slide(0), @"Incorrect slide");
+    STAssertEqualCStrings(record->name, _dyld_get_image_name(0), @"Incorrect name");
+    STAssertEquals(record->cpu_type, (uint32_t) _dyld_get_image_header(0)->cputype, @"Incorrect CPU type");
+}
+
+/**
+ * Verify that a full journal is compacted to the live image records.
+ */
+- (void) testCompaction {
+    plcrash_async_macho_t image;
+    STAssertEquals(plcrash_nasync_macho_init(&image, mach_task_self(), _dyld_get_image_name(0), (pl_vm_address_t) _dyld_get_image_header(0)),
+                   PLCRASH_ESUCCESS, @"Failed to initialize image");
+
+    /* Repeatedly load and unload the image; without compaction, the records would exceed the journal size */
+    size_t iterations = _journal.size / sizeof(plcrash_async_image_journal_record_t);
+    for (size_t i = 0; i < iterations; i++) {
+        STAssertEquals(plcrash_nasync_image_journal_add(&_journal, &image), PLCRASH_ESUCCESS, @"Failed to append ADD record");
+        STAssertEquals(plcrash_nasync_image_journal_remove(&_journal, image.header_addr), PLCRASH_ESUCCESS, @"Failed to append REMOVE record");
+    }
+    STAssertEquals(plcrash_nasync_image_journal_add(&_journal, &image), PLCRASH_ESUCCESS, @"Failed to append ADD record");
+
+    STAssertTrue(_journal.header->epoch > 0, @"Journal was not compacted");
+    STAssertEquals(_journal.header->epoch % 2, (uint64_t) 0, @"Compaction did not complete");
+    STAssertEquals(_journal.header->generation, (uint64_t) (iterations * 2 + 1), @"Incorrect generation");
+
+    uint64_t generation;
+    NSSet *images = [self replayRegion: _journal.header size: _journal.size generation: &generation];
+    STAssertEquals([images count], (NSUInteger) 1, @"Incorrect image count");
+    STAssertTrue([images containsObject: [NSNumber numberWithUnsignedLongLong: image.header_addr]], @"Live image was lost");
+
+    plcrash_nasync_macho_free(&image);
+}
+
+/**
+ * Verify that the journal may be read via a read-only mapping of its memory entry.
+ */
+- (void) testMemoryEntry {
+    plcrash_nasync_image_list_set_journal(&_list, &_journal);
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(0), _dyld_get_image_name(0));
+
+    vm_address_t addr = 0;
+    kern_return_t kr = vm_map(mach_task_self(), &addr, _journal.size, 0, VM_FLAGS_ANYWHERE, plcrash_nasync_image_journal_memory_entry(&_journal),
+                              0, false, VM_PROT_READ, VM_PROT_READ, VM_INHERIT_NONE);
+    STAssertEquals(kr, KERN_SUCCESS, @"Failed to map the journal's memory entry");
+    if (kr != KERN_SUCCESS)
+        return;
+
+    NSSet *images = [self replayRegion: (const void *) addr size: _journal.size generation: NULL];
+    STAssertEquals([images count], (NSUInteger) 1, @"Incorrect image count from the mapped journal");
+
+    /* Updates are visible through the existing mapping */
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(1), _dyld_get_image_name(1));
+    images = [self replayRegion: (const void *) addr size: _journal.size generation: NULL];
+    STAssertEquals([images count], (NSUInteger) 2, @"Update was not visible through the mapped journal");
+
+    vm_deallocate(mach_task_self(), addr, _journal.size);
+}
+
+/**
+ * Verify that invalid regions and records are rejected.
+ */
+- (void) testInvalid {
+    uint8_t buffer[256];
+    size_t length;
+    memset(buffer, 0, sizeof(buffer));
+
+    STAssertEquals(plcrash_async_image_journal_snapshot(buffer, sizeof(buffer), buffer, sizeof(buffer), &length, NULL), PLCRASH_EINVAL,
+                   @"Invalid region was accepted");
+
+    /* A record that overruns the available data */
+    plcrash_async_image_journal_record_t *record = (plcrash_async_image_journal_record_t *) buffer;
+    record->length = sizeof(buffer) * 2;
+    size_t offset = 0;
+    STAssertNULL(plcrash_async_image_journal_next(buffer, sizeof(buffer), &offset), @"Overrunning record was returned");
+
+    /* A record with an unterminated name */
+    record->length = 128;
+    record->name_length = 128;
+    offset = 0;
+    STAssertNULL(plcrash_async_image_journal_next(buffer, sizeof(buffer), &offset), @"Unterminated record was returned");
+}
+
+@end
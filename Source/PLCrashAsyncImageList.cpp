@@ -29,10 +29,16 @@
 #include "PLCrashAsync.h"
 #include "PLCrashAsyncImageList.h"
 #include "PLCrashAsyncLinkedList.hpp"
+#include "PLCrashAsyncObjCSection.h"
+#include "PLCrashAsyncDwarfFDEIndex.h"
+#include "PLCrashFeatureConfig.h"
+#include "PLCrashFrameDWARFUnwind.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <pthread.h>
+#include <mach/mach_time.h>
 
 using namespace plcrash::async;
 
@@ -47,9 +53,160 @@ using namespace plcrash::async;
  * Atomic compare and swap is used to ensure a consistent view of the list for readers. To simplify implementation, a
  * write mutex is held for all updates; the implementation is not designed for efficiency in the face of contention
  * between readers and writers, and it's assumed that no contention should realistically occur.
+ *
+ * To support O(log n) address lookups, an immutable address-sorted index of the list's images is rebuilt on every
+ * update and published via atomic pointer swap. Readers register with the index via
+ * plcrash_async_image_list_set_reading(); a replaced index is only deallocated once no readers remain.
+ *
+ * Per-image symbol and Objective-C indices may optionally be built on a low-priority background thread as images
+ * are appended (see plcrash_nasync_image_list_start_warmup()), moving the cost of parsing out of crash time.
  * @{
  */
 
+/**
+ * @internal
+ *
+ * Background index warmup state.
+ */
+/**
+ * @internal
+ *
+ * Unwind state retained across stack walks; see plcrash_nasync_image_list_acquire_unwind_cache(). The section
+ * mappings and parsed CIEs held here reference the list's images, and are evicted as images are removed.
+ */
+struct plcrash_async_image_unwind_context {
+    /** Held by the context's current user, and by image removal. */
+    pthread_mutex_t lock;
+
+    /** Section mappings retained across stack walks. */
+    plcrash_async_macho_section_cache_t section_cache;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /** Parsed DWARF CIEs retained across stack walks, or NULL if allocation failed. */
+    plframe_dwarf_cie_cache_t *dwarf_cie_cache;
+#endif
+};
+
+struct plcrash_async_image_warmup {
+    /** The warmup thread. */
+    pthread_t thread;
+
+    /** Lock guarding all mutable state below. */
+    pthread_mutex_t lock;
+
+    /** Signaled when work is requested, when work is completed, and when the thread is asked to stop. */
+    pthread_cond_t cond;
+
+    /** Incremented each time the image list is modified. */
+    uint64_t requested;
+
+    /** The value of @a requested at the start of the most recently completed warmup pass. */
+    uint64_t completed;
+
+    /** If true, the warmup thread should exit. */
+    bool stop;
+
+    /** The maximum number of bytes that may be allocated for indices. */
+    size_t budget;
+
+    /** The number of bytes allocated for indices. Only written by the warmup thread. */
+    size_t used;
+
+    /** If true, symbol indices will be built. */
+    bool symbols;
+
+    /** If true, Objective-C IMP indices will be built. */
+    bool objc;
+};
+
+/**
+ * @internal
+ *
+ * A single allocation backing the images registered by plcrash_nasync_image_list_append_all().
+ */
+struct plcrash_async_image_arena {
+    /** The next arena, or NULL. */
+    plcrash_async_image_arena_t *next;
+
+    /** The arena's images. */
+    plcrash_async_image_t images[];
+};
+
+/* qsort() comparator for plcrash_async_image_index::images */
+static int plcrash_nasync_image_index_compare (const void *lhs, const void *rhs) {
+    pl_vm_address_t lhs_addr = (*(plcrash_async_image_t * const *) lhs)->macho_image.header_addr;
+    pl_vm_address_t rhs_addr = (*(plcrash_async_image_t * const *) rhs)->macho_image.header_addr;
+
+    if (lhs_addr < rhs_addr)
+        return -1;
+    else if (lhs_addr > rhs_addr)
+        return 1;
+    return 0;
+}
+
+/* Free a chain of retired indices. */
+static void plcrash_nasync_image_index_free_retired (plcrash_async_image_index_t *index) {
+    while (index != NULL) {
+        plcrash_async_image_index_t *next = index->_next_retired;
+        free(index);
+        index = next;
+    }
+}
+
+/**
+ * Rebuild and publish the address-sorted index for @a list. If the index can not be allocated, a NULL index
+ * will be published, and readers will fall back to a linear search of the list.
+ *
+ * @param list The list to be re-indexed.
+ *
+ * @warning This method is not async safe.
+ */
+static void plcrash_nasync_image_list_reindex (plcrash_async_image_list_t *list) {
+    OSSpinLockLock(&list->_index_lock);
+
+    /* Build the new index from the current list contents */
+    plcrash_async_image_index_t *index = NULL;
+    list->_list->set_reading(true); {
+        async_list<plcrash_async_image_t *>::node *next = NULL;
+        size_t count = 0;
+        while ((next = list->_list->next(next)) != NULL)
+            count++;
+
+        if (count > 0 && (index = (plcrash_async_image_index_t *) malloc(sizeof(*index) + (sizeof(index->images[0]) * count))) != NULL) {
+            index->count = 0;
+            index->_next_retired = NULL;
+
+            next = NULL;
+            while ((next = list->_list->next(next)) != NULL && index->count < count)
+                index->images[index->count++] = next->value();
+            
+            qsort(index->images, index->count, sizeof(index->images[0]), plcrash_nasync_image_index_compare);
+        } else if (count > 0) {
+            PLCF_DEBUG("Failed to allocate image index for %zu images; lookups will use a linear search", count);
+        }
+    } list->_list->set_reading(false);
+
+    /* Publish the new index */
+    plcrash_async_image_index_t *old;
+    do {
+        old = list->_index;
+    } while (!OSAtomicCompareAndSwapPtrBarrier(old, index, (void * volatile *) &list->_index));
+
+    /* Retire the previous index; it may only be freed once no readers could be referencing it. Readers increment the
+     * refcount prior to fetching the index pointer, so any reader arriving after the swap will see the new index. */
+    if (old != NULL) {
+        old->_next_retired = list->_retired_index;
+        list->_retired_index = old;
+    }
+
+    if (list->_index_refcount == 0) {
+        plcrash_nasync_image_index_free_retired(list->_retired_index);
+        list->_retired_index = NULL;
+    }
+
+    OSSpinLockUnlock(&list->_index_lock);
+}
+
 
 /**
  * Initialize a new binary image list and issue a memory barrier
@@ -63,32 +220,247 @@ void plcrash_nasync_image_list_init (plcrash_async_image_list_t *list, mach_port
     memset(list, 0, sizeof(*list));
 
     list->_list = new async_list<plcrash_async_image_t *>();
+    list->_index_lock = OS_SPINLOCK_INIT;
+    list->_cmd_arena_lock = OS_SPINLOCK_INIT;
+    plcrash_nasync_macho_cmd_arena_init(&list->_cmd_arena);
+    pthread_mutex_init(&list->_journal_lock, NULL);
+    pthread_mutex_init(&list->_dwarf_index_lock, NULL);
     list->task = task;
     mach_port_mod_refs(mach_task_self(), list->task, MACH_PORT_RIGHT_SEND, 1);
 }
 
+/*
+ * Attach @a list's shared cache LINKEDIT mapping to @a image, if the mapping is available and @a image was loaded
+ * from the shared cache.
+ */
+static void plcrash_nasync_image_attach_shared_cache (plcrash_async_image_list_t *list, plcrash_async_image_t *image) {
+    if (!list->_shared_cache_mapped)
+        return;
+
+    if (plcrash_async_shared_cache_contains_image(&list->_shared_cache, &image->macho_image))
+        plcrash_nasync_macho_set_shared_linkedit(&image->macho_image, &list->_shared_linkedit);
+}
+
+/*
+ * Initialize @a image's Mach-O parser, in compact mode if enabled for @a list.
+ */
+static plcrash_error_t plcrash_nasync_image_init (plcrash_async_image_list_t *list, plcrash_async_image_t *image, pl_vm_address_t header, const char *name) {
+    plcrash_error_t ret;
+
+    if (!list->_compact) {
+        ret = plcrash_nasync_macho_init(&image->macho_image, list->task, name, header);
+    } else {
+        OSSpinLockLock(&list->_cmd_arena_lock); {
+            ret = plcrash_nasync_macho_init_compact(&image->macho_image, list->task, name, header, &list->_cmd_arena);
+        } OSSpinLockUnlock(&list->_cmd_arena_lock);
+    }
+
+    if (ret == PLCRASH_ESUCCESS)
+        plcrash_nasync_image_attach_shared_cache(list, image);
+
+    return ret;
+}
+
+/*
+ * If @a image is the system library that implements the _sigtramp signal trampoline, record the trampoline's address
+ * range in @a list; see plcrash_async_image_list_get_sigtramp(). The trampoline is implemented by libsystem_platform,
+ * or by libsystem_c on releases that predate libsystem_platform.
+ */
+static void plcrash_nasync_image_find_sigtramp (plcrash_async_image_list_t *list, plcrash_async_image_t *image) {
+    const char *name = image->macho_image.name;
+    const char *basename = strrchr(name, '/');
+    basename = (basename != NULL) ? basename + 1 : name;
+
+    if (strcmp(basename, "libsystem_platform.dylib") != 0 && (list->_sigtramp_start != 0 || strcmp(basename, "libsystem_c.dylib") != 0))
+        return;
+
+    pl_vm_address_t start;
+    plcrash_error_t ret;
+    if ((ret = plcrash_async_macho_find_symbol_by_name(&image->macho_image, "__sigtramp", &start)) != PLCRASH_ESUCCESS)
+        return;
+
+    /* The symbol table does not record symbol sizes; the trampoline ends at the next symbol in the image */
+    plcrash_async_macho_symtab_reader_t reader;
+    if ((ret = plcrash_async_macho_symtab_reader_init(&reader, &image->macho_image)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read the symbol table of %s: %d", name, ret);
+        return;
+    }
+
+    pl_vm_address_t end = 0;
+    for (uint32_t i = 0; i < reader.nsyms; i++) {
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_reader_read(&reader, reader.symtab, i);
+        if ((entry.n_type & N_TYPE) != N_SECT || ((entry.n_type & N_STAB) != 0))
+            continue;
+
+        pl_vm_address_t address = entry.normalized_value + image->macho_image.vmaddr_slide;
+        if (address > start && (end == 0 || address < end))
+            end = address;
+    }
+    plcrash_async_macho_symtab_reader_free(&reader);
+
+    if (end == 0) {
+        PLCF_DEBUG("Could not determine the end of _sigtramp in %s", name);
+        return;
+    }
+
+    /* Publish the range; readers check the start address first */
+    list->_sigtramp_start = 0;
+    OSMemoryBarrier();
+    list->_sigtramp_image = image->macho_image.header_addr;
+    list->_sigtramp_end = end;
+    OSMemoryBarrier();
+    list->_sigtramp_start = start;
+}
+
+/*
+ * Add the cost of an index built for @a image since @a start (in mach_absolute_time() units) to the image's index
+ * totals; see plcrash_nasync_image_list_get_stats().
+ */
+static void plcrash_nasync_image_record_index (plcrash_async_image_t *image, uint64_t start, size_t bytes) {
+    OSAtomicAdd64Barrier((int64_t) (mach_absolute_time() - start), &image->index_time);
+    OSAtomicAdd64Barrier((int64_t) bytes, &image->index_bytes);
+}
+
+/*
+ * Build @a image's symbol index, if not already built. Failure is non-fatal; lookups will fall back to a linear scan.
+ * Returns the number of bytes allocated for the index, or 0 if no index was built.
+ */
+static size_t plcrash_nasync_image_index_symbols (plcrash_async_image_t *image) {
+    if (image->macho_image.symbol_index != NULL)
+        return 0;
+
+    uint64_t start = mach_absolute_time();
+    plcrash_error_t ret;
+    if ((ret = plcrash_nasync_macho_index_symbols(&image->macho_image)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to build symbol index for %s: %d", image->macho_image.name, ret);
+        return 0;
+    }
+
+    plcrash_async_macho_symbol_index_t *index = image->macho_image.symbol_index;
+    if (index == NULL)
+        return 0;
+
+    size_t bytes = sizeof(*index) + (sizeof(index->entries[0]) * index->count);
+    plcrash_nasync_image_record_index(image, start, bytes);
+    return bytes;
+}
+
+/*
+ * Request a pass of @a list's background warmup thread, if warmup has been enabled.
+ */
+static void plcrash_nasync_image_list_request_warmup (plcrash_async_image_list_t *list) {
+    if (list->_warmup == NULL)
+        return;
+
+    pthread_mutex_lock(&list->_warmup->lock);
+    list->_warmup->requested++;
+    pthread_cond_broadcast(&list->_warmup->cond);
+    pthread_mutex_unlock(&list->_warmup->lock);
+}
+
+/*
+ * Pre-encode @a image's crash report record using @a list's record encoder, if any. Must be called prior to
+ * publishing @a image to readers. Failure is non-fatal; the record will be encoded at crash time.
+ */
+static void plcrash_nasync_image_encode_record (plcrash_async_image_list_t *list, plcrash_async_image_t *image) {
+    plcrash_async_image_record_encoder_t encoder = list->_record_encoder;
+    if (encoder == NULL)
+        return;
+
+    size_t length = encoder(&image->macho_image, NULL, 0);
+    if (length == 0)
+        return;
+
+    void *record = malloc(length);
+    if (record == NULL || encoder(&image->macho_image, record, length) != length) {
+        PLCF_DEBUG("Failed to encode crash report record for %s", image->macho_image.name);
+        free(record);
+        return;
+    }
+
+    image->record = record;
+    image->record_length = length;
+}
+
 /**
  * Free any binary image list resources.
  *
  * @warning This method is not async safe.
  */
 void plcrash_nasync_image_list_free (plcrash_async_image_list_t *list) {
+    /* Stop the warmup thread, if any */
+    if (list->_warmup != NULL) {
+        plcrash_async_image_warmup_t *warmup = list->_warmup;
+
+        pthread_mutex_lock(&warmup->lock);
+        warmup->stop = true;
+        pthread_cond_broadcast(&warmup->cond);
+        pthread_mutex_unlock(&warmup->lock);
+
+        pthread_join(warmup->thread, NULL);
+        pthread_cond_destroy(&warmup->cond);
+        pthread_mutex_destroy(&warmup->lock);
+        free(warmup);
+        list->_warmup = NULL;
+    }
+
     /* Clean up the image structures */
     list->_list->set_reading(true);
     async_list<plcrash_async_image_t *>::node *next = NULL;
     while ((next = list->_list->next(next)) != NULL) {
         plcrash_async_image_t *image = next->value();
         
-        /* Deallocate the Mach-O reference. */
+        /* Deallocate the Mach-O reference and pre-encoded record. */
         plcrash_nasync_macho_free(&image->macho_image);
+        free(image->record);
         
-        /* Deallocate the actual image value */
-        free(image);
+        /* Deallocate the actual image value; arena-allocated images are freed with their arena below. */
+        if (!image->_arena_allocated)
+            free(image);
     }
     list->_list->set_reading(false);
 
-    /* Free the backing list */
+    while (list->_arenas != NULL) {
+        plcrash_async_image_arena_t *next = list->_arenas->next;
+        free(list->_arenas);
+        list->_arenas = next;
+    }
+
+    plcrash_nasync_macho_cmd_arena_free(&list->_cmd_arena);
+
+    /* The stored index mappings are borrowed by the (now freed) images */
+    if (list->_index_store != NULL) {
+        plcrash_nasync_image_index_store_free(list->_index_store);
+        free(list->_index_store);
+        list->_index_store = NULL;
+    }
+
+    /* The shared LINKEDIT mapping is borrowed by the (now freed) cached images */
+    if (list->_shared_cache_mapped)
+        plcrash_async_mobject_free(&list->_shared_linkedit);
+
+    /* Free the unwind context; its mappings reference the (now freed) images, but not their memory */
+    if (list->_unwind_context != NULL) {
+        plcrash_async_image_unwind_context_t *context = list->_unwind_context;
+
+        plcrash_async_macho_section_cache_free(&context->section_cache);
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        if (context->dwarf_cie_cache != NULL)
+            plframe_dwarf_cie_cache_free(context->dwarf_cie_cache);
+#endif
+        pthread_mutex_destroy(&context->lock);
+        delete context;
+        list->_unwind_context = NULL;
+    }
+
+    /* Free the backing list and index */
     delete list->_list;
+
+    if (list->_index != NULL)
+        free(list->_index);
+    plcrash_nasync_image_index_free_retired(list->_retired_index);
+    pthread_mutex_destroy(&list->_journal_lock);
+    pthread_mutex_destroy(&list->_dwarf_index_lock);
     
     mach_port_mod_refs(mach_task_self(), list->task, MACH_PORT_RIGHT_SEND, -1);
 }
@@ -107,14 +479,129 @@ void plcrash_nasync_image_list_append (plcrash_async_image_list_t *list, pl_vm_a
 
     /* Initialize the new entry. */
     plcrash_async_image_t *new_entry = (plcrash_async_image_t *) calloc(1, sizeof(plcrash_async_image_t));
-    if ((ret = plcrash_nasync_macho_init(&new_entry->macho_image, list->task, name, header)) != PLCRASH_ESUCCESS) {
+    if ((ret = plcrash_nasync_image_init(list, new_entry, header, name)) != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Unexpected failure initializing Mach-O structure for %s: %d", name, ret);
         free(new_entry);
         return;
     }
 
-    /* Append */
-    list->_list->nasync_append(new_entry);
+    /* Build the symbol index, if enabled */
+    if (list->_index_symbols)
+        plcrash_nasync_image_index_symbols(new_entry);
+
+    plcrash_nasync_image_find_sigtramp(list, new_entry);
+
+    /* Pre-encode the image's crash report record, if enabled */
+    plcrash_nasync_image_encode_record(list, new_entry);
+
+    /* Append, mirroring the image to the journal, if any */
+    pthread_mutex_lock(&list->_journal_lock); {
+        list->_list->nasync_append(new_entry);
+        if (list->_journal != NULL)
+            plcrash_nasync_image_journal_add(list->_journal, &new_entry->macho_image);
+    } pthread_mutex_unlock(&list->_journal_lock);
+    plcrash_nasync_image_list_reindex(list);
+
+    /* Schedule background indexing of the new image */
+    plcrash_nasync_image_list_request_warmup(list);
+}
+
+/**
+ * Append binary image records for all of @a headers to @a list. This is equivalent to calling
+ * plcrash_nasync_image_list_append() for each image, but allocates the image records from a single arena,
+ * publishes all records to readers in a single atomic update, and rebuilds the address index only once.
+ *
+ * @param list The list to which the image records should be appended.
+ * @param headers The images' header addresses.
+ * @param names The images' names.
+ * @param count The number of images in @a headers and @a names.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_append_all (plcrash_async_image_list_t *list, const pl_vm_address_t *headers, const char * const *names, size_t count) {
+    plcrash_error_t ret;
+
+    if (count == 0)
+        return;
+
+    /* Allocate the arena and a temporary table of initialized entries */
+    plcrash_async_image_arena_t *arena = (plcrash_async_image_arena_t *) calloc(1, sizeof(*arena) + (sizeof(arena->images[0]) * count));
+    plcrash_async_image_t **entries = (plcrash_async_image_t **) malloc(sizeof(entries[0]) * count);
+    if (arena == NULL || entries == NULL) {
+        PLCF_DEBUG("Failed to allocate an image arena for %zu images; registering individually", count);
+        free(arena);
+        free(entries);
+
+        for (size_t i = 0; i < count; i++)
+            plcrash_nasync_image_list_append(list, headers[i], names[i]);
+        return;
+    }
+
+    /* Initialize the new entries. */
+    size_t initialized = 0;
+    for (size_t i = 0; i < count; i++) {
+        plcrash_async_image_t *new_entry = &arena->images[initialized];
+        if ((ret = plcrash_nasync_image_init(list, new_entry, headers[i], names[i])) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Unexpected failure initializing Mach-O structure for %s: %d", names[i], ret);
+            continue;
+        }
+
+        new_entry->_arena_allocated = true;
+
+        /* Build the symbol index, if enabled */
+        if (list->_index_symbols)
+            plcrash_nasync_image_index_symbols(new_entry);
+
+        plcrash_nasync_image_find_sigtramp(list, new_entry);
+
+        /* Pre-encode the image's crash report record, if enabled */
+        plcrash_nasync_image_encode_record(list, new_entry);
+
+        entries[initialized++] = new_entry;
+    }
+
+    if (initialized == 0) {
+        free(arena);
+        free(entries);
+        return;
+    }
+
+    /* Append and publish */
+    arena->next = list->_arenas;
+    list->_arenas = arena;
+
+    pthread_mutex_lock(&list->_journal_lock); {
+        list->_list->nasync_append_all(entries, initialized);
+        if (list->_journal != NULL) {
+            for (size_t i = 0; i < initialized; i++)
+                plcrash_nasync_image_journal_add(list->_journal, &entries[i]->macho_image);
+        }
+    } pthread_mutex_unlock(&list->_journal_lock);
+    free(entries);
+
+    plcrash_nasync_image_list_reindex(list);
+
+    /* Schedule background indexing of the new images */
+    plcrash_nasync_image_list_request_warmup(list);
+}
+
+/**
+ * Return true if @a list contains an image record with the given @a header address.
+ *
+ * @param list The list to search.
+ * @param header The image header address to search for.
+ *
+ * @warning This method is not async safe.
+ */
+bool plcrash_nasync_image_list_contains (plcrash_async_image_list_t *list, pl_vm_address_t header) {
+    bool found;
+
+    plcrash_async_image_list_set_reading(list, true); {
+        plcrash_async_image_t *image = plcrash_async_image_containing_address(list, header);
+        found = (image != NULL && image->macho_image.header_addr == header);
+    } plcrash_async_image_list_set_reading(list, false);
+
+    return found;
 }
 
 /**
@@ -126,6 +613,7 @@ void plcrash_nasync_image_list_append (plcrash_async_image_list_t *list, pl_vm_a
  * @warning This method is not async safe.
  */
 void plcrash_nasync_image_list_remove (plcrash_async_image_list_t *list, pl_vm_address_t header) {
+    pthread_mutex_lock(&list->_journal_lock);
     list->_list->set_reading(true); {
         /* Find a matching entry */
         async_list<plcrash_async_image_t *>::node *found = NULL;
@@ -141,12 +629,484 @@ void plcrash_nasync_image_list_remove (plcrash_async_image_list_t *list, pl_vm_a
         if (found == NULL) {
             PLCF_DEBUG("Can't find header addr=%llu in Mach-O image list.", (uint64_t)header);
             list->_list->set_reading(false);
+            pthread_mutex_unlock(&list->_journal_lock);
             return;
         }
 
         /* Delete the entry */
         list->_list->nasync_remove_node(found);
+
+        /* Discard the _sigtramp range if it was found within the removed image */
+        if (list->_sigtramp_image == header) {
+            list->_sigtramp_start = 0;
+            OSMemoryBarrier();
+            list->_sigtramp_image = 0;
+        }
+
+        /* Evict the image from the unwind context before the node may be reclaimed. This waits for any stack
+         * walk currently using the context. */
+        plcrash_async_image_unwind_context_t *context = list->_unwind_context;
+        if (context != NULL) {
+            pthread_mutex_lock(&context->lock);
+            plcrash_async_macho_section_cache_evict(&context->section_cache, &found->value()->macho_image);
+#if PLCRASH_FEATURE_UNWIND_DWARF
+            if (context->dwarf_cie_cache != NULL)
+                plframe_dwarf_cie_cache_reset(context->dwarf_cie_cache);
+#endif
+            pthread_mutex_unlock(&context->lock);
+        }
+    } list->_list->set_reading(false);
+
+    if (list->_journal != NULL)
+        plcrash_nasync_image_journal_remove(list->_journal, header);
+    pthread_mutex_unlock(&list->_journal_lock);
+
+    /* Our own read prevented reclamation of the removed node */
+    list->_list->nasync_reclaim();
+
+    plcrash_nasync_image_list_reindex(list);
+}
+
+/**
+ * Enable symbol address indexing for all images in @a list. Symbol indices are built immediately for all
+ * images currently in the list, as well as for any images appended to the list in the future. This
+ * allows async-safe symbol lookups via plcrash_async_macho_find_symbol_by_pc() to perform a binary search,
+ * at the cost of additional memory and the non-async-safe work required to build the indices.
+ *
+ * @param list The list for which symbol indexing should be enabled.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_index_symbols (plcrash_async_image_list_t *list) {
+    /* Enable indexing of any newly appended images */
+    list->_index_symbols = true;
+    OSMemoryBarrier();
+
+    /* Index all current images. Images being concurrently appended may be indexed twice, but only one index
+     * will be published. */
+    list->_list->set_reading(true); {
+        async_list<plcrash_async_image_t *>::node *next = NULL;
+        while ((next = list->_list->next(next)) != NULL)
+            plcrash_nasync_image_index_symbols(next->value());
+    } list->_list->set_reading(false);
+}
+
+/**
+ * Build a sorted DWARF FDE index (see plcrash_nasync_dwarf_fde_index_build()) for every image in @a list for which
+ * the DWARF unwinder has requested one. An index is requested the first time an FDE lookup within an image requires a
+ * linear scan of the image's DWARF data; once built, subsequent lookups, including those performed at crash time,
+ * are performed via binary search.
+ *
+ * This should be called after live or sampled stack walks, outside of crash time. If indices are concurrently being
+ * built by another thread, this function returns immediately; that thread will build any pending indices.
+ *
+ * @param list The list for which requested indices should be built.
+ *
+ * @return Returns the number of bytes allocated for the indices built by this call.
+ *
+ * @warning This method is not async safe.
+ */
+size_t plcrash_nasync_image_list_index_dwarf (plcrash_async_image_list_t *list) {
+    size_t total = 0;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /* A request must only be claimed by a single builder */
+    if (pthread_mutex_trylock(&list->_dwarf_index_lock) != 0)
+        return 0;
+
+    list->_list->set_reading(true); {
+        async_list<plcrash_async_image_t *>::node *next = NULL;
+        while ((next = list->_list->next(next)) != NULL) {
+            plcrash_async_macho_t *image = &next->value()->macho_image;
+            plcrash_error_t ret;
+            size_t bytes;
+
+            if (!image->dwarf_fde_index_requested)
+                continue;
+
+            /* Only a single attempt is made; a failed build will fail again */
+            image->dwarf_fde_index_requested = false;
+            uint64_t start = mach_absolute_time();
+            if ((ret = plcrash_nasync_dwarf_fde_index_build(image, &bytes)) == PLCRASH_ESUCCESS) {
+                plcrash_nasync_image_record_index(next->value(), start, bytes);
+                total += bytes;
+            } else
+                PLCF_DEBUG("Failed to build FDE index for %s: %d", image->name, ret);
+        }
+    } list->_list->set_reading(false);
+
+    pthread_mutex_unlock(&list->_dwarf_index_lock);
+
+    /* New indices are persisted by the warmup thread */
+    if (total > 0 && list->_index_store != NULL)
+        plcrash_nasync_image_list_request_warmup(list);
+#endif
+
+    return total;
+}
+
+/**
+ * Configure the record encoder used to pre-encode the crash report record of every image subsequently appended
+ * to @a list. Images already present in the list are not encoded, and their records will instead be encoded at
+ * crash time; the encoder should be configured prior to registering any images.
+ *
+ * @param list The list for which record encoding should be enabled.
+ * @param encoder The record encoder, or NULL to disable record encoding for newly appended images.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_set_record_encoder (plcrash_async_image_list_t *list, plcrash_async_image_record_encoder_t encoder) {
+    list->_record_encoder = encoder;
+    OSMemoryBarrier();
+}
+
+/**
+ * Enable or disable compact initialization of the images subsequently appended to @a list. Compact images copy
+ * their load commands into a contiguous arena shared by the list, rather than each holding a separate VM mapping,
+ * and borrow the name passed to plcrash_nasync_image_list_append() rather than copying it. Images already present
+ * in the list are not affected.
+ *
+ * When enabled, the names passed to plcrash_nasync_image_list_append() and plcrash_nasync_image_list_append_all()
+ * must remain valid for as long as the image remains in @a list.
+ *
+ * @param list The list for which compact mode should be configured.
+ * @param enable If true, newly appended images will be initialized via plcrash_nasync_macho_init_compact().
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_set_compact (plcrash_async_image_list_t *list, bool enable) {
+    list->_compact = enable;
+    OSMemoryBarrier();
+}
+
+/**
+ * Mirror all appends to and removals from @a list to @a journal. ADD records are written immediately for all images
+ * currently in the list; list updates are serialized with their journal records, and so the journal never records
+ * an image that has already been removed from the list.
+ *
+ * @param list The list to be journaled.
+ * @param journal The journal to which records will be appended. The journal must remain valid for the lifetime
+ * of @a list; once set, the journal may not be changed.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_set_journal (plcrash_async_image_list_t *list, plcrash_async_image_journal_t *journal) {
+    pthread_mutex_lock(&list->_journal_lock); {
+        PLCF_ASSERT(list->_journal == NULL);
+        list->_journal = journal;
+
+        list->_list->set_reading(true); {
+            async_list<plcrash_async_image_t *>::node *next = NULL;
+            while ((next = list->_list->next(next)) != NULL)
+                plcrash_nasync_image_journal_add(journal, &next->value()->macho_image);
+        } list->_list->set_reading(false);
+    } pthread_mutex_unlock(&list->_journal_lock);
+}
+
+/**
+ * Locate the task's dyld shared cache, and map the LINKEDIT region shared by all images loaded from the cache. The
+ * mapping is then attached to all cached images in @a list, including those appended subsequently, allowing their
+ * symbol tables to be read through a single mapping that is reused across frames, threads and reports, rather than
+ * mapping each image's __LINKEDIT segment on every lookup.
+ *
+ * Calling this function more than once has no further effect.
+ *
+ * @param list The list for which the shared cache should be mapped.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the task's shared cache could not be found or mapped. On
+ * failure, images will continue to map their own __LINKEDIT segments.
+ *
+ * @warning This method is not async safe, and must not be called concurrently with other list writers.
+ */
+plcrash_error_t plcrash_nasync_image_list_map_shared_cache (plcrash_async_image_list_t *list) {
+    plcrash_error_t err;
+
+    if (list->_shared_cache_mapped)
+        return PLCRASH_ESUCCESS;
+
+    if ((err = plcrash_async_shared_cache_init(&list->_shared_cache, list->task)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not locate the dyld shared cache: %d", err);
+        return err;
+    }
+
+    if ((err = plcrash_nasync_shared_cache_map_linkedit(&list->_shared_cache, list->task, &list->_shared_linkedit)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not map the dyld shared cache LINKEDIT region: %d", err);
+        return err;
+    }
+
+    /* Publish the mapping before attaching it to any images */
+    OSMemoryBarrier();
+    list->_shared_cache_mapped = true;
+
+    list->_list->set_reading(true); {
+        async_list<plcrash_async_image_t *>::node *next = NULL;
+        while ((next = list->_list->next(next)) != NULL)
+            plcrash_nasync_image_attach_shared_cache(list, next->value());
+    } list->_list->set_reading(false);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return the dyld shared cache located by plcrash_nasync_image_list_map_shared_cache(), or NULL if the shared cache
+ * has not been mapped.
+ *
+ * @param list The list to query.
+ *
+ * @warning This method is async-safe.
+ */
+plcrash_async_shared_cache_t *plcrash_async_image_list_get_shared_cache (plcrash_async_image_list_t *list) {
+    if (!list->_shared_cache_mapped)
+        return NULL;
+
+    return &list->_shared_cache;
+}
+
+/*
+ * Return true if @a image's indices should be persisted to @a list's index store. Images loaded from the dyld shared
+ * cache are updated along with the OS, and are shared by every process; only the process' own images are stored.
+ */
+static bool plcrash_nasync_image_should_store (plcrash_async_image_list_t *list, plcrash_async_image_t *image) {
+    if (list->_index_store == NULL)
+        return false;
+
+    /* Without a mapped shared cache, cached images are identified by the header flag set by newer releases of dyld */
+    plcrash_async_shared_cache_t unmapped = {};
+    plcrash_async_shared_cache_t *cache = list->_shared_cache_mapped ? &list->_shared_cache : &unmapped;
+    return !plcrash_async_shared_cache_contains_image(cache, &image->macho_image);
+}
+
+/*
+ * Load @a image's stored indices from @a list's index store. Returns the number of bytes mapped for the loaded
+ * indices, or 0 if none were loaded.
+ */
+static size_t plcrash_nasync_image_load_indices (plcrash_async_image_list_t *list, plcrash_async_image_t *image) {
+    uint64_t start = mach_absolute_time();
+    plcrash_error_t ret;
+    size_t bytes;
+
+    if ((ret = plcrash_nasync_image_index_store_load(list->_index_store, &image->macho_image, &image->_stored_indices, &bytes)) != PLCRASH_ESUCCESS) {
+        if (ret != PLCRASH_ENOTFOUND && ret != PLCRASH_ENOTSUP)
+            PLCF_DEBUG("Failed to load stored indices for %s: %d", image->macho_image.name, ret);
+        return 0;
+    }
+
+    plcrash_nasync_image_record_index(image, start, bytes);
+    return bytes;
+}
+
+/*
+ * Write @a image's indices to @a list's index store, if any have been built since they were last loaded or stored.
+ */
+static void plcrash_nasync_image_store_indices (plcrash_async_image_list_t *list, plcrash_async_image_t *image) {
+    uint32_t available = plcrash_nasync_image_index_store_available(&image->macho_image);
+    if ((available & ~image->_stored_indices) == 0)
+        return;
+
+    plcrash_error_t ret;
+    uint32_t stored;
+    if ((ret = plcrash_nasync_image_index_store_save(list->_index_store, &image->macho_image, &stored)) == PLCRASH_ESUCCESS) {
+        image->_stored_indices = stored;
+    } else {
+        if (ret != PLCRASH_ENOTSUP)
+            PLCF_DEBUG("Failed to store indices for %s: %d", image->macho_image.name, ret);
+
+        /* A failed write is not retried until further indices are built */
+        image->_stored_indices |= available;
+    }
+}
+
+/*
+ * Perform a single warmup pass over all images in @a list that have not yet been warmed. If an index store is
+ * configured, each image's stored indices are loaded before any index is built, and any indices built since the
+ * image was last stored -- including DWARF FDE indices built by plcrash_nasync_image_list_index_dwarf() -- are
+ * written back.
+ */
+static void plcrash_nasync_image_list_warm (plcrash_async_image_list_t *list) {
+    plcrash_async_image_warmup_t *warmup = list->_warmup;
+
+    list->_list->set_reading(true); {
+        async_list<plcrash_async_image_t *>::node *next = NULL;
+        while ((next = list->_list->next(next)) != NULL) {
+            plcrash_async_image_t *image = next->value();
+            bool store = plcrash_nasync_image_should_store(list, image);
+            plcrash_error_t ret;
+
+            if (image->_warmed || warmup->used >= warmup->budget) {
+                if (store && image->_warmed)
+                    plcrash_nasync_image_store_indices(list, image);
+                continue;
+            }
+
+            /* Stored indices are mapped in place of building them */
+            if (store)
+                warmup->used += plcrash_nasync_image_load_indices(list, image);
+
+            /* The budget is checked prior to building each index; a single index may exceed the remaining budget. */
+            if (warmup->symbols)
+                warmup->used += plcrash_nasync_image_index_symbols(image);
+
+            if (warmup->objc && warmup->used < warmup->budget) {
+                uint64_t start = mach_absolute_time();
+                size_t bytes;
+                ret = plcrash_nasync_objc_index_image(&image->macho_image, &bytes);
+                if (ret == PLCRASH_ESUCCESS) {
+                    plcrash_nasync_image_record_index(image, start, bytes);
+                    warmup->used += bytes;
+                }
+                else if (ret != PLCRASH_ENOTFOUND)
+                    PLCF_DEBUG("Failed to build ObjC index for %s: %d", image->macho_image.name, ret);
+            }
+
+            image->_warmed = true;
+
+            if (store)
+                plcrash_nasync_image_store_indices(list, image);
+        }
     } list->_list->set_reading(false);
+
+    if (warmup->used >= warmup->budget)
+        PLCF_DEBUG("Index warmup budget of %zu bytes exhausted; remaining images will be indexed on demand", warmup->budget);
+}
+
+/* Background warmup thread entry point. */
+static void *plcrash_nasync_image_list_warmup_thread (void *ctx) {
+    plcrash_async_image_list_t *list = (plcrash_async_image_list_t *) ctx;
+    plcrash_async_image_warmup_t *warmup = list->_warmup;
+
+    /* Run at the lowest available priority; failure is non-fatal. */
+    struct sched_param param;
+    int policy;
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0) {
+        param.sched_priority = sched_get_priority_min(policy);
+        pthread_setschedparam(pthread_self(), policy, &param);
+    }
+
+    pthread_mutex_lock(&warmup->lock);
+    while (!warmup->stop) {
+        if (warmup->completed == warmup->requested) {
+            pthread_cond_wait(&warmup->cond, &warmup->lock);
+            continue;
+        }
+
+        uint64_t generation = warmup->requested;
+        pthread_mutex_unlock(&warmup->lock);
+
+        plcrash_nasync_image_list_warm(list);
+
+        pthread_mutex_lock(&warmup->lock);
+        warmup->completed = generation;
+        pthread_cond_broadcast(&warmup->cond);
+    }
+    pthread_mutex_unlock(&warmup->lock);
+
+    return NULL;
+}
+
+/**
+ * Persist the indices built by @a list's background warmup to the index store at @a path, keyed by image LC_UUID. On
+ * subsequent launches, the stored indices of each image are mapped by the warmup thread in place of building them;
+ * see plcrash_async_image_index_store. Only images outside of the dyld shared cache are stored.
+ *
+ * @param list The list for which indices should be persisted.
+ * @param path The store directory. The directory must already exist.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if warmup has already been enabled or a store has
+ * already been configured, or PLCRASH_ENOMEM if allocation fails.
+ *
+ * @warning This method is not async safe, and must be called prior to plcrash_nasync_image_list_start_warmup().
+ */
+plcrash_error_t plcrash_nasync_image_list_set_index_store (plcrash_async_image_list_t *list, const char *path) {
+    if (list->_warmup != NULL || list->_index_store != NULL)
+        return PLCRASH_EINVAL;
+
+    plcrash_async_image_index_store_t *store = (plcrash_async_image_index_store_t *) malloc(sizeof(*store));
+    if (store == NULL)
+        return PLCRASH_ENOMEM;
+
+    plcrash_error_t err;
+    if ((err = plcrash_nasync_image_index_store_init(store, path)) != PLCRASH_ESUCCESS) {
+        free(store);
+        return err;
+    }
+
+    list->_index_store = store;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Enable background index warmup for @a list. A low-priority thread will be spawned to build the symbol and/or
+ * Objective-C IMP indices for all images currently in the list, as well as for any images appended to the list
+ * in the future. This moves the non-async-safe cost of parsing the images' symbol tables and ObjC metadata out
+ * of crash time, at the cost of the memory required for the indices.
+ *
+ * Indexing halts once @a budget bytes have been allocated for indices; images that are not indexed will continue
+ * to be searched on demand.
+ *
+ * @param list The list for which warmup should be enabled.
+ * @param budget The maximum number of bytes to be allocated for indices. The budget is checked prior to building
+ * each index, and may be exceeded by a single index.
+ * @param symbols If true, symbol indices will be built (see plcrash_nasync_macho_index_symbols()).
+ * @param objc If true, Objective-C IMP indices will be built (see plcrash_nasync_objc_index_image()).
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if warmup has already been enabled, or another
+ * error if the warmup thread could not be started.
+ *
+ * @warning This method is not async safe, and must not be called concurrently with other list modifications.
+ */
+plcrash_error_t plcrash_nasync_image_list_start_warmup (plcrash_async_image_list_t *list, size_t budget, bool symbols, bool objc) {
+    if (list->_warmup != NULL)
+        return PLCRASH_EINVAL;
+
+    plcrash_async_image_warmup_t *warmup = (plcrash_async_image_warmup_t *) calloc(1, sizeof(*warmup));
+    if (warmup == NULL)
+        return PLCRASH_ENOMEM;
+
+    pthread_mutex_init(&warmup->lock, NULL);
+    pthread_cond_init(&warmup->cond, NULL);
+    warmup->budget = budget;
+    warmup->symbols = symbols;
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+    warmup->objc = objc;
+#else
+    warmup->objc = false;
+#endif
+
+    /* Request an initial pass over the current images */
+    warmup->requested = 1;
+    list->_warmup = warmup;
+
+    int perr;
+    if ((perr = pthread_create(&warmup->thread, NULL, plcrash_nasync_image_list_warmup_thread, list)) != 0) {
+        PLCF_DEBUG("Failed to start the index warmup thread: %s", strerror(perr));
+        list->_warmup = NULL;
+        pthread_cond_destroy(&warmup->cond);
+        pthread_mutex_destroy(&warmup->lock);
+        free(warmup);
+        return PLCRASH_EINTERNAL;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Block until the background warmup thread has processed all images appended to @a list prior to this call. If
+ * warmup has not been enabled, returns immediately.
+ *
+ * @param list The list for which to wait.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_wait_warmup (plcrash_async_image_list_t *list) {
+    plcrash_async_image_warmup_t *warmup = list->_warmup;
+    if (warmup == NULL)
+        return;
+
+    pthread_mutex_lock(&warmup->lock);
+    uint64_t target = warmup->requested;
+    while (warmup->completed < target && !warmup->stop)
+        pthread_cond_wait(&warmup->cond, &warmup->lock);
+    pthread_mutex_unlock(&warmup->lock);
 }
 
 /**
@@ -158,7 +1118,210 @@ void plcrash_nasync_image_list_remove (plcrash_async_image_list_t *list, pl_vm_a
  * @param enable If true, the list will be retained. If false, released.
  */
 void plcrash_async_image_list_set_reading (plcrash_async_image_list_t *list, bool enable) {
-    list->_list->set_reading(enable);
+    if (enable) {
+        OSAtomicIncrement32Barrier(&list->_index_refcount);
+        list->_list->set_reading(true);
+    } else {
+        list->_list->set_reading(false);
+        OSAtomicDecrement32Barrier(&list->_index_refcount);
+    }
+}
+
+/**
+ * Return the list's current address-sorted image index, or NULL if the list is empty. This method is async-safe.
+ *
+ * The returned index is immutable, and remains valid until the list is released for reading, even if the list is
+ * modified; callers that require a consistent view of the images across multiple lookups should fetch the index
+ * once, rather than re-fetching it for each lookup.
+ *
+ * @param list The list from which the index will be fetched.
+ *
+ * @warning The list must be retained for reading via plcrash_async_image_list_set_reading() before calling this function.
+ */
+plcrash_async_image_index_t *plcrash_async_image_list_get_index (plcrash_async_image_list_t *list) {
+    return list->_index;
+}
+
+/**
+ * Fetch the address range of the _sigtramp signal trampoline, if the image containing the trampoline has been added
+ * to @a list. This method is async-safe.
+ *
+ * @param list The list to be queried.
+ * @param start On success, the trampoline's start address.
+ * @param end On success, the trampoline's end address (exclusive).
+ *
+ * @return Returns true if the trampoline's range is known, or false otherwise.
+ */
+bool plcrash_async_image_list_get_sigtramp (plcrash_async_image_list_t *list, pl_vm_address_t *start, pl_vm_address_t *end) {
+    pl_vm_address_t found = list->_sigtramp_start;
+    if (found == 0)
+        return false;
+
+    OSMemoryBarrier();
+    *start = found;
+    *end = list->_sigtramp_end;
+    return true;
+}
+
+/**
+ * Return the number of images currently in @a list. This method is async-safe.
+ *
+ * @param list The list to be counted.
+ */
+size_t plcrash_async_image_list_count (plcrash_async_image_list_t *list) {
+    size_t count = 0;
+
+    plcrash_async_image_list_set_reading(list, true); {
+        plcrash_async_image_index_t *index = plcrash_async_image_list_get_index(list);
+        if (index != NULL)
+            count = index->count;
+    } plcrash_async_image_list_set_reading(list, false);
+
+    return count;
+}
+
+/**
+ * Acquire @a list's persistent section cache for use in a stack walk. Unlike a cache initialized for a single walk,
+ * the returned cache retains its section mappings and parsed DWARF CIEs across walks, avoiding the cost of
+ * re-mapping and re-parsing the unwind data of the same images for every sample or live report. Entries
+ * referencing an image are evicted when the image is removed from @a list.
+ *
+ * The cache is shared by all users of @a list; if it is in use by another thread, NULL is returned and the
+ * caller should fall back on a cache of its own. Acquisition never blocks, allowing callers to safely acquire
+ * the cache while another thread -- which may hold the cache -- is suspended.
+ *
+ * The caller must hold @a list for reading (see plcrash_async_image_list_set_reading()) while using the cache, and
+ * must release the cache via plcrash_nasync_image_list_release_unwind_cache().
+ *
+ * @param list The list for which the cache should be acquired.
+ *
+ * @return Returns the cache, or NULL if the cache is unavailable.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_async_macho_section_cache_t *plcrash_nasync_image_list_acquire_unwind_cache (plcrash_async_image_list_t *list) {
+    plcrash_async_image_unwind_context_t *context = list->_unwind_context;
+
+    /* Create the context on first use */
+    if (context == NULL) {
+        context = new plcrash_async_image_unwind_context_t;
+        if (context == NULL)
+            return NULL;
+
+        pthread_mutex_init(&context->lock, NULL);
+        plcrash_async_macho_section_cache_init(&context->section_cache);
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        if (plframe_dwarf_cie_cache_new(&context->dwarf_cie_cache) != PLCRASH_ESUCCESS)
+            context->dwarf_cie_cache = NULL;
+        context->section_cache.dwarf_cie_cache = context->dwarf_cie_cache;
+#endif
+
+        /* Another thread may have won the race to publish its context */
+        if (!OSAtomicCompareAndSwapPtrBarrier(NULL, context, (void * volatile *) &list->_unwind_context)) {
+#if PLCRASH_FEATURE_UNWIND_DWARF
+            if (context->dwarf_cie_cache != NULL)
+                plframe_dwarf_cie_cache_free(context->dwarf_cie_cache);
+#endif
+            pthread_mutex_destroy(&context->lock);
+            delete context;
+            context = list->_unwind_context;
+        }
+    }
+
+    if (pthread_mutex_trylock(&context->lock) != 0)
+        return NULL;
+
+    return &context->section_cache;
+}
+
+/**
+ * Release a cache acquired via plcrash_nasync_image_list_acquire_unwind_cache().
+ *
+ * @param list The list from which @a cache was acquired.
+ * @param cache The cache to be released. All memory objects mapped via the cache must have been released.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_release_unwind_cache (plcrash_async_image_list_t *list, plcrash_async_macho_section_cache_t *cache) {
+    plcrash_async_image_unwind_context_t *context = list->_unwind_context;
+    PLCF_ASSERT(cache == &context->section_cache);
+
+    /* The work budget is borrowed for the duration of a single walk */
+    cache->work_budget = NULL;
+    pthread_mutex_unlock(&context->lock);
+}
+
+/**
+ * Fetch the resource usage of @a list.
+ *
+ * @param list The list to be measured.
+ * @param stats[out] On return, the list's resource usage.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_image_list_get_stats (plcrash_async_image_list_t *list, plcrash_async_image_list_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    list->_list->set_reading(true); {
+        async_list<plcrash_async_image_t *>::node *next = NULL;
+        while ((next = list->_list->next(next)) != NULL) {
+            plcrash_async_image_t *image = next->value();
+
+            stats->image_count++;
+            stats->index_bytes += (size_t) image->index_bytes;
+            stats->index_time += (uint64_t) image->index_time;
+
+            stats->footprint += sizeof(*image) + image->record_length + (size_t) image->index_bytes;
+            if (!image->macho_image.compact)
+                stats->footprint += image->macho_image.name_length + 1 + (size_t) image->macho_image.load_cmds.vm_length;
+        }
+
+        plcrash_async_image_index_t *index = list->_index;
+        if (index != NULL)
+            stats->footprint += sizeof(*index) + (sizeof(index->images[0]) * index->count);
+    } list->_list->set_reading(false);
+
+    OSSpinLockLock(&list->_cmd_arena_lock); {
+        stats->footprint += plcrash_nasync_macho_cmd_arena_size(&list->_cmd_arena);
+    } OSSpinLockUnlock(&list->_cmd_arena_lock);
+
+    if (list->_warmup != NULL) {
+        stats->warmup_budget = list->_warmup->budget;
+        stats->warmup_used = list->_warmup->used;
+    }
+}
+
+/**
+ * Find the position within @a index of the image containing the given @a address within its TEXT segment.
+ * This method is async-safe.
+ *
+ * @param index The index to be searched.
+ * @param address The address to be searched for.
+ * @param position On success, the position of the containing image within @a index.
+ *
+ * @return Returns true if a containing image was found, or false otherwise.
+ */
+bool plcrash_async_image_index_find (plcrash_async_image_index_t *index, pl_vm_address_t address, size_t *position) {
+    /* Binary search the sorted index for the last image with a header address <= address */
+    size_t low = 0;
+    size_t high = index->count;
+    while (low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if (index->images[mid]->macho_image.header_addr <= address)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == 0)
+        return false;
+
+    plcrash_async_image_t *image = index->images[low - 1];
+    if (address >= image->macho_image.header_addr + image->macho_image.text_size)
+        return false;
+
+    *position = low - 1;
+    return true;
 }
 
 /**
@@ -171,6 +1334,16 @@ void plcrash_async_image_list_set_reading (plcrash_async_image_list_t *list, boo
  * @warning The list must be retained for reading via plcrash_async_image_list_set_reading() before calling this function.
  */
 plcrash_async_image_t *plcrash_async_image_containing_address (plcrash_async_image_list_t *list, pl_vm_address_t address) {
+    plcrash_async_image_index_t *index = list->_index;
+    if (index != NULL) {
+        size_t position;
+        if (plcrash_async_image_index_find(index, address, &position))
+            return index->images[position];
+
+        return NULL;
+    }
+
+    /* No index is available; fall back to a linear search */
     plcrash_async_image_t *image = NULL;
     while ((image = plcrash_async_image_list_next(list, image)) != NULL) {
         if (address >= image->macho_image.header_addr && address < image->macho_image.header_addr + image->macho_image.text_size) {
@@ -38,6 +38,9 @@ extern "C" {
 #include <stdbool.h>
 
 #include "PLCrashAsyncMachOImage.h"
+#include "PLCrashAsyncSharedCache.h"
+#include "PLCrashAsyncImageJournal.h"
+#include "PLCrashAsyncImageIndexStore.h"
 
 /*
  * NOTE: We keep this code C-compatible for backwards-compatibility purposes. If the entirity
@@ -49,6 +52,26 @@ extern "C" {
 #endif
     
 typedef struct plcrash_async_image plcrash_async_image_t;
+typedef struct plcrash_async_image_index plcrash_async_image_index_t;
+typedef struct plcrash_async_image_warmup plcrash_async_image_warmup_t;
+typedef struct plcrash_async_image_arena plcrash_async_image_arena_t;
+typedef struct plcrash_async_image_unwind_context plcrash_async_image_unwind_context_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ *
+ * Image record encoder. Used to pre-encode an image's crash report record at the time the image is appended
+ * to an image list, allowing the record to be copied directly to the crash report output at crash time. See
+ * plcrash_nasync_image_list_set_record_encoder().
+ *
+ * @param image The image to be encoded.
+ * @param buffer The output buffer, or NULL if only the encoded size should be computed.
+ * @param length The size of @a buffer, in bytes. Ignored if @a buffer is NULL.
+ *
+ * @return Returns the encoded size, in bytes, or 0 if the image could not be encoded.
+ */
+typedef size_t (*plcrash_async_image_record_encoder_t) (plcrash_async_macho_t *image, void *buffer, size_t length);
 
 /**
  * @internal
@@ -66,6 +89,74 @@ struct plcrash_async_image {
 #else
     void *_node;
 #endif
+
+    /** If true, the image has been visited by the list's background warmup thread. Only accessed by that thread. */
+    bool _warmed;
+
+    /** If true, the image was allocated within a bulk registration arena, and must not be individually freed. */
+    bool _arena_allocated;
+
+    /** The indices stored for the image in the list's index store, as a bitwise OR of
+     * plcrash_async_image_index_store_index_t values. Only accessed by the list's background warmup thread. */
+    uint32_t _stored_indices;
+
+    /** The image's pre-encoded crash report record, or NULL if no record encoder was configured. */
+    void *record;
+
+    /** The size of @a record, in bytes. */
+    size_t record_length;
+
+    /** Time spent building the image's symbol, Objective-C and DWARF indices via the list, in mach_absolute_time()
+     * units. See plcrash_nasync_image_list_get_stats(). */
+    volatile int64_t index_time;
+
+    /** The number of bytes allocated for the indices counted by @a index_time. */
+    volatile int64_t index_bytes;
+};
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ *
+ * Image list resource usage; see plcrash_nasync_image_list_get_stats().
+ */
+typedef struct plcrash_async_image_list_stats {
+    /** The number of images in the list. */
+    size_t image_count;
+
+    /** The estimated heap and VM footprint of the list, in bytes, including image records, pre-encoded crash report
+     * records, load command copies and mappings, and the indices counted by @a index_bytes. */
+    size_t footprint;
+
+    /** The number of bytes allocated for image indices built via the list. */
+    size_t index_bytes;
+
+    /** The total time spent building image indices via the list, in mach_absolute_time() units. */
+    uint64_t index_time;
+
+    /** The background index warmup budget, in bytes, or 0 if warmup is disabled. */
+    size_t warmup_budget;
+
+    /** The number of bytes of @a warmup_budget that have been consumed. */
+    size_t warmup_used;
+} plcrash_async_image_list_stats_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_image
+ *
+ * Immutable, address-sorted image index. A new index is allocated and atomically published on every list
+ * update, allowing async-safe readers to perform a binary search over the images' TEXT ranges.
+ */
+struct plcrash_async_image_index {
+    /** The number of images in @a images. */
+    size_t count;
+
+    /** A retired index pending deallocation, or NULL. Only used by writers. */
+    plcrash_async_image_index_t *_next_retired;
+
+    /** The images, sorted by ascending header address. */
+    plcrash_async_image_t *images[];
 };
 
 /**
@@ -85,16 +176,102 @@ typedef struct plcrash_async_image_list {
 #else
     void *_list;
 #endif
+
+    /** The current address-sorted image index, or NULL if the list is empty. */
+    plcrash_async_image_index_t * volatile _index;
+
+    /** The number of active readers of @a _index. */
+    volatile int32_t _index_refcount;
+
+    /** Replaced indices that may still be referenced by a reader, pending deallocation. */
+    plcrash_async_image_index_t *_retired_index;
+
+    /** Index write lock. */
+    OSSpinLock _index_lock;
+
+    /** If true, a symbol address index will be built for each image as it is appended. */
+    volatile bool _index_symbols;
+
+    /** The record encoder applied to newly appended images, or NULL. See plcrash_nasync_image_list_set_record_encoder(). */
+    plcrash_async_image_record_encoder_t _record_encoder;
+
+    /** Background index warmup state, or NULL if warmup has not been enabled. See plcrash_nasync_image_list_start_warmup(). */
+    plcrash_async_image_warmup_t *_warmup;
+
+    /** The store to which warmed indices are persisted, or NULL. See plcrash_nasync_image_list_set_index_store(). */
+    plcrash_async_image_index_store_t *_index_store;
+
+    /** Image arenas allocated by plcrash_nasync_image_list_append_all(), or NULL. */
+    plcrash_async_image_arena_t *_arenas;
+
+    /** If true, newly appended images are initialized in compact mode. See plcrash_nasync_image_list_set_compact(). */
+    volatile bool _compact;
+
+    /** The load command arena shared by compact images. */
+    plcrash_async_macho_cmd_arena_t _cmd_arena;
+
+    /** Load command arena lock. */
+    OSSpinLock _cmd_arena_lock;
+
+    /** If true, @a _shared_cache and @a _shared_linkedit are valid. See plcrash_nasync_image_list_map_shared_cache(). */
+    volatile bool _shared_cache_mapped;
+
+    /** The task's dyld shared cache. */
+    plcrash_async_shared_cache_t _shared_cache;
+
+    /** The shared cache's LINKEDIT region, shared by all cached images in the list. */
+    plcrash_async_mobject_t _shared_linkedit;
+
+    /** The journal to which image appends and removals are mirrored, or NULL. See plcrash_nasync_image_list_set_journal(). */
+    plcrash_async_image_journal_t * volatile _journal;
+
+    /** Serializes list updates with their journal records. */
+    pthread_mutex_t _journal_lock;
+
+    /** Held while building DWARF FDE indices. See plcrash_nasync_image_list_index_dwarf(). */
+    pthread_mutex_t _dwarf_index_lock;
+
+    /** The persistent unwind context, or NULL if not yet used. See plcrash_nasync_image_list_acquire_unwind_cache(). */
+    plcrash_async_image_unwind_context_t * volatile _unwind_context;
+
+    /** The header address of the image containing the _sigtramp signal trampoline, or 0 if not found. */
+    pl_vm_address_t _sigtramp_image;
+
+    /** The start address of _sigtramp, or 0 if not found. See plcrash_async_image_list_get_sigtramp(). */
+    volatile pl_vm_address_t _sigtramp_start;
+
+    /** The end address (exclusive) of _sigtramp. Only valid if @a _sigtramp_start is non-zero. */
+    volatile pl_vm_address_t _sigtramp_end;
 } plcrash_async_image_list_t;
 
 void plcrash_nasync_image_list_init (plcrash_async_image_list_t *list, mach_port_t task);
 void plcrash_nasync_image_list_free (plcrash_async_image_list_t *list);
 void plcrash_nasync_image_list_append (plcrash_async_image_list_t *list, pl_vm_address_t header, const char *name);
+void plcrash_nasync_image_list_append_all (plcrash_async_image_list_t *list, const pl_vm_address_t *headers, const char * const *names, size_t count);
+bool plcrash_nasync_image_list_contains (plcrash_async_image_list_t *list, pl_vm_address_t header);
 void plcrash_nasync_image_list_remove (plcrash_async_image_list_t *list, pl_vm_address_t header);
+void plcrash_nasync_image_list_index_symbols (plcrash_async_image_list_t *list);
+size_t plcrash_nasync_image_list_index_dwarf (plcrash_async_image_list_t *list);
+void plcrash_nasync_image_list_set_record_encoder (plcrash_async_image_list_t *list, plcrash_async_image_record_encoder_t encoder);
+void plcrash_nasync_image_list_set_compact (plcrash_async_image_list_t *list, bool enable);
+void plcrash_nasync_image_list_set_journal (plcrash_async_image_list_t *list, plcrash_async_image_journal_t *journal);
+plcrash_error_t plcrash_nasync_image_list_map_shared_cache (plcrash_async_image_list_t *list);
+plcrash_async_shared_cache_t *plcrash_async_image_list_get_shared_cache (plcrash_async_image_list_t *list);
+plcrash_error_t plcrash_nasync_image_list_set_index_store (plcrash_async_image_list_t *list, const char *path);
+plcrash_error_t plcrash_nasync_image_list_start_warmup (plcrash_async_image_list_t *list, size_t budget, bool symbols, bool objc);
+void plcrash_nasync_image_list_wait_warmup (plcrash_async_image_list_t *list);
 
 void plcrash_async_image_list_set_reading (plcrash_async_image_list_t *list, bool enable);
 
 plcrash_async_image_t *plcrash_async_image_containing_address (plcrash_async_image_list_t *list, pl_vm_address_t address);
+plcrash_async_image_index_t *plcrash_async_image_list_get_index (plcrash_async_image_list_t *list);
+size_t plcrash_async_image_list_count (plcrash_async_image_list_t *list);
+bool plcrash_async_image_list_get_sigtramp (plcrash_async_image_list_t *list, pl_vm_address_t *start, pl_vm_address_t *end);
+plcrash_async_macho_section_cache_t *plcrash_nasync_image_list_acquire_unwind_cache (plcrash_async_image_list_t *list);
+void plcrash_nasync_image_list_release_unwind_cache (plcrash_async_image_list_t *list, plcrash_async_macho_section_cache_t *cache);
+
+void plcrash_nasync_image_list_get_stats (plcrash_async_image_list_t *list, plcrash_async_image_list_stats_t *stats);
+bool plcrash_async_image_index_find (plcrash_async_image_index_t *index, pl_vm_address_t address, size_t *position);
 plcrash_async_image_t *plcrash_async_image_list_next (plcrash_async_image_list_t *list, plcrash_async_image_t *current);
     
 #ifdef __cplusplus
@@ -29,6 +29,7 @@
 #import "GTMSenTestCase.h"
 
 #import "PLCrashAsyncImageList.h"
+#import "PLCrashAsyncObjCSection.h"
 
 #import <mach-o/dyld.h>
 
@@ -93,6 +94,178 @@
 
 
 /* Test removing the last image in the list. */
+- (void) testAppendAllImages {
+    uint32_t count = _dyld_image_count();
+    STAssertTrue(count >= 5, @"We need at least five Mach-O images for this test. This should not be a problem on a modern system.");
+
+    pl_vm_address_t headers[5];
+    const char *names[5];
+    for (uint32_t i = 0; i < 5; i++) {
+        headers[i] = (pl_vm_address_t) _dyld_get_image_header(i);
+        names[i] = _dyld_get_image_name(i);
+    }
+
+    plcrash_nasync_image_list_append_all(&_list, headers, names, 5);
+
+    /* Verify the appended elements, in order */
+    plcrash_async_image_t *item = NULL;
+    plcrash_async_image_list_set_reading(&_list, true);
+    for (uint32_t i = 0; i < 5; i++) {
+        item = plcrash_async_image_list_next(&_list, item);
+        STAssertNotNULL(item, @"Item should not be NULL");
+        STAssertEquals(item->macho_image.header_addr, headers[i], @"Incorrect header value");
+        STAssertEqualCStrings(item->macho_image.name, names[i], @"Incorrect name value");
+
+        STAssertEquals(plcrash_async_image_containing_address(&_list, headers[i]), item, @"Image not found in the address index");
+    }
+    STAssertNULL(plcrash_async_image_list_next(&_list, item), @"Item should be NULL");
+    plcrash_async_image_list_set_reading(&_list, false);
+
+    STAssertTrue(plcrash_nasync_image_list_contains(&_list, headers[2]), @"Image should be registered");
+
+    /* Arena-allocated images may be removed normally */
+    plcrash_nasync_image_list_remove(&_list, headers[2]);
+    STAssertFalse(plcrash_nasync_image_list_contains(&_list, headers[2]), @"Image should have been removed");
+}
+
+/* Test record encoder; encodes the image's header address */
+static size_t test_record_encoder (plcrash_async_macho_t *image, void *buffer, size_t length) {
+    if (buffer != NULL) {
+        if (length < sizeof(image->header_addr))
+            return 0;
+        memcpy(buffer, &image->header_addr, sizeof(image->header_addr));
+    }
+
+    return sizeof(image->header_addr);
+}
+
+- (void) testRecordEncoder {
+    /* Images appended prior to configuring the encoder are not encoded */
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(0), _dyld_get_image_name(0));
+
+    plcrash_nasync_image_list_set_record_encoder(&_list, test_record_encoder);
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(1), _dyld_get_image_name(1));
+
+    const pl_vm_address_t headers[] = { (pl_vm_address_t) _dyld_get_image_header(2), (pl_vm_address_t) _dyld_get_image_header(3) };
+    const char *names[] = { _dyld_get_image_name(2), _dyld_get_image_name(3) };
+    plcrash_nasync_image_list_append_all(&_list, headers, names, 2);
+
+    plcrash_async_image_list_set_reading(&_list, true);
+    plcrash_async_image_t *item = plcrash_async_image_list_next(&_list, NULL);
+    STAssertNotNULL(item, @"Item should not be NULL");
+    STAssertNULL(item->record, @"Record should not be encoded for images appended prior to configuring the encoder");
+
+    for (uintptr_t i = 1; i <= 3; i++) {
+        item = plcrash_async_image_list_next(&_list, item);
+        STAssertNotNULL(item, @"Item should not be NULL");
+        if (item == NULL)
+            break;
+
+        STAssertNotNULL(item->record, @"No record was encoded");
+        STAssertEquals(item->record_length, sizeof(pl_vm_address_t), @"Incorrect record length");
+        if (item->record != NULL)
+            STAssertEquals(*(pl_vm_address_t *) item->record, item->macho_image.header_addr, @"Incorrect record");
+    }
+    plcrash_async_image_list_set_reading(&_list, false);
+}
+
+- (void) testCompactImages {
+    /* Images appended prior to enabling compact mode are not affected */
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(0), _dyld_get_image_name(0));
+
+    plcrash_nasync_image_list_set_compact(&_list, true);
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(1), _dyld_get_image_name(1));
+
+    const pl_vm_address_t headers[] = { (pl_vm_address_t) _dyld_get_image_header(2), (pl_vm_address_t) _dyld_get_image_header(3) };
+    const char *names[] = { _dyld_get_image_name(2), _dyld_get_image_name(3) };
+    plcrash_nasync_image_list_append_all(&_list, headers, names, 2);
+
+    plcrash_async_image_list_set_reading(&_list, true);
+    plcrash_async_image_t *item = plcrash_async_image_list_next(&_list, NULL);
+    STAssertNotNULL(item, @"Item should not be NULL");
+    STAssertFalse(item->macho_image.compact, @"Image appended prior to enabling compact mode should not be compact");
+
+    for (uint32_t i = 1; i <= 3; i++) {
+        item = plcrash_async_image_list_next(&_list, item);
+        STAssertNotNULL(item, @"Item should not be NULL");
+        if (item == NULL)
+            break;
+
+        STAssertTrue(item->macho_image.compact, @"Image was not initialized in compact mode");
+        STAssertEquals((const char *) item->macho_image.name, _dyld_get_image_name(i), @"Name was not borrowed");
+        STAssertEquals(plcrash_async_image_containing_address(&_list, item->macho_image.header_addr), item, @"Image not found in the address index");
+    }
+    plcrash_async_image_list_set_reading(&_list, false);
+}
+
+/**
+ * Verify that the image count tracks appends and removals.
+ */
+- (void) testCount {
+    STAssertEquals(plcrash_async_image_list_count(&_list), (size_t) 0, @"Empty list has a non-zero count");
+
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(0), _dyld_get_image_name(0));
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(1), _dyld_get_image_name(1));
+    STAssertEquals(plcrash_async_image_list_count(&_list), (size_t) 2, @"Incorrect count");
+
+    plcrash_nasync_image_list_remove(&_list, (pl_vm_address_t) _dyld_get_image_header(0));
+    STAssertEquals(plcrash_async_image_list_count(&_list), (size_t) 1, @"Incorrect count after removal");
+}
+
+- (void) testUnwindCache {
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(0), _dyld_get_image_name(0));
+    plcrash_async_image_list_set_reading(&_list, true);
+
+    plcrash_async_macho_section_cache_t *cache = plcrash_nasync_image_list_acquire_unwind_cache(&_list);
+    STAssertNotNULL(cache, @"Failed to acquire the unwind cache");
+
+    /* The cache may only be held by a single user */
+    STAssertNULL(plcrash_nasync_image_list_acquire_unwind_cache(&_list), @"Acquired the unwind cache while in use");
+
+    /* Populate the cache */
+    plcrash_async_image_t *image = plcrash_async_image_list_next(&_list, NULL);
+    plcrash_async_mobject_t storage;
+    plcrash_async_mobject_t *mobj;
+    STAssertEquals(plcrash_async_macho_section_cache_map(cache, &image->macho_image, "__TEXT", "__text", &storage, &mobj), PLCRASH_ESUCCESS, @"Failed to map section");
+    plcrash_async_macho_section_cache_unmap(cache, mobj);
+
+    plcrash_nasync_image_list_release_unwind_cache(&_list, cache);
+    plcrash_async_image_list_set_reading(&_list, false);
+
+    /* The mapping should be retained across uses */
+    plcrash_async_image_list_set_reading(&_list, true);
+    STAssertEquals(plcrash_nasync_image_list_acquire_unwind_cache(&_list), cache, @"Unexpected cache");
+    STAssertEquals(cache->entries[0].image, &image->macho_image, @"Mapping was not retained");
+    plcrash_nasync_image_list_release_unwind_cache(&_list, cache);
+    plcrash_async_image_list_set_reading(&_list, false);
+
+    /* Removing the image should evict its mappings */
+    plcrash_nasync_image_list_remove(&_list, (pl_vm_address_t) _dyld_get_image_header(0));
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++)
+        STAssertNULL(cache->entries[i].image, @"Removed image was not evicted");
+}
+
+- (void) testStats {
+    plcrash_async_image_list_stats_t stats;
+
+    plcrash_nasync_image_list_get_stats(&_list, &stats);
+    STAssertEquals(stats.image_count, (size_t) 0, @"Empty list has a non-zero count");
+    STAssertEquals(stats.index_bytes, (size_t) 0, @"Empty list has non-zero index bytes");
+
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(0), _dyld_get_image_name(0));
+    plcrash_nasync_image_list_get_stats(&_list, &stats);
+    STAssertEquals(stats.image_count, (size_t) 1, @"Incorrect count");
+    STAssertTrue(stats.footprint > 0, @"Footprint not computed");
+    size_t footprint = stats.footprint;
+
+    /* Building the symbol index should be accounted for */
+    plcrash_nasync_image_list_index_symbols(&_list);
+    plcrash_nasync_image_list_get_stats(&_list, &stats);
+    STAssertTrue(stats.index_bytes > 0, @"Index bytes not recorded");
+    STAssertTrue(stats.index_time > 0, @"Index time not recorded");
+    STAssertEquals(stats.footprint, footprint + stats.index_bytes, @"Index bytes not included in footprint");
+}
+
 - (void) testRemoveLastImage {
     plcrash_nasync_image_list_append(&_list, 0x0, "image_name");
     plcrash_nasync_image_list_remove(&_list, 0x0);
@@ -184,4 +357,73 @@
 
 }
 
+/* Verify that address lookups return the correct image across a multi-image list, including after removal. */
+- (void) testFindImageForAddressMultipleImages {
+    uint32_t count = _dyld_image_count();
+    STAssertTrue(count >= 5, @"We need at least five Mach-O images for this test. This should not be a problem on a modern system.");
+
+    /* Append in reverse order, to ensure that lookups don't depend on insertion order */
+    for (uint32_t i = 5; i > 0; i--)
+        plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) _dyld_get_image_header(i-1), _dyld_get_image_name(i-1));
+
+    plcrash_nasync_image_list_remove(&_list, (pl_vm_address_t) _dyld_get_image_header(2));
+
+    plcrash_async_image_list_set_reading(&_list, true); {
+        for (uint32_t i = 0; i < 5; i++) {
+            pl_vm_address_t header = (pl_vm_address_t) _dyld_get_image_header(i);
+            plcrash_async_image_t *image = plcrash_async_image_containing_address(&_list, header);
+
+            if (i == 2) {
+                STAssertNULL(image, @"Removed image should not be returned");
+                continue;
+            }
+
+            STAssertNotNULL(image, @"Failed to find image %u", i);
+            STAssertEquals(image->macho_image.header_addr, header, @"Incorrect image returned for %u", i);
+
+            image = plcrash_async_image_containing_address(&_list, header + image->macho_image.text_size - 1);
+            STAssertNotNULL(image, @"Failed to find image %u by its last TEXT address", i);
+            STAssertEquals(image->macho_image.header_addr, header, @"Incorrect image returned for %u", i);
+        }
+    } plcrash_async_image_list_set_reading(&_list, false);
+}
+
+/* Append the image containing this test class, and return it. */
+- (plcrash_async_image_t *) appendTestImage {
+    Dl_info info;
+    STAssertTrue(dladdr((void *) method_getImplementation(class_getInstanceMethod([self class], _cmd)), &info) != 0, @"Could not find the test image");
+
+    plcrash_nasync_image_list_append(&_list, (pl_vm_address_t) info.dli_fbase, info.dli_fname);
+
+    plcrash_async_image_list_set_reading(&_list, true);
+    plcrash_async_image_t *image = plcrash_async_image_containing_address(&_list, (pl_vm_address_t) info.dli_fbase);
+    plcrash_async_image_list_set_reading(&_list, false);
+    STAssertNotNULL(image, @"Appended image not found");
+
+    return image;
+}
+
+- (void) testWarmup {
+    STAssertEquals(plcrash_nasync_image_list_start_warmup(&_list, SIZE_MAX, true, true), PLCRASH_ESUCCESS, @"Failed to start warmup");
+    STAssertEquals(plcrash_nasync_image_list_start_warmup(&_list, SIZE_MAX, true, true), PLCRASH_EINVAL, @"Warmup should only be started once");
+
+    plcrash_async_image_t *image = [self appendTestImage];
+    plcrash_nasync_image_list_wait_warmup(&_list);
+
+    STAssertNotNULL(image->macho_image.symbol_index, @"Symbol index was not built");
+    STAssertNotNULL(image->macho_image.objc_index, @"ObjC index was not built");
+    STAssertTrue(image->macho_image.objc_index->count > 0, @"ObjC index is empty");
+}
+
+- (void) testWarmupBudget {
+    /* The budget is checked prior to building each index; the symbol index will exhaust it. */
+    STAssertEquals(plcrash_nasync_image_list_start_warmup(&_list, 1, true, true), PLCRASH_ESUCCESS, @"Failed to start warmup");
+
+    plcrash_async_image_t *image = [self appendTestImage];
+    plcrash_nasync_image_list_wait_warmup(&_list);
+
+    STAssertNotNULL(image->macho_image.symbol_index, @"Symbol index was not built");
+    STAssertNULL(image->macho_image.objc_index, @"ObjC index should not be built once the budget is exhausted");
+}
+
 @end
@@ -0,0 +1,267 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncLZ4.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_lz4 LZ4 Block Compression
+ *
+ * Implements an async-safe, allocation-free compressor and decompressor for the LZ4 block format. The compressor
+ * performs a single greedy pass using a fixed-size match table, trading compression ratio for speed; its output may
+ * be decoded by any conforming LZ4 block decoder.
+ * @{
+ */
+
+/** The minimum match length supported by the block format. */
+#define LZ4_MIN_MATCH 4
+
+/** Matches may not start within this many bytes of the end of the input. */
+#define LZ4_MF_LIMIT 12
+
+/** The final bytes of the input are always encoded as literals. */
+#define LZ4_LAST_LITERALS 5
+
+/** The maximum match offset supported by the block format. */
+#define LZ4_MAX_OFFSET 65535
+
+/** The value of a token nibble indicating that the length continues in extension bytes. */
+#define LZ4_RUN_MASK 15
+
+/* Read a little-endian 32-bit value from unaligned @a p */
+static inline uint32_t lz4_read32 (const uint8_t *p) {
+    return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+/* Hash a 4-byte sequence to a match table index */
+static inline uint32_t lz4_hash (uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - PLCRASH_ASYNC_LZ4_HASH_LOG);
+}
+
+/* Write the extension bytes of a @a length that did not fit in its token nibble */
+static inline uint8_t *lz4_write_length (uint8_t *op, size_t length) {
+    length -= LZ4_RUN_MASK;
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (uint8_t) length;
+    return op;
+}
+
+/* Write a sequence of @a literal_length literals from @a literals, followed by a match of @a match_length at
+ * @a offset. If @a offset is 0, only the literals are written. */
+static uint8_t *lz4_write_sequence (uint8_t *op, const uint8_t *literals, size_t literal_length, uint16_t offset, size_t match_length) {
+    uint8_t *token = op++;
+
+    *token = (uint8_t) ((literal_length >= LZ4_RUN_MASK ? LZ4_RUN_MASK : literal_length) << 4);
+    if (literal_length >= LZ4_RUN_MASK)
+        op = lz4_write_length(op, literal_length);
+
+    plcrash_async_memcpy(op, literals, literal_length);
+    op += literal_length;
+
+    if (offset == 0)
+        return op;
+
+    *op++ = (uint8_t) (offset & 0xFF);
+    *op++ = (uint8_t) (offset >> 8);
+
+    *token |= (uint8_t) (match_length >= LZ4_RUN_MASK ? LZ4_RUN_MASK : match_length);
+    if (match_length >= LZ4_RUN_MASK)
+        op = lz4_write_length(op, match_length);
+
+    return op;
+}
+
+/**
+ * Return the maximum compressed size of @a length bytes of input. The destination buffer supplied to
+ * plcrash_async_lz4_compress() must be at least this large.
+ *
+ * @param length The input length.
+ */
+size_t plcrash_async_lz4_bound (size_t length) {
+    return length + (length / 255) + 16;
+}
+
+/**
+ * Compress @a length bytes of @a source into @a dest, using the LZ4 block format.
+ *
+ * @param state The compressor state.
+ * @param source The data to be compressed.
+ * @param length The length of @a source.
+ * @param dest The output buffer.
+ * @param dest_size The size of @a dest. Must be at least plcrash_async_lz4_bound(@a length) bytes.
+ * @param dest_length On success, will be set to the number of bytes written to @a dest.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if @a dest is too small.
+ *
+ * @par Async Safety
+ * This function is async-safe, and performs no allocation.
+ */
+plcrash_error_t plcrash_async_lz4_compress (plcrash_async_lz4_state_t *state, const void *source, size_t length, void *dest, size_t dest_size, size_t *dest_length) {
+    const uint8_t *src = source;
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *end = src + length;
+    uint8_t *op = dest;
+
+    if (dest_size < plcrash_async_lz4_bound(length))
+        return PLCRASH_ENOMEM;
+
+    plcrash_async_memset(state->table, 0, sizeof(state->table));
+
+    if (length > LZ4_MF_LIMIT) {
+        const uint8_t *mflimit = end - LZ4_MF_LIMIT;
+        const uint8_t *matchlimit = end - LZ4_LAST_LITERALS;
+
+        while (ip < mflimit) {
+            uint32_t sequence = lz4_read32(ip);
+            uint32_t *entry = &state->table[lz4_hash(sequence)];
+            uint32_t position = (uint32_t) (ip - src);
+            uint32_t candidate = *entry;
+
+            *entry = position + 1;
+
+            /* Match table entries are offset by one, such that zero identifies an empty entry */
+            if (candidate == 0 || position - (candidate - 1) > LZ4_MAX_OFFSET || lz4_read32(src + candidate - 1) != sequence) {
+                ip++;
+                continue;
+            }
+
+            /* Extend the match, stopping short of the trailing literals */
+            const uint8_t *match = src + candidate - 1;
+            const uint8_t *mp = ip + LZ4_MIN_MATCH;
+            const uint8_t *mm = match + LZ4_MIN_MATCH;
+            while (mp < matchlimit && *mp == *mm) {
+                mp++;
+                mm++;
+            }
+
+            op = lz4_write_sequence(op, anchor, (size_t) (ip - anchor), (uint16_t) (ip - match), (size_t) (mp - ip) - LZ4_MIN_MATCH);
+            ip = mp;
+            anchor = ip;
+        }
+    }
+
+    /* The final sequence holds only the remaining literals */
+    op = lz4_write_sequence(op, anchor, (size_t) (end - anchor), 0, 0);
+
+    *dest_length = (size_t) (op - (uint8_t *) dest);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Decompress @a length bytes of LZ4 block data from @a source into @a dest.
+ *
+ * @param source The compressed data.
+ * @param length The length of @a source.
+ * @param dest The output buffer.
+ * @param dest_size The size of @a dest.
+ * @param dest_length On success, will be set to the number of bytes written to @a dest.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOMEM if the decompressed data would exceed @a dest_size, or
+ * PLCRASH_EINVAL if @a source is malformed.
+ *
+ * @par Async Safety
+ * This function is async-safe, and performs no allocation.
+ */
+plcrash_error_t plcrash_async_lz4_decompress (const void *source, size_t length, void *dest, size_t dest_size, size_t *dest_length) {
+    const uint8_t *ip = source;
+    const uint8_t *iend = ip + length;
+    uint8_t *op = dest;
+    uint8_t *oend = op + dest_size;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        /* Literals */
+        size_t literal_length = token >> 4;
+        if (literal_length == LZ4_RUN_MASK) {
+            uint8_t b;
+            do {
+                if (ip >= iend)
+                    return PLCRASH_EINVAL;
+                b = *ip++;
+                literal_length += b;
+            } while (b == 255);
+        }
+
+        if (literal_length > (size_t) (iend - ip))
+            return PLCRASH_EINVAL;
+
+        if (literal_length > (size_t) (oend - op))
+            return PLCRASH_ENOMEM;
+
+        plcrash_async_memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        /* The final sequence has no match */
+        if (ip == iend)
+            break;
+
+        /* Match */
+        if (iend - ip < 2)
+            return PLCRASH_EINVAL;
+
+        size_t offset = (size_t) ip[0] | ((size_t) ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t) (op - (uint8_t *) dest))
+            return PLCRASH_EINVAL;
+
+        size_t match_length = token & LZ4_RUN_MASK;
+        if (match_length == LZ4_RUN_MASK) {
+            uint8_t b;
+            do {
+                if (ip >= iend)
+                    return PLCRASH_EINVAL;
+                b = *ip++;
+                match_length += b;
+            } while (b == 255);
+        }
+        match_length += LZ4_MIN_MATCH;
+
+        if (match_length > (size_t) (oend - op))
+            return PLCRASH_ENOMEM;
+
+        /* Matches may overlap their own output, and must be copied forward */
+        const uint8_t *match = op - offset;
+        for (size_t i = 0; i < match_length; i++)
+            op[i] = match[i];
+        op += match_length;
+    }
+
+    *dest_length = (size_t) (op - (uint8_t *) dest);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,68 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_LZ4_H
+#define PLCRASH_ASYNC_LZ4_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_lz4
+ *
+ * The base-2 logarithm of the number of entries in the compressor's match table.
+ */
+#define PLCRASH_ASYNC_LZ4_HASH_LOG 12
+
+/**
+ * @internal
+ * @ingroup plcrash_async_lz4
+ *
+ * Compressor state. The state holds the compressor's match table, and must be pre-allocated by the caller; it is
+ * reset by each call to plcrash_async_lz4_compress(), and may be reused, but not shared by concurrent callers.
+ */
+typedef struct plcrash_async_lz4_state {
+    /** Match table, mapping the hash of a 4-byte sequence to its most recent input position + 1, or 0 if empty. */
+    uint32_t table[1 << PLCRASH_ASYNC_LZ4_HASH_LOG];
+} plcrash_async_lz4_state_t;
+
+size_t plcrash_async_lz4_bound (size_t length);
+plcrash_error_t plcrash_async_lz4_compress (plcrash_async_lz4_state_t *state, const void *source, size_t length, void *dest, size_t dest_size, size_t *dest_length);
+plcrash_error_t plcrash_async_lz4_decompress (const void *source, size_t length, void *dest, size_t dest_size, size_t *dest_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_LZ4_H */
@@ -0,0 +1,117 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncLZ4.h"
+
+@interface PLCrashAsyncLZ4Tests : SenTestCase {
+@private
+    plcrash_async_lz4_state_t _state;
+}
+@end
+
+@implementation PLCrashAsyncLZ4Tests
+
+/* Compress and decompress @a data, verifying that the round trip is lossless */
+- (NSData *) roundTrip: (NSData *) data {
+    NSMutableData *compressed = [NSMutableData dataWithLength: plcrash_async_lz4_bound([data length])];
+    NSMutableData *decompressed = [NSMutableData dataWithLength: [data length]];
+    size_t length;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_lz4_compress(&_state, [data bytes], [data length], [compressed mutableBytes], [compressed length], &length), @"Compression failed");
+    STAssertTrue(length <= [compressed length], @"Compressed output exceeds the bound");
+    [compressed setLength: length];
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_lz4_decompress([compressed bytes], [compressed length], [decompressed mutableBytes], [decompressed length], &length), @"Decompression failed");
+    STAssertEquals(length, [data length], @"Incorrect decompressed length");
+    STAssertEqualObjects(decompressed, data, @"Decompressed data does not match the input");
+
+    return compressed;
+}
+
+/**
+ * Test compression of repetitive data, such as the image paths and symbol names found in reports.
+ */
+- (void) testCompressRepetitive {
+    NSMutableData *data = [NSMutableData data];
+    for (int i = 0; i < 500; i++) {
+        const char *path = "/System/Library/Frameworks/Foundation.framework/Versions/C/Foundation";
+        [data appendBytes: path length: strlen(path)];
+        [data appendBytes: &i length: sizeof(i)];
+    }
+
+    NSData *compressed = [self roundTrip: data];
+    STAssertTrue([compressed length] * 4 < [data length], @"Repetitive data was not compressed: %lu bytes", (unsigned long) [compressed length]);
+}
+
+/**
+ * Test compression of incompressible and short inputs, which are encoded as literals.
+ */
+- (void) testCompressLiterals {
+    NSMutableData *data = [NSMutableData dataWithLength: 4096];
+    uint8_t *bytes = [data mutableBytes];
+    for (size_t i = 0; i < [data length]; i++)
+        bytes[i] = (uint8_t) arc4random();
+
+    [self roundTrip: data];
+    [self roundTrip: [NSData dataWithBytes: "short" length: 5]];
+    [self roundTrip: [NSData data]];
+}
+
+/**
+ * Verify that an undersized output buffer is rejected.
+ */
+- (void) testCompressBound {
+    uint8_t source[64] = { 0 };
+    uint8_t dest[sizeof(source)];
+    size_t length;
+
+    STAssertEquals(PLCRASH_ENOMEM, plcrash_async_lz4_compress(&_state, source, sizeof(source), dest, sizeof(dest), &length), @"Undersized output buffer was accepted");
+}
+
+/**
+ * Verify that malformed and oversized input is rejected by the decompressor.
+ */
+- (void) testDecompressInvalid {
+    uint8_t dest[64];
+    size_t length;
+
+    /* A match offset that precedes the start of the output */
+    const uint8_t bad_offset[] = { 0x10, 'a', 0x02, 0x00 };
+    STAssertEquals(PLCRASH_EINVAL, plcrash_async_lz4_decompress(bad_offset, sizeof(bad_offset), dest, sizeof(dest), &length), @"Invalid offset was accepted");
+
+    /* Literals that extend past the end of the input */
+    const uint8_t truncated[] = { 0x50, 'a', 'b' };
+    STAssertEquals(PLCRASH_EINVAL, plcrash_async_lz4_decompress(truncated, sizeof(truncated), dest, sizeof(dest), &length), @"Truncated literals were accepted");
+
+    /* Output that exceeds the destination buffer */
+    const uint8_t overflow[] = { 0x1F, 'a', 0x01, 0x00, 0xFE };
+    STAssertEquals(PLCRASH_ENOMEM, plcrash_async_lz4_decompress(overflow, sizeof(overflow), dest, sizeof(dest), &length), @"Oversized output was accepted");
+}
+
+@end
@@ -48,6 +48,11 @@ namespace plcrash { namespace async {
  * write mutex is held for all updates; the implementation is not designed for efficiency in the face of contention
  * between readers and writers, and it's assumed that no contention should realistically occur.
  *
+ * Removed nodes are reclaimed via epoch-based reclamation. Each reading thread claims one of a fixed set of reader
+ * records, noting the writer epoch at which its read began; a removed node is stamped with the epoch of its removal,
+ * and is deallocated by a writer once no active reader record predates that epoch. Readers never wait on writers,
+ * and a long-running reader only delays reclamation of the nodes removed while it was active.
+ *
  * @tparam V The list element type. 
  */
 template <typename V>
@@ -87,17 +92,8 @@ public:
             _value = value;
             _prev = NULL;
             _next = NULL;
-        }
-        
-        /**
-         * Reset a node for re-use.
-         *
-         * @param value The new value for this node.
-         */
-        void reset (V value) {
-            _value = value;
-            _prev = NULL;
-            _next = NULL;
+            _retired_next = NULL;
+            _retired_epoch = 0;
         }
     
         /** The list entry value. */
@@ -106,8 +102,15 @@ public:
         /** The previous item in the list, or NULL */
         node *_prev;
         
-        /** The next image in the list, or NULL. */
+        /** The next image in the list, or NULL. This is left intact on removal, as it may still be followed by a
+         * reader. */
         node *_next;
+
+        /** The next node in the retired list, or NULL. */
+        node *_retired_next;
+
+        /** The writer epoch during which this node was removed. */
+        uint32_t _retired_epoch;
     };
 
     async_list (void);
@@ -115,8 +118,10 @@ public:
     
     void nasync_prepend (V value);
     void nasync_append (V value);
+    void nasync_append_all (const V *values, size_t count);
     void nasync_remove_first_value (V value);
     void nasync_remove_node (node *deleted_node);
+    void nasync_reclaim (void);
     void set_reading (bool enable);
     node *next (node *current);
     
@@ -146,8 +151,39 @@ public:
         PLCF_ASSERT(prev == _tail);
     }
 
+    /**
+     * Return the number of removed nodes pending reclamation. Intended to be used from the unit tests.
+     *
+     * This method acquires no locks and is not thread-safe.
+     */
+    inline size_t retired_count (void) {
+        size_t count = 0;
+        for (node *cur = _retired; cur != NULL; cur = cur->_retired_next)
+            count++;
+        return count;
+    }
+
 private:
+    /** The number of reader records. Readers beyond this count will block all reclamation until they complete. */
+    static const size_t READER_RECORD_COUNT = 64;
+
+    /**
+     * A reader record, claimed by a thread for the duration of its read.
+     */
+    struct reader_record {
+        /** The owning thread, or MACH_PORT_NULL if unclaimed. */
+        volatile thread_t owner;
+
+        /** The writer epoch at which the read began, or 0 if the record is being claimed or released. */
+        volatile uint32_t epoch;
+
+        /** The read nesting depth. Only modified by the owning thread. */
+        volatile uint32_t depth;
+    };
+
     void free_list (node *next);
+    bool can_reclaim (uint32_t epoch);
+    void reclaim_locked (void);
 
     /** The lock used by writers. No lock is required for readers. */
     OSSpinLock _write_lock;
@@ -158,30 +194,50 @@ private:
     /** The tail of the list, or NULL if the list is empty. Must only be used to append new entries. */
     node *_tail;
     
-    /** The list reference count. No nodes will be deallocated while the count is greater than 0. If the count
-     * reaches 0, all nodes in the free list will be deallocated. */
+    /** The total number of active readers. */
     int32_t _refcount;
+
+    /** The current writer epoch. Only modified with the write lock held; never 0. */
+    volatile uint32_t _epoch;
+
+    /** Reader records. */
+    reader_record _readers[READER_RECORD_COUNT];
+
+    /** The number of active readers that could not claim a reader record. */
+    volatile int32_t _overflow_readers;
     
-    /** The node free list. */
-    node *_free;
+    /** Removed nodes pending reclamation, linked via node::_retired_next. */
+    node *_retired;
 };
     
 /** Construct a new, empty linked list */
 template <typename V> async_list<V>::async_list (void) {
     _head = NULL;
     _tail = NULL;
-    _free = NULL;
+    _retired = NULL;
     _refcount = 0;
+    _epoch = 1;
+    _overflow_readers = 0;
     _write_lock = OS_SPINLOCK_INIT;
+
+    for (size_t i = 0; i < READER_RECORD_COUNT; i++) {
+        _readers[i].owner = MACH_PORT_NULL;
+        _readers[i].epoch = 0;
+        _readers[i].depth = 0;
+    }
 }
     
 template <typename V> async_list<V>::~async_list (void) {
     /* Free all nodes */
     if (_head != NULL)
         free_list(_head);
-    
-    if (_free != NULL)
-        free_list(_free);
+
+    node *next = _retired;
+    while (next != NULL) {
+        node *cur = next;
+        next = cur->_retired_next;
+        delete cur;
+    }
 }
 
 /**
@@ -194,18 +250,8 @@ template <typename V> async_list<V>::~async_list (void) {
 template <typename V> void async_list<V>::nasync_prepend (V value) {
     /* Lock the list from other writers. */
     OSSpinLockLock(&_write_lock); {
-        /* Construct the new entry, or recycle an existing one. */
-        node *new_node;
-        if (_free != NULL) {
-            /* Fetch a node from the free list */
-            new_node = _free;
-            new_node->reset(value);
-            
-            /* Update the free list */
-            _free = _free->_next;
-        } else {
-            new_node = new node(value);
-        }
+        /* Construct the new entry. Removed nodes are never recycled, as a reader may still be traversing them. */
+        node *new_node = new node(value);
         
         /* Issue a memory barrier to ensure a consistent view of the value. */
         OSMemoryBarrier();
@@ -255,18 +301,8 @@ template <typename V> void async_list<V>::nasync_append (V value) {
     
     /* Lock the list from other writers. */
     OSSpinLockLock(&_write_lock); {
-        /* Construct the new entry, or recycle an existing one. */
-        node *new_node;
-        if (_free != NULL) {
-            /* Fetch a node from the free list */
-            new_node = _free;
-            new_node->reset(value);
-            
-            /* Update the free list */
-            _free = _free->_next;
-        } else {
-            new_node = new node(value);
-        }
+        /* Construct the new entry. Removed nodes are never recycled, as a reader may still be traversing them. */
+        node *new_node = new node(value);
         
         /* Issue a memory barrier to ensure a consistent view of the value. */
         OSMemoryBarrier();
@@ -299,6 +335,56 @@ template <typename V> void async_list<V>::nasync_append (V value) {
     } OSSpinLockUnlock(&_write_lock);
 }
 
+/**
+ * Append all of @a values to the list. The new nodes are published to readers in a single atomic update, and the
+ * write lock is acquired only once.
+ *
+ * @param values The values to be appended, in order.
+ * @param count The number of values in @a values.
+ *
+ * @warning This method is not async safe.
+ */
+template <typename V> void async_list<V>::nasync_append_all (const V *values, size_t count) {
+    if (count == 0)
+        return;
+
+    /* Construct the new chain privately; it is not visible to readers until published below. */
+    node *first = new node(values[0]);
+    node *last = first;
+    for (size_t i = 1; i < count; i++) {
+        node *new_node = new node(values[i]);
+        new_node->_prev = last;
+        last->_next = new_node;
+        last = new_node;
+    }
+
+    /* Issue a memory barrier to ensure a consistent view of the chain. */
+    OSMemoryBarrier();
+
+    /* Lock the list from other writers. */
+    OSSpinLockLock(&_write_lock); {
+        if (_tail == NULL) {
+            _tail = last;
+
+            /* Atomically update the list head; this will be iterated upon by lockless readers. */
+            if (!OSAtomicCompareAndSwapPtrBarrier(NULL, first, (void **) (&_head))) {
+                /* Should never occur */
+                PLCF_DEBUG("An async image head was set with tail == NULL despite holding lock.");
+            }
+        } else {
+            first->_prev = _tail;
+            OSMemoryBarrier();
+
+            /* Atomically slot the new chain into place; this may be iterated on by a lockless reader. */
+            if (!OSAtomicCompareAndSwapPtrBarrier(NULL, first, (void **) (&_tail->_next))) {
+                PLCF_DEBUG("Failed to append to image list despite holding lock");
+            }
+
+            _tail = last;
+        }
+    } OSSpinLockUnlock(&_write_lock);
+}
+
 /**
  * Find and remove the first entry node with @a value. Direct '==' equality checking
  * is performed.
@@ -317,6 +403,9 @@ template <typename V> void async_list<V>::nasync_remove_first_value (V value) {
         }
     }
     set_reading(false);
+
+    /* Our own read prevented reclamation of the removed node */
+    nasync_reclaim();
 }
 
 /**
@@ -370,35 +459,137 @@ template <typename V> void async_list<V>::nasync_remove_node (node *deleted_node
             _tail = item->_prev;
         }
         
-        /* If a reader is active, place the node on the free list. The item is unreachable here when readers
-         * aren't active, so if we have a 0 refcount, we can safely delete the item, and be sure that no
-         * reader holds a reference to it. */
-        if (_refcount > 0) {
-            item->_prev = NULL;
-            item->_next = _free;
-            
-            if (_free != NULL)
-                _free->_prev = item;
-            _free = item;
+        /* Retire the node, and advance the epoch; any reader that begins after the increment can not observe the
+         * node. The node's _next pointer is preserved for the benefit of readers currently positioned on it. */
+        item->_retired_epoch = _epoch;
+        item->_retired_next = _retired;
+        _retired = item;
+
+        uint32_t epoch = _epoch + 1;
+        if (epoch == 0)
+            epoch = 1;
+        _epoch = epoch;
+        OSMemoryBarrier();
+
+        reclaim_locked();
+    } OSSpinLockUnlock(&_write_lock);
+}
+
+/**
+ * Deallocate any removed nodes that are no longer reachable by any active reader. This is performed automatically
+ * on removal, but may be called explicitly once a writer's own read of the list has completed.
+ *
+ * @warning This method is not async safe.
+ */
+template <typename V> void async_list<V>::nasync_reclaim (void) {
+    OSSpinLockLock(&_write_lock); {
+        reclaim_locked();
+    } OSSpinLockUnlock(&_write_lock);
+}
+
+/**
+ * Return true if no active reader could hold a reference to a node retired during @a epoch.
+ *
+ * @param epoch The retirement epoch.
+ */
+template <typename V> bool async_list<V>::can_reclaim (uint32_t epoch) {
+    if (_overflow_readers > 0)
+        return false;
+
+    for (size_t i = 0; i < READER_RECORD_COUNT; i++) {
+        if (_readers[i].owner == MACH_PORT_NULL)
+            continue;
+
+        /* A record that is being claimed or released conservatively blocks reclamation. Otherwise, only readers
+         * that began after the retirement epoch are known not to reference the node. */
+        uint32_t reader_epoch = _readers[i].epoch;
+        if (reader_epoch == 0 || (int32_t) (reader_epoch - epoch) <= 0)
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * @internal
+ *
+ * Deallocate all reclaimable retired nodes.
+ *
+ * @warning This method is not async-safe, and must only be called with the write lock held.
+ */
+template <typename V> void async_list<V>::reclaim_locked (void) {
+    node **prev = &_retired;
+    while (*prev != NULL) {
+        node *cur = *prev;
+        if (can_reclaim(cur->_retired_epoch)) {
+            *prev = cur->_retired_next;
+            delete cur;
         } else {
-            delete item;
+            prev = &cur->_retired_next;
         }
-    } OSSpinLockUnlock(&_write_lock);
+    }
 }
 
 /**
- * Retain or release the list for reading. This method is async-safe.
+ * Retain or release the list for reading. This method is async-safe, and wait-free.
  *
  * This must be issued prior to attempting to iterate the list, and must called again once reads have completed.
+ * Reads may be nested within a thread, including by a signal handler interrupting a read.
  *
  * @param enable If true, the list will be retained. If false, released.
  */
 template <typename V> void async_list<V>::set_reading (bool enable) {
+    thread_t self = pl_mach_thread_self();
+
     if (enable) {
-        /* Increment and issue a barrier. Once issued, no items will be deallocated while a reference is held. */
         OSAtomicIncrement32Barrier(&_refcount);
+
+        /* Nest within our existing record, if any. Records that are mid-claim or mid-release (depth or epoch of 0)
+         * are skipped; a read interrupting the claim or release will use a record of its own. */
+        for (size_t i = 0; i < READER_RECORD_COUNT; i++) {
+            reader_record *r = &_readers[i];
+            if (r->owner == self && r->depth > 0 && r->epoch != 0) {
+                r->depth++;
+                return;
+            }
+        }
+
+        /* Claim a free record. Once the epoch is published, no node reachable from this point will be deallocated
+         * until the record is released. */
+        for (size_t i = 0; i < READER_RECORD_COUNT; i++) {
+            reader_record *r = &_readers[i];
+            if (r->owner != MACH_PORT_NULL || !OSAtomicCompareAndSwap32Barrier(MACH_PORT_NULL, self, (volatile int32_t *) &r->owner))
+                continue;
+
+            r->depth = 1;
+            OSMemoryBarrier();
+            r->epoch = _epoch;
+            OSMemoryBarrier();
+            return;
+        }
+
+        /* No records are available; block all reclamation until we complete. */
+        OSAtomicIncrement32Barrier(&_overflow_readers);
     } else {
-        /* Increment and issue a barrier. Once issued, items may again be deallocated. */
+        /* Release our record */
+        for (size_t i = 0; i < READER_RECORD_COUNT; i++) {
+            reader_record *r = &_readers[i];
+            if (r->owner != self || r->depth == 0 || r->epoch == 0)
+                continue;
+
+            if (--r->depth == 0) {
+                OSMemoryBarrier();
+                r->epoch = 0;
+                OSMemoryBarrier();
+                r->owner = MACH_PORT_NULL;
+            }
+
+            OSAtomicDecrement32Barrier(&_refcount);
+            return;
+        }
+
+        /* If we hold no record, we were an overflow reader */
+        OSAtomicDecrement32Barrier(&_overflow_readers);
         OSAtomicDecrement32Barrier(&_refcount);
     }
 }
@@ -440,6 +631,199 @@ template <typename V> void async_list<V>::free_list (node *next) {
     }
 }
 
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Default async_hash_map key hashing. Integral keys are mixed with a 64-bit finalizer, such that keys with
+ * regular strides (such as addresses) are spread across the table.
+ *
+ * @tparam K The key type. Must be convertible to uint64_t.
+ */
+template <typename K> struct async_hash {
+    /** Return the hash of @a key. */
+    static inline uint64_t hash (K key) {
+        uint64_t h = (uint64_t) key;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+};
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Pointer key hashing.
+ */
+template <typename T> struct async_hash<T *> {
+    /** Return the hash of @a key. */
+    static inline uint64_t hash (T *key) {
+        return async_hash<uintptr_t>::hash((uintptr_t) key);
+    }
+};
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * An async-safe, fixed-capacity hash map.
+ *
+ * Entries are stored in caller-supplied, pre-allocated storage, using open addressing with linear probing over a
+ * power-of-two table. No memory is allocated and no locks are acquired by any operation; lookups may be performed
+ * from a signal handler, and may safely run concurrently with a single writer. Concurrent writers must be
+ * serialized by the caller.
+ *
+ * Entries may not be individually removed; the map may only be cleared in its entirety, which must not run
+ * concurrently with readers.
+ *
+ * @tparam K The key type.
+ * @tparam V The value type. Values are copied on insertion and lookup.
+ * @tparam H The key hashing implementation; see async_hash.
+ */
+template <typename K, typename V, typename H = async_hash<K> >
+class async_hash_map {
+public:
+    /**
+     * A hash map entry.
+     */
+    struct entry {
+        /** If true, the entry is occupied. Set only once @a key and @a value have been written. */
+        volatile bool used;
+
+        /** The entry's key. */
+        K key;
+
+        /** The entry's value. */
+        V value;
+    };
+
+    /**
+     * Return the number of bytes of storage required for a map of @a capacity entries.
+     *
+     * @param capacity The map capacity. Must be a power of two.
+     */
+    static inline size_t storage_size (size_t capacity) {
+        return sizeof(entry) * capacity;
+    }
+
+    async_hash_map (void *storage, size_t capacity);
+
+    bool insert (K key, V value);
+    bool get (K key, V *value) const;
+    void clear (void);
+
+    /** Return the number of occupied entries. */
+    inline size_t count (void) const { return _count; }
+
+    /** Return the maximum number of entries. */
+    inline size_t capacity (void) const { return _mask + 1; }
+
+private:
+    /** The entry table. */
+    entry *_entries;
+
+    /** The table capacity minus one; the capacity is always a power of two. */
+    size_t _mask;
+
+    /** The number of occupied entries. */
+    size_t _count;
+};
+
+/**
+ * Construct a new, empty hash map backed by @a storage.
+ *
+ * @param storage Pre-allocated storage of at least storage_size() bytes, suitably aligned for an entry. The
+ * storage is borrowed, and must remain valid for the lifetime of the map.
+ * @param capacity The maximum number of entries. Must be a non-zero power of two.
+ */
+template <typename K, typename V, typename H> async_hash_map<K,V,H>::async_hash_map (void *storage, size_t capacity) {
+    PLCF_ASSERT(capacity != 0 && (capacity & (capacity - 1)) == 0);
+
+    _entries = (entry *) storage;
+    _mask = capacity - 1;
+    clear();
+}
+
+/**
+ * Insert @a value for @a key, replacing any existing value. Replacing a value is not atomic with respect to
+ * concurrent readers of the same key, unless @a V may be written atomically.
+ *
+ * @param key The entry key.
+ * @param value The entry value.
+ *
+ * @return Returns true on success, or false if the map is full.
+ */
+template <typename K, typename V, typename H> bool async_hash_map<K,V,H>::insert (K key, V value) {
+    size_t index = (size_t) H::hash(key) & _mask;
+
+    for (size_t probe = 0; probe <= _mask; probe++) {
+        entry *e = &_entries[(index + probe) & _mask];
+
+        if (e->used) {
+            if (!(e->key == key))
+                continue;
+
+            e->value = value;
+            return true;
+        }
+
+        /* Populate the entry before publishing it to readers */
+        e->key = key;
+        e->value = value;
+        OSMemoryBarrier();
+        e->used = true;
+
+        _count++;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Look up the value for @a key.
+ *
+ * @param key The key to search for.
+ * @param value On success, the entry's value.
+ *
+ * @return Returns true if the key was found, or false otherwise.
+ */
+template <typename K, typename V, typename H> bool async_hash_map<K,V,H>::get (K key, V *value) const {
+    size_t index = (size_t) H::hash(key) & _mask;
+
+    for (size_t probe = 0; probe <= _mask; probe++) {
+        const entry *e = &_entries[(index + probe) & _mask];
+
+        /* Entries are never removed, so an empty entry terminates the probe sequence */
+        if (!e->used)
+            return false;
+
+        if (e->key == key) {
+            *value = e->value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Remove all entries from the map.
+ *
+ * @warning This method must not be called concurrently with readers.
+ */
+template <typename K, typename V, typename H> void async_hash_map<K,V,H>::clear (void) {
+    for (size_t i = 0; i <= _mask; i++)
+        _entries[i].used = false;
+
+    _count = 0;
+    OSMemoryBarrier();
+}
+
 }}
 
 #endif /* PLCRASH_ASYNC_LINKED_LIST_H */
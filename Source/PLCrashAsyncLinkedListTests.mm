@@ -167,4 +167,140 @@ using namespace plcrash::async;
     _list.assert_list_valid();
 }
 
+/* Test that removed nodes are reclaimed once no reader could reference them. */
+- (void) testReclaimRemovedItem {
+    _list.nasync_append(0);
+    _list.nasync_append(1);
+    _list.nasync_append(2);
+
+    /* Without an active reader, the node should be reclaimed immediately */
+    _list.nasync_remove_first_value(0);
+    STAssertEquals(_list.retired_count(), (size_t) 0, @"Node should have been reclaimed");
+
+    /* With an active reader, the node must be retained, and must remain traversable */
+    _list.set_reading(true);
+    async_list<int>::node *item = _list.next(NULL);
+    STAssertEquals(item->value(), 1, @"Incorrect value");
+
+    _list.nasync_remove_node(item);
+    STAssertEquals(_list.retired_count(), (size_t) 1, @"Node should not have been reclaimed");
+
+    item = _list.next(item);
+    STAssertNotNULL(item, @"Removed node should still reference its successor");
+    STAssertEquals(item->value(), 2, @"Incorrect value");
+    _list.set_reading(false);
+
+    _list.nasync_reclaim();
+    STAssertEquals(_list.retired_count(), (size_t) 0, @"Node should have been reclaimed");
+
+    _list.assert_list_valid();
+}
+
+/* Test that nested reads on a single thread block reclamation until the outermost read completes. */
+- (void) testReclaimNestedRead {
+    _list.nasync_append(0);
+    _list.nasync_append(1);
+
+    _list.set_reading(true);
+    _list.set_reading(true);
+    _list.nasync_remove_node(_list.next(NULL));
+
+    _list.set_reading(false);
+    _list.nasync_reclaim();
+    STAssertEquals(_list.retired_count(), (size_t) 1, @"Node should not be reclaimed while the outer read is active");
+
+    _list.set_reading(false);
+    _list.nasync_reclaim();
+    STAssertEquals(_list.retired_count(), (size_t) 0, @"Node should have been reclaimed");
+}
+
+/* Test that a reader beginning after a removal does not block its reclamation. */
+- (void) testReclaimWithLaterReader {
+    _list.nasync_append(0);
+    _list.nasync_append(1);
+
+    _list.set_reading(true);
+    _list.nasync_remove_node(_list.next(NULL));
+    _list.set_reading(false);
+
+    /* Start a new read; it can not observe the removed node */
+    _list.set_reading(true);
+    _list.nasync_reclaim();
+    STAssertEquals(_list.retired_count(), (size_t) 0, @"Node should have been reclaimed despite the active reader");
+    _list.set_reading(false);
+}
+
+@end
+
+
+@interface PLCrashAsyncHashMapTests : SenTestCase @end
+
+/**
+ * Tests for the async_hash_map implementation.
+ */
+@implementation PLCrashAsyncHashMapTests
+
+typedef async_hash_map<uintptr_t, int> test_map;
+
+/* Test basic insertion, replacement, and lookup. */
+- (void) testInsertAndGet {
+    test_map::entry storage[16];
+    test_map map(storage, 16);
+    int value;
+
+    STAssertEquals(map.capacity(), (size_t) 16, @"Incorrect capacity");
+    STAssertEquals(map.count(), (size_t) 0, @"Map should be empty");
+    STAssertFalse(map.get(0x1000, &value), @"Lookup in an empty map should fail");
+
+    /* Use page-strided keys to exercise collisions */
+    for (int i = 0; i < 8; i++)
+        STAssertTrue(map.insert(0x1000 * i, i), @"Insert failed");
+    STAssertEquals(map.count(), (size_t) 8, @"Incorrect count");
+
+    for (int i = 0; i < 8; i++) {
+        STAssertTrue(map.get(0x1000 * i, &value), @"Lookup failed");
+        STAssertEquals(value, i, @"Incorrect value");
+    }
+    STAssertFalse(map.get(0x1001, &value), @"Lookup of a missing key should fail");
+
+    /* Replace an existing value */
+    STAssertTrue(map.insert(0x2000, 42), @"Replacement failed");
+    STAssertEquals(map.count(), (size_t) 8, @"Replacement should not change the count");
+    STAssertTrue(map.get(0x2000, &value), @"Lookup failed");
+    STAssertEquals(value, 42, @"Value was not replaced");
+}
+
+/* Test insertion into a full map, and clearing. */
+- (void) testFullMap {
+    test_map::entry storage[4];
+    test_map map(storage, 4);
+    int value;
+
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(map.insert(i, i), @"Insert failed");
+
+    STAssertFalse(map.insert(4, 4), @"Insert into a full map should fail");
+    STAssertFalse(map.get(4, &value), @"Lookup of a missing key in a full map should fail");
+    STAssertTrue(map.insert(3, 30), @"Replacement in a full map should succeed");
+
+    map.clear();
+    STAssertEquals(map.count(), (size_t) 0, @"Map should be empty");
+    STAssertFalse(map.get(0, &value), @"Lookup in a cleared map should fail");
+    STAssertTrue(map.insert(4, 4), @"Insert into a cleared map failed");
+}
+
+/* Test pointer keys. */
+- (void) testPointerKeys {
+    async_hash_map<const void *, int>::entry storage[8];
+    async_hash_map<const void *, int> map(storage, 8);
+    int a, b, value;
+
+    STAssertTrue(map.insert(&a, 1), @"Insert failed");
+    STAssertTrue(map.insert(&b, 2), @"Insert failed");
+
+    STAssertTrue(map.get(&b, &value), @"Lookup failed");
+    STAssertEquals(value, 2, @"Incorrect value");
+    STAssertFalse(map.get(&value, &value), @"Lookup of a missing key should fail");
+}
+
 @end
@@ -31,6 +31,8 @@
 #import <stdint.h>
 #import <inttypes.h>
 
+#import <libkern/OSAtomic.h>
+
 /**
  * @internal
  * @ingroup plcrash_async
@@ -40,6 +42,194 @@
  * @{
  */
 
+/**
+ * @internal
+ *
+ * Pre-reserved address space from which mapping ranges of up to PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE are
+ * allocated, avoiding the need to allocate and deallocate a new page range for every mapping, followed by the
+ * copy slots into which objects of up to PLCRASH_ASYNC_MOBJECT_COPY_SIZE are read.
+ */
+static struct {
+    /** The base address of the reserved range, or 0 if the pool has not been initialized. */
+    pl_vm_address_t base;
+
+    /** Slot availability mask; a set bit marks an available slot. */
+    volatile int32_t free_mask;
+
+    /** The base address of the copy slots, or 0 if the pool has not been initialized. */
+    pl_vm_address_t copy_base;
+
+    /** Copy slot availability mask; a set bit marks an available slot. */
+    volatile int32_t copy_free_mask;
+} mobject_pool = { 0, 0, 0, 0 };
+
+/**
+ * @internal
+ *
+ * The total number of mappings established by plcrash_async_mobject_init(). Used to report crash-time mapping counts.
+ */
+static volatile int32_t mobject_map_count = 0;
+
+PLCF_ASSERT_STATIC(mobject_pool_slot_count, PLCRASH_ASYNC_MOBJECT_POOL_SLOTS <= 32);
+PLCF_ASSERT_STATIC(mobject_pool_copy_slot_count, PLCRASH_ASYNC_MOBJECT_COPY_SLOTS <= 32);
+
+/* Return the availability mask of a pool with @a slots slots, all available */
+static uint32_t plcrash_async_mobject_pool_mask (uint32_t slots) {
+    return (slots == 32) ? UINT32_MAX : ((1U << slots) - 1);
+}
+
+/**
+ * @internal
+ *
+ * Claim an available slot from the availability mask @a free_mask.
+ *
+ * @param free_mask The pool's availability mask.
+ * @param slot[out] On success, the index of the claimed slot.
+ *
+ * @return Returns true if a slot was claimed, or false if no slot is available.
+ */
+static bool plcrash_async_mobject_claim_slot (volatile int32_t *free_mask, uint32_t *slot) {
+    int32_t mask;
+    while ((mask = *free_mask) != 0) {
+        uint32_t index = (uint32_t) __builtin_ctz((uint32_t) mask);
+        if (OSAtomicCompareAndSwap32Barrier(mask, (int32_t) ((uint32_t) mask & ~(1U << index)), free_mask)) {
+            *slot = index;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Return @a slot to the availability mask @a free_mask */
+static void plcrash_async_mobject_return_slot (volatile int32_t *free_mask, uint32_t slot) {
+    int32_t mask;
+    do {
+        mask = *free_mask;
+    } while (!OSAtomicCompareAndSwap32Barrier(mask, (int32_t) ((uint32_t) mask | (1U << slot)), free_mask));
+}
+
+/**
+ * Reserve the process-wide memory object address space pool. Once initialized, mappings of up to
+ * PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE bytes will be placed within the pool's pre-reserved address space, and
+ * objects of up to PLCRASH_ASYNC_MOBJECT_COPY_SIZE bytes will be copied into the pool's copy slots, if a slot is
+ * available. The pool is never released.
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. If the pool's address space could not be reserved, PLCRASH_ENOMEM
+ * will be returned, and mappings will continue to allocate their own address space.
+ *
+ * @warning This function is not async-safe, and must not be called concurrently with itself.
+ */
+plcrash_error_t plcrash_nasync_mobject_pool_init (void) {
+    const pl_vm_size_t mapping_size = PLCRASH_ASYNC_MOBJECT_POOL_SLOTS * PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE;
+    const pl_vm_size_t copy_size = PLCRASH_ASYNC_MOBJECT_COPY_SLOTS * PLCRASH_ASYNC_MOBJECT_COPY_SIZE;
+    pl_vm_address_t base = 0x0;
+    kern_return_t kt;
+
+    if (mobject_pool.base != 0)
+        return PLCRASH_ESUCCESS;
+
+#ifdef PL_HAVE_MACH_VM
+    kt = mach_vm_allocate(mach_task_self(), &base, mapping_size + copy_size, VM_FLAGS_ANYWHERE);
+#else
+    kt = vm_allocate(mach_task_self(), &base, mapping_size + copy_size, VM_FLAGS_ANYWHERE);
+#endif
+    if (kt != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to reserve the memory object pool: %d", kt);
+        return PLCRASH_ENOMEM;
+    }
+
+    /* Publish the base addresses before marking any slots as available */
+    mobject_pool.base = base;
+    mobject_pool.copy_base = base + mapping_size;
+    OSAtomicCompareAndSwap32Barrier(0, (int32_t) plcrash_async_mobject_pool_mask(PLCRASH_ASYNC_MOBJECT_POOL_SLOTS), &mobject_pool.free_mask);
+    OSAtomicCompareAndSwap32Barrier(0, (int32_t) plcrash_async_mobject_pool_mask(PLCRASH_ASYNC_MOBJECT_COPY_SLOTS), &mobject_pool.copy_free_mask);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Reserve a local page range of @a size bytes into which target pages may be mapped, preferring an available
+ * slot in the memory object pool.
+ *
+ * @param size The page-rounded size of the range to reserve.
+ * @param result[out] On success, the base address of the reserved range.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINTERNAL if no range could be reserved.
+ */
+static plcrash_error_t plcrash_async_mobject_reserve (pl_vm_size_t size, pl_vm_address_t *result) {
+    kern_return_t kt;
+
+    /* Try to claim a pool slot */
+    uint32_t slot;
+    if (size <= PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE && plcrash_async_mobject_claim_slot(&mobject_pool.free_mask, &slot)) {
+        *result = mobject_pool.base + (slot * PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE);
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Fall back on a new allocation */
+    pl_vm_address_t addr = 0x0;
+#ifdef PL_HAVE_MACH_VM
+    kt = mach_vm_allocate(mach_task_self(), &addr, size, VM_FLAGS_ANYWHERE);
+#else
+    kt = vm_allocate(mach_task_self(), &addr, size, VM_FLAGS_ANYWHERE);
+#endif
+    if (kt != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to allocate a target page range for the page remapping: %d", kt);
+        return PLCRASH_EINTERNAL;
+    }
+
+    *result = addr;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Release a page range previously reserved via plcrash_async_mobject_reserve(), including any target pages
+ * that have been mapped into it.
+ *
+ * Pool slots are returned to the pool after their mapped pages have been replaced with a fresh anonymous
+ * reservation; if that fails, the slot is left claimed rather than risk handing out a range that still
+ * references the previous mapping's target pages.
+ *
+ * @param addr The base address of the reserved range.
+ * @param size The size of the reserved range.
+ */
+static void plcrash_async_mobject_release (pl_vm_address_t addr, pl_vm_size_t size) {
+    kern_return_t kt;
+    pl_vm_address_t pool_base = mobject_pool.base;
+
+    if (pool_base != 0 && addr >= pool_base && addr < pool_base + (PLCRASH_ASYNC_MOBJECT_POOL_SLOTS * PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE)) {
+        uint32_t slot = (uint32_t) ((addr - pool_base) / PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE);
+        pl_vm_address_t reserve_addr = addr;
+
+#ifdef PL_HAVE_MACH_VM
+        kt = mach_vm_allocate(mach_task_self(), &reserve_addr, size, VM_FLAGS_FIXED|VM_FLAGS_OVERWRITE);
+#else
+        kt = vm_allocate(mach_task_self(), &reserve_addr, size, VM_FLAGS_FIXED|VM_FLAGS_OVERWRITE);
+#endif
+        if (kt != KERN_SUCCESS) {
+            PLCF_DEBUG("Failed to reset memory object pool slot %" PRIu32 ": %d", slot, kt);
+            return;
+        }
+
+        plcrash_async_mobject_return_slot(&mobject_pool.free_mask, slot);
+        return;
+    }
+
+#ifdef PL_HAVE_MACH_VM
+    kt = mach_vm_deallocate(mach_task_self(), addr, size);
+#else
+    kt = vm_deallocate(mach_task_self(), addr, size);
+#endif
+
+    if (kt != KERN_SUCCESS)
+        PLCF_DEBUG("vm_deallocate() failure: %d", kt);
+}
+
 /**
  * Map pages starting at @a task_addr from @a task into the current process. The mapping
  * will be copy-on-write, and will be checked to ensure a minimum protection value of
@@ -159,20 +349,15 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
     /*
      * Set aside a memory range large enough for the total requested number of pages. Ideally the kernel
      * will lazy-allocate the backing physical pages so that we don't waste actual memory on this
-     * pre-emptive page range reservation.
+     * pre-emptive page range reservation. If the memory object pool has been initialized, the range
+     * will be drawn from the pool's pre-reserved address space when possible.
      */
     pl_vm_address_t mapping_addr = 0x0;
     pl_vm_size_t mapped_size = 0;
-#ifdef PL_HAVE_MACH_VM
-    kt = mach_vm_allocate(mach_task_self(), &mapping_addr, total_size, VM_FLAGS_ANYWHERE);
-#else
-    kt = vm_allocate(mach_task_self(), &mapping_addr, total_size, VM_FLAGS_ANYWHERE);
-#endif
+    plcrash_error_t err;
 
-    if (kt != KERN_SUCCESS) {
-        PLCF_DEBUG("Failed to allocate a target page range for the page remapping: %d", kt);
-        return PLCRASH_EINTERNAL;
-    }
+    if ((err = plcrash_async_mobject_reserve(total_size, &mapping_addr)) != PLCRASH_ESUCCESS)
+        return err;
 
     /* Map the source pages into the allocated region, overwriting the existing page mappings */
     while (mapped_size < total_size) {
@@ -187,10 +372,7 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
             PLCF_DEBUG("mach_make_memory_entry_64() failed: %d", kt);
             
             /* Clean up the reserved pages */
-            kt = vm_deallocate(mach_task_self(), mapping_addr, total_size);
-            if (kt != KERN_SUCCESS) {
-                PLCF_DEBUG("vm_deallocate() failed: %d", kt);
-            }
+            plcrash_async_mobject_release(mapping_addr, total_size);
             
             /* Return error */
             return PLCRASH_ENOMEM;
@@ -214,10 +396,7 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
             PLCF_DEBUG("vm_map() failure: %d", kt);
 
             /* Clean up the reserved pages */
-            kt = vm_deallocate(mach_task_self(), mapping_addr, total_size);
-            if (kt != KERN_SUCCESS) {
-                PLCF_DEBUG("vm_deallocate() failed: %d", kt);
-            }
+            plcrash_async_mobject_release(mapping_addr, total_size);
             
             return PLCRASH_ENOMEM;
         }
@@ -233,10 +412,64 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
 }
 
 
+/**
+ * @internal
+ *
+ * Return true if @a address lies within the memory object pool's copy slots.
+ */
+static bool plcrash_async_mobject_is_copy_slot (pl_vm_address_t address) {
+    pl_vm_address_t copy_base = mobject_pool.copy_base;
+    return copy_base != 0 && address >= copy_base && address - copy_base < PLCRASH_ASYNC_MOBJECT_COPY_SLOTS * PLCRASH_ASYNC_MOBJECT_COPY_SIZE;
+}
+
+/**
+ * @internal
+ *
+ * Initialize @a mobj with a copy of the @a length bytes at @a task_addr in @a task, read into an available copy
+ * slot of the memory object pool. Copied objects hold neither a mapping nor a task reference.
+ *
+ * @param mobj Memory object to be initialized.
+ * @param task The task from which the memory will be read.
+ * @param task_addr The task-relative address of the memory to be read.
+ * @param length The number of bytes to read. Must not exceed PLCRASH_ASYNC_MOBJECT_COPY_SIZE.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOMEM if no copy slot is available, or the error returned by
+ * plcrash_async_task_memcpy() if the memory could not be read in full.
+ */
+static plcrash_error_t plcrash_async_mobject_init_copy (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length) {
+    plcrash_error_t err;
+    uint32_t slot;
+
+    if (!plcrash_async_mobject_claim_slot(&mobject_pool.copy_free_mask, &slot))
+        return PLCRASH_ENOMEM;
+
+    pl_vm_address_t copy_addr = mobject_pool.copy_base + (slot * PLCRASH_ASYNC_MOBJECT_COPY_SIZE);
+    if ((err = plcrash_async_task_memcpy(task, task_addr, 0, (void *) (uintptr_t) copy_addr, length)) != PLCRASH_ESUCCESS) {
+        plcrash_async_mobject_return_slot(&mobject_pool.copy_free_mask, slot);
+        return err;
+    }
+
+    mobj->address = copy_addr;
+    mobj->length = length;
+    mobj->vm_address = copy_addr;
+    mobj->vm_length = PLCRASH_ASYNC_MOBJECT_COPY_SIZE;
+    mobj->vm_slide = task_addr - mobj->address;
+    mobj->task_address = task_addr;
+    mobj->task = task;
+    mobj->provider = NULL;
+    mobj->borrowed = false;
+
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Initialize a new memory object reference, mapping @a task_addr from @a task into the current process. The mapping
  * will be copy-on-write, and will be checked to ensure a minimum protection value of VM_PROT_READ.
  *
+ * If the memory object pool has been initialized (see plcrash_nasync_mobject_pool_init()), objects of up to
+ * PLCRASH_ASYNC_MOBJECT_COPY_SIZE bytes are instead copied into one of the pool's copy slots, requiring a single
+ * read of the target memory. If no copy slot is available, or the full range can't be read, the memory is mapped.
+ *
  * @param mobj Memory object to be initialized.
  * @param task The task from which the memory will be mapped.
  * @param task_address The task-relative address of the memory to be mapped. This is not required to fall on a page boundry.
@@ -246,12 +479,31 @@ static plcrash_error_t plcrash_async_mobject_remap_pages_workaround (mach_port_t
  * mapping, eg, using plcrash_async_mobject_remap_address() and similar. If true, and the entire requested page range is
  * not valid, the mapping request will fail.
  *
+ * If a memory provider has been registered for @a task via plcrash_nasync_memory_provider_register(), the memory
+ * object will be initialized from the provider via plcrash_async_mobject_init_provider().
+ *
  * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned, and no
  * mapping will be performed.
  */
 plcrash_error_t plcrash_async_mobject_init (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full) {
     plcrash_error_t err;
 
+    /* Defer to a registered provider, if any */
+    const plcrash_async_memory_provider_t *provider = plcrash_async_memory_provider_find(task);
+    if (provider != NULL) {
+        if ((err = plcrash_async_mobject_init_provider(mobj, provider, task_addr, length, require_full)) != PLCRASH_ESUCCESS)
+            return err;
+
+        mobj->task = task;
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Copy small objects, rather than mapping them */
+    if (length > 0 && length <= PLCRASH_ASYNC_MOBJECT_COPY_SIZE && mobject_pool.copy_base != 0) {
+        if (plcrash_async_mobject_init_copy(mobj, task, task_addr, length) == PLCRASH_ESUCCESS)
+            return PLCRASH_ESUCCESS;
+    }
+
     /* Perform the page mapping */
     err = plcrash_async_mobject_remap_pages_workaround(task, task_addr, length, require_full, &mobj->vm_address, &mobj->vm_length);
     if (err != PLCRASH_ESUCCESS)
@@ -276,10 +528,213 @@ plcrash_error_t plcrash_async_mobject_init (plcrash_async_mobject_t *mobj, mach_
     /* Save the task reference */
     mobj->task = task;
     mach_port_mod_refs(mach_task_self(), mobj->task, MACH_PORT_RIGHT_SEND, 1);
+    mobj->provider = NULL;
+    mobj->borrowed = false;
+
+    OSAtomicIncrement32(&mobject_map_count);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Initialize a new memory object reference to @a length bytes at @a task_addr, as served by @a provider. If the
+ * provider's memory is directly accessible, the memory object will reference it in place; otherwise, the memory
+ * will be read into a newly reserved local page range.
+ *
+ * @param mobj Memory object to be initialized.
+ * @param provider The provider from which the memory will be read. Must remain valid for the lifetime of @a mobj.
+ * @param task_addr The target address of the memory.
+ * @param length The total size of the memory object.
+ * @param require_full If false, a short memory object will be permitted if only a prefix of the requested range is
+ * available; see plcrash_async_mobject_init().
+ *
+ * @return On success, returns PLCRASH_ESUCCESS. On failure, one of the plcrash_error_t error values will be returned.
+ *
+ * @note The resulting memory object's task is MACH_PORT_NULL, unless initialized via plcrash_async_mobject_init().
+ */
+plcrash_error_t plcrash_async_mobject_init_provider (plcrash_async_mobject_t *mobj, const plcrash_async_memory_provider_t *provider,
+                                                     pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full)
+{
+    pl_vm_size_t available = 0;
+    plcrash_error_t err;
+
+    if (length == 0 || PL_VM_ADDRESS_MAX - length < task_addr)
+        return PLCRASH_EINVAL;
+
+    const void *local = plcrash_async_memory_provider_local_address(provider, task_addr, &available);
+    if (local != NULL) {
+        /* Reference the provider's memory in place */
+        if (available < length) {
+            if (require_full)
+                return PLCRASH_ENOMEM;
+            length = available;
+        }
+
+        mobj->address = (uintptr_t) local;
+        mobj->vm_address = 0;
+        mobj->vm_length = 0;
+    } else {
+        /* Read the memory page by page, stopping at the first unreadable target page */
+        pl_vm_size_t total_size = mach_vm_round_page(length);
+        pl_vm_address_t mapping_addr;
+        pl_vm_size_t copied = 0;
+
+        if ((err = plcrash_async_mobject_reserve(total_size, &mapping_addr)) != PLCRASH_ESUCCESS)
+            return err;
+
+        while (copied < length) {
+            pl_vm_address_t target = task_addr + copied;
+            pl_vm_size_t count = mach_vm_trunc_page(target) + PAGE_SIZE - target;
+            if (count > length - copied)
+                count = length - copied;
+
+            if (plcrash_async_memory_provider_read(provider, target, 0, (void *) (uintptr_t) (mapping_addr + copied), count) != PLCRASH_ESUCCESS)
+                break;
+
+            copied += count;
+        }
+
+        if (copied == 0 || (require_full && copied < length)) {
+            PLCF_DEBUG("No readable memory found at 0x%" PRIx64, (uint64_t) task_addr);
+            plcrash_async_mobject_release(mapping_addr, total_size);
+            return PLCRASH_ENOMEM;
+        }
+
+        length = copied;
+        mobj->address = mapping_addr;
+        mobj->vm_address = mapping_addr;
+        mobj->vm_length = total_size;
+    }
+
+    mobj->length = length;
+    mobj->vm_slide = task_addr - mobj->address;
+    mobj->task_address = task_addr;
+    mobj->task = MACH_PORT_NULL;
+    mobj->provider = provider;
+    mobj->borrowed = false;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Determine whether @a length bytes at @a address are backed by readable, non-guard regions of the current task.
+ */
+static bool plcrash_nasync_mobject_local_readable (pl_vm_address_t address, pl_vm_size_t length) {
+    pl_vm_address_t cursor = address;
+    pl_vm_address_t end;
+
+    if (!plcrash_async_address_apply_offset(address, length, &end))
+        return false;
+
+    while (cursor < end) {
+        vm_region_submap_info_data_64_t info;
+        pl_vm_address_t base = cursor;
+        natural_t depth = 0;
+        kern_return_t kt;
+
+        /* Find the innermost region containing the cursor */
+        while (true) {
+            mach_msg_type_number_t info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
+#ifdef PL_HAVE_MACH_VM
+            pl_vm_size_t size = 0;
+            kt = mach_vm_region_recurse(mach_task_self(), &base, &size, &depth, (vm_region_recurse_info_t) &info, &info_count);
+#else
+            vm_address_t vm_address = base;
+            vm_size_t size = 0;
+            kt = vm_region_recurse_64(mach_task_self(), &vm_address, &size, &depth, (vm_region_recurse_info_t) &info, &info_count);
+            base = vm_address;
+#endif
+            if (kt != KERN_SUCCESS)
+                return false;
+
+            if (info.is_submap) {
+                depth++;
+                continue;
+            }
+
+            /* The lookup returns the first region at or above the requested address */
+            if (base > cursor || cursor - base >= size)
+                return false;
+
+            cursor = base + size;
+            break;
+        }
+
+        if (!(info.protection & VM_PROT_READ))
+            return false;
+
+#ifdef VM_MEMORY_GUARD
+        if (info.user_tag == VM_MEMORY_GUARD)
+            return false;
+#endif
+    }
 
+    return true;
+}
+
+/**
+ * Initialize a new memory object reference to @a length bytes at @a task_addr in the current task, borrowing the
+ * existing pages rather than creating a new mapping. The range is verified to be readable once, at initialization;
+ * no mapping is created, and no task reference is held.
+ *
+ * This may be used to reference memory in the current task that will remain mapped for the lifetime of the memory
+ * object, such as the header and load commands of a loaded image, which remain mapped by dyld until the image is
+ * unloaded.
+ *
+ * @param mobj Memory object to be initialized.
+ * @param task_addr The address of the memory in the current task.
+ * @param length The number of bytes to reference.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EACCESS if any part of the range is not readable.
+ *
+ * @warning This function is not async-safe. The caller is responsible for ensuring that the range remains mapped for
+ * the lifetime of the memory object.
+ */
+plcrash_error_t plcrash_nasync_mobject_init_direct (plcrash_async_mobject_t *mobj, pl_vm_address_t task_addr, pl_vm_size_t length) {
+    if (length == 0 || !plcrash_nasync_mobject_local_readable(task_addr, length))
+        return PLCRASH_EACCESS;
+
+    plcrash_async_mobject_init_local(mobj, mach_task_self(), task_addr, (const void *) (uintptr_t) task_addr, length);
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Initialize a new memory object reference to @a length bytes at @a task_addr, backed by a caller-owned local copy
+ * of the target memory at @a local. No mapping is created, and no task reference is held; the caller is responsible
+ * for ensuring that @a local remains valid for the lifetime of the memory object.
+ *
+ * This may be used to reference long-lived copies of immutable target data (such as Mach-O load commands) without
+ * consuming a VM map entry per object.
+ *
+ * @param mobj Memory object to be initialized.
+ * @param task The task from which @a local was copied.
+ * @param task_addr The target address of the memory.
+ * @param local The local copy of the target memory.
+ * @param length The size of @a local, in bytes.
+ */
+void plcrash_async_mobject_init_local (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, const void *local, pl_vm_size_t length) {
+    mobj->address = (uintptr_t) local;
+    mobj->length = length;
+    mobj->vm_address = 0;
+    mobj->vm_length = 0;
+    mobj->vm_slide = task_addr - mobj->address;
+    mobj->task_address = task_addr;
+    mobj->task = task;
+    mobj->provider = NULL;
+    mobj->borrowed = true;
+}
+
+/**
+ * Return the total number of memory objects that have been successfully mapped by plcrash_async_mobject_init()
+ * within this process. Objects copied into the memory object pool's copy slots are not counted. The count wraps on
+ * overflow; callers should compare the difference between two readings.
+ */
+uint32_t plcrash_async_mobject_map_count (void) {
+    return (uint32_t) mobject_map_count;
+}
+
 /**
  * Return the base (target process relative) address for this mapping.
  *
@@ -367,6 +822,35 @@ void *plcrash_async_mobject_remap_address (plcrash_async_mobject_t *mobj, pl_vm_
     return (void *) remapped + offset;
 }
 
+/**
+ * Initialize @a view to the @a length bytes of @a mobj starting at the target @a address + @a offset. The range is
+ * verified once; addresses within the view may then be remapped via plcrash_async_mobject_view_remap().
+ *
+ * @param view The view to be initialized.
+ * @param mobj An initialized memory object. The object must remain valid for the lifetime of @a view.
+ * @param address The base address of the view. This address should be relative to the target task's address space.
+ * @param offset An offset to be applied to @a address.
+ * @param length The length of the view, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if the requested range is not within @a mobj's range.
+ */
+plcrash_error_t plcrash_async_mobject_view_init (plcrash_async_mobject_view_t *view, plcrash_async_mobject_t *mobj,
+                                                 pl_vm_address_t address, pl_vm_off_t offset, pl_vm_size_t length)
+{
+    pl_vm_address_t start;
+    if (!plcrash_async_address_apply_offset(address, offset, &start) || length > SIZE_MAX)
+        return PLCRASH_EINVAL;
+
+    const uint8_t *base = plcrash_async_mobject_remap_address(mobj, start, 0, (size_t) length);
+    if (base == NULL)
+        return PLCRASH_EINVAL;
+
+    view->task_address = start;
+    view->base = base;
+    view->length = length;
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Read a single byte from @a mobj.
  *
@@ -406,7 +890,7 @@ plcrash_error_t plcrash_async_mobject_read_uint16 (plcrash_async_mobject_t *mobj
     if (input == NULL)
         return PLCRASH_EINVAL;
     
-    *result = byteorder->swap16(*input);
+    *result = plcrash_async_byteorder_swap16(byteorder, *input);
     return PLCRASH_ESUCCESS;
 }
 
@@ -430,7 +914,7 @@ plcrash_error_t plcrash_async_mobject_read_uint32 (plcrash_async_mobject_t *mobj
     if (input == NULL)
         return PLCRASH_EINVAL;
     
-    *result = byteorder->swap32(*input);
+    *result = plcrash_async_byteorder_swap32(byteorder, *input);
     return PLCRASH_ESUCCESS;
 }
 
@@ -453,26 +937,70 @@ plcrash_error_t plcrash_async_mobject_read_uint64 (plcrash_async_mobject_t *mobj
     if (input == NULL)
         return PLCRASH_EINVAL;
     
-    *result = byteorder->swap64(*input);
+    *result = plcrash_async_byteorder_swap64(byteorder, *input);
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Copy @a len bytes from @a task at @a address + @a offset into @a dest. If the requested range falls entirely
+ * within @a mobj, the data is copied from the existing local mapping; otherwise, the data is read from @a task via
+ * plcrash_async_task_memcpy().
+ *
+ * This may be used to serve a series of small reads from a larger, pre-mapped window (such as a thread's stack)
+ * without incurring a Mach trap per read.
+ *
+ * @param mobj Memory object from which to attempt to read the value, or NULL.
+ * @param task The task from which the data will be read if the range is not within @a mobj. If @a mobj is non-NULL,
+ * this must be the task from which @a mobj was mapped.
+ * @param address The base address to be read. This address should be relative to the target task's address space.
+ * @param offset An offset to be applied to @a address.
+ * @param dest The destination to which the data will be written.
+ * @param len The number of bytes to be read.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or one of the plcrash_error_t constants returned by
+ * plcrash_async_task_memcpy() on failure.
+ */
+plcrash_error_t plcrash_async_mobject_task_memcpy (plcrash_async_mobject_t *mobj, task_t task, pl_vm_address_t address,
+                                                   pl_vm_off_t offset, void *dest, pl_vm_size_t len)
+{
+    if (mobj != NULL) {
+        PLCF_ASSERT(mobj->task == task);
+
+        void *src = plcrash_async_mobject_remap_address(mobj, address, offset, len);
+        if (src != NULL) {
+            plcrash_async_memcpy(dest, src, len);
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
+    return plcrash_async_task_memcpy(task, address, offset, dest, len);
+}
+
 /**
  * Free the memory mapping.
  *
  * @note Unlike most free() functions in this API, this function is async-safe.
  */
 void plcrash_async_mobject_free (plcrash_async_mobject_t *mobj) {
-    kern_return_t kt;
-    
-#ifdef PL_HAVE_MACH_VM
-    kt = mach_vm_deallocate(mach_task_self(), mobj->vm_address, mobj->vm_length);
-#else
-    kt = vm_deallocate(mach_task_self(), mobj->vm_address, mobj->vm_length);
-#endif
-    
-    if (kt != KERN_SUCCESS)
-        PLCF_DEBUG("vm_deallocate() failure: %d", kt);
+    /* Borrowed local memory is owned by the caller */
+    if (mobj->borrowed)
+        return;
+
+    /* Copied objects hold no task reference; their slot is returned to the pool */
+    if (plcrash_async_mobject_is_copy_slot(mobj->vm_address)) {
+        uint32_t slot = (uint32_t) ((mobj->vm_address - mobject_pool.copy_base) / PLCRASH_ASYNC_MOBJECT_COPY_SIZE);
+        plcrash_async_mobject_return_slot(&mobject_pool.copy_free_mask, slot);
+        return;
+    }
+
+    /* Provider-backed objects hold no task reference, and only hold a mapping if the memory was copied */
+    if (mobj->provider != NULL) {
+        if (mobj->vm_length != 0)
+            plcrash_async_mobject_release(mobj->vm_address, mobj->vm_length);
+        return;
+    }
+
+    plcrash_async_mobject_release(mobj->vm_address, mobj->vm_length);
 
     /* Decrement our task refcount */
     mach_port_mod_refs(mach_task_self(), mobj->task, MACH_PORT_RIGHT_SEND, -1);
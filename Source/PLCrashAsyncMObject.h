@@ -35,6 +35,42 @@ extern "C" {
 
 #include <stdint.h>
 #include "PLCrashAsync.h"
+#include "PLCrashAsyncMemoryProvider.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The size of each slot in the memory object pool; see plcrash_nasync_mobject_pool_init(). Mappings larger than
+ * this size are allocated outside of the pool.
+ */
+#define PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE (256 * 1024)
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The number of slots in the memory object pool. Must not exceed 32.
+ */
+#define PLCRASH_ASYNC_MOBJECT_POOL_SLOTS 32
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The largest memory object that plcrash_async_mobject_init() will copy into a pool copy slot, rather than map. For
+ * small objects, a single read of the target memory is considerably cheaper than establishing, and later releasing,
+ * a mapping.
+ */
+#define PLCRASH_ASYNC_MOBJECT_COPY_SIZE 4096
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The number of copy slots in the memory object pool. Must not exceed 32.
+ */
+#define PLCRASH_ASYNC_MOBJECT_COPY_SLOTS 32
 
 /**
  * @ingroup plcrash_async
@@ -67,9 +103,44 @@ typedef struct plcrash_async_mobject {
     
     /** The actual mapping size. This may differ from the user-requested size, as the base address has been page-aligned */
     pl_vm_size_t vm_length;
+
+    /** The memory provider from which the object was initialized, or NULL if mapped from a live Mach task. If the
+     * provider's memory was directly accessible, no mapping was created, and @a vm_length is 0. */
+    const plcrash_async_memory_provider_t *provider;
+
+    /** If true, the object references caller-owned local memory (see plcrash_async_mobject_init_local()), and holds
+     * neither a mapping nor a task reference. */
+    bool borrowed;
 } plcrash_async_mobject_t;
 
+/**
+ * @ingroup plcrash_async
+ * @internal
+ *
+ * A verified span of a memory object. The span's bounds are verified against the backing memory object once, on
+ * initialization; subsequent remapping of target addresses within the span is performed inline, with a single bounds
+ * check, avoiding the per-read cost of plcrash_async_mobject_remap_address() in hot parsing loops.
+ *
+ * A view borrows the backing memory object's mapping, and must not be used after the memory object is freed.
+ */
+typedef struct plcrash_async_mobject_view {
+    /** The task-relative address of the first byte of the view. */
+    pl_vm_address_t task_address;
+
+    /** The locally mapped address of the first byte of the view. */
+    const uint8_t *base;
+
+    /** The length of the view, in bytes. */
+    pl_vm_size_t length;
+} plcrash_async_mobject_view_t;
+
+plcrash_error_t plcrash_nasync_mobject_pool_init (void);
+
 plcrash_error_t plcrash_async_mobject_init (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full);
+plcrash_error_t plcrash_async_mobject_init_provider (plcrash_async_mobject_t *mobj, const plcrash_async_memory_provider_t *provider,
+                                                     pl_vm_address_t task_addr, pl_vm_size_t length, bool require_full);
+void plcrash_async_mobject_init_local (plcrash_async_mobject_t *mobj, mach_port_t task, pl_vm_address_t task_addr, const void *local, pl_vm_size_t length);
+plcrash_error_t plcrash_nasync_mobject_init_direct (plcrash_async_mobject_t *mobj, pl_vm_address_t task_addr, pl_vm_size_t length);
 
 pl_vm_address_t plcrash_async_mobject_base_address (plcrash_async_mobject_t *mobj);
 pl_vm_address_t plcrash_async_mobject_length (plcrash_async_mobject_t *mobj);
@@ -87,7 +158,55 @@ plcrash_error_t plcrash_async_mobject_read_uint32 (plcrash_async_mobject_t *mobj
 plcrash_error_t plcrash_async_mobject_read_uint64 (plcrash_async_mobject_t *mobj, const plcrash_async_byteorder_t *byteorder,
                                                    pl_vm_address_t address, pl_vm_off_t offset, uint64_t *result);
 
+plcrash_error_t plcrash_async_mobject_task_memcpy (plcrash_async_mobject_t *mobj, task_t task, pl_vm_address_t address,
+                                                   pl_vm_off_t offset, void *dest, pl_vm_size_t len);
+
 void plcrash_async_mobject_free (plcrash_async_mobject_t *mobj);
+
+plcrash_error_t plcrash_async_mobject_view_init (plcrash_async_mobject_view_t *view, plcrash_async_mobject_t *mobj,
+                                                 pl_vm_address_t address, pl_vm_off_t offset, pl_vm_size_t length);
+
+uint32_t plcrash_async_mobject_map_count (void);
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Verify that @a length bytes can be read from @a view at the target @a address + @a offset, and return the local
+ * pointer from which the read may be performed. This is the inline equivalent of plcrash_async_mobject_remap_address().
+ *
+ * @param view An initialized view.
+ * @param address The base address to be read. This address should be relative to the target task's address space.
+ * @param offset An offset to be applied to @a address.
+ * @param length The total number of bytes that should be readable at @a address + @a offset.
+ *
+ * @return Returns the validated pointer, or NULL if the requested bytes are not within @a view.
+ */
+static inline void *plcrash_async_mobject_view_remap (const plcrash_async_mobject_view_t *view, pl_vm_address_t address, pl_vm_off_t offset, size_t length) {
+    /* Addresses below the view wrap to offsets beyond its length, and are rejected by the same bounds check */
+    pl_vm_address_t start = (address - view->task_address) + (pl_vm_address_t) offset;
+    if (start > view->length || length > view->length - start)
+        return NULL;
+
+    return (void *) (view->base + start);
+}
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Verify that @a length bytes starting at the local @a pointer + @a offset lie within @a view. This is the inline
+ * equivalent of plcrash_async_mobject_verify_local_pointer().
+ *
+ * @param view An initialized view.
+ * @param pointer A local pointer, as returned by plcrash_async_mobject_view_remap().
+ * @param offset An offset to be applied to @a pointer prior to verifying the range.
+ * @param length The number of bytes that should be readable at @a pointer + @a offset.
+ */
+static inline bool plcrash_async_mobject_view_verify_local_pointer (const plcrash_async_mobject_view_t *view, const void *pointer, pl_vm_off_t offset, size_t length) {
+    pl_vm_address_t start = ((uintptr_t) pointer - (uintptr_t) view->base) + (pl_vm_address_t) offset;
+    return start <= view->length && length <= view->length - start;
+}
     
 #ifdef __cplusplus
 }
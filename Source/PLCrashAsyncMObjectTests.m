@@ -165,6 +165,43 @@
     plcrash_async_mobject_free(&mobj);
 }
 
+/**
+ * Test view initialization, remapping, and local pointer validation.
+ */
+- (void) testView {
+    size_t size = vm_page_size+1;
+    uint8_t template[size];
+
+    plcrash_async_mobject_t mobj;
+    plcrash_async_mobject_view_t view;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t)template, size, true), @"Failed to initialize mapping");
+
+    /* Views must lie within the memory object */
+    STAssertNotEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_view_init(&view, &mobj, (pl_vm_address_t) template, -1, 2), @"Initialized a view that starts before our memory object");
+    STAssertNotEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_view_init(&view, &mobj, (pl_vm_address_t) template, 1, size), @"Initialized a view that ends after our memory object");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_view_init(&view, &mobj, (pl_vm_address_t) template, 1, size - 2), @"Failed to initialize view");
+
+    /* Remapping must match the memory object */
+    STAssertEquals(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template, 1, 1), plcrash_async_mobject_remap_address(&mobj, (pl_vm_address_t) template, 1, 1), @"Mapped to incorrect address");
+    STAssertEquals(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template + 3, -1, 4), plcrash_async_mobject_remap_address(&mobj, (pl_vm_address_t) template, 2, 4), @"Mapped to incorrect address");
+    STAssertNotNULL(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template + 1, 0, size - 2), @"Failed to remap the entire view");
+
+    /* Ranges outside the view are rejected, even if within the memory object */
+    STAssertNULL(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template, 0, 1), @"Remapped a range that starts before our view");
+    STAssertNULL(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template, 1, size - 1), @"Remapped a range that ends after our view");
+    STAssertNULL(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template + size - 1, 0, 1), @"Remapped a range that starts at the end of our view");
+    STAssertNULL(plcrash_async_mobject_view_remap(&view, (pl_vm_address_t) template + 1, 0, SIZE_MAX), @"Remapped an overflowing range");
+
+    /* Local pointer validation */
+    const void *base = view.base;
+    STAssertTrue(plcrash_async_mobject_view_verify_local_pointer(&view, base, 0, size - 2), @"Returned false for a range that comprises our entire view");
+    STAssertTrue(plcrash_async_mobject_view_verify_local_pointer(&view, (const uint8_t *) base + 1, -1, 1), @"Returned false for a valid range at the start of our view");
+    STAssertFalse(plcrash_async_mobject_view_verify_local_pointer(&view, base, -1, 1), @"Returned true for a range that starts before our view");
+    STAssertFalse(plcrash_async_mobject_view_verify_local_pointer(&view, base, size - 3, 2), @"Returned true for a range that ends after our view");
+
+    plcrash_async_mobject_free(&mobj);
+}
+
 /**
  * Test byte/multibyte read routines.
  */
@@ -203,4 +240,107 @@
     plcrash_async_mobject_free(&mobj);
 }
 
+/**
+ * Test that task reads are served from the mapping when possible, and fall back to the task otherwise.
+ */
+- (void) testTaskMemcpy {
+    uint8_t test_bytes[] = { 0x00, 0x01, 0x02, 0x03 , 0x04, 0x05, 0x06, 0x07 };
+    uint8_t outside_bytes[] = { 0x08, 0x09 };
+    uint8_t dest[2];
+
+    /* Map the first half of the memory */
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) test_bytes, 4, true), @"Failed to initialize mapping");
+
+    /* Read from within the mapping */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_task_memcpy(&mobj, mach_task_self(), (pl_vm_address_t) test_bytes, 2, dest, sizeof(dest)), @"Failed to read data");
+    STAssertEquals(dest[0], (uint8_t) 0x02, @"Incorrect data");
+    STAssertEquals(dest[1], (uint8_t) 0x03, @"Incorrect data");
+
+    /* Read from outside the mapping */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_task_memcpy(&mobj, mach_task_self(), (pl_vm_address_t) outside_bytes, 0, dest, sizeof(dest)), @"Failed to read data");
+    STAssertEquals(dest[0], (uint8_t) 0x08, @"Incorrect data");
+    STAssertEquals(dest[1], (uint8_t) 0x09, @"Incorrect data");
+
+    /* Read without a mapping */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_task_memcpy(NULL, mach_task_self(), (pl_vm_address_t) test_bytes, 6, dest, sizeof(dest)), @"Failed to read data");
+    STAssertEquals(dest[0], (uint8_t) 0x06, @"Incorrect data");
+    STAssertEquals(dest[1], (uint8_t) 0x07, @"Incorrect data");
+
+    /* Clean up */
+    plcrash_async_mobject_free(&mobj);
+}
+
+/**
+ * Test repeated mapping via the memory object pool, including reuse of released slots and mappings too large for
+ * a pool slot.
+ */
+- (void) testPool {
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_mobject_pool_init(), @"Failed to initialize the pool");
+
+    /* Map more objects than there are pool slots, verifying the mapped data each time */
+    vm_size_t size = vm_page_size * 2;
+    uint8_t *template = malloc(size);
+    for (size_t i = 0; i < size; i++)
+        template[i] = (uint8_t) i;
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_MOBJECT_POOL_SLOTS * 2; i++) {
+        plcrash_async_mobject_t mobj;
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) template, size, true), @"Failed to initialize mapping");
+        STAssertTrue(memcmp((void *) mobj.address, template, size) == 0, @"Mapping does not match the source memory");
+        plcrash_async_mobject_free(&mobj);
+    }
+    free(template);
+
+    /* Map an object larger than a pool slot */
+    size = PLCRASH_ASYNC_MOBJECT_POOL_SLOT_SIZE * 2;
+    template = malloc(size);
+    memset(template, 0xAB, size);
+
+    plcrash_async_mobject_t large;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&large, mach_task_self(), (pl_vm_address_t) template, size, true), @"Failed to initialize mapping");
+    STAssertTrue(memcmp((void *) large.address, template, size) == 0, @"Mapping does not match the source memory");
+    plcrash_async_mobject_free(&large);
+    free(template);
+}
+
+/**
+ * Test copying of small objects into the memory object pool's copy slots, including reuse of released slots, and
+ * the fallback to mapping for short objects.
+ */
+- (void) testPoolCopy {
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_mobject_pool_init(), @"Failed to initialize the pool");
+
+    /* Copy more objects than there are copy slots; none should be mapped */
+    uint8_t template[PLCRASH_ASYNC_MOBJECT_COPY_SIZE];
+    for (size_t i = 0; i < sizeof(template); i++)
+        template[i] = (uint8_t) i;
+
+    uint32_t maps = plcrash_async_mobject_map_count();
+    for (size_t i = 0; i < PLCRASH_ASYNC_MOBJECT_COPY_SLOTS * 2; i++) {
+        plcrash_async_mobject_t mobj;
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), (pl_vm_address_t) template, sizeof(template), true), @"Failed to initialize object");
+        STAssertEquals(plcrash_async_mobject_length(&mobj), (pl_vm_address_t) sizeof(template), @"Incorrect length");
+        STAssertTrue(memcmp(plcrash_async_mobject_remap_address(&mobj, (pl_vm_address_t) template, 0, sizeof(template)), template, sizeof(template)) == 0, @"Copy does not match the source memory");
+        STAssertNULL(plcrash_async_mobject_remap_address(&mobj, (pl_vm_address_t) template, 1, sizeof(template)), @"Read beyond the object's length permitted");
+        plcrash_async_mobject_free(&mobj);
+    }
+    STAssertEquals(plcrash_async_mobject_map_count() - maps, (uint32_t) 0, @"Small objects were mapped");
+
+    /* Objects that can't be read in full fall back on a (short) mapping */
+    vm_address_t pages = 0;
+    STAssertEquals(vm_allocate(mach_task_self(), &pages, vm_page_size * 2, VM_FLAGS_ANYWHERE), KERN_SUCCESS, @"Failed to allocate pages");
+    STAssertEquals(vm_protect(mach_task_self(), pages + vm_page_size, vm_page_size, false, VM_PROT_NONE), KERN_SUCCESS, @"Failed to protect page");
+
+    plcrash_async_mobject_t mobj;
+    pl_vm_address_t addr = pages + vm_page_size - 16;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), addr, 64, false), @"Failed to initialize short object");
+    STAssertEquals(plcrash_async_mobject_length(&mobj), (pl_vm_address_t) 16, @"Incorrect short object length");
+    plcrash_async_mobject_free(&mobj);
+
+    STAssertNotEquals(PLCRASH_ESUCCESS, plcrash_async_mobject_init(&mobj, mach_task_self(), addr, 64, true), @"Unreadable object was initialized");
+
+    vm_deallocate(mach_task_self(), pages, vm_page_size * 2);
+}
+
 @end
@@ -176,6 +176,35 @@ bool plcrash_async_mach_exception_get_siginfo (exception_type_t exception_type,
     return true;
 }
 
+/**
+ * @internal
+ *
+ * Return the name of the resource described by an EXC_RESOURCE exception's first @a code, or NULL if the resource type
+ * is unknown.
+ *
+ * @param code The first Mach exception code of an EXC_RESOURCE exception.
+ */
+const char *plcrash_async_mach_exception_resource_name (mach_exception_data_type_t code) {
+    switch (PLCRASH_EXC_RESOURCE_TYPE(code)) {
+        case PLCRASH_EXC_RESOURCE_TYPE_CPU:
+            return "CPU";
+
+        case PLCRASH_EXC_RESOURCE_TYPE_WAKEUPS:
+            return "WAKEUPS";
+
+        case PLCRASH_EXC_RESOURCE_TYPE_MEMORY:
+            return "MEMORY";
+
+        case PLCRASH_EXC_RESOURCE_TYPE_IO:
+            return "IO";
+
+        case PLCRASH_EXC_RESOURCE_TYPE_THREADS:
+            return "THREADS";
+    }
+
+    return NULL;
+}
+
 /**
  * @} plcrash_async_mach_exception_info
  */
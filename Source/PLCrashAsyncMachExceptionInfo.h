@@ -73,7 +73,46 @@ PLCR_C_BEGIN_DECLS
 #define EXC_UNIX_ABORT          0x10002     /* SIGABRT */
 #endif
 
+/*
+ * EXC_RESOURCE was introduced in xnu 12.x (iOS 5.1, Mac OS X 10.8). The layout of its first code is defined by the
+ * unpublished xnu kern/exc_resource.h header: the resource type is encoded in bits 61-63, and the flavor in bits 58-60.
+ */
+#ifndef EXC_RESOURCE
+#define EXC_RESOURCE            11
+#endif
+
+#ifndef EXC_MASK_RESOURCE
+#define EXC_MASK_RESOURCE       (1 << EXC_RESOURCE)
+#endif
+
+/** Extract the resource type from an EXC_RESOURCE exception's first code. */
+#define PLCRASH_EXC_RESOURCE_TYPE(code)     ((uint32_t) (((uint64_t) (code) >> 61) & 0x7))
+
+/** Extract the resource flavor from an EXC_RESOURCE exception's first code. */
+#define PLCRASH_EXC_RESOURCE_FLAVOR(code)   ((uint32_t) (((uint64_t) (code) >> 58) & 0x7))
+
+/**
+ * EXC_RESOURCE resource types, as returned by PLCRASH_EXC_RESOURCE_TYPE().
+ */
+typedef enum {
+    /** CPU usage monitor. */
+    PLCRASH_EXC_RESOURCE_TYPE_CPU = 1,
+
+    /** Idle wakeup monitor. */
+    PLCRASH_EXC_RESOURCE_TYPE_WAKEUPS = 2,
+
+    /** Memory footprint limit. */
+    PLCRASH_EXC_RESOURCE_TYPE_MEMORY = 3,
+
+    /** Disk I/O monitor. */
+    PLCRASH_EXC_RESOURCE_TYPE_IO = 4,
+
+    /** Thread count limit. */
+    PLCRASH_EXC_RESOURCE_TYPE_THREADS = 5
+} plcrash_exc_resource_type_t;
+
 bool plcrash_async_mach_exception_get_siginfo (exception_type_t exception_type, mach_exception_data_t codes, mach_msg_type_number_t code_count, cpu_type_t cpu_type, siginfo_t *siginfo);
+const char *plcrash_async_mach_exception_resource_name (mach_exception_data_type_t code);
 
 /**
  * @} plcrash_async_mach_exception_info
@@ -79,6 +79,19 @@
     TEST_ME(CPU_TYPE_ANY, EXC_BREAKPOINT, KERN_INVALID_ADDRESS, 0x4, SIGTRAP, TRAP_BRKPT, 0x4);
 }
 
+- (void) testResourceName {
+    /* CPU monitor, flavor 1, with a 50% limit */
+    mach_exception_data_type_t cpu = (1ULL << 61) | (1ULL << 58) | 50;
+    STAssertEquals(PLCRASH_EXC_RESOURCE_TYPE(cpu), (uint32_t) PLCRASH_EXC_RESOURCE_TYPE_CPU, @"Incorrect resource type");
+    STAssertEquals(PLCRASH_EXC_RESOURCE_FLAVOR(cpu), (uint32_t) 1, @"Incorrect resource flavor");
+    STAssertEqualCStrings(plcrash_async_mach_exception_resource_name(cpu), "CPU", @"Incorrect resource name");
+
+    mach_exception_data_type_t wakeups = (2ULL << 61) | (1ULL << 58);
+    STAssertEqualCStrings(plcrash_async_mach_exception_resource_name(wakeups), "WAKEUPS", @"Incorrect resource name");
+
+    STAssertNULL(plcrash_async_mach_exception_resource_name(0), @"Unknown resource type was named");
+}
+
 @end
 
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
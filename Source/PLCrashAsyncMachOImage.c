@@ -27,12 +27,30 @@
  */
 
 #include "PLCrashAsyncMachOImage.h"
+#include "PLCrashAsyncObjCSection.h"
+#include "PLCrashAsyncDwarfCFATable.h"
+#include "PLCrashAsyncDwarfFDEIndex.h"
+#include "PLCrashFeatureConfig.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
 #include <assert.h>
 
+#include <libkern/OSAtomic.h>
+#include <pthread.h>
+
+/* Vectorized symbol table scans; see plcrash_async_macho_find_best_symbol_vector() */
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define PL_ASYNC_MACHO_VECTOR_SCAN 1
+#elif defined(__x86_64__) && defined(__SSE4_2__)
+#  include <nmmintrin.h>
+#  define PL_ASYNC_MACHO_VECTOR_SCAN 1
+#else
+#  define PL_ASYNC_MACHO_VECTOR_SCAN 0
+#endif
+
 #include <mach-o/fat.h>
 
 /**
@@ -45,9 +63,355 @@
  * @{
  */
 
+/* The load command types recorded by plcrash_async_macho_cmd_cache_t */
+static const uint32_t plcrash_async_macho_cached_commands[PLCRASH_ASYNC_MACHO_CACHED_COMMAND_COUNT] = {
+    LC_SYMTAB,
+    LC_DYSYMTAB,
+    LC_UUID
+};
+
+/* The segments recorded by plcrash_async_macho_cmd_cache_t */
+static const char * const plcrash_async_macho_cached_segments[PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT] = {
+    SEG_TEXT,
+    SEG_DATA,
+    SEG_OBJC,
+    SEG_LINKEDIT
+};
+
+/* The sections recorded by plcrash_async_macho_cmd_cache_t. Each section's segment must also be
+ * listed in plcrash_async_macho_cached_segments. */
+static const struct {
+    const char *segname;
+    const char *sectname;
+} plcrash_async_macho_cached_sections[PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT] = {
+    { SEG_TEXT, "__unwind_info" },
+    { SEG_TEXT, "__eh_frame" },
+    { SEG_TEXT, "__eh_frame_hdr" },
+    { SEG_DATA, "__objc_classlist" },
+    { SEG_DATA, "__objc_const" },
+    { SEG_DATA, "__objc_data" },
+    { SEG_OBJC, "__module_info" }
+};
+
+/* Packed forms of plcrash_async_macho_cached_segments and plcrash_async_macho_cached_sections. These are initialized
+ * once, prior to populating any image's load command cache; see plcrash_nasync_macho_cached_names_init(). */
+static plcrash_async_macho_name_t plcrash_async_macho_cached_segment_names[PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT];
+static struct {
+    plcrash_async_macho_name_t segname;
+    plcrash_async_macho_name_t sectname;
+} plcrash_async_macho_cached_section_names[PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT];
+static pthread_once_t plcrash_async_macho_cached_names_once = PTHREAD_ONCE_INIT;
+
+/* Populate the packed cached segment and section name tables. */
+static void plcrash_nasync_macho_cached_names_init (void) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT; i++)
+        plcrash_async_macho_name_init(&plcrash_async_macho_cached_segment_names[i], plcrash_async_macho_cached_segments[i]);
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT; i++) {
+        plcrash_async_macho_name_init(&plcrash_async_macho_cached_section_names[i].segname, plcrash_async_macho_cached_sections[i].segname);
+        plcrash_async_macho_name_init(&plcrash_async_macho_cached_section_names[i].sectname, plcrash_async_macho_cached_sections[i].sectname);
+    }
+}
+
+/* Return true if the packed names @a n1 and @a n2 are equal. */
+static inline bool plcrash_async_macho_name_equal (const plcrash_async_macho_name_t *n1, const plcrash_async_macho_name_t *n2) {
+    return n1->words[0] == n2->words[0] && n1->words[1] == n2->words[1];
+}
+
+/**
+ * Pack the segment or section name @a str for comparison against the fixed-width names of Mach-O load commands.
+ * Names longer than 16 bytes are truncated, matching the semantics of a strncmp() of the name field.
+ *
+ * @param name The packed name to be initialized.
+ * @param str The NUL-terminated name.
+ */
+void plcrash_async_macho_name_init (plcrash_async_macho_name_t *name, const char *str) {
+    uint8_t *bytes = (uint8_t *) name->words;
+    uint8_t *mask = (uint8_t *) name->mask;
+    size_t i;
+
+    for (i = 0; i < sizeof(name->words) && str[i] != '\0'; i++) {
+        bytes[i] = str[i];
+        mask[i] = 0xFF;
+    }
+
+    /* Unless the name fills the field, the image's name must also terminate at the same position */
+    if (i < sizeof(name->words)) {
+        bytes[i] = 0;
+        mask[i] = 0xFF;
+        i++;
+    }
+
+    /* Any bytes following the terminator are ignored */
+    for (; i < sizeof(name->words); i++) {
+        bytes[i] = 0;
+        mask[i] = 0;
+    }
+}
+
+/**
+ * Return true if the 16 byte segment or section name @a field, as found in a segment_command or section structure,
+ * matches the packed @a name.
+ *
+ * @param name The packed name.
+ * @param field A readable, 16 byte name field. The field need not be NUL-terminated, or aligned.
+ */
+bool plcrash_async_macho_name_matches (const plcrash_async_macho_name_t *name, const char *field) {
+    uint64_t words[2];
+    plcrash_async_memcpy(words, field, sizeof(words));
+
+    return (words[0] & name->mask[0]) == name->words[0] && (words[1] & name->mask[1]) == name->words[1];
+}
+
+/**
+ * Record the cached sections found within @a segment.
+ *
+ * @param image The image containing @a segment.
+ * @param segment The mapped segment command.
+ * @param segname The packed name of @a segment.
+ *
+ * @return Returns true on success, or false if the segment's section table could not be verified.
+ */
+static bool plcrash_nasync_macho_cmd_cache_sections (plcrash_async_macho_t *image, void *segment, const plcrash_async_macho_name_t *segname) {
+    plcrash_async_macho_cmd_cache_t *cache = &image->cmd_cache;
+    uint32_t nsects;
+    uintptr_t cursor = (uintptr_t) segment;
+    size_t sectsize;
+
+    if (image->m64) {
+        nsects = image->byteorder->swap32(((struct segment_command_64 *) segment)->nsects);
+        cursor += sizeof(struct segment_command_64);
+        sectsize = sizeof(struct section_64);
+    } else {
+        nsects = image->byteorder->swap32(((struct segment_command *) segment)->nsects);
+        cursor += sizeof(struct segment_command);
+        sectsize = sizeof(struct section);
+    }
+
+    for (uint32_t i = 0; i < nsects; i++, cursor += sectsize) {
+        if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, cursor, 0, sectsize))
+            return false;
+
+        /* The section name is at the same offset in both section and section_64 */
+        const char *sectname = ((struct section *) cursor)->sectname;
+        for (size_t j = 0; j < PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT; j++) {
+            if (cache->sections[j] != NULL)
+                continue;
+
+            if (!plcrash_async_macho_name_equal(&plcrash_async_macho_cached_section_names[j].segname, segname))
+                continue;
+
+            if (plcrash_async_macho_name_matches(&plcrash_async_macho_cached_section_names[j].sectname, sectname))
+                cache->sections[j] = (void *) cursor;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Populate @a image's load command cache. If the load commands can not be fully parsed, the cache will be
+ * marked as invalid, and lookups will fall back to iterating the load commands.
+ *
+ * @param image The image for which the cache should be populated. The image's load commands must be mapped.
+ */
+static void plcrash_nasync_macho_cmd_cache_init (plcrash_async_macho_t *image) {
+    plcrash_async_macho_cmd_cache_t *cache = &image->cmd_cache;
+    uint32_t segment_type = image->m64 ? LC_SEGMENT_64 : LC_SEGMENT;
+    struct load_command *cmd = NULL;
+
+    memset(cache, 0, sizeof(*cache));
+    pthread_once(&plcrash_async_macho_cached_names_once, plcrash_nasync_macho_cached_names_init);
+
+    while ((cmd = plcrash_async_macho_next_command(image, cmd)) != NULL) {
+        uint32_t type = image->byteorder->swap32(cmd->cmd);
+
+        for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_COMMAND_COUNT; i++) {
+            if (cache->commands[i] == NULL && plcrash_async_macho_cached_commands[i] == type)
+                cache->commands[i] = cmd;
+        }
+
+        if (type != segment_type)
+            continue;
+
+        /* The segment name is at the same offset in both segment_command and segment_command_64 */
+        size_t cmdsize = image->m64 ? sizeof(struct segment_command_64) : sizeof(struct segment_command);
+        if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, (uintptr_t) cmd, 0, cmdsize)) {
+            PLCF_DEBUG("LC_SEGMENT command was too short in: %s", image->name);
+            return;
+        }
+
+        const char *segname = ((struct segment_command *) cmd)->segname;
+        for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT; i++) {
+            if (cache->segments[i] != NULL)
+                continue;
+
+            if (!plcrash_async_macho_name_matches(&plcrash_async_macho_cached_segment_names[i], segname))
+                continue;
+
+            /* Only the sections of the first segment of a given name are considered, matching plcrash_async_macho_map_section() */
+            cache->segments[i] = cmd;
+            if (!plcrash_nasync_macho_cmd_cache_sections(image, cmd, &plcrash_async_macho_cached_segment_names[i])) {
+                PLCF_DEBUG("Section table entry outside of expected range in segment %s of: %s", plcrash_async_macho_cached_segments[i], image->name);
+                return;
+            }
+        }
+    }
+
+    cache->valid = true;
+}
+
+/* Return true if the cached section at @a index is present, and non-empty */
+static bool plcrash_nasync_macho_cached_section_nonempty (plcrash_async_macho_t *image, size_t index) {
+    void *sect = image->cmd_cache.sections[index];
+    if (sect == NULL)
+        return false;
+
+    if (image->m64)
+        return image->byteorder->swap64(((struct section_64 *) sect)->size) != 0;
+
+    return image->byteorder->swap32(((struct section *) sect)->size) != 0;
+}
+
+/**
+ * @internal
+ *
+ * Compute @a image's symbolication capabilities from its cached load command metadata. If the load command cache
+ * is not valid, all capabilities are assumed.
+ *
+ * @param image The image for which capabilities will be computed. The load command cache must have been initialized.
+ */
+static void plcrash_nasync_macho_capabilities_init (plcrash_async_macho_t *image) {
+    const plcrash_async_macho_cmd_cache_t *cache = &image->cmd_cache;
+
+    image->capabilities = 0;
+    image->local_symbol_count = 0;
+
+    if (!cache->valid) {
+        image->capabilities = PLCRASH_ASYNC_MACHO_CAPABILITY_ALL;
+        return;
+    }
+
+    /* Symbol table; only defined symbols are used for symbolication */
+    struct symtab_command *symtab = plcrash_async_macho_find_command(image, LC_SYMTAB);
+    struct dysymtab_command *dysymtab = plcrash_async_macho_find_command(image, LC_DYSYMTAB);
+    if (symtab != NULL && plcrash_async_mobject_verify_local_pointer(&image->load_cmds, (uintptr_t) symtab, 0, sizeof(*symtab))) {
+        uint32_t nsyms = image->byteorder->swap32(symtab->nsyms);
+        uint32_t defined = nsyms;
+
+        image->local_symbol_count = nsyms;
+        if (dysymtab != NULL && plcrash_async_mobject_verify_local_pointer(&image->load_cmds, (uintptr_t) dysymtab, 0, sizeof(*dysymtab))) {
+            image->local_symbol_count = image->byteorder->swap32(dysymtab->nlocalsym);
+            defined = image->local_symbol_count + image->byteorder->swap32(dysymtab->nextdefsym);
+        }
+
+        if (nsyms > 0 && defined > 0)
+            image->capabilities |= PLCRASH_ASYNC_MACHO_CAPABILITY_SYMTAB;
+    }
+
+    /* Objective-C metadata */
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT; i++) {
+        if (!plcrash_nasync_macho_cached_section_nonempty(image, i))
+            continue;
+
+        if (strcmp(plcrash_async_macho_cached_sections[i].sectname, "__objc_classlist") == 0)
+            image->capabilities |= PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC2;
+        else if (strcmp(plcrash_async_macho_cached_sections[i].sectname, "__module_info") == 0)
+            image->capabilities |= PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC1;
+    }
+}
+
+/**
+ * @internal
+ *
+ * A load command arena chunk.
+ */
+struct plcrash_async_macho_cmd_arena_chunk {
+    /** The previously filled chunk, or NULL. */
+    struct plcrash_async_macho_cmd_arena_chunk *next;
+
+    /** The total size of @a data, in bytes. */
+    size_t size;
+
+    /** The number of bytes of @a data that have been allocated. */
+    size_t used;
+
+    /** The chunk's storage. */
+    uint8_t data[];
+};
+
+/**
+ * Initialize an empty load command arena.
+ *
+ * @param arena The arena to be initialized.
+ */
+void plcrash_nasync_macho_cmd_arena_init (plcrash_async_macho_cmd_arena_t *arena) {
+    arena->chunks = NULL;
+}
+
+/**
+ * Free all chunks allocated by @a arena. All images initialized with @a arena must have been freed first.
+ *
+ * @param arena The arena to be freed.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_macho_cmd_arena_free (plcrash_async_macho_cmd_arena_t *arena) {
+    while (arena->chunks != NULL) {
+        struct plcrash_async_macho_cmd_arena_chunk *next = arena->chunks->next;
+        free(arena->chunks);
+        arena->chunks = next;
+    }
+}
+
+/**
+ * Return the total size of the chunks allocated by @a arena, in bytes.
+ *
+ * @param arena The arena to be measured.
+ *
+ * @warning This method is not async safe, and must be serialized with allocations from @a arena.
+ */
+size_t plcrash_nasync_macho_cmd_arena_size (plcrash_async_macho_cmd_arena_t *arena) {
+    size_t total = 0;
+    for (struct plcrash_async_macho_cmd_arena_chunk *chunk = arena->chunks; chunk != NULL; chunk = chunk->next)
+        total += sizeof(*chunk) + chunk->size;
+
+    return total;
+}
+
+/*
+ * Allocate @a size bytes, 8-byte aligned, from @a arena, or return NULL if allocation fails.
+ */
+static void *plcrash_nasync_macho_cmd_arena_alloc (plcrash_async_macho_cmd_arena_t *arena, size_t size) {
+    struct plcrash_async_macho_cmd_arena_chunk *chunk = arena->chunks;
+
+    size = (size + 7) & ~((size_t) 7);
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        size_t chunk_size = size > PLCRASH_ASYNC_MACHO_CMD_ARENA_CHUNK_SIZE ? size : PLCRASH_ASYNC_MACHO_CMD_ARENA_CHUNK_SIZE;
+        chunk = malloc(sizeof(*chunk) + chunk_size);
+        if (chunk == NULL)
+            return NULL;
+
+        chunk->size = chunk_size;
+        chunk->used = 0;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+
+    void *result = chunk->data + chunk->used;
+    chunk->used += size;
+    return result;
+}
+
+static plcrash_error_t plcrash_nasync_macho_init_internal (plcrash_async_macho_t *image, mach_port_t task, const char *name, pl_vm_address_t header,
+                                                          plcrash_async_macho_cmd_arena_t *arena);
+
 /**
  * Initialize a new Mach-O binary image parser.
  *
+ * If @a task is the current task, the image's load commands are referenced in place, and no mapping is created;
+ * the image must remain loaded until @a image is freed. Otherwise, the load commands are mapped from @a task.
+ *
  * @param image The image structure to be initialized.
  * @param name The file name or path for the Mach-O image.
  * @param header The task-local address of the image's Mach-O header.
@@ -58,6 +422,43 @@
  * @warning This method is not async safe.
  */
 plcrash_error_t plcrash_nasync_macho_init (plcrash_async_macho_t *image, mach_port_t task, const char *name, pl_vm_address_t header) {
+    return plcrash_nasync_macho_init_internal(image, task, name, header, NULL);
+}
+
+/**
+ * Initialize a new Mach-O binary image parser with a reduced resident footprint. Rather than mapping the image's
+ * load commands and copying its name, the load commands are copied into @a arena, and @a name is borrowed. As with
+ * plcrash_nasync_macho_init(), the load commands of images in the current task are instead referenced in place,
+ * and consume no arena space.
+ *
+ * This is intended for long-lived image records, such as those of a process' shared image list, where the
+ * per-image VM mapping and heap allocations would otherwise be retained for the life of the process.
+ *
+ * @param image The image structure to be initialized.
+ * @param name The file name or path for the Mach-O image. This is not copied, and must remain valid until
+ * @a image is freed; the path strings maintained by dyld for loaded images satisfy this requirement.
+ * @param header The task-local address of the image's Mach-O header.
+ * @param arena The arena from which the image's load command copy will be allocated. The arena must not be freed
+ * before @a image.
+ *
+ * @return PLCRASH_ESUCCESS on success. PLCRASH_EINVAL will be returned in the Mach-O file can not be parsed,
+ * PLCRASH_ENOMEM if arena allocation fails, or PLCRASH_EINTERNAL if an error occurs reading from the target task.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_macho_init_compact (plcrash_async_macho_t *image, mach_port_t task, const char *name, pl_vm_address_t header,
+                                                  plcrash_async_macho_cmd_arena_t *arena)
+{
+    return plcrash_nasync_macho_init_internal(image, task, name, header, arena);
+}
+
+/*
+ * Shared implementation of plcrash_nasync_macho_init() and plcrash_nasync_macho_init_compact(). If @a arena is
+ * non-NULL, the image is initialized in compact mode.
+ */
+static plcrash_error_t plcrash_nasync_macho_init_internal (plcrash_async_macho_t *image, mach_port_t task, const char *name, pl_vm_address_t header,
+                                                          plcrash_async_macho_cmd_arena_t *arena)
+{
     plcrash_error_t ret;
 
     /* Defaults checked in the  error cleanup handler */
@@ -68,7 +469,17 @@ plcrash_error_t plcrash_nasync_macho_init (plcrash_async_macho_t *image, mach_po
     /* Basic initialization */
     image->task = task;
     image->header_addr = header;
-    image->name = strdup(name);
+    image->compact = (arena != NULL);
+    image->name = image->compact ? (char *) name : strdup(name);
+    image->name_length = (image->name != NULL) ? strlen(image->name) : 0;
+    image->symbol_index = NULL;
+    image->objc_index = NULL;
+    image->dwarf_cfa_table = NULL;
+    image->dwarf_fde_index = NULL;
+    image->dwarf_fde_index_requested = false;
+    image->shared_indices = 0;
+    image->shared_linkedit = NULL;
+    image->cmd_cache.valid = false;
 
     mach_port_mod_refs(mach_task_self(), image->task, MACH_PORT_RIGHT_SEND, 1);
     task_initialized = true;
@@ -129,7 +540,22 @@ plcrash_error_t plcrash_nasync_macho_init (plcrash_async_macho_t *image, mach_po
     pl_vm_size_t cmd_offset = image->header_addr + image->header_size;
     image->ncmds = image->byteorder->swap32(image->header.ncmds);
 
-    ret = plcrash_async_mobject_init(&image->load_cmds, image->task, cmd_offset, cmd_len, true);
+    if (image->task == mach_task_self() && plcrash_nasync_mobject_init_direct(&image->load_cmds, cmd_offset, cmd_len) == PLCRASH_ESUCCESS) {
+        /* The load commands of our own images remain mapped by dyld for as long as the image is loaded, and may be
+         * referenced directly */
+        ret = PLCRASH_ESUCCESS;
+    } else if (image->compact) {
+        /* Copy the load commands into the arena */
+        void *cmds = (cmd_len > 0) ? plcrash_nasync_macho_cmd_arena_alloc(arena, cmd_len) : NULL;
+        if (cmds == NULL) {
+            ret = (cmd_len > 0) ? PLCRASH_ENOMEM : PLCRASH_EINVAL;
+        } else if ((ret = plcrash_async_task_memcpy(image->task, cmd_offset, 0, cmds, cmd_len)) == PLCRASH_ESUCCESS) {
+            plcrash_async_mobject_init_local(&image->load_cmds, image->task, cmd_offset, cmds, cmd_len);
+        }
+    } else {
+        ret = plcrash_async_mobject_init(&image->load_cmds, image->task, cmd_offset, cmd_len, true);
+    }
+
     if (ret != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Failed to map Mach-O load commands in image %s", image->name);
         goto error;
@@ -190,13 +616,17 @@ plcrash_error_t plcrash_nasync_macho_init (plcrash_async_macho_t *image, mach_po
         image->vmaddr_slide = 0;
     }
 
+    /* Record the frequently used load commands, and determine which symbolication strategies may succeed */
+    plcrash_nasync_macho_cmd_cache_init(image);
+    plcrash_nasync_macho_capabilities_init(image);
+
     return PLCRASH_ESUCCESS;
     
 error:
     if (mobj_initialized)
         plcrash_async_mobject_free(&image->load_cmds);
     
-    if (image->name != NULL)
+    if (image->name != NULL && !image->compact)
         free(image->name);
     
     if (task_initialized)
@@ -354,6 +784,14 @@ void *plcrash_async_macho_next_command_type (plcrash_async_macho_t *image, void
 void *plcrash_async_macho_find_command (plcrash_async_macho_t *image, uint32_t expectedCommand) {
     struct load_command *cmd = NULL;
 
+    /* Use the cached command, if available */
+    if (image->cmd_cache.valid) {
+        for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_COMMAND_COUNT; i++) {
+            if (plcrash_async_macho_cached_commands[i] == expectedCommand)
+                return image->cmd_cache.commands[i];
+        }
+    }
+
     /* Iterate commands until we either find a match, or reach the end */
     while ((cmd = plcrash_async_macho_next_command(image, cmd)) != NULL) {
         /* Read the load command type */
@@ -373,36 +811,53 @@ void *plcrash_async_macho_find_command (plcrash_async_macho_t *image, uint32_t e
 }
 
 /**
+ * @internal
+ *
  * Find a named segment.
  *
  * @param image The image to search for @a segname.
- * @param segname The name of the segment to search for.
- * @param outAddress On successful return, contains the address of the found segment.
- * @param outCmd_32 On successful return with a 32-bit image, contains the segment header.
- * @param outCmd_64 On successful return with a 64-bit image, contains the segment header.
+ * @param segname The packed name of the segment to search for.
  *
  * @return Returns a mapped pointer to the segment on success, or NULL on failure.
  */
-void *plcrash_async_macho_find_segment_cmd (plcrash_async_macho_t *image, const char *segname) {
+static void *plcrash_async_macho_find_named_segment_cmd (plcrash_async_macho_t *image, const plcrash_async_macho_name_t *segname) {
     void *seg = NULL;
 
-    while ((seg = plcrash_async_macho_next_command_type(image, seg, image->m64 ? LC_SEGMENT_64 : LC_SEGMENT)) != 0) {
-
-        /* Read the load command */
-        if (image->m64) {
-            struct segment_command_64 *cmd_64 = seg;
-            if (plcrash_async_strncmp(segname, cmd_64->segname, sizeof(cmd_64->segname)) == 0)
-                return seg;
-        } else {
-            struct segment_command *cmd_32 = seg;
-            if (plcrash_async_strncmp(segname, cmd_32->segname, sizeof(cmd_32->segname)) == 0)
-                return seg;
+    /* Use the cached segment, if available */
+    if (image->cmd_cache.valid) {
+        for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT; i++) {
+            if (plcrash_async_macho_name_equal(segname, &plcrash_async_macho_cached_segment_names[i]))
+                return image->cmd_cache.segments[i];
         }
     }
 
+    /* The segment name is at the same offset in both segment_command and segment_command_64 */
+    while ((seg = plcrash_async_macho_next_command_type(image, seg, image->m64 ? LC_SEGMENT_64 : LC_SEGMENT)) != 0) {
+        if (plcrash_async_macho_name_matches(segname, ((struct segment_command *) seg)->segname))
+            return seg;
+    }
+
     return NULL;
 }
 
+/**
+ * Find a named segment.
+ *
+ * @param image The image to search for @a segname.
+ * @param segname The name of the segment to search for.
+ * @param outAddress On successful return, contains the address of the found segment.
+ * @param outCmd_32 On successful return with a 32-bit image, contains the segment header.
+ * @param outCmd_64 On successful return with a 64-bit image, contains the segment header.
+ *
+ * @return Returns a mapped pointer to the segment on success, or NULL on failure.
+ */
+void *plcrash_async_macho_find_segment_cmd (plcrash_async_macho_t *image, const char *segname) {
+    plcrash_async_macho_name_t name;
+    plcrash_async_macho_name_init(&name, segname);
+
+    return plcrash_async_macho_find_named_segment_cmd(image, &name);
+}
+
 /**
  * Find and map a named segment, initializing @a mobj. It is the caller's responsibility to dealloc @a mobj after
  * a successful initialization
@@ -449,28 +904,170 @@ plcrash_error_t plcrash_async_macho_map_segment (plcrash_async_macho_t *image, c
         seg->filesize = image->byteorder->swap32(cmd_32->filesize);
     }
 
+    /* Images loaded from the dyld shared cache share a single LINKEDIT region; if it has already been mapped, borrow
+     * the segment's range from the existing mapping. */
+    const plcrash_async_mobject_t *shared = image->shared_linkedit;
+    if (shared != NULL && plcrash_async_strcmp(segname, SEG_LINKEDIT) == 0) {
+        if (segaddr >= shared->task_address && segaddr - shared->task_address < shared->length) {
+            pl_vm_size_t offset = segaddr - shared->task_address;
+            pl_vm_size_t available = shared->length - offset;
+
+            plcrash_async_mobject_init_local(&seg->mobj, image->task, segaddr, (const void *) (shared->address + offset), segsize < available ? segsize : available);
+            return PLCRASH_ESUCCESS;
+        }
+    }
+
     /* Perform and return the mapping (permitting shorter mappings, as documented above). */
     return plcrash_async_mobject_init(&seg->mobj, image->task, segaddr, segsize, false);
 }
 
 /**
+ * Configure @a image to read its __LINKEDIT segment from @a linkedit, a mapping of the LINKEDIT region shared by all
+ * images loaded from the dyld shared cache (see plcrash_nasync_shared_cache_map_linkedit()). Subsequent calls to
+ * plcrash_async_macho_map_segment() for the __LINKEDIT segment will return a borrowed view of @a linkedit, rather
+ * than creating a new mapping.
+ *
+ * @param image The image to configure.
+ * @param linkedit The shared LINKEDIT mapping. This mapping is borrowed, and must remain valid for the lifetime of
+ * @a image.
+ *
+ * @return Returns true if the image's __LINKEDIT segment begins within @a linkedit, and the mapping was attached,
+ * or false otherwise.
+ *
+ * @warning This function is not async-safe.
+ */
+bool plcrash_nasync_macho_set_shared_linkedit (plcrash_async_macho_t *image, const plcrash_async_mobject_t *linkedit) {
+    void *segment = plcrash_async_macho_find_segment_cmd(image, SEG_LINKEDIT);
+    if (segment == NULL)
+        return false;
+
+    pl_vm_address_t segaddr;
+    if (image->m64) {
+        segaddr = image->byteorder->swap64(((struct segment_command_64 *) segment)->vmaddr) + image->vmaddr_slide;
+    } else {
+        segaddr = image->byteorder->swap32(((struct segment_command *) segment)->vmaddr) + image->vmaddr_slide;
+    }
+
+    if (segaddr < linkedit->task_address || segaddr - linkedit->task_address >= linkedit->length)
+        return false;
+
+    image->shared_linkedit = linkedit;
+    return true;
+}
+
+/**
+ * Borrow any indices that have been built for @a donor, another instance of the same image, and that have not yet
+ * been built for @a image. This allows a process that reads the same image from several tasks, such as an
+ * out-of-process capture service, to build each index once.
+ *
+ * The images must share an LC_UUID. The symbol index records unslid addresses, and may be shared regardless of
+ * where each instance is loaded; the DWARF indices record runtime addresses, and are only shared if both instances
+ * are loaded at the same header address, as is the case for images loaded from the dyld shared cache.
+ *
+ * @param image The image that will borrow @a donor's indices.
+ * @param donor The image from which indices will be borrowed. The borrowed indices are owned by @a donor, and
+ * @a donor must not be freed before @a image.
+ *
+ * @return Returns the indices borrowed by this call, as a bitwise OR of plcrash_async_macho_shared_index_t values.
+ *
+ * @warning This function is not async-safe, and must not be called while other threads are reading @a image.
+ */
+uint32_t plcrash_nasync_macho_share_indices (plcrash_async_macho_t *image, const plcrash_async_macho_t *donor) {
+    uint32_t shared = 0;
+
+    /* Both images must be identified, and identical */
+    struct uuid_command *uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    struct uuid_command *donor_uuid = plcrash_async_macho_find_command((plcrash_async_macho_t *) donor, LC_UUID);
+    if (uuid == NULL || donor_uuid == NULL || memcmp(uuid->uuid, donor_uuid->uuid, sizeof(uuid->uuid)) != 0)
+        return 0;
+
+    if (image->symbol_index == NULL && donor->symbol_index != NULL) {
+        image->symbol_index = donor->symbol_index;
+        shared |= PLCRASH_ASYNC_MACHO_SHARED_SYMBOL_INDEX;
+    }
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (image->header_addr == donor->header_addr) {
+        if (image->dwarf_cfa_table == NULL && donor->dwarf_cfa_table != NULL) {
+            image->dwarf_cfa_table = donor->dwarf_cfa_table;
+            shared |= PLCRASH_ASYNC_MACHO_SHARED_DWARF_CFA_TABLE;
+        }
+
+        if (image->dwarf_fde_index == NULL && donor->dwarf_fde_index != NULL) {
+            image->dwarf_fde_index = donor->dwarf_fde_index;
+            shared |= PLCRASH_ASYNC_MACHO_SHARED_DWARF_FDE_INDEX;
+        }
+    }
+#endif
+
+    image->shared_indices |= shared;
+    OSMemoryBarrier();
+
+    return shared;
+}
+
+/**
+ * Map the section described by the section table entry @a section, initializing @a mobj.
+ *
+ * @param image The image containing @a section.
+ * @param section A verified pointer to the section's struct section or struct section_64 entry.
+ * @param mobj The mobject to be initialized.
+ */
+static plcrash_error_t plcrash_async_macho_map_section_entry (plcrash_async_macho_t *image, void *section, plcrash_async_mobject_t *mobj) {
+    /* Calculate the in-memory address and size */
+    pl_vm_address_t sectaddr;
+    pl_vm_size_t sectsize;
+    if (image->m64) {
+        struct section_64 *sect_64 = section;
+        sectaddr = image->byteorder->swap64(sect_64->addr) + image->vmaddr_slide;
+        sectsize = image->byteorder->swap32(sect_64->size);
+    } else {
+        struct section *sect_32 = section;
+        sectaddr = image->byteorder->swap32(sect_32->addr) + image->vmaddr_slide;
+        sectsize = image->byteorder->swap32(sect_32->size);
+    }
+
+    /* Perform and return the mapping */
+    return plcrash_async_mobject_init(mobj, image->task, sectaddr, sectsize, true);
+}
+
+/**
+ * @internal
+ *
  * Find and map a named section within a named segment, initializing @a mobj.
- * It is the caller's responsibility to dealloc @a mobj after a successful
- * initialization
  *
  * @param image The image to search for @a segname.
- * @param segname The name of the segment to search.
- * @param sectname The name of the section to map.
- * @param mobj The mobject to be initialized with a mapping of the section's data. It is the caller's responsibility to dealloc @a mobj after
- * a successful initialization.
+ * @param segname The packed name of the segment to search.
+ * @param sectname The packed name of the section to map.
+ * @param mobj The mobject to be initialized with a mapping of the section's data.
  *
  * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the section is not found, or an error result on failure.
  */
-plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, const char *segname, const char *sectname, plcrash_async_mobject_t *mobj) {
+static plcrash_error_t plcrash_async_macho_map_named_section (plcrash_async_macho_t *image,
+                                                              const plcrash_async_macho_name_t *segname,
+                                                              const plcrash_async_macho_name_t *sectname,
+                                                              plcrash_async_mobject_t *mobj)
+{
     struct segment_command *cmd_32;
     struct segment_command_64 *cmd_64;
-    
-    void *segment =  plcrash_async_macho_find_segment_cmd(image, segname);
+
+    /* Use the cached section, if available */
+    if (image->cmd_cache.valid) {
+        for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT; i++) {
+            if (!plcrash_async_macho_name_equal(segname, &plcrash_async_macho_cached_section_names[i].segname))
+                continue;
+
+            if (!plcrash_async_macho_name_equal(sectname, &plcrash_async_macho_cached_section_names[i].sectname))
+                continue;
+
+            if (image->cmd_cache.sections[i] == NULL)
+                return PLCRASH_ENOTFOUND;
+
+            return plcrash_async_macho_map_section_entry(image, image->cmd_cache.sections[i], mobj);
+        }
+    }
+
+    void *segment = plcrash_async_macho_find_named_segment_cmd(image, segname);
     if (segment == NULL)
         return PLCRASH_ENOTFOUND;
 
@@ -479,59 +1076,328 @@ plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, c
     
     uint32_t nsects;
     uintptr_t cursor = (uintptr_t) segment;
+    size_t sectsize;
 
     if (image->m64) {
         nsects = image->byteorder->swap32(cmd_64->nsects);
         cursor += sizeof(*cmd_64);
+        sectsize = sizeof(struct section_64);
     } else {
         nsects = image->byteorder->swap32(cmd_32->nsects);
         cursor += sizeof(*cmd_32);
+        sectsize = sizeof(struct section);
     }
 
-    for (uint32_t i = 0; i < nsects; i++) {        
-        struct section *sect_32 = NULL;
-        struct section_64 *sect_64 = NULL;
-       
-        if (image->m64) {
-            if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, cursor, 0, sizeof(*sect_64))) {
-                PLCF_DEBUG("Section table entry outside of expected range; searching for (%s,%s)", segname, sectname);
-                return PLCRASH_EINVAL;
-            }
-            
-            sect_64 = (void *) cursor;
-            cursor += sizeof(*sect_64);
-        } else {
-            if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, cursor, 0, sizeof(*sect_32))) {
-                PLCF_DEBUG("Section table entry outside of expected range; searching for (%s,%s)", segname, sectname);
-                return PLCRASH_EINVAL;
-            }
-            
-            sect_32 = (void *) cursor;
-            cursor += sizeof(*sect_32);
-        }
-        
-        const char *image_sectname = image->m64 ? sect_64->sectname : sect_32->sectname;
-        if (plcrash_async_strncmp(sectname, image_sectname, sizeof(sect_64->sectname)) == 0) {
-            /* Calculate the in-memory address and size */
-            pl_vm_address_t sectaddr;
-            pl_vm_size_t sectsize;
-            if (image->m64) {
-                sectaddr = image->byteorder->swap64(sect_64->addr) + image->vmaddr_slide;
-                sectsize = image->byteorder->swap32(sect_64->size);
-            } else {
-                sectaddr = image->byteorder->swap32(sect_32->addr) + image->vmaddr_slide;
-                sectsize = image->byteorder->swap32(sect_32->size);
-            }
-            
-            
-            /* Perform and return the mapping */
-            return plcrash_async_mobject_init(mobj, image->task, sectaddr, sectsize, true);
+    for (uint32_t i = 0; i < nsects; i++, cursor += sectsize) {
+        if (!plcrash_async_mobject_verify_local_pointer(&image->load_cmds, cursor, 0, sectsize)) {
+            PLCF_DEBUG("Section table entry outside of expected range; searching for (%.16s,%.16s)", (const char *) segname->words, (const char *) sectname->words);
+            return PLCRASH_EINVAL;
         }
+
+        /* The section name is at the same offset in both section and section_64 */
+        if (plcrash_async_macho_name_matches(sectname, ((struct section *) cursor)->sectname))
+            return plcrash_async_macho_map_section_entry(image, (void *) cursor, mobj);
     }
     
     return PLCRASH_ENOTFOUND;
 }
 
+/**
+ * Find and map a named section within a named segment, initializing @a mobj.
+ * It is the caller's responsibility to dealloc @a mobj after a successful
+ * initialization
+ *
+ * @param image The image to search for @a segname.
+ * @param segname The name of the segment to search.
+ * @param sectname The name of the section to map.
+ * @param mobj The mobject to be initialized with a mapping of the section's data. It is the caller's responsibility to dealloc @a mobj after
+ * a successful initialization.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the section is not found, or an error result on failure.
+ */
+plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, const char *segname, const char *sectname, plcrash_async_mobject_t *mobj) {
+    plcrash_async_macho_name_t packed_segname;
+    plcrash_async_macho_name_t packed_sectname;
+
+    plcrash_async_macho_name_init(&packed_segname, segname);
+    plcrash_async_macho_name_init(&packed_sectname, sectname);
+
+    return plcrash_async_macho_map_named_section(image, &packed_segname, &packed_sectname, mobj);
+}
+
+/**
+ * Initialize a new section cache.
+ *
+ * @param cache The cache to be initialized. The cache must be freed via plcrash_async_macho_section_cache_free().
+ */
+void plcrash_async_macho_section_cache_init (plcrash_async_macho_section_cache_t *cache) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        cache->entries[i].image = NULL;
+        cache->entries[i].refcount = 0;
+    }
+
+    cache->next_entry = 0;
+    cache->dwarf_cie_cache = NULL;
+    cache->stack_size_count = 0;
+    cache->next_stack_size = 0;
+    cache->work_budget = NULL;
+    cache->fde_hint_image = NULL;
+}
+
+/**
+ * @internal
+ *
+ * Release any mapping held by @a entry, and mark the entry as unused.
+ */
+static void plcrash_async_macho_section_cache_entry_free (plcrash_async_macho_section_cache_entry_t *entry) {
+    PLCF_ASSERT(entry->refcount == 0);
+
+    if (entry->image != NULL && entry->result == PLCRASH_ESUCCESS)
+        plcrash_async_mobject_free(&entry->mobj);
+
+    entry->image = NULL;
+}
+
+/**
+ * Find and map a named section within a named segment, returning a cached mapping if one is available.
+ *
+ * Both successful mappings and PLCRASH_ENOTFOUND results are cached. The returned memory object must be
+ * released via plcrash_async_macho_section_cache_unmap(), and must not be freed by the caller.
+ *
+ * @param cache The section cache, or NULL. If NULL, or if the cache is full of in-use entries, the section will be mapped
+ * into @a storage.
+ * @param image The image to search for @a segname.
+ * @param segname The name of the segment to search.
+ * @param sectname The name of the section to map.
+ * @param storage Caller-provided storage to be used if the mapping can not be cached.
+ * @param mobj On success, will be set to a memory object mapping the section's data.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the section is not found, or an error result on failure.
+ */
+plcrash_error_t plcrash_async_macho_section_cache_map (plcrash_async_macho_section_cache_t *cache,
+                                                       plcrash_async_macho_t *image,
+                                                       const char *segname,
+                                                       const char *sectname,
+                                                       plcrash_async_mobject_t *storage,
+                                                       plcrash_async_mobject_t **mobj)
+{
+    plcrash_async_macho_section_cache_entry_t *entry = NULL;
+    plcrash_async_macho_name_t packed_segname;
+    plcrash_async_macho_name_t packed_sectname;
+    plcrash_error_t err;
+
+    plcrash_async_macho_name_init(&packed_segname, segname);
+    plcrash_async_macho_name_init(&packed_sectname, sectname);
+
+    /* Without a cache, simply map the section into the caller's storage */
+    if (cache == NULL)
+        goto uncached;
+
+    /* Look for an existing entry */
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        entry = &cache->entries[i];
+        if (entry->image != image)
+            continue;
+
+        if (!plcrash_async_macho_name_equal(&entry->segname, &packed_segname))
+            continue;
+
+        if (!plcrash_async_macho_name_equal(&entry->sectname, &packed_sectname))
+            continue;
+
+        if (entry->result != PLCRASH_ESUCCESS)
+            return entry->result;
+
+        entry->refcount++;
+        *mobj = &entry->mobj;
+        return PLCRASH_ESUCCESS;
+    }
+
+    /* Find an entry that is not in use, evicting in round-robin order */
+    entry = NULL;
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        plcrash_async_macho_section_cache_entry_t *candidate = &cache->entries[(cache->next_entry + i) % PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE];
+        if (candidate->refcount == 0) {
+            entry = candidate;
+            cache->next_entry = (cache->next_entry + i + 1) % PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE;
+            break;
+        }
+    }
+
+    /* If every entry is in use, fall back on an uncached mapping */
+    if (entry == NULL)
+        goto uncached;
+
+    plcrash_async_macho_section_cache_entry_free(entry);
+
+    err = plcrash_async_macho_map_named_section(image, &packed_segname, &packed_sectname, &entry->mobj);
+
+    /* Only cache definitive results; other errors may be transient (eg, due to VM mapping limits) */
+    if (err != PLCRASH_ESUCCESS && err != PLCRASH_ENOTFOUND)
+        return err;
+
+    entry->image = image;
+    entry->segname = packed_segname;
+    entry->sectname = packed_sectname;
+    entry->result = err;
+
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    entry->refcount = 1;
+    *mobj = &entry->mobj;
+    return PLCRASH_ESUCCESS;
+
+uncached:
+    if ((err = plcrash_async_macho_map_named_section(image, &packed_segname, &packed_sectname, storage)) != PLCRASH_ESUCCESS)
+        return err;
+
+    *mobj = storage;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Release a memory object returned by plcrash_async_macho_section_cache_map().
+ *
+ * @param cache The section cache that was supplied to plcrash_async_macho_section_cache_map(), or NULL.
+ * @param mobj The memory object to be released.
+ */
+void plcrash_async_macho_section_cache_unmap (plcrash_async_macho_section_cache_t *cache, plcrash_async_mobject_t *mobj) {
+    /* Cached mapping; drop our reference. The mapping itself is retained until eviction, or until the cache is freed. */
+    if (cache != NULL) {
+        for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+            if (&cache->entries[i].mobj == mobj) {
+                PLCF_ASSERT(cache->entries[i].refcount > 0);
+                cache->entries[i].refcount--;
+                return;
+            }
+        }
+    }
+
+    /* Uncached mapping */
+    plcrash_async_mobject_free(mobj);
+}
+
+/**
+ * Free all mappings held by @a cache.
+ *
+ * @param cache The cache to be freed. All memory objects returned by plcrash_async_macho_section_cache_map() must
+ * have been released.
+ */
+void plcrash_async_macho_section_cache_free (plcrash_async_macho_section_cache_t *cache) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++)
+        plcrash_async_macho_section_cache_entry_free(&cache->entries[i]);
+}
+
+/**
+ * Evict all mappings of @a image held by @a cache, along with all cached indirect stack sizes. This must be called
+ * before @a image is freed if @a cache will continue to be used.
+ *
+ * @param cache The section cache.
+ * @param image The image to be evicted.
+ *
+ * @warning The caller must ensure that no memory objects mapped from @a image are in use.
+ */
+void plcrash_async_macho_section_cache_evict (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++) {
+        if (cache->entries[i].image == image)
+            plcrash_async_macho_section_cache_entry_free(&cache->entries[i]);
+    }
+
+    /* Stack sizes are keyed by address alone; the image's address range may be reused by a later image */
+    cache->stack_size_count = 0;
+    cache->next_stack_size = 0;
+
+    if (cache->fde_hint_image == image)
+        cache->fde_hint_image = NULL;
+}
+
+/**
+ * Look up a cached indirect stack size previously stored via plcrash_async_macho_section_cache_add_stack_size().
+ *
+ * @param cache The section cache, or NULL.
+ * @param address The task-relative address from which the stack size is read.
+ * @param stack_size On success, will be set to the cached stack size.
+ *
+ * @return Returns true if a cached value was found, or false if the value must be read from the target task.
+ */
+bool plcrash_async_macho_section_cache_find_stack_size (plcrash_async_macho_section_cache_t *cache, pl_vm_address_t address, uint32_t *stack_size) {
+    if (cache == NULL)
+        return false;
+
+    for (size_t i = 0; i < cache->stack_size_count; i++) {
+        if (cache->stack_sizes[i].address == address) {
+            *stack_size = cache->stack_sizes[i].stack_size;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Cache an indirect stack size read from @a address. Once the cache is full, entries are replaced in
+ * round-robin order.
+ *
+ * @param cache The section cache, or NULL.
+ * @param address The task-relative address from which the stack size was read.
+ * @param stack_size The stack size.
+ */
+void plcrash_async_macho_section_cache_add_stack_size (plcrash_async_macho_section_cache_t *cache, pl_vm_address_t address, uint32_t stack_size) {
+    plcrash_async_macho_stack_size_entry_t *entry;
+
+    if (cache == NULL)
+        return;
+
+    if (cache->stack_size_count < PLCRASH_ASYNC_MACHO_SECTION_CACHE_STACK_SIZES) {
+        entry = &cache->stack_sizes[cache->stack_size_count++];
+    } else {
+        entry = &cache->stack_sizes[cache->next_stack_size];
+        cache->next_stack_size = (cache->next_stack_size + 1) % PLCRASH_ASYNC_MACHO_SECTION_CACHE_STACK_SIZES;
+    }
+
+    entry->address = address;
+    entry->stack_size = stack_size;
+}
+
+/**
+ * Record the __eh_frame offset of the DWARF FDE covering @a pc, as provided by a compact unwind encoding that defers
+ * to DWARF. The hint is consumed by the DWARF frame reader via plcrash_async_macho_section_cache_take_fde_hint(),
+ * allowing the FDE to be decoded directly, rather than searched for. Only the most recent hint is retained.
+ *
+ * @param cache The section cache, or NULL.
+ * @param image The image containing @a pc.
+ * @param pc The task-relative PC.
+ * @param fde_offset The FDE's offset within the image's __eh_frame section.
+ */
+void plcrash_async_macho_section_cache_set_fde_hint (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image, pl_vm_address_t pc, pl_vm_off_t fde_offset) {
+    if (cache == NULL)
+        return;
+
+    cache->fde_hint_image = image;
+    cache->fde_hint_pc = pc;
+    cache->fde_hint_offset = fde_offset;
+}
+
+/**
+ * Fetch and clear the FDE hint recorded for @a pc via plcrash_async_macho_section_cache_set_fde_hint().
+ *
+ * @param cache The section cache, or NULL.
+ * @param image The image containing @a pc.
+ * @param pc The task-relative PC.
+ * @param fde_offset On success, will be set to the FDE's offset within the image's __eh_frame section.
+ *
+ * @return Returns true if a hint was recorded for @a pc, or false otherwise.
+ */
+bool plcrash_async_macho_section_cache_take_fde_hint (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image, pl_vm_address_t pc, pl_vm_off_t *fde_offset) {
+    if (cache == NULL || cache->fde_hint_image != image || cache->fde_hint_pc != pc)
+        return false;
+
+    *fde_offset = cache->fde_hint_offset;
+    cache->fde_hint_image = NULL;
+    return true;
+}
+
 /**
  * @internal
  * Common wrapper of nlist/nlist_64. We verify that this union is valid for our purposes in pl_async_macho_find_symtab_symbol().
@@ -691,6 +1557,44 @@ cleanup:
     return retval;
 }
 
+/*
+ * Read the entry at @a index from @a symtab, an array of struct nlist_64 if @a m64 is true, or struct nlist otherwise.
+ *
+ * This is inlined into each symbol table scan with a constant @a m64, such that the scans' inner loops do not branch
+ * on the image's pointer width; see PLCF_ALWAYS_INLINE.
+ */
+static PLCF_ALWAYS_INLINE plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_read_entry (const plcrash_async_byteorder_t *byteorder,
+                                                                                                    const void *symtab, uint32_t index,
+                                                                                                    const bool m64)
+{
+    /* Perform 32-bit/64-bit dependent aliased pointer math. */
+    const pl_nlist_common *symbol;
+    uint64_t n_value;
+    if (m64) {
+        symbol = (const pl_nlist_common *) &(((const struct nlist_64 *) symtab)[index]);
+        n_value = byteorder->swap64(symbol->n64.n_value);
+    } else {
+        symbol = (const pl_nlist_common *) &(((const struct nlist *) symtab)[index]);
+        n_value = byteorder->swap32(symbol->n32.n_value);
+    }
+
+    plcrash_async_macho_symtab_entry_t entry = {
+        .n_strx = byteorder->swap32(symbol->n32.n_un.n_strx),
+        .n_type = symbol->n32.n_type,
+        .n_sect = symbol->n32.n_sect,
+        .n_desc = byteorder->swap16(symbol->n32.n_desc),
+        .n_value = n_value
+    };
+
+    /* Normalize the symbol address. We have to set the low-order bit ourselves for ARM THUMB functions. */
+    if (entry.n_desc & N_ARM_THUMB_DEF)
+        entry.normalized_value = (entry.n_value|1);
+    else
+        entry.normalized_value = entry.n_value;
+
+    return entry;
+}
+
 /**
  * Fetch the entry corresponding to @a index.
  *
@@ -722,35 +1626,10 @@ plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_reader_read (plcra
 #undef pl_m_sizeof
     }
 
-#define pl_sym_value(image, nl) (image->m64 ? image->byteorder->swap64((nl)->n64.n_value) : image->byteorder->swap32((nl)->n32.n_value))
-
-    /* Perform 32-bit/64-bit dependent aliased pointer math. */
-    pl_nlist_common *symbol;
-    if (reader->image->m64) {
-        symbol = (pl_nlist_common *) &(((struct nlist_64 *) symtab)[index]);
-    } else {
-        symbol = (pl_nlist_common *) &(((struct nlist *) symtab)[index]);
-    }
-    
-    plcrash_async_macho_symtab_entry_t entry = {
-        .n_strx = byteorder->swap32(symbol->n32.n_un.n_strx),
-        .n_type = symbol->n32.n_type,
-        .n_sect = symbol->n32.n_sect,
-        .n_desc = byteorder->swap16(symbol->n32.n_desc),
-        .n_value = pl_sym_value(reader->image, symbol)
-    };
-    
-    entry.normalized_value = entry.n_value;
-    
-    /* Normalize the symbol address. We have to set the low-order bit ourselves for ARM THUMB functions. */
-    if (entry.n_desc & N_ARM_THUMB_DEF)
-        entry.normalized_value = (entry.n_value|1);
+    if (reader->image->m64)
+        return plcrash_async_macho_symtab_read_entry(byteorder, symtab, index, true);
     else
-        entry.normalized_value = entry.n_value;
-    
-#undef pl_sym_value
-    
-    return entry;
+        return plcrash_async_macho_symtab_read_entry(byteorder, symtab, index, false);
 }
 
 /**
@@ -806,13 +1685,15 @@ void plcrash_async_macho_symtab_reader_free (plcrash_async_macho_symtab_reader_t
  *
  * @return Returns true if a symbol was found, false otherwise.
  */
-static void plcrash_async_macho_find_best_symbol (plcrash_async_macho_symtab_reader_t *reader,
-                                                  pl_vm_address_t slide_pc,
-                                                  pl_nlist_common *symtab, uint32_t nsyms,
-                                                  plcrash_async_macho_symtab_entry_t *found_symbol,
-                                                  plcrash_async_macho_symtab_entry_t *prev_symbol,
-                                                  bool *did_find_symbol)
+static PLCF_ALWAYS_INLINE void plcrash_async_macho_find_best_symbol_impl (plcrash_async_macho_symtab_reader_t *reader,
+                                                                          pl_vm_address_t slide_pc,
+                                                                          pl_nlist_common *symtab, uint32_t nsyms,
+                                                                          plcrash_async_macho_symtab_entry_t *found_symbol,
+                                                                          plcrash_async_macho_symtab_entry_t *prev_symbol,
+                                                                          bool *did_find_symbol,
+                                                                          const bool m64)
 {
+    const plcrash_async_byteorder_t *byteorder = reader->image->byteorder;
     plcrash_async_macho_symtab_entry_t new_entry;
     
     /* Set did_find_symbol to false by default */
@@ -822,7 +1703,7 @@ static void plcrash_async_macho_find_best_symbol (plcrash_async_macho_symtab_rea
     /* Walk the symbol table. We know that symbols[i] is valid, since we fetched a pointer+len based on the value using
      * plcrash_async_mobject_remap_address() above. */
     for (uint32_t i = 0; i < nsyms; i++) {
-        new_entry = plcrash_async_macho_symtab_reader_read(reader, symtab, i);
+        new_entry = plcrash_async_macho_symtab_read_entry(byteorder, symtab, i, m64);
         
         /* Symbol must be within a section, and must not be a debugging entry. */
         if ((new_entry.n_type & N_TYPE) != N_SECT || ((new_entry.n_type & N_STAB) != 0))
@@ -839,6 +1720,333 @@ static void plcrash_async_macho_find_best_symbol (plcrash_async_macho_symtab_rea
     }
 }
 
+#if PL_ASYNC_MACHO_VECTOR_SCAN
+/*
+ * Merge a candidate @a value at @a index into the best match found by plcrash_async_macho_find_best_symbol_vector().
+ * Ties are resolved in favor of the lower index, matching the result of a linear scan.
+ */
+static PLCF_ALWAYS_INLINE void plcrash_async_macho_vector_scan_merge (bool *found, uint64_t *best_value, uint32_t *best_index,
+                                                                      uint64_t value, uint32_t index)
+{
+    if (!*found || value > *best_value || (value == *best_value && index < *best_index)) {
+        *found = true;
+        *best_value = value;
+        *best_index = index;
+    }
+}
+
+/*
+ * Find the index of the closest section symbol at or before @a slide_pc within @a symtab, an array of host byte order
+ * struct nlist_64 entries. This returns the same entry as plcrash_async_macho_find_best_symbol_impl(), but compares
+ * two entries per iteration, without reading or byte swapping the fields that do not participate in the search.
+ *
+ * Each pair of entries is loaded as two 64-bit lanes of leading words (n_strx, n_type, n_sect, n_desc) and two of
+ * n_value; N_SECT entries are matched by masking n_type within the leading word, and each lane tracks its own best
+ * value and index, which are merged once the scan completes.
+ *
+ * @return Returns true if a symbol was found, in which case @a index will be set to its index within @a symtab.
+ */
+static bool plcrash_async_macho_find_best_symbol_vector (const struct nlist_64 *symtab, uint32_t nsyms, pl_vm_address_t slide_pc, uint32_t *index) {
+    /* n_type is the fifth byte of the little-endian leading word */
+    const uint64_t type_mask = (uint64_t) (N_TYPE|N_STAB) << 32;
+    const uint64_t type_sect = (uint64_t) N_SECT << 32;
+
+    bool found = false;
+    uint64_t best_value = 0;
+    uint32_t best_index = 0;
+    uint32_t i = 0;
+
+#if defined(__aarch64__)
+    const uint64x2_t v_mask = vdupq_n_u64(type_mask);
+    const uint64x2_t v_sect = vdupq_n_u64(type_sect);
+    const uint64x2_t v_pc = vdupq_n_u64(slide_pc);
+    const uint64x2_t v_step = vdupq_n_u64(2);
+    uint64x2_t v_index = vcombine_u64(vcreate_u64(0), vcreate_u64(1));
+    uint64x2_t v_best = vdupq_n_u64(0);
+    uint64x2_t v_best_index = vdupq_n_u64(0);
+    uint64x2_t v_found = vdupq_n_u64(0);
+
+    for (; nsyms - i >= 2; i += 2) {
+        /* De-interleave the leading words and n_value of both entries */
+        uint64x2x2_t entries = vld2q_u64((const uint64_t *) &symtab[i]);
+
+        uint64x2_t eligible = vandq_u64(vceqq_u64(vandq_u64(entries.val[0], v_mask), v_sect), vcleq_u64(entries.val[1], v_pc));
+        uint64x2_t better = vbicq_u64(eligible, vbicq_u64(v_found, vcgtq_u64(entries.val[1], v_best)));
+
+        v_best = vbslq_u64(better, entries.val[1], v_best);
+        v_best_index = vbslq_u64(better, v_index, v_best_index);
+        v_found = vorrq_u64(v_found, better);
+        v_index = vaddq_u64(v_index, v_step);
+    }
+
+    if (vgetq_lane_u64(v_found, 0))
+        plcrash_async_macho_vector_scan_merge(&found, &best_value, &best_index, vgetq_lane_u64(v_best, 0), (uint32_t) vgetq_lane_u64(v_best_index, 0));
+    if (vgetq_lane_u64(v_found, 1))
+        plcrash_async_macho_vector_scan_merge(&found, &best_value, &best_index, vgetq_lane_u64(v_best, 1), (uint32_t) vgetq_lane_u64(v_best_index, 1));
+#else
+    /* SSE4.2 only provides a signed 64-bit comparison; values are biased by INT64_MIN to compare them unsigned */
+    const __m128i v_bias = _mm_set1_epi64x(INT64_MIN);
+    const __m128i v_mask = _mm_set1_epi64x((int64_t) type_mask);
+    const __m128i v_sect = _mm_set1_epi64x((int64_t) type_sect);
+    const __m128i v_pc = _mm_xor_si128(_mm_set1_epi64x((int64_t) slide_pc), v_bias);
+    const __m128i v_step = _mm_set1_epi64x(2);
+    __m128i v_index = _mm_set_epi64x(1, 0);
+    __m128i v_best = v_bias;
+    __m128i v_best_index = _mm_setzero_si128();
+    __m128i v_found = _mm_setzero_si128();
+
+    for (; nsyms - i >= 2; i += 2) {
+        /* De-interleave the leading words and n_value of both entries */
+        __m128i first = _mm_loadu_si128((const __m128i *) &symtab[i]);
+        __m128i second = _mm_loadu_si128((const __m128i *) &symtab[i + 1]);
+        __m128i lead = _mm_unpacklo_epi64(first, second);
+        __m128i value = _mm_xor_si128(_mm_unpackhi_epi64(first, second), v_bias);
+
+        __m128i eligible = _mm_andnot_si128(_mm_cmpgt_epi64(value, v_pc), _mm_cmpeq_epi64(_mm_and_si128(lead, v_mask), v_sect));
+        __m128i better = _mm_andnot_si128(_mm_andnot_si128(_mm_cmpgt_epi64(value, v_best), v_found), eligible);
+
+        v_best = _mm_blendv_epi8(v_best, value, better);
+        v_best_index = _mm_blendv_epi8(v_best_index, v_index, better);
+        v_found = _mm_or_si128(v_found, better);
+        v_index = _mm_add_epi64(v_index, v_step);
+    }
+
+    if (_mm_extract_epi64(v_found, 0))
+        plcrash_async_macho_vector_scan_merge(&found, &best_value, &best_index, (uint64_t) _mm_extract_epi64(_mm_xor_si128(v_best, v_bias), 0),
+                                              (uint32_t) _mm_extract_epi64(v_best_index, 0));
+    if (_mm_extract_epi64(v_found, 1))
+        plcrash_async_macho_vector_scan_merge(&found, &best_value, &best_index, (uint64_t) _mm_extract_epi64(_mm_xor_si128(v_best, v_bias), 1),
+                                              (uint32_t) _mm_extract_epi64(v_best_index, 1));
+#endif
+
+    /* Trailing entry */
+    for (; i < nsyms; i++) {
+        if ((symtab[i].n_type & N_TYPE) != N_SECT || ((symtab[i].n_type & N_STAB) != 0) || symtab[i].n_value > slide_pc)
+            continue;
+
+        plcrash_async_macho_vector_scan_merge(&found, &best_value, &best_index, symtab[i].n_value, i);
+    }
+
+    *index = best_index;
+    return found;
+}
+#endif /* PL_ASYNC_MACHO_VECTOR_SCAN */
+
+/*
+ * Pointer width dispatch for plcrash_async_macho_find_best_symbol_impl().
+ */
+static void plcrash_async_macho_find_best_symbol (plcrash_async_macho_symtab_reader_t *reader,
+                                                  pl_vm_address_t slide_pc,
+                                                  pl_nlist_common *symtab, uint32_t nsyms,
+                                                  plcrash_async_macho_symtab_entry_t *found_symbol,
+                                                  plcrash_async_macho_symtab_entry_t *prev_symbol,
+                                                  bool *did_find_symbol)
+{
+#if PL_ASYNC_MACHO_VECTOR_SCAN
+    /* Host byte order 64-bit tables (the common case) are scanned two entries at a time */
+    if (reader->image->m64 && reader->image->byteorder == &plcrash_async_byteorder_direct) {
+        uint32_t index;
+
+        if (prev_symbol == NULL)
+            *did_find_symbol = false;
+
+        if (!plcrash_async_macho_find_best_symbol_vector((const struct nlist_64 *) symtab, nsyms, slide_pc, &index))
+            return;
+
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_read_entry(reader->image->byteorder, symtab, index, true);
+        if (!*did_find_symbol || prev_symbol->n_value < entry.n_value) {
+            *found_symbol = entry;
+            *did_find_symbol = true;
+        }
+        return;
+    }
+#endif
+
+    if (reader->image->m64)
+        plcrash_async_macho_find_best_symbol_impl(reader, slide_pc, symtab, nsyms, found_symbol, prev_symbol, did_find_symbol, true);
+    else
+        plcrash_async_macho_find_best_symbol_impl(reader, slide_pc, symtab, nsyms, found_symbol, prev_symbol, did_find_symbol, false);
+}
+
+/* mergesort() comparator for plcrash_async_macho_symbol_index_t entries */
+static int plcrash_nasync_macho_symbol_index_compare (const void *lhs, const void *rhs) {
+    const plcrash_async_macho_symbol_index_entry_t *lhs_entry = lhs;
+    const plcrash_async_macho_symbol_index_entry_t *rhs_entry = rhs;
+
+    if (lhs_entry->n_value < rhs_entry->n_value)
+        return -1;
+    else if (lhs_entry->n_value > rhs_entry->n_value)
+        return 1;
+    return 0;
+}
+
+/*
+ * Append all section symbols from @a symtab to @a entries, returning the number of entries written. If @a entries is
+ * NULL, the number of matching symbols will be returned without writing any entries.
+ */
+static PLCF_ALWAYS_INLINE uint32_t plcrash_nasync_macho_symbol_index_collect_impl (plcrash_async_macho_symtab_reader_t *reader,
+                                                                                  void *symtab, uint32_t nsyms,
+                                                                                  plcrash_async_macho_symbol_index_entry_t *entries,
+                                                                                  const bool m64)
+{
+    const plcrash_async_byteorder_t *byteorder = reader->image->byteorder;
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < nsyms; i++) {
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_read_entry(byteorder, symtab, i, m64);
+
+        /* Symbol must be within a section, and must not be a debugging entry. */
+        if ((entry.n_type & N_TYPE) != N_SECT || ((entry.n_type & N_STAB) != 0))
+            continue;
+
+        if (entries != NULL) {
+            entries[count].n_value = entry.n_value;
+            entries[count].n_strx = entry.n_strx;
+            entries[count].n_desc = entry.n_desc;
+            entries[count].n_type = entry.n_type;
+            entries[count].n_sect = entry.n_sect;
+        }
+        count++;
+    }
+
+    return count;
+}
+
+/*
+ * Pointer width dispatch for plcrash_nasync_macho_symbol_index_collect_impl().
+ */
+static uint32_t plcrash_nasync_macho_symbol_index_collect (plcrash_async_macho_symtab_reader_t *reader,
+                                                           void *symtab, uint32_t nsyms,
+                                                           plcrash_async_macho_symbol_index_entry_t *entries)
+{
+    if (reader->image->m64)
+        return plcrash_nasync_macho_symbol_index_collect_impl(reader, symtab, nsyms, entries, true);
+    else
+        return plcrash_nasync_macho_symbol_index_collect_impl(reader, symtab, nsyms, entries, false);
+}
+
+/**
+ * Build the symbol address index for @a image, if it has not already been built. Once built, the index will be used
+ * by plcrash_async_macho_find_symbol_by_pc() to perform a binary search of the image's symbols, rather than a linear
+ * scan of the symbol table.
+ *
+ * The index is immutable once built, and is published atomically; it is safe to call this function while other
+ * threads are performing async-safe symbol lookups on @a image.
+ *
+ * @param image The image to be indexed.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or if the index has already been built. On failure, one of the
+ * plcrash_error_t error values will be returned, and symbol lookups will continue to use a linear scan.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_macho_index_symbols (plcrash_async_macho_t *image) {
+    plcrash_async_macho_symtab_reader_t reader;
+    plcrash_error_t ret;
+
+    if (image->symbol_index != NULL)
+        return PLCRASH_ESUCCESS;
+
+    if ((ret = plcrash_async_macho_symtab_reader_init(&reader, image)) != PLCRASH_ESUCCESS)
+        return ret;
+
+    /* Determine the number of candidate symbols. This uses the same table order as plcrash_async_macho_find_symbol_by_pc(),
+     * which ensures that the first symbol for any given address is the one retained below. */
+    uint32_t count;
+    if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
+        count = plcrash_nasync_macho_symbol_index_collect(&reader, reader.symtab_global, reader.nsyms_global, NULL);
+        count += plcrash_nasync_macho_symbol_index_collect(&reader, reader.symtab_local, reader.nsyms_local, NULL);
+    } else {
+        count = plcrash_nasync_macho_symbol_index_collect(&reader, reader.symtab, reader.nsyms, NULL);
+    }
+
+    plcrash_async_macho_symbol_index_t *index = malloc(sizeof(*index) + (sizeof(index->entries[0]) * count));
+    if (index == NULL) {
+        PLCF_DEBUG("Failed to allocate a symbol index of %" PRIu32 " entries for %s", count, image->name);
+        ret = PLCRASH_ENOMEM;
+        goto cleanup;
+    }
+
+    /* Populate the index */
+    if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
+        index->count = plcrash_nasync_macho_symbol_index_collect(&reader, reader.symtab_global, reader.nsyms_global, index->entries);
+        index->count += plcrash_nasync_macho_symbol_index_collect(&reader, reader.symtab_local, reader.nsyms_local, index->entries + index->count);
+    } else {
+        index->count = plcrash_nasync_macho_symbol_index_collect(&reader, reader.symtab, reader.nsyms, index->entries);
+    }
+
+    /* Sort by address. The sort must be stable, as the first symbol found for an address takes precedence. */
+    if (mergesort(index->entries, index->count, sizeof(index->entries[0]), plcrash_nasync_macho_symbol_index_compare) != 0) {
+        PLCF_DEBUG("Failed to sort the symbol index for %s", image->name);
+        free(index);
+        ret = PLCRASH_ENOMEM;
+        goto cleanup;
+    }
+
+    /* Drop all but the first symbol for each address */
+    uint32_t unique = 0;
+    for (uint32_t i = 0; i < index->count; i++) {
+        if (unique > 0 && index->entries[unique - 1].n_value == index->entries[i].n_value)
+            continue;
+        index->entries[unique++] = index->entries[i];
+    }
+    index->count = unique;
+
+    /* Publish the index. If another thread has already done so, discard ours. */
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, index, (void * volatile *) &image->symbol_index))
+        free(index);
+
+    ret = PLCRASH_ESUCCESS;
+
+cleanup:
+    plcrash_async_macho_symtab_reader_free(&reader);
+    return ret;
+}
+
+/*
+ * Locate the closest symbol occuring at or before @a slide_pc within @a index.
+ *
+ * @param index The symbol index to search.
+ * @param slide_pc The PC value for which symbol information should be found. The VM slide address should have
+ * already been applied to this value.
+ * @param found_symbol On success, will be set to the discovered symbol value.
+ *
+ * @return Returns true if a symbol was found, false otherwise.
+ */
+static bool plcrash_async_macho_find_indexed_symbol (plcrash_async_macho_symbol_index_t *index,
+                                                     pl_vm_address_t slide_pc,
+                                                     plcrash_async_macho_symtab_entry_t *found_symbol)
+{
+    /* Find the first entry with an address > slide_pc */
+    uint32_t low = 0;
+    uint32_t high = index->count;
+    while (low < high) {
+        uint32_t mid = low + ((high - low) / 2);
+        if (index->entries[mid].n_value <= slide_pc)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low == 0)
+        return false;
+
+    /* Reconstruct the symtab entry */
+    plcrash_async_macho_symbol_index_entry_t *entry = &index->entries[low - 1];
+    found_symbol->n_strx = entry->n_strx;
+    found_symbol->n_type = entry->n_type;
+    found_symbol->n_sect = entry->n_sect;
+    found_symbol->n_desc = entry->n_desc;
+    found_symbol->n_value = entry->n_value;
+
+    /* Normalize the symbol address. We have to set the low-order bit ourselves for ARM THUMB functions. */
+    if (entry->n_desc & N_ARM_THUMB_DEF)
+        found_symbol->normalized_value = (entry->n_value|1);
+    else
+        found_symbol->normalized_value = entry->n_value;
+
+    return true;
+}
+
 /**
  * Attempt to locate a symbol address and name for @a pc within @a image. This is performed using best-guess heuristics, and may
  * be incorrect.
@@ -869,7 +2077,11 @@ plcrash_error_t plcrash_async_macho_find_symbol_by_pc (plcrash_async_macho_t *im
     plcrash_async_macho_symtab_entry_t found_symbol;
     bool did_find_symbol;
 
-    if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
+    plcrash_async_macho_symbol_index_t *index = image->symbol_index;
+    if (index != NULL) {
+        /* A symbol index is available; perform a binary search */
+        did_find_symbol = plcrash_async_macho_find_indexed_symbol(index, slide_pc, &found_symbol);
+    } else if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
         /* dysymtab is available; use it to constrain our symbol search to the global and local sections of the symbol table. */
         plcrash_async_macho_find_best_symbol(&reader, slide_pc, reader.symtab_global, reader.nsyms_global, &found_symbol, NULL, &did_find_symbol);
         plcrash_async_macho_find_best_symbol(&reader, slide_pc, reader.symtab_local, reader.nsyms_local, &found_symbol, &found_symbol, &did_find_symbol);
@@ -903,6 +2115,169 @@ cleanup:
     return retval;
 }
 
+/**
+ * @internal
+ * Maximum number of PC values resolved by a single symbol table pass in plcrash_async_macho_find_symbols_by_pc().
+ */
+#define PL_ASYNC_MACHO_SYMBOL_BATCH_MAX 64
+
+/*
+ * Record the best candidate symbols within @a symtab for the sorted @a pcs. Each symbol is recorded only against the
+ * first PC at or after the symbol's address; the candidates must then be propagated forward to any subsequent PCs
+ * for which no closer symbol was found.
+ *
+ * @param reader The Mach-O symbol table reader.
+ * @param pcs The PC values, sorted in ascending order.
+ * @param count The number of values in @a pcs.
+ * @param slide The VM slide to be removed from all @a pcs values.
+ * @param symtab The symtab to search.
+ * @param nsyms The number of nlist entries available via @a symtab.
+ * @param found_symbols The candidate symbols, indexed by PC.
+ * @param did_find_symbols Candidate flags, indexed by PC.
+ */
+static PLCF_ALWAYS_INLINE void plcrash_async_macho_find_best_symbols_impl (plcrash_async_macho_symtab_reader_t *reader,
+                                                                           const pl_vm_address_t *pcs, size_t count, pl_vm_off_t slide,
+                                                                           pl_nlist_common *symtab, uint32_t nsyms,
+                                                                           plcrash_async_macho_symtab_entry_t *found_symbols,
+                                                                           bool *did_find_symbols,
+                                                                           const bool m64)
+{
+    const plcrash_async_byteorder_t *byteorder = reader->image->byteorder;
+    for (uint32_t i = 0; i < nsyms; i++) {
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_read_entry(byteorder, symtab, i, m64);
+        
+        /* Symbol must be within a section, and must not be a debugging entry. */
+        if ((entry.n_type & N_TYPE) != N_SECT || ((entry.n_type & N_STAB) != 0))
+            continue;
+
+        /* Find the first PC at or after the symbol address */
+        size_t low = 0;
+        size_t high = count;
+        while (low < high) {
+            size_t mid = low + ((high - low) / 2);
+            if (pcs[mid] - slide < entry.n_value)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+
+        if (low == count)
+            continue;
+
+        /* We're looking for the closest symbol occuring before PC. */
+        if (!did_find_symbols[low] || found_symbols[low].n_value < entry.n_value) {
+            found_symbols[low] = entry;
+            did_find_symbols[low] = true;
+        }
+    }
+}
+
+/*
+ * Pointer width dispatch for plcrash_async_macho_find_best_symbols_impl().
+ */
+static void plcrash_async_macho_find_best_symbols (plcrash_async_macho_symtab_reader_t *reader,
+                                                   const pl_vm_address_t *pcs, size_t count, pl_vm_off_t slide,
+                                                   pl_nlist_common *symtab, uint32_t nsyms,
+                                                   plcrash_async_macho_symtab_entry_t *found_symbols,
+                                                   bool *did_find_symbols)
+{
+    if (reader->image->m64)
+        plcrash_async_macho_find_best_symbols_impl(reader, pcs, count, slide, symtab, nsyms, found_symbols, did_find_symbols, true);
+    else
+        plcrash_async_macho_find_best_symbols_impl(reader, pcs, count, slide, symtab, nsyms, found_symbols, did_find_symbols, false);
+}
+
+/**
+ * Attempt to locate symbol addresses and names for all of @a pcs within @a image, mapping the symbol table only once
+ * and performing a single symbol table pass for every PL_ASYNC_MACHO_SYMBOL_BATCH_MAX PC values. This is performed
+ * using the same best-guess heuristics as plcrash_async_macho_find_symbol_by_pc(), and may be incorrect.
+ *
+ * @param image The Mach-O image to search for @a pcs.
+ * @param pcs The PC values within the target process for which symbol information should be found. The values must be
+ * sorted in ascending order.
+ * @param count The number of values in @a pcs.
+ * @param symbol_cb A callback to be called for each PC for which a symbol is found.
+ * @param context Context to be passed to @a symbol_cb.
+ *
+ * @return Returns PLCRASH_ESUCCESS if at least one symbol is found. If no symbols are found, @a symbol_cb will not be called,
+ * and PLCRASH_ENOTFOUND (or another error value if the symbol table could not be read) will be returned.
+ */
+plcrash_error_t plcrash_async_macho_find_symbols_by_pc (plcrash_async_macho_t *image,
+                                                        const pl_vm_address_t *pcs,
+                                                        size_t count,
+                                                        pl_async_macho_found_symbols_cb symbol_cb,
+                                                        void *context)
+{
+    plcrash_error_t retval;
+
+    /* Initialize a symbol table reader */
+    plcrash_async_macho_symtab_reader_t reader;
+    retval = plcrash_async_macho_symtab_reader_init(&reader, image);
+    if (retval != PLCRASH_ESUCCESS)
+        return retval;
+
+    plcrash_async_macho_symbol_index_t *index = image->symbol_index;
+    plcrash_async_macho_symtab_entry_t found_symbols[PL_ASYNC_MACHO_SYMBOL_BATCH_MAX];
+    bool did_find_symbols[PL_ASYNC_MACHO_SYMBOL_BATCH_MAX];
+    size_t found_count = 0;
+
+    for (size_t base = 0; base < count; base += PL_ASYNC_MACHO_SYMBOL_BATCH_MAX) {
+        const pl_vm_address_t *batch = pcs + base;
+        size_t batch_count = count - base;
+        if (batch_count > PL_ASYNC_MACHO_SYMBOL_BATCH_MAX)
+            batch_count = PL_ASYNC_MACHO_SYMBOL_BATCH_MAX;
+
+        if (index != NULL) {
+            /* A symbol index is available; perform a binary search for each PC */
+            for (size_t i = 0; i < batch_count; i++)
+                did_find_symbols[i] = plcrash_async_macho_find_indexed_symbol(index, batch[i] - image->vmaddr_slide, &found_symbols[i]);
+        } else {
+            for (size_t i = 0; i < batch_count; i++)
+                did_find_symbols[i] = false;
+
+            if (reader.symtab_global != NULL && reader.symtab_local != NULL) {
+                /* dysymtab is available; use it to constrain our symbol search to the global and local sections of the symbol table. */
+                plcrash_async_macho_find_best_symbols(&reader, batch, batch_count, image->vmaddr_slide, reader.symtab_global, reader.nsyms_global, found_symbols, did_find_symbols);
+                plcrash_async_macho_find_best_symbols(&reader, batch, batch_count, image->vmaddr_slide, reader.symtab_local, reader.nsyms_local, found_symbols, did_find_symbols);
+            } else {
+                /* If dysymtab is not available, search all symbols */
+                plcrash_async_macho_find_best_symbols(&reader, batch, batch_count, image->vmaddr_slide, reader.symtab, reader.nsyms, found_symbols, did_find_symbols);
+            }
+
+            /* Propagate candidates forward. Any candidate recorded against a PC is necessarily closer than the
+             * preceding PC's best match, so only PCs without a candidate need be updated. */
+            for (size_t i = 1; i < batch_count; i++) {
+                if (!did_find_symbols[i] && did_find_symbols[i-1]) {
+                    found_symbols[i] = found_symbols[i-1];
+                    did_find_symbols[i] = true;
+                }
+            }
+        }
+
+        /* Inform our caller */
+        for (size_t i = 0; i < batch_count; i++) {
+            if (!did_find_symbols[i])
+                continue;
+
+            const char *sym_name = plcrash_async_macho_symtab_reader_symbol_name(&reader, found_symbols[i].n_strx);
+            if (sym_name == NULL) {
+                PLCF_DEBUG("Failed to read symbol name\n");
+                continue;
+            }
+
+            symbol_cb(base + i, found_symbols[i].normalized_value + image->vmaddr_slide, sym_name, context);
+            found_count++;
+        }
+    }
+
+    plcrash_async_macho_symtab_reader_free(&reader);
+
+    if (found_count == 0)
+        return PLCRASH_ENOTFOUND;
+
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Free all mapped segment resources.
  *
@@ -918,11 +2293,25 @@ void plcrash_async_macho_mapped_segment_free (pl_async_macho_mapped_segment_t *s
  * @warning This method is not async safe.
  */
 void plcrash_nasync_macho_free (plcrash_async_macho_t *image) {
-    if (image->name != NULL)
+    if (image->name != NULL && !image->compact)
         free(image->name);
     
     plcrash_async_mobject_free(&image->load_cmds);
 
+    if (image->symbol_index != NULL && !(image->shared_indices & PLCRASH_ASYNC_MACHO_SHARED_SYMBOL_INDEX))
+        free(image->symbol_index);
+
+    if (image->objc_index != NULL)
+        plcrash_nasync_objc_free_index(image->objc_index);
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (image->dwarf_cfa_table != NULL && !(image->shared_indices & PLCRASH_ASYNC_MACHO_SHARED_DWARF_CFA_TABLE))
+        plcrash_nasync_dwarf_cfa_table_free(image->dwarf_cfa_table);
+
+    if (image->dwarf_fde_index != NULL && !(image->shared_indices & PLCRASH_ASYNC_MACHO_SHARED_DWARF_FDE_INDEX))
+        plcrash_nasync_dwarf_fde_index_free(image->dwarf_fde_index);
+#endif
+
     mach_port_mod_refs(mach_task_self(), image->task, MACH_PORT_RIGHT_SEND, -1);
 }
 
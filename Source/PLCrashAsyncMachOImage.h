@@ -39,6 +39,7 @@ extern "C" {
 #include <mach-o/nlist.h>
 
 #include "PLCrashAsyncMObject.h"
+#include "PLCrashAsyncWorkBudget.h"
 
 /**
  * @internal
@@ -46,6 +47,150 @@ extern "C" {
  * @{
  */
 
+/**
+ * @internal
+ *
+ * A symbol address index entry. The entry is sufficient to reconstruct a plcrash_async_macho_symtab_entry_t for
+ * symbol lookup; the symbol name must still be read from the image's string table.
+ */
+typedef struct plcrash_async_macho_symbol_index_entry {
+    /** The symbol's unslid address, as defined by the nlist n_value field. */
+    uint64_t n_value;
+
+    /** Index into the image's string table. */
+    uint32_t n_strx;
+
+    /** The symbol's nlist n_desc field. */
+    uint16_t n_desc;
+
+    /** The symbol's nlist n_type field. */
+    uint8_t n_type;
+
+    /** The symbol's nlist n_sect field. */
+    uint8_t n_sect;
+} plcrash_async_macho_symbol_index_entry_t;
+
+/**
+ * @internal
+ *
+ * An immutable, address-sorted index of an image's section symbols. Only the first symbol found for any given
+ * address is included, matching the linear symbol table search performed by plcrash_async_macho_find_symbol_by_pc().
+ */
+typedef struct plcrash_async_macho_symbol_index {
+    /** The number of entries in @a entries. */
+    uint32_t count;
+
+    /** The index entries, sorted by ascending n_value. */
+    plcrash_async_macho_symbol_index_entry_t entries[];
+} plcrash_async_macho_symbol_index_t;
+
+/**
+ * @internal
+ *
+ * A fixed-width, 16 byte Mach-O segment or section name, packed as two 64-bit words. This allows names to be
+ * compared with a few integer operations, rather than a byte-wise strncmp(). See plcrash_async_macho_name_init().
+ */
+typedef struct plcrash_async_macho_name {
+    /** The name, zero-filled following its terminator. */
+    uint64_t words[2];
+
+    /** Selects the bytes of @a words that must match: the name's characters, and its terminator if the name is
+     * shorter than the field. */
+    uint64_t mask[2];
+} plcrash_async_macho_name_t;
+
+/** @internal The number of load command types recorded by plcrash_async_macho_cmd_cache_t. */
+#define PLCRASH_ASYNC_MACHO_CACHED_COMMAND_COUNT 3
+
+/** @internal The number of segments recorded by plcrash_async_macho_cmd_cache_t. */
+#define PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT 4
+
+/** @internal The number of sections recorded by plcrash_async_macho_cmd_cache_t. */
+#define PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT 7
+
+/**
+ * @internal
+ *
+ * Load command metadata recorded by plcrash_nasync_macho_init(). The frequently used load commands (LC_SYMTAB,
+ * LC_DYSYMTAB, LC_UUID), segments (__TEXT, __DATA, __OBJC, __LINKEDIT) and sections (unwind and ObjC data) are
+ * recorded once, allowing them to be found without iterating the image's load commands.
+ *
+ * All pointers reference the image's mapped load commands, and have been verified to be fully readable.
+ */
+typedef struct plcrash_async_macho_cmd_cache {
+    /** If false, the load commands could not be fully parsed, and lookups must iterate the load commands. */
+    bool valid;
+
+    /** The first load command of each cached type, or NULL if not present. */
+    void *commands[PLCRASH_ASYNC_MACHO_CACHED_COMMAND_COUNT];
+
+    /** The first segment command of each cached name, or NULL if not present. */
+    void *segments[PLCRASH_ASYNC_MACHO_CACHED_SEGMENT_COUNT];
+
+    /** The section entry (struct section or struct section_64) of each cached section within the first segment
+     * of the matching name, or NULL if not present. */
+    void *sections[PLCRASH_ASYNC_MACHO_CACHED_SECTION_COUNT];
+} plcrash_async_macho_cmd_cache_t;
+
+/**
+ * @internal
+ *
+ * Symbolication capabilities of a Mach-O image, computed from its load commands by plcrash_nasync_macho_init().
+ * Symbolication strategies that require a capability the image lacks can't succeed, and may be skipped.
+ */
+typedef enum {
+    /** The image has an LC_SYMTAB symbol table containing at least one defined symbol. */
+    PLCRASH_ASYNC_MACHO_CAPABILITY_SYMTAB = 1 << 0,
+
+    /** The image has a non-empty ObjC2 __DATA,__objc_classlist section. */
+    PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC2 = 1 << 1,
+
+    /** The image has a non-empty ObjC1 __OBJC,__module_info section. */
+    PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC1 = 1 << 2,
+} plcrash_async_macho_capability_t;
+
+/** @internal Any Objective-C metadata capability. */
+#define PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC (PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC1 | PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC2)
+
+/** @internal All capabilities; assumed if an image's load commands could not be fully parsed. */
+#define PLCRASH_ASYNC_MACHO_CAPABILITY_ALL (PLCRASH_ASYNC_MACHO_CAPABILITY_SYMTAB | PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC)
+
+/**
+ * @internal
+ *
+ * The minimum size of a plcrash_async_macho_cmd_arena_t chunk.
+ */
+#define PLCRASH_ASYNC_MACHO_CMD_ARENA_CHUNK_SIZE (64 * 1024)
+
+/**
+ * @internal
+ *
+ * A bump-allocating arena of Mach-O load command copies, shared by images initialized via
+ * plcrash_nasync_macho_init_compact(). Packing the load commands of many images into a small number of contiguous
+ * chunks avoids the cost of a separate VM mapping per image. Chunks are only released when the arena is freed.
+ */
+typedef struct plcrash_async_macho_cmd_arena {
+    /** The current chunk, followed by any previously filled chunks, or NULL. */
+    struct plcrash_async_macho_cmd_arena_chunk *chunks;
+} plcrash_async_macho_cmd_arena_t;
+
+/**
+ * @internal
+ *
+ * Indices that a Mach-O image may borrow from another instance of the same image; see
+ * plcrash_nasync_macho_share_indices().
+ */
+typedef enum {
+    /** The symbol address index (plcrash_async_macho::symbol_index). */
+    PLCRASH_ASYNC_MACHO_SHARED_SYMBOL_INDEX = 1 << 0,
+
+    /** The compiled DWARF CFA table (plcrash_async_macho::dwarf_cfa_table). */
+    PLCRASH_ASYNC_MACHO_SHARED_DWARF_CFA_TABLE = 1 << 1,
+
+    /** The sorted DWARF FDE index (plcrash_async_macho::dwarf_fde_index). */
+    PLCRASH_ASYNC_MACHO_SHARED_DWARF_FDE_INDEX = 1 << 2,
+} plcrash_async_macho_shared_index_t;
+
 /**
  * @internal
  *
@@ -64,6 +209,13 @@ typedef struct plcrash_async_macho {
     /** The binary image's name/path. */
     char *name;
 
+    /** The length of @a name, in bytes, excluding the NUL terminator. */
+    size_t name_length;
+
+    /** If true, the image was initialized via plcrash_nasync_macho_init_compact(); @a name is borrowed, and
+     * @a load_cmds references a copy of the load commands within a shared plcrash_async_macho_cmd_arena_t. */
+    bool compact;
+
     /** The Mach-O header. For our purposes, the 32-bit and 64-bit headers are identical. Note that the header
      * values may require byte-swapping for the local process' use. */
     struct mach_header header;
@@ -75,7 +227,8 @@ typedef struct plcrash_async_macho {
     /** Number of load commands */
     uint32_t ncmds;
 
-    /** Mapped Mach-O load commands */
+    /** Mapped Mach-O load commands. For images of the current task, this directly references the load commands
+     * mapped by dyld; see plcrash_nasync_mobject_init_direct(). */
     plcrash_async_mobject_t load_cmds;
 
     /** The Mach-O image's __TEXT segment, as defined by the LC_SEGMENT/LC_SEGMENT_64 load command. */
@@ -89,6 +242,45 @@ typedef struct plcrash_async_macho {
 
     /** The byte order functions to use for this image */
     const plcrash_async_byteorder_t *byteorder;
+
+    /** Cached load command metadata. */
+    plcrash_async_macho_cmd_cache_t cmd_cache;
+
+    /** The image's symbolication capabilities; a bitwise OR of plcrash_async_macho_capability_t values. */
+    uint32_t capabilities;
+
+    /** The number of local symbols in the image's symbol table, as declared by LC_DYSYMTAB, or the total number of
+     * symbols if LC_DYSYMTAB is not available. */
+    uint32_t local_symbol_count;
+
+    /** The image's symbol address index, or NULL if the index has not been built. The index is created by
+     * plcrash_nasync_macho_index_symbols() and is immutable once published. */
+    plcrash_async_macho_symbol_index_t * volatile symbol_index;
+
+    /** The image's Objective-C IMP index, or NULL if the index has not been built. The index is created by
+     * plcrash_nasync_objc_index_image() and is immutable once published. */
+    struct plcrash_async_objc_imp_index * volatile objc_index;
+
+    /** The image's compiled DWARF CFA table, or NULL if the table has not been built. The table is created by
+     * plcrash_nasync_dwarf_cfa_table_compile() and is immutable once published. */
+    struct plcrash_async_dwarf_cfa_table * volatile dwarf_cfa_table;
+
+    /** The image's sorted DWARF FDE index, or NULL if the index has not been built. The index is created by
+     * plcrash_nasync_dwarf_fde_index_build() and is immutable once published. */
+    struct plcrash_async_dwarf_fde_index * volatile dwarf_fde_index;
+
+    /** Set by the DWARF unwinder when an FDE lookup within this image required a linear scan of its DWARF data;
+     * see plcrash_nasync_image_list_index_dwarf(). */
+    volatile bool dwarf_fde_index_requested;
+
+    /** The indices borrowed from another image via plcrash_nasync_macho_share_indices(), or from an index store via
+     * plcrash_nasync_image_index_store_load(); a bitwise OR of plcrash_async_macho_shared_index_t values. Borrowed
+     * indices are not freed with the image. */
+    uint32_t shared_indices;
+
+    /** A borrowed mapping of the dyld shared cache's LINKEDIT region, or NULL. If set, the image's __LINKEDIT
+     * segment is read from this mapping. See plcrash_nasync_macho_set_shared_linkedit(). */
+    const plcrash_async_mobject_t * volatile shared_linkedit;
 } plcrash_async_macho_t;
 
 /**
@@ -176,6 +368,103 @@ typedef struct plcrash_async_macho_symtab_reader {
     size_t string_table_size;
 } plcrash_async_macho_symtab_reader_t;
 
+/**
+ * @internal
+ *
+ * Maximum number of section mappings retained by a plcrash_async_macho_section_cache_t.
+ */
+#define PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE 16
+
+/**
+ * @internal
+ *
+ * Maximum number of indirect compact unwind stack sizes retained by a plcrash_async_macho_section_cache_t.
+ */
+#define PLCRASH_ASYNC_MACHO_SECTION_CACHE_STACK_SIZES 16
+
+/**
+ * @internal
+ *
+ * A cached indirect stack size, as read from a function's TEXT by the compact unwind STACK_IND encoding.
+ */
+typedef struct plcrash_async_macho_stack_size_entry {
+    /** The task-relative address from which the stack size was read. */
+    pl_vm_address_t address;
+
+    /** The stack size value read from @a address. */
+    uint32_t stack_size;
+} plcrash_async_macho_stack_size_entry_t;
+
+/**
+ * @internal
+ *
+ * A section cache entry.
+ */
+typedef struct plcrash_async_macho_section_cache_entry {
+    /** The image from which the section was mapped, or NULL if this entry is unused. */
+    plcrash_async_macho_t *image;
+
+    /** The packed segment name. */
+    plcrash_async_macho_name_t segname;
+
+    /** The packed section name. */
+    plcrash_async_macho_name_t sectname;
+
+    /** The result of mapping the section. If not PLCRASH_ESUCCESS, @a mobj is uninitialized. */
+    plcrash_error_t result;
+
+    /** The number of outstanding references to @a mobj. Entries with outstanding references will not be evicted. */
+    uint32_t refcount;
+
+    /** The mapped section data. */
+    plcrash_async_mobject_t mobj;
+} plcrash_async_macho_section_cache_entry_t;
+
+/**
+ * @internal
+ *
+ * Caches section mappings across API calls. This is used to avoid the cost of re-mapping the same sections
+ * (eg, __eh_frame or __unwind_info) when walking multiple frames that reside within the same image.
+ *
+ * @warning It is invalid to reuse this cache for multiple Mach tasks.
+ * @warning Any plcrash_async_macho_t pointers passed in must remain valid across all calls using this cache.
+ */
+typedef struct plcrash_async_macho_section_cache {
+    /** Cache entries. */
+    plcrash_async_macho_section_cache_entry_t entries[PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE];
+
+    /** The index at which the next eviction will be attempted. */
+    size_t next_entry;
+
+    /** An optional, borrowed reference to a DWARF CIE cache to be used by the DWARF frame reader alongside the
+     * mapped sections, or NULL. See plframe_dwarf_cie_cache_new(). */
+    struct plframe_dwarf_cie_cache *dwarf_cie_cache;
+
+    /** Indirect stack sizes read from the TEXT of frameless functions, used to avoid re-reading the same
+     * immediate for every frame that unwinds through a given function. */
+    plcrash_async_macho_stack_size_entry_t stack_sizes[PLCRASH_ASYNC_MACHO_SECTION_CACHE_STACK_SIZES];
+
+    /** The number of valid entries in @a stack_sizes. */
+    size_t stack_size_count;
+
+    /** The index at which the next stack size will be stored once @a stack_sizes is full. */
+    size_t next_stack_size;
+
+    /** An optional, borrowed reference to the work budget to be consumed by the frame readers when parsing the
+     * mapped unwind data, or NULL. */
+    plcrash_async_work_budget_t *work_budget;
+
+    /** The image to which @a fde_hint_offset applies, or NULL if no FDE hint has been recorded. See
+     * plcrash_async_macho_section_cache_set_fde_hint(). */
+    plcrash_async_macho_t *fde_hint_image;
+
+    /** The PC for which @a fde_hint_offset was recorded. */
+    pl_vm_address_t fde_hint_pc;
+
+    /** The __eh_frame offset of the FDE covering @a fde_hint_pc, as provided by the compact unwind encoding. */
+    pl_vm_off_t fde_hint_offset;
+} plcrash_async_macho_section_cache_t;
+
 /**
  * Prototype of a callback function used to execute user code with async-safely fetched symbol.
  *
@@ -186,7 +475,27 @@ typedef struct plcrash_async_macho_symtab_reader {
  */
 typedef void (*pl_async_macho_found_symbol_cb)(pl_vm_address_t address, const char *name, void *ctx);
 
+/**
+ * Prototype of a callback function used to return symbols found by plcrash_async_macho_find_symbols_by_pc().
+ *
+ * @param index The index of the PC value for which the symbol was found.
+ * @param address The symbol address.
+ * @param name The symbol name. The callback is responsible for copying this value, as its backing storage is not gauranteed to exist
+ * after the callback returns.
+ * @param ctx The API client's supplied context value.
+ */
+typedef void (*pl_async_macho_found_symbols_cb)(size_t index, pl_vm_address_t address, const char *name, void *ctx);
+
 plcrash_error_t plcrash_nasync_macho_init (plcrash_async_macho_t *image, mach_port_t task, const char *name, pl_vm_address_t header);
+plcrash_error_t plcrash_nasync_macho_init_compact (plcrash_async_macho_t *image, mach_port_t task, const char *name, pl_vm_address_t header,
+                                                  plcrash_async_macho_cmd_arena_t *arena);
+
+void plcrash_nasync_macho_cmd_arena_init (plcrash_async_macho_cmd_arena_t *arena);
+void plcrash_nasync_macho_cmd_arena_free (plcrash_async_macho_cmd_arena_t *arena);
+size_t plcrash_nasync_macho_cmd_arena_size (plcrash_async_macho_cmd_arena_t *arena);
+
+bool plcrash_nasync_macho_set_shared_linkedit (plcrash_async_macho_t *image, const plcrash_async_mobject_t *linkedit);
+uint32_t plcrash_nasync_macho_share_indices (plcrash_async_macho_t *image, const plcrash_async_macho_t *donor);
 
 const plcrash_async_byteorder_t *plcrash_async_macho_byteorder (plcrash_async_macho_t *image);
 const struct mach_header *plcrash_async_macho_header (plcrash_async_macho_t *image);
@@ -200,12 +509,39 @@ void *plcrash_async_macho_next_command_type (plcrash_async_macho_t *image, void
 void *plcrash_async_macho_find_command (plcrash_async_macho_t *image, uint32_t cmd);
 void *plcrash_async_macho_find_segment_cmd (plcrash_async_macho_t *image, const char *segname);
 
+void plcrash_async_macho_name_init (plcrash_async_macho_name_t *name, const char *str);
+bool plcrash_async_macho_name_matches (const plcrash_async_macho_name_t *name, const char *field);
+
 plcrash_error_t plcrash_async_macho_map_segment (plcrash_async_macho_t *image, const char *segname, pl_async_macho_mapped_segment_t *seg);
 plcrash_error_t plcrash_async_macho_map_section (plcrash_async_macho_t *image, const char *segname, const char *sectname, plcrash_async_mobject_t *mobj);
 
+void plcrash_async_macho_section_cache_init (plcrash_async_macho_section_cache_t *cache);
+plcrash_error_t plcrash_async_macho_section_cache_map (plcrash_async_macho_section_cache_t *cache,
+                                                       plcrash_async_macho_t *image,
+                                                       const char *segname,
+                                                       const char *sectname,
+                                                       plcrash_async_mobject_t *storage,
+                                                       plcrash_async_mobject_t **mobj);
+void plcrash_async_macho_section_cache_unmap (plcrash_async_macho_section_cache_t *cache, plcrash_async_mobject_t *mobj);
+void plcrash_async_macho_section_cache_free (plcrash_async_macho_section_cache_t *cache);
+void plcrash_async_macho_section_cache_evict (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image);
+
+bool plcrash_async_macho_section_cache_find_stack_size (plcrash_async_macho_section_cache_t *cache, pl_vm_address_t address, uint32_t *stack_size);
+void plcrash_async_macho_section_cache_add_stack_size (plcrash_async_macho_section_cache_t *cache, pl_vm_address_t address, uint32_t stack_size);
+
+void plcrash_async_macho_section_cache_set_fde_hint (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image, pl_vm_address_t pc, pl_vm_off_t fde_offset);
+bool plcrash_async_macho_section_cache_take_fde_hint (plcrash_async_macho_section_cache_t *cache, plcrash_async_macho_t *image, pl_vm_address_t pc, pl_vm_off_t *fde_offset);
+
 plcrash_error_t plcrash_async_macho_find_symbol_by_pc (plcrash_async_macho_t *image, pl_vm_address_t pc, pl_async_macho_found_symbol_cb symbol_cb, void *context);
+plcrash_error_t plcrash_async_macho_find_symbols_by_pc (plcrash_async_macho_t *image,
+                                                        const pl_vm_address_t *pcs,
+                                                        size_t count,
+                                                        pl_async_macho_found_symbols_cb symbol_cb,
+                                                        void *context);
 plcrash_error_t plcrash_async_macho_find_symbol_by_name (plcrash_async_macho_t *image, const char *symbol, pl_vm_address_t *pc);
 
+plcrash_error_t plcrash_nasync_macho_index_symbols (plcrash_async_macho_t *image);
+
 plcrash_error_t plcrash_async_macho_symtab_reader_init (plcrash_async_macho_symtab_reader_t *reader, plcrash_async_macho_t *image);
 plcrash_async_macho_symtab_entry_t plcrash_async_macho_symtab_reader_read (plcrash_async_macho_symtab_reader_t *reader, void *symtab, uint32_t index);
 const char *plcrash_async_macho_symtab_reader_symbol_name (plcrash_async_macho_symtab_reader_t *reader, uint32_t n_strx);
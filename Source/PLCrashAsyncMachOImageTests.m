@@ -68,6 +68,7 @@
 
     /* Basic test of the initializer */
     STAssertEqualCStrings(_image.name, info.dli_fname, @"Incorrect name");
+    STAssertEquals(_image.name_length, strlen(info.dli_fname), @"Incorrect name length");
     STAssertEquals(_image.header_addr, (pl_vm_address_t) info.dli_fbase, @"Incorrect header address");
     STAssertEquals(_image.vmaddr_slide, (pl_vm_off_t) vmaddr_slide, @"Incorrect vmaddr_slide value");
     
@@ -139,6 +140,83 @@
     }
 }
 
+/**
+ * Test initialization of images in the current task, verifying that the load commands are referenced in place
+ * without per-image mappings.
+ */
+- (void) testDirectInit {
+    uint32_t map_count = plcrash_async_mobject_map_count();
+
+    for (uint32_t i = 0; i < _dyld_image_count(); i++) {
+        plcrash_async_macho_t image;
+        pl_vm_address_t header = (pl_vm_address_t) _dyld_get_image_header(i);
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&image, mach_task_self(), _dyld_get_image_name(i), header), @"Failed to initialize %s", _dyld_get_image_name(i));
+
+        STAssertEquals(image.load_cmds.address, (uintptr_t) (header + image.header_size), @"Load commands were not referenced in place");
+        STAssertEquals(image.load_cmds.vm_slide, (int64_t) 0, @"Non-zero slide for directly referenced load commands");
+        plcrash_nasync_macho_free(&image);
+    }
+
+    STAssertEquals(map_count, plcrash_async_mobject_map_count(), @"Initialization created memory mappings");
+}
+
+/**
+ * Test compact initialization, verifying that the load commands are served from the arena without per-image
+ * mappings, and that the results match those of a standard image.
+ */
+- (void) testCompactInit {
+    plcrash_async_macho_cmd_arena_t arena;
+    plcrash_nasync_macho_cmd_arena_init(&arena);
+
+    uint32_t count = _dyld_image_count();
+    plcrash_async_macho_t *images = calloc(count, sizeof(images[0]));
+    uint32_t map_count = plcrash_async_mobject_map_count();
+
+    for (uint32_t i = 0; i < count; i++) {
+        const char *name = _dyld_get_image_name(i);
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init_compact(&images[i], mach_task_self(), name, (pl_vm_address_t) _dyld_get_image_header(i), &arena), @"Failed to initialize %s", name);
+        STAssertTrue(images[i].compact, @"Image was not initialized in compact mode");
+        STAssertEquals((const char *) images[i].name, name, @"Name was not borrowed");
+    }
+
+    STAssertEquals(map_count, plcrash_async_mobject_map_count(), @"Compact initialization created memory mappings");
+
+    /* Compare against a standard image */
+    plcrash_async_macho_t *compact = NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        if (images[i].header_addr == _image.header_addr)
+            compact = &images[i];
+    }
+    STAssertNotNULL(compact, @"Could not find the test image");
+
+    STAssertEquals(compact->text_vmaddr, _image.text_vmaddr, @"Incorrect text segment address");
+    STAssertEquals(compact->text_size, _image.text_size, @"Incorrect text segment size");
+    STAssertEquals(compact->vmaddr_slide, _image.vmaddr_slide, @"Incorrect vmaddr_slide value");
+    STAssertEquals(compact->ncmds, _image.ncmds, @"Incorrect command count");
+
+    struct load_command *cmd = NULL;
+    struct load_command *expected = NULL;
+    for (uint32_t ncmd = 0; ncmd < compact->ncmds; ncmd++) {
+        cmd = plcrash_async_macho_next_command(compact, cmd);
+        expected = plcrash_async_macho_next_command(&_image, expected);
+        STAssertNotNULL(cmd, @"Failed to fetch load command %" PRIu32, ncmd);
+        if (cmd == NULL || expected == NULL)
+            break;
+
+        STAssertTrue(memcmp(cmd, expected, expected->cmdsize) == 0, @"Load command %" PRIu32 " does not match", ncmd);
+    }
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_macho_map_section(compact, SEG_DATA, "__objc_classlist", &mobj), PLCRASH_ESUCCESS, @"Failed to map section");
+    plcrash_async_mobject_free(&mobj);
+
+    for (uint32_t i = 0; i < count; i++)
+        plcrash_nasync_macho_free(&images[i]);
+    free(images);
+
+    plcrash_nasync_macho_cmd_arena_free(&arena);
+}
+
 /**
  * Test type-specific iteration of Mach-O load commands.
  */
@@ -273,6 +351,170 @@
     STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_map_section(&_image, "__DATA", "__NO_SUCH_SECT", &mobj), @"Should have failed to map the section");
 }
 
+/**
+ * Verify that the load command cache returns the same results as iterating the load commands.
+ */
+- (void) testCommandCache {
+    STAssertTrue(_image.cmd_cache.valid, @"Load command cache was not populated");
+
+    /* Fetch the cached results */
+    void *symtab = plcrash_async_macho_find_command(&_image, LC_SYMTAB);
+    void *linkedit = plcrash_async_macho_find_segment_cmd(&_image, SEG_LINKEDIT);
+
+    plcrash_async_mobject_t cached_mobj;
+    STAssertEquals(plcrash_async_macho_map_section(&_image, SEG_DATA, "__objc_classlist", &cached_mobj), PLCRASH_ESUCCESS, @"Failed to map section");
+    STAssertEquals(plcrash_async_macho_map_section(&_image, SEG_TEXT, "__NO_SUCH_SECT", &cached_mobj), PLCRASH_ENOTFOUND, @"Should have failed to map the section");
+
+    /* Compare against the uncached results */
+    _image.cmd_cache.valid = false;
+
+    STAssertNotNULL(symtab, @"Failed to find LC_SYMTAB");
+    STAssertEquals(symtab, plcrash_async_macho_find_command(&_image, LC_SYMTAB), @"Cached LC_SYMTAB does not match");
+
+    STAssertNotNULL(linkedit, @"Failed to find __LINKEDIT");
+    STAssertEquals(linkedit, plcrash_async_macho_find_segment_cmd(&_image, SEG_LINKEDIT), @"Cached __LINKEDIT does not match");
+
+    plcrash_async_mobject_t mobj;
+    STAssertEquals(plcrash_async_macho_map_section(&_image, SEG_DATA, "__objc_classlist", &mobj), PLCRASH_ESUCCESS, @"Failed to map section");
+    STAssertEquals(cached_mobj.address + cached_mobj.vm_slide, mobj.address + mobj.vm_slide, @"Addresses do not match");
+    STAssertEquals(cached_mobj.length, mobj.length, @"Sizes do not match");
+
+    _image.cmd_cache.valid = true;
+
+    plcrash_async_mobject_free(&cached_mobj);
+    plcrash_async_mobject_free(&mobj);
+}
+
+/**
+ * Test the symbolication capabilities computed at initialization.
+ */
+- (void) testCapabilities {
+    /* Our test image has a symbol table and ObjC2 metadata */
+    STAssertTrue((_image.capabilities & PLCRASH_ASYNC_MACHO_CAPABILITY_SYMTAB) != 0, @"Symbol table capability not found");
+    STAssertTrue((_image.capabilities & PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC2) != 0, @"ObjC2 capability not found");
+
+    struct dysymtab_command *dysymtab = plcrash_async_macho_find_command(&_image, LC_DYSYMTAB);
+    STAssertNotNULL(dysymtab, @"Failed to find LC_DYSYMTAB");
+    STAssertEquals(_image.local_symbol_count, _image.byteorder->swap32(dysymtab->nlocalsym), @"Incorrect local symbol count");
+
+    /* Verify that the ObjC1 capability matches the presence of the section */
+    plcrash_async_mobject_t mobj;
+    bool has_objc1 = (plcrash_async_macho_map_section(&_image, SEG_OBJC, "__module_info", &mobj) == PLCRASH_ESUCCESS);
+    if (has_objc1)
+        plcrash_async_mobject_free(&mobj);
+    STAssertEquals(has_objc1, (bool) ((_image.capabilities & PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC1) != 0), @"Incorrect ObjC1 capability");
+}
+
+/**
+ * Test packed segment and section name matching.
+ */
+- (void) testNameMatching {
+    plcrash_async_macho_name_t name;
+    char field[16];
+
+    /* Exact match, with trailing garbage following the terminator */
+    plcrash_async_macho_name_init(&name, SEG_TEXT);
+    memset(field, 'X', sizeof(field));
+    memcpy(field, SEG_TEXT, sizeof(SEG_TEXT));
+    STAssertTrue(plcrash_async_macho_name_matches(&name, field), @"Names should match");
+
+    /* Prefixes must not match */
+    memset(field, 0, sizeof(field));
+    memcpy(field, "__TEXTX", 7);
+    STAssertFalse(plcrash_async_macho_name_matches(&name, field), @"A longer name should not match");
+
+    memset(field, 0, sizeof(field));
+    memcpy(field, "__TEX", 5);
+    STAssertFalse(plcrash_async_macho_name_matches(&name, field), @"A shorter name should not match");
+
+    /* Names that fill the field are not terminated, and longer names are truncated */
+    plcrash_async_macho_name_init(&name, "__objc_classlist");
+    memcpy(field, "__objc_classlist", sizeof(field));
+    STAssertTrue(plcrash_async_macho_name_matches(&name, field), @"Full-width names should match");
+
+    plcrash_async_macho_name_init(&name, "__objc_classlistXYZ");
+    STAssertTrue(plcrash_async_macho_name_matches(&name, field), @"Names should be truncated to the field width");
+
+    /* Unaligned fields */
+    char buffer[sizeof(field) + 1];
+    memset(buffer, 0, sizeof(buffer));
+    memcpy(buffer + 1, SEG_DATA, sizeof(SEG_DATA));
+    plcrash_async_macho_name_init(&name, SEG_DATA);
+    STAssertTrue(plcrash_async_macho_name_matches(&name, buffer + 1), @"Unaligned names should match");
+}
+
+/**
+ * Test section cache mapping.
+ */
+- (void) testSectionCacheMap {
+    plcrash_async_macho_section_cache_t cache;
+    plcrash_async_mobject_t storage;
+    plcrash_async_mobject_t *first;
+    plcrash_async_mobject_t *second;
+
+    plcrash_async_macho_section_cache_init(&cache);
+
+    /* Map the section; the mapping should be cached, rather than using our storage */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__const", &storage, &first), @"Failed to map section");
+    STAssertNotEquals(first, &storage, @"Mapping was not cached");
+
+    /* A second mapping should return the same cached memory object */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__const", &storage, &second), @"Failed to map section");
+    STAssertEquals(first, second, @"Cached mapping was not returned");
+
+    /* Verify the mapping */
+    unsigned long sectsize = 0;
+    uint8_t *data = getsectiondata((void *)_image.header_addr, "__DATA", "__const", &sectsize);
+    STAssertNotNULL(data, @"Could not fetch section data");
+    STAssertEquals((pl_vm_address_t)data, (pl_vm_address_t) (first->address + first->vm_slide), @"Addresses do not match");
+    STAssertEquals((pl_vm_size_t)sectsize, first->length, @"Sizes do not match");
+
+    plcrash_async_macho_section_cache_unmap(&cache, first);
+    plcrash_async_macho_section_cache_unmap(&cache, second);
+
+    /* Test handling of a missing section, both on the initial and cached lookup */
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__NO_SUCH_SECT", &storage, &first), @"Should have failed to map the section");
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__NO_SUCH_SECT", &storage, &first), @"Should have failed to map the section");
+
+    plcrash_async_macho_section_cache_free(&cache);
+}
+
+/**
+ * Test eviction of an image's cached sections.
+ */
+- (void) testSectionCacheEvict {
+    plcrash_async_macho_section_cache_t cache;
+    plcrash_async_mobject_t storage;
+    plcrash_async_mobject_t *mobj;
+    uint32_t stack_size;
+
+    plcrash_async_macho_section_cache_init(&cache);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(&cache, &_image, "__DATA", "__const", &storage, &mobj), @"Failed to map section");
+    plcrash_async_macho_section_cache_unmap(&cache, mobj);
+    plcrash_async_macho_section_cache_add_stack_size(&cache, _image.header_addr, 16);
+
+    /* Both the mapping and the stack size should be discarded */
+    plcrash_async_macho_section_cache_evict(&cache, &_image);
+    for (size_t i = 0; i < PLCRASH_ASYNC_MACHO_SECTION_CACHE_SIZE; i++)
+        STAssertNULL(cache.entries[i].image, @"Image was not evicted");
+    STAssertFalse(plcrash_async_macho_section_cache_find_stack_size(&cache, _image.header_addr, &stack_size), @"Stack size was not evicted");
+
+    plcrash_async_macho_section_cache_free(&cache);
+}
+
+/**
+ * Test section mapping without a cache.
+ */
+- (void) testSectionCacheMapUncached {
+    plcrash_async_mobject_t storage;
+    plcrash_async_mobject_t *mobj;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_section_cache_map(NULL, &_image, "__DATA", "__const", &storage, &mobj), @"Failed to map section");
+    STAssertEquals(mobj, &storage, @"Uncached mapping should use the provided storage");
+    plcrash_async_macho_section_cache_unmap(NULL, mobj);
+}
+
 
 /**
  * Test memory mapping of a missing Mach-O segment
@@ -397,6 +639,87 @@ static void testFindSymbol_cb (pl_vm_address_t address, const char *name, void *
     STAssertEquals(dli.dli_saddr, (void *) ctx.addr, @"Returned incorrect symbol address with slide %" PRId64, (int64_t) _image.vmaddr_slide);
 }
 
+/**
+ * Test symbol lookup using a pre-built symbol index.
+ */
+- (void) testFindSymbolIndexed {
+    /* Fetch our current PC, to be used for symbol lookup */
+    void *callstack[1];
+    int frames = backtrace(callstack, 1);
+    STAssertEquals(1, frames, @"Could not fetch our PC");
+
+    /* Perform an unindexed lookup for comparison */
+    struct testFindSymbol_cb_ctx expected;
+    plcrash_error_t res = plcrash_async_macho_find_symbol_by_pc(&_image, (pl_vm_address_t) callstack[0], testFindSymbol_cb, &expected);
+    STAssertEquals(res, PLCRASH_ESUCCESS, @"Failed to locate symbol");
+    if (res != PLCRASH_ESUCCESS)
+        return;
+
+    /* Build the index */
+    STAssertEquals(plcrash_nasync_macho_index_symbols(&_image), PLCRASH_ESUCCESS, @"Failed to build symbol index");
+    STAssertNotNULL(_image.symbol_index, @"Symbol index was not published");
+    STAssertEquals(plcrash_nasync_macho_index_symbols(&_image), PLCRASH_ESUCCESS, @"Re-indexing should be a no-op");
+
+    for (uint32_t i = 1; i < _image.symbol_index->count; i++)
+        STAssertTrue(_image.symbol_index->entries[i-1].n_value < _image.symbol_index->entries[i].n_value, @"Index is not sorted");
+
+    /* Perform the indexed lookup */
+    struct testFindSymbol_cb_ctx ctx;
+    res = plcrash_async_macho_find_symbol_by_pc(&_image, (pl_vm_address_t) callstack[0], testFindSymbol_cb, &ctx);
+    STAssertEquals(res, PLCRASH_ESUCCESS, @"Failed to locate symbol");
+    if (res != PLCRASH_ESUCCESS)
+        return;
+
+    STAssertEqualCStrings(expected.name, ctx.name, @"Returned incorrect symbol name");
+    STAssertEquals(expected.addr, ctx.addr, @"Returned incorrect symbol address");
+}
+
+/**
+ * Verify that the linear symbol table scan (vectorized, where supported) agrees with the symbol index across the
+ * image's symbols, including PCs that fall between symbols.
+ */
+- (void) testFindSymbolScanMatchesIndex {
+    plcrash_async_macho_symtab_reader_t reader;
+    STAssertEquals(plcrash_async_macho_symtab_reader_init(&reader, &_image), PLCRASH_ESUCCESS, @"Failed to initialize reader");
+
+    /* Sample PCs at, and just after, a subset of the image's section symbols */
+    NSMutableData *pcs = [NSMutableData data];
+    for (uint32_t i = 0; i < reader.nsyms; i += 7) {
+        plcrash_async_macho_symtab_entry_t entry = plcrash_async_macho_symtab_reader_read(&reader, reader.symtab, i);
+        if ((entry.n_type & N_TYPE) != N_SECT || ((entry.n_type & N_STAB) != 0))
+            continue;
+
+        for (pl_vm_address_t offset = 0; offset < 2; offset++) {
+            pl_vm_address_t pc = entry.n_value + _image.vmaddr_slide + offset;
+            [pcs appendBytes: &pc length: sizeof(pc)];
+        }
+    }
+    plcrash_async_macho_symtab_reader_free(&reader);
+
+    const pl_vm_address_t *pc = [pcs bytes];
+    size_t count = [pcs length] / sizeof(*pc);
+    STAssertTrue(count > 0, @"No symbols found");
+
+    /* Unindexed lookups */
+    NSMutableData *expected = [NSMutableData dataWithLength: count * sizeof(pl_vm_address_t)];
+    pl_vm_address_t *expected_addrs = [expected mutableBytes];
+    for (size_t i = 0; i < count; i++) {
+        struct testFindSymbol_cb_ctx ctx = { 0, NULL };
+        plcrash_async_macho_find_symbol_by_pc(&_image, pc[i], testFindSymbol_cb, &ctx);
+        expected_addrs[i] = ctx.addr;
+        free(ctx.name);
+    }
+
+    /* Indexed lookups */
+    STAssertEquals(plcrash_nasync_macho_index_symbols(&_image), PLCRASH_ESUCCESS, @"Failed to build symbol index");
+    for (size_t i = 0; i < count; i++) {
+        struct testFindSymbol_cb_ctx ctx = { 0, NULL };
+        plcrash_async_macho_find_symbol_by_pc(&_image, pc[i], testFindSymbol_cb, &ctx);
+        STAssertEquals(expected_addrs[i], ctx.addr, @"Scan and index disagree for PC 0x%" PRIx64, (uint64_t) pc[i]);
+        free(ctx.name);
+    }
+}
+
 /**
  * Test lookup of symbols by name.
  */
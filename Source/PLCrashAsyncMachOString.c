@@ -43,12 +43,60 @@
  * @return An error code.
  */
 plcrash_error_t plcrash_async_macho_string_init (plcrash_async_macho_string_t *string, plcrash_async_macho_t *image, pl_vm_address_t address) {
+    return plcrash_async_macho_string_init_section(string, image, NULL, address);
+}
+
+/**
+ * Initialize a string object from a NUL-terminated C string, which may reside within an already-mapped section
+ * (such as __objc_methname). If the string is found within @a section, it is read directly from the existing
+ * mapping; otherwise, the string is mapped individually, as per plcrash_async_macho_string_init().
+ *
+ * @param string A pointer to the string object to initialize.
+ * @param image The Mach-O image in which the string resides.
+ * @param section A mapped memory object that may contain the string, or NULL. The memory object is borrowed, and must
+ * remain valid for the lifetime of @a string.
+ * @param address The address of the string.
+ * @return An error code.
+ */
+plcrash_error_t plcrash_async_macho_string_init_section (plcrash_async_macho_string_t *string, plcrash_async_macho_t *image, plcrash_async_mobject_t *section, pl_vm_address_t address) {
     string->image = image;
     string->address = address;
+    string->section = section;
     string->mobjIsInitialized = false;
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Attempt to read the string contents from the string's section mapping, initializing the memory object as a
+ * borrowed view of the section.
+ *
+ * @param string The string object.
+ * @return Returns true if the NUL-terminated string was found within the section, or false otherwise.
+ */
+static bool plcrash_async_macho_string_read_section (plcrash_async_macho_string_t *string) {
+    plcrash_async_mobject_t *section = string->section;
+    if (section == NULL)
+        return false;
+
+    const char *start = plcrash_async_mobject_remap_address(section, string->address, 0, 1);
+    if (start == NULL)
+        return false;
+
+    /* Scan for the terminating NUL within the mapped section */
+    const char *end = (const char *) (section->address + section->length);
+    const char *p = start;
+    while (p < end && *p != '\0')
+        p++;
+
+    if (p == end)
+        return false;
+
+    string->length = p - start;
+    plcrash_async_mobject_init_local(&string->mobj, string->image->task, string->address, start, string->length + 1);
+    string->mobjIsInitialized = true;
+    return true;
+}
+
 /**
  * Lazily read the string contents, initializing the memory object if necessary.
  *
@@ -58,7 +106,11 @@ plcrash_error_t plcrash_async_macho_string_init (plcrash_async_macho_string_t *s
 static plcrash_error_t plcrash_async_macho_string_read (plcrash_async_macho_string_t *string) {
     if (string->mobjIsInitialized)
         return PLCRASH_ESUCCESS;
-    
+
+    /* Prefer the existing section mapping, if any */
+    if (plcrash_async_macho_string_read_section(string))
+        return PLCRASH_ESUCCESS;
+
     pl_vm_address_t cursor = string->address;
 
     /* Map in the page containing the string, +1 up to one additional page. Short reads are permitted, as the next page
@@ -49,6 +49,9 @@ typedef struct plcrash_async_macho_string {
     
     /** The address of the start of the string. */
     pl_vm_address_t address;
+
+    /** A borrowed, already-mapped memory object that may contain the string, or NULL. */
+    plcrash_async_mobject_t *section;
     
     /** The memory object for the string contents. */
     plcrash_async_mobject_t mobj;
@@ -62,6 +65,7 @@ typedef struct plcrash_async_macho_string {
 
 
 plcrash_error_t plcrash_async_macho_string_init (plcrash_async_macho_string_t *string, plcrash_async_macho_t *image, pl_vm_address_t address);
+plcrash_error_t plcrash_async_macho_string_init_section (plcrash_async_macho_string_t *string, plcrash_async_macho_t *image, plcrash_async_mobject_t *section, pl_vm_address_t address);
 
 plcrash_error_t plcrash_async_macho_string_get_length (plcrash_async_macho_string_t *string, pl_vm_size_t *outLength);
 
@@ -98,4 +98,33 @@
     STAssertEquals(strncmp(str, ptr, len), 0, @"String contents do not match");
 }
 
+/* Test reading strings from an already-mapped section, without additional mappings */
+- (void) testSectionStringReading {
+    const char section[] = "first\0second\0unterminated";
+
+    plcrash_async_mobject_t mobj;
+    plcrash_async_mobject_init_local(&mobj, mach_task_self(), (pl_vm_address_t) section, section, sizeof(section) - 1);
+
+    uint32_t maps = plcrash_async_mobject_map_count();
+
+    plcrash_async_macho_string_t strObj;
+    STAssertEquals(plcrash_async_macho_string_init_section(&strObj, &_image, &mobj, (pl_vm_address_t) section + 6), PLCRASH_ESUCCESS, @"Error initializing string object");
+
+    pl_vm_size_t len;
+    const char *ptr;
+    STAssertEquals(plcrash_async_macho_string_get_length(&strObj, &len), PLCRASH_ESUCCESS, @"Error getting string length");
+    STAssertEquals(plcrash_async_macho_string_get_pointer(&strObj, &ptr), PLCRASH_ESUCCESS, @"Error getting string pointer");
+    STAssertEquals((unsigned long) len, strlen("second"), @"String length does not match");
+    STAssertEquals(strncmp(ptr, "second", len), 0, @"String contents do not match");
+    STAssertEquals(ptr, section + 6, @"String was not read from the section mapping");
+    STAssertEquals(plcrash_async_mobject_map_count() - maps, (uint32_t) 0, @"String was mapped individually");
+    plcrash_async_macho_string_free(&strObj);
+
+    /* A string that is not terminated within the section falls back to an individual mapping */
+    STAssertEquals(plcrash_async_macho_string_init_section(&strObj, &_image, &mobj, (pl_vm_address_t) section + 13), PLCRASH_ESUCCESS, @"Error initializing string object");
+    STAssertEquals(plcrash_async_macho_string_get_length(&strObj, &len), PLCRASH_ESUCCESS, @"Error getting string length");
+    STAssertEquals((unsigned long) len, strlen("unterminated"), @"String length does not match");
+    plcrash_async_macho_string_free(&strObj);
+}
+
 @end
@@ -0,0 +1,575 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashAsyncMemoryProvider.h"
+
+#import <stdlib.h>
+#import <sys/mman.h>
+#import <sys/stat.h>
+#import <fcntl.h>
+#import <errno.h>
+
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_memory_provider Memory Providers
+ *
+ * Implements pluggable sources of target memory.
+ *
+ * All target memory reads performed via plcrash_async_task_memcpy(), and all mappings created via
+ * plcrash_async_mobject_init(), are served by the memory provider registered for the target task identifier,
+ * or by the live Mach task if no provider has been registered. As the frame cursor, the frame readers, and the Mach-O
+ * image parser all access target memory exclusively through these two interfaces, registering a provider allows
+ * the unwinder to run unmodified over an in-memory snapshot or a memory mapped file.
+ *
+ * The task identifier used to register a provider is not required to be a valid Mach port; any value other than
+ * MACH_PORT_NULL that does not name a live task in the current process may be used.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * Registered providers. An entry is free if its task is MACH_PORT_NULL.
+ */
+static struct {
+    /** The task identifier for which the provider is registered. */
+    volatile task_t task;
+
+    /** The registered provider. */
+    const plcrash_async_memory_provider_t * volatile provider;
+} memory_providers[PLCRASH_ASYNC_MEMORY_PROVIDER_MAX];
+
+/**
+ * @internal
+ *
+ * The number of registered providers; allows lookups to be skipped entirely in the common case.
+ */
+static volatile int32_t memory_provider_count = 0;
+
+/**
+ * Initialize a memory provider.
+ *
+ * @param provider The provider to initialize.
+ * @param ops The provider's operations. The @a read operation must be non-NULL.
+ * @param context The context to be passed to all operations.
+ */
+void plcrash_async_memory_provider_init (plcrash_async_memory_provider_t *provider, const plcrash_async_memory_provider_ops_t *ops, void *context) {
+    PLCF_ASSERT(ops->read != NULL);
+
+    provider->ops = ops;
+    provider->context = context;
+}
+
+/**
+ * Copy @a len bytes from @a provider at @a address + @a offset into @a dest.
+ *
+ * @param provider The provider from which the data will be read.
+ * @param address The base target address to be read.
+ * @param offset The offset from @a address at which data will be read.
+ * @param dest The destination to which the data will be written.
+ * @param len The number of bytes to be read.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success. If the provided address + offset would overflow pl_vm_address_t,
+ * PLCRASH_ENOMEM is returned. Otherwise, returns the error returned by the provider's read operation.
+ */
+plcrash_error_t plcrash_async_memory_provider_read (const plcrash_async_memory_provider_t *provider, pl_vm_address_t address,
+                                                    pl_vm_off_t offset, void *dest, pl_vm_size_t len)
+{
+    pl_vm_address_t target;
+    if (!plcrash_async_address_apply_offset(address, offset, &target))
+        return PLCRASH_ENOMEM;
+
+    return provider->ops->read(provider->context, target, dest, len);
+}
+
+/**
+ * Return a local pointer to the memory at the target @a address, if directly accessible via @a provider.
+ *
+ * @param provider The provider to query.
+ * @param address The target address.
+ * @param available[out] On success, the number of contiguous bytes readable from the returned pointer.
+ *
+ * @return Returns the local pointer, or NULL if the memory is not directly accessible, in which case it must be read
+ * via plcrash_async_memory_provider_read().
+ */
+const void *plcrash_async_memory_provider_local_address (const plcrash_async_memory_provider_t *provider, pl_vm_address_t address,
+                                                         pl_vm_size_t *available)
+{
+    if (provider->ops->local_address == NULL)
+        return NULL;
+
+    return provider->ops->local_address(provider->context, address, available);
+}
+
+/*
+ * Live task provider
+ */
+
+/**
+ * @internal
+ *
+ * Live task read operation.
+ */
+static plcrash_error_t plcrash_async_memory_task_read_op (void *context, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    plcrash_async_memory_task_t *ctx = context;
+    return plcrash_async_task_vm_read(ctx->task, address, dest, len);
+}
+
+/** Live Mach task provider operations. Memory is read via the Mach VM API, and is never directly accessible. */
+const plcrash_async_memory_provider_ops_t plcrash_async_memory_task_ops = {
+    .read = plcrash_async_memory_task_read_op,
+    .local_address = NULL
+};
+
+/**
+ * Initialize a provider that reads from the live Mach @a task. This is the behavior used for any task identifier
+ * for which no provider has been registered; it allows wrapping providers to defer to a live task.
+ *
+ * @param provider The provider to initialize.
+ * @param context The provider context to initialize. Must remain valid for the lifetime of @a provider.
+ * @param task The target task. No reference is acquired.
+ */
+void plcrash_async_memory_provider_init_task (plcrash_async_memory_provider_t *provider, plcrash_async_memory_task_t *context, task_t task) {
+    context->task = task;
+    plcrash_async_memory_provider_init(provider, &plcrash_async_memory_task_ops, context);
+}
+
+/*
+ * Segment table provider
+ */
+
+/**
+ * @internal
+ *
+ * Find the segment in @a ctx containing @a address.
+ */
+static const plcrash_async_memory_segment_t *plcrash_async_memory_segments_find (plcrash_async_memory_segments_t *ctx, pl_vm_address_t address) {
+    for (size_t i = 0; i < ctx->count; i++) {
+        const plcrash_async_memory_segment_t *seg = &ctx->segments[i];
+        if (address >= seg->address && address - seg->address < seg->length)
+            return seg;
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Segment table read operation. Reads may span adjacent segments.
+ */
+static plcrash_error_t plcrash_async_memory_segments_read_op (void *context, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    plcrash_async_memory_segments_t *ctx = context;
+    uint8_t *output = dest;
+
+    while (len > 0) {
+        const plcrash_async_memory_segment_t *seg = plcrash_async_memory_segments_find(ctx, address);
+        if (seg == NULL)
+            return PLCRASH_ENOTFOUND;
+
+        pl_vm_size_t offset = address - seg->address;
+        pl_vm_size_t count = seg->length - offset;
+        if (count > len)
+            count = len;
+
+        plcrash_async_memcpy(output, (const uint8_t *) seg->data + offset, count);
+        output += count;
+        address += count;
+        len -= count;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Segment table local address operation.
+ */
+static const void *plcrash_async_memory_segments_local_address_op (void *context, pl_vm_address_t address, pl_vm_size_t *available) {
+    plcrash_async_memory_segments_t *ctx = context;
+
+    const plcrash_async_memory_segment_t *seg = plcrash_async_memory_segments_find(ctx, address);
+    if (seg == NULL)
+        return NULL;
+
+    pl_vm_size_t offset = address - seg->address;
+    *available = seg->length - offset;
+    return (const uint8_t *) seg->data + offset;
+}
+
+/** Segment table provider operations. All memory is directly accessible. */
+const plcrash_async_memory_provider_ops_t plcrash_async_memory_segments_ops = {
+    .read = plcrash_async_memory_segments_read_op,
+    .local_address = plcrash_async_memory_segments_local_address_op
+};
+
+/**
+ * Initialize a provider that serves target memory from a table of in-memory segments, such as a snapshot of a
+ * thread's stack and the binary images it references.
+ *
+ * @param provider The provider to initialize.
+ * @param context The provider context to initialize. Must remain valid for the lifetime of @a provider.
+ * @param segments The segment table. Segments must not overlap. The table and the segment data are borrowed, and
+ * must remain valid for the lifetime of @a provider.
+ * @param count The number of entries in @a segments.
+ */
+void plcrash_async_memory_provider_init_segments (plcrash_async_memory_provider_t *provider, plcrash_async_memory_segments_t *context,
+                                                  const plcrash_async_memory_segment_t *segments, size_t count)
+{
+    context->segments = segments;
+    context->count = count;
+    plcrash_async_memory_provider_init(provider, &plcrash_async_memory_segments_ops, context);
+}
+
+/*
+ * Mapped file provider
+ */
+
+/**
+ * Map the file at @a path read-only, providing its contents at the target @a address.
+ *
+ * @param file The file to initialize.
+ * @param path The path of the file to map.
+ * @param address The target address of the first byte of the file.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the file could not be opened, PLCRASH_EINVAL if
+ * the file is empty or would overflow the target address space, or PLCRASH_ENOMEM if the file could not be mapped.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_memory_file_init (plcrash_async_memory_file_t *file, const char *path, pl_vm_address_t address) {
+    struct stat sb;
+    void *data;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        PLCF_DEBUG("Could not open %s: %s", path, strerror(errno));
+        return PLCRASH_ENOTFOUND;
+    }
+
+    if (fstat(fd, &sb) != 0 || sb.st_size <= 0 || (uint64_t) sb.st_size > PL_VM_ADDRESS_MAX - address) {
+        close(fd);
+        return PLCRASH_EINVAL;
+    }
+
+    data = mmap(NULL, (size_t) sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        PLCF_DEBUG("Could not map %s: %s", path, strerror(errno));
+        return PLCRASH_ENOMEM;
+    }
+
+    file->segment.address = address;
+    file->segment.data = data;
+    file->segment.length = (pl_vm_size_t) sb.st_size;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Initialize a provider that serves target memory from a mapped @a file.
+ *
+ * @param provider The provider to initialize.
+ * @param context The provider context to initialize. Must remain valid for the lifetime of @a provider.
+ * @param file A file initialized via plcrash_nasync_memory_file_init(). Must remain valid for the lifetime of @a provider.
+ */
+void plcrash_async_memory_provider_init_file (plcrash_async_memory_provider_t *provider, plcrash_async_memory_segments_t *context,
+                                              plcrash_async_memory_file_t *file)
+{
+    plcrash_async_memory_provider_init_segments(provider, context, &file->segment, 1);
+}
+
+/**
+ * Unmap @a file.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_nasync_memory_file_free (plcrash_async_memory_file_t *file) {
+    munmap((void *) file->segment.data, (size_t) file->segment.length);
+}
+
+/*
+ * Provider registration
+ */
+
+/**
+ * Register @a provider as the source of all target memory for @a task.
+ *
+ * @param task The task identifier. Must not be MACH_PORT_NULL.
+ * @param provider The provider to register. Must remain valid until unregistered.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if a provider is already registered for @a task, or
+ * PLCRASH_ENOMEM if PLCRASH_ASYNC_MEMORY_PROVIDER_MAX providers are already registered.
+ *
+ * @warning This function is not async-safe, and must not be called concurrently with itself or with
+ * plcrash_nasync_memory_provider_unregister().
+ */
+plcrash_error_t plcrash_nasync_memory_provider_register (task_t task, const plcrash_async_memory_provider_t *provider) {
+    PLCF_ASSERT(task != MACH_PORT_NULL);
+
+    if (plcrash_async_memory_provider_find(task) != NULL)
+        return PLCRASH_EINVAL;
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_MEMORY_PROVIDER_MAX; i++) {
+        if (memory_providers[i].task != MACH_PORT_NULL)
+            continue;
+
+        /* Publish the provider before the entry becomes visible to lookups */
+        memory_providers[i].provider = provider;
+        OSMemoryBarrier();
+        memory_providers[i].task = task;
+        OSAtomicIncrement32Barrier(&memory_provider_count);
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    return PLCRASH_ENOMEM;
+}
+
+/**
+ * Unregister the provider registered for @a task, if any. Subsequent reads of @a task will be served by the live
+ * Mach task.
+ *
+ * @param task The task identifier.
+ *
+ * @warning This function is not async-safe, and must not be called concurrently with any reads of @a task.
+ */
+void plcrash_nasync_memory_provider_unregister (task_t task) {
+    for (size_t i = 0; i < PLCRASH_ASYNC_MEMORY_PROVIDER_MAX; i++) {
+        if (memory_providers[i].task != task)
+            continue;
+
+        memory_providers[i].task = MACH_PORT_NULL;
+        OSMemoryBarrier();
+        memory_providers[i].provider = NULL;
+        OSAtomicDecrement32Barrier(&memory_provider_count);
+        return;
+    }
+}
+
+/**
+ * Return the provider registered for @a task, or NULL if @a task is to be read as a live Mach task.
+ *
+ * @param task The task identifier.
+ */
+const plcrash_async_memory_provider_t *plcrash_async_memory_provider_find (task_t task) {
+    if (memory_provider_count == 0 || task == MACH_PORT_NULL)
+        return NULL;
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_MEMORY_PROVIDER_MAX; i++) {
+        if (memory_providers[i].task == task)
+            return memory_providers[i].provider;
+    }
+
+    return NULL;
+}
+
+/*
+ * Local readable region map
+ */
+
+/**
+ * @internal
+ *
+ * The region map consulted by plcrash_async_memory_local_read(), or NULL if all reads of the current task are to be
+ * performed via the Mach VM API.
+ */
+static const plcrash_async_memory_region_map_t * volatile local_region_map = NULL;
+
+/**
+ * Initialize an empty region map with space for @a capacity regions. Regions beyond the map's capacity are simply
+ * omitted from the map, and reads of those regions are performed via the Mach VM API.
+ *
+ * @param map The map to initialize.
+ * @param capacity The maximum number of regions to be recorded.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the map could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_memory_region_map_init (plcrash_async_memory_region_map_t *map, size_t capacity) {
+    map->regions = malloc(capacity * sizeof(map->regions[0]));
+    if (map->regions == NULL)
+        return PLCRASH_ENOMEM;
+
+    map->capacity = capacity;
+    map->count = 0;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Populate @a map with the current task's readable regions.
+ *
+ * A region is recorded only if it is readable, is not a guard region, and is not backed by an external pager;
+ * file-backed pages may still fault on access (eg, if the backing file has been truncated). The map is only valid
+ * for as long as no other thread can modify the task's address space; callers must ensure that all other threads
+ * are suspended for the lifetime of the map's use.
+ *
+ * @param map The map to populate. Any existing entries are discarded.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINTERNAL if the address space could not be enumerated.
+ */
+plcrash_error_t plcrash_async_memory_region_map_build (plcrash_async_memory_region_map_t *map) {
+    pl_vm_address_t address = 0;
+    natural_t depth = 0;
+    kern_return_t kt;
+
+    map->count = 0;
+    while (map->count < map->capacity) {
+        vm_region_submap_info_data_64_t info;
+        mach_msg_type_number_t info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
+#ifdef PL_HAVE_MACH_VM
+        pl_vm_size_t size = 0;
+        kt = mach_vm_region_recurse(mach_task_self(), &address, &size, &depth, (vm_region_recurse_info_t) &info, &info_count);
+#else
+        vm_address_t vm_address = address;
+        vm_size_t size = 0;
+        kt = vm_region_recurse_64(mach_task_self(), &vm_address, &size, &depth, (vm_region_recurse_info_t) &info, &info_count);
+        address = vm_address;
+#endif
+
+        /* KERN_INVALID_ADDRESS marks the end of the address space */
+        if (kt == KERN_INVALID_ADDRESS)
+            break;
+
+        if (kt != KERN_SUCCESS) {
+            PLCF_DEBUG("Region enumeration failed: %d", kt);
+            map->count = 0;
+            return PLCRASH_EINTERNAL;
+        }
+
+        /* Descend into submaps */
+        if (info.is_submap) {
+            depth++;
+            continue;
+        }
+
+        bool readable = (info.protection & VM_PROT_READ) && !info.external_pager;
+#ifdef VM_MEMORY_GUARD
+        if (info.user_tag == VM_MEMORY_GUARD)
+            readable = false;
+#endif
+
+        if (readable) {
+            plcrash_async_memory_region_t *last = (map->count > 0) ? &map->regions[map->count - 1] : NULL;
+            if (last != NULL && last->address + last->length == address) {
+                last->length += size;
+            } else {
+                map->regions[map->count].address = address;
+                map->regions[map->count].length = size;
+                map->count++;
+            }
+        }
+
+        /* Advance to the next region, stopping on overflow */
+        if (PL_VM_ADDRESS_MAX - size < address)
+            break;
+        address += size;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return true if @a len bytes at @a address are entirely contained within a single readable region of @a map.
+ *
+ * @param map The region map to search.
+ * @param address The address to be read.
+ * @param len The number of bytes to be read.
+ */
+bool plcrash_async_memory_region_map_contains (const plcrash_async_memory_region_map_t *map, pl_vm_address_t address, pl_vm_size_t len) {
+    size_t lo = 0;
+    size_t hi = map->count;
+
+    /* Find the last region starting at or below the address */
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (map->regions[mid].address <= address) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    if (lo == 0)
+        return false;
+
+    const plcrash_async_memory_region_t *region = &map->regions[lo - 1];
+    pl_vm_size_t offset = address - region->address;
+    return offset < region->length && len <= region->length - offset;
+}
+
+/**
+ * Free all resources associated with @a map.
+ *
+ * @warning This function is not async-safe, and @a map must not be the active local region map.
+ */
+void plcrash_nasync_memory_region_map_free (plcrash_async_memory_region_map_t *map) {
+    PLCF_ASSERT(local_region_map != map);
+    free(map->regions);
+}
+
+/**
+ * Set the region map used to serve reads of the current task made via plcrash_async_task_memcpy(), or NULL to
+ * perform all reads via the Mach VM API. The map must only be set while all other threads in the task are
+ * suspended, and must be cleared before any thread is resumed.
+ *
+ * @param map A region map populated via plcrash_async_memory_region_map_build(), or NULL.
+ */
+void plcrash_async_memory_set_local_region_map (const plcrash_async_memory_region_map_t *map) {
+    local_region_map = map;
+    OSMemoryBarrier();
+}
+
+/**
+ * If a local region map is set, and @a len bytes at @a address fall within a readable region, copy the bytes
+ * directly into @a dest.
+ *
+ * @param address The current task's address from which the data will be read.
+ * @param dest The destination to which the data will be written.
+ * @param len The number of bytes to be read.
+ *
+ * @return Returns true if the data was copied, or false if the read must be performed via the Mach VM API.
+ */
+bool plcrash_async_memory_local_read (pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    const plcrash_async_memory_region_map_t *map = local_region_map;
+    if (map == NULL || !plcrash_async_memory_region_map_contains(map, address, len))
+        return false;
+
+    plcrash_async_memcpy(dest, (const void *) (uintptr_t) address, len);
+    return true;
+}
+
+/**
+ * @} plcrash_async_memory_provider
+ */
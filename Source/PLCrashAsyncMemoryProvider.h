@@ -0,0 +1,220 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_MEMORY_PROVIDER_H
+#define PLCRASH_ASYNC_MEMORY_PROVIDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The maximum number of memory providers that may be registered at once; see plcrash_nasync_memory_provider_register().
+ */
+#define PLCRASH_ASYNC_MEMORY_PROVIDER_MAX 8
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * The default capacity of a readable region map; see plcrash_nasync_memory_region_map_init().
+ */
+#define PLCRASH_ASYNC_MEMORY_REGION_MAP_CAPACITY 4096
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Memory provider operations. All operations must be async-safe.
+ */
+typedef struct plcrash_async_memory_provider_ops {
+    /**
+     * Copy @a len bytes at the target @a address into @a dest.
+     *
+     * @param context The provider's context.
+     * @param address The target address to be read.
+     * @param dest The destination to which the data will be written.
+     * @param len The number of bytes to be read.
+     *
+     * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if any part of the range is not available, or
+     * PLCRASH_EACCESS if any part of the range is not readable.
+     */
+    plcrash_error_t (*read) (void *context, pl_vm_address_t address, void *dest, pl_vm_size_t len);
+
+    /**
+     * Return a local pointer to the memory at the target @a address, if the memory is directly accessible within the
+     * current process. May be NULL, in which case all access is performed via @a read.
+     *
+     * @param context The provider's context.
+     * @param address The target address.
+     * @param available[out] On success, the number of contiguous bytes readable from the returned pointer.
+     *
+     * @return Returns the local pointer, or NULL if @a address is not directly accessible.
+     */
+    const void *(*local_address) (void *context, pl_vm_address_t address, pl_vm_size_t *available);
+} plcrash_async_memory_provider_ops_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * A source of target memory. By default, all target memory is read from the live Mach task; a provider registered
+ * for a task identifier via plcrash_nasync_memory_provider_register() will instead serve all reads made via
+ * plcrash_async_task_memcpy() and all mappings made via plcrash_async_mobject_init() against that identifier,
+ * allowing the frame cursor and all frame readers to operate over memory snapshots and mapped files.
+ */
+typedef struct plcrash_async_memory_provider {
+    /** The provider's operations. */
+    const plcrash_async_memory_provider_ops_t *ops;
+
+    /** The context passed to all operations. */
+    void *context;
+} plcrash_async_memory_provider_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * A contiguous range of target memory held in the current process.
+ */
+typedef struct plcrash_async_memory_segment {
+    /** The target address of the segment. */
+    pl_vm_address_t address;
+
+    /** The segment's contents. */
+    const void *data;
+
+    /** The length of the segment, in bytes. */
+    pl_vm_size_t length;
+} plcrash_async_memory_segment_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * A memory mapped file, providing the contents of the file at a fixed target address.
+ */
+typedef struct plcrash_async_memory_file {
+    /** The file's segment. */
+    plcrash_async_memory_segment_t segment;
+} plcrash_async_memory_file_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * A range of the current process' address space that is known to be safely readable.
+ */
+typedef struct plcrash_async_memory_region {
+    /** The base address of the region. */
+    pl_vm_address_t address;
+
+    /** The length of the region, in bytes. */
+    pl_vm_size_t length;
+} plcrash_async_memory_region_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * A sorted map of the current process' readable regions, allowing reads of the current task that fall entirely
+ * within a readable region to be served by a plain memcpy() rather than a Mach trap. See
+ * plcrash_async_memory_region_map_build().
+ */
+typedef struct plcrash_async_memory_region_map {
+    /** The readable regions, sorted by address, with adjacent regions coalesced. */
+    plcrash_async_memory_region_t *regions;
+
+    /** The number of entries allocated in @a regions. */
+    size_t capacity;
+
+    /** The number of valid entries in @a regions. */
+    size_t count;
+} plcrash_async_memory_region_map_t;
+
+extern const plcrash_async_memory_provider_ops_t plcrash_async_memory_task_ops;
+extern const plcrash_async_memory_provider_ops_t plcrash_async_memory_segments_ops;
+
+void plcrash_async_memory_provider_init (plcrash_async_memory_provider_t *provider, const plcrash_async_memory_provider_ops_t *ops, void *context);
+
+plcrash_error_t plcrash_async_memory_provider_read (const plcrash_async_memory_provider_t *provider, pl_vm_address_t address,
+                                                    pl_vm_off_t offset, void *dest, pl_vm_size_t len);
+const void *plcrash_async_memory_provider_local_address (const plcrash_async_memory_provider_t *provider, pl_vm_address_t address,
+                                                         pl_vm_size_t *available);
+
+/**
+ * The context of a live task provider, as initialized by plcrash_async_memory_provider_init_task().
+ */
+typedef struct plcrash_async_memory_task {
+    /** The target task. */
+    task_t task;
+} plcrash_async_memory_task_t;
+
+/**
+ * The context of a segment table provider, as initialized by plcrash_async_memory_provider_init_segments().
+ */
+typedef struct plcrash_async_memory_segments {
+    /** The segment table. Segments must not overlap. */
+    const plcrash_async_memory_segment_t *segments;
+
+    /** The number of entries in @a segments. */
+    size_t count;
+} plcrash_async_memory_segments_t;
+
+void plcrash_async_memory_provider_init_task (plcrash_async_memory_provider_t *provider, plcrash_async_memory_task_t *context, task_t task);
+void plcrash_async_memory_provider_init_segments (plcrash_async_memory_provider_t *provider, plcrash_async_memory_segments_t *context,
+                                                  const plcrash_async_memory_segment_t *segments, size_t count);
+
+plcrash_error_t plcrash_nasync_memory_file_init (plcrash_async_memory_file_t *file, const char *path, pl_vm_address_t address);
+void plcrash_async_memory_provider_init_file (plcrash_async_memory_provider_t *provider, plcrash_async_memory_segments_t *context,
+                                              plcrash_async_memory_file_t *file);
+void plcrash_nasync_memory_file_free (plcrash_async_memory_file_t *file);
+
+plcrash_error_t plcrash_nasync_memory_provider_register (task_t task, const plcrash_async_memory_provider_t *provider);
+void plcrash_nasync_memory_provider_unregister (task_t task);
+const plcrash_async_memory_provider_t *plcrash_async_memory_provider_find (task_t task);
+
+plcrash_error_t plcrash_nasync_memory_region_map_init (plcrash_async_memory_region_map_t *map, size_t capacity);
+plcrash_error_t plcrash_async_memory_region_map_build (plcrash_async_memory_region_map_t *map);
+bool plcrash_async_memory_region_map_contains (const plcrash_async_memory_region_map_t *map, pl_vm_address_t address, pl_vm_size_t len);
+void plcrash_nasync_memory_region_map_free (plcrash_async_memory_region_map_t *map);
+
+void plcrash_async_memory_set_local_region_map (const plcrash_async_memory_region_map_t *map);
+bool plcrash_async_memory_local_read (pl_vm_address_t address, void *dest, pl_vm_size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_MEMORY_PROVIDER_H */
@@ -0,0 +1,202 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncMemoryProvider.h"
+#import "PLCrashAsyncMObject.h"
+
+/* An identifier that does not name a live task in the test process */
+#define TEST_TASK ((task_t) 0xFFFFFFF0)
+
+@interface PLCrashAsyncMemoryProviderTests : SenTestCase {
+@private
+    /** Snapshot segment contents */
+    uint8_t _first[64];
+    uint8_t _second[64];
+
+    /** Snapshot segment table */
+    plcrash_async_memory_segment_t _segments[2];
+    plcrash_async_memory_segments_t _context;
+    plcrash_async_memory_provider_t _provider;
+}
+@end
+
+/* Read-only operations, used to exercise the copying path of plcrash_async_mobject_init_provider() */
+static plcrash_error_t read_only_read (void *context, pl_vm_address_t address, void *dest, pl_vm_size_t len) {
+    return plcrash_async_memory_segments_ops.read(context, address, dest, len);
+}
+
+static const plcrash_async_memory_provider_ops_t read_only_ops = {
+    .read = read_only_read,
+    .local_address = NULL
+};
+
+@implementation PLCrashAsyncMemoryProviderTests
+
+- (void) setUp {
+    memset_pattern4(_first, (const uint8_t[]){ 0xC, 0xA, 0xF, 0xE }, sizeof(_first));
+    memset_pattern4(_second, (const uint8_t[]){ 0xB, 0xE, 0xE, 0xF }, sizeof(_second));
+
+    /* Two adjacent segments */
+    _segments[0].address = 0x1000;
+    _segments[0].data = _first;
+    _segments[0].length = sizeof(_first);
+    _segments[1].address = 0x1000 + sizeof(_first);
+    _segments[1].data = _second;
+    _segments[1].length = sizeof(_second);
+
+    plcrash_async_memory_provider_init_segments(&_provider, &_context, _segments, 2);
+    STAssertEquals(plcrash_nasync_memory_provider_register(TEST_TASK, &_provider), PLCRASH_ESUCCESS, @"Failed to register provider");
+}
+
+- (void) tearDown {
+    plcrash_nasync_memory_provider_unregister(TEST_TASK);
+}
+
+- (void) testRegistration {
+    STAssertEquals(plcrash_async_memory_provider_find(TEST_TASK), (const plcrash_async_memory_provider_t *) &_provider, @"Provider not found");
+    STAssertNULL(plcrash_async_memory_provider_find(mach_task_self()), @"Unexpected provider for the live task");
+    STAssertEquals(plcrash_nasync_memory_provider_register(TEST_TASK, &_provider), PLCRASH_EINVAL, @"Duplicate registration accepted");
+
+    plcrash_nasync_memory_provider_unregister(TEST_TASK);
+    STAssertNULL(plcrash_async_memory_provider_find(TEST_TASK), @"Provider was not unregistered");
+}
+
+- (void) testTaskMemcpy {
+    uint8_t buf[16];
+
+    /* Read within a single segment */
+    STAssertEquals(plcrash_async_task_memcpy(TEST_TASK, 0x1000, 4, buf, 8), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertTrue(memcmp(buf, _first + 4, 8) == 0, @"Incorrect data read");
+
+    /* Read across adjacent segments */
+    STAssertEquals(plcrash_async_task_memcpy(TEST_TASK, 0x1000, sizeof(_first) - 8, buf, 16), PLCRASH_ESUCCESS, @"Spanning read failed");
+    STAssertTrue(memcmp(buf, _first + sizeof(_first) - 8, 8) == 0, @"Incorrect data read from the first segment");
+    STAssertTrue(memcmp(buf + 8, _second, 8) == 0, @"Incorrect data read from the second segment");
+
+    /* Reads outside of the segments must fail */
+    STAssertEquals(plcrash_async_task_memcpy(TEST_TASK, 0x1000, sizeof(_first) + sizeof(_second) - 4, buf, 8), PLCRASH_ENOTFOUND, @"Out of range read succeeded");
+    STAssertEquals(plcrash_async_task_memcpy(TEST_TASK, 0x0, 0, buf, 8), PLCRASH_ENOTFOUND, @"Unmapped read succeeded");
+}
+
+- (void) testMObjectInPlace {
+    plcrash_async_mobject_t mobj;
+
+    STAssertEquals(plcrash_async_mobject_init(&mobj, TEST_TASK, 0x1010, 16, true), PLCRASH_ESUCCESS, @"Failed to initialize mobject");
+    STAssertEquals(mobj.address, (uintptr_t) (_first + 0x10), @"Memory was not referenced in place");
+    STAssertEquals(plcrash_async_mobject_task(&mobj), TEST_TASK, @"Incorrect task");
+
+    uint8_t *ptr = plcrash_async_mobject_remap_address(&mobj, 0x1010, 0, 16);
+    STAssertEquals(ptr, _first + 0x10, @"Incorrect remapped address");
+    plcrash_async_mobject_free(&mobj);
+
+    /* In-place objects are limited to a single segment */
+    STAssertEquals(plcrash_async_mobject_init(&mobj, TEST_TASK, 0x1010, sizeof(_first), true), PLCRASH_ENOMEM, @"Full mapping across segments succeeded");
+    STAssertEquals(plcrash_async_mobject_init(&mobj, TEST_TASK, 0x1010, sizeof(_first), false), PLCRASH_ESUCCESS, @"Short mapping failed");
+    STAssertEquals(plcrash_async_mobject_length(&mobj), (pl_vm_address_t) (sizeof(_first) - 0x10), @"Incorrect short mapping length");
+    plcrash_async_mobject_free(&mobj);
+}
+
+- (void) testMObjectCopied {
+    plcrash_async_memory_provider_t provider;
+    plcrash_async_mobject_t mobj;
+    plcrash_async_memory_provider_init(&provider, &read_only_ops, &_context);
+
+    /* Copies may span segments */
+    STAssertEquals(plcrash_async_mobject_init_provider(&mobj, &provider, 0x1010, sizeof(_first), true), PLCRASH_ESUCCESS, @"Failed to initialize mobject");
+    uint8_t *ptr = plcrash_async_mobject_remap_address(&mobj, 0x1010, 0, sizeof(_first));
+    STAssertNotNULL(ptr, @"Could not remap address");
+    STAssertTrue(memcmp(ptr, _first + 0x10, sizeof(_first) - 0x10) == 0, @"Incorrect data from the first segment");
+    STAssertTrue(memcmp(ptr + sizeof(_first) - 0x10, _second, 0x10) == 0, @"Incorrect data from the second segment");
+    plcrash_async_mobject_free(&mobj);
+
+    /* Short copies stop at the end of the available memory */
+    STAssertEquals(plcrash_async_mobject_init_provider(&mobj, &provider, 0x1000, 4096, true), PLCRASH_ENOMEM, @"Full copy of unavailable memory succeeded");
+    STAssertEquals(plcrash_async_mobject_init_provider(&mobj, &provider, 0x1000, 4096, false), PLCRASH_ESUCCESS, @"Short copy failed");
+    STAssertEquals(plcrash_async_mobject_length(&mobj), (pl_vm_address_t) (sizeof(_first) + sizeof(_second)), @"Incorrect short copy length");
+    plcrash_async_mobject_free(&mobj);
+}
+
+- (void) testMappedFile {
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSData *contents = [NSData dataWithBytes: _first length: sizeof(_first)];
+    STAssertTrue([contents writeToFile: path atomically: NO], @"Could not write test file");
+
+    plcrash_async_memory_file_t file;
+    plcrash_async_memory_segments_t context;
+    plcrash_async_memory_provider_t provider;
+    STAssertEquals(plcrash_nasync_memory_file_init(&file, [path fileSystemRepresentation], 0x8000), PLCRASH_ESUCCESS, @"Could not map file");
+    plcrash_async_memory_provider_init_file(&provider, &context, &file);
+
+    uint8_t buf[8];
+    STAssertEquals(plcrash_async_memory_provider_read(&provider, 0x8000, 8, buf, sizeof(buf)), PLCRASH_ESUCCESS, @"Read failed");
+    STAssertTrue(memcmp(buf, _first + 8, sizeof(buf)) == 0, @"Incorrect data read");
+    STAssertEquals(plcrash_async_memory_provider_read(&provider, 0x8000, sizeof(_first), buf, sizeof(buf)), PLCRASH_ENOTFOUND, @"Out of range read succeeded");
+
+    plcrash_nasync_memory_file_free(&file);
+    [[NSFileManager defaultManager] removeItemAtPath: path error: NULL];
+}
+
+- (void) testRegionMap {
+    plcrash_async_memory_region_map_t map;
+    STAssertEquals(plcrash_nasync_memory_region_map_init(&map, PLCRASH_ASYNC_MEMORY_REGION_MAP_CAPACITY), PLCRASH_ESUCCESS, @"Could not allocate map");
+    STAssertEquals(plcrash_async_memory_region_map_build(&map), PLCRASH_ESUCCESS, @"Could not build map");
+    STAssertTrue(map.count > 0, @"No readable regions found");
+
+    /* Regions must be sorted and coalesced */
+    for (size_t i = 1; i < map.count; i++)
+        STAssertTrue(map.regions[i].address > map.regions[i-1].address + map.regions[i-1].length, @"Regions are not sorted and coalesced");
+
+    /* Allocate a readable page followed by an unreadable page */
+    vm_address_t page = 0;
+    STAssertEquals(vm_allocate(mach_task_self(), &page, vm_page_size * 2, VM_FLAGS_ANYWHERE), KERN_SUCCESS, @"Allocation failed");
+    STAssertEquals(vm_protect(mach_task_self(), page + vm_page_size, vm_page_size, false, VM_PROT_NONE), KERN_SUCCESS, @"Protect failed");
+    memset((void *) page, 0xAB, vm_page_size);
+    STAssertEquals(plcrash_async_memory_region_map_build(&map), PLCRASH_ESUCCESS, @"Could not rebuild map");
+
+    STAssertTrue(plcrash_async_memory_region_map_contains(&map, (pl_vm_address_t) _first, sizeof(_first)), @"Object memory not readable");
+    STAssertTrue(plcrash_async_memory_region_map_contains(&map, page, vm_page_size), @"Allocated page not readable");
+    STAssertFalse(plcrash_async_memory_region_map_contains(&map, page + vm_page_size, 1), @"Unreadable page marked readable");
+    STAssertFalse(plcrash_async_memory_region_map_contains(&map, page + vm_page_size - 4, 8), @"Read across an unreadable page permitted");
+    STAssertFalse(plcrash_async_memory_region_map_contains(&map, 0x0, 1), @"NULL page marked readable");
+
+    /* Reads via the local map must match the trap-based reads, and must still fail on unreadable memory */
+    uint8_t buf[8];
+    plcrash_async_memory_set_local_region_map(&map);
+    STAssertEquals(plcrash_async_task_memcpy(mach_task_self(), page, 0, buf, sizeof(buf)), PLCRASH_ESUCCESS, @"Local read failed");
+    STAssertEquals(buf[0], (uint8_t) 0xAB, @"Incorrect data read");
+    STAssertTrue(plcrash_async_memory_local_read(page, buf, sizeof(buf)), @"Read was not served locally");
+    STAssertFalse(plcrash_async_memory_local_read(page + vm_page_size, buf, sizeof(buf)), @"Unreadable read was served locally");
+    STAssertNotEquals(plcrash_async_task_memcpy(mach_task_self(), page + vm_page_size, 0, buf, sizeof(buf)), PLCRASH_ESUCCESS, @"Unreadable read succeeded");
+    plcrash_async_memory_set_local_region_map(NULL);
+
+    vm_deallocate(mach_task_self(), page, vm_page_size * 2);
+    plcrash_nasync_memory_region_map_free(&map);
+}
+
+@end
@@ -27,7 +27,13 @@
  */
 
 #include "PLCrashAsyncObjCSection.h"
+#include "PLCrashFeatureConfig.h"
+
 #include <mach/mach_time.h>
+#include <stdlib.h>
+#include <libkern/OSAtomic.h>
+
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
 
 /**
  * @internal
@@ -42,12 +48,20 @@
 
 static char * const kObjCSegmentName = "__OBJC";
 static char * const kDataSegmentName = "__DATA";
+static char * const kTextSegmentName = "__TEXT";
 
 static char * const kObjCModuleInfoSectionName = "__module_info";
 static char * const kClassListSectionName = "__objc_classlist";
 static char * const kObjCConstSectionName = "__objc_const";
 static char * const kObjCDataSectionName = "__objc_data";
 
+/** The __TEXT sections in which class and method name strings may be found. */
+static char * const kStringSectionNames[PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT] = {
+    "__objc_methname",
+    "__objc_classname",
+    "__cstring"
+};
+
 static uint32_t CLS_NO_METHOD_ARRAY = 0x4000;
 static uint32_t END_OF_METHODS_LIST = -1;
 
@@ -177,7 +191,22 @@ struct pl_objc2_list_header {
 
 
 /**
- * Get the index into the context's cache for the given key. Must only be called
+ * The minimum number of class cache entries. Must be a power of two.
+ */
+#define CLASS_CACHE_MIN_SIZE 1024
+
+/**
+ * The maximum number of class cache entries. Must be a power of two.
+ */
+#define CLASS_CACHE_MAX_SIZE (1 << 17)
+
+/**
+ * The maximum number of slots examined when probing for a key.
+ */
+#define CLASS_CACHE_PROBE_LIMIT 8
+
+/**
+ * Get the home index into the context's cache for the given key. Must only be called
  * if the cache size has been set.
  *
  * @param context The context.
@@ -185,7 +214,18 @@ struct pl_objc2_list_header {
  * @return The index.
  */
 static size_t cache_index (plcrash_async_objc_cache_t *context, pl_vm_address_t key) {
-    return (key >> 2) % context->classCacheSize;
+    /* Class data pointers are at least 8-byte aligned; discard the low bits before masking. */
+    return (key >> 3) & (context->classCacheSize - 1);
+}
+
+/**
+ * Get a cache's total memory allocation size for the given number of entries, including both keys and values.
+ *
+ * @param size The number of entries.
+ * @return The total number of bytes allocated for the cache.
+ */
+static size_t cache_allocation_size_entries (size_t size) {
+    return size * sizeof(pl_vm_address_t) * 2;
 }
 
 /**
@@ -195,8 +235,7 @@ static size_t cache_index (plcrash_async_objc_cache_t *context, pl_vm_address_t
  * @return The total number of bytes allocated for the cache.
  */
 static size_t cache_allocation_size (plcrash_async_objc_cache_t *context) {
-    size_t size = context->classCacheSize;
-    return size * sizeof(*context->classCacheKeys) + size * sizeof(*context->classCacheValues);
+    return cache_allocation_size_entries(context->classCacheSize);
 }
 
 /**
@@ -207,15 +246,87 @@ static size_t cache_allocation_size (plcrash_async_objc_cache_t *context) {
  * @return The value stored in the cache for that key, or 0 if none was found.
  */
 static pl_vm_address_t cache_lookup (plcrash_async_objc_cache_t *context, pl_vm_address_t key) {
-    if (context->classCacheSize > 0) {
-        size_t index = cache_index(context, key);
-        if (context->classCacheKeys[index] == key) {
+    if (context->classCacheSize == 0)
+        return 0;
+
+    /* Linear probe until the key or an empty slot is found */
+    size_t mask = context->classCacheSize - 1;
+    size_t index = cache_index(context, key);
+    for (size_t i = 0; i < CLASS_CACHE_PROBE_LIMIT; i++, index = (index + 1) & mask) {
+        if (context->classCacheKeys[index] == key)
             return context->classCacheValues[index];
-        }
+
+        if (context->classCacheKeys[index] == 0)
+            break;
     }
+
     return 0;
 }
 
+/**
+ * Store a key/value pair in an already-allocated cache table.
+ */
+static void cache_insert (pl_vm_address_t *keys, pl_vm_address_t *values, size_t size, pl_vm_address_t key, pl_vm_address_t value) {
+    size_t mask = size - 1;
+    size_t home = (key >> 3) & mask;
+    size_t index = home;
+
+    for (size_t i = 0; i < CLASS_CACHE_PROBE_LIMIT; i++, index = (index + 1) & mask) {
+        if (keys[index] == 0 || keys[index] == key) {
+            keys[index] = key;
+            values[index] = value;
+            return;
+        }
+    }
+
+    /* The probe sequence is full; evict the entry in the home slot. As entries are never removed, no
+     * tombstone is required -- the evicted key will simply miss on lookup. */
+    keys[home] = key;
+    values[home] = value;
+}
+
+/**
+ * Ensure that the cache has room for at least @a entries entries at a load factor of no more than 50%, growing
+ * (and rehashing) the cache if necessary. The cache size is capped at CLASS_CACHE_MAX_SIZE.
+ *
+ * On failure, the existing cache (if any) is left in place. We don't need the cache for correct operation.
+ *
+ * @param context The context.
+ * @param entries The number of entries expected to be stored.
+ */
+static void cache_reserve (plcrash_async_objc_cache_t *context, size_t entries) {
+    size_t size = CLASS_CACHE_MIN_SIZE;
+    while (size < entries * 2 && size < CLASS_CACHE_MAX_SIZE)
+        size <<= 1;
+
+    if (size <= context->classCacheSize)
+        return;
+
+    vm_address_t addr;
+    kern_return_t err = vm_allocate(mach_task_self_, &addr, cache_allocation_size_entries(size), VM_FLAGS_ANYWHERE);
+    if (err != KERN_SUCCESS) {
+        PLCF_DEBUG("vm_allocate failed with error %x, the class cache could not be resized and ObjC parsing will be substantially slower", err);
+        return;
+    }
+
+    pl_vm_address_t *keys = (void *)addr;
+    pl_vm_address_t *values = keys + size;
+
+    /* Rehash any existing entries; vm_allocate() returns zero-filled memory. */
+    if (context->classCacheKeys != NULL) {
+        for (size_t i = 0; i < context->classCacheSize; i++) {
+            if (context->classCacheKeys[i] != 0)
+                cache_insert(keys, values, size, context->classCacheKeys[i], context->classCacheValues[i]);
+        }
+
+        vm_deallocate(mach_task_self(), (vm_address_t)context->classCacheKeys, cache_allocation_size(context));
+    }
+
+    context->classCacheKeys = keys;
+    context->classCacheValues = values;
+    context->classCacheSize = size;
+}
+
 /**
  * Store a key/value pair in the cache. The cache is not guaranteed storage so storing may
  * silently fail, and the association can be evicted at any time. It's a CACHE.
@@ -225,33 +336,14 @@ static pl_vm_address_t cache_lookup (plcrash_async_objc_cache_t *context, pl_vm_
  * @param value The value to store.
  */
 static void cache_set (plcrash_async_objc_cache_t *context, pl_vm_address_t key, pl_vm_address_t value) {
-    /* If nothing has used the cache yet, allocate the memory. */
+    /* If nothing has sized the cache yet, allocate the memory. */
     if (context->classCacheKeys == NULL) {
-        size_t size = 1024;
-        context->classCacheSize = size;
-        
-        size_t allocationSize = cache_allocation_size(context);
-        
-        vm_address_t addr;
-        kern_return_t err = vm_allocate(mach_task_self_, &addr, allocationSize, VM_FLAGS_ANYWHERE);
-        /* If it fails, just bail out. We don't need the cache for correct operation. */
-        if (err != KERN_SUCCESS) {
-            PLCF_DEBUG("vm_allocate failed with error %x, the class cache could not be initialized and ObjC parsing will be substantially slower", err);
-            context->classCacheSize = 0;
+        cache_reserve(context, 0);
+        if (context->classCacheKeys == NULL)
             return;
-        }
-        
-        context->classCacheKeys = (void *)addr;
-        context->classCacheValues = (void *)(context->classCacheKeys + size);
     }
     
-    /* Treat the cache as a simple hash table with no chaining whatsoever. If the bucket is already
-     * occupied, then don't do anything. The existing entry wins. */
-    size_t index = cache_index(context, key);
-    if (context->classCacheKeys[index] == 0) {
-        context->classCacheKeys[index] = key;
-        context->classCacheValues[index] = value;
-    }
+    cache_insert(context->classCacheKeys, context->classCacheValues, context->classCacheSize, key, value);
 }
 
 /**
@@ -272,6 +364,41 @@ static void free_mapped_sections (plcrash_async_objc_cache_t *context) {
         plcrash_async_mobject_free(&context->objcDataMobj);
         context->objcDataMobjInitialized = false;
     }
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT; i++) {
+        if (context->stringMobjInitialized[i]) {
+            plcrash_async_mobject_free(&context->stringMobj[i]);
+            context->stringMobjInitialized[i] = false;
+        }
+    }
+}
+
+/**
+ * Initialize @a string with the name at @a address, resolving it against the string sections mapped for the
+ * context's current image, if any contains @a address.
+ *
+ * @param context The context.
+ * @param image The MachO image in which the string resides.
+ * @param string The string to initialize.
+ * @param address The string's address.
+ * @return An error code.
+ */
+static plcrash_error_t pl_async_objc_string_init (plcrash_async_objc_cache_t *context, plcrash_async_macho_t *image, plcrash_async_macho_string_t *string, pl_vm_address_t address) {
+    plcrash_async_mobject_t *section = NULL;
+
+    if (context->lastImage == image) {
+        for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT; i++) {
+            if (!context->stringMobjInitialized[i])
+                continue;
+
+            plcrash_async_mobject_t *mobj = &context->stringMobj[i];
+            if (address >= mobj->task_address && address - mobj->task_address < mobj->length) {
+                section = &context->stringMobj[i];
+                break;
+            }
+        }
+    }
+
+    return plcrash_async_macho_string_init_section(string, image, section, address);
 }
 
 /**
@@ -320,7 +447,14 @@ static plcrash_error_t map_sections (plcrash_async_macho_t *image, plcrash_async
         goto cleanup;
     }
     context->objcDataMobjInitialized = true;
-    
+
+    /* Map in the string sections. These are optional; any names not found within a mapped section are mapped
+     * individually. */
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT; i++) {
+        if (plcrash_async_macho_map_section(image, kTextSegmentName, kStringSectionNames[i], &context->stringMobj[i]) == PLCRASH_ESUCCESS)
+            context->stringMobjInitialized[i] = true;
+    }
+
     /* Only after all mappings succeed do we set the image. If any failed, the image won't be set,
      * and any mappings that DO succeed will be cleaned up on the next call (or when freeing the
      * context. */
@@ -330,19 +464,26 @@ cleanup:
     return err;
 }
 
-static plcrash_error_t pl_async_parse_obj1_class(plcrash_async_macho_t *image, struct pl_objc1_class *class, bool isMetaClass, plcrash_async_objc_found_method_cb callback, void *ctx) {
-    plcrash_error_t err;
+/**
+ * @internal
+ *
+ * A callback invoked for each method visited by plcrash_async_objc_parse(). Class and method names are supplied as
+ * unresolved string addresses, allowing the caller to defer reading any names until the method of interest has
+ * been found.
+ *
+ * @param isClassMethod If true, the method is a class (rather than an instance) method.
+ * @param className The address of the class's NUL-terminated name.
+ * @param methodName The address of the method's NUL-terminated name.
+ * @param imp The method's IMP (function pointer to the method's implementation).
+ * @param ctx The context pointer specified by the original caller.
+ */
+typedef void (*pl_async_objc_parse_method_cb)(bool isClassMethod, pl_vm_address_t className, pl_vm_address_t methodName, pl_vm_address_t imp, void *ctx);
+
+static plcrash_error_t pl_async_parse_obj1_class(plcrash_async_macho_t *image, plcrash_async_work_budget_t *budget, struct pl_objc1_class *class, bool isMetaClass, pl_async_objc_parse_method_cb callback, void *ctx) {
+    plcrash_error_t err = PLCRASH_ESUCCESS;
     
     /* Get the class's name. */
     pl_vm_address_t namePtr = image->byteorder->swap32(class->name);
-    bool classNameInitialized = false;
-    plcrash_async_macho_string_t className;
-    err = plcrash_async_macho_string_init(&className, image, namePtr);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long)namePtr, err);
-        goto cleanup;
-    }
-    classNameInitialized = true;
     
     /* Grab the method list pointer. This is either a pointer to
      * a single method_list structure, OR a pointer to an array
@@ -396,8 +537,17 @@ static plcrash_error_t pl_async_parse_obj1_class(plcrash_async_macho_t *image, s
             goto cleanup;
         }
         
-        /* Find out how many methods are in the list, and iterate. */
+        /* Find out how many methods are in the list, and iterate. The list itself is charged to the budget, as
+         * otherwise an unterminated method list array would be walked until an unreadable address is reached. */
         uint32_t count = image->byteorder->swap32(methodList.count);
+        if (!plcrash_async_work_budget_consume(budget, PLCRASH_ASYNC_WORK_OBJC_ENTRIES, 1) ||
+            !plcrash_async_work_budget_consume(budget, PLCRASH_ASYNC_WORK_OBJC_ENTRIES, count))
+        {
+            PLCF_DEBUG("Objective-C work budget exhausted while parsing method list at 0x%llx", (long long)thisListPtr);
+            err = PLCRASH_EBUDGET;
+            goto cleanup;
+        }
+
         for (uint32_t i = 0; i < count; i++) {
             /* Method structures are laid out directly following the
              * method_list structure. */
@@ -409,23 +559,12 @@ static plcrash_error_t pl_async_parse_obj1_class(plcrash_async_macho_t *image, s
                 goto cleanup;
             }
             
-            /* Load the method name from the .name field pointer. */
+            /* Fetch the method name pointer and IMP. */
             pl_vm_address_t methodNamePtr = image->byteorder->swap32(method.name);
-            plcrash_async_macho_string_t methodName;
-            err = plcrash_async_macho_string_init(&methodName, image, methodNamePtr);
-            if (err != PLCRASH_ESUCCESS) {
-                PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long)methodNamePtr, err);
-                goto cleanup;
-            }
-            
-            /* Grab the method's IMP as well. */
             pl_vm_address_t imp = image->byteorder->swap32(method.imp);
             
             /* Callback! */
-            callback(isMetaClass, &className, &methodName, imp, ctx);
-            
-            /* Clean up the method name object. */
-            plcrash_async_macho_string_free(&methodName);
+            callback(isMetaClass, namePtr, methodNamePtr, imp, ctx);
         }
         
         /* Bail out of the loop after a single iteration if
@@ -436,9 +575,6 @@ static plcrash_error_t pl_async_parse_obj1_class(plcrash_async_macho_t *image, s
     }
     
 cleanup:
-    if (classNameInitialized)
-        plcrash_async_macho_string_free(&className);
-    
     return err;
 }
 
@@ -447,12 +583,14 @@ cleanup:
  * ObjC1 metadata.
  *
  * @param image The Mach-O image to read from.
+ * @param budget The work budget to be consumed, or NULL.
  * @param callback The callback to invoke for each method found.
  * @param ctx The context pointer to pass to the callback.
  * @return PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the image doesn't
- * contain ObjC1 metadata, or another error code if a different error occurred.
+ * contain ObjC1 metadata, PLCRASH_EBUDGET if @a budget was exhausted, or another error code if a different error
+ * occurred.
  */
-static plcrash_error_t pl_async_objc_parse_from_module_info (plcrash_async_macho_t *image, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static plcrash_error_t pl_async_objc_parse_from_module_info (plcrash_async_macho_t *image, plcrash_async_work_budget_t *budget, pl_async_objc_parse_method_cb callback, void *ctx) {
     plcrash_error_t err = PLCRASH_EUNKNOWN;
     
     /* Map the __module_info section. */
@@ -513,7 +651,7 @@ static plcrash_error_t pl_async_objc_parse_from_module_info (plcrash_async_macho
                 goto cleanup;
             }
             
-            err = pl_async_parse_obj1_class(image, &class, false, callback, ctx);
+            err = pl_async_parse_obj1_class(image, budget, &class, false, callback, ctx);
             if (err != PLCRASH_ESUCCESS) {
                 PLCF_DEBUG("pl_async_parse_obj1_class error %d while parsing class", err);
                 goto cleanup;
@@ -528,7 +666,7 @@ static plcrash_error_t pl_async_objc_parse_from_module_info (plcrash_async_macho
                 goto cleanup;
             }
             
-            err = pl_async_parse_obj1_class(image, &metaclass, true, callback, ctx);
+            err = pl_async_parse_obj1_class(image, budget, &metaclass, true, callback, ctx);
             if (err != PLCRASH_ESUCCESS) {
                 PLCF_DEBUG("pl_async_parse_obj1_class error %d while parsing metaclass", err);
                 goto cleanup;
@@ -555,18 +693,21 @@ cleanup:
  * filled out if the image is 64 bits.
  * @param callback The callback to invoke for each method found.
  * @param ctx A context pointer to pass to the callback.
- * @return An error code.
+ * @param m64 The image's pointer width; this must be a constant, allowing the method list loop to be specialized
+ * for each pointer width. See pl_async_objc_parse_objc2_class_32() and pl_async_objc_parse_objc2_class_64().
+ * @return An error code; PLCRASH_EBUDGET will be returned if the context's work budget has been exhausted.
  */
-static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, struct pl_objc2_class_32 *class_32, struct pl_objc2_class_64 *class_64, bool isMetaClass, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static PLCF_ALWAYS_INLINE plcrash_error_t pl_async_objc_parse_objc2_class_impl (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, struct pl_objc2_class_32 *class_32, struct pl_objc2_class_64 *class_64, bool isMetaClass, pl_async_objc_parse_method_cb callback, void *ctx, const bool m64) {
     plcrash_error_t err;
-    
-    /* Set up the class name string and a flag to determine whether it needs cleanup. */
-    plcrash_async_macho_string_t className;
-    bool classNameInitialized = false;
+
+    if (!plcrash_async_work_budget_consume(objcContext->workBudget, PLCRASH_ASYNC_WORK_OBJC_ENTRIES, 1)) {
+        PLCF_DEBUG("Objective-C work budget exhausted while parsing classes");
+        return PLCRASH_EBUDGET;
+    }
     
     /* Grab the class's data_rw pointer. This needs masking because it also
      * can contain flags. */
-    pl_vm_address_t dataPtr = (image->m64
+    pl_vm_address_t dataPtr = (m64
                                ? image->byteorder->swap64(class_64->data_rw)
                                : image->byteorder->swap32(class_32->data_rw));
     dataPtr &= ~(pl_vm_address_t)3;
@@ -579,7 +720,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
         struct pl_objc2_class_data_ro_32 cls32;
         struct pl_objc2_class_data_ro_64 cls64;
     } cls_copied_ro;
-    pl_vm_size_t class_ro_length = (image->m64 ? sizeof(*classDataRO_64) : sizeof(*classDataRO_32));
+    pl_vm_size_t class_ro_length = (m64 ? sizeof(*classDataRO_64) : sizeof(*classDataRO_32));
 
 
     /* Grab the data RO pointer from the cache. If unavailable, we'll fetch the data and populate the class. */
@@ -589,7 +730,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
         struct pl_objc2_class_data_rw_64 classDataRW_64;
 
         /* Read an architecture-appropriate class_rw structure for the class. */
-        if (image->m64)
+        if (m64)
             err = plcrash_async_read_addr(image->task, dataPtr, &classDataRW_64, sizeof(classDataRW_64));
         else
             err = plcrash_async_read_addr(image->task, dataPtr, &classDataRW_32, sizeof(classDataRW_32));
@@ -601,7 +742,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
         
         /* Check the flags. If it's not yet realized, then we need to skip the class. */
         uint32_t flags;
-        if (image->m64)
+        if (m64)
             flags = classDataRW_64.flags;
         else
             flags = classDataRW_32.flags;
@@ -613,7 +754,7 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
 
         /* Grab the data_ro pointer. The RO data (read-only) contains the class name
          * and method list. */
-        cached_data_ro_addr = (image->m64
+        cached_data_ro_addr = (m64
                      ? image->byteorder->swap64(classDataRW_64.data_ro)
                      : image->byteorder->swap32(classDataRW_32.data_ro));
         
@@ -655,19 +796,13 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
         }
     }
     
-    /* Fetch the pointer to the class name, and make the string. */
-    pl_vm_address_t classNamePtr = (image->m64
+    /* Fetch the pointer to the class name. */
+    pl_vm_address_t classNamePtr = (m64
                                     ? image->byteorder->swap64(classDataRO_64->name)
                                     : image->byteorder->swap32(classDataRO_32->name));
-    err = plcrash_async_macho_string_init(&className, image, classNamePtr);
-    if (err != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long)classNamePtr, err);
-        goto cleanup;
-    }
-    classNameInitialized = true;
     
     /* Fetch the pointer to the method list. */
-    pl_vm_address_t methodsPtr = (image->m64
+    pl_vm_address_t methodsPtr = (m64
                                   ? image->byteorder->swap64(classDataRO_64->baseMethods)
                                   : image->byteorder->swap32(classDataRO_32->baseMethods));
     if (methodsPtr == 0)
@@ -694,6 +829,12 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
         PLCF_DEBUG("plcrash_async_mobject_remap_address at 0x%llx length %llu returned NULL", (long long)methodListStart, (unsigned long long)methodListLength);
         goto cleanup;
     }
+
+    if (!plcrash_async_work_budget_consume(objcContext->workBudget, PLCRASH_ASYNC_WORK_OBJC_ENTRIES, count)) {
+        PLCF_DEBUG("Objective-C work budget exhausted while parsing method list at 0x%llx", (long long)methodsPtr);
+        err = PLCRASH_EBUDGET;
+        goto cleanup;
+    }
     
     /* Extract methods from the list. */
     for (uint32_t i = 0; i < count; i++) {
@@ -703,40 +844,36 @@ static plcrash_error_t pl_async_objc_parse_objc2_class(plcrash_async_macho_t *im
         const struct pl_objc2_method_64 *method_64 = (void *)cursor;
         
         /* Extract the method name pointer. */
-        pl_vm_address_t methodNamePtr = (image->m64
+        pl_vm_address_t methodNamePtr = (m64
                                          ? image->byteorder->swap64(method_64->name)
                                          : image->byteorder->swap32(method_32->name));
         
-        /* Read the method name. */
-        plcrash_async_macho_string_t methodName;
-        err = plcrash_async_macho_string_init(&methodName, image, methodNamePtr);
-        if (err != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("plcrash_async_macho_string_init at 0x%llx error %d", (long long)methodNamePtr, err);
-            goto cleanup;
-        }
-        
         /* Extract the method IMP. */
-        pl_vm_address_t imp = (image->m64
+        pl_vm_address_t imp = (m64
                                ? image->byteorder->swap64(method_64->imp)
                                : image->byteorder->swap32(method_32->imp));
         
         /* Call the callback. */
-        callback(isMetaClass, &className, &methodName, imp, ctx);
-        
-        /* Clean up the method name. */
-        plcrash_async_macho_string_free(&methodName);
+        callback(isMetaClass, classNamePtr, methodNamePtr, imp, ctx);
         
         /* Increment the cursor by the entry size for the next iteration of the loop. */
         cursor += entsize;
     }
     
 cleanup:
-    if (classNameInitialized)
-        plcrash_async_macho_string_free(&className);
-    
     return err;
 }
 
+/* 32-bit specialization of pl_async_objc_parse_objc2_class_impl() */
+static plcrash_error_t pl_async_objc_parse_objc2_class_32 (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, struct pl_objc2_class_32 *class_32, bool isMetaClass, pl_async_objc_parse_method_cb callback, void *ctx) {
+    return pl_async_objc_parse_objc2_class_impl(image, objcContext, class_32, NULL, isMetaClass, callback, ctx, false);
+}
+
+/* 64-bit specialization of pl_async_objc_parse_objc2_class_impl() */
+static plcrash_error_t pl_async_objc_parse_objc2_class_64 (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, struct pl_objc2_class_64 *class_64, bool isMetaClass, pl_async_objc_parse_method_cb callback, void *ctx) {
+    return pl_async_objc_parse_objc2_class_impl(image, objcContext, NULL, class_64, isMetaClass, callback, ctx, true);
+}
+
 /**
  * Parse ObjC2 class data from a __objc_classlist section.
  *
@@ -744,10 +881,12 @@ cleanup:
  * @param objcContext An ObjC context object.
  * @param callback The callback to invoke for each method found.
  * @param ctx A context pointer to pass to the callback.
+ * @param m64 The image's pointer width; this must be a constant, allowing the class list loop to be specialized for
+ * each pointer width.
  * @return PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no ObjC2 data
  * exists in the image, and another error code if a different error occurred.
  */
-static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static PLCF_ALWAYS_INLINE plcrash_error_t pl_async_objc_parse_from_data_section_impl (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, pl_async_objc_parse_method_cb callback, void *ctx, const bool m64) {
     plcrash_error_t err;
     
     /* Map memory objects. */
@@ -773,19 +912,22 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
     
     /* Figure out how many classes are in the class list based on its length and
      * the size of a pointer in the image. */
-    unsigned classCount = objcContext->classMobj.length / (image->m64 ? sizeof(*classPtrs_64) : sizeof(*classPtrs_32));
+    unsigned classCount = objcContext->classMobj.length / (m64 ? sizeof(*classPtrs_64) : sizeof(*classPtrs_32));
+
+    /* Size the class cache to hold both the classes and metaclasses of this image */
+    cache_reserve(objcContext, classCount * 2);
     
     /* Iterate over all classes. */
     for(unsigned i = 0; i < classCount; i++) {
         /* Read a class pointer at the current index from the appropriate pointer. */
-        pl_vm_address_t ptr = (image->m64
+        pl_vm_address_t ptr = (m64
                                ? image->byteorder->swap64(classPtrs_64[i])
                                : image->byteorder->swap32(classPtrs_32[i]));
         
         /* Read an architecture-appropriate class structure. */
         struct pl_objc2_class_32 *class_32;
         struct pl_objc2_class_64 *class_64;
-        void *classPtr = plcrash_async_mobject_remap_address(&objcContext->objcDataMobj, ptr, 0, image->m64 ? sizeof(*class_64) : sizeof(*class_32));
+        void *classPtr = plcrash_async_mobject_remap_address(&objcContext->objcDataMobj, ptr, 0, m64 ? sizeof(*class_64) : sizeof(*class_32));
         if (classPtr == NULL) {
             PLCF_DEBUG("plcrash_async_mobject_remap_address in objcDataMobj for pointer %llx returned NULL", (long long)ptr);
             goto cleanup;
@@ -795,19 +937,21 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
         class_64 = classPtr;
         
         /* Parse the class. */
-        err = pl_async_objc_parse_objc2_class(image, objcContext, class_32, class_64, false, callback, ctx);
+        err = (m64
+               ? pl_async_objc_parse_objc2_class_64(image, objcContext, class_64, false, callback, ctx)
+               : pl_async_objc_parse_objc2_class_32(image, objcContext, class_32, false, callback, ctx));
         if (err != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("pl_async_objc_parse_objc2_class error %d while parsing class", err);
             goto cleanup;
         }
         
         /* Read an architecture-appropriate class structure for the metaclass. */
-        pl_vm_address_t isa = (image->m64
+        pl_vm_address_t isa = (m64
                                ? image->byteorder->swap64(class_64->isa)
                                : image->byteorder->swap32(class_32->isa));
         struct pl_objc2_class_32 *metaclass_32;
         struct pl_objc2_class_64 *metaclass_64;
-        void *metaclassPtr = plcrash_async_mobject_remap_address(&objcContext->objcDataMobj, isa, 0, image->m64 ? sizeof(*class_64) : sizeof(*class_32));
+        void *metaclassPtr = plcrash_async_mobject_remap_address(&objcContext->objcDataMobj, isa, 0, m64 ? sizeof(*class_64) : sizeof(*class_32));
         if (metaclassPtr == NULL) {
             PLCF_DEBUG("plcrash_async_mobject_remap_address in objcDataMobj for pointer %llx returned NULL", (long long)isa);
             goto cleanup;
@@ -817,7 +961,9 @@ static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_mach
         metaclass_64 = metaclassPtr;
         
         /* Parse the metaclass. */
-        err = pl_async_objc_parse_objc2_class(image, objcContext, metaclass_32, metaclass_64, true, callback, ctx);
+        err = (m64
+               ? pl_async_objc_parse_objc2_class_64(image, objcContext, metaclass_64, true, callback, ctx)
+               : pl_async_objc_parse_objc2_class_32(image, objcContext, metaclass_32, true, callback, ctx));
         if (err != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("pl_async_objc_parse_objc2_class error %d while parsing metaclass", err);
             goto cleanup;
@@ -828,6 +974,24 @@ cleanup:
     return err;
 }
 
+/**
+ * Parse ObjC2 class data from a __objc_classlist section, dispatching to the class list parser specialized for
+ * @a image's pointer width.
+ *
+ * @param image The Mach-O image to parse.
+ * @param objcContext An ObjC context object.
+ * @param callback The callback to invoke for each method found.
+ * @param ctx A context pointer to pass to the callback.
+ * @return PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if no ObjC2 data
+ * exists in the image, and another error code if a different error occurred.
+ */
+static plcrash_error_t pl_async_objc_parse_from_data_section (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, pl_async_objc_parse_method_cb callback, void *ctx) {
+    if (image->m64)
+        return pl_async_objc_parse_from_data_section_impl(image, objcContext, callback, ctx, true);
+    else
+        return pl_async_objc_parse_from_data_section_impl(image, objcContext, callback, ctx, false);
+}
+
 /**
  * Initialize an ObjC cache object.
  *
@@ -840,9 +1004,23 @@ plcrash_error_t plcrash_async_objc_cache_init (plcrash_async_objc_cache_t *cache
     cache->objcConstMobjInitialized = false;
     cache->classMobjInitialized = false;
     cache->objcDataMobjInitialized = false;
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT; i++)
+        cache->stringMobjInitialized[i] = false;
     cache->classCacheSize = 0;
     cache->classCacheKeys = NULL;
     cache->classCacheValues = NULL;
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT; i++) {
+        cache->impIndexes[i].image = NULL;
+        cache->impIndexes[i].entries = NULL;
+        cache->impIndexes[i].count = 0;
+        cache->impIndexes[i].allocationSize = 0;
+        cache->impIndexes[i].lastUsed = 0;
+    }
+    cache->impIndexGeneration = 0;
+    cache->workBudget = NULL;
+    cache->sharedCache = NULL;
+
     return PLCRASH_ESUCCESS;
 }
 
@@ -856,6 +1034,11 @@ void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *cache) {
 
     if (cache->classCacheKeys != NULL)
         vm_deallocate(mach_task_self(), (vm_address_t)cache->classCacheKeys, cache_allocation_size(cache));
+
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT; i++) {
+        if (cache->impIndexes[i].entries != NULL)
+            vm_deallocate(mach_task_self(), (vm_address_t)cache->impIndexes[i].entries, cache->impIndexes[i].allocationSize);
+    }
 }
 
 /**
@@ -871,7 +1054,7 @@ void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *cache) {
  * @param ctx The context pointer to pass to the callback.
  * @return An error code.
  */
-static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, plcrash_async_objc_found_method_cb callback, void *ctx) {
+static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, pl_async_objc_parse_method_cb callback, void *ctx) {
     plcrash_error_t err;
     
     if (cache == NULL)
@@ -879,7 +1062,7 @@ static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, p
    
     if (!cache->gotObjC2Info) {
         /* Try ObjC1 data. */
-        err = pl_async_objc_parse_from_module_info(image, callback, ctx);
+        err = pl_async_objc_parse_from_module_info(image, cache->workBudget, callback, ctx);
     } else {
         /* If it couldn't be found before, don't even bother to try again. */
         err = PLCRASH_ENOTFOUND;
@@ -899,49 +1082,358 @@ static plcrash_error_t plcrash_async_objc_parse (plcrash_async_macho_t *image, p
 
 struct pl_async_objc_find_method_search_context {
     pl_vm_address_t searchIMP;
+    bool found;
     pl_vm_address_t bestIMP;
-};
-
-struct pl_async_objc_find_method_call_context {
-    pl_vm_address_t searchIMP;
-    plcrash_async_objc_found_method_cb outerCallback;
-    void *outerCallbackCtx;
+    pl_vm_address_t bestClassName;
+    pl_vm_address_t bestMethodName;
+    bool bestIsClassMethod;
 };
 
 /**
- * Callback used to search for the method IMP that best matches a search target.
+ * Callback used to search for the method that best matches a search target.
  * The context pointer is a pointer to pl_async_objc_find_method_search_context.
- * The searchIMP field should be set to the IMP to search for. The bestIMP field
- * should be initialized to 0, and will be updated with the best-matching IMP
- * found.
+ * The searchIMP field should be set to the IMP to search for, and the found field
+ * should be initialized to false. The best-matching IMP and the name addresses of
+ * the first method found with that IMP will be recorded; no names are read.
  */
-static void pl_async_objc_find_method_search_callback (bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+static void pl_async_objc_find_method_search_callback (bool isClassMethod, pl_vm_address_t className, pl_vm_address_t methodName, pl_vm_address_t imp, void *ctx) {
     struct pl_async_objc_find_method_search_context *ctxStruct = ctx;
     
-    if (imp >= ctxStruct->bestIMP && imp <= ctxStruct->searchIMP) {
-        ctxStruct->bestIMP = imp;
+    if (imp > ctxStruct->searchIMP)
+        return;
+
+    if (ctxStruct->found && imp <= ctxStruct->bestIMP)
+        return;
+
+    ctxStruct->found = true;
+    ctxStruct->bestIMP = imp;
+    ctxStruct->bestClassName = className;
+    ctxStruct->bestMethodName = methodName;
+    ctxStruct->bestIsClassMethod = isClassMethod;
+}
+
+/**
+ * Resolve the class and method names at @a className and @a methodName, and invoke @a callback with the result.
+ * Names are read from the ObjC cache's mapped string sections where possible.
+ */
+static plcrash_error_t pl_async_objc_found_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, bool isClassMethod,
+                                                   pl_vm_address_t className, pl_vm_address_t methodName, pl_vm_address_t imp,
+                                                   plcrash_async_objc_found_method_cb callback, void *ctx)
+{
+    plcrash_async_macho_string_t classNameString;
+    plcrash_async_macho_string_t methodNameString;
+    plcrash_error_t err;
+
+    if ((err = pl_async_objc_string_init(objcContext, image, &classNameString, className)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = pl_async_objc_string_init(objcContext, image, &methodNameString, methodName)) != PLCRASH_ESUCCESS) {
+        plcrash_async_macho_string_free(&classNameString);
+        return err;
     }
+
+    callback(isClassMethod, &classNameString, &methodNameString, imp, ctx);
+
+    plcrash_async_macho_string_free(&classNameString);
+    plcrash_async_macho_string_free(&methodNameString);
+
+    return PLCRASH_ESUCCESS;
 }
 
+struct pl_async_objc_imp_index_fill_context {
+    plcrash_async_objc_imp_index_t *index;
+    size_t capacity;
+};
+
 /**
- * Callback used to find the method that precisely matches a search target.
- * The context pointer is a pointer to pl_async_objc_find_method_call_context.
- * The searchIMP field should be set to the IMP to search for. The outerCallback
- * will be invoked, passing outerCalblackCtx and the method data for a precise
- * match, if any is found.
+ * Callback used to count the methods in an image.
+ * The context pointer is a pointer to a size_t counter.
  */
-static void pl_async_objc_find_method_call_callback (bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
-    struct pl_async_objc_find_method_call_context *ctxStruct = ctx;
-    
-    if (imp == ctxStruct->searchIMP && ctxStruct->outerCallback != NULL) {
-        ctxStruct->outerCallback(isClassMethod, className, methodName, imp, ctxStruct->outerCallbackCtx);
-        ctxStruct->outerCallback = NULL;
+static void pl_async_objc_imp_index_count_callback (bool isClassMethod, pl_vm_address_t className, pl_vm_address_t methodName, pl_vm_address_t imp, void *ctx) {
+    size_t *count = ctx;
+    (*count)++;
+}
+
+/**
+ * Callback used to populate an IMP index.
+ * The context pointer is a pointer to pl_async_objc_imp_index_fill_context.
+ */
+static void pl_async_objc_imp_index_fill_callback (bool isClassMethod, pl_vm_address_t className, pl_vm_address_t methodName, pl_vm_address_t imp, void *ctx) {
+    struct pl_async_objc_imp_index_fill_context *ctxStruct = ctx;
+    plcrash_async_objc_imp_index_t *index = ctxStruct->index;
+
+    if (index->count >= ctxStruct->capacity)
+        return;
+
+    plcrash_async_objc_imp_entry_t *entry = &index->entries[index->count];
+    entry->imp = imp;
+    entry->className = className;
+    entry->methodName = methodName;
+    entry->order = (uint32_t) index->count;
+    entry->isClassMethod = isClassMethod;
+    index->count++;
+}
+
+/**
+ * Return true if @a lhs sorts before @a rhs: by IMP, and then by parse order.
+ */
+static bool pl_async_objc_imp_entry_less (const plcrash_async_objc_imp_entry_t *lhs, const plcrash_async_objc_imp_entry_t *rhs) {
+    if (lhs->imp != rhs->imp)
+        return lhs->imp < rhs->imp;
+    return lhs->order < rhs->order;
+}
+
+/**
+ * Restore the heap property for the subtree rooted at @a root.
+ */
+static void pl_async_objc_imp_sift_down (plcrash_async_objc_imp_entry_t *entries, size_t root, size_t count) {
+    while (root * 2 + 1 < count) {
+        size_t child = root * 2 + 1;
+        if (child + 1 < count && pl_async_objc_imp_entry_less(&entries[child], &entries[child + 1]))
+            child++;
+
+        if (!pl_async_objc_imp_entry_less(&entries[root], &entries[child]))
+            return;
+
+        plcrash_async_objc_imp_entry_t tmp = entries[root];
+        entries[root] = entries[child];
+        entries[child] = tmp;
+        root = child;
+    }
+}
+
+/**
+ * Sort @a entries in place. A heap sort is used, as it requires neither allocation nor recursion.
+ */
+static void pl_async_objc_imp_sort (plcrash_async_objc_imp_entry_t *entries, size_t count) {
+    if (count < 2)
+        return;
+
+    for (size_t i = count / 2; i > 0; i--)
+        pl_async_objc_imp_sift_down(entries, i - 1, count);
+
+    for (size_t end = count - 1; end > 0; end--) {
+        plcrash_async_objc_imp_entry_t tmp = entries[0];
+        entries[0] = entries[end];
+        entries[end] = tmp;
+        pl_async_objc_imp_sift_down(entries, 0, end);
     }
 }
 
+/**
+ * Return the IMP index for @a image, building it if necessary.
+ *
+ * @param image The image to index.
+ * @param objcContext The ObjC context object that owns the index.
+ * @param outIndex On success, will be set to the image's index.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the image contains no ObjC data, or another error
+ * if the index could not be built. On failure, callers may fall back on a full parse of the image.
+ */
+static plcrash_error_t pl_async_objc_imp_index_get (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, plcrash_async_objc_imp_index_t **outIndex) {
+    plcrash_async_objc_imp_index_t *slot = &objcContext->impIndexes[0];
+    uint32_t generation = ++objcContext->impIndexGeneration;
+    plcrash_error_t err;
+
+    /* Find an existing index, or the least recently used slot */
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT; i++) {
+        plcrash_async_objc_imp_index_t *index = &objcContext->impIndexes[i];
+        if (index->image == image) {
+            index->lastUsed = generation;
+            *outIndex = index;
+            return PLCRASH_ESUCCESS;
+        }
+
+        if (index->image == NULL || (slot->image != NULL && index->lastUsed < slot->lastUsed))
+            slot = index;
+    }
+
+    /* Release the evicted index */
+    if (slot->entries != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t)slot->entries, slot->allocationSize);
+    slot->image = NULL;
+    slot->entries = NULL;
+    slot->count = 0;
+    slot->allocationSize = 0;
+
+    /* Count the image's methods */
+    size_t capacity = 0;
+    if ((err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_imp_index_count_callback, &capacity)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if (capacity == 0)
+        return PLCRASH_ENOTFOUND;
+
+    /* Allocate and populate the index */
+    vm_address_t addr;
+    size_t allocationSize = capacity * sizeof(plcrash_async_objc_imp_entry_t);
+    kern_return_t kr = vm_allocate(mach_task_self(), &addr, allocationSize, VM_FLAGS_ANYWHERE);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("vm_allocate failed with error %x, the IMP index could not be allocated", kr);
+        return PLCRASH_ENOMEM;
+    }
+
+    slot->entries = (void *) addr;
+    slot->allocationSize = allocationSize;
+
+    struct pl_async_objc_imp_index_fill_context fillCtx = {
+        .index = slot,
+        .capacity = capacity
+    };
+    if ((err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_imp_index_fill_callback, &fillCtx)) != PLCRASH_ESUCCESS) {
+        vm_deallocate(mach_task_self(), (vm_address_t)slot->entries, slot->allocationSize);
+        slot->entries = NULL;
+        slot->count = 0;
+        slot->allocationSize = 0;
+        return err;
+    }
+
+    pl_async_objc_imp_sort(slot->entries, slot->count);
+
+    slot->image = image;
+    slot->lastUsed = generation;
+    *outIndex = slot;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Find the best-matching method for @a imp in @a index, and invoke @a callback with the result.
+ */
+static plcrash_error_t pl_async_objc_imp_index_find (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, plcrash_async_objc_imp_index_t *index, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx) {
+    /* Find the first entry with an IMP greater than the target */
+    size_t lower = 0;
+    size_t upper = index->count;
+    while (lower < upper) {
+        size_t mid = lower + (upper - lower) / 2;
+        if (index->entries[mid].imp <= imp)
+            lower = mid + 1;
+        else
+            upper = mid;
+    }
+
+    if (lower == 0)
+        return PLCRASH_ENOTFOUND;
+
+    /* Prefer the first-parsed of any methods sharing the best IMP */
+    size_t best = lower - 1;
+    while (best > 0 && index->entries[best - 1].imp == index->entries[best].imp)
+        best--;
+
+    plcrash_async_objc_imp_entry_t *entry = &index->entries[best];
+    if (entry->imp == 0)
+        return PLCRASH_ENOTFOUND;
+
+    return pl_async_objc_found_method(image, objcContext, entry->isClassMethod, entry->className, entry->methodName, entry->imp, callback, ctx);
+}
+
+/**
+ * Transfer ownership of the entries of @a slot, an index built by pl_async_objc_imp_index_get(), to a newly
+ * allocated persistent index, and publish it to @a image. The slot is reset.
+ *
+ * @param image The indexed image.
+ * @param slot The cache slot holding the image's index.
+ * @param outBytes If non-NULL, on success will be set to the number of bytes allocated for the index. If another
+ * index had already been published, this will be set to 0.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the image has a published index on return, or PLCRASH_ENOMEM if the index
+ * could not be allocated, in which case the slot is left unmodified.
+ *
+ * @warning This method is not async safe.
+ */
+static plcrash_error_t pl_nasync_objc_imp_index_publish (plcrash_async_macho_t *image, plcrash_async_objc_imp_index_t *slot, size_t *outBytes) {
+    if (outBytes != NULL)
+        *outBytes = 0;
+
+    /* Take ownership of the slot's entries */
+    plcrash_async_objc_imp_index_t *index = malloc(sizeof(*index));
+    if (index == NULL) {
+        PLCF_DEBUG("Failed to allocate the IMP index for %s", image->name);
+        return PLCRASH_ENOMEM;
+    }
+
+    *index = *slot;
+    slot->image = NULL;
+    slot->entries = NULL;
+    slot->count = 0;
+    slot->allocationSize = 0;
+
+    /* Publish the index; if another thread won the race, discard ours. */
+    if (!OSAtomicCompareAndSwapPtrBarrier(NULL, index, (void * volatile *) &image->objc_index)) {
+        plcrash_nasync_objc_free_index(index);
+        return PLCRASH_ESUCCESS;
+    }
+
+    if (outBytes != NULL)
+        *outBytes = sizeof(*index) + index->allocationSize;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Build and publish a persistent Objective-C IMP index for @a image. Once published, the index is used by
+ * plcrash_async_objc_find_method() for all lookups within the image, regardless of the ObjC cache supplied,
+ * and is deallocated along with the image by plcrash_nasync_macho_free().
+ *
+ * The index is published atomically, and it is safe to call this function while other threads are performing
+ * async-safe lookups on @a image.
+ *
+ * @param image The image to be indexed.
+ * @param outBytes If non-NULL, on success will be set to the number of bytes allocated for the index. If the
+ * index had already been published, this will be set to 0.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or if the index has already been built. Returns PLCRASH_ENOTFOUND
+ * if the image contains no ObjC methods, or another plcrash_error_t error value if the index could not be built.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_objc_index_image (plcrash_async_macho_t *image, size_t *outBytes) {
+    plcrash_async_objc_cache_t objcContext;
+    plcrash_async_objc_imp_index_t *slot;
+    plcrash_error_t err;
+
+    if (outBytes != NULL)
+        *outBytes = 0;
+
+    if (image->objc_index != NULL)
+        return PLCRASH_ESUCCESS;
+
+    if ((err = plcrash_async_objc_cache_init(&objcContext)) != PLCRASH_ESUCCESS)
+        return err;
+
+    if ((err = pl_async_objc_imp_index_get(image, &objcContext, &slot)) != PLCRASH_ESUCCESS) {
+        plcrash_async_objc_cache_free(&objcContext);
+        return err;
+    }
+
+    err = pl_nasync_objc_imp_index_publish(image, slot, outBytes);
+    plcrash_async_objc_cache_free(&objcContext);
+
+    return err;
+}
+
+/**
+ * Free an IMP index previously allocated by plcrash_nasync_objc_index_image().
+ *
+ * @param index The index to be freed.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_objc_free_index (plcrash_async_objc_imp_index_t *index) {
+    if (index->entries != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t)index->entries, index->allocationSize);
+    free(index);
+}
+
 /**
  * Search for the method that best matches the given code address.
  *
+ * The first search within an image builds a sorted IMP index for the image within @a objcContext; subsequent
+ * searches within the same image are performed via binary search of the index. If a persistent index has been
+ * published for the image via plcrash_nasync_objc_index_image(), it is used instead. If the cache's
+ * plcrash_async_objc_cache::sharedCache is set, indices built for images within the shared cache are published to
+ * the image, and are used by all subsequent searches.
+ *
  * @param image The image to search.
  * @param objcContext A pointer to an ObjC context object. Must not be NULL, and must (obviously) be initialized.
  * @param imp The address to search for.
@@ -950,11 +1442,37 @@ static void pl_async_objc_find_method_call_callback (bool isClassMethod, plcrash
  * @return An error code.
  */
 plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx) {
+    plcrash_error_t err;
+
+    if (objcContext == NULL)
+        return PLCRASH_EACCESS;
+
+    /* Prefer the image's persistent IMP index, if one has been published */
+    plcrash_async_objc_imp_index_t *index = image->objc_index;
+    if (index != NULL)
+        return pl_async_objc_imp_index_find(image, objcContext, index, imp, callback, ctx);
+
+    /* Otherwise, use the cache's IMP index for the image, if one can be built */
+    err = pl_async_objc_imp_index_get(image, objcContext, &index);
+    if (err == PLCRASH_ESUCCESS) {
+        /* Shared cache images are never unloaded, and are otherwise re-parsed in full by each report */
+        if (objcContext->sharedCache != NULL && plcrash_async_shared_cache_contains_image(objcContext->sharedCache, image)) {
+            if (pl_nasync_objc_imp_index_publish(image, index, NULL) == PLCRASH_ESUCCESS)
+                index = image->objc_index;
+        }
+
+        return pl_async_objc_imp_index_find(image, objcContext, index, imp, callback, ctx);
+    }
+    else if (err == PLCRASH_ENOTFOUND)
+        return err;
+
+    /* Otherwise, fall back on a single search of the full ObjC data; only the best match's names are read */
     struct pl_async_objc_find_method_search_context searchCtx = {
-        .searchIMP = imp
+        .searchIMP = imp,
+        .found = false
     };
 
-    plcrash_error_t err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_search_callback, &searchCtx);
+    err = plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_search_callback, &searchCtx);
     if (err != PLCRASH_ESUCCESS) {
         /* Don't log an error if ObjC data was simply not found */
         if (err != PLCRASH_ENOTFOUND)
@@ -962,15 +1480,40 @@ plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, pl
         return err;
     }
     
-    if (searchCtx.bestIMP == 0)
+    if (!searchCtx.found || searchCtx.bestIMP == 0)
         return PLCRASH_ENOTFOUND;
     
-    struct pl_async_objc_find_method_call_context callCtx = {
-        .searchIMP = searchCtx.bestIMP,
-        .outerCallback = callback,
-        .outerCallbackCtx = ctx
-    };
-    
-    return plcrash_async_objc_parse(image, objcContext, pl_async_objc_find_method_call_callback, &callCtx);
+    return pl_async_objc_found_method(image, objcContext, searchCtx.bestIsClassMethod, searchCtx.bestClassName, searchCtx.bestMethodName,
+                                      searchCtx.bestIMP, callback, ctx);
+}
+
+#else /* !PLCRASH_FEATURE_SYMBOLICATE_OBJC */
+
+/*
+ * The Objective-C metadata parser is excluded from this build. The entry points are retained, such that symbol caches
+ * may be initialized and freed as usual, but all method lookups fail with PLCRASH_ENOTSUP.
+ */
+
+plcrash_error_t plcrash_async_objc_cache_init (plcrash_async_objc_cache_t *cache) {
+    return PLCRASH_ESUCCESS;
+}
+
+void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *cache) {
+}
+
+plcrash_error_t plcrash_nasync_objc_index_image (plcrash_async_macho_t *image, size_t *outBytes) {
+    if (outBytes != NULL)
+        *outBytes = 0;
+
+    return PLCRASH_ENOTSUP;
+}
+
+void plcrash_nasync_objc_free_index (plcrash_async_objc_imp_index_t *index) {
+    free(index);
+}
+
+plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *objcContext, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx) {
+    return PLCRASH_ENOTSUP;
 }
 
+#endif /* PLCRASH_FEATURE_SYMBOLICATE_OBJC */
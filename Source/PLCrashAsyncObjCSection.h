@@ -35,6 +35,7 @@ extern "C" {
 
 #include "PLCrashAsyncMachOImage.h"
 #include "PLCrashAsyncMachOString.h"
+#include "PLCrashAsyncSharedCache.h"
     
 /**
  * @internal
@@ -43,6 +44,64 @@ extern "C" {
  */
 
 
+/**
+ * @internal
+ * The number of per-image IMP indices retained by a plcrash_async_objc_cache_t.
+ */
+#define PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT 4
+
+/**
+ * @internal
+ * The number of __TEXT string sections (__objc_methname, __objc_classname, __cstring) mapped by a
+ * plcrash_async_objc_cache_t.
+ */
+#define PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT 3
+
+/**
+ * @internal
+ *
+ * A single method entry in a plcrash_async_objc_imp_index_t.
+ */
+typedef struct plcrash_async_objc_imp_entry {
+    /** The method's IMP. */
+    pl_vm_address_t imp;
+
+    /** The address of the class name string. */
+    pl_vm_address_t className;
+
+    /** The address of the method name string. */
+    pl_vm_address_t methodName;
+
+    /** The order in which the method was found while parsing the image; used to prefer the first of several
+     * methods sharing an IMP. */
+    uint32_t order;
+
+    /** If true, the method is a class (rather than an instance) method. */
+    bool isClassMethod;
+} plcrash_async_objc_imp_entry_t;
+
+/**
+ * @internal
+ *
+ * A sorted table of an image's Objective-C methods, ordered by IMP.
+ */
+typedef struct plcrash_async_objc_imp_index {
+    /** The indexed image, or NULL if this index is unused. */
+    plcrash_async_macho_t *image;
+
+    /** The method entries, sorted by IMP. Allocated with vm_allocate(). */
+    plcrash_async_objc_imp_entry_t *entries;
+
+    /** The number of valid entries in @a entries. */
+    size_t count;
+
+    /** The size of the @a entries allocation, in bytes. */
+    size_t allocationSize;
+
+    /** The value of plcrash_async_objc_cache::impIndexGeneration when this index was last used. */
+    uint32_t lastUsed;
+} plcrash_async_objc_imp_index_t;
+
 /**
  * @internal
  *
@@ -81,8 +140,16 @@ typedef struct plcrash_async_objc_cache {
     
     /** A memory object for the __objc_data section. */
     plcrash_async_mobject_t objcDataMobj;
+
+    /** Whether each of the string section memory objects is initialized. */
+    bool stringMobjInitialized[PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT];
+
+    /** Memory objects for the image's string sections, against which class and method names are resolved without
+     * requiring a mapping per string. */
+    plcrash_async_mobject_t stringMobj[PLCRASH_ASYNC_OBJC_STRING_SECTION_COUNT];
     
-    /** The size of the class cache, in entries. */
+    /** The size of the class cache, in entries. This is always 0 or a power of two; the cache is an open-addressed,
+     * linearly probed table sized from the __objc_classlist count of the images parsed. */
     size_t classCacheSize;
     
     /** Array of class cache keys. These are class data pointers. */
@@ -90,6 +157,24 @@ typedef struct plcrash_async_objc_cache {
     
     /** Array of class cache values. These are pointers to class_ro data. */
     pl_vm_address_t *classCacheValues;
+
+    /** Per-image IMP indices, built on the first method lookup within an image. */
+    plcrash_async_objc_imp_index_t impIndexes[PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT];
+
+    /** Incremented on each IMP index lookup; used to select the least recently used index for replacement. */
+    uint32_t impIndexGeneration;
+
+    /** An optional, borrowed reference to the work budget to be consumed when parsing Objective-C metadata,
+     * or NULL. */
+    plcrash_async_work_budget_t *workBudget;
+
+    /** An optional, borrowed reference to the task's shared cache, or NULL. If set, IMP indices built for images
+     * within the shared cache are published to the images, as per plcrash_nasync_objc_index_image(), rather than
+     * being discarded with the cache.
+     *
+     * @warning Publishing an index allocates memory; this must only be set when the cache is used outside of
+     * crash-time reporting. */
+    plcrash_async_shared_cache_t *sharedCache;
 } plcrash_async_objc_cache_t;
 
 plcrash_error_t plcrash_async_objc_cache_init (plcrash_async_objc_cache_t *context);
@@ -107,6 +192,9 @@ void plcrash_async_objc_cache_free (plcrash_async_objc_cache_t *context);
 typedef void (*plcrash_async_objc_found_method_cb)(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx);
 
 plcrash_error_t plcrash_async_objc_find_method (plcrash_async_macho_t *image, plcrash_async_objc_cache_t *cache, pl_vm_address_t imp, plcrash_async_objc_found_method_cb callback, void *ctx);
+
+plcrash_error_t plcrash_nasync_objc_index_image (plcrash_async_macho_t *image, size_t *outBytes);
+void plcrash_nasync_objc_free_index (plcrash_async_objc_imp_index_t *index);
     
 /**
  * @}
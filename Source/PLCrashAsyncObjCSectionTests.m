@@ -32,8 +32,11 @@
 #import <mach-o/dyld.h>
 #import <mach-o/getsect.h>
 
+#import "PLCrashFeatureConfig.h"
 #include "PLCrashAsyncObjCSection.h"
 
+#if PLCRASH_FEATURE_SYMBOLICATE_OBJC
+
 
 @interface PLCrashAsyncObjCSectionTests : SenTestCase {
     /** The image containing our class. */
@@ -110,6 +113,92 @@ static void ParseCallbackTrampoline(bool isClassMethod, plcrash_async_macho_stri
     block(isClassMethod, className, methodName, imp);
 }
 
+/**
+ * Verify that the first method lookup within an image builds a sorted IMP index, which is then reused.
+ */
+- (void) testIMPIndex {
+    plcrash_async_objc_cache_t objCContext;
+    STAssertEquals(plcrash_async_objc_cache_init(&objCContext), PLCRASH_ESUCCESS, @"Failed to initialize the cache");
+
+    __block BOOL didCall = NO;
+    pl_vm_address_t pc = [PLCrashAsyncObjCSectionTests addressInClassMethod];
+    plcrash_error_t err = plcrash_async_objc_find_method(&_image, &objCContext, pc, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+        didCall = YES;
+        STAssertTrue(isClassMethod, @"Incorrectly indicated an instance method");
+    });
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"ObjC parse failed");
+    STAssertTrue(didCall, @"Method find callback never got called");
+
+    /* Locate the index */
+    plcrash_async_objc_imp_index_t *index = NULL;
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT; i++) {
+        if (objCContext.impIndexes[i].image == &_image)
+            index = &objCContext.impIndexes[i];
+    }
+    STAssertNotNULL(index, @"No IMP index was built");
+    if (index == NULL) {
+        plcrash_async_objc_cache_free(&objCContext);
+        return;
+    }
+
+    STAssertTrue(index->count > 0, @"The IMP index is empty");
+    for (size_t i = 1; i < index->count; i++)
+        STAssertTrue(index->entries[i-1].imp <= index->entries[i].imp, @"The IMP index is not sorted");
+
+    /* A second lookup must reuse the existing index */
+    plcrash_async_objc_imp_entry_t *entries = index->entries;
+    didCall = NO;
+    err = plcrash_async_objc_find_method(&_image, &objCContext, pc, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+        didCall = YES;
+    });
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"ObjC parse failed");
+    STAssertTrue(didCall, @"Method find callback never got called");
+    STAssertEquals(entries, index->entries, @"The IMP index was rebuilt");
+
+    plcrash_async_objc_cache_free(&objCContext);
+}
+
+/**
+ * Verify that the IMP indices of shared cache images are published to the image when the cache's shared cache
+ * is set.
+ */
+- (void) testSharedCacheIndexPublished {
+    plcrash_async_shared_cache_t sharedCache;
+    if (plcrash_async_shared_cache_init(&sharedCache, mach_task_self()) != PLCRASH_ESUCCESS) {
+        NSLog(@"The shared cache could not be found; skipping the shared cache IMP index test");
+        return;
+    }
+
+    /* Find a method implemented within the shared cache */
+    pl_vm_address_t pc = (pl_vm_address_t) [NSObject instanceMethodForSelector: @selector(description)];
+    Dl_info info;
+    STAssertTrue(dladdr((void *) pc, &info) > 0, @"Could not fetch dyld info for %p", (void *) pc);
+
+    plcrash_async_macho_t image;
+    plcrash_nasync_macho_init(&image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase);
+    STAssertTrue(plcrash_async_shared_cache_contains_image(&sharedCache, &image), @"%s is not within the shared cache", info.dli_fname);
+
+    plcrash_async_objc_cache_t objCContext;
+    STAssertEquals(plcrash_async_objc_cache_init(&objCContext), PLCRASH_ESUCCESS, @"Failed to initialize the cache");
+    objCContext.sharedCache = &sharedCache;
+
+    __block BOOL didCall = NO;
+    plcrash_error_t err = plcrash_async_objc_find_method(&image, &objCContext, pc, ParseCallbackTrampoline, ^(bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx) {
+        didCall = YES;
+        STAssertEquals(imp, pc, @"Incorrect IMP");
+    });
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"ObjC parse failed");
+    STAssertTrue(didCall, @"Method find callback never got called");
+
+    /* The index must have been published to the image, rather than retained by the cache */
+    STAssertNotNULL(image.objc_index, @"The IMP index was not published");
+    for (size_t i = 0; i < PLCRASH_ASYNC_OBJC_IMP_INDEX_COUNT; i++)
+        STAssertTrue(objCContext.impIndexes[i].image != &image, @"The IMP index was retained by the cache");
+
+    plcrash_async_objc_cache_free(&objCContext);
+    plcrash_nasync_macho_free(&image);
+}
+
 - (void) testParse {
     plcrash_error_t err;
     
@@ -251,3 +340,5 @@ static void ParseCallbackTrampoline(bool isClassMethod, plcrash_async_macho_stri
 }
 
 @end
+
+#endif /* PLCRASH_FEATURE_SYMBOLICATE_OBJC */
@@ -0,0 +1,429 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncReportIndex.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_report_index Pending Report Index
+ *
+ * Implements a small, append-only index of the reports written to the report directory. Each report write, upload
+ * hand-off and deletion appends a fixed-size record, allowing the pending reports, their sizes and their write times
+ * to be determined with a single read of the index, rather than by enumerating the directory and examining each file.
+ *
+ * The index is only trusted while it is in sync with the directory: each record carries the directory's modification
+ * time following the change it describes, and the index is considered stale if the directory has since been modified
+ * by any other means, such as a report written by a previous version of the library. A stale index must be rebuilt
+ * from a directory scan via plcrash_nasync_report_index_rewrite().
+ *
+ * Appending a record requires only a stat(2) and a single write(2) to a pre-opened descriptor, and may be performed
+ * at crash time.
+ *
+ * @{
+ */
+
+/* Copy the NUL-terminated @a src to @a dest of @a size bytes. Returns false if @a src does not fit. */
+static bool plcrash_report_index_strcpy (char *dest, const char *src, size_t size) {
+    size_t i = 0;
+    for (; src[i] != '\0'; i++) {
+        if (i + 1 >= size)
+            return false;
+        dest[i] = src[i];
+    }
+    dest[i] = '\0';
+    return true;
+}
+
+/* Return true if @a lhs and @a rhs are equal */
+static bool plcrash_report_index_stamp_equal (const plcrash_async_report_index_stamp_t *lhs, const plcrash_async_report_index_stamp_t *rhs) {
+    return lhs->sec == rhs->sec && lhs->nsec == rhs->nsec;
+}
+
+/**
+ * Open (or create) the report index at @a path, describing the reports within @a directory.
+ *
+ * @param index The index instance to initialize.
+ * @param directory The report directory.
+ * @param path The index file path.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate error if the index could not be opened. If an
+ * error is returned, @a index must not be used.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_report_index_open (plcrash_async_report_index_t *index, const char *directory, const char *path) {
+    if ((index->directory = strdup(directory)) == NULL)
+        return PLCRASH_ENOMEM;
+
+    index->fd = open(path, O_RDWR|O_APPEND|O_CREAT, 0644);
+    if (index->fd < 0) {
+        PLCF_DEBUG("Could not open the report index %s: %s", path, strerror(errno));
+        free(index->directory);
+        return PLCRASH_EINTERNAL;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Close @a index.
+ *
+ * @param index The index to be closed.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_nasync_report_index_close (plcrash_async_report_index_t *index) {
+    close(index->fd);
+    free(index->directory);
+}
+
+/**
+ * Fetch the current modification time of the report directory described by @a index. This method is async-safe.
+ *
+ * @param index The report index.
+ * @param stamp On success, the directory's modification time.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINTERNAL if the directory could not be examined.
+ */
+plcrash_error_t plcrash_async_report_index_stamp (plcrash_async_report_index_t *index, plcrash_async_report_index_stamp_t *stamp) {
+    struct stat st;
+    if (stat(index->directory, &st) != 0)
+        return PLCRASH_EINTERNAL;
+
+    stamp->sec = st.st_mtimespec.tv_sec;
+    stamp->nsec = st.st_mtimespec.tv_nsec;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return true if @a index is in sync with its report directory; that is, if the directory has not been modified since
+ * the last record was appended. This method is async-safe.
+ *
+ * This should be called prior to modifying the directory, and the result supplied to plcrash_async_report_index_append()
+ * once the modification has been made.
+ *
+ * @param index The report index.
+ */
+bool plcrash_async_report_index_synced (plcrash_async_report_index_t *index) {
+    plcrash_async_report_index_record_t record;
+    plcrash_async_report_index_stamp_t stamp;
+    struct stat st;
+
+    if (fstat(index->fd, &st) != 0 || st.st_size == 0 || st.st_size % sizeof(record) != 0)
+        return false;
+
+    if (pread(index->fd, &record, sizeof(record), st.st_size - sizeof(record)) != (ssize_t) sizeof(record))
+        return false;
+
+    if (record.magic != PLCRASH_ASYNC_REPORT_INDEX_MAGIC || record.stamp.sec == 0)
+        return false;
+
+    if (plcrash_async_report_index_stamp(index, &stamp) != PLCRASH_ESUCCESS)
+        return false;
+
+    return plcrash_report_index_stamp_equal(&record.stamp, &stamp);
+}
+
+/**
+ * Append a record describing a change to the report directory. This method is async-safe.
+ *
+ * @param index The report index.
+ * @param state The report's new state.
+ * @param name The report's file name, relative to the report directory. Ignored for PLCRASH_ASYNC_REPORT_INDEX_SYNC.
+ * @param size The report's size, in bytes.
+ * @param timestamp The time at which the report was written, in seconds since the epoch.
+ * @param synced The result of plcrash_async_report_index_synced(), as determined prior to making the change. If false,
+ * the index will remain stale.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a name exceeds PLCRASH_ASYNC_REPORT_INDEX_NAME_MAX,
+ * or PLCRASH_OUTPUT_ERR if the record could not be written.
+ */
+plcrash_error_t plcrash_async_report_index_append (plcrash_async_report_index_t *index,
+                                                   plcrash_async_report_index_state_t state,
+                                                   const char *name,
+                                                   uint64_t size,
+                                                   int64_t timestamp,
+                                                   bool synced)
+{
+    plcrash_async_report_index_record_t record;
+    plcrash_async_memset(&record, 0, sizeof(record));
+
+    record.magic = PLCRASH_ASYNC_REPORT_INDEX_MAGIC;
+    record.state = state;
+    record.timestamp = timestamp;
+    record.size = size;
+
+    /* A report that can't be named in the index leaves the index stale, ensuring that it is found by a directory scan */
+    bool named = true;
+    if (state != PLCRASH_ASYNC_REPORT_INDEX_SYNC && !plcrash_report_index_strcpy(record.name, name, sizeof(record.name))) {
+        record.name[0] = '\0';
+        named = false;
+        synced = false;
+    }
+
+    if (synced && plcrash_async_report_index_stamp(index, &record.stamp) != PLCRASH_ESUCCESS) {
+        record.stamp.sec = 0;
+        record.stamp.nsec = 0;
+    }
+
+    /* The record is written with a single append, and is never left partially interleaved with another writer's */
+    if (write(index->fd, &record, sizeof(record)) != (ssize_t) sizeof(record))
+        return PLCRASH_OUTPUT_ERR;
+
+    if (!named)
+        return PLCRASH_EINVAL;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Read the pending reports recorded in @a index, newest first.
+ *
+ * @param index The report index.
+ * @param entries On success, a newly allocated array of the pending reports, which must be freed via free(), or NULL
+ * if there are no pending reports.
+ * @param count On success, the number of entries in @a entries.
+ * @param record_count On success, the total number of records in the index, which may be used to determine whether
+ * the index should be compacted via plcrash_nasync_report_index_rewrite().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the index is not in sync with the report directory,
+ * PLCRASH_EINVAL if the index is malformed, or another appropriate error if the index could not be read. If any error
+ * is returned, the index must be rebuilt from a directory scan.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_report_index_read (plcrash_async_report_index_t *index,
+                                                  plcrash_async_report_index_entry_t **entries,
+                                                  size_t *count,
+                                                  size_t *record_count)
+{
+    plcrash_async_report_index_record_t *records;
+    plcrash_async_report_index_entry_t *result = NULL;
+    plcrash_async_report_index_stamp_t stamp;
+    plcrash_error_t err = PLCRASH_ESUCCESS;
+    size_t nrecords;
+    size_t nresult = 0;
+    struct stat st;
+
+    if (fstat(index->fd, &st) != 0)
+        return PLCRASH_EINTERNAL;
+
+    if (st.st_size == 0)
+        return PLCRASH_ENOTFOUND;
+
+    if (st.st_size % sizeof(*records) != 0)
+        return PLCRASH_EINVAL;
+
+    nrecords = (size_t) st.st_size / sizeof(*records);
+    if ((records = malloc((size_t) st.st_size)) == NULL)
+        return PLCRASH_ENOMEM;
+
+    if (pread(index->fd, records, (size_t) st.st_size, 0) != (ssize_t) st.st_size) {
+        err = PLCRASH_EINTERNAL;
+        goto cleanup;
+    }
+
+    /* The final record determines whether the index reflects the directory */
+    if (plcrash_async_report_index_stamp(index, &stamp) != PLCRASH_ESUCCESS) {
+        err = PLCRASH_EINTERNAL;
+        goto cleanup;
+    }
+
+    if (records[nrecords - 1].stamp.sec == 0 || !plcrash_report_index_stamp_equal(&records[nrecords - 1].stamp, &stamp)) {
+        err = PLCRASH_ENOTFOUND;
+        goto cleanup;
+    }
+
+    if ((result = malloc(nrecords * sizeof(*result))) == NULL) {
+        err = PLCRASH_ENOMEM;
+        goto cleanup;
+    }
+
+    /* Replay the records, in order. Pending entries are maintained in the order in which they were written. */
+    for (size_t i = 0; i < nrecords; i++) {
+        plcrash_async_report_index_record_t *record = &records[i];
+        if (record->magic != PLCRASH_ASYNC_REPORT_INDEX_MAGIC) {
+            err = PLCRASH_EINVAL;
+            goto cleanup;
+        }
+
+        if (record->state == PLCRASH_ASYNC_REPORT_INDEX_SYNC)
+            continue;
+
+        record->name[sizeof(record->name) - 1] = '\0';
+
+        /* Occurrence counts update an existing entry in place; the report may since have been removed */
+        if (record->state == PLCRASH_ASYNC_REPORT_INDEX_OCCURRENCE) {
+            for (size_t j = 0; j < nresult; j++) {
+                if (strcmp(result[j].name, record->name) == 0) {
+                    result[j].occurrences = record->size > 0 ? record->size : 1;
+                    result[j].occurrence_timestamp = record->timestamp;
+                    break;
+                }
+            }
+            continue;
+        }
+
+        /* Drop any existing entry for the report. A report rewritten in place (eg, once symbolicated) retains its
+         * occurrence count. */
+        uint64_t occurrences = 1;
+        int64_t occurrence_timestamp = record->timestamp;
+        for (size_t j = 0; j < nresult; j++) {
+            if (strcmp(result[j].name, record->name) == 0) {
+                if (result[j].occurrences > 1) {
+                    occurrences = result[j].occurrences;
+                    occurrence_timestamp = result[j].occurrence_timestamp;
+                }
+                memmove(&result[j], &result[j + 1], (nresult - j - 1) * sizeof(*result));
+                nresult--;
+                break;
+            }
+        }
+
+        switch (record->state) {
+            case PLCRASH_ASYNC_REPORT_INDEX_WRITTEN:
+            case PLCRASH_ASYNC_REPORT_INDEX_TRUNCATED: {
+                plcrash_async_report_index_entry_t *entry = &result[nresult++];
+                memcpy(entry->name, record->name, sizeof(entry->name));
+                entry->state = (plcrash_async_report_index_state_t) record->state;
+                entry->timestamp = record->timestamp;
+                entry->size = record->size;
+                entry->occurrences = occurrences;
+                entry->occurrence_timestamp = occurrence_timestamp;
+                break;
+            }
+
+            case PLCRASH_ASYNC_REPORT_INDEX_UPLOADED:
+            case PLCRASH_ASYNC_REPORT_INDEX_PURGED:
+                break;
+
+            default:
+                err = PLCRASH_EINVAL;
+                goto cleanup;
+        }
+    }
+
+    /* Sort newest first. Entries are reversed into most-recently-written order, and then stably sorted by their write
+     * time, such that reports written within the same second are returned in the reverse of their write order. */
+    for (size_t i = 0; i < nresult / 2; i++) {
+        plcrash_async_report_index_entry_t tmp = result[i];
+        result[i] = result[nresult - i - 1];
+        result[nresult - i - 1] = tmp;
+    }
+
+    for (size_t i = 1; i < nresult; i++) {
+        plcrash_async_report_index_entry_t tmp = result[i];
+        size_t j = i;
+        for (; j > 0 && result[j - 1].timestamp < tmp.timestamp; j--)
+            result[j] = result[j - 1];
+        result[j] = tmp;
+    }
+
+    if (nresult == 0) {
+        free(result);
+        result = NULL;
+    }
+
+    *entries = result;
+    *count = nresult;
+    *record_count = nrecords;
+    result = NULL;
+
+cleanup:
+    free(result);
+    free(records);
+    return err;
+}
+
+/**
+ * Replace the contents of @a index with @a entries, marking the index as in sync with the report directory as of
+ * @a stamp. This is used to rebuild a stale index from a directory scan, and to compact an index in which most
+ * records describe reports that are no longer pending.
+ *
+ * When rebuilding from a scan, @a stamp should be fetched via plcrash_async_report_index_stamp() prior to the scan;
+ * if the directory is modified during the scan, the index will remain stale.
+ *
+ * @param index The report index.
+ * @param entries The pending reports, in any order. Occurrence counts greater than 1 are preserved.
+ * @param count The number of entries in @a entries.
+ * @param stamp The directory modification time as of which @a entries describes the directory's pending reports.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an appropriate error if the index could not be written. On failure,
+ * the index is left stale.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plcrash_nasync_report_index_rewrite (plcrash_async_report_index_t *index,
+                                                     const plcrash_async_report_index_entry_t *entries,
+                                                     size_t count,
+                                                     const plcrash_async_report_index_stamp_t *stamp)
+{
+    plcrash_error_t err;
+
+    /* The index is rewritten in place, rather than replaced, to avoid modifying the directory. Until the final sync
+     * record is written, the index is stale. */
+    if (ftruncate(index->fd, 0) != 0) {
+        PLCF_DEBUG("Could not truncate the report index: %s", strerror(errno));
+        return PLCRASH_OUTPUT_ERR;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if ((err = plcrash_async_report_index_append(index, entries[i].state, entries[i].name, entries[i].size, entries[i].timestamp, false)) != PLCRASH_ESUCCESS)
+            return err;
+
+        if (entries[i].occurrences > 1) {
+            err = plcrash_async_report_index_append(index, PLCRASH_ASYNC_REPORT_INDEX_OCCURRENCE, entries[i].name, entries[i].occurrences,
+                                                    entries[i].occurrence_timestamp, false);
+            if (err != PLCRASH_ESUCCESS)
+                return err;
+        }
+    }
+
+    plcrash_async_report_index_record_t record;
+    plcrash_async_memset(&record, 0, sizeof(record));
+    record.magic = PLCRASH_ASYNC_REPORT_INDEX_MAGIC;
+    record.state = PLCRASH_ASYNC_REPORT_INDEX_SYNC;
+    record.stamp = *stamp;
+
+    if (write(index->fd, &record, sizeof(record)) != (ssize_t) sizeof(record))
+        return PLCRASH_OUTPUT_ERR;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @} plcrash_async_report_index
+ */
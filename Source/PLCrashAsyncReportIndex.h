@@ -0,0 +1,197 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_REPORT_INDEX_H
+#define PLCRASH_ASYNC_REPORT_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * The magic value identifying a report index record ('plri').
+ */
+#define PLCRASH_ASYNC_REPORT_INDEX_MAGIC 0x706c7269
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * The maximum length of a report file name recorded in the index, including the trailing NUL. Reports with longer
+ * names can not be indexed.
+ */
+#define PLCRASH_ASYNC_REPORT_INDEX_NAME_MAX 64
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * The state of a report, as recorded in the index.
+ */
+typedef enum plcrash_async_report_index_state {
+    /** The report was written, and is pending. */
+    PLCRASH_ASYNC_REPORT_INDEX_WRITTEN = 1,
+
+    /** The report was written, but is incomplete; for example, the writer failed or exhausted the report's size
+     * limit. The report is pending. */
+    PLCRASH_ASYNC_REPORT_INDEX_TRUNCATED = 2,
+
+    /** The report was handed off for upload, and is no longer pending. */
+    PLCRASH_ASYNC_REPORT_INDEX_UPLOADED = 3,
+
+    /** The report was deleted. */
+    PLCRASH_ASYNC_REPORT_INDEX_PURGED = 4,
+
+    /** No report is described; the record only marks the index as in sync with the report directory. */
+    PLCRASH_ASYNC_REPORT_INDEX_SYNC = 5,
+
+    /** The pending report's occurrence count was updated; duplicate reports were collapsed into it. The record's size
+     * is the total occurrence count, and its timestamp the write time of the most recent occurrence. The report's
+     * state is otherwise unchanged. */
+    PLCRASH_ASYNC_REPORT_INDEX_OCCURRENCE = 6
+} plcrash_async_report_index_state_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * A report directory modification time, used to determine whether the index reflects the directory's contents.
+ */
+typedef struct plcrash_async_report_index_stamp {
+    /** Seconds since the epoch. */
+    int64_t sec;
+
+    /** Nanoseconds. */
+    int64_t nsec;
+} plcrash_async_report_index_stamp_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * A single index record. Records are appended to the index file verbatim; the layout must only be changed alongside
+ * PLCRASH_ASYNC_REPORT_INDEX_MAGIC.
+ */
+typedef struct plcrash_async_report_index_record {
+    /** PLCRASH_ASYNC_REPORT_INDEX_MAGIC. */
+    uint32_t magic;
+
+    /** The report's new state; one of plcrash_async_report_index_state_t. */
+    uint32_t state;
+
+    /** The time at which the report was written, in seconds since the epoch. */
+    int64_t timestamp;
+
+    /** The report's size, in bytes. */
+    uint64_t size;
+
+    /** The report directory's modification time once the change described by this record had been made, or zero if
+     * the index was not in sync with the directory prior to the change. */
+    plcrash_async_report_index_stamp_t stamp;
+
+    /** The NUL-terminated report file name, relative to the report directory. Empty for PLCRASH_ASYNC_REPORT_INDEX_SYNC. */
+    char name[PLCRASH_ASYNC_REPORT_INDEX_NAME_MAX];
+} plcrash_async_report_index_record_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * A pending report, as returned by plcrash_nasync_report_index_read().
+ */
+typedef struct plcrash_async_report_index_entry {
+    /** The NUL-terminated report file name, relative to the report directory. */
+    char name[PLCRASH_ASYNC_REPORT_INDEX_NAME_MAX];
+
+    /** The report's state; either PLCRASH_ASYNC_REPORT_INDEX_WRITTEN or PLCRASH_ASYNC_REPORT_INDEX_TRUNCATED. */
+    plcrash_async_report_index_state_t state;
+
+    /** The time at which the report was written, in seconds since the epoch. */
+    int64_t timestamp;
+
+    /** The report's size, in bytes. */
+    uint64_t size;
+
+    /** The number of crashes described by the report, including any collapsed duplicates; at least 1. */
+    uint64_t occurrences;
+
+    /** The write time of the report's most recent occurrence, in seconds since the epoch. Equal to @a timestamp if
+     * no duplicates have been collapsed into the report. */
+    int64_t occurrence_timestamp;
+} plcrash_async_report_index_entry_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_report_index
+ *
+ * An open report index.
+ */
+typedef struct plcrash_async_report_index {
+    /** The index file descriptor, opened for appending. */
+    int fd;
+
+    /** The report directory described by the index. */
+    char *directory;
+} plcrash_async_report_index_t;
+
+plcrash_error_t plcrash_nasync_report_index_open (plcrash_async_report_index_t *index, const char *directory, const char *path);
+void plcrash_nasync_report_index_close (plcrash_async_report_index_t *index);
+
+plcrash_error_t plcrash_async_report_index_stamp (plcrash_async_report_index_t *index, plcrash_async_report_index_stamp_t *stamp);
+bool plcrash_async_report_index_synced (plcrash_async_report_index_t *index);
+plcrash_error_t plcrash_async_report_index_append (plcrash_async_report_index_t *index,
+                                                   plcrash_async_report_index_state_t state,
+                                                   const char *name,
+                                                   uint64_t size,
+                                                   int64_t timestamp,
+                                                   bool synced);
+
+plcrash_error_t plcrash_nasync_report_index_read (plcrash_async_report_index_t *index,
+                                                  plcrash_async_report_index_entry_t **entries,
+                                                  size_t *count,
+                                                  size_t *record_count);
+plcrash_error_t plcrash_nasync_report_index_rewrite (plcrash_async_report_index_t *index,
+                                                     const plcrash_async_report_index_entry_t *entries,
+                                                     size_t count,
+                                                     const plcrash_async_report_index_stamp_t *stamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_REPORT_INDEX_H */
@@ -0,0 +1,209 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncReportIndex.h"
+
+@interface PLCrashAsyncReportIndexTests : SenTestCase {
+@private
+    /** Report directory */
+    NSString *_directory;
+
+    /** Index under test */
+    plcrash_async_report_index_t _index;
+}
+@end
+
+@implementation PLCrashAsyncReportIndexTests
+
+- (void) setUp {
+    _directory = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: _directory withIntermediateDirectories: YES attributes: nil error: NULL], @"Could not create directory");
+
+    NSString *path = [_directory stringByAppendingPathComponent: @"index"];
+    plcrash_error_t err = plcrash_nasync_report_index_open(&_index, [_directory fileSystemRepresentation], [path fileSystemRepresentation]);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to open the index");
+
+    /* Creating the index modified the directory; mark the (empty) index as in sync */
+    plcrash_async_report_index_stamp_t stamp;
+    STAssertEquals(plcrash_async_report_index_stamp(&_index, &stamp), PLCRASH_ESUCCESS, @"Failed to fetch the directory stamp");
+    STAssertEquals(plcrash_nasync_report_index_rewrite(&_index, NULL, 0, &stamp), PLCRASH_ESUCCESS, @"Failed to rewrite the index");
+}
+
+- (void) tearDown {
+    plcrash_nasync_report_index_close(&_index);
+    [[NSFileManager defaultManager] removeItemAtPath: _directory error: NULL];
+    [_directory release];
+}
+
+/* Write a report file named @a name to the directory, recording it in the index */
+- (void) writeReport: (NSString *) name timestamp: (int64_t) timestamp {
+    bool synced = plcrash_async_report_index_synced(&_index);
+    NSData *data = [name dataUsingEncoding: NSUTF8StringEncoding];
+    STAssertTrue([data writeToFile: [_directory stringByAppendingPathComponent: name] atomically: NO], @"Could not write report");
+
+    plcrash_error_t err = plcrash_async_report_index_append(&_index, PLCRASH_ASYNC_REPORT_INDEX_WRITTEN, [name UTF8String], [data length], timestamp, synced);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to append to the index");
+}
+
+/**
+ * Verify that written reports are returned newest first, and that uploaded and purged reports are dropped.
+ */
+- (void) testAppendAndRead {
+    plcrash_async_report_index_entry_t *entries;
+    size_t count;
+    size_t records;
+
+    [self writeReport: @"a" timestamp: 10];
+    [self writeReport: @"bb" timestamp: 30];
+    [self writeReport: @"ccc" timestamp: 20];
+    [self writeReport: @"dddd" timestamp: 20];
+
+    STAssertTrue(plcrash_async_report_index_synced(&_index), @"Index should be in sync");
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(count, (size_t) 4, @"Incorrect entry count");
+    STAssertEquals(records, (size_t) 5, @"Incorrect record count");
+    STAssertEqualCStrings(entries[0].name, "bb", @"Incorrect order");
+    STAssertEqualCStrings(entries[1].name, "dddd", @"Reports written within the same second should be returned newest first");
+    STAssertEqualCStrings(entries[2].name, "ccc", @"Incorrect order");
+    STAssertEqualCStrings(entries[3].name, "a", @"Incorrect order");
+    STAssertEquals(entries[0].size, (uint64_t) 2, @"Incorrect size");
+    STAssertEquals(entries[0].timestamp, (int64_t) 30, @"Incorrect timestamp");
+    free(entries);
+
+    /* Move one report and delete another */
+    bool synced = plcrash_async_report_index_synced(&_index);
+    STAssertTrue([[NSFileManager defaultManager] removeItemAtPath: [_directory stringByAppendingPathComponent: @"bb"] error: NULL], @"Could not remove report");
+    plcrash_async_report_index_append(&_index, PLCRASH_ASYNC_REPORT_INDEX_UPLOADED, "bb", 0, 0, synced);
+
+    synced = plcrash_async_report_index_synced(&_index);
+    STAssertTrue([[NSFileManager defaultManager] removeItemAtPath: [_directory stringByAppendingPathComponent: @"a"] error: NULL], @"Could not remove report");
+    plcrash_async_report_index_append(&_index, PLCRASH_ASYNC_REPORT_INDEX_PURGED, "a", 0, 0, synced);
+
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(count, (size_t) 2, @"Incorrect entry count");
+    STAssertEqualCStrings(entries[0].name, "dddd", @"Incorrect order");
+    STAssertEqualCStrings(entries[1].name, "ccc", @"Incorrect order");
+    free(entries);
+}
+
+/**
+ * Verify that modification of the directory outside of the index is detected, and that a rewrite restores the index.
+ */
+- (void) testStaleIndex {
+    plcrash_async_report_index_entry_t *entries;
+    size_t count;
+    size_t records;
+
+    [self writeReport: @"a" timestamp: 10];
+
+    /* Sleep to ensure that the directory's modification time changes even on coarse-grained file systems */
+    sleep(1);
+    STAssertTrue([[NSData data] writeToFile: [_directory stringByAppendingPathComponent: @"unindexed"] atomically: NO], @"Could not write report");
+
+    STAssertFalse(plcrash_async_report_index_synced(&_index), @"Index should be stale");
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ENOTFOUND, @"Stale index should not be returned");
+
+    /* Appending to a stale index leaves it stale */
+    [self writeReport: @"b" timestamp: 20];
+    STAssertFalse(plcrash_async_report_index_synced(&_index), @"Index should be stale");
+
+    /* Rebuild */
+    plcrash_async_report_index_stamp_t stamp;
+    plcrash_async_report_index_entry_t scanned = { .name = "unindexed", .state = PLCRASH_ASYNC_REPORT_INDEX_WRITTEN, .timestamp = 5, .size = 0 };
+    STAssertEquals(plcrash_async_report_index_stamp(&_index, &stamp), PLCRASH_ESUCCESS, @"Failed to fetch the directory stamp");
+    STAssertEquals(plcrash_nasync_report_index_rewrite(&_index, &scanned, 1, &stamp), PLCRASH_ESUCCESS, @"Failed to rewrite the index");
+
+    STAssertTrue(plcrash_async_report_index_synced(&_index), @"Index should be in sync");
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(count, (size_t) 1, @"Incorrect entry count");
+    STAssertEquals(records, (size_t) 2, @"Incorrect record count");
+    STAssertEqualCStrings(entries[0].name, "unindexed", @"Incorrect entry");
+    free(entries);
+}
+
+/**
+ * Verify that occurrence counts are applied to their report, survive a rewrite of the report, and are preserved
+ * when the index is compacted.
+ */
+- (void) testOccurrences {
+    plcrash_async_report_index_entry_t *entries;
+    size_t count;
+    size_t records;
+
+    [self writeReport: @"a" timestamp: 10];
+    [self writeReport: @"b" timestamp: 20];
+
+    bool synced = plcrash_async_report_index_synced(&_index);
+    STAssertEquals(plcrash_async_report_index_append(&_index, PLCRASH_ASYNC_REPORT_INDEX_OCCURRENCE, "a", 3, 15, synced), PLCRASH_ESUCCESS, @"Failed to append to the index");
+
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(count, (size_t) 2, @"Occurrence records should not add entries");
+    STAssertEqualCStrings(entries[1].name, "a", @"Incorrect order");
+    STAssertEquals(entries[1].occurrences, (uint64_t) 3, @"Incorrect occurrence count");
+    STAssertEquals(entries[1].occurrence_timestamp, (int64_t) 15, @"Incorrect occurrence timestamp");
+    STAssertEquals(entries[0].occurrences, (uint64_t) 1, @"Incorrect occurrence count");
+    STAssertEquals(entries[0].occurrence_timestamp, (int64_t) 20, @"Incorrect occurrence timestamp");
+    free(entries);
+
+    /* Rewriting the report in place retains its count */
+    [self writeReport: @"a" timestamp: 10];
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(entries[1].occurrences, (uint64_t) 3, @"Occurrence count should be retained");
+    free(entries);
+
+    /* Compaction preserves the count */
+    plcrash_async_report_index_stamp_t stamp;
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(plcrash_async_report_index_stamp(&_index, &stamp), PLCRASH_ESUCCESS, @"Failed to fetch the directory stamp");
+    STAssertEquals(plcrash_nasync_report_index_rewrite(&_index, entries, count, &stamp), PLCRASH_ESUCCESS, @"Failed to rewrite the index");
+    free(entries);
+
+    STAssertEquals(plcrash_nasync_report_index_read(&_index, &entries, &count, &records), PLCRASH_ESUCCESS, @"Failed to read the index");
+    STAssertEquals(count, (size_t) 2, @"Incorrect entry count");
+    STAssertEquals(records, (size_t) 4, @"Incorrect record count");
+    STAssertEqualCStrings(entries[1].name, "a", @"Incorrect order");
+    STAssertEquals(entries[1].occurrences, (uint64_t) 3, @"Occurrence count should be preserved");
+    STAssertEquals(entries[1].occurrence_timestamp, (int64_t) 15, @"Occurrence timestamp should be preserved");
+    free(entries);
+}
+
+/**
+ * Verify that names that do not fit within a record leave the index stale, rather than dropping the report.
+ */
+- (void) testLongName {
+    char name[PLCRASH_ASYNC_REPORT_INDEX_NAME_MAX + 1];
+    memset(name, 'a', sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+
+    bool synced = plcrash_async_report_index_synced(&_index);
+    STAssertTrue(synced, @"Index should be in sync");
+    STAssertEquals(plcrash_async_report_index_append(&_index, PLCRASH_ASYNC_REPORT_INDEX_WRITTEN, name, 0, 0, synced), PLCRASH_EINVAL, @"Long name should be rejected");
+    STAssertFalse(plcrash_async_report_index_synced(&_index), @"Index should be stale");
+}
+
+@end
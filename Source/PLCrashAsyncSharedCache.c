@@ -0,0 +1,265 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashAsyncSharedCache.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+#include <mach/mach.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async_shared_cache
+ * @{
+ */
+
+/** Mach-O header flag set by dyld on images loaded from the shared cache. Not defined by older SDKs. */
+#define PL_MH_DYLIB_IN_CACHE 0x80000000
+
+/** The first dyld_all_image_infos version to include the sharedCacheBaseAddress field. */
+#define PL_DYLD_ALL_IMAGE_INFOS_MIN_VERSION 15
+
+/** The maximum number of shared cache mappings that will be read. */
+#define PL_DYLD_CACHE_MAX_MAPPINGS 16
+
+/**
+ * @internal
+ *
+ * Define a mirror of the leading fields of dyld's dyld_all_image_infos structure (mach-o/dyld_images.h), using
+ * fixed-width types of @a ptr_t in place of the target's pointer-sized fields. These fields have remained stable
+ * since their introduction, and the structure is only ever extended.
+ */
+#define PL_DYLD_ALL_IMAGE_INFOS(name, ptr_t) \
+    struct name { \
+        uint32_t version; \
+        uint32_t infoArrayCount; \
+        ptr_t infoArray; \
+        ptr_t notification; \
+        uint8_t processDetachedFromSharedRegion; \
+        uint8_t libSystemInitialized; \
+        ptr_t dyldImageLoadAddress; \
+        ptr_t jitInfo; \
+        ptr_t dyldVersion; \
+        ptr_t errorMessage; \
+        ptr_t terminationFlags; \
+        ptr_t coreSymbolicationShmPage; \
+        ptr_t systemOrderFlag; \
+        ptr_t uuidArrayCount; \
+        ptr_t uuidArray; \
+        ptr_t dyldAllImageInfosAddress; \
+        ptr_t initialImageCount; \
+        ptr_t errorKind; \
+        ptr_t errorClientOfDylibPath; \
+        ptr_t errorTargetDylibPath; \
+        ptr_t errorSymbol; \
+        ptr_t sharedCacheSlide; \
+        uint8_t sharedCacheUUID[16]; \
+        ptr_t sharedCacheBaseAddress; \
+    }
+
+PL_DYLD_ALL_IMAGE_INFOS(pl_dyld_all_image_infos_32, uint32_t);
+PL_DYLD_ALL_IMAGE_INFOS(pl_dyld_all_image_infos_64, uint64_t);
+
+/**
+ * @internal
+ *
+ * The leading fields of the dyld_cache_header structure.
+ */
+struct pl_dyld_cache_header {
+    /** Cache magic; "dyld_v1" followed by the padded architecture name. */
+    char magic[16];
+
+    /** File offset of the first dyld_cache_mapping_info. */
+    uint32_t mappingOffset;
+
+    /** Number of dyld_cache_mapping_info entries. */
+    uint32_t mappingCount;
+};
+
+/**
+ * @internal
+ *
+ * A dyld_cache_mapping_info entry.
+ */
+struct pl_dyld_cache_mapping {
+    /** The mapping's unslid address. */
+    uint64_t address;
+
+    /** The mapping's size. */
+    uint64_t size;
+
+    /** The mapping's file offset. */
+    uint64_t fileOffset;
+
+    /** Maximum VM protection. */
+    uint32_t maxProt;
+
+    /** Initial VM protection. */
+    uint32_t initProt;
+};
+
+/**
+ * Initialize @a cache with the dyld shared cache mapped within @a task.
+ *
+ * @param cache The shared cache record to be initialized.
+ * @param task The task from which the shared cache information will be read.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if the task's dyld does not publish the shared cache
+ * base address, PLCRASH_ENOTFOUND if no shared cache is mapped, or another error if the task's memory could not be
+ * read.
+ *
+ * @warning This function is async-safe.
+ */
+plcrash_error_t plcrash_async_shared_cache_init (plcrash_async_shared_cache_t *cache, task_t task) {
+    struct task_dyld_info dyld_info;
+    mach_msg_type_number_t count = TASK_DYLD_INFO_COUNT;
+    plcrash_error_t err;
+    uint64_t slide;
+    uint64_t base;
+
+    kern_return_t kt = task_info(task, TASK_DYLD_INFO, (task_info_t) &dyld_info, &count);
+    if (kt != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to fetch the task's dyld info: %d", kt);
+        return PLCRASH_ENOTSUP;
+    }
+
+    /* Fetch the shared cache fields from the target's dyld_all_image_infos */
+    if (dyld_info.all_image_info_format == TASK_DYLD_ALL_IMAGE_INFO_64) {
+        struct pl_dyld_all_image_infos_64 infos;
+        if ((err = plcrash_async_task_memcpy(task, (pl_vm_address_t) dyld_info.all_image_info_addr, 0, &infos, sizeof(infos))) != PLCRASH_ESUCCESS)
+            return err;
+
+        if (infos.version < PL_DYLD_ALL_IMAGE_INFOS_MIN_VERSION)
+            return PLCRASH_ENOTSUP;
+
+        slide = infos.sharedCacheSlide;
+        base = infos.sharedCacheBaseAddress;
+        memcpy(cache->uuid, infos.sharedCacheUUID, sizeof(cache->uuid));
+    } else {
+        struct pl_dyld_all_image_infos_32 infos;
+        if ((err = plcrash_async_task_memcpy(task, (pl_vm_address_t) dyld_info.all_image_info_addr, 0, &infos, sizeof(infos))) != PLCRASH_ESUCCESS)
+            return err;
+
+        if (infos.version < PL_DYLD_ALL_IMAGE_INFOS_MIN_VERSION)
+            return PLCRASH_ENOTSUP;
+
+        slide = infos.sharedCacheSlide;
+        base = infos.sharedCacheBaseAddress;
+        memcpy(cache->uuid, infos.sharedCacheUUID, sizeof(cache->uuid));
+    }
+
+    if (base == 0)
+        return PLCRASH_ENOTFOUND;
+
+    /* Determine the extent of the cache's mappings */
+    struct pl_dyld_cache_header header;
+    if ((err = plcrash_async_task_memcpy(task, (pl_vm_address_t) base, 0, &header, sizeof(header))) != PLCRASH_ESUCCESS)
+        return err;
+
+    if (plcrash_async_strncmp(header.magic, "dyld_v1", 7) != 0) {
+        PLCF_DEBUG("Unexpected shared cache magic at 0x%" PRIx64, base);
+        return PLCRASH_EINVAL;
+    }
+
+    uint64_t end = base;
+    uint64_t linkedit_address = 0;
+    uint64_t linkedit_size = 0;
+    uint32_t mappings = header.mappingCount;
+    if (mappings > PL_DYLD_CACHE_MAX_MAPPINGS)
+        mappings = PL_DYLD_CACHE_MAX_MAPPINGS;
+
+    for (uint32_t i = 0; i < mappings; i++) {
+        struct pl_dyld_cache_mapping mapping;
+        pl_vm_off_t offset = header.mappingOffset + (i * sizeof(mapping));
+
+        if ((err = plcrash_async_task_memcpy(task, (pl_vm_address_t) base, offset, &mapping, sizeof(mapping))) != PLCRASH_ESUCCESS)
+            return err;
+
+        if (mapping.address + slide + mapping.size > end)
+            end = mapping.address + slide + mapping.size;
+
+        /* The read-only mapping holds the LINKEDIT data of all cached images */
+        if (mapping.initProt == VM_PROT_READ) {
+            linkedit_address = mapping.address + slide;
+            linkedit_size = mapping.size;
+        }
+    }
+
+    cache->slide = (pl_vm_off_t) slide;
+    cache->base_address = (pl_vm_address_t) base;
+    cache->size = (pl_vm_size_t) (end - base);
+    cache->linkedit_address = (pl_vm_address_t) linkedit_address;
+    cache->linkedit_size = (pl_vm_size_t) linkedit_size;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Map the LINKEDIT region shared by all images loaded from @a cache, initializing @a mobj. The mapping may be
+ * supplied to plcrash_nasync_macho_set_shared_linkedit(), allowing the symbol tables of all cached images to be
+ * read without mapping each image's LINKEDIT segment individually.
+ *
+ * @param cache A shared cache initialized with plcrash_async_shared_cache_init().
+ * @param task The task in which @a cache is mapped.
+ * @param mobj The memory object to be initialized. It is the caller's responsibility to free @a mobj after a
+ * successful initialization.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the cache's LINKEDIT mapping is not known, or
+ * another error if the mapping could not be performed.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_nasync_shared_cache_map_linkedit (plcrash_async_shared_cache_t *cache, task_t task, plcrash_async_mobject_t *mobj) {
+    if (cache->linkedit_address == 0 || cache->linkedit_size == 0)
+        return PLCRASH_ENOTFOUND;
+
+    /* As with plcrash_async_macho_map_segment(), permit a shorter mapping; all reads are range-checked. */
+    return plcrash_async_mobject_init(mobj, task, cache->linkedit_address, cache->linkedit_size, false);
+}
+
+/**
+ * Return true if @a image was loaded from @a cache.
+ *
+ * @param cache A shared cache initialized with plcrash_async_shared_cache_init().
+ * @param image The image to test.
+ *
+ * @warning This function is async-safe.
+ */
+bool plcrash_async_shared_cache_contains_image (plcrash_async_shared_cache_t *cache, plcrash_async_macho_t *image) {
+    /* Newer releases of dyld mark cached images directly; this also covers images in split sub-caches, which
+     * fall outside of the primary cache's mappings. */
+    if (image->byteorder->swap32(image->header.flags) & PL_MH_DYLIB_IN_CACHE)
+        return true;
+
+    return (image->header_addr >= cache->base_address && image->header_addr - cache->base_address < cache->size);
+}
+
+/**
+ * @}
+ */
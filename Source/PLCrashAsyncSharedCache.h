@@ -0,0 +1,91 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_SHARED_CACHE_H
+#define PLCRASH_ASYNC_SHARED_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <uuid/uuid.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncMachOImage.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_shared_cache dyld Shared Cache Info
+ *
+ * Async-safe lookup of a task's dyld shared cache, used to identify the system library images that are
+ * mapped from the shared cache, and to map the LINKEDIT region shared by those images.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A task's mapped dyld shared cache.
+ */
+typedef struct plcrash_async_shared_cache {
+    /** The shared cache's UUID. */
+    uuid_t uuid;
+
+    /** The shared cache's slide; the difference between its mapped and preferred load addresses. */
+    pl_vm_off_t slide;
+
+    /** The shared cache's mapped base address. */
+    pl_vm_address_t base_address;
+
+    /** The size, in bytes, of the shared cache's mappings, starting at @a base_address. */
+    pl_vm_size_t size;
+
+    /** The mapped address of the cache's read-only mapping, which contains the single LINKEDIT region shared by all
+     * cached images, or 0 if not found. */
+    pl_vm_address_t linkedit_address;
+
+    /** The size, in bytes, of the read-only mapping at @a linkedit_address. */
+    pl_vm_size_t linkedit_size;
+} plcrash_async_shared_cache_t;
+
+plcrash_error_t plcrash_async_shared_cache_init (plcrash_async_shared_cache_t *cache, task_t task);
+plcrash_error_t plcrash_nasync_shared_cache_map_linkedit (plcrash_async_shared_cache_t *cache, task_t task, plcrash_async_mobject_t *mobj);
+bool plcrash_async_shared_cache_contains_image (plcrash_async_shared_cache_t *cache, plcrash_async_macho_t *image);
+
+/**
+ * @}
+ */
+    
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_SHARED_CACHE_H */
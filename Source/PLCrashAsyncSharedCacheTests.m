@@ -0,0 +1,110 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncSharedCache.h"
+
+#import <dlfcn.h>
+#import <mach-o/dyld.h>
+
+@interface PLCrashAsyncSharedCacheTests : SenTestCase {
+    /** The current task's shared cache. */
+    plcrash_async_shared_cache_t _cache;
+
+    /** True if the current task's shared cache was found. */
+    bool _found;
+}
+@end
+
+@implementation PLCrashAsyncSharedCacheTests
+
+- (void) setUp {
+    plcrash_error_t err = plcrash_async_shared_cache_init(&_cache, mach_task_self());
+    STAssertTrue(err == PLCRASH_ESUCCESS || err == PLCRASH_ENOTSUP || err == PLCRASH_ENOTFOUND, @"Unexpected error reading the shared cache: %d", err);
+    _found = (err == PLCRASH_ESUCCESS);
+}
+
+/**
+ * Test shared cache image membership.
+ */
+- (void) testContainsImage {
+    if (!_found)
+        return;
+
+    STAssertNotEquals(_cache.base_address, (pl_vm_address_t) 0, @"Shared cache base address was not set");
+    STAssertTrue(_cache.size > 0, @"Shared cache size was not set");
+
+    /* libSystem is always loaded from the shared cache */
+    Dl_info info;
+    STAssertTrue(dladdr((void *) &dladdr, &info) > 0, @"Could not fetch dyld info for dladdr()");
+
+    plcrash_async_macho_t image;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), @"Failed to initialize image");
+    STAssertTrue(plcrash_async_shared_cache_contains_image(&_cache, &image), @"System library not found in the shared cache");
+    plcrash_nasync_macho_free(&image);
+
+    /* Our own image is not */
+    STAssertTrue(dladdr([self class], &info) > 0, @"Could not fetch dyld info for %p", [self class]);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), @"Failed to initialize image");
+    STAssertFalse(plcrash_async_shared_cache_contains_image(&_cache, &image), @"Test image found in the shared cache");
+    plcrash_nasync_macho_free(&image);
+}
+
+/**
+ * Test symbol lookup via the shared LINKEDIT mapping.
+ */
+- (void) testSharedLinkedit {
+    if (!_found)
+        return;
+
+    plcrash_async_mobject_t linkedit;
+    plcrash_error_t err = plcrash_nasync_shared_cache_map_linkedit(&_cache, mach_task_self(), &linkedit);
+    if (err == PLCRASH_ENOTFOUND)
+        return;
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to map the shared LINKEDIT region");
+
+    Dl_info info;
+    STAssertTrue(dladdr((void *) &dladdr, &info) > 0, @"Could not fetch dyld info for dladdr()");
+
+    plcrash_async_macho_t image;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), @"Failed to initialize image");
+    STAssertTrue(plcrash_nasync_macho_set_shared_linkedit(&image, &linkedit), @"System library LINKEDIT not found in the shared mapping");
+
+    /* Symbol lookups must not require any additional mappings */
+    uint32_t maps = plcrash_async_mobject_map_count();
+    pl_vm_address_t pc;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_macho_find_symbol_by_name(&image, "_dladdr", &pc), @"Failed to look up dladdr()");
+    STAssertEquals((uintptr_t) pc, (uintptr_t) &dladdr, @"Incorrect symbol address");
+    STAssertEquals(plcrash_async_mobject_map_count() - maps, (uint32_t) 0, @"LINKEDIT was mapped separately");
+
+    plcrash_nasync_macho_free(&image);
+    plcrash_async_mobject_free(&linkedit);
+}
+
+@end
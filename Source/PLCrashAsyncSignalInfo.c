@@ -130,6 +130,9 @@ static struct signal_code signal_codes[] = {
     /* SIGABRT */
     { SIGABRT,  0,              "#0"          },
 
+    /* SIGKILL; used by synthesized termination reports */
+    { SIGKILL,  0,              "#0"          },
+
     { 0, 0, NULL }
 };
 #else
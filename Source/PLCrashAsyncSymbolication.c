@@ -27,6 +27,7 @@
  */
 
 #include "PLCrashAsyncSymbolication.h"
+#include "PLCrashFeatureConfig.h"
 
 #include <inttypes.h>
 
@@ -50,6 +51,33 @@ struct symbol_lookup_ctx {
     pl_vm_address_t symbol_address;
 };
 
+/**
+ * @internal
+ *
+ * A memoized PC lookup result.
+ */
+struct plcrash_async_symbol_memo_entry {
+    /** The PC value, or 0x0 if the entry is unused. */
+    pl_vm_address_t pc;
+
+    /** If true, the entry has been claimed by an in-progress batch lookup, and is not yet resolved. */
+    bool pending;
+
+    /** If true, a symbol was found for @a pc, and the remaining fields are valid. */
+    bool found;
+
+    /** Address of the discovered symbol. */
+    pl_vm_address_t symbol_address;
+
+    /** The NUL-terminated symbol name. */
+    char name[SYMBOL_NAME_BUFLEN];
+};
+
+/* Maximum number of slots probed by a memo lookup or insertion */
+#define SYMBOL_MEMO_PROBE_MAX 8
+
+PLCF_ASSERT_STATIC(symbol_memo_size_pow2, (PLCRASH_ASYNC_SYMBOL_MEMO_SIZE & (PLCRASH_ASYNC_SYMBOL_MEMO_SIZE - 1)) == 0);
+
 static void macho_symbol_callback (pl_vm_address_t address, const char *name, void *ctx);
 static void objc_symbol_callback (bool isClassMethod, plcrash_async_macho_string_t *className, plcrash_async_macho_string_t *methodName, pl_vm_address_t imp, void *ctx);
 
@@ -60,6 +88,10 @@ static void objc_symbol_callback (bool isClassMethod, plcrash_async_macho_string
  * @return An error code.
  */
 plcrash_error_t plcrash_async_symbol_cache_init (plcrash_async_symbol_cache_t *cache) {
+    cache->memo = NULL;
+    cache->memo_strategy = PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE;
+    cache->memo_failed = false;
+
     return plcrash_async_objc_cache_init(&cache->objc_cache);
 }
 
@@ -70,6 +102,113 @@ plcrash_error_t plcrash_async_symbol_cache_init (plcrash_async_symbol_cache_t *c
  */
 void plcrash_async_symbol_cache_free (plcrash_async_symbol_cache_t *cache) {
     plcrash_async_objc_cache_free(&cache->objc_cache);
+
+    if (cache->memo != NULL)
+        vm_deallocate(mach_task_self(), (vm_address_t) cache->memo, PLCRASH_ASYNC_SYMBOL_MEMO_SIZE * sizeof(cache->memo[0]));
+}
+
+/**
+ * @internal
+ *
+ * Return the memo table of @a cache for lookups using @a strategy, allocating it if necessary. Returns NULL if the
+ * table is unavailable, or was populated using a different strategy.
+ */
+static struct plcrash_async_symbol_memo_entry *symbol_memo_table (plcrash_async_symbol_cache_t *cache, plcrash_async_symbol_strategy_t strategy) {
+    if (cache == NULL)
+        return NULL;
+
+    if (cache->memo == NULL) {
+        if (cache->memo_failed)
+            return NULL;
+
+        /* vm_allocate() is async-safe, and returns zero-filled memory; only the pages touched are populated. */
+        vm_address_t addr = 0;
+        kern_return_t kr = vm_allocate(mach_task_self(), &addr, PLCRASH_ASYNC_SYMBOL_MEMO_SIZE * sizeof(cache->memo[0]), VM_FLAGS_ANYWHERE);
+        if (kr != KERN_SUCCESS) {
+            PLCF_DEBUG("vm_allocate failed with error %x, symbol lookups will not be memoized", kr);
+            cache->memo_failed = true;
+            return NULL;
+        }
+
+        cache->memo = (struct plcrash_async_symbol_memo_entry *) addr;
+        cache->memo_strategy = strategy;
+    }
+
+    if (cache->memo_strategy != strategy)
+        return NULL;
+
+    return cache->memo;
+}
+
+/**
+ * @internal
+ *
+ * Find the memo entry for @a pc in @a memo. If no entry exists and @a insert is true, an unused entry will be claimed
+ * for @a pc and returned, marked as pending.
+ *
+ * @return Returns the entry, or NULL if no entry exists and none could be claimed.
+ */
+static struct plcrash_async_symbol_memo_entry *symbol_memo_find (struct plcrash_async_symbol_memo_entry *memo, pl_vm_address_t pc, bool insert) {
+    if (memo == NULL || pc == 0x0)
+        return NULL;
+
+    size_t slot = (size_t) (((uint64_t) pc >> 2) * 2654435761ULL) & (PLCRASH_ASYNC_SYMBOL_MEMO_SIZE - 1);
+    for (size_t probe = 0; probe < SYMBOL_MEMO_PROBE_MAX; probe++) {
+        struct plcrash_async_symbol_memo_entry *entry = &memo[(slot + probe) & (PLCRASH_ASYNC_SYMBOL_MEMO_SIZE - 1)];
+        if (entry->pc == pc)
+            return entry;
+
+        if (entry->pc == 0x0) {
+            if (!insert)
+                return NULL;
+
+            entry->pc = pc;
+            entry->pending = true;
+            entry->found = false;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Record the symbol lookup result for @a entry, if non-NULL.
+ */
+static void symbol_memo_set (struct plcrash_async_symbol_memo_entry *entry, pl_vm_address_t address, const char *name) {
+    if (entry == NULL)
+        return;
+
+    size_t i;
+    for (i = 0; i < sizeof(entry->name) - 1 && name[i] != '\0'; i++)
+        entry->name[i] = name[i];
+    entry->name[i] = '\0';
+
+    entry->symbol_address = address;
+    entry->found = true;
+}
+
+/**
+ * @internal
+ *
+ * Return @a strategy, excluding any strategies that can't succeed for @a image given its symbolication
+ * capabilities (see plcrash_async_macho_capability_t).
+ */
+static plcrash_async_symbol_strategy_t symbol_strategy_for_image (plcrash_async_macho_t *image, plcrash_async_symbol_strategy_t strategy) {
+    if ((image->capabilities & PLCRASH_ASYNC_MACHO_CAPABILITY_SYMTAB) == 0)
+        strategy &= ~PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE;
+
+    if ((image->capabilities & PLCRASH_ASYNC_MACHO_CAPABILITY_OBJC) == 0)
+        strategy &= ~PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC;
+
+#if !PLCRASH_FEATURE_SYMBOLICATE_OBJC
+    /* The Objective-C metadata parser is excluded from this build */
+    strategy &= ~PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC;
+#endif
+
+    return strategy;
 }
 
 /**
@@ -96,9 +235,25 @@ plcrash_error_t plcrash_async_find_symbol (plcrash_async_macho_t *image,
     plcrash_error_t machoErr = PLCRASH_ENOTFOUND;
     plcrash_error_t objcErr = PLCRASH_ENOTFOUND;
 
+    /* Check for a memoized result */
+    struct plcrash_async_symbol_memo_entry *memo = symbol_memo_table(cache, strategy);
+    struct plcrash_async_symbol_memo_entry *entry = symbol_memo_find(memo, pc, false);
+    if (entry != NULL) {
+        if (!entry->found)
+            return PLCRASH_ENOTFOUND;
+
+        callback(entry->symbol_address, entry->name, ctx);
+        return PLCRASH_ESUCCESS;
+    }
+    if ((entry = symbol_memo_find(memo, pc, true)) != NULL)
+        entry->pending = false;
+
     lookup_ctx.symbol_address = 0x0;
     lookup_ctx.found = false;
 
+    /* Skip any strategies that can't succeed for this image */
+    strategy = symbol_strategy_for_image(image, strategy);
+
     /* Perform lookups; our callbacks will only update the lookup_ctx if they find a better match than the
      * previously run callbacks */
     if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE)
@@ -120,10 +275,162 @@ plcrash_error_t plcrash_async_find_symbol (plcrash_async_macho_t *image,
         return PLCRASH_EINTERNAL;
     }
 
+    symbol_memo_set(entry, lookup_ctx.symbol_address, lookup_ctx.buffer);
     callback(lookup_ctx.symbol_address, lookup_ctx.buffer, ctx);
     return PLCRASH_ESUCCESS;
 }
 
+/* Maximum number of PC values for which plcrash_async_find_symbols() will perform a single batched lookup */
+#define SYMBOL_BATCH_MAX 64
+
+/* Batched lookup state used by plcrash_async_find_symbols() */
+struct symbol_batch_ctx {
+    /** The PC values to be resolved by this batch; memoized PCs are excluded. */
+    pl_vm_address_t pcs[SYMBOL_BATCH_MAX];
+
+    /** The caller's index for each PC in this batch. */
+    size_t index[SYMBOL_BATCH_MAX];
+
+    /** The memo entry to be populated for each PC in this batch, or NULL if the result will not be memoized. */
+    struct plcrash_async_symbol_memo_entry *entry[SYMBOL_BATCH_MAX];
+
+    /** Address of the discovered symbol table symbol, by PC. */
+    pl_vm_address_t symbol_address[SYMBOL_BATCH_MAX];
+
+    /** If true, a symbol table symbol was found, by PC. */
+    bool found[SYMBOL_BATCH_MAX];
+
+    /** The caller's callback. */
+    plcrash_async_found_symbols_cb callback;
+
+    /** The caller's callback context. */
+    void *ctx;
+};
+
+static void macho_batch_symbol_callback (size_t index, pl_vm_address_t address, const char *name, void *ctx);
+
+/**
+ * Find the best-guess matching symbol names for all of @a pcs, using the same heuristics as plcrash_async_find_symbol(). The
+ * symbol table is searched once for each batch of PC values, rather than once per PC.
+ *
+ * Results are memoized in @a cache; PCs resolved by an earlier lookup using the same cache are reported directly from the
+ * memoized result, and are not searched again.
+ *
+ * @param image The Mach-O image to search for these symbols.
+ * @param strategy The look-up strategy to be used to find the symbols.
+ * @param cache The task-specific cache to use for lookups.
+ * @param pcs The program counter (instruction pointer) addresses for which symbols will be searched. The values must be sorted
+ * in ascending order.
+ * @param count The number of values in @a pcs.
+ * @param callback The callback to be issued when a matching symbol is found. The callback may be called more than once for
+ * the same PC if a better match is found by a later lookup strategy; the last call always provides the best match. If no symbol is found
+ * for a PC, the callback will not be called for that PC.
+ * @param ctx The context to be provided to @a callback.
+ *
+ * @return Returns PLCRASH_ESUCCESS if a matching symbol is found for at least one PC. Otherwise, returns one of the other defined
+ * plcrash_error_t error values.
+ */
+plcrash_error_t plcrash_async_find_symbols (plcrash_async_macho_t *image,
+                                            plcrash_async_symbol_strategy_t strategy,
+                                            plcrash_async_symbol_cache_t *cache,
+                                            const pl_vm_address_t *pcs,
+                                            size_t count,
+                                            plcrash_async_found_symbols_cb callback,
+                                            void *ctx)
+{
+    struct symbol_batch_ctx batch_ctx;
+    struct plcrash_async_symbol_memo_entry *memo = symbol_memo_table(cache, strategy);
+    plcrash_error_t machoErr = PLCRASH_ENOTFOUND;
+    bool found = false;
+
+    batch_ctx.callback = callback;
+    batch_ctx.ctx = ctx;
+
+    /* Skip any strategies that can't succeed for this image. The memo table is selected by the caller's strategy. */
+    strategy = symbol_strategy_for_image(image, strategy);
+
+    size_t next = 0;
+    while (next < count) {
+        /* Gather the next batch, reporting memoized results directly */
+        size_t batch_count = 0;
+        for (; next < count && batch_count < SYMBOL_BATCH_MAX; next++) {
+            struct plcrash_async_symbol_memo_entry *entry = symbol_memo_find(memo, pcs[next], true);
+            if (entry != NULL && !entry->pending) {
+                if (entry->found) {
+                    callback(next, entry->symbol_address, entry->name, ctx);
+                    found = true;
+                }
+                continue;
+            }
+
+            batch_ctx.pcs[batch_count] = pcs[next];
+            batch_ctx.index[batch_count] = next;
+            batch_ctx.entry[batch_count] = entry;
+            batch_ctx.found[batch_count] = false;
+            batch_count++;
+        }
+
+        if (batch_count == 0)
+            continue;
+
+        /* Perform the symbol table lookups in a single pass; our callback reports all results directly */
+        if (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE) {
+            machoErr = plcrash_async_macho_find_symbols_by_pc(image, batch_ctx.pcs, batch_count, macho_batch_symbol_callback, &batch_ctx);
+            if (machoErr == PLCRASH_ESUCCESS)
+                found = true;
+        }
+
+        /* Perform the Objective-C lookups, reporting any that are a better match than the symbol table results */
+        for (size_t i = 0; i < batch_count && (strategy & PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC); i++) {
+            struct symbol_lookup_ctx lookup_ctx;
+            lookup_ctx.symbol_address = 0x0;
+            lookup_ctx.found = false;
+
+            if (plcrash_async_objc_find_method(image, &cache->objc_cache, batch_ctx.pcs[i], objc_symbol_callback, &lookup_ctx) != PLCRASH_ESUCCESS)
+                continue;
+
+            /* Our callback could have errored out, in which case it would have logged a debug message, not set 'found' */
+            if (!lookup_ctx.found)
+                continue;
+
+            if (batch_ctx.found[i] && lookup_ctx.symbol_address < batch_ctx.symbol_address[i])
+                continue;
+
+            symbol_memo_set(batch_ctx.entry[i], lookup_ctx.symbol_address, lookup_ctx.buffer);
+            callback(batch_ctx.index[i], lookup_ctx.symbol_address, lookup_ctx.buffer, ctx);
+            found = true;
+        }
+
+        /* The batch's memo entries are now resolved; PCs for which no symbol was found are memoized as negative results */
+        for (size_t i = 0; i < batch_count; i++) {
+            if (batch_ctx.entry[i] != NULL)
+                batch_ctx.entry[i]->pending = false;
+        }
+    }
+
+    if (!found) {
+        PLCF_DEBUG("Could not find symbols for %zu PCs in image %p", count, image);
+        return machoErr;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Record the Mach-O symbol address in the symbol_batch_ctx @a ctx, and report the symbol to the batch caller.
+ */
+static void macho_batch_symbol_callback (size_t index, pl_vm_address_t address, const char *name, void *ctx) {
+    struct symbol_batch_ctx *batch_ctx = ctx;
+
+    batch_ctx->symbol_address[index] = address;
+    batch_ctx->found[index] = true;
+
+    symbol_memo_set(batch_ctx->entry[index], address, name);
+    batch_ctx->callback(batch_ctx->index[index], address, name, batch_ctx->ctx);
+}
+
 /**
  * Append a character to the given @a str, enforcing byte @a limit.
  *
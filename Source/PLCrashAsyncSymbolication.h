@@ -78,18 +78,39 @@ typedef enum {
     PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL = (PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE|PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC)
 } plcrash_async_symbol_strategy_t;
 
+/**
+ * @internal
+ *
+ * The number of PC values memoized by a plcrash_async_symbol_cache_t. Must be a power of two.
+ */
+#define PLCRASH_ASYNC_SYMBOL_MEMO_SIZE 512
+
 /**
  * @internal
  *
  * Context object that helps speed up repeated symbol lookups.
  *
- * @warning It is invalid to reuse this context for multiple Mach tasks.
+ * In addition to the Objective-C cache, the result of each PC lookup is memoized, such that frames shared across
+ * threads (eg, mach_msg_trap, or a thread's start routine) are only symbolicated once for the lifetime of the cache.
+ *
+ * @warning It is invalid to reuse this context for multiple Mach tasks, or to reuse it after any image referenced
+ * by a previous lookup has been unloaded.
  * @warning Any plcrash_async_macho_t pointers passed in must be valid across all
  * calls using this context.
  */
 typedef struct plcrash_async_symbol_cache {
     /** Objective-C look-up cache. */
     plcrash_async_objc_cache_t objc_cache;
+
+    /** PC lookup results, allocated on first use; an open-addressed, linearly probed table of
+     * PLCRASH_ASYNC_SYMBOL_MEMO_SIZE entries. NULL if not yet allocated, or if allocation failed. */
+    struct plcrash_async_symbol_memo_entry *memo;
+
+    /** The lookup strategy with which all @a memo entries were resolved. */
+    plcrash_async_symbol_strategy_t memo_strategy;
+
+    /** If true, allocation of @a memo failed, and will not be retried. */
+    bool memo_failed;
 } plcrash_async_symbol_cache_t;
 
 plcrash_error_t plcrash_async_symbol_cache_init (plcrash_async_symbol_cache_t *cache);
@@ -112,6 +133,25 @@ plcrash_error_t plcrash_async_find_symbol(plcrash_async_macho_t *image,
                                           pl_vm_address_t pc,
                                           plcrash_async_found_symbol_cb callback,
                                           void *ctx);
+
+/**
+ * Prototype of a callback function used to return symbols found by plcrash_async_find_symbols().
+ *
+ * @param index The index of the PC value for which the symbol was found.
+ * @param address The symbol address.
+ * @param name The symbol name. The callback is responsible for copying this value, as its backing storage is not gauranteed to exist
+ * after the callback returns.
+ * @param context The API client's supplied context value.
+ */
+typedef void (*plcrash_async_found_symbols_cb)(size_t index, pl_vm_address_t address, const char *name, void *ctx);
+
+plcrash_error_t plcrash_async_find_symbols(plcrash_async_macho_t *image,
+                                           plcrash_async_symbol_strategy_t strategy,
+                                           plcrash_async_symbol_cache_t *cache,
+                                           const pl_vm_address_t *pcs,
+                                           size_t count,
+                                           plcrash_async_found_symbols_cb callback,
+                                           void *ctx);
     
 #ifdef __cplusplus
 }
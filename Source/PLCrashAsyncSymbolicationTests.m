@@ -115,6 +115,84 @@ void PLCrashAsyncLocalSymbolicationTestsDummyFunction(void) {}
     plcrash_async_symbol_cache_free(&findContext);
 }
 
+static void testFindSymbols_cb (size_t index, pl_vm_address_t address, const char *name, void *ctx) {
+    struct testFindSymbol_cb_ctx *cb_ctx = ctx;
+    testFindSymbol_cb(address, name, &cb_ctx[index]);
+}
+
+- (void) testFindSymbols {
+    plcrash_error_t err;
+    
+    plcrash_async_symbol_cache_t findContext;
+    err = plcrash_async_symbol_cache_init(&findContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_local_find_symbol_context_init failed (that should not be possible, how did you do that?)");
+
+    /* Look up a C function and an Obj-C method, including a duplicate PC */
+    pl_vm_address_t cPC = (pl_vm_address_t)PLCrashAsyncLocalSymbolicationTestsDummyFunction;
+    pl_vm_address_t localPC = [[[NSThread callStackReturnAddresses] objectAtIndex: 0] longLongValue];
+    pl_vm_address_t pcs[] = { MIN(cPC, localPC), MIN(cPC, localPC), MAX(cPC, localPC) };
+    struct testFindSymbol_cb_ctx ctx[3] = {};
+
+    err = plcrash_async_find_symbols(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs, 3, testFindSymbols_cb, ctx);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbols");
+
+    /* Compare against single lookups */
+    for (size_t i = 0; i < 3; i++) {
+        struct testFindSymbol_cb_ctx expected = {};
+        err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs[i], testFindSymbol_cb, &expected);
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+
+        STAssertNotNULL(ctx[i].name, @"No symbol found for PC %zu", i);
+        STAssertEquals(ctx[i].addr, expected.addr, @"Got bad address finding symbol %zu", i);
+        STAssertEqualCStrings(ctx[i].name, expected.name, @"Got wrong symbol name for %zu", i);
+    }
+
+    STAssertEqualCStrings(ctx[cPC < localPC ? 0 : 2].name, "_PLCrashAsyncLocalSymbolicationTestsDummyFunction", @"Got wrong symbol name");
+    STAssertEqualCStrings(ctx[cPC < localPC ? 2 : 0].name, "-[PLCrashAsyncSymbolicationTests testFindSymbols]", @"Got wrong symbol name");
+
+    plcrash_async_symbol_cache_free(&findContext);
+}
+
+/**
+ * Verify that repeated lookups are served from the cache's PC memo, and produce the same results.
+ */
+- (void) testFindSymbolsMemoized {
+    plcrash_error_t err;
+
+    plcrash_async_symbol_cache_t findContext;
+    err = plcrash_async_symbol_cache_init(&findContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_local_find_symbol_context_init failed (that should not be possible, how did you do that?)");
+    STAssertNULL(findContext.memo, @"Memo table should be lazily allocated");
+
+    pl_vm_address_t cPC = (pl_vm_address_t)PLCrashAsyncLocalSymbolicationTestsDummyFunction;
+    pl_vm_address_t localPC = [[[NSThread callStackReturnAddresses] objectAtIndex: 0] longLongValue];
+    pl_vm_address_t pcs[] = { MIN(cPC, localPC), MAX(cPC, localPC) };
+    struct testFindSymbol_cb_ctx first[2] = {};
+    struct testFindSymbol_cb_ctx second[2] = {};
+
+    err = plcrash_async_find_symbols(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs, 2, testFindSymbols_cb, first);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbols");
+    STAssertNotNULL(findContext.memo, @"Memo table was not allocated");
+
+    /* Repeat the lookup; the results must match the initial lookup */
+    err = plcrash_async_find_symbols(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs, 2, testFindSymbols_cb, second);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find memoized symbols");
+
+    for (size_t i = 0; i < 2; i++) {
+        STAssertNotNULL(second[i].name, @"No memoized symbol found for PC %zu", i);
+        STAssertEquals(second[i].addr, first[i].addr, @"Got bad memoized address for %zu", i);
+        STAssertEqualCStrings(second[i].name, first[i].name, @"Got wrong memoized symbol name for %zu", i);
+
+        /* Single lookups share the same memo */
+        struct testFindSymbol_cb_ctx single = {};
+        err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, pcs[i], testFindSymbol_cb, &single);
+        STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find memoized symbol");
+        STAssertEqualCStrings(single.name, first[i].name, @"Got wrong memoized symbol name for %zu", i);
+    }
+
+    plcrash_async_symbol_cache_free(&findContext);
+}
+
 - (void) testStrategyFlags {
     struct testFindSymbol_cb_ctx ctx = {};
     plcrash_error_t err;
@@ -144,4 +222,32 @@ void PLCrashAsyncLocalSymbolicationTestsDummyFunction(void) {}
     STAssertEqualCStrings(ctx.name, "_PLCrashAsyncLocalSymbolicationTestsDummyFunction", @"Got wrong symbol name");
 }
 
+/**
+ * Verify that strategies the image lacks the capabilities for are skipped.
+ */
+- (void) testCapabilitySkipsStrategy {
+    struct testFindSymbol_cb_ctx ctx = {};
+    plcrash_error_t err;
+
+    plcrash_async_symbol_cache_t findContext;
+    err = plcrash_async_symbol_cache_init(&findContext);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"pl_async_local_find_symbol_context_init failed (that should not be possible, how did you do that?)");
+
+    /* Clear the symbol table capability; symbol table lookups must not be attempted */
+    uint32_t capabilities = _image.capabilities;
+    _image.capabilities &= ~PLCRASH_ASYNC_MACHO_CAPABILITY_SYMTAB;
+
+    err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE, &findContext, (pl_vm_address_t)PLCrashAsyncLocalSymbolicationTestsDummyFunction, testFindSymbol_cb, &ctx);
+    STAssertEquals(err, PLCRASH_ENOTFOUND, @"Symbol table lookup should have been skipped");
+
+    /* Strategies the image does support are unaffected */
+    pl_vm_address_t localPC = [[[NSThread callStackReturnAddresses] objectAtIndex: 0] longLongValue];
+    err = plcrash_async_find_symbol(&_image, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &findContext, localPC, testFindSymbol_cb, &ctx);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Got error trying to find symbol");
+    STAssertEqualCStrings(ctx.name, "-[PLCrashAsyncSymbolicationTests testCapabilitySkipsStrategy]", @"Got wrong symbol name");
+
+    _image.capabilities = capabilities;
+    plcrash_async_symbol_cache_free(&findContext);
+}
+
 @end
@@ -28,9 +28,13 @@
 
 #import "GTMSenTestCase.h"
 #import "PLCrashAsync.h"
+#import "PLCrashAsyncLZ4.h"
+#import "PLCrashAsyncCRC32C.h"
 
 #import <fcntl.h>
 #import <sys/stat.h>
+#import <sys/mman.h>
+#import <libkern/OSByteOrder.h>
 
 @interface PLCrashAsyncTests : SenTestCase {
 @private
@@ -77,6 +81,27 @@
     }
 }
 
+/* Custom swap functions, used to verify that non-standard byte orders are still applied via their function pointers */
+static uint16_t test_swap16 (uint16_t v) { return v + 1; }
+static uint32_t test_swap32 (uint32_t v) { return v + 1; }
+static uint64_t test_swap64 (uint64_t v) { return v + 1; }
+
+- (void) testByteOrderSwap {
+    const plcrash_async_byteorder_t custom = { .swap16 = test_swap16, .swap32 = test_swap32, .swap64 = test_swap64 };
+
+    STAssertEquals(plcrash_async_byteorder_swap16(&plcrash_async_byteorder_direct, (uint16_t) 0x0102), (uint16_t) 0x0102, @"Incorrect value");
+    STAssertEquals(plcrash_async_byteorder_swap32(&plcrash_async_byteorder_direct, (uint32_t) 0x01020304), (uint32_t) 0x01020304, @"Incorrect value");
+    STAssertEquals(plcrash_async_byteorder_swap64(&plcrash_async_byteorder_direct, (uint64_t) 0x0102030405060708ULL), (uint64_t) 0x0102030405060708ULL, @"Incorrect value");
+
+    STAssertEquals(plcrash_async_byteorder_swap16(&plcrash_async_byteorder_swapped, (uint16_t) 0x0102), (uint16_t) 0x0201, @"Incorrect value");
+    STAssertEquals(plcrash_async_byteorder_swap32(&plcrash_async_byteorder_swapped, (uint32_t) 0x01020304), (uint32_t) 0x04030201, @"Incorrect value");
+    STAssertEquals(plcrash_async_byteorder_swap64(&plcrash_async_byteorder_swapped, (uint64_t) 0x0102030405060708ULL), (uint64_t) 0x0807060504030201ULL, @"Incorrect value");
+
+    STAssertEquals(plcrash_async_byteorder_swap16(&custom, (uint16_t) 1), (uint16_t) 2, @"Custom swap function was not used");
+    STAssertEquals(plcrash_async_byteorder_swap32(&custom, (uint32_t) 1), (uint32_t) 2, @"Custom swap function was not used");
+    STAssertEquals(plcrash_async_byteorder_swap64(&custom, (uint64_t) 1), (uint64_t) 2, @"Custom swap function was not used");
+}
+
 - (void) test_readAddr {
     const char bytes[] = "Hello";
     char dest[sizeof(bytes)];
@@ -157,6 +182,46 @@
     STAssertTrue(plcrash_async_strcmp("s", "longer") != 0, @"");
 }
 
+- (void) testStrlen {
+    STAssertEquals((size_t) 0, plcrash_async_strlen(""), @"Incorrect length");
+    STAssertEquals((size_t) 2, plcrash_async_strlen("s1"), @"Incorrect length");
+
+    /* Verify all alignments and lengths spanning multiple words */
+    char buffer[64];
+    for (size_t offset = 0; offset < 16; offset++) {
+        for (size_t length = 0; length < 32; length++) {
+            memset(buffer, 'A', sizeof(buffer));
+            buffer[offset + length] = '\0';
+            STAssertEquals(length, plcrash_async_strlen(buffer + offset), @"Incorrect length at offset %zu", offset);
+        }
+    }
+}
+
+- (void) testStrcmpAlignment {
+    char s1[64];
+    char s2[64];
+
+    /* Compare strings at all relative alignments, with a mismatch at every position */
+    for (size_t o1 = 0; o1 < 16; o1++) {
+        for (size_t o2 = 0; o2 < 16; o2++) {
+            for (size_t pos = 0; pos < 24; pos++) {
+                memset(s1, 'A', sizeof(s1));
+                memset(s2, 'A', sizeof(s2));
+                s1[o1 + 24] = '\0';
+                s2[o2 + 24] = '\0';
+
+                STAssertEquals(0, plcrash_async_strcmp(s1 + o1, s2 + o2), @"Strings should be equal");
+                STAssertEquals(0, plcrash_async_strncmp(s1 + o1, s2 + o2, 24), @"Strings should be equal");
+
+                s2[o2 + pos] = 'B';
+                STAssertTrue(plcrash_async_strcmp(s1 + o1, s2 + o2) < 0, @"Strings compared incorrectly");
+                STAssertTrue(plcrash_async_strncmp(s1 + o1, s2 + o2, pos + 1) < 0, @"Strings compared incorrectly");
+                STAssertEquals(0, plcrash_async_strncmp(s1 + o1, s2 + o2, pos), @"String prefixes should be equal");
+            }
+        }
+    }
+}
+
 - (void) testStrncmp {
     STAssertEquals(0, plcrash_async_strncmp("s1", "s1", 42), @"Strings should be equal");
     STAssertTrue(plcrash_async_strncmp("s1", "s2", 42) < 0, @"Strings compared incorrectly");
@@ -193,6 +258,28 @@
     STAssertTrue(dest[1024] == (uint8_t)0xB, @"Sentinal was overwritten (0x%" PRIX8 ")", dest[1024]);
 }
 
+- (void) testMemcpyAlignment {
+    uint8_t src[64];
+    uint8_t dest[64];
+
+    for (size_t i = 0; i < sizeof(src); i++)
+        src[i] = (uint8_t) i;
+
+    /* Copy at all relative alignments and a range of lengths, verifying that no adjacent bytes are written */
+    for (size_t so = 0; so < 16; so++) {
+        for (size_t doff = 0; doff < 16; doff++) {
+            for (size_t len = 0; len < 32; len++) {
+                memset(dest, 0xFF, sizeof(dest));
+                plcrash_async_memcpy(dest + doff, src + so, len);
+
+                STAssertTrue(memcmp(dest + doff, src + so, len) == 0, @"The copied destination does not match the source");
+                STAssertTrue(doff == 0 || dest[doff - 1] == 0xFF, @"Leading sentinal was overwritten");
+                STAssertTrue(dest[doff + len] == 0xFF, @"Trailing sentinal was overwritten");
+            }
+        }
+    }
+}
+
 - (void) testMemset {
     size_t size = 1024;
     uint8_t template[size];
@@ -257,7 +344,7 @@
     unsigned char data[100];
     size_t nread = 0;
     
-    STAssertTrue(sizeof(data) * write_iterations > sizeof(file.buffer), @"Test is invalid if our buffer is not larger");
+    STAssertTrue(sizeof(data) * write_iterations > PLCRASH_ASYNC_FILE_DEFAULT_BUFFER_SIZE, @"Test is invalid if our buffer is not larger");
 
     /* Initialize the file instance */
     plcrash_async_file_init(&file, _testFd, 0);
@@ -287,4 +374,214 @@
     [input close];
 }
 
+- (void) testBufferedWriteCustomBuffer {
+    plcrash_async_file_t file;
+    unsigned char buffer[64];
+    unsigned char data[100];
+    size_t nread = 0;
+
+    /* Initialize the file instance with a buffer smaller than our writes */
+    plcrash_async_file_init_buffer(&file, _testFd, 0, buffer, sizeof(buffer));
+    STAssertEquals(file.bufsize, sizeof(buffer), @"Incorrect buffer size");
+
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    /* Mix small (buffered, topping off the buffer) and large (unbuffered) writes */
+    STAssertTrue(plcrash_async_file_write(&file, data, 10), @"Failed to write to output buffer");
+    STAssertTrue(plcrash_async_file_write(&file, data + 10, sizeof(data) - 10), @"Failed to write to output buffer");
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to output buffer");
+    STAssertEquals(plcrash_async_file_tell(&file), (off_t) sizeof(data) * 2, @"Incorrect output position");
+
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+    
+    /* Validate the test file */
+    NSInputStream *input = [NSInputStream inputStreamWithFileAtPath: _outputFile];
+    [input open];
+    STAssertEquals((NSStreamStatus)NSStreamStatusOpen, [input streamStatus], @"Could not open input stream %@: %@", _outputFile, [input streamError]);
+
+    for (int i = 0; i < 2; i++)
+        nread += [self checkTestData: data bytes: sizeof(data) inputStream: input];
+
+    STAssertEquals(nread, sizeof(data) * 2, @"Fewer than expected bytes were written (%zu < %zu)", nread, sizeof(data) * 2);
+    
+    [input close];
+}
+
+- (void) testMappedWrite {
+    plcrash_async_file_t file;
+    unsigned char data[100];
+    unsigned char patch[] = { 0xC, 0xA, 0xF, 0xE };
+    size_t size = PAGE_SIZE;
+
+    /* Size and map the output file */
+    STAssertEquals(ftruncate(_testFd, size), 0, @"Failed to size the output file");
+    void *mapping = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, _testFd, 0);
+    STAssertTrue(mapping != MAP_FAILED, @"Failed to map the output file");
+
+    plcrash_async_file_init_mapped(&file, _testFd, mapping, size);
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    /* Write and patch the output */
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to mapped output");
+    STAssertTrue(plcrash_async_file_pwrite(&file, 10, patch, sizeof(patch)), @"Failed to patch mapped data");
+
+    /* Writes beyond the mapping must fail */
+    STAssertFalse(plcrash_async_file_write(&file, mapping, size), @"Write beyond the mapping was permitted");
+
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+    munmap(mapping, size);
+
+    /* Validate the test file; it should have been truncated to the written length */
+    NSData *written = [NSData dataWithContentsOfFile: _outputFile];
+    STAssertEquals([written length], sizeof(data) * 4, @"Incorrect file size");
+
+    const unsigned char *bytes = [written bytes];
+    STAssertTrue(memcmp(bytes, data, 10) == 0, @"Incorrect data written");
+    STAssertTrue(memcmp(bytes + 10, patch, sizeof(patch)) == 0, @"Mapped data was not patched");
+    STAssertTrue(memcmp(bytes + sizeof(data), data, sizeof(data)) == 0, @"Incorrect data written");
+}
+
+- (void) testMemoryWrite {
+    plcrash_async_file_t file;
+    unsigned char buffer[256];
+    unsigned char data[100];
+    unsigned char patch[] = { 0xC, 0xA, 0xF, 0xE };
+
+    plcrash_async_file_init_memory(&file, buffer, sizeof(buffer));
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    /* Write and patch the output */
+    for (int i = 0; i < 2; i++)
+        STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to memory output");
+    STAssertTrue(plcrash_async_file_pwrite(&file, 10, patch, sizeof(patch)), @"Failed to patch memory output");
+
+    /* Writes beyond the buffer must fail */
+    STAssertFalse(plcrash_async_file_write(&file, data, sizeof(data)), @"Write beyond the buffer was permitted");
+    STAssertEquals(plcrash_async_file_tell(&file), (off_t) (sizeof(data) * 2), @"Incorrect output position");
+
+    /* Flush and close are no-ops */
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File close failed");
+
+    STAssertTrue(memcmp(buffer, data, 10) == 0, @"Incorrect data written");
+    STAssertTrue(memcmp(buffer + 10, patch, sizeof(patch)) == 0, @"Memory output was not patched");
+    STAssertTrue(memcmp(buffer + sizeof(data), data, sizeof(data)) == 0, @"Incorrect data written");
+}
+
+- (void) testCompressMemoryOutput {
+    plcrash_async_file_t file;
+    plcrash_async_lz4_state_t state;
+    unsigned char buffer[512];
+    unsigned char scratch[sizeof(buffer) + 32];
+    unsigned char data[100];
+    unsigned char decompressed[400];
+    size_t decompressed_length;
+
+    STAssertTrue(plcrash_async_lz4_bound(400) + 4 <= sizeof(scratch), @"Test is invalid if the scratch buffer is too small");
+
+    plcrash_async_file_init_memory(&file, buffer, sizeof(buffer));
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    STAssertTrue(plcrash_async_file_write(&file, "HDR", 3), @"Failed to write to memory output");
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to memory output");
+
+    /* Compress everything following the header */
+    STAssertTrue(plcrash_async_file_compress(&file, 3, &state, scratch, sizeof(scratch)), @"Output was not compressed");
+    off_t length = plcrash_async_file_tell(&file);
+    STAssertTrue(length < 3 + 400, @"Output was not reduced in size");
+
+    STAssertTrue(memcmp(buffer, "HDR", 3) == 0, @"Uncompressed prefix was modified");
+    STAssertEquals(OSReadLittleInt32(buffer, 3), (uint32_t) 400, @"Incorrect uncompressed length");
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_lz4_decompress(buffer + 7, (size_t) length - 7, decompressed, sizeof(decompressed), &decompressed_length), @"Failed to decompress output");
+    STAssertEquals(decompressed_length, (size_t) 400, @"Incorrect decompressed length");
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(memcmp(decompressed + (i * sizeof(data)), data, sizeof(data)) == 0, @"Incorrect decompressed data");
+
+    /* Buffered output can't be compressed */
+    plcrash_async_file_init(&file, _testFd, 0);
+    STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to output buffer");
+    STAssertFalse(plcrash_async_file_compress(&file, 0, &state, scratch, sizeof(scratch)), @"Buffered output was compressed");
+    STAssertEquals(plcrash_async_file_tell(&file), (off_t) sizeof(data), @"Buffered output was modified");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+}
+
+- (void) testPatchWrite {
+    plcrash_async_file_t file;
+    unsigned char data[100];
+    unsigned char patch[] = { 0xC, 0xA, 0xF, 0xE };
+
+    STAssertTrue(sizeof(data) * 4 > PLCRASH_ASYNC_FILE_DEFAULT_BUFFER_SIZE, @"Test is invalid if our buffer is not larger");
+
+    plcrash_async_file_init(&file, _testFd, 0);
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+    
+    /* Write enough data that the start of the file will have been flushed */
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to output buffer");
+    STAssertEquals(plcrash_async_file_tell(&file), (off_t) sizeof(data) * 4, @"Incorrect output position");
+
+    /* Patch flushed data, buffered data, and the end of the file */
+    STAssertTrue(plcrash_async_file_pwrite(&file, 10, patch, sizeof(patch)), @"Failed to patch flushed data");
+    STAssertTrue(plcrash_async_file_pwrite(&file, sizeof(data) * 4 - sizeof(patch), patch, sizeof(patch)), @"Failed to patch buffered data");
+    STAssertFalse(plcrash_async_file_pwrite(&file, sizeof(data) * 4 - 1, patch, sizeof(patch)), @"Patch beyond the written output was permitted");
+
+    STAssertTrue(plcrash_async_file_flush(&file), @"File flush failed");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+
+    /* Validate the test file */
+    NSData *written = [NSData dataWithContentsOfFile: _outputFile];
+    STAssertEquals([written length], sizeof(data) * 4, @"Incorrect file size");
+
+    const unsigned char *bytes = [written bytes];
+    STAssertTrue(memcmp(bytes + 10, patch, sizeof(patch)) == 0, @"Flushed data was not patched");
+    STAssertTrue(memcmp(bytes + [written length] - sizeof(patch), patch, sizeof(patch)) == 0, @"Buffered data was not patched");
+    STAssertTrue(memcmp(bytes, data, 10) == 0, @"Unpatched data was modified");
+}
+
+/**
+ * Verify that the file checksum reflects patches to both flushed and buffered output.
+ */
+- (void) testChecksumPatchedWrite {
+    plcrash_async_file_t file;
+    unsigned char data[100];
+    unsigned char patch[] = { 0xC, 0xA, 0xF, 0xE };
+    uint32_t checksum;
+
+    plcrash_async_file_init(&file, _testFd, 0);
+    for (unsigned char i = 0; i < sizeof(data); i++)
+        data[i] = i;
+
+    /* Output preceding the call to plcrash_async_file_checksum_begin() is not checksummed */
+    STAssertFalse(plcrash_async_file_checksum(&file, &checksum), @"Checksum was available before being enabled");
+    STAssertTrue(plcrash_async_file_write(&file, data, 8), @"Failed to write to output buffer");
+    plcrash_async_file_checksum_begin(&file);
+
+    /* Write enough data that the start of the file will have been flushed, and patch it */
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(plcrash_async_file_write(&file, data, sizeof(data)), @"Failed to write to output buffer");
+
+    STAssertTrue(plcrash_async_file_pwrite(&file, 4, patch, sizeof(patch)), @"Failed to patch flushed data");
+    STAssertTrue(plcrash_async_file_pwrite(&file, 20, patch, sizeof(patch)), @"Failed to patch flushed data");
+    STAssertTrue(plcrash_async_file_pwrite(&file, plcrash_async_file_tell(&file) - sizeof(patch), patch, sizeof(patch)), @"Failed to patch buffered data");
+    STAssertTrue(plcrash_async_file_write(&file, data, 10), @"Failed to write to output buffer");
+
+    STAssertTrue(plcrash_async_file_checksum(&file, &checksum), @"Checksum is unavailable");
+    STAssertTrue(plcrash_async_file_close(&file), @"File not closed");
+
+    /* Compare against the checksum of the written file */
+    NSData *written = [NSData dataWithContentsOfFile: _outputFile];
+    STAssertEquals([written length], (NSUInteger) 8 + sizeof(data) * 4 + 10, @"Incorrect file size");
+    STAssertEquals(checksum, plcrash_async_crc32c_update(0, (const uint8_t *) [written bytes] + 8, [written length] - 8), @"Incorrect checksum");
+}
+
 @end
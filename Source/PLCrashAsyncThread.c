@@ -28,6 +28,8 @@
 
 #include "PLCrashAsyncThread.h"
 
+#include <stdlib.h>
+
 /**
  * @internal
  * @ingroup plcrash_async
@@ -74,15 +76,27 @@ plcrash_error_t plcrash_async_thread_state_init (plcrash_async_thread_state_t *t
 
 #if PLCRASH_ASYNC_THREAD_ARM_SUPPORT
         case CPU_TYPE_ARM:
+            thread_state->arm_state.thread.ash.count = ARM_THREAD_STATE32_COUNT;
+            thread_state->arm_state.thread.ash.flavor = ARM_THREAD_STATE32;
+
             thread_state->stack_direction = PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN;
             thread_state->greg_size = 4;
             break;
+
+        case CPU_TYPE_ARM64:
+            thread_state->arm_state.thread.ash.count = ARM_THREAD_STATE64_COUNT;
+            thread_state->arm_state.thread.ash.flavor = ARM_THREAD_STATE64;
+
+            thread_state->stack_direction = PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN;
+            thread_state->greg_size = 8;
+            break;
 #endif /* PLCRASH_ASYNC_THREAD_ARM_SUPPORT */
 
         default:
             return PLCRASH_ENOTSUP;
     }
 
+    plcrash_async_thread_state_resolve_regs(thread_state);
     plcrash_async_thread_state_clear_all_regs(thread_state);
     return PLCRASH_ESUCCESS;
 }
@@ -101,13 +115,21 @@ void plcrash_async_thread_state_mcontext_init (plcrash_async_thread_state_t *thr
      * the thread state of the host process, and we may assume that the compilation target matches the mcontext_t
      * thread type.
      */
-#if defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
+#if defined(PLCRASH_ASYNC_THREAD_ARM64_SUPPORT)
+    plcrash_async_thread_state_init(thread_state, CPU_TYPE_ARM64);
+
+    /* Sanity check. */
+    PLCF_ASSERT(sizeof(mctx->__ss) == sizeof(thread_state->arm_state.thread.ts_64));
+
+    plcrash_async_memcpy(&thread_state->arm_state.thread.ts_64, &mctx->__ss, sizeof(thread_state->arm_state.thread.ts_64));
+
+#elif defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
     plcrash_async_thread_state_init(thread_state, CPU_TYPE_ARM);
 
     /* Sanity check. */
-    PLCF_ASSERT(sizeof(mctx->__ss) == sizeof(thread_state->arm_state.thread));
+    PLCF_ASSERT(sizeof(mctx->__ss) == sizeof(thread_state->arm_state.thread.ts_32));
 
-    plcrash_async_memcpy(&thread_state->arm_state.thread, &mctx->__ss, sizeof(thread_state->arm_state.thread));
+    plcrash_async_memcpy(&thread_state->arm_state.thread.ts_32, &mctx->__ss, sizeof(thread_state->arm_state.thread.ts_32));
     
 #elif defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT) && defined(__LP64__)
     plcrash_async_thread_state_init(thread_state, CPU_TYPE_X86_64);
@@ -137,29 +159,53 @@ void plcrash_async_thread_state_mcontext_init (plcrash_async_thread_state_t *thr
 }
 
 /**
- * Initialize the @a thread_state using thread state fetched from the given mach @a thread. If the thread is not
- * suspended, the fetched state may be inconsistent.
+ * Initialize the @a thread_state using only the general purpose thread state fetched from the given mach @a thread.
+ * If the thread is not suspended, the fetched state may be inconsistent.
  *
- * All registers will be marked as available.
+ * This issues a single thread_get_state() call, and is intended for threads that will only be unwound; the
+ * auxiliary (eg, x86 exception) state is not fetched, and will be zero-initialized. All registers will be marked
+ * as available, as all registers exposed via plcrash_async_thread_state_get_reg() are sourced from the general
+ * purpose thread state.
  *
  * @param thread_state The thread state to be initialized.
  * @param thread The thread from which to fetch thread state.
  *
  * @return Returns PLFRAME_ESUCCESS on success, or standard plframe_error_t code if an error occurs.
+ *
+ * @sa plcrash_async_thread_state_mach_thread_init
  */
-plcrash_error_t plcrash_async_thread_state_mach_thread_init (plcrash_async_thread_state_t *thread_state, thread_t thread) {
+plcrash_error_t plcrash_async_thread_state_mach_thread_minimal_init (plcrash_async_thread_state_t *thread_state, thread_t thread) {
     mach_msg_type_number_t state_count;
     kern_return_t kr;
     
-#ifdef PLCRASH_ASYNC_THREAD_ARM_SUPPORT
-    /* Fetch the thread state */
-    state_count = ARM_THREAD_STATE_COUNT;
+#if defined(PLCRASH_ASYNC_THREAD_ARM64_SUPPORT)
+    /* Fetch the thread state. On ARM64 kernels, ARM_THREAD_STATE returns the unified 32/64-bit thread state. */
+    state_count = ARM_UNIFIED_THREAD_STATE_COUNT;
     kr = thread_get_state(thread, ARM_THREAD_STATE, (thread_state_t) &thread_state->arm_state.thread, &state_count);
     if (kr != KERN_SUCCESS) {
         PLCF_DEBUG("Fetch of ARM thread state failed with Mach error: %d", kr);
         return PLCRASH_EINTERNAL;
     }
-    
+
+    /* Platform meta-data */
+    thread_state->stack_direction = PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN;
+    if (thread_state->arm_state.thread.ash.flavor == ARM_THREAD_STATE64) {
+        thread_state->greg_size = 8;
+    } else {
+        thread_state->greg_size = 4;
+    }
+#elif defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
+    /* Fetch the thread state. 32-bit ARM kernels return only the 32-bit thread state. */
+    state_count = ARM_THREAD_STATE32_COUNT;
+    kr = thread_get_state(thread, ARM_THREAD_STATE32, (thread_state_t) &thread_state->arm_state.thread.ts_32, &state_count);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("Fetch of ARM thread state failed with Mach error: %d", kr);
+        return PLCRASH_EINTERNAL;
+    }
+
+    thread_state->arm_state.thread.ash.count = ARM_THREAD_STATE32_COUNT;
+    thread_state->arm_state.thread.ash.flavor = ARM_THREAD_STATE32;
+
     /* Platform meta-data */
     thread_state->stack_direction = PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN;
     thread_state->greg_size = 4;
@@ -171,20 +217,19 @@ plcrash_error_t plcrash_async_thread_state_mach_thread_init (plcrash_async_threa
         PLCF_DEBUG("Fetch of x86 thread state failed with Mach error: %d", kr);
         return PLCRASH_EINTERNAL;
     }
-    
-    /* Fetch the exception state */
-    state_count = x86_EXCEPTION_STATE_COUNT;
-    kr = thread_get_state(thread, x86_EXCEPTION_STATE, (thread_state_t) &thread_state->x86_state.exception, &state_count);
-    if (kr != KERN_SUCCESS) {
-        PLCF_DEBUG("Fetch of x86 exception state failed with Mach error: %d", kr);
-        return PLCRASH_EINTERNAL;
-    }
-    
+
+    /* The exception state is not fetched; provide a zeroed state of the matching flavor */
+    memset(&thread_state->x86_state.exception, 0, sizeof(thread_state->x86_state.exception));
+
     /* Platform meta-data */
     thread_state->stack_direction = PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN;
     if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE64) {
+        thread_state->x86_state.exception.esh.count = x86_EXCEPTION_STATE64_COUNT;
+        thread_state->x86_state.exception.esh.flavor = x86_EXCEPTION_STATE64;
         thread_state->greg_size = 8;
     } else {
+        thread_state->x86_state.exception.esh.count = x86_EXCEPTION_STATE32_COUNT;
+        thread_state->x86_state.exception.esh.flavor = x86_EXCEPTION_STATE32;
         thread_state->greg_size = 4;
     }
 
@@ -192,12 +237,46 @@ plcrash_error_t plcrash_async_thread_state_mach_thread_init (plcrash_async_threa
 #error Add platform support
 #endif
 
+    /* Resolve the register table for the fetched flavor */
+    plcrash_async_thread_state_resolve_regs(thread_state);
+
     /* Mark all registers as available */
     memset(&thread_state->valid_regs, 0xFF, sizeof(thread_state->valid_regs));
 
     return PLCRASH_ESUCCESS;
 }
 
+/**
+ * Initialize the @a thread_state using thread state fetched from the given mach @a thread. If the thread is not
+ * suspended, the fetched state may be inconsistent.
+ *
+ * All registers will be marked as available.
+ *
+ * @param thread_state The thread state to be initialized.
+ * @param thread The thread from which to fetch thread state.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, or standard plframe_error_t code if an error occurs.
+ */
+plcrash_error_t plcrash_async_thread_state_mach_thread_init (plcrash_async_thread_state_t *thread_state, thread_t thread) {
+    plcrash_error_t err;
+
+    /* Fetch the general purpose thread state */
+    if ((err = plcrash_async_thread_state_mach_thread_minimal_init(thread_state, thread)) != PLCRASH_ESUCCESS)
+        return err;
+
+#if defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT)
+    /* Fetch the exception state */
+    mach_msg_type_number_t state_count = x86_EXCEPTION_STATE_COUNT;
+    kern_return_t kr = thread_get_state(thread, x86_EXCEPTION_STATE, (thread_state_t) &thread_state->x86_state.exception, &state_count);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("Fetch of x86 exception state failed with Mach error: %d", kr);
+        return PLCRASH_EINTERNAL;
+    }
+#endif
+
+    return PLCRASH_ESUCCESS;
+}
+
 /**
  * Copy thread state @a source to @a dest.
  *
@@ -217,7 +296,7 @@ void plcrash_async_thread_state_copy (plcrash_async_thread_state_t *dest, const
  * @param regnum The register number to test for.
  */
 bool plcrash_async_thread_state_has_reg (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    if ((thread_state->valid_regs & (1<<regnum)) != 0)
+    if ((thread_state->valid_regs & (1ULL<<regnum)) != 0)
         return true;
     
     return false;
@@ -230,7 +309,7 @@ bool plcrash_async_thread_state_has_reg (const plcrash_async_thread_state_t *thr
  * @param regnum The register to unset.
  */
 void plcrash_async_thread_state_clear_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    thread_state->valid_regs &= ~(1<<regnum);
+    thread_state->valid_regs &= ~(1ULL<<regnum);
 }
 
 
@@ -243,6 +322,90 @@ void plcrash_async_thread_state_clear_all_regs (plcrash_async_thread_state_t *th
     thread_state->valid_regs = 0x0;
 }
 
+/**
+ * Return the total number of registers supported by @a thread_state.
+ *
+ * @param thread_state The target thread state.
+ */
+size_t plcrash_async_thread_state_get_reg_count (const plcrash_async_thread_state_t *thread_state) {
+    return thread_state->reg_count;
+}
+
+/**
+ * Return the name of @a regnum.
+ *
+ * @param thread_state The target thread state.
+ * @param regnum The register number.
+ */
+char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
+    /* Unsupported register is an implementation error (checked in unit tests) */
+    if ((size_t) regnum >= thread_state->reg_count) {
+        PLCF_DEBUG("Missing register name for register id: %d", regnum);
+        abort();
+    }
+
+    return thread_state->reg_table[regnum].name;
+}
+
+/**
+ * Return the value of @a regnum. The register is read directly from the offset recorded in the thread state's
+ * register table.
+ *
+ * @param thread_state The target thread state.
+ * @param regnum The register number.
+ */
+plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
+    /* Unsupported register */
+    if ((size_t) regnum >= thread_state->reg_count)
+        __builtin_trap();
+
+    const plcrash_async_thread_reg_info_t *info = &thread_state->reg_table[regnum];
+    const void *value = ((const uint8_t *) thread_state) + info->offset;
+
+    switch (info->size) {
+        case sizeof(uint64_t):
+            return *(const uint64_t *) value;
+        case sizeof(uint32_t):
+            return *(const uint32_t *) value;
+        case sizeof(uint16_t):
+            return *(const uint16_t *) value;
+        default:
+            __builtin_trap();
+    }
+}
+
+/**
+ * Set the value of @a regnum, and mark the register as available.
+ *
+ * @param thread_state The target thread state.
+ * @param regnum The register number.
+ * @param reg The register value.
+ */
+void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
+    /* Unsupported register */
+    if ((size_t) regnum >= thread_state->reg_count)
+        __builtin_trap();
+
+    const plcrash_async_thread_reg_info_t *info = &thread_state->reg_table[regnum];
+    void *value = ((uint8_t *) thread_state) + info->offset;
+
+    switch (info->size) {
+        case sizeof(uint64_t):
+            *(uint64_t *) value = reg;
+            break;
+        case sizeof(uint32_t):
+            *(uint32_t *) value = (uint32_t) reg;
+            break;
+        case sizeof(uint16_t):
+            *(uint16_t *) value = (uint16_t) reg;
+            break;
+        default:
+            __builtin_trap();
+    }
+
+    thread_state->valid_regs |= 1ULL<<regnum;
+}
+
 /**
  * Return the direction used for stack growth by @a thread_state.
  *
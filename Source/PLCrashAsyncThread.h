@@ -57,17 +57,33 @@ extern "C" {
 typedef mcontext_t pl_mcontext_t;
 #endif
 
-#if defined(__arm__)
+#if defined(__arm__) || defined(__arm64__)
 
-/** Defined if ARM thread states are supported by the PLCrashReporter thread state API. */
+/** Defined if ARM thread states are supported by the PLCrashReporter thread state API. Both 32-bit and 64-bit ARM
+ * thread states are represented using the unified ARM thread state. */
 #define PLCRASH_ASYNC_THREAD_ARM_SUPPORT 1
 
 #include <mach/arm/thread_state.h>
+#include <mach/arm/thread_status.h>
 
+#if defined(__arm64__)
+/** Defined if ARM64 thread states are supported by the PLCrashReporter thread state API. */
+#define PLCRASH_ASYNC_THREAD_ARM64_SUPPORT 1
+
+/** Host architecture mcontext_t-compatible type. */
+typedef struct __darwin_mcontext64 *pl_mcontext_t;
+#else
 /** Host architecture mcontext_t-compatible type. */
 typedef struct __darwin_mcontext *pl_mcontext_t;
 #endif
 
+#endif
+
+/* Older SDKs do not define the ARM64 CPU type */
+#ifndef CPU_TYPE_ARM64
+#define CPU_TYPE_ARM64 (CPU_TYPE_ARM | CPU_ARCH_ABI64)
+#endif
+
 /**
  * Stack growth direction.
  */
@@ -96,14 +112,21 @@ typedef struct plcrash_async_thread_state {
     size_t greg_size;
     
     /** The set of available registers. */
-    uint32_t valid_regs;
+    uint64_t valid_regs;
+
+    /** The register table for this thread state's flavor, indexed by register number. This is resolved when the
+     * thread state is initialized, and references constant data; it remains valid when the thread state is copied. */
+    const struct plcrash_async_thread_reg_info *reg_table;
+
+    /** The number of registers in @a reg_table. */
+    size_t reg_count;
 
     /* Union used to hold thread state for any supported architecture */
     union {
     #ifdef PLCRASH_ASYNC_THREAD_ARM_SUPPORT
         struct {
-            /** ARM thread state */
-            arm_thread_state_t thread;
+            /** Combined ARM 32/64 thread state */
+            arm_unified_thread_state_t thread;
         } arm_state;
     #endif
         
@@ -123,6 +146,22 @@ typedef struct plcrash_async_thread_state {
 /** Register number type */
 typedef int plcrash_regnum_t;
 
+/**
+ * @internal
+ *
+ * Describes the storage of a single register within a plcrash_async_thread_state_t.
+ */
+typedef struct plcrash_async_thread_reg_info {
+    /** The register's name. */
+    const char *name;
+
+    /** The offset of the register's value from the start of the plcrash_async_thread_state_t. */
+    uint16_t offset;
+
+    /** The size of the register's value, in bytes. */
+    uint8_t size;
+} plcrash_async_thread_reg_info_t;
+
 /**
  * General pseudo-registers common across platforms.
  *
@@ -156,6 +195,7 @@ typedef plcrash_pdef_greg_t plcrash_greg_t;
 plcrash_error_t plcrash_async_thread_state_init (plcrash_async_thread_state_t *thread_state, cpu_type_t cpu_type);
 void plcrash_async_thread_state_mcontext_init (plcrash_async_thread_state_t *thread_state, pl_mcontext_t mctx);
 plcrash_error_t plcrash_async_thread_state_mach_thread_init (plcrash_async_thread_state_t *thread_state, thread_t thread);
+plcrash_error_t plcrash_async_thread_state_mach_thread_minimal_init (plcrash_async_thread_state_t *thread_state, thread_t thread);
 
 /**
  * Callback function called by plcrash_log_writer_write_curthread().
@@ -185,29 +225,20 @@ bool plcrash_async_thread_state_has_reg (const plcrash_async_thread_state_t *thr
 void plcrash_async_thread_state_clear_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
 void plcrash_async_thread_state_clear_all_regs (plcrash_async_thread_state_t *thread_state);
 
-/* Platform specific funtions */
-
-/**
- * Get a register's name.
- */
 char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
-
-/**
- * Get the total number of registers supported by @a thread_state.
- *
- * @param thread_state The target thread state.
- */
 size_t plcrash_async_thread_state_get_reg_count (const plcrash_async_thread_state_t *thread_state);
-
-/**
- * Get a register value.
- */
 plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
+void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg);
+
+/* Platform specific funtions */
 
 /**
- * Set a register value.
+ * Resolve the register table for @a thread_state's flavor. This must be called by any function that initializes
+ * the thread state's flavor.
+ *
+ * @param thread_state The thread state for which the register table should be resolved.
  */
-void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg);
+void plcrash_async_thread_state_resolve_regs (plcrash_async_thread_state_t *thread_state);
 
 /**
  * Clear all non-callee saved volatile registers in @a thread_state. The exact registers preserved depend on the target ABI.
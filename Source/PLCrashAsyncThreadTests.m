@@ -63,6 +63,29 @@
     }
 }
 
+/**
+ * Verify that the minimal thread state provides the general purpose registers required for unwinding, matching
+ * the complete thread state.
+ */
+- (void) testMachThreadMinimalInit {
+    plcrash_async_thread_state_t full;
+    plcrash_async_thread_state_t minimal;
+    thread_t thr = pthread_mach_thread_np(_thr_args.thread);
+
+    STAssertEquals(plcrash_async_thread_state_mach_thread_init(&full, thr), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    STAssertEquals(plcrash_async_thread_state_mach_thread_minimal_init(&minimal, thr), PLCRASH_ESUCCESS, @"Failed to initialize minimal thread state");
+
+    STAssertEquals(plcrash_async_thread_state_get_greg_size(&minimal), plcrash_async_thread_state_get_greg_size(&full), @"Incorrect greg size");
+    STAssertEquals(plcrash_async_thread_state_get_reg_count(&minimal), plcrash_async_thread_state_get_reg_count(&full), @"Incorrect register count");
+
+    for (int i = 0; i < plcrash_async_thread_state_get_reg_count(&minimal); i++)
+        STAssertTrue(plcrash_async_thread_state_has_reg(&minimal, i), @"Register %d not marked as available", i);
+
+    /* The test thread is blocked; its stack and frame pointers should be stable across both fetches */
+    STAssertEquals(plcrash_async_thread_state_get_reg(&minimal, PLCRASH_REG_SP), plcrash_async_thread_state_get_reg(&full, PLCRASH_REG_SP), @"Incorrect SP");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&minimal, PLCRASH_REG_FP), plcrash_async_thread_state_get_reg(&full, PLCRASH_REG_FP), @"Incorrect FP");
+}
+
 - (void) testClearVolatileRegisters {
     plcrash_async_thread_state_t ts;
     plcrash_async_thread_state_mach_thread_init(&ts, pthread_mach_thread_np(_thr_args.thread));
@@ -89,7 +112,21 @@
     
 #define REQ_REG(_reg) STAssertTrue(plcrash_async_thread_state_has_reg(&ts, _reg), @"Missing required register");
     
-#ifdef __arm__
+#if defined(__arm64__)
+    REQ_REG(PLCRASH_ARM64_X19);
+    REQ_REG(PLCRASH_ARM64_X20);
+    REQ_REG(PLCRASH_ARM64_X21);
+    REQ_REG(PLCRASH_ARM64_X22);
+    REQ_REG(PLCRASH_ARM64_X23);
+    REQ_REG(PLCRASH_ARM64_X24);
+    REQ_REG(PLCRASH_ARM64_X25);
+    REQ_REG(PLCRASH_ARM64_X26);
+    REQ_REG(PLCRASH_ARM64_X27);
+    REQ_REG(PLCRASH_ARM64_X28);
+    REQ_REG(PLCRASH_ARM64_FP);
+    REQ_REG(PLCRASH_ARM64_SP);
+    STAssertEquals((size_t)12, nv_count, @"Incorrect number of registers preserved");
+#elif defined(__arm__)
     REQ_REG(PLCRASH_ARM_R4);
     REQ_REG(PLCRASH_ARM_R5);
     REQ_REG(PLCRASH_ARM_R6);
@@ -127,14 +164,14 @@
     size_t regcount = plcrash_async_thread_state_get_reg_count(&ts);
 
     /* Verify that all registers are marked as available */
-    STAssertTrue(__builtin_popcount(ts.valid_regs) >= regcount, @"Incorrect number of 1 bits");
+    STAssertTrue(__builtin_popcountll(ts.valid_regs) >= regcount, @"Incorrect number of 1 bits");
     for (int i = 0; i < plcrash_async_thread_state_get_reg_count(&ts); i++) {
         STAssertTrue(plcrash_async_thread_state_has_reg(&ts, i), @"Register should be marked as set");
     }
 
     /* Clear all registers */
     plcrash_async_thread_state_clear_all_regs(&ts);
-    STAssertEquals(ts.valid_regs, (uint32_t)0, @"Registers not marked as clear");
+    STAssertEquals(ts.valid_regs, (uint64_t)0, @"Registers not marked as clear");
 
     /* Now set+get each individually */
     for (int i = 0; i < plcrash_async_thread_state_get_reg_count(&ts); i++) {
@@ -145,7 +182,7 @@
         STAssertEquals(reg, (plcrash_greg_t)5, @"Unexpected register value");
         
         STAssertTrue(plcrash_async_thread_state_has_reg(&ts, i), @"Register should be marked as set");
-        STAssertEquals(__builtin_popcount(ts.valid_regs), i+1, @"Incorrect number of 1 bits");
+        STAssertEquals(__builtin_popcountll(ts.valid_regs), i+1, @"Incorrect number of 1 bits");
     }
 }
 
@@ -223,6 +260,17 @@
     CHECKREG(PLCRASH_ARM_SP, 13);
     CHECKREG(PLCRASH_ARM_LR, 14);
     CHECKREG(PLCRASH_ARM_PC, 15);
+
+    STAssertEquals(plcrash_async_thread_state_init(&ts, CPU_TYPE_ARM64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+
+    CHECKREG(PLCRASH_ARM64_X0, 0);
+    CHECKREG(PLCRASH_ARM64_X1, 1);
+    CHECKREG(PLCRASH_ARM64_X18, 18);
+    CHECKREG(PLCRASH_ARM64_X19, 19);
+    CHECKREG(PLCRASH_ARM64_X28, 28);
+    CHECKREG(PLCRASH_ARM64_FP, 29);
+    CHECKREG(PLCRASH_ARM64_LR, 30);
+    CHECKREG(PLCRASH_ARM64_SP, 31);
 #endif
     
 #undef CHECKREG
@@ -254,6 +302,13 @@
     STAssertEquals(plcrash_async_thread_state_init(&ts, CPU_TYPE_ARM), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
     STAssertEquals(ts.stack_direction, PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN, @"Incorrect stack direction");
     STAssertEquals(ts.greg_size, (size_t)4, @"Incorrect gpreg size");
+
+    STAssertEquals(plcrash_async_thread_state_init(&ts, CPU_TYPE_ARM64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    STAssertEquals(ts.arm_state.thread.ash.count, (int)ARM_THREAD_STATE64_COUNT, @"Incorrect count");
+    STAssertEquals(ts.arm_state.thread.ash.flavor, ARM_THREAD_STATE64, @"Incorrect flavor");
+    STAssertEquals(ts.stack_direction, PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN, @"Incorrect stack direction");
+    STAssertEquals(ts.greg_size, (size_t)8, @"Incorrect gpreg size");
+    STAssertEquals(plcrash_async_thread_state_get_reg_count(&ts), (size_t)(PLCRASH_ARM64_LAST_REG + 1), @"Incorrect register count");
 #endif
 }
 
@@ -268,13 +323,17 @@
     
     /* Verify that all registers are marked as available */
     size_t regcount = plcrash_async_thread_state_get_reg_count(&thr_state);
-    STAssertTrue(__builtin_popcount(thr_state.valid_regs) >= regcount, @"Incorrect number of 1 bits");
+    STAssertTrue(__builtin_popcountll(thr_state.valid_regs) >= regcount, @"Incorrect number of 1 bits");
     for (int i = 0; i < plcrash_async_thread_state_get_reg_count(&thr_state); i++) {
         STAssertTrue(plcrash_async_thread_state_has_reg(&thr_state, i), @"Register should be marked as set");
     }
     
 #if defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
-    STAssertTrue(memcmp(&thr_state.arm_state.thread, &mctx.__ss, sizeof(thr_state.arm_state.thread)) == 0, @"Incorrectly copied");
+#if defined(PLCRASH_ASYNC_THREAD_ARM64_SUPPORT)
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_64, &mctx.__ss, sizeof(thr_state.arm_state.thread.ts_64)) == 0, @"Incorrectly copied");
+#else
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_32, &mctx.__ss, sizeof(thr_state.arm_state.thread.ts_32)) == 0, @"Incorrectly copied");
+#endif
     
 #elif defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT) && defined(__LP64__)
     STAssertEquals(thr_state.x86_state.thread.tsh.count, (int)x86_THREAD_STATE64_COUNT, @"Incorrect thread state count for a 64-bit system");
@@ -312,18 +371,26 @@
     
     /* Verify that all registers are marked as available */
     size_t regcount = plcrash_async_thread_state_get_reg_count(&thr_state);
-    STAssertTrue(__builtin_popcount(thr_state.valid_regs) >= regcount, @"Incorrect number of 1 bits");
+    STAssertTrue(__builtin_popcountll(thr_state.valid_regs) >= regcount, @"Incorrect number of 1 bits");
     for (int i = 0; i < plcrash_async_thread_state_get_reg_count(&thr_state); i++) {
         STAssertTrue(plcrash_async_thread_state_has_reg(&thr_state, i), @"Register should be marked as set");
     }
 
     /* Test the results */
 #if defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
-    arm_thread_state_t local_thr_state;
-    state_count = ARM_THREAD_STATE_COUNT;
-    
-    STAssertEquals(thread_get_state(thr, ARM_THREAD_STATE, (thread_state_t) &local_thr_state, &state_count), KERN_SUCCESS, @"Failed to fetch thread state");
-    STAssertTrue(memcmp(&thr_state.arm_state.thread, &local_thr_state, sizeof(thr_state.arm_state.thread)) == 0, @"Incorrectly copied");
+#if defined(__arm64__)
+    arm_thread_state64_t local_thr_state;
+    state_count = ARM_THREAD_STATE64_COUNT;
+
+    STAssertEquals(thread_get_state(thr, ARM_THREAD_STATE64, (thread_state_t) &local_thr_state, &state_count), KERN_SUCCESS, @"Failed to fetch thread state");
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_64, &local_thr_state, sizeof(thr_state.arm_state.thread.ts_64)) == 0, @"Incorrectly copied");
+#else
+    arm_thread_state32_t local_thr_state;
+    state_count = ARM_THREAD_STATE32_COUNT;
+
+    STAssertEquals(thread_get_state(thr, ARM_THREAD_STATE32, (thread_state_t) &local_thr_state, &state_count), KERN_SUCCESS, @"Failed to fetch thread state");
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_32, &local_thr_state, sizeof(thr_state.arm_state.thread.ts_32)) == 0, @"Incorrectly copied");
+#endif
     
 #elif defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT) && defined(__LP64__)
     state_count = x86_THREAD_STATE64_COUNT;
@@ -365,7 +432,7 @@
     STAssertEquals(plcrash_async_thread_state_get_greg_size(&thr_state), (size_t)4, @"Incorrect greg size");
 #endif
 
-#if defined(__arm__) || defined(__i386__) || defined(__x86_64__)
+#if defined(__arm__) || defined(__arm64__) || defined(__i386__) || defined(__x86_64__)
     // This is true on just about every modern platform
     STAssertEquals(plcrash_async_thread_state_get_stack_direction(&thr_state), PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN, @"Incorrect stack growth direction");
 #else
@@ -414,10 +481,14 @@ static plcrash_error_t write_current_thread_callback (plcrash_async_thread_state
     }
     
     /* Architecture-specific validations */
-#if __arm__
+#if __arm__ || __arm64__
     /* Validate LR */
     void *retaddr = __builtin_return_address(0);
+#if __arm64__
+    uintptr_t lr = plcrash_async_thread_state_get_reg(&thr_state, PLCRASH_ARM64_LR);
+#else
     uintptr_t lr = plcrash_async_thread_state_get_reg(&thr_state, PLCRASH_ARM_LR);
+#endif
     STAssertEquals(retaddr, (void *)lr, @"Incorrect lr: %p", (void *) lr);
 #endif
 }
@@ -31,19 +31,10 @@
 
 #import <signal.h>
 #import <stdlib.h>
+#import <stddef.h>
 #import <assert.h>
 
-#ifdef __arm__
-
-#define RETGEN(name, type, ts) {\
-    return (ts->arm_state. type . __ ## name); \
-}
-
-#define SETGEN(name, type, ts, regnum, value) {\
-    ts->valid_regs |= 1<<regnum; \
-    (ts->arm_state. type . __ ## name) = value; \
-    break; \
-}
+#if defined(__arm__) || defined(__arm64__)
 
 /* Mapping of DWARF register numbers to PLCrashReporter register numbers. */
 struct dwarf_register_table {
@@ -69,6 +60,25 @@ static const plcrash_regnum_t arm_nonvolatile_registers[] = {
     PLCRASH_ARM_R11,
 };
 
+/*
+ * ARM64 GP registers defined as callee-preserved, as per Apple's iOS ARM64
+ * Function Calling Conventions.
+ */
+static const plcrash_regnum_t arm64_nonvolatile_registers[] = {
+    PLCRASH_ARM64_X19,
+    PLCRASH_ARM64_X20,
+    PLCRASH_ARM64_X21,
+    PLCRASH_ARM64_X22,
+    PLCRASH_ARM64_X23,
+    PLCRASH_ARM64_X24,
+    PLCRASH_ARM64_X25,
+    PLCRASH_ARM64_X26,
+    PLCRASH_ARM64_X27,
+    PLCRASH_ARM64_X28,
+    PLCRASH_ARM64_FP,
+    PLCRASH_ARM64_SP,
+};
+
 /**
  * DWARF register mappings as defined in ARM's "DWARF for the ARM Architecture", ARM IHI 0040B,
  * issued November 30th, 2012.
@@ -99,193 +109,151 @@ static const struct dwarf_register_table arm_dwarf_table [] = {
     { PLCRASH_ARM_PC, 15 }
 };
 
+/**
+ * DWARF register mappings as defined in ARM's "DWARF for the ARM 64-bit Architecture (AArch64)", ARM IHI 0057B,
+ * issued May 22nd, 2013.
+ *
+ * The PC and CPSR are not allocated a DWARF register number; the return address is instead described by
+ * the link register (x30).
+ */
+static const struct dwarf_register_table arm64_dwarf_table [] = {
+    { PLCRASH_ARM64_X0, 0 },
+    { PLCRASH_ARM64_X1, 1 },
+    { PLCRASH_ARM64_X2, 2 },
+    { PLCRASH_ARM64_X3, 3 },
+    { PLCRASH_ARM64_X4, 4 },
+    { PLCRASH_ARM64_X5, 5 },
+    { PLCRASH_ARM64_X6, 6 },
+    { PLCRASH_ARM64_X7, 7 },
+    { PLCRASH_ARM64_X8, 8 },
+    { PLCRASH_ARM64_X9, 9 },
+    { PLCRASH_ARM64_X10, 10 },
+    { PLCRASH_ARM64_X11, 11 },
+    { PLCRASH_ARM64_X12, 12 },
+    { PLCRASH_ARM64_X13, 13 },
+    { PLCRASH_ARM64_X14, 14 },
+    { PLCRASH_ARM64_X15, 15 },
+    { PLCRASH_ARM64_X16, 16 },
+    { PLCRASH_ARM64_X17, 17 },
+    { PLCRASH_ARM64_X18, 18 },
+    { PLCRASH_ARM64_X19, 19 },
+    { PLCRASH_ARM64_X20, 20 },
+    { PLCRASH_ARM64_X21, 21 },
+    { PLCRASH_ARM64_X22, 22 },
+    { PLCRASH_ARM64_X23, 23 },
+    { PLCRASH_ARM64_X24, 24 },
+    { PLCRASH_ARM64_X25, 25 },
+    { PLCRASH_ARM64_X26, 26 },
+    { PLCRASH_ARM64_X27, 27 },
+    { PLCRASH_ARM64_X28, 28 },
+    { PLCRASH_ARM64_FP, 29 },
+    { PLCRASH_ARM64_LR, 30 },
+    { PLCRASH_ARM64_SP, 31 }
+};
 
 
-// PLCrashAsyncThread API
-plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *ts, plcrash_regnum_t regnum) {
-    switch (regnum) {
-        case PLCRASH_ARM_R0:
-            RETGEN(r[0], thread, ts);
-            
-        case PLCRASH_ARM_R1:
-            RETGEN(r[1], thread, ts);
-            
-        case PLCRASH_ARM_R2:
-            RETGEN(r[2], thread, ts);
-            
-        case PLCRASH_ARM_R3:
-            RETGEN(r[3], thread, ts);
-            
-        case PLCRASH_ARM_R4:
-            RETGEN(r[4], thread, ts);
-            
-        case PLCRASH_ARM_R5:
-            RETGEN(r[5], thread, ts);
-            
-        case PLCRASH_ARM_R6:
-            RETGEN(r[6], thread, ts);
-            
-        case PLCRASH_ARM_R7:
-            RETGEN(r[7], thread, ts);
-            
-        case PLCRASH_ARM_R8:
-            RETGEN(r[8], thread, ts);
-            
-        case PLCRASH_ARM_R9:
-            RETGEN(r[9], thread, ts);
-            
-        case PLCRASH_ARM_R10:
-            RETGEN(r[10], thread, ts);
-            
-        case PLCRASH_ARM_R11:
-            RETGEN(r[11], thread, ts);
-            
-        case PLCRASH_ARM_R12:
-            RETGEN(r[12], thread, ts);
-            
-        case PLCRASH_ARM_SP:
-            RETGEN(sp, thread, ts);
-            
-        case PLCRASH_ARM_LR:
-            RETGEN(lr, thread, ts);
-            
-        case PLCRASH_ARM_PC:
-            RETGEN(pc, thread, ts);
-            
-        case PLCRASH_ARM_CPSR:
-            RETGEN(cpsr, thread, ts);
-            
-        default:
-            __builtin_trap();
-    }
 
-    /* Should not be reachable */
-    return 0;
+/* Define a register table entry for the ARM thread state field @a field. */
+#define ARM_REG(field, regname) { \
+    .name = regname, \
+    .offset = offsetof(plcrash_async_thread_state_t, arm_state.thread.ts_32.field), \
+    .size = sizeof(((plcrash_async_thread_state_t *) NULL)->arm_state.thread.ts_32.field) \
 }
 
-// PLCrashAsyncThread API
-void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    plcrash_async_thread_state_t *ts = thread_state;
-
-    switch (regnum) {
-        case PLCRASH_ARM_R0:
-            SETGEN(r[0], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R1:
-            SETGEN(r[1], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R2:
-            SETGEN(r[2], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R3:
-            SETGEN(r[3], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R4:
-            SETGEN(r[4], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R5:
-            SETGEN(r[5], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R6:
-            SETGEN(r[6], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R7:
-            SETGEN(r[7], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R8:
-            SETGEN(r[8], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R9:
-            SETGEN(r[9], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R10:
-            SETGEN(r[10], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R11:
-            SETGEN(r[11], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_R12:
-            SETGEN(r[12], thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_SP:
-            SETGEN(sp, thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_LR:
-            SETGEN(lr, thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_PC:
-            SETGEN(pc, thread, ts, regnum, reg);
-            
-        case PLCRASH_ARM_CPSR:
-            SETGEN(cpsr, thread, ts, regnum, reg);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
+/* Define a register table entry for the ARM64 thread state field @a field. */
+#define ARM64_REG(field, regname) { \
+    .name = regname, \
+    .offset = offsetof(plcrash_async_thread_state_t, arm_state.thread.ts_64.field), \
+    .size = sizeof(((plcrash_async_thread_state_t *) NULL)->arm_state.thread.ts_64.field) \
 }
 
-// PLCrashAsyncThread API
-size_t plcrash_async_thread_state_get_reg_count (const plcrash_async_thread_state_t *thread_state) {
-    /* Last is an index value, so increment to get the count */
-    return PLCRASH_ARM_LAST_REG+1;
+/* ARM register table, indexed by register number */
+static const plcrash_async_thread_reg_info_t arm_reg_table[] = {
+    [PLCRASH_ARM_R0]    = ARM_REG(__r[0], "r0"),
+    [PLCRASH_ARM_R1]    = ARM_REG(__r[1], "r1"),
+    [PLCRASH_ARM_R2]    = ARM_REG(__r[2], "r2"),
+    [PLCRASH_ARM_R3]    = ARM_REG(__r[3], "r3"),
+    [PLCRASH_ARM_R4]    = ARM_REG(__r[4], "r4"),
+    [PLCRASH_ARM_R5]    = ARM_REG(__r[5], "r5"),
+    [PLCRASH_ARM_R6]    = ARM_REG(__r[6], "r6"),
+    [PLCRASH_ARM_R7]    = ARM_REG(__r[7], "r7"),
+    [PLCRASH_ARM_R8]    = ARM_REG(__r[8], "r8"),
+    [PLCRASH_ARM_R9]    = ARM_REG(__r[9], "r9"),
+    [PLCRASH_ARM_R10]   = ARM_REG(__r[10], "r10"),
+    [PLCRASH_ARM_R11]   = ARM_REG(__r[11], "r11"),
+    [PLCRASH_ARM_R12]   = ARM_REG(__r[12], "r12"),
+    [PLCRASH_ARM_SP]    = ARM_REG(__sp, "sp"),
+    [PLCRASH_ARM_LR]    = ARM_REG(__lr, "lr"),
+    [PLCRASH_ARM_PC]    = ARM_REG(__pc, "pc"),
+    [PLCRASH_ARM_CPSR]  = ARM_REG(__cpsr, "cpsr")
+};
+
+/* ARM64 register table, indexed by register number */
+static const plcrash_async_thread_reg_info_t arm64_reg_table[] = {
+    [PLCRASH_ARM64_X0]      = ARM64_REG(__x[0], "x0"),
+    [PLCRASH_ARM64_X1]      = ARM64_REG(__x[1], "x1"),
+    [PLCRASH_ARM64_X2]      = ARM64_REG(__x[2], "x2"),
+    [PLCRASH_ARM64_X3]      = ARM64_REG(__x[3], "x3"),
+    [PLCRASH_ARM64_X4]      = ARM64_REG(__x[4], "x4"),
+    [PLCRASH_ARM64_X5]      = ARM64_REG(__x[5], "x5"),
+    [PLCRASH_ARM64_X6]      = ARM64_REG(__x[6], "x6"),
+    [PLCRASH_ARM64_X7]      = ARM64_REG(__x[7], "x7"),
+    [PLCRASH_ARM64_X8]      = ARM64_REG(__x[8], "x8"),
+    [PLCRASH_ARM64_X9]      = ARM64_REG(__x[9], "x9"),
+    [PLCRASH_ARM64_X10]     = ARM64_REG(__x[10], "x10"),
+    [PLCRASH_ARM64_X11]     = ARM64_REG(__x[11], "x11"),
+    [PLCRASH_ARM64_X12]     = ARM64_REG(__x[12], "x12"),
+    [PLCRASH_ARM64_X13]     = ARM64_REG(__x[13], "x13"),
+    [PLCRASH_ARM64_X14]     = ARM64_REG(__x[14], "x14"),
+    [PLCRASH_ARM64_X15]     = ARM64_REG(__x[15], "x15"),
+    [PLCRASH_ARM64_X16]     = ARM64_REG(__x[16], "x16"),
+    [PLCRASH_ARM64_X17]     = ARM64_REG(__x[17], "x17"),
+    [PLCRASH_ARM64_X18]     = ARM64_REG(__x[18], "x18"),
+    [PLCRASH_ARM64_X19]     = ARM64_REG(__x[19], "x19"),
+    [PLCRASH_ARM64_X20]     = ARM64_REG(__x[20], "x20"),
+    [PLCRASH_ARM64_X21]     = ARM64_REG(__x[21], "x21"),
+    [PLCRASH_ARM64_X22]     = ARM64_REG(__x[22], "x22"),
+    [PLCRASH_ARM64_X23]     = ARM64_REG(__x[23], "x23"),
+    [PLCRASH_ARM64_X24]     = ARM64_REG(__x[24], "x24"),
+    [PLCRASH_ARM64_X25]     = ARM64_REG(__x[25], "x25"),
+    [PLCRASH_ARM64_X26]     = ARM64_REG(__x[26], "x26"),
+    [PLCRASH_ARM64_X27]     = ARM64_REG(__x[27], "x27"),
+    [PLCRASH_ARM64_X28]     = ARM64_REG(__x[28], "x28"),
+    [PLCRASH_ARM64_FP]      = ARM64_REG(__fp, "fp"),
+    [PLCRASH_ARM64_SP]      = ARM64_REG(__sp, "sp"),
+    [PLCRASH_ARM64_LR]      = ARM64_REG(__lr, "lr"),
+    [PLCRASH_ARM64_PC]      = ARM64_REG(__pc, "pc"),
+    [PLCRASH_ARM64_CPSR]    = ARM64_REG(__cpsr, "cpsr")
+};
+
+/* Return true if @a thread_state contains a 64-bit ARM thread state. */
+static inline bool plcrash_async_thread_state_is_arm64 (const plcrash_async_thread_state_t *thread_state) {
+    return thread_state->arm_state.thread.ash.flavor == ARM_THREAD_STATE64;
 }
 
 // PLCrashAsyncThread API
-char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    switch (regnum) {
-        case PLCRASH_ARM_R0:
-            return "r0";
-        case PLCRASH_ARM_R1:
-            return "r1";
-        case PLCRASH_ARM_R2:
-            return "r2";
-        case PLCRASH_ARM_R3:
-            return "r3";
-        case PLCRASH_ARM_R4:
-            return "r4";
-        case PLCRASH_ARM_R5:
-            return "r5";
-        case PLCRASH_ARM_R6:
-            return "r6";
-        case PLCRASH_ARM_R7:
-            return "r7";
-        case PLCRASH_ARM_R8:
-            return "r8";
-        case PLCRASH_ARM_R9:
-            return "r9";
-        case PLCRASH_ARM_R10:
-            return "r10";
-        case PLCRASH_ARM_R11:
-            return "r11";
-        case PLCRASH_ARM_R12:
-            return "r12";
-            
-        case PLCRASH_ARM_SP:
-            return "sp";
-            
-        case PLCRASH_ARM_LR:
-            return "lr";
-            
-        case PLCRASH_ARM_PC:
-            return "pc";
-            
-        case PLCRASH_ARM_CPSR:
-            return "cpsr";
-            
-        default:
-            // Unsupported register
-            break;
+void plcrash_async_thread_state_resolve_regs (plcrash_async_thread_state_t *thread_state) {
+    if (plcrash_async_thread_state_is_arm64(thread_state)) {
+        thread_state->reg_table = arm64_reg_table;
+        thread_state->reg_count = sizeof(arm64_reg_table) / sizeof(arm64_reg_table[0]);
+    } else {
+        thread_state->reg_table = arm_reg_table;
+        thread_state->reg_count = sizeof(arm_reg_table) / sizeof(arm_reg_table[0]);
     }
-    
-    /* Unsupported register is an implementation error (checked in unit tests) */
-    PLCF_DEBUG("Missing register name for register id: %d", regnum);
-    abort();
 }
 
 // PLCrashAsyncThread API
 void plcrash_async_thread_state_clear_volatile_regs (plcrash_async_thread_state_t *thread_state) {
-    size_t table_count = sizeof(arm_nonvolatile_registers) / sizeof(arm_nonvolatile_registers[0]);;
+    const plcrash_regnum_t *table;
+    size_t table_count;
+
+    if (plcrash_async_thread_state_is_arm64(thread_state)) {
+        table = arm64_nonvolatile_registers;
+        table_count = sizeof(arm64_nonvolatile_registers) / sizeof(arm64_nonvolatile_registers[0]);
+    } else {
+        table = arm_nonvolatile_registers;
+        table_count = sizeof(arm_nonvolatile_registers) / sizeof(arm_nonvolatile_registers[0]);
+    }
     
     size_t reg_count = plcrash_async_thread_state_get_reg_count(thread_state);
     for (size_t reg = 0; reg < reg_count; reg++) {
@@ -296,7 +264,7 @@ void plcrash_async_thread_state_clear_volatile_regs (plcrash_async_thread_state_
         /* Check for the register in the preservation table */
         bool preserved = false;
         for (size_t i = 0; i < table_count; i++) {
-            if (arm_nonvolatile_registers[i] == reg) {
+            if (table[i] == reg) {
                 preserved = true;
                 break;
             }
@@ -308,11 +276,26 @@ void plcrash_async_thread_state_clear_volatile_regs (plcrash_async_thread_state_
     }
 }
 
+/* Fetch the DWARF register table corresponding to @a thread_state's flavor. */
+static void plcrash_async_thread_state_dwarf_table (const plcrash_async_thread_state_t *thread_state, const struct dwarf_register_table **table, size_t *count) {
+    if (plcrash_async_thread_state_is_arm64(thread_state)) {
+        *table = arm64_dwarf_table;
+        *count = sizeof(arm64_dwarf_table) / sizeof(arm64_dwarf_table[0]);
+    } else {
+        *table = arm_dwarf_table;
+        *count = sizeof(arm_dwarf_table) / sizeof(arm_dwarf_table[0]);
+    }
+}
+
 // PLCrashAsyncThread API
 bool plcrash_async_thread_state_map_reg_to_dwarf (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, uint64_t *dwarf_reg) {
-    for (size_t i = 0; i < sizeof(arm_dwarf_table) / sizeof(arm_dwarf_table[0]); i++) {
-        if (arm_dwarf_table[i].regnum == regnum) {
-            *dwarf_reg = arm_dwarf_table[i].dwarf_value;
+    const struct dwarf_register_table *table;
+    size_t table_count;
+    plcrash_async_thread_state_dwarf_table(thread_state, &table, &table_count);
+
+    for (size_t i = 0; i < table_count; i++) {
+        if (table[i].regnum == regnum) {
+            *dwarf_reg = table[i].dwarf_value;
             return true;
         }
     }
@@ -323,9 +306,13 @@ bool plcrash_async_thread_state_map_reg_to_dwarf (plcrash_async_thread_state_t *
 
 // PLCrashAsyncThread API
 bool plcrash_async_thread_state_map_dwarf_to_reg (const plcrash_async_thread_state_t *thread_state, uint64_t dwarf_reg, plcrash_regnum_t *regnum) {
-    for (size_t i = 0; i < sizeof(arm_dwarf_table) / sizeof(arm_dwarf_table[0]); i++) {
-        if (arm_dwarf_table[i].dwarf_value == dwarf_reg) {
-            *regnum = arm_dwarf_table[i].regnum;
+    const struct dwarf_register_table *table;
+    size_t table_count;
+    plcrash_async_thread_state_dwarf_table(thread_state, &table, &table_count);
+
+    for (size_t i = 0; i < table_count; i++) {
+        if (table[i].dwarf_value == dwarf_reg) {
+            *regnum = table[i].regnum;
             return true;
         }
     }
@@ -334,4 +321,4 @@ bool plcrash_async_thread_state_map_dwarf_to_reg (const plcrash_async_thread_sta
     return false;
 }
 
-#endif /* __arm__ */
+#endif /* __arm__ || __arm64__ */
@@ -42,7 +42,11 @@ plcrash_error_t plcrash_async_thread_state_current_stub (plcrash_async_thread_st
 {
     /* Zero unsupported thread states */
     plcrash_async_memset(&mctx->__es, 0, sizeof(mctx->__es));
+#if defined(__arm64__)
+    plcrash_async_memset(&mctx->__ns, 0, sizeof(mctx->__ns));
+#else
     plcrash_async_memset(&mctx->__fs, 0, sizeof(mctx->__fs));
+#endif
 
     /* Convert to standard thread state */
     plcrash_async_thread_state_t thread_state;
@@ -139,6 +143,25 @@ VOFF(es, trapno, 0);
 #undef OFF
 #undef VOFF
 
+#elif defined(__arm64__)
+
+/* There's a hard-coded dependency on this size in the trampoline assembly, so we explicitly validate it here. */
+VALIDATE(MCONTEXT_SIZE, sizeof(_STRUCT_MCONTEXT) == 816);
+
+/* Verify the expected offsets */
+#define OFF(struct, reg, offset) (offsetof(_STRUCT_MCONTEXT, __##struct.__##reg) == offset)
+#define VOFF(struct, reg, offset) VALIDATE(MCONTEXT_SS_OFFSET_##reg##_, OFF(struct, reg, offset))
+
+VOFF(ss, x, 16);
+VOFF(ss, fp, 248);
+VOFF(ss, lr, 256);
+VOFF(ss, sp, 264);
+VOFF(ss, pc, 272);
+VOFF(ss, cpsr, 280);
+
+#undef OFF
+#undef VOFF
+
 #elif defined(__arm__)
 
 /* There's a hard-coded dependency on this size in the trampoline assembly, so we explicitly validate it here. */
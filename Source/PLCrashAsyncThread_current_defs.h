@@ -49,6 +49,14 @@ extern "C" {
 /* sizeof(struct mcontext) */
 #define PL_MCONTEXT_SIZE 600
 
+#elif defined(__arm64__)
+
+/* sizeof(struct ucontext64) */
+#define PL_UCONTEXT_SIZE 56
+
+/* sizeof(struct mcontext64) */
+#define PL_MCONTEXT_SIZE 816
+
 #elif defined(__arm__)
 
 /* sizeof(struct ucontext) */
@@ -32,16 +32,7 @@
 #import <signal.h>
 #import <assert.h>
 #import <stdlib.h>
-
-#define RETGEN(name, type, ts) {\
-    return (ts->x86_state. type . __ ## name); \
-}
-
-#define SETGEN(name, type, ts, regnum, value) {\
-    ts->valid_regs |= 1<<regnum; \
-    (ts->x86_state. type . __ ## name) = value; \
-    break; \
-}
+#import <stddef.h>
 
 #if defined(__i386__) || defined(__x86_64__)
 
@@ -140,52 +131,66 @@ static const struct dwarf_register_table x86_64_dwarf_table [] = {
     { PLCRASH_X86_64_GS, 55 }
 };
 
-static plcrash_greg_t plcrash_async_thread_state_get_reg_32 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
-static plcrash_greg_t plcrash_async_thread_state_get_reg_64 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum);
-
-static void plcrash_async_thread_state_set_reg_32 (plcrash_async_thread_state_t *cursor, plcrash_regnum_t regnum, plcrash_greg_t reg);
-static void plcrash_async_thread_state_set_reg_64 (plcrash_async_thread_state_t *cursor, plcrash_regnum_t regnum, plcrash_greg_t reg);
-
-static const char *plcrash_async_thread_state_get_regname_32 (plcrash_regnum_t regnum);
-static const char *plcrash_async_thread_state_get_regname_64 (plcrash_regnum_t regnum);
-
-plcrash_regnum_t plcrash_async_thread_state_map_dwarf_reg_32 (uint64_t dwarf_reg, plcrash_regnum_t *regnum);
-plcrash_regnum_t plcrash_async_thread_state_map_dwarf_reg_64 (uint64_t dwarf_reg, plcrash_regnum_t *regnum);
-
-// PLCrashAsyncThread API
-plcrash_greg_t plcrash_async_thread_state_get_reg (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return plcrash_async_thread_state_get_reg_32(thread_state, regnum);
-    } else {
-        return plcrash_async_thread_state_get_reg_64(thread_state, regnum);
-    }
+/* Define a register table entry for the x86 thread state field @a field. */
+#define X86_REG(field, regname) { \
+    .name = regname, \
+    .offset = offsetof(plcrash_async_thread_state_t, x86_state.field), \
+    .size = sizeof(((plcrash_async_thread_state_t *) NULL)->x86_state.field) \
 }
 
-// PLCrashAsyncThread API
-void plcrash_async_thread_state_set_reg (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return plcrash_async_thread_state_set_reg_32(thread_state, regnum, reg);
-    } else {
-        return plcrash_async_thread_state_set_reg_64(thread_state, regnum, reg);
-    }
-}
+/* i386 register table, indexed by register number */
+static const plcrash_async_thread_reg_info_t x86_32_reg_table[] = {
+    [PLCRASH_X86_EAX]       = X86_REG(thread.uts.ts32.__eax, "eax"),
+    [PLCRASH_X86_EDX]       = X86_REG(thread.uts.ts32.__edx, "edx"),
+    [PLCRASH_X86_ECX]       = X86_REG(thread.uts.ts32.__ecx, "ecx"),
+    [PLCRASH_X86_EBX]       = X86_REG(thread.uts.ts32.__ebx, "ebx"),
+    [PLCRASH_X86_EBP]       = X86_REG(thread.uts.ts32.__ebp, "ebp"),
+    [PLCRASH_X86_ESI]       = X86_REG(thread.uts.ts32.__esi, "esi"),
+    [PLCRASH_X86_EDI]       = X86_REG(thread.uts.ts32.__edi, "edi"),
+    [PLCRASH_X86_ESP]       = X86_REG(thread.uts.ts32.__esp, "esp"),
+    [PLCRASH_X86_EIP]       = X86_REG(thread.uts.ts32.__eip, "eip"),
+    [PLCRASH_X86_EFLAGS]    = X86_REG(thread.uts.ts32.__eflags, "eflags"),
+    [PLCRASH_X86_TRAPNO]    = X86_REG(exception.ues.es32.__trapno, "trapno"),
+    [PLCRASH_X86_CS]        = X86_REG(thread.uts.ts32.__cs, "cs"),
+    [PLCRASH_X86_DS]        = X86_REG(thread.uts.ts32.__ds, "ds"),
+    [PLCRASH_X86_ES]        = X86_REG(thread.uts.ts32.__es, "es"),
+    [PLCRASH_X86_FS]        = X86_REG(thread.uts.ts32.__fs, "fs"),
+    [PLCRASH_X86_GS]        = X86_REG(thread.uts.ts32.__gs, "gs")
+};
 
-// PLCrashAsyncThread API
-char const *plcrash_async_thread_state_get_reg_name (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return plcrash_async_thread_state_get_regname_32(regnum);
-    } else {
-        return plcrash_async_thread_state_get_regname_64(regnum);
-    }
-}
+/* x86-64 register table, indexed by register number */
+static const plcrash_async_thread_reg_info_t x86_64_reg_table[] = {
+    [PLCRASH_X86_64_RAX]    = X86_REG(thread.uts.ts64.__rax, "rax"),
+    [PLCRASH_X86_64_RBX]    = X86_REG(thread.uts.ts64.__rbx, "rbx"),
+    [PLCRASH_X86_64_RCX]    = X86_REG(thread.uts.ts64.__rcx, "rcx"),
+    [PLCRASH_X86_64_RDX]    = X86_REG(thread.uts.ts64.__rdx, "rdx"),
+    [PLCRASH_X86_64_RDI]    = X86_REG(thread.uts.ts64.__rdi, "rdi"),
+    [PLCRASH_X86_64_RSI]    = X86_REG(thread.uts.ts64.__rsi, "rsi"),
+    [PLCRASH_X86_64_RBP]    = X86_REG(thread.uts.ts64.__rbp, "rbp"),
+    [PLCRASH_X86_64_RSP]    = X86_REG(thread.uts.ts64.__rsp, "rsp"),
+    [PLCRASH_X86_64_R8]     = X86_REG(thread.uts.ts64.__r8, "r8"),
+    [PLCRASH_X86_64_R9]     = X86_REG(thread.uts.ts64.__r9, "r9"),
+    [PLCRASH_X86_64_R10]    = X86_REG(thread.uts.ts64.__r10, "r10"),
+    [PLCRASH_X86_64_R11]    = X86_REG(thread.uts.ts64.__r11, "r11"),
+    [PLCRASH_X86_64_R12]    = X86_REG(thread.uts.ts64.__r12, "r12"),
+    [PLCRASH_X86_64_R13]    = X86_REG(thread.uts.ts64.__r13, "r13"),
+    [PLCRASH_X86_64_R14]    = X86_REG(thread.uts.ts64.__r14, "r14"),
+    [PLCRASH_X86_64_R15]    = X86_REG(thread.uts.ts64.__r15, "r15"),
+    [PLCRASH_X86_64_RIP]    = X86_REG(thread.uts.ts64.__rip, "rip"),
+    [PLCRASH_X86_64_RFLAGS] = X86_REG(thread.uts.ts64.__rflags, "rflags"),
+    [PLCRASH_X86_64_CS]     = X86_REG(thread.uts.ts64.__cs, "cs"),
+    [PLCRASH_X86_64_FS]     = X86_REG(thread.uts.ts64.__fs, "fs"),
+    [PLCRASH_X86_64_GS]     = X86_REG(thread.uts.ts64.__gs, "gs")
+};
 
 // PLCrashAsyncThread API
-size_t plcrash_async_thread_state_get_reg_count (const plcrash_async_thread_state_t *thread_state) {
-    /* Last is an index value, so increment to get the count */
+void plcrash_async_thread_state_resolve_regs (plcrash_async_thread_state_t *thread_state) {
     if (thread_state->x86_state.thread.tsh.flavor == x86_THREAD_STATE32) {
-        return PLCRASH_X86_LAST_REG+1;
+        thread_state->reg_table = x86_32_reg_table;
+        thread_state->reg_count = sizeof(x86_32_reg_table) / sizeof(x86_32_reg_table[0]);
     } else {
-        return PLCRASH_X86_64_LAST_REG+1;
+        thread_state->reg_table = x86_64_reg_table;
+        thread_state->reg_count = sizeof(x86_64_reg_table) / sizeof(x86_64_reg_table[0]);
     }
 }
 
@@ -271,434 +276,4 @@ bool plcrash_async_thread_state_map_reg_to_dwarf (plcrash_async_thread_state_t *
     return false;
 }
 
-/**
- * @internal
- * 32-bit implementation of plcrash_async_thread_state_get_reg()
- */
-static plcrash_greg_t plcrash_async_thread_state_get_reg_32 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    const plcrash_async_thread_state_t *ts = thread_state;
-
-    /* All word-sized registers */
-    switch (regnum) {
-        case PLCRASH_X86_EAX:
-            RETGEN(eax, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EDX:
-            RETGEN(edx, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ECX:
-            RETGEN(ecx, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EBX:
-            RETGEN(ebx, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EBP:
-            RETGEN(ebp, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ESI:
-            RETGEN(esi, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EDI:
-            RETGEN(edi, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ESP:
-            RETGEN(esp, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EIP:
-            RETGEN(eip, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_EFLAGS:
-            RETGEN(eflags, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_TRAPNO:
-            RETGEN(trapno, exception.ues.es32, ts);
-            
-        case PLCRASH_X86_CS:
-            RETGEN(cs, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_DS:
-            RETGEN(ds, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_ES:
-            RETGEN(es, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_FS:
-            RETGEN(fs, thread.uts.ts32, ts);
-            
-        case PLCRASH_X86_GS:
-            RETGEN(gs, thread.uts.ts32, ts);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
-    
-    /* Shouldn't be reachable */
-    return 0;
-}
-
-/**
- * @internal
- * 64-bit implementation of plcrash_async_thread_state_get_reg()
- */
-static plcrash_greg_t plcrash_async_thread_state_get_reg_64 (const plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum) {
-    const plcrash_async_thread_state_t *ts = thread_state;
-
-    switch (regnum) {
-        case PLCRASH_X86_64_RAX:
-            RETGEN(rax, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RBX:
-            RETGEN(rbx, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RCX:
-            RETGEN(rcx, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RDX:
-            RETGEN(rdx, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RDI:
-            RETGEN(rdi, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RSI:
-            RETGEN(rsi, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RBP:
-            RETGEN(rbp, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RSP:
-            RETGEN(rsp, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R8:
-            RETGEN(r8, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R9:
-            RETGEN(r9, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R10:
-            RETGEN(r10, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R11:
-            RETGEN(r11, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R12:
-            RETGEN(r12, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R13:
-            RETGEN(r13, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R14:
-            RETGEN(r14, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_R15:
-            RETGEN(r15, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RIP:
-            RETGEN(rip, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_RFLAGS:
-            RETGEN(rflags, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_CS:
-            RETGEN(cs, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_FS:
-            RETGEN(fs, thread.uts.ts64, ts);
-            
-        case PLCRASH_X86_64_GS:
-            RETGEN(gs, thread.uts.ts64, ts);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
-
-    /* Should not be reachable */
-    return 0;
-}
-
-/**
- * @internal
- * 32-bit implementation of plcrash_async_thread_state_set_reg()
- */
-static void plcrash_async_thread_state_set_reg_32 (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    plcrash_async_thread_state_t *ts = thread_state;
-    
-    /* All word-sized registers */
-    switch (regnum) {
-        case PLCRASH_X86_EAX:
-            SETGEN(eax, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EDX:
-            SETGEN(edx, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ECX:
-            SETGEN(ecx, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EBX:
-            SETGEN(ebx, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EBP:
-            SETGEN(ebp, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ESI:
-            SETGEN(esi, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EDI:
-            SETGEN(edi, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ESP:
-            SETGEN(esp, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EIP:
-            SETGEN(eip, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_EFLAGS:
-            SETGEN(eflags, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_TRAPNO:
-            SETGEN(trapno, exception.ues.es32, ts, regnum, reg);
-            
-        case PLCRASH_X86_CS:
-            SETGEN(cs, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_DS:
-            SETGEN(ds, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_ES:
-            SETGEN(es, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_FS:
-            SETGEN(fs, thread.uts.ts32, ts, regnum, reg);
-            
-        case PLCRASH_X86_GS:
-            SETGEN(gs, thread.uts.ts32, ts, regnum, reg);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }
-}
-
-/**
- * @internal
- * 64-bit implementation of plcrash_async_thread_state_set_reg()
- */
-static void plcrash_async_thread_state_set_reg_64 (plcrash_async_thread_state_t *thread_state, plcrash_regnum_t regnum, plcrash_greg_t reg) {
-    plcrash_async_thread_state_t *ts = thread_state;
-    
-    switch (regnum) {
-        case PLCRASH_X86_64_RAX:
-            SETGEN(rax, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RBX:
-            SETGEN(rbx, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RCX:
-            SETGEN(rcx, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RDX:
-            SETGEN(rdx, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RDI:
-            SETGEN(rdi, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RSI:
-            SETGEN(rsi, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RBP:
-            SETGEN(rbp, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RSP:
-            SETGEN(rsp, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R8:
-            SETGEN(r8, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R9:
-            SETGEN(r9, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R10:
-            SETGEN(r10, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R11:
-            SETGEN(r11, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R12:
-            SETGEN(r12, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R13:
-            SETGEN(r13, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R14:
-            SETGEN(r14, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_R15:
-            SETGEN(r15, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RIP:
-            SETGEN(rip, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_RFLAGS:
-            SETGEN(rflags, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_CS:
-            SETGEN(cs, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_FS:
-            SETGEN(fs, thread.uts.ts64, ts, regnum, reg);
-            
-        case PLCRASH_X86_64_GS:
-            SETGEN(gs, thread.uts.ts64, ts, regnum, reg);
-            
-        default:
-            // Unsupported register
-            __builtin_trap();
-    }    
-}
-
-/**
- * @internal
- * 32-bit implementation of plcrash_async_thread_state_get_regname()
- */
-static char const *plcrash_async_thread_state_get_regname_32 (plcrash_regnum_t regnum) {
-    /* All word-sized registers */
-    switch (regnum) {
-        case PLCRASH_X86_EAX:
-            return "eax";
-            
-        case PLCRASH_X86_EDX:
-            return "edx";
-            
-        case PLCRASH_X86_ECX:
-            return "ecx";
-            
-        case PLCRASH_X86_EBX:
-            return "ebx";
-            
-        case PLCRASH_X86_EBP:
-            return "ebp";
-            
-        case PLCRASH_X86_ESI:
-            return "esi";
-            
-        case PLCRASH_X86_EDI:
-            return "edi";
-            
-        case PLCRASH_X86_ESP:
-            return "esp";
-            
-        case PLCRASH_X86_EIP:
-            return "eip";
-            
-        case PLCRASH_X86_EFLAGS:
-            return "eflags";
-            
-        case PLCRASH_X86_TRAPNO:
-            return "trapno";
-            
-        case PLCRASH_X86_CS:
-            return "cs";
-            
-        case PLCRASH_X86_DS:
-            return "ds";
-            
-        case PLCRASH_X86_ES:
-            return "es";
-            
-        case PLCRASH_X86_FS:
-            return "fs";
-            
-        case PLCRASH_X86_GS:
-            return "gs";
-            
-        default:
-            // Unsupported register
-            break;
-    }
-    
-    /* Unsupported register is an implementation error (checked in unit tests) */
-    PLCF_DEBUG("Missing register name for register id: %d", regnum);
-    abort();
-}
-
-/**
- * @internal
- * 64-bit implementation of plcrash_async_thread_state_get_regname()
- */
-static const char *plcrash_async_thread_state_get_regname_64 (plcrash_regnum_t regnum) {
-    switch (regnum) {
-        case PLCRASH_X86_64_RAX:
-            return "rax";
-            
-        case PLCRASH_X86_64_RBX:
-            return "rbx";
-            
-        case PLCRASH_X86_64_RCX:
-            return "rcx";
-            
-        case PLCRASH_X86_64_RDX:
-            return "rdx";
-            
-        case PLCRASH_X86_64_RDI:
-            return "rdi";
-            
-        case PLCRASH_X86_64_RSI:
-            return "rsi";
-            
-        case PLCRASH_X86_64_RBP:
-            return "rbp";
-            
-        case PLCRASH_X86_64_RSP:
-            return "rsp";
-            
-        case PLCRASH_X86_64_R8:
-            return "r8";
-            
-        case PLCRASH_X86_64_R9:
-            return "r9";
-            
-        case PLCRASH_X86_64_R10:
-            return "r10";
-            
-        case PLCRASH_X86_64_R11:
-            return "r11";
-            
-        case PLCRASH_X86_64_R12:
-            return "r12";
-            
-        case PLCRASH_X86_64_R13:
-            return "r13";
-            
-        case PLCRASH_X86_64_R14:
-            return "r14";
-            
-        case PLCRASH_X86_64_R15:
-            return "r15";
-            
-        case PLCRASH_X86_64_RIP:
-            return "rip";
-            
-        case PLCRASH_X86_64_RFLAGS:
-            return "rflags";
-            
-        case PLCRASH_X86_64_CS:
-            return "cs";
-            
-        case PLCRASH_X86_64_FS:
-            return "fs";
-            
-        case PLCRASH_X86_64_GS:
-            return "gs";
-            
-        default:
-            // Unsupported register
-            break;
-    }
-    
-    /* Unsupported register is an implementation error (checked in unit tests) */
-    PLCF_DEBUG("Missing register name for register id: %d", regnum);
-    abort();
-}
-
 #endif /* defined(__i386__) || defined(__x86_64__) */
@@ -0,0 +1,167 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashAsyncTrace.h"
+
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_trace Debug Trace Ring
+ *
+ * Implements an async-safe binary trace of crash-path diagnostics. Each event is recorded as a fixed-format record,
+ * consisting of an event identifier and a small number of integer arguments, in a statically allocated ring; no
+ * formatting is performed, no locks are taken, and no memory is allocated.
+ *
+ * Producers claim a slot with a single atomic increment of the ring's sequence number, and publish the record by
+ * writing the slot's sequence number after the remainder of the record, as per the breadcrumb buffer. The ring is
+ * written verbatim to crash reports, and decoded using the event names and argument names below.
+ * @{
+ */
+
+/* The record layout is written verbatim to reports */
+PLCF_ASSERT_STATIC(trace_record_size, sizeof(plcrash_async_trace_record_t) == 40);
+PLCF_ASSERT_STATIC(trace_capacity_pow2, (PLCRASH_ASYNC_TRACE_CAPACITY & (PLCRASH_ASYNC_TRACE_CAPACITY - 1)) == 0);
+
+/**
+ * @internal
+ *
+ * A trace event's name and argument names.
+ */
+typedef struct plcrash_async_trace_event_desc {
+    /** The event name. */
+    const char *name;
+
+    /** The names of the event's arguments; unused arguments are NULL. */
+    const char *args[PLCRASH_ASYNC_TRACE_ARGS_MAX];
+} plcrash_async_trace_event_desc_t;
+
+/**
+ * @internal
+ *
+ * Event descriptions, indexed by plcrash_async_trace_event_t.
+ */
+static const plcrash_async_trace_event_desc_t plcrash_async_trace_events[PLCRASH_ASYNC_TRACE_EVENT_COUNT] = {
+    [PLCRASH_ASYNC_TRACE_EVENT_THREAD_STATE_FAILED]         = { "thread_state_failed",          { "thread", "error", NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_CURSOR_INIT_FAILED]          = { "cursor_init_failed",           { "thread", "error", NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_FRAME_PC_FAILED]             = { "frame_pc_failed",              { "thread", "error", NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED]             = { "walk_terminated",              { "thread", "error", "frames" } },
+    [PLCRASH_ASYNC_TRACE_EVENT_FRAME_MISSING_IP]            = { "frame_missing_ip",             { "depth", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_SNAPSHOT_ALLOC_FAILED]       = { "snapshot_alloc_failed",        { "threads", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_PARALLEL_CAPTURE_FAILED]     = { "parallel_capture_failed",      { "threads", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_THREAD_LIST_FAILED]          = { "thread_list_failed",           { "kr", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_TIMESTAMP_FAILED]            = { "timestamp_failed",             { "errno", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_SHARED_CACHE_FAILED]         = { "shared_cache_failed",          { "error", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_UNKNOWN_SIGNAL]              = { "unknown_signal",               { "signo", "code", NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_MESSAGE_LENGTH_FAILED]       = { "message_length_failed",        { "field", NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_VM_SUMMARY_INCOMPLETE]       = { "vm_summary_incomplete",        { NULL, NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_METRICS_FAILED]              = { "metrics_failed",               { NULL, NULL, NULL } },
+    [PLCRASH_ASYNC_TRACE_EVENT_WORKER_TIMEOUT]              = { "worker_timeout",               { "threads", NULL, NULL } },
+};
+
+/**
+ * @internal
+ *
+ * The shared trace ring; zero-filled slots are empty.
+ */
+static plcrash_async_trace_ring_t plcrash_async_trace_ring;
+
+/**
+ * Return the process-wide trace ring used by PLCF_TRACE().
+ *
+ * @par Async Safety
+ * This function is async-safe.
+ */
+plcrash_async_trace_ring_t *plcrash_async_trace_shared_ring (void) {
+    return &plcrash_async_trace_ring;
+}
+
+/**
+ * Append a trace record to @a ring, replacing the oldest record if the ring is full.
+ *
+ * @param ring The ring to which the record will be appended.
+ * @param level The event level.
+ * @param event The event.
+ * @param arg0 The event's first argument, or 0.
+ * @param arg1 The event's second argument, or 0.
+ * @param arg2 The event's third argument, or 0.
+ *
+ * @par Async Safety
+ * This function is async-safe, lock-free, and may be called concurrently from any number of threads.
+ */
+void plcrash_async_trace_ring_append (plcrash_async_trace_ring_t *ring, plcrash_async_trace_level_t level, plcrash_async_trace_event_t event,
+                                      uint64_t arg0, uint64_t arg1, uint64_t arg2)
+{
+    /* Claim the next slot */
+    uint64_t sequence = (uint64_t) OSAtomicIncrement64Barrier(&ring->sequence);
+    volatile plcrash_async_trace_record_t *record = &ring->records[(sequence - 1) & (PLCRASH_ASYNC_TRACE_CAPACITY - 1)];
+
+    /* Invalidate the slot while the record is written, and then publish it */
+    record->sequence = 0;
+    OSMemoryBarrier();
+
+    record->event = (uint16_t) event;
+    record->level = (uint8_t) level;
+    record->args[0] = arg0;
+    record->args[1] = arg1;
+    record->args[2] = arg2;
+    OSMemoryBarrier();
+
+    record->sequence = sequence;
+}
+
+/**
+ * Return the name of @a event, or NULL if the event is unknown.
+ *
+ * @param event A plcrash_async_trace_event_t value, as recorded. Events recorded by other versions of the library
+ * may be unknown.
+ */
+const char *plcrash_async_trace_event_name (uint32_t event) {
+    if (event >= PLCRASH_ASYNC_TRACE_EVENT_COUNT)
+        return NULL;
+
+    return plcrash_async_trace_events[event].name;
+}
+
+/**
+ * Return the name of @a event's argument at @a index, or NULL if the event is unknown or does not use the argument.
+ *
+ * @param event A plcrash_async_trace_event_t value, as recorded.
+ * @param index The argument index.
+ */
+const char *plcrash_async_trace_event_arg_name (uint32_t event, uint32_t index) {
+    if (event >= PLCRASH_ASYNC_TRACE_EVENT_COUNT || index >= PLCRASH_ASYNC_TRACE_ARGS_MAX)
+        return NULL;
+
+    return plcrash_async_trace_events[event].args[index];
+}
+
+/**
+ * @}
+ */
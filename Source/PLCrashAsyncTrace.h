@@ -0,0 +1,210 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_TRACE_H
+#define PLCRASH_ASYNC_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * The number of records retained by a trace ring. Must be a power of two.
+ */
+#define PLCRASH_ASYNC_TRACE_CAPACITY 256
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * The maximum number of integer arguments recorded with a single trace event.
+ */
+#define PLCRASH_ASYNC_TRACE_ARGS_MAX 3
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * Trace event levels. Events above PLCF_TRACE_LEVEL are compiled out.
+ */
+typedef enum {
+    /** An operation failed, and report data was lost. */
+    PLCRASH_ASYNC_TRACE_LEVEL_ERROR = 1,
+
+    /** An operation failed or was degraded, but the report remains complete. */
+    PLCRASH_ASYNC_TRACE_LEVEL_INFO = 2,
+
+    /** Detailed diagnostics. */
+    PLCRASH_ASYNC_TRACE_LEVEL_DEBUG = 3,
+} plcrash_async_trace_level_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * Trace events. Event values are written to crash reports, and decoded by name; new events must only be appended,
+ * and existing events must not be renumbered or reused.
+ */
+typedef enum {
+    /** Fetching a thread's register state failed. Arguments: thread, error. */
+    PLCRASH_ASYNC_TRACE_EVENT_THREAD_STATE_FAILED = 1,
+
+    /** Initializing a thread's frame cursor failed. Arguments: thread, error. */
+    PLCRASH_ASYNC_TRACE_EVENT_CURSOR_INIT_FAILED = 2,
+
+    /** Reading a frame's PC failed. Arguments: thread, error. */
+    PLCRASH_ASYNC_TRACE_EVENT_FRAME_PC_FAILED = 3,
+
+    /** A stack walk ended before reaching the end of the stack. Arguments: thread, error, frames walked. */
+    PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED = 4,
+
+    /** A frame reader produced a frame with no PC. Arguments: depth. */
+    PLCRASH_ASYNC_TRACE_EVENT_FRAME_MISSING_IP = 5,
+
+    /** Thread snapshots could not be allocated. Arguments: thread count. */
+    PLCRASH_ASYNC_TRACE_EVENT_SNAPSHOT_ALLOC_FAILED = 6,
+
+    /** Parallel capture state could not be allocated. Arguments: thread count. */
+    PLCRASH_ASYNC_TRACE_EVENT_PARALLEL_CAPTURE_FAILED = 7,
+
+    /** The task's thread list could not be fetched. Arguments: kern_return_t. */
+    PLCRASH_ASYNC_TRACE_EVENT_THREAD_LIST_FAILED = 8,
+
+    /** The report timestamp could not be fetched. Arguments: errno. */
+    PLCRASH_ASYNC_TRACE_EVENT_TIMESTAMP_FAILED = 9,
+
+    /** The shared cache could not be determined. Arguments: error. */
+    PLCRASH_ASYNC_TRACE_EVENT_SHARED_CACHE_FAILED = 10,
+
+    /** The signal number or code is unknown. Arguments: signo, code. */
+    PLCRASH_ASYNC_TRACE_EVENT_UNKNOWN_SIGNAL = 11,
+
+    /** A reserved message length could not be back-patched. Arguments: field. */
+    PLCRASH_ASYNC_TRACE_EVENT_MESSAGE_LENGTH_FAILED = 12,
+
+    /** The VM region summary is incomplete. No arguments. */
+    PLCRASH_ASYNC_TRACE_EVENT_VM_SUMMARY_INCOMPLETE = 13,
+
+    /** The crash-time metrics could not be back-patched. No arguments. */
+    PLCRASH_ASYNC_TRACE_EVENT_METRICS_FAILED = 14,
+
+    /** A crash-time worker did not complete its thread capture in time. Arguments: omitted thread count. */
+    PLCRASH_ASYNC_TRACE_EVENT_WORKER_TIMEOUT = 15,
+
+    /** The total number of trace events, plus one. */
+    PLCRASH_ASYNC_TRACE_EVENT_COUNT
+} plcrash_async_trace_event_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * A single trace record. The record layout is written verbatim to crash reports (CrashReport.debug_trace), in host
+ * byte order, and must not be changed.
+ */
+typedef struct plcrash_async_trace_record {
+    /** The record's sequence number, starting at 1, or 0 if the slot is empty or its record is being written. */
+    uint64_t sequence;
+
+    /** The plcrash_async_trace_event_t event. */
+    uint16_t event;
+
+    /** The plcrash_async_trace_level_t level. */
+    uint8_t level;
+
+    /** Reserved; always 0. */
+    uint8_t reserved[5];
+
+    /** The event's arguments; unused arguments are 0. */
+    uint64_t args[PLCRASH_ASYNC_TRACE_ARGS_MAX];
+} plcrash_async_trace_record_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * A statically allocated, lock-free, multi-producer ring of trace records.
+ */
+typedef struct plcrash_async_trace_ring {
+    /** The sequence number most recently claimed by a producer. */
+    volatile int64_t sequence;
+
+    /** The record slots. */
+    plcrash_async_trace_record_t records[PLCRASH_ASYNC_TRACE_CAPACITY];
+} plcrash_async_trace_ring_t;
+
+plcrash_async_trace_ring_t *plcrash_async_trace_shared_ring (void);
+
+void plcrash_async_trace_ring_append (plcrash_async_trace_ring_t *ring, plcrash_async_trace_level_t level, plcrash_async_trace_event_t event,
+                                      uint64_t arg0, uint64_t arg1, uint64_t arg2);
+
+const char *plcrash_async_trace_event_name (uint32_t event);
+const char *plcrash_async_trace_event_arg_name (uint32_t event, uint32_t index);
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * The maximum plcrash_async_trace_level_t recorded by PLCF_TRACE(). Events above this level are compiled out. May be
+ * defined by the build; defaults to PLCRASH_ASYNC_TRACE_LEVEL_INFO in release builds, and
+ * PLCRASH_ASYNC_TRACE_LEVEL_DEBUG otherwise.
+ */
+#ifndef PLCF_TRACE_LEVEL
+#  ifdef PLCF_RELEASE_BUILD
+#    define PLCF_TRACE_LEVEL PLCRASH_ASYNC_TRACE_LEVEL_INFO
+#  else
+#    define PLCF_TRACE_LEVEL PLCRASH_ASYNC_TRACE_LEVEL_DEBUG
+#  endif
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_async_trace
+ *
+ * Record a trace event with up to PLCRASH_ASYNC_TRACE_ARGS_MAX integer arguments in the shared trace ring. Unlike
+ * PLCF_DEBUG(), no formatting is performed; this is async-safe, and cheap enough to remain enabled in release builds.
+ *
+ * @param level The plcrash_async_trace_level_t event level.
+ * @param event The plcrash_async_trace_event_t event.
+ */
+#define PLCF_TRACE(level, event, arg0, arg1, arg2) do { \
+    if ((level) <= PLCF_TRACE_LEVEL) \
+        plcrash_async_trace_ring_append(plcrash_async_trace_shared_ring(), (level), (event), (uint64_t) (arg0), (uint64_t) (arg1), (uint64_t) (arg2)); \
+} while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_TRACE_H */
@@ -0,0 +1,100 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncTrace.h"
+
+@interface PLCrashAsyncTraceTests : SenTestCase {
+@private
+    plcrash_async_trace_ring_t _ring;
+}
+@end
+
+@implementation PLCrashAsyncTraceTests
+
+- (void) setUp {
+    memset(&_ring, 0, sizeof(_ring));
+}
+
+/**
+ * Test appending records.
+ */
+- (void) testAppend {
+    plcrash_async_trace_ring_append(&_ring, PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED, 1, 2, 3);
+    plcrash_async_trace_ring_append(&_ring, PLCRASH_ASYNC_TRACE_LEVEL_DEBUG, PLCRASH_ASYNC_TRACE_EVENT_FRAME_MISSING_IP, 4, 0, 0);
+
+    STAssertEquals(_ring.sequence, (int64_t) 2, @"Incorrect ring sequence");
+
+    const plcrash_async_trace_record_t *record = &_ring.records[0];
+    STAssertEquals(record->sequence, (uint64_t) 1, @"Incorrect sequence");
+    STAssertEquals(record->event, (uint16_t) PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED, @"Incorrect event");
+    STAssertEquals(record->level, (uint8_t) PLCRASH_ASYNC_TRACE_LEVEL_ERROR, @"Incorrect level");
+    STAssertEquals(record->args[0], (uint64_t) 1, @"Incorrect argument");
+    STAssertEquals(record->args[1], (uint64_t) 2, @"Incorrect argument");
+    STAssertEquals(record->args[2], (uint64_t) 3, @"Incorrect argument");
+
+    record = &_ring.records[1];
+    STAssertEquals(record->sequence, (uint64_t) 2, @"Incorrect sequence");
+    STAssertEquals(record->event, (uint16_t) PLCRASH_ASYNC_TRACE_EVENT_FRAME_MISSING_IP, @"Incorrect event");
+    STAssertEquals(record->args[0], (uint64_t) 4, @"Incorrect argument");
+
+    STAssertEquals(_ring.records[2].sequence, (uint64_t) 0, @"Unused slot is not empty");
+}
+
+/**
+ * Verify that the oldest records are replaced once the ring wraps.
+ */
+- (void) testAppendWraps {
+    for (uint64_t i = 1; i <= PLCRASH_ASYNC_TRACE_CAPACITY + 2; i++)
+        plcrash_async_trace_ring_append(&_ring, PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_THREAD_STATE_FAILED, i, 0, 0);
+
+    /* Slots 0 and 1 hold the two newest records; slot 2 holds the oldest retained record */
+    STAssertEquals(_ring.records[0].sequence, (uint64_t) PLCRASH_ASYNC_TRACE_CAPACITY + 1, @"Incorrect sequence");
+    STAssertEquals(_ring.records[1].sequence, (uint64_t) PLCRASH_ASYNC_TRACE_CAPACITY + 2, @"Incorrect sequence");
+    STAssertEquals(_ring.records[1].args[0], (uint64_t) PLCRASH_ASYNC_TRACE_CAPACITY + 2, @"Incorrect argument");
+    STAssertEquals(_ring.records[2].sequence, (uint64_t) 3, @"Incorrect sequence");
+}
+
+/**
+ * Verify event and argument name lookup, including for unknown events.
+ */
+- (void) testNames {
+    STAssertTrue(strcmp(plcrash_async_trace_event_name(PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED), "walk_terminated") == 0, @"Incorrect event name");
+    STAssertNotNULL(plcrash_async_trace_event_arg_name(PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED, 2), @"Missing argument name");
+    STAssertNULL(plcrash_async_trace_event_arg_name(PLCRASH_ASYNC_TRACE_EVENT_FRAME_MISSING_IP, 1), @"Unused argument was named");
+
+    /* Every defined event must be named */
+    for (uint32_t event = 1; event < PLCRASH_ASYNC_TRACE_EVENT_COUNT; event++)
+        STAssertNotNULL(plcrash_async_trace_event_name(event), @"Event %u is not named", event);
+
+    STAssertNULL(plcrash_async_trace_event_name(0), @"Invalid event was named");
+    STAssertNULL(plcrash_async_trace_event_name(PLCRASH_ASYNC_TRACE_EVENT_COUNT), @"Unknown event was named");
+    STAssertNULL(plcrash_async_trace_event_arg_name(PLCRASH_ASYNC_TRACE_EVENT_COUNT, 0), @"Unknown event argument was named");
+}
+
+@end
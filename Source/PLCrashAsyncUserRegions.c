@@ -0,0 +1,197 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashAsyncUserRegions.h"
+
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_user_regions User Memory Regions
+ *
+ * Implements a fixed-capacity, lock-free registry of application memory regions -- small, critical state structures
+ * such as the current screen or request identifier -- that are copied verbatim into each report.
+ *
+ * Each slot carries a generation counter that is odd while the slot is being modified. Producers claim a slot
+ * with a single compare-and-swap of its generation, and release it by incrementing the generation once modified.
+ * At crash time, the writer snapshots each slot without locking, and discards any slot whose generation changed
+ * while it was read; the region's contents are then copied with a single bounded plcrash_async_task_memcpy(),
+ * which fails gracefully if the region has since been deallocated.
+ * @{
+ */
+
+/**
+ * Initialize @a regions with no registered regions.
+ *
+ * @param regions The registry to initialize.
+ */
+void plcrash_async_user_regions_init (plcrash_async_user_regions_t *regions) {
+    plcrash_async_memset(regions, 0, sizeof(*regions));
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Claim @a slot if it holds @a address. On success, the slot's generation is left odd, and the slot must be released
+ * with pl_user_region_release().
+ *
+ * @param slot The slot to claim.
+ * @param address The address the slot must hold; 0 to claim a free slot.
+ */
+static bool pl_user_region_claim (plcrash_async_user_region_t *slot, pl_vm_address_t address) {
+    int32_t current = slot->generation;
+    if ((current & 1) != 0 || slot->address != address)
+        return false;
+
+    if (!OSAtomicCompareAndSwap32Barrier(current, current + 1, &slot->generation))
+        return false;
+
+    /* The slot may have been modified between the address check and the claim */
+    if (slot->address != address) {
+        OSAtomicIncrement32Barrier(&slot->generation);
+        return false;
+    }
+
+    return true;
+}
+
+/* Release a slot claimed with pl_user_region_claim(), publishing its modified contents. */
+static void pl_user_region_release (plcrash_async_user_region_t *slot) {
+    OSMemoryBarrier();
+    OSAtomicIncrement32Barrier(&slot->generation);
+}
+
+/**
+ * Register a region to be copied into each report.
+ *
+ * @param regions The registry.
+ * @param address The region's address. Must not be NULL.
+ * @param length The region's length, in bytes. Must not be zero or exceed PLCRASH_ASYNC_USER_REGION_LENGTH_MAX.
+ * @param tag A caller-defined tag, written to the report alongside the region's contents.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a address or @a length is invalid, or
+ * PLCRASH_ENOMEM if PLCRASH_ASYNC_USER_REGIONS_MAX regions are already registered.
+ *
+ * @par Async Safety
+ * This function is async-safe, lock-free, and may be called concurrently from any number of threads.
+ */
+plcrash_error_t plcrash_async_user_regions_add (plcrash_async_user_regions_t *regions, const void *address, size_t length, uint32_t tag) {
+    if (address == NULL || length == 0 || length > PLCRASH_ASYNC_USER_REGION_LENGTH_MAX)
+        return PLCRASH_EINVAL;
+
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_USER_REGIONS_MAX; i++) {
+        plcrash_async_user_region_t *slot = &regions->slots[i];
+        if (!pl_user_region_claim(slot, 0))
+            continue;
+
+        slot->tag = tag;
+        slot->length = length;
+        slot->address = (pl_vm_address_t) address;
+        pl_user_region_release(slot);
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    return PLCRASH_ENOMEM;
+}
+
+/**
+ * Remove a registration of @a address. If @a address was registered more than once, only one registration is removed.
+ *
+ * @param regions The registry.
+ * @param address The address of a previously registered region.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOTFOUND if @a address is not registered.
+ *
+ * @par Async Safety
+ * This function is async-safe, lock-free, and may be called concurrently from any number of threads. The region's
+ * memory may be deallocated once this function returns; a report being written concurrently may still attempt to
+ * read it, which will fail gracefully.
+ */
+plcrash_error_t plcrash_async_user_regions_remove (plcrash_async_user_regions_t *regions, const void *address) {
+    if (address == NULL)
+        return PLCRASH_ENOTFOUND;
+
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_USER_REGIONS_MAX; i++) {
+        plcrash_async_user_region_t *slot = &regions->slots[i];
+        if (!pl_user_region_claim(slot, (pl_vm_address_t) address))
+            continue;
+
+        slot->address = 0;
+        slot->length = 0;
+        slot->tag = 0;
+        pl_user_region_release(slot);
+
+        return PLCRASH_ESUCCESS;
+    }
+
+    return PLCRASH_ENOTFOUND;
+}
+
+/**
+ * Fetch a consistent snapshot of the region registered in the slot at @a index.
+ *
+ * @param regions The registry.
+ * @param index The slot index, less than PLCRASH_ASYNC_USER_REGIONS_MAX.
+ * @param[out] tag On success, the region's tag.
+ * @param[out] address On success, the region's address.
+ * @param[out] length On success, the region's length.
+ *
+ * @return Returns true if the slot holds a registered region, or false if the slot is free, or was being modified.
+ *
+ * @par Async Safety
+ * This function is async-safe, and never blocks.
+ */
+bool plcrash_async_user_regions_get (plcrash_async_user_regions_t *regions, uint32_t index, uint32_t *tag, pl_vm_address_t *address, pl_vm_size_t *length) {
+    plcrash_async_user_region_t *slot = &regions->slots[index];
+
+    int32_t generation = slot->generation;
+    if ((generation & 1) != 0)
+        return false;
+    OSMemoryBarrier();
+
+    uint32_t t = slot->tag;
+    pl_vm_address_t a = slot->address;
+    pl_vm_size_t l = slot->length;
+    OSMemoryBarrier();
+
+    /* Discard the snapshot if the slot was modified while being read */
+    if (slot->generation != generation || a == 0 || l > PLCRASH_ASYNC_USER_REGION_LENGTH_MAX)
+        return false;
+
+    *tag = t;
+    *address = a;
+    *length = l;
+    return true;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,96 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_USER_REGIONS_H
+#define PLCRASH_ASYNC_USER_REGIONS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_user_regions
+ *
+ * The maximum number of regions that may be registered at once.
+ */
+#define PLCRASH_ASYNC_USER_REGIONS_MAX 16
+
+/**
+ * @internal
+ * @ingroup plcrash_async_user_regions
+ *
+ * The maximum length of a single registered region, in bytes.
+ */
+#define PLCRASH_ASYNC_USER_REGION_LENGTH_MAX 4096
+
+/**
+ * @internal
+ * @ingroup plcrash_async_user_regions
+ *
+ * A single registration slot.
+ */
+typedef struct plcrash_async_user_region {
+    /** The slot's generation. Odd while the slot is being modified, and incremented on each modification. */
+    volatile int32_t generation;
+
+    /** The caller-defined tag. */
+    uint32_t tag;
+
+    /** The region's address, or 0 if the slot is free. */
+    pl_vm_address_t address;
+
+    /** The region's length, in bytes. */
+    pl_vm_size_t length;
+} plcrash_async_user_region_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_user_regions
+ *
+ * A fixed-capacity, lock-free registry of application memory regions to be copied into each report.
+ */
+typedef struct plcrash_async_user_regions {
+    /** The registration slots. */
+    plcrash_async_user_region_t slots[PLCRASH_ASYNC_USER_REGIONS_MAX];
+} plcrash_async_user_regions_t;
+
+void plcrash_async_user_regions_init (plcrash_async_user_regions_t *regions);
+plcrash_error_t plcrash_async_user_regions_add (plcrash_async_user_regions_t *regions, const void *address, size_t length, uint32_t tag);
+plcrash_error_t plcrash_async_user_regions_remove (plcrash_async_user_regions_t *regions, const void *address);
+bool plcrash_async_user_regions_get (plcrash_async_user_regions_t *regions, uint32_t index, uint32_t *tag, pl_vm_address_t *address, pl_vm_size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_USER_REGIONS_H */
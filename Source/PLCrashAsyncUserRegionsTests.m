@@ -0,0 +1,103 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncUserRegions.h"
+
+@interface PLCrashAsyncUserRegionsTests : SenTestCase {
+@private
+    plcrash_async_user_regions_t _regions;
+}
+@end
+
+@implementation PLCrashAsyncUserRegionsTests
+
+- (void) setUp {
+    plcrash_async_user_regions_init(&_regions);
+}
+
+/**
+ * Test registering, fetching, and removing a region.
+ */
+- (void) testAddRemove {
+    char state[] = "screen";
+    uint32_t tag;
+    pl_vm_address_t address;
+    pl_vm_size_t length;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_add(&_regions, state, sizeof(state), 42), @"Failed to register region");
+    STAssertTrue(plcrash_async_user_regions_get(&_regions, 0, &tag, &address, &length), @"Registered region not found");
+    STAssertEquals(tag, (uint32_t) 42, @"Incorrect tag");
+    STAssertEquals(address, (pl_vm_address_t) state, @"Incorrect address");
+    STAssertEquals(length, (pl_vm_size_t) sizeof(state), @"Incorrect length");
+
+    for (uint32_t i = 1; i < PLCRASH_ASYNC_USER_REGIONS_MAX; i++)
+        STAssertFalse(plcrash_async_user_regions_get(&_regions, i, &tag, &address, &length), @"Slot %u is not free", i);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_remove(&_regions, state), @"Failed to remove region");
+    STAssertFalse(plcrash_async_user_regions_get(&_regions, 0, &tag, &address, &length), @"Removed region was returned");
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_async_user_regions_remove(&_regions, state), @"Removed region was found");
+
+    /* The freed slot is reused */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_add(&_regions, state, 1, 7), @"Failed to register region");
+    STAssertTrue(plcrash_async_user_regions_get(&_regions, 0, &tag, &address, &length), @"Freed slot was not reused");
+    STAssertEquals(tag, (uint32_t) 7, @"Incorrect tag");
+}
+
+/**
+ * Verify that invalid regions are rejected, and that the registry capacity is enforced.
+ */
+- (void) testAddInvalid {
+    static char bytes[PLCRASH_ASYNC_USER_REGIONS_MAX + 1];
+
+    STAssertEquals(PLCRASH_EINVAL, plcrash_async_user_regions_add(&_regions, NULL, 1, 0), @"NULL region was accepted");
+    STAssertEquals(PLCRASH_EINVAL, plcrash_async_user_regions_add(&_regions, bytes, 0, 0), @"Empty region was accepted");
+    STAssertEquals(PLCRASH_EINVAL, plcrash_async_user_regions_add(&_regions, bytes, PLCRASH_ASYNC_USER_REGION_LENGTH_MAX + 1, 0), @"Oversized region was accepted");
+
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_USER_REGIONS_MAX; i++)
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_add(&_regions, &bytes[i], 1, i), @"Failed to register region %u", i);
+
+    STAssertEquals(PLCRASH_ENOMEM, plcrash_async_user_regions_add(&_regions, &bytes[PLCRASH_ASYNC_USER_REGIONS_MAX], 1, 0), @"Registry capacity was exceeded");
+}
+
+/**
+ * Verify that a slot being modified is not returned.
+ */
+- (void) testGetSkipsBusySlot {
+    char state = 'x';
+    uint32_t tag;
+    pl_vm_address_t address;
+    pl_vm_size_t length;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_add(&_regions, &state, 1, 1), @"Failed to register region");
+
+    _regions.slots[0].generation++;
+    STAssertFalse(plcrash_async_user_regions_get(&_regions, 0, &tag, &address, &length), @"Busy slot was returned");
+}
+
+@end
@@ -0,0 +1,147 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashAsyncVMSummary.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_vm_summary VM Usage Summaries
+ *
+ * Implements a fixed-size summary of a task's memory usage, suitable for inclusion in a crash report. Many
+ * terminations are the result of memory pressure; recording the task's footprint, and the regions that account for
+ * it, allows crashes to be correlated with memory growth without a separate memory profiler.
+ *
+ * @{
+ */
+
+/**
+ * Populate @a summary with the memory usage of @a task. The task's VM statistics are fetched via TASK_VM_INFO, and
+ * its VM regions are enumerated via mach_vm_region_recurse(), descending into submaps, and totalled by user tag.
+ *
+ * For a consistent summary, all of the target task's threads should be suspended.
+ *
+ * @param summary The summary to populate. Any existing contents are discarded.
+ * @param task The target task.
+ * @param max_regions The maximum number of regions to be visited. If the address space contains further regions,
+ * the summary's @a truncated flag will be set.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINTERNAL if the address space could not be enumerated.
+ * The task statistics may be valid even if enumeration fails.
+ *
+ * @warning The page counts returned by the kernel are converted using the current task's page size.
+ */
+plcrash_error_t plcrash_async_vm_summary_build (plcrash_async_vm_summary_t *summary, task_t task, uint32_t max_regions) {
+    plcrash_async_memset(summary, 0, sizeof(*summary));
+
+    /* Task-level statistics */
+#ifdef TASK_VM_INFO
+    task_vm_info_data_t vm_info;
+    mach_msg_type_number_t count = TASK_VM_INFO_COUNT;
+    if (task_info(task, TASK_VM_INFO, (task_info_t) &vm_info, &count) == KERN_SUCCESS) {
+        summary->has_task_info = true;
+        summary->virtual_size = vm_info.virtual_size;
+        summary->resident_size = vm_info.resident_size;
+        summary->resident_size_peak = vm_info.resident_size_peak;
+        summary->compressed_size = vm_info.compressed;
+
+#ifdef TASK_VM_INFO_REV1_COUNT
+        /* Older kernels return the shorter, revision 0 structure */
+        if (count >= TASK_VM_INFO_REV1_COUNT) {
+            summary->has_phys_footprint = true;
+            summary->phys_footprint = vm_info.phys_footprint;
+        }
+#endif
+    }
+#endif
+
+    /* Regions */
+    uint64_t page_size = vm_page_size;
+    pl_vm_address_t address = 0;
+    natural_t depth = 0;
+    kern_return_t kt;
+
+    while (true) {
+        vm_region_submap_info_data_64_t info;
+        mach_msg_type_number_t info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
+#ifdef PL_HAVE_MACH_VM
+        pl_vm_size_t size = 0;
+        kt = mach_vm_region_recurse(task, &address, &size, &depth, (vm_region_recurse_info_t) &info, &info_count);
+#else
+        vm_address_t vm_address = address;
+        vm_size_t size = 0;
+        kt = vm_region_recurse_64(task, &vm_address, &size, &depth, (vm_region_recurse_info_t) &info, &info_count);
+        address = vm_address;
+#endif
+
+        /* KERN_INVALID_ADDRESS marks the end of the address space */
+        if (kt == KERN_INVALID_ADDRESS)
+            break;
+
+        if (kt != KERN_SUCCESS) {
+            PLCF_DEBUG("Region enumeration failed: %d", kt);
+            return PLCRASH_EINTERNAL;
+        }
+
+        /* Descend into submaps */
+        if (info.is_submap) {
+            depth++;
+            continue;
+        }
+
+        /* Stop once the region limit has been reached */
+        if (summary->region_count == max_regions) {
+            summary->truncated = true;
+            break;
+        }
+        summary->region_count++;
+
+        /* Untagged file-backed mappings are recorded separately from anonymous memory */
+        uint32_t index = info.user_tag % PLCRASH_ASYNC_VM_SUMMARY_TAG_COUNT;
+        if (index == 0 && info.external_pager)
+            index = PLCRASH_ASYNC_VM_SUMMARY_MAPPED_FILE;
+
+        plcrash_async_vm_summary_bucket_t *bucket = &summary->buckets[index];
+        bucket->region_count++;
+        bucket->virtual_size += size;
+        bucket->resident_size += (uint64_t) info.pages_resident * page_size;
+        bucket->dirty_size += (uint64_t) info.pages_dirtied * page_size;
+        bucket->swapped_size += (uint64_t) info.pages_swapped_out * page_size;
+
+        /* Advance to the next region, stopping on overflow */
+        if (PL_VM_ADDRESS_MAX - size < address)
+            break;
+        address += size;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @} plcrash_async_vm_summary
+ */
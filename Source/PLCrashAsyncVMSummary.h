@@ -0,0 +1,143 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_ASYNC_VM_SUMMARY_H
+#define PLCRASH_ASYNC_VM_SUMMARY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <mach/mach.h>
+
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vm_summary
+ *
+ * The number of distinct VM region user tags (VM_MEMORY_*).
+ */
+#define PLCRASH_ASYNC_VM_SUMMARY_TAG_COUNT 256
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vm_summary
+ *
+ * The bucket index used for untagged, file-backed regions, such as mapped Mach-O images and the dyld shared cache.
+ */
+#define PLCRASH_ASYNC_VM_SUMMARY_MAPPED_FILE PLCRASH_ASYNC_VM_SUMMARY_TAG_COUNT
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vm_summary
+ *
+ * The total number of region buckets; one per user tag, and one for mapped files.
+ */
+#define PLCRASH_ASYNC_VM_SUMMARY_BUCKET_COUNT (PLCRASH_ASYNC_VM_SUMMARY_TAG_COUNT + 1)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vm_summary
+ *
+ * The default maximum number of VM regions visited by plcrash_async_vm_summary_build().
+ */
+#define PLCRASH_ASYNC_VM_SUMMARY_MAX_REGIONS 16384
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vm_summary
+ *
+ * The aggregate size of all VM regions sharing a user tag.
+ */
+typedef struct plcrash_async_vm_summary_bucket {
+    /** The number of regions. */
+    uint32_t region_count;
+
+    /** The total virtual size of the regions, in bytes. */
+    uint64_t virtual_size;
+
+    /** The total size of the regions' resident pages, in bytes. */
+    uint64_t resident_size;
+
+    /** The total size of the regions' dirtied pages, in bytes. */
+    uint64_t dirty_size;
+
+    /** The total size of the regions' swapped out or compressed pages, in bytes. */
+    uint64_t swapped_size;
+} plcrash_async_vm_summary_bucket_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_vm_summary
+ *
+ * A summary of a task's memory usage, consisting of the task's overall VM statistics and the sizes of its VM regions
+ * grouped by user tag. The summary is fixed-size, and may be populated at crash time.
+ */
+typedef struct plcrash_async_vm_summary {
+    /** If true, the task-level statistics below are valid. */
+    bool has_task_info;
+
+    /** The task's virtual size, in bytes. */
+    uint64_t virtual_size;
+
+    /** The task's resident size, in bytes. */
+    uint64_t resident_size;
+
+    /** The task's peak resident size, in bytes. */
+    uint64_t resident_size_peak;
+
+    /** The size of the task's compressed memory, in bytes. */
+    uint64_t compressed_size;
+
+    /** If true, @a phys_footprint is valid. Requires iOS 9 or Mac OS X 10.11 or later. */
+    bool has_phys_footprint;
+
+    /** The task's physical footprint, as used by the kernel to enforce memory limits, in bytes. */
+    uint64_t phys_footprint;
+
+    /** The number of regions visited. */
+    uint32_t region_count;
+
+    /** If true, region enumeration was stopped before reaching the end of the address space, and the bucket totals
+     * are incomplete. */
+    bool truncated;
+
+    /** Per-tag region totals, indexed by user tag, followed by the PLCRASH_ASYNC_VM_SUMMARY_MAPPED_FILE bucket. */
+    plcrash_async_vm_summary_bucket_t buckets[PLCRASH_ASYNC_VM_SUMMARY_BUCKET_COUNT];
+} plcrash_async_vm_summary_t;
+
+plcrash_error_t plcrash_async_vm_summary_build (plcrash_async_vm_summary_t *summary, task_t task, uint32_t max_regions);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_VM_SUMMARY_H */
@@ -0,0 +1,80 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncVMSummary.h"
+
+@interface PLCrashAsyncVMSummaryTests : SenTestCase {
+@private
+    plcrash_async_vm_summary_t _summary;
+}
+@end
+
+@implementation PLCrashAsyncVMSummaryTests
+
+/**
+ * Verify that the current task's statistics and regions are summarized.
+ */
+- (void) testBuild {
+    /* Ensure that at least one large malloc region exists */
+    size_t len = 1024 * 1024;
+    void *allocation = malloc(len);
+    memset(allocation, 0xFF, len);
+
+    STAssertEquals(plcrash_async_vm_summary_build(&_summary, mach_task_self(), PLCRASH_ASYNC_VM_SUMMARY_MAX_REGIONS), PLCRASH_ESUCCESS, @"Failed to build summary");
+    free(allocation);
+
+    STAssertTrue(_summary.has_task_info, @"Task statistics were not fetched");
+    STAssertTrue(_summary.resident_size > 0, @"Resident size was not recorded");
+    STAssertTrue(_summary.region_count > 0, @"No regions were visited");
+    STAssertFalse(_summary.truncated, @"Summary was truncated");
+
+    /* The regions visited must be accounted for by the buckets */
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_VM_SUMMARY_BUCKET_COUNT; i++) {
+        total += _summary.buckets[i].region_count;
+        STAssertTrue(_summary.buckets[i].resident_size <= _summary.buckets[i].virtual_size, @"Resident size of bucket %u exceeds its virtual size", i);
+    }
+    STAssertEquals(total, _summary.region_count, @"Region counts do not match");
+
+    /* Our own image is file-backed, and malloc regions are tagged */
+    STAssertTrue(_summary.buckets[PLCRASH_ASYNC_VM_SUMMARY_MAPPED_FILE].region_count > 0, @"No mapped file regions were found");
+    STAssertTrue(_summary.buckets[VM_MEMORY_MALLOC_LARGE].region_count > 0 || _summary.buckets[VM_MEMORY_MALLOC].region_count > 0,
+                 @"No malloc regions were found");
+}
+
+/**
+ * Verify that enumeration is stopped once the region limit is reached.
+ */
+- (void) testRegionLimit {
+    STAssertEquals(plcrash_async_vm_summary_build(&_summary, mach_task_self(), 1), PLCRASH_ESUCCESS, @"Failed to build summary");
+    STAssertEquals(_summary.region_count, (uint32_t) 1, @"Region limit was not applied");
+    STAssertTrue(_summary.truncated, @"Summary was not marked as truncated");
+}
+
+@end
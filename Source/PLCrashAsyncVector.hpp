@@ -0,0 +1,409 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef PLCRASH_ASYNC_VECTOR_H
+#define PLCRASH_ASYNC_VECTOR_H 1
+
+#include "PLCrashAsync.h"
+#include <libkern/OSAtomic.h>
+
+namespace plcrash { namespace async {
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * Return the index of the first element of the sorted array @a items that does not compare less than @a key.
+ *
+ * @param items A sorted array of elements.
+ * @param count The number of elements in @a items.
+ * @param key The key to search for.
+ * @param key_of A function returning the sort key of an element.
+ *
+ * @return Returns the index of the first element not less than @a key, or @a count if no such element exists.
+ */
+template <typename T, typename K> static inline size_t async_lower_bound (const T *items, size_t count, const K &key, K (*key_of)(const T &)) {
+    size_t low = 0;
+    size_t high = count;
+
+    while (low < high) {
+        size_t mid = low + ((high - low) / 2);
+        if (key_of(items[mid]) < key)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * An async-safe, fixed-capacity vector.
+ *
+ * Elements are stored in caller-supplied, pre-allocated storage. Appending never allocates, and a new element is
+ * only made visible to readers once it has been fully written; reading may occur concurrently with a single writer,
+ * including from a signal handler. Concurrent writers must be serialized by the caller.
+ *
+ * @tparam T The element type. Elements are copied on insertion.
+ */
+template <typename T>
+class async_vector {
+public:
+    /**
+     * Return the number of bytes of storage required for a vector of @a capacity elements.
+     *
+     * @param capacity The vector capacity.
+     */
+    static inline size_t storage_size (size_t capacity) {
+        return sizeof(T) * capacity;
+    }
+
+    async_vector (void *storage, size_t capacity);
+
+    bool nasync_append (const T &value);
+    void nasync_clear (void);
+
+    /** Return the number of published elements. */
+    inline size_t count (void) const { return _count; }
+
+    /** Return the maximum number of elements. */
+    inline size_t capacity (void) const { return _capacity; }
+
+    /** Return a pointer to the vector's elements. Only the first count() elements are valid. */
+    inline const T *data (void) const { return _items; }
+
+    /**
+     * Return the element at @a index.
+     *
+     * @param index The element index. Must be less than count().
+     */
+    inline const T &operator[] (size_t index) const {
+        PLCF_ASSERT(index < _count);
+        return _items[index];
+    }
+
+private:
+    /** The element storage. */
+    T *_items;
+
+    /** The maximum number of elements. */
+    size_t _capacity;
+
+    /** The number of published elements. */
+    volatile size_t _count;
+};
+
+/**
+ * Construct a new, empty vector backed by @a storage.
+ *
+ * @param storage Pre-allocated storage of at least storage_size() bytes, suitably aligned for @a T. The storage is
+ * borrowed, and must remain valid for the lifetime of the vector.
+ * @param capacity The maximum number of elements.
+ */
+template <typename T> async_vector<T>::async_vector (void *storage, size_t capacity) {
+    _items = (T *) storage;
+    _capacity = capacity;
+    _count = 0;
+}
+
+/**
+ * Append @a value to the vector.
+ *
+ * @param value The value to append.
+ *
+ * @return Returns true on success, or false if the vector is full.
+ *
+ * @warning This method is not async-safe.
+ */
+template <typename T> bool async_vector<T>::nasync_append (const T &value) {
+    if (_count == _capacity)
+        return false;
+
+    /* Populate the element before publishing it to readers */
+    _items[_count] = value;
+    OSMemoryBarrier();
+    _count = _count + 1;
+
+    return true;
+}
+
+/**
+ * Remove all elements from the vector.
+ *
+ * @warning This method is not async-safe, and must not be called concurrently with readers.
+ */
+template <typename T> void async_vector<T>::nasync_clear (void) {
+    _count = 0;
+    OSMemoryBarrier();
+}
+
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ *
+ * An async-safe, key-sorted index.
+ *
+ * The index is double-buffered within caller-supplied, pre-allocated storage. A writer populates the inactive
+ * buffer, which is then sorted and published with an atomic pointer swap; readers perform a binary search of whichever
+ * buffer was published when their lookup began, and are never blocked by writers.
+ *
+ * Each buffer maintains a count of the readers currently searching it. Before a writer may reuse the inactive
+ * buffer, it waits for any readers that began prior to the most recent publication to complete. Concurrent
+ * writers must be serialized by the caller.
+ *
+ * @tparam K The key type. Must support operator<.
+ * @tparam V The value type. Values are copied on lookup.
+ */
+template <typename K, typename V>
+class sorted_index {
+public:
+    /**
+     * An index entry.
+     */
+    struct entry {
+        /** The entry's sort key. */
+        K key;
+
+        /** The entry's value. */
+        V value;
+    };
+
+    /**
+     * Return the number of bytes of storage required for an index of @a capacity entries.
+     *
+     * @param capacity The index capacity.
+     */
+    static inline size_t storage_size (size_t capacity) {
+        return sizeof(entry) * capacity * 2;
+    }
+
+    sorted_index (void *storage, size_t capacity);
+
+    entry *nasync_begin_rebuild (void);
+    void nasync_publish (size_t count);
+
+    bool get (K key, V *value);
+    bool get_floor (K key, K *found_key, V *value);
+
+    /** Return the number of entries in the published index. */
+    inline size_t count (void) const { return _published->count; }
+
+    /** Return the maximum number of entries. */
+    inline size_t capacity (void) const { return _capacity; }
+
+private:
+    /**
+     * A single index buffer.
+     */
+    struct buffer {
+        /** The buffer's entries. */
+        entry *entries;
+
+        /** The number of valid entries. */
+        size_t count;
+
+        /** The number of readers currently searching this buffer. */
+        volatile int32_t readers;
+    };
+
+    buffer *acquire (void);
+    void release (buffer *buf);
+    static K key_of (const entry &e);
+    static int compare (const void *lhs, const void *rhs);
+
+    /** The index buffers. */
+    buffer _buffers[2];
+
+    /** The buffer visible to readers. */
+    buffer * volatile _published;
+
+    /** The maximum number of entries per buffer. */
+    size_t _capacity;
+};
+
+/**
+ * Construct a new, empty index backed by @a storage.
+ *
+ * @param storage Pre-allocated storage of at least storage_size() bytes, suitably aligned for an entry. The storage
+ * is borrowed, and must remain valid for the lifetime of the index.
+ * @param capacity The maximum number of entries.
+ */
+template <typename K, typename V> sorted_index<K,V>::sorted_index (void *storage, size_t capacity) {
+    _capacity = capacity;
+
+    for (size_t i = 0; i < 2; i++) {
+        _buffers[i].entries = ((entry *) storage) + (capacity * i);
+        _buffers[i].count = 0;
+        _buffers[i].readers = 0;
+    }
+
+    _published = &_buffers[0];
+}
+
+/**
+ * Begin rebuilding the index, returning the unpublished buffer of capacity() entries to be populated by the caller.
+ * The new contents are not visible to readers until nasync_publish() is called.
+ *
+ * If any readers are still searching the unpublished buffer, this method will spin until they complete.
+ *
+ * @warning This method is not async-safe.
+ */
+template <typename K, typename V> typename sorted_index<K,V>::entry *sorted_index<K,V>::nasync_begin_rebuild (void) {
+    buffer *inactive = (_published == &_buffers[0]) ? &_buffers[1] : &_buffers[0];
+
+    /* New readers can only acquire the published buffer; wait for any stragglers from before the last swap */
+    while (OSAtomicAdd32Barrier(0, &inactive->readers) != 0)
+        ;
+
+    return inactive->entries;
+}
+
+/**
+ * Sort and publish the first @a count entries populated following nasync_begin_rebuild().
+ *
+ * @param count The number of populated entries. Must not exceed capacity().
+ *
+ * @warning This method is not async-safe.
+ */
+template <typename K, typename V> void sorted_index<K,V>::nasync_publish (size_t count) {
+    PLCF_ASSERT(count <= _capacity);
+
+    buffer *inactive = (_published == &_buffers[0]) ? &_buffers[1] : &_buffers[0];
+    qsort(inactive->entries, count, sizeof(entry), compare);
+    inactive->count = count;
+
+    /* Publish the rebuilt buffer */
+    buffer *old;
+    do {
+        old = _published;
+    } while (!OSAtomicCompareAndSwapPtrBarrier(old, inactive, (void * volatile *) &_published));
+}
+
+/**
+ * Look up the value for @a key.
+ *
+ * @param key The key to search for.
+ * @param value On success, the entry's value.
+ *
+ * @return Returns true if the key was found, or false otherwise.
+ */
+template <typename K, typename V> bool sorted_index<K,V>::get (K key, V *value) {
+    buffer *buf = acquire();
+    bool found = false;
+
+    size_t idx = async_lower_bound(buf->entries, buf->count, key, key_of);
+    if (idx < buf->count && !(key < buf->entries[idx].key)) {
+        *value = buf->entries[idx].value;
+        found = true;
+    }
+
+    release(buf);
+    return found;
+}
+
+/**
+ * Look up the entry with the greatest key less than or equal to @a key; this may be used, for example, to find the
+ * region containing an address from an index of region base addresses.
+ *
+ * @param key The key to search for.
+ * @param found_key On success, the matching entry's key. May be NULL.
+ * @param value On success, the matching entry's value.
+ *
+ * @return Returns true if a matching entry was found, or false if all keys are greater than @a key.
+ */
+template <typename K, typename V> bool sorted_index<K,V>::get_floor (K key, K *found_key, V *value) {
+    buffer *buf = acquire();
+    bool found = false;
+
+    size_t idx = async_lower_bound(buf->entries, buf->count, key, key_of);
+    if (idx < buf->count && !(key < buf->entries[idx].key)) {
+        /* Exact match */
+        found = true;
+    } else if (idx > 0) {
+        idx--;
+        found = true;
+    }
+
+    if (found) {
+        if (found_key != NULL)
+            *found_key = buf->entries[idx].key;
+        *value = buf->entries[idx].value;
+    }
+
+    release(buf);
+    return found;
+}
+
+/**
+ * Acquire a reader reference to the published buffer; the buffer will not be reused until release() is called.
+ */
+template <typename K, typename V> typename sorted_index<K,V>::buffer *sorted_index<K,V>::acquire (void) {
+    while (true) {
+        buffer *buf = _published;
+        OSAtomicIncrement32Barrier(&buf->readers);
+
+        /* If the buffer was swapped out before our reference was visible, a writer may already be reusing it */
+        if (buf == _published)
+            return buf;
+
+        OSAtomicDecrement32Barrier(&buf->readers);
+    }
+}
+
+/**
+ * Release a reader reference previously acquired via acquire().
+ *
+ * @param buf The acquired buffer.
+ */
+template <typename K, typename V> void sorted_index<K,V>::release (buffer *buf) {
+    OSAtomicDecrement32Barrier(&buf->readers);
+}
+
+/* async_lower_bound() key accessor */
+template <typename K, typename V> K sorted_index<K,V>::key_of (const entry &e) {
+    return e.key;
+}
+
+/* qsort() comparator for index entries */
+template <typename K, typename V> int sorted_index<K,V>::compare (const void *lhs, const void *rhs) {
+    const entry *lhs_entry = (const entry *) lhs;
+    const entry *rhs_entry = (const entry *) rhs;
+
+    if (lhs_entry->key < rhs_entry->key)
+        return -1;
+    else if (rhs_entry->key < lhs_entry->key)
+        return 1;
+    return 0;
+}
+
+}}
+
+#endif /* PLCRASH_ASYNC_VECTOR_H */
@@ -0,0 +1,115 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "GTMSenTestCase.h"
+
+#import "PLCrashAsyncVector.hpp"
+
+using namespace plcrash::async;
+
+@interface PLCrashAsyncVectorTests : SenTestCase @end
+
+/**
+ * Tests for the async_vector and sorted_index implementations.
+ */
+@implementation PLCrashAsyncVectorTests
+
+/* Test appending to a fixed-capacity vector */
+- (void) testVectorAppend {
+    int storage[4];
+    async_vector<int> vec(storage, 4);
+
+    STAssertEquals(vec.capacity(), (size_t) 4, @"Incorrect capacity");
+    STAssertEquals(vec.count(), (size_t) 0, @"Vector should be empty");
+
+    for (int i = 0; i < 4; i++)
+        STAssertTrue(vec.nasync_append(i * 2), @"Append failed");
+    STAssertFalse(vec.nasync_append(8), @"Append to a full vector should fail");
+
+    STAssertEquals(vec.count(), (size_t) 4, @"Incorrect count");
+    for (size_t i = 0; i < vec.count(); i++)
+        STAssertEquals(vec[i], (int) i * 2, @"Incorrect value");
+
+    vec.nasync_clear();
+    STAssertEquals(vec.count(), (size_t) 0, @"Vector should be empty");
+}
+
+/* Test exact and floor lookups against a published index */
+- (void) testIndexLookup {
+    typedef sorted_index<uintptr_t, int> test_index;
+    test_index::entry storage[8];
+    test_index index(storage, 4);
+    uintptr_t key;
+    int value;
+
+    STAssertFalse(index.get_floor(100, &key, &value), @"Lookup in an empty index should fail");
+
+    /* Populate out of order; publishing must sort the entries */
+    test_index::entry *entries = index.nasync_begin_rebuild();
+    entries[0].key = 300; entries[0].value = 3;
+    entries[1].key = 100; entries[1].value = 1;
+    entries[2].key = 200; entries[2].value = 2;
+    index.nasync_publish(3);
+    STAssertEquals(index.count(), (size_t) 3, @"Incorrect count");
+
+    STAssertTrue(index.get(200, &value), @"Exact lookup failed");
+    STAssertEquals(value, 2, @"Incorrect value");
+    STAssertFalse(index.get(250, &value), @"Exact lookup of a missing key should fail");
+
+    STAssertTrue(index.get_floor(250, &key, &value), @"Floor lookup failed");
+    STAssertEquals(key, (uintptr_t) 200, @"Incorrect key");
+    STAssertEquals(value, 2, @"Incorrect value");
+
+    STAssertTrue(index.get_floor(300, &key, &value), @"Floor lookup of an exact key failed");
+    STAssertEquals(key, (uintptr_t) 300, @"Incorrect key");
+
+    STAssertFalse(index.get_floor(50, &key, &value), @"Floor lookup below the first key should fail");
+}
+
+/* Test that a rebuilt index replaces the previously published contents */
+- (void) testIndexRebuild {
+    typedef sorted_index<uintptr_t, int> test_index;
+    test_index::entry storage[8];
+    test_index index(storage, 4);
+    int value;
+
+    test_index::entry *entries = index.nasync_begin_rebuild();
+    entries[0].key = 100; entries[0].value = 1;
+    index.nasync_publish(1);
+
+    entries = index.nasync_begin_rebuild();
+    entries[0].key = 500; entries[0].value = 5;
+    entries[1].key = 400; entries[1].value = 4;
+    index.nasync_publish(2);
+
+    STAssertEquals(index.count(), (size_t) 2, @"Incorrect count");
+    STAssertFalse(index.get(100, &value), @"Stale entry should not be visible");
+    STAssertTrue(index.get(400, &value), @"Lookup failed");
+    STAssertEquals(value, 4, @"Incorrect value");
+}
+
+@end
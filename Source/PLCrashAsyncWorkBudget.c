@@ -0,0 +1,115 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashAsyncWorkBudget.h"
+#import "PLCrashAsync.h"
+
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async
+ * @defgroup plcrash_async_work_budget Parser Work Budgets
+ *
+ * Implements per-report bounds on the work performed by the DWARF, compact unwind, and Objective-C parsers.
+ *
+ * These parsers are bounded only by the size of the data they are handed; a malformed or adversarial image can
+ * require the evaluation of an unbounded number of CFA instructions, a looping DWARF expression, or a linear eh_frame
+ * scan over every entry in the section for every frame walked. A work budget is consulted by each parser loop, and once a class of work has
+ * been exhausted, the parser fails with PLCRASH_EBUDGET, allowing the frame walker and symbolicator to proceed with
+ * the remaining (cheaper) strategies.
+ *
+ * @{
+ */
+
+/**
+ * Initialize @a budget with the default per-report limits.
+ *
+ * @param budget The budget to initialize.
+ */
+void plcrash_async_work_budget_init (plcrash_async_work_budget_t *budget) {
+    budget->limits[PLCRASH_ASYNC_WORK_DWARF_OPS] = PLCRASH_ASYNC_WORK_BUDGET_DWARF_OPS;
+    budget->limits[PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES] = PLCRASH_ASYNC_WORK_BUDGET_DWARF_CFI_ENTRIES;
+    budget->limits[PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS] = PLCRASH_ASYNC_WORK_BUDGET_COMPACT_UNWIND_LOOKUPS;
+    budget->limits[PLCRASH_ASYNC_WORK_OBJC_ENTRIES] = PLCRASH_ASYNC_WORK_BUDGET_OBJC_ENTRIES;
+
+    plcrash_async_work_budget_reset(budget);
+}
+
+/**
+ * Set the permitted work for @a work.
+ *
+ * @param budget The budget to modify.
+ * @param work The class of work.
+ * @param limit The permitted work, or 0 to disable the limit.
+ */
+void plcrash_async_work_budget_set_limit (plcrash_async_work_budget_t *budget, plcrash_async_work_t work, uint64_t limit) {
+    PLCF_ASSERT(work < PLCRASH_ASYNC_WORK_COUNT);
+    budget->limits[work] = limit;
+}
+
+/**
+ * Reset all consumed and exhausted counters of @a budget, retaining the configured limits. This should be called
+ * at the start of each report.
+ *
+ * @param budget The budget to reset.
+ */
+void plcrash_async_work_budget_reset (plcrash_async_work_budget_t *budget) {
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_WORK_COUNT; i++) {
+        budget->consumed[i] = 0;
+        budget->exhausted[i] = 0;
+    }
+}
+
+/**
+ * Consume @a units of @a work from @a budget.
+ *
+ * @param budget The budget from which the work will be consumed, or NULL. If NULL, the work is not bounded.
+ * @param work The class of work.
+ * @param units The amount of work to be performed.
+ *
+ * @return Returns true if the work may be performed, or false if the budget for @a work has been exhausted, in which
+ * case the caller should abandon the current operation.
+ */
+bool plcrash_async_work_budget_consume (plcrash_async_work_budget_t *budget, plcrash_async_work_t work, uint32_t units) {
+    if (budget == NULL)
+        return true;
+
+    PLCF_ASSERT(work < PLCRASH_ASYNC_WORK_COUNT);
+
+    int64_t consumed = OSAtomicAdd64(units, &budget->consumed[work]);
+    if (budget->limits[work] != 0 && (uint64_t) consumed > budget->limits[work]) {
+        OSAtomicIncrement64(&budget->exhausted[work]);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @} plcrash_async_work_budget
+ */
@@ -0,0 +1,123 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef PLCRASH_ASYNC_WORK_BUDGET_H
+#define PLCRASH_ASYNC_WORK_BUDGET_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_async_work_budget
+ *
+ * The classes of parser work tracked by a work budget.
+ */
+typedef enum {
+    /** DWARF call frame instructions and expression operations evaluated while unwinding. */
+    PLCRASH_ASYNC_WORK_DWARF_OPS = 0,
+
+    /** CFI entries visited while scanning eh_frame or debug_frame data for an FDE. */
+    PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES,
+
+    /** Compact unwind lookups performed by plcrash_async_cfe_reader_find_pc(). */
+    PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS,
+
+    /** Objective-C classes and methods visited while parsing an image's Objective-C metadata. */
+    PLCRASH_ASYNC_WORK_OBJC_ENTRIES,
+
+    /** The number of work classes. */
+    PLCRASH_ASYNC_WORK_COUNT
+} plcrash_async_work_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_async_work_budget
+ *
+ * Default per-report limit for PLCRASH_ASYNC_WORK_DWARF_OPS.
+ */
+#define PLCRASH_ASYNC_WORK_BUDGET_DWARF_OPS (1 << 20)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_work_budget
+ *
+ * Default per-report limit for PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES.
+ */
+#define PLCRASH_ASYNC_WORK_BUDGET_DWARF_CFI_ENTRIES (1 << 22)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_work_budget
+ *
+ * Default per-report limit for PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS.
+ */
+#define PLCRASH_ASYNC_WORK_BUDGET_COMPACT_UNWIND_LOOKUPS (1 << 16)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_work_budget
+ *
+ * Default per-report limit for PLCRASH_ASYNC_WORK_OBJC_ENTRIES.
+ */
+#define PLCRASH_ASYNC_WORK_BUDGET_OBJC_ENTRIES (1 << 21)
+
+/**
+ * @internal
+ * @ingroup plcrash_async_work_budget
+ *
+ * Bounds the total work performed by the unwind and symbolication parsers over a single report, ensuring that
+ * malformed or adversarial binaries can not stall the crash handler.
+ *
+ * A budget may be shared by parsers running concurrently on multiple threads; all counters are updated atomically.
+ */
+typedef struct plcrash_async_work_budget {
+    /** The permitted work for each class, indexed by plcrash_async_work_t. A limit of 0 disables the limit. */
+    uint64_t limits[PLCRASH_ASYNC_WORK_COUNT];
+
+    /** The work consumed for each class, indexed by plcrash_async_work_t. */
+    volatile int64_t consumed[PLCRASH_ASYNC_WORK_COUNT];
+
+    /** The number of operations refused once each class' limit was reached, indexed by plcrash_async_work_t. */
+    volatile int64_t exhausted[PLCRASH_ASYNC_WORK_COUNT];
+} plcrash_async_work_budget_t;
+
+void plcrash_async_work_budget_init (plcrash_async_work_budget_t *budget);
+void plcrash_async_work_budget_set_limit (plcrash_async_work_budget_t *budget, plcrash_async_work_t work, uint64_t limit);
+void plcrash_async_work_budget_reset (plcrash_async_work_budget_t *budget);
+
+bool plcrash_async_work_budget_consume (plcrash_async_work_budget_t *budget, plcrash_async_work_t work, uint32_t units);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_ASYNC_WORK_BUDGET_H */
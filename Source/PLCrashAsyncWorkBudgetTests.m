@@ -0,0 +1,104 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashAsyncWorkBudget.h"
+
+@interface PLCrashAsyncWorkBudgetTests : SenTestCase {
+@private
+    plcrash_async_work_budget_t _budget;
+}
+@end
+
+@implementation PLCrashAsyncWorkBudgetTests
+
+- (void) setUp {
+    plcrash_async_work_budget_init(&_budget);
+}
+
+/**
+ * Verify that the default limits are applied, and all counters are cleared.
+ */
+- (void) testDefaults {
+    STAssertEquals(_budget.limits[PLCRASH_ASYNC_WORK_DWARF_OPS], (uint64_t) PLCRASH_ASYNC_WORK_BUDGET_DWARF_OPS, @"Incorrect default limit");
+    STAssertEquals(_budget.limits[PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES], (uint64_t) PLCRASH_ASYNC_WORK_BUDGET_DWARF_CFI_ENTRIES, @"Incorrect default limit");
+    STAssertEquals(_budget.limits[PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS], (uint64_t) PLCRASH_ASYNC_WORK_BUDGET_COMPACT_UNWIND_LOOKUPS, @"Incorrect default limit");
+    STAssertEquals(_budget.limits[PLCRASH_ASYNC_WORK_OBJC_ENTRIES], (uint64_t) PLCRASH_ASYNC_WORK_BUDGET_OBJC_ENTRIES, @"Incorrect default limit");
+
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_WORK_COUNT; i++) {
+        STAssertEquals(_budget.consumed[i], (int64_t) 0, @"Consumed count not cleared");
+        STAssertEquals(_budget.exhausted[i], (int64_t) 0, @"Exhausted count not cleared");
+    }
+}
+
+/**
+ * Verify that work is refused once the limit is reached, and that other classes of work are unaffected.
+ */
+- (void) testExhaust {
+    plcrash_async_work_budget_set_limit(&_budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 10);
+
+    STAssertTrue(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 4), @"Work refused within limit");
+    STAssertTrue(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 6), @"Work refused at limit");
+    STAssertFalse(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 1), @"Work permitted beyond limit");
+    STAssertFalse(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_OPS, 1), @"Work permitted beyond limit");
+    STAssertEquals(_budget.exhausted[PLCRASH_ASYNC_WORK_DWARF_OPS], (int64_t) 2, @"Incorrect exhausted count");
+
+    STAssertTrue(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_OBJC_ENTRIES, 1), @"Unrelated work refused");
+    STAssertEquals(_budget.exhausted[PLCRASH_ASYNC_WORK_OBJC_ENTRIES], (int64_t) 0, @"Unrelated work marked exhausted");
+}
+
+/**
+ * Verify that a limit of 0 disables the limit.
+ */
+- (void) testUnlimited {
+    plcrash_async_work_budget_set_limit(&_budget, PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS, 0);
+    STAssertTrue(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_COMPACT_UNWIND_LOOKUPS, UINT32_MAX), @"Unlimited work refused");
+}
+
+/**
+ * Verify that a NULL budget permits all work.
+ */
+- (void) testNullBudget {
+    STAssertTrue(plcrash_async_work_budget_consume(NULL, PLCRASH_ASYNC_WORK_DWARF_OPS, UINT32_MAX), @"NULL budget refused work");
+}
+
+/**
+ * Verify that reset clears the counters while retaining the configured limits.
+ */
+- (void) testReset {
+    plcrash_async_work_budget_set_limit(&_budget, PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES, 1);
+    STAssertTrue(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES, 1), @"Work refused within limit");
+    STAssertFalse(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES, 1), @"Work permitted beyond limit");
+
+    plcrash_async_work_budget_reset(&_budget);
+    STAssertEquals(_budget.limits[PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES], (uint64_t) 1, @"Limit not retained");
+    STAssertEquals(_budget.exhausted[PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES], (int64_t) 0, @"Exhausted count not cleared");
+    STAssertTrue(plcrash_async_work_budget_consume(&_budget, PLCRASH_ASYNC_WORK_DWARF_CFI_ENTRIES, 1), @"Work refused after reset");
+}
+
+@end
@@ -0,0 +1,103 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * @internal
+ *
+ * A benchmarked operation. Each call performs a single timed iteration.
+ *
+ * @param context The caller-supplied context value.
+ */
+typedef void (*PLCrashBenchmarkFunction) (void *context);
+
+@interface PLCrashBenchmarkResult : NSObject {
+@private
+    /** Benchmark name */
+    NSString *_name;
+
+    /** Number of timed iterations */
+    NSUInteger _iterations;
+
+    /** Latency percentiles, in nanoseconds */
+    uint64_t _p50;
+    uint64_t _p90;
+    uint64_t _p99;
+    uint64_t _max;
+}
+
+- (id) initWithName: (NSString *) name samples: (uint64_t *) samples count: (NSUInteger) count;
+
+/** The benchmark name. */
+@property(nonatomic, readonly) NSString *name;
+
+/** The number of timed iterations. */
+@property(nonatomic, readonly) NSUInteger iterations;
+
+/** The median iteration latency, in nanoseconds. */
+@property(nonatomic, readonly) uint64_t p50;
+
+/** The 90th percentile iteration latency, in nanoseconds. */
+@property(nonatomic, readonly) uint64_t p90;
+
+/** The 99th percentile iteration latency, in nanoseconds. */
+@property(nonatomic, readonly) uint64_t p99;
+
+/** The maximum iteration latency, in nanoseconds. */
+@property(nonatomic, readonly) uint64_t max;
+
+@end
+
+@interface PLCrashBenchmark : NSObject {
+@private
+    /** Baseline results, keyed by benchmark name, or nil if no baseline was supplied. */
+    NSDictionary *_baseline;
+
+    /** The permitted fractional increase in median latency relative to the baseline. */
+    double _tolerance;
+
+    /** All results, keyed by benchmark name. */
+    NSMutableDictionary *_results;
+}
+
++ (BOOL) isEnabled;
++ (PLCrashBenchmark *) sharedBenchmark;
+
+- (id) initWithBaselinePath: (NSString *) path tolerance: (double) tolerance;
+
+- (PLCrashBenchmarkResult *) runBenchmark: (NSString *) name
+                               iterations: (NSUInteger) iterations
+                                 function: (PLCrashBenchmarkFunction) function
+                                  context: (void *) context;
+
+- (NSString *) regressionForResult: (PLCrashBenchmarkResult *) result;
+
+- (BOOL) writeResultsToPath: (NSString *) path error: (NSError **) outError;
+
+@end
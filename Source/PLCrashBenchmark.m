@@ -0,0 +1,281 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashBenchmark.h"
+
+#import <stdlib.h>
+#import <mach/mach_time.h>
+
+/** Environment variable that enables benchmark execution. */
+#define PLCRASH_BENCHMARK_ENV @"PLCRASH_BENCHMARK"
+
+/** Environment variable specifying the path of a baseline results plist, as written by -writeResultsToPath:error:. */
+#define PLCRASH_BENCHMARK_BASELINE_ENV @"PLCRASH_BENCHMARK_BASELINE"
+
+/** Environment variable specifying the permitted fractional regression relative to the baseline. */
+#define PLCRASH_BENCHMARK_TOLERANCE_ENV @"PLCRASH_BENCHMARK_TOLERANCE"
+
+/** The default permitted fractional regression relative to the baseline. */
+#define PLCRASH_BENCHMARK_DEFAULT_TOLERANCE 0.25
+
+/* Result dictionary keys */
+static NSString *PLCrashBenchmarkIterationsKey = @"iterations";
+static NSString *PLCrashBenchmarkP50Key = @"p50";
+static NSString *PLCrashBenchmarkP90Key = @"p90";
+static NSString *PLCrashBenchmarkP99Key = @"p99";
+static NSString *PLCrashBenchmarkMaxKey = @"max";
+
+/**
+ * @internal
+ *
+ * Stores the latency percentiles of a single benchmark run.
+ */
+@implementation PLCrashBenchmarkResult
+
+@synthesize name = _name;
+@synthesize iterations = _iterations;
+@synthesize p50 = _p50;
+@synthesize p90 = _p90;
+@synthesize p99 = _p99;
+@synthesize max = _max;
+
+static int uint64_compare (const void *a, const void *b) {
+    uint64_t lhs = *(const uint64_t *) a;
+    uint64_t rhs = *(const uint64_t *) b;
+
+    if (lhs < rhs)
+        return -1;
+    else if (lhs > rhs)
+        return 1;
+    return 0;
+}
+
+/* Return the nearest-rank @a pct percentile of the sorted @a samples. */
+static uint64_t percentile (uint64_t *samples, NSUInteger count, NSUInteger pct) {
+    NSUInteger rank = (pct * count + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+
+    return samples[rank - 1];
+}
+
+/**
+ * Initialize a new result instance.
+ *
+ * @param name The benchmark name.
+ * @param samples The per-iteration latencies, in nanoseconds. The array will be sorted in place.
+ * @param count The number of entries in @a samples. Must be non-zero.
+ */
+- (id) initWithName: (NSString *) name samples: (uint64_t *) samples count: (NSUInteger) count {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    NSParameterAssert(count > 0);
+    qsort(samples, count, sizeof(samples[0]), uint64_compare);
+
+    _name = [name copy];
+    _iterations = count;
+    _p50 = percentile(samples, count, 50);
+    _p90 = percentile(samples, count, 90);
+    _p99 = percentile(samples, count, 99);
+    _max = samples[count - 1];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_name release];
+    [super dealloc];
+}
+
+- (NSString *) description {
+    return [NSString stringWithFormat: @"%@: %lu iterations, p50=%lluns p90=%lluns p99=%lluns max=%lluns", _name,
+            (unsigned long) _iterations, _p50, _p90, _p99, _max];
+}
+
+@end
+
+/**
+ * @internal
+ *
+ * Times benchmarked operations, and compares their latencies against a previously recorded baseline.
+ *
+ * Benchmarks are only run if the PLCRASH_BENCHMARK environment variable is set. If PLCRASH_BENCHMARK_BASELINE
+ * names a results plist previously written by -writeResultsToPath:error:, a benchmark regresses if its median
+ * latency exceeds the baseline's by more than the PLCRASH_BENCHMARK_TOLERANCE fraction (default: 0.25).
+ */
+@implementation PLCrashBenchmark
+
+/**
+ * Return true if benchmarks should be run.
+ */
++ (BOOL) isEnabled {
+    return [[[NSProcessInfo processInfo] environment] objectForKey: PLCRASH_BENCHMARK_ENV] != nil;
+}
+
+/**
+ * Return the shared benchmark instance, configured from the process environment.
+ */
++ (PLCrashBenchmark *) sharedBenchmark {
+    static PLCrashBenchmark *shared = nil;
+
+    @synchronized (self) {
+        if (shared == nil) {
+            NSDictionary *env = [[NSProcessInfo processInfo] environment];
+            NSString *tolerance = [env objectForKey: PLCRASH_BENCHMARK_TOLERANCE_ENV];
+
+            shared = [[PLCrashBenchmark alloc] initWithBaselinePath: [env objectForKey: PLCRASH_BENCHMARK_BASELINE_ENV]
+                                                          tolerance: tolerance != nil ? [tolerance doubleValue] : PLCRASH_BENCHMARK_DEFAULT_TOLERANCE];
+        }
+    }
+
+    return shared;
+}
+
+/**
+ * Initialize a new benchmark instance.
+ *
+ * @param path The path to a baseline results plist, or nil if results should not be compared against a baseline.
+ * @param tolerance The permitted fractional increase in median latency relative to the baseline.
+ */
+- (id) initWithBaselinePath: (NSString *) path tolerance: (double) tolerance {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    if (path != nil) {
+        _baseline = [[NSDictionary alloc] initWithContentsOfFile: path];
+        if (_baseline == nil)
+            NSLog(@"Could not load benchmark baseline from %@", path);
+    }
+
+    _tolerance = tolerance;
+    _results = [[NSMutableDictionary alloc] init];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_baseline release];
+    [_results release];
+    [super dealloc];
+}
+
+/**
+ * Time @a iterations calls to @a function, after a single untimed warm-up call.
+ *
+ * @param name The benchmark name. Used to match the result against the baseline.
+ * @param iterations The number of timed iterations. Must be non-zero.
+ * @param function The operation to be timed.
+ * @param context The context value to be passed to @a function.
+ *
+ * @return Returns the benchmark result, or nil if the sample buffer could not be allocated.
+ */
+- (PLCrashBenchmarkResult *) runBenchmark: (NSString *) name
+                               iterations: (NSUInteger) iterations
+                                 function: (PLCrashBenchmarkFunction) function
+                                  context: (void *) context
+{
+    mach_timebase_info_data_t timebase;
+    uint64_t *samples;
+
+    NSParameterAssert(iterations > 0);
+
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS)
+        return nil;
+
+    if ((samples = malloc(iterations * sizeof(samples[0]))) == NULL)
+        return nil;
+
+    /* Warm up any caches and lazily bound symbols */
+    function(context);
+
+    for (NSUInteger i = 0; i < iterations; i++) {
+        uint64_t start = mach_absolute_time();
+        function(context);
+        samples[i] = (mach_absolute_time() - start) * timebase.numer / timebase.denom;
+    }
+
+    PLCrashBenchmarkResult *result = [[[PLCrashBenchmarkResult alloc] initWithName: name samples: samples count: iterations] autorelease];
+    free(samples);
+
+    [_results setObject: [NSDictionary dictionaryWithObjectsAndKeys:
+                          [NSNumber numberWithUnsignedInteger: [result iterations]], PLCrashBenchmarkIterationsKey,
+                          [NSNumber numberWithUnsignedLongLong: [result p50]], PLCrashBenchmarkP50Key,
+                          [NSNumber numberWithUnsignedLongLong: [result p90]], PLCrashBenchmarkP90Key,
+                          [NSNumber numberWithUnsignedLongLong: [result p99]], PLCrashBenchmarkP99Key,
+                          [NSNumber numberWithUnsignedLongLong: [result max]], PLCrashBenchmarkMaxKey,
+                          nil] forKey: name];
+
+    NSLog(@"Benchmark %@", result);
+    return result;
+}
+
+/**
+ * Compare @a result against the baseline.
+ *
+ * @return Returns a description of the regression, or nil if the result is within the baseline tolerance, or
+ * no baseline is available for the benchmark.
+ */
+- (NSString *) regressionForResult: (PLCrashBenchmarkResult *) result {
+    NSDictionary *baseline = [_baseline objectForKey: [result name]];
+    if (baseline == nil)
+        return nil;
+
+    uint64_t expected = [[baseline objectForKey: PLCrashBenchmarkP50Key] unsignedLongLongValue];
+    if ((double) [result p50] <= (double) expected * (1.0 + _tolerance))
+        return nil;
+
+    return [NSString stringWithFormat: @"%@ median latency of %lluns exceeds the baseline of %lluns by more than %.0f%%",
+            [result name], [result p50], expected, _tolerance * 100.0];
+}
+
+/**
+ * Write all results to @a path as a property list, suitable for use as a future baseline.
+ *
+ * @param path The output path.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the results could not be written. If no error occurs, this parameter will be left
+ * unmodified. You may specify NULL for this parameter, and no error information will be provided.
+ */
+- (BOOL) writeResultsToPath: (NSString *) path error: (NSError **) outError {
+    NSString *errorDesc = nil;
+    NSData *data = [NSPropertyListSerialization dataFromPropertyList: _results
+                                                              format: NSPropertyListXMLFormat_v1_0
+                                                    errorDescription: &errorDesc];
+    if (data == nil) {
+        if (outError != NULL)
+            *outError = [NSError errorWithDomain: NSCocoaErrorDomain code: NSFileWriteUnknownError
+                                        userInfo: [NSDictionary dictionaryWithObject: errorDesc forKey: NSLocalizedDescriptionKey]];
+        [errorDesc release];
+        return NO;
+    }
+
+    return [data writeToFile: path options: NSAtomicWrite error: outError];
+}
+
+@end
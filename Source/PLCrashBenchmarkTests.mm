@@ -0,0 +1,1129 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashTestCase.h"
+#import "PLCrashBenchmark.h"
+
+#include "PLCrashFeatureConfig.h"
+
+#include "PLCrashAsyncDwarfEncoding.hpp"
+#include "PLCrashAsyncCompactUnwindEncoding.h"
+#include "PLCrashAsyncSymbolication.h"
+#include "PLCrashFrameWalker.h"
+#include "PLCrashFrameCompactUnwind.h"
+#include "PLCrashFrameDWARFUnwind.h"
+#include "PLCrashFrameStackUnwind.h"
+#include "PLCrashFrameStackScan.h"
+#include "PLCrashLogWriter.h"
+#include "PLCrashLogWriterEncoding.h"
+#include "PLCrashTestThread.h"
+#include "PLCrashSyntheticFixtures.h"
+
+#include "dwarf_encoding_test.h"
+#include "unwind_test_harness.h"
+
+#import "PLCrashReport.h"
+#import "PLCrashReportTextFormatter.h"
+#import "crash_report.pb-c.h"
+
+#import <objc/runtime.h>
+#import <dlfcn.h>
+#import <fcntl.h>
+#import <mach-o/dyld.h>
+#import <malloc/malloc.h>
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+using namespace plcrash::async;
+#endif
+
+#if TARGET_OS_MAC && (!TARGET_OS_IPHONE)
+#  define TEST_BINARY @"test.macosx"
+#elif TARGET_IPHONE_SIMULATOR
+#  define TEST_BINARY @"test.sim"
+#elif TARGET_OS_IPHONE
+#  define TEST_BINARY @"test.ios"
+#else
+#  error Unsupported target
+#endif
+
+/** Environment variable specifying the path to which all benchmark results will be written. */
+#define PLCRASH_BENCHMARK_RECORD_ENV @"PLCRASH_BENCHMARK_RECORD"
+
+/** The maximum number of frames walked per frame walking iteration. */
+#define BENCHMARK_MAX_FRAMES 128
+
+/**
+ * @internal
+ *
+ * Benchmarks for the crash-time hot paths. These are only run if the PLCRASH_BENCHMARK environment variable is set;
+ * see PLCrashBenchmark. Fixture binaries are shared with the corresponding unit tests.
+ */
+@interface PLCrashBenchmarkTests : PLCrashTestCase {
+@private
+    /** Test thread to be walked */
+    plcrash_test_thread_t _thr_args;
+
+    /** The current process' images */
+    plcrash_async_image_list_t _image_list;
+
+    /** Unwind section cache */
+    plcrash_async_macho_section_cache_t _section_cache;
+}
+@end
+
+@implementation PLCrashBenchmarkTests
+
+- (void) setUp {
+    plcrash_test_thread_spawn(&_thr_args);
+
+    plcrash_nasync_image_list_init(&_image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&_image_list, (pl_vm_address_t) _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    plcrash_async_macho_section_cache_init(&_section_cache);
+}
+
+- (void) tearDown {
+    plcrash_async_macho_section_cache_free(&_section_cache);
+    plcrash_nasync_image_list_free(&_image_list);
+    plcrash_test_thread_stop(&_thr_args);
+
+    /* Record all results gathered thus far */
+    NSString *recordPath = [[[NSProcessInfo processInfo] environment] objectForKey: PLCRASH_BENCHMARK_RECORD_ENV];
+    if ([PLCrashBenchmark isEnabled] && recordPath != nil) {
+        NSError *error;
+        if (![[PLCrashBenchmark sharedBenchmark] writeResultsToPath: recordPath error: &error])
+            NSLog(@"Failed to write benchmark results to %@: %@", recordPath, error);
+    }
+}
+
+/* Benchmark resources are named relative to the test resource root, rather than this class' resource directory. */
+- (NSString *) pathForTestResource: (NSString *) resourceName {
+    NSString *bundleResources = [[NSBundle bundleForClass: [self class]] resourcePath];
+    return [[bundleResources stringByAppendingPathComponent: @"Tests"] stringByAppendingPathComponent: resourceName];
+}
+
+/**
+ * Run a benchmark, verifying that it has not regressed relative to the baseline. Returns the benchmark result, or nil
+ * if the benchmark could not be run.
+ */
+- (PLCrashBenchmarkResult *) runBenchmark: (NSString *) name iterations: (NSUInteger) iterations function: (PLCrashBenchmarkFunction) function context: (void *) context {
+    PLCrashBenchmark *benchmark = [PLCrashBenchmark sharedBenchmark];
+    PLCrashBenchmarkResult *result = [benchmark runBenchmark: name iterations: iterations function: function context: context];
+
+    STAssertNotNil(result, @"Failed to run benchmark %@", name);
+    if (result != nil)
+        STAssertNil([benchmark regressionForResult: result], @"Benchmark regressed");
+
+    return result;
+}
+
+#pragma mark Frame Walking
+
+struct frame_walk_ctx {
+    plcrash_test_thread_t *thread;
+    plcrash_async_image_list_t *image_list;
+    plcrash_async_macho_section_cache_t *section_cache;
+
+    /** The reader to use, or NULL to use the default reader ordering of plframe_cursor_next(). */
+    plframe_cursor_frame_reader_t *reader;
+};
+
+static void bench_frame_walk (void *context) {
+    struct frame_walk_ctx *ctx = (struct frame_walk_ctx *) context;
+    plframe_cursor_frame_reader_t *readers[] = { ctx->reader };
+    plframe_cursor_t cursor;
+    plframe_error_t ferr;
+
+    if (plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(ctx->thread->thread), ctx->image_list) != PLFRAME_ESUCCESS)
+        return;
+    plframe_cursor_set_section_cache(&cursor, ctx->section_cache);
+
+    for (uint32_t depth = 0; depth < BENCHMARK_MAX_FRAMES; depth++) {
+        if (ctx->reader != NULL)
+            ferr = plframe_cursor_next_with_readers(&cursor, readers, 1);
+        else
+            ferr = plframe_cursor_next(&cursor);
+
+        if (ferr != PLFRAME_ESUCCESS)
+            break;
+    }
+
+    plframe_cursor_free(&cursor);
+}
+
+/**
+ * Time walking the test thread's stack with each frame reader, and with the default reader ordering.
+ */
+- (void) testFrameWalking {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    struct {
+        NSString *name;
+        plframe_cursor_frame_reader_t *reader;
+    } readers[] = {
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+        { @"plframe_cursor_next (compact unwind)", plframe_cursor_read_compact_unwind },
+#endif
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        { @"plframe_cursor_next (dwarf unwind)", plframe_cursor_read_dwarf_unwind },
+#endif
+        { @"plframe_cursor_next (frame pointer)", plframe_cursor_read_frame_ptr },
+#if PLCRASH_FEATURE_UNWIND_STACK_SCAN
+        { @"plframe_cursor_next (stack scan)", plframe_cursor_read_stack_scan },
+#endif
+        { @"plframe_cursor_next", NULL }
+    };
+
+    for (size_t i = 0; i < sizeof(readers) / sizeof(readers[0]); i++) {
+        struct frame_walk_ctx ctx = { &_thr_args, &_image_list, &_section_cache, readers[i].reader };
+        [self runBenchmark: readers[i].name iterations: 500 function: bench_frame_walk context: &ctx];
+    }
+}
+
+static void unwinder_comparison_cb (const unwind_test_comparison_t *result, void *ctx) {
+    uint64_t *accurate_mismatches = (uint64_t *) ctx;
+    double fps = result->elapsed_ns > 0 ? (result->unwinds * 1e9) / result->elapsed_ns : 0;
+
+    NSLog(@"%s: %s: %llu unwinds, %.0f frames/sec, %llu mismatches", result->shape, result->unwinder,
+          (unsigned long long) result->unwinds, fps, (unsigned long long) result->mismatches);
+
+    if (strcmp(result->unwinder, unwind_test_harness_unwinder_name(UNWIND_TEST_UNWINDER_PIPELINE_ACCURATE)) == 0)
+        *accurate_mismatches += result->mismatches;
+}
+
+static void bench_unwinder_comparison (void *context) {
+    unwind_test_unwinder_t unwinder = *(unwind_test_unwinder_t *) context;
+    unwind_test_harness_compare(unwinder, 1, NULL, NULL);
+}
+
+/**
+ * Compare the throughput and accuracy of each frame reader, reader pipeline, and the system unwinder across the
+ * libunwind regression test shapes.
+ */
+- (void) testUnwinderComparison {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    uint64_t accurate_mismatches = 0;
+    for (int i = 0; i < UNWIND_TEST_UNWINDER_COUNT; i++) {
+        unwind_test_unwinder_t unwinder = (unwind_test_unwinder_t) i;
+        STAssertTrue(unwind_test_harness_compare(unwinder, 100, unwinder_comparison_cb, &accurate_mismatches), @"Comparison failed");
+
+        NSString *name = [NSString stringWithFormat: @"unwind_test_harness_compare (%s)", unwind_test_harness_unwinder_name(unwinder)];
+        [self runBenchmark: name iterations: 100 function: bench_unwinder_comparison context: &unwinder];
+    }
+
+    /* The accurate pipeline must recover the complete register state for every shape */
+    STAssertEquals(accurate_mismatches, (uint64_t) 0, @"Accurate pipeline produced mismatched unwinds");
+}
+
+#pragma mark Symbolication
+
+struct find_symbol_ctx {
+    plcrash_async_macho_t *image;
+    plcrash_async_symbol_strategy_t strategy;
+    pl_vm_address_t pc;
+};
+
+static void bench_find_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    /* Nothing to do */
+}
+
+static void bench_find_symbol (void *context) {
+    struct find_symbol_ctx *ctx = (struct find_symbol_ctx *) context;
+    plcrash_async_symbol_cache_t cache;
+
+    /* Use a new cache for every lookup; the cost of a cache hit is not of interest. */
+    if (plcrash_async_symbol_cache_init(&cache) != PLCRASH_ESUCCESS)
+        return;
+
+    plcrash_async_find_symbol(ctx->image, ctx->strategy, &cache, ctx->pc, bench_find_symbol_cb, NULL);
+    plcrash_async_symbol_cache_free(&cache);
+}
+
+/**
+ * Time symbol lookup within our own image using each symbolication strategy.
+ */
+- (void) testFindSymbol {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    /* Look up our own method implementation */
+    IMP localIMP = class_getMethodImplementation([self class], _cmd);
+    Dl_info info;
+    STAssertTrue(dladdr((void *) localIMP, &info) != 0, @"Could not fetch dyld info for %p", localIMP);
+
+    plcrash_async_macho_t image;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&image, mach_task_self(), info.dli_fname, (pl_vm_address_t) info.dli_fbase), @"Failed to initialize Mach-O parser");
+
+    struct {
+        NSString *name;
+        plcrash_async_symbol_strategy_t strategy;
+    } strategies[] = {
+        { @"plcrash_async_find_symbol (symbol table)", PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE },
+        { @"plcrash_async_find_symbol (objc)", PLCRASH_ASYNC_SYMBOL_STRATEGY_OBJC },
+        { @"plcrash_async_find_symbol (all)", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL }
+    };
+
+    for (size_t i = 0; i < sizeof(strategies) / sizeof(strategies[0]); i++) {
+        struct find_symbol_ctx ctx = { &image, strategies[i].strategy, (pl_vm_address_t) localIMP };
+        [self runBenchmark: strategies[i].name iterations: 1000 function: bench_find_symbol context: &ctx];
+    }
+
+    plcrash_nasync_macho_free(&image);
+}
+
+#pragma mark Unwind Data
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+
+struct find_fde_ctx {
+    dwarf_frame_reader *reader;
+    pl_vm_address_t pc;
+};
+
+static void bench_find_fde (void *context) {
+    struct find_fde_ctx *ctx = (struct find_fde_ctx *) context;
+    plcrash_async_dwarf_fde_info_t fde_info;
+
+    if (ctx->reader->find_fde(0x0, ctx->pc, &fde_info) == PLCRASH_ESUCCESS)
+        plcrash_async_dwarf_fde_info_free(&fde_info);
+}
+
+/**
+ * Time FDE lookup within the DWARF encoding test fixture's __eh_frame.
+ */
+- (void) testFindFDE {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    plcrash_async_macho_t image;
+    plcrash_async_mobject_t eh_frame;
+    dwarf_frame_reader reader;
+    plcrash_error_t err;
+
+    NSData *mappedImage = [self nativeBinaryFromTestResource: [@"PLCrashAsyncDwarfEncodingTests" stringByAppendingPathComponent: TEST_BINARY]];
+    STAssertNotNil(mappedImage, @"Failed to map image");
+
+    err = plcrash_nasync_macho_init(&image, mach_task_self(), [TEST_BINARY UTF8String], (pl_vm_address_t) [mappedImage bytes]);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize Mach-O parser");
+
+    err = plcrash_async_macho_map_section(&image, "__PL_DWARF", "__eh_frame", &eh_frame);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to map __eh_frame section");
+
+    const plcrash_async_byteorder_t *byteorder = plcrash_async_macho_byteorder(&image);
+    bool m64 = (byteorder->swap32(image.header.cputype) & CPU_ARCH_ABI64) != 0;
+
+    err = reader.init(&eh_frame, byteorder, m64, false, NULL);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize reader");
+
+    struct find_fde_ctx ctx = { &reader, PL_CFI_EH_FRAME_PC + PL_CFI_EH_FRAME_PC_RANGE - 1 };
+    [self runBenchmark: @"dwarf_frame_reader::find_fde" iterations: 10000 function: bench_find_fde context: &ctx];
+
+    plcrash_async_mobject_free(&eh_frame);
+    plcrash_nasync_macho_free(&image);
+}
+
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
+
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+
+struct cfe_find_pc_ctx {
+    plcrash_async_cfe_reader_t *reader;
+    pl_vm_address_t pc;
+};
+
+static void bench_cfe_find_pc (void *context) {
+    struct cfe_find_pc_ctx *ctx = (struct cfe_find_pc_ctx *) context;
+    pl_vm_address_t function_base;
+    uint32_t encoding;
+
+    plcrash_async_cfe_reader_find_pc(ctx->reader, ctx->pc, &function_base, &encoding);
+}
+
+/**
+ * Time compact unwind entry lookup within the compact unwind test fixture's __unwind_info.
+ */
+- (void) testCFEFindPC {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    plcrash_async_macho_t image;
+    plcrash_async_mobject_t unwind_mobj;
+    plcrash_async_cfe_reader_t reader;
+    plcrash_error_t err;
+
+    NSData *mappedImage = [self nativeBinaryFromTestResource: [@"PLCrashAsyncCompactUnwindEncodingTests" stringByAppendingPathComponent: TEST_BINARY]];
+    STAssertNotNil(mappedImage, @"Failed to map image");
+
+    err = plcrash_nasync_macho_init(&image, mach_task_self(), [TEST_BINARY UTF8String], (pl_vm_address_t) [mappedImage bytes]);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize Mach-O parser");
+
+    err = plcrash_async_macho_map_section(&image, SEG_TEXT, "__unwind_info", &unwind_mobj);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to map unwind info");
+
+    /* As in PLCrashAsyncCompactUnwindEncodingTests, the fixture data is x86-specific, but usable on any host. */
+    err = plcrash_async_cfe_reader_init(&reader, &unwind_mobj, CPU_TYPE_X86);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Failed to initialize CFE reader");
+
+    /* Look up the fixture's regular (second-level) entry */
+    struct cfe_find_pc_ctx ctx = { &reader, 10 };
+    [self runBenchmark: @"plcrash_async_cfe_reader_find_pc" iterations: 10000 function: bench_cfe_find_pc context: &ctx];
+
+    plcrash_async_cfe_reader_free(&reader);
+    plcrash_async_mobject_free(&unwind_mobj);
+    plcrash_nasync_macho_free(&image);
+}
+
+#endif /* PLCRASH_FEATURE_UNWIND_COMPACT */
+
+#pragma mark String Primitives
+
+struct string_ctx {
+    char *s1;
+    char *s2;
+    size_t length;
+};
+
+/* Number of primitive calls per benchmark iteration; a single call is too short to time accurately. */
+#define STRING_BENCH_CALLS 100
+
+/* Sink for primitive results, preventing the calls from being optimized out */
+static volatile size_t string_bench_sink;
+
+static void bench_strlen (void *context) {
+    struct string_ctx *ctx = (struct string_ctx *) context;
+    for (int i = 0; i < STRING_BENCH_CALLS; i++)
+        string_bench_sink += plcrash_async_strlen(ctx->s1);
+}
+
+static void bench_strcmp (void *context) {
+    struct string_ctx *ctx = (struct string_ctx *) context;
+    for (int i = 0; i < STRING_BENCH_CALLS; i++)
+        string_bench_sink += plcrash_async_strcmp(ctx->s1, ctx->s2);
+}
+
+static void bench_strncmp (void *context) {
+    struct string_ctx *ctx = (struct string_ctx *) context;
+    for (int i = 0; i < STRING_BENCH_CALLS; i++)
+        string_bench_sink += plcrash_async_strncmp(ctx->s1, ctx->s2, ctx->length);
+}
+
+static void bench_memcpy (void *context) {
+    struct string_ctx *ctx = (struct string_ctx *) context;
+    for (int i = 0; i < STRING_BENCH_CALLS; i++)
+        plcrash_async_memcpy(ctx->s2, ctx->s1, ctx->length);
+}
+
+static void bench_memset (void *context) {
+    struct string_ctx *ctx = (struct string_ctx *) context;
+    for (int i = 0; i < STRING_BENCH_CALLS; i++)
+        plcrash_async_memset(ctx->s2, (uint8_t) i, ctx->length);
+}
+
+/**
+ * Time the async-safe string primitives over symbol-length strings, fixed-width Mach-O names, and page-sized buffers.
+ */
+- (void) testStringPrimitives {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    size_t size = 4096;
+    char *s1 = (char *) malloc(size + 1);
+    char *s2 = (char *) malloc(size + 1);
+    STAssertNotNULL(s1, @"Failed to allocate buffer");
+    STAssertNotNULL(s2, @"Failed to allocate buffer");
+
+    /* A typical mangled symbol name length */
+    size_t symbol_length = 128;
+    memset(s1, 'A', symbol_length);
+    memset(s2, 'A', symbol_length);
+    s1[symbol_length] = '\0';
+    s2[symbol_length] = '\0';
+
+    struct string_ctx ctx = { s1, s2, symbol_length };
+    [self runBenchmark: @"plcrash_async_strlen" iterations: 10000 function: bench_strlen context: &ctx];
+    [self runBenchmark: @"plcrash_async_strcmp" iterations: 10000 function: bench_strcmp context: &ctx];
+
+    /* A fixed-width segment or section name */
+    ctx.length = 16;
+    [self runBenchmark: @"plcrash_async_strncmp" iterations: 10000 function: bench_strncmp context: &ctx];
+
+    /* Page-sized buffers */
+    ctx.length = size;
+    [self runBenchmark: @"plcrash_async_memcpy" iterations: 1000 function: bench_memcpy context: &ctx];
+    [self runBenchmark: @"plcrash_async_memset" iterations: 1000 function: bench_memset context: &ctx];
+
+    free(s1);
+    free(s2);
+}
+
+#pragma mark Memory Objects
+
+struct mobject_ctx {
+    pl_vm_address_t address;
+    pl_vm_size_t length;
+};
+
+static void bench_mobject_init (void *context) {
+    struct mobject_ctx *ctx = (struct mobject_ctx *) context;
+    plcrash_async_mobject_t mobj;
+
+    if (plcrash_async_mobject_init(&mobj, mach_task_self(), ctx->address, ctx->length, true) == PLCRASH_ESUCCESS)
+        plcrash_async_mobject_free(&mobj);
+}
+
+/**
+ * Time mapping of a 16KB range of local memory.
+ */
+- (void) testMobjectInit {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    pl_vm_size_t length = 16 * 1024;
+    void *buffer = malloc(length);
+    STAssertNotNULL(buffer, @"Failed to allocate buffer");
+    memset(buffer, 'A', length);
+
+    struct mobject_ctx ctx = { (pl_vm_address_t) buffer, length };
+    [self runBenchmark: @"plcrash_async_mobject_init" iterations: 1000 function: bench_mobject_init context: &ctx];
+
+    free(buffer);
+}
+
+#pragma mark Field Encoding
+
+/** The number of fields encoded per field encoding iteration. */
+#define BENCHMARK_FIELD_COUNT 4096
+
+struct field_encoding_ctx {
+    plcrash_async_file_t *file;
+    uint64_t *values;
+};
+
+static void bench_pack_generic (void *context) {
+    struct field_encoding_ctx *ctx = (struct field_encoding_ctx *) context;
+    for (size_t i = 0; i < BENCHMARK_FIELD_COUNT; i++)
+        plcrash_writer_pack(ctx->file, 3, PLPROTOBUF_C_TYPE_UINT64, &ctx->values[i]);
+}
+
+static void bench_pack_uint64 (void *context) {
+    struct field_encoding_ctx *ctx = (struct field_encoding_ctx *) context;
+    for (size_t i = 0; i < BENCHMARK_FIELD_COUNT; i++)
+        plcrash_writer_pack_uint64(ctx->file, 3, ctx->values[i]);
+}
+
+/**
+ * Time encoding of address-sized uint64 fields via the generic typed encoder and the specialized uint64 encoder, both
+ * when computing sizes and when writing to a discarded output file.
+ */
+- (void) testFieldEncoding {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    /* A mix of small values, and typical 64-bit addresses */
+    uint64_t *values = (uint64_t *) malloc(sizeof(values[0]) * BENCHMARK_FIELD_COUNT);
+    STAssertNotNULL(values, @"Failed to allocate values");
+    for (size_t i = 0; i < BENCHMARK_FIELD_COUNT; i++)
+        values[i] = (i % 4 == 0) ? i : 0x7fff50000000ULL + (i * 0x1234);
+
+    struct field_encoding_ctx ctx = { NULL, values };
+    [self runBenchmark: @"plcrash_writer_pack(uint64) size" iterations: 1000 function: bench_pack_generic context: &ctx];
+    [self runBenchmark: @"plcrash_writer_pack_uint64 size" iterations: 1000 function: bench_pack_uint64 context: &ctx];
+
+    int fd = open("/dev/null", O_WRONLY);
+    STAssertTrue(fd >= 0, @"Failed to open /dev/null: %s", strerror(errno));
+
+    plcrash_async_file_t file;
+    plcrash_async_file_init(&file, fd, 0);
+    ctx.file = &file;
+    [self runBenchmark: @"plcrash_writer_pack(uint64)" iterations: 1000 function: bench_pack_generic context: &ctx];
+    [self runBenchmark: @"plcrash_writer_pack_uint64" iterations: 1000 function: bench_pack_uint64 context: &ctx];
+    plcrash_async_file_flush(&file);
+
+    close(fd);
+    free(values);
+}
+
+#pragma mark Report Writing
+
+struct log_writer_ctx {
+    plcrash_log_writer_t *writer;
+    plcrash_async_image_list_t *image_list;
+    thread_t crashed_thread;
+    plcrash_log_signal_info_t *siginfo;
+    int fd;
+};
+
+static void bench_log_writer_write (void *context) {
+    struct log_writer_ctx *ctx = (struct log_writer_ctx *) context;
+    plcrash_async_file_t file;
+
+    plcrash_async_file_init(&file, ctx->fd, 0);
+    plcrash_log_writer_write(ctx->writer, ctx->crashed_thread, ctx->image_list, &file, ctx->siginfo, NULL);
+    plcrash_async_file_flush(&file);
+}
+
+/**
+ * Time writing a complete report for the current process, using the test thread as the crashed thread.
+ */
+- (void) testLogWriterWrite {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    plcrash_log_writer_t writer;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+
+    /* Report output is discarded */
+    int fd = open("/dev/null", O_WRONLY);
+    STAssertTrue(fd >= 0, @"Failed to open /dev/null: %s", strerror(errno));
+
+    plcrash_log_bsd_signal_info_t bsd_info;
+    bsd_info.signo = SIGSEGV;
+    bsd_info.code = SEGV_MAPERR;
+    bsd_info.address = (void *) 0x42;
+
+    plcrash_log_signal_info_t info;
+    info.bsd_info = &bsd_info;
+    info.mach_info = NULL;
+
+    struct log_writer_ctx ctx = { &writer, &_image_list, pthread_mach_thread_np(_thr_args.thread), &info, fd };
+    [self runBenchmark: @"plcrash_log_writer_write" iterations: 25 function: bench_log_writer_write context: &ctx];
+
+    close(fd);
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+}
+
+#pragma mark Report Decoding
+
+/* Base address of the first synthetic binary image; images are laid out contiguously from this address. */
+#define SYNTHETIC_IMAGE_BASE 0x100000000ULL
+
+/* Size of each synthetic binary image. */
+#define SYNTHETIC_IMAGE_SIZE 0x100000ULL
+
+/**
+ * Generate an encoded crash report containing @a thread_count threads of @a frame_count frames each, @a image_count
+ * binary images, an exception with user info, and a signal. Frame PCs are distributed across all images.
+ */
+static NSData *synthetic_report_data (uint32_t thread_count, uint32_t frame_count, uint32_t image_count) {
+    const char *register_names[] = { "rip", "rbp", "rsp", "rax", "rbx", "rcx", "rdx", "rdi", "rsi", "r8" };
+    const size_t register_count = sizeof(register_names) / sizeof(register_names[0]);
+
+    Plcrash__CrashReport report = PLCRASH__CRASH_REPORT__INIT;
+
+    Plcrash__CrashReport__SystemInfo system_info = PLCRASH__CRASH_REPORT__SYSTEM_INFO__INIT;
+    system_info.has_operating_system = true;
+    system_info.operating_system = PLCRASH__CRASH_REPORT__SYSTEM_INFO__OPERATING_SYSTEM__MAC_OS_X;
+    system_info.os_version = (char *) "10.8.4";
+    system_info.has_os_build = true;
+    system_info.os_build = (char *) "12E55";
+    system_info.architecture = PLCRASH__ARCHITECTURE__X86_64;
+    system_info.timestamp = 1370000000;
+    report.system_info = &system_info;
+
+    Plcrash__CrashReport__ApplicationInfo app_info = PLCRASH__CRASH_REPORT__APPLICATION_INFO__INIT;
+    app_info.identifier = (char *) "coop.plausible.SyntheticApp";
+    app_info.version = (char *) "1.0";
+    report.application_info = &app_info;
+
+    Plcrash__CrashReport__Processor processor = PLCRASH__CRASH_REPORT__PROCESSOR__INIT;
+    processor.has_encoding = true;
+    processor.encoding = PLCRASH__CRASH_REPORT__PROCESSOR__TYPE_ENCODING__TYPE_ENCODING_MACH;
+    processor.type = CPU_TYPE_X86_64;
+    processor.subtype = CPU_SUBTYPE_X86_64_ALL;
+
+    Plcrash__CrashReport__MachineInfo machine_info = PLCRASH__CRASH_REPORT__MACHINE_INFO__INIT;
+    machine_info.model = (char *) "MacBookPro10,1";
+    machine_info.processor = &processor;
+    machine_info.processor_count = 4;
+    machine_info.logical_processor_count = 8;
+    report.machine_info = &machine_info;
+
+    Plcrash__CrashReport__ProcessInfo process_info = PLCRASH__CRASH_REPORT__PROCESS_INFO__INIT;
+    process_info.process_name = (char *) "SyntheticApp";
+    process_info.process_id = 1234;
+    process_info.process_path = (char *) "/Applications/SyntheticApp.app/Contents/MacOS/SyntheticApp";
+    process_info.parent_process_name = (char *) "launchd";
+    process_info.parent_process_id = 1;
+    process_info.native = true;
+    report.process_info = &process_info;
+
+    Plcrash__CrashReport__Signal signal = PLCRASH__CRASH_REPORT__SIGNAL__INIT;
+    signal.name = (char *) "SIGSEGV";
+    signal.code = (char *) "SEGV_MAPERR";
+    signal.address = 0x42;
+    report.signal = &signal;
+
+    /* Binary images */
+    char (*image_names)[64] = (char (*)[64]) calloc(image_count, sizeof(*image_names));
+    uint8_t (*image_uuids)[16] = (uint8_t (*)[16]) calloc(image_count, sizeof(*image_uuids));
+    Plcrash__CrashReport__BinaryImage *images = (Plcrash__CrashReport__BinaryImage *) calloc(image_count, sizeof(*images));
+    Plcrash__CrashReport__BinaryImage **image_ptrs = (Plcrash__CrashReport__BinaryImage **) calloc(image_count, sizeof(*image_ptrs));
+    for (uint32_t i = 0; i < image_count; i++) {
+        Plcrash__CrashReport__BinaryImage init = PLCRASH__CRASH_REPORT__BINARY_IMAGE__INIT;
+        images[i] = init;
+
+        snprintf(image_names[i], sizeof(image_names[i]), "/usr/lib/synthetic/libsynthetic%u.dylib", i);
+        for (size_t j = 0; j < sizeof(image_uuids[i]); j++)
+            image_uuids[i][j] = (uint8_t) (i + j);
+
+        images[i].base_address = SYNTHETIC_IMAGE_BASE + (i * SYNTHETIC_IMAGE_SIZE);
+        images[i].size = SYNTHETIC_IMAGE_SIZE;
+        images[i].name = image_names[i];
+        images[i].has_uuid = true;
+        images[i].uuid.len = sizeof(image_uuids[i]);
+        images[i].uuid.data = image_uuids[i];
+        images[i].code_type = &processor;
+        image_ptrs[i] = &images[i];
+    }
+    report.n_binary_images = image_count;
+    report.binary_images = image_ptrs;
+
+    /* Threads; the frames and registers are shared across all threads */
+    Plcrash__CrashReport__Thread__StackFrame *frames = (Plcrash__CrashReport__Thread__StackFrame *) calloc(frame_count, sizeof(*frames));
+    Plcrash__CrashReport__Thread__StackFrame **frame_ptrs = (Plcrash__CrashReport__Thread__StackFrame **) calloc(frame_count, sizeof(*frame_ptrs));
+    for (uint32_t i = 0; i < frame_count; i++) {
+        Plcrash__CrashReport__Thread__StackFrame init = PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__INIT;
+        frames[i] = init;
+
+        uint32_t image = (image_count > 0) ? (i * 7) % image_count : 0;
+        frames[i].has_pc = true;
+        frames[i].pc = SYNTHETIC_IMAGE_BASE + (image * SYNTHETIC_IMAGE_SIZE) + 0x1000 + (i * 0x10);
+        frame_ptrs[i] = &frames[i];
+    }
+
+    Plcrash__CrashReport__Thread__RegisterValue registers[register_count];
+    Plcrash__CrashReport__Thread__RegisterValue *register_ptrs[register_count];
+    for (size_t i = 0; i < register_count; i++) {
+        Plcrash__CrashReport__Thread__RegisterValue init = PLCRASH__CRASH_REPORT__THREAD__REGISTER_VALUE__INIT;
+        registers[i] = init;
+        registers[i].name = (char *) register_names[i];
+        registers[i].value = 0x7fff5fbff000ULL + i;
+        register_ptrs[i] = &registers[i];
+    }
+
+    Plcrash__CrashReport__Thread *threads = (Plcrash__CrashReport__Thread *) calloc(thread_count, sizeof(*threads));
+    Plcrash__CrashReport__Thread **thread_ptrs = (Plcrash__CrashReport__Thread **) calloc(thread_count, sizeof(*thread_ptrs));
+    for (uint32_t i = 0; i < thread_count; i++) {
+        Plcrash__CrashReport__Thread init = PLCRASH__CRASH_REPORT__THREAD__INIT;
+        threads[i] = init;
+
+        threads[i].thread_number = i;
+        threads[i].n_frames = frame_count;
+        threads[i].frames = frame_ptrs;
+        threads[i].crashed = (i == 0);
+        threads[i].n_registers = register_count;
+        threads[i].registers = register_ptrs;
+        thread_ptrs[i] = &threads[i];
+    }
+    report.n_threads = thread_count;
+    report.threads = thread_ptrs;
+
+    /* Exception, sharing the thread frames */
+    Plcrash__CrashReport__Exception__UserInfo user_info[2] = {
+        PLCRASH__CRASH_REPORT__EXCEPTION__USER_INFO__INIT,
+        PLCRASH__CRASH_REPORT__EXCEPTION__USER_INFO__INIT
+    };
+    user_info[0].key = (char *) "NSLocalizedDescription";
+    user_info[0].serialized = (char *) "The operation couldn't be completed.";
+    user_info[0].archive = false;
+    user_info[1].key = (char *) "SyntheticKey";
+    user_info[1].serialized = (char *) "SyntheticValue";
+    user_info[1].archive = false;
+    Plcrash__CrashReport__Exception__UserInfo *user_info_ptrs[] = { &user_info[0], &user_info[1] };
+
+    Plcrash__CrashReport__Exception exception = PLCRASH__CRASH_REPORT__EXCEPTION__INIT;
+    exception.name = (char *) "NSInternalInconsistencyException";
+    exception.reason = (char *) "Synthetic exception reason";
+    exception.n_frames = frame_count;
+    exception.frames = frame_ptrs;
+    exception.n_userinfo = sizeof(user_info_ptrs) / sizeof(user_info_ptrs[0]);
+    exception.userinfo = user_info_ptrs;
+    report.exception = &exception;
+
+    /* Encode the report */
+    size_t packed_length = protobuf_c_message_get_packed_size((ProtobufCMessage *) &report);
+    NSMutableData *data = [NSMutableData dataWithLength: sizeof(struct PLCrashReportFileHeader) + packed_length];
+    uint8_t *bytes = (uint8_t *) [data mutableBytes];
+
+    memcpy(bytes, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC));
+    bytes[strlen(PLCRASH_REPORT_FILE_MAGIC)] = PLCRASH_REPORT_FILE_VERSION;
+    protobuf_c_message_pack((ProtobufCMessage *) &report, bytes + sizeof(struct PLCrashReportFileHeader));
+
+    free(thread_ptrs);
+    free(threads);
+    free(frame_ptrs);
+    free(frames);
+    free(image_ptrs);
+    free(images);
+    free(image_uuids);
+    free(image_names);
+
+    return data;
+}
+
+struct report_decode_ctx {
+    NSData *data;
+};
+
+/* Decode the report, and force extraction of any lazily decoded records */
+static PLCrashReport *decode_report (NSData *data) {
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: NULL] autorelease];
+    [report threads];
+    [report images];
+    return report;
+}
+
+static void bench_report_decode (void *context) {
+    struct report_decode_ctx *ctx = (struct report_decode_ctx *) context;
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    decode_report(ctx->data);
+    [pool drain];
+}
+
+static void bench_report_format (void *context) {
+    struct report_decode_ctx *ctx = (struct report_decode_ctx *) context;
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    [PLCrashReportTextFormatter stringValueForCrashReport: decode_report(ctx->data) withTextFormat: PLCrashReportTextFormatiOS];
+    [pool drain];
+}
+
+/**
+ * Return the number of heap allocations live across all malloc zones.
+ */
+static size_t live_allocation_count (void) {
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.blocks_in_use;
+}
+
+/**
+ * Time decoding and text formatting of synthetic reports of varying size; throughput is logged as MB/s of encoded
+ * report data, along with the number of heap allocations held by each decoded and formatted report.
+ */
+- (void) testReportDecode {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    struct {
+        uint32_t threads;
+        uint32_t frames;
+        uint32_t images;
+    } shapes[] = {
+        { 4,   16,  32 },
+        { 16,  64,  128 },
+        { 64,  128, 512 }
+    };
+
+    for (size_t i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        NSData *data = synthetic_report_data(shapes[i].threads, shapes[i].frames, shapes[i].images);
+        STAssertNotNil([[[PLCrashReport alloc] initWithData: data error: NULL] autorelease], @"Failed to decode synthetic report");
+
+        NSString *shape = [NSString stringWithFormat: @"%u threads x %u frames x %u images", shapes[i].threads, shapes[i].frames, shapes[i].images];
+        struct report_decode_ctx ctx = { data };
+
+        /* Count the allocations held by a decoded and formatted report */
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        size_t baseline = live_allocation_count();
+        PLCrashReport *report = decode_report(data);
+        size_t decodeAllocations = live_allocation_count() - baseline;
+        [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: PLCrashReportTextFormatiOS];
+        size_t formatAllocations = live_allocation_count() - baseline;
+        [pool drain];
+
+        NSString *decodeName = [NSString stringWithFormat: @"-[PLCrashReport initWithData:] (%@)", shape];
+        PLCrashBenchmarkResult *decode = [self runBenchmark: decodeName iterations: 50 function: bench_report_decode context: &ctx];
+
+        NSString *formatName = [NSString stringWithFormat: @"PLCrashReportTextFormatter (%@)", shape];
+        PLCrashBenchmarkResult *format = [self runBenchmark: formatName iterations: 50 function: bench_report_format context: &ctx];
+
+        /* bytes per nanosecond * 1000 = MB/s */
+        NSLog(@"%@: %lu bytes; decode %.1f MB/s, %lu allocations; decode+format %.1f MB/s, %lu allocations", shape,
+              (unsigned long) [data length],
+              decode.p50 > 0 ? ([data length] * 1000.0) / decode.p50 : 0.0, (unsigned long) decodeAllocations,
+              format.p50 > 0 ? ([data length] * 1000.0) / format.p50 : 0.0, (unsigned long) formatAllocations);
+    }
+}
+
+#pragma mark Scaling
+
+/**
+ * Log the scaling curve of a benchmark run at each of @a count @a sizes, with median latencies @a p50. The growth
+ * of the median latency relative to the smallest size is reported alongside the growth of the size itself.
+ */
+static void log_scaling_curve (NSString *name, const uint32_t *sizes, const uint64_t *p50, size_t count) {
+    NSMutableString *curve = [NSMutableString stringWithFormat: @"%@ scaling:", name];
+    for (size_t i = 0; i < count; i++) {
+        double size_growth = (double) sizes[i] / sizes[0];
+        double time_growth = p50[0] > 0 ? (double) p50[i] / p50[0] : 0.0;
+        [curve appendFormat: @" %u=%lluns (%.0fx size, %.1fx time)", sizes[i], (unsigned long long) p50[i], size_growth, time_growth];
+    }
+    NSLog(@"%@", curve);
+}
+
+/* Symbol lookup result; see -testSyntheticFixtures */
+struct synthetic_symbol_ctx {
+    pl_vm_address_t address;
+    char name[64];
+    bool found;
+};
+
+static void synthetic_symbol_cb (pl_vm_address_t address, const char *name, void *context) {
+    struct synthetic_symbol_ctx *ctx = (struct synthetic_symbol_ctx *) context;
+    ctx->address = address;
+    strlcpy(ctx->name, name, sizeof(ctx->name));
+    ctx->found = true;
+}
+
+/**
+ * Verify that the synthetic fixtures are parsed as expected; the scaling benchmarks rely on their validity.
+ */
+- (void) testSyntheticFixtures {
+    plcrash_synthetic_image_t synthetic;
+    plcrash_async_macho_t image;
+
+    STAssertEquals(plcrash_synthetic_image_init(&synthetic, 0, 1000, 1000), PLCRASH_ESUCCESS, @"Failed to generate image");
+    STAssertEquals(plcrash_nasync_macho_init(&image, mach_task_self(), synthetic.path, synthetic.header), PLCRASH_ESUCCESS, @"Failed to parse image");
+
+    /* Symbol lookup */
+    pl_vm_address_t function = plcrash_synthetic_image_function_address(&synthetic, 517);
+    struct synthetic_symbol_ctx symbol = { 0, "", false };
+    STAssertEquals(plcrash_async_macho_find_symbol_by_pc(&image, function + 4, synthetic_symbol_cb, &symbol), PLCRASH_ESUCCESS, @"Symbol lookup failed");
+    STAssertTrue(symbol.found, @"Symbol was not found");
+    STAssertEquals(symbol.address, function, @"Incorrect symbol address");
+    STAssertEqualCStrings(symbol.name, "_synthetic_0_0000000517", @"Incorrect symbol name");
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /* FDE lookup */
+    plcrash_async_mobject_t eh_frame;
+    dwarf_frame_reader reader;
+    plcrash_async_dwarf_fde_info_t fde_info;
+
+    STAssertEquals(plcrash_async_macho_map_section(&image, SEG_TEXT, "__eh_frame", &eh_frame), PLCRASH_ESUCCESS, @"Failed to map __eh_frame");
+    const plcrash_async_byteorder_t *byteorder = plcrash_async_macho_byteorder(&image);
+    bool m64 = (byteorder->swap32(image.header.cputype) & CPU_ARCH_ABI64) != 0;
+    STAssertEquals(reader.init(&eh_frame, byteorder, m64, false, NULL), PLCRASH_ESUCCESS, @"Failed to initialize reader");
+
+    STAssertEquals(reader.find_fde(0x0, function + 4, &fde_info), PLCRASH_ESUCCESS, @"FDE was not found");
+    STAssertEquals(fde_info.pc_start, (uint64_t) function, @"Incorrect FDE start");
+    STAssertEquals(fde_info.pc_end, (uint64_t) (function + PLCRASH_SYNTHETIC_FUNCTION_SIZE), @"Incorrect FDE end");
+    plcrash_async_dwarf_fde_info_free(&fde_info);
+    plcrash_async_mobject_free(&eh_frame);
+#endif
+
+    plcrash_nasync_macho_free(&image);
+    plcrash_synthetic_image_free(&synthetic);
+
+    /* Thread population */
+    plcrash_synthetic_threads_t threads;
+    STAssertEquals(plcrash_synthetic_threads_spawn(&threads, 8, 4), PLCRASH_ESUCCESS, @"Failed to spawn threads");
+    STAssertEquals(threads.ready, (uint32_t) 8, @"Not all threads parked");
+    plcrash_synthetic_threads_stop(&threads);
+}
+
+struct image_lookup_ctx {
+    plcrash_async_image_list_t *image_list;
+    plcrash_synthetic_image_t *images;
+    uint32_t count;
+    uint32_t next;
+};
+
+static void bench_image_lookup (void *context) {
+    struct image_lookup_ctx *ctx = (struct image_lookup_ctx *) context;
+
+    /* Visit the images in a stride that defeats any single-entry caching */
+    plcrash_synthetic_image_t *target = &ctx->images[ctx->next];
+    ctx->next = (ctx->next + 7919) % ctx->count;
+
+    plcrash_async_image_list_set_reading(ctx->image_list, true);
+    plcrash_async_image_containing_address(ctx->image_list, plcrash_synthetic_image_function_address(target, 0));
+    plcrash_async_image_list_set_reading(ctx->image_list, false);
+}
+
+/**
+ * Time image lookup by address across image lists of increasing size.
+ */
+- (void) testImageLookupScaling {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    const uint32_t sizes[] = { 10, 100, 1000 };
+    const size_t size_count = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t p50[size_count];
+
+    for (size_t i = 0; i < size_count; i++) {
+        plcrash_synthetic_image_t *images = (plcrash_synthetic_image_t *) calloc(sizes[i], sizeof(*images));
+        plcrash_async_image_list_t list;
+
+        plcrash_nasync_image_list_init(&list, mach_task_self());
+        for (uint32_t j = 0; j < sizes[i]; j++) {
+            STAssertEquals(plcrash_synthetic_image_init(&images[j], j, 64, 64), PLCRASH_ESUCCESS, @"Failed to generate image");
+            plcrash_nasync_image_list_append(&list, images[j].header, images[j].path);
+        }
+
+        struct image_lookup_ctx ctx = { &list, images, sizes[i], 0 };
+        NSString *name = [NSString stringWithFormat: @"plcrash_async_image_containing_address (%u images)", sizes[i]];
+        PLCrashBenchmarkResult *result = [self runBenchmark: name iterations: 10000 function: bench_image_lookup context: &ctx];
+        p50[i] = result.p50;
+
+        plcrash_nasync_image_list_free(&list);
+        for (uint32_t j = 0; j < sizes[i]; j++)
+            plcrash_synthetic_image_free(&images[j]);
+        free(images);
+    }
+
+    log_scaling_curve(@"plcrash_async_image_containing_address", sizes, p50, size_count);
+}
+
+/**
+ * Time symbol table lookup within synthetic images of increasing symbol count.
+ */
+- (void) testFindSymbolScaling {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    const uint32_t sizes[] = { 5000, 50000, 500000 };
+    const size_t size_count = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t p50[size_count];
+
+    for (size_t i = 0; i < size_count; i++) {
+        plcrash_synthetic_image_t synthetic;
+        plcrash_async_macho_t image;
+
+        STAssertEquals(plcrash_synthetic_image_init(&synthetic, 0, sizes[i], 0), PLCRASH_ESUCCESS, @"Failed to generate image");
+        STAssertEquals(plcrash_nasync_macho_init(&image, mach_task_self(), synthetic.path, synthetic.header), PLCRASH_ESUCCESS, @"Failed to parse image");
+
+        /* Look up the final function, which is found late in the (unsorted) symbol table */
+        pl_vm_address_t pc = plcrash_synthetic_image_function_address(&synthetic, sizes[i] - 1) + 4;
+        struct find_symbol_ctx ctx = { &image, PLCRASH_ASYNC_SYMBOL_STRATEGY_SYMBOL_TABLE, pc };
+        NSString *name = [NSString stringWithFormat: @"plcrash_async_find_symbol (%u symbols)", sizes[i]];
+        PLCrashBenchmarkResult *result = [self runBenchmark: name iterations: 100 function: bench_find_symbol context: &ctx];
+        p50[i] = result.p50;
+
+        plcrash_nasync_macho_free(&image);
+        plcrash_synthetic_image_free(&synthetic);
+    }
+
+    log_scaling_curve(@"plcrash_async_find_symbol", sizes, p50, size_count);
+}
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+
+/**
+ * Time FDE lookup within synthetic __eh_frame sections of increasing FDE count.
+ */
+- (void) testFindFDEScaling {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    const uint32_t sizes[] = { 1000, 10000, 100000 };
+    const size_t size_count = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t p50[size_count];
+
+    for (size_t i = 0; i < size_count; i++) {
+        plcrash_synthetic_image_t synthetic;
+        plcrash_async_macho_t image;
+        plcrash_async_mobject_t eh_frame;
+        dwarf_frame_reader reader;
+
+        STAssertEquals(plcrash_synthetic_image_init(&synthetic, 0, 0, sizes[i]), PLCRASH_ESUCCESS, @"Failed to generate image");
+        STAssertEquals(plcrash_nasync_macho_init(&image, mach_task_self(), synthetic.path, synthetic.header), PLCRASH_ESUCCESS, @"Failed to parse image");
+        STAssertEquals(plcrash_async_macho_map_section(&image, SEG_TEXT, "__eh_frame", &eh_frame), PLCRASH_ESUCCESS, @"Failed to map __eh_frame");
+
+        const plcrash_async_byteorder_t *byteorder = plcrash_async_macho_byteorder(&image);
+        bool m64 = (byteorder->swap32(image.header.cputype) & CPU_ARCH_ABI64) != 0;
+        STAssertEquals(reader.init(&eh_frame, byteorder, m64, false, NULL), PLCRASH_ESUCCESS, @"Failed to initialize reader");
+
+        /* Look up the final FDE */
+        struct find_fde_ctx ctx = { &reader, plcrash_synthetic_image_function_address(&synthetic, sizes[i] - 1) + 4 };
+        NSString *name = [NSString stringWithFormat: @"dwarf_frame_reader::find_fde (%u FDEs)", sizes[i]];
+        PLCrashBenchmarkResult *result = [self runBenchmark: name iterations: 100 function: bench_find_fde context: &ctx];
+        p50[i] = result.p50;
+
+        plcrash_async_mobject_free(&eh_frame);
+        plcrash_nasync_macho_free(&image);
+        plcrash_synthetic_image_free(&synthetic);
+    }
+
+    log_scaling_curve(@"dwarf_frame_reader::find_fde", sizes, p50, size_count);
+}
+
+#endif /* PLCRASH_FEATURE_UNWIND_DWARF */
+
+/**
+ * Time writing a complete report for the current process with increasing numbers of additional threads, each
+ * parked at a fixed stack depth.
+ */
+- (void) testLogWriterThreadScaling {
+    if (![PLCrashBenchmark isEnabled])
+        return;
+
+    const uint32_t sizes[] = { 20, 200 };
+    const size_t size_count = sizeof(sizes) / sizeof(sizes[0]);
+    uint64_t p50[size_count];
+
+    plcrash_log_writer_t writer;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+
+    /* Report output is discarded */
+    int fd = open("/dev/null", O_WRONLY);
+    STAssertTrue(fd >= 0, @"Failed to open /dev/null: %s", strerror(errno));
+
+    plcrash_log_bsd_signal_info_t bsd_info;
+    bsd_info.signo = SIGSEGV;
+    bsd_info.code = SEGV_MAPERR;
+    bsd_info.address = (void *) 0x42;
+
+    plcrash_log_signal_info_t info;
+    info.bsd_info = &bsd_info;
+    info.mach_info = NULL;
+
+    for (size_t i = 0; i < size_count; i++) {
+        plcrash_synthetic_threads_t threads;
+        STAssertEquals(plcrash_synthetic_threads_spawn(&threads, sizes[i], 16), PLCRASH_ESUCCESS, @"Failed to spawn threads");
+
+        struct log_writer_ctx ctx = { &writer, &_image_list, pthread_mach_thread_np(_thr_args.thread), &info, fd };
+        NSString *name = [NSString stringWithFormat: @"plcrash_log_writer_write (%u threads)", sizes[i]];
+        PLCrashBenchmarkResult *result = [self runBenchmark: name iterations: 10 function: bench_log_writer_write context: &ctx];
+        p50[i] = result.p50;
+
+        plcrash_synthetic_threads_stop(&threads);
+    }
+
+    log_scaling_curve(@"plcrash_log_writer_write", sizes, p50, size_count);
+
+    close(fd);
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+}
+
+@end
@@ -0,0 +1,178 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+#import <pthread.h>
+#import <mach/mach.h>
+
+#import "PLCrashFeatureConfig.h"
+#import "PLCrashReporter.h"
+#import "PLCrashLogWriter.h"
+#import "PLCrashAsyncImageIndexCache.h"
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+
+#import "PLCrashMachExceptionServer.h"
+
+/**
+ * @internal
+ * The msgh_id of a capture service registration request.
+ */
+#define PLCRASH_CAPTURE_SERVICE_REGISTER_MSGH_ID 0x504c4352
+
+/**
+ * @internal
+ * The msgh_id of a capture service registration reply. Following MIG convention, this is the request ID plus 100.
+ */
+#define PLCRASH_CAPTURE_SERVICE_REGISTER_REPLY_MSGH_ID (PLCRASH_CAPTURE_SERVICE_REGISTER_MSGH_ID + 100)
+
+/**
+ * @internal
+ * The capture service registration protocol version.
+ */
+#define PLCRASH_CAPTURE_SERVICE_PROTOCOL_VERSION 1
+
+/**
+ * @internal
+ * The size of the application identifier and version fields of a registration request, including the NUL terminator.
+ */
+#define PLCRASH_CAPTURE_SERVICE_STRING_MAX 256
+
+/**
+ * @internal
+ * The maximum size of a report written by the capture service, in bytes.
+ */
+#define PLCRASH_CAPTURE_SERVICE_MAX_REPORT_BYTES (256 * 1024)
+
+/**
+ * @internal
+ * A capture service registration request. The request is sent by the client process, and carries send rights to the
+ * client's task control port and to a read-only memory entry for the client's image journal (see
+ * -[PLCrashReporter exportImageListWithMemoryEntry:size:error:]).
+ */
+typedef struct plcrash_capture_service_register_request {
+    mach_msg_header_t header;
+    mach_msg_body_t body;
+
+    /** The client's task control port. */
+    mach_msg_port_descriptor_t task;
+
+    /** The client's image journal memory entry. */
+    mach_msg_port_descriptor_t image_journal;
+
+    /** PLCRASH_CAPTURE_SERVICE_PROTOCOL_VERSION. */
+    uint32_t version;
+
+    /** Reserved; always 0. */
+    uint32_t reserved;
+
+    /** The size of the client's image journal region, in bytes. */
+    uint64_t image_journal_size;
+
+    /** The client's NUL-terminated application identifier. */
+    char app_identifier[PLCRASH_CAPTURE_SERVICE_STRING_MAX];
+
+    /** The client's NUL-terminated application version. */
+    char app_version[PLCRASH_CAPTURE_SERVICE_STRING_MAX];
+} plcrash_capture_service_register_request_t;
+
+/**
+ * @internal
+ * A capture service registration reply.
+ */
+typedef struct plcrash_capture_service_register_reply {
+    mach_msg_header_t header;
+
+    /** KERN_SUCCESS if the client was registered, or the reason that registration failed. */
+    kern_return_t result;
+} plcrash_capture_service_register_reply_t;
+
+@interface PLCrashCaptureService : NSObject {
+@private
+    /** The reporter used to configure report writers and to queue written reports. Not retained; the reporter
+     * owns, and must stop, the service. */
+    PLCrashReporter *_reporter;
+
+    /** The exception server, on whose threads the reports of all clients are written. */
+    PLCrashMachExceptionServer *_server;
+
+    /** The exception port registered for each client task. */
+    PLCrashMachExceptionPort *_exceptionPort;
+
+    /** The receive right on which registration requests and client dead-name notifications are received. */
+    mach_port_t _registrationPort;
+
+    /** The registration thread. */
+    pthread_t _registrationThread;
+
+    /** YES if the registration thread is running. */
+    BOOL _running;
+
+    /** Set to request that the registration thread exit. */
+    volatile uint32_t _stop;
+
+    /** Protects @a _clients and the client reference counts. */
+    pthread_mutex_t _lock;
+
+    /** The registered clients. */
+    struct plcrash_capture_client *_clients;
+
+    /** Symbol and unwind indices shared by all clients' images. */
+    plcrash_async_image_index_cache_t _indexCache;
+}
+
+- (id) initWithReporter: (PLCrashReporter *) reporter
+          exceptionMask: (exception_mask_t) mask
+            workerCount: (NSUInteger) workerCount
+            serviceName: (NSString *) serviceName
+                  error: (NSError **) outError;
+
+- (mach_port_t) copySendRightForRegistrationAndReturningError: (NSError **) outError;
+- (void) stop;
+
++ (BOOL) registerTask: (task_t) task
+      withServicePort: (mach_port_t) servicePort
+applicationIdentifier: (NSString *) applicationIdentifier
+   applicationVersion: (NSString *) applicationVersion
+    imageJournalEntry: (mach_port_t) journalEntry
+     imageJournalSize: (size_t) journalSize
+                error: (NSError **) outError;
+
+@end
+
+/**
+ * @internal
+ * Reporter methods used by the capture service.
+ */
+@interface PLCrashReporter (CaptureService)
+- (plcrash_async_symbol_strategy_t) crashTimeSymbolicationStrategy;
+- (void) configureCapturePolicyForWriter: (plcrash_log_writer_t *) writer;
+- (BOOL) queueReportData: (NSData *) data error: (NSError **) outError;
+@end
+
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
@@ -0,0 +1,856 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashCaptureService.h"
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+
+#import "PLCrashReporterNSError.h"
+#import "PLCrashAsyncImageJournal.h"
+#import "PLCrashAsyncMachExceptionInfo.h"
+
+#import <mach/mach_vm.h>
+#import <mach/notify.h>
+#import <servers/bootstrap.h>
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * The msgh_id of the message used to wake the registration thread when stopping.
+ */
+#define PLCRASH_CAPTURE_SERVICE_STOP_MSGH_ID (PLCRASH_CAPTURE_SERVICE_REGISTER_MSGH_ID + 1)
+
+/**
+ * @internal
+ * The maximum image journal size accepted from a client, in bytes.
+ */
+#define PLCRASH_CAPTURE_SERVICE_MAX_JOURNAL_SIZE (64 * 1024 * 1024)
+
+/**
+ * @internal
+ * The time to wait for a registration reply, in milliseconds.
+ */
+#define PLCRASH_CAPTURE_SERVICE_REGISTER_TIMEOUT 5000
+
+/**
+ * @internal
+ * A message received on the registration port.
+ */
+typedef union plcrash_capture_service_message {
+    mach_msg_header_t header;
+
+    /** A registration request, and the trailer appended by the kernel. */
+    struct {
+        plcrash_capture_service_register_request_t request;
+        mach_msg_max_trailer_t trailer;
+    } registration;
+
+    /** A client task dead-name notification. */
+    mach_dead_name_notification_t dead_name;
+} plcrash_capture_service_message_t;
+
+/**
+ * @internal
+ * A registered client process.
+ */
+struct plcrash_capture_client {
+    /** The next client, or NULL. */
+    struct plcrash_capture_client *next;
+
+    /** The number of references held to this client; one is held by the client list while the client is registered,
+     * and one by each report in progress. Protected by the service lock. */
+    uint32_t refcount;
+
+    /** A send right to the client's task control port. */
+    task_t task;
+
+    /** The client's process ID. */
+    pid_t pid;
+
+    /** The client's image journal, mapped read-only. */
+    const void *journal;
+
+    /** The size of @a journal, in bytes. */
+    size_t journal_size;
+
+    /** The client's application identifier. */
+    NSString *appIdentifier;
+
+    /** The client's application version. */
+    NSString *appVersion;
+
+    /** The exception ports registered for the client task prior to registration. */
+    PLCrashMachExceptionPortSet *previousPorts;
+
+    /** The async-safe representation of @a previousPorts, used to forward exceptions. */
+    plcrash_mach_exception_port_set_t portSet;
+};
+
+static void *plcrash_capture_service_registration_thread (void *arg);
+static kern_return_t plcrash_capture_service_exception_callback (task_t task,
+                                                                 thread_t thread,
+                                                                 exception_type_t exception_type,
+                                                                 mach_exception_data_t code,
+                                                                 mach_msg_type_number_t code_count,
+                                                                 void *context);
+
+@interface PLCrashCaptureService (PrivateMethods)
+- (void) runRegistrationLoop;
+- (kern_return_t) registerClientWithRequest: (plcrash_capture_service_register_request_t *) request;
+- (void) unregisterClientWithTask: (task_t) task;
+- (kern_return_t) handleExceptionForTask: (task_t) task
+                                  thread: (thread_t) thread
+                           exceptionType: (exception_type_t) exception_type
+                                    code: (mach_exception_data_t) code
+                               codeCount: (mach_msg_type_number_t) code_count;
+- (void) writeReportForClient: (struct plcrash_capture_client *) client
+                       thread: (thread_t) thread
+                exceptionType: (exception_type_t) exception_type
+                         code: (mach_exception_data_t) code
+                    codeCount: (mach_msg_type_number_t) code_count;
+@end
+
+/**
+ * @internal
+ *
+ * Release a reference to @a client, freeing the client if no references remain. The service lock must be held.
+ */
+static void plcrash_capture_client_release (struct plcrash_capture_client *client) {
+    PLCF_ASSERT(client->refcount > 0);
+    if (--client->refcount > 0)
+        return;
+
+    if (client->journal != NULL)
+        mach_vm_deallocate(mach_task_self(), (mach_vm_address_t) client->journal, client->journal_size);
+
+    mach_port_deallocate(mach_task_self(), client->task);
+
+    [client->appIdentifier release];
+    [client->appVersion release];
+    [client->previousPorts release];
+    free(client);
+}
+
+/**
+ * @internal
+ *
+ * A capture service for multi-process applications.
+ *
+ * Rather than each process of an application installing its own handlers, and building its own symbol and unwind
+ * indices, each client process registers with a single capture service, typically hosted by a launchd agent. The
+ * service registers its exception port as the client task's exception port; when a client crashes, the report is
+ * written out-of-process, by the service, via plcrash_log_writer_write_task().
+ *
+ * Registration requests carry the client's task control port, and a read-only memory entry for the client's image
+ * journal (see PLCrashAsyncImageJournal.h). At crash time, the client's image list is reconstructed from its
+ * journal, without enumerating the client's images via dyld. The symbol and DWARF FDE indices of each image are
+ * built once, and shared by every client that loads the same image (see PLCrashAsyncImageIndexCache.h); for the
+ * images of the dyld shared cache, which are loaded at the same address by every client, this includes the
+ * unwind indices.
+ *
+ * Each of the service's exception server threads writes reports independently, allowing concurrent crashes in
+ * several clients to be reported in parallel. Written reports are queued by the service's own reporter, and are
+ * identified by the client's application identifier and process info.
+ *
+ * Clients are unregistered when their task terminates, via a dead-name notification on the client's task port.
+ */
+@implementation PLCrashCaptureService
+
+/**
+ * Initialize and start a new capture service.
+ *
+ * @param reporter The reporter used to configure report writers and to queue written reports. The reporter is not
+ * retained, and must stop the service prior to being deallocated.
+ * @param mask The exceptions for which reports will be written.
+ * @param workerCount The number of threads on which reports will be written; this is the number of concurrent
+ * crashes that may be reported.
+ * @param serviceName The launchd service name via which clients will look up the service, or nil. If non-nil,
+ * the registration port is obtained via bootstrap_check_in(), and the name must be declared in the launchd job's
+ * MachServices dictionary. If nil, clients must be provided a registration port obtained via
+ * copySendRightForRegistrationAndReturningError:.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the service could not be started. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the initialized service, or nil on error.
+ */
+- (id) initWithReporter: (PLCrashReporter *) reporter
+          exceptionMask: (exception_mask_t) mask
+            workerCount: (NSUInteger) workerCount
+            serviceName: (NSString *) serviceName
+                  error: (NSError **) outError
+{
+    kern_return_t kr;
+    NSError *osError;
+
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _reporter = reporter;
+    _registrationPort = MACH_PORT_NULL;
+    pthread_mutex_init(&_lock, NULL);
+
+    if (plcrash_nasync_image_index_cache_init(&_indexCache, 0) != PLCRASH_ESUCCESS) {
+        plcrash_populate_posix_error(outError, ENOMEM, @"Failed to allocate the shared image index cache");
+        [self release];
+        return nil;
+    }
+
+    /* Start the report writing threads */
+    _server = [[PLCrashMachExceptionServer alloc] initWithCallBack: plcrash_capture_service_exception_callback
+                                                           context: self
+                                                       threadCount: workerCount
+                                                             error: &osError];
+    if (_server == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to instantiate the Mach exception server.", osError);
+        [self release];
+        return nil;
+    }
+
+    _exceptionPort = [[_server exceptionPortWithMask: mask error: &osError] retain];
+    if (_exceptionPort == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to instantiate the Mach exception port.", osError);
+        [self release];
+        return nil;
+    }
+
+    /* Fetch or allocate the registration port */
+    if (serviceName != nil) {
+        kr = bootstrap_check_in(bootstrap_port, [serviceName UTF8String], &_registrationPort);
+        if (kr != KERN_SUCCESS) {
+            _registrationPort = MACH_PORT_NULL;
+            plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem,
+                                   [NSString stringWithFormat: @"Failed to check in the capture service %@: %s", serviceName, bootstrap_strerror(kr)], nil);
+            [self release];
+            return nil;
+        }
+    } else {
+        kr = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &_registrationPort);
+        if (kr != KERN_SUCCESS) {
+            _registrationPort = MACH_PORT_NULL;
+            plcrash_populate_mach_error(outError, kr, @"Failed to allocate the capture service registration port");
+            [self release];
+            return nil;
+        }
+    }
+
+    /* Start the registration thread */
+    if (pthread_create(&_registrationThread, NULL, plcrash_capture_service_registration_thread, self) != 0) {
+        plcrash_populate_posix_error(outError, errno, @"Could not create the capture service registration thread");
+        [self release];
+        return nil;
+    }
+    _running = YES;
+
+    return self;
+}
+
+- (void) dealloc {
+    [self stop];
+
+    if (_registrationPort != MACH_PORT_NULL)
+        mach_port_mod_refs(mach_task_self(), _registrationPort, MACH_PORT_RIGHT_RECEIVE, -1);
+
+    /* All images that borrowed the cached indices have been freed */
+    if (_indexCache.entries != NULL)
+        plcrash_nasync_image_index_cache_free(&_indexCache);
+
+    pthread_mutex_destroy(&_lock);
+
+    [super dealloc];
+}
+
+/**
+ * Return a new send right to the service's registration port. The caller is responsible for deallocating the right.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the right could not be created. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns the send right, or MACH_PORT_NULL on error.
+ */
+- (mach_port_t) copySendRightForRegistrationAndReturningError: (NSError **) outError {
+    kern_return_t kr = mach_port_insert_right(mach_task_self(), _registrationPort, _registrationPort, MACH_MSG_TYPE_MAKE_SEND);
+    if (kr != KERN_SUCCESS) {
+        plcrash_populate_mach_error(outError, kr, @"Failed to insert a send right for the registration port");
+        return MACH_PORT_NULL;
+    }
+
+    return _registrationPort;
+}
+
+/**
+ * Stop the service. No further registration requests will be accepted, and the exception ports of all registered
+ * clients are restored to those registered prior to their registration. Any reports in progress will be completed
+ * before this method returns.
+ */
+- (void) stop {
+    if (_running) {
+        /* Wake the registration thread */
+        OSAtomicCompareAndSwap32Barrier(0, 1, (int32_t *) &_stop);
+
+        mach_msg_header_t msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_MAKE_SEND, 0);
+        msg.msgh_remote_port = _registrationPort;
+        msg.msgh_local_port = MACH_PORT_NULL;
+        msg.msgh_size = sizeof(msg);
+        msg.msgh_id = PLCRASH_CAPTURE_SERVICE_STOP_MSGH_ID;
+
+        mach_msg_return_t mr = mach_msg(&msg, MACH_SEND_MSG, msg.msgh_size, 0, MACH_PORT_NULL, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+        if (mr != MACH_MSG_SUCCESS) {
+            NSLog(@"Unexpected error sending termination message to the registration thread: %d", mr);
+            return;
+        }
+
+        pthread_join(_registrationThread, NULL);
+        _running = NO;
+    }
+
+    /* Restore the clients' previous exception ports */
+    pthread_mutex_lock(&_lock); {
+        for (struct plcrash_capture_client *client = _clients; client != NULL; client = client->next) {
+            for (PLCrashMachExceptionPort *port in client->previousPorts) {
+                NSError *error;
+                if (![port registerForTask: client->task previousPortSet: NULL error: &error])
+                    PLCF_DEBUG("Failed to restore the exception ports of pid %d: %s", client->pid, [[error description] UTF8String]);
+            }
+        }
+    } pthread_mutex_unlock(&_lock);
+
+    /* Wait for any reports in progress, and stop the exception server threads */
+    [_server release];
+    _server = nil;
+
+    [_exceptionPort release];
+    _exceptionPort = nil;
+
+    /* Release the clients */
+    pthread_mutex_lock(&_lock); {
+        while (_clients != NULL) {
+            struct plcrash_capture_client *client = _clients;
+            _clients = client->next;
+            plcrash_capture_client_release(client);
+        }
+    } pthread_mutex_unlock(&_lock);
+}
+
+/**
+ * Register @a task with the capture service at @a servicePort. On success, reports of the exceptions handled by the
+ * service will be written by the service, out-of-process.
+ *
+ * @param task The task to be registered.
+ * @param servicePort A send right to the service's registration port.
+ * @param applicationIdentifier The application identifier to be recorded in the task's reports.
+ * @param applicationVersion The application version to be recorded in the task's reports.
+ * @param journalEntry A send right to a read-only memory entry for the task's image journal. The right is copied,
+ * and remains owned by the caller.
+ * @param journalSize The size of the image journal region, in bytes.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the task could not be registered. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES if the service registered the task, or NO on error.
+ */
++ (BOOL) registerTask: (task_t) task
+      withServicePort: (mach_port_t) servicePort
+applicationIdentifier: (NSString *) applicationIdentifier
+   applicationVersion: (NSString *) applicationVersion
+    imageJournalEntry: (mach_port_t) journalEntry
+     imageJournalSize: (size_t) journalSize
+                error: (NSError **) outError
+{
+    union {
+        plcrash_capture_service_register_request_t request;
+        struct {
+            plcrash_capture_service_register_reply_t reply;
+            mach_msg_max_trailer_t trailer;
+        } reply;
+    } msg;
+    mach_port_t replyPort;
+    kern_return_t kr;
+
+    kr = mach_port_allocate(mach_task_self(), MACH_PORT_RIGHT_RECEIVE, &replyPort);
+    if (kr != KERN_SUCCESS) {
+        plcrash_populate_mach_error(outError, kr, @"Failed to allocate the registration reply port");
+        return NO;
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.request.header.msgh_bits = MACH_MSGH_BITS_COMPLEX | MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, MACH_MSG_TYPE_MAKE_SEND_ONCE);
+    msg.request.header.msgh_remote_port = servicePort;
+    msg.request.header.msgh_local_port = replyPort;
+    msg.request.header.msgh_size = sizeof(msg.request);
+    msg.request.header.msgh_id = PLCRASH_CAPTURE_SERVICE_REGISTER_MSGH_ID;
+
+    msg.request.body.msgh_descriptor_count = 2;
+    msg.request.task.name = task;
+    msg.request.task.disposition = MACH_MSG_TYPE_COPY_SEND;
+    msg.request.task.type = MACH_MSG_PORT_DESCRIPTOR;
+    msg.request.image_journal.name = journalEntry;
+    msg.request.image_journal.disposition = MACH_MSG_TYPE_COPY_SEND;
+    msg.request.image_journal.type = MACH_MSG_PORT_DESCRIPTOR;
+
+    msg.request.version = PLCRASH_CAPTURE_SERVICE_PROTOCOL_VERSION;
+    msg.request.image_journal_size = journalSize;
+    strlcpy(msg.request.app_identifier, [applicationIdentifier UTF8String], sizeof(msg.request.app_identifier));
+    strlcpy(msg.request.app_version, [applicationVersion UTF8String], sizeof(msg.request.app_version));
+
+    mach_msg_return_t mr = mach_msg(&msg.request.header,
+                                    MACH_SEND_MSG | MACH_RCV_MSG | MACH_SEND_TIMEOUT | MACH_RCV_TIMEOUT,
+                                    sizeof(msg.request),
+                                    sizeof(msg.reply),
+                                    replyPort,
+                                    PLCRASH_CAPTURE_SERVICE_REGISTER_TIMEOUT,
+                                    MACH_PORT_NULL);
+    mach_port_mod_refs(mach_task_self(), replyPort, MACH_PORT_RIGHT_RECEIVE, -1);
+
+    if (mr != MACH_MSG_SUCCESS) {
+        plcrash_populate_mach_error(outError, mr, @"Failed to send the capture service registration request");
+        return NO;
+    }
+
+    if (msg.reply.reply.header.msgh_id != PLCRASH_CAPTURE_SERVICE_REGISTER_REPLY_MSGH_ID || msg.reply.reply.header.msgh_size < sizeof(msg.reply.reply)) {
+        mach_msg_destroy(&msg.reply.reply.header);
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Received an invalid capture service registration reply", nil);
+        return NO;
+    }
+
+    if (msg.reply.reply.result != KERN_SUCCESS) {
+        plcrash_populate_mach_error(outError, msg.reply.reply.result, @"The capture service rejected the registration request");
+        return NO;
+    }
+
+    return YES;
+}
+
+@end
+
+@implementation PLCrashCaptureService (PrivateMethods)
+
+/**
+ * Receive and dispatch registration requests and dead-name notifications until stopped.
+ */
+- (void) runRegistrationLoop {
+    plcrash_capture_service_message_t *msg = malloc(sizeof(*msg));
+    if (msg == NULL) {
+        PLCF_DEBUG("Failed to allocate the registration receive buffer");
+        return;
+    }
+
+    while (true) {
+        mach_msg_return_t mr = mach_msg(&msg->header, MACH_RCV_MSG, 0, sizeof(*msg), _registrationPort, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+        if (mr == MACH_RCV_TOO_LARGE) {
+            PLCF_DEBUG("Discarded an oversized message");
+            continue;
+        } else if (mr != MACH_MSG_SUCCESS) {
+            PLCF_DEBUG("Unexpected error in mach_msg(): 0x%x", mr);
+            continue;
+        }
+
+        switch (msg->header.msgh_id) {
+            case PLCRASH_CAPTURE_SERVICE_STOP_MSGH_ID:
+                if (_stop) {
+                    free(msg);
+                    return;
+                }
+                break;
+
+            case MACH_NOTIFY_DEAD_NAME:
+                if (msg->header.msgh_size >= sizeof(msg->dead_name) - sizeof(msg->dead_name.trailer)) {
+                    [self unregisterClientWithTask: msg->dead_name.not_port];
+
+                    /* The notification holds a reference to the dead name */
+                    mach_port_deallocate(mach_task_self(), msg->dead_name.not_port);
+                }
+                break;
+
+            case PLCRASH_CAPTURE_SERVICE_REGISTER_MSGH_ID: {
+                plcrash_capture_service_register_reply_t reply;
+                mach_port_t replyPort = msg->header.msgh_remote_port;
+
+                kern_return_t result = [self registerClientWithRequest: &msg->registration.request];
+
+                if (replyPort != MACH_PORT_NULL) {
+                    memset(&reply, 0, sizeof(reply));
+                    reply.header.msgh_bits = MACH_MSGH_BITS(MACH_MSGH_BITS_REMOTE(msg->header.msgh_bits), 0);
+                    reply.header.msgh_remote_port = replyPort;
+                    reply.header.msgh_local_port = MACH_PORT_NULL;
+                    reply.header.msgh_size = sizeof(reply);
+                    reply.header.msgh_id = PLCRASH_CAPTURE_SERVICE_REGISTER_REPLY_MSGH_ID;
+                    reply.result = result;
+
+                    mr = mach_msg(&reply.header, MACH_SEND_MSG | MACH_SEND_TIMEOUT, reply.header.msgh_size, 0, MACH_PORT_NULL, 0, MACH_PORT_NULL);
+                    if (mr != MACH_MSG_SUCCESS) {
+                        PLCF_DEBUG("Unexpected failure replying to a registration request: 0x%x", mr);
+                        mach_port_deallocate(mach_task_self(), replyPort);
+                    }
+                }
+                break;
+            }
+
+            default:
+                PLCF_DEBUG("Discarding unexpected message with id %d", msg->header.msgh_id);
+                mach_msg_destroy(&msg->header);
+                break;
+        }
+    }
+}
+
+/**
+ * Register the client described by @a request. The rights carried by @a request are consumed.
+ *
+ * @param request The registration request.
+ *
+ * @return Returns KERN_SUCCESS if the client was registered, or the reason that registration failed.
+ */
+- (kern_return_t) registerClientWithRequest: (plcrash_capture_service_register_request_t *) request {
+    struct plcrash_capture_client *client = NULL;
+    PLCrashMachExceptionPortSet *previous = nil;
+    mach_vm_address_t journal = 0;
+    mach_port_t prevNotify;
+    kern_return_t kr;
+    pid_t pid;
+
+    /* Validate the request */
+    if (!(request->header.msgh_bits & MACH_MSGH_BITS_COMPLEX) ||
+        request->header.msgh_size < sizeof(*request) ||
+        request->body.msgh_descriptor_count != 2 ||
+        request->task.type != MACH_MSG_PORT_DESCRIPTOR ||
+        request->image_journal.type != MACH_MSG_PORT_DESCRIPTOR)
+    {
+        mach_msg_destroy(&request->header);
+        return KERN_INVALID_ARGUMENT;
+    }
+
+    task_t task = request->task.name;
+    mach_port_t journalEntry = request->image_journal.name;
+
+    if (request->version != PLCRASH_CAPTURE_SERVICE_PROTOCOL_VERSION ||
+        request->image_journal_size < sizeof(plcrash_async_image_journal_header_t) ||
+        request->image_journal_size > PLCRASH_CAPTURE_SERVICE_MAX_JOURNAL_SIZE)
+    {
+        kr = KERN_INVALID_ARGUMENT;
+        goto error;
+    }
+
+    /* The task right must name a live task */
+    if ((kr = pid_for_task(task, &pid)) != KERN_SUCCESS)
+        goto error;
+
+    /* Reject duplicate registrations */
+    pthread_mutex_lock(&_lock); {
+        for (struct plcrash_capture_client *c = _clients; c != NULL; c = c->next) {
+            if (c->task == task) {
+                pthread_mutex_unlock(&_lock);
+                PLCF_DEBUG("Ignoring duplicate registration of pid %d", pid);
+
+                /* The client holds a reference to the task name; release only the request's reference */
+                mach_port_deallocate(mach_task_self(), task);
+                mach_port_deallocate(mach_task_self(), journalEntry);
+                return KERN_NAME_EXISTS;
+            }
+        }
+    } pthread_mutex_unlock(&_lock);
+
+    /* Map the image journal */
+    request->app_identifier[sizeof(request->app_identifier) - 1] = '\0';
+    request->app_version[sizeof(request->app_version) - 1] = '\0';
+
+    kr = mach_vm_map(mach_task_self(), &journal, request->image_journal_size, 0, VM_FLAGS_ANYWHERE, journalEntry, 0, FALSE,
+                     VM_PROT_READ, VM_PROT_READ, VM_INHERIT_NONE);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to map the image journal of pid %d: 0x%x", pid, kr);
+        journal = 0;
+        goto error;
+    }
+
+    /* Unregister the client once its task terminates */
+    kr = mach_port_request_notification(mach_task_self(), task, MACH_NOTIFY_DEAD_NAME, 0, _registrationPort, MACH_MSG_TYPE_MAKE_SEND_ONCE, &prevNotify);
+    if (kr != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to request a dead-name notification for pid %d: 0x%x", pid, kr);
+        goto error;
+    }
+    if (prevNotify != MACH_PORT_NULL)
+        mach_port_deallocate(mach_task_self(), prevNotify);
+
+    client = calloc(1, sizeof(*client));
+    if (client == NULL) {
+        kr = KERN_RESOURCE_SHORTAGE;
+        goto error;
+    }
+
+    client->refcount = 1;
+    client->task = task;
+    client->pid = pid;
+    client->journal = (const void *) journal;
+    client->journal_size = request->image_journal_size;
+    client->appIdentifier = [[NSString alloc] initWithUTF8String: request->app_identifier];
+    client->appVersion = [[NSString alloc] initWithUTF8String: request->app_version];
+
+    /* Publish the client before redirecting its exceptions */
+    pthread_mutex_lock(&_lock); {
+        client->next = _clients;
+        _clients = client;
+    } pthread_mutex_unlock(&_lock);
+
+    NSError *error;
+    if (![_exceptionPort registerForTask: task previousPortSet: &previous error: &error]) {
+        PLCF_DEBUG("Failed to set the exception ports of pid %d: %s", pid, [[error description] UTF8String]);
+        [self unregisterClientWithTask: task];
+        mach_port_deallocate(mach_task_self(), journalEntry);
+        return KERN_FAILURE;
+    }
+
+    pthread_mutex_lock(&_lock); {
+        client->previousPorts = [previous retain];
+        client->portSet = [previous asyncSafeRepresentation];
+    } pthread_mutex_unlock(&_lock);
+
+    /* The mapping retains the journal's memory object */
+    mach_port_deallocate(mach_task_self(), journalEntry);
+    return KERN_SUCCESS;
+
+error:
+    if (journal != 0)
+        mach_vm_deallocate(mach_task_self(), journal, request->image_journal_size);
+
+    mach_port_deallocate(mach_task_self(), task);
+    mach_port_deallocate(mach_task_self(), journalEntry);
+    return kr;
+}
+
+/**
+ * Unregister the client for @a task, if any. The client is freed once any reports in progress have been written.
+ *
+ * @param task The client's task port.
+ */
+- (void) unregisterClientWithTask: (task_t) task {
+    pthread_mutex_lock(&_lock); {
+        for (struct plcrash_capture_client **prev = &_clients; *prev != NULL; prev = &(*prev)->next) {
+            struct plcrash_capture_client *client = *prev;
+            if (client->task != task)
+                continue;
+
+            *prev = client->next;
+            plcrash_capture_client_release(client);
+            break;
+        }
+    } pthread_mutex_unlock(&_lock);
+}
+
+/**
+ * Handle an exception raised by a client task. Called on an exception server thread.
+ */
+- (kern_return_t) handleExceptionForTask: (task_t) task
+                                  thread: (thread_t) thread
+                           exceptionType: (exception_type_t) exception_type
+                                    code: (mach_exception_data_t) code
+                               codeCount: (mach_msg_type_number_t) code_count
+{
+    struct plcrash_capture_client *client = NULL;
+
+    /* Acquire a reference to the client, preventing its release should the task terminate while the report is written */
+    pthread_mutex_lock(&_lock); {
+        for (struct plcrash_capture_client *c = _clients; c != NULL; c = c->next) {
+            if (c->task == task) {
+                client = c;
+                client->refcount++;
+                break;
+            }
+        }
+    } pthread_mutex_unlock(&_lock);
+
+    if (client == NULL) {
+        PLCF_DEBUG("Received an exception for an unregistered task");
+        return KERN_FAILURE;
+    }
+
+    /* Let any previously registered server attempt to handle the exception */
+    kern_return_t kr = PLCrashMachExceptionForward(task, thread, exception_type, code, code_count, &client->portSet);
+    if (kr != KERN_SUCCESS) {
+        [self writeReportForClient: client thread: thread exceptionType: exception_type code: code codeCount: code_count];
+
+        /* Allow the exception to be delivered to the host exception handler, and as a BSD signal */
+        kr = KERN_FAILURE;
+    }
+
+    pthread_mutex_lock(&_lock); {
+        plcrash_capture_client_release(client);
+    } pthread_mutex_unlock(&_lock);
+
+    return kr;
+}
+
+/**
+ * Write and queue a report of an exception raised by @a client.
+ */
+- (void) writeReportForClient: (struct plcrash_capture_client *) client
+                       thread: (thread_t) thread
+                exceptionType: (exception_type_t) exception_type
+                         code: (mach_exception_data_t) code
+                    codeCount: (mach_msg_type_number_t) code_count
+{
+    plcrash_async_image_list_t images;
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+
+    /* Set up the signal info */
+    siginfo_t si;
+    if (!plcrash_async_mach_exception_get_siginfo(exception_type, code, code_count, CPU_TYPE_ANY, &si)) {
+        PLCF_DEBUG("Unexpected error mapping Mach exception to a POSIX signal");
+        return;
+    }
+
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    bsd_signal_info.signo = si.si_signo;
+    bsd_signal_info.code = si.si_code;
+    bsd_signal_info.address = si.si_addr;
+
+    plcrash_log_mach_signal_info_t mach_signal_info;
+    mach_signal_info.type = exception_type;
+    mach_signal_info.code = code;
+    mach_signal_info.code_count = code_count;
+
+    plcrash_log_signal_info_t signal_info;
+    signal_info.bsd_info = &bsd_signal_info;
+    signal_info.mach_info = &mach_signal_info;
+
+    /* Reconstruct the client's image list from its journal */
+    void *records = malloc(client->journal_size);
+    size_t length;
+    if (records == NULL) {
+        PLCF_DEBUG("Failed to allocate the image journal snapshot of pid %d", client->pid);
+        return;
+    }
+
+    if ((err = plcrash_async_image_journal_snapshot(client->journal, client->journal_size, records, client->journal_size, &length, NULL)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to snapshot the image journal of pid %d: %d", client->pid, err);
+        free(records);
+        return;
+    }
+
+    plcrash_nasync_image_list_init(&images, client->task);
+    {
+        const plcrash_async_image_journal_record_t *record;
+        size_t offset = 0;
+
+        while ((record = plcrash_async_image_journal_next(records, length, &offset)) != NULL) {
+            if (plcrash_nasync_image_list_contains(&images, record->header_addr))
+                plcrash_nasync_image_list_remove(&images, record->header_addr);
+
+            if (record->op == PLCRASH_ASYNC_IMAGE_JOURNAL_ADD)
+                plcrash_nasync_image_list_append(&images, record->header_addr, record->name);
+        }
+    }
+    free(records);
+
+    /* Borrow the symbol and unwind indices built for earlier clients */
+    plcrash_nasync_image_index_cache_share_list(&_indexCache, &images);
+
+    /* Configure a writer describing the client */
+    err = plcrash_log_writer_init(&writer, client->appIdentifier, client->appVersion, [_reporter crashTimeSymbolicationStrategy], false);
+    if (err != PLCRASH_ESUCCESS) {
+        NSLog(@"Writer initialization failed with error %s", plcrash_async_strerror(err));
+        plcrash_log_writer_free(&writer);
+        plcrash_nasync_image_list_free(&images);
+        return;
+    }
+    [_reporter configureCapturePolicyForWriter: &writer];
+
+    if ((err = plcrash_log_writer_set_target_process(&writer, client->pid)) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Failed to fetch the process info of pid %d: %d", client->pid, err);
+
+    /* Write the report */
+    NSMutableData *data = [NSMutableData dataWithLength: PLCRASH_CAPTURE_SERVICE_MAX_REPORT_BYTES];
+    plcrash_async_file_init_memory(&file, [data mutableBytes], [data length]);
+
+    err = plcrash_log_writer_write_task(&writer, client->task, thread, &images, &file, &signal_info, NULL);
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&images);
+
+    if (err != PLCRASH_ESUCCESS) {
+        NSLog(@"Failed to write the crash report of pid %d: %s", client->pid, plcrash_async_strerror(err));
+        return;
+    }
+
+    /* Trim the buffer to the written report, and queue it */
+    [data setLength: (NSUInteger) plcrash_async_file_tell(&file)];
+
+    NSError *error;
+    if (![_reporter queueReportData: data error: &error])
+        NSLog(@"Failed to queue the crash report of pid %d: %@", client->pid, error);
+}
+
+@end
+
+/**
+ * @internal
+ *
+ * Registration thread entry point.
+ */
+static void *plcrash_capture_service_registration_thread (void *arg) {
+    PLCrashCaptureService *service = arg;
+
+    @autoreleasepool {
+        [service runRegistrationLoop];
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Exception server callback; writes a report of an exception raised by a client task. Unlike the in-process
+ * callbacks, the service is not constrained to async-safe operations, and may allocate.
+ */
+static kern_return_t plcrash_capture_service_exception_callback (task_t task,
+                                                                 thread_t thread,
+                                                                 exception_type_t exception_type,
+                                                                 mach_exception_data_t code,
+                                                                 mach_msg_type_number_t code_count,
+                                                                 void *context)
+{
+    PLCrashCaptureService *service = context;
+    kern_return_t kr;
+
+    @autoreleasepool {
+        kr = [service handleExceptionForTask: task thread: thread exceptionType: exception_type code: code codeCount: code_count];
+    }
+
+    /* Release the task and thread rights carried by the exception message; the client holds its own task reference */
+    mach_port_deallocate(mach_task_self(), task);
+    mach_port_deallocate(mach_task_self(), thread);
+
+    return kr;
+}
+
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
@@ -0,0 +1,137 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashCaptureService.h"
+#import "PLCrashAsyncImageJournal.h"
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+
+@interface PLCrashCaptureServiceTests : SenTestCase {
+@private
+    PLCrashReporter *_reporter;
+    PLCrashCaptureService *_service;
+    mach_port_t _servicePort;
+    plcrash_async_image_journal_t _journal;
+}
+@end
+
+@implementation PLCrashCaptureServiceTests
+
+- (void) setUp {
+    NSError *error;
+
+    _reporter = [[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]];
+
+    /* EXC_SOFTWARE is not otherwise raised by the test process */
+    _service = [[PLCrashCaptureService alloc] initWithReporter: _reporter exceptionMask: EXC_MASK_SOFTWARE workerCount: 2 serviceName: nil error: &error];
+    STAssertNotNil(_service, @"Failed to start the capture service: %@", error);
+
+    _servicePort = [_service copySendRightForRegistrationAndReturningError: &error];
+    STAssertTrue(MACH_PORT_VALID(_servicePort), @"Failed to fetch the registration port: %@", error);
+
+    STAssertEquals(plcrash_nasync_image_journal_init(&_journal, 0), PLCRASH_ESUCCESS, @"Failed to initialize journal");
+}
+
+- (void) tearDown {
+    [_service stop];
+    [_service release];
+    [_reporter release];
+
+    mach_port_deallocate(mach_task_self(), _servicePort);
+    plcrash_nasync_image_journal_free(&_journal);
+}
+
+/* Register the current task with the test service */
+- (BOOL) registerWithJournalSize: (size_t) size error: (NSError **) outError {
+    return [PLCrashCaptureService registerTask: mach_task_self()
+                               withServicePort: _servicePort
+                         applicationIdentifier: @"test.identifier"
+                            applicationVersion: @"1.0"
+                             imageJournalEntry: plcrash_nasync_image_journal_memory_entry(&_journal)
+                              imageJournalSize: size
+                                         error: outError];
+}
+
+/* Return the server port registered for EXC_SOFTWARE */
+- (mach_port_t) softwareExceptionPort {
+    NSError *error;
+    PLCrashMachExceptionPortSet *ports = [PLCrashMachExceptionPort exceptionPortsForTask: mach_task_self() mask: EXC_MASK_SOFTWARE error: &error];
+    STAssertNotNil(ports, @"Failed to fetch port state: %@", error);
+
+    mach_port_t result = MACH_PORT_NULL;
+    for (PLCrashMachExceptionPort *port in ports) {
+        if (port.mask & EXC_MASK_SOFTWARE)
+            result = port.server_port;
+    }
+
+    return result;
+}
+
+/**
+ * Verify that registration redirects the task's exception ports to the service, and that stopping the service
+ * restores the previous ports.
+ */
+- (void) testRegisterTask {
+    NSError *error;
+    mach_port_t initial = [self softwareExceptionPort];
+
+    STAssertTrue([self registerWithJournalSize: _journal.size error: &error], @"Failed to register: %@", error);
+    mach_port_t registered = [self softwareExceptionPort];
+    STAssertTrue(MACH_PORT_VALID(registered), @"No exception port was registered");
+    STAssertNotEquals(registered, initial, @"The exception port was not changed");
+
+    [_service stop];
+    STAssertEquals([self softwareExceptionPort], initial, @"The previous exception port was not restored");
+}
+
+/**
+ * Verify that a task may only be registered once.
+ */
+- (void) testDuplicateRegistration {
+    NSError *error;
+
+    STAssertTrue([self registerWithJournalSize: _journal.size error: &error], @"Failed to register: %@", error);
+    STAssertFalse([self registerWithJournalSize: _journal.size error: &error], @"Duplicate registration was accepted");
+}
+
+/**
+ * Verify that requests describing an invalid image journal are rejected.
+ */
+- (void) testRejectInvalidJournal {
+    NSError *error;
+    mach_port_t initial = [self softwareExceptionPort];
+
+    STAssertFalse([self registerWithJournalSize: 0 error: &error], @"Empty journal was accepted");
+    STAssertEquals([self softwareExceptionPort], initial, @"The exception port was changed by a rejected registration");
+}
+
+@end
+
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
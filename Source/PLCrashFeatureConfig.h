@@ -64,6 +64,29 @@
 #  endif
 #endif
 
+/*
+ * Minimal builds (eg, for app extensions with tight binary size and memory limits) exclude all frame readers other
+ * than the frame pointer reader, along with the Objective-C metadata symbolicator and the signpost/DTrace probes.
+ * Individual features may still be re-enabled explicitly.
+ */
+#ifdef PLCRASH_MINIMAL_BUILD
+#  ifndef PLCRASH_FEATURE_UNWIND_DWARF
+#    define PLCRASH_FEATURE_UNWIND_DWARF 0
+#  endif
+#  ifndef PLCRASH_FEATURE_UNWIND_COMPACT
+#    define PLCRASH_FEATURE_UNWIND_COMPACT 0
+#  endif
+#  ifndef PLCRASH_FEATURE_UNWIND_STACK_SCAN
+#    define PLCRASH_FEATURE_UNWIND_STACK_SCAN 0
+#  endif
+#  ifndef PLCRASH_FEATURE_SYMBOLICATE_OBJC
+#    define PLCRASH_FEATURE_SYMBOLICATE_OBJC 0
+#  endif
+#  ifndef PLCRASH_FEATURE_PROBES
+#    define PLCRASH_FEATURE_PROBES 0
+#  endif
+#endif
+
 /*
  * Configuration Flags
  */
@@ -98,6 +121,29 @@
 #    define PLCRASH_FEATURE_UNWIND_COMPACT 1
 #endif
 
+#ifndef PLCRASH_FEATURE_UNWIND_STACK_SCAN
+/** If true, fall back on heuristic stack scanning when no other frame reader is able to recover the next frame. */
+#    define PLCRASH_FEATURE_UNWIND_STACK_SCAN 1
+#endif
+
+#ifndef PLCRASH_FEATURE_SYMBOLICATE_OBJC
+/**
+ * If true, enable symbolication of Objective-C methods via the image's Objective-C runtime metadata. If disabled,
+ * the parser is excluded from the build, and only the symbol table is used for symbolication.
+ */
+#    define PLCRASH_FEATURE_SYMBOLICATE_OBJC 1
+#endif
+
+#ifndef PLCRASH_FEATURE_PROBES
+/**
+ * If true, emit os_signpost intervals and USDT (DTrace) probes at the phase boundaries of the crash reporter's
+ * non-crash paths: enabling the reporter, live report generation, stack sampling, and dyld image notifications.
+ * Signposts are only emitted on OS releases that support them, and both mechanisms cost no more than a flag check
+ * while no tool is observing the process. The crash-time path is never instrumented.
+ */
+#    define PLCRASH_FEATURE_PROBES 1
+#endif
+
 /**
  * @}
  */
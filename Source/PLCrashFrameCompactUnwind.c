@@ -38,6 +38,8 @@
  *
  * @param task The task containing the target frame stack.
  * @param image_list The list of images loaded in the target @a task.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
  * @param current_frame The current stack frame.
  * @param previous_frame The previous stack frame, or NULL if this is the first frame.
  * @param next_frame The new frame to be initialized.
@@ -46,10 +48,13 @@
  */
 plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
                                                     plcrash_async_image_list_t *image_list,
+                                                    plcrash_async_macho_section_cache_t *section_cache,
+                                                    plcrash_async_mobject_t *stack_window,
                                                     const plframe_stackframe_t *current_frame,
                                                     const plframe_stackframe_t *previous_frame,
                                                     plframe_stackframe_t *next_frame)
 {
+    plcrash_async_mobject_t *unwind_mobj = NULL;
     plframe_error_t result;
     plcrash_error_t err;
 
@@ -70,8 +75,8 @@ plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
     }
     
     /* Map the unwind section */
-    plcrash_async_mobject_t unwind_mobj;
-    err = plcrash_async_macho_map_section(&image->macho_image, SEG_TEXT, "__unwind_info", &unwind_mobj);
+    plcrash_async_mobject_t unwind_storage;
+    err = plcrash_async_macho_section_cache_map(section_cache, &image->macho_image, SEG_TEXT, "__unwind_info", &unwind_storage, &unwind_mobj);
     if (err != PLCRASH_ESUCCESS) {
         if (err != PLCRASH_ENOTFOUND)
             PLCF_DEBUG("Could not map the compact unwind info section for image %s: %d", image->macho_image.name, err);
@@ -83,13 +88,16 @@ plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
     cpu_type_t cputype = image->macho_image.byteorder->swap32(image->macho_image.header.cputype);
     plcrash_async_cfe_reader_t reader;
 
-    err = plcrash_async_cfe_reader_init(&reader, &unwind_mobj, cputype);
+    err = plcrash_async_cfe_reader_init(&reader, unwind_mobj, cputype);
     if (err != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Could not parse the compact unwind info section for image '%s': %d", image->macho_image.name, err);
         result = PLFRAME_EINVAL;
         goto cleanup;
     }
 
+    if (section_cache != NULL)
+        plcrash_async_cfe_reader_set_work_budget(&reader, section_cache->work_budget);
+
     /* Find the encoding entry (if any) and free the reader */
     pl_vm_address_t function_base;
     uint32_t encoding;
@@ -117,6 +125,16 @@ plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
         plcrash_async_cfe_entry_free(&entry);
         goto cleanup;
     }
+
+    /* The encoding defers to DWARF; hand the FDE's __eh_frame offset to the DWARF reader, allowing the FDE to be
+     * decoded directly rather than searched for. */
+    if (plcrash_async_cfe_entry_type(&entry) == PLCRASH_ASYNC_CFE_ENTRY_TYPE_DWARF) {
+        plcrash_async_macho_section_cache_set_fde_hint(section_cache, &image->macho_image, pc, plcrash_async_cfe_entry_stack_offset(&entry));
+        result = PLFRAME_ENOTSUP;
+
+        plcrash_async_cfe_entry_free(&entry);
+        goto cleanup;
+    }
     
     /* Compute the in-core function address */
     pl_vm_address_t function_address;
@@ -130,7 +148,7 @@ plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
     }
 
     /* Apply the frame delta -- this may fail. */
-    if ((err = plcrash_async_cfe_entry_apply(task, function_address, &current_frame->thread_state, &entry, &next_frame->thread_state)) == PLCRASH_ESUCCESS) {
+    if ((err = plcrash_async_cfe_entry_apply(task, stack_window, section_cache, function_address, &current_frame->thread_state, &entry, &next_frame->thread_state)) == PLCRASH_ESUCCESS) {
         result = PLFRAME_ESUCCESS;
     } else {
         PLCF_DEBUG("Failed to apply CFE encoding 0x%" PRIx32 " for PC 0x%" PRIx64 ": %d", encoding, (uint64_t) pc, err);
@@ -140,6 +158,9 @@ plframe_error_t plframe_cursor_read_compact_unwind (task_t task,
     plcrash_async_cfe_entry_free(&entry);
 
 cleanup:
+    if (unwind_mobj != NULL)
+        plcrash_async_macho_section_cache_unmap(section_cache, unwind_mobj);
+
     plcrash_async_image_list_set_reading(image_list, false);
     return result;
 }
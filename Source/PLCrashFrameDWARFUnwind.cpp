@@ -31,10 +31,12 @@
 
 #include "PLCrashAsyncDwarfEncoding.hpp"
 #include "PLCrashAsyncDwarfCFAState.hpp"
+#include "PLCrashAsyncDwarfCFATable.h"
 
 #include "PLCrashFeatureConfig.h"
 
 #include <inttypes.h>
+#include <string.h>
 
 #include <limits>
 
@@ -42,6 +44,277 @@
 
 using namespace plcrash::async;
 
+/**
+ * @internal
+ * Number of CIEs retained per pointer size by a plframe_dwarf_cie_cache_t.
+ */
+#define PLFRAME_DWARF_CIE_CACHE_SIZE 4
+
+/**
+ * @internal
+ *
+ * A cached CIE.
+ *
+ * @tparam machine_ptr The native machine pointer type for the target data.
+ * @tparam machine_ptr_s The native machine signed pointer type for the target data.
+ */
+template<typename machine_ptr, typename machine_ptr_s>
+struct plframe_dwarf_cie_cache_entry {
+    /** The image containing the CIE, or NULL if this entry is unused. */
+    plcrash_async_macho_t *image;
+
+    /** The task-relative address of the CIE. */
+    pl_vm_address_t cie_address;
+
+    /** The parsed CIE. */
+    plcrash_async_dwarf_cie_info_t cie_info;
+
+    /** If true, @a initial_state is valid. If false, the CIE's initial instructions depend on the FDE's location, and
+     * must be evaluated for every FDE. */
+    bool has_initial_state;
+
+    /** The CFA state resulting from evaluating the CIE's initial instructions. */
+    dwarf_cfa_state<machine_ptr, machine_ptr_s> initial_state;
+};
+
+/**
+ * @internal
+ *
+ * DWARF CIE cache; see plframe_dwarf_cie_cache_new().
+ */
+struct plframe_dwarf_cie_cache {
+    // Custom new/delete that do not rely on the stdlib
+    void *operator new (size_t size) { return malloc(size); };
+    void *operator new (size_t size, void *ptr) { return ptr; };
+    void operator delete (void *ptr) { free(ptr); };
+
+    /** 32-bit CIE entries. */
+    plframe_dwarf_cie_cache_entry<uint32_t, int32_t> entries_32[PLFRAME_DWARF_CIE_CACHE_SIZE];
+
+    /** The index of the next 32-bit entry to be replaced. */
+    size_t next_32;
+
+    /** 64-bit CIE entries. */
+    plframe_dwarf_cie_cache_entry<uint64_t, int64_t> entries_64[PLFRAME_DWARF_CIE_CACHE_SIZE];
+
+    /** The index of the next 64-bit entry to be replaced. */
+    size_t next_64;
+};
+
+/* Return the 32-bit entry table from @a cache, and its replacement index in @a next. */
+static plframe_dwarf_cie_cache_entry<uint32_t, int32_t> *plframe_dwarf_cie_cache_entries (plframe_dwarf_cie_cache_t *cache, uint32_t, size_t **next) {
+    *next = &cache->next_32;
+    return cache->entries_32;
+}
+
+/* Return the 64-bit entry table from @a cache, and its replacement index in @a next. */
+static plframe_dwarf_cie_cache_entry<uint64_t, int64_t> *plframe_dwarf_cie_cache_entries (plframe_dwarf_cie_cache_t *cache, uint64_t, size_t **next) {
+    *next = &cache->next_64;
+    return cache->entries_64;
+}
+
+/**
+ * Allocate a new, empty CIE cache.
+ *
+ * @param cache On success, will be set to the new cache. The cache must be freed via plframe_dwarf_cie_cache_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be allocated.
+ *
+ * @warning This method is not async safe.
+ */
+plcrash_error_t plframe_dwarf_cie_cache_new (plframe_dwarf_cie_cache_t **cache) {
+    plframe_dwarf_cie_cache_t *result = new plframe_dwarf_cie_cache_t;
+    if (result == NULL)
+        return PLCRASH_ENOMEM;
+
+    plframe_dwarf_cie_cache_reset(result);
+    *cache = result;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Allocate a new, empty CIE cache from @a allocator.
+ *
+ * @param allocator The allocator from which the cache will be allocated.
+ * @param cache On success, will be set to the new cache. The cache must be released via plcrash_async_allocator_free(),
+ * and must not be passed to plframe_dwarf_cie_cache_free().
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if insufficient space is available in @a allocator.
+ */
+plcrash_error_t plframe_dwarf_cie_cache_new_with_allocator (plcrash_async_allocator_t *allocator, plframe_dwarf_cie_cache_t **cache) {
+    void *buffer = plcrash_async_allocator_alloc(allocator, sizeof(plframe_dwarf_cie_cache_t), true);
+    if (buffer == NULL)
+        return PLCRASH_ENOMEM;
+
+    plframe_dwarf_cie_cache_t *result = new (buffer) plframe_dwarf_cie_cache_t;
+    plframe_dwarf_cie_cache_reset(result);
+    *cache = result;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Remove all entries from @a cache. This method is async-safe.
+ *
+ * @param cache The cache to be reset.
+ */
+void plframe_dwarf_cie_cache_reset (plframe_dwarf_cie_cache_t *cache) {
+    for (size_t i = 0; i < PLFRAME_DWARF_CIE_CACHE_SIZE; i++) {
+        cache->entries_32[i].image = NULL;
+        cache->entries_64[i].image = NULL;
+    }
+
+    cache->next_32 = 0;
+    cache->next_64 = 0;
+}
+
+/**
+ * Free @a cache.
+ *
+ * @param cache The cache to be freed.
+ *
+ * @warning This method is not async safe.
+ */
+void plframe_dwarf_cie_cache_free (plframe_dwarf_cie_cache_t *cache) {
+    delete cache;
+}
+
+/**
+ * @internal
+ *
+ * Fetch the cached entry for the CIE at @a cie_address in @a image.
+ *
+ * @param section_cache The section cache, or NULL.
+ * @param image The image containing the CIE.
+ * @param cie_address The task-relative address of the CIE.
+ *
+ * @return Returns the cached entry, or NULL if not found.
+ */
+template<typename machine_ptr, typename machine_ptr_s>
+static plframe_dwarf_cie_cache_entry<machine_ptr, machine_ptr_s> *plframe_dwarf_cie_cache_find (plcrash_async_macho_section_cache_t *section_cache,
+                                                                                                 plcrash_async_macho_t *image,
+                                                                                                 pl_vm_address_t cie_address)
+{
+    if (section_cache == NULL || section_cache->dwarf_cie_cache == NULL)
+        return NULL;
+
+    size_t *next;
+    plframe_dwarf_cie_cache_entry<machine_ptr, machine_ptr_s> *entries = plframe_dwarf_cie_cache_entries(section_cache->dwarf_cie_cache, (machine_ptr) 0, &next);
+    for (size_t i = 0; i < PLFRAME_DWARF_CIE_CACHE_SIZE; i++) {
+        if (entries[i].image == image && entries[i].cie_address == cie_address)
+            return &entries[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Insert a CIE into the cache, replacing the oldest entry.
+ *
+ * @param section_cache The section cache, or NULL.
+ * @param image The image containing the CIE.
+ * @param cie_address The task-relative address of the CIE.
+ * @param cie_info The parsed CIE.
+ * @param initial_state The CFA state resulting from evaluation of the CIE's initial instructions, or NULL if the
+ * state is location-dependent.
+ */
+template<typename machine_ptr, typename machine_ptr_s>
+static void plframe_dwarf_cie_cache_insert (plcrash_async_macho_section_cache_t *section_cache,
+                                            plcrash_async_macho_t *image,
+                                            pl_vm_address_t cie_address,
+                                            const plcrash_async_dwarf_cie_info_t *cie_info,
+                                            const dwarf_cfa_state<machine_ptr, machine_ptr_s> *initial_state)
+{
+    if (section_cache == NULL || section_cache->dwarf_cie_cache == NULL)
+        return;
+
+    size_t *next;
+    plframe_dwarf_cie_cache_entry<machine_ptr, machine_ptr_s> *entries = plframe_dwarf_cie_cache_entries(section_cache->dwarf_cie_cache, (machine_ptr) 0, &next);
+    plframe_dwarf_cie_cache_entry<machine_ptr, machine_ptr_s> *entry = &entries[*next];
+    *next = (*next + 1) % PLFRAME_DWARF_CIE_CACHE_SIZE;
+
+    entry->image = image;
+    entry->cie_address = cie_address;
+    entry->cie_info = *cie_info;
+    entry->has_initial_state = (initial_state != NULL);
+    if (initial_state != NULL)
+        entry->initial_state = *initial_state;
+}
+
+/**
+ * @internal
+ *
+ * Apply the unwind rules of a compiled CFA table @a row to @a current_frame.
+ *
+ * @param task The task containing the target frame stack.
+ * @param image The image containing the current frame's PC.
+ * @param table The compiled CFA table containing @a row.
+ * @param row The table row covering the current frame's PC.
+ * @param budget The work budget to be consumed when evaluating CFA expressions, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
+ * @param current_frame The current stack frame.
+ * @param next_frame The new frame to be initialized.
+ *
+ * @tparam machine_ptr The native machine pointer type for the target data.
+ * @tparam machine_ptr_s The native machine signed pointer type for the target data.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
+ */
+template<typename machine_ptr, typename machine_ptr_s>
+static plframe_error_t plframe_cursor_apply_dwarf_cfa_row (task_t task,
+                                                           plcrash_async_macho_t *image,
+                                                           const plcrash_async_dwarf_cfa_table_t *table,
+                                                           const plcrash_async_dwarf_cfa_table_row_t *row,
+                                                           plcrash_async_work_budget_t *budget,
+                                                           plcrash_async_mobject_t *stack_window,
+                                                           const plframe_stackframe_t *current_frame,
+                                                           plframe_stackframe_t *next_frame)
+{
+    plcrash::async::dwarf_cfa_state<machine_ptr, machine_ptr_s> cfa_state;
+    plcrash_error_t err;
+
+    cfa_state.set_work_budget(budget);
+
+    /* Reconstruct the CFA state */
+    switch (row->cfa_type) {
+        case DWARF_CFA_STATE_CFA_TYPE_UNDEFINED:
+            break;
+
+        case DWARF_CFA_STATE_CFA_TYPE_EXPRESSION:
+            cfa_state.set_cfa_expression(row->cfa_value, row->cfa_expression_length);
+            break;
+
+        case DWARF_CFA_STATE_CFA_TYPE_REGISTER:
+            cfa_state.set_cfa_register(row->cfa_regnum, (machine_ptr) row->cfa_value);
+            break;
+
+        case DWARF_CFA_STATE_CFA_TYPE_REGISTER_SIGNED:
+            cfa_state.set_cfa_register_signed(row->cfa_regnum, (machine_ptr_s) row->cfa_value);
+            break;
+    }
+
+    for (uint8_t i = 0; i < row->rule_count; i++) {
+        const plcrash_async_dwarf_cfa_table_rule_t *rule = &table->rules[row->rule_index + i];
+        if (!cfa_state.set_register(rule->regnum, (plcrash_dwarf_cfa_reg_rule_t) rule->rule, (machine_ptr) rule->value)) {
+            PLCF_DEBUG("Exhausted available register slots while restoring compiled CFA state");
+            return PLFRAME_ENOTSUP;
+        }
+    }
+
+    /* Of the CIE data, only the return address register is required to apply the state */
+    plcrash_async_dwarf_cie_info_t cie_info;
+    memset(&cie_info, 0, sizeof(cie_info));
+    cie_info.return_address_register = row->return_address_register;
+
+    if ((err = cfa_state.apply_state(task, &cie_info, &current_frame->thread_state, image->byteorder, &next_frame->thread_state, stack_window)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to apply compiled CFA state for PC 0x%" PRIx64 ": %d", row->pc_start, err);
+        return PLFRAME_ENOFRAME;
+    }
+
+    return PLFRAME_ESUCCESS;
+}
+
 /**
  * @internal
  *
@@ -50,6 +323,8 @@ using namespace plcrash::async;
  * @param task The task containing the target frame stack.
  * @param pc The current frame's PC value.
  * @param image The Mach-O image for the current stack frame.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
  * @param current_frame The current stack frame.
  * @param previous_frame The previous stack frame, or NULL if this is the first frame.
  * @param next_frame The new frame to be initialized.
@@ -63,17 +338,30 @@ template<typename machine_ptr, typename machine_ptr_s>
 static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
                                                              machine_ptr pc,
                                                              plcrash_async_macho_t *image,
+                                                             plcrash_async_macho_section_cache_t *section_cache,
+                                                             plcrash_async_mobject_t *stack_window,
                                                              const plframe_stackframe_t *current_frame,
                                                              const plframe_stackframe_t *previous_frame,
                                                              plframe_stackframe_t *next_frame)
 {
+    /* Prefer the image's compiled CFA table, if one has been published and covers the PC */
+    plcrash_async_dwarf_cfa_table_t *cfa_table = image->dwarf_cfa_table;
+    if (cfa_table != NULL) {
+        const plcrash_async_dwarf_cfa_table_row_t *row = plcrash_async_dwarf_cfa_table_find(cfa_table, pc);
+        if (row != NULL)
+            return plframe_cursor_apply_dwarf_cfa_row<machine_ptr, machine_ptr_s>(task, image, cfa_table, row, section_cache != NULL ? section_cache->work_budget : NULL, stack_window, current_frame, next_frame);
+    }
+
     gnu_ehptr_reader<machine_ptr> ptr_state(image->byteorder);
 
     /* Mapped DWARF sections; only one of eh_frame/debug_frame will be mapped */
-    plcrash_async_mobject_t eh_frame;
-    plcrash_async_mobject_t debug_frame;
+    plcrash_async_mobject_t dwarf_storage;
     plcrash_async_mobject_t *dwarf_section = NULL;
     bool is_debug_frame = false;
+
+    /* Mapped eh_frame_hdr search table, if any */
+    plcrash_async_mobject_t eh_frame_hdr_storage;
+    plcrash_async_mobject_t *eh_frame_hdr_section = NULL;
     
     /* Reader state */
     dwarf_frame_reader reader;
@@ -83,9 +371,12 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
     
     plcrash_async_dwarf_cie_info_t cie_info;
     bool did_init_cie = false;
+    pl_vm_address_t cie_address;
+    plframe_dwarf_cie_cache_entry<machine_ptr, machine_ptr_s> *cached_cie;
     
     /* CFA evaluation stack */
     plcrash::async::dwarf_cfa_state<machine_ptr, machine_ptr_s> cfa_state;
+    bool has_initial_state = false;
     
     plframe_error_t result;
     plcrash_error_t err;
@@ -95,17 +386,16 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
      * as such, we prefer eh_frame, but allow falling back on debug_frame.
      */
     {
-        err = plcrash_async_macho_map_section(image, "__TEXT", "__eh_frame", &eh_frame);
+        err = plcrash_async_macho_section_cache_map(section_cache, image, "__TEXT", "__eh_frame", &dwarf_storage, &dwarf_section);
         if (err == PLCRASH_ESUCCESS) {
-            dwarf_section = &eh_frame;
+            /* The eh_frame_hdr binary search table is optional, and is not emitted by all toolchains. */
+            plcrash_async_macho_section_cache_map(section_cache, image, "__TEXT", "__eh_frame_hdr", &eh_frame_hdr_storage, &eh_frame_hdr_section);
         }
         
         if (dwarf_section == NULL) {
-            err = plcrash_async_macho_map_section(image, "__DWARF", "__debug_frame", &debug_frame);
-            if (err == PLCRASH_ESUCCESS) {
-                dwarf_section = &debug_frame;
+            err = plcrash_async_macho_section_cache_map(section_cache, image, "__DWARF", "__debug_frame", &dwarf_storage, &dwarf_section);
+            if (err == PLCRASH_ESUCCESS)
                 is_debug_frame = true;
-            }
         }
         
         /* If neither, there's nothing to do */
@@ -117,15 +407,38 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
     }
     
     /* Initialize the reader. */
-    if ((err = reader.init(dwarf_section, image->byteorder, image->m64, is_debug_frame)) != PLCRASH_ESUCCESS) {
+    if ((err = reader.init(dwarf_section, image->byteorder, image->m64, is_debug_frame, eh_frame_hdr_section)) != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Could not initialize a %s DWARF parser for the current frame pc: 0x%" PRIx64 " %d", (is_debug_frame ? "debug_frame" : "eh_frame"), (uint64_t) pc, err);
         result = PLFRAME_EINVAL;
         goto cleanup;
     }
+
+    /* Bound the work performed by any linear scan and CFA evaluation */
+    if (section_cache != NULL)
+        reader.set_work_budget(section_cache->work_budget);
+
+    /* Without an eh_frame_hdr search table, use the image's FDE index if one has been built. Otherwise, the FDE
+     * must be found by a linear scan; request that an index be built outside of crash time. */
+    if (eh_frame_hdr_section == NULL) {
+        const plcrash_async_dwarf_fde_index_t *fde_index = image->dwarf_fde_index;
+        if (fde_index != NULL)
+            reader.set_fde_index(fde_index);
+        else
+            image->dwarf_fde_index_requested = true;
+    }
     
-    /* Find the FDE (if any) */
+    /* Find the FDE (if any). If the compact unwind encoding deferred to DWARF, it supplies the FDE's __eh_frame
+     * offset, and the FDE is decoded directly; should the hinted FDE not cover the PC, fall back on a search. */
     {
-        err = reader.find_fde(0x0 /* offset hint */, pc, &fde_info);
+        pl_vm_off_t fde_offset;
+        bool hinted = plcrash_async_macho_section_cache_take_fde_hint(section_cache, image, pc, &fde_offset) && !is_debug_frame;
+
+        err = PLCRASH_ENOTFOUND;
+        if (hinted)
+            err = reader.find_fde_at(fde_offset, pc, &fde_info);
+
+        if (err != PLCRASH_ESUCCESS)
+            err = reader.find_fde(0x0 /* offset hint */, pc, &fde_info);
         
         if (err != PLCRASH_ESUCCESS) {
             result = PLFRAME_ENOTSUP;
@@ -139,9 +452,20 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
         // TODO - configure the pointer state */
     }
     
+    /* Fetch the CIE info and initial CFA state from the CIE cache, if available */
+    cie_address = plcrash_async_mobject_base_address(dwarf_section) + fde_info.cie_offset;
+    if ((cached_cie = plframe_dwarf_cie_cache_find<machine_ptr, machine_ptr_s>(section_cache, image, cie_address)) != NULL) {
+        cie_info = cached_cie->cie_info;
+
+        if (cached_cie->has_initial_state) {
+            cfa_state = cached_cie->initial_state;
+            has_initial_state = true;
+        }
+    }
+
     /* Parse CIE info */
-    {
-        err = plcrash_async_dwarf_cie_info_init(&cie_info, dwarf_section, image->byteorder, &ptr_state, plcrash_async_mobject_base_address(dwarf_section) + fde_info.cie_offset);
+    if (cached_cie == NULL) {
+        err = plcrash_async_dwarf_cie_info_init(&cie_info, dwarf_section, image->byteorder, &ptr_state, cie_address);
         if (err != PLCRASH_ESUCCESS) {
             PLCF_DEBUG("Failed to parse CIE at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.cie_offset, err);
             result = PLFRAME_ENOTSUP;
@@ -152,18 +476,29 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
         did_init_cie = true;
     }
     
-    /* Evaluate the CFA instruction opcodes */
+    /* Evaluate the CFA instruction opcodes. The budget is set after any cached initial state has been copied. */
+    if (section_cache != NULL)
+        cfa_state.set_work_budget(section_cache->work_budget);
+
     {
         /* Assert that pc_start won't overflow machine_ptr. This could only occur if we were to use a 64-bit FDE parser with 32-bit CFA evaluation
          * TODO: The FDE pc_start value should probably by typed for the target architecture. */
         PLCF_ASSERT(fde_info.pc_start < std::numeric_limits<machine_ptr>::max());
 
         /* Initial instructions */
-        err = cfa_state.eval_program(dwarf_section, pc, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, plcrash_async_mobject_base_address(dwarf_section), cie_info.initial_instructions_offset, cie_info.initial_instructions_length);
-        if (err != PLCRASH_ESUCCESS) {
-            PLCF_DEBUG("Failed to evaluate CFA at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.instructions_offset, err);
-            result = PLFRAME_ENOTSUP;
-            goto cleanup;
+        if (!has_initial_state) {
+            bool location_dependent;
+            err = cfa_state.eval_program(dwarf_section, pc, fde_info.pc_start, &cie_info, &ptr_state, image->byteorder, plcrash_async_mobject_base_address(dwarf_section), cie_info.initial_instructions_offset, cie_info.initial_instructions_length, &location_dependent);
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to evaluate CFA at offset of 0x%" PRIx64 ": %d", (uint64_t) fde_info.instructions_offset, err);
+                result = PLFRAME_ENOTSUP;
+                goto cleanup;
+            }
+
+            /* Cache the parsed CIE. The resulting CFA state may only be reused by other FDEs if it does not depend on
+             * the FDE's location. */
+            if (cached_cie == NULL)
+                plframe_dwarf_cie_cache_insert<machine_ptr, machine_ptr_s>(section_cache, image, cie_address, &cie_info, (location_dependent || pc < fde_info.pc_start) ? NULL : &cfa_state);
         }
         
         /*  FDE instructions */
@@ -176,7 +511,7 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
     }
     
     /* Apply the frame delta -- this may fail. */
-    if ((err = cfa_state.apply_state(task, &cie_info, &current_frame->thread_state, image->byteorder, &next_frame->thread_state)) == PLCRASH_ESUCCESS) {
+    if ((err = cfa_state.apply_state(task, &cie_info, &current_frame->thread_state, image->byteorder, &next_frame->thread_state, stack_window)) == PLCRASH_ESUCCESS) {
         result = PLFRAME_ESUCCESS;
     } else {
         PLCF_DEBUG("Failed to apply CFA state for PC 0x%" PRIx64 ": %d", (uint64_t) pc, err);
@@ -187,7 +522,10 @@ static plframe_error_t plframe_cursor_read_dwarf_unwind_int (task_t task,
     
 cleanup:
     if (dwarf_section != NULL)
-        plcrash_async_mobject_free(dwarf_section);
+        plcrash_async_macho_section_cache_unmap(section_cache, dwarf_section);
+
+    if (eh_frame_hdr_section != NULL)
+        plcrash_async_macho_section_cache_unmap(section_cache, eh_frame_hdr_section);
     
     if (did_init_cie)
         plcrash_async_dwarf_cie_info_free(&cie_info);
@@ -203,6 +541,8 @@ cleanup:
  *
  * @param task The task containing the target frame stack.
  * @param image_list The list of images loaded in the target @a task.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
  * @param current_frame The current stack frame.
  * @param previous_frame The previous stack frame, or NULL if this is the first frame.
  * @param next_frame The new frame to be initialized.
@@ -211,6 +551,8 @@ cleanup:
  */
 plframe_error_t plframe_cursor_read_dwarf_unwind (task_t task,
                                                   plcrash_async_image_list_t *image_list,
+                                                  plcrash_async_macho_section_cache_t *section_cache,
+                                                  plcrash_async_mobject_t *stack_window,
                                                   const plframe_stackframe_t *current_frame,
                                                   const plframe_stackframe_t *previous_frame,
                                                   plframe_stackframe_t *next_frame)
@@ -243,12 +585,12 @@ plframe_error_t plframe_cursor_read_dwarf_unwind (task_t task,
         /* Could only happen due to programmer error; eg, an image that doesn't actually match our thread state */
         PLCF_ASSERT(pc <= UINT64_MAX);
 
-        ferr = plframe_cursor_read_dwarf_unwind_int<uint64_t, int64_t>(task, pc, &image->macho_image, current_frame, previous_frame, next_frame);
+        ferr = plframe_cursor_read_dwarf_unwind_int<uint64_t, int64_t>(task, pc, &image->macho_image, section_cache, stack_window, current_frame, previous_frame, next_frame);
     } else {
         /* Could only happen due to programmer error; eg, an image that doesn't actually match our thread state */
         PLCF_ASSERT(pc <= UINT32_MAX);
 
-        ferr = plframe_cursor_read_dwarf_unwind_int<uint32_t, int32_t>(task, pc, &image->macho_image, current_frame, previous_frame, next_frame);
+        ferr = plframe_cursor_read_dwarf_unwind_int<uint32_t, int32_t>(task, pc, &image->macho_image, section_cache, stack_window, current_frame, previous_frame, next_frame);
     }
     
     plcrash_async_image_list_set_reading(image_list, false);
@@ -29,6 +29,7 @@
 
 #include "PLCrashFeatureConfig.h"
 #include "PLCrashFrameWalker.h"
+#include "PLCrashAsyncAllocator.h"
 
 #if PLCRASH_FEATURE_UNWIND_DWARF
 
@@ -37,8 +38,25 @@ extern "C" {
 #endif
 
 
+/**
+ * @internal
+ *
+ * A fixed-size cache of parsed DWARF CIEs, and of the CFA state that results from evaluating each CIE's initial
+ * instructions. A cache may be attached to a plcrash_async_macho_section_cache_t, and must be reset via
+ * plframe_dwarf_cie_cache_reset() whenever the images referenced by the cache may have been removed from the
+ * image list.
+ */
+typedef struct plframe_dwarf_cie_cache plframe_dwarf_cie_cache_t;
+
+plcrash_error_t plframe_dwarf_cie_cache_new (plframe_dwarf_cie_cache_t **cache);
+plcrash_error_t plframe_dwarf_cie_cache_new_with_allocator (plcrash_async_allocator_t *allocator, plframe_dwarf_cie_cache_t **cache);
+void plframe_dwarf_cie_cache_reset (plframe_dwarf_cie_cache_t *cache);
+void plframe_dwarf_cie_cache_free (plframe_dwarf_cie_cache_t *cache);
+
 plframe_error_t plframe_cursor_read_dwarf_unwind (task_t task,
                                                   plcrash_async_image_list_t *image_list,
+                                                  plcrash_async_macho_section_cache_t *section_cache,
+                                                  plcrash_async_mobject_t *stack_window,
                                                   const plframe_stackframe_t *current_frame,
                                                   const plframe_stackframe_t *previous_frame,
                                                   plframe_stackframe_t *next_frame);
@@ -0,0 +1,138 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashFrameSigtramp.h"
+#include "PLCrashAsync.h"
+
+#include <sys/ucontext.h>
+#include <stddef.h>
+#include <inttypes.h>
+
+/*
+ * The signal frame layout is only known for the host's 64-bit mcontext; other targets fall back on the DWARF reader.
+ */
+#if defined(PLCRASH_ASYNC_THREAD_ARM64_SUPPORT)
+#  define PLFRAME_SIGTRAMP_SUPPORTED 1
+
+/** The callee-saved register in which _sigtramp preserves its ucontext_t argument across the signal handler call. */
+#  define PLFRAME_SIGTRAMP_UCONTEXT_REG PLCRASH_ARM64_X19
+
+/** The minimum valid uc_mcsize; only the exception and thread state are restored. */
+#  define PLFRAME_SIGTRAMP_MCONTEXT_MIN_SIZE offsetof(struct __darwin_mcontext64, __ns)
+
+#elif defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT) && defined(__LP64__)
+#  define PLFRAME_SIGTRAMP_SUPPORTED 1
+#  define PLFRAME_SIGTRAMP_UCONTEXT_REG PLCRASH_X86_64_RBX
+#  define PLFRAME_SIGTRAMP_MCONTEXT_MIN_SIZE offsetof(struct __darwin_mcontext64, __fs)
+#endif
+
+/** The maximum plausible uc_mcsize, including any extended (eg, AVX-512) floating point state. */
+#define PLFRAME_SIGTRAMP_MCONTEXT_MAX_SIZE (16 * 1024)
+
+/**
+ * Fetch the interrupted frame of a signal handler, assuming that @a current_frame is the _sigtramp trampoline that
+ * called the handler. The interrupted thread state is restored directly from the trampoline's ucontext_t, rather
+ * than by evaluating the trampoline's DWARF CFI expressions.
+ *
+ * The trampoline's address range is found when its image is added to @a image_list; see
+ * plcrash_async_image_list_get_sigtramp().
+ *
+ * @param task The task containing the target frame stack.
+ * @param image_list The list of images loaded in the target @a task.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
+ * @param current_frame The current stack frame.
+ * @param previous_frame The previous stack frame, or NULL if this is the first frame.
+ * @param next_frame The new frame to be initialized.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOTSUP if @a current_frame is not a _sigtramp frame, or a
+ * standard plframe_error_t code if an error occurs.
+ */
+plframe_error_t plframe_cursor_read_sigtramp (task_t task,
+                                              plcrash_async_image_list_t *image_list,
+                                              plcrash_async_macho_section_cache_t *section_cache,
+                                              plcrash_async_mobject_t *stack_window,
+                                              const plframe_stackframe_t *current_frame,
+                                              const plframe_stackframe_t *previous_frame,
+                                              plframe_stackframe_t *next_frame)
+{
+#if PLFRAME_SIGTRAMP_SUPPORTED
+    pl_vm_address_t start;
+    pl_vm_address_t end;
+    plcrash_error_t err;
+
+    /* Fetch the IP. It should always be available */
+    if (!plcrash_async_thread_state_has_reg(&current_frame->thread_state, PLCRASH_REG_IP)) {
+        PLCF_DEBUG("Frame is missing a valid IP register, skipping signal frame reader");
+        return PLFRAME_EBADFRAME;
+    }
+    plcrash_greg_t pc = plcrash_async_thread_state_get_reg(&current_frame->thread_state, PLCRASH_REG_IP);
+
+    /* Only _sigtramp frames are supported */
+    if (!plcrash_async_image_list_get_sigtramp(image_list, &start, &end) || (pl_vm_address_t) pc < start || (pl_vm_address_t) pc >= end)
+        return PLFRAME_ENOTSUP;
+
+    if (plcrash_async_thread_state_get_greg_size(&current_frame->thread_state) != sizeof(uint64_t))
+        return PLFRAME_ENOTSUP;
+
+    if (!plcrash_async_thread_state_has_reg(&current_frame->thread_state, PLFRAME_SIGTRAMP_UCONTEXT_REG)) {
+        PLCF_DEBUG("The _sigtramp ucontext register is unavailable at PC 0x%" PRIx64, (uint64_t) pc);
+        return PLFRAME_ENOTSUP;
+    }
+    plcrash_greg_t uctx_addr = plcrash_async_thread_state_get_reg(&current_frame->thread_state, PLFRAME_SIGTRAMP_UCONTEXT_REG);
+
+    /* The context may reside on an alternate signal stack, and is not bounds checked against the thread's stack */
+    ucontext_t uctx;
+    if ((err = plcrash_async_mobject_task_memcpy(stack_window, task, (pl_vm_address_t) uctx_addr, 0, &uctx, sizeof(uctx))) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read the _sigtramp ucontext at 0x%" PRIx64 ": %d", (uint64_t) uctx_addr, err);
+        return PLFRAME_ENOTSUP;
+    }
+
+    /* Reject anything that does not resemble a signal context, deferring to the DWARF reader */
+    if (uctx.uc_mcontext == NULL || uctx.uc_mcsize < PLFRAME_SIGTRAMP_MCONTEXT_MIN_SIZE || uctx.uc_mcsize > PLFRAME_SIGTRAMP_MCONTEXT_MAX_SIZE) {
+        PLCF_DEBUG("Invalid _sigtramp ucontext at 0x%" PRIx64, (uint64_t) uctx_addr);
+        return PLFRAME_ENOTSUP;
+    }
+
+    struct __darwin_mcontext64 mctx;
+    plcrash_async_memset(&mctx, 0, sizeof(mctx));
+    err = plcrash_async_mobject_task_memcpy(stack_window, task, (pl_vm_address_t) uctx.uc_mcontext, 0, &mctx, PLFRAME_SIGTRAMP_MCONTEXT_MIN_SIZE);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read the _sigtramp mcontext at 0x%" PRIx64 ": %d", (uint64_t) (uintptr_t) uctx.uc_mcontext, err);
+        return PLFRAME_ENOTSUP;
+    }
+
+    /* Restore the complete interrupted thread state */
+    *next_frame = *current_frame;
+    plcrash_async_thread_state_mcontext_init(&next_frame->thread_state, &mctx);
+
+    return PLFRAME_ESUCCESS;
+#else
+    return PLFRAME_ENOTSUP;
+#endif /* PLFRAME_SIGTRAMP_SUPPORTED */
+}
@@ -0,0 +1,146 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashFrameSigtramp.h"
+
+#import <dlfcn.h>
+#import <sys/ucontext.h>
+
+/**
+ * @internal
+ *
+ * This code tests the _sigtramp signal frame reader.
+ */
+@interface PLCrashFrameSigtrampTests : SenTestCase {
+@private
+    plcrash_async_image_list_t _image_list;
+
+    /** The address range of _sigtramp, or 0 if the trampoline could not be found. */
+    pl_vm_address_t _start;
+    pl_vm_address_t _end;
+}
+
+@end
+
+@implementation PLCrashFrameSigtrampTests
+
+- (void) setUp {
+    Dl_info info;
+
+    plcrash_nasync_image_list_init(&_image_list, mach_task_self());
+
+    void *sigtramp = dlsym(RTLD_DEFAULT, "_sigtramp");
+    if (sigtramp == NULL || dladdr(sigtramp, &info) == 0)
+        return;
+
+    plcrash_nasync_image_list_append(&_image_list, (pl_vm_address_t) info.dli_fbase, info.dli_fname);
+    if (!plcrash_async_image_list_get_sigtramp(&_image_list, &_start, &_end)) {
+        _start = 0;
+        _end = 0;
+    }
+}
+
+- (void) tearDown {
+    plcrash_nasync_image_list_free(&_image_list);
+}
+
+/**
+ * Verify that the trampoline's range is found when its image is added to the image list.
+ */
+- (void) testFindSigtramp {
+    void *sigtramp = dlsym(RTLD_DEFAULT, "_sigtramp");
+    if (sigtramp == NULL)
+        return;
+
+    STAssertEquals(_start, (pl_vm_address_t) sigtramp, @"Incorrect _sigtramp address");
+    STAssertTrue(_end > _start, @"Invalid _sigtramp end address");
+}
+
+#if defined(__arm64__) || defined(__x86_64__)
+
+/**
+ * Initialize @a frame as a _sigtramp frame at @a pc, referencing @a uctx.
+ */
+- (void) initFrame: (plframe_stackframe_t *) frame pc: (pl_vm_address_t) pc context: (ucontext_t *) uctx {
+#if defined(__arm64__)
+    STAssertEquals(plcrash_async_thread_state_init(&frame->thread_state, CPU_TYPE_ARM64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    plcrash_async_thread_state_set_reg(&frame->thread_state, PLCRASH_ARM64_X19, (plcrash_greg_t) uctx);
+#else
+    STAssertEquals(plcrash_async_thread_state_init(&frame->thread_state, CPU_TYPE_X86_64), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    plcrash_async_thread_state_set_reg(&frame->thread_state, PLCRASH_X86_64_RBX, (plcrash_greg_t) uctx);
+#endif
+    plcrash_async_thread_state_set_reg(&frame->thread_state, PLCRASH_REG_IP, pc);
+}
+
+/**
+ * Verify that the interrupted thread state is restored from the trampoline's context.
+ */
+- (void) testReadContext {
+    if (_start == 0)
+        return;
+
+    struct __darwin_mcontext64 mctx;
+    ucontext_t uctx;
+    plframe_stackframe_t frame;
+    plframe_stackframe_t next;
+
+    memset(&mctx, 0, sizeof(mctx));
+    memset(&uctx, 0, sizeof(uctx));
+#if defined(__arm64__)
+    mctx.__ss.__pc = 0x1000;
+    mctx.__ss.__sp = 0x2000;
+    mctx.__ss.__fp = 0x3000;
+#else
+    mctx.__ss.__rip = 0x1000;
+    mctx.__ss.__rsp = 0x2000;
+    mctx.__ss.__rbp = 0x3000;
+#endif
+    uctx.uc_mcontext = &mctx;
+    uctx.uc_mcsize = sizeof(mctx);
+
+    [self initFrame: &frame pc: _start + 1 context: &uctx];
+    STAssertEquals(plframe_cursor_read_sigtramp(mach_task_self(), &_image_list, NULL, NULL, &frame, NULL, &next), PLFRAME_ESUCCESS, @"Failed to read the signal frame");
+
+    STAssertEquals(plcrash_async_thread_state_get_reg(&next.thread_state, PLCRASH_REG_IP), (plcrash_greg_t) 0x1000, @"Incorrect PC");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&next.thread_state, PLCRASH_REG_SP), (plcrash_greg_t) 0x2000, @"Incorrect SP");
+    STAssertEquals(plcrash_async_thread_state_get_reg(&next.thread_state, PLCRASH_REG_FP), (plcrash_greg_t) 0x3000, @"Incorrect FP");
+
+    /* Frames outside of the trampoline are not handled */
+    [self initFrame: &frame pc: _end context: &uctx];
+    STAssertEquals(plframe_cursor_read_sigtramp(mach_task_self(), &_image_list, NULL, NULL, &frame, NULL, &next), PLFRAME_ENOTSUP, @"Read a frame outside of _sigtramp");
+
+    /* Implausible contexts are rejected */
+    uctx.uc_mcsize = 0;
+    [self initFrame: &frame pc: _start + 1 context: &uctx];
+    STAssertEquals(plframe_cursor_read_sigtramp(mach_task_self(), &_image_list, NULL, NULL, &frame, NULL, &next), PLFRAME_ENOTSUP, @"Accepted an invalid context");
+}
+
+#endif /* defined(__arm64__) || defined(__x86_64__) */
+
+@end
@@ -0,0 +1,298 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashFrameStackScan.h"
+#include "PLCrashAsync.h"
+
+#include <mach/machine.h>
+
+/**
+ * @internal
+ *
+ * Return the index of the first word in @a words[start..count) that falls within [@a text_base, @a text_base + @a text_span),
+ * or @a count if no such word exists.
+ *
+ * Words are compared four at a time using a branch-free unsigned range check, allowing the compiler to vectorize
+ * the common case of a run of non-candidate stack words.
+ */
+static size_t plframe_stack_scan_find64 (const uint64_t *words, size_t start, size_t count, uint64_t text_base, uint64_t text_span) {
+    size_t i = start;
+    for (; i + 4 <= count; i += 4) {
+        bool hit = ((words[i] - text_base) < text_span) | ((words[i+1] - text_base) < text_span) |
+                   ((words[i+2] - text_base) < text_span) | ((words[i+3] - text_base) < text_span);
+        if (hit)
+            break;
+    }
+
+    for (; i < count; i++) {
+        if (words[i] - text_base < text_span)
+            return i;
+    }
+
+    return count;
+}
+
+/**
+ * @internal
+ *
+ * 32-bit variant of plframe_stack_scan_find64().
+ */
+static size_t plframe_stack_scan_find32 (const uint32_t *words, size_t start, size_t count, uint32_t text_base, uint32_t text_span) {
+    size_t i = start;
+    for (; i + 4 <= count; i += 4) {
+        bool hit = ((uint32_t)(words[i] - text_base) < text_span) | ((uint32_t)(words[i+1] - text_base) < text_span) |
+                   ((uint32_t)(words[i+2] - text_base) < text_span) | ((uint32_t)(words[i+3] - text_base) < text_span);
+        if (hit)
+            break;
+    }
+
+    for (; i < count; i++) {
+        if ((uint32_t)(words[i] - text_base) < text_span)
+            return i;
+    }
+    
+    return count;
+}
+
+/**
+ * @internal
+ *
+ * Determine whether the instruction immediately preceding @a retaddr within @a image is a call instruction, in which
+ * case @a retaddr is plausibly a return address. Images of an unrecognized CPU type are accepted on the basis of the
+ * address range check alone.
+ *
+ * @param task The task containing @a image.
+ * @param image The image containing @a retaddr.
+ * @param retaddr The candidate return address.
+ */
+static bool plframe_stack_scan_is_call_site (task_t task, plcrash_async_macho_t *image, pl_vm_address_t retaddr) {
+    const plcrash_async_byteorder_t *byteorder = image->byteorder;
+    uint8_t code[8];
+
+    /* The call instruction must lie entirely within the image's TEXT range */
+    if (retaddr - image->header_addr < sizeof(code))
+        return false;
+
+    switch (image->header.cputype) {
+        case CPU_TYPE_X86:
+        case CPU_TYPE_X86_64:
+            if (plcrash_async_task_memcpy(task, retaddr, -(pl_vm_off_t) sizeof(code), code, sizeof(code)) != PLCRASH_ESUCCESS)
+                return false;
+
+            /* call rel32 */
+            if (code[sizeof(code) - 5] == 0xE8)
+                return true;
+
+            /* call r/m (FF /2), with a ModRM-encoded operand of up to six bytes */
+            for (size_t len = 2; len <= 7; len++) {
+                if (code[sizeof(code) - len] == 0xFF && ((code[sizeof(code) - len + 1] >> 3) & 0x7) == 2)
+                    return true;
+            }
+            return false;
+
+        case CPU_TYPE_ARM: {
+            if (retaddr & 0x1) {
+                /* Thumb; the low bit of the return address is set */
+                uint16_t hw[2];
+                if (plcrash_async_task_memcpy(task, retaddr & ~(pl_vm_address_t)0x1, -(pl_vm_off_t) sizeof(hw), hw, sizeof(hw)) != PLCRASH_ESUCCESS)
+                    return false;
+
+                uint16_t hw1 = plcrash_async_byteorder_swap16(byteorder, hw[0]);
+                uint16_t hw2 = plcrash_async_byteorder_swap16(byteorder, hw[1]);
+
+                /* BL/BLX immediate (32-bit) */
+                if ((hw1 & 0xF800) == 0xF000 && (hw2 & 0xC000) == 0xC000)
+                    return true;
+
+                /* BLX register (16-bit) */
+                if ((hw2 & 0xFF87) == 0x4780)
+                    return true;
+
+                return false;
+            }
+
+            uint32_t insn;
+            if (plcrash_async_task_memcpy(task, retaddr, -(pl_vm_off_t) sizeof(insn), &insn, sizeof(insn)) != PLCRASH_ESUCCESS)
+                return false;
+            insn = plcrash_async_byteorder_swap32(byteorder, insn);
+
+            /* BL, BLX immediate, BLX register */
+            return ((insn & 0x0F000000) == 0x0B000000 && (insn >> 28) != 0xF) ||
+                   (insn & 0xFE000000) == 0xFA000000 ||
+                   (insn & 0x0FFFFFF0) == 0x012FFF30;
+        }
+
+#ifdef CPU_TYPE_ARM64
+        case CPU_TYPE_ARM64: {
+            uint32_t insn;
+            if (plcrash_async_task_memcpy(task, retaddr, -(pl_vm_off_t) sizeof(insn), &insn, sizeof(insn)) != PLCRASH_ESUCCESS)
+                return false;
+            insn = plcrash_async_byteorder_swap32(byteorder, insn);
+
+            /* BL, BLR */
+            return (insn & 0xFC000000) == 0x94000000 || (insn & 0xFFFFFC1F) == 0xD63F0000;
+        }
+#endif
+
+        default:
+            return true;
+    }
+}
+
+/**
+ * Fetch the next frame by scanning the stack for a plausible return address. This is a heuristic reader of last
+ * resort, intended to recover frames when no unwind data is available and the frame pointer chain has been
+ * omitted or corrupted.
+ *
+ * Starting at the current frame's stack pointer (or, if unavailable, the address just past the frame record
+ * referenced by the frame pointer), stack words within @a stack_window are compared against the TEXT range spanned
+ * by the images in @a image_list. Each candidate must fall within a specific image's TEXT range, and must
+ * immediately follow a call instruction.
+ *
+ * @param task The task containing the target frame stack.
+ * @param image_list The list of images loaded in the target @a task.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack. If NULL, PLFRAME_ENOTSUP will be returned.
+ * @param current_frame The current stack frame.
+ * @param previous_frame The previous stack frame, or NULL if this is the first frame.
+ * @param next_frame The new frame to be initialized.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
+ */
+plframe_error_t plframe_cursor_read_stack_scan (task_t task,
+                                                plcrash_async_image_list_t *image_list,
+                                                plcrash_async_macho_section_cache_t *section_cache,
+                                                plcrash_async_mobject_t *stack_window,
+                                                const plframe_stackframe_t *current_frame,
+                                                const plframe_stackframe_t *previous_frame,
+                                                plframe_stackframe_t *next_frame)
+{
+    const plcrash_async_thread_state_t *thread_state = &current_frame->thread_state;
+    size_t greg_size = plcrash_async_thread_state_get_greg_size(thread_state);
+    bool x64 = (greg_size == sizeof(uint64_t));
+
+    if (stack_window == NULL)
+        return PLFRAME_ENOTSUP;
+
+    /* Only downward-growing stacks are supported */
+    if (plcrash_async_thread_state_get_stack_direction(thread_state) != PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN)
+        return PLFRAME_ENOTSUP;
+
+    /* A NULL FP means a terminated frame */
+    if (plcrash_async_thread_state_has_reg(thread_state, PLCRASH_REG_FP) && plcrash_async_thread_state_get_reg(thread_state, PLCRASH_REG_FP) == 0x0)
+        return PLFRAME_ENOFRAME;
+
+    /* Determine the scan's starting address */
+    pl_vm_address_t start;
+    if (plcrash_async_thread_state_has_reg(thread_state, PLCRASH_REG_SP)) {
+        start = plcrash_async_thread_state_get_reg(thread_state, PLCRASH_REG_SP);
+    } else if (plcrash_async_thread_state_has_reg(thread_state, PLCRASH_REG_FP)) {
+        start = plcrash_async_thread_state_get_reg(thread_state, PLCRASH_REG_FP) + (greg_size * 2);
+    } else {
+        PLCF_DEBUG("Neither the stack pointer nor the frame pointer are available, can't scan the stack.");
+        return PLFRAME_EBADFRAME;
+    }
+
+    /* Align to the word size, and clamp the scan to the mapped window */
+    start = (start + (greg_size - 1)) & ~((pl_vm_address_t) greg_size - 1);
+
+    pl_vm_address_t window_base = plcrash_async_mobject_base_address(stack_window);
+    pl_vm_address_t window_end = window_base + plcrash_async_mobject_length(stack_window);
+    if (start < window_base || start >= window_end)
+        return PLFRAME_ENOTSUP;
+    
+    size_t count = (size_t) ((window_end - start) / greg_size);
+    if (count > PLFRAME_STACK_SCAN_MAX_WORDS)
+        count = PLFRAME_STACK_SCAN_MAX_WORDS;
+
+    if (count == 0)
+        return PLFRAME_ENOFRAME;
+
+    const void *words = plcrash_async_mobject_remap_address(stack_window, start, 0, count * greg_size);
+    if (words == NULL) {
+        PLCF_DEBUG("Failed to map the stack scan range");
+        return PLFRAME_EBADFRAME;
+    }
+
+    /*
+     * Mark the list as being read; this prevents any deallocation of our borrowed references to the image index and
+     * its images, and must be balanced by a call below to mark reading as completed.
+     */
+    plcrash_async_image_list_set_reading(image_list, true);
+
+    plcrash_async_image_index_t *index = image_list->_index;
+    if (index == NULL || index->count == 0) {
+        plcrash_async_image_list_set_reading(image_list, false);
+        return PLFRAME_ENOTSUP;
+    }
+
+    /* The index is sorted by header address, and TEXT ranges do not overlap; the last image's TEXT range ends
+     * the span covered by the list. */
+    plcrash_async_macho_t *last = &index->images[index->count - 1]->macho_image;
+    pl_vm_address_t text_base = index->images[0]->macho_image.header_addr;
+    pl_vm_address_t text_span = (last->header_addr + last->text_size) - text_base;
+
+    size_t i = 0;
+    plcrash_greg_t retaddr = 0;
+    bool found = false;
+    while (!found) {
+        if (x64) {
+            i = plframe_stack_scan_find64(words, i, count, text_base, text_span);
+        } else {
+            i = plframe_stack_scan_find32(words, i, count, (uint32_t) text_base, (uint32_t) text_span);
+        }
+
+        if (i >= count)
+            break;
+
+        retaddr = x64 ? ((const uint64_t *) words)[i] : ((const uint32_t *) words)[i];
+
+        plcrash_async_image_t *image = plcrash_async_image_containing_address(image_list, retaddr);
+        if (image != NULL && plframe_stack_scan_is_call_site(task, &image->macho_image, retaddr)) {
+            found = true;
+        } else {
+            i++;
+        }
+    }
+
+    plcrash_async_image_list_set_reading(image_list, false);
+
+    if (!found) {
+        PLCF_DEBUG("No return address found within %zu stack words", count);
+        return PLFRAME_ENOFRAME;
+    }
+
+    /* Initialize the new frame; only the non-volatile registers are carried over from the current frame. The caller's
+     * stack pointer follows the return address slot. */
+    *next_frame = *current_frame;
+    plcrash_async_thread_state_clear_volatile_regs(&next_frame->thread_state);
+    plcrash_async_thread_state_set_reg(&next_frame->thread_state, PLCRASH_REG_IP, retaddr);
+    plcrash_async_thread_state_set_reg(&next_frame->thread_state, PLCRASH_REG_SP, start + ((i + 1) * greg_size));
+
+    return PLFRAME_ESUCCESS;
+}
@@ -0,0 +1,134 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashFrameStackScan.h"
+
+#import <dlfcn.h>
+
+/**
+ * @internal
+ *
+ * This code tests heuristic stack scanning.
+ */
+@interface PLCrashFrameStackScanTests : SenTestCase {
+@private
+    plcrash_async_image_list_t _image_list;
+
+    /** The cpu type of the test image */
+    cpu_type_t _cpu_type;
+
+    /** The test image's header address */
+    uintptr_t _header;
+}
+
+@end
+
+/* Return the return address of this function's caller; this is guaranteed to follow a call instruction */
+static uintptr_t __attribute__((noinline)) stack_scan_return_address (void) {
+    return (uintptr_t) __builtin_return_address(0);
+}
+
+@implementation PLCrashFrameStackScanTests
+
+- (void) setUp {
+    Dl_info info;
+
+    plcrash_nasync_image_list_init(&_image_list, mach_task_self());
+
+    STAssertTrue(dladdr((void *) stack_scan_return_address, &info) > 0, @"Could not fetch dyld info");
+    plcrash_nasync_image_list_append(&_image_list, (pl_vm_address_t) info.dli_fbase, info.dli_fname);
+
+    _header = (uintptr_t) info.dli_fbase;
+    _cpu_type = ((const struct mach_header *) info.dli_fbase)->cputype;
+}
+
+- (void) tearDown {
+    plcrash_nasync_image_list_free(&_image_list);
+}
+
+/**
+ * Initialize @a frame with a stack pointer of @a sp and a frame pointer of @a fp.
+ */
+- (void) initFrame: (plframe_stackframe_t *) frame sp: (uintptr_t) sp fp: (uintptr_t) fp {
+    STAssertEquals(plcrash_async_thread_state_init(&frame->thread_state, _cpu_type), PLCRASH_ESUCCESS, @"Failed to initialize thread state");
+    plcrash_async_thread_state_set_reg(&frame->thread_state, PLCRASH_REG_SP, sp);
+    plcrash_async_thread_state_set_reg(&frame->thread_state, PLCRASH_REG_FP, fp);
+}
+
+- (void) testMissingWindow {
+    uintptr_t stack[4] = { 0 };
+    plframe_stackframe_t frame;
+    plframe_stackframe_t next;
+
+    [self initFrame: &frame sp: (uintptr_t) stack fp: (uintptr_t) stack];
+    STAssertEquals(plframe_cursor_read_stack_scan(mach_task_self(), &_image_list, NULL, NULL, &frame, NULL, &next), PLFRAME_ENOTSUP, @"Unexpected result for a missing stack window");
+}
+
+- (void) testTerminatedFrame {
+    uintptr_t stack[4] = { 0 };
+    plcrash_async_mobject_t window;
+    plframe_stackframe_t frame;
+    plframe_stackframe_t next;
+
+    STAssertEquals(plcrash_async_mobject_init(&window, mach_task_self(), (pl_vm_address_t) stack, sizeof(stack), true), PLCRASH_ESUCCESS, @"Failed to map stack");
+
+    [self initFrame: &frame sp: (uintptr_t) stack fp: 0];
+    STAssertEquals(plframe_cursor_read_stack_scan(mach_task_self(), &_image_list, NULL, &window, &frame, NULL, &next), PLFRAME_ENOFRAME, @"Expected a NULL frame pointer to terminate the scan");
+
+    plcrash_async_mobject_free(&window);
+}
+
+- (void) testScan {
+    uintptr_t retaddr = stack_scan_return_address();
+    plcrash_async_mobject_t window;
+    plframe_stackframe_t frame;
+    plframe_stackframe_t next;
+    
+    /* Populate a stack with non-text values, a TEXT address that does not follow a call, and a valid return address */
+    uintptr_t stack[16];
+    for (size_t i = 0; i < sizeof(stack) / sizeof(stack[0]); i++)
+        stack[i] = i;
+    stack[5] = _header;
+    stack[9] = retaddr;
+
+    STAssertEquals(plcrash_async_mobject_init(&window, mach_task_self(), (pl_vm_address_t) stack, sizeof(stack), true), PLCRASH_ESUCCESS, @"Failed to map stack");
+
+    [self initFrame: &frame sp: (uintptr_t) stack fp: (uintptr_t) stack];
+    STAssertEquals(plframe_cursor_read_stack_scan(mach_task_self(), &_image_list, NULL, &window, &frame, NULL, &next), PLFRAME_ESUCCESS, @"Failed to scan the stack");
+
+    STAssertEquals((uintptr_t) plcrash_async_thread_state_get_reg(&next.thread_state, PLCRASH_REG_IP), retaddr, @"Incorrect return address");
+    STAssertEquals((uintptr_t) plcrash_async_thread_state_get_reg(&next.thread_state, PLCRASH_REG_SP), (uintptr_t) &stack[10], @"Incorrect stack pointer");
+
+    /* Resuming the scan from the new frame should exhaust the stack */
+    STAssertEquals(plframe_cursor_read_stack_scan(mach_task_self(), &_image_list, NULL, &window, &next, &frame, &frame), PLFRAME_ENOFRAME, @"Expected the scan to be exhausted");
+
+    plcrash_async_mobject_free(&window);
+}
+
+@end
@@ -29,10 +29,15 @@
 #include "PLCrashFrameStackUnwind.h"
 #include "PLCrashAsync.h"
 
+#include <inttypes.h>
+
 /**
  * Fetch the next frame, assuming a valid frame pointer in @a cursor's current frame.
  *
  * @param task The task containing the target frame stack.
+ * @param image_list The list of images loaded in the target @a task.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the target thread's stack, or NULL.
  * @param current_frame The current stack frame.
  * @param previous_frame The previous stack frame, or NULL if this is the first frame.
  * @param next_frame The new frame to be initialized.
@@ -41,6 +46,8 @@
  */
 plframe_error_t plframe_cursor_read_frame_ptr (task_t task,
                                                plcrash_async_image_list_t *image_list,
+                                               plcrash_async_macho_section_cache_t *section_cache,
+                                               plcrash_async_mobject_t *stack_window,
                                                const plframe_stackframe_t *current_frame,
                                                const plframe_stackframe_t *previous_frame,
                                                plframe_stackframe_t *next_frame)
@@ -88,16 +95,21 @@ plframe_error_t plframe_cursor_read_frame_ptr (task_t task,
         }
     }
 
+    /* Reject frame pointers outside of the thread's stack without issuing a read against the target task */
+    const plframe_stack_bounds_t *bounds = &current_frame->stack_bounds;
+    if (bounds->valid && ((pl_vm_address_t) fp < bounds->low || (pl_vm_address_t) fp >= bounds->high || bounds->high - (pl_vm_address_t) fp < len)) {
+        PLCF_DEBUG("Frame pointer 0x%" PRIx64 " is outside of the thread stack, terminating stack walk", (uint64_t) fp);
+        return PLFRAME_EBADFRAME;
+    }
+
     /* Read the registers off the stack via the frame pointer */
     plcrash_greg_t new_fp;
     plcrash_greg_t new_pc;
-    kern_return_t kr;
-    
-
+    plcrash_error_t err;
 
-    kr = plcrash_async_read_addr(task, (pl_vm_address_t) fp, dest, len);
-    if (kr != KERN_SUCCESS) {
-        PLCF_DEBUG("Failed to read frame: %d", kr);
+    err = plcrash_async_mobject_task_memcpy(stack_window, task, (pl_vm_address_t) fp, 0, dest, len);
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to read frame: %d", err);
         return PLFRAME_EBADFRAME;
     }
 
@@ -37,6 +37,8 @@ extern "C" {
 
 plframe_error_t plframe_cursor_read_frame_ptr (task_t task,
                                                plcrash_async_image_list_t *image_list,
+                                               plcrash_async_macho_section_cache_t *section_cache,
+                                               plcrash_async_mobject_t *stack_window,
                                                const plframe_stackframe_t *current_frame,
                                                const plframe_stackframe_t *previous_frame,
                                                plframe_stackframe_t *next_frame);
@@ -83,7 +83,7 @@ struct stack_frame {
     /* Try walking the stack */
     plframe_stackframe_t new_frame;
     plframe_stackframe_t prev_frame;
-    plframe_stackframe_t frame = cursor.frame;
+    plframe_stackframe_t frame = *plframe_cursor_get_frame(&cursor);
     for (int i = 0; i < frame_count; i++) {
         if (i > 0) {
             plframe_stackframe_t *has_prev_frame = NULL;
@@ -91,7 +91,7 @@ struct stack_frame {
                 has_prev_frame = &prev_frame;
 
             /* Fetch the next frame */
-            STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, &frame, has_prev_frame, &new_frame), PLFRAME_ESUCCESS, @"Failed to read next frame");
+            STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, NULL, NULL, &frame, has_prev_frame, &new_frame), PLFRAME_ESUCCESS, @"Failed to read next frame");
             prev_frame = frame;
             frame = new_frame;
         }
@@ -103,7 +103,40 @@ struct stack_frame {
     }
 
     /* Ensure that the final frame's NULL fp triggers an ENOFRAME */
-    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, &frame, &prev_frame, &new_frame), PLFRAME_ENOFRAME, @"Expected to hit end of frames");
+    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, NULL, NULL, &frame, &prev_frame, &new_frame), PLFRAME_ENOFRAME, @"Expected to hit end of frames");
+}
+
+/**
+ * Verify that frame pointers outside of the thread's stack are rejected, even if the target memory is readable.
+ */
+- (void) testOutOfBoundsFrame {
+    /* Set up a (readable) test stack outside of the thread's stack */
+    struct stack_frame *frames = calloc(2, sizeof(struct stack_frame));
+    frames[0].fp = (uintptr_t) &frames[1];
+    frames[0].pc = 0x1;
+    frames[1].fp = 0x0;
+    frames[1].pc = 0x2;
+
+    /* Configure thread state */
+    plcrash_async_thread_state_t state;
+    plcrash_async_thread_state_mach_thread_init(&state, pl_mach_thread_self());
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_FP, frames[0].fp);
+    plcrash_async_thread_state_set_reg(&state, PLCRASH_REG_IP, frames[0].pc);
+
+    plframe_cursor_t cursor;
+    plframe_cursor_init(&cursor, mach_task_self(), &state, &_image_list);
+    STAssertTrue(plframe_cursor_get_frame(&cursor)->stack_bounds.valid, @"Stack bounds were not determined");
+
+    /* The heap-allocated frame must be rejected */
+    plframe_stackframe_t new_frame;
+    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, NULL, NULL, plframe_cursor_get_frame(&cursor), NULL, &new_frame), PLFRAME_EBADFRAME, @"Expected out-of-bounds frame to be rejected");
+
+    /* Without bounds, the frame is readable */
+    plframe_cursor_get_frame(&cursor)->stack_bounds.valid = false;
+    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, NULL, NULL, plframe_cursor_get_frame(&cursor), NULL, &new_frame), PLFRAME_ESUCCESS, @"Failed to read unbounded frame");
+
+    plframe_cursor_free(&cursor);
+    free(frames);
 }
 
 /**
@@ -131,7 +164,7 @@ struct stack_frame {
     /* Try walking the stack */
     plframe_stackframe_t new_frame;
     plframe_stackframe_t prev_frame;
-    plframe_stackframe_t frame = cursor.frame;
+    plframe_stackframe_t frame = *plframe_cursor_get_frame(&cursor);
     
     for (size_t i = 0; i < frame_count; i++) {
         if (i > 0) {
@@ -140,7 +173,7 @@ struct stack_frame {
                 has_prev_frame = &prev_frame;
             
             /* Fetch the next frame */
-            STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, &frame, has_prev_frame, &new_frame), PLFRAME_ESUCCESS, @"Failed to read next frame");
+            STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, NULL, NULL, &frame, has_prev_frame, &new_frame), PLFRAME_ESUCCESS, @"Failed to read next frame");
             prev_frame = frame;
             frame = new_frame;
         }
@@ -152,7 +185,7 @@ struct stack_frame {
     }
 
     /* Ensure that the final frame's bad fp triggers an EBADFRAME */
-    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, &frame, &prev_frame, &new_frame), PLFRAME_EBADFRAME, @"Expected to hit end of frames");
+    STAssertEquals(plframe_cursor_read_frame_ptr(cursor.task, &_image_list, NULL, NULL, &frame, &prev_frame, &new_frame), PLFRAME_EBADFRAME, @"Expected to hit end of frames");
 }
 
 @end
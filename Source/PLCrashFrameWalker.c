@@ -28,14 +28,49 @@
 
 #include "PLCrashFrameWalker.h"
 #include "PLCrashAsync.h"
+#include "PLCrashAsyncTrace.h"
 #include "PLCrashTestThread.h"
 
 #include "PLCrashFrameStackUnwind.h"
+#include "PLCrashFrameStackScan.h"
 #include "PLCrashFrameCompactUnwind.h"
 #include "PLCrashFrameDWARFUnwind.h"
+#include "PLCrashFrameSigtramp.h"
 
 #include "PLCrashFeatureConfig.h"
 
+#include <pthread.h>
+
+/** Reader pipeline for PLFRAME_CURSOR_PIPELINE_ACCURATE. */
+static plframe_cursor_frame_reader_t *plframe_cursor_accurate_readers[] = {
+    plframe_cursor_read_sigtramp,
+
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    plframe_cursor_read_compact_unwind,
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    plframe_cursor_read_dwarf_unwind,
+#endif
+
+    plframe_cursor_read_frame_ptr,
+
+#if PLCRASH_FEATURE_UNWIND_STACK_SCAN
+    plframe_cursor_read_stack_scan,
+#endif
+};
+
+/** Reader pipeline for PLFRAME_CURSOR_PIPELINE_FAST. */
+static plframe_cursor_frame_reader_t *plframe_cursor_fast_readers[] = {
+    plframe_cursor_read_sigtramp,
+
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    plframe_cursor_read_compact_unwind,
+#endif
+
+    plframe_cursor_read_frame_ptr,
+};
+
 #pragma mark Error Handling
 
 /**
@@ -116,12 +151,164 @@ void plframe_test_thread_stop (plcrash_test_thread_t *args) {
  * @param cursor Cursor record to be initialized.
  * @param task The task from which @a uap was derived. All memory will be mapped from this task.
  * @param image_list The task's current image list. This is a borrowed reference, and must remain valid for the lifetime of the cursor.
+ * @param retain_task If true, a send right to @a task will be retained for the lifetime of the cursor. This may only be
+ * false if @a task is mach_task_self(), the name of which remains valid for the lifetime of the process.
  */
-static void plframe_cursor_internal_init (plframe_cursor_t *cursor, task_t task, plcrash_async_image_list_t *image_list) {
+static void plframe_cursor_internal_init (plframe_cursor_t *cursor, task_t task, plcrash_async_image_list_t *image_list, bool retain_task) {
     cursor->depth = 0;
     cursor->task = task;
     cursor->image_list = image_list;
-    mach_port_mod_refs(mach_task_self(), cursor->task, MACH_PORT_RIGHT_SEND, 1);    
+    cursor->section_cache = NULL;
+    cursor->readers = plframe_cursor_pipeline_readers(PLFRAME_CURSOR_PIPELINE_ACCURATE, &cursor->reader_count);
+    memset(cursor->reader_memo, 0, sizeof(cursor->reader_memo));
+    cursor->reader_memo_next = 0;
+    cursor->frame_reader = NULL;
+    cursor->failed_reader_count = 0;
+    cursor->has_stack_window = false;
+    cursor->frame_index = 0;
+    cursor->prev_frame_index = 1;
+    plframe_cursor_get_frame(cursor)->stack_bounds.valid = false;
+    cursor->has_task_ref = retain_task;
+    if (retain_task)
+        mach_port_mod_refs(mach_task_self(), cursor->task, MACH_PORT_RIGHT_SEND, 1);
+}
+
+/**
+ * @internal
+ * Look up the VM region containing @a address in @a task, descending into submaps as required.
+ *
+ * @param task The target task.
+ * @param address The address to look up.
+ * @param region_base On success, the base address of the region.
+ * @param region_size On success, the size of the region.
+ * @param info On success, the region's information.
+ *
+ * @return Returns true if a region containing @a address was found, false otherwise.
+ */
+static bool plframe_cursor_find_region (task_t task, pl_vm_address_t address, pl_vm_address_t *region_base, pl_vm_size_t *region_size,
+                                        vm_region_submap_info_data_64_t *info)
+{
+    pl_vm_address_t base = address;
+    natural_t depth = 0;
+    kern_return_t kt;
+
+    while (true) {
+        mach_msg_type_number_t info_count = VM_REGION_SUBMAP_INFO_COUNT_64;
+#ifdef PL_HAVE_MACH_VM
+        pl_vm_size_t size = 0;
+        kt = mach_vm_region_recurse(task, &base, &size, &depth, (vm_region_recurse_info_t) info, &info_count);
+#else
+        vm_address_t vm_address = base;
+        vm_size_t size = 0;
+        kt = vm_region_recurse_64(task, &vm_address, &size, &depth, (vm_region_recurse_info_t) info, &info_count);
+        base = vm_address;
+#endif
+        if (kt != KERN_SUCCESS)
+            return false;
+
+        if (info->is_submap) {
+            depth++;
+            continue;
+        }
+
+        /* The lookup returns the first region at or above the requested address */
+        if (base > address || address - base >= size)
+            return false;
+
+        *region_base = base;
+        *region_size = size;
+        return true;
+    }
+}
+
+/**
+ * @internal
+ * Determine the bounds of the initial frame's thread stack from the readable VM region containing the initial stack
+ * pointer. On downward-growing stacks, contiguous regions above the stack pointer that share the same tag are also
+ * included, as the kernel may split a single stack allocation into multiple regions. If the bounds can not be
+ * determined -- eg, the stack pointer references a guard page after a stack overflow -- the frame's bounds are
+ * left unset, and stack reads will not be bounds checked.
+ *
+ * @param cursor A cursor with an initialized initial frame.
+ */
+static void plframe_cursor_find_stack_bounds (plframe_cursor_t *cursor) {
+    plframe_stackframe_t *frame = plframe_cursor_get_frame(cursor);
+    plframe_stack_bounds_t *bounds = &frame->stack_bounds;
+    bounds->valid = false;
+
+    if (!plcrash_async_thread_state_has_reg(&frame->thread_state, PLCRASH_REG_SP))
+        return;
+
+    pl_vm_address_t sp = (pl_vm_address_t) plcrash_async_thread_state_get_reg(&frame->thread_state, PLCRASH_REG_SP);
+    vm_region_submap_info_data_64_t info;
+    pl_vm_address_t base;
+    pl_vm_size_t size;
+
+    if (!plframe_cursor_find_region(cursor->task, sp, &base, &size, &info) || !(info.protection & VM_PROT_READ))
+        return;
+
+    pl_vm_address_t high = base + size;
+    unsigned int tag = info.user_tag;
+
+    if (plcrash_async_thread_state_get_stack_direction(&frame->thread_state) == PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN) {
+        for (size_t i = 1; i < PLFRAME_CURSOR_STACK_REGION_MAX; i++) {
+            pl_vm_address_t next_base;
+            pl_vm_size_t next_size;
+
+            if (!plframe_cursor_find_region(cursor->task, high, &next_base, &next_size, &info))
+                break;
+
+            if (next_base != high || info.user_tag != tag || !(info.protection & VM_PROT_READ))
+                break;
+
+            high = next_base + next_size;
+        }
+    }
+
+    bounds->low = base;
+    bounds->high = high;
+    bounds->valid = true;
+}
+
+/**
+ * @internal
+ * Map a window of the stack surrounding the initial frame's stack pointer, allowing the stack reads performed by the
+ * frame readers to be served from a single mapping, rather than requiring a separate read of the target task for each
+ * saved register. Failure to map the window is non-fatal; all reads will be performed directly against the task.
+ *
+ * @param cursor A cursor with an initialized initial frame.
+ */
+static void plframe_cursor_map_stack_window (plframe_cursor_t *cursor) {
+    plframe_stackframe_t *frame = plframe_cursor_get_frame(cursor);
+    if (!plcrash_async_thread_state_has_reg(&frame->thread_state, PLCRASH_REG_SP))
+        return;
+
+    pl_vm_address_t sp = (pl_vm_address_t) plcrash_async_thread_state_get_reg(&frame->thread_state, PLCRASH_REG_SP);
+    const plframe_stack_bounds_t *bounds = &frame->stack_bounds;
+    pl_vm_address_t base = sp;
+    pl_vm_size_t length = PLFRAME_CURSOR_STACK_WINDOW_SIZE;
+
+    /* Caller frames are found above the stack pointer on downward-growing stacks, and below it otherwise. If the
+     * stack's bounds are known, the window is clamped to the stack. */
+    if (plcrash_async_thread_state_get_stack_direction(&frame->thread_state) == PLCRASH_ASYNC_THREAD_STACK_DIRECTION_UP) {
+        if (bounds->valid) {
+            base = (sp - bounds->low > length) ? sp - length : bounds->low;
+            length = sp - base;
+        } else {
+            if (sp < PLFRAME_CURSOR_STACK_WINDOW_SIZE)
+                return;
+            base = sp - PLFRAME_CURSOR_STACK_WINDOW_SIZE;
+        }
+    } else if (bounds->valid && bounds->high - sp < length) {
+        length = bounds->high - sp;
+    }
+
+    if (length == 0)
+        return;
+
+    /* Short mappings are permitted; the window will simply be truncated at the end of the stack. */
+    if (plcrash_async_mobject_init(&cursor->stack_window, cursor->task, base, length, false) == PLCRASH_ESUCCESS)
+        cursor->has_stack_window = true;
 }
 
 /**
@@ -138,9 +325,66 @@ static void plframe_cursor_internal_init (plframe_cursor_t *cursor, task_t task,
  * fails.
  */
 plframe_error_t plframe_cursor_init (plframe_cursor_t *cursor, task_t task, plcrash_async_thread_state_t *thread_state, plcrash_async_image_list_t *image_list) {
-    plframe_cursor_internal_init(cursor, task, image_list);
+    plframe_cursor_internal_init(cursor, task, image_list, true);
+
+    plcrash_async_memcpy(&plframe_cursor_get_frame(cursor)->thread_state, thread_state, sizeof(plcrash_async_thread_state_t));
+    plframe_cursor_find_stack_bounds(cursor);
+    plframe_cursor_map_stack_window(cursor);
+
+    return PLFRAME_ESUCCESS;
+}
+
+/**
+ * Initialize the frame cursor to walk the calling thread's stack, using @a thread_state as acquired from the calling
+ * thread via plcrash_async_thread_state_current().
+ *
+ * As the stack belongs to the calling thread, and the frames above the initial stack pointer remain live for the
+ * duration of the walk, the stack's bounds are taken from the thread's pthread stack attributes and the stack window
+ * references the stack directly, rather than being derived from VM region lookups and a new mapping. This avoids all
+ * Mach traps during initialization, making the cursor suitable for frequent use on hot paths. If the initial stack
+ * pointer does not fall within the thread's pthread stack -- eg, the caller is running on an alternate signal stack --
+ * the bounds and window are determined as per plframe_cursor_init().
+ *
+ * @param cursor Cursor record to be initialized.
+ * @param thread_state The calling thread's state, as provided by plcrash_async_thread_state_current(). The cursor must
+ * be stepped and freed prior to the return of the plcrash_async_thread_state_current() callback.
+ * @param image_list The current task's image list. This is a borrowed reference, and must remain valid for the lifetime of the cursor.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, or standard plframe_error_t code if an error occurs.
+ *
+ * @warn Callers must call plframe_cursor_free() on @a cursor to free any associated resources, even if initialization
+ * fails.
+ */
+plframe_error_t plframe_cursor_current_thread_init (plframe_cursor_t *cursor, plcrash_async_thread_state_t *thread_state, plcrash_async_image_list_t *image_list) {
+    plframe_cursor_internal_init(cursor, mach_task_self(), image_list, false);
+
+    plframe_stackframe_t *frame = plframe_cursor_get_frame(cursor);
+    plcrash_async_memcpy(&frame->thread_state, thread_state, sizeof(plcrash_async_thread_state_t));
+
+    if (!plcrash_async_thread_state_has_reg(&frame->thread_state, PLCRASH_REG_SP))
+        return PLFRAME_ESUCCESS;
+
+    pthread_t self = pthread_self();
+    pl_vm_address_t high = (pl_vm_address_t) (uintptr_t) pthread_get_stackaddr_np(self);
+    pl_vm_size_t size = (pl_vm_size_t) pthread_get_stacksize_np(self);
+    pl_vm_address_t sp = (pl_vm_address_t) plcrash_async_thread_state_get_reg(&frame->thread_state, PLCRASH_REG_SP);
+
+    /* Darwin thread stacks grow downward from the reported stack address */
+    if (plcrash_async_thread_state_get_stack_direction(&frame->thread_state) != PLCRASH_ASYNC_THREAD_STACK_DIRECTION_DOWN ||
+        size > high || sp < high - size || sp >= high)
+    {
+        plframe_cursor_find_stack_bounds(cursor);
+        plframe_cursor_map_stack_window(cursor);
+        return PLFRAME_ESUCCESS;
+    }
+
+    frame->stack_bounds.low = high - size;
+    frame->stack_bounds.high = high;
+    frame->stack_bounds.valid = true;
 
-    plcrash_async_memcpy(&cursor->frame.thread_state, thread_state, sizeof(cursor->frame.thread_state));
+    /* The caller frames between the stack pointer and the top of the stack are live and may be read in place. */
+    plcrash_async_mobject_init_local(&cursor->stack_window, mach_task_self(), sp, (const void *) (uintptr_t) sp, high - sp);
+    cursor->has_stack_window = true;
 
     return PLFRAME_ESUCCESS;
 }
@@ -161,9 +405,137 @@ plframe_error_t plframe_cursor_init (plframe_cursor_t *cursor, task_t task, plcr
  */
 plframe_error_t plframe_cursor_thread_init (plframe_cursor_t *cursor, task_t task, thread_t thread, plcrash_async_image_list_t *image_list) {
     /* Standard initialization */
-    plframe_cursor_internal_init(cursor, task, image_list);
+    plframe_cursor_internal_init(cursor, task, image_list, true);
     
-    return plcrash_async_thread_state_mach_thread_init(&cursor->frame.thread_state, thread);
+    plcrash_error_t err = plcrash_async_thread_state_mach_thread_init(&plframe_cursor_get_frame(cursor)->thread_state, thread);
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    plframe_cursor_find_stack_bounds(cursor);
+    plframe_cursor_map_stack_window(cursor);
+    return PLFRAME_ESUCCESS;
+}
+
+/**
+ * Configure a section cache to be used when mapping unwind data. By default, no cache is used.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init();
+ * @param section_cache The section cache, or NULL. This is a borrowed reference, and must remain valid for the lifetime
+ * of the cursor. The cache may be shared between multiple cursors walking threads of the same task, but must not be used
+ * concurrently.
+ */
+void plframe_cursor_set_section_cache (plframe_cursor_t *cursor, plcrash_async_macho_section_cache_t *section_cache) {
+    cursor->section_cache = section_cache;
+}
+
+/**
+ * Select one of the predefined frame reader pipelines to be used by plframe_cursor_next(). By default,
+ * PLFRAME_CURSOR_PIPELINE_ACCURATE is used.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init();
+ * @param pipeline The reader pipeline.
+ */
+void plframe_cursor_set_pipeline (plframe_cursor_t *cursor, plframe_cursor_pipeline_t pipeline) {
+    cursor->readers = plframe_cursor_pipeline_readers(pipeline, &cursor->reader_count);
+}
+
+/**
+ * Configure a custom frame reader pipeline to be used by plframe_cursor_next(). Pipelines may be composed from the
+ * predefined pipelines returned by plframe_cursor_pipeline_readers().
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init();
+ * @param readers The frame readers, in the order in which they should be tried. This is a borrowed reference, and must
+ * remain valid for the lifetime of the cursor.
+ * @param reader_count The number of readers in @a readers.
+ */
+void plframe_cursor_set_readers (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count) {
+    cursor->readers = readers;
+    cursor->reader_count = reader_count;
+}
+
+/**
+ * Return the frame readers used by @a pipeline, in order.
+ *
+ * @param pipeline The predefined pipeline.
+ * @param reader_count On return, will be set to the number of readers in the returned array.
+ *
+ * @return Returns the pipeline's readers. The returned array is statically allocated, and must not be modified.
+ */
+plframe_cursor_frame_reader_t **plframe_cursor_pipeline_readers (plframe_cursor_pipeline_t pipeline, size_t *reader_count) {
+    switch (pipeline) {
+        case PLFRAME_CURSOR_PIPELINE_FAST:
+            *reader_count = sizeof(plframe_cursor_fast_readers) / sizeof(plframe_cursor_fast_readers[0]);
+            return plframe_cursor_fast_readers;
+
+        case PLFRAME_CURSOR_PIPELINE_ACCURATE:
+            break;
+    }
+
+    *reader_count = sizeof(plframe_cursor_accurate_readers) / sizeof(plframe_cursor_accurate_readers[0]);
+    return plframe_cursor_accurate_readers;
+}
+
+/**
+ * @internal
+ * Look up the image containing the current frame's IP, and return its reader memo entry, if any.
+ *
+ * @param cursor The cursor to search.
+ * @param image_base On return, the base address of the image containing the current IP, or 0 if no image was found.
+ *
+ * @return Returns the memo entry for the image, or NULL if no reader has been memoized for the image.
+ */
+static plframe_reader_memo_t *plframe_cursor_find_reader_memo (plframe_cursor_t *cursor, pl_vm_address_t *image_base) {
+    *image_base = 0;
+
+    if (cursor->image_list == NULL || !plcrash_async_thread_state_has_reg(&plframe_cursor_get_frame(cursor)->thread_state, PLCRASH_REG_IP))
+        return NULL;
+
+    pl_vm_address_t pc = (pl_vm_address_t) plcrash_async_thread_state_get_reg(&plframe_cursor_get_frame(cursor)->thread_state, PLCRASH_REG_IP);
+
+    plcrash_async_image_list_set_reading(cursor->image_list, true);
+    plcrash_async_image_t *image = plcrash_async_image_containing_address(cursor->image_list, pc);
+    if (image != NULL)
+        *image_base = image->macho_image.header_addr;
+    plcrash_async_image_list_set_reading(cursor->image_list, false);
+
+    if (*image_base == 0)
+        return NULL;
+
+    for (uint32_t i = 0; i < PLFRAME_CURSOR_READER_MEMO_COUNT; i++) {
+        if (cursor->reader_memo[i].image_base == *image_base)
+            return &cursor->reader_memo[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ * Record @a reader as the preferred reader for the image at @a image_base.
+ *
+ * @param cursor The cursor to update.
+ * @param memo The existing memo entry for the image, or NULL to allocate a new entry.
+ * @param image_base The base address of the image.
+ * @param reader The reader that successfully unwound a frame within the image.
+ */
+static void plframe_cursor_record_reader_memo (plframe_cursor_t *cursor, plframe_reader_memo_t *memo, pl_vm_address_t image_base, plframe_cursor_frame_reader_t *reader) {
+    /* Replace entries round-robin; stacks rarely span more images than the memo holds. */
+    if (memo == NULL) {
+        memo = &cursor->reader_memo[cursor->reader_memo_next];
+        cursor->reader_memo_next = (cursor->reader_memo_next + 1) % PLFRAME_CURSOR_READER_MEMO_COUNT;
+    }
+
+    memo->image_base = image_base;
+    memo->reader = reader;
+}
+
+/**
+ * @internal
+ * Record that @a reader failed to read the cursor's next frame.
+ */
+static void plframe_cursor_record_failed_reader (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *reader) {
+    if (cursor->failed_reader_count < PLFRAME_CURSOR_FAILED_READERS_MAX)
+        cursor->failed_readers[cursor->failed_reader_count++] = reader;
 }
 
 /**
@@ -171,10 +543,13 @@ plframe_error_t plframe_cursor_thread_init (plframe_cursor_t *cursor, task_t tas
  *
  * @param cursor A cursor instance initialized with plframe_cursor_init();
  * @param readers Frame readers to be used to fetch the next frame. Each reader will be executed in the provided order until a valid frame is read.
+ * If a reader (other than the final reader) previously succeeded for a frame within the same image, that reader is tried first.
  * @param reader_count The number of readers provided in @a readers.
  * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
  */
 plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count) {
+    cursor->failed_reader_count = 0;
+
     /* The first frame is already available via existing thread state. */
     if (cursor->depth == 0) {
         cursor->depth++;
@@ -182,18 +557,66 @@ plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plfr
     }
     
     /* A previous frame is only available if we're on the second frame */
+    plframe_stackframe_t *cur_frame = plframe_cursor_get_frame(cursor);
     plframe_stackframe_t *prev_frame = NULL;
     if (cursor->depth >= 2)
-        prev_frame = &cursor->prev_frame;
+        prev_frame = plframe_cursor_get_prev_frame(cursor);
     
-    /* Read in the next frame using the first successful frame reader. */
-    plframe_stackframe_t frame;
+    plcrash_async_mobject_t *stack_window = cursor->has_stack_window ? &cursor->stack_window : NULL;
+
+    /* Read in the next frame using the first successful frame reader. The frame is read directly into the slot
+     * that is held by neither the current nor the previous frame. */
+    uint8_t next_index = 3 - cursor->frame_index - cursor->prev_frame_index;
+    plframe_stackframe_t *frame = &cursor->frames[next_index];
     plframe_error_t ferr = PLFRAME_EINVAL; // default return value if reader_count is 0.
     
-    for (size_t i = 0; i < reader_count; i++) {
-        ferr = readers[i](cursor->task, cursor->image_list, &cursor->frame, prev_frame, &frame);
-        if (ferr == PLFRAME_ESUCCESS)
-            break;
+    pl_vm_address_t image_base = 0;
+    plframe_reader_memo_t *memo = plframe_cursor_find_reader_memo(cursor, &image_base);
+    plframe_cursor_frame_reader_t *memo_reader = NULL;
+    plframe_cursor_frame_reader_t *found_reader = NULL;
+    bool found = false;
+
+    /* Try the reader that last succeeded within this image first. It is only used if it is also in the supplied
+     * reader list. */
+    if (memo != NULL) {
+        for (size_t i = 0; i < reader_count; i++) {
+            if (readers[i] == memo->reader) {
+                memo_reader = memo->reader;
+                break;
+            }
+        }
+    }
+
+    if (memo_reader != NULL) {
+        ferr = memo_reader(cursor->task, cursor->image_list, cursor->section_cache, stack_window, cur_frame, prev_frame, frame);
+        if (ferr == PLFRAME_ESUCCESS) {
+            found_reader = memo_reader;
+            found = true;
+        } else {
+            plframe_cursor_record_failed_reader(cursor, memo_reader);
+        }
+    }
+
+    /* Fall back on the standard reader ordering */
+    for (size_t i = 0; !found && i < reader_count; i++) {
+        if (readers[i] == memo_reader)
+            continue;
+
+        ferr = readers[i](cursor->task, cursor->image_list, cursor->section_cache, stack_window, cur_frame, prev_frame, frame);
+        if (ferr != PLFRAME_ESUCCESS) {
+            plframe_cursor_record_failed_reader(cursor, readers[i]);
+            continue;
+        }
+
+        /* The final reader is the catch-all fallback (eg, frame pointer walking); memoizing it would cause the more
+         * precise readers to be skipped for the remainder of the image, so only earlier readers are recorded. The
+         * frame pointer and stack scan readers are always treated as fallbacks. The signal frame reader applies
+         * only to _sigtramp, and is never memoized for the remainder of its image. */
+        if (image_base != 0 && i + 1 < reader_count && readers[i] != plframe_cursor_read_frame_ptr && readers[i] != plframe_cursor_read_stack_scan &&
+            readers[i] != plframe_cursor_read_sigtramp)
+            plframe_cursor_record_reader_memo(cursor, memo, image_base, readers[i]);
+        found_reader = readers[i];
+        found = true;
     }
     
     if (ferr != PLFRAME_ESUCCESS) {
@@ -201,45 +624,36 @@ plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plfr
     }
 
     /* Check for completion */
-    if (!plcrash_async_thread_state_has_reg(&frame.thread_state, PLCRASH_REG_IP)) {
-        PLCF_DEBUG("Missing expected IP value in successfully read frame");
+    if (!plcrash_async_thread_state_has_reg(&frame->thread_state, PLCRASH_REG_IP)) {
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_DEBUG, PLCRASH_ASYNC_TRACE_EVENT_FRAME_MISSING_IP, cursor->depth, 0, 0);
         return PLFRAME_ENOFRAME;
     }
     
     /* A pc within the NULL page is a terminating frame */
-    plcrash_greg_t ip = plcrash_async_thread_state_get_reg(&frame.thread_state, PLCRASH_REG_IP);
+    plcrash_greg_t ip = plcrash_async_thread_state_get_reg(&frame->thread_state, PLCRASH_REG_IP);
     if (ip <= PAGE_SIZE)
         return PLFRAME_ENOFRAME;
     
-    /* Save the newly fetched frame */
-    cursor->prev_frame = cursor->frame;
-    cursor->frame = frame;
+    /* All frames share the initial frame's stack */
+    frame->stack_bounds = cur_frame->stack_bounds;
+
+    /* Rotate the newly fetched frame into place */
+    cursor->prev_frame_index = cursor->frame_index;
+    cursor->frame_index = next_index;
+    cursor->frame_reader = found_reader;
     cursor->depth++;
     
     return PLFRAME_ESUCCESS;
 }
 
 /**
- * Fetch the next frame.
+ * Fetch the next frame using the cursor's reader pipeline (see plframe_cursor_set_pipeline()).
  *
  * @param cursor A cursor instance initialized with plframe_cursor_init();
  * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
  */
 plframe_error_t plframe_cursor_next (plframe_cursor_t *cursor) {
-    plframe_cursor_frame_reader_t *readers[] = {
-
-#if PLCRASH_FEATURE_UNWIND_COMPACT
-        plframe_cursor_read_compact_unwind,
-#endif
-
-#if PLCRASH_FEATURE_UNWIND_DWARF
-        plframe_cursor_read_dwarf_unwind,
-#endif
-
-        plframe_cursor_read_frame_ptr
-    };
-
-    return plframe_cursor_next_with_readers(cursor, readers, sizeof(readers)/sizeof(readers[0]));
+    return plframe_cursor_next_with_readers(cursor, cursor->readers, cursor->reader_count);
 }
 
 
@@ -252,11 +666,11 @@ plframe_error_t plframe_cursor_next (plframe_cursor_t *cursor) {
  */
 plframe_error_t plframe_cursor_get_reg (plframe_cursor_t *cursor, plcrash_regnum_t regnum, plcrash_greg_t *reg) {
     /* Verify that the register is available */
-    if (!plcrash_async_thread_state_has_reg(&cursor->frame.thread_state, regnum))
+    if (!plcrash_async_thread_state_has_reg(&plframe_cursor_get_frame(cursor)->thread_state, regnum))
         return PLFRAME_ENOTSUP;
 
     /* Fetch from thread state */
-    *reg = plcrash_async_thread_state_get_reg(&cursor->frame.thread_state, regnum);
+    *reg = plcrash_async_thread_state_get_reg(&plframe_cursor_get_frame(cursor)->thread_state, regnum);
     return PLFRAME_ESUCCESS;
 }
 
@@ -267,7 +681,7 @@ plframe_error_t plframe_cursor_get_reg (plframe_cursor_t *cursor, plcrash_regnum
  * @param regnum The register number for which a name should be returned.
  */
 char const *plframe_cursor_get_regname (plframe_cursor_t *cursor, plcrash_regnum_t regnum) {
-    return plcrash_async_thread_state_get_reg_name(&cursor->frame.thread_state, regnum);
+    return plcrash_async_thread_state_get_reg_name(&plframe_cursor_get_frame(cursor)->thread_state, regnum);
 }
 
 /**
@@ -276,7 +690,7 @@ char const *plframe_cursor_get_regname (plframe_cursor_t *cursor, plcrash_regnum
  * @param cursor The target cursor.
  */
 size_t plframe_cursor_get_regcount (plframe_cursor_t *cursor) {
-    return plcrash_async_thread_state_get_reg_count(&cursor->frame.thread_state);
+    return plcrash_async_thread_state_get_reg_count(&plframe_cursor_get_frame(cursor)->thread_state);
 }
 
 /**
@@ -285,6 +699,11 @@ size_t plframe_cursor_get_regcount (plframe_cursor_t *cursor) {
  * @param cursor Cursor record to be freed
  */
 void plframe_cursor_free(plframe_cursor_t *cursor) {
-    if (cursor->task != MACH_PORT_NULL)
+    if (cursor->has_stack_window) {
+        plcrash_async_mobject_free(&cursor->stack_window);
+        cursor->has_stack_window = false;
+    }
+
+    if (cursor->has_task_ref && cursor->task != MACH_PORT_NULL)
         mach_port_mod_refs(mach_task_self(), cursor->task, MACH_PORT_RIGHT_SEND, -1);
 }
@@ -44,6 +44,7 @@ extern "C" {
 
 #include "PLCrashAsyncThread.h"
 #include "PLCrashAsyncImageList.h"
+#include "PLCrashAsyncMObject.h"
 
 /* Configure supported targets based on the host build architecture. There's currently
  * no deployed architecture on which simultaneous support for different processor families
@@ -54,7 +55,7 @@ extern "C" {
 #include <mach/i386/thread_state.h>
 #endif
 
-#if defined(__arm__)
+#if defined(__arm__) || defined(__arm64__)
 #define PLFRAME_ARM_SUPPORT 1
 #include <mach/arm/thread_state.h>
 #endif
@@ -111,6 +112,22 @@ typedef enum  {
     PLFRAME_EBADREG
 } plframe_error_t;
 
+/**
+ * @internal
+ *
+ * The address range of a thread's stack.
+ */
+typedef struct plframe_stack_bounds {
+    /** If false, the stack's bounds are unknown, and all other fields are undefined. */
+    bool valid;
+
+    /** The lowest address within the stack. */
+    pl_vm_address_t low;
+
+    /** The address immediately following the highest address within the stack. */
+    pl_vm_address_t high;
+} plframe_stack_bounds_t;
+
 /**
  * @internal
  *
@@ -119,8 +136,90 @@ typedef enum  {
 typedef struct plframe_stackframe {
     /** Thread state */
     plcrash_async_thread_state_t thread_state;
+
+    /** The bounds of the thread stack containing this frame. Frame readers may reject stack reads that fall outside
+     * of these bounds without issuing a read against the target task. This value is maintained by the frame cursor,
+     * and need not be populated by frame readers. */
+    plframe_stack_bounds_t stack_bounds;
 } plframe_stackframe_t;
 
+/**
+ * Fetch the caller's stack frame, based on the current state in @a current_frame and @a previous_frame.
+ *
+ * @param task The task containing the target frame stack.
+ * @param image_list The list of images loaded in the target @a task.
+ * @param section_cache The section cache to be used when mapping unwind data, or NULL.
+ * @param stack_window A pre-mapped window of the thread's stack from which stack reads should be served when possible
+ * (see plcrash_async_mobject_task_memcpy()), or NULL.
+ * @param current_frame The current stack frame.
+ * @param previous_frame The previous stack frame, or NULL if this is the first frame.
+ * @param next_frame The new frame to be initialized.
+ *
+ * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
+ */
+typedef plframe_error_t plframe_cursor_frame_reader_t (task_t task,
+                                                       plcrash_async_image_list_t *image_list,
+                                                       plcrash_async_macho_section_cache_t *section_cache,
+                                                       plcrash_async_mobject_t *stack_window,
+                                                       const plframe_stackframe_t *current_frame,
+                                                       const plframe_stackframe_t *previous_frame,
+                                                       plframe_stackframe_t *next_frame);
+
+/**
+ * @internal
+ * Predefined frame reader pipelines; see plframe_cursor_set_pipeline().
+ */
+typedef enum {
+    /**
+     * The signal frame, compact unwind, DWARF, frame pointer and stack scan readers are tried in order, subject to
+     * the enabled unwind features. This recovers the most frames, and is the default pipeline used to write crash reports.
+     */
+    PLFRAME_CURSOR_PIPELINE_ACCURATE = 0,
+
+    /**
+     * Only the signal frame, compact unwind and frame pointer readers are used. DWARF interpretation and stack scanning are
+     * skipped, bounding the cost of each frame; this is intended for stack sampling.
+     */
+    PLFRAME_CURSOR_PIPELINE_FAST = 1,
+} plframe_cursor_pipeline_t;
+
+/**
+ * @internal
+ * The number of per-image frame reader selections memoized by a plframe_cursor_t.
+ */
+#define PLFRAME_CURSOR_READER_MEMO_COUNT 8
+
+/**
+ * @internal
+ * The maximum number of failed frame readers recorded for a single plframe_cursor_next() call.
+ */
+#define PLFRAME_CURSOR_FAILED_READERS_MAX 8
+
+/**
+ * @internal
+ * The size of the stack window mapped from the initial stack pointer at cursor initialization. Stack reads
+ * that fall outside of the window are read directly from the target task.
+ */
+#define PLFRAME_CURSOR_STACK_WINDOW_SIZE (64 * 1024)
+
+/**
+ * @internal
+ * The maximum number of contiguous VM regions that will be coalesced when determining the bounds of a thread's stack.
+ */
+#define PLFRAME_CURSOR_STACK_REGION_MAX 4
+
+/**
+ * @internal
+ * A memoized frame reader selection for a single image.
+ */
+typedef struct plframe_reader_memo {
+    /** The base (header) address of the image, or 0 if this entry is unused. */
+    pl_vm_address_t image_base;
+
+    /** The frame reader that last successfully unwound a frame within the image. */
+    plframe_cursor_frame_reader_t *reader;
+} plframe_reader_memo_t;
+
 /**
  * @internal
  * Frame cursor context.
@@ -128,42 +227,77 @@ typedef struct plframe_stackframe {
 typedef struct plframe_cursor {
     /** The task in which the thread stack resides */
     task_t task;
+
+    /** If true, the cursor holds a send right to @a task that must be released by plframe_cursor_free(). */
+    bool has_task_ref;
     
     /** The task's current image list. This is a borrowed reference, and must remain valid for the lifetime of the cursor. */
     plcrash_async_image_list_t *image_list;
+
+    /** The section cache to be used when mapping unwind data, or NULL. This is a borrowed reference, and must remain valid
+     * for the lifetime of the cursor. */
+    plcrash_async_macho_section_cache_t *section_cache;
+
+    /** The frame readers used by plframe_cursor_next(), in order. This is a borrowed reference; see
+     * plframe_cursor_set_pipeline() and plframe_cursor_set_readers(). */
+    plframe_cursor_frame_reader_t **readers;
+
+    /** The number of readers in @a readers. */
+    size_t reader_count;
     
     /** The current frame depth. If the depth is 0, the cursor has not been stepped, and the remainder of this
      * structure should be considered uninitialized. */
     uint32_t depth;
     
-    /** The previous frame. This value is unitialized if no previous frame exists (eg, a depth of <= 1) */
-    plframe_stackframe_t prev_frame;
+    /** Frame slots. The current and previous frames occupy the slots at @a frame_index and @a prev_frame_index;
+     * the remaining slot receives the next frame, after which the indices are rotated. This avoids copying the
+     * (large) frame records on every step. Use plframe_cursor_get_frame() and plframe_cursor_get_prev_frame() to
+     * access the current and previous frames. */
+    plframe_stackframe_t frames[3];
+
+    /** The index of the current frame within @a frames. */
+    uint8_t frame_index;
+
+    /** The index of the previous frame within @a frames. The referenced frame is unitialized if no previous frame
+     * exists (eg, a depth of <= 1), but the index always differs from @a frame_index. */
+    uint8_t prev_frame_index;
+
+    /** Per-image memo of the frame reader that last succeeded within that image. Frames within a memoized image try
+     * the memoized reader first, avoiding repeated failed lookups in readers that do not apply to the image. */
+    plframe_reader_memo_t reader_memo[PLFRAME_CURSOR_READER_MEMO_COUNT];
 
-    /** The current stack frame data */
-    plframe_stackframe_t frame;
+    /** The next reader_memo entry to be replaced. */
+    uint32_t reader_memo_next;
+
+    /** The frame reader that produced the current frame, or NULL if the current frame is the initial frame, which is
+     * derived from the thread state rather than read from the stack. */
+    plframe_cursor_frame_reader_t *frame_reader;
+
+    /** The frame readers that were tried and failed during the most recent call to plframe_cursor_next(), in the
+     * order in which they were tried. This is populated whether or not a frame was ultimately read. Any failures
+     * beyond PLFRAME_CURSOR_FAILED_READERS_MAX are not recorded. */
+    plframe_cursor_frame_reader_t *failed_readers[PLFRAME_CURSOR_FAILED_READERS_MAX];
+
+    /** The number of valid entries in @a failed_readers. */
+    uint32_t failed_reader_count;
+
+    /** If true, @a stack_window is a valid mapping of the stack surrounding the initial frame's stack pointer. */
+    bool has_stack_window;
+
+    /** Mapping of the stack surrounding the initial frame's stack pointer. Only valid if @a has_stack_window is true. */
+    plcrash_async_mobject_t stack_window;
 } plframe_cursor_t;
 
-/**
- * Fetch the caller's stack frame, based on the current state in @a current_frame and @a previous_frame.
- *
- * @param task The task containing the target frame stack.
- * @param image_list The list of images loaded in the target @a task.
- * @param current_frame The current stack frame.
- * @param previous_frame The previous stack frame, or NULL if this is the first frame.
- * @param next_frame The new frame to be initialized.
- *
- * @return Returns PLFRAME_ESUCCESS on success, PLFRAME_ENOFRAME is no additional frames are available, or a standard plframe_error_t code if an error occurs.
- */
-typedef plframe_error_t plframe_cursor_frame_reader_t (task_t task,
-                                                       plcrash_async_image_list_t *image_list,
-                                                       const plframe_stackframe_t *current_frame,
-                                                       const plframe_stackframe_t *previous_frame,
-                                                       plframe_stackframe_t *next_frame);
 
 const char *plframe_strerror (plframe_error_t error);
 
 plframe_error_t plframe_cursor_init (plframe_cursor_t *cursor, task_t task, plcrash_async_thread_state_t *thread_state, plcrash_async_image_list_t *image_list);
+plframe_error_t plframe_cursor_current_thread_init (plframe_cursor_t *cursor, plcrash_async_thread_state_t *thread_state, plcrash_async_image_list_t *image_list);
 plframe_error_t plframe_cursor_thread_init (plframe_cursor_t *cursor, task_t task, thread_t thread, plcrash_async_image_list_t *image_list);
+void plframe_cursor_set_section_cache (plframe_cursor_t *cursor, plcrash_async_macho_section_cache_t *section_cache);
+void plframe_cursor_set_pipeline (plframe_cursor_t *cursor, plframe_cursor_pipeline_t pipeline);
+void plframe_cursor_set_readers (plframe_cursor_t *cursor, plframe_cursor_frame_reader_t *readers[], size_t reader_count);
+plframe_cursor_frame_reader_t **plframe_cursor_pipeline_readers (plframe_cursor_pipeline_t pipeline, size_t *reader_count);
 
 char const *plframe_cursor_get_regname (plframe_cursor_t *cursor, plcrash_regnum_t regnum);
 size_t plframe_cursor_get_regcount (plframe_cursor_t *cursor);
@@ -174,6 +308,27 @@ plframe_error_t plframe_cursor_next_with_readers (plframe_cursor_t *cursor, plfr
 
 void plframe_cursor_free(plframe_cursor_t *cursor);
 
+/**
+ * @internal
+ * Return the @a cursor's current frame.
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init();
+ */
+static inline plframe_stackframe_t *plframe_cursor_get_frame (plframe_cursor_t *cursor) {
+    return &cursor->frames[cursor->frame_index];
+}
+
+/**
+ * @internal
+ * Return the @a cursor's previous frame. The returned frame is uninitialized if no previous frame exists (eg,
+ * the cursor depth is <= 1).
+ *
+ * @param cursor A cursor instance initialized with plframe_cursor_init();
+ */
+static inline plframe_stackframe_t *plframe_cursor_get_prev_frame (plframe_cursor_t *cursor) {
+    return &cursor->frames[cursor->prev_frame_index];
+}
+
 /**
  * @} plcrash_framewalker
  */
@@ -35,6 +35,8 @@
 
 #import "unwind_test_harness.h"
 
+#import <dlfcn.h>
+
 @interface PLCrashFrameWalkerTests : SenTestCase {
 @private
     plcrash_test_thread_t _thr_args;
@@ -77,7 +79,11 @@
     plcrash_async_thread_state_mcontext_init(&thr_state, &mctx);
 
 #if defined(PLFRAME_ARM_SUPPORT)
-    STAssertTrue(memcmp(&thr_state.arm_state.thread, &mctx.__ss, sizeof(thr_state.arm_state.thread)) == 0, @"Incorrectly copied");
+#if defined(__arm64__)
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_64, &mctx.__ss, sizeof(thr_state.arm_state.thread.ts_64)) == 0, @"Incorrectly copied");
+#else
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_32, &mctx.__ss, sizeof(thr_state.arm_state.thread.ts_32)) == 0, @"Incorrectly copied");
+#endif
 
 #elif defined(PLFRAME_X86_SUPPORT) && defined(__LP64__)
     STAssertEquals(thr_state.x86_state.thread.tsh.count, (int)x86_THREAD_STATE64_COUNT, @"Incorrect thread state count for a 64-bit system");
@@ -115,11 +121,19 @@
 
     /* Test the results */
 #if defined(PLFRAME_ARM_SUPPORT)
-    arm_thread_state_t local_thr_state;
-    state_count = ARM_THREAD_STATE_COUNT;
+#if defined(__arm64__)
+    arm_thread_state64_t local_thr_state;
+    state_count = ARM_THREAD_STATE64_COUNT;
 
-    STAssertEquals(thread_get_state(thr, ARM_THREAD_STATE, (thread_state_t) &local_thr_state, &state_count), KERN_SUCCESS, @"Failed to fetch thread state");
-    STAssertTrue(memcmp(&thr_state.arm_state.thread, &local_thr_state, sizeof(thr_state.arm_state.thread)) == 0, @"Incorrectly copied");
+    STAssertEquals(thread_get_state(thr, ARM_THREAD_STATE64, (thread_state_t) &local_thr_state, &state_count), KERN_SUCCESS, @"Failed to fetch thread state");
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_64, &local_thr_state, sizeof(thr_state.arm_state.thread.ts_64)) == 0, @"Incorrectly copied");
+#else
+    arm_thread_state32_t local_thr_state;
+    state_count = ARM_THREAD_STATE32_COUNT;
+
+    STAssertEquals(thread_get_state(thr, ARM_THREAD_STATE32, (thread_state_t) &local_thr_state, &state_count), KERN_SUCCESS, @"Failed to fetch thread state");
+    STAssertTrue(memcmp(&thr_state.arm_state.thread.ts_32, &local_thr_state, sizeof(thr_state.arm_state.thread.ts_32)) == 0, @"Incorrectly copied");
+#endif
 
 #elif defined(PLFRAME_X86_SUPPORT) && defined(__LP64__)
     state_count = x86_THREAD_STATE64_COUNT;
@@ -176,9 +190,68 @@
     }
 }
 
+/* Verify that the cursor determines the bounds of the target thread's stack */
+- (void) testStackBounds {
+    plframe_cursor_t cursor;
+
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(_thr_args.thread), &_image_list), @"Initialization failed");
+
+    const plframe_stack_bounds_t *bounds = &plframe_cursor_get_frame(&cursor)->stack_bounds;
+    STAssertTrue(bounds->valid, @"Stack bounds were not determined");
+    if (!bounds->valid) {
+        plframe_cursor_free(&cursor);
+        return;
+    }
+
+    /* The stack pointer must fall within the bounds */
+    plcrash_greg_t sp;
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_get_reg(&cursor, PLCRASH_REG_SP, &sp), @"Could not fetch SP");
+    STAssertTrue((pl_vm_address_t) sp >= bounds->low && (pl_vm_address_t) sp < bounds->high, @"SP outside of stack bounds");
+
+    /* The stack's top (as reported by pthreads) must also fall within the bounds; stacks grow down on all supported
+     * architectures. */
+    pl_vm_address_t stack_top = (pl_vm_address_t) pthread_get_stackaddr_np(_thr_args.thread);
+    STAssertTrue(stack_top > bounds->low && stack_top <= bounds->high, @"Stack top outside of stack bounds");
+
+    /* Bounds must be propagated to subsequent frames */
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next(&cursor), @"Failed to fetch first frame");
+    if (plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+        STAssertTrue(plframe_cursor_get_frame(&cursor)->stack_bounds.valid, @"Stack bounds were not propagated");
+        STAssertEquals(plframe_cursor_get_frame(&cursor)->stack_bounds.low, plframe_cursor_get_prev_frame(&cursor)->stack_bounds.low, @"Incorrect stack bounds");
+        STAssertEquals(plframe_cursor_get_frame(&cursor)->stack_bounds.high, plframe_cursor_get_prev_frame(&cursor)->stack_bounds.high, @"Incorrect stack bounds");
+    }
+
+    plframe_cursor_free(&cursor);
+}
+
+/* Verify that stepping the cursor rotates the current frame into the previous frame slot */
+- (void) testFrameRotation {
+    plframe_cursor_t cursor;
+
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(_thr_args.thread), &_image_list), @"Initialization failed");
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next(&cursor), @"Failed to fetch first frame");
+
+    for (int depth = 2; depth < 6; depth++) {
+        plframe_stackframe_t *frame = plframe_cursor_get_frame(&cursor);
+        plcrash_greg_t pc;
+        STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc), @"Could not fetch PC");
+
+        if (plframe_cursor_next(&cursor) != PLFRAME_ESUCCESS)
+            break;
+
+        STAssertEquals(plframe_cursor_get_prev_frame(&cursor), frame, @"Current frame was not rotated into the previous slot");
+        STAssertTrue(plframe_cursor_get_frame(&cursor) != frame, @"New frame overwrote the previous frame");
+        STAssertEquals(plcrash_async_thread_state_get_reg(&plframe_cursor_get_prev_frame(&cursor)->thread_state, PLCRASH_REG_IP), pc, @"Previous frame was modified");
+    }
+
+    plframe_cursor_free(&cursor);
+}
+
 /* Test-only frame readers */
 static plframe_error_t null_ip_reader (task_t task,
                                        plcrash_async_image_list_t *image_list,
+                                       plcrash_async_macho_section_cache_t *section_cache,
+                                       plcrash_async_mobject_t *stack_window,
                                        const plframe_stackframe_t *current_frame,
                                        const plframe_stackframe_t *previous_frame,
                                        plframe_stackframe_t *next_frame)
@@ -190,6 +263,8 @@ static plframe_error_t null_ip_reader (task_t task,
 
 static plframe_error_t esuccess_reader (task_t task,
                                         plcrash_async_image_list_t *image_list,
+                                        plcrash_async_macho_section_cache_t *section_cache,
+                                        plcrash_async_mobject_t *stack_window,
                                         const plframe_stackframe_t *current_frame,
                                         const plframe_stackframe_t *previous_frame,
                                         plframe_stackframe_t *next_frame)
@@ -198,6 +273,99 @@ static plframe_error_t esuccess_reader (task_t task,
     return PLFRAME_ESUCCESS;
 }
 
+/* Call-counting frame readers, used to verify per-image reader memoization */
+static uint32_t counting_fail_calls = 0;
+static uint32_t counting_success_calls = 0;
+
+static plframe_error_t counting_fail_reader (task_t task,
+                                             plcrash_async_image_list_t *image_list,
+                                             plcrash_async_macho_section_cache_t *section_cache,
+                                             plcrash_async_mobject_t *stack_window,
+                                             const plframe_stackframe_t *current_frame,
+                                             const plframe_stackframe_t *previous_frame,
+                                             plframe_stackframe_t *next_frame)
+{
+    counting_fail_calls++;
+    return PLFRAME_ENOTSUP;
+}
+
+static plframe_error_t counting_success_reader (task_t task,
+                                                plcrash_async_image_list_t *image_list,
+                                                plcrash_async_macho_section_cache_t *section_cache,
+                                                plcrash_async_mobject_t *stack_window,
+                                                const plframe_stackframe_t *current_frame,
+                                                const plframe_stackframe_t *previous_frame,
+                                                plframe_stackframe_t *next_frame)
+{
+    counting_success_calls++;
+    plcrash_async_thread_state_copy(&next_frame->thread_state, &current_frame->thread_state);
+    return PLFRAME_ESUCCESS;
+}
+
+/**
+ * Verify that the reader that succeeds within an image is tried first for later frames within that image.
+ */
+- (void) testReaderMemo {
+    plframe_cursor_t cursor;
+
+    /* Register our own image, and point the cursor's IP at it */
+    Dl_info dli;
+    IMP localIMP = class_getMethodImplementation([self class], _cmd);
+    STAssertTrue(dladdr((void *)localIMP, &dli) != 0, @"Failed to look up image");
+    plcrash_nasync_image_list_append(&_image_list, (pl_vm_address_t) dli.dli_fbase, dli.dli_fname);
+
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(_thr_args.thread), &_image_list), @"Initialization failed");
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next(&cursor), @"Failed to fetch first frame");
+    plcrash_async_thread_state_set_reg(&plframe_cursor_get_frame(&cursor)->thread_state, PLCRASH_REG_IP, (plcrash_greg_t) localIMP);
+
+    plframe_cursor_frame_reader_t *readers[] = { counting_fail_reader, counting_success_reader, esuccess_reader };
+    counting_fail_calls = 0;
+    counting_success_calls = 0;
+
+    /* The first step must try the readers in order */
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next_with_readers(&cursor, readers, sizeof(readers) / sizeof(readers[0])), @"Failed to step");
+    STAssertEquals(counting_fail_calls, (uint32_t)1, @"Failing reader was not tried");
+    STAssertEquals(counting_success_calls, (uint32_t)1, @"Succeeding reader was not tried");
+
+    /* Later steps within the same image should go directly to the memoized reader */
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next_with_readers(&cursor, readers, sizeof(readers) / sizeof(readers[0])), @"Failed to step");
+    STAssertEquals(counting_fail_calls, (uint32_t)1, @"Memoized reader was not used");
+    STAssertEquals(counting_success_calls, (uint32_t)2, @"Memoized reader was not used");
+
+    plframe_cursor_free(&cursor);
+}
+
+/**
+ * Verify reader pipeline selection and composition.
+ */
+- (void) testPipelines {
+    plframe_cursor_t cursor;
+    size_t accurate_count;
+    size_t fast_count;
+
+    plframe_cursor_frame_reader_t **accurate = plframe_cursor_pipeline_readers(PLFRAME_CURSOR_PIPELINE_ACCURATE, &accurate_count);
+    plframe_cursor_frame_reader_t **fast = plframe_cursor_pipeline_readers(PLFRAME_CURSOR_PIPELINE_FAST, &fast_count);
+    STAssertTrue(fast_count > 0, @"Fast pipeline is empty");
+    STAssertTrue(accurate_count >= fast_count, @"Fast pipeline should not contain more readers than the accurate pipeline");
+
+    /* The accurate pipeline is the default */
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_thread_init(&cursor, mach_task_self(), pthread_mach_thread_np(_thr_args.thread), &_image_list), @"Initialization failed");
+    STAssertEquals(cursor.readers, accurate, @"Unexpected default pipeline");
+    STAssertEquals(cursor.reader_count, accurate_count, @"Unexpected default pipeline");
+
+    plframe_cursor_set_pipeline(&cursor, PLFRAME_CURSOR_PIPELINE_FAST);
+    STAssertEquals(cursor.readers, fast, @"Pipeline was not selected");
+    STAssertEquals(cursor.reader_count, fast_count, @"Pipeline was not selected");
+
+    /* Custom pipelines are used by plframe_cursor_next() */
+    STAssertEquals(PLFRAME_ESUCCESS, plframe_cursor_next(&cursor), @"Failed to fetch first frame");
+
+    plframe_cursor_frame_reader_t *readers[] = { null_ip_reader, esuccess_reader };
+    plframe_cursor_set_readers(&cursor, readers, sizeof(readers) / sizeof(readers[0]));
+    STAssertEquals(PLFRAME_ENOFRAME, plframe_cursor_next(&cursor), @"Custom pipeline was not used");
+
+    plframe_cursor_free(&cursor);
+}
 
 /**
  * Test handling of IPs within the NULL page.
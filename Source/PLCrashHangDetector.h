@@ -0,0 +1,146 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import <Foundation/Foundation.h>
+#import <CoreFoundation/CoreFoundation.h>
+
+#import <pthread.h>
+#import <mach/mach.h>
+
+#import "PLCrashReporter.h"
+#import "PLCrashLogWriter.h"
+#import "PLCrashSamplingProfiler.h"
+
+/**
+ * @internal
+ * The maximum number of stack samples recorded for a single hang. Once reached, later samples are discarded; the
+ * earliest samples are retained, as they are the most likely to capture the hang's cause.
+ */
+#define PLCRASH_HANG_DETECTOR_MAX_SAMPLES 32
+
+/**
+ * @internal
+ * The minimum interval between watchdog wakeups, in seconds.
+ */
+#define PLCRASH_HANG_DETECTOR_MIN_INTERVAL 0.01
+
+/**
+ * @internal
+ * The CPU budget for hang stack sampling, in parts per million of a single core. Samples are skipped as required to
+ * remain within the budget, which is reduced under thermal pressure or in low power mode.
+ */
+#define PLCRASH_HANG_DETECTOR_SAMPLING_BUDGET_PPM 5000
+
+/**
+ * @internal
+ * The maximum interval between hang stack samples, in seconds.
+ */
+#define PLCRASH_HANG_DETECTOR_MAX_SAMPLE_INTERVAL 1.0
+
+@interface PLCrashHangDetector : NSObject {
+@private
+    /** The reporter used to sample the target thread and generate hang reports. Not retained; the reporter owns,
+     * and must stop, the detector. */
+    PLCrashReporter *_reporter;
+
+    /** The monitored thread. */
+    thread_t _thread;
+
+    /** The monitored thread's run loop. */
+    CFRunLoopRef _runLoop;
+
+    /** The run loop activity observer. */
+    CFRunLoopObserverRef _observer;
+
+    /** The length of time for which a run loop pass must run before it is considered a hang, in mach_absolute_time()
+     * units. */
+    uint64_t _threshold;
+
+    /** The length of time after which a hang is escalated to a full report, in mach_absolute_time() units. */
+    uint64_t _reportThreshold;
+
+    /** The watchdog wakeup interval. */
+    NSTimeInterval _interval;
+
+    /** Timebase used to convert mach_absolute_time() values. */
+    mach_timebase_info_data_t _timebase;
+
+    /** Incremented by the run loop observer at the start of each run loop pass. */
+    volatile uint32_t _generation;
+
+    /** Set by the run loop observer while the run loop is waiting for events. */
+    volatile bool _idle;
+
+    /** Samples recorded for the current hang. */
+    plcrash_log_writer_hang_sample_t *_samples;
+
+    /** The number of valid entries in @a _samples. */
+    size_t _sampleCount;
+
+    /** Rate controller for hang stack samples. Only accessed by the watchdog thread. */
+    plcrash_sampling_budget_t _sampleBudget;
+
+    /** The thermal pressure monitor. Only accessed by the watchdog thread. */
+    plcrash_sampling_thermal_monitor_t _thermal;
+
+    /** The time at which the last hang sample was started, in mach_absolute_time() units. */
+    uint64_t _lastSampleTime;
+
+    /** The watchdog thread. */
+    pthread_t _watchdog;
+
+    /** Lock and condition used to wake the watchdog thread when stopping. */
+    pthread_mutex_t _lock;
+    pthread_cond_t _cond;
+
+    /** YES if the watchdog thread is running. */
+    BOOL _running;
+
+    /** Set to request that the watchdog thread exit. Protected by @a _lock. */
+    BOOL _stop;
+}
+
+- (id) initWithReporter: (PLCrashReporter *) reporter
+                 thread: (thread_t) thread
+                runLoop: (CFRunLoopRef) runLoop
+              threshold: (NSTimeInterval) threshold
+        reportThreshold: (NSTimeInterval) reportThreshold;
+
+- (BOOL) startAndReturnError: (NSError **) outError;
+- (void) stop;
+
+@end
+
+/**
+ * @internal
+ * Reporter methods used by the hang detector.
+ */
+@interface PLCrashReporter (HangDetection)
+- (NSData *) generateLiveReportWithThread: (thread_t) thread hang: (const plcrash_log_writer_hang_info_t *) hang error: (NSError **) outError;
+- (BOOL) queueReportData: (NSData *) data error: (NSError **) outError;
+- (void) recordHangState: (BOOL) hung;
+@end
@@ -0,0 +1,373 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashHangDetector.h"
+#import "PLCrashReporterNSError.h"
+
+#import <mach/mach_time.h>
+#import <sys/time.h>
+
+static void *plcrash_hang_detector_thread (void *arg);
+static void plcrash_hang_detector_observe (CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info);
+
+/**
+ * @internal
+ *
+ * Monitors a thread's run loop for hangs.
+ *
+ * A run loop observer marks the start of each run loop pass, at a cost of two stores per pass. A
+ * watchdog thread wakes periodically; if it finds that the same pass has been running for longer than the hang
+ * threshold, it captures a lightweight stack sample of the monitored thread on each wakeup for as long as the hang
+ * persists. If the hang persists beyond the report threshold, a live report -- including the samples recorded so far
+ * -- is generated and queued for submission. At most one report is generated per hang.
+ *
+ * Hang durations are measured from the first watchdog wakeup at which the pass was observed, and so have a
+ * resolution of the watchdog interval (half of the hang threshold).
+ *
+ * The cost of each stack sample is measured, and samples are skipped as required to keep sampling within
+ * PLCRASH_HANG_DETECTOR_SAMPLING_BUDGET_PPM of a single core; the budget is reduced while the device is under thermal
+ * pressure or in low power mode.
+ */
+@implementation PLCrashHangDetector
+
+/**
+ * Initialize a new detector. The detector will not monitor @a runLoop until started.
+ *
+ * @param reporter The reporter used to sample the monitored thread and generate hang reports. The reporter is not
+ * retained, and must stop the detector prior to being deallocated.
+ * @param thread The thread to be monitored.
+ * @param runLoop The monitored thread's run loop.
+ * @param threshold The length of time for which a run loop pass must run before it is considered a hang.
+ * @param reportThreshold The length of time after which a hang is escalated to a full live report. Must be greater than
+ * or equal to @a threshold.
+ */
+- (id) initWithReporter: (PLCrashReporter *) reporter
+                 thread: (thread_t) thread
+                runLoop: (CFRunLoopRef) runLoop
+              threshold: (NSTimeInterval) threshold
+        reportThreshold: (NSTimeInterval) reportThreshold
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _samples = calloc(PLCRASH_HANG_DETECTOR_MAX_SAMPLES, sizeof(_samples[0]));
+    if (_samples == NULL || mach_timebase_info(&_timebase) != KERN_SUCCESS) {
+        [self release];
+        return nil;
+    }
+
+    _reporter = reporter;
+    _thread = thread;
+    _runLoop = (CFRunLoopRef) CFRetain(runLoop);
+
+    /* Convert the thresholds to mach_absolute_time() units */
+    _threshold = (uint64_t) (threshold * NSEC_PER_SEC) * _timebase.denom / _timebase.numer;
+    _reportThreshold = (uint64_t) (reportThreshold * NSEC_PER_SEC) * _timebase.denom / _timebase.numer;
+
+    _interval = threshold / 2.0;
+    if (_interval < PLCRASH_HANG_DETECTOR_MIN_INTERVAL)
+        _interval = PLCRASH_HANG_DETECTOR_MIN_INTERVAL;
+
+    plcrash_sampling_budget_init(&_sampleBudget, PLCRASH_HANG_DETECTOR_SAMPLING_BUDGET_PPM, (uint32_t) (_interval * USEC_PER_SEC),
+                                 (uint32_t) (PLCRASH_HANG_DETECTOR_MAX_SAMPLE_INTERVAL * USEC_PER_SEC));
+
+    _idle = true;
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_cond, NULL);
+
+    return self;
+}
+
+- (void) dealloc {
+    [self stop];
+
+    if (_runLoop != NULL) {
+        CFRelease(_runLoop);
+        pthread_mutex_destroy(&_lock);
+        pthread_cond_destroy(&_cond);
+    }
+
+    free(_samples);
+    [super dealloc];
+}
+
+/**
+ * Install the run loop observer and start the watchdog thread.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the detector could not be started. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the detector could not be started.
+ */
+- (BOOL) startAndReturnError: (NSError **) outError {
+    if (_running) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"The hang detector is already running", nil);
+        return NO;
+    }
+
+    CFRunLoopObserverContext context = { 0, self, NULL, NULL, NULL };
+    CFOptionFlags activities = kCFRunLoopEntry | kCFRunLoopBeforeTimers | kCFRunLoopBeforeSources | kCFRunLoopAfterWaiting |
+                               kCFRunLoopBeforeWaiting | kCFRunLoopExit;
+
+    _observer = CFRunLoopObserverCreate(NULL, activities, true, 0, plcrash_hang_detector_observe, &context);
+    if (_observer == NULL) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Could not create the hang detector's run loop observer", nil);
+        return NO;
+    }
+    CFRunLoopAddObserver(_runLoop, _observer, kCFRunLoopCommonModes);
+
+    _stop = NO;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    int ret = pthread_create(&_watchdog, &attr, plcrash_hang_detector_thread, self);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        plcrash_populate_posix_error(outError, ret, @"Could not start the hang detector's watchdog thread");
+        CFRunLoopRemoveObserver(_runLoop, _observer, kCFRunLoopCommonModes);
+        CFRelease(_observer);
+        _observer = NULL;
+        return NO;
+    }
+
+    _running = YES;
+    return YES;
+}
+
+/**
+ * Stop the watchdog thread and remove the run loop observer. If a hang report is being generated, this method will
+ * block until it is complete. If the detector is not running, this method is a no-op.
+ */
+- (void) stop {
+    if (!_running)
+        return;
+
+    pthread_mutex_lock(&_lock);
+    _stop = YES;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_lock);
+
+    pthread_join(_watchdog, NULL);
+    _running = NO;
+
+    CFRunLoopObserverInvalidate(_observer);
+    CFRelease(_observer);
+    _observer = NULL;
+}
+
+/**
+ * Convert a mach_absolute_time() interval to milliseconds.
+ */
+- (uint64_t) millisecondsFromAbsoluteTime: (uint64_t) value {
+    return (value * _timebase.numer / _timebase.denom) / NSEC_PER_MSEC;
+}
+
+/**
+ * Convert a mach_absolute_time() interval to microseconds.
+ */
+- (uint64_t) microsecondsFromAbsoluteTime: (uint64_t) value {
+    return (value * _timebase.numer / _timebase.denom) / NSEC_PER_USEC;
+}
+
+/**
+ * Wait for the watchdog interval to elapse.
+ *
+ * @return Returns NO if the detector has been stopped, YES otherwise.
+ */
+- (BOOL) waitForInterval {
+    struct timeval now;
+    struct timespec deadline;
+    gettimeofday(&now, NULL);
+
+    uint64_t nsec = (uint64_t) now.tv_usec * NSEC_PER_USEC + (uint64_t) (_interval * NSEC_PER_SEC);
+    deadline.tv_sec = now.tv_sec + (time_t) (nsec / NSEC_PER_SEC);
+    deadline.tv_nsec = (long) (nsec % NSEC_PER_SEC);
+
+    BOOL running;
+    pthread_mutex_lock(&_lock);
+    if (!_stop)
+        pthread_cond_timedwait(&_cond, &_lock, &deadline);
+    running = !_stop;
+    pthread_mutex_unlock(&_lock);
+
+    return running;
+}
+
+/**
+ * Update the sampling budget's constraint from the device's thermal pressure level and low power mode.
+ */
+- (void) updateSamplingConstraint {
+    BOOL constrained = plcrash_sampling_thermal_monitor_pressured(&_thermal);
+
+    /* Low power mode is only available on iOS 9 and later */
+    NSProcessInfo *info = [NSProcessInfo processInfo];
+    if (!constrained && [info respondsToSelector: NSSelectorFromString(@"isLowPowerModeEnabled")])
+        constrained = [[info valueForKey: @"lowPowerModeEnabled"] boolValue];
+
+    plcrash_sampling_budget_set_constrained(&_sampleBudget, constrained);
+}
+
+/**
+ * Record a stack sample of the monitored thread, unless the sampling budget requires that the sample be skipped. The
+ * first sample of a hang is always recorded.
+ *
+ * @param offset The time elapsed since the start of the hang, in mach_absolute_time() units.
+ */
+- (void) recordSampleAtOffset: (uint64_t) offset {
+    if (_sampleCount >= PLCRASH_HANG_DETECTOR_MAX_SAMPLES)
+        return;
+
+    uint64_t start = mach_absolute_time();
+    if (_sampleCount > 0 && [self microsecondsFromAbsoluteTime: start - _lastSampleTime] < _sampleBudget.interval_usec)
+        return;
+
+    plcrash_log_writer_hang_sample_t *sample = &_samples[_sampleCount];
+    NSUInteger count = 0;
+
+    BOOL sampled = [_reporter sampleStackForThread: _thread pcs: sample->pcs maxCount: PLCRASH_LOG_WRITER_HANG_MAX_FRAMES count: &count error: NULL];
+
+    /* Account for the sample's cost (thread suspension, stack walk and recording), successful or not */
+    uint64_t cost = mach_absolute_time() - start;
+    plcrash_sampling_budget_record(&_sampleBudget, cost * _timebase.numer / _timebase.denom);
+    _lastSampleTime = start;
+
+    if (!sampled)
+        return;
+
+    sample->offset = [self millisecondsFromAbsoluteTime: offset];
+    sample->frame_count = (uint32_t) count;
+    _sampleCount++;
+}
+
+/**
+ * Generate and queue a hang report.
+ *
+ * @param duration The hang's duration, in mach_absolute_time() units.
+ */
+- (void) reportHangWithDuration: (uint64_t) duration {
+    plcrash_log_writer_hang_info_t hang;
+    hang.duration = [self millisecondsFromAbsoluteTime: duration];
+    hang.samples = _samples;
+    hang.sample_count = _sampleCount;
+
+    NSError *error;
+    NSData *data = [_reporter generateLiveReportWithThread: _thread hang: &hang error: &error];
+    if (data == nil) {
+        NSLog(@"Could not generate hang report: %@", error);
+        return;
+    }
+
+    if (![_reporter queueReportData: data error: &error])
+        NSLog(@"Could not queue hang report: %@", error);
+}
+
+/**
+ * The watchdog thread's run loop.
+ */
+- (void) runWatchdog {
+    uint32_t generation = 0;
+    uint64_t pass_start = 0;
+    BOOL reported = NO;
+    BOOL hung = NO;
+
+    plcrash_sampling_thermal_monitor_init(&_thermal);
+
+    while ([self waitForInterval]) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        uint64_t now = mach_absolute_time();
+
+        OSMemoryBarrier();
+        bool idle = _idle;
+        uint32_t current = _generation;
+
+        /* A new pass (or an idle run loop) resets the hang state */
+        if (idle || current != generation || pass_start == 0) {
+            generation = current;
+            pass_start = now;
+            reported = NO;
+            _sampleCount = 0;
+
+            /* The hang, if any, has ended */
+            if (hung) {
+                [_reporter recordHangState: NO];
+                hung = NO;
+            }
+
+            [pool release];
+            continue;
+        }
+
+        uint64_t elapsed = now - pass_start;
+        if (elapsed >= _threshold) {
+            /* Record the hang in the app state journal, allowing a watchdog termination to be identified on the
+             * next launch */
+            if (!hung) {
+                [_reporter recordHangState: YES];
+                [self updateSamplingConstraint];
+                hung = YES;
+            }
+
+            [self recordSampleAtOffset: elapsed];
+
+            if (!reported && elapsed >= _reportThreshold) {
+                [self reportHangWithDuration: elapsed];
+                reported = YES;
+            }
+        }
+
+        [pool release];
+    }
+
+    /* A hang can not outlive the detector */
+    if (hung)
+        [_reporter recordHangState: NO];
+
+    plcrash_sampling_thermal_monitor_free(&_thermal);
+}
+
+/* pthread entry point for the watchdog thread */
+static void *plcrash_hang_detector_thread (void *arg) {
+    PLCrashHangDetector *detector = arg;
+    [detector runWatchdog];
+    return NULL;
+}
+
+/* CFRunLoopObserver callback; records the run loop activity on the monitored thread. */
+static void plcrash_hang_detector_observe (CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info) {
+    PLCrashHangDetector *detector = info;
+
+    if (activity == kCFRunLoopBeforeWaiting || activity == kCFRunLoopExit) {
+        detector->_idle = true;
+    } else {
+        detector->_generation++;
+        detector->_idle = false;
+    }
+}
+
+@end
@@ -38,11 +38,20 @@ extern "C" {
 
 #import "PLCrashAsync.h"
 #import "PLCrashAsyncImageList.h"
+#import "PLCrashAsyncAllocator.h"
+#import "PLCrashAsyncMemoryProvider.h"
+#import "PLCrashAsyncBreadcrumbBuffer.h"
+#import "PLCrashAsyncUserRegions.h"
+#import "PLCrashAsyncTrace.h"
+#import "PLCrashAsyncWorkBudget.h"
+#import "PLCrashAsyncVMSummary.h"
+#import "PLCrashAsyncAppState.h"
 #import "PLCrashFrameWalker.h"
     
 #import "PLCrashAsyncSymbolication.h"
 
 #include <uuid/uuid.h>
+#include <mach/mach_time.h>
 
 /**
  * @internal
@@ -63,13 +72,145 @@ extern "C" {
 typedef struct user_info_t {
     /** Key name. */
     char *key;
+    /** The length of @a key, in bytes. */
+    size_t key_length;
     /** For @a NSCoding-complaint objects, the output of @ NSKeyedArchiver. For
         other objects, the result of calling @a description. */
     char *serialized;
+    /** The length of @a serialized, in bytes. */
+    size_t serialized_length;
     /** If true, serialized contains @a NSKeyedArchiver output. */
     BOOL archive;
 } user_info_t;
 
+/**
+ * @internal
+ * The maximum number of frames recorded in a single hang sample.
+ */
+#define PLCRASH_LOG_WRITER_HANG_MAX_FRAMES 64
+
+/**
+ * @internal
+ *
+ * A stack sample of a hung thread.
+ */
+typedef struct plcrash_log_writer_hang_sample {
+    /** The time at which the sample was taken, relative to the start of the hang, in milliseconds. */
+    uint64_t offset;
+
+    /** The number of valid entries in @a pcs. */
+    uint32_t frame_count;
+
+    /** The sampled PC values, ordered from the innermost frame outward. */
+    uint64_t pcs[PLCRASH_LOG_WRITER_HANG_MAX_FRAMES];
+} plcrash_log_writer_hang_sample_t;
+
+/**
+ * @internal
+ *
+ * Hang details to be written to a report; see plcrash_log_writer_set_hang().
+ */
+typedef struct plcrash_log_writer_hang_info {
+    /** The length of time for which the thread had been unresponsive, in milliseconds. */
+    uint64_t duration;
+
+    /** Stack samples taken during the hang, oldest first. */
+    const plcrash_log_writer_hang_sample_t *samples;
+
+    /** The number of entries in @a samples. */
+    size_t sample_count;
+} plcrash_log_writer_hang_info_t;
+
+/**
+ * @internal
+ *
+ * Termination details to be written to a report synthesized for a previous session; see
+ * plcrash_log_writer_set_termination().
+ */
+typedef struct plcrash_log_writer_termination_info {
+    /** The inferred cause of the termination. Must not be PLCRASH_ASYNC_APP_STATE_TERMINATION_NONE. */
+    plcrash_async_app_state_termination_t reason;
+
+    /** The terminated session's app state journal record. */
+    const plcrash_async_app_state_record_t *session;
+} plcrash_log_writer_termination_info_t;
+
+/**
+ * @internal
+ *
+ * Binary image output options; see plcrash_log_writer_set_image_options().
+ */
+typedef enum {
+    /** Write all loaded binary images. */
+    PLCRASH_LOG_WRITER_IMAGES_ALL = 0,
+
+    /** Omit binary images loaded from the dyld shared cache, writing the shared cache's UUID and slide in their
+     * place. The omitted images may be reconstructed from the matching on-disk shared cache. */
+    PLCRASH_LOG_WRITER_IMAGES_ELIDE_SHARED_CACHE = 1 << 0,
+
+    /** Only write binary images referenced by a captured frame, the uncaught exception's callstack, or a register
+     * value of the crashed thread. */
+    PLCRASH_LOG_WRITER_IMAGES_REFERENCED_ONLY = 1 << 1,
+} plcrash_log_writer_image_options_t;
+
+/**
+ * @internal
+ *
+ * Thread capture order; see plcrash_log_writer_capture_policy_t.
+ */
+typedef enum {
+    /** Capture threads in the order returned by task_threads(). */
+    PLCRASH_LOG_WRITER_THREAD_ORDER_KERNEL = 0,
+
+    /** Capture the crashed thread first, followed by the main thread, followed by all remaining threads in
+     * task_threads() order. */
+    PLCRASH_LOG_WRITER_THREAD_ORDER_CRASHED_FIRST = 1,
+} plcrash_log_writer_thread_order_t;
+
+/**
+ * @internal
+ *
+ * Thread capture policy; see plcrash_log_writer_set_capture_policy().
+ */
+typedef struct plcrash_log_writer_capture_policy {
+    /** The order in which threads are captured and written. */
+    plcrash_log_writer_thread_order_t thread_order;
+
+    /** The maximum number of frames to be captured for each non-crashed thread, or 0 for no additional limit. */
+    uint32_t max_thread_frames;
+
+    /** The number of frames at the bottom (outermost end) of a stack to be retained if the stack exceeds its frame
+     * limit, or 0 to stop walking at the limit. The retained frames count against the limit, and are clamped to half
+     * of it. */
+    uint32_t tail_frames;
+
+    /** The time, in nanoseconds, after which the report is truncated, or 0 for no limit. */
+    uint64_t time_budget;
+
+    /** The report size, in bytes, after which no further non-crashed threads are captured, or 0 for no limit. */
+    uint64_t size_budget;
+
+    /** The number of innermost frames to be symbolicated for each thread other than the crashed and main threads, or
+     * 0 to symbolicate all frames. The remaining frames are written without symbols. */
+    uint32_t max_symbolicated_frames;
+} plcrash_log_writer_capture_policy_t;
+
+/**
+ * @internal
+ *
+ * Summary of the most recent report written by a log writer; see plcrash_log_writer_t::last_report.
+ */
+typedef struct plcrash_log_writer_report_summary {
+    /** The number of threads written. */
+    uint32_t thread_count;
+
+    /** The number of frames captured across all written threads. */
+    uint64_t frame_count;
+
+    /** The time spent writing the report, in nanoseconds. */
+    uint64_t duration;
+} plcrash_log_writer_report_summary_t;
+
 /**
  * @internal
  *
@@ -154,12 +295,22 @@ typedef struct plcrash_log_writer {
         /** Flag specifying wether an uncaught exception is available. */
         bool has_exception;
 
+        /** If true, @a name, @a reason and @a callstack reference the writer's @a exception_buffers, and must not be
+         * freed. */
+        bool buffered;
+
         /** Exception name (may be null) */
         char *name;
 
+        /** The length of @a name, in bytes. */
+        size_t name_length;
+
         /** Exception reason (may be null) */
         char *reason;
 
+        /** The length of @a reason, in bytes. */
+        size_t reason_length;
+
         /** The original exception call stack (may be null) */
         void **callstack;
         
@@ -172,8 +323,160 @@ typedef struct plcrash_log_writer {
         /** Number of @a userInfo dictionary pairs. */
         size_t user_info_size;
     } uncaught_exception;
+
+    /** Pre-allocated frame cache. Each stack is walked and symbolicated once into this cache, and the cached
+     * frames are then used to write the report. */
+    struct plcrash_log_writer_frame_cache *frame_cache;
+
+    /** If non-NULL, a borrowed reference to a worker pool used to capture thread stacks in parallel. Only
+     * set for live (non-crash) reports; see plcrash_log_writer_set_workers(). */
+    struct plcrash_log_writer_workers *workers;
+
+    /** Pre-allocated DWARF CIE cache, or NULL if unavailable. The cache is reset and attached to the section
+     * cache used to unwind each report's threads. */
+    struct plframe_dwarf_cie_cache *dwarf_cie_cache;
+
+    /** Parser work budget, reset at the start of each report and attached to the section and symbol caches used
+     * to unwind and symbolicate its threads. Corrupt DWARF CFI, compact unwind or Objective-C metadata can not
+     * consume more than the budget's limits; see plcrash_async_work_budget_set_limit(). */
+    plcrash_async_work_budget_t work_budget;
+
+    /** If non-NULL, a borrowed reference to the pre-reserved crash-time allocator from which the frame and CIE
+     * caches were allocated; see plcrash_log_writer_set_allocator(). */
+    plcrash_async_allocator_t *allocator;
+
+    /** The position of @a allocator following allocation of the writer's caches. Any allocations made from
+     * @a allocator while writing a report are released by resetting to this mark once the report is complete. */
+    plcrash_async_allocator_mark_t allocator_mark;
+
+    /** The report file version to be written; either PLCRASH_REPORT_FILE_VERSION, or
+     * PLCRASH_REPORT_FILE_VERSION_COMPACT. See plcrash_log_writer_set_file_version(). */
+    uint8_t file_version;
+
+    /** Pre-allocated string table used to deduplicate image directory paths, or NULL. Only allocated when writing
+     * compact reports. */
+    struct plcrash_log_writer_string_table *string_table;
+
+    /** Pre-allocated table of the backtraces written to the current report, used to deduplicate identical thread
+     * backtraces, or NULL. Only allocated when writing compact reports. */
+    struct plcrash_log_writer_stack_table *stack_table;
+
+    /** The binary image output options; a bitwise OR of plcrash_log_writer_image_options_t values. See
+     * plcrash_log_writer_set_image_options(). */
+    uint32_t image_options;
+
+    /** Pre-allocated map from image index positions to the positions of the written binary images, or NULL. Only
+     * allocated if @a image_options are set. */
+    struct plcrash_log_writer_image_map *image_map;
+
+    /** The mach_absolute_time() timebase, used to convert crash-time metrics to nanoseconds. */
+    mach_timebase_info_data_t timebase;
+
+    /** The thread capture policy. See plcrash_log_writer_set_capture_policy(). */
+    plcrash_log_writer_capture_policy_t capture_policy;
+
+    /** The capture policy's @a time_budget, in mach_absolute_time() units, or 0 for no limit. */
+    uint64_t capture_time_budget;
+
+    /** The deadline of the report being written, in mach_absolute_time() units, or 0 if none. Derived from
+     * @a capture_time_budget at the start of each report. */
+    uint64_t deadline;
+
+    /** If true, each thread's register state and stack window are snapshotted while the threads are suspended, and
+     * the threads are resumed before their stacks are walked. See plcrash_log_writer_set_snapshot_threads(). */
+    bool snapshot_threads;
+
+    /** If true, threads are unwound using the image list's persistent section cache, when available. See
+     * plcrash_log_writer_set_persistent_unwind(). */
+    bool persistent_unwind;
+
+    /** If true, the writer may write reports concurrently with other reentrant writers. See
+     * plcrash_log_writer_set_reentrant(). */
+    bool reentrant;
+
+    /** The number of bytes of raw stack memory to capture for each thread in place of unwinding, or 0 if stacks are
+     * unwound at capture time. See plcrash_log_writer_set_raw_stack_size(). */
+    size_t raw_stack_size;
+
+    /** Pre-allocated table of the scheduling state of the current report's threads, or NULL if disabled. See
+     * plcrash_log_writer_set_thread_info(). */
+    struct plcrash_log_writer_thread_info_table *thread_info;
+
+    /** Pre-allocated storage for the uncaught exception's name, reason and call stack, or NULL if disabled. See
+     * plcrash_log_writer_set_exception_buffers(). */
+    struct plcrash_log_writer_exception_buffers *exception_buffers;
+
+    /** Pre-allocated cache of the threads unwound and symbolicated by the previous report, or NULL if disabled. See
+     * plcrash_log_writer_set_unwind_cache(). */
+    struct plcrash_log_writer_unwind_cache *unwind_cache;
+
+    /** Pre-allocated memory usage summary, populated when writing each report, or NULL if disabled. See
+     * plcrash_log_writer_set_memory_summary(). */
+    plcrash_async_vm_summary_t *vm_summary;
+
+    /** Pre-allocated map of the current task's readable regions, rebuilt for each report of the current task, or
+     * NULL if disabled. See plcrash_log_writer_set_local_region_map(). */
+    plcrash_async_memory_region_map_t *region_map;
+
+    /** If non-NULL, a borrowed reference to the breadcrumb buffer to be copied into each report. See
+     * plcrash_log_writer_set_breadcrumbs(). */
+    plcrash_async_breadcrumb_buffer_t *breadcrumbs;
+
+    /** If non-NULL, a borrowed reference to the registry of application memory regions to be copied into each
+     * report. See plcrash_log_writer_set_user_regions(). */
+    plcrash_async_user_regions_t *user_regions;
+
+    /** Pre-allocated buffer of PLCRASH_ASYNC_USER_REGION_LENGTH_MAX bytes into which each user region is copied, or
+     * NULL if user regions are disabled. */
+    uint8_t *user_region_buffer;
+
+    /** If non-NULL, a borrowed reference to the trace ring to be copied into each report. See
+     * plcrash_log_writer_set_trace(). */
+    plcrash_async_trace_ring_t *trace;
+
+    /** Summary of the most recently written report, updated as each report is completed. Not written to reports. */
+    plcrash_log_writer_report_summary_t last_report;
+
+    /** If non-NULL, a borrowed reference to the hang details to be written to the next report. See
+     * plcrash_log_writer_set_hang(). */
+    const plcrash_log_writer_hang_info_t *hang;
+
+    /** If non-NULL, a borrowed reference to the termination details to be written to the next report. See
+     * plcrash_log_writer_set_termination(). */
+    const plcrash_log_writer_termination_info_t *termination;
+
+    /** Pre-allocated compressor state and output buffer, or NULL if compression is disabled. See
+     * plcrash_log_writer_set_compression(). */
+    struct plcrash_log_writer_compressor *compressor;
+
+    /** If true, reports are written with a section footer (PLCRASH_REPORT_FILE_FLAG_FOOTER). See
+     * plcrash_log_writer_set_footer(). */
+    bool footer;
+
+    /** Report messages pre-encoded at initialization time. */
+    struct {
+        /** The encoded system info fields preceding the timestamp, followed by the complete machine info, app info,
+         * and process info messages, or NULL if the header could not be encoded. */
+        uint8_t *data;
+
+        /** The length of the system info fields at the start of @a data, in bytes. */
+        size_t system_info_length;
+
+        /** The total length of @a data, in bytes. */
+        size_t length;
+    } static_header;
 } plcrash_log_writer_t;
 
+/**
+ * @internal
+ *
+ * A pool of pre-spawned worker threads, used to unwind and symbolicate thread stacks in parallel. Pools created
+ * via plcrash_log_writer_workers_new() may only be used when writing live (non-crash) reports; pools created via
+ * plcrash_log_writer_workers_new_async_safe() may also be used at crash time. The pool's own threads are neither
+ * suspended nor included in reports written with the pool.
+ */
+typedef struct plcrash_log_writer_workers plcrash_log_writer_workers_t;
+
 /**
  * @internal
  *
@@ -235,7 +538,30 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
                                          NSString *app_version,
                                          plcrash_async_symbol_strategy_t symbol_strategy,
                                          BOOL user_requested);
+plcrash_error_t plcrash_log_writer_set_exception_buffers (plcrash_log_writer_t *writer, bool enable);
 void plcrash_log_writer_set_exception (plcrash_log_writer_t *writer, NSException *exception);
+plcrash_error_t plcrash_log_writer_set_target_process (plcrash_log_writer_t *writer, pid_t pid);
+plcrash_error_t plcrash_log_writer_set_allocator (plcrash_log_writer_t *writer, plcrash_async_allocator_t *allocator);
+plcrash_error_t plcrash_log_writer_set_file_version (plcrash_log_writer_t *writer, uint8_t file_version);
+plcrash_error_t plcrash_log_writer_set_image_options (plcrash_log_writer_t *writer, uint32_t image_options);
+void plcrash_log_writer_set_capture_policy (plcrash_log_writer_t *writer, const plcrash_log_writer_capture_policy_t *policy);
+void plcrash_log_writer_set_snapshot_threads (plcrash_log_writer_t *writer, bool enable);
+void plcrash_log_writer_set_persistent_unwind (plcrash_log_writer_t *writer, bool enable);
+void plcrash_log_writer_set_reentrant (plcrash_log_writer_t *writer, bool enable);
+void plcrash_log_writer_set_raw_stack_size (plcrash_log_writer_t *writer, size_t size);
+plcrash_error_t plcrash_log_writer_set_local_region_map (plcrash_log_writer_t *writer, bool enable);
+plcrash_error_t plcrash_log_writer_set_thread_info (plcrash_log_writer_t *writer, bool enable);
+plcrash_error_t plcrash_log_writer_set_unwind_cache (plcrash_log_writer_t *writer, bool enable);
+plcrash_error_t plcrash_log_writer_set_memory_summary (plcrash_log_writer_t *writer, bool enable);
+void plcrash_log_writer_set_breadcrumbs (plcrash_log_writer_t *writer, plcrash_async_breadcrumb_buffer_t *breadcrumbs);
+plcrash_error_t plcrash_log_writer_set_user_regions (plcrash_log_writer_t *writer, plcrash_async_user_regions_t *regions);
+void plcrash_log_writer_set_trace (plcrash_log_writer_t *writer, plcrash_async_trace_ring_t *trace);
+void plcrash_log_writer_set_hang (plcrash_log_writer_t *writer, const plcrash_log_writer_hang_info_t *hang);
+void plcrash_log_writer_set_termination (plcrash_log_writer_t *writer, const plcrash_log_writer_termination_info_t *termination);
+plcrash_error_t plcrash_log_writer_set_compression (plcrash_log_writer_t *writer, size_t max_report_size);
+void plcrash_log_writer_set_footer (plcrash_log_writer_t *writer, bool enable);
+void plcrash_log_writer_reset (plcrash_log_writer_t *writer);
+void plcrash_log_writer_reset_async (plcrash_log_writer_t *writer);
 
 plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
                                           thread_t crashed_thread,
@@ -244,9 +570,25 @@ plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
                                           plcrash_log_signal_info_t *siginfo,
                                           plcrash_async_thread_state_t *current_state);
 
+plcrash_error_t plcrash_log_writer_write_task (plcrash_log_writer_t *writer,
+                                               task_t task,
+                                               thread_t crashed_thread,
+                                               plcrash_async_image_list_t *image_list,
+                                               plcrash_async_file_t *file,
+                                               plcrash_log_signal_info_t *siginfo,
+                                               plcrash_async_thread_state_t *current_state);
+
 plcrash_error_t plcrash_log_writer_close (plcrash_log_writer_t *writer);
 void plcrash_log_writer_free (plcrash_log_writer_t *writer);
 
+plcrash_error_t plcrash_log_writer_workers_new (plcrash_log_writer_workers_t **workers, uint32_t count);
+plcrash_error_t plcrash_log_writer_workers_new_async_safe (plcrash_log_writer_workers_t **workers, uint32_t count, uint32_t max_threads);
+plcrash_error_t plcrash_log_writer_workers_wire (plcrash_log_writer_workers_t *workers, size_t *wired_size);
+void plcrash_log_writer_workers_free (plcrash_log_writer_workers_t *workers);
+void plcrash_log_writer_set_workers (plcrash_log_writer_t *writer, plcrash_log_writer_workers_t *workers);
+
+size_t plcrash_log_writer_encode_binary_image (plcrash_async_macho_t *image, void *buffer, size_t length);
+
 /**
  * @} plcrash_log_writer
  */
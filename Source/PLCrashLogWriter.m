@@ -32,6 +32,7 @@
 #import <string.h>
 #import <stdbool.h>
 #import <dlfcn.h>
+#import <pthread.h>
 
 #import <sys/sysctl.h>
 #import <sys/time.h>
@@ -41,10 +42,18 @@
 #import <libkern/OSAtomic.h>
 
 #import "PLCrashReport.h"
+#import "PLCrashReportReader.h"
 #import "PLCrashLogWriter.h"
 #import "PLCrashLogWriterEncoding.h"
 #import "PLCrashAsyncSignalInfo.h"
 #import "PLCrashAsyncSymbolication.h"
+#import "PLCrashAsyncSharedCache.h"
+#import "PLCrashAsyncLZ4.h"
+#import "PLCrashFrameDWARFUnwind.h"
+#import "PLCrashFrameCompactUnwind.h"
+#import "PLCrashFrameStackUnwind.h"
+#import "PLCrashFrameStackScan.h"
+#import "PLCrashFrameSigtramp.h"
 
 #import "PLCrashSysctl.h"
 #import "PLCrashProcessInfo.h"
@@ -64,6 +73,418 @@
  */
 #define MAX_THREAD_FRAMES 512 // matches Apple's crash reporting on Snow Leopard
 
+/**
+ * @internal
+ * Maximum length of a repeating frame sequence that will be collapsed into a single repeated sequence record.
+ */
+#define PLCRASH_WRITER_REPEAT_LENGTH_MAX 8
+
+/**
+ * @internal
+ * Maximum number of frames that will be walked for a single thread, including any collapsed repeated frames. Bounds
+ * the time spent walking a thread whose stack was exhausted by unbounded recursion.
+ */
+#define PLCRASH_WRITER_WALK_FRAMES_MAX (MAX_THREAD_FRAMES * 128)
+
+/**
+ * @internal
+ * Maximum length of a resolved frame symbol name, including the terminating NUL.
+ */
+#define PLCRASH_WRITER_SYMBOL_NAME_MAX 256
+
+/**
+ * @internal
+ *
+ * A frame's resolved symbol. The symbol is looked up once per frame, and the result is then used both to size
+ * and to write the frame message.
+ */
+typedef struct plcrash_writer_frame_symbol {
+    /** If true, a symbol was found for the frame, and the remaining fields are valid. */
+    bool found;
+
+    /** The symbol start address. */
+    pl_vm_address_t start_address;
+
+    /** The NUL-terminated symbol name. Names longer than the buffer are truncated. */
+    char name[PLCRASH_WRITER_SYMBOL_NAME_MAX];
+} plcrash_writer_frame_symbol_t;
+
+/**
+ * @internal
+ *
+ * Frame unwind methods, as written to CrashReport.thread.frame.unwind_method.
+ */
+typedef enum {
+    /** Unknown; the frame was not walked. Not written. */
+    PLCRASH_WRITER_UNWIND_METHOD_UNKNOWN = 0,
+
+    /** The frame was derived from the thread's register state. */
+    PLCRASH_WRITER_UNWIND_METHOD_THREAD_STATE = 1,
+
+    /** The first of the frame reader methods, ordered as per plcrash_writer_reader_t. */
+    PLCRASH_WRITER_UNWIND_METHOD_READER = 2,
+} plcrash_writer_unwind_method_t;
+
+/**
+ * @internal
+ *
+ * A captured stack frame.
+ */
+typedef struct plcrash_writer_cached_frame {
+    /** The frame's PC value. */
+    uint64_t pc;
+
+    /** If non-zero, the frame ends a sequence of @a repeat_length captured frames that was walked @a repeat_count
+     * additional times following this frame. */
+    uint32_t repeat_length;
+
+    /** The number of additional repetitions of the sequence ending at this frame. */
+    uint32_t repeat_count;
+
+    /** The number of frames walked immediately following this frame that were not captured, as the stack exceeded
+     * its frame limit. See plcrash_log_writer_capture_policy_t::tail_frames. */
+    uint32_t omitted_count;
+
+    /** The frame's plcrash_writer_unwind_method_t unwind method. */
+    uint8_t unwind_method;
+
+    /** The frame's resolved symbol. */
+    plcrash_writer_frame_symbol_t symbol;
+} plcrash_writer_cached_frame_t;
+
+/**
+ * @internal
+ *
+ * Frame cache. A single stack is walked and symbolicated into the cache, after which the cached frames
+ * are used to size and write the frame messages. The cache is allocated by plcrash_log_writer_init(), as
+ * allocation is not permitted at crash time.
+ */
+struct plcrash_log_writer_frame_cache {
+    /** The number of valid entries in @a frames. */
+    uint32_t count;
+
+    /** The captured frames. */
+    plcrash_writer_cached_frame_t frames[MAX_THREAD_FRAMES];
+
+    /** Symbolication scratch space: frame indices, sorted by image and PC. */
+    uint32_t sorted[MAX_THREAD_FRAMES];
+
+    /** Symbolication scratch space: the image containing each frame's PC, or NULL if not found. */
+    plcrash_async_image_t *images[MAX_THREAD_FRAMES];
+
+    /** Symbolication scratch space: the unique PC values of a single image's frames, in ascending order. */
+    pl_vm_address_t pcs[MAX_THREAD_FRAMES];
+
+    /** Symbolication scratch space: the index of the first frame matching each entry in @a pcs. */
+    uint32_t pc_frames[MAX_THREAD_FRAMES];
+};
+
+/**
+ * @internal
+ * Maximum number of unique strings in the compact encoding string table. The directories of any images beyond
+ * this limit are written as part of the image's full path.
+ */
+#define PLCRASH_WRITER_STRING_TABLE_MAX 1024
+
+/**
+ * @internal
+ * Number of string table hash slots. Must be a power of two, and greater than PLCRASH_WRITER_STRING_TABLE_MAX.
+ */
+#define PLCRASH_WRITER_STRING_TABLE_SLOTS 2048
+
+/**
+ * @internal
+ *
+ * String table used to deduplicate the image directory paths written to compact reports. The table references,
+ * but does not copy, the interned strings, and is reset at the start of each report. The table is allocated by
+ * plcrash_log_writer_set_file_version(), as allocation is not permitted at crash time.
+ */
+struct plcrash_log_writer_string_table {
+    /** The number of valid entries in @a strings. */
+    uint32_t count;
+
+    /** The interned strings, in insertion order. The strings are not NUL-terminated. */
+    struct {
+        /** The string data. */
+        const char *data;
+
+        /** The string length, in bytes. */
+        size_t length;
+    } strings[PLCRASH_WRITER_STRING_TABLE_MAX];
+
+    /** Open-addressed hash slots, each containing an index into @a strings plus one, or 0 if empty. */
+    uint16_t slots[PLCRASH_WRITER_STRING_TABLE_SLOTS];
+};
+
+/**
+ * @internal
+ * Maximum number of unique backtraces recorded by the stack table. Threads beyond this limit are written in full.
+ */
+#define PLCRASH_WRITER_STACK_TABLE_MAX 512
+
+/**
+ * @internal
+ * Number of stack table hash slots. Must be a power of two, and greater than PLCRASH_WRITER_STACK_TABLE_MAX.
+ */
+#define PLCRASH_WRITER_STACK_TABLE_SLOTS 1024
+
+/**
+ * @internal
+ *
+ * Table of the thread backtraces written to a compact report, used to write identical backtraces once. Backtraces
+ * are identified by a hash of their PC values, computed as each stack is walked, and their frame count. The table is
+ * reset at the start of each report, and is allocated by plcrash_log_writer_set_file_version(), as allocation is not
+ * permitted at crash time.
+ */
+struct plcrash_log_writer_stack_table {
+    /** The number of valid entries in @a stacks. */
+    uint32_t count;
+
+    /** The recorded backtraces, in insertion order. */
+    struct {
+        /** The backtrace's PC hash. */
+        uint64_t hash;
+
+        /** The backtrace's frame count. */
+        uint32_t frame_count;
+
+        /** The number of the thread with which the backtrace was written. */
+        uint32_t thread_number;
+    } stacks[PLCRASH_WRITER_STACK_TABLE_MAX];
+
+    /** Open-addressed hash slots, each containing an index into @a stacks plus one, or 0 if empty. */
+    uint16_t slots[PLCRASH_WRITER_STACK_TABLE_SLOTS];
+};
+
+/**
+ * @internal
+ * Maximum number of image index positions that may be remapped when a subset of the binary images are written.
+ * Frames within any images beyond this limit are written using absolute PCs, and the images are always written.
+ */
+#define PLCRASH_WRITER_IMAGE_MAP_MAX 4096
+
+/**
+ * @internal
+ * Maximum number of registers of the crashed thread that may be annotated with their containing image and symbol.
+ * This exceeds the register count of all supported architectures.
+ */
+#define PLCRASH_WRITER_ANNOTATED_REGISTERS_MAX 64
+
+/**
+ * @internal
+ *
+ * Maps the positions of images within the image list's sorted index to their positions within a report's written
+ * binary images. Used when writing a subset of the loaded images. The map is allocated by
+ * plcrash_log_writer_set_image_options(), as allocation is not permitted at crash time.
+ */
+struct plcrash_log_writer_image_map {
+    /** The number of valid entries in @a positions. */
+    uint32_t count;
+
+    /** For each image index position, the image's position within the written binary images plus one, or 0 if the
+     * image is not written. */
+    uint32_t positions[PLCRASH_WRITER_IMAGE_MAP_MAX];
+
+    /** The number of images that have been assigned a position in @a positions. */
+    uint32_t assigned;
+
+    /** The index positions of the assigned images, in written order. Only maintained when writing referenced
+     * images. */
+    uint32_t order[PLCRASH_WRITER_IMAGE_MAP_MAX];
+};
+
+/**
+ * @internal
+ * Maximum number of threads for which scheduling state is captured. Threads beyond this limit are written without
+ * their scheduling state.
+ */
+#define PLCRASH_WRITER_THREAD_INFO_MAX 512
+
+/* THREAD_QOS_POLICY is not declared by all SDKs; the flavor is supported by xnu 14 (iOS 8, Mac OS X 10.10) and
+ * later, and thread_policy_get() will return an error on earlier releases. */
+#ifndef THREAD_QOS_POLICY
+#define THREAD_QOS_POLICY 9
+struct thread_qos_policy {
+    integer_t qos_tier;
+    integer_t tier_importance;
+};
+#define THREAD_QOS_POLICY_COUNT ((mach_msg_type_number_t) (sizeof(struct thread_qos_policy) / sizeof(integer_t)))
+#endif
+
+/**
+ * @internal
+ * Maximum length of a captured thread name, including the NUL terminator. Matches the kernel's MAXTHREADNAMESIZE.
+ */
+#define PLCRASH_WRITER_THREAD_NAME_MAX 64
+
+/**
+ * @internal
+ *
+ * A thread's scheduling and CPU accounting state, as returned by thread_info().
+ */
+typedef struct plcrash_writer_thread_info {
+    /** If false, the thread's state could not be fetched, and no other fields are valid. */
+    bool valid;
+
+    /** Total user and system run time, in microseconds. */
+    uint64_t user_time;
+    uint64_t system_time;
+
+    /** Scaled CPU usage, in units of TH_USAGE_SCALE. */
+    uint32_t cpu_usage;
+
+    /** The thread's run state (TH_STATE_*). */
+    uint32_t run_state;
+
+    /** The thread's TH_FLAGS_* flags. */
+    uint32_t flags;
+
+    /** The number of seconds for which the thread has been sleeping. */
+    uint32_t sleep_time;
+
+    /** If true, the THREAD_EXTENDED_INFO fields are valid. */
+    bool has_extended;
+
+    /** The thread's base and current scheduling priorities. */
+    int32_t base_priority;
+    int32_t current_priority;
+
+    /** The thread's NUL-terminated name, or an empty string if unnamed. */
+    char name[PLCRASH_WRITER_THREAD_NAME_MAX];
+
+    /** If true, @a qos_class is valid. */
+    bool has_qos;
+
+    /** The thread's QoS tier (THREAD_QOS_*). */
+    uint32_t qos_class;
+} plcrash_writer_thread_info_t;
+
+/**
+ * @internal
+ *
+ * The scheduling state of a report's threads, captured in a single pass over the thread list before the threads are
+ * suspended; see plcrash_writer_capture_thread_info(). The table is allocated by plcrash_log_writer_set_thread_info(),
+ * as allocation is not permitted at crash time.
+ */
+struct plcrash_log_writer_thread_info_table {
+    /** The number of captured entries in @a threads. Entries are indexed by the thread's task_threads() position. */
+    uint32_t count;
+
+    /** The captured thread states. */
+    plcrash_writer_thread_info_t threads[PLCRASH_WRITER_THREAD_INFO_MAX];
+};
+
+/** The maximum size of a reserved uncaught exception name, in bytes, including the NUL terminator. */
+#define PLCRASH_WRITER_EXCEPTION_NAME_MAX 256
+
+/** The maximum size of a reserved uncaught exception reason, in bytes, including the NUL terminator. */
+#define PLCRASH_WRITER_EXCEPTION_REASON_MAX (16 * 1024)
+
+/**
+ * @internal
+ *
+ * Storage for the name, reason and call stack of an uncaught exception, reserved by
+ * plcrash_log_writer_set_exception_buffers() so that plcrash_log_writer_set_exception() need not allocate from a
+ * process that is about to terminate. Longer names and reasons are truncated, and deeper call stacks are truncated
+ * to the frames that would be written to the report.
+ */
+struct plcrash_log_writer_exception_buffers {
+    /** The NUL-terminated exception name. */
+    char name[PLCRASH_WRITER_EXCEPTION_NAME_MAX];
+
+    /** The NUL-terminated exception reason. */
+    char reason[PLCRASH_WRITER_EXCEPTION_REASON_MAX];
+
+    /** The exception call stack. */
+    void *callstack[MAX_THREAD_FRAMES];
+};
+
+/** The maximum number of threads retained by each generation of the unwind cache. */
+#define PLCRASH_WRITER_UNWIND_CACHE_THREADS_MAX 256
+
+/** The total number of frames retained by each generation of the unwind cache. */
+#define PLCRASH_WRITER_UNWIND_CACHE_FRAMES_MAX 2048
+
+/** The number of bytes at a thread's stack pointer that are included in its unwind key. */
+#define PLCRASH_WRITER_UNWIND_KEY_STACK_SIZE 256
+
+/**
+ * @internal
+ *
+ * Identifies a thread's position at the time its state was fetched. A thread with an identical key in two reports is
+ * assumed not to have run in the interim, and its previously captured frames are reused.
+ */
+typedef struct plcrash_writer_unwind_key {
+    /** The thread's port. */
+    thread_t thread;
+
+    /** The thread's instruction and stack pointers. */
+    plcrash_greg_t ip;
+    plcrash_greg_t sp;
+
+    /** The FNV-1a hash of the PLCRASH_WRITER_UNWIND_KEY_STACK_SIZE bytes at @a sp. The innermost return addresses
+     * and saved frame pointers are included, such that a thread that has returned and re-entered the same IP with the
+     * same SP does not match. */
+    uint64_t stack_hash;
+} plcrash_writer_unwind_key_t;
+
+/**
+ * @internal
+ *
+ * A thread's captured frames, retained by the unwind cache.
+ */
+typedef struct plcrash_writer_unwind_entry {
+    /** The thread's unwind key. */
+    plcrash_writer_unwind_key_t key;
+
+    /** The frame limits with which the thread was captured; an entry captured with different limits is not reused. */
+    uint32_t max_frames;
+    uint32_t tail_frames;
+
+    /** The position of the thread's first frame in the generation's frame pool. */
+    uint32_t frame_offset;
+
+    /** The number of frames present. */
+    uint32_t frame_count;
+} plcrash_writer_unwind_entry_t;
+
+/**
+ * @internal
+ *
+ * The threads captured by a single report.
+ */
+struct plcrash_writer_unwind_generation {
+    /** The number of valid entries in @a entries. */
+    uint32_t count;
+
+    /** The number of frames used in @a frames. */
+    uint32_t frame_count;
+
+    /** The captured threads. */
+    plcrash_writer_unwind_entry_t entries[PLCRASH_WRITER_UNWIND_CACHE_THREADS_MAX];
+
+    /** The frame pool, shared by all entries. */
+    plcrash_writer_cached_frame_t frames[PLCRASH_WRITER_UNWIND_CACHE_FRAMES_MAX];
+};
+
+/**
+ * @internal
+ *
+ * The unwind cache. Threads that have not moved since the previous report are written from the frames captured by
+ * that report, rather than being walked and symbolicated again; see plcrash_log_writer_set_unwind_cache().
+ *
+ * Each report records its threads into the current generation while reading from the previous generation, and the
+ * two are exchanged once the report's threads have been written. Threads that are not present in a report are
+ * thereby dropped from the cache.
+ */
+struct plcrash_log_writer_unwind_cache {
+    /** The previous and current generations. */
+    struct plcrash_writer_unwind_generation generations[2];
+
+    /** The index of the current generation within @a generations. */
+    uint32_t current;
+};
+
 /**
  * @internal
  * Protobuf Field IDs, as defined in crashreport.proto
@@ -127,6 +548,24 @@ enum {
     /** CrashReport.thread.frame.symbol */
     PLCRASH_PROTO_THREAD_FRAME_SYMBOL_ID = 6,
 
+    /** CrashReport.thread.frame.image_index */
+    PLCRASH_PROTO_THREAD_FRAME_IMAGE_INDEX_ID = 7,
+
+    /** CrashReport.thread.frame.offset_delta */
+    PLCRASH_PROTO_THREAD_FRAME_OFFSET_DELTA_ID = 8,
+
+    /** CrashReport.thread.frame.repeat_length */
+    PLCRASH_PROTO_THREAD_FRAME_REPEAT_LENGTH_ID = 9,
+
+    /** CrashReport.thread.frame.repeat_count */
+    PLCRASH_PROTO_THREAD_FRAME_REPEAT_COUNT_ID = 10,
+
+    /** CrashReport.thread.frame.omitted_count */
+    PLCRASH_PROTO_THREAD_FRAME_OMITTED_COUNT_ID = 11,
+
+    /** CrashReport.thread.frame.unwind_method */
+    PLCRASH_PROTO_THREAD_FRAME_UNWIND_METHOD_ID = 12,
+
 
     /** CrashReport.thread.registers */
     PLCRASH_PROTO_THREAD_REGISTERS_ID = 4,
@@ -134,9 +573,88 @@ enum {
     /** CrashReport.thread.register.name */
     PLCRASH_PROTO_THREAD_REGISTER_NAME_ID = 1,
 
-    /** CrashReport.thread.register.name */
+    /** CrashReport.thread.register.value */
     PLCRASH_PROTO_THREAD_REGISTER_VALUE_ID = 2,
 
+    /** CrashReport.thread.register.image_index */
+    PLCRASH_PROTO_THREAD_REGISTER_IMAGE_INDEX_ID = 3,
+
+    /** CrashReport.thread.register.symbol_start */
+    PLCRASH_PROTO_THREAD_REGISTER_SYMBOL_START_ID = 4,
+
+    /** CrashReport.thread.register_state */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_ID = 8,
+
+    /** CrashReport.thread.register_state.x86_32 */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_X86_32_ID = 1,
+
+    /** CrashReport.thread.register_state.x86_64 */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_X86_64_ID = 2,
+
+    /** CrashReport.thread.register_state.arm */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_ARM_ID = 3,
+
+    /** CrashReport.thread.register_state.arm64 */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_ARM64_ID = 4,
+
+    /** CrashReport.thread.register_state.annotations */
+    PLCRASH_PROTO_THREAD_REGISTER_STATE_ANNOTATIONS_ID = 5,
+
+    /** CrashReport.thread.register_state.annotations.register_number */
+    PLCRASH_PROTO_THREAD_REGISTER_ANNOTATION_REGISTER_NUMBER_ID = 1,
+
+    /** CrashReport.thread.register_state.annotations.image_index */
+    PLCRASH_PROTO_THREAD_REGISTER_ANNOTATION_IMAGE_INDEX_ID = 2,
+
+    /** CrashReport.thread.register_state.annotations.symbol_start */
+    PLCRASH_PROTO_THREAD_REGISTER_ANNOTATION_SYMBOL_START_ID = 3,
+
+
+    /** CrashReport.thread.stack_memory */
+    PLCRASH_PROTO_THREAD_STACK_MEMORY_ID = 5,
+
+    /** CrashReport.thread.stack_memory.address */
+    PLCRASH_PROTO_THREAD_STACK_MEMORY_ADDRESS_ID = 1,
+
+    /** CrashReport.thread.stack_memory.data */
+    PLCRASH_PROTO_THREAD_STACK_MEMORY_DATA_ID = 2,
+
+    /** CrashReport.thread.duplicate_of_thread */
+    PLCRASH_PROTO_THREAD_DUPLICATE_OF_THREAD_ID = 6,
+
+    /** CrashReport.thread.scheduling */
+    PLCRASH_PROTO_THREAD_SCHEDULING_ID = 7,
+
+    /** CrashReport.thread.scheduling.user_time */
+    PLCRASH_PROTO_THREAD_SCHEDULING_USER_TIME_ID = 1,
+
+    /** CrashReport.thread.scheduling.system_time */
+    PLCRASH_PROTO_THREAD_SCHEDULING_SYSTEM_TIME_ID = 2,
+
+    /** CrashReport.thread.scheduling.cpu_usage */
+    PLCRASH_PROTO_THREAD_SCHEDULING_CPU_USAGE_ID = 3,
+
+    /** CrashReport.thread.scheduling.run_state */
+    PLCRASH_PROTO_THREAD_SCHEDULING_RUN_STATE_ID = 4,
+
+    /** CrashReport.thread.scheduling.flags */
+    PLCRASH_PROTO_THREAD_SCHEDULING_FLAGS_ID = 5,
+
+    /** CrashReport.thread.scheduling.sleep_time */
+    PLCRASH_PROTO_THREAD_SCHEDULING_SLEEP_TIME_ID = 6,
+
+    /** CrashReport.thread.scheduling.base_priority */
+    PLCRASH_PROTO_THREAD_SCHEDULING_BASE_PRIORITY_ID = 7,
+
+    /** CrashReport.thread.scheduling.current_priority */
+    PLCRASH_PROTO_THREAD_SCHEDULING_CURRENT_PRIORITY_ID = 8,
+
+    /** CrashReport.thread.scheduling.name */
+    PLCRASH_PROTO_THREAD_SCHEDULING_NAME_ID = 9,
+
+    /** CrashReport.thread.scheduling.qos_class */
+    PLCRASH_PROTO_THREAD_SCHEDULING_QOS_CLASS_ID = 10,
+
 
     /** CrashReport.images */
     PLCRASH_PROTO_BINARY_IMAGES_ID = 4,
@@ -156,6 +674,9 @@ enum {
     /** CrashReport.BinaryImage.code_type */
     PLCRASH_PROTO_BINARY_IMAGE_CODE_TYPE_ID = 5,
 
+    /** CrashReport.BinaryImage.directory_index */
+    PLCRASH_PROTO_BINARY_IMAGE_DIRECTORY_INDEX_ID = 6,
+
     
     /** CrashReport.exception */
     PLCRASH_PROTO_EXCEPTION_ID = 5,
@@ -265,63 +786,287 @@ enum {
 
     /** CrashReport.report_info.uuid */
     PLCRASH_PROTO_REPORT_INFO_UUID_ID = 2,
-};
 
-/**
- * Initialize a new crash log writer instance and issue a memory barrier upon completion. This fetches all necessary
- * environment information.
- *
- * @param writer Writer instance to be initialized.
- * @param app_identifier Unique per-application identifier. On Mac OS X, this is likely the CFBundleIdentifier.
- * @param app_version Application version string.
- * @param symbol_strategy The strategy to use for local symbolication.
- * @param user_requested If true, the written report will be marked as a 'generated' non-crash report, rather than as
- * a true crash report created upon an actual crash.
- *
- * @note If this function fails, plcrash_log_writer_free() should be called
- * to free any partially allocated data.
- *
- * @warning This function is not guaranteed to be async-safe, and must be called prior to enabling the crash handler.
- */
-plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
-                                         NSString *app_identifier,
-                                         NSString *app_version,
-                                         plcrash_async_symbol_strategy_t symbol_strategy,
-                                         BOOL user_requested)
-{
-    /* Default to 0 */
-    memset(writer, 0, sizeof(*writer));
+    /** CrashReport.report_info.metrics */
+    PLCRASH_PROTO_REPORT_INFO_METRICS_ID = 3,
 
-    /* Initialize configuration */
-    writer->symbol_strategy = symbol_strategy;
+    /** CrashReport.report_info.truncated */
+    PLCRASH_PROTO_REPORT_INFO_TRUNCATED_ID = 4,
 
-    /* Default to false */
-    writer->report_info.user_requested = user_requested;
+    /** CrashReport.report_info.type */
+    PLCRASH_PROTO_REPORT_INFO_TYPE_ID = 5,
 
-    /* Generate a UUID for this incident; CFUUID is used in favor of NSUUID as to maintain compatibility
-     * with (Mac OS X 10.7|iOS 5) and earlier. */
-    {
-        CFUUIDRef uuid = CFUUIDCreate(NULL);
-        CFUUIDBytes bytes = CFUUIDGetUUIDBytes(uuid);
-        PLCF_ASSERT(sizeof(bytes) == sizeof(writer->report_info.uuid_bytes));
-        memcpy(writer->report_info.uuid_bytes, &bytes, sizeof(writer->report_info.uuid_bytes));
-        CFRelease(uuid);
-    }
 
-    /* Fetch the application information */
-    {
-        writer->application_info.app_identifier = strdup([app_identifier UTF8String]);
-        writer->application_info.app_version = strdup([app_version UTF8String]);
-    }
-    
-    /* Fetch the process information */
-    {
-        /* Current process */
-        PLCrashProcessInfo *pinfo = [PLCrashProcessInfo currentProcessInfo];
-        if (pinfo == nil) {
-            /* Should only occur if the process is no longer valid */
-            PLCF_DEBUG("Could not retreive process info for target");
-            return PLCRASH_EINVAL;
+    /** CrashReport.strings */
+    PLCRASH_PROTO_STRINGS_ID = 10,
+
+
+    /** CrashReport.shared_cache */
+    PLCRASH_PROTO_SHARED_CACHE_ID = 11,
+
+    /** CrashReport.shared_cache.uuid */
+    PLCRASH_PROTO_SHARED_CACHE_UUID_ID = 1,
+
+    /** CrashReport.shared_cache.slide */
+    PLCRASH_PROTO_SHARED_CACHE_SLIDE_ID = 2,
+
+    /** CrashReport.shared_cache.base_address */
+    PLCRASH_PROTO_SHARED_CACHE_BASE_ADDRESS_ID = 3,
+
+
+    /** CrashReport.breadcrumbs */
+    PLCRASH_PROTO_BREADCRUMBS_ID = 12,
+
+    /** CrashReport.breadcrumbs.record_size */
+    PLCRASH_PROTO_BREADCRUMBS_RECORD_SIZE_ID = 1,
+
+    /** CrashReport.breadcrumbs.slot_size */
+    PLCRASH_PROTO_BREADCRUMBS_SLOT_SIZE_ID = 2,
+
+    /** CrashReport.breadcrumbs.slots */
+    PLCRASH_PROTO_BREADCRUMBS_SLOTS_ID = 3,
+
+    /** CrashReport.hang */
+    PLCRASH_PROTO_HANG_ID = 14,
+
+    /** CrashReport.hang.duration */
+    PLCRASH_PROTO_HANG_DURATION_ID = 1,
+
+    /** CrashReport.hang.samples */
+    PLCRASH_PROTO_HANG_SAMPLES_ID = 2,
+
+    /** CrashReport.hang.samples.offset */
+    PLCRASH_PROTO_HANG_SAMPLE_OFFSET_ID = 1,
+
+    /** CrashReport.hang.samples.pcs */
+    PLCRASH_PROTO_HANG_SAMPLE_PCS_ID = 2,
+
+
+    /** CrashReport.memory */
+    PLCRASH_PROTO_MEMORY_ID = 15,
+
+    /** CrashReport.memory.phys_footprint */
+    PLCRASH_PROTO_MEMORY_PHYS_FOOTPRINT_ID = 1,
+
+    /** CrashReport.memory.resident_size */
+    PLCRASH_PROTO_MEMORY_RESIDENT_SIZE_ID = 2,
+
+    /** CrashReport.memory.resident_size_peak */
+    PLCRASH_PROTO_MEMORY_RESIDENT_SIZE_PEAK_ID = 3,
+
+    /** CrashReport.memory.compressed_size */
+    PLCRASH_PROTO_MEMORY_COMPRESSED_SIZE_ID = 4,
+
+    /** CrashReport.memory.virtual_size */
+    PLCRASH_PROTO_MEMORY_VIRTUAL_SIZE_ID = 5,
+
+    /** CrashReport.memory.regions */
+    PLCRASH_PROTO_MEMORY_REGIONS_ID = 6,
+
+    /** CrashReport.memory.regions.tag */
+    PLCRASH_PROTO_MEMORY_REGION_TAG_ID = 1,
+
+    /** CrashReport.memory.regions.mapped_file */
+    PLCRASH_PROTO_MEMORY_REGION_MAPPED_FILE_ID = 2,
+
+    /** CrashReport.memory.regions.region_count */
+    PLCRASH_PROTO_MEMORY_REGION_COUNT_ID = 3,
+
+    /** CrashReport.memory.regions.virtual_size */
+    PLCRASH_PROTO_MEMORY_REGION_VIRTUAL_SIZE_ID = 4,
+
+    /** CrashReport.memory.regions.resident_size */
+    PLCRASH_PROTO_MEMORY_REGION_RESIDENT_SIZE_ID = 5,
+
+    /** CrashReport.memory.regions.dirty_size */
+    PLCRASH_PROTO_MEMORY_REGION_DIRTY_SIZE_ID = 6,
+
+    /** CrashReport.memory.regions.swapped_size */
+    PLCRASH_PROTO_MEMORY_REGION_SWAPPED_SIZE_ID = 7,
+
+    /** CrashReport.memory.regions_truncated */
+    PLCRASH_PROTO_MEMORY_REGIONS_TRUNCATED_ID = 7,
+
+
+    /** CrashReport.termination */
+    PLCRASH_PROTO_TERMINATION_ID = 16,
+
+    /** CrashReport.termination.reason */
+    PLCRASH_PROTO_TERMINATION_REASON_ID = 1,
+
+    /** CrashReport.termination.pid */
+    PLCRASH_PROTO_TERMINATION_PID_ID = 2,
+
+    /** CrashReport.termination.launch_time */
+    PLCRASH_PROTO_TERMINATION_LAUNCH_TIME_ID = 3,
+
+    /** CrashReport.termination.foreground */
+    PLCRASH_PROTO_TERMINATION_FOREGROUND_ID = 4,
+
+    /** CrashReport.termination.in_hang */
+    PLCRASH_PROTO_TERMINATION_IN_HANG_ID = 5,
+
+    /** CrashReport.termination.memory_warning */
+    PLCRASH_PROTO_TERMINATION_MEMORY_WARNING_ID = 6,
+
+    /** CrashReport.termination.footprint */
+    PLCRASH_PROTO_TERMINATION_FOOTPRINT_ID = 7,
+
+    /** CrashReport.termination.footprint_time */
+    PLCRASH_PROTO_TERMINATION_FOOTPRINT_TIME_ID = 8,
+
+
+    /** CrashReport.user_regions */
+    PLCRASH_PROTO_USER_REGIONS_ID = 18,
+
+    /** CrashReport.user_regions.tag */
+    PLCRASH_PROTO_USER_REGION_TAG_ID = 1,
+
+    /** CrashReport.user_regions.address */
+    PLCRASH_PROTO_USER_REGION_ADDRESS_ID = 2,
+
+    /** CrashReport.user_regions.length */
+    PLCRASH_PROTO_USER_REGION_LENGTH_ID = 3,
+
+    /** CrashReport.user_regions.data */
+    PLCRASH_PROTO_USER_REGION_DATA_ID = 4,
+
+    /** CrashReport.debug_trace */
+    PLCRASH_PROTO_DEBUG_TRACE_ID = 17,
+
+    /** CrashReport.debug_trace.record_size */
+    PLCRASH_PROTO_DEBUG_TRACE_RECORD_SIZE_ID = 1,
+
+    /** CrashReport.debug_trace.records */
+    PLCRASH_PROTO_DEBUG_TRACE_RECORDS_ID = 2,
+
+    /** CrashReport.checksum */
+    PLCRASH_PROTO_CHECKSUM_ID = 13,
+};
+
+static void plcrash_writer_encode_static_header (plcrash_log_writer_t *writer);
+
+/**
+ * @internal
+ *
+ * Pre-allocated report compression state. See plcrash_log_writer_set_compression().
+ */
+struct plcrash_log_writer_compressor {
+    /** The compressor's match table. */
+    plcrash_async_lz4_state_t state;
+
+    /** The size of @a output, in bytes. */
+    size_t output_size;
+
+    /** Output buffer into which the report is compressed before being copied into place. */
+    uint8_t output[];
+};
+
+/**
+ * @internal
+ *
+ * Generate a new incident UUID for @a writer's next report. This function is not async-safe.
+ */
+static void plcrash_writer_generate_uuid (plcrash_log_writer_t *writer) {
+    /* CFUUID is used in favor of NSUUID as to maintain compatibility with (Mac OS X 10.7|iOS 5) and earlier. */
+    CFUUIDRef uuid = CFUUIDCreate(NULL);
+    CFUUIDBytes bytes = CFUUIDGetUUIDBytes(uuid);
+    PLCF_ASSERT(sizeof(bytes) == sizeof(writer->report_info.uuid_bytes));
+    memcpy(writer->report_info.uuid_bytes, &bytes, sizeof(writer->report_info.uuid_bytes));
+    CFRelease(uuid);
+}
+
+/**
+ * @internal
+ *
+ * Return the length of @a str, or 0 if @a str is NULL. Used to pre-compute the lengths of strings that are written
+ * at crash time, avoiding repeated strlen() calls in both the sizing and writing passes.
+ */
+static size_t plcrash_writer_strlen (const char *str) {
+    if (str == NULL)
+        return 0;
+
+    return strlen(str);
+}
+
+/**
+ * Initialize a new crash log writer instance and issue a memory barrier upon completion. This fetches all necessary
+ * environment information.
+ *
+ * @param writer Writer instance to be initialized.
+ * @param app_identifier Unique per-application identifier. On Mac OS X, this is likely the CFBundleIdentifier.
+ * @param app_version Application version string.
+ * @param symbol_strategy The strategy to use for local symbolication.
+ * @param user_requested If true, the written report will be marked as a 'generated' non-crash report, rather than as
+ * a true crash report created upon an actual crash.
+ *
+ * @note If this function fails, plcrash_log_writer_free() should be called
+ * to free any partially allocated data.
+ *
+ * @warning This function is not guaranteed to be async-safe, and must be called prior to enabling the crash handler.
+ */
+plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
+                                         NSString *app_identifier,
+                                         NSString *app_version,
+                                         plcrash_async_symbol_strategy_t symbol_strategy,
+                                         BOOL user_requested)
+{
+    /* Default to 0 */
+    memset(writer, 0, sizeof(*writer));
+
+    /* Initialize configuration */
+    writer->symbol_strategy = symbol_strategy;
+    writer->file_version = PLCRASH_REPORT_FILE_VERSION;
+
+    /* Allocate the frame cache; allocation is not permitted at crash time. */
+    writer->frame_cache = malloc(sizeof(*writer->frame_cache));
+    if (writer->frame_cache == NULL) {
+        PLCF_DEBUG("Could not allocate the frame cache");
+        return PLCRASH_ENOMEM;
+    }
+    writer->frame_cache->count = 0;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /* Allocate the DWARF CIE cache. The cache is optional; unwinding will proceed without it. */
+    if (plframe_dwarf_cie_cache_new(&writer->dwarf_cie_cache) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Could not allocate the DWARF CIE cache");
+        writer->dwarf_cie_cache = NULL;
+    }
+#endif
+
+    /* Apply the default parser work limits */
+    plcrash_async_work_budget_init(&writer->work_budget);
+
+    /* Include the shared debug trace by default */
+    writer->trace = plcrash_async_trace_shared_ring();
+
+    /* Fetch the timebase used to convert crash-time metrics; mach_timebase_info() is not async-safe. */
+    if (mach_timebase_info(&writer->timebase) != KERN_SUCCESS) {
+        PLCF_DEBUG("Could not fetch the mach timebase");
+        writer->timebase.numer = 0;
+        writer->timebase.denom = 0;
+    }
+
+    /* Default to false */
+    writer->report_info.user_requested = user_requested;
+
+    /* Generate a UUID for this incident */
+    plcrash_writer_generate_uuid(writer);
+
+    /* Fetch the application information */
+    {
+        writer->application_info.app_identifier = strdup([app_identifier UTF8String]);
+        writer->application_info.app_version = strdup([app_version UTF8String]);
+    }
+    
+    /* Fetch the process information */
+    {
+        /* Current process */
+        PLCrashProcessInfo *pinfo = [PLCrashProcessInfo currentProcessInfo];
+        if (pinfo == nil) {
+            /* Should only occur if the process is no longer valid */
+            PLCF_DEBUG("Could not retreive process info for target");
+            return PLCRASH_EINVAL;
         }
 
         {
@@ -463,6 +1208,9 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
 #error Unsupported Platform
 #endif
 
+    /* Pre-encode the static report messages */
+    plcrash_writer_encode_static_header(writer);
+
     /* Ensure that any signal handler has a consistent view of the above initialization. */
     OSMemoryBarrier();
 
@@ -470,162 +1218,3930 @@ plcrash_error_t plcrash_log_writer_init (plcrash_log_writer_t *writer,
 }
 
 /**
- * Set the uncaught exception for this writer. Once set, this exception will be used to
- * provide exception data for the crash log output.
+ * Describe the process @a pid, rather than the current process, in the report's process info. This must be
+ * configured when writing a report for another task via plcrash_log_writer_write_task().
+ *
+ * @param writer The writer to be configured.
+ * @param pid The process ID of the target task.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if the process info for @a pid could not be
+ * retrieved, in which case the writer's process info is left unmodified.
  *
  * @warning This function is not async safe, and must be called outside of a signal handler.
  */
-void plcrash_log_writer_set_exception (plcrash_log_writer_t *writer, NSException *exception) {
-    assert(writer->uncaught_exception.has_exception == false);
+plcrash_error_t plcrash_log_writer_set_target_process (plcrash_log_writer_t *writer, pid_t pid) {
+    PLCrashProcessInfo *pinfo = [[[PLCrashProcessInfo alloc] initWithProcessID: pid] autorelease];
+    if (pinfo == nil) {
+        PLCF_DEBUG("Could not retreive process info for pid %d", pid);
+        return PLCRASH_EINVAL;
+    }
 
-    /* Save the exception data */
-    writer->uncaught_exception.has_exception = true;
-    writer->uncaught_exception.name = strdup([[exception name] UTF8String]);
-    writer->uncaught_exception.reason = strdup([[exception reason] UTF8String]);
+    if (writer->process_info.process_name != NULL)
+        free(writer->process_info.process_name);
+    if (writer->process_info.process_path != NULL)
+        free(writer->process_info.process_path);
+    if (writer->process_info.parent_process_name != NULL)
+        free(writer->process_info.parent_process_name);
 
-    /* Save the call stack, if available */
-    NSArray *callStackArray = [exception callStackReturnAddresses];
-#if TARGET_OS_MAC && !TARGET_OS_IPHONE && !TARGET_IPHONE_SIMULATOR
-    if (!callStackArray) {
-        NSArray *frames = [[[exception userInfo] objectForKey:NSStackTraceKey] componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
-        callStackArray = [[NSMutableArray alloc] initWithCapacity:[frames count]];
-        for (NSString *frame in frames) {
-            long address = strtol([frame cStringUsingEncoding:NSASCIIStringEncoding], NULL, 16);
-            [(NSMutableArray *)callStackArray addObject:[NSNumber numberWithLong:address]];
+    writer->process_info.process_id = pinfo.processID;
+    writer->process_info.process_name = strdup([pinfo.processName UTF8String]);
+    writer->process_info.start_time = pinfo.startTime.tv_sec;
+    writer->process_info.process_path = NULL;
+    writer->process_info.parent_process_id = pinfo.parentProcessID;
+    writer->process_info.parent_process_name = NULL;
+
+    /* The executable path leads the target's KERN_PROCARGS2 argument area, following the argument count */
+    {
+        int mib[3] = { CTL_KERN, KERN_PROCARGS2, pid };
+        size_t length = 0;
+        char *args = NULL;
+
+        if (sysctl(mib, 3, NULL, &length, NULL, 0) == 0 && length > sizeof(int) && (args = malloc(length)) != NULL) {
+            if (sysctl(mib, 3, args, &length, NULL, 0) == 0 && length > sizeof(int))
+                writer->process_info.process_path = strndup(args + sizeof(int), length - sizeof(int));
+            free(args);
         }
+
+        if (writer->process_info.process_path == NULL)
+            PLCF_DEBUG("Could not retreive the executable path for pid %d: %s", pid, strerror(errno));
     }
-#endif
-    if (callStackArray != nil && [callStackArray count] > 0) {
-        size_t count = [callStackArray count];
-        writer->uncaught_exception.callstack_count = count;
-        writer->uncaught_exception.callstack = malloc(sizeof(void *) * count);
 
-        size_t i = 0;
-        for (NSNumber *num in callStackArray) {
-            assert(i < count);
-            writer->uncaught_exception.callstack[i] = (void *)(uintptr_t)[num unsignedLongLongValue];
-            i++;
-        }
+    PLCrashProcessInfo *parentInfo = [[[PLCrashProcessInfo alloc] initWithProcessID: pinfo.parentProcessID] autorelease];
+    if (parentInfo != nil) {
+        writer->process_info.parent_process_name = strdup([parentInfo.processName UTF8String]);
+    } else {
+        PLCF_DEBUG("Could not retreive parent process name: %s", strerror(errno));
     }
 
-    writer->uncaught_exception.user_info_size = [[exception userInfo] count];
-    writer->uncaught_exception.user_info = malloc(sizeof(user_info_t) * [[exception userInfo] count]);
-    uint64_t index = 0;
-    for (NSString *key in [exception userInfo]) {
-        id object = [[exception userInfo] objectForKey:key];
-        writer->uncaught_exception.user_info[index].key = strdup([key UTF8String]);
-        if ([object conformsToProtocol:@protocol(NSCoding)]) {
-            NSMutableData *encoded = [[NSMutableData alloc] init];
-            NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:encoded];
-            [archiver setOutputFormat:NSPropertyListXMLFormat_v1_0];
-            [archiver encodeRootObject:object];
-            [archiver finishEncoding];
-            [archiver release];
-            NSString *string = [[NSString alloc] initWithData:encoded encoding:NSUTF8StringEncoding];
-            [encoded release];
-            writer->uncaught_exception.user_info[index].serialized = strdup([string UTF8String]);
-            [string release];
-        } else
-            writer->uncaught_exception.user_info[index].serialized = strdup([[object description] UTF8String]);
+    /* Determine whether the target is translated, rather than whether the current process is */
+#ifdef P_TRANSLATED
+    {
+        int mib[4] = { CTL_KERN, KERN_PROC, KERN_PROC_PID, pid };
+        struct kinfo_proc info;
+        size_t length = sizeof(info);
 
-        index++;
+        if (sysctl(mib, 4, &info, &length, NULL, 0) == 0 && length == sizeof(info))
+            writer->process_info.native = (info.kp_proc.p_flag & P_TRANSLATED) == 0;
+    }
+#endif
+
+    /* Re-encode the static report messages */
+    if (writer->static_header.data != NULL) {
+        free(writer->static_header.data);
+        writer->static_header.data = NULL;
     }
+    plcrash_writer_encode_static_header(writer);
 
     /* Ensure that any signal handler has a consistent view of the above initialization. */
     OSMemoryBarrier();
-}
 
-/**
- * Close the plcrash_writer_t output.
- *
- * @param writer Writer instance to be closed.
- */
-plcrash_error_t plcrash_log_writer_close (plcrash_log_writer_t *writer) {
     return PLCRASH_ESUCCESS;
 }
 
 /**
- * Free any crash log writer resources.
+ * Move the writer's pre-allocated frame and DWARF CIE caches into @a allocator, a pre-reserved and guarded crash-time
+ * memory region. Any memory allocated from @a allocator while writing a report will be released once the report
+ * has been written.
  *
- * @warning This method is not async safe.
+ * @param writer The writer to be configured.
+ * @param allocator The allocator from which the writer's caches will be allocated. The allocator must remain valid
+ * for the lifetime of @a writer, and must not be reset by any other user.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if @a allocator has insufficient space,
+ * in which case the writer's existing caches will continue to be used.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
  */
-void plcrash_log_writer_free (plcrash_log_writer_t *writer) {
-    /* Free the app info */
-    if (writer->application_info.app_identifier != NULL)
-        free(writer->application_info.app_identifier);
-    if (writer->application_info.app_version != NULL)
-        free(writer->application_info.app_version);
+plcrash_error_t plcrash_log_writer_set_allocator (plcrash_log_writer_t *writer, plcrash_async_allocator_t *allocator) {
+    PLCF_ASSERT(writer->allocator == NULL);
 
-    /* Free the process info */
-    if (writer->process_info.process_name != NULL) 
-        free(writer->process_info.process_name);
-    if (writer->process_info.process_path != NULL) 
-        free(writer->process_info.process_path);
-    if (writer->process_info.parent_process_name != NULL) 
-        free(writer->process_info.parent_process_name);
-    
-    /* Free the system info */
-    if (writer->system_info.version != NULL)
-        free(writer->system_info.version);
-    
-    if (writer->system_info.build != NULL)
-        free(writer->system_info.build);
-    
-    /* Free the machine info */
-    if (writer->machine_info.model != NULL)
-        free(writer->machine_info.model);
+    struct plcrash_log_writer_frame_cache *frame_cache = plcrash_async_allocator_alloc(allocator, sizeof(*frame_cache), true);
+    if (frame_cache == NULL) {
+        PLCF_DEBUG("Insufficient crash-time memory for the frame cache");
+        return PLCRASH_ENOMEM;
+    }
+    frame_cache->count = 0;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    plframe_dwarf_cie_cache_t *dwarf_cie_cache = NULL;
+    if (plframe_dwarf_cie_cache_new_with_allocator(allocator, &dwarf_cie_cache) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Insufficient crash-time memory for the DWARF CIE cache");
+        plcrash_async_allocator_free(allocator, frame_cache);
+        return PLCRASH_ENOMEM;
+    }
 
-    /* Free the exception data */
-    if (writer->uncaught_exception.has_exception) {
-        if (writer->uncaught_exception.name != NULL)
-            free(writer->uncaught_exception.name);
+    if (writer->dwarf_cie_cache != NULL)
+        plframe_dwarf_cie_cache_free(writer->dwarf_cie_cache);
+    writer->dwarf_cie_cache = dwarf_cie_cache;
+#endif
 
-        if (writer->uncaught_exception.reason != NULL)
-            free(writer->uncaught_exception.reason);
-        
-        if (writer->uncaught_exception.callstack != NULL)
-            free(writer->uncaught_exception.callstack);
+    if (writer->frame_cache != NULL)
+        free(writer->frame_cache);
+    writer->frame_cache = frame_cache;
 
-        if (writer->uncaught_exception.user_info != NULL) {
-            for (uint64_t i=0; i!=writer->uncaught_exception.user_info_size; i++) {
-                if (writer->uncaught_exception.user_info[i].key != NULL)
-                    free(writer->uncaught_exception.user_info[i].key);
-                if (writer->uncaught_exception.user_info[i].serialized != NULL)
-                    free(writer->uncaught_exception.user_info[i].serialized);
-            }
-            free(writer->uncaught_exception.user_info);
-        }
-    }
+    plcrash_async_allocator_mark(allocator, &writer->allocator_mark);
+    writer->allocator = allocator;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
 }
 
 /**
- * @internal
+ * Set the report file version to be written. By default, PLCRASH_REPORT_FILE_VERSION reports are written.
  *
- * Write the system info message.
+ * Compact (PLCRASH_REPORT_FILE_VERSION_COMPACT) reports encode each stack frame as the index of its containing
+ * image and a delta-encoded image-relative offset, rather than as an absolute PC, and write each unique image
+ * directory path once, in a shared string table. Threads whose backtraces are identical to that of an earlier thread
+ * are written as a reference to the earlier thread, and are not symbolicated. Thread registers are written as a typed
+ * per-architecture register state, rather than as a list of named register values. Compact reports are smaller, and faster
+ * to write, but may not be read by decoders that predate PLCRASH_REPORT_FILE_VERSION_COMPACT.
  *
- * @param file Output file
- * @param timestamp Timestamp to use (seconds since epoch). Must be same across calls, as varint encoding.
- */
+ * @param writer The writer to be configured.
+ * @param file_version The file version; one of PLCRASH_REPORT_FILE_VERSION or PLCRASH_REPORT_FILE_VERSION_COMPACT.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTSUP if @a file_version is not supported, or PLCRASH_ENOMEM
+ * if the compact encoding's string or stack tables could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_file_version (plcrash_log_writer_t *writer, uint8_t file_version) {
+    if (file_version != PLCRASH_REPORT_FILE_VERSION && file_version != PLCRASH_REPORT_FILE_VERSION_COMPACT)
+        return PLCRASH_ENOTSUP;
+
+    /* Allocate the string and stack tables; allocation is not permitted at crash time. */
+    if (file_version == PLCRASH_REPORT_FILE_VERSION_COMPACT && writer->string_table == NULL) {
+        writer->string_table = malloc(sizeof(*writer->string_table));
+        if (writer->string_table == NULL) {
+            PLCF_DEBUG("Could not allocate the string table");
+            return PLCRASH_ENOMEM;
+        }
+        writer->string_table->count = 0;
+    }
+
+    if (file_version == PLCRASH_REPORT_FILE_VERSION_COMPACT && writer->stack_table == NULL) {
+        writer->stack_table = malloc(sizeof(*writer->stack_table));
+        if (writer->stack_table == NULL) {
+            PLCF_DEBUG("Could not allocate the stack table");
+            return PLCRASH_ENOMEM;
+        }
+        writer->stack_table->count = 0;
+    }
+
+    writer->file_version = file_version;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ * Set the binary image output options. By default, all loaded binary images are written.
+ *
+ * With PLCRASH_LOG_WRITER_IMAGES_ELIDE_SHARED_CACHE, images loaded from the dyld shared cache are omitted, and the
+ * shared cache's UUID and slide are written instead. These images are identical across all crashes on a given OS
+ * build, and typically account for the majority of a report's binary images. If the target task's shared cache can
+ * not be determined at crash time, all images are written.
+ *
+ * With PLCRASH_LOG_WRITER_IMAGES_REFERENCED_ONLY, only the images referenced by a captured stack frame, the uncaught
+ * exception's callstack, or a register value of the crashed thread are written. Typical applications load hundreds
+ * of images that are not referenced by any frame.
+ *
+ * @param writer The writer to be configured.
+ * @param image_options A bitwise OR of plcrash_log_writer_image_options_t values.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the writer's image map could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_image_options (plcrash_log_writer_t *writer, uint32_t image_options) {
+    /* Allocate the image map; allocation is not permitted at crash time. */
+    if (image_options != PLCRASH_LOG_WRITER_IMAGES_ALL && writer->image_map == NULL) {
+        writer->image_map = malloc(sizeof(*writer->image_map));
+        if (writer->image_map == NULL) {
+            PLCF_DEBUG("Could not allocate the image map");
+            return PLCRASH_ENOMEM;
+        }
+        writer->image_map->count = 0;
+    }
+
+    writer->image_options = image_options;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ * Set the thread capture policy. By default, threads are captured in task_threads() order, with no per-thread frame
+ * limit beyond the writer's maximum, and no time or size budget.
+ *
+ * Once the time elapsed since the start of the report exceeds the policy's @a time_budget, or the report's size
+ * exceeds its @a size_budget, all remaining threads other than the crashed thread are omitted from the report.
+ * Capture is stopped between threads, and the report remains valid. With PLCRASH_LOG_WRITER_THREAD_ORDER_CRASHED_FIRST,
+ * the crashed and main threads are captured before the budget can be exhausted by other threads.
+ *
+ * The @a time_budget additionally defines a deadline for the report as a whole. Once the deadline has passed,
+ * symbolication is skipped, the walk of any thread other than the crashed thread is stopped, and if frames are
+ * written with absolute PCs, the remaining binary images are omitted. Any report so truncated is marked via
+ * CrashReport.report_info.truncated.
+ *
+ * If the policy's @a tail_frames is non-zero, a stack exceeding its frame limit is walked to its end, and its
+ * outermost @a tail_frames frames are written following the innermost frames; the frames in between are neither
+ * symbolicated nor written, and their number is recorded via CrashReport.thread.frame.omitted_count.
+ *
+ * @param writer The writer to be configured.
+ * @param policy The capture policy. The policy is copied, and need not remain valid after this call.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_capture_policy (plcrash_log_writer_t *writer, const plcrash_log_writer_capture_policy_t *policy) {
+    writer->capture_policy = *policy;
+    if (writer->capture_policy.max_thread_frames > MAX_THREAD_FRAMES)
+        writer->capture_policy.max_thread_frames = MAX_THREAD_FRAMES;
+
+    /* Convert the time budget to mach_absolute_time() units; the conversion is not async-safe. */
+    if (writer->timebase.numer == 0) {
+        writer->capture_time_budget = policy->time_budget;
+    } else {
+        writer->capture_time_budget = policy->time_budget * writer->timebase.denom / writer->timebase.numer;
+        if (writer->capture_time_budget == 0 && policy->time_budget != 0)
+            writer->capture_time_budget = 1;
+    }
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Enable or disable thread snapshotting. By default, all threads remain suspended while their stacks are walked,
+ * symbolicated, and written. When snapshotting is enabled, each thread's register state and a copy-on-write mapping
+ * of the stack window surrounding its stack pointer (see PLFRAME_CURSOR_STACK_WINDOW_SIZE) are captured while the
+ * threads are suspended, after which the threads are immediately resumed; their stacks are then walked against the
+ * snapshots. This bounds the time for which the target threads are stalled to the cost of fetching their state.
+ *
+ * Stack reads that fall outside of a thread's snapshotted window are served from the thread's live stack, and
+ * may be inconsistent with the snapshot if the thread has since modified its stack.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, threads will be snapshotted.
+ *
+ * @warning Snapshotting allocates memory when writing a report, and must only be enabled for writers that are used
+ * outside of a signal handler, such as those used to write live reports. This function is not async safe.
+ */
+void plcrash_log_writer_set_snapshot_threads (plcrash_log_writer_t *writer, bool enable) {
+    writer->snapshot_threads = enable;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Enable or disable use of the image list's persistent section cache (see
+ * plcrash_nasync_image_list_acquire_unwind_cache()) when unwinding the report's threads. The persistent cache
+ * retains section mappings and parsed CIEs across reports; if it is in use by another thread, a cache local to
+ * the report is used instead.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, the persistent cache will be used.
+ *
+ * @warning Acquiring the persistent cache is not async safe, and must only be enabled for writers that are used
+ * outside of a signal handler, such as those used to write live reports. This function is not async safe.
+ */
+void plcrash_log_writer_set_persistent_unwind (plcrash_log_writer_t *writer, bool enable) {
+    writer->persistent_unwind = enable;
+}
+
+/**
+ * @internal
+ *
+ * Serializes the thread suspension windows of reentrant writers; see plcrash_log_writer_set_reentrant().
+ */
+static pthread_mutex_t plcrash_writer_suspend_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Enable or disable reentrant report writing. Any number of reentrant writers may write reports concurrently from
+ * different threads; each writer must still only be used by a single thread at a time.
+ *
+ * Writers suspend all other threads of the target task, which includes any other thread that is concurrently
+ * writing a report. To prevent two writers from suspending each other, the window during which a reentrant writer
+ * holds the target's threads suspended is serialized with that of all other reentrant writers; if threads are
+ * snapshotted (see plcrash_log_writer_set_snapshot_threads()), this window covers only the snapshot, and the
+ * remainder of each report is written concurrently. A shared worker pool (see plcrash_log_writer_set_workers())
+ * that is busy with another writer's report is not waited upon; the threads are instead captured serially.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, the writer may be used concurrently with other reentrant writers.
+ *
+ * @warning Reentrant writers acquire a pthread mutex when writing a report, and must only be enabled for writers that
+ * are used outside of a signal handler, such as those used to write live reports. This function is not async safe.
+ */
+void plcrash_log_writer_set_reentrant (plcrash_log_writer_t *writer, bool enable) {
+    writer->reentrant = enable;
+}
+
+/**
+ * Enable or disable raw stack capture. When enabled, thread stacks are not walked at crash time; instead, the register
+ * state of every thread is written, along with up to @a size bytes of raw stack memory starting just below each
+ * thread's stack pointer (CrashReport.thread.stack_memory). Combined with the report's binary image base addresses
+ * and UUIDs, this is sufficient to unwind the threads offline, and allows the threads to be re-unwound should better
+ * unwind data become available.
+ *
+ * Crash-time work is reduced to fetching the thread state and mapping and copying each stack window. No frames
+ * are written for any thread, and the written report must be large enough to hold all captured stacks.
+ *
+ * @param writer The writer to be configured.
+ * @param size The maximum number of bytes of stack memory to capture for each thread, or 0 to disable raw stack
+ * capture. Sizes larger than PLFRAME_CURSOR_STACK_WINDOW_SIZE will be clamped.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_raw_stack_size (plcrash_log_writer_t *writer, size_t size) {
+    if (size > PLFRAME_CURSOR_STACK_WINDOW_SIZE)
+        size = PLFRAME_CURSOR_STACK_WINDOW_SIZE;
+
+    writer->raw_stack_size = size;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Enable or disable per-thread scheduling state capture. When enabled, each written thread's CPU time and usage, run
+ * state, sleep time, scheduling priorities, name, and QoS class (CrashReport.thread.scheduling) are fetched via
+ * thread_info() in a single pass over the task's threads before they are suspended. This allows the threads that were
+ * running at the time of a hang or CPU usage report to be identified.
+ *
+ * The state of at most PLCRASH_WRITER_THREAD_INFO_MAX threads is captured; any further threads are written without
+ * their scheduling state.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, thread scheduling state will be captured.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the thread info table could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_thread_info (plcrash_log_writer_t *writer, bool enable) {
+    struct plcrash_log_writer_thread_info_table *table = NULL;
+
+    /* Allocate the thread info table; allocation is not permitted at crash time. */
+    if (enable) {
+        if (writer->thread_info != NULL)
+            return PLCRASH_ESUCCESS;
+
+        table = malloc(sizeof(*table));
+        if (table == NULL) {
+            PLCF_DEBUG("Could not allocate the thread info table");
+            return PLCRASH_ENOMEM;
+        }
+        table->count = 0;
+    }
+
+    struct plcrash_log_writer_thread_info_table *previous = writer->thread_info;
+    writer->thread_info = table;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    if (previous != NULL)
+        free(previous);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Enable or disable the unwind cache. When enabled, the key of each thread -- its instruction pointer, stack pointer,
+ * and a hash of the memory at its stack pointer -- is computed while the thread is suspended, and the thread's
+ * symbolicated frames are retained once written. A thread with an identical key in the following report is assumed
+ * not to have run in the interim, and its retained frames are written without walking or symbolicating its stack.
+ *
+ * This reduces the cost of repeated live reports, such as those written by the hang detector, to that of the threads
+ * that have run since the last report. The crashed thread is always walked in full.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, the unwind cache will be allocated and used.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_unwind_cache (plcrash_log_writer_t *writer, bool enable) {
+    struct plcrash_log_writer_unwind_cache *cache = NULL;
+
+    /* Allocate the cache; allocation is not permitted at crash time. */
+    if (enable) {
+        if (writer->unwind_cache != NULL)
+            return PLCRASH_ESUCCESS;
+
+        cache = malloc(sizeof(*cache));
+        if (cache == NULL) {
+            PLCF_DEBUG("Could not allocate the unwind cache");
+            return PLCRASH_ENOMEM;
+        }
+        cache->current = 0;
+        cache->generations[0].count = 0;
+        cache->generations[0].frame_count = 0;
+        cache->generations[1].count = 0;
+        cache->generations[1].frame_count = 0;
+    }
+
+    struct plcrash_log_writer_unwind_cache *previous = writer->unwind_cache;
+    writer->unwind_cache = cache;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    if (previous != NULL)
+        free(previous);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Enable or disable the memory usage summary. When enabled, each report includes the target task's physical
+ * footprint, resident and compressed sizes, and the sizes of its VM regions totalled by user tag (eg, the malloc
+ * zones, IOKit, and mapped images) in CrashReport.memory. Reports for terminations caused by memory pressure may
+ * then be correlated with the regions responsible.
+ *
+ * The summary is populated at crash time, after the target threads have been suspended, and at most
+ * PLCRASH_ASYNC_VM_SUMMARY_MAX_REGIONS regions are visited.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, a memory usage summary will be written.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the summary could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_memory_summary (plcrash_log_writer_t *writer, bool enable) {
+    plcrash_async_vm_summary_t *summary = NULL;
+
+    /* Allocate the summary; allocation is not permitted at crash time. */
+    if (enable) {
+        if (writer->vm_summary != NULL)
+            return PLCRASH_ESUCCESS;
+
+        summary = malloc(sizeof(*summary));
+        if (summary == NULL) {
+            PLCF_DEBUG("Could not allocate the memory usage summary");
+            return PLCRASH_ENOMEM;
+        }
+    }
+
+    plcrash_async_vm_summary_t *previous = writer->vm_summary;
+    writer->vm_summary = summary;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    if (previous != NULL)
+        free(previous);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Set the breadcrumb buffer to be copied into each report written by @a writer. The buffer's record slots are written
+ * verbatim (CrashReport.breadcrumbs), without locking; records being appended at the time of the crash are discarded
+ * by the decoder.
+ *
+ * @param writer The writer to be configured.
+ * @param breadcrumbs The breadcrumb buffer, or NULL to disable breadcrumb capture. The buffer is borrowed, and must
+ * remain valid for the lifetime of @a writer.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_breadcrumbs (plcrash_log_writer_t *writer, plcrash_async_breadcrumb_buffer_t *breadcrumbs) {
+    writer->breadcrumbs = breadcrumbs;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Set the registry of application memory regions to be copied into each report written by @a writer. Each region
+ * registered at the time of the crash is copied verbatim (CrashReport.user_regions) with a single bounded
+ * plcrash_async_task_memcpy(); no encoding or callback is performed at crash time. Regions are only written to
+ * reports of the current task.
+ *
+ * @param writer The writer to be configured.
+ * @param regions The registry, or NULL to disable user region capture. The registry is borrowed, and must remain
+ * valid for the lifetime of @a writer.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the copy buffer could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_user_regions (plcrash_log_writer_t *writer, plcrash_async_user_regions_t *regions) {
+    /* Allocate the copy buffer; allocation is not permitted at crash time. */
+    if (regions != NULL && writer->user_region_buffer == NULL) {
+        writer->user_region_buffer = malloc(PLCRASH_ASYNC_USER_REGION_LENGTH_MAX);
+        if (writer->user_region_buffer == NULL) {
+            PLCF_DEBUG("Could not allocate the user region buffer");
+            return PLCRASH_ENOMEM;
+        }
+
+        OSMemoryBarrier();
+    }
+
+    writer->user_regions = regions;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Set the trace ring to be copied into each report written by @a writer. The ring's records are written verbatim
+ * (CrashReport.debug_trace), without locking, after all other report data other than the checksum; events recorded
+ * while the ring is being copied may be discarded by the decoder.
+ *
+ * @param writer The writer to be configured.
+ * @param trace The trace ring, or NULL to disable trace capture. The ring is borrowed, and must remain valid for the
+ * lifetime of @a writer.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_trace (plcrash_log_writer_t *writer, plcrash_async_trace_ring_t *trace) {
+    writer->trace = trace;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Set the hang details (CrashReport.hang) to be written to reports produced by @a writer. This is intended for use
+ * with live reports generated in response to an unresponsive thread; see PLCrashHangDetector.
+ *
+ * @param writer The writer to be configured.
+ * @param hang The hang details, or NULL to clear any previously set details. The details are borrowed, and must
+ * remain valid until they are cleared, or @a writer is freed.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_hang (plcrash_log_writer_t *writer, const plcrash_log_writer_hang_info_t *hang) {
+    writer->hang = hang;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Set the termination details (CrashReport.termination) to be written to reports produced by @a writer. This is
+ * intended for use when synthesizing a report for a previous session that was terminated without writing a crash
+ * report; such reports are written for the current thread with no thread state, and thus contain no threads or
+ * binary images.
+ *
+ * @param writer The writer to be configured.
+ * @param termination The termination details, or NULL to clear any previously set details. The details are borrowed,
+ * and must remain valid until they are cleared, or @a writer is freed.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_termination (plcrash_log_writer_t *writer, const plcrash_log_writer_termination_info_t *termination) {
+    writer->termination = termination;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Enable or disable report compression. When enabled, reports written to mapped or memory output
+ * (see plcrash_async_file_init_mapped()) are LZ4 compressed in place once complete, and are marked with
+ * PLCRASH_REPORT_FILE_FLAG_COMPRESSED. Reports written via buffered output, reports larger than @a max_report_size,
+ * and reports that do not compress are written uncompressed.
+ *
+ * @param writer The writer to be configured.
+ * @param max_report_size The largest (uncompressed) report size that may be compressed, or 0 to disable
+ * compression. The compressor's output buffer is pre-allocated based on this size.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the compressor could not be allocated, in which
+ * case compression is disabled.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_compression (plcrash_log_writer_t *writer, size_t max_report_size) {
+    struct plcrash_log_writer_compressor *compressor = NULL;
+
+    if (max_report_size > 0) {
+        size_t output_size = plcrash_async_lz4_bound(max_report_size) + sizeof(uint32_t);
+        compressor = malloc(sizeof(*compressor) + output_size);
+        if (compressor == NULL)
+            PLCF_DEBUG("Could not allocate the report compressor");
+        else
+            compressor->output_size = output_size;
+    }
+
+    struct plcrash_log_writer_compressor *previous = writer->compressor;
+    writer->compressor = compressor;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    if (previous != NULL)
+        free(previous);
+
+    if (max_report_size > 0 && compressor == NULL)
+        return PLCRASH_ENOMEM;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Enable or disable the report footer. When enabled, reports are marked with PLCRASH_REPORT_FILE_FLAG_FOOTER, and
+ * are terminated with a footer listing the offset and length of each top-level section of the report message, and of
+ * the crashed thread's record (see plcrash_report_reader_read_footer()). Tools that require only a few of a report's
+ * records, such as the crashed thread or the signal, may then seek directly to those records, rather than scanning the
+ * report's top-level fields. The footer follows any compressed output.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, reports will be written with a footer.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_footer (plcrash_log_writer_t *writer, bool enable) {
+    writer->footer = enable;
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Enable or disable the local readable region map. When enabled, and the report is written for the current task,
+ * the task's readable regions are enumerated once the task's threads have been suspended; while the threads remain
+ * suspended, target memory reads that fall entirely within a readable region are performed via a plain memcpy(),
+ * rather than a Mach trap per read. See plcrash_async_memory_region_map_build().
+ *
+ * The map is released once the threads are resumed; if threads are snapshotted and resumed early (see
+ * plcrash_log_writer_set_snapshot_threads()), only the snapshot phase benefits from the map.
+ *
+ * @param writer The writer to be configured.
+ * @param enable If true, the region map will be used.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the region map could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_local_region_map (plcrash_log_writer_t *writer, bool enable) {
+    /* Allocate the region map; allocation is not permitted at crash time. */
+    if (enable && writer->region_map == NULL) {
+        plcrash_async_memory_region_map_t *map = malloc(sizeof(*map));
+        if (map == NULL || plcrash_nasync_memory_region_map_init(map, PLCRASH_ASYNC_MEMORY_REGION_MAP_CAPACITY) != PLCRASH_ESUCCESS) {
+            PLCF_DEBUG("Could not allocate the region map");
+            free(map);
+            return PLCRASH_ENOMEM;
+        }
+
+        writer->region_map = map;
+    } else if (!enable && writer->region_map != NULL) {
+        plcrash_nasync_memory_region_map_free(writer->region_map);
+        free(writer->region_map);
+        writer->region_map = NULL;
+    }
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Reserve or release the buffers into which plcrash_log_writer_set_exception() copies an uncaught exception's name,
+ * reason and call stack. When reserved, setting the exception performs no heap allocation for these fields; names
+ * and reasons longer than PLCRASH_WRITER_EXCEPTION_NAME_MAX and PLCRASH_WRITER_EXCEPTION_REASON_MAX bytes are
+ * truncated, and at most MAX_THREAD_FRAMES call stack frames are retained.
+ *
+ * @param writer The writer to be configured. The writer must not have an uncaught exception set.
+ * @param enable If true, the exception buffers will be reserved.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the buffers could not be allocated.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+plcrash_error_t plcrash_log_writer_set_exception_buffers (plcrash_log_writer_t *writer, bool enable) {
+    PLCF_ASSERT(writer->uncaught_exception.has_exception == false);
+
+    /* Allocate the buffers; the uncaught exception handler runs in a process that is about to terminate. */
+    if (enable && writer->exception_buffers == NULL) {
+        struct plcrash_log_writer_exception_buffers *buffers = malloc(sizeof(*buffers));
+        if (buffers == NULL) {
+            PLCF_DEBUG("Could not allocate the exception buffers");
+            return PLCRASH_ENOMEM;
+        }
+
+        writer->exception_buffers = buffers;
+    } else if (!enable && writer->exception_buffers != NULL) {
+        free(writer->exception_buffers);
+        writer->exception_buffers = NULL;
+    }
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Copy the UTF-8 representation of @a string into @a buffer, truncating at a character boundary if required. No
+ * intermediate C string is created.
+ *
+ * @param string The string to copy, or nil.
+ * @param buffer The destination buffer.
+ * @param size The size of @a buffer, in bytes. Must be non-zero.
+ *
+ * @return Returns @a buffer, or NULL if @a string is nil.
+ */
+static char *plcrash_writer_copy_string (NSString *string, char *buffer, size_t size) {
+    NSUInteger used = 0;
+
+    if (string == nil)
+        return NULL;
+
+    [string getBytes: buffer maxLength: size - 1 usedLength: &used encoding: NSUTF8StringEncoding options: 0 range: NSMakeRange(0, [string length]) remainingRange: NULL];
+    buffer[used] = '\0';
+    return buffer;
+}
+
+/**
+ * Set the uncaught exception for this writer. Once set, this exception will be used to
+ * provide exception data for the crash log output.
+ *
+ * If buffers have been reserved via plcrash_log_writer_set_exception_buffers(), the exception's name, reason and
+ * call stack are copied into the reserved buffers without heap allocation by the writer.
+ *
+ * @warning This function is not async safe, and must be called outside of a signal handler.
+ */
+void plcrash_log_writer_set_exception (plcrash_log_writer_t *writer, NSException *exception) {
+    struct plcrash_log_writer_exception_buffers *buffers = writer->exception_buffers;
+    assert(writer->uncaught_exception.has_exception == false);
+
+    /* Save the exception data */
+    writer->uncaught_exception.has_exception = true;
+    writer->uncaught_exception.buffered = (buffers != NULL);
+    if (buffers != NULL) {
+        writer->uncaught_exception.name = plcrash_writer_copy_string([exception name], buffers->name, sizeof(buffers->name));
+        writer->uncaught_exception.reason = plcrash_writer_copy_string([exception reason], buffers->reason, sizeof(buffers->reason));
+    } else {
+        writer->uncaught_exception.name = strdup([[exception name] UTF8String]);
+        writer->uncaught_exception.reason = strdup([[exception reason] UTF8String]);
+    }
+    writer->uncaught_exception.name_length = plcrash_writer_strlen(writer->uncaught_exception.name);
+    writer->uncaught_exception.reason_length = plcrash_writer_strlen(writer->uncaught_exception.reason);
+
+    /* Save the call stack, if available */
+    NSArray *callStackArray = [exception callStackReturnAddresses];
+#if TARGET_OS_MAC && !TARGET_OS_IPHONE && !TARGET_IPHONE_SIMULATOR
+    if (!callStackArray && buffers != NULL) {
+        /* Parse the stack trace directly into the reserved call stack, without boxing each address */
+        NSString *trace = [[exception userInfo] objectForKey:NSStackTraceKey];
+        const char *cursor = [trace cStringUsingEncoding:NSASCIIStringEncoding];
+        size_t count = 0;
+
+        while (cursor != NULL && *cursor != '\0' && count < MAX_THREAD_FRAMES) {
+            char *end;
+            unsigned long long address = strtoull(cursor, &end, 16);
+            if (end == cursor) {
+                cursor++;
+                continue;
+            }
+
+            buffers->callstack[count++] = (void *)(uintptr_t) address;
+            cursor = end;
+        }
+
+        if (count > 0) {
+            writer->uncaught_exception.callstack = buffers->callstack;
+            writer->uncaught_exception.callstack_count = count;
+        }
+    } else if (!callStackArray) {
+        NSArray *frames = [[[exception userInfo] objectForKey:NSStackTraceKey] componentsSeparatedByCharactersInSet:[NSCharacterSet whitespaceCharacterSet]];
+        callStackArray = [[NSMutableArray alloc] initWithCapacity:[frames count]];
+        for (NSString *frame in frames) {
+            long address = strtol([frame cStringUsingEncoding:NSASCIIStringEncoding], NULL, 16);
+            [(NSMutableArray *)callStackArray addObject:[NSNumber numberWithLong:address]];
+        }
+    }
+#endif
+    if (callStackArray != nil && [callStackArray count] > 0 && buffers != NULL) {
+        /* Unbox the return addresses directly into the reserved call stack */
+        size_t count = MIN((size_t) [callStackArray count], (size_t) MAX_THREAD_FRAMES);
+        CFArrayRef array = (CFArrayRef) callStackArray;
+
+        for (size_t i = 0; i < count; i++) {
+            unsigned long long address = 0;
+            CFNumberGetValue((CFNumberRef) CFArrayGetValueAtIndex(array, i), kCFNumberLongLongType, &address);
+            buffers->callstack[i] = (void *)(uintptr_t) address;
+        }
+
+        writer->uncaught_exception.callstack = buffers->callstack;
+        writer->uncaught_exception.callstack_count = count;
+    } else if (callStackArray != nil && [callStackArray count] > 0) {
+        size_t count = [callStackArray count];
+        writer->uncaught_exception.callstack_count = count;
+        writer->uncaught_exception.callstack = malloc(sizeof(void *) * count);
+
+        size_t i = 0;
+        for (NSNumber *num in callStackArray) {
+            assert(i < count);
+            writer->uncaught_exception.callstack[i] = (void *)(uintptr_t)[num unsignedLongLongValue];
+            i++;
+        }
+    }
+
+    writer->uncaught_exception.user_info_size = [[exception userInfo] count];
+    writer->uncaught_exception.user_info = malloc(sizeof(user_info_t) * [[exception userInfo] count]);
+    uint64_t index = 0;
+    for (NSString *key in [exception userInfo]) {
+        id object = [[exception userInfo] objectForKey:key];
+        writer->uncaught_exception.user_info[index].key = strdup([key UTF8String]);
+        if ([object conformsToProtocol:@protocol(NSCoding)]) {
+            NSMutableData *encoded = [[NSMutableData alloc] init];
+            NSKeyedArchiver *archiver = [[NSKeyedArchiver alloc] initForWritingWithMutableData:encoded];
+            [archiver setOutputFormat:NSPropertyListXMLFormat_v1_0];
+            [archiver encodeRootObject:object];
+            [archiver finishEncoding];
+            [archiver release];
+            NSString *string = [[NSString alloc] initWithData:encoded encoding:NSUTF8StringEncoding];
+            [encoded release];
+            writer->uncaught_exception.user_info[index].serialized = strdup([string UTF8String]);
+            [string release];
+        } else
+            writer->uncaught_exception.user_info[index].serialized = strdup([[object description] UTF8String]);
+
+        writer->uncaught_exception.user_info[index].key_length = plcrash_writer_strlen(writer->uncaught_exception.user_info[index].key);
+        writer->uncaught_exception.user_info[index].serialized_length = plcrash_writer_strlen(writer->uncaught_exception.user_info[index].serialized);
+
+        index++;
+    }
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Prepare a previously initialized @a writer for writing another report. The writer's environment information,
+ * pre-encoded report header, caches, and configuration are retained; only the per-report incident UUID is
+ * regenerated. The report timestamp is always fetched at the time a report is written.
+ *
+ * This allows a single writer to be reused for repeated live reports, without re-fetching the process, machine,
+ * and system information via plcrash_log_writer_init().
+ *
+ * @param writer The writer to be reset. The writer must not have an uncaught exception set.
+ *
+ * @warning This function is not async safe, and must not be called while the writer is in use by another thread.
+ */
+void plcrash_log_writer_reset (plcrash_log_writer_t *writer) {
+    PLCF_ASSERT(writer->uncaught_exception.has_exception == false);
+
+    plcrash_writer_generate_uuid(writer);
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Regenerate the per-report incident UUID of @a writer, preparing it to write another report. Unlike
+ * plcrash_log_writer_reset(), this function does not allocate, and may be used to reuse a writer from a context in
+ * which suspended threads may hold the malloc lock, such as a Mach exception handler.
+ *
+ * @param writer The writer to be reset. The writer must not be in use by another thread.
+ */
+void plcrash_log_writer_reset_async (plcrash_log_writer_t *writer) {
+    uuid_generate_random(writer->report_info.uuid_bytes);
+
+    /* Ensure that any signal handler has a consistent view of the above initialization. */
+    OSMemoryBarrier();
+}
+
+/**
+ * Close the plcrash_writer_t output.
+ *
+ * @param writer Writer instance to be closed.
+ */
+plcrash_error_t plcrash_log_writer_close (plcrash_log_writer_t *writer) {
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free any crash log writer resources.
+ *
+ * @warning This method is not async safe.
+ */
+void plcrash_log_writer_free (plcrash_log_writer_t *writer) {
+    /* Free the caches; if allocated from a crash-time allocator, they are owned by the allocator's region */
+    if (writer->allocator != NULL) {
+        plcrash_async_allocator_free(writer->allocator, writer->frame_cache);
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        plcrash_async_allocator_free(writer->allocator, writer->dwarf_cie_cache);
+#endif
+    } else {
+        if (writer->frame_cache != NULL)
+            free(writer->frame_cache);
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        if (writer->dwarf_cie_cache != NULL)
+            plframe_dwarf_cie_cache_free(writer->dwarf_cie_cache);
+#endif
+    }
+
+    if (writer->string_table != NULL)
+        free(writer->string_table);
+
+    if (writer->stack_table != NULL)
+        free(writer->stack_table);
+
+    if (writer->compressor != NULL)
+        free(writer->compressor);
+
+    if (writer->image_map != NULL)
+        free(writer->image_map);
+
+    if (writer->thread_info != NULL)
+        free(writer->thread_info);
+
+    if (writer->exception_buffers != NULL)
+        free(writer->exception_buffers);
+
+    if (writer->unwind_cache != NULL)
+        free(writer->unwind_cache);
+
+    if (writer->vm_summary != NULL)
+        free(writer->vm_summary);
+
+    if (writer->user_region_buffer != NULL)
+        free(writer->user_region_buffer);
+
+    if (writer->region_map != NULL) {
+        plcrash_nasync_memory_region_map_free(writer->region_map);
+        free(writer->region_map);
+    }
+
+    /* Free the app info */
+    if (writer->application_info.app_identifier != NULL)
+        free(writer->application_info.app_identifier);
+    if (writer->application_info.app_version != NULL)
+        free(writer->application_info.app_version);
+
+    /* Free the process info */
+    if (writer->process_info.process_name != NULL) 
+        free(writer->process_info.process_name);
+    if (writer->process_info.process_path != NULL) 
+        free(writer->process_info.process_path);
+    if (writer->process_info.parent_process_name != NULL) 
+        free(writer->process_info.parent_process_name);
+    
+    /* Free the pre-encoded report header */
+    if (writer->static_header.data != NULL)
+        free(writer->static_header.data);
+
+    /* Free the system info */
+    if (writer->system_info.version != NULL)
+        free(writer->system_info.version);
+    
+    if (writer->system_info.build != NULL)
+        free(writer->system_info.build);
+    
+    /* Free the machine info */
+    if (writer->machine_info.model != NULL)
+        free(writer->machine_info.model);
+
+    /* Free the exception data */
+    if (writer->uncaught_exception.has_exception && !writer->uncaught_exception.buffered) {
+        if (writer->uncaught_exception.name != NULL)
+            free(writer->uncaught_exception.name);
+
+        if (writer->uncaught_exception.reason != NULL)
+            free(writer->uncaught_exception.reason);
+        
+        if (writer->uncaught_exception.callstack != NULL)
+            free(writer->uncaught_exception.callstack);
+    }
+
+    if (writer->uncaught_exception.has_exception) {
+        if (writer->uncaught_exception.user_info != NULL) {
+            for (uint64_t i=0; i!=writer->uncaught_exception.user_info_size; i++) {
+                if (writer->uncaught_exception.user_info[i].key != NULL)
+                    free(writer->uncaught_exception.user_info[i].key);
+                if (writer->uncaught_exception.user_info[i].serialized != NULL)
+                    free(writer->uncaught_exception.user_info[i].serialized);
+            }
+            free(writer->uncaught_exception.user_info);
+        }
+    }
+}
+
+/**
+ * @internal
+ *
+ * A parallel job. The job function is called once for each index in [0, count), from any of the pool's threads, or
+ * from the thread that submitted the job.
+ *
+ * @param ctx The job context.
+ * @param worker The index of the executing worker, in [0, plcrash_log_writer_workers::count]. The submitting thread
+ * runs as worker plcrash_log_writer_workers::count.
+ * @param index The job index to be executed.
+ */
+typedef void (*plcrash_log_writer_job_fn) (void *ctx, uint32_t worker, size_t index);
+
+/**
+ * @internal
+ *
+ * Worker pool state.
+ */
+struct plcrash_log_writer_workers {
+    /** The number of spawned worker threads. */
+    uint32_t count;
+
+    /** The worker threads. */
+    pthread_t *threads;
+
+    /** The Mach thread ports of the worker threads. */
+    thread_t *mach_threads;
+
+    /** Serializes job submission; a pool may be shared by multiple writers, but only runs one job at a time. */
+    pthread_mutex_t submit_lock;
+
+    /** Protects all fields below. */
+    pthread_mutex_t lock;
+
+    /** Signaled when a new job is submitted, or the pool is shut down. */
+    pthread_cond_t job_cond;
+
+    /** Signaled when the last worker finishes the current job. */
+    pthread_cond_t done_cond;
+
+    /** Incremented for each submitted job. */
+    uint64_t generation;
+
+    /** If true, the workers should exit. */
+    bool shutdown;
+
+    /** The number of workers that have not yet finished the current job. */
+    uint32_t active;
+
+    /** The current job function. */
+    plcrash_log_writer_job_fn job;
+
+    /** The current job context. */
+    void *job_ctx;
+
+    /** The number of indices in the current job. */
+    size_t job_count;
+
+    /** The next unclaimed job index. */
+    volatile int32_t job_next;
+
+    /** If true, jobs are submitted and completed via @a job_sem and @a done_sem rather than the pthread lock and
+     * condition variables, and all per-job state is pre-allocated; see plcrash_log_writer_workers_new_async_safe(). */
+    bool async_safe;
+
+    /** Signaled once per worker for each submitted job, or for shutdown. Only used by async-safe pools. */
+    semaphore_t job_sem;
+
+    /** Signaled by each worker on completion of a job. Only used by async-safe pools. */
+    semaphore_t done_sem;
+
+    /** Pre-reserved allocator from which per-job thread captures are allocated, or NULL. Only used by async-safe pools. */
+    plcrash_async_allocator_t *allocator;
+
+    /** The position of @a allocator prior to any per-job allocations. */
+    plcrash_async_allocator_mark_t allocator_mark;
+
+    /** The maximum number of threads that may be captured by a single job. Only used by async-safe pools. */
+    uint32_t max_threads;
+
+    /** Pre-allocated per-worker symbol caches (count + 1 entries), or NULL. Only used by async-safe pools. */
+    plcrash_async_symbol_cache_t *symbol_caches;
+
+    /** Pre-allocated per-worker section caches (count + 1 entries), or NULL. Only used by async-safe pools. */
+    plcrash_async_macho_section_cache_t *section_caches;
+};
+
+/**
+ * @internal
+ *
+ * The time, in seconds, for which the thread writing a crash report waits for an async-safe pool's workers to
+ * complete a job. A worker that does not complete in time -- eg, because it faulted while walking a corrupt
+ * stack -- is abandoned, and the thread it was capturing is omitted from the report.
+ */
+#define PLCRASH_WRITER_WORKER_TIMEOUT 2
+
+static size_t plcrash_writer_thread_capture_size (void);
+
+/**
+ * @internal
+ * Per-thread worker startup argument.
+ */
+struct plcrash_log_writer_worker_arg {
+    /** The owning pool. */
+    plcrash_log_writer_workers_t *workers;
+
+    /** The worker's index. */
+    uint32_t worker;
+};
+
+/**
+ * @internal
+ * Claim and execute indices from the current job until none remain.
+ */
+static void plcrash_log_writer_workers_drain (plcrash_log_writer_workers_t *workers, uint32_t worker) {
+    int32_t index;
+    while ((index = OSAtomicIncrement32Barrier(&workers->job_next) - 1) < (int32_t) workers->job_count)
+        workers->job(workers->job_ctx, worker, index);
+}
+
+/**
+ * @internal
+ * Worker thread entry point.
+ */
+static void *plcrash_log_writer_worker_main (void *arg) {
+    struct plcrash_log_writer_worker_arg *worker_arg = arg;
+    plcrash_log_writer_workers_t *workers = worker_arg->workers;
+    uint32_t worker = worker_arg->worker;
+    free(worker_arg);
+
+    /* Async-safe pools park on the job semaphore; the submitting thread may be a signal handler, and can only
+     * use semaphore_signal() to wake us. */
+    if (workers->async_safe) {
+        while (true) {
+            if (semaphore_wait(workers->job_sem) != KERN_SUCCESS)
+                continue;
+
+            OSMemoryBarrier();
+            if (workers->shutdown)
+                break;
+
+            plcrash_log_writer_workers_drain(workers, worker);
+            semaphore_signal(workers->done_sem);
+        }
+
+        return NULL;
+    }
+
+    /* Jobs are numbered from 1; starting from 0 ensures that a job submitted before this thread first acquires the
+     * lock is not missed. */
+    uint64_t generation = 0;
+    pthread_mutex_lock(&workers->lock);
+    while (true) {
+        while (!workers->shutdown && workers->generation == generation)
+            pthread_cond_wait(&workers->job_cond, &workers->lock);
+
+        if (workers->shutdown)
+            break;
+
+        generation = workers->generation;
+        pthread_mutex_unlock(&workers->lock);
+
+        plcrash_log_writer_workers_drain(workers, worker);
+
+        pthread_mutex_lock(&workers->lock);
+        if (--workers->active == 0)
+            pthread_cond_signal(&workers->done_cond);
+    }
+    pthread_mutex_unlock(&workers->lock);
+
+    return NULL;
+}
+
+/**
+ * Spawn a new worker pool.
+ *
+ * @param workers On success, will be set to the new worker pool. The pool must be freed via
+ * plcrash_log_writer_workers_free().
+ * @param count The number of worker threads to spawn. The thread writing a report also executes jobs, so a report
+ * will be written by up to @a count + 1 threads.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the pool could not be created.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_log_writer_workers_new (plcrash_log_writer_workers_t **workers, uint32_t count) {
+    plcrash_log_writer_workers_t *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL)
+        return PLCRASH_ENOMEM;
+
+    pool->threads = calloc(count, sizeof(pool->threads[0]));
+    pool->mach_threads = calloc(count, sizeof(pool->mach_threads[0]));
+    if ((count > 0 && pool->threads == NULL) || (count > 0 && pool->mach_threads == NULL)) {
+        free(pool->threads);
+        free(pool->mach_threads);
+        free(pool);
+        return PLCRASH_ENOMEM;
+    }
+
+    pthread_mutex_init(&pool->submit_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (uint32_t i = 0; i < count; i++) {
+        struct plcrash_log_writer_worker_arg *arg = malloc(sizeof(*arg));
+        if (arg == NULL)
+            break;
+
+        arg->workers = pool;
+        arg->worker = i;
+        int perr = pthread_create(&pool->threads[i], NULL, plcrash_log_writer_worker_main, arg);
+        if (perr != 0) {
+            PLCF_DEBUG("Failed to spawn log writer worker %" PRIu32 ": %s", i, strerror(perr));
+            free(arg);
+            break;
+        }
+
+        pool->mach_threads[i] = pthread_mach_thread_np(pool->threads[i]);
+        pool->count++;
+    }
+
+    *workers = pool;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Spawn a new worker pool that may be used when writing crash reports. As threads can't be created by a signal
+ * handler, the pool's threads are spawned up front and parked on a Mach semaphore; at crash time, they are woken
+ * via the async-safe semaphore_signal(), and each unwinds and symbolicates a subset of the crashed process'
+ * threads, while the crashed thread merges and writes the results.
+ *
+ * All state required at crash time is allocated by this function: the per-worker symbol and section caches, and
+ * a guarded allocator reserved for the captures and frame caches of up to @a max_threads threads. The allocator's
+ * pages are not touched until a report is written. If a report includes more than @a max_threads threads, they
+ * are captured serially.
+ *
+ * @param workers On success, will be set to the new worker pool. The pool must be freed via
+ * plcrash_log_writer_workers_free().
+ * @param count The number of worker threads to spawn.
+ * @param max_threads The maximum number of threads that may be captured in parallel by a single report.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the pool could not be created.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_log_writer_workers_new_async_safe (plcrash_log_writer_workers_t **workers, uint32_t count, uint32_t max_threads) {
+    plcrash_log_writer_workers_t *pool = calloc(1, sizeof(*pool));
+    kern_return_t kr;
+    plcrash_error_t err;
+
+    if (pool == NULL)
+        return PLCRASH_ENOMEM;
+
+    pool->async_safe = true;
+    pool->max_threads = max_threads;
+    pool->threads = calloc(count, sizeof(pool->threads[0]));
+    pool->mach_threads = calloc(count, sizeof(pool->mach_threads[0]));
+    pool->symbol_caches = calloc(count + 1, sizeof(pool->symbol_caches[0]));
+    pool->section_caches = calloc(count + 1, sizeof(pool->section_caches[0]));
+    if ((count > 0 && (pool->threads == NULL || pool->mach_threads == NULL)) || pool->symbol_caches == NULL || pool->section_caches == NULL) {
+        err = PLCRASH_ENOMEM;
+        goto error;
+    }
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    /* The CIE caches are optional; on allocation failure, the worker simply unwinds without one. */
+    for (uint32_t i = 0; i < count + 1; i++) {
+        if (plframe_dwarf_cie_cache_new(&pool->section_caches[i].dwarf_cie_cache) != PLCRASH_ESUCCESS)
+            pool->section_caches[i].dwarf_cie_cache = NULL;
+    }
+#endif
+
+    /* Reserve space for each thread's capture and frame cache, plus the allocator's per-allocation overhead */
+    size_t per_thread = plcrash_writer_thread_capture_size() + sizeof(struct plcrash_log_writer_frame_cache) + PAGE_SIZE;
+    if ((err = plcrash_async_allocator_new(&pool->allocator, per_thread * max_threads + PAGE_SIZE, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage)) != PLCRASH_ESUCCESS) {
+        pool->allocator = NULL;
+        goto error;
+    }
+    plcrash_async_allocator_mark(pool->allocator, &pool->allocator_mark);
+
+    if ((kr = semaphore_create(mach_task_self(), &pool->job_sem, SYNC_POLICY_FIFO, 0)) != KERN_SUCCESS) {
+        pool->job_sem = SEMAPHORE_NULL;
+        err = PLCRASH_EINTERNAL;
+        goto error;
+    }
+
+    if ((kr = semaphore_create(mach_task_self(), &pool->done_sem, SYNC_POLICY_FIFO, 0)) != KERN_SUCCESS) {
+        pool->done_sem = SEMAPHORE_NULL;
+        err = PLCRASH_EINTERNAL;
+        goto error;
+    }
+
+    pthread_mutex_init(&pool->submit_lock, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->job_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (uint32_t i = 0; i < count; i++) {
+        struct plcrash_log_writer_worker_arg *arg = malloc(sizeof(*arg));
+        if (arg == NULL)
+            break;
+
+        arg->workers = pool;
+        arg->worker = i;
+        int perr = pthread_create(&pool->threads[i], NULL, plcrash_log_writer_worker_main, arg);
+        if (perr != 0) {
+            PLCF_DEBUG("Failed to spawn log writer worker %" PRIu32 ": %s", i, strerror(perr));
+            free(arg);
+            break;
+        }
+
+        pool->mach_threads[i] = pthread_mach_thread_np(pool->threads[i]);
+        pool->count++;
+    }
+
+    *workers = pool;
+    return PLCRASH_ESUCCESS;
+
+error:
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    for (uint32_t i = 0; pool->section_caches != NULL && i < count + 1; i++) {
+        if (pool->section_caches[i].dwarf_cie_cache != NULL)
+            plframe_dwarf_cie_cache_free(pool->section_caches[i].dwarf_cie_cache);
+    }
+#endif
+    if (pool->allocator != NULL)
+        plcrash_async_allocator_delete(pool->allocator);
+    if (pool->job_sem != SEMAPHORE_NULL)
+        semaphore_destroy(mach_task_self(), pool->job_sem);
+
+    free(pool->threads);
+    free(pool->mach_threads);
+    free(pool->symbol_caches);
+    free(pool->section_caches);
+    free(pool);
+    return err;
+}
+
+/**
+ * Pre-fault and wire the crash-time capture storage reserved by an async-safe worker pool; see
+ * plcrash_async_allocator_wire().
+ *
+ * @param workers The pool to be wired.
+ * @param wired_size On return, the number of bytes wired. May be NULL.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a workers is not async-safe, or PLCRASH_ENOMEM
+ * if the storage could not be wired.
+ *
+ * @warning This function is not async-safe, and must not be called while the pool is in use by a writer.
+ */
+plcrash_error_t plcrash_log_writer_workers_wire (plcrash_log_writer_workers_t *workers, size_t *wired_size) {
+    if (wired_size != NULL)
+        *wired_size = 0;
+
+    if (!workers->async_safe)
+        return PLCRASH_EINVAL;
+
+    return plcrash_async_allocator_wire(workers->allocator, wired_size);
+}
+
+/**
+ * Stop all worker threads and free the pool. The pool must not be in use by any writer.
+ *
+ * @param workers The pool to be freed.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_log_writer_workers_free (plcrash_log_writer_workers_t *workers) {
+    pthread_mutex_lock(&workers->lock);
+    workers->shutdown = true;
+    pthread_cond_broadcast(&workers->job_cond);
+    pthread_mutex_unlock(&workers->lock);
+
+    if (workers->async_safe) {
+        OSMemoryBarrier();
+        for (uint32_t i = 0; i < workers->count; i++)
+            semaphore_signal(workers->job_sem);
+    }
+
+    for (uint32_t i = 0; i < workers->count; i++)
+        pthread_join(workers->threads[i], NULL);
+
+    if (workers->async_safe) {
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        for (uint32_t i = 0; i < workers->count + 1; i++) {
+            if (workers->section_caches[i].dwarf_cie_cache != NULL)
+                plframe_dwarf_cie_cache_free(workers->section_caches[i].dwarf_cie_cache);
+        }
+#endif
+        plcrash_async_allocator_delete(workers->allocator);
+        semaphore_destroy(mach_task_self(), workers->job_sem);
+        semaphore_destroy(mach_task_self(), workers->done_sem);
+        free(workers->symbol_caches);
+        free(workers->section_caches);
+    }
+
+    pthread_cond_destroy(&workers->job_cond);
+    pthread_cond_destroy(&workers->done_cond);
+    pthread_mutex_destroy(&workers->lock);
+    pthread_mutex_destroy(&workers->submit_lock);
+
+    free(workers->threads);
+    free(workers->mach_threads);
+    free(workers);
+}
+
+/**
+ * @internal
+ * Execute @a fn for all indices in [0, count) across an async-safe pool's threads and the calling thread, as per
+ * plcrash_log_writer_workers_run(). This function is async-safe.
+ *
+ * @return Returns true if all workers completed, or false if the wait for one or more workers timed out, in which
+ * case the indices claimed by those workers may still be executing.
+ */
+static bool plcrash_log_writer_workers_run_async_safe (plcrash_log_writer_workers_t *workers, plcrash_log_writer_job_fn fn, void *ctx, size_t count) {
+    workers->job = fn;
+    workers->job_ctx = ctx;
+    workers->job_count = count;
+    workers->job_next = 0;
+    OSMemoryBarrier();
+
+    for (uint32_t i = 0; i < workers->count; i++)
+        semaphore_signal(workers->job_sem);
+
+    /* Participate, rather than idling while the workers run */
+    plcrash_log_writer_workers_drain(workers, workers->count);
+
+    /* Once every index has been claimed, only the workers' in-progress indices remain */
+    for (uint32_t i = 0; i < workers->count; i++) {
+        mach_timespec_t timeout = { .tv_sec = PLCRASH_WRITER_WORKER_TIMEOUT, .tv_nsec = 0 };
+        if (semaphore_timedwait(workers->done_sem, timeout) != KERN_SUCCESS)
+            return false;
+    }
+
+    OSMemoryBarrier();
+    return true;
+}
+
+/**
+ * @internal
+ * Execute @a fn for all indices in [0, count) across the pool's threads and the calling thread, returning once
+ * all indices have completed. Unless the pool is async-safe, the caller must hold the pool's @a submit_lock.
+ *
+ * @return Returns true if all indices have completed. Only async-safe pools may return false; see
+ * plcrash_log_writer_workers_run_async_safe().
+ */
+static bool plcrash_log_writer_workers_run (plcrash_log_writer_workers_t *workers, plcrash_log_writer_job_fn fn, void *ctx, size_t count) {
+    if (workers->async_safe)
+        return plcrash_log_writer_workers_run_async_safe(workers, fn, ctx, count);
+
+    pthread_mutex_lock(&workers->lock);
+    workers->job = fn;
+    workers->job_ctx = ctx;
+    workers->job_count = count;
+    workers->job_next = 0;
+    workers->active = workers->count;
+    workers->generation++;
+    pthread_cond_broadcast(&workers->job_cond);
+    pthread_mutex_unlock(&workers->lock);
+
+    /* Participate, rather than idling while the workers run */
+    plcrash_log_writer_workers_drain(workers, workers->count);
+
+    pthread_mutex_lock(&workers->lock);
+    while (workers->active > 0)
+        pthread_cond_wait(&workers->done_cond, &workers->lock);
+    pthread_mutex_unlock(&workers->lock);
+
+    return true;
+}
+
+/**
+ * @internal
+ * Allocate zero-initialized storage for a single report's parallel captures from @a workers. Async-safe pools
+ * allocate from their pre-reserved allocator; all other pools use malloc().
+ */
+static void *plcrash_log_writer_workers_alloc (plcrash_log_writer_workers_t *workers, size_t size) {
+    if (!workers->async_safe)
+        return calloc(1, size);
+
+    void *result = plcrash_async_allocator_alloc(workers->allocator, size, true);
+    if (result != NULL)
+        plcrash_async_memset(result, 0, size);
+    return result;
+}
+
+/**
+ * @internal
+ * Release storage allocated via plcrash_log_writer_workers_alloc().
+ */
+static void plcrash_log_writer_workers_dealloc (plcrash_log_writer_workers_t *workers, void *ptr) {
+    if (ptr == NULL)
+        return;
+
+    if (!workers->async_safe)
+        free(ptr);
+    else
+        plcrash_async_allocator_free(workers->allocator, ptr);
+}
+
+/**
+ * @internal
+ * Return true if @a thread is one of the threads of @a workers.
+ */
+static bool plcrash_log_writer_workers_contains (plcrash_log_writer_workers_t *workers, thread_t thread) {
+    if (workers == NULL)
+        return false;
+
+    for (uint32_t i = 0; i < workers->count; i++) {
+        if (workers->mach_threads[i] == thread)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * Configure a worker pool to be used to unwind and symbolicate thread stacks in parallel. By default, threads are
+ * walked serially on the calling thread.
+ *
+ * @param writer The writer to configure.
+ * @param workers The worker pool, or NULL to walk threads serially. This is a borrowed reference, and must remain
+ * valid for the lifetime of the writer.
+ *
+ * @warning Pools created via plcrash_log_writer_workers_new() allocate memory and rely on pthread synchronization;
+ * they must only be used for live reports, and never from a crash handler. Crash-time writers must use a pool
+ * created via plcrash_log_writer_workers_new_async_safe().
+ */
+void plcrash_log_writer_set_workers (plcrash_log_writer_t *writer, plcrash_log_writer_workers_t *workers) {
+    writer->workers = workers;
+}
+
+/**
+ * @internal
+ *
+ * Write the system info message fields, excluding the trailing timestamp.
+ *
+ * @param file Output file
+ * @param writer Writer containing system data
+ */
+static size_t plcrash_writer_write_system_info_fields (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+    size_t rv = 0;
+    uint32_t enumval;
+
+    /* OS */
+    enumval = PLCrashReportHostOperatingSystem;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+
+    /* OS Version */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, writer->system_info.version);
+    
+    /* OS Build */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_BUILD_ID, PLPROTOBUF_C_TYPE_STRING, writer->system_info.build);
+
+    /* Machine type */
+    enumval = PLCrashReportHostArchitecture;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ARCHITECTURE_TYPE_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the system info message.
+ *
+ * @param file Output file
+ * @param writer Writer containing system data
+ * @param timestamp Timestamp to use (seconds since epoch). Must be same across calls, as varint encoding.
+ */
 static size_t plcrash_writer_write_system_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer, int64_t timestamp) {
     size_t rv = 0;
-    uint32_t enumval;
 
-    /* OS */
-    enumval = PLCrashReportHostOperatingSystem;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+    /* Static fields; these may have been pre-encoded by plcrash_writer_encode_static_header() */
+    if (writer->static_header.data != NULL) {
+        if (file != NULL)
+            plcrash_async_file_write(file, writer->static_header.data, writer->static_header.system_info_length);
+        rv += writer->static_header.system_info_length;
+    } else {
+        rv += plcrash_writer_write_system_info_fields(file, writer);
+    }
+
+    /* Timestamp */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_INT64, &timestamp);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the processor info message.
+ *
+ * @param file Output file
+ * @param cpu_type The Mach CPU type.
+ * @param cpu_subtype_t The Mach CPU subtype
+ */
+static size_t plcrash_writer_write_processor_info (plcrash_async_file_t *file, uint64_t cpu_type, uint64_t cpu_subtype) {
+    size_t rv = 0;
+    uint32_t enumval;
+    
+    /* Encoding */
+    enumval = PLCrashReportProcessorTypeEncodingMach;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_ENCODING_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+
+    /* Type */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_type);
+
+    /* Subtype */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_SUBTYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_subtype);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the machine info message.
+ *
+ * @param file Output file
+ */
+static size_t plcrash_writer_write_machine_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+    size_t rv = 0;
+    
+    /* Model */
+    if (writer->machine_info.model != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_MODEL_ID, PLPROTOBUF_C_TYPE_STRING, writer->machine_info.model);
+
+    /* Processor */
+    {
+        uint32_t size;
+
+        /* Determine size */
+        size = plcrash_writer_write_processor_info(NULL, writer->machine_info.cpu_type, writer->machine_info.cpu_subtype);
+
+        /* Write message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_processor_info(file, writer->machine_info.cpu_type, writer->machine_info.cpu_subtype);
+    }
+
+    /* Physical Processor Count */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->machine_info.processor_count);
+    
+    /* Logical Processor Count */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_LOGICAL_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->machine_info.logical_processor_count);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the app info message.
+ *
+ * @param file Output file
+ * @param app_identifier Application identifier
+ * @param app_version Application version
+ */
+static size_t plcrash_writer_write_app_info (plcrash_async_file_t *file, const char *app_identifier, const char *app_version) {
+    size_t rv = 0;
+
+    /* App identifier */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_IDENTIFIER_ID, PLPROTOBUF_C_TYPE_STRING, app_identifier);
+    
+    /* App version */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, app_version);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the process info message.
+ *
+ * @param file Output file
+ * @param process_name Process name
+ * @param process_id Process ID
+ * @param process_path Process path
+ * @param parent_process_name Parent process name
+ * @param parent_process_id Parent process ID
+ * @param native If false, process is running under emulation.
+ * @param start_time The start time of the process.
+ */
+static size_t plcrash_writer_write_process_info (plcrash_async_file_t *file, const char *process_name,
+                                                 const pid_t process_id, const char *process_path, 
+                                                 const char *parent_process_name, const pid_t parent_process_id,
+                                                 bool native, time_t start_time)
+{
+    size_t rv = 0;
+    uint64_t tval;
+
+    /*
+     * In the current crash reporter serialization format, pid values are serialized as unsigned 32-bit integers. This
+     * conforms with the actual implementation of pid_t on both 32-bit and 64-bit Darwin systems. To conform with
+     * SuSV3, however, the values should be encoded as signed integers; the actual width of the type being implementation
+     * defined.
+     *
+     * To maintain compatibility with existing report readers the values remain encoded as unsigned 32-bit integers,
+     * but should be updated to int64 values in future major revision of the data format.
+     */
+    uint32_t pidval;
+
+    /* Process name */
+    if (process_name != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, process_name);
+
+    /* Process ID */
+    pidval = process_id;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+
+    /* Process path */
+    if (process_path != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_PATH_ID, PLPROTOBUF_C_TYPE_STRING, process_path);
+    
+    /* Parent process name */
+    if (parent_process_name != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, parent_process_name);
+    
+
+    /* Parent process ID */
+    pidval = parent_process_id;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+
+    /* Native process. */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_NATIVE_ID, PLPROTOBUF_C_TYPE_BOOL, &native);
+    
+    /* Start time */
+    tval = start_time;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_START_TIME_ID, PLPROTOBUF_C_TYPE_UINT64, &tval);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * The top-level sections of a report being written with a footer (see plcrash_log_writer_set_footer()). All
+ * offsets are relative to the start of the report message.
+ */
+typedef struct plcrash_writer_footer {
+    /** The file offset of the report message, following the file header. */
+    off_t message_offset;
+
+    /** The recorded sections. The length of the last section is not known until it is closed. */
+    struct {
+        uint32_t field;
+        uint32_t offset;
+        uint32_t length;
+    } sections[PLCRASH_REPORT_FOOTER_MAX_SECTIONS];
+
+    /** Number of entries in @a sections. */
+    uint32_t count;
+
+    /** If true, the last entry of @a sections remains open. */
+    bool open;
+
+    /** Number of thread records written. */
+    uint32_t thread_count;
+
+    /** The crashed thread's record index, or PLCRASH_REPORT_FOOTER_NO_THREAD. */
+    uint32_t crashed_index;
+
+    /** The crashed thread's record offset and length. */
+    uint32_t crashed_offset;
+    uint32_t crashed_length;
+} plcrash_writer_footer_t;
+
+/**
+ * @internal
+ *
+ * Note that the records of @a field begin at @a offset, closing the previous section. Records of the same field as
+ * the open section extend that section.
+ *
+ * @param footer The footer, or NULL if no footer is being written.
+ * @param offset The message offset at which the records begin.
+ * @param field The records' CrashReport field number, or 0 to close the last section.
+ */
+static void plcrash_writer_footer_mark_at (plcrash_writer_footer_t *footer, uint32_t offset, uint32_t field) {
+    if (footer == NULL)
+        return;
+
+    if (footer->open) {
+        if (footer->sections[footer->count - 1].field == field)
+            return;
+
+        footer->sections[footer->count - 1].length = offset - footer->sections[footer->count - 1].offset;
+        footer->open = false;
+    }
+
+    /* Sections beyond the footer's capacity are not listed */
+    if (field == 0 || footer->count == PLCRASH_REPORT_FOOTER_MAX_SECTIONS)
+        return;
+
+    footer->sections[footer->count].field = field;
+    footer->sections[footer->count].offset = offset;
+    footer->sections[footer->count].length = 0;
+    footer->count++;
+    footer->open = true;
+}
+
+/* Return the current offset of @a file, relative to the start of the report message */
+static uint32_t plcrash_writer_footer_offset (plcrash_writer_footer_t *footer, plcrash_async_file_t *file) {
+    return (uint32_t) (plcrash_async_file_tell(file) - footer->message_offset);
+}
+
+/**
+ * @internal
+ *
+ * Note that the records of @a field begin at the current output position of @a file.
+ *
+ * @param footer The footer, or NULL if no footer is being written.
+ * @param file The output file.
+ * @param field The records' CrashReport field number, or 0 to close the last section.
+ */
+static void plcrash_writer_footer_mark (plcrash_writer_footer_t *footer, plcrash_async_file_t *file, uint32_t field) {
+    if (footer == NULL)
+        return;
+
+    plcrash_writer_footer_mark_at(footer, plcrash_writer_footer_offset(footer, file), field);
+}
+
+/**
+ * @internal
+ *
+ * Note the sections of the pre-encoded top-level records in @a data, which are about to be written at the current
+ * output position of @a file.
+ *
+ * @param footer The footer, or NULL if no footer is being written.
+ * @param file The output file.
+ * @param data The encoded records.
+ * @param length The length of @a data.
+ */
+static void plcrash_writer_footer_mark_encoded (plcrash_writer_footer_t *footer, plcrash_async_file_t *file, const uint8_t *data, size_t length) {
+    if (footer == NULL)
+        return;
+
+    uint32_t base = plcrash_writer_footer_offset(footer, file);
+    size_t pos = 0;
+
+    /* The records were encoded by this writer, and are all length-delimited messages */
+    while (pos < length) {
+        uint64_t values[2] = { 0, 0 };
+        size_t start = pos;
+
+        for (int i = 0; i < 2; i++) {
+            for (unsigned int shift = 0; pos < length && shift < 64; shift += 7) {
+                uint8_t byte = data[pos++];
+                values[i] |= ((uint64_t) (byte & 0x7F)) << shift;
+                if ((byte & 0x80) == 0)
+                    break;
+            }
+        }
+
+        plcrash_writer_footer_mark_at(footer, base + (uint32_t) start, (uint32_t) (values[0] >> 3));
+        pos += (size_t) MIN(values[1], (uint64_t) (length - pos));
+    }
+}
+
+/* Write @a value to @a file as a little-endian 32-bit value */
+static void plcrash_writer_footer_write_uint32 (plcrash_async_file_t *file, uint32_t value) {
+    uint8_t bytes[4] = { (uint8_t) value, (uint8_t) (value >> 8), (uint8_t) (value >> 16), (uint8_t) (value >> 24) };
+    plcrash_async_file_write(file, bytes, sizeof(bytes));
+}
+
+/**
+ * @internal
+ *
+ * Write the report footer, in the layout decoded by plcrash_report_reader_read_footer(). The last section must have
+ * been closed.
+ *
+ * @param file The output file.
+ * @param footer The footer to be written.
+ */
+static void plcrash_writer_write_footer (plcrash_async_file_t *file, plcrash_writer_footer_t *footer) {
+    for (uint32_t i = 0; i < footer->count; i++) {
+        plcrash_writer_footer_write_uint32(file, footer->sections[i].field);
+        plcrash_writer_footer_write_uint32(file, footer->sections[i].offset);
+        plcrash_writer_footer_write_uint32(file, footer->sections[i].length);
+    }
+
+    plcrash_writer_footer_write_uint32(file, footer->count);
+    plcrash_writer_footer_write_uint32(file, footer->crashed_index);
+    plcrash_writer_footer_write_uint32(file, footer->crashed_offset);
+    plcrash_writer_footer_write_uint32(file, footer->crashed_length);
+    plcrash_async_file_write(file, PLCRASH_REPORT_FOOTER_MAGIC, strlen(PLCRASH_REPORT_FOOTER_MAGIC));
+}
+
+/**
+ * @internal
+ *
+ * Write the machine info, app info, and process info messages. The content of these messages is fixed at
+ * writer initialization time.
+ *
+ * @param file Output file
+ * @param writer Writer containing machine, application, and process data
+ * @param footer The report footer, or NULL if the messages' sections are not to be recorded.
+ */
+static size_t plcrash_writer_write_static_messages (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_writer_footer_t *footer) {
+    size_t rv = 0;
+
+    /* Machine Info */
+    {
+        uint32_t size;
+
+        /* Determine size */
+        size = plcrash_writer_write_machine_info(NULL, writer);
+
+        /* Write message */
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_MACHINE_INFO_ID);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_machine_info(file, writer);
+    }
+
+    /* App info */
+    {
+        uint32_t size;
+
+        /* Determine size */
+        size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version);
+        
+        /* Write message */
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_APP_INFO_ID);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version);
+    }
+    
+    /* Process info */
+    {
+        uint32_t size;
+        
+        /* Determine size */
+        size = plcrash_writer_write_process_info(NULL, writer->process_info.process_name, writer->process_info.process_id, 
+                                                 writer->process_info.process_path, writer->process_info.parent_process_name,
+                                                 writer->process_info.parent_process_id, writer->process_info.native,
+                                                 writer->process_info.start_time);
+        
+        /* Write message */
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_PROCESS_INFO_ID);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_process_info(file, writer->process_info.process_name, writer->process_info.process_id, 
+                                                writer->process_info.process_path, writer->process_info.parent_process_name, 
+                                                writer->process_info.parent_process_id, writer->process_info.native,
+                                                writer->process_info.start_time);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Pre-encode the writer's static report header: the system info fields preceding the timestamp, followed by the
+ * complete machine info, app info, and process info messages. At crash time, only the system info timestamp
+ * (and the enclosing system info length prefix) must be encoded. If the header can't be allocated, the messages
+ * will be encoded at crash time.
+ *
+ * @param writer The writer for which the static header will be encoded.
+ *
+ * @warning This method is not async safe.
+ */
+static void plcrash_writer_encode_static_header (plcrash_log_writer_t *writer) {
+    size_t system_info_length = plcrash_writer_write_system_info_fields(NULL, writer);
+    size_t length = system_info_length + plcrash_writer_write_static_messages(NULL, writer, NULL);
+
+    uint8_t *data = malloc(length);
+    if (data == NULL) {
+        PLCF_DEBUG("Could not allocate the %zu byte report header", length);
+        return;
+    }
+
+    plcrash_async_file_t file;
+    plcrash_async_file_init_memory(&file, data, length);
+    plcrash_writer_write_system_info_fields(&file, writer);
+    plcrash_writer_write_static_messages(&file, writer, NULL);
+    PLCF_ASSERT(plcrash_async_file_tell(&file) == (off_t) length);
+
+    writer->static_header.data = data;
+    writer->static_header.system_info_length = system_info_length;
+    writer->static_header.length = length;
+}
+
+/**
+ * @internal
+ *
+ * The image and symbol containing a crashed thread's register value; see plcrash_writer_annotate_registers().
+ */
+typedef struct plcrash_writer_register_annotation {
+    /** If true, the value is an address within a written binary image, and @a image_index is valid. */
+    bool has_image;
+
+    /** The position of the containing image within the report's written binary images. */
+    uint32_t image_index;
+
+    /** If true, a symbol containing the value was found, and @a symbol_start is valid. */
+    bool has_symbol;
+
+    /** The start address of the containing symbol. */
+    pl_vm_address_t symbol_start;
+} plcrash_writer_register_annotation_t;
+
+/**
+ * @internal
+ *
+ * Write a thread backtrace register
+ *
+ * @param file Output file
+ * @param regname The register name.
+ * @param regval The register value.
+ * @param annotation If non-NULL, the image and symbol containing @a regval.
+ */
+static size_t plcrash_writer_write_thread_register (plcrash_async_file_t *file, const char *regname, plcrash_greg_t regval,
+                                                    const plcrash_writer_register_annotation_t *annotation)
+{
+    size_t rv = 0;
+
+    /* Write the name */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_NAME_ID, PLPROTOBUF_C_TYPE_STRING, regname);
+
+    /* Write the value */
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_THREAD_REGISTER_VALUE_ID, regval);
+
+    /* Write the containing image and symbol */
+    if (annotation != NULL && annotation->has_image) {
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_REGISTER_IMAGE_INDEX_ID, annotation->image_index);
+
+        if (annotation->has_symbol)
+            rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_THREAD_REGISTER_SYMBOL_START_ID, annotation->symbol_start);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write all thread backtrace register messages
+ *
+ * @param file Output file
+ * @param task The task from which @a uap was derived. All memory accesses will be mapped from this task.
+ * @param thread_state The thread state from which to acquire frame registers.
+ * @param annotations If non-NULL, the annotations of each register, indexed by register number.
+ */
+static size_t plcrash_writer_write_thread_registers (plcrash_async_file_t *file, task_t task, plcrash_async_thread_state_t *thread_state,
+                                                     const plcrash_writer_register_annotation_t *annotations)
+{
+    uint32_t regCount = plcrash_async_thread_state_get_reg_count(thread_state);
+    size_t rv = 0;
+    
+    /* Write out register messages */
+    for (int i = 0; i < regCount; i++) {
+        plcrash_greg_t regVal;
+        const char *regname;
+        const plcrash_writer_register_annotation_t *annotation;
+        uint32_t msgsize;
+
+        /* Fetch the register value */
+        if (plcrash_async_thread_state_has_reg(thread_state, i)) {
+            regVal = plcrash_async_thread_state_get_reg(thread_state, i);
+        } else {
+            // Should never happen
+            PLCF_DEBUG("Could not fetch register %i value: %s", i, plframe_strerror(PLFRAME_ENOTSUP));
+            regVal = 0;
+        }
+
+        /* Fetch the register name */
+        regname = plcrash_async_thread_state_get_reg_name(thread_state, i);
+
+        /* Fetch the register annotation */
+        annotation = (annotations != NULL) ? &annotations[i] : NULL;
+
+        /* Get the register message size */
+        msgsize = plcrash_writer_write_thread_register(NULL, regname, regVal, annotation);
+        
+        /* Write the header and message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTERS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+        rv += plcrash_writer_write_thread_register(file, regname, regVal, annotation);
+    }
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the fixed register fields of a typed RegisterState register set. The field number of each register is its
+ * register number plus one, and registers that are not available are omitted.
+ *
+ * @param file Output file, or NULL to determine the message size.
+ * @param thread_state The thread state from which to acquire registers.
+ */
+static size_t plcrash_writer_write_register_set (plcrash_async_file_t *file, plcrash_async_thread_state_t *thread_state) {
+    size_t regCount = plcrash_async_thread_state_get_reg_count(thread_state);
+    bool wide = (plcrash_async_thread_state_get_greg_size(thread_state) == 8);
+    size_t rv = 0;
+
+    for (plcrash_regnum_t i = 0; i < regCount; i++) {
+        if (!plcrash_async_thread_state_has_reg(thread_state, i))
+            continue;
+
+        plcrash_greg_t regVal = plcrash_async_thread_state_get_reg(thread_state, i);
+        if (wide) {
+            rv += plcrash_writer_pack_uint64(file, (uint32_t) i + 1, regVal);
+        } else {
+            rv += plcrash_writer_pack_uint32(file, (uint32_t) i + 1, (uint32_t) regVal);
+        }
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a typed RegisterState register annotation message.
+ *
+ * @param file Output file, or NULL to determine the message size.
+ * @param regnum The annotated register.
+ * @param annotation The register's annotation. Must reference a containing image.
+ */
+static size_t plcrash_writer_write_register_annotation (plcrash_async_file_t *file, plcrash_regnum_t regnum,
+                                                        const plcrash_writer_register_annotation_t *annotation)
+{
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_REGISTER_ANNOTATION_REGISTER_NUMBER_ID, (uint32_t) regnum);
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_REGISTER_ANNOTATION_IMAGE_INDEX_ID, annotation->image_index);
+
+    if (annotation->has_symbol)
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_THREAD_REGISTER_ANNOTATION_SYMBOL_START_ID, annotation->symbol_start);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write the annotation messages of all registers in @a thread_state that are within a binary image.
+ *
+ * @param file Output file, or NULL to determine the total size.
+ * @param thread_state The annotated thread state.
+ * @param annotations The annotations of each register, indexed by register number.
+ */
+static size_t plcrash_writer_write_register_annotations (plcrash_async_file_t *file, plcrash_async_thread_state_t *thread_state,
+                                                         const plcrash_writer_register_annotation_t *annotations)
+{
+    size_t regCount = plcrash_async_thread_state_get_reg_count(thread_state);
+    size_t rv = 0;
+
+    for (plcrash_regnum_t i = 0; i < regCount; i++) {
+        if (!annotations[i].has_image)
+            continue;
+
+        uint32_t msgsize = (uint32_t) plcrash_writer_write_register_annotation(NULL, i, &annotations[i]);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_STATE_ANNOTATIONS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+        rv += plcrash_writer_write_register_annotation(file, i, &annotations[i]);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a compact (v2) typed RegisterState message, in place of the per-register name and value messages written by
+ * plcrash_writer_write_thread_registers().
+ *
+ * @param file Output file
+ * @param thread_state The thread state from which to acquire registers.
+ * @param annotations If non-NULL, the annotations of each register, indexed by register number.
+ */
+static size_t plcrash_writer_write_register_state (plcrash_async_file_t *file, plcrash_async_thread_state_t *thread_state,
+                                                   const plcrash_writer_register_annotation_t *annotations)
+{
+    bool wide = (plcrash_async_thread_state_get_greg_size(thread_state) == 8);
+    uint32_t field_id;
+    size_t rv = 0;
+
+#if defined(PLCRASH_ASYNC_THREAD_X86_SUPPORT)
+    field_id = wide ? PLCRASH_PROTO_THREAD_REGISTER_STATE_X86_64_ID : PLCRASH_PROTO_THREAD_REGISTER_STATE_X86_32_ID;
+#elif defined(PLCRASH_ASYNC_THREAD_ARM_SUPPORT)
+    field_id = wide ? PLCRASH_PROTO_THREAD_REGISTER_STATE_ARM64_ID : PLCRASH_PROTO_THREAD_REGISTER_STATE_ARM_ID;
+#else
+#error Add typed register state support for this architecture
+#endif
+
+    /* Write the register set, and the RegisterState message that contains it */
+    uint32_t setsize = (uint32_t) plcrash_writer_write_register_set(NULL, thread_state);
+    uint32_t msgsize = (uint32_t) plcrash_writer_pack(NULL, field_id, PLPROTOBUF_C_TYPE_MESSAGE, &setsize) + setsize;
+    if (annotations != NULL)
+        msgsize += (uint32_t) plcrash_writer_write_register_annotations(NULL, thread_state, annotations);
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_STATE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+    rv += plcrash_writer_pack(file, field_id, PLPROTOBUF_C_TYPE_MESSAGE, &setsize);
+    rv += plcrash_writer_write_register_set(file, thread_state);
+    if (annotations != NULL)
+        rv += plcrash_writer_write_register_annotations(file, thread_state, annotations);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a symbol
+ *
+ * @param file Output file
+ * @param name The symbol name
+ * @param name_length The length of @a name, in bytes.
+ * @param start_address The symbol start address
+ */
+static size_t plcrash_writer_write_symbol (plcrash_async_file_t *file, const char *name, size_t name_length, uint64_t start_address) {
+    size_t rv = 0;
+    
+    /* name */
+    rv += plcrash_writer_pack_string(file, PLCRASH_PROTO_SYMBOL_NAME, name, name_length);
+    
+    /* start_address */
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_SYMBOL_START_ADDRESS, start_address);
+    
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * plcrash_async_found_symbols_cb callback implementation. Copies the result to the frame referenced by the
+ * plcrash_log_writer_frame_cache available via @a ctx.
+ */
+static void plcrash_writer_resolve_frame_symbols_cb (size_t index, pl_vm_address_t address, const char *name, void *ctx) {
+    struct plcrash_log_writer_frame_cache *cache = ctx;
+    plcrash_writer_frame_symbol_t *symbol = &cache->frames[cache->pc_frames[index]].symbol;
+    size_t i;
+
+    for (i = 0; i < sizeof(symbol->name) - 1 && name[i] != '\0'; i++)
+        symbol->name[i] = name[i];
+    symbol->name[i] = '\0';
+
+    symbol->start_address = address;
+    symbol->found = true;
+}
+
+/**
+ * @internal
+ *
+ * Order two cached frames by image and PC.
+ */
+static int plcrash_writer_frame_cache_compare (struct plcrash_log_writer_frame_cache *cache, uint32_t lhs, uint32_t rhs) {
+    uintptr_t lhs_image = (uintptr_t) cache->images[lhs];
+    uintptr_t rhs_image = (uintptr_t) cache->images[rhs];
+
+    if (lhs_image != rhs_image)
+        return lhs_image < rhs_image ? -1 : 1;
+
+    if (cache->frames[lhs].pc != cache->frames[rhs].pc)
+        return cache->frames[lhs].pc < cache->frames[rhs].pc ? -1 : 1;
+
+    return 0;
+}
+
+/**
+ * @internal
+ *
+ * Resolve the symbols for the first @a max_frames frames captured in @a cache. Frames are grouped by image and sorted
+ * by PC, and each image's symbols are then resolved with a single batched lookup, rather than searching the image's
+ * symbol table once per frame. Duplicate PCs (as are common in recursive stacks) are only resolved once. Any frames
+ * beyond @a max_frames are left unsymbolicated, and are not looked up.
+ *
+ * @param writer The writer context.
+ * @param cache The frame cache.
+ * @param max_frames The number of innermost frames to be symbolicated.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ */
+static void plcrash_writer_frame_cache_symbolicate (plcrash_log_writer_t *writer, struct plcrash_log_writer_frame_cache *cache, uint32_t max_frames,
+                                                    plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext)
+{
+    for (uint32_t i = 0; i < cache->count; i++)
+        cache->frames[i].symbol.found = false;
+
+    if (writer->symbol_strategy == PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE)
+        return;
+
+    uint32_t count = MIN(cache->count, max_frames);
+    if (count == 0)
+        return;
+
+    plcrash_async_image_list_set_reading(image_list, true);
+
+    /* Determine the image for each frame, and sort the frames by image and PC. An insertion sort is used, as it
+     * requires no additional storage, is stable, and the number of frames is bounded by MAX_THREAD_FRAMES. */
+    for (uint32_t i = 0; i < count; i++) {
+        cache->images[i] = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) cache->frames[i].pc);
+
+        uint32_t j = i;
+        while (j > 0 && plcrash_writer_frame_cache_compare(cache, cache->sorted[j-1], i) > 0) {
+            cache->sorted[j] = cache->sorted[j-1];
+            j--;
+        }
+        cache->sorted[j] = i;
+    }
+
+    /* Resolve each image's frames */
+    uint32_t i = 0;
+    while (i < count) {
+        plcrash_async_image_t *image = cache->images[cache->sorted[i]];
+        uint32_t first = i;
+
+        /* Collect the image's unique PCs */
+        uint32_t npcs = 0;
+        for (; i < count && cache->images[cache->sorted[i]] == image; i++) {
+            uint32_t frame = cache->sorted[i];
+            if (npcs > 0 && cache->pcs[npcs - 1] == cache->frames[frame].pc)
+                continue;
+
+            cache->pcs[npcs] = (pl_vm_address_t) cache->frames[frame].pc;
+            cache->pc_frames[npcs] = frame;
+            npcs++;
+        }
+
+        /* No symbols are available for frames outside of a known image */
+        if (image == NULL)
+            continue;
+
+        /* If a symbol can not be found, our callback will not be called. */
+        plcrash_async_find_symbols(&image->macho_image, writer->symbol_strategy, findContext, cache->pcs, npcs, plcrash_writer_resolve_frame_symbols_cb, cache);
+
+        /* Copy the resolved symbols to any duplicate frames */
+        for (uint32_t j = first + 1; j < i; j++) {
+            plcrash_writer_cached_frame_t *prev = &cache->frames[cache->sorted[j-1]];
+            plcrash_writer_cached_frame_t *frame = &cache->frames[cache->sorted[j]];
+            if (frame->pc == prev->pc)
+                frame->symbol = prev->symbol;
+        }
+    }
+
+    plcrash_async_image_list_set_reading(image_list, false);
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a image should be written to the report's binary images.
+ *
+ * @param shared_cache If non-NULL, the shared cache from which loaded images are to be omitted.
+ * @param image The image to test.
+ */
+static bool plcrash_writer_should_write_image (plcrash_async_shared_cache_t *shared_cache, plcrash_async_macho_t *image) {
+    if (shared_cache != NULL && plcrash_async_shared_cache_contains_image(shared_cache, image))
+        return false;
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * The binary images written to a report, and referenced by its frames.
+ */
+typedef struct plcrash_writer_image_refs {
+    /** The image index snapshot from which the report's binary images are written. */
+    plcrash_async_image_index_t *index;
+
+    /** If non-NULL, maps positions within @a index to the positions of the written binary images. If NULL, all
+     * images in @a index are written, in index order. */
+    struct plcrash_log_writer_image_map *map;
+
+    /** If non-NULL, images loaded from this shared cache are not written. */
+    plcrash_async_shared_cache_t *shared_cache;
+
+    /** If true, frames contained by a written image are written using the compact encoding. */
+    bool compact;
+
+    /** If true, only images found via plcrash_writer_image_refs_find() are written, in order of first reference.
+     * Requires a non-NULL @a map. */
+    bool referenced_only;
+} plcrash_writer_image_refs_t;
+
+/**
+ * @internal
+ *
+ * Find the written binary image containing @a address. When writing only referenced images, the image is marked as
+ * referenced, and assigned a position if this is its first reference.
+ *
+ * @param refs The report's image references.
+ * @param address The address to look up.
+ * @param position On success, the image's position within the report's written binary images.
+ * @param image On success, the image containing @a address.
+ *
+ * @return Returns true if @a address is contained by a written image, or false otherwise.
+ */
+static bool plcrash_writer_image_refs_find (plcrash_writer_image_refs_t *refs, pl_vm_address_t address, uint32_t *position,
+                                            plcrash_async_image_t **image)
+{
+    size_t i;
+    if (!plcrash_async_image_index_find(refs->index, address, &i))
+        return false;
+
+    if (refs->map != NULL) {
+        struct plcrash_log_writer_image_map *map = refs->map;
+        if (i >= map->count)
+            return false;
+
+        /* Assign a position on first reference */
+        if (map->positions[i] == 0) {
+            if (!refs->referenced_only || !plcrash_writer_should_write_image(refs->shared_cache, &refs->index->images[i]->macho_image))
+                return false;
+
+            map->order[map->assigned] = (uint32_t) i;
+            map->positions[i] = ++map->assigned;
+        }
+
+        *position = map->positions[i] - 1;
+    } else {
+        *position = (uint32_t) i;
+    }
+
+    *image = refs->index->images[i];
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Mark the image containing @a address as referenced. This is a no-op unless only referenced images are to be
+ * written.
+ *
+ * @param refs The report's image references.
+ * @param address The referenced address.
+ */
+static void plcrash_writer_image_refs_mark (plcrash_writer_image_refs_t *refs, pl_vm_address_t address) {
+    plcrash_async_image_t *image;
+    uint32_t position;
+
+    if (refs->referenced_only)
+        plcrash_writer_image_refs_find(refs, address, &position, &image);
+}
+
+/**
+ * @internal
+ *
+ * The state required to annotate a crashed thread's register values; see plcrash_writer_annotate_registers().
+ */
+typedef struct plcrash_writer_register_annotator {
+    /** The report's image references. */
+    plcrash_writer_image_refs_t *refs;
+
+    /** The strategy to use for symbol lookups, or PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE to annotate only images. */
+    plcrash_async_symbol_strategy_t strategy;
+
+    /** Symbol lookup cache. Any register value matching a PC already resolved while symbolicating the crashed
+     * thread's frames (eg, the PC and link register) is served from the cache's memo. */
+    plcrash_async_symbol_cache_t *findContext;
+} plcrash_writer_register_annotator_t;
+
+/**
+ * @internal
+ *
+ * plcrash_async_found_symbol_cb callback implementation. Records the symbol start address in the
+ * plcrash_writer_register_annotation_t referenced by @a ctx.
+ */
+static void plcrash_writer_annotate_register_cb (pl_vm_address_t address, const char *name, void *ctx) {
+    plcrash_writer_register_annotation_t *annotation = ctx;
+    annotation->symbol_start = address;
+    annotation->has_symbol = true;
+}
+
+/**
+ * @internal
+ *
+ * Determine the written binary image, and the symbol, containing each register value of @a thread_state. Images
+ * are found via a binary search of the report's sorted image index, which only matches a value within an image's
+ * text segment; a symbol is then looked up for each matched value. Annotating a register costs O(log n) in the
+ * number of loaded images, plus a symbol lookup that is served from the memo for any value also found in the
+ * crashed thread's backtrace.
+ *
+ * @param annotator The annotation state.
+ * @param thread_state The thread state to be annotated.
+ * @param annotations On return, the annotations of each register, indexed by register number. Must have room for
+ * at least plcrash_async_thread_state_get_reg_count() entries.
+ */
+static void plcrash_writer_annotate_registers (plcrash_writer_register_annotator_t *annotator, plcrash_async_thread_state_t *thread_state,
+                                               plcrash_writer_register_annotation_t *annotations)
+{
+    size_t regCount = plcrash_async_thread_state_get_reg_count(thread_state);
+
+    for (plcrash_regnum_t i = 0; i < regCount; i++) {
+        plcrash_writer_register_annotation_t *annotation = &annotations[i];
+        plcrash_async_image_t *image;
+
+        annotation->has_image = false;
+        annotation->has_symbol = false;
+
+        if (!plcrash_async_thread_state_has_reg(thread_state, i))
+            continue;
+
+        pl_vm_address_t regval = (pl_vm_address_t) plcrash_async_thread_state_get_reg(thread_state, i);
+        if (regval == 0x0 || !plcrash_writer_image_refs_find(annotator->refs, regval, &annotation->image_index, &image))
+            continue;
+        annotation->has_image = true;
+
+        if (annotator->strategy == PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE)
+            continue;
+
+        /* If a symbol can not be found, our callback will not be called. */
+        plcrash_async_find_symbol(&image->macho_image, annotator->strategy, annotator->findContext, regval,
+                                  plcrash_writer_annotate_register_cb, annotation);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Return the next image to be written to the report's binary images, in written order.
+ *
+ * @param refs The report's image references.
+ * @param cursor The iteration state. Must be initialized to 0 prior to the first call.
+ *
+ * @return Returns the next image, or NULL if all images have been returned.
+ */
+static plcrash_async_image_t *plcrash_writer_image_refs_next (plcrash_writer_image_refs_t *refs, size_t *cursor) {
+    plcrash_async_image_index_t *index = refs->index;
+    size_t i;
+
+    if (refs->referenced_only) {
+        /* Referenced images, in order of first reference */
+        if (*cursor < refs->map->assigned)
+            return index->images[refs->map->order[(*cursor)++]];
+
+        /* References to images beyond the map's capacity aren't tracked; they must be written unconditionally. */
+        while ((i = refs->map->count + (*cursor - refs->map->assigned)) < index->count) {
+            (*cursor)++;
+            if (plcrash_writer_should_write_image(refs->shared_cache, &index->images[i]->macho_image))
+                return index->images[i];
+        }
+
+        return NULL;
+    }
+
+    while ((i = (*cursor)++) < index->count) {
+        if (plcrash_writer_should_write_image(refs->shared_cache, &index->images[i]->macho_image))
+            return index->images[i];
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * A frame's compact (PLCRASH_REPORT_FILE_VERSION_COMPACT) location.
+ */
+typedef struct plcrash_writer_compact_frame {
+    /** The index of the image containing the frame's PC, within the report's binary images. */
+    uint32_t image_index;
+
+    /** The difference between the frame's image-relative offset and that of the previous compact frame. */
+    int64_t offset_delta;
+} plcrash_writer_compact_frame_t;
+
+/**
+ * @internal
+ *
+ * Write a thread backtrace frame
+ *
+ * @param file Output file
+ * @param frame The captured frame, with its symbol as resolved by plcrash_writer_frame_cache_symbolicate().
+ * @param compact The frame's compact location, or NULL to write the frame's PC.
+ */
+static size_t plcrash_writer_write_thread_frame (plcrash_async_file_t *file, plcrash_writer_cached_frame_t *frame,
+                                                 plcrash_writer_compact_frame_t *compact)
+{
+    plcrash_writer_frame_symbol_t *symbol = &frame->symbol;
+    size_t rv = 0;
+
+    if (compact != NULL) {
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_FRAME_IMAGE_INDEX_ID, compact->image_index);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_OFFSET_DELTA_ID, PLPROTOBUF_C_TYPE_SINT64, &compact->offset_delta);
+    } else {
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_THREAD_FRAME_PC_ID, frame->pc);
+    }
+
+    if (symbol->found) {
+        /* The name is measured once, and used for both the size computation and the write */
+        size_t name_length = strlen(symbol->name);
+        uint32_t msgsize = plcrash_writer_write_symbol(NULL, symbol->name, name_length, symbol->start_address);
+
+        /* Write the header and message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_SYMBOL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+        rv += plcrash_writer_write_symbol(file, symbol->name, name_length, symbol->start_address);
+    }
+
+    if (frame->repeat_length > 0) {
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_FRAME_REPEAT_LENGTH_ID, frame->repeat_length);
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_FRAME_REPEAT_COUNT_ID, frame->repeat_count);
+    }
+
+    if (frame->omitted_count > 0)
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_FRAME_OMITTED_COUNT_ID, frame->omitted_count);
+
+    if (frame->unwind_method != PLCRASH_WRITER_UNWIND_METHOD_UNKNOWN) {
+        uint32_t method = frame->unwind_method;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_UNWIND_METHOD_ID, PLPROTOBUF_C_TYPE_ENUM, &method);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Initialize @a frame with @a pcval, clearing its repetition and symbol fields.
+ */
+static void plcrash_writer_cached_frame_init (plcrash_writer_cached_frame_t *frame, uint64_t pcval) {
+    frame->pc = pcval;
+    frame->repeat_length = 0;
+    frame->repeat_count = 0;
+    frame->omitted_count = 0;
+    frame->unwind_method = PLCRASH_WRITER_UNWIND_METHOD_UNKNOWN;
+    frame->symbol.found = false;
+}
+
+/**
+ * @internal
+ *
+ * Capture a frame in @a cache. The frame's symbol will be resolved by plcrash_writer_frame_cache_symbolicate().
+ *
+ * @param cache The frame cache.
+ * @param pcval The frame PC value.
+ *
+ * @return Returns false if the cache is full and the frame could not be captured.
+ */
+static bool plcrash_writer_frame_cache_append (struct plcrash_log_writer_frame_cache *cache, uint64_t pcval) {
+    if (cache->count >= MAX_THREAD_FRAMES)
+        return false;
+
+    plcrash_writer_cached_frame_init(&cache->frames[cache->count], pcval);
+
+    cache->count++;
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Capture a walked frame in @a cache. Frames are appended until the cache holds @a head_limit frames; any further
+ * frames are written to a ring buffer of @a tail_frames entries immediately following the head frames, retaining
+ * the last @a tail_frames frames walked. See plcrash_writer_frame_cache_finish_tail().
+ *
+ * @param cache The frame cache.
+ * @param head_limit The maximum number of head frames. @a head_limit + @a tail_frames must not exceed MAX_THREAD_FRAMES.
+ * @param tail_frames The number of tail frames to retain, or 0 to discard frames beyond @a head_limit.
+ * @param tail_walked The number of frames written to the ring buffer, initialized to 0 by the caller.
+ * @param pcval The frame PC value.
+ * @param unwind_method The frame's plcrash_writer_unwind_method_t unwind method.
+ *
+ * @return Returns true if the frame was appended to the head frames.
+ */
+static bool plcrash_writer_frame_cache_push (struct plcrash_log_writer_frame_cache *cache, uint32_t head_limit, uint32_t tail_frames,
+                                             uint32_t *tail_walked, uint64_t pcval, uint8_t unwind_method)
+{
+    if (*tail_walked == 0 && cache->count < head_limit) {
+        if (!plcrash_writer_frame_cache_append(cache, pcval))
+            return false;
+
+        cache->frames[cache->count - 1].unwind_method = unwind_method;
+        return true;
+    }
+
+    if (tail_frames == 0)
+        return false;
+
+    plcrash_writer_cached_frame_t *frame = &cache->frames[head_limit + (*tail_walked % tail_frames)];
+    plcrash_writer_cached_frame_init(frame, pcval);
+    frame->unwind_method = unwind_method;
+    (*tail_walked)++;
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Complete a capture performed with plcrash_writer_frame_cache_push(), ordering the retained tail frames as walked,
+ * appending them to the head frames, and recording the number of omitted frames on the last head frame.
+ *
+ * @param cache The frame cache.
+ * @param head_limit The maximum number of head frames, as provided to plcrash_writer_frame_cache_push().
+ * @param tail_frames The number of tail frames, as provided to plcrash_writer_frame_cache_push().
+ * @param tail_walked The number of frames written to the ring buffer.
+ */
+static void plcrash_writer_frame_cache_finish_tail (struct plcrash_log_writer_frame_cache *cache, uint32_t head_limit, uint32_t tail_frames,
+                                                    uint32_t tail_walked)
+{
+    if (tail_walked == 0)
+        return;
+
+    PLCF_ASSERT(cache->count == head_limit && head_limit > 0);
+    plcrash_writer_cached_frame_t *tail = &cache->frames[head_limit];
+
+    /* If the ring wrapped, rotate the oldest retained frame to the front. The tail frames have not yet been
+     * symbolicated, and only their PCs and unwind methods need be moved. */
+    if (tail_walked > tail_frames) {
+        uint32_t oldest = tail_walked % tail_frames;
+        for (uint32_t rotated = 0, start = 0; rotated < tail_frames; start++) {
+            uint64_t pc = tail[start].pc;
+            uint8_t unwind_method = tail[start].unwind_method;
+            uint32_t current = start;
+            while (true) {
+                uint32_t next = (current + oldest) % tail_frames;
+                rotated++;
+                if (next == start)
+                    break;
+
+                tail[current].pc = tail[next].pc;
+                tail[current].unwind_method = tail[next].unwind_method;
+                current = next;
+            }
+            tail[current].pc = pc;
+            tail[current].unwind_method = unwind_method;
+        }
+
+        cache->frames[head_limit - 1].omitted_count = tail_walked - tail_frames;
+        cache->count += tail_frames;
+    } else {
+        cache->count += tail_walked;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Determine whether the frames most recently captured in @a cache end with two consecutive copies of the same frame
+ * sequence, considering only frames at or above @a floor.
+ *
+ * @param cache The frame cache.
+ * @param floor The index of the first frame that may be included in a repeated sequence.
+ *
+ * @return Returns the length of the shortest repeated sequence, or 0 if none.
+ */
+static uint32_t plcrash_writer_frame_cache_find_repeat (struct plcrash_log_writer_frame_cache *cache, uint32_t floor) {
+    for (uint32_t length = 1; length <= PLCRASH_WRITER_REPEAT_LENGTH_MAX && length * 2 <= cache->count - floor; length++) {
+        plcrash_writer_cached_frame_t *second = &cache->frames[cache->count - length];
+        plcrash_writer_cached_frame_t *first = second - length;
+
+        uint32_t i;
+        for (i = 0; i < length && first[i].pc == second[i].pc; i++);
+
+        if (i == length)
+            return length;
+    }
+
+    return 0;
+}
+
+/**
+ * @internal
+ *
+ * Write all frames captured in @a cache as frame messages, including the message headers.
+ *
+ * @param file Output file
+ * @param field_id The frame message field identifier.
+ * @param cache The frame cache.
+ * @param refs If non-NULL, the report's image references. If compact, frames contained by a written image in
+ * @a refs will be written using the compact encoding, referencing the image by its position in the report's binary
+ * images.
+ */
+static size_t plcrash_writer_write_cached_frames (plcrash_async_file_t *file, uint32_t field_id, struct plcrash_log_writer_frame_cache *cache,
+                                                  plcrash_writer_image_refs_t *refs)
+{
+    size_t rv = 0;
+    uint64_t prev_offset = 0;
+
+    for (uint32_t i = 0; i < cache->count; i++) {
+        plcrash_writer_cached_frame_t *frame = &cache->frames[i];
+        plcrash_writer_compact_frame_t compact;
+        plcrash_writer_compact_frame_t *location = NULL;
+        plcrash_async_image_t *image;
+        uint32_t position;
+
+        /* Determine the compact location, if any */
+        if (refs != NULL && plcrash_writer_image_refs_find(refs, (pl_vm_address_t) frame->pc, &position, &image) && refs->compact) {
+            uint64_t offset = frame->pc - image->macho_image.header_addr;
+
+            compact.image_index = position;
+            compact.offset_delta = (int64_t) (offset - prev_offset);
+            location = &compact;
+
+            prev_offset = offset;
+        }
+
+        /* Determine the size */
+        uint32_t frame_size = plcrash_writer_write_thread_frame(NULL, frame, location);
+
+        rv += plcrash_writer_pack(file, field_id, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
+        rv += plcrash_writer_write_thread_frame(file, frame, location);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write an exception userInfo entry
+ *
+ * @param file Output file
+ * @param userInfo The userInfo dictionary entry.
+ */
+static size_t plcrash_writer_write_user_info_pair (plcrash_async_file_t *file, user_info_t userInfo) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack_string(file, PLCRASH_PROTO_EXCEPTION_USERINFO_KEY_ID, userInfo.key, userInfo.key_length);
+    rv += plcrash_writer_pack_string(file, PLCRASH_PROTO_EXCEPTION_USERINFO_SERIALIZED_ID, userInfo.serialized, userInfo.serialized_length);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_USERINFO_ARCHIVE_ID, PLPROTOBUF_C_TYPE_BOOL, &userInfo.archive);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Frame readers for which crash-time frame counts are recorded.
+ */
+typedef enum {
+    /** Compact unwind reader */
+    PLCRASH_WRITER_READER_COMPACT_UNWIND = 0,
+
+    /** DWARF unwind reader */
+    PLCRASH_WRITER_READER_DWARF_UNWIND,
+
+    /** Frame pointer reader */
+    PLCRASH_WRITER_READER_FRAME_POINTER,
+
+    /** Stack scanning reader */
+    PLCRASH_WRITER_READER_STACK_SCAN,
+
+    /** The total number of recorded frame readers */
+    PLCRASH_WRITER_READER_COUNT
+} plcrash_writer_reader_t;
+
+/**
+ * @internal
+ *
+ * Map @a reader to its plcrash_writer_reader_t value.
+ *
+ * @param reader The frame reader, as returned via plframe_cursor_t.frame_reader.
+ * @param result On success, the reader's plcrash_writer_reader_t value.
+ *
+ * @return Returns true on success, or false if @a reader is NULL or unknown.
+ */
+static bool plcrash_writer_reader_index (plframe_cursor_frame_reader_t *reader, plcrash_writer_reader_t *result) {
+    if (reader == NULL)
+        return false;
+
+#if PLCRASH_FEATURE_UNWIND_COMPACT
+    if (reader == plframe_cursor_read_compact_unwind) {
+        *result = PLCRASH_WRITER_READER_COMPACT_UNWIND;
+        return true;
+    }
+#endif
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+    if (reader == plframe_cursor_read_dwarf_unwind) {
+        *result = PLCRASH_WRITER_READER_DWARF_UNWIND;
+        return true;
+    }
+#endif
+
+    if (reader == plframe_cursor_read_frame_ptr) {
+        *result = PLCRASH_WRITER_READER_FRAME_POINTER;
+        return true;
+    }
+
+#if PLCRASH_FEATURE_UNWIND_STACK_SCAN
+    if (reader == plframe_cursor_read_stack_scan) {
+        *result = PLCRASH_WRITER_READER_STACK_SCAN;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Return the plcrash_writer_unwind_method_t unwind method of @a cursor's current frame.
+ */
+static uint8_t plcrash_writer_frame_unwind_method (plframe_cursor_t *cursor) {
+    /* The initial frame is not read from the stack, and a signal handler's interrupted frame is restored from its
+     * saved thread state */
+    if (cursor->frame_reader == NULL || cursor->frame_reader == plframe_cursor_read_sigtramp)
+        return PLCRASH_WRITER_UNWIND_METHOD_THREAD_STATE;
+
+    plcrash_writer_reader_t reader;
+    if (!plcrash_writer_reader_index(cursor->frame_reader, &reader))
+        return PLCRASH_WRITER_UNWIND_METHOD_UNKNOWN;
+
+    return PLCRASH_WRITER_UNWIND_METHOD_READER + reader;
+}
+
+/**
+ * @internal
+ *
+ * A thread's state, captured while the thread was suspended. See plcrash_log_writer_set_snapshot_threads().
+ */
+typedef struct plcrash_writer_thread_snapshot {
+    /** If true, @a cursor has been initialized from the thread's state, and must be freed. */
+    bool valid;
+
+    /** A frame cursor initialized from the thread's register state. The cursor's stack window is a copy-on-write
+     * mapping of the thread's stack at the time of the snapshot. */
+    plframe_cursor_t cursor;
+
+    /** If true, @a key contains the thread's unwind key. Only computed if the writer's unwind cache is enabled. */
+    bool has_key;
+
+    /** The thread's unwind key, computed while the thread was suspended. */
+    plcrash_writer_unwind_key_t key;
+} plcrash_writer_thread_snapshot_t;
+
+/**
+ * @internal
+ *
+ * A thread's captured stack.
+ */
+typedef struct plcrash_writer_thread_capture {
+    /** If false, the thread is excluded from the report. */
+    bool include;
+
+    /** The frame cache into which the thread's stack was walked and symbolicated. */
+    struct plcrash_log_writer_frame_cache *cache;
+
+    /** The maximum number of frames to be captured; must not exceed MAX_THREAD_FRAMES. */
+    uint32_t max_frames;
+
+    /** The number of innermost captured frames to be symbolicated; see plcrash_writer_thread_symbolicated_frames(). */
+    uint32_t symbolicated_frames;
+
+    /** If true, the thread is the crashed thread. The crashed thread's complete register state is fetched and saved
+     * to @a state, and its stack is walked in full regardless of the report deadline; all other threads are fetched
+     * with only the state required to unwind. */
+    bool crashed;
+
+    /** If true, unwinding or symbolication of the thread was cut short by the report deadline. */
+    bool truncated;
+
+    /** If true, @a key contains the thread's unwind key, and the capture may be reused by the following report. */
+    bool has_key;
+
+    /** The thread's unwind key; see plcrash_log_writer_set_unwind_cache(). */
+    plcrash_writer_unwind_key_t key;
+
+    /** If true, the thread had not moved since the previous report, and its frames were copied from the unwind
+     * cache rather than walked and symbolicated. */
+    bool cached;
+
+    /** The thread's snapshot, or NULL if threads were not snapshotted. If non-NULL, the thread itself is not
+     * accessed, and the thread's stack is not walked if the snapshot is not valid. */
+    plcrash_writer_thread_snapshot_t *snapshot;
+
+    /** If true, @a state contains the thread's initial register state. */
+    bool has_state;
+
+    /** The thread's initial register state. */
+    plcrash_async_thread_state_t state;
+
+    /** A hash of the captured frame PCs; see plcrash_writer_stack_hash(). */
+    uint64_t stack_hash;
+
+    /** If non-NULL, the report's stack table. A thread whose backtrace matches a recorded backtrace is marked as a
+     * @a duplicate, and is not symbolicated. The table is not modified. */
+    struct plcrash_log_writer_stack_table *stack_table;
+
+    /** If true, the thread's backtrace is identical to that of thread @a duplicate_of, and its frames are not written. */
+    bool duplicate;
+
+    /** The number of the earlier thread whose backtrace matches this thread's, if @a duplicate is set. */
+    uint32_t duplicate_of;
+
+    /** If true, @a stack contains a raw capture of the thread's stack, and must be freed once written. */
+    bool has_stack;
+
+    /** The thread's captured stack memory, if raw stack capture is enabled. See plcrash_log_writer_set_raw_stack_size(). */
+    plcrash_async_mobject_t stack;
+
+    /** Time spent walking the thread's stack, in mach_absolute_time() units. */
+    uint64_t unwind_time;
+
+    /** Time spent symbolicating the thread's frames, in mach_absolute_time() units. */
+    uint64_t symbolication_time;
+
+    /** The number of frames read by each of the plcrash_writer_reader_t frame readers. */
+    uint32_t reader_frames[PLCRASH_WRITER_READER_COUNT];
+
+    /** The number of failed frame reads by each of the plcrash_writer_reader_t frame readers. */
+    uint32_t reader_failures[PLCRASH_WRITER_READER_COUNT];
+
+    /** Set once a parallel capture of the thread has completed; see plcrash_writer_capture_threads(). */
+    volatile bool complete;
+} plcrash_writer_thread_capture_t;
+
+/**
+ * @internal
+ * Return the size of plcrash_writer_thread_capture_t; used to reserve capture storage prior to its definition.
+ */
+static size_t plcrash_writer_thread_capture_size (void) {
+    return sizeof(plcrash_writer_thread_capture_t);
+}
+
+/**
+ * @internal
+ *
+ * Compute the FNV-1a hash of the PC values captured in @a cache.
+ */
+static uint64_t plcrash_writer_stack_hash (struct plcrash_log_writer_frame_cache *cache) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (uint32_t i = 0; i < cache->count; i++) {
+        /* Repeated sequences are included, such that backtraces differing only in their recursion depth differ */
+        uint64_t values[] = { cache->frames[i].pc, ((uint64_t) cache->frames[i].repeat_length << 32) | cache->frames[i].repeat_count,
+                              cache->frames[i].omitted_count };
+        for (uint32_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+            for (uint32_t byte = 0; byte < sizeof(values[v]); byte++) {
+                hash ^= (uint8_t) (values[v] >> (byte * 8));
+                hash *= 1099511628211ULL;
+            }
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * @internal
+ *
+ * Look up, and optionally insert, a backtrace in @a table.
+ *
+ * @param table The stack table.
+ * @param hash The backtrace's PC hash, as returned by plcrash_writer_stack_hash().
+ * @param frame_count The backtrace's frame count.
+ * @param insert If true, and no matching backtrace is found, the backtrace will be recorded as written by
+ * @a thread_number.
+ * @param thread_number The number of the thread being written.
+ * @param original On success, the number of the thread with which the matching backtrace was written.
+ *
+ * @return Returns true if a matching backtrace was found, or false otherwise.
+ */
+static bool plcrash_writer_stack_table_find (struct plcrash_log_writer_stack_table *table, uint64_t hash, uint32_t frame_count,
+                                             bool insert, uint32_t thread_number, uint32_t *original)
+{
+    /* Linear probe for a matching or empty slot */
+    for (uint32_t probe = 0; probe < PLCRASH_WRITER_STACK_TABLE_SLOTS; probe++) {
+        uint32_t slot = ((uint32_t) hash + probe) & (PLCRASH_WRITER_STACK_TABLE_SLOTS - 1);
+        uint16_t entry = table->slots[slot];
+
+        if (entry == 0) {
+            if (!insert || table->count >= PLCRASH_WRITER_STACK_TABLE_MAX)
+                return false;
+
+            table->stacks[table->count].hash = hash;
+            table->stacks[table->count].frame_count = frame_count;
+            table->stacks[table->count].thread_number = thread_number;
+            table->slots[slot] = (uint16_t) (table->count + 1);
+            table->count++;
+            return false;
+        }
+
+        if (table->stacks[entry - 1].hash == hash && table->stacks[entry - 1].frame_count == frame_count) {
+            *original = table->stacks[entry - 1].thread_number;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Compute the unwind key of @a thread from its register @a state. The thread must be suspended.
+ *
+ * @param task The task in which @a thread is executing.
+ * @param thread The thread.
+ * @param state The thread's register state.
+ * @param key On success, the thread's unwind key.
+ *
+ * @return Returns true on success, or false if the thread's stack pointer could not be read.
+ */
+static bool plcrash_writer_unwind_key_init (task_t task, thread_t thread, plcrash_async_thread_state_t *state, plcrash_writer_unwind_key_t *key) {
+    uint8_t stack[PLCRASH_WRITER_UNWIND_KEY_STACK_SIZE];
+
+    if (!plcrash_async_thread_state_has_reg(state, PLCRASH_REG_IP) || !plcrash_async_thread_state_has_reg(state, PLCRASH_REG_SP))
+        return false;
+
+    key->thread = thread;
+    key->ip = plcrash_async_thread_state_get_reg(state, PLCRASH_REG_IP);
+    key->sp = plcrash_async_thread_state_get_reg(state, PLCRASH_REG_SP);
+
+    /* A thread blocked in its outermost frame may have less than a full window above its stack pointer; such threads
+     * are simply walked each time. */
+    if (plcrash_async_task_memcpy(task, (pl_vm_address_t) key->sp, 0, stack, sizeof(stack)) != PLCRASH_ESUCCESS)
+        return false;
+
+    key->stack_hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < sizeof(stack); i++) {
+        key->stack_hash ^= stack[i];
+        key->stack_hash *= 1099511628211ULL;
+    }
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Return the number of tail frames to be retained when capturing @a capture; see
+ * plcrash_log_writer_capture_policy_t::tail_frames.
+ */
+static uint32_t plcrash_writer_capture_tail_frames (plcrash_log_writer_t *writer, plcrash_writer_thread_capture_t *capture) {
+    return MIN(writer->capture_policy.tail_frames, capture->max_frames / 2);
+}
+
+/**
+ * @internal
+ *
+ * If the thread of @a capture has not moved since the previous report, copy its frames from the writer's unwind cache.
+ *
+ * @param writer Writer instance.
+ * @param capture The capture to be populated. The capture's key must have been computed.
+ * @param start_time The capture's start time, in mach_absolute_time() units.
+ *
+ * @return Returns true if the capture was populated from the cache, or false if the thread must be walked.
+ */
+static bool plcrash_writer_capture_from_unwind_cache (plcrash_log_writer_t *writer, plcrash_writer_thread_capture_t *capture, uint64_t start_time) {
+    struct plcrash_log_writer_unwind_cache *unwind_cache = writer->unwind_cache;
+    if (unwind_cache == NULL || !capture->has_key || capture->crashed)
+        return false;
+
+    /* Only the previous generation is read; the current generation is written by the report thread alone. */
+    const struct plcrash_writer_unwind_generation *previous = &unwind_cache->generations[unwind_cache->current ^ 1];
+    uint32_t tail_frames = plcrash_writer_capture_tail_frames(writer, capture);
+
+    for (uint32_t i = 0; i < previous->count; i++) {
+        const plcrash_writer_unwind_entry_t *entry = &previous->entries[i];
+        if (entry->key.thread != capture->key.thread || entry->key.ip != capture->key.ip || entry->key.sp != capture->key.sp ||
+            entry->key.stack_hash != capture->key.stack_hash)
+            continue;
+
+        /* An entry captured under a different frame limit can not be reused */
+        if (entry->max_frames != capture->max_frames || entry->tail_frames != tail_frames)
+            return false;
+
+        struct plcrash_log_writer_frame_cache *cache = capture->cache;
+        plcrash_async_memcpy(cache->frames, &previous->frames[entry->frame_offset], entry->frame_count * sizeof(cache->frames[0]));
+        cache->count = entry->frame_count;
+
+        capture->cached = true;
+        capture->stack_hash = plcrash_writer_stack_hash(cache);
+        if (capture->stack_table != NULL && cache->count > 0)
+            capture->duplicate = plcrash_writer_stack_table_find(capture->stack_table, capture->stack_hash, cache->count, false, 0, &capture->duplicate_of);
+
+        capture->unwind_time = mach_absolute_time() - start_time;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Record the frames of a written @a capture in the current generation of @a unwind_cache. Captures that were cut
+ * short, or whose frames were not symbolicated, are not recorded.
+ *
+ * @param writer Writer instance.
+ * @param unwind_cache The unwind cache.
+ * @param capture The written capture.
+ */
+static void plcrash_writer_unwind_cache_record (plcrash_log_writer_t *writer, struct plcrash_log_writer_unwind_cache *unwind_cache,
+                                                plcrash_writer_thread_capture_t *capture)
+{
+    struct plcrash_log_writer_frame_cache *cache = capture->cache;
+    struct plcrash_writer_unwind_generation *current = &unwind_cache->generations[unwind_cache->current];
+
+    if (!capture->has_key || capture->truncated || cache->count == 0)
+        return;
+
+    /* Duplicate backtraces are not symbolicated, unless copied from the cache */
+    if (capture->duplicate && !capture->cached)
+        return;
+
+    if (current->count == PLCRASH_WRITER_UNWIND_CACHE_THREADS_MAX || PLCRASH_WRITER_UNWIND_CACHE_FRAMES_MAX - current->frame_count < cache->count)
+        return;
+
+    plcrash_writer_unwind_entry_t *entry = &current->entries[current->count++];
+    entry->key = capture->key;
+    entry->max_frames = capture->max_frames;
+    entry->tail_frames = plcrash_writer_capture_tail_frames(writer, capture);
+    entry->frame_offset = current->frame_count;
+    entry->frame_count = cache->count;
+
+    plcrash_async_memcpy(&current->frames[entry->frame_offset], cache->frames, cache->count * sizeof(cache->frames[0]));
+    current->frame_count += cache->count;
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a thread may be captured.
+ *
+ * @param writer Writer instance.
+ * @param self The thread on which the report is being written, or MACH_PORT_NULL if writing out-of-process.
+ * @param thread The thread to be captured.
+ * @param current_state The thread state to be used when walking @a self, or NULL.
+ */
+static bool plcrash_writer_should_capture_thread (plcrash_log_writer_t *writer, thread_t self, thread_t thread, plcrash_async_thread_state_t *current_state) {
+    /* Can't log a report for the current thread without a valid context. */
+    if (thread == self && current_state == NULL)
+        return false;
+
+    /* Worker threads are never suspended, and can not be safely walked */
+    if (plcrash_log_writer_workers_contains(writer->workers, thread))
+        return false;
+
+    return true;
+}
+
+/**
+ * @internal
+ *
+ * Return the maximum number of frames to be captured for a thread, as per the writer's capture policy.
+ *
+ * @param writer Writer instance.
+ * @param crashed If true, the thread is the crashed thread, and is not subject to the policy's frame limit.
+ */
+static uint32_t plcrash_writer_thread_max_frames (plcrash_log_writer_t *writer, bool crashed) {
+    if (crashed || writer->capture_policy.max_thread_frames == 0)
+        return MAX_THREAD_FRAMES;
+
+    return writer->capture_policy.max_thread_frames;
+}
+
+/**
+ * @internal
+ *
+ * Return the number of innermost frames to be symbolicated for a thread, as per the writer's capture policy.
+ *
+ * @param writer Writer instance.
+ * @param crashed If true, the thread is the crashed thread, and is symbolicated in full.
+ * @param index The thread's task_threads() index. As the kernel returns threads in creation order, the thread at
+ * index 0 is the main thread, and is symbolicated in full.
+ */
+static uint32_t plcrash_writer_thread_symbolicated_frames (plcrash_log_writer_t *writer, bool crashed, mach_msg_type_number_t index) {
+    if (crashed || index == 0 || writer->capture_policy.max_symbolicated_frames == 0)
+        return MAX_THREAD_FRAMES;
+
+    return writer->capture_policy.max_symbolicated_frames;
+}
+
+/**
+ * @internal
+ *
+ * Map a capture @a position to the corresponding task_threads() index when capturing the thread at @a first_index
+ * before all others. The remaining threads are captured in task_threads() order; as the kernel returns threads in
+ * creation order, the main thread is captured immediately after @a first_index.
+ *
+ * @param position The capture position.
+ * @param first_index The task_threads() index of the thread to be captured first.
+ */
+static mach_msg_type_number_t plcrash_writer_thread_capture_index (mach_msg_type_number_t position, mach_msg_type_number_t first_index) {
+    if (position == 0)
+        return first_index;
+
+    if (position - 1 < first_index)
+        return position - 1;
+
+    return position;
+}
+
+/**
+ * @internal
+ *
+ * Return true if the deadline of the report being written has passed.
+ *
+ * @param writer Writer instance.
+ */
+static bool plcrash_writer_deadline_passed (plcrash_log_writer_t *writer) {
+    return writer->deadline != 0 && mach_absolute_time() >= writer->deadline;
+}
+
+/**
+ * @internal
+ *
+ * Return true if the writer's capture time or size budget has been exhausted.
+ *
+ * @param writer Writer instance.
+ * @param file The report output file.
+ */
+static bool plcrash_writer_capture_budget_exhausted (plcrash_log_writer_t *writer, plcrash_async_file_t *file) {
+    if (plcrash_writer_deadline_passed(writer))
+        return true;
+
+    if (writer->capture_policy.size_budget != 0 && (uint64_t) plcrash_async_file_tell(file) >= writer->capture_policy.size_budget)
+        return true;
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * The number of bytes below the stack pointer included in a raw stack capture on downward-growing stacks. This
+ * covers the x86-64 ABI's red zone, which leaf functions may use without adjusting the stack pointer.
+ */
+#define PLCRASH_WRITER_RAW_STACK_RED_ZONE 128
+
+/**
+ * @internal
+ *
+ * Save @a state to @a capture, and map the thread's raw stack window into @a capture's stack. If the stack can
+ * not be mapped, only the thread state is saved.
+ *
+ * @param writer Writer instance.
+ * @param task The task in which the thread is executing.
+ * @param state The thread's register state.
+ * @param capture The capture to be populated.
+ */
+static void plcrash_writer_capture_raw_stack (plcrash_log_writer_t *writer,
+                                              task_t task,
+                                              plcrash_async_thread_state_t *state,
+                                              plcrash_writer_thread_capture_t *capture)
+{
+    capture->state = *state;
+    capture->has_state = true;
+
+    if (!plcrash_async_thread_state_has_reg(state, PLCRASH_REG_SP))
+        return;
+
+    pl_vm_address_t sp = (pl_vm_address_t) plcrash_async_thread_state_get_reg(state, PLCRASH_REG_SP);
+    pl_vm_address_t base;
+
+    /* Caller frames are found above the stack pointer on downward-growing stacks, and below it otherwise */
+    if (plcrash_async_thread_state_get_stack_direction(state) == PLCRASH_ASYNC_THREAD_STACK_DIRECTION_UP) {
+        if (sp < writer->raw_stack_size)
+            return;
+        base = sp - writer->raw_stack_size;
+    } else {
+        if (sp < PLCRASH_WRITER_RAW_STACK_RED_ZONE)
+            return;
+        base = sp - PLCRASH_WRITER_RAW_STACK_RED_ZONE;
+    }
+
+    /* Short mappings are permitted; the capture is simply truncated at the end of the stack. */
+    if (plcrash_async_mobject_init(&capture->stack, task, base, writer->raw_stack_size, false) == PLCRASH_ESUCCESS)
+        capture->has_stack = true;
+}
+
+/**
+ * @internal
+ *
+ * Release the raw stack mapping of @a capture, if any.
+ */
+static void plcrash_writer_capture_free_raw_stack (plcrash_writer_thread_capture_t *capture) {
+    if (capture->has_stack) {
+        plcrash_async_mobject_free(&capture->stack);
+        capture->has_stack = false;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Step @a cursor to the next frame, recording any frame readers that failed in @a capture.
+ */
+static plframe_error_t plcrash_writer_cursor_next (plframe_cursor_t *cursor, plcrash_writer_thread_capture_t *capture) {
+    plframe_error_t ferr = plframe_cursor_next(cursor);
+
+    for (uint32_t i = 0; i < cursor->failed_reader_count; i++) {
+        plcrash_writer_reader_t reader;
+        if (plcrash_writer_reader_index(cursor->failed_readers[i], &reader))
+            capture->reader_failures[reader]++;
+    }
+
+    return ferr;
+}
+
+/**
+ * @internal
+ *
+ * Walk and symbolicate a thread's stack into @a capture.
+ *
+ * @param writer Writer instance.
+ * @param task The task in which @a thread is executing.
+ * @param thread Thread to be walked.
+ * @param thread_ctx Thread state to use for stack walking. If NULL, the thread state will be fetched from @a thread. If
+ * @a thread is the currently executing thread, <em>must</em> be non-NULL.
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ * @param sectionCache Unwind section cache.
+ * @param capture The capture to be populated. The capture's @a cache must be allocated by the caller.
+ */
+static void plcrash_writer_capture_thread (plcrash_log_writer_t *writer,
+                                           task_t task,
+                                           thread_t thread,
+                                           plcrash_async_thread_state_t *thread_ctx,
+                                           plcrash_async_image_list_t *image_list,
+                                           plcrash_async_symbol_cache_t *findContext,
+                                           plcrash_async_macho_section_cache_t *sectionCache,
+                                           plcrash_writer_thread_capture_t *capture)
+{
+    plframe_cursor_t thread_cursor;
+    plframe_cursor_t *cursor = &thread_cursor;
+    plframe_error_t ferr;
+
+    /* A context must be supplied when walking the current thread */
+    PLCF_ASSERT(task != mach_task_self() || thread_ctx != NULL || thread != pl_mach_thread_self());
+    PLCF_ASSERT(capture->max_frames <= MAX_THREAD_FRAMES);
+
+    struct plcrash_log_writer_frame_cache *cache = capture->cache;
+    cache->count = 0;
+    capture->has_state = false;
+    capture->has_stack = false;
+    capture->duplicate = false;
+    capture->truncated = false;
+    capture->cached = false;
+    capture->unwind_time = 0;
+    capture->symbolication_time = 0;
+    plcrash_async_memset(capture->reader_frames, 0, sizeof(capture->reader_frames));
+    plcrash_async_memset(capture->reader_failures, 0, sizeof(capture->reader_failures));
+
+    uint64_t start_time = mach_absolute_time();
+
+    /* Set up the frame cursor. */
+    if (capture->snapshot != NULL) {
+        /* Walk the snapshotted state; the thread itself may no longer be suspended. */
+        if (!capture->snapshot->valid)
+            return;
+
+        /* Reuse the thread's previous capture if it has not moved since the previous report */
+        capture->has_key = capture->snapshot->has_key;
+        capture->key = capture->snapshot->key;
+        if (plcrash_writer_capture_from_unwind_cache(writer, capture, start_time))
+            return;
+
+        cursor = &capture->snapshot->cursor;
+        plframe_cursor_set_section_cache(cursor, sectionCache);
+    } else {
+        /* Use the provided context if available, otherwise initialize a new thread context
+         * from the target thread's state. */
+        plcrash_async_thread_state_t cursor_thr_state;
+        if (thread_ctx) {
+            cursor_thr_state = *thread_ctx;
+        } else {
+            /* Threads whose registers are not written require only the general purpose state used by the unwinder */
+            plcrash_error_t err;
+            if (capture->crashed || writer->raw_stack_size != 0)
+                err = plcrash_async_thread_state_mach_thread_init(&cursor_thr_state, thread);
+            else
+                err = plcrash_async_thread_state_mach_thread_minimal_init(&cursor_thr_state, thread);
+
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_THREAD_STATE_FAILED, thread, err, 0);
+                return;
+            }
+        }
+
+        /* In raw stack mode, the state is saved and the stack captured for offline unwinding */
+        if (writer->raw_stack_size != 0) {
+            plcrash_writer_capture_raw_stack(writer, task, &cursor_thr_state, capture);
+            capture->unwind_time = mach_absolute_time() - start_time;
+            return;
+        }
+
+        /* Reuse the thread's previous capture if it has not moved since the previous report */
+        if (writer->unwind_cache != NULL && !capture->crashed)
+            capture->has_key = plcrash_writer_unwind_key_init(task, thread, &cursor_thr_state, &capture->key);
+        if (plcrash_writer_capture_from_unwind_cache(writer, capture, start_time))
+            return;
+
+        /* Initialize the cursor */
+        ferr = plframe_cursor_init(cursor, task, &cursor_thr_state, image_list);
+        if (ferr != PLFRAME_ESUCCESS) {
+            PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_CURSOR_INIT_FAILED, thread, ferr, 0);
+            return;
+        }
+
+        /* Share section mappings across all frames and threads */
+        plframe_cursor_set_section_cache(cursor, sectionCache);
+        plframe_cursor_set_pipeline(cursor, PLFRAME_CURSOR_PIPELINE_ACCURATE);
+    }
+
+    /* Walk the stack into the frame cache, limiting the total number of frames that are output. Repeating frame
+     * sequences, such as those of a runaway recursion, are collapsed as they are walked; the repetitions do not count
+     * against the frame limit, allowing the frames beyond the recursion to be captured.
+     *
+     * If tail frames are to be retained, a stack exceeding the frame limit is walked in full, without symbolication,
+     * retaining its outermost frames in a ring buffer following the head frames. */
+    uint32_t tail_frames = plcrash_writer_capture_tail_frames(writer, capture);
+    uint32_t head_limit = capture->max_frames - tail_frames;
+    uint32_t tail_walked = 0;
+    uint32_t walked = 0;
+    uint32_t repeat_length = 0;
+    uint32_t repeat_phase = 0;
+    uint32_t repeat_floor = 0;
+    while ((tail_frames > 0 || repeat_length > 0 || cache->count < head_limit) && walked < PLCRASH_WRITER_WALK_FRAMES_MAX &&
+           (ferr = plcrash_writer_cursor_next(cursor, capture)) == PLFRAME_ESUCCESS)
+    {
+        /* On the first frame, save the registers */
+        if (walked++ == 0 && capture->crashed) {
+            capture->state = plframe_cursor_get_frame(cursor)->thread_state;
+            capture->has_state = true;
+        }
+
+        /* Fetch the PC value */
+        plcrash_greg_t pc = 0;
+        if ((ferr = plframe_cursor_get_reg(cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS) {
+            PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_FRAME_PC_FAILED, thread, ferr, 0);
+            break;
+        }
+
+        /* Within a repeated sequence, frames matching the sequence are counted rather than captured */
+        bool capture_frame = true;
+        if (repeat_length > 0) {
+            uint32_t start = cache->count - repeat_length;
+            if (cache->frames[start + repeat_phase].pc == pc) {
+                if (++repeat_phase == repeat_length) {
+                    cache->frames[cache->count - 1].repeat_count++;
+                    repeat_phase = 0;
+                }
+                capture_frame = false;
+            } else {
+                /* The sequence has ended; capture any frames of the partially matched final repetition */
+                for (uint32_t i = 0; i < repeat_phase; i++) {
+                    plcrash_writer_frame_cache_push(cache, head_limit, tail_frames, &tail_walked, cache->frames[start + i].pc,
+                                                    cache->frames[start + i].unwind_method);
+                }
+
+                repeat_floor = cache->count;
+                repeat_length = 0;
+                repeat_phase = 0;
+            }
+        }
+
+        /* Repetitions are only collapsed within the head frames */
+        uint8_t unwind_method = plcrash_writer_frame_unwind_method(cursor);
+        if (capture_frame && plcrash_writer_frame_cache_push(cache, head_limit, tail_frames, &tail_walked, pc, unwind_method)) {
+            /* If the frame completes a second copy of a sequence, collapse the copy into a repetition */
+            if ((repeat_length = plcrash_writer_frame_cache_find_repeat(cache, repeat_floor)) > 0) {
+                cache->count -= repeat_length;
+                cache->frames[cache->count - 1].repeat_length = repeat_length;
+                cache->frames[cache->count - 1].repeat_count = 1;
+            }
+        }
+
+        /* Note the reader that produced the frame */
+        plcrash_writer_reader_t reader;
+        if (plcrash_writer_reader_index(cursor->frame_reader, &reader))
+            capture->reader_frames[reader]++;
+
+        /* Stop walking any thread other than the crashed thread once the report deadline has passed */
+        if (!capture->crashed && plcrash_writer_deadline_passed(writer)) {
+            capture->truncated = true;
+            ferr = PLFRAME_ENOFRAME;
+            break;
+        }
+    }
+
+    /* Capture any frames of a partially walked final repetition, and append the retained tail frames */
+    if (repeat_length > 0) {
+        uint32_t start = cache->count - repeat_length;
+        for (uint32_t i = 0; i < repeat_phase; i++) {
+            plcrash_writer_frame_cache_push(cache, head_limit, tail_frames, &tail_walked, cache->frames[start + i].pc,
+                                            cache->frames[start + i].unwind_method);
+        }
+    }
+    plcrash_writer_frame_cache_finish_tail(cache, head_limit, tail_frames, tail_walked);
+
+    uint64_t unwind_end_time = mach_absolute_time();
+    capture->unwind_time = unwind_end_time - start_time;
+    capture->stack_hash = plcrash_writer_stack_hash(cache);
+
+    /* A backtrace identical to one already written is written by reference, and need not be symbolicated */
+    if (capture->stack_table != NULL && !capture->crashed && cache->count > 0)
+        capture->duplicate = plcrash_writer_stack_table_find(capture->stack_table, capture->stack_hash, cache->count, false, 0, &capture->duplicate_of);
+
+    /* Symbolicate the captured frames. Symbolication is the first stage to be skipped once the report deadline has
+     * passed; the frame PCs are sufficient to symbolicate the report after the fact. */
+    if (capture->duplicate) {
+        /* Nothing to symbolicate */
+    } else if (plcrash_writer_deadline_passed(writer)) {
+        for (uint32_t i = 0; i < cache->count; i++)
+            cache->frames[i].symbol.found = false;
+        capture->truncated = true;
+    } else {
+        plcrash_writer_frame_cache_symbolicate(writer, cache, capture->symbolicated_frames, image_list, findContext);
+    }
+    capture->symbolication_time = mach_absolute_time() - unwind_end_time;
+
+    /* Did we reach the end successfully? */
+    if (ferr != PLFRAME_ENOFRAME) {
+        /* This is non-fatal, and in some circumstances -could- be caused by reaching the end of the stack if the
+         * final frame pointer is not NULL. */
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED, thread, ferr, walked);
+    }
+
+    /* Snapshot cursors are owned by the caller */
+    if (capture->snapshot == NULL)
+        plframe_cursor_free(cursor);
+}
+
+/**
+ * @internal
+ *
+ * Snapshot the state of all capturable @a threads. Each thread's cursor is initialized from its register state,
+ * mapping the stack window surrounding its stack pointer; once this function returns, the threads may be resumed,
+ * and their stacks walked against the returned snapshots.
+ *
+ * @param writer Writer instance.
+ * @param task The task containing @a threads.
+ * @param self The thread on which the report is being written, or MACH_PORT_NULL if @a task is not the current task.
+ * @param crashed_thread The crashed thread, for which the complete register state is fetched.
+ * @param threads The suspended threads to be snapshotted.
+ * @param thread_count The number of entries in @a threads.
+ * @param current_state The state to use for the current thread, or NULL.
+ * @param image_list The Mach-O image list.
+ *
+ * @return Returns an array of @a thread_count snapshots, indexed as per @a threads, or NULL if the snapshots could not
+ * be allocated. The array must be freed with plcrash_writer_free_snapshots().
+ */
+static plcrash_writer_thread_snapshot_t *plcrash_writer_snapshot_threads (plcrash_log_writer_t *writer,
+                                                                           task_t task,
+                                                                           thread_t self,
+                                                                           thread_t crashed_thread,
+                                                                           thread_act_array_t threads,
+                                                                           mach_msg_type_number_t thread_count,
+                                                                           plcrash_async_thread_state_t *current_state,
+                                                                           plcrash_async_image_list_t *image_list)
+{
+    plcrash_writer_thread_snapshot_t *snapshots = calloc(thread_count, sizeof(*snapshots));
+    if (snapshots == NULL) {
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_SNAPSHOT_ALLOC_FAILED, thread_count, 0, 0);
+        return NULL;
+    }
+
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        plcrash_async_thread_state_t state;
+        plcrash_error_t err;
+
+        if (!plcrash_writer_should_capture_thread(writer, self, threads[i], current_state))
+            continue;
+
+        /* Only the crashed thread's registers are written; all others require only the unwinder's state */
+        if (threads[i] == self) {
+            state = *current_state;
+        } else {
+            if (threads[i] == crashed_thread)
+                err = plcrash_async_thread_state_mach_thread_init(&state, threads[i]);
+            else
+                err = plcrash_async_thread_state_mach_thread_minimal_init(&state, threads[i]);
+
+            if (err != PLCRASH_ESUCCESS) {
+                PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_THREAD_STATE_FAILED, threads[i], err, 0);
+                continue;
+            }
+        }
+
+        plframe_error_t ferr = plframe_cursor_init(&snapshots[i].cursor, task, &state, image_list);
+        if (ferr != PLFRAME_ESUCCESS) {
+            PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_CURSOR_INIT_FAILED, threads[i], ferr, 0);
+            plframe_cursor_free(&snapshots[i].cursor);
+            continue;
+        }
+
+        /* The stack must be hashed before the thread is resumed */
+        if (writer->unwind_cache != NULL && threads[i] != crashed_thread)
+            snapshots[i].has_key = plcrash_writer_unwind_key_init(task, threads[i], &state, &snapshots[i].key);
+
+        snapshots[i].valid = true;
+    }
+
+    return snapshots;
+}
+
+/**
+ * @internal
+ *
+ * Free all thread snapshots allocated by plcrash_writer_snapshot_threads().
+ *
+ * @param snapshots The snapshots to be freed.
+ * @param thread_count The number of entries in @a snapshots.
+ */
+static void plcrash_writer_free_snapshots (plcrash_writer_thread_snapshot_t *snapshots, mach_msg_type_number_t thread_count) {
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (snapshots[i].valid)
+            plframe_cursor_free(&snapshots[i].cursor);
+    }
+
+    free(snapshots);
+}
+
+/**
+ * @internal
+ *
+ * Resume all of @a threads suspended by plcrash_log_writer_write_task().
+ *
+ * @param writer Writer instance.
+ * @param self The thread on which the report is being written, or MACH_PORT_NULL.
+ * @param threads The suspended threads.
+ * @param thread_count The number of entries in @a threads.
+ */
+static void plcrash_writer_resume_threads (plcrash_log_writer_t *writer, thread_t self, thread_act_array_t threads, mach_msg_type_number_t thread_count) {
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (threads[i] != self && !plcrash_log_writer_workers_contains(writer->workers, threads[i]))
+            thread_resume(threads[i]);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Capture the scheduling state of all of @a threads into the writer's thread info table, if enabled. This is performed
+ * in a single pass before the threads are suspended, ensuring that the recorded run states reflect the threads' states
+ * at the time of the report, rather than their suspension; each thread requires only a few thread_info() calls.
+ *
+ * @param writer The writer.
+ * @param threads The threads to be captured, in task_threads() order.
+ * @param thread_count The number of entries in @a threads.
+ */
+static void plcrash_writer_capture_thread_info (plcrash_log_writer_t *writer, thread_act_array_t threads, mach_msg_type_number_t thread_count) {
+    struct plcrash_log_writer_thread_info_table *table = writer->thread_info;
+    if (table == NULL)
+        return;
+
+    table->count = (uint32_t) MIN(thread_count, PLCRASH_WRITER_THREAD_INFO_MAX);
+    for (uint32_t i = 0; i < table->count; i++) {
+        plcrash_writer_thread_info_t *info = &table->threads[i];
+        mach_msg_type_number_t count;
+
+        plcrash_async_memset(info, 0, sizeof(*info));
+
+        thread_basic_info_data_t basic;
+        count = THREAD_BASIC_INFO_COUNT;
+        if (thread_info(threads[i], THREAD_BASIC_INFO, (thread_info_t) &basic, &count) != KERN_SUCCESS)
+            continue;
+
+        info->valid = true;
+        info->user_time = (uint64_t) basic.user_time.seconds * 1000000 + (uint64_t) basic.user_time.microseconds;
+        info->system_time = (uint64_t) basic.system_time.seconds * 1000000 + (uint64_t) basic.system_time.microseconds;
+        info->cpu_usage = (uint32_t) basic.cpu_usage;
+        info->run_state = (uint32_t) basic.run_state;
+        info->flags = (uint32_t) basic.flags;
+        info->sleep_time = (uint32_t) basic.sleep_time;
+
+        struct thread_extended_info extended;
+        count = THREAD_EXTENDED_INFO_COUNT;
+        if (thread_info(threads[i], THREAD_EXTENDED_INFO, (thread_info_t) &extended, &count) == KERN_SUCCESS) {
+            info->has_extended = true;
+            info->base_priority = extended.pth_priority;
+            info->current_priority = extended.pth_curpri;
+
+            size_t len = MIN(sizeof(extended.pth_name), sizeof(info->name) - 1);
+            plcrash_async_memcpy(info->name, extended.pth_name, len);
+            info->name[len] = '\0';
+        }
+
+        struct thread_qos_policy qos;
+        boolean_t get_default = FALSE;
+        count = THREAD_QOS_POLICY_COUNT;
+        if (thread_policy_get(threads[i], THREAD_QOS_POLICY, (thread_policy_t) &qos, &count, &get_default) == KERN_SUCCESS) {
+            info->has_qos = true;
+            info->qos_class = (uint32_t) qos.qos_tier;
+        }
+    }
+}
+
+/**
+ * @internal
+ *
+ * Write a thread scheduling state message.
+ *
+ * @param file Output file, or NULL to compute the message size.
+ * @param info The thread's captured scheduling state.
+ */
+static size_t plcrash_writer_write_thread_info (plcrash_async_file_t *file, const plcrash_writer_thread_info_t *info) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_THREAD_SCHEDULING_USER_TIME_ID, info->user_time);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_THREAD_SCHEDULING_SYSTEM_TIME_ID, info->system_time);
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_SCHEDULING_CPU_USAGE_ID, info->cpu_usage);
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_SCHEDULING_RUN_STATE_ID, info->run_state);
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_SCHEDULING_FLAGS_ID, info->flags);
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_SCHEDULING_SLEEP_TIME_ID, info->sleep_time);
+
+    if (info->has_extended) {
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_SCHEDULING_BASE_PRIORITY_ID, PLPROTOBUF_C_TYPE_INT32, &info->base_priority);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_SCHEDULING_CURRENT_PRIORITY_ID, PLPROTOBUF_C_TYPE_INT32, &info->current_priority);
+        if (info->name[0] != '\0')
+            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_SCHEDULING_NAME_ID, PLPROTOBUF_C_TYPE_STRING, info->name);
+    }
 
-    /* OS Version */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, writer->system_info.version);
-    
-    /* OS Build */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_OS_BUILD_ID, PLPROTOBUF_C_TYPE_STRING, writer->system_info.build);
+    if (info->has_qos)
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_THREAD_SCHEDULING_QOS_CLASS_ID, info->qos_class);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a raw stack memory message.
+ *
+ * @param file Output file, or NULL to compute the message size.
+ * @param stack The raw stack mapping.
+ */
+static size_t plcrash_writer_write_stack_memory (plcrash_async_file_t *file, plcrash_async_mobject_t *stack) {
+    size_t rv = 0;
+    uint64_t address = plcrash_async_mobject_base_address(stack);
+
+    PLProtobufCBinaryData data;
+    data.len = plcrash_async_mobject_length(stack);
+    data.data = plcrash_async_mobject_remap_address(stack, stack->task_address, 0, data.len);
+    if (data.data == NULL)
+        data.len = 0;
+
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_STACK_MEMORY_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &address);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_STACK_MEMORY_DATA_ID, PLPROTOBUF_C_TYPE_BYTES, &data);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Write a thread message
+ *
+ * @param file Output file
+ * @param task The task in which the thread is executing.
+ * @param thread_number The thread's index number.
+ * @param capture The thread's captured stack, as populated by plcrash_writer_capture_thread().
+ * @param crashed If true, mark this as a crashed thread.
+ * @param refs If non-NULL, the image references to be used to write compact frames; see
+ * plcrash_writer_write_cached_frames().
+ * @param info If non-NULL, the thread's scheduling state.
+ * @param typed_registers If true, write the thread's registers as a compact (v2) typed RegisterState.
+ * @param annotator If non-NULL, the thread's register values are annotated with their containing images and symbols;
+ * see plcrash_writer_annotate_registers().
+ */
+static size_t plcrash_writer_write_thread (plcrash_async_file_t *file,
+                                           task_t task,
+                                           uint32_t thread_number,
+                                           plcrash_writer_thread_capture_t *capture,
+                                           bool crashed,
+                                           plcrash_writer_image_refs_t *refs,
+                                           const plcrash_writer_thread_info_t *info,
+                                           bool typed_registers,
+                                           plcrash_writer_register_annotator_t *annotator)
+{
+    size_t rv = 0;
+
+    /* Write the thread ID */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_THREAD_NUMBER_ID, PLPROTOBUF_C_TYPE_UINT32, &thread_number);
+
+    /* Note crashed status */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_CRASHED_ID, PLPROTOBUF_C_TYPE_BOOL, &crashed);
+
+    /* Dump registers for the crashed thread, and for all threads captured for offline unwinding */
+    if ((crashed || capture->has_stack) && capture->has_state) {
+        /* Annotate the registers once; the annotations are used to both size and write the register messages */
+        plcrash_writer_register_annotation_t annotations[PLCRASH_WRITER_ANNOTATED_REGISTERS_MAX];
+        const plcrash_writer_register_annotation_t *regAnnotations = NULL;
+        if (annotator != NULL && plcrash_async_thread_state_get_reg_count(&capture->state) <= PLCRASH_WRITER_ANNOTATED_REGISTERS_MAX) {
+            plcrash_writer_annotate_registers(annotator, &capture->state, annotations);
+            regAnnotations = annotations;
+        }
+
+        if (typed_registers) {
+            rv += plcrash_writer_write_register_state(file, &capture->state, regAnnotations);
+        } else {
+            rv += plcrash_writer_write_thread_registers(file, task, &capture->state, regAnnotations);
+        }
+    }
 
-    /* Machine type */
-    enumval = PLCrashReportHostArchitecture;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ARCHITECTURE_TYPE_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+    /* Write out the stack frames, or the reference to the identical backtrace of an earlier thread. */
+    if (capture->duplicate) {
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_DUPLICATE_OF_THREAD_ID, PLPROTOBUF_C_TYPE_UINT32, &capture->duplicate_of);
+    } else {
+        rv += plcrash_writer_write_cached_frames(file, PLCRASH_PROTO_THREAD_FRAMES_ID, capture->cache, refs);
+    }
 
-    /* Timestamp */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_TIMESTAMP_ID, PLPROTOBUF_C_TYPE_INT64, &timestamp);
+    /* Write out the raw stack, if captured */
+    if (capture->has_stack) {
+        uint32_t size = (uint32_t) plcrash_writer_write_stack_memory(NULL, &capture->stack);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_STACK_MEMORY_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_stack_memory(file, &capture->stack);
+    }
+
+    /* Write out the scheduling state, if captured */
+    if (info != NULL && info->valid) {
+        uint32_t size = (uint32_t) plcrash_writer_write_thread_info(NULL, info);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_SCHEDULING_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_thread_info(file, info);
+    }
 
     return rv;
 }
@@ -633,298 +5149,508 @@ static size_t plcrash_writer_write_system_info (plcrash_async_file_t *file, plcr
 /**
  * @internal
  *
- * Write the processor info message.
- *
- * @param file Output file
- * @param cpu_type The Mach CPU type.
- * @param cpu_subtype_t The Mach CPU subtype
+ * Parallel thread capture state.
  */
-static size_t plcrash_writer_write_processor_info (plcrash_async_file_t *file, uint64_t cpu_type, uint64_t cpu_subtype) {
-    size_t rv = 0;
-    uint32_t enumval;
-    
-    /* Encoding */
-    enumval = PLCrashReportProcessorTypeEncodingMach;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_ENCODING_ID, PLPROTOBUF_C_TYPE_ENUM, &enumval);
+struct plcrash_writer_parallel_capture {
+    /** Writer instance. */
+    plcrash_log_writer_t *writer;
 
-    /* Type */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_TYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_type);
+    /** The task containing @a threads. */
+    task_t task;
 
-    /* Subtype */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESSOR_SUBTYPE_ID, PLPROTOBUF_C_TYPE_UINT64, &cpu_subtype);
-    
-    return rv;
+    /** The thread on which the report is being written, or MACH_PORT_NULL if writing for another task. */
+    thread_t self;
+
+    /** The threads to be captured. */
+    thread_act_array_t threads;
+
+    /** The state to use when walking the current thread, or NULL. */
+    plcrash_async_thread_state_t *current_state;
+
+    /** The Mach-O image list. */
+    plcrash_async_image_list_t *image_list;
+
+    /** Per-thread captures. */
+    plcrash_writer_thread_capture_t *captures;
+
+    /** Per-worker symbol caches; the symbol cache may not be used concurrently. */
+    plcrash_async_symbol_cache_t *symbol_caches;
+
+    /** Per-worker section caches; the section cache may not be used concurrently. */
+    plcrash_async_macho_section_cache_t *section_caches;
+};
+
+/**
+ * @internal
+ * Worker job used to capture a single thread; see plcrash_writer_capture_threads().
+ */
+static void plcrash_writer_capture_thread_job (void *ctx, uint32_t worker, size_t index) {
+    struct plcrash_writer_parallel_capture *pc = ctx;
+    plcrash_writer_thread_capture_t *capture = &pc->captures[index];
+    thread_t thread = pc->threads[index];
+
+    if (!capture->include)
+        return;
+
+    plcrash_async_thread_state_t *thr_ctx = (thread == pc->self) ? pc->current_state : NULL;
+    plcrash_writer_capture_thread(pc->writer, pc->task, thread, thr_ctx, pc->image_list,
+                                  &pc->symbol_caches[worker], &pc->section_caches[worker], capture);
+
+    OSMemoryBarrier();
+    capture->complete = true;
 }
 
 /**
  * @internal
  *
- * Write the machine info message.
+ * Capture all included threads in parallel, using the writer's worker pool. Each thread is captured into a
+ * separately allocated frame cache, allowing the results to be written in thread order.
  *
- * @param file Output file
+ * @param writer Writer instance. The writer's worker pool must be non-NULL.
+ * @param task The task containing @a threads.
+ * @param self The thread on which the report is being written, or MACH_PORT_NULL if @a task is not the current task.
+ * @param threads The threads to be captured.
+ * @param captures The per-thread captures; only entries marked for inclusion will be populated.
+ * @param thread_count The number of entries in @a threads and @a captures.
+ * @param current_state The state to use when walking the current thread, or NULL.
+ * @param image_list The Mach-O image list. Must be marked for reading by the caller.
+ *
+ * @return Returns true on success, or false if the required resources could not be allocated or, for reentrant
+ * writers, the pool is busy with another writer's report; in either case, the captures should be performed serially.
  */
-static size_t plcrash_writer_write_machine_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
-    size_t rv = 0;
-    
-    /* Model */
-    if (writer->machine_info.model != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_MODEL_ID, PLPROTOBUF_C_TYPE_STRING, writer->machine_info.model);
+static bool plcrash_writer_capture_threads (plcrash_log_writer_t *writer,
+                                            task_t task,
+                                            thread_t self,
+                                            thread_act_array_t threads,
+                                            plcrash_writer_thread_capture_t *captures,
+                                            mach_msg_type_number_t thread_count,
+                                            plcrash_async_thread_state_t *current_state,
+                                            plcrash_async_image_list_t *image_list)
+{
+    plcrash_log_writer_workers_t *workers = writer->workers;
+    uint32_t worker_count = workers->count + 1;
+    bool async_safe = workers->async_safe;
+    bool result = false;
+    bool abandoned = false;
+
+    /* A pool may be shared by multiple writers, but only runs one job at a time. Reentrant writers do not wait on a
+     * busy pool, as its current job may belong to a writer that is suspended by this writer. */
+    if (!async_safe) {
+        if (!writer->reentrant) {
+            pthread_mutex_lock(&workers->submit_lock);
+        } else if (pthread_mutex_trylock(&workers->submit_lock) != 0) {
+            return false;
+        }
+    }
 
-    /* Processor */
-    {
-        uint32_t size;
+    /* Async-safe pools provide pre-allocated caches, and capture a bounded number of threads */
+    struct plcrash_writer_parallel_capture pc = {
+        .writer = writer,
+        .task = task,
+        .self = self,
+        .threads = threads,
+        .current_state = current_state,
+        .image_list = image_list,
+        .captures = captures,
+        .symbol_caches = async_safe ? workers->symbol_caches : calloc(worker_count, sizeof(plcrash_async_symbol_cache_t)),
+        .section_caches = async_safe ? workers->section_caches : calloc(worker_count, sizeof(plcrash_async_macho_section_cache_t))
+    };
+
+    uint32_t symbol_caches = 0;
+    if (pc.symbol_caches == NULL || pc.section_caches == NULL)
+        goto cleanup;
+
+    if (async_safe && thread_count > workers->max_threads)
+        goto cleanup;
+
+    /* Allocate the per-thread frame caches */
+    for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+        if (!captures[i].include)
+            continue;
+
+        if ((captures[i].cache = plcrash_log_writer_workers_alloc(workers, sizeof(*captures[i].cache))) == NULL)
+            goto cleanup;
+        captures[i].cache->count = 0;
+    }
 
-        /* Determine size */
-        size = plcrash_writer_write_processor_info(NULL, writer->machine_info.cpu_type, writer->machine_info.cpu_subtype);
+    /* Set up the per-worker caches */
+    for (; symbol_caches < worker_count; symbol_caches++) {
+        if (plcrash_async_symbol_cache_init(&pc.symbol_caches[symbol_caches]) != PLCRASH_ESUCCESS)
+            goto cleanup;
+
+        /* An async-safe pool's CIE caches are pre-allocated, and retained across reports */
+        struct plframe_dwarf_cie_cache *cie_cache = async_safe ? pc.section_caches[symbol_caches].dwarf_cie_cache : NULL;
+        plcrash_async_macho_section_cache_init(&pc.section_caches[symbol_caches]);
+
+        /* The workers share the report's work budget, and as the live report path, may publish shared cache
+         * IMP indices */
+        pc.symbol_caches[symbol_caches].objc_cache.workBudget = &writer->work_budget;
+        if (!async_safe && task == image_list->task)
+            pc.symbol_caches[symbol_caches].objc_cache.sharedCache = plcrash_async_image_list_get_shared_cache(image_list);
+        pc.section_caches[symbol_caches].work_budget = &writer->work_budget;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        /* The CIE cache is optional; on allocation failure, the worker simply unwinds without it. */
+        if (async_safe) {
+            if (cie_cache != NULL)
+                plframe_dwarf_cie_cache_reset(cie_cache);
+            pc.section_caches[symbol_caches].dwarf_cie_cache = cie_cache;
+        } else if (plframe_dwarf_cie_cache_new(&pc.section_caches[symbol_caches].dwarf_cie_cache) != PLCRASH_ESUCCESS) {
+            pc.section_caches[symbol_caches].dwarf_cie_cache = NULL;
+        }
+#else
+        (void) cie_cache;
+#endif
+    }
 
-        /* Write message */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        rv += plcrash_writer_write_processor_info(file, writer->machine_info.cpu_type, writer->machine_info.cpu_subtype);
+    if (!plcrash_log_writer_workers_run(workers, plcrash_writer_capture_thread_job, &pc, thread_count)) {
+        /* A worker did not finish in time; omit any threads whose capture may still be in progress. The worker may
+         * still be using its caches and capture, and neither can be safely released. */
+        uint32_t omitted = 0;
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            if (captures[i].include && !captures[i].complete) {
+                captures[i].include = false;
+                captures[i].cache = NULL;
+                omitted++;
+            }
+        }
+
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_WORKER_TIMEOUT, omitted, 0, 0);
+        abandoned = true;
+    }
+    result = true;
+
+cleanup:
+    for (uint32_t i = 0; i < symbol_caches && !abandoned; i++) {
+        plcrash_async_symbol_cache_free(&pc.symbol_caches[i]);
+#if PLCRASH_FEATURE_UNWIND_DWARF
+        if (!async_safe && pc.section_caches[i].dwarf_cie_cache != NULL)
+            plframe_dwarf_cie_cache_free(pc.section_caches[i].dwarf_cie_cache);
+#endif
+        plcrash_async_macho_section_cache_free(&pc.section_caches[i]);
     }
 
-    /* Physical Processor Count */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->machine_info.processor_count);
-    
-    /* Logical Processor Count */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_LOGICAL_PROCESSOR_COUNT_ID, PLPROTOBUF_C_TYPE_UINT32, &writer->machine_info.logical_processor_count);
-    
-    return rv;
+    if (!async_safe) {
+        free(pc.symbol_caches);
+        free(pc.section_caches);
+        pthread_mutex_unlock(&workers->submit_lock);
+    }
+
+    if (!result) {
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_PARALLEL_CAPTURE_FAILED, thread_count, 0, 0);
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            plcrash_log_writer_workers_dealloc(workers, captures[i].cache);
+            captures[i].cache = NULL;
+        }
+    }
+
+    return result;
 }
 
+
 /**
  * @internal
  *
- * Write the app info message.
+ * Write a binary image frame
  *
  * @param file Output file
- * @param app_identifier Application identifier
- * @param app_version Application version
+ * @param image The Mach-O image.
+ * @param name The image path, or if @a directory_index is non-NULL, the image path's last component.
+ * @param name_length The length of @a name, in bytes.
+ * @param directory_index If non-NULL, the string table index of the image's directory path.
  */
-static size_t plcrash_writer_write_app_info (plcrash_async_file_t *file, const char *app_identifier, const char *app_version) {
+static size_t plcrash_writer_write_binary_image (plcrash_async_file_t *file, plcrash_async_macho_t *image, const char *name,
+                                                 size_t name_length, const uint32_t *directory_index)
+{
     size_t rv = 0;
 
-    /* App identifier */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_IDENTIFIER_ID, PLPROTOBUF_C_TYPE_STRING, app_identifier);
+    /* Fetch the CPU types. Note that the wire format represents these as 64-bit unsigned integers.
+     * We explicitly cast to an equivalently sized unsigned type to prevent improper sign extension. */
+    uint64_t cpu_type = (uint32_t) image->byteorder->swap32(image->header.cputype);
+    uint64_t cpu_subtype = (uint32_t) image->byteorder->swap32(image->header.cpusubtype);
+
+    /* Text segment size */
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_BINARY_IMAGE_SIZE_ID, image->text_size);
     
-    /* App version */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_APP_VERSION_ID, PLPROTOBUF_C_TYPE_STRING, app_version);
+    /* Base address */
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_BINARY_IMAGE_ADDR_ID, (uintptr_t) image->header_addr);
+
+    /* Name */
+    rv += plcrash_writer_pack_string(file, PLCRASH_PROTO_BINARY_IMAGE_NAME_ID, name, name_length);
+    if (directory_index != NULL)
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_DIRECTORY_INDEX_ID, PLPROTOBUF_C_TYPE_UINT32, directory_index);
+
+    /* UUID */
+    struct uuid_command *uuid;
+    uuid = plcrash_async_macho_find_command(image, LC_UUID);
+    if (uuid != NULL) {
+        PLProtobufCBinaryData binary;
+    
+        /* Write the 128-bit UUID */
+        binary.len = sizeof(uuid->uuid);
+        binary.data = uuid->uuid;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+    }
     
+    /* Get the processor message size */
+    uint32_t msgsize = plcrash_writer_write_processor_info(NULL, cpu_type, cpu_subtype);
+
+    /* Write the header and message */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_CODE_TYPE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
+    rv += plcrash_writer_write_processor_info(file, cpu_type, cpu_subtype);
+
     return rv;
 }
 
+
+/**
+ * @internal
+ *
+ * Reset @a table, discarding all interned strings.
+ *
+ * @param table The string table to be reset.
+ */
+static void plcrash_writer_string_table_reset (struct plcrash_log_writer_string_table *table) {
+    table->count = 0;
+    plcrash_async_memset(table->slots, 0, sizeof(table->slots));
+}
+
 /**
  * @internal
  *
- * Write the process info message.
+ * Look up, and optionally insert, @a data in @a table.
  *
- * @param file Output file
- * @param process_name Process name
- * @param process_id Process ID
- * @param process_path Process path
- * @param parent_process_name Parent process name
- * @param parent_process_id Parent process ID
- * @param native If false, process is running under emulation.
- * @param start_time The start time of the process.
+ * @param table The string table.
+ * @param data The string data. The data is not copied, and must remain valid until the table is reset.
+ * @param length The length of @a data, in bytes.
+ * @param insert If true, the string will be inserted if not already present.
+ * @param index On success, the string's index within @a table.
+ *
+ * @return Returns true on success, or false if the string was not found and could not be inserted.
  */
-static size_t plcrash_writer_write_process_info (plcrash_async_file_t *file, const char *process_name,
-                                                 const pid_t process_id, const char *process_path, 
-                                                 const char *parent_process_name, const pid_t parent_process_id,
-                                                 bool native, time_t start_time)
+static bool plcrash_writer_string_table_intern (struct plcrash_log_writer_string_table *table, const char *data, size_t length,
+                                                bool insert, uint32_t *index)
 {
-    size_t rv = 0;
-    uint64_t tval;
+    /* FNV-1a */
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t) data[i];
+        hash *= 16777619U;
+    }
 
-    /*
-     * In the current crash reporter serialization format, pid values are serialized as unsigned 32-bit integers. This
-     * conforms with the actual implementation of pid_t on both 32-bit and 64-bit Darwin systems. To conform with
-     * SuSV3, however, the values should be encoded as signed integers; the actual width of the type being implementation
-     * defined.
-     *
-     * To maintain compatibility with existing report readers the values remain encoded as unsigned 32-bit integers,
-     * but should be updated to int64 values in future major revision of the data format.
-     */
-    uint32_t pidval;
+    /* Linear probe for a matching or empty slot */
+    for (uint32_t probe = 0; probe < PLCRASH_WRITER_STRING_TABLE_SLOTS; probe++) {
+        uint32_t slot = (hash + probe) & (PLCRASH_WRITER_STRING_TABLE_SLOTS - 1);
+        uint16_t entry = table->slots[slot];
 
-    /* Process name */
-    if (process_name != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, process_name);
+        if (entry == 0) {
+            if (!insert || table->count >= PLCRASH_WRITER_STRING_TABLE_MAX)
+                return false;
 
-    /* Process ID */
-    pidval = process_id;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+            table->strings[table->count].data = data;
+            table->strings[table->count].length = length;
+            table->slots[slot] = (uint16_t) (table->count + 1);
+            *index = table->count++;
+            return true;
+        }
 
-    /* Process path */
-    if (process_path != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PROCESS_PATH_ID, PLPROTOBUF_C_TYPE_STRING, process_path);
-    
-    /* Parent process name */
-    if (parent_process_name != NULL)
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_NAME_ID, PLPROTOBUF_C_TYPE_STRING, parent_process_name);
-    
+        if (table->strings[entry - 1].length == length && plcrash_async_strncmp(table->strings[entry - 1].data, data, length) == 0) {
+            *index = entry - 1;
+            return true;
+        }
+    }
 
-    /* Parent process ID */
-    pidval = parent_process_id;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_PARENT_PROCESS_ID_ID, PLPROTOBUF_C_TYPE_UINT32, &pidval);
+    return false;
+}
 
-    /* Native process. */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_NATIVE_ID, PLPROTOBUF_C_TYPE_BOOL, &native);
-    
-    /* Start time */
-    tval = start_time;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_START_TIME_ID, PLPROTOBUF_C_TYPE_UINT64, &tval);
+/**
+ * @internal
+ *
+ * Determine the length of the directory component of @a path, excluding the trailing path separator.
+ *
+ * @param path The image path.
+ * @param length On success, the directory's length.
+ *
+ * @return Returns true on success, or false if @a path has no directory component.
+ */
+static bool plcrash_writer_image_directory (const char *path, size_t *length) {
+    const char *separator = NULL;
+    for (const char *p = path; *p != '\0'; p++) {
+        if (*p == '/')
+            separator = p;
+    }
 
-    return rv;
+    if (separator == NULL)
+        return false;
+
+    *length = separator - path;
+    return true;
 }
 
 /**
  * @internal
  *
- * Write a thread backtrace register
+ * Write the shared cache message.
  *
  * @param file Output file
- * @param cursor The cursor from which to acquire frame data.
+ * @param shared_cache The task's shared cache.
  */
-static size_t plcrash_writer_write_thread_register (plcrash_async_file_t *file, const char *regname, plcrash_greg_t regval) {
-    uint64_t uint64val;
+static size_t plcrash_writer_write_shared_cache (plcrash_async_file_t *file, plcrash_async_shared_cache_t *shared_cache) {
     size_t rv = 0;
 
-    /* Write the name */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_NAME_ID, PLPROTOBUF_C_TYPE_STRING, regname);
+    /* Write the 128-bit UUID */
+    PLProtobufCBinaryData uuid_bin;
+    uuid_bin.len = sizeof(shared_cache->uuid);
+    uuid_bin.data = shared_cache->uuid;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_CACHE_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &uuid_bin);
+
+    /* Slide and base address */
+    int64_t slide = shared_cache->slide;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_CACHE_SLIDE_ID, PLPROTOBUF_C_TYPE_INT64, &slide);
+
+    uint64_t base_address = shared_cache->base_address;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_CACHE_BASE_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &base_address);
 
-    /* Write the value */
-    uint64val = regval;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTER_VALUE_ID, PLPROTOBUF_C_TYPE_UINT64, &uint64val);
-    
     return rv;
 }
 
 /**
  * @internal
  *
- * Write all thread backtrace register messages
+ * Write the breadcrumbs message, copying the buffer's record slots verbatim.
  *
  * @param file Output file
- * @param task The task from which @a uap was derived. All memory accesses will be mapped from this task.
- * @param cursor The cursor from which to acquire frame registers.
+ * @param breadcrumbs The breadcrumb buffer.
  */
-static size_t plcrash_writer_write_thread_registers (plcrash_async_file_t *file, task_t task, plframe_cursor_t *cursor) {
-    plframe_error_t frame_err;
-    uint32_t regCount = plframe_cursor_get_regcount(cursor);
+static size_t plcrash_writer_write_breadcrumbs (plcrash_async_file_t *file, plcrash_async_breadcrumb_buffer_t *breadcrumbs) {
     size_t rv = 0;
-    
-    /* Write out register messages */
-    for (int i = 0; i < regCount; i++) {
-        plcrash_greg_t regVal;
-        const char *regname;
-        uint32_t msgsize;
 
-        /* Fetch the register value */
-        if ((frame_err = plframe_cursor_get_reg(cursor, i, &regVal)) != PLFRAME_ESUCCESS) {
-            // Should never happen
-            PLCF_DEBUG("Could not fetch register %i value: %s", i, plframe_strerror(frame_err));
-            regVal = 0;
-        }
+    uint32_t record_size = breadcrumbs->record_size;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BREADCRUMBS_RECORD_SIZE_ID, PLPROTOBUF_C_TYPE_UINT32, &record_size);
 
-        /* Fetch the register name */
-        regname = plframe_cursor_get_regname(cursor, i);
+    uint32_t slot_size = breadcrumbs->slot_size;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BREADCRUMBS_SLOT_SIZE_ID, PLPROTOBUF_C_TYPE_UINT32, &slot_size);
+
+    /* Producers may continue to append while the slots are copied; any partially written slot has a zero
+     * sequence number, and is discarded by the decoder. */
+    PLProtobufCBinaryData slots;
+    slots.len = plcrash_async_breadcrumb_buffer_length(breadcrumbs);
+    slots.data = breadcrumbs->slots;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BREADCRUMBS_SLOTS_ID, PLPROTOBUF_C_TYPE_BYTES, &slots);
 
-        /* Get the register message size */
-        msgsize = plcrash_writer_write_thread_register(NULL, regname, regVal);
-        
-        /* Write the header and message */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_REGISTERS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
-        rv += plcrash_writer_write_thread_register(file, regname, regVal);
-    }
-    
     return rv;
 }
 
 /**
  * @internal
  *
- * Write a symbol
+ * Write the debug trace message, copying the ring's records verbatim.
  *
  * @param file Output file
- * @param name The symbol name
- * @param start_address The symbol start address
+ * @param trace The trace ring.
+ * @param count The number of records to be written, from the start of the ring. Until the ring first wraps, only
+ * its leading records are in use.
  */
-static size_t plcrash_writer_write_symbol (plcrash_async_file_t *file, const char *name, uint64_t start_address) {
+static size_t plcrash_writer_write_debug_trace (plcrash_async_file_t *file, plcrash_async_trace_ring_t *trace, size_t count) {
     size_t rv = 0;
-    
-    /* name */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_NAME, PLPROTOBUF_C_TYPE_STRING, name);
-    
-    /* start_address */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SYMBOL_START_ADDRESS, PLPROTOBUF_C_TYPE_UINT64, &start_address);
-    
+
+    uint32_t record_size = sizeof(plcrash_async_trace_record_t);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_DEBUG_TRACE_RECORD_SIZE_ID, PLPROTOBUF_C_TYPE_UINT32, &record_size);
+
+    /* Any record being written while the ring is copied has a zero sequence number, and is discarded by the decoder */
+    PLProtobufCBinaryData records;
+    records.len = count * sizeof(trace->records[0]);
+    records.data = (void *) trace->records;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_DEBUG_TRACE_RECORDS_ID, PLPROTOBUF_C_TYPE_BYTES, &records);
+
     return rv;
 }
 
 /**
  * @internal
- * Symbol lookup callback context
+ *
+ * Write a hang sample message.
+ *
+ * @param file Output file
+ * @param sample The sample to be written.
  */
-struct pl_symbol_cb_ctx {
-    /** File to use for writing out a symbol entry. May be NULL. */
-    plcrash_async_file_t *file;
+static size_t plcrash_writer_write_hang_sample (plcrash_async_file_t *file, const plcrash_log_writer_hang_sample_t *sample) {
+    size_t rv = 0;
 
-    /** Size of the symbol entry, to be written by the callback function upon writing an entry. */
-    uint32_t msgsize;
-};
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_HANG_SAMPLE_OFFSET_ID, sample->offset);
+
+    uint32_t frame_count = sample->frame_count;
+    if (frame_count > PLCRASH_LOG_WRITER_HANG_MAX_FRAMES)
+        frame_count = PLCRASH_LOG_WRITER_HANG_MAX_FRAMES;
+
+    for (uint32_t i = 0; i < frame_count; i++)
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_HANG_SAMPLE_PCS_ID, sample->pcs[i]);
+
+    return rv;
+}
 
 /**
  * @internal
  *
- * pl_async_macho_found_symbol_cb callback implementation. Writes the result to the file available via @a ctx,
- * which must be a valid pl_symbol_cb_ctx structure.
+ * Write the hang message.
+ *
+ * @param file Output file
+ * @param hang The hang details.
  */
-static void plcrash_writer_write_thread_frame_symbol_cb (pl_vm_address_t address, const char *name, void *ctx) {
-    struct pl_symbol_cb_ctx *cb_ctx = ctx;
-    cb_ctx->msgsize = plcrash_writer_write_symbol(cb_ctx->file, name, address);
+static size_t plcrash_writer_write_hang (plcrash_async_file_t *file, const plcrash_log_writer_hang_info_t *hang) {
+    size_t rv = 0;
+
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_HANG_DURATION_ID, hang->duration);
+
+    for (size_t i = 0; i < hang->sample_count; i++) {
+        uint32_t size = (uint32_t) plcrash_writer_write_hang_sample(NULL, &hang->samples[i]);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_HANG_SAMPLES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_hang_sample(file, &hang->samples[i]);
+    }
+
+    return rv;
 }
 
 /**
  * @internal
  *
- * Write a thread backtrace frame
+ * Write the termination message.
  *
  * @param file Output file
- * @param pcval The frame PC value.
+ * @param termination The termination details.
  */
-static size_t plcrash_writer_write_thread_frame (plcrash_async_file_t *file, plcrash_log_writer_t *writer, uint64_t pcval, plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext) {
+static size_t plcrash_writer_write_termination (plcrash_async_file_t *file, const plcrash_log_writer_termination_info_t *termination) {
+    const plcrash_async_app_state_record_t *session = termination->session;
     size_t rv = 0;
+    uint32_t uint32val;
+    int64_t int64val;
+    bool boolval;
 
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_PC_ID, PLPROTOBUF_C_TYPE_UINT64, &pcval);
-    
-    plcrash_async_image_list_set_reading(image_list, true);
-    plcrash_async_image_t *image = plcrash_async_image_containing_address(image_list, (pl_vm_address_t) pcval);
-    
-    if (image != NULL && writer->symbol_strategy != PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE) {
-        struct pl_symbol_cb_ctx ctx;
-        plcrash_error_t ret;
-        
-        /* Get the symbol message size. If the symbol can not be found, our callback will not be called. If the symbol is found,
-         * our callback is called and PLCRASH_ESUCCESS is returned. */
-        ctx.file = NULL;
-        ctx.msgsize = 0x0;
-        ret = plcrash_async_find_symbol(&image->macho_image, writer->symbol_strategy, findContext, (pl_vm_address_t) pcval, plcrash_writer_write_thread_frame_symbol_cb, &ctx);
-        if (ret == PLCRASH_ESUCCESS) {
-            /* Write the header and message */
-            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAME_SYMBOL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &ctx.msgsize);
-
-            ctx.file = file;
-            ret = plcrash_async_find_symbol(&image->macho_image, writer->symbol_strategy, findContext, (pl_vm_address_t) pcval, plcrash_writer_write_thread_frame_symbol_cb, &ctx);
-            if (ret == PLCRASH_ESUCCESS) {
-                rv += ctx.msgsize;
-            } else {
-                /* This should not happen, but it would be very confusing if it did and nothing was logged. */
-                PLCF_DEBUG("Fetching the symbol unexpectedly failed during the second call");
-            }
-        }
-    }
+    uint32val = termination->reason;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_REASON_ID, PLPROTOBUF_C_TYPE_ENUM, &uint32val);
 
-    plcrash_async_image_list_set_reading(image_list, false);
+    uint32val = (uint32_t) session->pid;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_PID_ID, PLPROTOBUF_C_TYPE_UINT32, &uint32val);
+
+    int64val = session->launch_time;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_LAUNCH_TIME_ID, PLPROTOBUF_C_TYPE_INT64, &int64val);
+
+    boolval = session->foreground != 0;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_FOREGROUND_ID, PLPROTOBUF_C_TYPE_BOOL, &boolval);
+
+    boolval = session->in_hang != 0;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_IN_HANG_ID, PLPROTOBUF_C_TYPE_BOOL, &boolval);
+
+    boolval = session->memory_warning != 0;
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_MEMORY_WARNING_ID, PLPROTOBUF_C_TYPE_BOOL, &boolval);
+
+    /* The footprint is only written if it was sampled */
+    if (session->footprint != 0) {
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_TERMINATION_FOOTPRINT_ID, session->footprint);
 
+        int64val = session->footprint_time;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_FOOTPRINT_TIME_ID, PLPROTOBUF_C_TYPE_INT64, &int64val);
+    }
 
     return rv;
 }
@@ -932,17 +5658,27 @@ static size_t plcrash_writer_write_thread_frame (plcrash_async_file_t *file, plc
 /**
  * @internal
  *
- * Write an exception userInfo entry
+ * Write a user region message.
  *
  * @param file Output file
- * @param userInfo The userInfo dictionary entry.
+ * @param tag The region's tag.
+ * @param address The region's address.
+ * @param length The region's length.
+ * @param data The region's contents, or NULL if the region could not be read.
  */
-static size_t plcrash_writer_write_user_info_pair (plcrash_async_file_t *file, user_info_t userInfo) {
+static size_t plcrash_writer_write_user_region (plcrash_async_file_t *file, uint32_t tag, pl_vm_address_t address, pl_vm_size_t length, const void *data) {
     size_t rv = 0;
 
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_USERINFO_KEY_ID, PLPROTOBUF_C_TYPE_STRING, userInfo.key);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_USERINFO_SERIALIZED_ID, PLPROTOBUF_C_TYPE_STRING, userInfo.serialized);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_USERINFO_ARCHIVE_ID, PLPROTOBUF_C_TYPE_BOOL, &userInfo.archive);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_USER_REGION_TAG_ID, PLPROTOBUF_C_TYPE_UINT32, &tag);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_USER_REGION_ADDRESS_ID, address);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_USER_REGION_LENGTH_ID, length);
+
+    if (data != NULL) {
+        PLProtobufCBinaryData bytes;
+        bytes.len = length;
+        bytes.data = (void *) data;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_USER_REGION_DATA_ID, PLPROTOBUF_C_TYPE_BYTES, &bytes);
+    }
 
     return rv;
 }
@@ -950,161 +5686,177 @@ static size_t plcrash_writer_write_user_info_pair (plcrash_async_file_t *file, u
 /**
  * @internal
  *
- * Write a thread message
+ * Write a memory region summary message.
  *
  * @param file Output file
- * @param task The task in which @a thread is executing.
- * @param thread Thread for which we'll output data.
- * @param thread_number The thread's index number.
- * @param thread_ctx Thread state to use for stack walking. If NULL, the thread state will be fetched from @a thread. If
- * @a thread is the currently executing thread, <em>must</em> be non-NULL.
- * @param image_list The Mach-O image list.
- * @param findContext Symbol lookup cache.
- * @param crashed If true, mark this as a crashed thread.
+ * @param index The bucket's index within the summary; either a VM user tag, or PLCRASH_ASYNC_VM_SUMMARY_MAPPED_FILE.
+ * @param bucket The bucket to be written.
  */
-static size_t plcrash_writer_write_thread (plcrash_async_file_t *file,
-                                           plcrash_log_writer_t *writer,
-                                           task_t task,
-                                           thread_t thread,
-                                           uint32_t thread_number,
-                                           plcrash_async_thread_state_t *thread_ctx,
-                                           plcrash_async_image_list_t *image_list,
-                                           plcrash_async_symbol_cache_t *findContext,
-                                           bool crashed)
-{
+static size_t plcrash_writer_write_memory_region (plcrash_async_file_t *file, uint32_t index, const plcrash_async_vm_summary_bucket_t *bucket) {
     size_t rv = 0;
-    plframe_cursor_t cursor;
-    plframe_error_t ferr;
-
-    /* A context must be supplied when walking the current thread */
-    PLCF_ASSERT(task != mach_task_self() || thread_ctx != NULL || thread != pl_mach_thread_self());
 
-    /* Write the required elements first; fatal errors may occur below, in which case we need to have
-     * written out required elements before returning. */
-    {
-        /* Write the thread ID */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_THREAD_NUMBER_ID, PLPROTOBUF_C_TYPE_UINT32, &thread_number);
-
-        /* Note crashed status */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_CRASHED_ID, PLPROTOBUF_C_TYPE_BOOL, &crashed);
+    if (index == PLCRASH_ASYNC_VM_SUMMARY_MAPPED_FILE) {
+        bool mapped_file = true;
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_MEMORY_REGION_TAG_ID, 0);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_REGION_MAPPED_FILE_ID, PLPROTOBUF_C_TYPE_BOOL, &mapped_file);
+    } else {
+        rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_MEMORY_REGION_TAG_ID, index);
     }
 
+    rv += plcrash_writer_pack_uint32(file, PLCRASH_PROTO_MEMORY_REGION_COUNT_ID, bucket->region_count);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_REGION_VIRTUAL_SIZE_ID, bucket->virtual_size);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_REGION_RESIDENT_SIZE_ID, bucket->resident_size);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_REGION_DIRTY_SIZE_ID, bucket->dirty_size);
+    rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_REGION_SWAPPED_SIZE_ID, bucket->swapped_size);
 
-    /* Write out the stack frames. */
-    {
-        /* Set up the frame cursor. */
-        {            
-            /* Use the provided context if available, otherwise initialize a new thread context
-             * from the target thread's state. */
-            plcrash_async_thread_state_t cursor_thr_state;
-            if (thread_ctx) {
-                cursor_thr_state = *thread_ctx;
-            } else {
-                plcrash_async_thread_state_mach_thread_init(&cursor_thr_state, thread);
-            }
+    return rv;
+}
 
-            /* Initialize the cursor */
-            ferr = plframe_cursor_init(&cursor, task, &cursor_thr_state, image_list);
-            if (ferr != PLFRAME_ESUCCESS) {
-                PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
-                return rv;
-            }
-        }
+/**
+ * @internal
+ *
+ * Write the memory usage message.
+ *
+ * @param file Output file
+ * @param summary The populated memory usage summary.
+ */
+static size_t plcrash_writer_write_memory (plcrash_async_file_t *file, const plcrash_async_vm_summary_t *summary) {
+    size_t rv = 0;
 
-        /* Walk the stack, limiting the total number of frames that are output. */
-        uint32_t frame_count = 0;
-        while ((ferr = plframe_cursor_next(&cursor)) == PLFRAME_ESUCCESS && frame_count < MAX_THREAD_FRAMES) {
-            uint32_t frame_size;
-            
-            /* On the first frame, dump registers for the crashed thread */
-            if (frame_count == 0 && crashed) {
-                rv += plcrash_writer_write_thread_registers(file, task, &cursor);
-            }
+    if (summary->has_phys_footprint)
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_PHYS_FOOTPRINT_ID, summary->phys_footprint);
 
-            /* Fetch the PC value */
-            plcrash_greg_t pc = 0;
-            if ((ferr = plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS) {
-                PLCF_DEBUG("Could not retrieve frame PC register: %s", plframe_strerror(ferr));
-                break;
-            }
+    if (summary->has_task_info) {
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_RESIDENT_SIZE_ID, summary->resident_size);
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_RESIDENT_SIZE_PEAK_ID, summary->resident_size_peak);
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_COMPRESSED_SIZE_ID, summary->compressed_size);
+        rv += plcrash_writer_pack_uint64(file, PLCRASH_PROTO_MEMORY_VIRTUAL_SIZE_ID, summary->virtual_size);
+    }
 
-            /* Determine the size */
-            frame_size = plcrash_writer_write_thread_frame(NULL, writer, pc, image_list, findContext);
-            
-            rv += plcrash_writer_pack(file, PLCRASH_PROTO_THREAD_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
-            rv += plcrash_writer_write_thread_frame(file, writer, pc, image_list, findContext);
-            frame_count++;
-        }
+    /* Only non-empty buckets are written */
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_VM_SUMMARY_BUCKET_COUNT; i++) {
+        const plcrash_async_vm_summary_bucket_t *bucket = &summary->buckets[i];
+        if (bucket->region_count == 0)
+            continue;
 
-        /* Did we reach the end successfully? */
-        if (ferr != PLFRAME_ENOFRAME) {
-            /* This is non-fatal, and in some circumstances -could- be caused by reaching the end of the stack if the
-             * final frame pointer is not NULL. */
-            PLCF_DEBUG("Terminated stack walking early: %s", plframe_strerror(ferr));
-        }
+        uint32_t size = (uint32_t) plcrash_writer_write_memory_region(NULL, i, bucket);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_REGIONS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_memory_region(file, i, bucket);
+    }
+
+    if (summary->truncated) {
+        bool truncated = true;
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_REGIONS_TRUNCATED_ID, PLPROTOBUF_C_TYPE_BOOL, &truncated);
     }
 
-    plframe_cursor_free(&cursor);
     return rv;
 }
 
-
 /**
  * @internal
  *
- * Write a binary image frame
+ * Write the binary images described by @a refs, in written order. If writing a compact report, the images are
+ * preceded by the string table entries for their directory paths.
  *
  * @param file Output file
- * @param name binary image path (or name).
- * @param image_base Mach-O image base.
+ * @param writer The writer context.
+ * @param refs The report's image references.
+ * @param footer The report footer, or NULL if no footer is being written.
  */
-static size_t plcrash_writer_write_binary_image (plcrash_async_file_t *file, plcrash_async_macho_t *image) {
-    size_t rv = 0;
+static void plcrash_writer_write_indexed_binary_images (plcrash_async_file_t *file, plcrash_log_writer_t *writer,
+                                                        plcrash_writer_image_refs_t *refs, plcrash_writer_footer_t *footer)
+{
+    struct plcrash_log_writer_string_table *strings = refs->compact ? writer->string_table : NULL;
+    plcrash_async_image_t *entry;
+    size_t cursor;
+
+    /* Intern the image directories, writing each unique directory once */
+    if (strings != NULL) {
+        plcrash_writer_string_table_reset(strings);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_STRINGS_ID);
+
+        cursor = 0;
+        while ((entry = plcrash_writer_image_refs_next(refs, &cursor)) != NULL) {
+            const char *path = entry->macho_image.name;
+            uint32_t count = strings->count;
+            uint32_t index;
+            size_t length;
+
+            if (!plcrash_writer_image_directory(path, &length))
+                continue;
+
+            if (!plcrash_writer_string_table_intern(strings, path, length, true, &index) || index != count)
+                continue;
+
+            PLProtobufCBinaryData binary;
+            binary.len = length;
+            binary.data = (void *) path;
+            plcrash_writer_pack(file, PLCRASH_PROTO_STRINGS_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
+        }
+    }
 
-    /* Fetch the CPU types. Note that the wire format represents these as 64-bit unsigned integers.
-     * We explicitly cast to an equivalently sized unsigned type to prevent improper sign extension. */
-    uint64_t cpu_type = (uint32_t) image->byteorder->swap32(image->header.cputype);
-    uint64_t cpu_subtype = (uint32_t) image->byteorder->swap32(image->header.cpusubtype);
+    /* Write the images, referencing their interned directories */
+    plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_BINARY_IMAGES_ID);
+    cursor = 0;
+    while ((entry = plcrash_writer_image_refs_next(refs, &cursor)) != NULL) {
+        plcrash_async_macho_t *image = &entry->macho_image;
+        const char *name = image->name;
+        size_t name_length = image->name_length;
+        uint32_t *directory_index = NULL;
+        uint32_t index;
+        size_t length;
+
+        if (strings != NULL && plcrash_writer_image_directory(image->name, &length) &&
+            plcrash_writer_string_table_intern(strings, image->name, length, false, &index))
+        {
+            name = image->name + length + 1;
+            name_length = image->name_length - length - 1;
+            directory_index = &index;
+        }
 
-    /* Text segment size */
-    uint64_t mach_size = image->text_size;
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_SIZE_ID, PLPROTOBUF_C_TYPE_UINT64, &mach_size);
-    
-    /* Base address */
-    {
-        uintptr_t base_addr;
-        uint64_t u64;
+        /* Use the image's pre-encoded record if its name is written in full */
+        if (directory_index == NULL && entry->record != NULL) {
+            plcrash_async_file_write(file, entry->record, entry->record_length);
+            continue;
+        }
 
-        base_addr = (uintptr_t) image->header_addr;
-        u64 = base_addr;
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_ADDR_ID, PLPROTOBUF_C_TYPE_UINT64, &u64);
+        uint32_t size = plcrash_writer_write_binary_image(NULL, image, name, name_length, directory_index);
+        plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_binary_image(file, image, name, name_length, directory_index);
     }
+}
 
-    /* Name */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_NAME_ID, PLPROTOBUF_C_TYPE_STRING, image->name);
+/**
+ * Encode a complete crash report binary image record -- including the enclosing field tag and length prefix --
+ * for @a image. This conforms to plcrash_async_image_record_encoder_t, and may be used to pre-encode binary
+ * image records at image registration time, via plcrash_nasync_image_list_set_record_encoder(); the crash
+ * log writer will then copy the pre-encoded records directly to the crash report output.
+ *
+ * @param image The image to be encoded.
+ * @param buffer The output buffer, or NULL if only the encoded size should be computed.
+ * @param length The size of @a buffer, in bytes. Ignored if @a buffer is NULL.
+ *
+ * @return Returns the encoded size, in bytes, or 0 if @a buffer is too small to hold the record.
+ *
+ * @warning This method is not async safe.
+ */
+size_t plcrash_log_writer_encode_binary_image (plcrash_async_macho_t *image, void *buffer, size_t length) {
+    uint32_t size = plcrash_writer_write_binary_image(NULL, image, image->name, image->name_length, NULL);
+    size_t total = plcrash_writer_pack(NULL, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size) + size;
 
-    /* UUID */
-    struct uuid_command *uuid;
-    uuid = plcrash_async_macho_find_command(image, LC_UUID);
-    if (uuid != NULL) {
-        PLProtobufCBinaryData binary;
-    
-        /* Write the 128-bit UUID */
-        binary.len = sizeof(uuid->uuid);
-        binary.data = uuid->uuid;
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &binary);
-    }
-    
-    /* Get the processor message size */
-    uint32_t msgsize = plcrash_writer_write_processor_info(NULL, cpu_type, cpu_subtype);
+    if (buffer == NULL)
+        return total;
+    else if (length < total)
+        return 0;
 
-    /* Write the header and message */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGE_CODE_TYPE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &msgsize);
-    rv += plcrash_writer_write_processor_info(file, cpu_type, cpu_subtype);
+    plcrash_async_file_t file;
+    plcrash_async_file_init_memory(&file, buffer, length);
 
-    return rv;
-}
+    plcrash_writer_pack(&file, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+    plcrash_writer_write_binary_image(&file, image, image->name, image->name_length, NULL);
 
+    return (size_t) plcrash_async_file_tell(&file);
+}
 
 /**
  * @internal
@@ -1113,27 +5865,30 @@ static size_t plcrash_writer_write_binary_image (plcrash_async_file_t *file, plc
  *
  * @param file Output file
  * @param writer Writer containing exception data
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ * @param refs If non-NULL, the image references to be used to write compact frames; see
+ * plcrash_writer_write_cached_frames().
  */
-static size_t plcrash_writer_write_exception (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list, plcrash_async_symbol_cache_t *findContext) {
+static size_t plcrash_writer_write_exception (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list,
+                                              plcrash_async_symbol_cache_t *findContext, plcrash_writer_image_refs_t *refs)
+{
     size_t rv = 0;
 
     /* Write the name and reason */
     assert(writer->uncaught_exception.has_exception);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_NAME_ID, PLPROTOBUF_C_TYPE_STRING, writer->uncaught_exception.name);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_REASON_ID, PLPROTOBUF_C_TYPE_STRING, writer->uncaught_exception.reason);
+    rv += plcrash_writer_pack_string(file, PLCRASH_PROTO_EXCEPTION_NAME_ID, writer->uncaught_exception.name, writer->uncaught_exception.name_length);
+    rv += plcrash_writer_pack_string(file, PLCRASH_PROTO_EXCEPTION_REASON_ID, writer->uncaught_exception.reason, writer->uncaught_exception.reason_length);
     
     /* Write the stack frames, if any */
-    uint32_t frame_count = 0;
-    for (size_t i = 0; i < writer->uncaught_exception.callstack_count && frame_count < MAX_THREAD_FRAMES; i++) {
+    struct plcrash_log_writer_frame_cache *cache = writer->frame_cache;
+    cache->count = 0;
+    for (size_t i = 0; i < writer->uncaught_exception.callstack_count && cache->count < MAX_THREAD_FRAMES; i++) {
         uint64_t pc = (uint64_t)(uintptr_t) writer->uncaught_exception.callstack[i];
-        
-        /* Determine the size */
-        uint32_t frame_size = plcrash_writer_write_thread_frame(NULL, writer, pc, image_list, findContext);
-        
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_FRAMES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &frame_size);
-        rv += plcrash_writer_write_thread_frame(file, writer, pc, image_list, findContext);
-        frame_count++;
+        plcrash_writer_frame_cache_append(cache, pc);
     }
+    plcrash_writer_frame_cache_symbolicate(writer, cache, MAX_THREAD_FRAMES, image_list, findContext);
+    rv += plcrash_writer_write_cached_frames(file, PLCRASH_PROTO_EXCEPTION_FRAMES_ID, cache, refs);
 
     /* Write the user info */
     for (size_t i = 0; i < writer->uncaught_exception.user_info_size; i++) {
@@ -1149,6 +5904,29 @@ static size_t plcrash_writer_write_exception (plcrash_async_file_t *file, plcras
     return rv;
 }
 
+/**
+ * @internal
+ *
+ * Write the top-level Exception record.
+ *
+ * @param file Output file
+ * @param writer Writer containing exception data
+ * @param image_list The Mach-O image list.
+ * @param findContext Symbol lookup cache.
+ * @param refs If non-NULL, the image references to be used to write compact frames.
+ */
+static void plcrash_writer_write_exception_record (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_async_image_list_t *image_list,
+                                                   plcrash_async_symbol_cache_t *findContext, plcrash_writer_image_refs_t *refs)
+{
+    plcrash_writer_msg_slot_t slot;
+
+    /* Write the message in a single pass, avoiding a second symbol lookup for every exception frame */
+    plcrash_writer_pack_begin_message(file, PLCRASH_PROTO_EXCEPTION_ID, &slot);
+    plcrash_writer_write_exception(file, writer, image_list, findContext, refs);
+    if (!plcrash_writer_pack_end_message(file, &slot))
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_MESSAGE_LENGTH_FAILED, PLCRASH_PROTO_EXCEPTION_ID, 0, 0);
+}
+
 /**
  * @internal
  *
@@ -1176,57 +5954,287 @@ static size_t plcrash_writer_write_mach_signal (plcrash_async_file_t *file, plcr
 /**
  * @internal
  *
- * Write the crash signal message
+ * Write the crash signal message
+ *
+ * @param file Output file
+ * @param siginfo The signal information
+ */
+static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_log_signal_info_t *siginfo) {
+    size_t rv = 0;
+    
+    /* BSD signal info is always required in the current report format; this restriction will be lifted
+     * once we switch to the 2.0 format. */
+    PLCF_ASSERT(siginfo->bsd_info != NULL);
+    
+    /* Fetch the signal name */
+    char name_buf[10];
+    const char *name;
+    if ((name = plcrash_async_signal_signame(siginfo->bsd_info->signo)) == NULL) {
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_UNKNOWN_SIGNAL, siginfo->bsd_info->signo, siginfo->bsd_info->code, 0);
+        snprintf(name_buf, sizeof(name_buf), "#%d", siginfo->bsd_info->signo);
+        name = name_buf;
+    }
+
+    /* Fetch the signal code string */
+    char code_buf[10];
+    const char *code;
+    if ((code = plcrash_async_signal_sigcode(siginfo->bsd_info->signo, siginfo->bsd_info->code)) == NULL) {
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_UNKNOWN_SIGNAL, siginfo->bsd_info->signo, siginfo->bsd_info->code, 0);
+        snprintf(code_buf, sizeof(code_buf), "#%d", siginfo->bsd_info->code);
+        code = code_buf;
+    }
+    
+    /* Address value */
+    uint64_t addr = (uintptr_t) siginfo->bsd_info->address;
+
+    /* Write it out */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_NAME_ID, PLPROTOBUF_C_TYPE_STRING, name);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_CODE_ID, PLPROTOBUF_C_TYPE_STRING, code);
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &addr);
+    
+    /* Mach exception info */
+    if (siginfo->mach_info != NULL) {
+        uint32_t size;
+        
+        /* Determine size */
+        size = plcrash_writer_write_mach_signal(NULL, siginfo->mach_info);
+        
+        /* Write message */
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_mach_signal(file, siginfo->mach_info);
+    }
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Crash-time metrics recorded in CrashReport.report_info.metrics. Each value's field identifier is its
+ * enumeration value + 1.
+ */
+typedef enum {
+    PLCRASH_WRITER_METRIC_TOTAL_TIME = 0,
+    PLCRASH_WRITER_METRIC_THREAD_SUSPEND_TIME,
+    PLCRASH_WRITER_METRIC_UNWIND_TIME,
+    PLCRASH_WRITER_METRIC_MAX_THREAD_UNWIND_TIME,
+    PLCRASH_WRITER_METRIC_SYMBOLICATION_TIME,
+    PLCRASH_WRITER_METRIC_BINARY_IMAGES_TIME,
+    PLCRASH_WRITER_METRIC_FILE_WRITE_TIME,
+    PLCRASH_WRITER_METRIC_THREAD_COUNT,
+
+    /** The first of the per-reader frame counts, ordered as per plcrash_writer_reader_t. */
+    PLCRASH_WRITER_METRIC_READER_FRAMES,
+
+    PLCRASH_WRITER_METRIC_MEMORY_OBJECT_MAPS = PLCRASH_WRITER_METRIC_READER_FRAMES + PLCRASH_WRITER_READER_COUNT,
+    PLCRASH_WRITER_METRIC_BYTES_WRITTEN,
+    PLCRASH_WRITER_METRIC_SYSCALL_COUNT,
+    PLCRASH_WRITER_METRIC_OMITTED_THREAD_COUNT,
+    PLCRASH_WRITER_METRIC_SUSPENDED_TIME,
+
+    /** The first of the per-category parser work counts, ordered as per plcrash_async_work_t. */
+    PLCRASH_WRITER_METRIC_WORK_CONSUMED,
+
+    /** The first of the per-category parser work refusal counts, ordered as per plcrash_async_work_t. */
+    PLCRASH_WRITER_METRIC_WORK_EXHAUSTED = PLCRASH_WRITER_METRIC_WORK_CONSUMED + PLCRASH_ASYNC_WORK_COUNT,
+
+    /** The number of threads whose frames were copied from the unwind cache. */
+    PLCRASH_WRITER_METRIC_UNWIND_CACHE_HITS = PLCRASH_WRITER_METRIC_WORK_EXHAUSTED + PLCRASH_ASYNC_WORK_COUNT,
+
+    /** The first of the per-reader frame read failure counts, ordered as per plcrash_writer_reader_t. */
+    PLCRASH_WRITER_METRIC_READER_FAILURES,
+
+    /** The total number of metrics */
+    PLCRASH_WRITER_METRIC_COUNT = PLCRASH_WRITER_METRIC_READER_FAILURES + PLCRASH_WRITER_READER_COUNT
+} plcrash_writer_metric_t;
+
+/**
+ * @internal
+ *
+ * Crash-time metrics state. Timing values are accumulated in mach_absolute_time() units, and converted to
+ * nanoseconds when written.
+ */
+typedef struct plcrash_writer_metrics {
+    /** Metric values, indexed by plcrash_writer_metric_t. */
+    uint64_t values[PLCRASH_WRITER_METRIC_COUNT];
+
+    /** The reserved output slot for each value, indexed by plcrash_writer_metric_t. */
+    plcrash_writer_fixed64_slot_t slots[PLCRASH_WRITER_METRIC_COUNT];
+
+    /** Start time, in mach_absolute_time() units. */
+    uint64_t start_time;
+
+    /** The process' memory object map count at the start of the report. */
+    uint32_t start_map_count;
+
+    /** The output file's system call count and write time at the start of the report. */
+    uint32_t start_syscall_count;
+    uint64_t start_write_time;
+
+    /** If true, report data was omitted to meet the capture policy's time or size budget. */
+    bool truncated;
+
+    /** The number of frames captured across all threads. Not written to the report; see
+     * plcrash_log_writer_t::last_report. */
+    uint64_t frame_count;
+
+    /** The reserved output slot for CrashReport.report_info.truncated. */
+    plcrash_writer_bool_slot_t truncated_slot;
+} plcrash_writer_metrics_t;
+
+/**
+ * @internal
+ *
+ * Begin recording crash-time metrics.
+ *
+ * @param metrics The metrics state to initialize.
+ * @param file The report output file.
+ */
+static void plcrash_writer_metrics_init (plcrash_writer_metrics_t *metrics, plcrash_async_file_t *file) {
+    plcrash_async_memset(metrics, 0, sizeof(*metrics));
+
+    metrics->start_time = mach_absolute_time();
+    metrics->start_map_count = plcrash_async_mobject_map_count();
+    metrics->start_syscall_count = file->syscall_count;
+    metrics->start_write_time = file->write_time;
+}
+
+/**
+ * @internal
+ *
+ * Add the timings and frame reader counts of a written thread's @a capture to @a metrics.
+ */
+static void plcrash_writer_metrics_add_capture (plcrash_writer_metrics_t *metrics, plcrash_writer_thread_capture_t *capture) {
+    metrics->values[PLCRASH_WRITER_METRIC_THREAD_COUNT]++;
+    if (capture->cache != NULL)
+        metrics->frame_count += capture->cache->count;
+    if (capture->truncated)
+        metrics->truncated = true;
+    if (capture->cached)
+        metrics->values[PLCRASH_WRITER_METRIC_UNWIND_CACHE_HITS]++;
+    metrics->values[PLCRASH_WRITER_METRIC_UNWIND_TIME] += capture->unwind_time;
+    metrics->values[PLCRASH_WRITER_METRIC_SYMBOLICATION_TIME] += capture->symbolication_time;
+
+    if (capture->unwind_time > metrics->values[PLCRASH_WRITER_METRIC_MAX_THREAD_UNWIND_TIME])
+        metrics->values[PLCRASH_WRITER_METRIC_MAX_THREAD_UNWIND_TIME] = capture->unwind_time;
+
+    for (uint32_t i = 0; i < PLCRASH_WRITER_READER_COUNT; i++) {
+        metrics->values[PLCRASH_WRITER_METRIC_READER_FRAMES + i] += capture->reader_frames[i];
+        metrics->values[PLCRASH_WRITER_METRIC_READER_FAILURES + i] += capture->reader_failures[i];
+    }
+}
+
+/**
+ * @internal
+ *
+ * Convert @a abstime from mach_absolute_time() units to nanoseconds.
+ */
+static uint64_t plcrash_writer_abstime_to_ns (plcrash_log_writer_t *writer, uint64_t abstime) {
+    if (writer->timebase.denom == 0)
+        return abstime;
+
+    return abstime * writer->timebase.numer / writer->timebase.denom;
+}
+
+/**
+ * @internal
+ *
+ * Complete @a metrics, and back-patch the final values into the metrics message reserved by
+ * plcrash_writer_write_report_info().
+ *
+ * @param file Output file
+ * @param writer Writer instance
+ * @param metrics The metrics state.
+ *
+ * @return Returns true on success, or false if any of the values could not be written.
+ */
+static bool plcrash_writer_metrics_finish (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_writer_metrics_t *metrics) {
+    static const plcrash_writer_metric_t timings[] = {
+        PLCRASH_WRITER_METRIC_TOTAL_TIME,
+        PLCRASH_WRITER_METRIC_THREAD_SUSPEND_TIME,
+        PLCRASH_WRITER_METRIC_UNWIND_TIME,
+        PLCRASH_WRITER_METRIC_MAX_THREAD_UNWIND_TIME,
+        PLCRASH_WRITER_METRIC_SYMBOLICATION_TIME,
+        PLCRASH_WRITER_METRIC_BINARY_IMAGES_TIME,
+        PLCRASH_WRITER_METRIC_FILE_WRITE_TIME,
+        PLCRASH_WRITER_METRIC_SUSPENDED_TIME
+    };
+    uint64_t *values = metrics->values;
+    bool result = true;
+
+    values[PLCRASH_WRITER_METRIC_TOTAL_TIME] = mach_absolute_time() - metrics->start_time;
+    values[PLCRASH_WRITER_METRIC_FILE_WRITE_TIME] = file->write_time - metrics->start_write_time;
+    values[PLCRASH_WRITER_METRIC_MEMORY_OBJECT_MAPS] = plcrash_async_mobject_map_count() - metrics->start_map_count;
+    values[PLCRASH_WRITER_METRIC_BYTES_WRITTEN] = plcrash_async_file_tell(file);
+    values[PLCRASH_WRITER_METRIC_SYSCALL_COUNT] = file->syscall_count - metrics->start_syscall_count;
+
+    for (uint32_t i = 0; i < PLCRASH_ASYNC_WORK_COUNT; i++) {
+        values[PLCRASH_WRITER_METRIC_WORK_CONSUMED + i] = writer->work_budget.consumed[i];
+        values[PLCRASH_WRITER_METRIC_WORK_EXHAUSTED + i] = writer->work_budget.exhausted[i];
+    }
+
+    for (size_t i = 0; i < sizeof(timings) / sizeof(timings[0]); i++)
+        values[timings[i]] = plcrash_writer_abstime_to_ns(writer, values[timings[i]]);
+
+    writer->last_report.thread_count = (uint32_t) values[PLCRASH_WRITER_METRIC_THREAD_COUNT];
+    writer->last_report.frame_count = metrics->frame_count;
+    writer->last_report.duration = values[PLCRASH_WRITER_METRIC_TOTAL_TIME];
+
+    for (uint32_t i = 0; i < PLCRASH_WRITER_METRIC_COUNT; i++) {
+        if (!plcrash_writer_pack_patch_fixed64(file, &metrics->slots[i], values[i]))
+            result = false;
+    }
+
+    if (metrics->truncated && !plcrash_writer_pack_patch_bool(file, &metrics->truncated_slot, true))
+        result = false;
+
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Write the metrics message, reserving output space for metric values that will be supplied by
+ * plcrash_writer_metrics_finish().
+ *
+ * @param file Output file
+ * @param metrics The metrics state.
+ */
+static size_t plcrash_writer_write_metrics (plcrash_async_file_t *file, plcrash_writer_metrics_t *metrics) {
+    size_t rv = 0;
+
+    for (uint32_t i = 0; i < PLCRASH_WRITER_METRIC_COUNT; i++)
+        rv += plcrash_writer_pack_reserve_fixed64(file, i + 1, &metrics->slots[i]);
+
+    return rv;
+}
+
+/**
+ * @internal
+ *
+ * Determine the type of the report to be written by @a writer. Hang reports, and reports of non-fatal EXC_RESOURCE
+ * exceptions, are written as watchdog reports; as both are written on request, they take precedence over the
+ * user-requested live report type.
  *
- * @param file Output file
- * @param siginfo The signal information
+ * @param writer Writer containing report data
+ * @param siginfo The report's signal information.
  */
-static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_log_signal_info_t *siginfo) {
-    size_t rv = 0;
-    
-    /* BSD signal info is always required in the current report format; this restriction will be lifted
-     * once we switch to the 2.0 format. */
-    PLCF_ASSERT(siginfo->bsd_info != NULL);
-    
-    /* Fetch the signal name */
-    char name_buf[10];
-    const char *name;
-    if ((name = plcrash_async_signal_signame(siginfo->bsd_info->signo)) == NULL) {
-        PLCF_DEBUG("Warning -- unhandled signal number (signo=%d). This is a bug.", siginfo->bsd_info->signo);
-        snprintf(name_buf, sizeof(name_buf), "#%d", siginfo->bsd_info->signo);
-        name = name_buf;
-    }
+static PLCrashReportType plcrash_writer_report_type (plcrash_log_writer_t *writer, plcrash_log_signal_info_t *siginfo) {
+    if (writer->hang != NULL)
+        return PLCrashReportTypeWatchdog;
 
-    /* Fetch the signal code string */
-    char code_buf[10];
-    const char *code;
-    if ((code = plcrash_async_signal_sigcode(siginfo->bsd_info->signo, siginfo->bsd_info->code)) == NULL) {
-        PLCF_DEBUG("Warning -- unhandled signal sicode (signo=%d, code=%d). This is a bug.", siginfo->bsd_info->signo, siginfo->bsd_info->code);
-        snprintf(code_buf, sizeof(code_buf), "#%d", siginfo->bsd_info->code);
-        code = code_buf;
-    }
-    
-    /* Address value */
-    uint64_t addr = (uintptr_t) siginfo->bsd_info->address;
+#ifdef EXC_RESOURCE
+    if (siginfo->mach_info != NULL && siginfo->mach_info->type == EXC_RESOURCE)
+        return PLCrashReportTypeWatchdog;
+#endif
 
-    /* Write it out */
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_NAME_ID, PLPROTOBUF_C_TYPE_STRING, name);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_CODE_ID, PLPROTOBUF_C_TYPE_STRING, code);
-    rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ADDRESS_ID, PLPROTOBUF_C_TYPE_UINT64, &addr);
-    
-    /* Mach exception info */
-    if (siginfo->mach_info != NULL) {
-        uint32_t size;
-        
-        /* Determine size */
-        size = plcrash_writer_write_mach_signal(NULL, siginfo->mach_info);
-        
-        /* Write message */
-        rv += plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_MACH_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        rv += plcrash_writer_write_mach_signal(file, siginfo->mach_info);
-    }
+    if (writer->report_info.user_requested)
+        return PLCrashReportTypeLive;
 
-    return rv;
+    if (writer->uncaught_exception.has_exception)
+        return PLCrashReportTypeLanguageException;
+
+    return PLCrashReportTypeCrash;
 }
 
 /**
@@ -1236,12 +6244,20 @@ static size_t plcrash_writer_write_signal (plcrash_async_file_t *file, plcrash_l
  *
  * @param file Output file
  * @param writer Writer containing report data
+ * @param metrics The crash-time metrics state, or NULL if metrics should not be written.
+ * @param type The report type; see plcrash_writer_report_type().
  */
-static size_t plcrash_writer_write_report_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer) {
+static size_t plcrash_writer_write_report_info (plcrash_async_file_t *file, plcrash_log_writer_t *writer, plcrash_writer_metrics_t *metrics,
+                                                PLCrashReportType type)
+{
     size_t rv = 0;
+    uint32_t type_value = type;
 
     /* Note crashed status */
     rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_USER_REQUESTED_ID, PLPROTOBUF_C_TYPE_BOOL, &writer->report_info.user_requested);
+
+    /* Write the report type */
+    rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_TYPE_ID, PLPROTOBUF_C_TYPE_ENUM, &type_value);
     
     /* Write the 128-bit UUID */
     PLProtobufCBinaryData uuid_bin;
@@ -1250,11 +6266,22 @@ static size_t plcrash_writer_write_report_info (plcrash_async_file_t *file, plcr
     uuid_bin.data = &writer->report_info.uuid_bytes;
     rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_UUID_ID, PLPROTOBUF_C_TYPE_BYTES, &uuid_bin);
 
+    /* Reserve the crash-time metrics */
+    if (metrics != NULL) {
+        uint32_t size = plcrash_writer_write_metrics(NULL, metrics);
+        rv += plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_METRICS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        rv += plcrash_writer_write_metrics(file, metrics);
+
+        /* Reserve the truncation flag; the flag is only set once the report's data has been written. */
+        rv += plcrash_writer_pack_reserve_bool(file, PLCRASH_PROTO_REPORT_INFO_TRUNCATED_ID, &metrics->truncated_slot);
+    }
+
     return rv;
 }
 
 /**
- * Write the crash report. All other running threads are suspended while the crash report is generated.
+ * Write the crash report for the current task. All other running threads are suspended while the crash report is
+ * generated.
  *
  * @param writer The writer context.
  * @param crashed_thread The crashed thread. 
@@ -1266,6 +6293,8 @@ static size_t plcrash_writer_write_report_info (plcrash_async_file_t *file, plcr
  * context-generating trampoline such as plcrash_log_writer_write_curthread(). If NULL, a thread dump for the current
  * thread will not be written. If @a crashed_thread is the current thread (as returned by mach_thread_self()), this
  * value <em>must</em> be provided.
+ *
+ * @sa plcrash_log_writer_write_task()
  */
 plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
                                           thread_t crashed_thread,
@@ -1273,27 +6302,117 @@ plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
                                           plcrash_async_file_t *file,
                                           plcrash_log_signal_info_t *siginfo,
                                           plcrash_async_thread_state_t *current_state)
+{
+    return plcrash_log_writer_write_task(writer, mach_task_self(), crashed_thread, image_list, file, siginfo, current_state);
+}
+
+/**
+ * Write a crash report for @a task. All other running threads within @a task are suspended while the crash report
+ * is generated.
+ *
+ * If @a task is not the current task, the report is captured out-of-process: the target's threads, stacks and images
+ * are read via @a task, and the report generation is not subject to the target's heap or stack state. In this case, the
+ * writer's process (see plcrash_log_writer_set_target_process()), application and exception data must have been
+ * configured to describe the target process, and
+ * @a image_list must describe the images loaded in @a task.
+ *
+ * @param writer The writer context.
+ * @param task The task for which the report will be written. The caller must hold a send right to the task's
+ * control port.
+ * @param crashed_thread The crashed thread, as a thread port in the current task's port namespace.
+ * @param image_list The list of binary images loaded in @a task.
+ * @param file The output file.
+ * @param siginfo Signal information.
+ * @param current_state If non-NULL, the given thread state will be used when walking the current thread. Ignored if
+ * @a task is not the current task. See plcrash_log_writer_write().
+ */
+plcrash_error_t plcrash_log_writer_write_task (plcrash_log_writer_t *writer,
+                                               task_t task,
+                                               thread_t crashed_thread,
+                                               plcrash_async_image_list_t *image_list,
+                                               plcrash_async_file_t *file,
+                                               plcrash_log_signal_info_t *siginfo,
+                                               plcrash_async_thread_state_t *current_state)
 {
     thread_act_array_t threads;
     mach_msg_type_number_t thread_count;
+    uint64_t phase_start;
+    uint64_t suspend_start = 0;
+    plcrash_writer_thread_snapshot_t *snapshots = NULL;
+    bool resumed = false;
+    bool local_regions = false;
+
+    /* Start recording crash-time metrics */
+    plcrash_writer_metrics_t metrics;
+    plcrash_writer_metrics_init(&metrics, file);
+    plcrash_async_work_budget_reset(&writer->work_budget);
+
+    /* Determine the report deadline */
+    if (writer->capture_time_budget != 0) {
+        writer->deadline = metrics.start_time + writer->capture_time_budget;
+    } else {
+        writer->deadline = 0;
+    }
+
+    /* The thread on which the report is being written; none of the target task's threads are the current thread
+     * when writing out-of-process. */
+    thread_t self = MACH_PORT_NULL;
+    if (task == mach_task_self()) {
+        self = pl_mach_thread_self();
+    } else {
+        current_state = NULL;
+    }
 
     /* A context must be supplied if the current thread is marked as the crashed thread; otherwise,
      * the thread's stack can not be safely walked. */
-    BOOL include_stack = (pl_mach_thread_self() != crashed_thread || current_state != NULL);
+    BOOL include_stack = (self != crashed_thread || current_state != NULL);
 
     plcrash_async_symbol_cache_t findContext;
     if (include_stack) {
         /* Get a list of all threads */
-        if (task_threads(mach_task_self(), &threads, &thread_count) != KERN_SUCCESS) {
-            PLCF_DEBUG("Fetching thread list failed");
+        kern_return_t kr = task_threads(task, &threads, &thread_count);
+        if (kr != KERN_SUCCESS) {
+            PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_THREAD_LIST_FAILED, kr, 0, 0);
             thread_count = 0;
         }
-    
-        /* Suspend all but the current thread. */
+
+        /* Fetch the threads' scheduling state prior to suspending them */
+        plcrash_writer_capture_thread_info(writer, threads, thread_count);
+
+        /* Reentrant writers must not suspend each other; the lock is held until the threads are resumed */
+        if (writer->reentrant)
+            pthread_mutex_lock(&plcrash_writer_suspend_lock);
+
+        /* Suspend all but the current thread and any worker threads. */
+        phase_start = suspend_start = mach_absolute_time();
         for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
-            if (threads[i] != pl_mach_thread_self())
+            if (threads[i] != self && !plcrash_log_writer_workers_contains(writer->workers, threads[i]))
                 thread_suspend(threads[i]);
         }
+        metrics.values[PLCRASH_WRITER_METRIC_THREAD_SUSPEND_TIME] = mach_absolute_time() - phase_start;
+
+        /* With all other threads suspended, local reads within the task's readable regions can bypass the Mach trap */
+        if (writer->region_map != NULL && task == mach_task_self() && plcrash_async_memory_region_map_build(writer->region_map) == PLCRASH_ESUCCESS) {
+            plcrash_async_memory_set_local_region_map(writer->region_map);
+            local_regions = true;
+        }
+
+        /* If snapshotting, capture the threads' state and resume them before any stack is walked. On failure, the
+         * threads remain suspended until the report has been written. Raw stack captures are copied while the
+         * threads are suspended, and do not require a snapshot. */
+        if (writer->snapshot_threads && writer->raw_stack_size == 0 && thread_count > 0) {
+            snapshots = plcrash_writer_snapshot_threads(writer, task, self, crashed_thread, threads, thread_count, current_state, image_list);
+            if (snapshots != NULL) {
+                if (local_regions)
+                    plcrash_async_memory_set_local_region_map(NULL);
+                plcrash_writer_resume_threads(writer, self, threads, thread_count);
+                metrics.values[PLCRASH_WRITER_METRIC_SUSPENDED_TIME] = mach_absolute_time() - suspend_start;
+                resumed = true;
+
+                if (writer->reentrant)
+                    pthread_mutex_unlock(&plcrash_writer_suspend_lock);
+            }
+        }
     }
 
     /* Set up a symbol-finding context. */
@@ -1301,27 +6420,53 @@ plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
     /* Abort if it failed, although that should never actually happen, ever. */
     if (err != PLCRASH_ESUCCESS)
         return err;
+    findContext.objc_cache.workBudget = &writer->work_budget;
 
-    /* Write the file header */
+    /* Live reports may allocate; the Objective-C IMP indices built for shared cache images, which are never unloaded,
+     * are published to the images and reused by all subsequent reports. */
+    if (writer->workers != NULL && !writer->workers->async_safe && task == image_list->task)
+        findContext.objc_cache.sharedCache = plcrash_async_image_list_get_shared_cache(image_list);
+
+    /* Write the file header. All output from the header onward is covered by the report checksum. */
+    off_t header_offset = plcrash_async_file_tell(file);
+    plcrash_async_file_checksum_begin(file);
     {
-        uint8_t version = PLCRASH_REPORT_FILE_VERSION;
+        uint8_t version = writer->file_version;
+        if (writer->footer)
+            version |= PLCRASH_REPORT_FILE_FLAG_FOOTER;
 
         /* Write the magic string (with no trailing NULL) and the version number */
         plcrash_async_file_write(file, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC));
         plcrash_async_file_write(file, &version, sizeof(version));
     }
-    
+
+    /* Record the report's sections for the footer */
+    plcrash_writer_footer_t footer_storage;
+    plcrash_writer_footer_t *footer = NULL;
+    if (writer->footer) {
+        footer_storage.message_offset = plcrash_async_file_tell(file);
+        footer_storage.count = 0;
+        footer_storage.open = false;
+        footer_storage.thread_count = 0;
+        footer_storage.crashed_index = PLCRASH_REPORT_FOOTER_NO_THREAD;
+        footer_storage.crashed_offset = 0;
+        footer_storage.crashed_length = 0;
+        footer = &footer_storage;
+    }
     
     /* Report Info */
     {
         uint32_t size;
         
+        PLCrashReportType type = plcrash_writer_report_type(writer, siginfo);
+
         /* Determine size */
-        size = plcrash_writer_write_report_info(NULL, writer);
+        size = plcrash_writer_write_report_info(NULL, writer, &metrics, type);
         
         /* Write message */
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_REPORT_INFO_ID);
         plcrash_writer_pack(file, PLCRASH_PROTO_REPORT_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_report_info(file, writer);
+        plcrash_writer_write_report_info(file, writer, &metrics, type);
     }
 
     /* System Info */
@@ -1331,7 +6476,7 @@ plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
 
         /* Must stay the same across both calls, so get the timestamp here */
         if (time(&timestamp) == (time_t)-1) {
-            PLCF_DEBUG("Failed to fetch timestamp: %s", strerror(errno));
+            PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_TIMESTAMP_FAILED, errno, 0, 0);
             timestamp = 0;
         }
 
@@ -1339,138 +6484,554 @@ plcrash_error_t plcrash_log_writer_write (plcrash_log_writer_t *writer,
         size = plcrash_writer_write_system_info(NULL, writer, timestamp);
         
         /* Write message */
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_SYSTEM_INFO_ID);
         plcrash_writer_pack(file, PLCRASH_PROTO_SYSTEM_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
         plcrash_writer_write_system_info(file, writer, timestamp);
     }
     
-    /* Machine Info */
-    {
-        uint32_t size;
-
-        /* Determine size */
-        size = plcrash_writer_write_machine_info(NULL, writer);
-
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_MACHINE_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_machine_info(file, writer);
+    /* Machine, App, and Process Info */
+    if (writer->static_header.data != NULL) {
+        size_t offset = writer->static_header.system_info_length;
+        plcrash_writer_footer_mark_encoded(footer, file, writer->static_header.data + offset, writer->static_header.length - offset);
+        plcrash_async_file_write(file, writer->static_header.data + offset, writer->static_header.length - offset);
+    } else {
+        plcrash_writer_write_static_messages(file, writer, footer);
     }
 
-    /* App info */
-    {
+    /* Signal. The report is written progressively, most important records first, and each section is flushed as it
+     * is completed; should the process be terminated while writing the remainder, the records written so far can be
+     * recovered with PLCrashReportDecodingOptionSalvage. The signal is the last of the report's required records. */
+    if (siginfo) {
         uint32_t size;
-
-        /* Determine size */
-        size = plcrash_writer_write_app_info(NULL, writer->application_info.app_identifier, writer->application_info.app_version);
         
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_APP_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_app_info(file, writer->application_info.app_identifier, writer->application_info.app_version);
+        /* Calculate the message size */
+        size = plcrash_writer_write_signal(NULL, siginfo);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_SIGNAL_ID);
+        plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_signal(file, siginfo);
     }
-    
-    /* Process info */
-    {
-        uint32_t size;
-        
-        /* Determine size */
-        size = plcrash_writer_write_process_info(NULL, writer->process_info.process_name, writer->process_info.process_id, 
-                                                 writer->process_info.process_path, writer->process_info.parent_process_name,
-                                                 writer->process_info.parent_process_id, writer->process_info.native,
-                                                 writer->process_info.start_time);
-        
-        /* Write message */
-        plcrash_writer_pack(file, PLCRASH_PROTO_PROCESS_INFO_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_process_info(file, writer->process_info.process_name, writer->process_info.process_id, 
-                                          writer->process_info.process_path, writer->process_info.parent_process_name, 
-                                          writer->process_info.parent_process_id, writer->process_info.native,
-                                          writer->process_info.start_time);
+    plcrash_async_file_flush(file);
+
+    /* Determine whether shared cache images are to be omitted. If the shared cache can't be found, all images are
+     * written. */
+    plcrash_async_shared_cache_t shared_cache_info;
+    plcrash_async_shared_cache_t *shared_cache = NULL;
+    if (include_stack && (writer->image_options & PLCRASH_LOG_WRITER_IMAGES_ELIDE_SHARED_CACHE)) {
+        /* Prefer the shared cache already located by the image list, if any */
+        if (task == image_list->task)
+            shared_cache = plcrash_async_image_list_get_shared_cache(image_list);
+
+        if (shared_cache == NULL) {
+            if ((err = plcrash_async_shared_cache_init(&shared_cache_info, task)) == PLCRASH_ESUCCESS) {
+                shared_cache = &shared_cache_info;
+            } else {
+                PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_SHARED_CACHE_FAILED, err, 0, 0);
+            }
+        }
+    }
+
+    /* Compact reports reference binary images by their position in the report's binary images, which are written in
+     * the order of the image list's sorted index, or when writing only referenced images, in order of first reference.
+     * A single snapshot of the index is used to write all frames and images, and is held for reading until the report
+     * is complete. If no index is available, or the binary images will not be written, absolute frame PCs and all
+     * images are written instead. */
+    plcrash_writer_image_refs_t image_refs_storage;
+    plcrash_writer_image_refs_t *image_refs = NULL;
+    plcrash_async_image_index_t *image_index = NULL;
+    bool compact = (writer->file_version == PLCRASH_REPORT_FILE_VERSION_COMPACT && include_stack);
+    /* Raw stack captures may reference any loaded image, all of which are required to unwind the stacks offline. */
+    bool referenced_only = (include_stack && writer->raw_stack_size == 0 && (writer->image_options & PLCRASH_LOG_WRITER_IMAGES_REFERENCED_ONLY));
+    bool indexed = (compact || referenced_only);
+    if (indexed) {
+        plcrash_async_image_list_set_reading(image_list, true);
+        image_index = plcrash_async_image_list_get_index(image_list);
+    }
+
+    if (image_index != NULL) {
+        image_refs_storage.index = image_index;
+        image_refs_storage.map = NULL;
+        image_refs_storage.shared_cache = shared_cache;
+        image_refs_storage.compact = compact;
+        image_refs_storage.referenced_only = referenced_only;
+
+        /* If images are omitted, map the index positions to the positions of the written images. The map is always
+         * allocated by plcrash_log_writer_set_image_options() when images may be omitted. */
+        if (shared_cache != NULL || referenced_only) {
+            PLCF_ASSERT(writer->image_map != NULL);
+            struct plcrash_log_writer_image_map *map = writer->image_map;
+
+            map->count = (uint32_t) MIN(image_index->count, PLCRASH_WRITER_IMAGE_MAP_MAX);
+            map->assigned = 0;
+
+            if (referenced_only) {
+                /* Positions are assigned as images are referenced */
+                plcrash_async_memset(map->positions, 0, map->count * sizeof(map->positions[0]));
+            } else {
+                for (uint32_t i = 0; i < map->count; i++) {
+                    if (plcrash_writer_should_write_image(shared_cache, &image_index->images[i]->macho_image))
+                        map->positions[i] = ++map->assigned;
+                    else
+                        map->positions[i] = 0;
+                }
+            }
+
+            image_refs_storage.map = map;
+        }
+
+        image_refs = &image_refs_storage;
     }
 
     if (include_stack) {
         /* Threads */
         uint32_t thread_number = 0;
+
+        /* Set up a section cache. The image list is held for reading until all threads have been written, ensuring
+         * that the images referenced by the cache remain valid. */
+        plcrash_async_macho_section_cache_t sectionCacheStorage;
+        plcrash_async_macho_section_cache_t *sectionCache = NULL;
+        plcrash_async_image_list_set_reading(image_list, true);
+
+        /* Prefer the image list's persistent cache, if enabled and not in use by another thread */
+        if (writer->persistent_unwind)
+            sectionCache = plcrash_nasync_image_list_acquire_unwind_cache(image_list);
+
+        if (sectionCache == NULL) {
+            plcrash_async_macho_section_cache_init(&sectionCacheStorage);
+            sectionCache = &sectionCacheStorage;
+
+#if PLCRASH_FEATURE_UNWIND_DWARF
+            /* Attach the pre-allocated CIE cache; entries from any previous report may reference images that are
+             * no longer loaded. */
+            if (writer->dwarf_cie_cache != NULL) {
+                plframe_dwarf_cie_cache_reset(writer->dwarf_cie_cache);
+                sectionCache->dwarf_cie_cache = writer->dwarf_cie_cache;
+            }
+#endif
+        }
+        sectionCache->work_budget = &writer->work_budget;
+
+        /* Discard any threads recorded by an incomplete report */
+        if (writer->unwind_cache != NULL) {
+            writer->unwind_cache->generations[writer->unwind_cache->current].count = 0;
+            writer->unwind_cache->generations[writer->unwind_cache->current].frame_count = 0;
+        }
+
+        /* Identical backtraces are written once in compact reports */
+        struct plcrash_log_writer_stack_table *stack_table = NULL;
+        if (compact && writer->stack_table != NULL) {
+            stack_table = writer->stack_table;
+            stack_table->count = 0;
+            plcrash_async_memset(stack_table->slots, 0, sizeof(stack_table->slots));
+        }
+
+        /* Determine which threads are to be written. If a worker pool is available, the threads are captured in
+         * parallel into per-thread caches; these are allocated by the pool, from pre-reserved memory if the pool
+         * is async-safe. */
+        plcrash_writer_thread_capture_t *captures = NULL;
+        bool parallel = false;
+        if (writer->workers != NULL && (captures = plcrash_log_writer_workers_alloc(writer->workers, thread_count * sizeof(*captures))) != NULL) {
+            for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+                /* Can't log a report for the current thread without a valid context, and the worker threads are
+                 * busy writing this report. */
+                if (!plcrash_writer_should_capture_thread(writer, self, threads[i], current_state))
+                    continue;
+
+                captures[i].include = true;
+                captures[i].max_frames = plcrash_writer_thread_max_frames(writer, threads[i] == crashed_thread);
+                captures[i].symbolicated_frames = plcrash_writer_thread_symbolicated_frames(writer, threads[i] == crashed_thread, i);
+                captures[i].crashed = (threads[i] == crashed_thread);
+                captures[i].snapshot = (snapshots != NULL) ? &snapshots[i] : NULL;
+            }
+
+            parallel = plcrash_writer_capture_threads(writer, task, self, threads, captures, thread_count, current_state, image_list);
+        }
+
+        /* Determine the capture order. Threads are numbered by their task_threads() position regardless of the
+         * order in which they are written, so the crashed thread's number is determined up front. */
+        mach_msg_type_number_t crashed_index = thread_count;
+        uint32_t crashed_number = 0;
         for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+            if (threads[i] == crashed_thread) {
+                crashed_index = i;
+                break;
+            }
+
+            if (plcrash_writer_should_capture_thread(writer, self, threads[i], current_state))
+                crashed_number++;
+        }
+
+        /* If the crashed thread is written first, the exception immediately follows it */
+        bool exception_written = !writer->uncaught_exception.has_exception;
+
+        bool crashed_first = false;
+        if (writer->capture_policy.thread_order == PLCRASH_LOG_WRITER_THREAD_ORDER_CRASHED_FIRST && crashed_index < thread_count)
+            crashed_first = plcrash_writer_should_capture_thread(writer, self, crashed_thread, current_state);
+
+        for (mach_msg_type_number_t position = 0; position < thread_count; position++) {
+            mach_msg_type_number_t i = crashed_first ? plcrash_writer_thread_capture_index(position, crashed_index) : position;
             thread_t thread = threads[i];
             plcrash_async_thread_state_t *thr_ctx = NULL;
-            bool crashed = false;
-            uint32_t size;
+            bool crashed = (crashed_thread == thread);
+            plcrash_writer_msg_slot_t slot;
+            plcrash_writer_thread_capture_t serial_capture;
+            plcrash_writer_thread_capture_t *capture;
 
-            /* If executing on the target thread, we need to a valid context to walk */
-            if (pl_mach_thread_self() == thread) {
-                /* Can't log a report for the current thread without a valid context. */
-                if (current_state == NULL)
+            if (parallel) {
+                if (!captures[i].include)
                     continue;
-        
-                thr_ctx = current_state;
+            } else {
+                if (!plcrash_writer_should_capture_thread(writer, self, thread, current_state))
+                    continue;
+
+                /* If executing on the target thread, we need to a valid context to walk */
+                if (self == thread)
+                    thr_ctx = current_state;
             }
-        
-            /* Check if this is the crashed thread */
-            if (crashed_thread == thread) {
-                crashed = true;
+
+            /* Assign the thread's number; the crashed thread, if written first, retains its original position */
+            uint32_t number;
+            if (crashed_first && crashed) {
+                number = crashed_number;
+            } else {
+                number = thread_number++;
+                if (crashed_first && i > crashed_index)
+                    number++;
             }
 
-            /* Determine the size */
-            size = plcrash_writer_write_thread(NULL, writer, mach_task_self(), thread, thread_number, thr_ctx, image_list, &findContext, crashed);
+            /* Once the capture budget is exhausted, all remaining threads other than the crashed thread are omitted */
+            if (!crashed && plcrash_writer_capture_budget_exhausted(writer, file)) {
+                metrics.values[PLCRASH_WRITER_METRIC_OMITTED_THREAD_COUNT]++;
+                metrics.truncated = true;
+                continue;
+            }
 
-            /* Write message */
-            plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-            plcrash_writer_write_thread(file, writer, mach_task_self(), thread, thread_number, thr_ctx, image_list, &findContext, crashed);
+            if (parallel) {
+                capture = &captures[i];
+            } else {
+                serial_capture.cache = writer->frame_cache;
+                serial_capture.max_frames = plcrash_writer_thread_max_frames(writer, crashed);
+                serial_capture.symbolicated_frames = plcrash_writer_thread_symbolicated_frames(writer, crashed, i);
+                serial_capture.crashed = crashed;
+                serial_capture.snapshot = (snapshots != NULL) ? &snapshots[i] : NULL;
+                serial_capture.stack_table = stack_table;
+                capture = &serial_capture;
+                plcrash_writer_capture_thread(writer, task, thread, thr_ctx, image_list, &findContext, sectionCache, capture);
+            }
+
+            /* The crashed thread's register values, and those of raw stack captures, may reference images that are
+             * not otherwise referenced by a frame; eg, a data pointer into a library's __DATA segment. */
+            if ((crashed || capture->has_stack) && capture->has_state && image_refs != NULL) {
+                size_t reg_count = plcrash_async_thread_state_get_reg_count(&capture->state);
+                for (size_t reg = 0; reg < reg_count; reg++) {
+                    if (plcrash_async_thread_state_has_reg(&capture->state, (plcrash_regnum_t) reg))
+                        plcrash_writer_image_refs_mark(image_refs, (pl_vm_address_t) plcrash_async_thread_state_get_reg(&capture->state, (plcrash_regnum_t) reg));
+                }
+            }
+
+            /* Record the backtrace, or if identical to that of an earlier thread, write it by reference. The crashed
+             * thread and raw stack captures are always written in full. */
+            if (stack_table != NULL && !capture->has_stack && capture->cache->count > 0 && !capture->duplicate) {
+                bool found = plcrash_writer_stack_table_find(stack_table, capture->stack_hash, capture->cache->count, true, number, &capture->duplicate_of);
+                capture->duplicate = (found && !crashed);
+            }
+
+            /* Write the message in a single pass; the stack has already been walked and symbolicated into the
+             * capture, and walking it again to determine the message size would double the cost. */
+            plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_THREADS_ID);
+            uint32_t record_offset = (footer != NULL) ? plcrash_writer_footer_offset(footer, file) : 0;
+            plcrash_writer_pack_begin_message(file, PLCRASH_PROTO_THREADS_ID, &slot);
+            const plcrash_writer_thread_info_t *info = NULL;
+            if (writer->thread_info != NULL && i < writer->thread_info->count)
+                info = &writer->thread_info->threads[i];
+
+            /* The crashed thread's register values are annotated with their containing images and symbols */
+            plcrash_writer_register_annotator_t annotator = {
+                .refs = image_refs,
+                .strategy = writer->symbol_strategy,
+                .findContext = &findContext
+            };
+
+            plcrash_writer_write_thread(file, task, number, capture, crashed, image_refs, info,
+                                        writer->file_version == PLCRASH_REPORT_FILE_VERSION_COMPACT,
+                                        (crashed && image_refs != NULL) ? &annotator : NULL);
+            if (!plcrash_writer_pack_end_message(file, &slot))
+                PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_MESSAGE_LENGTH_FAILED, PLCRASH_PROTO_THREADS_ID, 0, 0);
+
+            if (footer != NULL) {
+                if (crashed) {
+                    footer->crashed_index = footer->thread_count;
+                    footer->crashed_offset = record_offset;
+                    footer->crashed_length = plcrash_writer_footer_offset(footer, file) - record_offset;
+                }
+                footer->thread_count++;
+            }
+
+            if (writer->unwind_cache != NULL)
+                plcrash_writer_unwind_cache_record(writer, writer->unwind_cache, capture);
+
+            plcrash_writer_capture_free_raw_stack(capture);
+            plcrash_writer_metrics_add_capture(&metrics, capture);
+
+            /* The exception's frames are written via the writer's frame cache, which is no longer needed by the
+             * crashed thread's capture. */
+            if (crashed_first && crashed) {
+                if (!exception_written) {
+                    plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_EXCEPTION_ID);
+                    plcrash_writer_write_exception_record(file, writer, image_list, &findContext, image_refs);
+                    exception_written = true;
+                }
+                plcrash_async_file_flush(file);
+            }
+        }
+
+        /* The threads recorded by this report are read by the next */
+        if (writer->unwind_cache != NULL)
+            writer->unwind_cache->current ^= 1;
+
+        if (captures != NULL) {
+            for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
+                plcrash_writer_capture_free_raw_stack(&captures[i]);
+                plcrash_log_writer_workers_dealloc(writer->workers, captures[i].cache);
+            }
+            plcrash_log_writer_workers_dealloc(writer->workers, captures);
+
+            /* Release any allocations not reclaimed by the pool's allocator */
+            if (writer->workers->async_safe)
+                plcrash_async_allocator_reset(writer->workers->allocator, &writer->workers->allocator_mark);
+        }
+
+        if (snapshots != NULL) {
+            plcrash_writer_free_snapshots(snapshots, thread_count);
+            snapshots = NULL;
+        }
+
+        if (sectionCache == &sectionCacheStorage)
+            plcrash_async_macho_section_cache_free(&sectionCacheStorage);
+        else
+            plcrash_nasync_image_list_release_unwind_cache(image_list, sectionCache);
+        plcrash_async_image_list_set_reading(image_list, false);
+
+        /* Exception, if not already written following the crashed thread */
+        if (!exception_written) {
+            plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_EXCEPTION_ID);
+            plcrash_writer_write_exception_record(file, writer, image_list, &findContext, image_refs);
+        }
+        plcrash_async_file_flush(file);
+
+        /* Shared cache */
+        if (shared_cache != NULL) {
+            uint32_t size;
+
+            /* Determine size */
+            size = plcrash_writer_write_shared_cache(NULL, shared_cache);
 
             /* Write message */
-            plcrash_writer_pack(file, PLCRASH_PROTO_THREADS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-            plcrash_writer_write_thread(file, writer, mach_task_self(), thread, thread_number, thr_ctx, image_list, &findContext, crashed);
+            plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_SHARED_CACHE_ID);
+            plcrash_writer_pack(file, PLCRASH_PROTO_SHARED_CACHE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_shared_cache(file, shared_cache);
+        }
 
-            thread_number++;
+        /* Mark the exception's full callstack, including any frames beyond those written, prior to writing the
+         * binary images. */
+        if (image_refs != NULL && writer->uncaught_exception.has_exception) {
+            for (size_t i = 0; i < writer->uncaught_exception.callstack_count; i++)
+                plcrash_writer_image_refs_mark(image_refs, (pl_vm_address_t) (uintptr_t) writer->uncaught_exception.callstack[i]);
         }
 
         /* Binary Images */
+        phase_start = mach_absolute_time();
         plcrash_async_image_list_set_reading(image_list, true);
 
-        plcrash_async_image_t *image = NULL;
-        while ((image = plcrash_async_image_list_next(image_list, image)) != NULL) {
-            uint32_t size;
+        if (image_refs != NULL) {
+            plcrash_writer_write_indexed_binary_images(file, writer, image_refs, footer);
+        } else {
+            plcrash_async_image_t *image = NULL;
+            plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_BINARY_IMAGES_ID);
+            while ((image = plcrash_async_image_list_next(image_list, image)) != NULL) {
+                uint32_t size;
 
-            /* Calculate the message size */
-            size = plcrash_writer_write_binary_image(NULL, &image->macho_image);
-            plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-            plcrash_writer_write_binary_image(file, &image->macho_image);
+                if (!plcrash_writer_should_write_image(shared_cache, &image->macho_image))
+                    continue;
+
+                /* Frames are written with absolute PCs, which do not reference image positions; once the report
+                 * deadline has passed, the remaining images are omitted. */
+                if (plcrash_writer_deadline_passed(writer)) {
+                    metrics.truncated = true;
+                    break;
+                }
+
+                /* Use the image's pre-encoded record, if available */
+                if (image->record != NULL) {
+                    plcrash_async_file_write(file, image->record, image->record_length);
+                    continue;
+                }
+
+                /* Calculate the message size */
+                size = plcrash_writer_write_binary_image(NULL, &image->macho_image, image->macho_image.name, image->macho_image.name_length, NULL);
+                plcrash_writer_pack(file, PLCRASH_PROTO_BINARY_IMAGES_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+                plcrash_writer_write_binary_image(file, &image->macho_image, image->macho_image.name, image->macho_image.name_length, NULL);
+            }
         }
 
         plcrash_async_image_list_set_reading(image_list, false);
+        metrics.values[PLCRASH_WRITER_METRIC_BINARY_IMAGES_TIME] = mach_absolute_time() - phase_start;
+        plcrash_async_file_flush(file);
+    } else if (writer->uncaught_exception.has_exception) {
+        /* Exception */
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_EXCEPTION_ID);
+        plcrash_writer_write_exception_record(file, writer, image_list, &findContext, image_refs);
     }
 
-    /* Exception */
-    if (writer->uncaught_exception.has_exception) {
+    if (indexed)
+        plcrash_async_image_list_set_reading(image_list, false);
+
+    /* Breadcrumbs */
+    if (writer->breadcrumbs != NULL) {
         uint32_t size;
 
         /* Calculate the message size */
-        size = plcrash_writer_write_exception(NULL, writer, image_list, &findContext);
-        plcrash_writer_pack(file, PLCRASH_PROTO_EXCEPTION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_exception(file, writer, image_list, &findContext);
+        size = plcrash_writer_write_breadcrumbs(NULL, writer->breadcrumbs);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_BREADCRUMBS_ID);
+        plcrash_writer_pack(file, PLCRASH_PROTO_BREADCRUMBS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_breadcrumbs(file, writer->breadcrumbs);
     }
 
-    /* Signal */
-    if (siginfo) {
+    /* Hang */
+    if (writer->hang != NULL) {
         uint32_t size;
-        
+
         /* Calculate the message size */
-        size = plcrash_writer_write_signal(NULL, siginfo);
-        plcrash_writer_pack(file, PLCRASH_PROTO_SIGNAL_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
-        plcrash_writer_write_signal(file, siginfo);
+        size = plcrash_writer_write_hang(NULL, writer->hang);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_HANG_ID);
+        plcrash_writer_pack(file, PLCRASH_PROTO_HANG_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_hang(file, writer->hang);
+    }
+
+    /* Memory usage */
+    if (writer->vm_summary != NULL) {
+        uint32_t size;
+
+        /* Populate the summary; this must be done prior to calculating the message size */
+        if (plcrash_async_vm_summary_build(writer->vm_summary, task, PLCRASH_ASYNC_VM_SUMMARY_MAX_REGIONS) != PLCRASH_ESUCCESS)
+            PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_VM_SUMMARY_INCOMPLETE, 0, 0, 0);
+
+        /* Calculate the message size */
+        size = plcrash_writer_write_memory(NULL, writer->vm_summary);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_MEMORY_ID);
+        plcrash_writer_pack(file, PLCRASH_PROTO_MEMORY_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_memory(file, writer->vm_summary);
+    }
+
+    /* Termination */
+    if (writer->termination != NULL) {
+        uint32_t size;
+
+        /* Calculate the message size */
+        size = plcrash_writer_write_termination(NULL, writer->termination);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_TERMINATION_ID);
+        plcrash_writer_pack(file, PLCRASH_PROTO_TERMINATION_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_termination(file, writer->termination);
+    }
+
+    /* User regions; the registry describes the current task, and its regions are not available in other tasks. */
+    if (writer->user_regions != NULL && writer->user_region_buffer != NULL && task == mach_task_self()) {
+        for (uint32_t i = 0; i < PLCRASH_ASYNC_USER_REGIONS_MAX; i++) {
+            uint32_t tag;
+            pl_vm_address_t address;
+            pl_vm_size_t length;
+            uint32_t size;
+
+            if (!plcrash_async_user_regions_get(writer->user_regions, i, &tag, &address, &length))
+                continue;
+
+            /* Copy the region once, such that the sized and written messages match; a region deallocated without
+             * being unregistered is written without its contents. */
+            const void *data = writer->user_region_buffer;
+            if (plcrash_async_task_memcpy(task, address, 0, writer->user_region_buffer, length) != PLCRASH_ESUCCESS)
+                data = NULL;
+
+            /* Calculate the message size */
+            size = plcrash_writer_write_user_region(NULL, tag, address, length, data);
+            plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_USER_REGIONS_ID);
+            plcrash_writer_pack(file, PLCRASH_PROTO_USER_REGIONS_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+            plcrash_writer_write_user_region(file, tag, address, length, data);
+        }
+    }
+
+    /* Threads that were not snapshotted remain suspended until the report is complete */
+    if (include_stack && !resumed)
+        metrics.values[PLCRASH_WRITER_METRIC_SUSPENDED_TIME] = mach_absolute_time() - suspend_start;
+
+    /* Crash-time metrics */
+    if (!plcrash_writer_metrics_finish(file, writer, &metrics))
+        PLCF_TRACE(PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_METRICS_FAILED, 0, 0, 0);
+
+    /* Debug trace; written last, such that it includes any events recorded while writing the report. The record
+     * count is fixed before the message is sized, as other threads may continue to record events. */
+    if (writer->trace != NULL && writer->trace->sequence > 0) {
+        uint64_t recorded = (uint64_t) writer->trace->sequence;
+        size_t count = (size_t) MIN(recorded, (uint64_t) PLCRASH_ASYNC_TRACE_CAPACITY);
+        uint32_t size;
+
+        /* Calculate the message size */
+        size = plcrash_writer_write_debug_trace(NULL, writer->trace, count);
+        plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_DEBUG_TRACE_ID);
+        plcrash_writer_pack(file, PLCRASH_PROTO_DEBUG_TRACE_ID, PLPROTOBUF_C_TYPE_MESSAGE, &size);
+        plcrash_writer_write_debug_trace(file, writer->trace, count);
     }
     
     if (include_stack) {
         plcrash_async_symbol_cache_free(&findContext);
     
-        /* Clean up the thread array */
-        for (mach_msg_type_number_t i = 0; i < thread_count; i++) {
-            if (threads[i] != pl_mach_thread_self())
-                thread_resume(threads[i]);
+        /* Resume any threads that were not already resumed after snapshotting, and clean up the thread array */
+        if (!resumed) {
+            if (local_regions)
+                plcrash_async_memory_set_local_region_map(NULL);
+            plcrash_writer_resume_threads(writer, self, threads, thread_count);
+
+            if (writer->reentrant)
+                pthread_mutex_unlock(&plcrash_writer_suspend_lock);
+        }
 
+        for (mach_msg_type_number_t i = 0; i < thread_count; i++)
             mach_port_deallocate(mach_task_self(), threads[i]);
-        }
 
         vm_deallocate(mach_task_self(), (vm_address_t)threads, sizeof(thread_t) * thread_count);
     }
+
+    /* Terminate the report with the checksum of all preceding output (see +[PLCrashReport validateData:error:]) */
+    {
+        uint32_t checksum;
+        if (plcrash_async_file_checksum(file, &checksum)) {
+            plcrash_writer_footer_mark(footer, file, PLCRASH_PROTO_CHECKSUM_ID);
+            plcrash_writer_pack(file, PLCRASH_PROTO_CHECKSUM_ID, PLPROTOBUF_C_TYPE_FIXED32, &checksum);
+        } else {
+            PLCF_DEBUG("The report checksum is unavailable; the report will not be checksummed");
+        }
+    }
+
+    /* Close the last section; the footer itself is written once the message is complete */
+    plcrash_writer_footer_mark(footer, file, 0);
+
+    /* Compress the completed report, flagging the compressed encoding in the file header */
+    if (writer->compressor != NULL) {
+        off_t message_offset = header_offset + strlen(PLCRASH_REPORT_FILE_MAGIC) + 1;
+        if (plcrash_async_file_compress(file, message_offset, &writer->compressor->state, writer->compressor->output, writer->compressor->output_size)) {
+            uint8_t version = writer->file_version | PLCRASH_REPORT_FILE_FLAG_COMPRESSED;
+            if (footer != NULL)
+                version |= PLCRASH_REPORT_FILE_FLAG_FOOTER;
+            if (!plcrash_async_file_pwrite(file, message_offset - 1, &version, sizeof(version)))
+                PLCF_DEBUG("Failed to mark the report as compressed");
+        }
+    }
+
+    /* The footer follows any compressed output, such that it may be read without decompressing the report */
+    if (footer != NULL)
+        plcrash_writer_write_footer(file, footer);
+
+    /* Release any crash-time memory allocated while writing the report */
+    if (writer->allocator != NULL)
+        plcrash_async_allocator_reset(writer->allocator, &writer->allocator_mark);
     
     return PLCRASH_ESUCCESS;
 }
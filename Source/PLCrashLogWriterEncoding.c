@@ -24,6 +24,7 @@
 #import <stdint.h>
 #import <string.h>
 #import <stdlib.h>
+#import <inttypes.h>
 
 #include "PLCrashLogWriterEncoding.h"
 
@@ -54,19 +55,13 @@ get_tag_size (unsigned number)
     else
         return 5;
 }
+/* Each varint byte carries 7 bits of the value; the size is computed from the index of the highest set bit, with
+ * a zero value occupying a single byte. (bits * 9 + 64) / 64 is equivalent to ceil(bits / 7) for bits <= 64. */
 static inline size_t
 uint32_size (uint32_t v)
 {
-    if (v < (1<<7))
-        return 1;
-    else if (v < (1<<14))
-        return 2;
-    else if (v < (1<<21))
-        return 3;
-    else if (v < (1<<28))
-        return 4;
-    else
-        return 5;
+    uint32_t bits = 32 - __builtin_clz(v | 1);
+    return (bits * 9 + 64) / 64;
 }
 static inline size_t
 int32_size (int32_t v)
@@ -74,16 +69,7 @@ int32_size (int32_t v)
     if (v < 0)
         return 10;
     else
-        if (v < (1<<7))
-            return 1;
-        else if (v < (1<<14))
-            return 2;
-        else if (v < (1<<21))
-            return 3;
-        else if (v < (1<<28))
-            return 4;
-        else
-            return 5;
+        return uint32_size ((uint32_t) v);
 }
 static inline uint32_t
 zigzag32 (int32_t v)
@@ -101,21 +87,8 @@ sint32_size (int32_t v)
 static inline size_t
 uint64_size (uint64_t v)
 {
-    uint32_t upper_v = (v>>32);
-    if (upper_v == 0)
-        return uint32_size ((uint32_t)v);
-    else if (upper_v < (1<<3))
-        return 5;
-    else if (upper_v < (1<<10))
-        return 6;
-    else if (upper_v < (1<<17))
-        return 7;
-    else if (upper_v < (1<<24))
-        return 8;
-    else if (upper_v < (1U<<31))
-        return 9;
-    else
-        return 10;
+    uint32_t bits = 64 - __builtin_clzll(v | 1);
+    return (bits * 9 + 64) / 64;
 }
 static inline uint64_t
 zigzag64 (int64_t v)
@@ -133,35 +106,35 @@ sint64_size (int64_t v)
 
 
 /* === pack() === */
+/* The unrolled packers write every byte with the continuation bit set, falling through from the highest byte, and then
+ * clear the continuation bit of the final byte. */
 static inline size_t
 uint32_pack (uint32_t value, uint8_t *out)
 {
-    unsigned rv = 0;
-    if (value >= 0x80)
+    size_t rv = uint32_size (value);
+    switch (rv)
     {
-        out[rv++] = value | 0x80;
-        value >>= 7;
-        if (value >= 0x80)
-        {
-            out[rv++] = value | 0x80;
-            value >>= 7;
-            if (value >= 0x80)
-            {
-                out[rv++] = value | 0x80;
-                value >>= 7;
-                if (value >= 0x80)
-                {
-                    out[rv++] = value | 0x80;
-                    value >>= 7;
-                }
-            }
-        }
+        case 5: out[4] = (value>>28) | 0x80;
+        case 4: out[3] = (value>>21) | 0x80;
+        case 3: out[2] = (value>>14) | 0x80;
+        case 2: out[1] = (value>>7) | 0x80;
+        case 1: out[0] = value | 0x80;
     }
-    /* assert: value<128 */
-    out[rv++] = value;
+    out[rv - 1] &= 0x7f;
     return rv;
 }
 static inline size_t
+padded_uint32_pack (uint32_t value, uint8_t *out)
+{
+    /* Always emit PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE bytes; the continuation bit is set on all but the last byte. */
+    out[0] = value | 0x80;
+    out[1] = (value>>7) | 0x80;
+    out[2] = (value>>14) | 0x80;
+    out[3] = (value>>21) | 0x80;
+    out[4] = (value>>28);
+    return PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE;
+}
+static inline size_t
 int32_pack (int32_t value, uint8_t *out)
 {
     if (value < 0)
@@ -182,35 +155,24 @@ static inline size_t sint32_pack (int32_t value, uint8_t *out)
 {
     return uint32_pack (zigzag32 (value), out);
 }
-static size_t
+static inline size_t
 uint64_pack (uint64_t value, uint8_t *out)
 {
-    uint32_t hi = value>>32;
-    uint32_t lo = value;
-    unsigned rv;
-    if (hi == 0)
-        return uint32_pack ((uint32_t)lo, out);
-    out[0] = (lo) | 0x80;
-    out[1] = (lo>>7) | 0x80;
-    out[2] = (lo>>14) | 0x80;
-    out[3] = (lo>>21) | 0x80;
-    if (hi < 8)
+    size_t rv = uint64_size (value);
+    switch (rv)
     {
-        out[4] = (hi<<4) | (lo>>28);
-        return 5;
+        case 10: out[9] = (value>>63) | 0x80;
+        case 9: out[8] = (value>>56) | 0x80;
+        case 8: out[7] = (value>>49) | 0x80;
+        case 7: out[6] = (value>>42) | 0x80;
+        case 6: out[5] = (value>>35) | 0x80;
+        case 5: out[4] = (value>>28) | 0x80;
+        case 4: out[3] = (value>>21) | 0x80;
+        case 3: out[2] = (value>>14) | 0x80;
+        case 2: out[1] = (value>>7) | 0x80;
+        case 1: out[0] = value | 0x80;
     }
-    else
-    {
-        out[4] = ((hi&7)<<4) | (lo>>28) | 0x80;
-        hi >>= 3;
-    }
-    rv = 5;
-    while (hi >= 128)
-    {
-        out[rv++] = hi | 0x80;
-        hi >>= 7;
-    }
-    out[rv++] = hi;
+    out[rv - 1] &= 0x7f;
     return rv;
 }
 static inline size_t sint64_pack (int64_t value, uint8_t *out)
@@ -252,13 +214,57 @@ static inline size_t string_pack (const char * str, uint8_t *out)
     return rv + len;
 }
 
-/* wire-type will be added in required_field_pack() */
-static size_t tag_pack (uint32_t id, uint8_t *out)
+/**
+ * @internal
+ * The largest field identifier whose tag may be encoded in a single byte (4 bits of field id, 3 bits of wire type).
+ */
+#define SINGLE_BYTE_TAG_MAX_ID ((1 << 4) - 1)
+
+/**
+ * @internal
+ * The largest field identifier whose tag may be encoded in two bytes.
+ */
+#define DOUBLE_BYTE_TAG_MAX_ID ((1 << 11) - 1)
+
+/*
+ * Return the encoded size of the tag for @a id. All crash report field identifiers are small constants, and
+ * are handled without performing a varint size computation.
+ */
+static inline size_t tag_size (uint32_t id)
 {
-    if (id < (1<<(32-3)))
-        return uint32_pack (id<<3, out);
+    if (id <= SINGLE_BYTE_TAG_MAX_ID)
+        return 1;
+    else if (id <= DOUBLE_BYTE_TAG_MAX_ID)
+        return 2;
+    else if (id < (1<<(32-3)))
+        return uint32_size (id<<3);
     else
-        return uint64_pack (((uint64_t)id) << 3, out);
+        return uint64_size (((uint64_t)id) << 3);
+}
+
+/*
+ * Write the tag for @a id and @a wire_type to @a out. Single and double byte tags -- which covers all crash report
+ * fields -- are written directly, without a general varint encode.
+ */
+static inline size_t tag_pack (uint32_t id, uint8_t wire_type, uint8_t *out)
+{
+    size_t rv;
+
+    if (id <= SINGLE_BYTE_TAG_MAX_ID) {
+        out[0] = (uint8_t) ((id << 3) | wire_type);
+        return 1;
+    } else if (id <= DOUBLE_BYTE_TAG_MAX_ID) {
+        out[0] = (uint8_t) (((id << 3) & 0x7f) | 0x80 | wire_type);
+        out[1] = (uint8_t) (id >> 4);
+        return 2;
+    } else if (id < (1<<(32-3))) {
+        rv = uint32_pack (id<<3, out);
+    } else {
+        rv = uint64_pack (((uint64_t)id) << 3, out);
+    }
+
+    out[0] |= wire_type;
+    return rv;
 }
 
 /* === pack_to_buffer() === */
@@ -266,7 +272,7 @@ static size_t tag_pack (uint32_t id, uint8_t *out)
 size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLProtobufCType field_type, const void *value) {
     size_t rv;
     uint8_t scratch[MAX_UINT64_ENCODED_SIZE * 2];
-    rv = tag_pack (field_id, scratch);
+    rv = tag_pack (field_id, 0, scratch);
     switch (field_type)
     {
         case PLPROTOBUF_C_TYPE_SINT32:
@@ -366,3 +372,228 @@ size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLPro
     }
     return rv;
 }
+
+/**
+ * Write a uint64 field. This is equivalent to calling plcrash_writer_pack() with PLPROTOBUF_C_TYPE_UINT64, but avoids
+ * dispatching on the field type.
+ *
+ * @param file The output file. If NULL, only the size of the field will be computed.
+ * @param field_id The field identifier.
+ * @param value The field value.
+ *
+ * @return Returns the number of bytes written (or that would be written) for the field.
+ */
+size_t plcrash_writer_pack_uint64 (plcrash_async_file_t *file, uint32_t field_id, uint64_t value) {
+    size_t rv;
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE * 2];
+
+    if (file == NULL)
+        return tag_size (field_id) + uint64_size (value);
+
+    rv = tag_pack (field_id, PLPROTOBUF_C_WIRE_TYPE_VARINT, scratch);
+    rv += uint64_pack (value, scratch + rv);
+    plcrash_async_file_write(file, scratch, rv);
+    return rv;
+}
+
+/**
+ * Write a uint32 field. This is equivalent to calling plcrash_writer_pack() with PLPROTOBUF_C_TYPE_UINT32, but avoids
+ * dispatching on the field type.
+ *
+ * @param file The output file. If NULL, only the size of the field will be computed.
+ * @param field_id The field identifier.
+ * @param value The field value.
+ *
+ * @return Returns the number of bytes written (or that would be written) for the field.
+ */
+size_t plcrash_writer_pack_uint32 (plcrash_async_file_t *file, uint32_t field_id, uint32_t value) {
+    size_t rv;
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE * 2];
+
+    if (file == NULL)
+        return tag_size (field_id) + uint32_size (value);
+
+    rv = tag_pack (field_id, PLPROTOBUF_C_WIRE_TYPE_VARINT, scratch);
+    rv += uint32_pack (value, scratch + rv);
+    plcrash_async_file_write(file, scratch, rv);
+    return rv;
+}
+
+/**
+ * Write a string field of a known length. This is equivalent to calling plcrash_writer_pack() with
+ * PLPROTOBUF_C_TYPE_STRING, but avoids dispatching on the field type, and does not require the string to be
+ * measured on each call.
+ *
+ * @param file The output file. If NULL, only the size of the field will be computed.
+ * @param field_id The field identifier.
+ * @param value The string value. Need not be NUL-terminated.
+ * @param length The length of @a value, in bytes.
+ *
+ * @return Returns the number of bytes written (or that would be written) for the field.
+ */
+size_t plcrash_writer_pack_string (plcrash_async_file_t *file, uint32_t field_id, const char *value, size_t length) {
+    size_t rv;
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE * 2];
+
+    if (file == NULL)
+        return tag_size (field_id) + uint32_size ((uint32_t) length) + length;
+
+    rv = tag_pack (field_id, PLPROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED, scratch);
+    rv += uint32_pack ((uint32_t) length, scratch + rv);
+    plcrash_async_file_write(file, scratch, rv);
+    plcrash_async_file_write(file, value, length);
+    return rv + length;
+}
+
+/**
+ * Write a message field header with a reserved, fixed-width length prefix. Once the message contents have been
+ * written, plcrash_writer_pack_end_message() must be called to back-patch the actual message length.
+ *
+ * @param file The output file. If NULL, only the size of the header will be computed.
+ * @param field_id The message's field identifier.
+ * @param slot On return, the reserved length slot to be passed to plcrash_writer_pack_end_message(). Ignored if
+ * @a file is NULL.
+ *
+ * @return Returns the number of bytes written (or that would be written) for the header. The returned value does not
+ * depend on the eventual message size, and may be used when computing sizes in advance.
+ */
+size_t plcrash_writer_pack_begin_message (plcrash_async_file_t *file, uint32_t field_id, plcrash_writer_msg_slot_t *slot) {
+    size_t rv;
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE + PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE];
+
+    rv = tag_pack (field_id, PLPROTOBUF_C_WIRE_TYPE_LENGTH_PREFIXED, scratch);
+    rv += padded_uint32_pack (0, scratch + rv);
+
+    if (file != NULL) {
+        slot->length_offset = plcrash_async_file_tell(file) + (rv - PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE);
+        slot->valid = plcrash_async_file_write(file, scratch, rv);
+    }
+
+    return rv;
+}
+
+/**
+ * Back-patch the length prefix reserved by plcrash_writer_pack_begin_message(), using the number of bytes
+ * written to @a file since the prefix was reserved.
+ *
+ * @param file The output file. If NULL, no action is performed.
+ * @param slot The slot initialized by plcrash_writer_pack_begin_message().
+ *
+ * @return Returns true on success, or false if the length prefix could not be written.
+ */
+bool plcrash_writer_pack_end_message (plcrash_async_file_t *file, plcrash_writer_msg_slot_t *slot) {
+    uint8_t scratch[PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE];
+
+    if (file == NULL)
+        return true;
+
+    if (!slot->valid)
+        return false;
+
+    off_t msgsize = plcrash_async_file_tell(file) - (slot->length_offset + PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE);
+    if (msgsize < 0 || msgsize > UINT32_MAX) {
+        PLCF_DEBUG("Message size %" PRId64 " can not be represented in the reserved length prefix", (int64_t) msgsize);
+        return false;
+    }
+
+    padded_uint32_pack ((uint32_t) msgsize, scratch);
+    return plcrash_async_file_pwrite(file, slot->length_offset, scratch, sizeof(scratch));
+}
+
+/**
+ * Write a fixed64 field with a reserved value of 0. The actual value may be supplied later via
+ * plcrash_writer_pack_patch_fixed64().
+ *
+ * @param file The output file. If NULL, only the size of the field will be computed.
+ * @param field_id The field identifier.
+ * @param slot On return, the reserved value slot to be passed to plcrash_writer_pack_patch_fixed64(). Ignored if
+ * @a file is NULL.
+ *
+ * @return Returns the number of bytes written (or that would be written) for the field. The returned value does not
+ * depend on the eventual field value.
+ */
+size_t plcrash_writer_pack_reserve_fixed64 (plcrash_async_file_t *file, uint32_t field_id, plcrash_writer_fixed64_slot_t *slot) {
+    size_t rv;
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE + 8];
+
+    rv = tag_pack (field_id, PLPROTOBUF_C_WIRE_TYPE_64BIT, scratch);
+    rv += fixed64_pack (0, scratch + rv);
+
+    if (file != NULL) {
+        slot->value_offset = plcrash_async_file_tell(file) + (rv - 8);
+        slot->valid = plcrash_async_file_write(file, scratch, rv);
+    }
+
+    return rv;
+}
+
+/**
+ * Back-patch the value reserved by plcrash_writer_pack_reserve_fixed64().
+ *
+ * @param file The output file. If NULL, no action is performed.
+ * @param slot The slot initialized by plcrash_writer_pack_reserve_fixed64().
+ * @param value The field value.
+ *
+ * @return Returns true on success, or false if the value could not be written.
+ */
+bool plcrash_writer_pack_patch_fixed64 (plcrash_async_file_t *file, plcrash_writer_fixed64_slot_t *slot, uint64_t value) {
+    uint8_t scratch[8];
+
+    if (file == NULL)
+        return true;
+
+    if (!slot->valid)
+        return false;
+
+    fixed64_pack (value, scratch);
+    return plcrash_async_file_pwrite(file, slot->value_offset, scratch, sizeof(scratch));
+}
+
+/**
+ * Write a bool field with a reserved value of false. The actual value may be supplied later via
+ * plcrash_writer_pack_patch_bool().
+ *
+ * @param file The output file. If NULL, only the size of the field will be computed.
+ * @param field_id The field identifier.
+ * @param slot On return, the reserved value slot to be passed to plcrash_writer_pack_patch_bool(). Ignored if
+ * @a file is NULL.
+ *
+ * @return Returns the number of bytes written (or that would be written) for the field. The returned value does not
+ * depend on the eventual field value.
+ */
+size_t plcrash_writer_pack_reserve_bool (plcrash_async_file_t *file, uint32_t field_id, plcrash_writer_bool_slot_t *slot) {
+    size_t rv;
+    uint8_t scratch[MAX_UINT64_ENCODED_SIZE + 1];
+
+    /* A bool is encoded as a single-byte varint, regardless of its value */
+    rv = tag_pack (field_id, PLPROTOBUF_C_WIRE_TYPE_VARINT, scratch);
+    scratch[rv++] = 0;
+
+    if (file != NULL) {
+        slot->value_offset = plcrash_async_file_tell(file) + (rv - 1);
+        slot->valid = plcrash_async_file_write(file, scratch, rv);
+    }
+
+    return rv;
+}
+
+/**
+ * Back-patch the value reserved by plcrash_writer_pack_reserve_bool().
+ *
+ * @param file The output file. If NULL, no action is performed.
+ * @param slot The slot initialized by plcrash_writer_pack_reserve_bool().
+ * @param value The field value.
+ *
+ * @return Returns true on success, or false if the value could not be written.
+ */
+bool plcrash_writer_pack_patch_bool (plcrash_async_file_t *file, plcrash_writer_bool_slot_t *slot, bool value) {
+    uint8_t scratch = value ? 1 : 0;
+
+    if (file == NULL)
+        return true;
+
+    if (!slot->valid)
+        return false;
+
+    return plcrash_async_file_pwrite(file, slot->value_offset, &scratch, sizeof(scratch));
+}
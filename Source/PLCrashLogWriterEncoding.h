@@ -49,7 +49,70 @@ typedef struct PLProtobufCBinaryData {
     void *data;
 } PLProtobufCBinaryData;
 
+/**
+ * @internal
+ *
+ * The number of bytes reserved for a back-patched message length prefix. This is the maximum encoded size of a 32-bit
+ * varint; shorter lengths are written using a padded (non-canonical, but valid) encoding.
+ */
+#define PLCRASH_WRITER_MSG_LENGTH_SLOT_SIZE 5
+
+/**
+ * @internal
+ *
+ * A reserved message length prefix. Used to write a message in a single pass, when determining the message size in
+ * advance would require the (potentially expensive) message contents to be generated twice.
+ */
+typedef struct plcrash_writer_msg_slot {
+    /** The output position of the reserved length prefix. */
+    off_t length_offset;
+
+    /** If false, the reserved prefix could not be written, and the slot must not be patched. */
+    bool valid;
+} plcrash_writer_msg_slot_t;
+
+/**
+ * @internal
+ *
+ * A reserved fixed64 field value. Used to write values -- such as crash-time metrics -- that are not known until
+ * after the data following them has been written.
+ */
+typedef struct plcrash_writer_fixed64_slot {
+    /** The output position of the reserved 8-byte value. */
+    off_t value_offset;
+
+    /** If false, the reserved value could not be written, and the slot must not be patched. */
+    bool valid;
+} plcrash_writer_fixed64_slot_t;
+
+/**
+ * @internal
+ *
+ * A reserved bool field value. Used to write flags -- such as report truncation -- that are not known until after the
+ * data following them has been written.
+ */
+typedef struct plcrash_writer_bool_slot {
+    /** The output position of the reserved 1-byte value. */
+    off_t value_offset;
+
+    /** If false, the reserved value could not be written, and the slot must not be patched. */
+    bool valid;
+} plcrash_writer_bool_slot_t;
+
 size_t plcrash_writer_pack (plcrash_async_file_t *file, uint32_t field_id, PLProtobufCType field_type, const void *value);
+
+size_t plcrash_writer_pack_uint64 (plcrash_async_file_t *file, uint32_t field_id, uint64_t value);
+size_t plcrash_writer_pack_uint32 (plcrash_async_file_t *file, uint32_t field_id, uint32_t value);
+size_t plcrash_writer_pack_string (plcrash_async_file_t *file, uint32_t field_id, const char *value, size_t length);
+
+size_t plcrash_writer_pack_begin_message (plcrash_async_file_t *file, uint32_t field_id, plcrash_writer_msg_slot_t *slot);
+bool plcrash_writer_pack_end_message (plcrash_async_file_t *file, plcrash_writer_msg_slot_t *slot);
+
+size_t plcrash_writer_pack_reserve_fixed64 (plcrash_async_file_t *file, uint32_t field_id, plcrash_writer_fixed64_slot_t *slot);
+bool plcrash_writer_pack_patch_fixed64 (plcrash_async_file_t *file, plcrash_writer_fixed64_slot_t *slot, uint64_t value);
+
+size_t plcrash_writer_pack_reserve_bool (plcrash_async_file_t *file, uint32_t field_id, plcrash_writer_bool_slot_t *slot);
+bool plcrash_writer_pack_patch_bool (plcrash_async_file_t *file, plcrash_writer_bool_slot_t *slot, bool value);
     
 #ifdef __cplusplus
 }
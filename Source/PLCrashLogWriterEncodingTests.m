@@ -153,4 +153,167 @@ TEST_PACK(EncoderTest__Enum, enum_, enum, ENCODER_TEST__ENUM__Value2, 14, PLPROT
     STAssertTrue(strcmp(et->string, str) == 0, @"Did not encode correct value");
 }
 
+/* Verify the type-specialized packers against the generic encoder, at each varint length boundary */
+- (void) testPackSpecialized {
+    for (uint32_t bits = 0; bits <= 64; bits++) {
+        uint64_t u64 = (bits == 0) ? 0 : (UINT64_MAX >> (64 - bits));
+        uint32_t u32 = (uint32_t) u64;
+
+        STAssertEquals(plcrash_writer_pack_uint64(NULL, 7, u64), plcrash_writer_pack(NULL, 7, PLPROTOBUF_C_TYPE_UINT64, &u64), @"Incorrect uint64 size for %u bits", bits);
+        STAssertEquals(plcrash_writer_pack_uint32(NULL, 2, u32), plcrash_writer_pack(NULL, 2, PLPROTOBUF_C_TYPE_UINT32, &u32), @"Incorrect uint32 size for %u bits", bits);
+    }
+
+    /* The string need not be NUL terminated */
+    const char *str = "cafebabe";
+    size_t rv = 0;
+    rv += plcrash_writer_pack_uint64(&_file, 7, UINT64_MAX);
+    rv += plcrash_writer_pack_uint32(&_file, 2, 300);
+    rv += plcrash_writer_pack_string(&_file, 16, str, 4);
+    STAssertEquals(rv, plcrash_writer_pack_uint64(NULL, 7, UINT64_MAX) + plcrash_writer_pack_uint32(NULL, 2, 300) + plcrash_writer_pack_string(NULL, 16, str, 4), @"Written size does not match computed size");
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    STAssertEquals([data length], rv, @"Incorrect file length");
+
+    EncoderTest *et = encoder_test__unpack(&protobuf_c_system_allocator, [data length], [data bytes]);
+    STAssertNotNULL(et, @"Failed to decode test data");
+    if (et == NULL)
+        return;
+
+    STAssertTrue(et->has_uint64, @"uint64 not encoded");
+    STAssertEquals(et->uint64, (uint64_t) UINT64_MAX, @"Incorrect uint64 value");
+    STAssertTrue(et->has_uint32, @"uint32 not encoded");
+    STAssertEquals(et->uint32, (uint32_t) 300, @"Incorrect uint32 value");
+    STAssertNotNULL(et->string, @"string not encoded");
+    STAssertTrue(strcmp(et->string, "cafe") == 0, @"Incorrect string value");
+
+    encoder_test__free_unpacked(et, &protobuf_c_system_allocator);
+}
+
+/* Verify tag encoding across the single byte, double byte, and general varint tag boundaries */
+- (void) testPackTag {
+    struct {
+        uint32_t field_id;
+        uint8_t bytes[4];
+        size_t length;
+    } cases[] = {
+        { 1,        { 0x08 },                   1 },
+        { 15,       { 0x78 },                   1 },
+        { 16,       { 0x80, 0x01 },             2 },
+        { 2047,     { 0xF8, 0x7F },             2 },
+        { 2048,     { 0x80, 0x80, 0x01 },       3 },
+    };
+
+    off_t offset = 0;
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        /* Field value of 1 is encoded as a single byte following the tag */
+        size_t rv = plcrash_writer_pack_uint32(&_file, cases[i].field_id, 1);
+        STAssertEquals(rv, cases[i].length + 1, @"Incorrect size for field %u", cases[i].field_id);
+        STAssertEquals(plcrash_writer_pack_uint32(NULL, cases[i].field_id, 1), rv, @"Incorrect computed size for field %u", cases[i].field_id);
+    }
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    const uint8_t *bytes = [data bytes];
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        STAssertTrue(offset + cases[i].length + 1 <= [data length], @"Output truncated");
+        if (offset + cases[i].length + 1 > [data length])
+            return;
+
+        STAssertTrue(memcmp(bytes + offset, cases[i].bytes, cases[i].length) == 0, @"Incorrect tag for field %u", cases[i].field_id);
+        STAssertEquals(bytes[offset + cases[i].length], (uint8_t) 1, @"Incorrect value for field %u", cases[i].field_id);
+        offset += cases[i].length + 1;
+    }
+}
+
+/* Verify that a single-pass message with a back-patched length prefix is decodable */
+- (void) testPackBackPatchedMessage {
+    plcrash_writer_msg_slot_t slot;
+    const char *str = "cafe";
+    uint32_t uint32 = 42;
+    size_t size = 0;
+
+    /* The header size must not depend on the message contents */
+    STAssertEquals(plcrash_writer_pack_begin_message(NULL, 17, &slot), plcrash_writer_pack_begin_message(&_file, 17, &slot), @"Header size mismatch");
+    size += plcrash_writer_pack(&_file, 16, PLPROTOBUF_C_TYPE_STRING, str);
+    size += plcrash_writer_pack(&_file, 2, PLPROTOBUF_C_TYPE_UINT32, &uint32);
+    STAssertTrue(plcrash_writer_pack_end_message(&_file, &slot), @"Failed to patch message length");
+
+    /* Follow the message with an additional field, to verify that the length excludes trailing data */
+    plcrash_writer_pack(&_file, 2, PLPROTOBUF_C_TYPE_UINT32, &uint32);
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    STAssertNotNil(data, @"Failed to load encoded data");
+    if (data == nil)
+        return;
+
+    EncoderTest *et = encoder_test__unpack(&protobuf_c_system_allocator, [data length], [data bytes]);
+    STAssertNotNULL(et, @"Failed to decode test data");
+    if (et == NULL)
+        return;
+
+    STAssertNotNULL(et->message, @"Did not encode nested message");
+    if (et->message == NULL)
+        return;
+
+    STAssertTrue(strcmp(et->message->string, str) == 0, @"Did not encode correct value");
+    STAssertTrue(et->message->has_uint32, @"Did not encode correct type");
+    STAssertEquals(et->message->uint32, uint32, @"Did not encode correct value");
+    STAssertTrue(et->has_uint32, @"Trailing field was included in the message");
+}
+
+/* Verify that a reserved fixed64 value may be back-patched after additional data is written */
+- (void) testPackBackPatchedFixed64 {
+    plcrash_writer_fixed64_slot_t slot;
+    const char *str = "cafe";
+    uint64_t value = 0xCAFEF00DDEADBEEFULL;
+
+    /* The field size must not depend on the eventual value */
+    STAssertEquals(plcrash_writer_pack_reserve_fixed64(NULL, 9, &slot), plcrash_writer_pack_reserve_fixed64(&_file, 9, &slot), @"Field size mismatch");
+    plcrash_writer_pack(&_file, 16, PLPROTOBUF_C_TYPE_STRING, str);
+    STAssertTrue(plcrash_writer_pack_patch_fixed64(&_file, &slot, value), @"Failed to patch value");
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    STAssertNotNil(data, @"Failed to load encoded data");
+    if (data == nil)
+        return;
+
+    EncoderTest *et = encoder_test__unpack(&protobuf_c_system_allocator, [data length], [data bytes]);
+    STAssertNotNULL(et, @"Failed to decode test data");
+    if (et == NULL)
+        return;
+
+    STAssertTrue(et->has_fixed64, @"Did not encode correct type");
+    STAssertEquals(et->fixed64, value, @"Did not encode correct value");
+    STAssertTrue(strcmp(et->string, str) == 0, @"Did not encode correct value");
+}
+
+/* Verify that a reserved bool value may be back-patched after additional data is written */
+- (void) testPackBackPatchedBool {
+    plcrash_writer_bool_slot_t slot;
+    const char *str = "cafe";
+
+    /* The field size must not depend on the eventual value */
+    STAssertEquals(plcrash_writer_pack_reserve_bool(NULL, 13, &slot), plcrash_writer_pack_reserve_bool(&_file, 13, &slot), @"Field size mismatch");
+    plcrash_writer_pack(&_file, 16, PLPROTOBUF_C_TYPE_STRING, str);
+    STAssertTrue(plcrash_writer_pack_patch_bool(&_file, &slot, true), @"Failed to patch value");
+    STAssertTrue(plcrash_async_file_flush(&_file), @"Failed to flush file");
+
+    NSData *data = [NSData dataWithContentsOfFile: _filePath];
+    STAssertNotNil(data, @"Failed to load encoded data");
+    if (data == nil)
+        return;
+
+    EncoderTest *et = encoder_test__unpack(&protobuf_c_system_allocator, [data length], [data bytes]);
+    STAssertNotNULL(et, @"Failed to decode test data");
+    if (et == NULL)
+        return;
+
+    STAssertTrue(et->has_bool_, @"Did not encode correct type");
+    STAssertTrue(et->bool_, @"Did not encode correct value");
+    STAssertTrue(strcmp(et->string, str) == 0, @"Did not encode correct value");
+}
+
 @end
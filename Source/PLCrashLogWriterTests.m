@@ -32,6 +32,9 @@
 #import "PLCrashFrameWalker.h"
 #import "PLCrashAsyncImageList.h"
 #import "PLCrashReport.h"
+#import "PLCrashReportReader.h"
+#import "PLCrashReportTextFormatter.h"
+#import "PLCrashAsyncSharedCache.h"
 
 #import <sys/stat.h>
 #import <sys/mman.h>
@@ -364,6 +367,37 @@
             CFRelease(uuid);
     }
 
+    /* Verify the crash-time metrics */
+    STAssertNotNULL(crashReport->report_info->metrics, @"Report missing crash-time metrics");
+    if (crashReport->report_info->metrics != NULL) {
+        Plcrash__CrashReport__ReportInfo__Metrics *metrics = crashReport->report_info->metrics;
+
+        STAssertTrue(metrics->total_time > 0, @"Total time was not recorded");
+        STAssertTrue(metrics->total_time >= metrics->binary_images_time, @"Phase time exceeds the total time");
+        STAssertTrue(metrics->thread_count > 0, @"Thread count was not recorded");
+        STAssertEquals(metrics->thread_count, (uint64_t) crashReport->n_threads, @"Incorrect thread count");
+        STAssertTrue(metrics->bytes_written > 0, @"Output size was not recorded");
+
+        uint64_t frames = metrics->compact_unwind_frames + metrics->dwarf_unwind_frames + metrics->frame_pointer_frames + metrics->stack_scan_frames;
+        STAssertTrue(frames > 0, @"No frames were attributed to a frame reader");
+    }
+
+    /* Verify the per-frame unwind methods; the first frame of each walked thread is derived from its thread state */
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thread = crashReport->threads[i];
+        for (size_t j = 0; j < thread->n_frames; j++) {
+            Plcrash__CrashReport__Thread__StackFrame *frame = thread->frames[j];
+            STAssertTrue(frame->has_unwind_method, @"Frame %zu of thread %zu is missing its unwind method", j, i);
+            if (j == 0) {
+                STAssertEquals(frame->unwind_method, PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__UNWIND_METHOD__UNWIND_THREAD_STATE,
+                               @"The first frame was not derived from the thread state");
+            } else {
+                STAssertTrue(frame->unwind_method >= PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__UNWIND_METHOD__UNWIND_COMPACT,
+                             @"Frame %zu of thread %zu was not attributed to a frame reader", j, i);
+            }
+        }
+    }
+
     /* Test the report */
     [self checkSystemInfo: crashReport];
     [self checkAppInfo: crashReport];
@@ -387,11 +421,13 @@
     /* Validate the 'crashed' flag is on a thread with the expected PC. */
     uint64_t expectedPC;
 #if __x86_64__
-    expectedPC = cursor.frame.thread_state.x86_state.thread.uts.ts64.__rip;
+    expectedPC = plframe_cursor_get_frame(&cursor)->thread_state.x86_state.thread.uts.ts64.__rip;
 #elif __i386__
-    expectedPC = cursor.frame.thread_state.x86_state.thread.uts.ts32.__eip;
+    expectedPC = plframe_cursor_get_frame(&cursor)->thread_state.x86_state.thread.uts.ts32.__eip;
+#elif __arm64__
+    expectedPC = plframe_cursor_get_frame(&cursor)->thread_state.arm_state.thread.ts_64.__pc;
 #elif __arm__
-    expectedPC = cursor.frame.thread_state.arm_state.thread.__pc;
+    expectedPC = plframe_cursor_get_frame(&cursor)->thread_state.arm_state.thread.ts_32.__pc;
 #else
 #error Unsupported Platform
 #endif
@@ -419,4 +455,1948 @@
     protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
 }
 
+/**
+ * Verify that reports written using a worker pool contain complete, correctly ordered thread data.
+ */
+- (void) testWriteReportWithWorkers {
+    plcrash_log_writer_t writer;
+    plcrash_log_writer_workers_t *workers;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer using a worker pool */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_workers_new(&workers, 3), @"Failed to create the worker pool");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_workers(&writer, workers);
+
+    /* Write the report, using the test thread as the crashed thread */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    /* Clean up the writer; the pool must outlive the writer */
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_log_writer_workers_free(workers);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Load and validate the written report */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Failed to load report");
+    if (crashReport == NULL)
+        return;
+
+    [self checkThreads: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that reports written using an async-safe worker pool contain complete thread data, and that the pool may
+ * be reused for subsequent reports.
+ */
+- (void) testWriteReportWithAsyncSafeWorkers {
+    plcrash_log_writer_workers_t *workers;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_workers_new_async_safe(&workers, 2, 256), @"Failed to create the worker pool");
+
+    for (int pass = 0; pass < 2; pass++) {
+        plcrash_log_writer_t writer;
+        plcrash_async_file_t file;
+
+        /* Open the output file */
+        unlink([_logPath UTF8String]);
+        int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+        plcrash_async_file_init(&file, fd, 0);
+
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+        plcrash_log_writer_set_workers(&writer, workers);
+
+        /* Write the report, using the test thread as the crashed thread */
+        plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+        plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+        thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+        plcrash_log_writer_close(&writer);
+        plcrash_log_writer_free(&writer);
+
+        plcrash_async_file_flush(&file);
+        plcrash_async_file_close(&file);
+
+        /* Load and validate the written report */
+        Plcrash__CrashReport *crashReport = [self loadReport];
+        STAssertNotNULL(crashReport, @"Failed to load report");
+        if (crashReport == NULL)
+            break;
+
+        [self checkThreads: crashReport];
+        protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+    }
+
+    plcrash_log_writer_workers_free(workers);
+    plcrash_nasync_image_list_free(&image_list);
+}
+
+/**
+ * Verify that reports may be written using caches allocated from a crash-time allocator, and that the allocator's
+ * budget is not consumed by writing reports.
+ */
+- (void) testWriteReportWithAllocator {
+    plcrash_log_writer_t writer;
+    plcrash_async_allocator_t *allocator;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer using a crash-time allocator */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_allocator_new(&allocator, 1024 * 1024, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage), @"Failed to create the allocator");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_allocator(&writer, allocator), @"Failed to move the writer caches");
+
+    /* Write the report, using the test thread as the crashed thread */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    /* Any scratch allocations must have been released */
+    plcrash_async_allocator_mark_t mark;
+    plcrash_async_allocator_mark(allocator, &mark);
+    STAssertEquals(mark.next_addr, writer.allocator_mark.next_addr, @"Report scratch memory was not released");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Load and validate the written report */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Failed to load report");
+    if (crashReport == NULL)
+        return;
+
+    [self checkThreads: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that compact reports may be written and decoded, and that their frames and image paths are resolved
+ * correctly.
+ */
+- (void) testWriteCompactReport {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    NSError *error;
+
+    /* Initialize the image list */
+    NSMutableSet *imageNames = [NSMutableSet set];
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++) {
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+        [imageNames addObject: [NSString stringWithUTF8String: _dyld_get_image_name(i)]];
+    }
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a compact writer */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ENOTSUP, plcrash_log_writer_set_file_version(&writer, 3), @"Unsupported version was accepted");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_file_version(&writer, PLCRASH_REPORT_FILE_VERSION_COMPACT), @"Failed to set the file version");
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the header and encoding */
+    NSData *data = [NSData dataWithContentsOfFile: _logPath];
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    STAssertEquals(header->version, (uint8_t) PLCRASH_REPORT_FILE_VERSION_COMPACT, @"Incorrect file version");
+
+    Plcrash__CrashReport *crashReport = plcrash__crash_report__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->n_strings > 0, @"No directories were written to the string table");
+    STAssertTrue(crashReport->n_strings < crashReport->n_binary_images, @"Image directories were not deduplicated");
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        for (size_t j = 0; j < crashReport->threads[i]->n_frames; j++)
+            STAssertFalse(crashReport->threads[i]->frames[j]->has_pc && crashReport->threads[i]->frames[j]->has_image_index, @"Frame has both a PC and image index");
+
+        /* Registers must be written as a typed register state */
+        if (crashReport->threads[i]->crashed) {
+            STAssertNotNULL(crashReport->threads[i]->register_state, @"The crashed thread's register state was not written");
+            STAssertEquals(crashReport->threads[i]->n_registers, (size_t) 0, @"Named registers were written to a compact report");
+
+            /* Register values within an image must be annotated with that image; at minimum, the PC is within an image */
+            Plcrash__CrashReport__Thread__RegisterState *state = crashReport->threads[i]->register_state;
+            if (state == NULL)
+                continue;
+
+            STAssertTrue(state->n_annotations > 0, @"No register of the crashed thread was annotated with its image");
+            for (size_t j = 0; j < state->n_annotations; j++) {
+                Plcrash__CrashReport__Thread__RegisterState__Annotation *annotation = state->annotations[j];
+                STAssertTrue(annotation->image_index < crashReport->n_binary_images, @"Register %u image index out of range", annotation->register_number);
+                if (annotation->image_index >= crashReport->n_binary_images || !annotation->has_symbol_start)
+                    continue;
+
+                Plcrash__CrashReport__BinaryImage *image = crashReport->binary_images[annotation->image_index];
+                STAssertTrue(annotation->symbol_start >= image->base_address && annotation->symbol_start - image->base_address < image->size,
+                             @"Register %u symbol start is not within its annotated image", annotation->register_number);
+            }
+        }
+    }
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    /* Decode the report, and verify that the image paths and frames were reconstructed */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode compact report: %@", error);
+
+    STAssertEquals([[report images] count], [imageNames count], @"Incorrect image count");
+    for (PLCrashReportBinaryImageInfo *image in [report images])
+        STAssertTrue([imageNames containsObject: [image imageName]], @"Unexpected image path %@", [image imageName]);
+
+    for (PLCrashReportThreadInfo *threadInfo in [report threads]) {
+        /* The typed register state must be decoded to named registers */
+        if ([threadInfo crashed]) {
+            NSMutableSet *names = [NSMutableSet set];
+            BOOL annotated = NO;
+            for (PLCrashReportRegisterInfo *reg in [threadInfo registers]) {
+                [names addObject: [reg registerName]];
+
+                /* Annotations must be matched to their register */
+                if ([reg hasImageIndex]) {
+                    annotated = YES;
+                    STAssertTrue([reg imageIndex] < [[report images] count], @"Register %@ image index out of range", [reg registerName]);
+                }
+            }
+            STAssertTrue(annotated, @"No register annotations were decoded");
+
+            STAssertTrue([names count] > 3, @"The crashed thread's registers were not decoded");
+            STAssertTrue([names containsObject: @"pc"] || [names containsObject: @"rip"] || [names containsObject: @"eip"], @"Missing instruction pointer register");
+        }
+
+        for (PLCrashReportStackFrameInfo *frame in [threadInfo stackFrames]) {
+            if ([frame instructionPointer] == 0)
+                continue;
+
+            /* Compact frames must resolve to an address within their image */
+            PLCrashReportBinaryImageInfo *image = [report imageForAddress: [frame instructionPointer]];
+            if (image != nil)
+                STAssertTrue([frame instructionPointer] - [image imageBaseAddress] < [image imageSize], @"Frame PC outside of its image");
+        }
+    }
+}
+
+/**
+ * Verify that identical thread backtraces are written once in compact reports, and expanded on decode.
+ */
+- (void) testWriteCompactReportDeduplicatesStacks {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    plcrash_test_thread_t idle[2];
+    NSError *error;
+
+    /* Spawn additional threads with backtraces identical to that of the test thread */
+    for (size_t i = 0; i < sizeof(idle) / sizeof(idle[0]); i++)
+        plcrash_test_thread_spawn(&idle[i]);
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a compact writer */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_file_version(&writer, PLCRASH_REPORT_FILE_VERSION_COMPACT), @"Failed to set the file version");
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    for (size_t i = 0; i < sizeof(idle) / sizeof(idle[0]); i++)
+        plcrash_test_thread_stop(&idle[i]);
+
+    /* Verify that the duplicate backtraces were written by reference to an earlier thread */
+    NSData *data = [NSData dataWithContentsOfFile: _logPath];
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    Plcrash__CrashReport *crashReport = plcrash__crash_report__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    NSMutableDictionary *references = [NSMutableDictionary dictionary];
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thr = crashReport->threads[i];
+        if (!thr->has_duplicate_of_thread)
+            continue;
+
+        STAssertFalse(thr->crashed, @"The crashed thread was written by reference");
+        STAssertEquals(thr->n_frames, (size_t) 0, @"Frames were written for a duplicate thread");
+        [references setObject: [NSNumber numberWithUnsignedInt: thr->duplicate_of_thread] forKey: [NSNumber numberWithUnsignedInt: thr->thread_number]];
+    }
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    STAssertTrue([references count] >= 2, @"Identical backtraces were not deduplicated");
+
+    /* Decode the report, and verify that the referenced frames were expanded */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode compact report: %@", error);
+
+    NSMutableDictionary *threadsByNumber = [NSMutableDictionary dictionary];
+    for (PLCrashReportThreadInfo *threadInfo in [report threads])
+        [threadsByNumber setObject: threadInfo forKey: [NSNumber numberWithInteger: [threadInfo threadNumber]]];
+
+    for (NSNumber *number in references) {
+        PLCrashReportThreadInfo *duplicate = [threadsByNumber objectForKey: number];
+        PLCrashReportThreadInfo *original = [threadsByNumber objectForKey: [references objectForKey: number]];
+        STAssertNotNil(original, @"Missing referenced thread");
+        STAssertTrue([[duplicate stackFrames] count] > 0, @"Duplicate thread frames were not expanded");
+        STAssertEqualObjects([duplicate stackFrames], [original stackFrames], @"Duplicate thread frames do not match the referenced thread");
+    }
+}
+
+/**
+ * Verify that shared cache images are omitted when PLCRASH_LOG_WRITER_IMAGES_ELIDE_SHARED_CACHE is set.
+ */
+- (void) testWriteReportElidingSharedCache {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    plcrash_async_shared_cache_t shared_cache;
+
+    /* The shared cache may not be available on older releases */
+    if (plcrash_async_shared_cache_init(&shared_cache, mach_task_self()) != PLCRASH_ESUCCESS)
+        return;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_image_options(&writer, PLCRASH_LOG_WRITER_IMAGES_ELIDE_SHARED_CACHE), @"Failed to set the image options");
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the shared cache and images */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertNotNULL(crashReport->shared_cache, @"No shared cache was written");
+    if (crashReport->shared_cache != NULL) {
+        STAssertEquals(crashReport->shared_cache->uuid.len, sizeof(shared_cache.uuid), @"Incorrect UUID length");
+        STAssertTrue(memcmp(crashReport->shared_cache->uuid.data, shared_cache.uuid, sizeof(shared_cache.uuid)) == 0, @"Incorrect UUID");
+        STAssertEquals(crashReport->shared_cache->slide, (int64_t) shared_cache.slide, @"Incorrect slide");
+    }
+
+    STAssertTrue(crashReport->n_binary_images > 0, @"No images were written");
+    STAssertTrue(crashReport->n_binary_images < _dyld_image_count(), @"No shared cache images were omitted");
+    for (size_t i = 0; i < crashReport->n_binary_images; i++) {
+        uint64_t base = crashReport->binary_images[i]->base_address;
+        STAssertFalse(base >= shared_cache.base_address && base - shared_cache.base_address < shared_cache.size, @"Shared cache image was written");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that only referenced images are written when PLCRASH_LOG_WRITER_IMAGES_REFERENCED_ONLY is set.
+ */
+- (void) testWriteReportReferencedImagesOnly {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_image_options(&writer, PLCRASH_LOG_WRITER_IMAGES_REFERENCED_ONLY), @"Failed to set the image options");
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the images */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->n_binary_images > 0, @"No images were written");
+    STAssertTrue(crashReport->n_binary_images < _dyld_image_count(), @"Unreferenced images were written");
+
+    /* Every frame within a loaded image must reference a written image */
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        for (size_t j = 0; j < crashReport->threads[i]->n_frames; j++) {
+            uint64_t pc = crashReport->threads[i]->frames[j]->pc;
+            Dl_info dlinfo;
+            if (pc == 0 || dladdr((void *) (uintptr_t) pc, &dlinfo) == 0)
+                continue;
+
+            bool found = false;
+            for (size_t k = 0; k < crashReport->n_binary_images && !found; k++)
+                found = (crashReport->binary_images[k]->base_address == (uint64_t) (uintptr_t) dlinfo.dli_fbase);
+            STAssertTrue(found, @"Image %s referenced by frame 0x%llx was not written", dlinfo.dli_fname, (unsigned long long) pc);
+        }
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that the crashed thread is written first, retaining its task_threads() thread number, and that the frame
+ * limit is applied to all other threads.
+ */
+- (void) testWriteReportCrashedThreadFirst {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer */
+    plcrash_log_writer_capture_policy_t policy = {
+        .thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_CRASHED_FIRST,
+        .max_thread_frames = 1,
+        .time_budget = 0,
+        .size_budget = 0
+    };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_capture_policy(&writer, &policy);
+
+    /* Write the report; the test thread was spawned after the main thread, and is not the first thread */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the thread order */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->n_threads > 1, @"Expected multiple threads");
+    STAssertTrue(crashReport->threads[0]->crashed, @"The crashed thread was not written first");
+    STAssertTrue(crashReport->threads[0]->thread_number > 0, @"The crashed thread was renumbered");
+    STAssertTrue(crashReport->threads[0]->n_frames > 1, @"The frame limit was applied to the crashed thread");
+
+    for (size_t i = 1; i < crashReport->n_threads; i++) {
+        STAssertFalse(crashReport->threads[i]->crashed, @"Multiple crashed threads");
+        STAssertTrue(crashReport->threads[i]->n_frames <= 1, @"The frame limit was not applied");
+        for (size_t j = 0; j < i; j++)
+            STAssertTrue(crashReport->threads[i]->thread_number != crashReport->threads[j]->thread_number, @"Duplicate thread number");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that threads other than the crashed thread are omitted once the capture size budget is exhausted.
+ */
+- (void) testWriteReportSizeBudget {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer with a budget that is exhausted by the report header */
+    plcrash_log_writer_capture_policy_t policy = {
+        .thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_KERNEL,
+        .max_thread_frames = 0,
+        .time_budget = 0,
+        .size_budget = 1
+    };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_capture_policy(&writer, &policy);
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Only the crashed thread should have been written */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertEquals(crashReport->n_threads, (size_t) 1, @"Threads were not omitted");
+    if (crashReport->n_threads == 1)
+        STAssertTrue(crashReport->threads[0]->crashed, @"The crashed thread was omitted");
+
+    STAssertNotNULL(crashReport->report_info->metrics, @"Report missing crash-time metrics");
+    if (crashReport->report_info->metrics != NULL) {
+        STAssertTrue(crashReport->report_info->metrics->has_omitted_thread_count, @"Omitted thread count was not recorded");
+        STAssertTrue(crashReport->report_info->metrics->omitted_thread_count > 0, @"Omitted thread count was not recorded");
+    }
+    STAssertTrue(crashReport->report_info->has_truncated && crashReport->report_info->truncated, @"Report was not marked as truncated");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that once the report deadline has passed, symbolication is skipped and threads other than the crashed
+ * thread are omitted, while still producing a valid report.
+ */
+- (void) testWriteReportTimeBudget {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer with a deadline that will have passed before any thread is captured */
+    plcrash_log_writer_capture_policy_t policy = {
+        .thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_CRASHED_FIRST,
+        .max_thread_frames = 0,
+        .time_budget = 1,
+        .size_budget = 0
+    };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_capture_policy(&writer, &policy);
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* The crashed thread should have been walked in full, without symbolication */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->report_info->has_truncated && crashReport->report_info->truncated, @"Report was not marked as truncated");
+    STAssertEquals(crashReport->n_threads, (size_t) 1, @"Threads were not omitted");
+    if (crashReport->n_threads == 1) {
+        Plcrash__CrashReport__Thread *crashed = crashReport->threads[0];
+        STAssertTrue(crashed->crashed, @"The crashed thread was omitted");
+        STAssertTrue(crashed->n_frames > 1, @"The crashed thread's stack was truncated");
+        for (size_t i = 0; i < crashed->n_frames; i++)
+            STAssertNULL(crashed->frames[i]->symbol, @"Frame %zu was symbolicated after the deadline", i);
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that thread stacks are walked from snapshots, with all threads resumed before the stacks are walked.
+ */
+- (void) testWriteReportSnapshotThreads {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_snapshot_threads(&writer, true);
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* The test thread must have been resumed */
+    struct thread_basic_info basic_info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    STAssertEquals(thread_info(thread, THREAD_BASIC_INFO, (thread_info_t) &basic_info, &count), KERN_SUCCESS, @"Could not fetch thread info");
+    STAssertEquals(basic_info.suspend_count, 0, @"Test thread was not resumed");
+
+    /* The crashed thread's stack should have been walked from its snapshot */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    bool found_crashed = false;
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *t = crashReport->threads[i];
+        if (!t->crashed)
+            continue;
+
+        found_crashed = true;
+        STAssertTrue(t->n_frames > 1, @"The crashed thread's stack was not walked");
+        STAssertTrue(t->n_registers > 0, @"The crashed thread's registers were not written");
+    }
+    STAssertTrue(found_crashed, @"The crashed thread was not written");
+    STAssertTrue(crashReport->report_info->metrics->has_suspended_time, @"Suspended time was not recorded");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Write a report of the current task using @a writer, replacing any existing report at the log path.
+ */
+- (Plcrash__CrashReport *) writeReportWithWriter: (plcrash_log_writer_t *) writer imageList: (plcrash_async_image_list_t *) image_list {
+    plcrash_async_file_t file;
+
+    unlink([_logPath UTF8String]);
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(writer, thread, image_list, &file, &info, NULL), @"Crash log failed");
+    plcrash_log_writer_close(writer);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    return [self loadReport];
+}
+
+/**
+ * Verify that the frames of threads that have not moved since the previous report are reused from the unwind cache.
+ */
+- (void) testWriteReportUnwindCache {
+    plcrash_log_writer_t writer;
+    plcrash_async_image_list_t image_list;
+    plcrash_test_thread_t blocked;
+
+    /* A second thread that remains blocked across both reports; the crashed thread is always walked in full */
+    plcrash_test_thread_spawn(&blocked);
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_unwind_cache(&writer, true), @"Could not enable the unwind cache");
+
+    /* Nothing is cached by the first report */
+    Plcrash__CrashReport *first = [self writeReportWithWriter: &writer imageList: &image_list];
+    STAssertNotNULL(first, @"Could not decode crash report");
+
+    plcrash_log_writer_reset(&writer);
+    Plcrash__CrashReport *second = [self writeReportWithWriter: &writer imageList: &image_list];
+    STAssertNotNULL(second, @"Could not decode crash report");
+
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+    plcrash_test_thread_stop(&blocked);
+
+    if (first == NULL || second == NULL)
+        return;
+
+    STAssertEquals(first->report_info->metrics->unwind_cache_hits, (uint64_t) 0, @"The first report's threads were cached");
+    STAssertTrue(second->report_info->metrics->unwind_cache_hits > 0, @"No threads were reused from the unwind cache");
+
+    /* Reused threads must be written with the same frames and symbols as when walked */
+    STAssertEquals(first->n_threads, second->n_threads, @"Thread count changed between reports");
+    for (size_t i = 0; i < first->n_threads && i < second->n_threads; i++) {
+        Plcrash__CrashReport__Thread *a = first->threads[i];
+        Plcrash__CrashReport__Thread *b = second->threads[i];
+        if (a->crashed || a->n_frames != b->n_frames)
+            continue;
+
+        for (size_t j = 0; j < a->n_frames; j++) {
+            STAssertEquals(a->frames[j]->pc, b->frames[j]->pc, @"Frame %zu of thread %zu differs", j, i);
+            STAssertEquals(a->frames[j]->symbol != NULL, b->frames[j]->symbol != NULL, @"Symbol of frame %zu of thread %zu differs", j, i);
+        }
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) first, &protobuf_c_system_allocator);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) second, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that each thread's scheduling state is written when thread info capture is enabled.
+ */
+- (void) testWriteReportThreadInfo {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_thread_info(&writer, true), @"Could not enable thread info capture");
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Every written thread should include its scheduling state */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->n_threads > 0, @"No threads were written");
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread__Scheduling *sched = crashReport->threads[i]->scheduling;
+        STAssertNotNULL(sched, @"Thread %zu was written without its scheduling state", i);
+        if (sched == NULL)
+            continue;
+
+        STAssertTrue(sched->run_state >= TH_STATE_RUNNING && sched->run_state <= TH_STATE_HALTED, @"Invalid run state %u", sched->run_state);
+        STAssertTrue(sched->has_base_priority, @"The thread's priority was not written");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that an uncaught exception is written from the reserved exception buffers, and that over-long reasons
+ * are truncated.
+ */
+- (void) testWriteReportExceptionBuffers {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_exception_buffers(&writer, true), @"Could not reserve the exception buffers");
+
+    /* Raise an exception with a reason larger than the reserved buffer */
+    NSString *reason = [@"" stringByPaddingToLength: 64 * 1024 withString: @"TestReason" startingAtIndex: 0];
+    NSException *e = nil;
+    @try {
+        [NSException raise: @"TestException" format: @"%@", reason];
+    }
+    @catch (NSException *exception) {
+        e = exception;
+    }
+    plcrash_log_writer_set_exception(&writer, e);
+    STAssertTrue(writer.uncaught_exception.buffered, @"The exception was not captured into the reserved buffers");
+    STAssertEquals(writer.uncaught_exception.callstack_count, MIN((size_t) [[e callStackReturnAddresses] count], (size_t) 512), @"Incorrect call stack depth");
+    for (size_t i = 0; i < writer.uncaught_exception.callstack_count; i++)
+        STAssertEquals((uint64_t) (uintptr_t) writer.uncaught_exception.callstack[i], [[[e callStackReturnAddresses] objectAtIndex: i] unsignedLongLongValue], @"Incorrect return address at %zu", i);
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    Plcrash__CrashReport__Exception *exception = crashReport->exception;
+    STAssertNotNULL(exception, @"No exception was written");
+    if (exception != NULL) {
+        STAssertTrue(strcmp(exception->name, "TestException") == 0, @"Exception name was not correctly serialized");
+        STAssertTrue(strlen(exception->reason) > 0 && strlen(exception->reason) < [reason length], @"Exception reason was not truncated");
+        STAssertTrue(strncmp(exception->reason, [reason UTF8String], strlen(exception->reason)) == 0, @"Truncated reason is not a prefix of the original");
+        STAssertTrue(exception->n_frames > 0, @"0 exception frames were written");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that the memory usage summary is written when enabled.
+ */
+- (void) testWriteReportMemorySummary {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_memory_summary(&writer, true), @"Could not enable the memory summary");
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the summary */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    Plcrash__CrashReport__Memory *memory = crashReport->memory;
+    STAssertNotNULL(memory, @"The memory summary was not written");
+    if (memory != NULL) {
+        STAssertTrue(memory->has_resident_size && memory->resident_size > 0, @"The resident size was not written");
+        STAssertTrue(memory->n_regions > 0, @"No region summaries were written");
+
+        uint64_t virtual_size = 0;
+        for (size_t i = 0; i < memory->n_regions; i++) {
+            STAssertTrue(memory->regions[i]->region_count > 0, @"An empty region summary was written");
+            virtual_size += memory->regions[i]->virtual_size;
+        }
+        STAssertTrue(virtual_size > 0, @"The region summaries are empty");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a synthesized termination report, which contains no threads or images.
+ */
+- (void) testWriteReportTermination {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false), @"Initialization failed");
+
+    plcrash_async_app_state_record_t session;
+    memset(&session, 0, sizeof(session));
+    session.pid = 42;
+    session.launch_time = 1000;
+    session.foreground = 1;
+    session.memory_warning = 1;
+    session.footprint = 1024 * 1024;
+    session.footprint_time = 2000;
+
+    plcrash_log_writer_termination_info_t termination = { .reason = PLCRASH_ASYNC_APP_STATE_TERMINATION_OOM, .session = &session };
+    plcrash_log_writer_set_termination(&writer, &termination);
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGKILL, .code = 0, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, pl_mach_thread_self(), &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the termination */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertEquals(crashReport->n_threads, (size_t) 0, @"No threads should be written");
+    STAssertEquals(crashReport->n_binary_images, (size_t) 0, @"No images should be written");
+
+    Plcrash__CrashReport__Termination *t = crashReport->termination;
+    STAssertNotNULL(t, @"The termination was not written");
+    if (t != NULL) {
+        STAssertEquals(t->reason, PLCRASH__CRASH_REPORT__TERMINATION__REASON__OUT_OF_MEMORY, @"Incorrect reason");
+        STAssertEquals(t->pid, (uint32_t) 42, @"Incorrect pid");
+        STAssertEquals(t->launch_time, (int64_t) 1000, @"Incorrect launch time");
+        STAssertTrue(t->foreground, @"Incorrect foreground state");
+        STAssertFalse(t->in_hang, @"Incorrect hang state");
+        STAssertTrue(t->memory_warning, @"Incorrect memory warning state");
+        STAssertEquals(t->footprint, (uint64_t) 1024 * 1024, @"Incorrect footprint");
+        STAssertEquals(t->footprint_time, (int64_t) 2000, @"Incorrect footprint time");
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Test writing a report with raw stack capture enabled.
+ */
+- (void) testWriteReportRawStacks {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_raw_stack_size(&writer, 4096);
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Every thread should have its registers and raw stack written in place of its frames */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertTrue(crashReport->n_threads > 0, @"No threads were written");
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *t = crashReport->threads[i];
+        STAssertEquals(t->n_frames, (size_t) 0, @"Thread %u stack was walked", t->thread_number);
+        STAssertTrue(t->n_registers > 0, @"Thread %u registers were not written", t->thread_number);
+
+        STAssertNotNULL(t->stack_memory, @"Thread %u stack was not captured", t->thread_number);
+        if (t->stack_memory == NULL)
+            continue;
+
+        STAssertTrue(t->stack_memory->data.len > 0, @"Thread %u stack capture is empty", t->thread_number);
+        STAssertTrue(t->stack_memory->data.len <= 4096, @"Thread %u stack capture exceeds the requested size", t->thread_number);
+        STAssertTrue(t->stack_memory->address != 0, @"Thread %u stack address was not written", t->thread_number);
+    }
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/* Recursion test thread state */
+struct recursion_thread_args {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool ready;
+    bool done;
+};
+
+/* Recurse @a depth times, and then wait to be asked to exit */
+static void __attribute__((noinline)) recursion_thread_recurse (struct recursion_thread_args *args, uint32_t depth) {
+    volatile uint32_t result = depth;
+
+    if (depth > 0) {
+        recursion_thread_recurse(args, depth - 1);
+    } else {
+        pthread_mutex_lock(&args->lock);
+        args->ready = true;
+        pthread_cond_signal(&args->cond);
+        while (!args->done)
+            pthread_cond_wait(&args->cond, &args->lock);
+        pthread_mutex_unlock(&args->lock);
+    }
+
+    /* Prevent tail call optimization */
+    result++;
+}
+
+/* Four times the writer's 512 frame limit */
+#define RECURSION_TEST_DEPTH 2048
+
+static void *recursion_thread_entry (void *arg) {
+    recursion_thread_recurse(arg, RECURSION_TEST_DEPTH);
+    return NULL;
+}
+
+/**
+ * Verify that repeated frames are collapsed, allowing the bottom of a stack deeper than the frame limit to be captured.
+ */
+- (void) testWriteReportCollapsesRecursion {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    struct recursion_thread_args args = { .ready = false, .done = false };
+    pthread_t recursion_thread;
+    NSError *error;
+
+    /* Start the recursing thread */
+    pthread_mutex_init(&args.lock, NULL);
+    pthread_cond_init(&args.cond, NULL);
+    pthread_mutex_lock(&args.lock);
+    pthread_create(&recursion_thread, NULL, recursion_thread_entry, &args);
+    while (!args.ready)
+        pthread_cond_wait(&args.cond, &args.lock);
+    pthread_mutex_unlock(&args.lock);
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+
+    /* Write the report, marking the recursing thread as crashed */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGSEGV, .code = SEGV_MAPERR, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(recursion_thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Stop the recursing thread */
+    pthread_mutex_lock(&args.lock);
+    args.done = true;
+    pthread_cond_signal(&args.cond);
+    pthread_mutex_unlock(&args.lock);
+    pthread_join(recursion_thread, NULL);
+
+    pthread_cond_destroy(&args.cond);
+    pthread_mutex_destroy(&args.lock);
+
+    /* Verify that the recursion was collapsed, and that the frames beyond it were captured */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+
+    PLCrashReportThreadInfo *crashed = nil;
+    for (PLCrashReportThreadInfo *threadInfo in [report threads]) {
+        if ([threadInfo crashed])
+            crashed = threadInfo;
+    }
+    STAssertNotNil(crashed, @"Crashed thread was not written");
+
+    NSUInteger depth = 0;
+    NSUInteger repeatedFrame = NSNotFound;
+    NSArray *frames = [crashed stackFrames];
+    for (NSUInteger i = 0; i < [frames count]; i++) {
+        PLCrashReportStackFrameInfo *frame = [frames objectAtIndex: i];
+        depth++;
+
+        if ([frame repeatCount] > 0) {
+            STAssertTrue([frame repeatLength] > 0, @"Repeat count set without a sequence length");
+            depth += [frame repeatLength] * [frame repeatCount];
+            if (repeatedFrame == NSNotFound)
+                repeatedFrame = i;
+        }
+    }
+
+    STAssertTrue(repeatedFrame != NSNotFound, @"Recursion was not collapsed");
+    STAssertTrue([frames count] < 512, @"Collapsed stack exhausted the frame limit");
+    STAssertTrue(depth > RECURSION_TEST_DEPTH, @"Collapsed stack does not account for the full recursion depth");
+    STAssertTrue(repeatedFrame + 1 < [frames count], @"Frames beyond the recursion were not captured");
+
+    /* Verify the formatted output */
+    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: PLCrashReportTextFormatiOS];
+    STAssertTrue([text rangeOfString: @"more times"].location != NSNotFound, @"Repeated frames were not formatted");
+}
+
+/* A call chain of CHAIN_FN_COUNT distinct functions, longer than any repeated sequence collapsed by the writer */
+#define CHAIN_FN_COUNT 9
+#define CHAIN_TEST_DEPTH 48
+
+static void chain_call (struct recursion_thread_args *args, uint32_t depth);
+
+#define CHAIN_FN(n) static void __attribute__((noinline)) chain_fn_##n (struct recursion_thread_args *args, uint32_t depth) { \
+    volatile uint32_t result = depth; \
+    chain_call(args, depth); \
+    result++; \
+}
+CHAIN_FN(0) CHAIN_FN(1) CHAIN_FN(2) CHAIN_FN(3) CHAIN_FN(4) CHAIN_FN(5) CHAIN_FN(6) CHAIN_FN(7) CHAIN_FN(8)
+
+static void __attribute__((noinline)) chain_call (struct recursion_thread_args *args, uint32_t depth) {
+    static void (*chain[CHAIN_FN_COUNT])(struct recursion_thread_args *, uint32_t) = {
+        chain_fn_0, chain_fn_1, chain_fn_2, chain_fn_3, chain_fn_4, chain_fn_5, chain_fn_6, chain_fn_7, chain_fn_8
+    };
+    volatile uint32_t result = depth;
+
+    if (depth == 0) {
+        recursion_thread_recurse(args, 0);
+    } else {
+        chain[depth % CHAIN_FN_COUNT](args, depth - 1);
+    }
+
+    /* Prevent tail call optimization */
+    result++;
+}
+
+static void *chain_thread_entry (void *arg) {
+    chain_call(arg, CHAIN_TEST_DEPTH);
+    return NULL;
+}
+
+/* Write a report for the current task to @a path using @a policy, returning the decoded report. */
+- (PLCrashReport *) reportWithCapturePolicy: (plcrash_log_writer_capture_policy_t *) policy path: (NSString *) path {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    NSError *error;
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    int fd = open([path UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    if (policy != NULL)
+        plcrash_log_writer_set_capture_policy(&writer, policy);
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: path] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+    return report;
+}
+
+/**
+ * Verify that the outermost frames of a stack exceeding its frame limit are retained when tail frames are enabled.
+ */
+- (void) testWriteReportTailFrames {
+    struct recursion_thread_args args = { .ready = false, .done = false };
+    pthread_t chain_thread;
+
+    /* Start the call chain thread */
+    pthread_mutex_init(&args.lock, NULL);
+    pthread_cond_init(&args.cond, NULL);
+    pthread_mutex_lock(&args.lock);
+    pthread_create(&chain_thread, NULL, chain_thread_entry, &args);
+    while (!args.ready)
+        pthread_cond_wait(&args.cond, &args.lock);
+    pthread_mutex_unlock(&args.lock);
+
+    /* Write a reference report without a frame limit, and a report with a limit and tail frames */
+    NSString *fullPath = [_logPath stringByAppendingString: @".full"];
+    PLCrashReport *full = [self reportWithCapturePolicy: NULL path: fullPath];
+    [[NSFileManager defaultManager] removeItemAtPath: fullPath error: NULL];
+
+    plcrash_log_writer_capture_policy_t policy = {
+        .thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_KERNEL,
+        .max_thread_frames = 16,
+        .tail_frames = 4
+    };
+    PLCrashReport *limited = [self reportWithCapturePolicy: &policy path: _logPath];
+
+    /* Stop the call chain thread */
+    pthread_mutex_lock(&args.lock);
+    args.done = true;
+    pthread_cond_signal(&args.cond);
+    pthread_mutex_unlock(&args.lock);
+    pthread_join(chain_thread, NULL);
+
+    pthread_cond_destroy(&args.cond);
+    pthread_mutex_destroy(&args.lock);
+
+    /* Find the call chain thread, the only thread deeper than CHAIN_TEST_DEPTH frames */
+    NSArray *fullFrames = nil;
+    NSUInteger fullIndex = 0;
+    for (PLCrashReportThreadInfo *threadInfo in [full threads]) {
+        if ([[threadInfo stackFrames] count] > CHAIN_TEST_DEPTH) {
+            fullFrames = [threadInfo stackFrames];
+            break;
+        }
+        fullIndex++;
+    }
+    STAssertNotNil(fullFrames, @"Could not find the call chain thread");
+    if (fullFrames == nil)
+        return;
+
+    NSArray *frames = [[[limited threads] objectAtIndex: fullIndex] stackFrames];
+    STAssertEquals([frames count], (NSUInteger) 16, @"Incorrect frame count");
+
+    /* The innermost and outermost frames must match the complete walk, with the remainder recorded as omitted */
+    for (NSUInteger i = 0; i < 12; i++)
+        STAssertEquals([[frames objectAtIndex: i] instructionPointer], [[fullFrames objectAtIndex: i] instructionPointer], @"Head frame %lu differs", (unsigned long) i);
+
+    for (NSUInteger i = 0; i < 4; i++) {
+        uint64_t expected = [[fullFrames objectAtIndex: [fullFrames count] - 4 + i] instructionPointer];
+        STAssertEquals([[frames objectAtIndex: 12 + i] instructionPointer], expected, @"Tail frame %lu differs", (unsigned long) i);
+    }
+
+    STAssertEquals([[frames objectAtIndex: 11] omittedFrameCount], [fullFrames count] - 16, @"Incorrect omitted frame count");
+}
+
+/**
+ * Verify that only the innermost frames of threads other than the crashed and main threads are symbolicated when a
+ * symbolication limit is set.
+ */
+- (void) testWriteReportSymbolicatedFrameLimit {
+    struct recursion_thread_args args = { .ready = false, .done = false };
+    pthread_t chain_thread;
+
+    /* Start the call chain thread */
+    pthread_mutex_init(&args.lock, NULL);
+    pthread_cond_init(&args.cond, NULL);
+    pthread_mutex_lock(&args.lock);
+    pthread_create(&chain_thread, NULL, chain_thread_entry, &args);
+    while (!args.ready)
+        pthread_cond_wait(&args.cond, &args.lock);
+    pthread_mutex_unlock(&args.lock);
+
+    plcrash_log_writer_capture_policy_t policy = {
+        .thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_KERNEL,
+        .max_symbolicated_frames = 2
+    };
+    PLCrashReport *report = [self reportWithCapturePolicy: &policy path: _logPath];
+
+    /* Stop the call chain thread */
+    pthread_mutex_lock(&args.lock);
+    args.done = true;
+    pthread_cond_signal(&args.cond);
+    pthread_mutex_unlock(&args.lock);
+    pthread_join(chain_thread, NULL);
+
+    pthread_cond_destroy(&args.cond);
+    pthread_mutex_destroy(&args.lock);
+
+    /* The main thread is written first, and along with the crashed thread, is symbolicated in full */
+    BOOL foundChain = NO;
+    NSArray *threads = [report threads];
+    for (NSUInteger i = 0; i < [threads count]; i++) {
+        PLCrashReportThreadInfo *threadInfo = [threads objectAtIndex: i];
+        NSArray *frames = [threadInfo stackFrames];
+        if (i == 0 || [threadInfo crashed] || [frames count] <= 2)
+            continue;
+
+        if ([frames count] > CHAIN_TEST_DEPTH) {
+            foundChain = YES;
+            STAssertNotNil([[frames objectAtIndex: 0] symbolInfo], @"The innermost frame was not symbolicated");
+        }
+
+        for (NSUInteger j = 2; j < [frames count]; j++)
+            STAssertNil([[frames objectAtIndex: j] symbolInfo], @"Frame %lu of thread %lu was symbolicated", (unsigned long) j, (unsigned long) i);
+    }
+    STAssertTrue(foundChain, @"Could not find the call chain thread");
+
+    PLCrashReportThreadInfo *crashedThread = nil;
+    for (PLCrashReportThreadInfo *threadInfo in threads) {
+        if ([threadInfo crashed])
+            crashedThread = threadInfo;
+    }
+    STAssertNotNil(crashedThread, @"Could not find the crashed thread");
+    if ([[crashedThread stackFrames] count] > 2)
+        STAssertNotNil([[[crashedThread stackFrames] objectAtIndex: 2] symbolInfo], @"The crashed thread was not symbolicated in full");
+}
+
+/**
+ * Verify that breadcrumb records are written to the report, and decoded oldest first.
+ */
+- (void) testWriteReportBreadcrumbs {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    plcrash_async_breadcrumb_buffer_t breadcrumbs;
+    NSError *error;
+
+    /* Wrap a four record buffer */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_breadcrumb_buffer_init(&breadcrumbs, 4, 16), @"Failed to initialize breadcrumbs");
+    for (int i = 0; i < 6; i++) {
+        char record[16];
+        int length = snprintf(record, sizeof(record), "crumb %d", i);
+        plcrash_async_breadcrumb_buffer_append(&breadcrumbs, record, length);
+    }
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_breadcrumbs(&writer, &breadcrumbs);
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+    plcrash_nasync_breadcrumb_buffer_free(&breadcrumbs);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Only the four most recent records are retained */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+
+    NSArray *records = [report breadcrumbs];
+    STAssertEquals([records count], (NSUInteger) 4, @"Incorrect breadcrumb count");
+    for (NSUInteger i = 0; i < [records count]; i++) {
+        NSString *expected = [NSString stringWithFormat: @"crumb %lu", (unsigned long) i + 2];
+        NSString *actual = [[[NSString alloc] initWithData: [records objectAtIndex: i] encoding: NSUTF8StringEncoding] autorelease];
+        STAssertEqualObjects(actual, expected, @"Incorrect breadcrumb %lu", (unsigned long) i);
+    }
+}
+
+/**
+ * Verify that registered user regions are copied into the report, and that a deallocated region is written without
+ * its contents.
+ */
+- (void) testWriteReportUserRegions {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    plcrash_async_user_regions_t regions;
+    NSError *error;
+
+    static const char state[] = "request-1234";
+    vm_address_t unmapped;
+    STAssertEquals(KERN_SUCCESS, vm_allocate(mach_task_self(), &unmapped, PAGE_SIZE, VM_FLAGS_ANYWHERE), @"Failed to allocate page");
+
+    plcrash_async_user_regions_init(&regions);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_add(&regions, state, sizeof(state), 1), @"Failed to register region");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_async_user_regions_add(&regions, (void *) unmapped, 16, 2), @"Failed to register region");
+    vm_deallocate(mach_task_self(), unmapped, PAGE_SIZE);
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_user_regions(&writer, &regions), @"Failed to set user regions");
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+
+    /* Regions are written in slot order */
+    NSArray *userRegions = [report userRegions];
+    STAssertEquals([userRegions count], (NSUInteger) 2, @"Incorrect region count");
+
+    PLCrashReportUserRegionInfo *region = [userRegions objectAtIndex: 0];
+    STAssertEquals(region.tag, (uint32_t) 1, @"Incorrect tag");
+    STAssertEquals(region.address, (uint64_t) (uintptr_t) state, @"Incorrect address");
+    STAssertEquals(region.length, (uint64_t) sizeof(state), @"Incorrect length");
+    STAssertEqualObjects(region.data, [NSData dataWithBytes: state length: sizeof(state)], @"Incorrect contents");
+
+    region = [userRegions objectAtIndex: 1];
+    STAssertEquals(region.tag, (uint32_t) 2, @"Incorrect tag");
+    STAssertEquals(region.length, (uint64_t) 16, @"Incorrect length");
+    STAssertNil(region.data, @"Contents of a deallocated region were written");
+}
+
+/**
+ * Verify that the debug trace is written to the report, and decoded oldest first.
+ */
+- (void) testWriteReportDebugTrace {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    plcrash_async_trace_ring_t trace;
+    NSError *error;
+
+    memset(&trace, 0, sizeof(trace));
+    plcrash_async_trace_ring_append(&trace, PLCRASH_ASYNC_TRACE_LEVEL_ERROR, PLCRASH_ASYNC_TRACE_EVENT_WALK_TERMINATED, 42, 3, 7);
+    plcrash_async_trace_ring_append(&trace, PLCRASH_ASYNC_TRACE_LEVEL_INFO, PLCRASH_ASYNC_TRACE_EVENT_UNKNOWN_SIGNAL, 99, 1, 0);
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(writer.trace, plcrash_async_trace_shared_ring(), @"Shared trace ring was not used by default");
+    plcrash_log_writer_set_trace(&writer, &trace);
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Only the used records are written */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport->debug_trace, @"No debug trace");
+    STAssertEquals(crashReport->debug_trace->records.len, 2 * sizeof(plcrash_async_trace_record_t), @"Incorrect trace length");
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+
+    NSArray *events = [report debugTrace];
+    STAssertEquals([events count], (NSUInteger) 2, @"Incorrect event count");
+    STAssertEqualObjects([events objectAtIndex: 0], @"walk_terminated thread=42 error=3 frames=7", @"Incorrect event");
+    STAssertEqualObjects([events objectAtIndex: 1], @"unknown_signal signo=99 code=1", @"Incorrect event");
+}
+
+/**
+ * Verify that hang samples are written to the report and decoded.
+ */
+- (void) testWriteReportHang {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    NSError *error;
+
+    /* Populate two samples */
+    plcrash_log_writer_hang_sample_t samples[2];
+    memset(samples, 0, sizeof(samples));
+    for (uint32_t i = 0; i < 2; i++) {
+        samples[i].offset = 500 + (i * 250);
+        samples[i].frame_count = 3;
+        for (uint32_t f = 0; f < samples[i].frame_count; f++)
+            samples[i].pcs[f] = 0x1000 + (i * 0x100) + f;
+    }
+
+    plcrash_log_writer_hang_info_t hang = { .duration = 2500, .samples = samples, .sample_count = 2 };
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_hang(&writer, &hang);
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the decoded hang */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfFile: _logPath] error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+
+    PLCrashReportHangInfo *hangInfo = [report hangInfo];
+    STAssertNotNil(hangInfo, @"Missing hang info");
+    STAssertEqualsWithAccuracy([hangInfo duration], 2.5, 0.0001, @"Incorrect duration");
+    STAssertEquals([[hangInfo samples] count], (NSUInteger) 2, @"Incorrect sample count");
+
+    for (NSUInteger i = 0; i < 2; i++) {
+        PLCrashReportHangSample *sample = [[hangInfo samples] objectAtIndex: i];
+        STAssertEqualsWithAccuracy([sample offset], (500 + (i * 250)) / 1000.0, 0.0001, @"Incorrect offset for sample %lu", (unsigned long) i);
+        STAssertEquals([[sample stackFrames] count], (NSUInteger) 3, @"Incorrect frame count for sample %lu", (unsigned long) i);
+
+        for (NSUInteger f = 0; f < 3; f++) {
+            PLCrashReportStackFrameInfo *frame = [[sample stackFrames] objectAtIndex: f];
+            STAssertEquals([frame instructionPointer], (uint64_t) (0x1000 + (i * 0x100) + f), @"Incorrect PC");
+        }
+    }
+}
+
+/**
+ * Verify that reports written to memory output are compressed when enabled, and decompressed transparently.
+ */
+- (void) testWriteCompressedReport {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    NSError *error;
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    NSMutableData *data = [NSMutableData dataWithLength: 512 * 1024];
+    plcrash_async_file_init_memory(&file, [data mutableBytes], [data length]);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_set_compression(&writer, [data length]), @"Failed to enable compression");
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    [data setLength: (NSUInteger) plcrash_async_file_tell(&file)];
+    plcrash_async_file_close(&file);
+
+    /* Verify the header, and that the report decodes */
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    STAssertTrue(memcmp(header->magic, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) == 0, @"Incorrect file magic");
+    STAssertEquals(header->version, (uint8_t) (PLCRASH_REPORT_FILE_VERSION | PLCRASH_REPORT_FILE_FLAG_COMPRESSED), @"Report was not flagged as compressed");
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode compressed report: %@", error);
+    STAssertTrue([[report threads] count] > 0, @"No threads were decoded");
+    STAssertTrue([[report images] count] > 0, @"No images were decoded");
+
+    /* Compression must also be transparent to lazy decoding */
+    report = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: &error] autorelease];
+    STAssertNotNil(report, @"Could not lazily decode compressed report: %@", error);
+    STAssertTrue([[report threads] count] > 0, @"No threads were decoded");
+
+    /* The checksum covers the uncompressed report */
+    STAssertTrue([PLCrashReport validateData: data error: &error], @"Compressed report failed validation: %@", error);
+}
+
+/**
+ * Verify that the report footer lists the report's sections and crashed thread, and is discarded when decoding.
+ */
+- (void) testWriteReportFooter {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    NSError *error;
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    NSMutableData *data = [NSMutableData dataWithLength: 512 * 1024];
+    plcrash_async_file_init_memory(&file, [data mutableBytes], [data length]);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+    plcrash_log_writer_set_footer(&writer, true);
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    [data setLength: (NSUInteger) plcrash_async_file_tell(&file)];
+    plcrash_async_file_close(&file);
+
+    /* Read the footer */
+    const struct PLCrashReportFileHeader *header = [data bytes];
+    plcrash_report_footer_t footer;
+    size_t reportLength;
+
+    STAssertEquals(header->version, (uint8_t) (PLCRASH_REPORT_FILE_VERSION | PLCRASH_REPORT_FILE_FLAG_FOOTER), @"Report was not flagged as having a footer");
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_read_footer([data bytes], [data length], &footer, &reportLength), @"Failed to read the footer");
+
+    /* The sections must cover the complete message, in order */
+    size_t offset = 0;
+    for (size_t i = 0; i < footer.count; i++) {
+        STAssertEquals(footer.sections[i].range.offset, offset, @"Section %zu is not contiguous with its predecessor", i);
+        offset += footer.sections[i].range.length;
+    }
+    STAssertEquals(offset, reportLength - sizeof(*header), @"The sections do not cover the report message");
+
+    /* The signal and the crashed thread can be decoded directly */
+    plcrash_report_range_t range;
+    STAssertTrue(plcrash_report_footer_find(&footer, 6, &range), @"The signal section was not listed");
+    STAssertTrue(footer.has_crashed_thread, @"The crashed thread was not listed");
+
+    Plcrash__CrashReport *crashed = plcrash__crash_report__unpack(&protobuf_c_system_allocator, footer.crashed_thread.length, header->data + footer.crashed_thread.offset);
+    STAssertNotNULL(crashed, @"Could not decode the crashed thread's record");
+    if (crashed != NULL) {
+        STAssertEquals(crashed->n_threads, (size_t) 1, @"Incorrect number of thread records");
+        STAssertTrue(crashed->n_threads == 1 && crashed->threads[0]->crashed, @"The listed thread is not the crashed thread");
+        protobuf_c_message_free_unpacked((ProtobufCMessage *) crashed, &protobuf_c_system_allocator);
+    }
+
+    /* The footer is discarded transparently */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode report: %@", error);
+    STAssertTrue(footer.crashed_thread_index < [[report threads] count], @"Invalid crashed thread index");
+    STAssertTrue([PLCrashReport validateData: data error: &error], @"Report failed validation: %@", error);
+}
+
+/**
+ * Verify that reports are terminated with a checksum that detects truncation and corruption.
+ */
+- (void) testWriteReportChecksum {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+    NSError *error;
+
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Use a small buffer, such that back-patched output will have been flushed */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    STAssertTrue(fd >= 0, @"Could not open the output file");
+
+    char buffer[256];
+    plcrash_async_file_init_buffer(&file, fd, 0, buffer, sizeof(buffer));
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+    STAssertTrue(plcrash_async_file_close(&file), @"Failed to close the report");
+
+    /* Validate the report */
+    NSMutableData *data = [NSMutableData dataWithContentsOfFile: _logPath];
+    STAssertNotNil(data, @"Could not read the report");
+    STAssertTrue([PLCrashReport validateData: data error: &error], @"Report failed validation: %@", error);
+
+    /* The checksum is transparent to decoding */
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode the report: %@", error);
+
+    /* Corrupt a byte within the report */
+    uint8_t *bytes = [data mutableBytes];
+    bytes[[data length] / 2] ^= 0x1;
+    STAssertFalse([PLCrashReport validateData: data error: NULL], @"Corrupt report passed validation");
+    bytes[[data length] / 2] ^= 0x1;
+
+    /* Truncate the report */
+    [data setLength: [data length] - 1];
+    STAssertFalse([PLCrashReport validateData: data error: NULL], @"Truncated report passed validation");
+}
+
+/**
+ * Verify that binary image records pre-encoded at image registration time are written in place of crash-time encoding.
+ */
+- (void) testWriteReportPreEncodedImages {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list, pre-encoding the image records */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    plcrash_nasync_image_list_set_record_encoder(&image_list, plcrash_log_writer_encode_binary_image);
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Verify that the records were encoded */
+    size_t image_count = 0;
+    plcrash_async_image_list_set_reading(&image_list, true); {
+        plcrash_async_image_t *image = NULL;
+        while ((image = plcrash_async_image_list_next(&image_list, image)) != NULL) {
+            image_count++;
+            STAssertNotNULL(image->record, @"No record was encoded for %s", image->macho_image.name);
+            STAssertEquals(image->record_length, plcrash_log_writer_encode_binary_image(&image->macho_image, NULL, 0), @"Incorrect record length");
+        }
+    } plcrash_async_image_list_set_reading(&image_list, false);
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Write the report */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, true), @"Initialization failed");
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Verify the images */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    STAssertEquals(crashReport->n_binary_images, image_count, @"Incorrect number of images written");
+    [self checkBinaryImages: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
+/**
+ * Verify that binary image records are not encoded into an undersized buffer.
+ */
+- (void) testEncodeBinaryImageBufferSize {
+    plcrash_async_macho_t image;
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_nasync_macho_init(&image, mach_task_self(), _dyld_get_image_name(0), (pl_vm_address_t) _dyld_get_image_header(0)), @"Failed to initialize image");
+
+    size_t length = plcrash_log_writer_encode_binary_image(&image, NULL, 0);
+    STAssertTrue(length > 0, @"Failed to compute the record length");
+
+    uint8_t *buffer = malloc(length);
+    STAssertEquals((size_t) 0, plcrash_log_writer_encode_binary_image(&image, buffer, length - 1), @"Record was encoded into an undersized buffer");
+    STAssertEquals(length, plcrash_log_writer_encode_binary_image(&image, buffer, length), @"Failed to encode the record");
+
+    free(buffer);
+    plcrash_nasync_macho_free(&image);
+}
+
+/**
+ * Verify that the static report messages are written correctly when the writer's pre-encoded header is unavailable.
+ */
+- (void) testWriteReportWithoutStaticHeader {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_async_image_list_t image_list;
+
+    /* Initialize the image list */
+    plcrash_nasync_image_list_init(&image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&image_list, _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    /* Open the output file */
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    plcrash_async_file_init(&file, fd, 0);
+
+    /* Initialize a writer, and discard the pre-encoded header */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, false), @"Initialization failed");
+    STAssertNotNULL(writer.static_header.data, @"The static header was not encoded");
+    STAssertTrue(writer.static_header.system_info_length < writer.static_header.length, @"Incorrect system info length");
+
+    free(writer.static_header.data);
+    writer.static_header.data = NULL;
+
+    /* Write the report */
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+    plcrash_nasync_image_list_free(&image_list);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    /* Validate the static messages */
+    Plcrash__CrashReport *crashReport = [self loadReport];
+    STAssertNotNULL(crashReport, @"Could not decode crash report");
+    if (crashReport == NULL)
+        return;
+
+    [self checkSystemInfo: crashReport];
+    [self checkAppInfo: crashReport];
+    [self checkProcessInfo: crashReport];
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+}
+
 @end
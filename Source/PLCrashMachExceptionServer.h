@@ -75,6 +75,13 @@ kern_return_t PLCrashMachExceptionForward (task_t task,
                 context: (void *) context
                   error: (NSError **) outError;
 
+- (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
+                context: (void *) context
+            threadCount: (NSUInteger) threadCount
+                  error: (NSError **) outError;
+
+- (thread_t) serverThreadAtIndex: (NSUInteger) index;
+
 - (mach_port_t) copySendRightForServerAndReturningError: (NSError **) outError;
 
 - (PLCrashMachExceptionPort *) exceptionPortWithMask: (exception_mask_t) mask error: (NSError **) outError;
@@ -83,6 +90,9 @@ kern_return_t PLCrashMachExceptionForward (task_t task,
  * a thread-specific exception handler for the server itself. */
 @property(nonatomic, readonly) thread_t serverThread;
 
+/** The number of threads on which the exception server is running. */
+@property(nonatomic, readonly) NSUInteger serverThreadCount;
+
 @end
 
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
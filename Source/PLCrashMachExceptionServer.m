@@ -108,6 +108,9 @@
 #error The allocated message identifiers conflict.
 #endif
 
+/* The maximum number of server threads that may be requested. */
+#define PLCRASH_MAX_SERVER_THREADS 64
+
 #if USE_MACH64_CODES
 typedef __Request__mach_exception_raise_t PLRequest_exception_raise_t;
 typedef __Reply__mach_exception_raise_t PLReply_exception_raise_t;
@@ -141,6 +144,9 @@ static exception_mask_t exception_to_mask (exception_type_t exception) {
         EXM(CRASH);
 #ifdef EXC_GUARD
         EXM(GUARD);
+#endif
+#ifdef EXC_RESOURCE
+        EXM(RESOURCE);
 #endif
     }
 #undef EXM
@@ -156,14 +162,39 @@ static exception_mask_t exception_to_mask (exception_type_t exception) {
 #endif
 }
 
+/**
+ * @internal
+ *
+ * Per-thread exception server state.
+ */
+struct plcrash_exception_server_thread {
+    /** The shared server context. */
+    struct plcrash_exception_server_context *context;
+
+    /** The thread's pre-allocated receive buffer, sized to hold the largest supported exception request. */
+    PLRequest_exception_raise_t *request;
+
+    /** The size of @a request, in bytes. */
+    size_t request_size;
+
+    /** The thread's mach thread, or MACH_PORT_NULL if not yet started. */
+    thread_t thread;
+};
+
 /**
  * @internal
  *
  * Exception handler context.
  */
 struct plcrash_exception_server_context {
-    /** The server's mach thread. */
-    thread_t server_thread;
+    /** The server threads, all of which receive on @a port_set. */
+    struct plcrash_exception_server_thread *threads;
+
+    /** The number of entries in @a threads. */
+    uint32_t thread_count;
+
+    /** The number of server threads that were successfully started. */
+    uint32_t threads_started;
 
     /** Registered exception port. */
     mach_port_t server_port;
@@ -196,8 +227,8 @@ struct plcrash_exception_server_context {
     uint32_t server_should_stop;
 
     /** Intended to be observed by the waiting initialization thread. Informs
-     * the waiting thread that shutdown has completed . */
-    bool server_stop_done;
+     * the waiting thread of the number of server threads that have completed shutdown. */
+    uint32_t server_stop_count;
 };
 
 /***
@@ -251,7 +282,7 @@ struct plcrash_exception_server_context {
 @implementation PLCrashMachExceptionServer
 
 /**
- * Initialize a new Mach exception server.
+ * Initialize a new Mach exception server with a single server thread.
  *
  * @param callback Callback called upon receipt of an exception. The callback will execute
  * on the exception server's thread, distinctly from the crashed thread.
@@ -264,6 +295,32 @@ struct plcrash_exception_server_context {
 - (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
                 context: (void *) context
                   error: (NSError **) outError
+{
+    return [self initWithCallBack: callback context: context threadCount: 1 error: outError];
+}
+
+/**
+ * Initialize a new Mach exception server.
+ *
+ * All server threads receive on a single port set, with each exception message delivered to exactly one idle
+ * thread. Using multiple threads allows unrelated exceptions, such as non-fatal EXC_RESOURCE or EXC_GUARD
+ * exceptions raised concurrently on many threads, to be handled without queueing behind a long-running callback.
+ * Each thread's receive buffer is allocated prior to the thread's start.
+ *
+ * @param callback Callback called upon receipt of an exception. The callback will execute
+ * on one of the exception server's threads, distinctly from the crashed thread. If @a threadCount is greater than
+ * one, the callback may be called concurrently, and must be reentrant.
+ * @param context Context to be passed to the callback. May be NULL.
+ * @param threadCount The number of server threads to be started. Must be between 1 and 64, inclusive.
+ * @param outError A pointer to an NSError object variable. If an error occurs initializing the exception server,
+ * this pointer will contain an error object in the NSMachErrorDomain or NSPOSIXErrorDomain indicating why the
+ * exception handler could not be registered. If no error occurs, this parameter will be left unmodified.
+ * You may specify NULL for this parameter, and no error information will be provided.
+ */
+- (id) initWithCallBack: (PLCrashMachExceptionHandlerCallback) callback
+                context: (void *) context
+            threadCount: (NSUInteger) threadCount
+                  error: (NSError **) outError
 {
     pthread_attr_t attr;
     pthread_t thr;
@@ -272,19 +329,38 @@ struct plcrash_exception_server_context {
     if ((self = [super init]) == nil)
         return nil;
 
+    if (threadCount == 0 || threadCount > PLCRASH_MAX_SERVER_THREADS) {
+        plcrash_populate_posix_error(outError, EINVAL, @"Invalid exception server thread count");
+
+        [self release];
+        return nil;
+    }
     
     /* Initialize the bare context. */
     _serverContext = (struct plcrash_exception_server_context *) calloc(1, sizeof(*_serverContext));
     _serverContext->server_port = MACH_PORT_NULL;
     _serverContext->notify_port = MACH_PORT_NULL;
     _serverContext->port_set = MACH_PORT_NULL;
-    _serverContext->server_thread = MACH_PORT_NULL;
     _serverContext->callback = callback;
     _serverContext->callback_context = context;
     
+    _serverContext->threads = (struct plcrash_exception_server_thread *) calloc(threadCount, sizeof(_serverContext->threads[0]));
+    if (_serverContext->threads == NULL) {
+        plcrash_populate_posix_error(outError, ENOMEM, @"Failed to allocate exception server thread state");
+
+        free(_serverContext);
+        _serverContext = NULL;
+
+        [self release];
+        return nil;
+    }
+    _serverContext->thread_count = (uint32_t) threadCount;
+    
+
     if (pthread_mutex_init(&_serverContext->lock, NULL) != 0) {
         plcrash_populate_posix_error(outError, errno, @"Mutex initialization failed");
         
+        free(_serverContext->threads);
         free(_serverContext);
         _serverContext = NULL;
         
@@ -296,6 +372,7 @@ struct plcrash_exception_server_context {
         plcrash_populate_posix_error(outError, errno, @"Condition initialization failed");
 
         pthread_mutex_destroy(&_serverContext->lock);
+        free(_serverContext->threads);
         free(_serverContext);
         _serverContext = NULL;
         
@@ -371,8 +448,28 @@ struct plcrash_exception_server_context {
         return nil;
     }
 
-    /* Spawn the server thread. */
-    {
+    /* Pre-allocate the receive buffers. The server only registers for EXCEPTION_DEFAULT behavior, and the buffers
+     * are sized for the largest such request, including the maximum trailer; the threads need never reallocate at
+     * exception time. */
+    for (uint32_t i = 0; i < _serverContext->thread_count; i++) {
+        struct plcrash_exception_server_thread *server_thread = &_serverContext->threads[i];
+
+        server_thread->context = _serverContext;
+        server_thread->thread = MACH_PORT_NULL;
+        server_thread->request_size = round_page(sizeof(*server_thread->request) + MAX_TRAILER_SIZE);
+
+        kr = vm_allocate(mach_task_self(), (vm_address_t *) &server_thread->request, server_thread->request_size, VM_FLAGS_ANYWHERE);
+        if (kr != KERN_SUCCESS) {
+            server_thread->request = NULL;
+            plcrash_populate_mach_error(outError, kr, @"Failed to allocate exception server's receive buffer");
+
+            [self release];
+            return nil;
+        }
+    }
+
+    /* Spawn the server threads. */
+    for (uint32_t i = 0; i < _serverContext->thread_count; i++) {
         if (pthread_attr_init(&attr) != 0) {
             plcrash_populate_posix_error(outError, errno, @"Failed to initialize pthread_attr");
             
@@ -385,7 +482,7 @@ struct plcrash_exception_server_context {
         // by crashing code.
         // pthread_attr_setstack(&attr, sp, stacksize);
         
-        if (pthread_create(&thr, &attr, &exception_server_thread, _serverContext) != 0) {
+        if (pthread_create(&thr, &attr, &exception_server_thread, &_serverContext->threads[i]) != 0) {
             plcrash_populate_posix_error(outError, errno, @"Failed to create exception server thread");
             pthread_attr_destroy(&attr);
             
@@ -396,7 +493,10 @@ struct plcrash_exception_server_context {
         pthread_attr_destroy(&attr);
         
         /* Save the thread reference */
-        _serverContext->server_thread = pthread_mach_thread_np(thr);
+        pthread_mutex_lock(&_serverContext->lock); {
+            _serverContext->threads[i].thread = pthread_mach_thread_np(thr);
+            _serverContext->threads_started++;
+        } pthread_mutex_unlock(&_serverContext->lock);
     }
     
     return self;
@@ -409,11 +509,32 @@ struct plcrash_exception_server_context {
  * has not been registered as a mach exception server, or has been deregistered.
  */
 - (thread_t) serverThread {
+    return [self serverThreadAtIndex: 0];
+}
+
+/**
+ * Return the number of server threads.
+ */
+- (NSUInteger) serverThreadCount {
+    NSAssert(_serverContext != NULL, @"No handler registered!");
+    return _serverContext->thread_count;
+}
+
+/**
+ * Return the Mach thread at @a index, which must be less than PLCrashMachExceptionServer::serverThreadCount.
+ *
+ * @param index The index of the server thread to return.
+ *
+ * @warning The behavior of this method is undefined if the receiver
+ * has not been registered as a mach exception server, or has been deregistered.
+ */
+- (thread_t) serverThreadAtIndex: (NSUInteger) index {
     NSAssert(_serverContext != NULL, @"No handler registered!");
+    NSAssert(index < _serverContext->thread_count, @"Server thread index out of range");
 
     thread_t result;
     pthread_mutex_lock(&_serverContext->lock); {
-        result = _serverContext->server_thread;
+        result = _serverContext->threads[index].thread;
     } pthread_mutex_unlock(&_serverContext->lock);
     
     return result;
@@ -662,53 +783,31 @@ kern_return_t PLCrashMachExceptionForward (task_t task,
  * has been returned, as the state of the process' threads is entirely unknown.
  */
 static void *exception_server_thread (void *arg) {
-    struct plcrash_exception_server_context *exc_context = (struct plcrash_exception_server_context *) arg;
-    PLRequest_exception_raise_t *request = NULL;
-    size_t request_size;
-    kern_return_t kr;
+    struct plcrash_exception_server_thread *server_thread = (struct plcrash_exception_server_thread *) arg;
+    struct plcrash_exception_server_context *exc_context = server_thread->context;
+    PLRequest_exception_raise_t *request = server_thread->request;
+    size_t request_size = server_thread->request_size;
     mach_msg_return_t mr;
     
-    /* Initialize the received message with a default size */
-    request_size = round_page(sizeof(*request));
-    kr = vm_allocate(mach_task_self(), (vm_address_t *) &request, request_size, VM_FLAGS_ANYWHERE);
-    if (kr != KERN_SUCCESS) {
-        /* Shouldn't happen ... */
-        fprintf(stderr, "Unexpected error in vm_allocate(): %x\n", kr);
-        return NULL;
-    }
-    
     /* Wait for an exception message */
     while (true) {
-        /* Initialize our request message */
+        /* Initialize our request message. The buffer is sized for the largest supported request; an oversized message
+         * can not be a supported exception request, and MACH_RCV_LARGE is intentionally not set, allowing the kernel
+         * to destroy such a message (and its reply right) rather than requiring the buffer to be reallocated. */
         request->Head.msgh_local_port = exc_context->port_set;
         request->Head.msgh_size = request_size;
         mr = mach_msg(&request->Head,
-                      MACH_RCV_MSG | MACH_RCV_LARGE,
+                      MACH_RCV_MSG,
                       0,
                       request->Head.msgh_size,
                       exc_context->port_set,
                       MACH_MSG_TIMEOUT_NONE,
                       MACH_PORT_NULL);
         
-        /* Handle recoverable errors */
-        if (mr != MACH_MSG_SUCCESS && mr == MACH_RCV_TOO_LARGE) {
-            /* Determine the new size (before dropping the buffer) */
-            request_size = round_page(request->Head.msgh_size);
-            
-            /* Drop the old receive buffer */
-            vm_deallocate(mach_task_self(), (vm_address_t) request, request_size);
-            
-            /* Re-allocate a larger receive buffer */
-            kr = vm_allocate(mach_task_self(), (vm_address_t *) &request, request_size, VM_FLAGS_ANYWHERE);
-            if (kr != KERN_SUCCESS) {
-                /* Shouldn't happen ... */
-                fprintf(stderr, "Unexpected error in vm_allocate(): 0x%x\n", kr);
-                return NULL;
-            }
-            
+        /* Handle errors */
+        if (mr == MACH_RCV_TOO_LARGE) {
+            PLCF_DEBUG("Discarded an oversized message");
             continue;
-            
-            /* Handle fatal errors */
         } else if (mr != MACH_MSG_SUCCESS) {
             /* Shouldn't happen ... */
             PLCF_DEBUG("Unexpected error in mach_msg(): 0x%x", mr);
@@ -736,9 +835,10 @@ static void *exception_server_thread (void *arg) {
                      * spuriously with the process in an unknown state, in which case we must not call
                      * out to non-async-safe functions */
                     if (exc_context->server_should_stop) {
-                        /* Inform the requesting thread of completion */
+                        /* Inform the requesting thread of completion. Each server thread consumes exactly one
+                         * termination message. */
                         pthread_mutex_lock(&exc_context->lock); {
-                            exc_context->server_stop_done = true;
+                            exc_context->server_stop_count++;
                             pthread_cond_signal(&exc_context->server_cond);
                         } pthread_mutex_unlock(&exc_context->lock);
                         
@@ -791,10 +891,7 @@ static void *exception_server_thread (void *arg) {
         }
     }
     
-    /* Drop the receive buffer */
-    if (request != NULL)
-        vm_deallocate(mach_task_self(), (vm_address_t) request, request_size);
-    
+    /* The receive buffer is owned by the server context, and is released once all threads have stopped */
     return NULL;
 }
 
@@ -811,25 +908,28 @@ static void *exception_server_thread (void *arg) {
     /* Mark the server for termination */
     OSAtomicCompareAndSwap32Barrier(0, 1, (int32_t *) &_serverContext->server_should_stop);
 
-    /* Wake up the waiting server */
-    mach_msg_header_t msg;
-    memset(&msg, 0, sizeof(msg));
-    msg.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, MACH_MSG_TYPE_MAKE_SEND_ONCE);
-    msg.msgh_local_port = MACH_PORT_NULL;
-    msg.msgh_remote_port = _serverContext->notify_port;
-    msg.msgh_size = sizeof(msg);
-    msg.msgh_id = PLCRASH_TERMINATE_MSGH_ID;
-
-    mr = mach_msg(&msg, MACH_SEND_MSG, msg.msgh_size, 0, MACH_PORT_NULL, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
-
-    if (mr != MACH_MSG_SUCCESS) {
-        NSLog(@"Unexpected error sending termination message to background thread: %d", mr);
-        return;
+    /* Wake up the waiting server threads; each will consume a single termination message. */
+    uint32_t threads_started = _serverContext->threads_started;
+    for (uint32_t i = 0; i < threads_started; i++) {
+        mach_msg_header_t msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_COPY_SEND, MACH_MSG_TYPE_MAKE_SEND_ONCE);
+        msg.msgh_local_port = MACH_PORT_NULL;
+        msg.msgh_remote_port = _serverContext->notify_port;
+        msg.msgh_size = sizeof(msg);
+        msg.msgh_id = PLCRASH_TERMINATE_MSGH_ID;
+
+        mr = mach_msg(&msg, MACH_SEND_MSG, msg.msgh_size, 0, MACH_PORT_NULL, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+
+        if (mr != MACH_MSG_SUCCESS) {
+            NSLog(@"Unexpected error sending termination message to background thread: %d", mr);
+            return;
+        }
     }
 
     /* Wait for completion */
     pthread_mutex_lock(&_serverContext->lock);
-    while (!_serverContext->server_stop_done) {
+    while (_serverContext->server_stop_count < threads_started) {
         pthread_cond_wait(&_serverContext->server_cond, &_serverContext->lock);
     }
     pthread_mutex_unlock(&_serverContext->lock);
@@ -847,7 +947,14 @@ static void *exception_server_thread (void *arg) {
     pthread_cond_destroy(&_serverContext->server_cond);
     pthread_mutex_destroy(&_serverContext->lock);
 
-    /* Once we've been signaled by the background thread, it will no longer access exc_context */
+    /* Once we've been signaled by the background threads, they will no longer access exc_context or their
+     * receive buffers */
+    for (uint32_t i = 0; i < _serverContext->thread_count; i++) {
+        if (_serverContext->threads[i].request != NULL)
+            vm_deallocate(mach_task_self(), (vm_address_t) _serverContext->threads[i].request, _serverContext->threads[i].request_size);
+    }
+
+    free(_serverContext->threads);
     free(_serverContext);
     
     [super dealloc];
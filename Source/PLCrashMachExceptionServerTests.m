@@ -240,6 +240,51 @@ static kern_return_t exception_callback (task_t task,
     STAssertTrue(didRun, @"Calback was not executed");
 }
 
+/**
+ * Test a server running on multiple threads.
+ */
+- (void) testMultipleServerThreads {
+    NSError *error;
+
+    /* Zero threads are not permitted */
+    STAssertNil([[[PLCrashMachExceptionServer alloc] initWithCallBack: exception_callback context: NULL threadCount: 0 error: &error] autorelease],
+                @"Server initialized with no threads");
+
+    BOOL didRun = false;
+    PLCrashMachExceptionServer *server = [[[PLCrashMachExceptionServer alloc] initWithCallBack: exception_callback
+                                                                                       context: &didRun
+                                                                                   threadCount: 4
+                                                                                         error: &error] autorelease];
+    STAssertNotNil(server, @"Failed to initialize server: %@", error);
+    STAssertEquals([server serverThreadCount], (NSUInteger) 4, @"Incorrect thread count");
+    STAssertEquals([server serverThread], [server serverThreadAtIndex: 0], @"The first server thread should be the primary server thread");
+
+    /* All threads must be distinct */
+    for (NSUInteger i = 0; i < [server serverThreadCount]; i++) {
+        STAssertTrue(MACH_PORT_VALID([server serverThreadAtIndex: i]), @"Invalid server thread");
+        for (NSUInteger j = i + 1; j < [server serverThreadCount]; j++)
+            STAssertNotEquals([server serverThreadAtIndex: i], [server serverThreadAtIndex: j], @"Duplicate server thread");
+    }
+
+    /* Verify that exceptions are dispatched */
+    PLCrashMachExceptionPort *port = [server exceptionPortWithMask: EXC_MASK_BAD_ACCESS error: &error];
+    STAssertNotNil(port, @"Failed to fetch server port: %@", error);
+
+    STAssertTrue([port registerForTask: mach_task_self()
+                       previousPortSet: NULL
+                                 error: &error], @"Failed to configure handler: %@", error);
+
+    PLCrashMachExceptionPortSet *portSet = [PLCrashMachExceptionPort exceptionPortsForTask: mach_task_self() mask: EXC_MASK_BAD_ACCESS error: &error];
+    plcrash_mach_exception_port_set_t port_set = portSet.asyncSafeRepresentation;
+
+    mach_exception_data_type_t codes[2] = { 0x1, 0x2 };
+    kern_return_t kt = PLCrashMachExceptionForward(mach_task_self(), pl_mach_thread_self(), EXC_BAD_ACCESS, codes, 2, &port_set);
+    STAssertEquals(KERN_SUCCESS, kt, @"Callback did not return KERN_SUCCESS");
+    STAssertTrue(didRun, @"Callback was not executed");
+
+    /* Server shutdown on dealloc must terminate all threads; if this test hangs, it has failed. */
+}
+
 /**
  * Test basic copying of the send right.
  */
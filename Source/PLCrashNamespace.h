@@ -48,18 +48,29 @@
 #define PLCrashMachExceptionServer          PLNS(PLCrashMachExceptionServer)
 #define PLCrashReport                       PLNS(PLCrashReport)
 #define PLCrashReportApplicationInfo        PLNS(PLCrashReportApplicationInfo)
+#define PLCrashReportArchive                PLNS(PLCrashReportArchive)
+#define PLCrashReportArchiveWriter          PLNS(PLCrashReportArchiveWriter)
 #define PLCrashReportBinaryImageInfo        PLNS(PLCrashReportBinaryImageInfo)
 #define PLCrashReportExceptionInfo          PLNS(PLCrashReportExceptionInfo)
+#define PLCrashReportFrameTable             PLNS(PLCrashReportFrameTable)
+#define PLCrashReportHangInfo               PLNS(PLCrashReportHangInfo)
+#define PLCrashReportHangSample             PLNS(PLCrashReportHangSample)
 #define PLCrashReportMachineInfo            PLNS(PLCrashReportMachineInfo)
+#define PLCrashReportMemoryInfo             PLNS(PLCrashReportMemoryInfo)
+#define PLCrashReportMemoryRegionInfo       PLNS(PLCrashReportMemoryRegionInfo)
 #define PLCrashReportProcessInfo            PLNS(PLCrashReportProcessInfo)
 #define PLCrashReportProcessorInfo          PLNS(PLCrashReportProcessorInfo)
 #define PLCrashReportRegisterInfo           PLNS(PLCrashReportRegisterInfo)
 #define PLCrashReportSignalInfo             PLNS(PLCrashReportSignalInfo)
 #define PLCrashReportStackFrameInfo         PLNS(PLCrashReportStackFrameInfo)
+#define PLCrashReportStringTable            PLNS(PLCrashReportStringTable)
 #define PLCrashReportSymbolInfo             PLNS(PLCrashReportSymbolInfo)
 #define PLCrashReportSystemInfo             PLNS(PLCrashReportSystemInfo)
+#define PLCrashReportTerminationInfo        PLNS(PLCrashReportTerminationInfo)
 #define PLCrashReportTextFormatter          PLNS(PLCrashReportTextFormatter)
 #define PLCrashReportThreadInfo             PLNS(PLCrashReportThreadInfo)
+#define PLCrashReportThreadSchedulingInfo   PLNS(PLCrashReportThreadSchedulingInfo)
+#define PLCrashReportUserRegionInfo         PLNS(PLCrashReportUserRegionInfo)
 #define PLCrashReporter                     PLNS(PLCrashReporter)
 #define PLCrashSignalHandler                PLNS(PLCrashSignalHandler)
 #define PLCrashReportHostArchitecture       PLNS(PLCrashReportHostArchitecture)
@@ -67,10 +78,14 @@
 #define PLCrashReporterErrorDomain          PLNS(PLCrashReporterErrorDomain)
 #define PLCrashReporterException            PLNS(PLCrashReporterException)
 #define PLCrashHostInfo                     PLNS(PLCrashHostInfo)
+#define PLCrashHangDetector                 PLNS(PLCrashHangDetector)
+#define PLCrashPathWarmer                   PLNS(PLCrashPathWarmer)
+#define PLCrashReportStore                  PLNS(PLCrashReportStore)
 #define PLCrashMachExceptionPort            PLNS(PLCrashMachExceptionPort)
 #define PLCrashMachExceptionPortSet         PLNS(PLCrashMachExceptionPortSet)
 #define PLCrashProcessInfo                  PLNS(PLCrashProcessInfo)
 #define PLCrashReporterConfig               PLNS(PLCrashReporterConfig)
+#define PLCrashReporterStatistics           PLNS(PLCrashReporterStatistics)
 #define PLCrashUncaughtExceptionHandler     PLNS(PLCrashUncaughtExceptionHandler)
 #define PLCrashMachExceptionForward         PLNS(PLCrashMachExceptionForward)
 #define PLCrashSignalHandlerForward         PLNS(PLCrashSignalHandlerForward)
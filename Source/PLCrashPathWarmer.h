@@ -0,0 +1,114 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <pthread.h>
+#import <stdint.h>
+
+/**
+ * @internal
+ * The maximum number of regions that may be registered with a PLCrashPathWarmer.
+ */
+#define PLCRASH_PATH_WARMER_MAX_REGIONS 8
+
+/**
+ * @internal
+ * The minimum interval between warming passes, in seconds.
+ */
+#define PLCRASH_PATH_WARMER_MIN_INTERVAL 1.0
+
+/**
+ * @internal
+ * A page-aligned region warmed by PLCrashPathWarmer.
+ */
+typedef struct plcrash_path_warmer_region {
+    /** The page-aligned base address of the region. */
+    uintptr_t base;
+
+    /** The size of the region, in bytes; a multiple of the page size. */
+    size_t size;
+} plcrash_path_warmer_region_t;
+
+@interface PLCrashPathWarmer : NSObject {
+@private
+    /** The registered regions. */
+    plcrash_path_warmer_region_t _regions[PLCRASH_PATH_WARMER_MAX_REGIONS];
+
+    /** The number of valid entries in @a _regions. */
+    size_t _regionCount;
+
+    /** The mincore(2) result vector, sized for the largest registered region. */
+    char *_residency;
+
+    /** The number of entries allocated in @a _residency. */
+    size_t _residencyCount;
+
+    /** The interval between warming passes. */
+    NSTimeInterval _interval;
+
+    /** The number of non-resident pages faulted in by the warmer. */
+    volatile int64_t _pageInCount;
+
+    /** The number of completed warming passes. */
+    volatile int64_t _passCount;
+
+    /** The warming thread. */
+    pthread_t _thread;
+
+    /** Lock and condition used to wake the warming thread when stopping. */
+    pthread_mutex_t _lock;
+    pthread_cond_t _cond;
+
+    /** YES if the warming thread is running. */
+    BOOL _running;
+
+    /** Set to request that the warming thread exit. Protected by @a _lock. */
+    BOOL _stop;
+}
+
+- (id) initWithInterval: (NSTimeInterval) interval;
+
+- (BOOL) addRegion: (const void *) address length: (size_t) length;
+- (BOOL) addCrashPathText;
+
+- (BOOL) startAndReturnError: (NSError **) outError;
+- (void) stop;
+
+- (void) warm;
+
+/** The total size of the registered regions, in bytes. */
+@property(nonatomic, readonly) uint64_t warmedSize;
+
+/** The number of non-resident pages faulted in by the warmer. */
+@property(nonatomic, readonly) uint64_t pageInCount;
+
+/** The number of completed warming passes. */
+@property(nonatomic, readonly) uint64_t passCount;
+
+@end
@@ -0,0 +1,323 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashPathWarmer.h"
+#import "PLCrashReporterNSError.h"
+#import "PLCrashAsync.h"
+
+#import "PLCrashLogWriter.h"
+#import "PLCrashSignalHandler.h"
+#import "PLCrashFrameWalker.h"
+#import "PLCrashFrameDWARFUnwind.h"
+#import "PLCrashAsyncCompactUnwindEncoding.h"
+#import "PLCrashAsyncMachOImage.h"
+
+#import <dlfcn.h>
+#import <sys/mman.h>
+#import <sys/time.h>
+#import <mach-o/getsect.h>
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * The maximum size of the crash path text span registered by -[PLCrashPathWarmer addCrashPathText]. If the span is
+ * larger, the crash reporter's code is not laid out contiguously, and the text is not registered.
+ */
+#define PLCRASH_PATH_WARMER_MAX_TEXT_SIZE (16 * 1024 * 1024)
+
+static void *plcrash_path_warmer_thread (void *arg);
+
+/**
+ * @internal
+ *
+ * Periodically warms the pages used at crash time.
+ *
+ * The crash path -- the log writer, frame readers, and DWARF and compact unwind parsers -- is rarely executed, and
+ * its text pages, along with any pre-allocated crash-time buffers, are likely to have been evicted or compressed by
+ * the time a crash occurs; the crash handler would then incur a page-in for every evicted page it touches. On each
+ * pass, the warmer issues a MADV_WILLNEED advisory for each registered region, and then reads a byte from each page
+ * that mincore(2) reports as non-resident. Resident pages are not touched, and so a pass over a warm process
+ * costs one mincore(2) call per region.
+ */
+@implementation PLCrashPathWarmer
+
+/**
+ * Initialize a new warmer. No regions are warmed until regions have been registered and the warmer is started.
+ *
+ * @param interval The interval between warming passes. Intervals shorter than PLCRASH_PATH_WARMER_MIN_INTERVAL are
+ * rounded up.
+ */
+- (id) initWithInterval: (NSTimeInterval) interval {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _interval = MAX(interval, PLCRASH_PATH_WARMER_MIN_INTERVAL);
+    pthread_mutex_init(&_lock, NULL);
+    pthread_cond_init(&_cond, NULL);
+
+    return self;
+}
+
+- (void) dealloc {
+    [self stop];
+
+    pthread_mutex_destroy(&_lock);
+    pthread_cond_destroy(&_cond);
+    free(_residency);
+
+    [super dealloc];
+}
+
+/**
+ * Register a region to be warmed. The region is expanded to page boundaries, and must remain mapped and readable for
+ * the lifetime of the receiver. Regions may only be registered prior to starting the warmer.
+ *
+ * @param address The base address of the region.
+ * @param length The length of the region, in bytes.
+ *
+ * @return Returns YES on success, or NO if PLCRASH_PATH_WARMER_MAX_REGIONS regions have already been registered, the
+ * region is empty, or the warmer is running.
+ */
+- (BOOL) addRegion: (const void *) address length: (size_t) length {
+    if (_running || length == 0 || _regionCount == PLCRASH_PATH_WARMER_MAX_REGIONS)
+        return NO;
+
+    uintptr_t base = trunc_page((uintptr_t) address);
+    size_t size = round_page((uintptr_t) address + length) - base;
+
+    /* Size the residency vector for the largest region */
+    size_t pages = size / PAGE_SIZE;
+    if (pages > _residencyCount) {
+        char *residency = realloc(_residency, pages);
+        if (residency == NULL)
+            return NO;
+
+        _residency = residency;
+        _residencyCount = pages;
+    }
+
+    _regions[_regionCount].base = base;
+    _regions[_regionCount].size = size;
+    _regionCount++;
+
+    return YES;
+}
+
+/**
+ * Register the text of the crash reporter's crash path. The span is derived from the addresses of the crash path's
+ * entry points, clamped to the __TEXT,__text section of the image containing them; as the crash reporter's object
+ * files are linked contiguously, this covers the crash path whether the crash reporter is linked as a framework or
+ * a static library.
+ *
+ * @return Returns YES on success, or NO if the span could not be determined or registered.
+ */
+- (BOOL) addCrashPathText {
+    const void *anchors[] = {
+        (const void *) &plcrash_signal_handler,
+        (const void *) &plcrash_log_writer_write,
+        (const void *) &plframe_cursor_next,
+        (const void *) &plframe_cursor_read_dwarf_unwind,
+        (const void *) &plcrash_async_cfe_reader_find_pc,
+        (const void *) &plcrash_async_macho_find_symbol_by_pc,
+    };
+
+    uintptr_t start = UINTPTR_MAX;
+    uintptr_t end = 0;
+    for (size_t i = 0; i < sizeof(anchors) / sizeof(anchors[0]); i++) {
+        start = MIN(start, (uintptr_t) anchors[i]);
+        end = MAX(end, (uintptr_t) anchors[i]);
+    }
+
+    /* Clamp the span to the containing image's text section */
+    Dl_info info;
+    if (dladdr(anchors[0], &info) == 0 || info.dli_fbase == NULL) {
+        PLCF_DEBUG("Could not find the crash reporter's image");
+        return NO;
+    }
+
+    unsigned long text_size;
+#ifdef __LP64__
+    uint8_t *text = getsectiondata((const struct mach_header_64 *) info.dli_fbase, SEG_TEXT, SECT_TEXT, &text_size);
+#else
+    uint8_t *text = getsectiondata((const struct mach_header *) info.dli_fbase, SEG_TEXT, SECT_TEXT, &text_size);
+#endif
+    if (text == NULL || start < (uintptr_t) text || end >= (uintptr_t) text + text_size) {
+        PLCF_DEBUG("The crash path does not reside within a single text section");
+        return NO;
+    }
+
+    /* The span starts at the first anchor's entry point, but ends at the final anchor's entry point; extend it to
+     * cover the final anchor's body. */
+    end = MIN((uintptr_t) text + text_size, end + PAGE_SIZE);
+    if (end - start > PLCRASH_PATH_WARMER_MAX_TEXT_SIZE) {
+        PLCF_DEBUG("The crash path text span of %lu bytes exceeds the maximum", (unsigned long) (end - start));
+        return NO;
+    }
+
+    return [self addRegion: (const void *) start length: end - start];
+}
+
+/**
+ * Start the warming thread.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the warmer could not be started. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the warmer could not be started.
+ */
+- (BOOL) startAndReturnError: (NSError **) outError {
+    if (_running) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"The crash path warmer is already running", nil);
+        return NO;
+    }
+
+    _stop = NO;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    int ret = pthread_create(&_thread, &attr, plcrash_path_warmer_thread, self);
+    pthread_attr_destroy(&attr);
+
+    if (ret != 0) {
+        plcrash_populate_posix_error(outError, ret, @"Could not start the crash path warming thread");
+        return NO;
+    }
+
+    _running = YES;
+    return YES;
+}
+
+/**
+ * Stop the warming thread, waiting for any in-progress pass to complete. If the warmer is not running, this
+ * method is a no-op.
+ */
+- (void) stop {
+    if (!_running)
+        return;
+
+    pthread_mutex_lock(&_lock);
+    _stop = YES;
+    pthread_cond_signal(&_cond);
+    pthread_mutex_unlock(&_lock);
+
+    pthread_join(_thread, NULL);
+    _running = NO;
+}
+
+/**
+ * Perform a single warming pass over all registered regions.
+ */
+- (void) warm {
+    for (size_t i = 0; i < _regionCount; i++) {
+        const plcrash_path_warmer_region_t *region = &_regions[i];
+        size_t pages = region->size / PAGE_SIZE;
+
+        if (mincore((caddr_t) region->base, region->size, _residency) != 0) {
+            PLCF_DEBUG("mincore() failure: %d", errno);
+            continue;
+        }
+
+        /* Skip fully resident regions */
+        size_t missing = 0;
+        for (size_t p = 0; p < pages; p++) {
+            if (!(_residency[p] & MINCORE_INCORE))
+                missing++;
+        }
+
+        if (missing == 0)
+            continue;
+
+        /* Start read-ahead of file-backed pages, then fault in each non-resident page */
+        madvise((void *) region->base, region->size, MADV_WILLNEED);
+        for (size_t p = 0; p < pages; p++) {
+            if (!(_residency[p] & MINCORE_INCORE))
+                (void) *(volatile const uint8_t *) (region->base + (p * PAGE_SIZE));
+        }
+
+        OSAtomicAdd64Barrier((int64_t) missing, &_pageInCount);
+    }
+
+    OSAtomicIncrement64Barrier(&_passCount);
+}
+
+/**
+ * Wait for the warming interval to elapse.
+ *
+ * @return Returns NO if the warmer has been stopped, YES otherwise.
+ */
+- (BOOL) waitForInterval {
+    struct timeval now;
+    struct timespec deadline;
+    gettimeofday(&now, NULL);
+
+    uint64_t nsec = (uint64_t) now.tv_usec * NSEC_PER_USEC + (uint64_t) (_interval * NSEC_PER_SEC);
+    deadline.tv_sec = now.tv_sec + (time_t) (nsec / NSEC_PER_SEC);
+    deadline.tv_nsec = (long) (nsec % NSEC_PER_SEC);
+
+    BOOL running;
+    pthread_mutex_lock(&_lock);
+    if (!_stop)
+        pthread_cond_timedwait(&_cond, &_lock, &deadline);
+    running = !_stop;
+    pthread_mutex_unlock(&_lock);
+
+    return running;
+}
+
+/**
+ * Warming thread main loop.
+ */
+- (void) runWarmer {
+    while ([self waitForInterval])
+        [self warm];
+}
+
+- (uint64_t) warmedSize {
+    uint64_t size = 0;
+    for (size_t i = 0; i < _regionCount; i++)
+        size += _regions[i].size;
+    return size;
+}
+
+- (uint64_t) pageInCount {
+    return (uint64_t) _pageInCount;
+}
+
+- (uint64_t) passCount {
+    return (uint64_t) _passCount;
+}
+
+@end
+
+/* pthread entry point for the warming thread */
+static void *plcrash_path_warmer_thread (void *arg) {
+    PLCrashPathWarmer *warmer = arg;
+    [warmer runWarmer];
+    return NULL;
+}
@@ -0,0 +1,111 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashPathWarmer.h"
+
+#import <sys/mman.h>
+
+@interface PLCrashPathWarmerTests : SenTestCase {
+@private
+}
+
+@end
+
+@implementation PLCrashPathWarmerTests
+
+/**
+ * Test registration of regions.
+ */
+- (void) testAddRegion {
+    PLCrashPathWarmer *warmer = [[[PLCrashPathWarmer alloc] initWithInterval: 60] autorelease];
+    static uint8_t buffer[PAGE_SIZE * 2];
+
+    STAssertFalse([warmer addRegion: buffer length: 0], @"Empty region was registered");
+    STAssertTrue([warmer addRegion: buffer + 1 length: PAGE_SIZE], @"Failed to register region");
+    STAssertTrue(warmer.warmedSize >= PAGE_SIZE, @"Region was not expanded to page boundaries");
+    STAssertEquals((uint64_t) 0, warmer.warmedSize % PAGE_SIZE, @"Region was not expanded to page boundaries");
+
+    for (size_t i = 1; i < PLCRASH_PATH_WARMER_MAX_REGIONS; i++)
+        STAssertTrue([warmer addRegion: buffer length: sizeof(buffer)], @"Failed to register region %zu", i);
+    STAssertFalse([warmer addRegion: buffer length: sizeof(buffer)], @"Registered more than the maximum number of regions");
+}
+
+/**
+ * Test that a warming pass faults in non-resident pages, and leaves resident pages untouched.
+ */
+- (void) testWarm {
+    PLCrashPathWarmer *warmer = [[[PLCrashPathWarmer alloc] initWithInterval: 60] autorelease];
+
+    /* Map fresh pages, leaving them non-resident */
+    size_t size = PAGE_SIZE * 4;
+    void *region = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE, -1, 0);
+    STAssertTrue(region != MAP_FAILED, @"Failed to map region");
+
+    STAssertTrue([warmer addRegion: region length: size], @"Failed to register region");
+
+    [warmer warm];
+    STAssertEquals((uint64_t) 1, warmer.passCount, @"Pass was not counted");
+
+    uint64_t pageIns = warmer.pageInCount;
+    STAssertEquals((uint64_t) 4, pageIns, @"Non-resident pages were not faulted in");
+
+    /* Subsequent passes must not touch the now-resident pages */
+    char residency[4];
+    STAssertEquals(0, mincore(region, size, residency), @"mincore() failed");
+
+    BOOL resident = YES;
+    for (size_t i = 0; i < 4; i++) {
+        if (!(residency[i] & MINCORE_INCORE))
+            resident = NO;
+    }
+
+    if (resident) {
+        [warmer warm];
+        STAssertEquals(pageIns, warmer.pageInCount, @"Resident pages were counted as page-ins");
+    }
+
+    munmap(region, size);
+}
+
+/**
+ * Test starting and stopping the warming thread.
+ */
+- (void) testStartStop {
+    PLCrashPathWarmer *warmer = [[[PLCrashPathWarmer alloc] initWithInterval: 60] autorelease];
+    STAssertTrue([warmer addCrashPathText], @"Failed to register the crash path text");
+
+    NSError *error;
+    STAssertTrue([warmer startAndReturnError: &error], @"Failed to start warmer: %@", error);
+    STAssertFalse([warmer startAndReturnError: NULL], @"Warmer was started twice");
+    STAssertFalse([warmer addRegion: &error length: sizeof(error)], @"Region was registered on a running warmer");
+
+    [warmer stop];
+}
+
+@end
@@ -0,0 +1,269 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashProbes.h"
+#include "PLCrashFeatureConfig.h"
+
+#if PLCRASH_FEATURE_PROBES
+
+#include <pthread.h>
+
+#if defined(__has_include)
+#  if __has_include(<os/signpost.h>)
+#    include <os/log.h>
+#    include <os/signpost.h>
+#    define PLCRASH_PROBES_SIGNPOSTS 1
+#  endif
+#  if __has_include("PLCrashReporterProvider.h")
+#    include "PLCrashReporterProvider.h"
+#    define PLCRASH_PROBES_USDT 1
+#  endif
+#endif
+
+#ifndef PLCRASH_PROBES_SIGNPOSTS
+#  define PLCRASH_PROBES_SIGNPOSTS 0
+#endif
+
+#ifndef PLCRASH_PROBES_USDT
+#  define PLCRASH_PROBES_USDT 0
+#endif
+
+#endif /* PLCRASH_FEATURE_PROBES */
+
+/**
+ * @internal
+ * @defgroup plcrash_probes Signpost and DTrace Probes
+ * @ingroup plcrash_internal
+ *
+ * Instrumentation of the crash reporter's non-crash paths. Each phase boundary is emitted as an os_signpost
+ * interval, and as a USDT probe of the plcrashreporter DTrace provider, allowing the reporter's cost at launch and
+ * while snapshotting hangs to be measured in Instruments or with dtrace(1), using a standard release build.
+ *
+ * Signposts are emitted only when the running OS supports them and a tool has enabled the log category; USDT probes
+ * are compiled to no-ops until enabled by a tracer. When neither is being observed, each probe costs a flag check.
+ *
+ * These functions are not async-safe, and must not be used on the crash-time path.
+ * @{
+ */
+
+#if PLCRASH_PROBES_SIGNPOSTS
+
+/* The shared signpost log handle, or NULL if signposts are unavailable. */
+static os_log_t plcrash_probe_log = NULL;
+static pthread_once_t plcrash_probe_log_once = PTHREAD_ONCE_INIT;
+
+/* Create the shared log handle. */
+static void plcrash_probe_log_init (void) {
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *))
+        plcrash_probe_log = os_log_create("com.plausiblelabs.crashreporter", "PointsOfInterest");
+}
+
+/* Return the shared log handle if signposts are supported and enabled, or NULL. */
+static os_log_t plcrash_probe_signpost_log (void) {
+    pthread_once(&plcrash_probe_log_once, plcrash_probe_log_init);
+    if (plcrash_probe_log == NULL)
+        return NULL;
+
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+        if (os_signpost_enabled(plcrash_probe_log))
+            return plcrash_probe_log;
+    }
+
+    return NULL;
+}
+
+#endif /* PLCRASH_PROBES_SIGNPOSTS */
+
+/**
+ * Begin a probe interval.
+ *
+ * @param interval The interval state to initialize; must be passed to plcrash_probe_end() once the phase completes.
+ * @param phase The phase being entered. Must not be an event-only phase.
+ * @param arg The phase's begin argument, as documented by plcrash_probe_phase_t, or 0.
+ */
+void plcrash_probe_begin (plcrash_probe_interval_t *interval, plcrash_probe_phase_t phase, uint64_t arg) {
+    interval->phase = phase;
+    interval->signpost_id = 0;
+
+#if PLCRASH_FEATURE_PROBES
+#if PLCRASH_PROBES_USDT
+    switch (phase) {
+        case PLCRASH_PROBE_PHASE_ENABLE:
+            PLCRASHREPORTER_ENABLE_START((int) arg);
+            break;
+        case PLCRASH_PROBE_PHASE_SETUP:
+            PLCRASHREPORTER_SETUP_START();
+            break;
+        case PLCRASH_PROBE_PHASE_LIVE_REPORT:
+            PLCRASHREPORTER_LIVE_REPORT_START(arg);
+            break;
+        case PLCRASH_PROBE_PHASE_SAMPLE:
+            PLCRASHREPORTER_SAMPLE_START(arg);
+            break;
+        default:
+            break;
+    }
+#endif /* PLCRASH_PROBES_USDT */
+
+#if PLCRASH_PROBES_SIGNPOSTS
+    os_log_t log = plcrash_probe_signpost_log();
+    if (log == NULL)
+        return;
+
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+        os_signpost_id_t sid = os_signpost_id_generate(log);
+        interval->signpost_id = sid;
+
+        switch (phase) {
+            case PLCRASH_PROBE_PHASE_ENABLE:
+                os_signpost_interval_begin(log, sid, "Enable", "deferred=%llu", arg);
+                break;
+            case PLCRASH_PROBE_PHASE_SETUP:
+                os_signpost_interval_begin(log, sid, "Setup");
+                break;
+            case PLCRASH_PROBE_PHASE_LIVE_REPORT:
+                os_signpost_interval_begin(log, sid, "LiveReport", "thread=%llu", arg);
+                break;
+            case PLCRASH_PROBE_PHASE_SAMPLE:
+                os_signpost_interval_begin(log, sid, "Sample", "thread=%llu", arg);
+                break;
+            default:
+                interval->signpost_id = 0;
+                break;
+        }
+    }
+#endif /* PLCRASH_PROBES_SIGNPOSTS */
+#endif /* PLCRASH_FEATURE_PROBES */
+}
+
+/**
+ * End a probe interval begun by plcrash_probe_begin().
+ *
+ * @param interval The interval to be ended.
+ * @param arg0 The phase's first end argument, as documented by plcrash_probe_phase_t, or 0.
+ * @param arg1 The phase's second end argument, or 0.
+ * @param arg2 The phase's third end argument, or 0.
+ * @param arg3 The phase's fourth end argument, or 0.
+ */
+void plcrash_probe_end (plcrash_probe_interval_t *interval, uint64_t arg0, uint64_t arg1, uint64_t arg2, uint64_t arg3) {
+#if PLCRASH_FEATURE_PROBES
+#if PLCRASH_PROBES_USDT
+    switch (interval->phase) {
+        case PLCRASH_PROBE_PHASE_ENABLE:
+            PLCRASHREPORTER_ENABLE_DONE((int) arg0, arg1);
+            break;
+        case PLCRASH_PROBE_PHASE_SETUP:
+            PLCRASHREPORTER_SETUP_DONE(arg0);
+            break;
+        case PLCRASH_PROBE_PHASE_LIVE_REPORT:
+            PLCRASHREPORTER_LIVE_REPORT_DONE((int) arg0, arg1, arg2, arg3);
+            break;
+        case PLCRASH_PROBE_PHASE_SAMPLE:
+            PLCRASHREPORTER_SAMPLE_DONE((int) arg0, arg1);
+            break;
+        default:
+            break;
+    }
+#endif /* PLCRASH_PROBES_USDT */
+
+#if PLCRASH_PROBES_SIGNPOSTS
+    /* Signposts may have been enabled after the interval began; an interval without an ID is not ended. */
+    if (interval->signpost_id == 0 || plcrash_probe_log == NULL)
+        return;
+
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+        os_log_t log = plcrash_probe_log;
+        os_signpost_id_t sid = (os_signpost_id_t) interval->signpost_id;
+
+        switch (interval->phase) {
+            case PLCRASH_PROBE_PHASE_ENABLE:
+                os_signpost_interval_end(log, sid, "Enable", "success=%llu images=%llu", arg0, arg1);
+                break;
+            case PLCRASH_PROBE_PHASE_SETUP:
+                os_signpost_interval_end(log, sid, "Setup", "images=%llu", arg0);
+                break;
+            case PLCRASH_PROBE_PHASE_LIVE_REPORT:
+                os_signpost_interval_end(log, sid, "LiveReport", "error=%llu threads=%llu frames=%llu images=%llu", arg0, arg1, arg2, arg3);
+                break;
+            case PLCRASH_PROBE_PHASE_SAMPLE:
+                os_signpost_interval_end(log, sid, "Sample", "error=%llu frames=%llu", arg0, arg1);
+                break;
+            default:
+                break;
+        }
+    }
+#endif /* PLCRASH_PROBES_SIGNPOSTS */
+#endif /* PLCRASH_FEATURE_PROBES */
+}
+
+/**
+ * Emit a single probe event.
+ *
+ * @param phase The event-only phase to be emitted.
+ * @param arg0 The event's first argument, as documented by plcrash_probe_phase_t.
+ * @param arg1 The event's second argument.
+ */
+void plcrash_probe_event (plcrash_probe_phase_t phase, uint64_t arg0, uint64_t arg1) {
+#if PLCRASH_FEATURE_PROBES
+#if PLCRASH_PROBES_USDT
+    switch (phase) {
+        case PLCRASH_PROBE_PHASE_IMAGE_ADD:
+            PLCRASHREPORTER_IMAGE_ADD(arg0, arg1);
+            break;
+        case PLCRASH_PROBE_PHASE_IMAGE_REMOVE:
+            PLCRASHREPORTER_IMAGE_REMOVE(arg0, arg1);
+            break;
+        default:
+            break;
+    }
+#endif /* PLCRASH_PROBES_USDT */
+
+#if PLCRASH_PROBES_SIGNPOSTS
+    os_log_t log = plcrash_probe_signpost_log();
+    if (log == NULL)
+        return;
+
+    if (__builtin_available(macOS 10.14, iOS 12.0, tvOS 12.0, watchOS 5.0, *)) {
+        switch (phase) {
+            case PLCRASH_PROBE_PHASE_IMAGE_ADD:
+                os_signpost_event_emit(log, OS_SIGNPOST_ID_EXCLUSIVE, "ImageAdd", "header=0x%llx images=%llu", arg0, arg1);
+                break;
+            case PLCRASH_PROBE_PHASE_IMAGE_REMOVE:
+                os_signpost_event_emit(log, OS_SIGNPOST_ID_EXCLUSIVE, "ImageRemove", "header=0x%llx images=%llu", arg0, arg1);
+                break;
+            default:
+                break;
+        }
+    }
+#endif /* PLCRASH_PROBES_SIGNPOSTS */
+#endif /* PLCRASH_FEATURE_PROBES */
+}
+
+/**
+ * @}
+ */
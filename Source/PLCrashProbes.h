@@ -0,0 +1,88 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_PROBES_H
+#define PLCRASH_PROBES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_probes
+ *
+ * Instrumented phases of the crash reporter's non-crash paths. Each phase is emitted both as an os_signpost
+ * interval (or event) in the "com.plausiblelabs.crashreporter" subsystem's PointsOfInterest category, visible in
+ * Instruments, and as the matching plcrashreporter USDT probe pair (see PLCrashReporterProvider.d).
+ */
+typedef enum {
+    /** Enabling the crash reporter. Begin: deferred setup. End: success, registered images. */
+    PLCRASH_PROBE_PHASE_ENABLE = 0,
+
+    /** Registering the loaded images and configuring the crash-time writer. End: registered images. */
+    PLCRASH_PROBE_PHASE_SETUP,
+
+    /** Generating a live report. Begin: target thread. End: plcrash_error_t, threads, frames, registered images. */
+    PLCRASH_PROBE_PHASE_LIVE_REPORT,
+
+    /** Sampling a thread's stack. Begin: target thread. End: plcrash_error_t, frames. */
+    PLCRASH_PROBE_PHASE_SAMPLE,
+
+    /** A dyld image add notification; emitted as a single event. Arguments: header address, registered images. */
+    PLCRASH_PROBE_PHASE_IMAGE_ADD,
+
+    /** A dyld image remove notification; emitted as a single event. Arguments: header address, registered images. */
+    PLCRASH_PROBE_PHASE_IMAGE_REMOVE,
+} plcrash_probe_phase_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_probes
+ *
+ * An in-progress probe interval.
+ */
+typedef struct plcrash_probe_interval {
+    /** The interval's phase. */
+    plcrash_probe_phase_t phase;
+
+    /** The interval's os_signpost_id_t, or 0 if signposts are unavailable or disabled. */
+    uint64_t signpost_id;
+} plcrash_probe_interval_t;
+
+void plcrash_probe_begin (plcrash_probe_interval_t *interval, plcrash_probe_phase_t phase, uint64_t arg);
+void plcrash_probe_end (plcrash_probe_interval_t *interval, uint64_t arg0, uint64_t arg1, uint64_t arg2, uint64_t arg3);
+void plcrash_probe_event (plcrash_probe_phase_t phase, uint64_t arg0, uint64_t arg1);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_PROBES_H */
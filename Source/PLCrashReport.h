@@ -31,6 +31,9 @@
 #import "PLCrashReportApplicationInfo.h"
 #import "PLCrashReportBinaryImageInfo.h"
 #import "PLCrashReportExceptionInfo.h"
+#import "PLCrashReportHangInfo.h"
+#import "PLCrashReportMemoryInfo.h"
+#import "PLCrashReportTerminationInfo.h"
 #import "PLCrashReportMachineInfo.h"
 #import "PLCrashReportMachExceptionInfo.h"
 #import "PLCrashReportProcessInfo.h"
@@ -41,6 +44,7 @@
 #import "PLCrashReportSymbolInfo.h"
 #import "PLCrashReportSystemInfo.h"
 #import "PLCrashReportThreadInfo.h"
+#import "PLCrashReportUserRegionInfo.h"
 
 /** 
  * @ingroup constants
@@ -53,6 +57,31 @@
  * an entirely new crash log format. */
 #define PLCRASH_REPORT_FILE_VERSION 1
 
+/**
+ * @ingroup constants
+ * Crash format version byte identifier of the compact report encoding. Compact reports use the
+ * same message format as #PLCRASH_REPORT_FILE_VERSION reports, but encode stack frames as an image
+ * index and delta-encoded image offset, image paths via a shared directory string table, and
+ * thread registers as a typed, per-architecture register state. Compact reports are not readable by decoders that predate this version. */
+#define PLCRASH_REPORT_FILE_VERSION_COMPACT 2
+
+/**
+ * @ingroup constants
+ * Crash format version byte flag identifying a compressed report. If set in the header's version byte, the
+ * remaining bits identify the report's encoding, and the file data consists of the uncompressed message length, as
+ * a little-endian 32-bit value, followed by the LZ4 block-compressed message. Compressed reports are decompressed
+ * transparently by PLCrashReport, but are not readable by decoders that predate this flag. */
+#define PLCRASH_REPORT_FILE_FLAG_COMPRESSED 0x80
+
+/**
+ * @ingroup constants
+ * Crash format version byte flag identifying a report written with a section footer. If set in the header's version
+ * byte, the report message (or its compressed representation) is followed by a fixed-layout footer listing the offset
+ * and length of each top-level section of the message, and of the crashed thread's record, allowing tools to seek
+ * directly to the records they require. The footer is not covered by the report checksum. Footers are discarded
+ * transparently by PLCrashReport, but reports with a footer are not readable by decoders that predate this flag. */
+#define PLCRASH_REPORT_FILE_FLAG_FOOTER 0x40
+
 /**
  * @ingroup types
  * Crash log file header format.
@@ -74,6 +103,61 @@ struct PLCrashReportFileHeader {
 } __attribute__((packed));
 
 
+/**
+ * @ingroup enums
+ * Crash report types.
+ */
+typedef enum {
+    /** A report generated due to a fatal signal or Mach exception. */
+    PLCrashReportTypeCrash = 1,
+
+    /** A report generated due to an uncaught language-level exception. */
+    PLCrashReportTypeLanguageException = 2,
+
+    /**
+     * A report generated due to a hang, or a non-fatal resource (EXC_RESOURCE) exception. The stalled or offending
+     * thread is marked as the crashed thread. A watchdog report does not imply that the process was terminated.
+     */
+    PLCrashReportTypeWatchdog = 3,
+
+    /** A live report, generated on request on a running process where no crash occured. */
+    PLCrashReportTypeLive = 4
+} PLCrashReportType;
+
+/**
+ * @ingroup enums
+ * Crash report decoding options.
+ */
+typedef NS_OPTIONS(NSUInteger, PLCrashReportDecodingOptions) {
+    /** Decode the entire report at initialization time. */
+    PLCrashReportDecodingOptionNone = 0,
+
+    /**
+     * Defer decoding of the report's thread and binary image records until they are first accessed. The encoded
+     * report data is retained for the lifetime of the report; when decoding a large number of reports, the data
+     * should be memory mapped (eg, via NSDataReadingMappedIfSafe) to avoid copying the encoded records.
+     *
+     * Decoding errors in the deferred records are not reported at initialization time; the corresponding
+     * property will instead return an empty array.
+     */
+    PLCrashReportDecodingOptionLazy = 1 << 0,
+
+    /**
+     * If the report is a watchdog report (PLCrashReportTypeWatchdog), do not decode the thread registers,
+     * breadcrumbs or debug trace, none of which is used in analyzing a hang; the corresponding properties will
+     * instead be empty. Other report types are decoded in full.
+     */
+    PLCrashReportDecodingOptionWatchdogSummary = 1 << 1,
+
+    /**
+     * If the report is incomplete, such as when the reporting process was terminated while writing it, decode all
+     * complete top-level records preceding the first incomplete or malformed record, rather than failing. Reports
+     * are written with their required records and crashed thread first, and a salvaged report is marked as
+     * truncated. Reports that are complete are decoded unmodified.
+     */
+    PLCrashReportDecodingOptionSalvage = 1 << 2,
+};
+
 /**
  * @internal
  * Private decoder instance variables (used to hide the underlying protobuf parser).
@@ -114,9 +198,45 @@ typedef struct _PLCrashReportDecoder _PLCrashReportDecoder;
 
     /** Report UUID */
     CFUUIDRef _uuid;
+
+    /** If true, the report was truncated at crash time */
+    BOOL _truncated;
+
+    /** Report type */
+    PLCrashReportType _reportType;
+
+    /** Breadcrumb records (NSData instances), oldest first */
+    NSArray *_breadcrumbs;
+
+    /** Crash reporter debug trace events (NSString instances), oldest first */
+    NSArray *_debugTrace;
+
+    /** Hang information (may be nil) */
+    PLCrashReportHangInfo *_hangInfo;
+
+    /** Memory usage information (may be nil) */
+    PLCrashReportMemoryInfo *_memoryInfo;
+
+    /** Termination information (may be nil) */
+    PLCrashReportTerminationInfo *_terminationInfo;
+
+    /** Application-registered memory regions (PLCrashReportUserRegionInfo instances) */
+    NSArray *_userRegions;
+
+    /** The crashed thread, or nil if not yet determined */
+    PLCrashReportThreadInfo *_crashedThread;
+
+    /** If YES, the report has been searched for a crashed thread */
+    BOOL _crashedThreadResolved;
 }
 
 - (id) initWithData: (NSData *) encodedData error: (NSError **) outError;
+- (id) initWithData: (NSData *) encodedData options: (PLCrashReportDecodingOptions) options error: (NSError **) outError;
+
++ (NSArray *) reportsWithDataArray: (NSArray *) dataArray options: (PLCrashReportDecodingOptions) options errors: (NSArray **) outErrors;
+
++ (NSData *) fingerprintForData: (NSData *) encodedData frameCount: (NSUInteger) frameCount error: (NSError **) outError;
++ (BOOL) validateData: (NSData *) encodedData error: (NSError **) outError;
 
 - (PLCrashReportBinaryImageInfo *) imageForAddress: (uint64_t) address;
 
@@ -174,6 +294,13 @@ typedef struct _PLCrashReportDecoder _PLCrashReportDecoder;
  */
 @property(nonatomic, readonly) NSArray *threads;
 
+/**
+ * The crashed thread, or nil if no thread is marked as crashed. If the report was decoded with
+ * PLCrashReportDecodingOptionLazy and the threads property has not yet been accessed, only the crashed thread's
+ * record is decoded; the remaining thread records are skipped without being decoded.
+ */
+@property(nonatomic, readonly) PLCrashReportThreadInfo *crashedThread;
+
 /**
  * Binary image information. Returns a list of PLCrashReportBinaryImageInfo instances.
  */
@@ -197,4 +324,67 @@ typedef struct _PLCrashReportDecoder _PLCrashReportDecoder;
  */
 @property(nonatomic, readonly) CFUUIDRef uuidRef;
 
+/**
+ * YES if the report was truncated to meet the crash reporter's configured time or size budget, or was salvaged from
+ * an incomplete report (see PLCrashReportDecodingOptionSalvage). Threads, frames, symbols, or binary images may have
+ * been omitted from a truncated report.
+ */
+@property(nonatomic, readonly) BOOL truncated;
+
+/**
+ * The report type. Reports written prior to the introduction of report types are assigned a type based on their
+ * contents.
+ */
+@property(nonatomic, readonly) PLCrashReportType reportType;
+
+/**
+ * The application breadcrumbs recorded prior to the crash, as an array of NSData instances, ordered from oldest
+ * to newest. If breadcrumb capture was not enabled, the array will be empty.
+ *
+ * @sa PLCrashReporter::appendBreadcrumb:length:
+ */
+@property(nonatomic, readonly) NSArray *breadcrumbs;
+
+/**
+ * The crash reporter's own diagnostic events, recorded prior to and while writing the report, as an array of
+ * single-line NSString descriptions ordered from oldest to newest. These describe failures within the crash
+ * reporter, such as stack walks that terminated early, and are intended for diagnosing incomplete reports. If the
+ * report contains no trace, the array will be empty.
+ */
+@property(nonatomic, readonly) NSArray *debugTrace;
+
+/**
+ * If this report was generated by the hang detector in response to an unresponsive main thread, the hang's
+ * details. Otherwise, nil. The unresponsive thread is marked as the report's crashed thread.
+ *
+ * @sa PLCrashReporter::enableHangDetectionWithThreshold:reportThreshold:error:
+ */
+@property(nonatomic, readonly) PLCrashReportHangInfo *hangInfo;
+
+/**
+ * The crashed process' memory usage at the time of the crash, or nil if memory usage was not recorded.
+ */
+@property(nonatomic, readonly) PLCrashReportMemoryInfo *memoryInfo;
+
+/**
+ * If this report was synthesized on a later launch to describe a process that was terminated without writing a
+ * crash report -- such as by the system watchdog, or for exceeding its memory limit -- the termination's details.
+ * Otherwise, nil.
+ *
+ * Such reports contain no threads or binary images, and their system, machine, application and process info
+ * describe the launch on which the report was synthesized.
+ *
+ * @sa PLCrashReporter::enableTerminationReportsAndReturnError:
+ */
+@property(nonatomic, readonly) PLCrashReportTerminationInfo *terminationInfo;
+
+/**
+ * The memory regions registered by the application at the time of the crash, as an array of
+ * PLCrashReportUserRegionInfo instances, in no particular order. If no regions were registered, the array will be
+ * empty.
+ *
+ * @sa PLCrashReporter::registerMemoryRegion:length:tag:
+ */
+@property(nonatomic, readonly) NSArray *userRegions;
+
 @end
@@ -30,31 +30,184 @@
 #import "CrashReporter.h"
 
 #import "crash_report.pb-c.h"
+#import "PLCrashReportArena.h"
+#import "PLCrashReportRecordDecoder.h"
+#import "PLCrashReportStringPool.h"
+#import "PLCrashReportFingerprint.h"
+#import "PLCrashReportReader.h"
+#import "PLCrashAsyncBreadcrumbBuffer.h"
+#import "PLCrashAsyncTrace.h"
+#import "PLCrashReportStringTable.h"
+#import "PLCrashReportFrameTable.h"
+
+#import <libkern/OSByteOrder.h>
+#import <pthread.h>
+#import <unistd.h>
+#import <inttypes.h>
+#import <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * An entry in the sorted binary image index.
+ */
+typedef struct pl_image_index_entry {
+    /** The image's base address. */
+    uint64_t base;
+
+    /** The image's end address (exclusive). */
+    uint64_t end;
+
+    /** The image. This is a borrowed reference; the image is retained by the report's images array. */
+    PLCrashReportBinaryImageInfo *image;
+} pl_image_index_entry_t;
 
 struct _PLCrashReportDecoder {
+    /** The unpacked report, allocated from @a arena. Only valid during initialization. */
     Plcrash__CrashReport *crashReport;
+
+    /** The arena from which @a crashReport was allocated, or NULL. Released once initialization completes. */
+    plcrash_report_arena_t *arena;
+
+    /** If true, @a arena is owned by the caller, and is reset rather than released. */
+    bool arenaBorrowed;
+
+    /** The string table used to intern decoded strings, or nil. */
+    PLCrashReportStringTable *strings;
+
+    /** If @a strings is nil, the pool into which binary image and symbol names are decoded, and from which they are
+     * bridged to NSString without copying. Otherwise, NULL. */
+    plcrash_report_string_pool_t *stringPool;
+
+    /** If the report was decoded with PLCrashReportDecodingOptionLazy, the retained encoded report data. Deferred
+     * field ranges are relative to the start of the message that follows the file header. Otherwise, nil. */
+    NSData *encodedData;
+
+    /** Deferred thread records (lazy decoding only). */
+    plcrash_report_range_list_t threadRanges;
+
+    /** Deferred binary image records (lazy decoding only). */
+    plcrash_report_range_list_t imageRanges;
+
+    /** Binary images sorted by base address, or NULL if the index has not yet been built. */
+    pl_image_index_entry_t *imageIndex;
+
+    /** Number of entries in @a imageIndex. */
+    size_t imageIndexCount;
+
+    /** If true, thread registers are not decoded; see PLCrashReportDecodingOptionWatchdogSummary. */
+    bool skipRegisters;
 };
 
 #define IMAGE_UUID_DIGEST_LEN 16
 
+/* Implemented by the primary PLCrashReport implementation */
+@interface PLCrashReport (InternalInitializers)
+- (id) initWithData: (NSData *) encodedData
+            options: (PLCrashReportDecodingOptions) options
+              arena: (plcrash_report_arena_t *) arena
+        stringTable: (PLCrashReportStringTable *) strings
+              error: (NSError **) outError;
+@end
+
 @interface PLCrashReport (PrivateMethods)
 
-- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data error: (NSError **) outError;
+- (NSString *) stringWithUTF8String: (const char *) string;
+- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data lazy: (BOOL) lazy error: (NSError **) outError;
 - (PLCrashReportSystemInfo *) extractSystemInfo: (Plcrash__CrashReport__SystemInfo *) systemInfo error: (NSError **) outError;
 - (PLCrashReportProcessorInfo *) extractProcessorInfo: (Plcrash__CrashReport__Processor *) processorInfo error: (NSError **) outError;
 - (PLCrashReportMachineInfo *) extractMachineInfo: (Plcrash__CrashReport__MachineInfo *) machineInfo error: (NSError **) outError;
 - (PLCrashReportApplicationInfo *) extractApplicationInfo: (Plcrash__CrashReport__ApplicationInfo *) applicationInfo error: (NSError **) outError;
 - (PLCrashReportProcessInfo *) extractProcessInfo: (Plcrash__CrashReport__ProcessInfo *) processInfo error: (NSError **) outError;
+- (BOOL) extractRegisterState: (Plcrash__CrashReport__Thread__RegisterState *) state registers: (NSMutableArray *) registers error: (NSError **) outError;
 - (NSArray *) extractThreadInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError;
+- (BOOL) resolveStackFrame: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame imageOffset: (uint64_t *) imageOffset pc: (uint64_t *) outPC error: (NSError **) outError;
+- (BOOL) appendStackFrame: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame toTable: (PLCrashReportFrameTable *) table imageOffset: (uint64_t *) imageOffset error: (NSError **) outError;
 - (NSArray *) extractImageInfo: (Plcrash__CrashReport *) crashReport error: (NSError **) outError;
+- (NSArray *) extractDeferredRecords: (plcrash_report_range_list_t *) list descriptor: (const ProtobufCMessageDescriptor *) descriptor;
 - (PLCrashReportExceptionInfo *) extractExceptionInfo: (Plcrash__CrashReport__Exception *) exceptionInfo error: (NSError **) outError;
 - (PLCrashReportSignalInfo *) extractSignalInfo: (Plcrash__CrashReport__Signal *) signalInfo error: (NSError **) outError;
 - (PLCrashReportMachExceptionInfo *) extractMachExceptionInfo: (Plcrash__CrashReport__Signal__MachException *) machExceptionInfo error: (NSError **) outError;
+- (NSArray *) extractBreadcrumbs: (Plcrash__CrashReport__Breadcrumbs *) breadcrumbs error: (NSError **) outError;
+- (NSArray *) extractDebugTrace: (Plcrash__CrashReport__DebugTrace *) debugTrace error: (NSError **) outError;
+- (PLCrashReportHangInfo *) extractHangInfo: (Plcrash__CrashReport__Hang *) hang error: (NSError **) outError;
+- (PLCrashReportMemoryInfo *) extractMemoryInfo: (Plcrash__CrashReport__Memory *) memory error: (NSError **) outError;
+- (PLCrashReportTerminationInfo *) extractTerminationInfo: (Plcrash__CrashReport__Termination *) termination error: (NSError **) outError;
+- (NSArray *) extractUserRegions: (Plcrash__CrashReport__UserRegion **) regions count: (size_t) count error: (NSError **) outError;
 
 @end
 
 
 static void populate_nserror (NSError **error, PLCrashReporterError code, NSString *description);
+static int pl_image_index_compare (const void *a, const void *b);
+static BOOL pl_check_header (NSData *data, NSError **outError);
+static PLCrashReportType pl_report_type (Plcrash__CrashReport *crashReport);
+static PLCrashReportUnwindMethod pl_stack_frame_unwind_method (Plcrash__CrashReport__Thread__StackFrame *stackFrame);
+static NSData *pl_decompress_report (NSData *data, NSError **outError);
+static NSData *pl_salvage_report (NSData *data, BOOL *salvaged);
+static void pl_decoder_release_arena (_PLCrashReportDecoder *decoder);
+
+/**
+ * @internal
+ *
+ * Shared batch decoding state (see +[PLCrashReport reportsWithDataArray:options:errors:]). Each worker claims
+ * inputs by atomically incrementing @a next, and writes only to the result slots of the inputs it has claimed.
+ */
+typedef struct pl_batch_decode {
+    /** The encoded reports. */
+    NSArray *inputs;
+
+    /** Decoding options. */
+    PLCrashReportDecodingOptions options;
+
+    /** Shared string table. */
+    PLCrashReportStringTable *strings;
+
+    /** Decoded (retained) reports, or nil if decoding failed. */
+    PLCrashReport **reports;
+
+    /** Decoding (retained) errors, for reports that could not be decoded. */
+    NSError **errors;
+
+    /** Index of the next unclaimed input. */
+    volatile int32_t next;
+} pl_batch_decode_t;
+
+/**
+ * @internal
+ *
+ * Batch decoding worker; claims and decodes inputs until none remain.
+ */
+static void *pl_batch_decode_worker (void *arg) {
+    pl_batch_decode_t *ctx = arg;
+    plcrash_report_arena_t *arena = NULL;
+    NSUInteger count = [ctx->inputs count];
+
+    while (true) {
+        int32_t idx = OSAtomicIncrement32Barrier(&ctx->next) - 1;
+        if ((NSUInteger) idx >= count)
+            break;
+
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSData *data = [ctx->inputs objectAtIndex: idx];
+        NSError *error = nil;
+
+        /* The worker's arena is sized by its first report, and grows to fit the largest; if it can't be allocated,
+         * a shared arena is used instead. */
+        if (arena == NULL)
+            arena = plcrash_report_arena_new(plcrash_report_arena_size_hint([data length]));
+
+        ctx->reports[idx] = [[PLCrashReport alloc] initWithData: data options: ctx->options arena: arena stringTable: ctx->strings error: &error];
+        if (ctx->reports[idx] == nil)
+            ctx->errors[idx] = [error retain];
+
+        [pool release];
+    }
+
+    if (arena != NULL)
+        plcrash_report_arena_free(arena);
+
+    return NULL;
+}
 
 /**
  * Provides decoding of crash logs generated by the PLCrashReporter framework.
@@ -72,11 +225,76 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
  * indicating why the crash log could not be parsed. If no error occurs, this parameter
  * will be left unmodified. You may specify NULL for this parameter, and no error information
  * will be provided.
+ */
+- (id) initWithData: (NSData *) encodedData error: (NSError **) outError {
+    return [self initWithData: encodedData options: PLCrashReportDecodingOptionNone error: outError];
+}
+
+/**
+ * Initialize with the provided crash log data and decoding options. On error, nil will be returned, and
+ * an NSError instance will be provided via @a error, if non-NULL.
+ *
+ * @param encodedData Encoded plcrash crash log. If PLCrashReportDecodingOptionLazy is specified, this data will
+ * be retained, and must not be mutated, for the lifetime of the report.
+ * @param options The decoding options.
+ * @param outError If an error occurs, this pointer will contain an NSError object
+ * indicating why the crash log could not be parsed. If no error occurs, this parameter
+ * will be left unmodified. You may specify NULL for this parameter, and no error information
+ * will be provided.
+ *
+ */
+- (id) initWithData: (NSData *) encodedData options: (PLCrashReportDecodingOptions) options error: (NSError **) outError {
+    return [self initWithData: encodedData options: options arena: NULL stringTable: nil error: outError];
+}
+
+/**
+ * @internal
+ *
+ * Initialize with the provided crash log data and decoding options, using the given decoding @a arena and
+ * string table.
+ *
+ * @param encodedData Encoded plcrash crash log.
+ * @param options The decoding options.
+ * @param arena The arena to be used to unpack the report, or NULL to acquire a shared arena. The arena is reset
+ * once initialization completes, and must not be used concurrently.
+ * @param strings The table used to intern decoded strings, or nil. The table is retained for the lifetime of
+ * the report, and is also used by lazily decoded records.
+ * @param outError If an error occurs, this pointer will contain an NSError object
+ * indicating why the crash log could not be parsed. If no error occurs, this parameter
+ * will be left unmodified. You may specify NULL for this parameter, and no error information
+ * will be provided.
  *
  * @par Designated Initializer
  * This method is the designated initializer for the PLCrashReport class.
  */
-- (id) initWithData: (NSData *) encodedData error: (NSError **) outError {
+- (id) initWithData: (NSData *) encodedData
+            options: (PLCrashReportDecodingOptions) options
+              arena: (plcrash_report_arena_t *) arena
+        stringTable: (PLCrashReportStringTable *) strings
+              error: (NSError **) outError
+{
+    BOOL lazy = (options & PLCrashReportDecodingOptionLazy) != 0;
+
+    /* Decompress compressed reports; the decompressed report is decoded in place of the encoded data */
+    encodedData = pl_decompress_report(encodedData, outError);
+    if (encodedData == nil) {
+        [self release];
+        return nil;
+    }
+
+    /* Discard any incomplete trailing records */
+    BOOL salvaged = NO;
+    if (options & PLCrashReportDecodingOptionSalvage)
+        encodedData = pl_salvage_report(encodedData, &salvaged);
+
+    /* Compact frames reference the report's binary images, and compact images reference the report's string table;
+     * compact reports are always decoded eagerly. */
+    if ([encodedData length] > sizeof(struct PLCrashReportFileHeader) &&
+        (((const struct PLCrashReportFileHeader *) [encodedData bytes])->version & ~PLCRASH_REPORT_FILE_FLAG_FOOTER) == PLCRASH_REPORT_FILE_VERSION_COMPACT)
+    {
+        lazy = NO;
+    }
+
     if ((self = [super init]) == nil) {
         // This shouldn't happen, but we have to fufill our API contract
         populate_nserror(outError, PLCrashReporterErrorUnknown, @"Could not initialize superclass");
@@ -85,8 +303,13 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
 
 
     /* Allocate the struct and attempt to parse */
-    _decoder = malloc(sizeof(_PLCrashReportDecoder));
-    _decoder->crashReport = [self decodeCrashData: encodedData error: outError];
+    _decoder = calloc(1, sizeof(_PLCrashReportDecoder));
+    _decoder->arena = arena;
+    _decoder->arenaBorrowed = (arena != NULL);
+    _decoder->strings = [strings retain];
+    if (strings == nil)
+        _decoder->stringPool = plcrash_report_string_pool_new();
+    _decoder->crashReport = [self decodeCrashData: encodedData lazy: lazy error: outError];
 
     /* Check if decoding failed. If so, outError has already been populated. */
     if (_decoder->crashReport == NULL) {
@@ -110,8 +333,20 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
             memcpy(&uuid_bytes, _decoder->crashReport->report_info->uuid.data, _decoder->crashReport->report_info->uuid.len);
             _uuid = CFUUIDCreateFromUUIDBytes(NULL, uuid_bytes);
         }
+
+        /* Truncation flag (optional) */
+        if (_decoder->crashReport->report_info->has_truncated)
+            _truncated = _decoder->crashReport->report_info->truncated;
     }
 
+    if (salvaged)
+        _truncated = YES;
+
+    /* Report type. Watchdog summaries omit the data not used in analyzing hangs. */
+    _reportType = pl_report_type(_decoder->crashReport);
+    BOOL summary = (options & PLCrashReportDecodingOptionWatchdogSummary) != 0 && _reportType == PLCrashReportTypeWatchdog;
+    _decoder->skipRegisters = summary;
+
     /* System info */
     _systemInfo = [[self extractSystemInfo: _decoder->crashReport->system_info error: outError] retain];
     if (!_systemInfo)
@@ -149,13 +384,14 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
             goto error;
     }
 
-    /* Thread info */
-    _threads = [[self extractThreadInfo: _decoder->crashReport error: outError] retain];
-    if (!_threads) _threads = [[NSArray alloc] init];
+    /* Thread and image info. When decoding lazily, these are extracted on first access. */
+    if (!lazy) {
+        _threads = [[self extractThreadInfo: _decoder->crashReport error: outError] retain];
+        if (!_threads) _threads = [[NSArray alloc] init];
 
-    /* Image info */
-    _images = [[self extractImageInfo: _decoder->crashReport error: outError] retain];
-    if (!_images) _images = [[NSArray alloc] init];
+        _images = [[self extractImageInfo: _decoder->crashReport error: outError] retain];
+        if (!_images) _images = [[NSArray alloc] init];
+    }
 
     /* Exception info, if it is available */
     if (_decoder->crashReport->exception != NULL) {
@@ -164,6 +400,54 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
             goto error;
     }
 
+    /* Breadcrumbs (optional) */
+    if (_decoder->crashReport->breadcrumbs != NULL && !summary) {
+        _breadcrumbs = [[self extractBreadcrumbs: _decoder->crashReport->breadcrumbs error: outError] retain];
+        if (!_breadcrumbs)
+            goto error;
+    } else {
+        _breadcrumbs = [[NSArray alloc] init];
+    }
+
+    /* Debug trace (optional) */
+    if (_decoder->crashReport->debug_trace != NULL && !summary) {
+        _debugTrace = [[self extractDebugTrace: _decoder->crashReport->debug_trace error: outError] retain];
+        if (!_debugTrace)
+            goto error;
+    } else {
+        _debugTrace = [[NSArray alloc] init];
+    }
+
+    /* Hang info (optional) */
+    if (_decoder->crashReport->hang != NULL) {
+        _hangInfo = [[self extractHangInfo: _decoder->crashReport->hang error: outError] retain];
+        if (!_hangInfo)
+            goto error;
+    }
+
+    /* Memory info (optional) */
+    if (_decoder->crashReport->memory != NULL) {
+        _memoryInfo = [[self extractMemoryInfo: _decoder->crashReport->memory error: outError] retain];
+        if (!_memoryInfo)
+            goto error;
+    }
+
+    /* Termination info (optional) */
+    if (_decoder->crashReport->termination != NULL) {
+        _terminationInfo = [[self extractTerminationInfo: _decoder->crashReport->termination error: outError] retain];
+        if (!_terminationInfo)
+            goto error;
+    }
+
+    /* User regions (optional) */
+    _userRegions = [[self extractUserRegions: _decoder->crashReport->user_regions count: _decoder->crashReport->n_user_regions error: outError] retain];
+    if (!_userRegions)
+        goto error;
+
+    /* All values have been extracted; the unpacked report is no longer required, and its arena may be reused. */
+    _decoder->crashReport = NULL;
+    pl_decoder_release_arena(_decoder);
+
     return self;
 
 error:
@@ -180,17 +464,31 @@ error:
     if (_signalInfo) [_signalInfo release];
     [_machExceptionInfo release];
     [_threads release];
+    [_crashedThread release];
     [_images release];
     [_exceptionInfo release];
+    [_breadcrumbs release];
+    [_debugTrace release];
+    [_hangInfo release];
+    [_memoryInfo release];
+    [_terminationInfo release];
+    [_userRegions release];
     
     if (_uuid != NULL)
         CFRelease(_uuid);
 
     /* Free the decoder state */
     if (_decoder != NULL) {
-        if (_decoder->crashReport != NULL) {
-            protobuf_c_message_free_unpacked((ProtobufCMessage *) _decoder->crashReport, &protobuf_c_system_allocator);
-        }
+        /* The unpacked report, if any, is freed along with its arena */
+        pl_decoder_release_arena(_decoder);
+
+        [_decoder->encodedData release];
+        [_decoder->strings release];
+        if (_decoder->stringPool != NULL)
+            plcrash_report_string_pool_release(_decoder->stringPool);
+        plcrash_report_range_list_free(&_decoder->threadRanges);
+        plcrash_report_range_list_free(&_decoder->imageRanges);
+        free(_decoder->imageIndex);
 
         free(_decoder);
         _decoder = NULL;
@@ -199,6 +497,176 @@ error:
     [super dealloc];
 }
 
+/**
+ * Decode all of the provided crash logs, concurrently.
+ *
+ * Reports are decoded by a pool of worker threads sized to the number of available CPUs. Each worker unpacks its
+ * reports using a private decoding arena, and strings repeated across reports -- such as image paths, process
+ * paths, and OS versions -- are interned in a table shared by all reports in the batch, reducing the memory
+ * required to hold a large number of decoded reports.
+ *
+ * The returned reports are immutable, and may be safely accessed from multiple threads.
+ *
+ * @param dataArray An array of NSData instances, each containing an encoded plcrash crash log. The array and its
+ * contents must not be mutated while decoding. If PLCrashReportDecodingOptionLazy is specified, the data will be
+ * retained, and must not be mutated, for the lifetime of the corresponding report.
+ * @param options The decoding options to be used for all reports.
+ * @param outErrors If non-NULL, this pointer will be set to an array containing, for each input, either the NSError
+ * describing why the corresponding report could not be decoded, or NSNull if decoding succeeded.
+ *
+ * @return Returns an array containing, for each input, either the decoded PLCrashReport, or NSNull if the report
+ * could not be decoded.
+ */
++ (NSArray *) reportsWithDataArray: (NSArray *) dataArray options: (PLCrashReportDecodingOptions) options errors: (NSArray **) outErrors {
+    NSUInteger count = [dataArray count];
+    pl_batch_decode_t ctx;
+
+    ctx.inputs = dataArray;
+    ctx.options = options;
+    ctx.strings = [[PLCrashReportStringTable alloc] init];
+    ctx.reports = calloc(count + 1, sizeof(ctx.reports[0]));
+    ctx.errors = calloc(count + 1, sizeof(ctx.errors[0]));
+    ctx.next = 0;
+
+    /* The calling thread also acts as a worker */
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    if (workers < 1)
+        workers = 1;
+    if ((NSUInteger) workers > count)
+        workers = (long) (count > 0 ? count : 1);
+
+    pthread_t *threads = calloc(workers, sizeof(pthread_t));
+    long started = 0;
+    for (long i = 1; i < workers; i++) {
+        if (pthread_create(&threads[started], NULL, pl_batch_decode_worker, &ctx) != 0)
+            break;
+        started++;
+    }
+
+    pl_batch_decode_worker(&ctx);
+
+    for (long i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    /* Gather the results */
+    NSMutableArray *reports = [NSMutableArray arrayWithCapacity: count];
+    NSMutableArray *errors = outErrors != NULL ? [NSMutableArray arrayWithCapacity: count] : nil;
+
+    for (NSUInteger i = 0; i < count; i++) {
+        if (ctx.reports[i] != nil) {
+            [reports addObject: ctx.reports[i]];
+            [errors addObject: [NSNull null]];
+            [ctx.reports[i] release];
+        } else {
+            [reports addObject: [NSNull null]];
+            [errors addObject: ctx.errors[i] != nil ? (id) ctx.errors[i] : (id) [NSNull null]];
+            [ctx.errors[i] release];
+        }
+    }
+
+    free(ctx.reports);
+    free(ctx.errors);
+    [ctx.strings release];
+
+    if (outErrors != NULL)
+        *outErrors = errors;
+
+    return reports;
+}
+
+/**
+ * Compute a crash bucketing fingerprint directly from the provided crash log data, without decoding the report.
+ *
+ * The fingerprint covers the top @a frameCount frames of the crashed thread, each identified by its containing
+ * image's UUID and its image-relative PC, as well as the signal name and code, Mach exception type, and uncaught
+ * exception name. Values that vary between otherwise identical crashes, such as image load addresses and exception
+ * reasons, are excluded. Reports with equal fingerprints may be considered duplicates.
+ *
+ * If the report was written with a section footer, only the records listed for the crashed thread, signal, exception
+ * and binary images are read; otherwise, the full report is scanned. The result is the same in either case.
+ *
+ * @param encodedData Encoded plcrash crash log.
+ * @param frameCount The maximum number of crashed thread frames to include in the fingerprint.
+ * @param outError If an error occurs, this pointer will contain an NSError object
+ * indicating why the fingerprint could not be computed. If no error occurs, this parameter
+ * will be left unmodified. You may specify NULL for this parameter, and no error information
+ * will be provided.
+ *
+ * @return Returns an opaque fingerprint value on success, or nil on failure.
+ */
++ (NSData *) fingerprintForData: (NSData *) encodedData frameCount: (NSUInteger) frameCount error: (NSError **) outError {
+    plcrash_report_footer_t footer;
+    size_t reportLength;
+    uint64_t fingerprint;
+    plcrash_error_t err;
+
+    /* The footer is discarded on decompression, and must be read first */
+    BOOL hasFooter = plcrash_report_reader_read_footer([encodedData bytes], [encodedData length], &footer, &reportLength) == PLCRASH_ESUCCESS;
+
+    encodedData = pl_decompress_report(encodedData, outError);
+    if (encodedData == nil)
+        return nil;
+
+    const struct PLCrashReportFileHeader *header = [encodedData bytes];
+    if (!pl_check_header(encodedData, outError))
+        return nil;
+
+    if (hasFooter)
+        err = plcrash_report_fingerprint_footer(header->data, [encodedData length] - sizeof(*header), &footer, frameCount, &fingerprint);
+    else
+        err = plcrash_report_fingerprint(header->data, [encodedData length] - sizeof(*header), frameCount, &fingerprint);
+
+    if (err != PLCRASH_ESUCCESS) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode malformed crash report",
+                                                                                             @"Crash log decoding error message"));
+        return nil;
+    }
+
+    /* Use a fixed byte order, such that fingerprints may be compared across hosts */
+    fingerprint = OSSwapHostToBigInt64(fingerprint);
+    return [NSData dataWithBytes: &fingerprint length: sizeof(fingerprint)];
+}
+
+/**
+ * Verify the integrity of the provided crash log data against the checksum written at the end of the report,
+ * without decoding the report. This may be used to cheaply reject reports that were truncated or corrupted in
+ * storage or transit.
+ *
+ * Reports written by earlier versions of the library do not include a checksum, and can't be validated.
+ *
+ * @param encodedData Encoded plcrash crash log.
+ * @param outError If the report fails validation, this pointer will contain an NSError object indicating why the
+ * report is invalid. If no error occurs, this parameter will be left unmodified. You may specify NULL for this
+ * parameter, and no error information will be provided.
+ *
+ * @return Returns YES if the report's checksum is present and correct, or NO otherwise.
+ */
++ (BOOL) validateData: (NSData *) encodedData error: (NSError **) outError {
+    /* Compressed reports are checksummed prior to compression */
+    encodedData = pl_decompress_report(encodedData, outError);
+    if (encodedData == nil)
+        return NO;
+
+    if (!pl_check_header(encodedData, outError))
+        return NO;
+
+    switch (plcrash_report_reader_validate([encodedData bytes], [encodedData length])) {
+        case PLCRASH_ESUCCESS:
+            return YES;
+
+        case PLCRASH_ENOTFOUND:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"The crash report is truncated, or does not include a checksum",
+                                                                                                 @"Crash log validation error message"));
+            return NO;
+
+        default:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"The crash report checksum does not match its contents",
+                                                                                                 @"Crash log validation error message"));
+            return NO;
+    }
+}
+
 /**
  * Return the binary image containing the given address, or nil if no binary image
  * is found.
@@ -206,15 +674,113 @@ error:
  * @param address The address to search for.
  */
 - (PLCrashReportBinaryImageInfo *) imageForAddress: (uint64_t) address {
-    for (PLCrashReportBinaryImageInfo *imageInfo in self.images) {
-        if (imageInfo.imageBaseAddress <= address && address < (imageInfo.imageBaseAddress + imageInfo.imageSize))
-            return imageInfo;
+    pl_image_index_entry_t *index;
+    size_t count;
+
+    /* Build the sorted index on first use */
+    NSArray *images = self.images;
+    @synchronized (self) {
+        if (_decoder->imageIndex == NULL && [images count] > 0) {
+            index = malloc(sizeof(*index) * [images count]);
+            if (index == NULL)
+                return nil;
+
+            count = 0;
+            for (PLCrashReportBinaryImageInfo *imageInfo in images) {
+                index[count].base = imageInfo.imageBaseAddress;
+                index[count].end = imageInfo.imageBaseAddress + imageInfo.imageSize;
+                index[count].image = imageInfo;
+                count++;
+            }
+
+            qsort(index, count, sizeof(*index), pl_image_index_compare);
+            _decoder->imageIndexCount = count;
+            _decoder->imageIndex = index;
+        }
+
+        index = _decoder->imageIndex;
+        count = _decoder->imageIndexCount;
+    }
+
+    /* Find the last image with a base address <= address. */
+    size_t lower = 0;
+    size_t upper = count;
+    while (lower < upper) {
+        size_t mid = lower + (upper - lower) / 2;
+        if (index[mid].base <= address)
+            lower = mid + 1;
+        else
+            upper = mid;
     }
 
+    /* Images do not overlap; only the nearest preceding image may contain the address */
+    if (lower > 0 && address < index[lower - 1].end)
+        return index[lower - 1].image;
+
     /* Not found */
     return nil;
 }
 
+// property getter. Decodes deferred thread records on first access.
+- (NSArray *) threads {
+    @synchronized (self) {
+        if (_threads == nil) {
+            _threads = [[self extractDeferredRecords: &_decoder->threadRanges
+                                          descriptor: &plcrash__crash_report__thread__descriptor] retain];
+        }
+        return _threads;
+    }
+}
+
+// property getter. When decoding lazily, decodes only the crashed thread's record, unless all thread records have
+// already been decoded.
+- (PLCrashReportThreadInfo *) crashedThread {
+    @synchronized (self) {
+        if (_crashedThreadResolved)
+            return _crashedThread;
+
+        if (_threads == nil && _decoder->encodedData != nil) {
+            const uint8_t *message = (const uint8_t *) [_decoder->encodedData bytes] + sizeof(struct PLCrashReportFileHeader);
+
+            /* Find the first crashed thread record, and decode it alone */
+            for (size_t i = 0; i < _decoder->threadRanges.count; i++) {
+                plcrash_report_range_t *range = &_decoder->threadRanges.ranges[i];
+                bool crashed;
+
+                if (!plcrash_report_thread_crashed(range->length, message + range->offset, &crashed) || !crashed)
+                    continue;
+
+                plcrash_report_range_list_t list = { .ranges = range, .count = 1, .capacity = 1 };
+                NSArray *threads = [self extractDeferredRecords: &list descriptor: &plcrash__crash_report__thread__descriptor];
+                if ([threads count] > 0)
+                    _crashedThread = [[threads objectAtIndex: 0] retain];
+                break;
+            }
+        } else {
+            for (PLCrashReportThreadInfo *thread in self.threads) {
+                if (thread.crashed) {
+                    _crashedThread = [thread retain];
+                    break;
+                }
+            }
+        }
+
+        _crashedThreadResolved = YES;
+        return _crashedThread;
+    }
+}
+
+// property getter. Decodes deferred binary image records on first access.
+- (NSArray *) images {
+    @synchronized (self) {
+        if (_images == nil) {
+            _images = [[self extractDeferredRecords: &_decoder->imageRanges
+                                         descriptor: &plcrash__crash_report__binary_image__descriptor] retain];
+        }
+        return _images;
+    }
+}
+
 // property getter. Returns YES if machine information is available.
 - (BOOL) hasMachineInfo {
     if (_machineInfo != nil)
@@ -242,10 +808,16 @@ error:
 @synthesize processInfo = _processInfo;
 @synthesize signalInfo = _signalInfo;
 @synthesize machExceptionInfo = _machExceptionInfo;
-@synthesize threads = _threads;
-@synthesize images = _images;
 @synthesize exceptionInfo = _exceptionInfo;
 @synthesize uuidRef = _uuid;
+@synthesize truncated = _truncated;
+@synthesize reportType = _reportType;
+@synthesize breadcrumbs = _breadcrumbs;
+@synthesize debugTrace = _debugTrace;
+@synthesize hangInfo = _hangInfo;
+@synthesize memoryInfo = _memoryInfo;
+@synthesize terminationInfo = _terminationInfo;
+@synthesize userRegions = _userRegions;
 
 @end
 
@@ -257,46 +829,123 @@ error:
 @implementation PLCrashReport (PrivateMethods)
 
 /**
- * Decode the crash log message.
- *
- * @warning MEMORY WARNING. The caller is responsible for deallocating th ePlcrash__CrashReport instance
- * returned by this method via protobuf_c_message_free_unpacked().
+ * Return a string for the given decoded UTF-8 @a string, interned via the decoder's string table if available.
+ * Otherwise, strings that were decoded into the decoder's string pool are bridged without copying.
  */
-- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data error: (NSError **) outError {
-    const struct PLCrashReportFileHeader *header;
-    const void *bytes;
+- (NSString *) stringWithUTF8String: (const char *) string {
+    if (_decoder->strings != nil)
+        return [_decoder->strings stringWithUTF8String: string];
 
-    bytes = [data bytes];
-    header = bytes;
+    if (_decoder->stringPool != NULL)
+        return [(NSString *) plcrash_report_string_pool_create_string(_decoder->stringPool, string) autorelease];
 
-    /* Verify that the crash log is sufficently large */
-    if (sizeof(struct PLCrashReportFileHeader) >= [data length]) {
-        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode truncated crash log",
-                                                                                             @"Crash log decoding error message"));
-        return NULL;
-    }
+    return [NSString stringWithUTF8String: string];
+}
 
-    /* Check the file magic */
-    if (memcmp(header->magic, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) != 0) {
-        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,NSLocalizedString(@"Could not decode invalid crash log header",
-                                                                                            @"Crash log decoding error message"));
+/**
+ * Decode the crash log message. The returned message is allocated from an arena, which is saved in the
+ * decoder state.
+ *
+ * The top-level thread and binary image records are split from the remainder of the message, which is unpacked
+ * by protobuf-c; the split records are decoded with the specialized record decoders (see
+ * plcrash_report_record_decoder).
+ *
+ * If @a lazy is true, the thread and binary image records are not decoded; their encoded byte ranges are instead
+ * recorded in the decoder state, and @a data is retained for later decoding by extractDeferredRecords:descriptor:.
+ *
+ * @warning MEMORY WARNING. The returned Plcrash__CrashReport instance is only valid until the decoder's arena
+ * is released.
+ */
+- (Plcrash__CrashReport *) decodeCrashData: (NSData *) data lazy: (BOOL) lazy error: (NSError **) outError {
+    const struct PLCrashReportFileHeader *header = [data bytes];
+
+    /* Verify the file header */
+    if (!pl_check_header(data, outError))
         return NULL;
+
+    const uint8_t *message = header->data;
+    size_t messageLength = [data length] - sizeof(struct PLCrashReportFileHeader);
+    plcrash_report_range_list_t threadRanges = { NULL, 0, 0 };
+    plcrash_report_range_list_t imageRanges = { NULL, 0, 0 };
+    Plcrash__CrashReport *crashReport = NULL;
+    ProtobufCAllocator *allocator;
+    NSMutableData *core;
+    size_t coreLength;
+
+    /* Strip the thread and image records from the message before unpacking the remainder. If decoding lazily, the
+     * record ranges are saved for later decoding. */
+    core = [NSMutableData dataWithLength: messageLength];
+    if (lazy) {
+        if (plcrash_report_reader_split(message, messageLength, [core mutableBytes], &coreLength, &_decoder->threadRanges, &_decoder->imageRanges) != PLCRASH_ESUCCESS)
+            goto malformed;
+
+        _decoder->encodedData = [data retain];
+    } else {
+        if (plcrash_report_reader_split(message, messageLength, [core mutableBytes], &coreLength, &threadRanges, &imageRanges) != PLCRASH_ESUCCESS)
+            goto malformed;
     }
+    [core setLength: coreLength];
 
-    /* Check the version */
-    if(header->version != PLCRASH_REPORT_FILE_VERSION) {
-        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, [NSString stringWithFormat: NSLocalizedString(@"Could not decode unsupported crash report version: %d", 
-                                                                                                                         @"Crash log decoding message"), header->version]);
-        return NULL;
+    /* Size the arena for everything that will be decoded now */
+    if (_decoder->arena == NULL)
+        _decoder->arena = plcrash_report_arena_acquire(plcrash_report_arena_size_hint(lazy ? [core length] : messageLength));
+
+    if (_decoder->arena == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorOperatingSystem, NSLocalizedString(@"Could not allocate memory to decode the crash report",
+                                                                                          @"Crash log decoding error message"));
+        goto cleanup;
     }
+    allocator = plcrash_report_arena_allocator(_decoder->arena);
 
-    Plcrash__CrashReport *crashReport = plcrash__crash_report__unpack(&protobuf_c_system_allocator, [data length] - sizeof(struct PLCrashReportFileHeader), header->data);
+    crashReport = plcrash__crash_report__unpack(allocator, [core length], [core bytes]);
     if (crashReport == NULL) {
         populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"An unknown error occured decoding the crash report", 
                                                                                              @"Crash log decoding error message"));
-        return NULL;
+        goto cleanup;
+    }
+
+    /* Decode the split records */
+    if (threadRanges.count > 0) {
+        crashReport->threads = allocator->alloc(allocator->allocator_data, threadRanges.count * sizeof(*crashReport->threads));
+        if (crashReport->threads == NULL) {
+            crashReport = NULL;
+            goto malformed;
+        }
+        for (size_t i = 0; i < threadRanges.count; i++) {
+            plcrash_report_range_t *range = &threadRanges.ranges[i];
+            if ((crashReport->threads[i] = plcrash_report_decode_thread(allocator, _decoder->stringPool, range->length, message + range->offset)) == NULL) {
+                crashReport = NULL;
+                goto malformed;
+            }
+            crashReport->n_threads++;
+        }
+    }
+
+    if (imageRanges.count > 0) {
+        crashReport->binary_images = allocator->alloc(allocator->allocator_data, imageRanges.count * sizeof(*crashReport->binary_images));
+        if (crashReport->binary_images == NULL) {
+            crashReport = NULL;
+            goto malformed;
+        }
+        for (size_t i = 0; i < imageRanges.count; i++) {
+            plcrash_report_range_t *range = &imageRanges.ranges[i];
+            if ((crashReport->binary_images[i] = plcrash_report_decode_binary_image(allocator, _decoder->stringPool, range->length, message + range->offset)) == NULL) {
+                crashReport = NULL;
+                goto malformed;
+            }
+            crashReport->n_binary_images++;
+        }
     }
 
+    goto cleanup;
+
+malformed:
+    populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode malformed crash report",
+                                                                                         @"Crash log decoding error message"));
+
+cleanup:
+    plcrash_report_range_list_free(&threadRanges);
+    plcrash_report_range_list_free(&imageRanges);
     return crashReport;
 }
 
@@ -325,7 +974,7 @@ error:
 
     /* Set up the build, if available */
     if (systemInfo->os_build != NULL)
-        osBuild = [NSString stringWithUTF8String: systemInfo->os_build];
+        osBuild = [self stringWithUTF8String: systemInfo->os_build];
     
     /* Set up the timestamp, if available */
     if (systemInfo->timestamp != 0)
@@ -333,7 +982,7 @@ error:
     
     /* Done */
     return [[[PLCrashReportSystemInfo alloc] initWithOperatingSystem: (PLCrashReportOperatingSystem) systemInfo->operating_system
-                                              operatingSystemVersion: [NSString stringWithUTF8String: systemInfo->os_version]
+                                              operatingSystemVersion: [self stringWithUTF8String: systemInfo->os_version]
                                                 operatingSystemBuild: osBuild
                                                         architecture: (PLCrashReportArchitecture) systemInfo->architecture
                                                            timestamp: timestamp] autorelease];
@@ -373,7 +1022,7 @@ error:
 
     /* Set up the model, if available */
     if (machineInfo->model != NULL)
-        model = [NSString stringWithUTF8String: machineInfo->model];
+        model = [self stringWithUTF8String: machineInfo->model];
 
     /* Set up the processor info. */
     if (machineInfo->processor != NULL) {
@@ -420,8 +1069,8 @@ error:
     }
     
     /* Done */
-    NSString *identifier = [NSString stringWithUTF8String: applicationInfo->identifier];
-    NSString *version = [NSString stringWithUTF8String: applicationInfo->version];
+    NSString *identifier = [self stringWithUTF8String: applicationInfo->identifier];
+    NSString *version = [self stringWithUTF8String: applicationInfo->version];
 
     return [[[PLCrashReportApplicationInfo alloc] initWithApplicationIdentifier: identifier
                                                           applicationVersion: version] autorelease];
@@ -445,12 +1094,12 @@ error:
     /* Name available? */
     NSString *processName = nil;
     if (processInfo->process_name != NULL)
-        processName = [NSString stringWithUTF8String: processInfo->process_name];
+        processName = [self stringWithUTF8String: processInfo->process_name];
     
     /* Path available? */
     NSString *processPath = nil;
     if (processInfo->process_path != NULL)
-        processPath = [NSString stringWithUTF8String: processInfo->process_path];
+        processPath = [self stringWithUTF8String: processInfo->process_path];
 
     /* Start time available? */
     NSDate *startTime = nil;
@@ -460,7 +1109,7 @@ error:
     /* Parent Name available? */
     NSString *parentProcessName = nil;
     if (processInfo->parent_process_name != NULL)
-        parentProcessName = [NSString stringWithUTF8String: processInfo->parent_process_name];
+        parentProcessName = [self stringWithUTF8String: processInfo->parent_process_name];
 
     /* Required elements */
     NSUInteger processID = processInfo->process_id;
@@ -488,7 +1137,7 @@ error:
         return nil;
     }
     
-    NSString *name = [NSString stringWithUTF8String: symbol->name];
+    NSString *name = [self stringWithUTF8String: symbol->name];
     return [[[PLCrashReportSymbolInfo alloc] initWithSymbolName: name
                                                    startAddress: symbol->start_address
                                                      endAddress: symbol->has_end_address ? symbol->end_address : 0] autorelease];
@@ -497,8 +1146,16 @@ error:
 /**
  * Extract stack frame information from the crash log. Returns nil on error, or a PLCrashReportStackFrameInfo
  * instance on success.
+ *
+ * @param stackFrame The frame to be extracted.
+ * @param imageOffset The image-relative offset of the previous compact frame within the same backtrace, or 0 if this
+ * is the first. Updated if @a stackFrame is a compact frame.
+ * @param outError If an error occurs, a pointer to an NSError describing the failure.
  */
-- (PLCrashReportStackFrameInfo *) extractStackFrameInfo: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame error: (NSError **) outError {
+- (PLCrashReportStackFrameInfo *) extractStackFrameInfo: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame
+                                            imageOffset: (uint64_t *) imageOffset
+                                                  error: (NSError **) outError
+{
     /* There should be at least one thread */
     if (stackFrame == NULL) {
 //        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
@@ -513,8 +1170,173 @@ error:
             return NULL;
     }
 
-    return [[[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: stackFrame->pc
-                                                                 symbolInfo: symbolInfo] autorelease];
+    uint64_t pc;
+    if (![self resolveStackFrame: stackFrame imageOffset: imageOffset pc: &pc error: outError])
+        return nil;
+
+    /* Repeated sequences are not expanded */
+    NSUInteger repeatLength = 0;
+    NSUInteger repeatCount = 0;
+    if (stackFrame->has_repeat_length && stackFrame->has_repeat_count && stackFrame->repeat_length > 0) {
+        repeatLength = stackFrame->repeat_length;
+        repeatCount = stackFrame->repeat_count;
+    }
+
+    return [[[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: pc
+                                                                 symbolInfo: symbolInfo
+                                                               repeatLength: repeatLength
+                                                                repeatCount: repeatCount
+                                                          omittedFrameCount: stackFrame->has_omitted_count ? stackFrame->omitted_count : 0
+                                                               unwindMethod: pl_stack_frame_unwind_method(stackFrame)] autorelease];
+}
+
+/**
+ * Determine the PC of @a stackFrame. Returns NO on error.
+ *
+ * @param stackFrame The frame to be resolved.
+ * @param imageOffset The image-relative offset of the previous compact frame within the same backtrace, or 0 if this
+ * is the first. Updated if @a stackFrame is a compact frame.
+ * @param outPC On success, the frame's PC.
+ * @param outError If an error occurs, a pointer to an NSError describing the failure.
+ */
+- (BOOL) resolveStackFrame: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame imageOffset: (uint64_t *) imageOffset pc: (uint64_t *) outPC error: (NSError **) outError {
+    /* Resolve the PC of compact frames against the frame's image */
+    if (stackFrame->has_image_index) {
+        Plcrash__CrashReport *crashReport = _decoder->crashReport;
+        if (crashReport == NULL || stackFrame->image_index >= crashReport->n_binary_images) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid image index in stack frame");
+            return NO;
+        }
+
+        *imageOffset += stackFrame->offset_delta;
+        *outPC = crashReport->binary_images[stackFrame->image_index]->base_address + *imageOffset;
+    } else if (stackFrame->has_pc) {
+        *outPC = stackFrame->pc;
+    } else {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Missing PC in stack frame");
+        return NO;
+    }
+
+    return YES;
+}
+
+/**
+ * Append @a stackFrame to the report's frame @a table. Returns NO on error.
+ *
+ * @param stackFrame The frame to be appended.
+ * @param table The frame table.
+ * @param imageOffset The image-relative offset of the previous compact frame within the same backtrace, or 0 if this
+ * is the first. Updated if @a stackFrame is a compact frame.
+ * @param outError If an error occurs, a pointer to an NSError describing the failure.
+ */
+- (BOOL) appendStackFrame: (Plcrash__CrashReport__Thread__StackFrame *) stackFrame toTable: (PLCrashReportFrameTable *) table imageOffset: (uint64_t *) imageOffset error: (NSError **) outError {
+    uint64_t pc;
+    if (![self resolveStackFrame: stackFrame imageOffset: imageOffset pc: &pc error: outError])
+        return NO;
+
+    uint32_t symbolIndex = PLCrashReportFrameTableNoSymbol;
+    if (stackFrame->symbol != NULL) {
+        Plcrash__CrashReport__Symbol *symbol = stackFrame->symbol;
+        if (symbol->name == NULL) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Missing symbol name in stack frame");
+            return NO;
+        }
+
+        symbolIndex = [table indexForSymbolName: symbol->name
+                                   startAddress: symbol->start_address
+                                     endAddress: symbol->has_end_address ? symbol->end_address : 0];
+        if (symbolIndex == PLCrashReportFrameTableNoSymbol) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid symbol name in stack frame");
+            return NO;
+        }
+    }
+
+    /* Repeated sequences are not expanded */
+    NSUInteger repeatLength = 0;
+    NSUInteger repeatCount = 0;
+    if (stackFrame->has_repeat_length && stackFrame->has_repeat_count && stackFrame->repeat_length > 0) {
+        repeatLength = stackFrame->repeat_length;
+        repeatCount = stackFrame->repeat_count;
+    }
+
+    if (![table appendFrameWithInstructionPointer: pc
+                                      symbolIndex: symbolIndex
+                                     repeatLength: repeatLength
+                                      repeatCount: repeatCount
+                                omittedFrameCount: stackFrame->has_omitted_count ? stackFrame->omitted_count : 0
+                                     unwindMethod: pl_stack_frame_unwind_method(stackFrame)])
+    {
+        populate_nserror(outError, PLCrashReporterErrorOperatingSystem, @"Could not allocate memory to decode the stack frames");
+        return NO;
+    }
+
+    return YES;
+}
+
+/**
+ * Extract the registers of a compact (v2) typed register state, appending a PLCrashReportRegisterInfo instance to
+ * @a registers for each register that is present. Returns NO on error.
+ *
+ * The register sets are fixed messages; each register's name is that of its field, and the fields are ordered by
+ * register number. Any register annotations are matched to their register by field number.
+ */
+- (BOOL) extractRegisterState: (Plcrash__CrashReport__Thread__RegisterState *) state registers: (NSMutableArray *) registers error: (NSError **) outError {
+    const ProtobufCMessage *set = NULL;
+    if (state->x86_32 != NULL) {
+        set = (const ProtobufCMessage *) state->x86_32;
+    } else if (state->x86_64 != NULL) {
+        set = (const ProtobufCMessage *) state->x86_64;
+    } else if (state->arm != NULL) {
+        set = (const ProtobufCMessage *) state->arm;
+    } else if (state->arm64 != NULL) {
+        set = (const ProtobufCMessage *) state->arm64;
+    } else {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Missing register set in register state");
+        return NO;
+    }
+
+    const ProtobufCMessageDescriptor *desc = set->descriptor;
+    for (unsigned i = 0; i < desc->n_fields; i++) {
+        const ProtobufCFieldDescriptor *field = &desc->fields[i];
+        const uint8_t *base = (const uint8_t *) set;
+
+        if (!*(const protobuf_c_boolean *) (base + field->quantifier_offset))
+            continue;
+
+        uint64_t value;
+        switch (field->type) {
+            case PROTOBUF_C_TYPE_UINT32:
+                value = *(const uint32_t *) (base + field->offset);
+                break;
+
+            case PROTOBUF_C_TYPE_UINT64:
+                value = *(const uint64_t *) (base + field->offset);
+                break;
+
+            default:
+                /* Register sets are only composed of unsigned integers */
+                continue;
+        }
+
+        /* Find the register's annotation, if any */
+        Plcrash__CrashReport__Thread__RegisterState__Annotation *annotation = NULL;
+        for (size_t j = 0; j < state->n_annotations; j++) {
+            if ((uint64_t) state->annotations[j]->register_number + 1 == field->id) {
+                annotation = state->annotations[j];
+                break;
+            }
+        }
+
+        PLCrashReportRegisterInfo *regInfo = [[[PLCrashReportRegisterInfo alloc] initWithRegisterName: [NSString stringWithUTF8String: field->name]
+                                                                                        registerValue: value
+                                                                                        hasImageIndex: annotation != NULL
+                                                                                           imageIndex: annotation != NULL ? annotation->image_index : 0
+                                                                                       hasSymbolStart: annotation != NULL && annotation->has_symbol_start
+                                                                                          symbolStart: annotation != NULL ? annotation->symbol_start : 0] autorelease];
+        [registers addObject: regInfo];
+    }
+
+    return YES;
 }
 
 /**
@@ -530,25 +1352,56 @@ error:
         return nil;
     }
 
+    /* The frames of all threads are stored in a single table; the frame instances are only created on request */
+    PLCrashReportFrameTable *frameTable = [[[PLCrashReportFrameTable alloc] initWithStringTable: _decoder->strings stringPool: _decoder->stringPool] autorelease];
+    NSMutableData *frameRanges = [NSMutableData dataWithLength: crashReport->n_threads * sizeof(NSRange)];
+    if (frameTable == nil || frameRanges == nil) {
+        populate_nserror(outError, PLCrashReporterErrorOperatingSystem, @"Could not allocate memory to decode the stack frames");
+        return nil;
+    }
+    NSRange *ranges = [frameRanges mutableBytes];
+
     /* Handle all threads */
     NSMutableArray *threadResult = [NSMutableArray arrayWithCapacity: crashReport->n_threads];
     for (size_t thr_idx = 0; thr_idx < crashReport->n_threads; thr_idx++) {
         Plcrash__CrashReport__Thread *thread = crashReport->threads[thr_idx];
         
-        /* Fetch stack frames for this thread */
-        NSMutableArray *frames = [NSMutableArray arrayWithCapacity: thread->n_frames];
-        for (size_t frame_idx = 0; frame_idx < thread->n_frames; frame_idx++) {
-            Plcrash__CrashReport__Thread__StackFrame *frame = thread->frames[frame_idx];
-            PLCrashReportStackFrameInfo *frameInfo = [self extractStackFrameInfo: frame error: outError];
-            if (frameInfo == nil)
+        /* Fetch stack frames for this thread. Compact reports may reference the identical frames of an earlier thread. */
+        if (thread->has_duplicate_of_thread) {
+            BOOL found = NO;
+            for (size_t earlier = 0; earlier < thr_idx; earlier++) {
+                if (crashReport->threads[earlier]->thread_number == thread->duplicate_of_thread) {
+                    ranges[thr_idx] = ranges[earlier];
+                    found = YES;
+                    break;
+                }
+            }
+
+            if (!found) {
+                populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid duplicate thread reference in thread");
                 return nil;
+            }
+        } else {
+            ranges[thr_idx].location = frameTable.frameCount;
+            uint64_t imageOffset = 0;
+            for (size_t frame_idx = 0; frame_idx < thread->n_frames; frame_idx++) {
+                if (![self appendStackFrame: thread->frames[frame_idx] toTable: frameTable imageOffset: &imageOffset error: outError])
+                    return nil;
+            }
+            ranges[thr_idx].length = frameTable.frameCount - ranges[thr_idx].location;
+        }
 
-            [frames addObject: frameInfo];
+        /* Fetch registers for this thread. Compact reports provide a typed register state in place of the register
+         * list. */
+        size_t registerCount = _decoder->skipRegisters ? 0 : thread->n_registers;
+        NSMutableArray *registers = [NSMutableArray arrayWithCapacity: registerCount];
+        if (thread->register_state != NULL && !_decoder->skipRegisters &&
+            ![self extractRegisterState: thread->register_state registers: registers error: outError])
+        {
+            return nil;
         }
 
-        /* Fetch registers for this thread */
-        NSMutableArray *registers = [NSMutableArray arrayWithCapacity: thread->n_registers];
-        for (size_t reg_idx = 0; reg_idx < thread->n_registers; reg_idx++) {
+        for (size_t reg_idx = 0; reg_idx < registerCount; reg_idx++) {
             Plcrash__CrashReport__Thread__RegisterValue *reg = thread->registers[reg_idx];
             PLCrashReportRegisterInfo *regInfo;
 
@@ -559,18 +1412,50 @@ error:
             }
 
             regInfo = [[[PLCrashReportRegisterInfo alloc] initWithRegisterName: [NSString stringWithUTF8String: reg->name]
-                                                              registerValue: reg->value] autorelease];
+                                                              registerValue: reg->value
+                                                              hasImageIndex: reg->has_image_index
+                                                                 imageIndex: reg->image_index
+                                                             hasSymbolStart: reg->has_symbol_start
+                                                                symbolStart: reg->symbol_start] autorelease];
             [registers addObject: regInfo];
         }
 
+        /* Fetch the scheduling state, if available */
+        PLCrashReportThreadSchedulingInfo *schedulingInfo = nil;
+        if (thread->scheduling != NULL) {
+            Plcrash__CrashReport__Thread__Scheduling *sched = thread->scheduling;
+            NSString *name = nil;
+            if (sched->name != NULL && sched->name[0] != '\0')
+                name = [NSString stringWithUTF8String: sched->name];
+
+            PLCrashReportThreadRunState runState = PLCrashReportThreadRunStateUnknown;
+            if (sched->run_state >= PLCrashReportThreadRunStateRunning && sched->run_state <= PLCrashReportThreadRunStateHalted)
+                runState = (PLCrashReportThreadRunState) sched->run_state;
+
+            schedulingInfo = [[[PLCrashReportThreadSchedulingInfo alloc] initWithUserTime: sched->user_time / 1000000.0
+                                                                               systemTime: sched->system_time / 1000000.0
+                                                                                 cpuUsage: sched->cpu_usage / 1000.0
+                                                                                 runState: runState
+                                                                                sleepTime: sched->sleep_time
+                                                                              hasPriority: sched->has_base_priority && sched->has_current_priority
+                                                                             basePriority: sched->base_priority
+                                                                          currentPriority: sched->current_priority
+                                                                                     name: name
+                                                                              hasQoSClass: sched->has_qos_class
+                                                                                 qosClass: (PLCrashReportThreadQoSClass) sched->qos_class] autorelease];
+        }
+
         /* Create the thread info instance */
         PLCrashReportThreadInfo *threadInfo = [[[PLCrashReportThreadInfo alloc] initWithThreadNumber: thread->thread_number
-                                                                                   stackFrames: frames 
+                                                                                    frameTable: frameTable
+                                                                                    frameRange: ranges[thr_idx]
                                                                                        crashed: thread->crashed 
-                                                                                     registers: registers] autorelease];
+                                                                                     registers: registers
+                                                                                schedulingInfo: schedulingInfo] autorelease];
         [threadResult addObject: threadInfo];
     }
-    
+
+    [frameTable finishAppending];
     return threadResult;
 }
 
@@ -616,11 +1501,24 @@ error:
                 return nil;
         }
 
+        /* Join the image's directory (if any) and name */
+        NSString *name = [self stringWithUTF8String: image->name];
+        if (image->has_directory_index) {
+            if (image->directory_index >= crashReport->n_strings) {
+                populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Invalid directory index in image record");
+                return nil;
+            }
+
+            NSString *directory = [NSString stringWithUTF8String: crashReport->strings[image->directory_index]];
+            name = [NSString stringWithFormat: @"%@/%@", directory, name];
+            if (_decoder->strings != nil)
+                name = [_decoder->strings internString: name];
+        }
 
         imageInfo = [[[PLCrashReportBinaryImageInfo alloc] initWithCodeType: codeType
                                                                 baseAddress: image->base_address
                                                                        size: image->size
-                                                                       name: [NSString stringWithUTF8String: image->name]
+                                                                       name: name
                                                                        uuid: uuid] autorelease];
         [images addObject: imageInfo];
     }
@@ -628,6 +1526,67 @@ error:
     return images;
 }
 
+/**
+ * Decode and extract the deferred thread or binary image records in @a list. Returns an empty array
+ * if the records can not be decoded.
+ *
+ * @param list The deferred record ranges.
+ * @param descriptor The message descriptor of the deferred records; either plcrash__crash_report__thread__descriptor,
+ * or plcrash__crash_report__binary_image__descriptor.
+ */
+- (NSArray *) extractDeferredRecords: (plcrash_report_range_list_t *) list descriptor: (const ProtobufCMessageDescriptor *) descriptor {
+    Plcrash__CrashReport report = PLCRASH__CRASH_REPORT__INIT;
+    plcrash_report_arena_t *arena;
+    ProtobufCAllocator *allocator;
+    NSArray *result = nil;
+    ProtobufCMessage **records;
+    const uint8_t *message;
+    size_t encodedLength = 0;
+
+    /* Nothing to decode if the report was decoded eagerly */
+    if (_decoder->encodedData == nil || list->count == 0)
+        return [NSArray array];
+
+    /* All records are unpacked into a single arena */
+    for (size_t i = 0; i < list->count; i++)
+        encodedLength += list->ranges[i].length;
+
+    if ((arena = plcrash_report_arena_acquire(plcrash_report_arena_size_hint(encodedLength))) == NULL)
+        return [NSArray array];
+    allocator = plcrash_report_arena_allocator(arena);
+
+    message = (const uint8_t *) [_decoder->encodedData bytes] + sizeof(struct PLCrashReportFileHeader);
+    records = allocator->alloc(allocator->allocator_data, list->count * sizeof(*records));
+
+    /* Decode the individual records */
+    for (size_t i = 0; i < list->count; i++) {
+        plcrash_report_range_t *range = &list->ranges[i];
+        records[i] = plcrash_report_decode_record(descriptor, allocator, _decoder->stringPool, range->length, message + range->offset);
+        if (records[i] == NULL)
+            goto cleanup;
+    }
+
+    /* Populate a report containing only the decoded records, and extract them. */
+    if (descriptor == &plcrash__crash_report__thread__descriptor) {
+        report.n_threads = list->count;
+        report.threads = (Plcrash__CrashReport__Thread **) records;
+        result = [self extractThreadInfo: &report error: NULL];
+    } else {
+        report.n_binary_images = list->count;
+        report.binary_images = (Plcrash__CrashReport__BinaryImage **) records;
+        result = [self extractImageInfo: &report error: NULL];
+    }
+
+cleanup:
+    /* The records are freed along with the arena */
+    plcrash_report_arena_release(arena);
+
+    if (result == nil)
+        return [NSArray array];
+
+    return result;
+}
+
 /**
  * Extract  exception information from the crash log. Returns nil on error.
  */
@@ -666,9 +1625,10 @@ error:
     NSMutableArray *frames = nil;
     if (exceptionInfo->n_frames > 0) {
         frames = [NSMutableArray arrayWithCapacity: exceptionInfo->n_frames];
+        uint64_t imageOffset = 0;
         for (size_t frame_idx = 0; frame_idx < exceptionInfo->n_frames; frame_idx++) {
             Plcrash__CrashReport__Thread__StackFrame *frame = exceptionInfo->frames[frame_idx];
-            PLCrashReportStackFrameInfo *frameInfo = [self extractStackFrameInfo: frame error: outError];
+            PLCrashReportStackFrameInfo *frameInfo = [self extractStackFrameInfo: frame imageOffset: &imageOffset error: outError];
             if (frameInfo == nil)
                 return nil;
             
@@ -754,6 +1714,302 @@ error:
     return [[[PLCrashReportMachExceptionInfo alloc] initWithType: machExceptionInfo->type codes: codes] autorelease];
 }
 
+/**
+ * Extract hang information from the crash log. Returns nil on error.
+ */
+- (PLCrashReportHangInfo *) extractHangInfo: (Plcrash__CrashReport__Hang *) hang error: (NSError **) outError {
+    NSMutableArray *samples = [NSMutableArray arrayWithCapacity: hang->n_samples];
+
+    for (size_t i = 0; i < hang->n_samples; i++) {
+        Plcrash__CrashReport__Hang__Sample *sample = hang->samples[i];
+
+        /* Validate */
+        if (sample == NULL) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report contains an invalid hang sample",
+                                               @"Invalid hang sample in crash report"));
+            return nil;
+        }
+
+        NSMutableArray *frames = [NSMutableArray arrayWithCapacity: sample->n_pcs];
+        for (size_t j = 0; j < sample->n_pcs; j++) {
+            PLCrashReportStackFrameInfo *frame = [[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: sample->pcs[j] symbolInfo: nil];
+            [frames addObject: frame];
+            [frame release];
+        }
+
+        PLCrashReportHangSample *hangSample = [[PLCrashReportHangSample alloc] initWithOffset: ((NSTimeInterval) sample->offset) / 1000.0
+                                                                                  stackFrames: frames];
+        [samples addObject: hangSample];
+        [hangSample release];
+    }
+
+    return [[[PLCrashReportHangInfo alloc] initWithDuration: ((NSTimeInterval) hang->duration) / 1000.0 samples: samples] autorelease];
+}
+
+/**
+ * Extract memory usage information from the crash log. Returns nil on error.
+ */
+- (PLCrashReportMemoryInfo *) extractMemoryInfo: (Plcrash__CrashReport__Memory *) memory error: (NSError **) outError {
+    NSMutableArray *regions = [NSMutableArray arrayWithCapacity: memory->n_regions];
+
+    for (size_t i = 0; i < memory->n_regions; i++) {
+        Plcrash__CrashReport__Memory__RegionSummary *region = memory->regions[i];
+
+        /* Validate */
+        if (region == NULL) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report contains an invalid memory region summary",
+                                               @"Invalid memory region summary in crash report"));
+            return nil;
+        }
+
+        PLCrashReportMemoryRegionInfo *regionInfo = [[PLCrashReportMemoryRegionInfo alloc] initWithTag: region->tag
+                                                                                            mappedFile: region->has_mapped_file && region->mapped_file
+                                                                                           regionCount: region->region_count
+                                                                                           virtualSize: region->virtual_size
+                                                                                          residentSize: region->resident_size
+                                                                                             dirtySize: region->dirty_size
+                                                                                           swappedSize: region->swapped_size];
+        [regions addObject: regionInfo];
+        [regionInfo release];
+    }
+
+    return [[[PLCrashReportMemoryInfo alloc] initWithPhysicalFootprint: memory->phys_footprint
+                                                  hasPhysicalFootprint: memory->has_phys_footprint
+                                                          residentSize: memory->resident_size
+                                                      peakResidentSize: memory->resident_size_peak
+                                                        compressedSize: memory->compressed_size
+                                                           virtualSize: memory->virtual_size
+                                                               regions: regions
+                                                      regionsTruncated: memory->has_regions_truncated && memory->regions_truncated] autorelease];
+}
+
+/**
+ * Extract termination information from the crash log. Returns nil on error.
+ */
+- (PLCrashReportTerminationInfo *) extractTerminationInfo: (Plcrash__CrashReport__Termination *) termination error: (NSError **) outError {
+    PLCrashReportTerminationReason reason;
+
+    switch (termination->reason) {
+        case PLCRASH__CRASH_REPORT__TERMINATION__REASON__WATCHDOG:
+            reason = PLCrashReportTerminationReasonWatchdog;
+            break;
+
+        case PLCRASH__CRASH_REPORT__TERMINATION__REASON__OUT_OF_MEMORY:
+            reason = PLCrashReportTerminationReasonOutOfMemory;
+            break;
+
+        case PLCRASH__CRASH_REPORT__TERMINATION__REASON__BACKGROUND:
+            reason = PLCrashReportTerminationReasonBackground;
+            break;
+
+        default:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report contains an unknown termination reason",
+                                               @"Invalid termination reason in crash report"));
+            return nil;
+    }
+
+    NSDate *launchDate = nil;
+    if (termination->has_launch_time)
+        launchDate = [NSDate dateWithTimeIntervalSince1970: termination->launch_time];
+
+    NSDate *footprintDate = nil;
+    if (termination->has_footprint_time)
+        footprintDate = [NSDate dateWithTimeIntervalSince1970: termination->footprint_time];
+
+    return [[[PLCrashReportTerminationInfo alloc] initWithReason: reason
+                                                       processID: termination->pid
+                                                      launchDate: launchDate
+                                                      foreground: termination->has_foreground && termination->foreground
+                                                            hung: termination->has_in_hang && termination->in_hang
+                                           receivedMemoryWarning: termination->has_memory_warning && termination->memory_warning
+                                                       footprint: termination->footprint
+                                                   footprintDate: footprintDate] autorelease];
+}
+
+/**
+ * Extract the application-registered memory regions from the crash log. Returns nil on error.
+ */
+- (NSArray *) extractUserRegions: (Plcrash__CrashReport__UserRegion **) regions count: (size_t) count error: (NSError **) outError {
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity: count];
+
+    for (size_t i = 0; i < count; i++) {
+        Plcrash__CrashReport__UserRegion *region = regions[i];
+
+        /* Validate */
+        if (region->has_data && region->data.len != region->length) {
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                             NSLocalizedString(@"Crash report contains an invalid user memory region",
+                                               @"Invalid user region in crash report"));
+            return nil;
+        }
+
+        NSData *data = nil;
+        if (region->has_data)
+            data = [NSData dataWithBytes: region->data.data length: region->data.len];
+
+        PLCrashReportUserRegionInfo *info = [[PLCrashReportUserRegionInfo alloc] initWithTag: region->tag
+                                                                                     address: region->address
+                                                                                      length: region->length
+                                                                                        data: data];
+        [result addObject: info];
+        [info release];
+    }
+
+    return result;
+}
+
+/**
+ * @internal
+ * A published breadcrumb slot, as located by -extractBreadcrumbs:error:.
+ */
+struct pl_breadcrumb_slot {
+    /** The record's sequence number. */
+    uint64_t sequence;
+
+    /** The record's slot header. */
+    const plcrash_async_breadcrumb_header_t *header;
+};
+
+/* qsort() comparison function; orders slots by sequence number. */
+static int pl_breadcrumb_slot_compare (const void *lhs, const void *rhs) {
+    uint64_t a = ((const struct pl_breadcrumb_slot *) lhs)->sequence;
+    uint64_t b = ((const struct pl_breadcrumb_slot *) rhs)->sequence;
+
+    if (a < b)
+        return -1;
+    else if (a > b)
+        return 1;
+    return 0;
+}
+
+/**
+ * Extract the breadcrumb records from the crash log, oldest first. Returns nil on error.
+ *
+ * Slots that are empty, or that were being written at the time of the crash, are skipped.
+ */
+- (NSArray *) extractBreadcrumbs: (Plcrash__CrashReport__Breadcrumbs *) breadcrumbs error: (NSError **) outError {
+    const size_t header_size = sizeof(plcrash_async_breadcrumb_header_t);
+
+    /* Validate */
+    if (breadcrumbs->slot_size < header_size || breadcrumbs->slot_size % 8 != 0 ||
+        breadcrumbs->record_size > breadcrumbs->slot_size - header_size ||
+        breadcrumbs->slots.len % breadcrumbs->slot_size != 0)
+    {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                         NSLocalizedString(@"Crash report contains an invalid breadcrumb buffer",
+                                           @"Invalid breadcrumbs in crash report"));
+        return nil;
+    }
+
+    /* Gather the published slots. The slot data is copied to ensure the headers are suitably aligned. */
+    NSData *slotData = [NSData dataWithBytes: breadcrumbs->slots.data length: breadcrumbs->slots.len];
+    const uint8_t *bytes = [slotData bytes];
+    size_t count = breadcrumbs->slots.len / breadcrumbs->slot_size;
+    size_t found = 0;
+
+    struct pl_breadcrumb_slot *slots = calloc(count > 0 ? count : 1, sizeof(*slots));
+    if (slots == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not allocate breadcrumb table");
+        return nil;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const plcrash_async_breadcrumb_header_t *header = (const void *) (bytes + (i * breadcrumbs->slot_size));
+        if (header->sequence == 0 || header->length > breadcrumbs->record_size)
+            continue;
+
+        slots[found].sequence = header->sequence;
+        slots[found].header = header;
+        found++;
+    }
+
+    qsort(slots, found, sizeof(*slots), pl_breadcrumb_slot_compare);
+
+    /* Extract the records */
+    NSMutableArray *records = [NSMutableArray arrayWithCapacity: found];
+    for (size_t i = 0; i < found; i++) {
+        const uint8_t *payload = ((const uint8_t *) slots[i].header) + header_size;
+        [records addObject: [NSData dataWithBytes: payload length: slots[i].header->length]];
+    }
+
+    free(slots);
+    return records;
+}
+
+/* qsort() comparison function; orders trace records by sequence number. */
+static int pl_trace_record_compare (const void *lhs, const void *rhs) {
+    uint64_t a = ((const plcrash_async_trace_record_t *) lhs)->sequence;
+    uint64_t b = ((const plcrash_async_trace_record_t *) rhs)->sequence;
+
+    if (a < b)
+        return -1;
+    else if (a > b)
+        return 1;
+    return 0;
+}
+
+/**
+ * Extract the crash reporter debug trace from the crash log, oldest first, formatting each event as a single line
+ * of the form "event_name arg=value ...". Returns nil on error.
+ *
+ * Records that are empty, or that were being written at the time of the crash, are skipped. Events that are unknown
+ * to this version of the library are formatted by number, with all of their arguments.
+ */
+- (NSArray *) extractDebugTrace: (Plcrash__CrashReport__DebugTrace *) debugTrace error: (NSError **) outError {
+    const size_t record_size = sizeof(plcrash_async_trace_record_t);
+
+    /* Validate */
+    if (debugTrace->record_size != record_size || debugTrace->records.len % record_size != 0) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,
+                         NSLocalizedString(@"Crash report contains an invalid debug trace",
+                                           @"Invalid debug trace in crash report"));
+        return nil;
+    }
+
+    /* Copy the records to ensure they are suitably aligned, and then order them */
+    size_t count = debugTrace->records.len / record_size;
+    plcrash_async_trace_record_t *trace = malloc(count > 0 ? debugTrace->records.len : record_size);
+    if (trace == NULL) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not allocate debug trace table");
+        return nil;
+    }
+    memcpy(trace, debugTrace->records.data, debugTrace->records.len);
+
+    qsort(trace, count, record_size, pl_trace_record_compare);
+
+    NSMutableArray *events = [NSMutableArray arrayWithCapacity: count];
+    for (size_t i = 0; i < count; i++) {
+        const plcrash_async_trace_record_t *record = &trace[i];
+        if (record->sequence == 0)
+            continue;
+
+        NSMutableString *line;
+        const char *name = plcrash_async_trace_event_name(record->event);
+        if (name != NULL) {
+            line = [NSMutableString stringWithUTF8String: name];
+        } else {
+            line = [NSMutableString stringWithFormat: @"event #%u", (unsigned int) record->event];
+        }
+
+        for (uint32_t arg = 0; arg < PLCRASH_ASYNC_TRACE_ARGS_MAX; arg++) {
+            const char *argName = plcrash_async_trace_event_arg_name(record->event, arg);
+            if (argName != NULL) {
+                [line appendFormat: @" %s=%" PRId64, argName, (int64_t) record->args[arg]];
+            } else if (name == NULL) {
+                [line appendFormat: @" 0x%" PRIx64, record->args[arg]];
+            }
+        }
+
+        [events addObject: line];
+    }
+
+    free(trace);
+    return events;
+}
+
 @end
 
 /**
@@ -781,3 +2037,198 @@ static void populate_nserror (NSError **error, PLCrashReporterError code, NSStri
     
     *error = [NSError errorWithDomain: PLCrashReporterErrorDomain code: code userInfo: userInfo];
 }
+
+/**
+ * @internal
+ *
+ * Return the longest prefix of @a data consisting of complete, individually decodable top-level CrashReport
+ * records, discarding the first incomplete or malformed record and all data that follows it. A record whose
+ * length was never back-patched (see plcrash_writer_pack_begin_message()) is encoded as an empty message, and is
+ * rejected as missing its required fields.
+ *
+ * @param data The encoded report, including its file header.
+ * @param salvaged On return, YES if any data was discarded.
+ *
+ * @return Returns @a data if no records were discarded, or a new data object containing the file header and all
+ * complete records.
+ */
+static NSData *pl_salvage_report (NSData *data, BOOL *salvaged) {
+    size_t complete = plcrash_report_reader_salvage_length([data bytes], [data length]);
+
+    *salvaged = NO;
+    if (complete == [data length])
+        return data;
+
+    *salvaged = YES;
+    return [data subdataWithRange: NSMakeRange(0, complete)];
+}
+
+/**
+ * @internal
+ *
+ * qsort() comparison function for pl_image_index_entry_t, ordering entries by base address.
+ */
+static int pl_image_index_compare (const void *a, const void *b) {
+    const pl_image_index_entry_t *lhs = a;
+    const pl_image_index_entry_t *rhs = b;
+
+    if (lhs->base < rhs->base)
+        return -1;
+    else if (lhs->base > rhs->base)
+        return 1;
+
+    return 0;
+}
+
+/**
+ * @internal
+ *
+ * If @a data was written with a footer (see PLCRASH_REPORT_FILE_FLAG_FOOTER), return the report preceding the
+ * footer. A missing or malformed footer is expected of a report whose writing was interrupted; such reports are
+ * returned unmodified, as their records may still be decodable.
+ */
+static NSData *pl_strip_footer (NSData *data) {
+    size_t length;
+
+    if (plcrash_report_reader_read_footer([data bytes], [data length], NULL, &length) != PLCRASH_ESUCCESS)
+        return data;
+
+    return [data subdataWithRange: NSMakeRange(0, length)];
+}
+
+/**
+ * @internal
+ *
+ * If @a data is a compressed report (see PLCRASH_REPORT_FILE_FLAG_COMPRESSED), return the decompressed report, with
+ * the compression flag cleared from its header. Otherwise, @a data is returned unmodified. Any report footer is
+ * discarded.
+ *
+ * @param data The encoded report.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the report could
+ * not be decompressed.
+ *
+ * @return Returns the (decompressed) report data, or nil on error.
+ */
+static NSData *pl_decompress_report (NSData *data, NSError **outError) {
+    uint8_t *output;
+    size_t length;
+
+    /* The footer follows the compressed message */
+    data = pl_strip_footer(data);
+
+    switch (plcrash_report_reader_decompress([data bytes], [data length], &output, &length)) {
+        case PLCRASH_ESUCCESS:
+            break;
+
+        case PLCRASH_ENOMEM:
+            populate_nserror(outError, PLCrashReporterErrorOperatingSystem, NSLocalizedString(@"Could not allocate memory to decode the crash report",
+                                                                                              @"Crash log decoding error message"));
+            return nil;
+
+        default:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decompress malformed crash report",
+                                                                                                 @"Crash log decoding error message"));
+            return nil;
+    }
+
+    /* Not compressed */
+    if (output == NULL)
+        return data;
+
+    return [NSData dataWithBytesNoCopy: output length: length freeWhenDone: YES];
+}
+
+/**
+ * @internal
+ *
+ * Release the decoder's arena, if any. Borrowed arenas are reset for reuse by their owner.
+ */
+static void pl_decoder_release_arena (_PLCrashReportDecoder *decoder) {
+    if (decoder->arena == NULL)
+        return;
+
+    if (decoder->arenaBorrowed)
+        plcrash_report_arena_reset(decoder->arena);
+    else
+        plcrash_report_arena_release(decoder->arena);
+
+    decoder->arena = NULL;
+}
+
+/**
+ * @internal
+ *
+ * Determine the type of @a crashReport. If the report does not specify its type, as is the case for reports written
+ * prior to the introduction of report types, the type is inferred from the report's contents.
+ */
+static PLCrashReportType pl_report_type (Plcrash__CrashReport *crashReport) {
+    Plcrash__CrashReport__ReportInfo *info = crashReport->report_info;
+    if (info != NULL && info->has_type && info->type >= PLCrashReportTypeCrash && info->type <= PLCrashReportTypeLive)
+        return (PLCrashReportType) info->type;
+
+    /* Hang and resource reports are written as user-requested reports */
+    if (crashReport->hang != NULL)
+        return PLCrashReportTypeWatchdog;
+
+#ifdef EXC_RESOURCE
+    if (crashReport->signal != NULL && crashReport->signal->mach_exception != NULL && crashReport->signal->mach_exception->type == EXC_RESOURCE)
+        return PLCrashReportTypeWatchdog;
+#endif
+
+    if (info != NULL && info->user_requested)
+        return PLCrashReportTypeLive;
+
+    if (crashReport->exception != NULL)
+        return PLCrashReportTypeLanguageException;
+
+    return PLCrashReportTypeCrash;
+}
+
+/**
+ * @internal
+ *
+ * Return the unwind method recorded for @a stackFrame, or PLCrashReportUnwindMethodUnknown if the frame does not
+ * record a method known to this version of the library.
+ */
+static PLCrashReportUnwindMethod pl_stack_frame_unwind_method (Plcrash__CrashReport__Thread__StackFrame *stackFrame) {
+    if (!stackFrame->has_unwind_method)
+        return PLCrashReportUnwindMethodUnknown;
+
+    if (stackFrame->unwind_method < PLCrashReportUnwindMethodUnknown || stackFrame->unwind_method > PLCrashReportUnwindMethodStackScan)
+        return PLCrashReportUnwindMethodUnknown;
+
+    return (PLCrashReportUnwindMethod) stackFrame->unwind_method;
+}
+
+/**
+ * @internal
+ *
+ * Verify that @a data is sufficiently large to contain a crash log, and that it begins with a supported file
+ * header. Returns NO and populates @a outError on failure.
+ */
+static BOOL pl_check_header (NSData *data, NSError **outError) {
+    const struct PLCrashReportFileHeader *header = [data bytes];
+
+    /* Verify that the crash log is sufficently large */
+    if (sizeof(struct PLCrashReportFileHeader) >= [data length]) {
+        populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, NSLocalizedString(@"Could not decode truncated crash log",
+                                                                                             @"Crash log decoding error message"));
+        return NO;
+    }
+
+    /* Check the file magic and version */
+    switch (plcrash_report_reader_check_header([data bytes], [data length], NULL)) {
+        case PLCRASH_ESUCCESS:
+            return YES;
+
+        case PLCRASH_ENOTSUP:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid, [NSString stringWithFormat: NSLocalizedString(@"Could not decode unsupported crash report version: %d",
+                                                                                                                             @"Crash log decoding message"), header->version]);
+            return NO;
+
+        default:
+            populate_nserror(outError, PLCrashReporterErrorCrashReportInvalid,NSLocalizedString(@"Could not decode invalid crash log header",
+                                                                                                @"Crash log decoding error message"));
+            return NO;
+    }
+}
@@ -0,0 +1,136 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * @ingroup constants
+ * Crash report archive magic identifier. */
+#define PLCRASH_REPORT_ARCHIVE_MAGIC "plarchv"
+
+/**
+ * @ingroup constants
+ * Crash report archive format version number. */
+#define PLCRASH_REPORT_ARCHIVE_VERSION 1
+
+/**
+ * @ingroup constants
+ * The number of crashed thread frames included in the fingerprints recorded in an archive's index. */
+#define PLCRASH_REPORT_ARCHIVE_FINGERPRINT_FRAMES 5
+
+/**
+ * @internal
+ *
+ * Crash report archive file header format.
+ *
+ * An archive is a concatenation of encoded crash reports, prefixed with this header, and followed by an index
+ * of #PLCrashReportArchiveEntry records and a single #PLCrashReportArchiveTrailer. The index and trailer are located
+ * at the end of the file, allowing reports to be appended while the archive is written; readers locate the index
+ * via the trailer, and may then access any report without reading the others.
+ *
+ * All multi-byte values are little-endian.
+ */
+struct PLCrashReportArchiveHeader {
+    /** Archive magic identifier (#PLCRASH_REPORT_ARCHIVE_MAGIC), not NULL terminated */
+    char magic[7];
+
+    /** Archive format version (#PLCRASH_REPORT_ARCHIVE_VERSION) */
+    uint8_t version;
+
+    /** Reserved; must be zero */
+    uint8_t reserved[8];
+} __attribute__((packed));
+
+/**
+ * @internal
+ *
+ * A single crash report archive index entry.
+ */
+struct PLCrashReportArchiveEntry {
+    /** Offset of the encoded report from the start of the archive */
+    uint64_t offset;
+
+    /** Length of the encoded report */
+    uint64_t length;
+
+    /** The report's fingerprint, as returned by +[PLCrashReport fingerprintForData:frameCount:error:], or zero if
+     * a fingerprint could not be computed. */
+    uint8_t fingerprint[8];
+
+    /** The report's timestamp, in seconds since the UNIX epoch, or zero if unknown */
+    int64_t timestamp;
+} __attribute__((packed));
+
+/**
+ * @internal
+ *
+ * Crash report archive trailer format.
+ */
+struct PLCrashReportArchiveTrailer {
+    /** Offset of the first index entry from the start of the archive */
+    uint64_t index_offset;
+
+    /** Number of index entries */
+    uint64_t count;
+
+    /** Archive magic identifier (#PLCRASH_REPORT_ARCHIVE_MAGIC), not NULL terminated */
+    char magic[7];
+
+    /** Archive format version (#PLCRASH_REPORT_ARCHIVE_VERSION) */
+    uint8_t version;
+} __attribute__((packed));
+
+@interface PLCrashReportArchive : NSObject {
+@private
+    /** Archive data */
+    NSData *_data;
+
+    /** The first index entry, within _data */
+    const uint8_t *_index;
+
+    /** Number of index entries */
+    NSUInteger _count;
+}
+
++ (BOOL) isArchiveData: (NSData *) data;
+
+- (id) initWithContentsOfFile: (NSString *) path error: (NSError **) outError;
+- (id) initWithData: (NSData *) data error: (NSError **) outError;
+
+- (NSData *) reportDataAtIndex: (NSUInteger) index;
+- (NSData *) fingerprintAtIndex: (NSUInteger) index;
+- (NSDate *) timestampAtIndex: (NSUInteger) index;
+
+- (NSIndexSet *) indexesOfReportsWithFingerprint: (NSData *) fingerprint;
+- (NSIndexSet *) indexesOfReportsFromDate: (NSDate *) startDate toDate: (NSDate *) endDate;
+
+/**
+ * The number of reports in the archive.
+ */
+@property(nonatomic, readonly) NSUInteger count;
+
+@end
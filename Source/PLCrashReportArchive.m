@@ -0,0 +1,252 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashReportArchive.h"
+#import "PLCrashReporterNSError.h"
+
+#import <libkern/OSByteOrder.h>
+#import <stddef.h>
+#import <float.h>
+
+/**
+ * Provides random access to the reports within a crash report archive, as written by PLCrashReportArchiveWriter.
+ *
+ * Only the archive's trailer and index are read at initialization time; report data is returned directly from the
+ * archive's backing storage, and the archive's reports may be filtered by fingerprint or timestamp without decoding
+ * them. Large archives should be memory mapped, as done by initWithContentsOfFile:error:.
+ *
+ * Archive instances are immutable, and may be safely accessed from multiple threads.
+ */
+@implementation PLCrashReportArchive
+
+@synthesize count = _count;
+
+/**
+ * Return true if @a data appears to be a crash report archive, based on its header.
+ *
+ * @param data The data to be checked.
+ */
++ (BOOL) isArchiveData: (NSData *) data {
+    const struct PLCrashReportArchiveHeader *header = [data bytes];
+
+    if ([data length] < sizeof(*header))
+        return NO;
+
+    if (memcmp(header->magic, PLCRASH_REPORT_ARCHIVE_MAGIC, strlen(PLCRASH_REPORT_ARCHIVE_MAGIC)) != 0)
+        return NO;
+
+    return YES;
+}
+
+/**
+ * Memory map and initialize the archive at @a path.
+ *
+ * @param path The archive path.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the archive could
+ * not be read. If no error occurs, this parameter will be left unmodified. You may specify NULL for this parameter,
+ * and no error information will be provided.
+ */
+- (id) initWithContentsOfFile: (NSString *) path error: (NSError **) outError {
+    NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: outError];
+    if (data == nil) {
+        [self release];
+        return nil;
+    }
+
+    return [self initWithData: data error: outError];
+}
+
+/**
+ * Initialize with the provided archive data.
+ *
+ * @param data Encoded archive data. The data is retained, and reports returned by the archive reference it
+ * directly.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the archive could
+ * not be read. If no error occurs, this parameter will be left unmodified. You may specify NULL for this parameter,
+ * and no error information will be provided.
+ */
+- (id) initWithData: (NSData *) data error: (NSError **) outError {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    const uint8_t *bytes = [data bytes];
+    size_t length = [data length];
+    const size_t header_size = sizeof(struct PLCrashReportArchiveHeader);
+    const size_t trailer_size = sizeof(struct PLCrashReportArchiveTrailer);
+    const size_t entry_size = sizeof(struct PLCrashReportArchiveEntry);
+
+    /* Verify the header */
+    if (![PLCrashReportArchive isArchiveData: data] || length < header_size + trailer_size) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Data is not a crash report archive", nil);
+        goto error;
+    }
+
+    if (((const struct PLCrashReportArchiveHeader *) bytes)->version != PLCRASH_REPORT_ARCHIVE_VERSION) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Crash report archive version is not supported", nil);
+        goto error;
+    }
+
+    /* Verify the trailer */
+    const uint8_t *trailer = bytes + length - trailer_size;
+    if (memcmp(trailer + offsetof(struct PLCrashReportArchiveTrailer, magic), PLCRASH_REPORT_ARCHIVE_MAGIC, strlen(PLCRASH_REPORT_ARCHIVE_MAGIC)) != 0) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Crash report archive is truncated", nil);
+        goto error;
+    }
+
+    uint64_t index_offset = OSReadLittleInt64(trailer, offsetof(struct PLCrashReportArchiveTrailer, index_offset));
+    uint64_t count = OSReadLittleInt64(trailer, offsetof(struct PLCrashReportArchiveTrailer, count));
+    uint64_t index_end = length - trailer_size;
+
+    if (index_offset < header_size || index_offset > index_end || count > (index_end - index_offset) / entry_size ||
+        index_offset + (count * entry_size) != index_end)
+    {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Crash report archive index is invalid", nil);
+        goto error;
+    }
+
+    /* Verify that all entries fall within the report data */
+    for (uint64_t i = 0; i < count; i++) {
+        const uint8_t *entry = bytes + index_offset + (i * entry_size);
+        uint64_t offset = OSReadLittleInt64(entry, offsetof(struct PLCrashReportArchiveEntry, offset));
+        uint64_t entry_length = OSReadLittleInt64(entry, offsetof(struct PLCrashReportArchiveEntry, length));
+
+        if (offset < header_size || offset > index_offset || entry_length > index_offset - offset) {
+            plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Crash report archive index is invalid", nil);
+            goto error;
+        }
+    }
+
+    _data = [data retain];
+    _index = bytes + index_offset;
+    _count = (NSUInteger) count;
+
+    return self;
+
+error:
+    [self release];
+    return nil;
+}
+
+- (void) dealloc {
+    [_data release];
+    [super dealloc];
+}
+
+/**
+ * Return a pointer to the index entry at @a index.
+ */
+- (const uint8_t *) entryAtIndex: (NSUInteger) index {
+    if (index >= _count)
+        [NSException raise: NSRangeException format: @"Index %lu beyond bounds (%lu)", (unsigned long) index, (unsigned long) _count];
+
+    return _index + (index * sizeof(struct PLCrashReportArchiveEntry));
+}
+
+/**
+ * Return the encoded report data at @a index. The returned data references the archive's backing storage
+ * directly, and is not copied.
+ *
+ * @param index The report index. An NSRangeException will be raised if @a index is beyond the end of the archive.
+ */
+- (NSData *) reportDataAtIndex: (NSUInteger) index {
+    const uint8_t *entry = [self entryAtIndex: index];
+    uint64_t offset = OSReadLittleInt64(entry, offsetof(struct PLCrashReportArchiveEntry, offset));
+    uint64_t length = OSReadLittleInt64(entry, offsetof(struct PLCrashReportArchiveEntry, length));
+
+    return [_data subdataWithRange: NSMakeRange((NSUInteger) offset, (NSUInteger) length)];
+}
+
+/**
+ * Return the fingerprint recorded for the report at @a index, in the form returned by
+ * +[PLCrashReport fingerprintForData:frameCount:error:]. If no fingerprint could be computed when the
+ * report was archived, the fingerprint will be zero.
+ *
+ * @param index The report index. An NSRangeException will be raised if @a index is beyond the end of the archive.
+ */
+- (NSData *) fingerprintAtIndex: (NSUInteger) index {
+    const uint8_t *entry = [self entryAtIndex: index];
+    return [NSData dataWithBytes: entry + offsetof(struct PLCrashReportArchiveEntry, fingerprint) length: sizeof(((struct PLCrashReportArchiveEntry *) NULL)->fingerprint)];
+}
+
+/**
+ * Return the timestamp recorded for the report at @a index, or nil if the report's timestamp is unknown.
+ *
+ * @param index The report index. An NSRangeException will be raised if @a index is beyond the end of the archive.
+ */
+- (NSDate *) timestampAtIndex: (NSUInteger) index {
+    int64_t timestamp = (int64_t) OSReadLittleInt64([self entryAtIndex: index], offsetof(struct PLCrashReportArchiveEntry, timestamp));
+    if (timestamp == 0)
+        return nil;
+
+    return [NSDate dateWithTimeIntervalSince1970: timestamp];
+}
+
+/**
+ * Return the indexes of all reports with the given @a fingerprint. Only the archive index is read.
+ *
+ * @param fingerprint A fingerprint, as returned by +[PLCrashReport fingerprintForData:frameCount:error:].
+ */
+- (NSIndexSet *) indexesOfReportsWithFingerprint: (NSData *) fingerprint {
+    NSMutableIndexSet *result = [NSMutableIndexSet indexSet];
+    const size_t fingerprint_size = sizeof(((struct PLCrashReportArchiveEntry *) NULL)->fingerprint);
+
+    if ([fingerprint length] != fingerprint_size)
+        return result;
+
+    for (NSUInteger i = 0; i < _count; i++) {
+        const uint8_t *entry = _index + (i * sizeof(struct PLCrashReportArchiveEntry));
+        if (memcmp(entry + offsetof(struct PLCrashReportArchiveEntry, fingerprint), [fingerprint bytes], fingerprint_size) == 0)
+            [result addIndex: i];
+    }
+
+    return result;
+}
+
+/**
+ * Return the indexes of all reports with a timestamp within the given range, inclusive. Reports without a timestamp
+ * are never matched. Only the archive index is read.
+ *
+ * @param startDate The start of the range, or nil for no lower bound.
+ * @param endDate The end of the range, or nil for no upper bound.
+ */
+- (NSIndexSet *) indexesOfReportsFromDate: (NSDate *) startDate toDate: (NSDate *) endDate {
+    NSMutableIndexSet *result = [NSMutableIndexSet indexSet];
+    NSTimeInterval start = startDate != nil ? [startDate timeIntervalSince1970] : -DBL_MAX;
+    NSTimeInterval end = endDate != nil ? [endDate timeIntervalSince1970] : DBL_MAX;
+
+    for (NSUInteger i = 0; i < _count; i++) {
+        const uint8_t *entry = _index + (i * sizeof(struct PLCrashReportArchiveEntry));
+        int64_t timestamp = (int64_t) OSReadLittleInt64(entry, offsetof(struct PLCrashReportArchiveEntry, timestamp));
+
+        if (timestamp != 0 && timestamp >= start && timestamp <= end)
+            [result addIndex: i];
+    }
+
+    return result;
+}
+
+@end
@@ -0,0 +1,160 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "GTMSenTestCase.h"
+
+#import "CrashReporter.h"
+
+#import <libkern/OSByteOrder.h>
+#import <stddef.h>
+
+@interface PLCrashReportArchiveTests : SenTestCase {
+@private
+    NSString *_archivePath;
+}
+@end
+
+@implementation PLCrashReportArchiveTests
+
+- (void) setUp {
+    _archivePath = [[NSTemporaryDirectory() stringByAppendingString: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+}
+
+- (void) tearDown {
+    NSError *error;
+
+    if ([[NSFileManager defaultManager] fileExistsAtPath: _archivePath])
+        STAssertTrue([[NSFileManager defaultManager] removeItemAtPath: _archivePath error: &error], @"Could not remove archive: %@", error);
+
+    [_archivePath release];
+    _archivePath = nil;
+}
+
+/**
+ * Write an archive containing @a count live reports, returning the archived report data.
+ */
+- (NSArray *) writeArchiveWithReportCount: (NSUInteger) count {
+    NSMutableArray *reports = [NSMutableArray array];
+    NSError *error;
+
+    PLCrashReportArchiveWriter *writer = [[[PLCrashReportArchiveWriter alloc] initWithPath: _archivePath error: &error] autorelease];
+    STAssertNotNil(writer, @"Could not create writer: %@", error);
+
+    for (NSUInteger i = 0; i < count; i++) {
+        NSData *data = [[PLCrashReporter sharedReporter] generateLiveReportAndReturnError: &error];
+        STAssertNotNil(data, @"Failed to generate live report: %@", error);
+
+        STAssertTrue([writer addReportData: data error: &error], @"Could not add report: %@", error);
+        [reports addObject: data];
+    }
+
+    STAssertEquals([writer count], count, @"Incorrect report count");
+    STAssertTrue([writer finishAndReturnError: &error], @"Could not finish archive: %@", error);
+
+    return reports;
+}
+
+/**
+ * Verify that archived reports, fingerprints, and timestamps may be read back.
+ */
+- (void) testReadWrite {
+    NSArray *reports = [self writeArchiveWithReportCount: 3];
+    NSError *error;
+
+    PLCrashReportArchive *archive = [[[PLCrashReportArchive alloc] initWithContentsOfFile: _archivePath error: &error] autorelease];
+    STAssertNotNil(archive, @"Could not read archive: %@", error);
+    STAssertEquals([archive count], (NSUInteger) 3, @"Incorrect report count");
+
+    for (NSUInteger i = 0; i < [reports count]; i++) {
+        NSData *expected = [reports objectAtIndex: i];
+        STAssertEqualObjects([archive reportDataAtIndex: i], expected, @"Incorrect report data for report %lu", (unsigned long) i);
+
+        NSData *fingerprint = [PLCrashReport fingerprintForData: expected frameCount: PLCRASH_REPORT_ARCHIVE_FINGERPRINT_FRAMES error: &error];
+        STAssertNotNil(fingerprint, @"Could not compute fingerprint: %@", error);
+        STAssertEqualObjects([archive fingerprintAtIndex: i], fingerprint, @"Incorrect fingerprint for report %lu", (unsigned long) i);
+
+        PLCrashReport *report = [[[PLCrashReport alloc] initWithData: expected error: &error] autorelease];
+        STAssertEquals((int64_t) [[archive timestampAtIndex: i] timeIntervalSince1970],
+                       (int64_t) [report.systemInfo.timestamp timeIntervalSince1970], @"Incorrect timestamp for report %lu", (unsigned long) i);
+    }
+
+    /* The live reports were generated from the same call site, and share a fingerprint */
+    NSIndexSet *matches = [archive indexesOfReportsWithFingerprint: [archive fingerprintAtIndex: 0]];
+    STAssertEquals([matches count], (NSUInteger) 3, @"Incorrect fingerprint match count");
+
+    uint8_t unknown[8] = { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    matches = [archive indexesOfReportsWithFingerprint: [NSData dataWithBytes: unknown length: sizeof(unknown)]];
+    STAssertEquals([matches count], (NSUInteger) 0, @"Unexpected fingerprint match");
+
+    /* Timestamp filtering */
+    NSDate *timestamp = [archive timestampAtIndex: 0];
+    matches = [archive indexesOfReportsFromDate: [timestamp dateByAddingTimeInterval: -60] toDate: nil];
+    STAssertEquals([matches count], (NSUInteger) 3, @"Incorrect timestamp match count");
+
+    matches = [archive indexesOfReportsFromDate: nil toDate: [timestamp dateByAddingTimeInterval: -60]];
+    STAssertEquals([matches count], (NSUInteger) 0, @"Unexpected timestamp match");
+}
+
+/**
+ * Verify that an empty archive may be written and read.
+ */
+- (void) testEmptyArchive {
+    [self writeArchiveWithReportCount: 0];
+    NSError *error;
+
+    PLCrashReportArchive *archive = [[[PLCrashReportArchive alloc] initWithContentsOfFile: _archivePath error: &error] autorelease];
+    STAssertNotNil(archive, @"Could not read archive: %@", error);
+    STAssertEquals([archive count], (NSUInteger) 0, @"Incorrect report count");
+}
+
+/**
+ * Verify that truncated or corrupt archives are rejected.
+ */
+- (void) testInvalidArchive {
+    [self writeArchiveWithReportCount: 2];
+    NSData *data = [NSData dataWithContentsOfFile: _archivePath];
+    NSError *error;
+
+    STAssertTrue([PLCrashReportArchive isArchiveData: data], @"Archive was not recognized");
+
+    /* Truncated */
+    NSData *truncated = [data subdataWithRange: NSMakeRange(0, [data length] - 1)];
+    STAssertNil([[[PLCrashReportArchive alloc] initWithData: truncated error: &error] autorelease], @"Truncated archive was accepted");
+
+    /* Entry beyond the report data */
+    NSMutableData *corrupt = [[data mutableCopy] autorelease];
+    const size_t trailer_size = sizeof(struct PLCrashReportArchiveTrailer);
+    uint64_t index_offset = OSReadLittleInt64([corrupt bytes], [corrupt length] - trailer_size);
+    OSWriteLittleInt64([corrupt mutableBytes], index_offset + offsetof(struct PLCrashReportArchiveEntry, length), UINT64_MAX);
+    STAssertNil([[[PLCrashReportArchive alloc] initWithData: corrupt error: &error] autorelease], @"Corrupt archive was accepted");
+
+    /* Not an archive */
+    NSData *report = [[PLCrashReporter sharedReporter] generateLiveReportAndReturnError: &error];
+    STAssertFalse([PLCrashReportArchive isArchiveData: report], @"Report was recognized as an archive");
+}
+
+@end
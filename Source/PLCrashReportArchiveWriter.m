@@ -0,0 +1,230 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashReportArchiveWriter.h"
+#import "PLCrashReportArchive.h"
+#import "PLCrashReport.h"
+#import "PLCrashReporterNSError.h"
+
+#import <libkern/OSByteOrder.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <errno.h>
+
+/**
+ * Writes a crash report archive, as read by PLCrashReportArchive.
+ *
+ * Reports are appended to a temporary file as they are added, and the archive index is written once the archive is
+ * finished; memory use is limited to the fixed-size index entries. The completed archive is atomically moved into
+ * place by finishAndReturnError:. If the writer is released prior to being finished, the partial archive is
+ * discarded.
+ *
+ * Writer instances are not thread-safe.
+ */
+@implementation PLCrashReportArchiveWriter
+
+@synthesize count = _count;
+
+/**
+ * Write @a length bytes from @a bytes to @a fd, retrying on partial writes.
+ */
+static BOOL plcrash_archive_write (int fd, const void *bytes, size_t length, NSError **outError) {
+    const uint8_t *p = bytes;
+
+    while (length > 0) {
+        ssize_t written = write(fd, p, length);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+
+            plcrash_populate_posix_error(outError, errno, @"Could not write to the crash report archive");
+            return NO;
+        }
+
+        p += written;
+        length -= written;
+    }
+
+    return YES;
+}
+
+/**
+ * Initialize a new writer, creating the archive's temporary file in the same directory as @a path.
+ *
+ * @param path The path at which the completed archive will be written. Any existing file will be replaced
+ * once the archive is finished.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the archive
+ * could not be created. If no error occurs, this parameter will be left unmodified. You may specify NULL for this
+ * parameter, and no error information will be provided.
+ */
+- (id) initWithPath: (NSString *) path error: (NSError **) outError {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _fd = -1;
+    _path = [path copy];
+    _index = [[NSMutableData alloc] init];
+
+    /* Create the temporary file */
+    NSString *template = [path stringByAppendingString: @".XXXXXX"];
+    char *tempPath = strdup([template fileSystemRepresentation]);
+    _fd = mkstemp(tempPath);
+    if (_fd < 0) {
+        plcrash_populate_posix_error(outError, errno, @"Could not create the crash report archive");
+        free(tempPath);
+        [self release];
+        return nil;
+    }
+
+    _tempPath = [[[NSFileManager defaultManager] stringWithFileSystemRepresentation: tempPath length: strlen(tempPath)] retain];
+    free(tempPath);
+
+    /* Write the header */
+    struct PLCrashReportArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PLCRASH_REPORT_ARCHIVE_MAGIC, strlen(PLCRASH_REPORT_ARCHIVE_MAGIC));
+    header.version = PLCRASH_REPORT_ARCHIVE_VERSION;
+
+    if (!plcrash_archive_write(_fd, &header, sizeof(header), outError)) {
+        [self release];
+        return nil;
+    }
+    _offset = sizeof(header);
+
+    return self;
+}
+
+- (void) dealloc {
+    /* Discard any unfinished archive */
+    if (_fd >= 0) {
+        close(_fd);
+        unlink([_tempPath fileSystemRepresentation]);
+    }
+
+    [_path release];
+    [_tempPath release];
+    [_index release];
+    [super dealloc];
+}
+
+/**
+ * Append an encoded crash report to the archive. The report's fingerprint and timestamp are recorded in the
+ * archive index.
+ *
+ * @param data An encoded crash report.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the report
+ * could not be added. If no error occurs, this parameter will be left unmodified. You may specify NULL for this
+ * parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the report could not be decoded or written. If the report could not
+ * be decoded, the archive is not modified, and further reports may be added.
+ */
+- (BOOL) addReportData: (NSData *) data error: (NSError **) outError {
+    if (_fd < 0) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"The crash report archive has already been finished", nil);
+        return NO;
+    }
+
+    /* Only the report's system info is required; the thread and image records are left undecoded */
+    PLCrashReport *report = [[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: outError];
+    if (report == nil)
+        return NO;
+
+    struct PLCrashReportArchiveEntry entry;
+    memset(&entry, 0, sizeof(entry));
+
+    OSWriteLittleInt64(&entry.offset, 0, _offset);
+    OSWriteLittleInt64(&entry.length, 0, [data length]);
+    OSWriteLittleInt64(&entry.timestamp, 0, (uint64_t) (int64_t) [report.systemInfo.timestamp timeIntervalSince1970]);
+    [report release];
+
+    /* Reports without a crashed thread can't be fingerprinted, and are recorded with a zero fingerprint */
+    NSData *fingerprint = [PLCrashReport fingerprintForData: data frameCount: PLCRASH_REPORT_ARCHIVE_FINGERPRINT_FRAMES error: NULL];
+    if (fingerprint != nil && [fingerprint length] == sizeof(entry.fingerprint))
+        memcpy(entry.fingerprint, [fingerprint bytes], sizeof(entry.fingerprint));
+
+    if (!plcrash_archive_write(_fd, [data bytes], [data length], outError))
+        return NO;
+
+    _offset += [data length];
+    [_index appendBytes: &entry length: sizeof(entry)];
+    _count++;
+
+    return YES;
+}
+
+/**
+ * Write the archive index, and atomically move the completed archive to its destination path. No further
+ * reports may be added.
+ *
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the archive
+ * could not be completed. If no error occurs, this parameter will be left unmodified. You may specify NULL for this
+ * parameter, and no error information will be provided.
+ */
+- (BOOL) finishAndReturnError: (NSError **) outError {
+    if (_fd < 0) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"The crash report archive has already been finished", nil);
+        return NO;
+    }
+
+    struct PLCrashReportArchiveTrailer trailer;
+    memset(&trailer, 0, sizeof(trailer));
+    OSWriteLittleInt64(&trailer.index_offset, 0, _offset);
+    OSWriteLittleInt64(&trailer.count, 0, _count);
+    memcpy(trailer.magic, PLCRASH_REPORT_ARCHIVE_MAGIC, strlen(PLCRASH_REPORT_ARCHIVE_MAGIC));
+    trailer.version = PLCRASH_REPORT_ARCHIVE_VERSION;
+
+    if (!plcrash_archive_write(_fd, [_index bytes], [_index length], outError))
+        return NO;
+
+    if (!plcrash_archive_write(_fd, &trailer, sizeof(trailer), outError))
+        return NO;
+
+    int ret = fsync(_fd);
+    int err = errno;
+    if (close(_fd) != 0 && ret == 0) {
+        ret = -1;
+        err = errno;
+    }
+    _fd = -1;
+
+    if (ret != 0) {
+        plcrash_populate_posix_error(outError, err, @"Could not write the crash report archive");
+        unlink([_tempPath fileSystemRepresentation]);
+        return NO;
+    }
+
+    if (rename([_tempPath fileSystemRepresentation], [_path fileSystemRepresentation]) != 0) {
+        plcrash_populate_posix_error(outError, errno, @"Could not move the crash report archive into place");
+        unlink([_tempPath fileSystemRepresentation]);
+        return NO;
+    }
+
+    return YES;
+}
+
+@end
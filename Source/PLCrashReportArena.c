@@ -0,0 +1,264 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashReportArena.h"
+
+#include <stdlib.h>
+#include <libkern/OSAtomic.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_report_arena
+ * @{
+ */
+
+/** Alignment of all arena allocations. */
+#define ARENA_ALIGNMENT 16
+
+/** Round @a size up to ARENA_ALIGNMENT. */
+#define ARENA_ALIGN(size) (((size) + (ARENA_ALIGNMENT - 1)) & ~((size_t) ARENA_ALIGNMENT - 1))
+
+/**
+ * @internal
+ *
+ * An arena chunk. The chunk's allocatable data immediately follows the (aligned) chunk header.
+ */
+struct plcrash_report_arena_chunk {
+    /** The next (previously exhausted) chunk, or NULL. */
+    struct plcrash_report_arena_chunk *next;
+
+    /** Size of the chunk's allocatable data. */
+    size_t size;
+
+    /** Number of bytes allocated from this chunk. */
+    size_t used;
+};
+
+/** Aligned size of the chunk header. */
+#define ARENA_CHUNK_HEADER_SIZE ARENA_ALIGN(sizeof(struct plcrash_report_arena_chunk))
+
+/* A small cache of released arenas, shared across all decoded reports. Multiple entries allow concurrent
+ * decoders to each reuse an arena. */
+static plcrash_report_arena_t *cached_arenas[PLCRASH_REPORT_ARENA_CACHE_SLOTS];
+
+/**
+ * Allocate a new chunk with @a size bytes of allocatable data. Returns NULL on failure.
+ */
+static struct plcrash_report_arena_chunk *arena_chunk_new (size_t size) {
+    struct plcrash_report_arena_chunk *chunk = malloc(ARENA_CHUNK_HEADER_SIZE + size);
+    if (chunk == NULL)
+        return NULL;
+
+    chunk->next = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+/**
+ * Free @a chunk, and all chunks that follow it.
+ */
+static void arena_chunk_free_all (struct plcrash_report_arena_chunk *chunk) {
+    while (chunk != NULL) {
+        struct plcrash_report_arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+}
+
+/* ProtobufCAllocator alloc() implementation */
+static void *arena_alloc (void *allocator_data, size_t size) {
+    plcrash_report_arena_t *arena = allocator_data;
+    struct plcrash_report_arena_chunk *chunk = arena->chunks;
+
+    /* Match the behavior of the protobuf-c system allocator */
+    if (size == 0)
+        return NULL;
+
+    size = ARENA_ALIGN(size);
+
+    /* Start a new chunk if the current chunk is exhausted. Chunk sizes are doubled to bound the number of chunks */
+    if (chunk->size - chunk->used < size) {
+        size_t chunk_size = chunk->size * 2;
+        if (chunk_size < size)
+            chunk_size = size;
+
+        struct plcrash_report_arena_chunk *next = arena_chunk_new(chunk_size);
+        if (next == NULL) {
+            protobuf_c_out_of_memory();
+            return NULL;
+        }
+
+        next->next = chunk;
+        arena->chunks = next;
+        chunk = next;
+    }
+
+    void *result = (uint8_t *) chunk + ARENA_CHUNK_HEADER_SIZE + chunk->used;
+    chunk->used += size;
+    return result;
+}
+
+/* ProtobufCAllocator free() implementation. Arena allocations are only released by plcrash_report_arena_reset(). */
+static void arena_free (void *allocator_data, void *pointer) {
+    (void) allocator_data;
+    (void) pointer;
+}
+
+/**
+ * Allocate a new arena with an initial capacity of @a size bytes. Returns NULL on failure.
+ *
+ * @param size The initial arena capacity. If less than PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE, the minimum
+ * chunk size will be used.
+ */
+plcrash_report_arena_t *plcrash_report_arena_new (size_t size) {
+    plcrash_report_arena_t *arena = malloc(sizeof(*arena));
+    if (arena == NULL)
+        return NULL;
+
+    if (size < PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE)
+        size = PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE;
+
+    arena->chunks = arena_chunk_new(size);
+    if (arena->chunks == NULL) {
+        free(arena);
+        return NULL;
+    }
+
+    /* Temporary allocations are also served from the arena; they're released with the rest of the arena's
+     * allocations. */
+    arena->allocator.alloc = arena_alloc;
+    arena->allocator.free = arena_free;
+    arena->allocator.tmp_alloc = arena_alloc;
+    arena->allocator.max_alloca = 8192;
+    arena->allocator.allocator_data = arena;
+
+    return arena;
+}
+
+/**
+ * Return the protobuf-c allocator interface for @a arena. Messages unpacked using this allocator remain
+ * valid until the arena is reset or freed; they need not be freed with protobuf_c_message_free_unpacked().
+ */
+ProtobufCAllocator *plcrash_report_arena_allocator (plcrash_report_arena_t *arena) {
+    return &arena->allocator;
+}
+
+/**
+ * Return the total allocatable capacity of @a arena.
+ */
+size_t plcrash_report_arena_capacity (plcrash_report_arena_t *arena) {
+    size_t capacity = 0;
+    for (struct plcrash_report_arena_chunk *chunk = arena->chunks; chunk != NULL; chunk = chunk->next)
+        capacity += chunk->size;
+
+    return capacity;
+}
+
+/**
+ * Release all allocations made from @a arena. If the arena grew beyond its initial chunk, its chunks are
+ * coalesced into a single chunk of the arena's total capacity, such that a subsequent decode of a similarly
+ * sized report will be served by a single chunk.
+ */
+void plcrash_report_arena_reset (plcrash_report_arena_t *arena) {
+    if (arena->chunks->next != NULL) {
+        struct plcrash_report_arena_chunk *coalesced = arena_chunk_new(plcrash_report_arena_capacity(arena));
+
+        /* If coalescing fails, fall back on retaining only the (largest) current chunk */
+        if (coalesced == NULL) {
+            arena_chunk_free_all(arena->chunks->next);
+            arena->chunks->next = NULL;
+        } else {
+            arena_chunk_free_all(arena->chunks);
+            arena->chunks = coalesced;
+        }
+    }
+
+    arena->chunks->used = 0;
+}
+
+/**
+ * Free @a arena and all of its allocations.
+ */
+void plcrash_report_arena_free (plcrash_report_arena_t *arena) {
+    arena_chunk_free_all(arena->chunks);
+    free(arena);
+}
+
+/**
+ * Return the expected arena capacity required to unpack an encoded report of @a encoded_length bytes.
+ */
+size_t plcrash_report_arena_size_hint (size_t encoded_length) {
+    if (encoded_length > SIZE_MAX / PLCRASH_REPORT_ARENA_EXPANSION_FACTOR)
+        return SIZE_MAX;
+
+    return encoded_length * PLCRASH_REPORT_ARENA_EXPANSION_FACTOR;
+}
+
+/**
+ * Acquire an arena for decoding. If a previously released arena is cached, it will be reused; otherwise,
+ * a new arena of @a size bytes will be allocated. Returns NULL on failure.
+ *
+ * The returned arena must be released via plcrash_report_arena_release().
+ *
+ * @param size The initial capacity to use if a new arena must be allocated.
+ */
+plcrash_report_arena_t *plcrash_report_arena_acquire (size_t size) {
+    /* Try to claim a cached arena */
+    for (size_t i = 0; i < PLCRASH_REPORT_ARENA_CACHE_SLOTS; i++) {
+        plcrash_report_arena_t *arena;
+        do {
+            arena = cached_arenas[i];
+        } while (arena != NULL && !OSAtomicCompareAndSwapPtrBarrier(arena, NULL, (void **) &cached_arenas[i]));
+
+        if (arena != NULL)
+            return arena;
+    }
+
+    return plcrash_report_arena_new(size);
+}
+
+/**
+ * Release an arena acquired via plcrash_report_arena_acquire(). All allocations made from the arena are
+ * released, and the arena is either cached for reuse, or freed.
+ */
+void plcrash_report_arena_release (plcrash_report_arena_t *arena) {
+    plcrash_report_arena_reset(arena);
+
+    for (size_t i = 0; i < PLCRASH_REPORT_ARENA_CACHE_SLOTS; i++) {
+        if (OSAtomicCompareAndSwapPtrBarrier(NULL, arena, (void **) &cached_arenas[i]))
+            return;
+    }
+
+    /* Cache is full */
+    plcrash_report_arena_free(arena);
+}
+
+/**
+ * @} plcrash_report_arena
+ */
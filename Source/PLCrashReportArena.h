@@ -0,0 +1,106 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_REPORT_ARENA_H
+#define PLCRASH_REPORT_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "protobuf-c.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_report_arena Crash Report Decoding Arena
+ *
+ * Implements a bump-allocating arena ProtobufCAllocator, used to decode crash reports. All allocations made
+ * while unpacking a report are served from a small number of large chunks, and are released together when the
+ * arena is reset.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * The expected ratio of unpacked message size to encoded report size, used to size an arena from the
+ * length of its input.
+ */
+#define PLCRASH_REPORT_ARENA_EXPANSION_FACTOR 8
+
+/**
+ * @internal
+ *
+ * The minimum arena chunk size.
+ */
+#define PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE (16 * 1024)
+
+/**
+ * @internal
+ *
+ * The maximum number of released arenas retained for reuse by plcrash_report_arena_acquire().
+ */
+#define PLCRASH_REPORT_ARENA_CACHE_SLOTS 8
+
+/**
+ * @internal
+ *
+ * A bump-allocating protobuf-c arena.
+ */
+typedef struct plcrash_report_arena {
+    /** The protobuf-c allocator interface; allocator_data refers to this arena. */
+    ProtobufCAllocator allocator;
+
+    /** The current chunk, followed by any previously exhausted chunks. */
+    struct plcrash_report_arena_chunk *chunks;
+} plcrash_report_arena_t;
+
+plcrash_report_arena_t *plcrash_report_arena_new (size_t size);
+ProtobufCAllocator *plcrash_report_arena_allocator (plcrash_report_arena_t *arena);
+size_t plcrash_report_arena_capacity (plcrash_report_arena_t *arena);
+void plcrash_report_arena_reset (plcrash_report_arena_t *arena);
+void plcrash_report_arena_free (plcrash_report_arena_t *arena);
+
+size_t plcrash_report_arena_size_hint (size_t encoded_length);
+plcrash_report_arena_t *plcrash_report_arena_acquire (size_t size);
+void plcrash_report_arena_release (plcrash_report_arena_t *arena);
+
+/**
+ * @} plcrash_report_arena
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_REPORT_ARENA_H */
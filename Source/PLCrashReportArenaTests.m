@@ -0,0 +1,109 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashReportArena.h"
+
+@interface PLCrashReportArenaTests : SenTestCase {
+@private
+}
+
+@end
+
+@implementation PLCrashReportArenaTests
+
+/**
+ * Test basic allocation and alignment.
+ */
+- (void) testAlloc {
+    plcrash_report_arena_t *arena = plcrash_report_arena_new(0);
+    STAssertNotNULL(arena, @"Failed to allocate arena");
+    STAssertEquals((size_t) PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE, plcrash_report_arena_capacity(arena), @"Minimum chunk size not applied");
+
+    ProtobufCAllocator *allocator = plcrash_report_arena_allocator(arena);
+    uint8_t *first = allocator->alloc(allocator->allocator_data, 1);
+    uint8_t *second = allocator->alloc(allocator->allocator_data, 1);
+    STAssertNotNULL(first, @"Allocation failed");
+    STAssertNotNULL(second, @"Allocation failed");
+    STAssertEquals((uintptr_t) 0, ((uintptr_t) first) % 16, @"Allocation is not aligned");
+    STAssertEquals((uintptr_t) 0, ((uintptr_t) second) % 16, @"Allocation is not aligned");
+    STAssertEquals((ptrdiff_t) 16, second - first, @"Allocations were not served sequentially from the arena");
+
+    /* Free is a no-op */
+    allocator->free(allocator->allocator_data, first);
+
+    plcrash_report_arena_free(arena);
+}
+
+/**
+ * Test growth beyond the initial chunk, and coalescing of chunks on reset.
+ */
+- (void) testGrowAndReset {
+    plcrash_report_arena_t *arena = plcrash_report_arena_new(PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE);
+    ProtobufCAllocator *allocator = plcrash_report_arena_allocator(arena);
+
+    /* Exceed the initial chunk */
+    uint8_t *large = allocator->alloc(allocator->allocator_data, PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE * 4);
+    STAssertNotNULL(large, @"Allocation failed");
+    memset(large, 0xFF, PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE * 4);
+
+    size_t capacity = plcrash_report_arena_capacity(arena);
+    STAssertTrue(capacity >= PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE * 5, @"Arena did not grow");
+
+    /* Reset should preserve the total capacity in a single chunk */
+    plcrash_report_arena_reset(arena);
+    STAssertEquals(capacity, plcrash_report_arena_capacity(arena), @"Capacity was not preserved");
+
+    uint8_t *reused = allocator->alloc(allocator->allocator_data, PLCRASH_REPORT_ARENA_MIN_CHUNK_SIZE * 4);
+    STAssertNotNULL(reused, @"Allocation failed");
+    STAssertEquals(capacity, plcrash_report_arena_capacity(arena), @"Arena grew after coalescing");
+
+    plcrash_report_arena_free(arena);
+}
+
+/**
+ * Test reuse of released arenas.
+ */
+- (void) testAcquireRelease {
+    plcrash_report_arena_t *arena = plcrash_report_arena_acquire(1024);
+    STAssertNotNULL(arena, @"Failed to acquire arena");
+    plcrash_report_arena_release(arena);
+
+    plcrash_report_arena_t *reused = plcrash_report_arena_acquire(1024);
+    STAssertEquals(arena, reused, @"Released arena was not reused");
+
+    /* An outstanding arena must never be returned */
+    plcrash_report_arena_t *other = plcrash_report_arena_acquire(1024);
+    STAssertNotNULL(other, @"Failed to acquire arena");
+    STAssertNotEquals(reused, other, @"Outstanding arena was returned");
+
+    plcrash_report_arena_release(other);
+    plcrash_report_arena_release(reused);
+}
+
+@end
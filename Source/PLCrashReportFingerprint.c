@@ -0,0 +1,639 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashReportFingerprint.h"
+
+#include <string.h>
+#include <stdbool.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_report_fingerprint
+ * @{
+ */
+
+/* Field numbers from crash_report.proto. These must be kept in sync with the protobuf definition. */
+enum {
+    /* CrashReport */
+    FIELD_REPORT_THREADS = 3,
+    FIELD_REPORT_BINARY_IMAGES = 4,
+    FIELD_REPORT_EXCEPTION = 5,
+    FIELD_REPORT_SIGNAL = 6,
+
+    /* CrashReport.Thread */
+    FIELD_THREAD_FRAMES = 2,
+    FIELD_THREAD_CRASHED = 3,
+
+    /* CrashReport.Thread.StackFrame */
+    FIELD_FRAME_PC = 3,
+    FIELD_FRAME_IMAGE_INDEX = 7,
+    FIELD_FRAME_OFFSET_DELTA = 8,
+
+    /* CrashReport.BinaryImage */
+    FIELD_IMAGE_BASE_ADDRESS = 1,
+    FIELD_IMAGE_SIZE = 2,
+    FIELD_IMAGE_NAME = 3,
+    FIELD_IMAGE_UUID = 4,
+
+    /* CrashReport.Exception */
+    FIELD_EXCEPTION_NAME = 1,
+
+    /* CrashReport.Signal */
+    FIELD_SIGNAL_NAME = 1,
+    FIELD_SIGNAL_CODE = 2,
+    FIELD_SIGNAL_MACH_EXCEPTION = 4,
+
+    /* CrashReport.Signal.MachException */
+    FIELD_MACH_EXCEPTION_TYPE = 1,
+};
+
+/* Protobuf wire types */
+enum {
+    WIRETYPE_VARINT = 0,
+    WIRETYPE_64BIT = 1,
+    WIRETYPE_LENGTH_PREFIXED = 2,
+    WIRETYPE_32BIT = 5
+};
+
+/* FNV-1a 64-bit parameters */
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+/**
+ * @internal
+ *
+ * A protobuf message field reader.
+ */
+typedef struct pb_reader {
+    /** Current position. */
+    const uint8_t *cursor;
+
+    /** End of the message. */
+    const uint8_t *end;
+} pb_reader_t;
+
+/**
+ * @internal
+ *
+ * A decoded protobuf field.
+ */
+typedef struct pb_field {
+    /** Field number. */
+    uint32_t number;
+
+    /** Wire type. */
+    uint32_t wiretype;
+
+    /** The field's value, for varint and fixed-width fields. */
+    uint64_t value;
+
+    /** The field's data, for length-prefixed fields. */
+    const uint8_t *data;
+
+    /** Length of @a data. */
+    size_t length;
+} pb_field_t;
+
+/** A byte range within the encoded report. */
+typedef struct pb_range {
+    const uint8_t *data;
+    size_t length;
+} pb_range_t;
+
+static void pb_reader_init (pb_reader_t *reader, const uint8_t *data, size_t length) {
+    reader->cursor = data;
+    reader->end = data + length;
+}
+
+static bool pb_read_varint (pb_reader_t *reader, uint64_t *result) {
+    uint64_t value = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (reader->cursor >= reader->end)
+            return false;
+
+        uint8_t byte = *reader->cursor++;
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+        if ((byte & 0x80) == 0) {
+            *result = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Read the next field from @a reader. Returns PLCRASH_ENOTFOUND at the end of the message, or PLCRASH_EINVAL
+ * if the message is malformed.
+ */
+static plcrash_error_t pb_next_field (pb_reader_t *reader, pb_field_t *field) {
+    uint64_t tag;
+    uint64_t length;
+
+    if (reader->cursor == reader->end)
+        return PLCRASH_ENOTFOUND;
+
+    if (!pb_read_varint(reader, &tag) || (tag >> 3) == 0 || (tag >> 3) > UINT32_MAX)
+        return PLCRASH_EINVAL;
+
+    field->number = (uint32_t) (tag >> 3);
+    field->wiretype = (uint32_t) (tag & 0x7);
+    field->value = 0;
+    field->data = NULL;
+    field->length = 0;
+
+    switch (field->wiretype) {
+        case WIRETYPE_VARINT:
+            if (!pb_read_varint(reader, &field->value))
+                return PLCRASH_EINVAL;
+            return PLCRASH_ESUCCESS;
+
+        case WIRETYPE_64BIT:
+            if (reader->end - reader->cursor < 8)
+                return PLCRASH_EINVAL;
+            memcpy(&field->value, reader->cursor, 8);
+            reader->cursor += 8;
+            return PLCRASH_ESUCCESS;
+
+        case WIRETYPE_32BIT: {
+            uint32_t value;
+            if (reader->end - reader->cursor < 4)
+                return PLCRASH_EINVAL;
+            memcpy(&value, reader->cursor, 4);
+            field->value = value;
+            reader->cursor += 4;
+            return PLCRASH_ESUCCESS;
+        }
+
+        case WIRETYPE_LENGTH_PREFIXED:
+            if (!pb_read_varint(reader, &length) || length > (uint64_t) (reader->end - reader->cursor))
+                return PLCRASH_EINVAL;
+            field->data = reader->cursor;
+            field->length = (size_t) length;
+            reader->cursor += length;
+            return PLCRASH_ESUCCESS;
+
+        default:
+            return PLCRASH_EINVAL;
+    }
+}
+
+static uint64_t fnv_hash (uint64_t hash, const void *data, size_t length) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static uint64_t fnv_hash_u64 (uint64_t hash, uint64_t value) {
+    for (unsigned int i = 0; i < 8; i++) {
+        hash ^= (uint8_t) (value >> (i * 8));
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * Hash a length-delimited value, including its length, such that adjacent values can not collide.
+ */
+static uint64_t fnv_hash_bytes (uint64_t hash, const uint8_t *data, size_t length) {
+    hash = fnv_hash_u64(hash, length);
+    return fnv_hash(hash, data, length);
+}
+
+/**
+ * Hash the string and bytes fields of @a message matching @a numbers (terminated by 0), and any varint
+ * field matching @a varint_number (if non-zero).
+ */
+static plcrash_error_t hash_message_fields (uint64_t *hash, const pb_range_t *message, const uint32_t *numbers, uint32_t varint_number) {
+    pb_reader_t reader;
+    pb_field_t field;
+    plcrash_error_t err;
+
+    pb_reader_init(&reader, message->data, message->length);
+    while ((err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+        if (field.wiretype == WIRETYPE_VARINT && varint_number != 0 && field.number == varint_number) {
+            *hash = fnv_hash_u64(fnv_hash_u64(*hash, field.number), field.value);
+            continue;
+        }
+
+        if (field.wiretype != WIRETYPE_LENGTH_PREFIXED)
+            continue;
+
+        for (const uint32_t *n = numbers; *n != 0; n++) {
+            if (field.number == *n) {
+                *hash = fnv_hash_bytes(fnv_hash_u64(*hash, field.number), field.data, field.length);
+                break;
+            }
+        }
+    }
+
+    return err == PLCRASH_ENOTFOUND ? PLCRASH_ESUCCESS : err;
+}
+
+/**
+ * Find the base address of the binary image at @a image_index within the report's binary images. Used to resolve
+ * the PCs of compact (PLCRASH_REPORT_FILE_VERSION_COMPACT) frames.
+ */
+static plcrash_error_t find_image_base (const uint8_t *message, size_t length, uint64_t image_index, uint64_t *base) {
+    pb_reader_t reader;
+    pb_field_t field;
+    plcrash_error_t err;
+    uint64_t count = 0;
+
+    pb_reader_init(&reader, message, length);
+    while ((err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+        if (field.number != FIELD_REPORT_BINARY_IMAGES || field.wiretype != WIRETYPE_LENGTH_PREFIXED)
+            continue;
+
+        if (count++ != image_index)
+            continue;
+
+        pb_reader_t image_reader;
+        pb_field_t image_field;
+
+        *base = 0;
+        pb_reader_init(&image_reader, field.data, field.length);
+        while ((err = pb_next_field(&image_reader, &image_field)) == PLCRASH_ESUCCESS) {
+            if (image_field.number == FIELD_IMAGE_BASE_ADDRESS)
+                *base = image_field.value;
+        }
+
+        return err == PLCRASH_ENOTFOUND ? PLCRASH_ESUCCESS : err;
+    }
+
+    if (err != PLCRASH_ENOTFOUND)
+        return err;
+
+    /* Image index out of range */
+    return PLCRASH_EINVAL;
+}
+
+/**
+ * Hash the image-relative address of @a pc, using the containing image's UUID (or name, if the image has no UUID)
+ * to identify the image. If no image contains @a pc, the absolute address is hashed.
+ */
+static plcrash_error_t hash_frame (uint64_t *hash, uint64_t pc, const uint8_t *message, size_t length) {
+    pb_reader_t reader;
+    pb_field_t field;
+    plcrash_error_t err;
+
+    pb_reader_init(&reader, message, length);
+    while ((err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+        if (field.number != FIELD_REPORT_BINARY_IMAGES || field.wiretype != WIRETYPE_LENGTH_PREFIXED)
+            continue;
+
+        /* Parse the image record */
+        pb_reader_t image_reader;
+        pb_field_t image_field;
+        uint64_t base = 0;
+        uint64_t size = 0;
+        pb_range_t name = { NULL, 0 };
+        pb_range_t uuid = { NULL, 0 };
+
+        pb_reader_init(&image_reader, field.data, field.length);
+        while ((err = pb_next_field(&image_reader, &image_field)) == PLCRASH_ESUCCESS) {
+            switch (image_field.number) {
+                case FIELD_IMAGE_BASE_ADDRESS:
+                    base = image_field.value;
+                    break;
+                case FIELD_IMAGE_SIZE:
+                    size = image_field.value;
+                    break;
+                case FIELD_IMAGE_NAME:
+                    name.data = image_field.data;
+                    name.length = image_field.length;
+                    break;
+                case FIELD_IMAGE_UUID:
+                    uuid.data = image_field.data;
+                    uuid.length = image_field.length;
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (err != PLCRASH_ENOTFOUND)
+            return err;
+
+        if (pc < base || pc - base >= size)
+            continue;
+
+        /* Found */
+        if (uuid.length > 0)
+            *hash = fnv_hash_bytes(*hash, uuid.data, uuid.length);
+        else
+            *hash = fnv_hash_bytes(*hash, name.data, name.length);
+
+        *hash = fnv_hash_u64(*hash, pc - base);
+        return PLCRASH_ESUCCESS;
+    }
+
+    if (err != PLCRASH_ENOTFOUND)
+        return err;
+
+    /* No matching image */
+    *hash = fnv_hash_bytes(*hash, NULL, 0);
+    *hash = fnv_hash_u64(*hash, pc);
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Hash the located @a crashed_thread, @a signal and @a exception records (any of which may be absent), resolving
+ * frame PCs against the binary image records of @a images, a CrashReport encoding containing all of the report's
+ * binary images in written order.
+ */
+static plcrash_error_t hash_records (uint64_t *fingerprint, const pb_range_t *crashed_thread, const pb_range_t *signal, const pb_range_t *exception,
+                                     const uint8_t *images, size_t images_length, size_t frame_count)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    pb_reader_t reader;
+    pb_field_t field;
+    plcrash_error_t err;
+
+    /* Signal info */
+    if (signal->data != NULL) {
+        static const uint32_t signal_fields[] = { FIELD_SIGNAL_NAME, FIELD_SIGNAL_CODE, 0 };
+        if ((err = hash_message_fields(&hash, signal, signal_fields, 0)) != PLCRASH_ESUCCESS)
+            return err;
+
+        /* Mach exception type */
+        pb_reader_init(&reader, signal->data, signal->length);
+        while ((err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+            if (field.number == FIELD_SIGNAL_MACH_EXCEPTION && field.wiretype == WIRETYPE_LENGTH_PREFIXED) {
+                static const uint32_t no_fields[] = { 0 };
+                pb_range_t mach = { field.data, field.length };
+                if ((err = hash_message_fields(&hash, &mach, no_fields, FIELD_MACH_EXCEPTION_TYPE)) != PLCRASH_ESUCCESS)
+                    return err;
+            }
+        }
+        if (err != PLCRASH_ENOTFOUND)
+            return err;
+    }
+
+    /* Exception name */
+    if (exception->data != NULL) {
+        static const uint32_t exception_fields[] = { FIELD_EXCEPTION_NAME, 0 };
+        if ((err = hash_message_fields(&hash, exception, exception_fields, 0)) != PLCRASH_ESUCCESS)
+            return err;
+    }
+
+    /* Crashed thread frames */
+    if (crashed_thread->data != NULL) {
+        size_t frames = 0;
+        uint64_t image_offset = 0;
+
+        pb_reader_init(&reader, crashed_thread->data, crashed_thread->length);
+        while (frames < frame_count && (err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+            if (field.number != FIELD_THREAD_FRAMES || field.wiretype != WIRETYPE_LENGTH_PREFIXED)
+                continue;
+
+            /* Find the PC */
+            pb_reader_t frame_reader;
+            pb_field_t frame_field;
+            uint64_t pc = 0;
+            bool compact = false;
+            uint64_t image_index = 0;
+            uint64_t offset_delta = 0;
+
+            pb_reader_init(&frame_reader, field.data, field.length);
+            while ((err = pb_next_field(&frame_reader, &frame_field)) == PLCRASH_ESUCCESS) {
+                if (frame_field.wiretype != WIRETYPE_VARINT)
+                    continue;
+
+                if (frame_field.number == FIELD_FRAME_PC) {
+                    pc = frame_field.value;
+                } else if (frame_field.number == FIELD_FRAME_IMAGE_INDEX) {
+                    compact = true;
+                    image_index = frame_field.value;
+                } else if (frame_field.number == FIELD_FRAME_OFFSET_DELTA) {
+                    offset_delta = frame_field.value;
+                }
+            }
+            if (err != PLCRASH_ENOTFOUND)
+                return err;
+
+            /* Resolve compact frames; the zigzag-encoded delta is relative to the previous compact frame's offset */
+            if (compact) {
+                uint64_t base;
+                if ((err = find_image_base(images, images_length, image_index, &base)) != PLCRASH_ESUCCESS)
+                    return err;
+
+                image_offset += (offset_delta >> 1) ^ (~(offset_delta & 1) + 1);
+                pc = base + image_offset;
+            }
+
+            if ((err = hash_frame(&hash, pc, images, images_length)) != PLCRASH_ESUCCESS)
+                return err;
+
+            frames++;
+        }
+
+        if (frames < frame_count && err != PLCRASH_ENOTFOUND)
+            return err;
+    }
+
+    *fingerprint = hash;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Compute a crash bucketing fingerprint from an encoded crash report message, without unpacking the message.
+ *
+ * The fingerprint covers the top @a frame_count frames of the crashed thread, each identified by its
+ * containing image's UUID and its image-relative PC, along with the signal name and code, the Mach exception type
+ * (if any), and the uncaught exception name (if any). Values that vary between otherwise identical crashes, such as
+ * image load addresses, fault addresses and exception reasons, are excluded.
+ *
+ * @param message The encoded crash report message, following the PLCrashReportFileHeader.
+ * @param length The length of @a message.
+ * @param frame_count The maximum number of crashed thread frames to include.
+ * @param fingerprint On success, the computed fingerprint.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if the report is malformed.
+ */
+plcrash_error_t plcrash_report_fingerprint (const void *message, size_t length, size_t frame_count, uint64_t *fingerprint) {
+    pb_range_t crashed_thread = { NULL, 0 };
+    pb_range_t signal = { NULL, 0 };
+    pb_range_t exception = { NULL, 0 };
+    pb_reader_t reader;
+    pb_field_t field;
+    plcrash_error_t err;
+
+    /* Locate the top-level records */
+    pb_reader_init(&reader, message, length);
+    while ((err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+        if (field.wiretype != WIRETYPE_LENGTH_PREFIXED)
+            continue;
+
+        switch (field.number) {
+            case FIELD_REPORT_THREADS: {
+                /* Check whether this is the crashed thread */
+                pb_reader_t thread_reader;
+                pb_field_t thread_field;
+
+                if (crashed_thread.data != NULL)
+                    break;
+
+                pb_reader_init(&thread_reader, field.data, field.length);
+                while ((err = pb_next_field(&thread_reader, &thread_field)) == PLCRASH_ESUCCESS) {
+                    if (thread_field.number == FIELD_THREAD_CRASHED && thread_field.wiretype == WIRETYPE_VARINT && thread_field.value) {
+                        crashed_thread.data = field.data;
+                        crashed_thread.length = field.length;
+                    }
+                }
+                if (err != PLCRASH_ENOTFOUND)
+                    return err;
+                break;
+            }
+
+            case FIELD_REPORT_SIGNAL:
+                signal.data = field.data;
+                signal.length = field.length;
+                break;
+
+            case FIELD_REPORT_EXCEPTION:
+                exception.data = field.data;
+                exception.length = field.length;
+                break;
+
+            default:
+                break;
+        }
+    }
+    if (err != PLCRASH_ENOTFOUND)
+        return err;
+
+    return hash_records(fingerprint, &crashed_thread, &signal, &exception, message, length, frame_count);
+}
+
+/**
+ * Locate the last top-level record of @a field_number within the footer section @a range of @a message. Returns
+ * PLCRASH_EINVAL if the range does not lie within the message, or does not contain complete records. If no such
+ * record is found, @a record is left unmodified.
+ */
+static plcrash_error_t find_section_record (const uint8_t *message, size_t length, const plcrash_report_range_t *range, uint32_t field_number,
+                                            pb_range_t *record)
+{
+    pb_reader_t reader;
+    pb_field_t field;
+    plcrash_error_t err;
+
+    if (range->offset > length || range->length > length - range->offset)
+        return PLCRASH_EINVAL;
+
+    pb_reader_init(&reader, message + range->offset, range->length);
+    while ((err = pb_next_field(&reader, &field)) == PLCRASH_ESUCCESS) {
+        if (field.number != field_number || field.wiretype != WIRETYPE_LENGTH_PREFIXED)
+            continue;
+
+        record->data = field.data;
+        record->length = field.length;
+    }
+
+    return err == PLCRASH_ENOTFOUND ? PLCRASH_ESUCCESS : err;
+}
+
+/**
+ * Compute the fingerprint of an encoded crash report message using the section ranges of its @a footer (see
+ * plcrash_report_reader_read_footer()), reading only the crashed thread, signal, exception and binary image records,
+ * rather than scanning the full message. The result is identical to that of plcrash_report_fingerprint().
+ *
+ * If the footer is incomplete (the report has more sections than may be listed), the full message is scanned. If
+ * the binary images were not written as a single section, they are located by scanning the full message.
+ *
+ * @param message The encoded crash report message, following the PLCrashReportFileHeader. If the report was
+ * compressed, this must be the decompressed message.
+ * @param length The length of @a message.
+ * @param footer The report's decoded footer. The section ranges are verified to lie within @a message.
+ * @param frame_count The maximum number of crashed thread frames to include.
+ * @param fingerprint On success, the computed fingerprint.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_EINVAL if the report or its footer is malformed.
+ */
+plcrash_error_t plcrash_report_fingerprint_footer (const void *message, size_t length, const plcrash_report_footer_t *footer, size_t frame_count,
+                                                   uint64_t *fingerprint)
+{
+    pb_range_t crashed_thread = { NULL, 0 };
+    pb_range_t signal = { NULL, 0 };
+    pb_range_t exception = { NULL, 0 };
+    const uint8_t *images = message;
+    size_t images_length = length;
+    plcrash_report_range_t range;
+    plcrash_error_t err;
+
+    /* Records beyond the listed sections can only be found by scanning */
+    if (footer->count >= PLCRASH_REPORT_FOOTER_MAX_SECTIONS)
+        return plcrash_report_fingerprint(message, length, frame_count, fingerprint);
+
+    if (footer->has_crashed_thread) {
+        if ((err = find_section_record(message, length, &footer->crashed_thread, FIELD_REPORT_THREADS, &crashed_thread)) != PLCRASH_ESUCCESS)
+            return err;
+
+        /* The range must contain the crashed thread's record */
+        if (crashed_thread.data == NULL)
+            return PLCRASH_EINVAL;
+    }
+
+    if (plcrash_report_footer_find(footer, FIELD_REPORT_SIGNAL, &range)) {
+        if ((err = find_section_record(message, length, &range, FIELD_REPORT_SIGNAL, &signal)) != PLCRASH_ESUCCESS)
+            return err;
+    }
+
+    if (plcrash_report_footer_find(footer, FIELD_REPORT_EXCEPTION, &range)) {
+        if ((err = find_section_record(message, length, &range, FIELD_REPORT_EXCEPTION, &exception)) != PLCRASH_ESUCCESS)
+            return err;
+    }
+
+    /* Compact frames refer to images by index, which is only preserved if all images are within a single section */
+    size_t image_sections = 0;
+    for (size_t i = 0; i < footer->count; i++) {
+        if (footer->sections[i].field == FIELD_REPORT_BINARY_IMAGES) {
+            range = footer->sections[i].range;
+            image_sections++;
+        }
+    }
+
+    if (image_sections == 1) {
+        if (range.offset > length || range.length > length - range.offset)
+            return PLCRASH_EINVAL;
+
+        images = (const uint8_t *) message + range.offset;
+        images_length = range.length;
+    }
+
+    return hash_records(fingerprint, &crashed_thread, &signal, &exception, images, images_length, frame_count);
+}
+
+/**
+ * @} plcrash_report_fingerprint
+ */
@@ -0,0 +1,72 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_REPORT_FINGERPRINT_H
+#define PLCRASH_REPORT_FINGERPRINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashReportReader.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_report_fingerprint Crash Report Fingerprinting
+ *
+ * Computes a crash bucketing fingerprint directly from an encoded crash report, without unpacking the
+ * report's protobuf message.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * The default number of crashed thread frames included in a fingerprint.
+ */
+#define PLCRASH_REPORT_FINGERPRINT_DEFAULT_FRAMES 5
+
+plcrash_error_t plcrash_report_fingerprint (const void *message, size_t length, size_t frame_count, uint64_t *fingerprint);
+plcrash_error_t plcrash_report_fingerprint_footer (const void *message, size_t length, const plcrash_report_footer_t *footer, size_t frame_count,
+                                                   uint64_t *fingerprint);
+
+/**
+ * @} plcrash_report_fingerprint
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_REPORT_FINGERPRINT_H */
@@ -0,0 +1,219 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashReportFingerprint.h"
+
+@interface PLCrashReportFingerprintTests : SenTestCase {
+@private
+}
+
+@end
+
+/* Append a varint to @a data */
+static void append_varint (NSMutableData *data, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            byte |= 0x80;
+        [data appendBytes: &byte length: 1];
+    } while (value != 0);
+}
+
+/* Append a varint field */
+static void append_varint_field (NSMutableData *data, uint32_t field, uint64_t value) {
+    append_varint(data, (field << 3) | 0);
+    append_varint(data, value);
+}
+
+/* Append a length-delimited field */
+static void append_bytes_field (NSMutableData *data, uint32_t field, const void *bytes, size_t length) {
+    append_varint(data, (field << 3) | 2);
+    append_varint(data, length);
+    [data appendBytes: bytes length: length];
+}
+
+static void append_message_field (NSMutableData *data, uint32_t field, NSData *message) {
+    append_bytes_field(data, field, [message bytes], [message length]);
+}
+
+static void append_string_field (NSMutableData *data, uint32_t field, const char *string) {
+    append_bytes_field(data, field, string, strlen(string));
+}
+
+/* Read a varint from @a bytes at @a offset, advancing @a offset */
+static uint64_t read_varint (const uint8_t *bytes, size_t *offset) {
+    uint64_t value = 0;
+    for (unsigned int shift = 0; ; shift += 7) {
+        uint8_t byte = bytes[(*offset)++];
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+        if ((byte & 0x80) == 0)
+            return value;
+    }
+}
+
+/* Build the footer that would be written for @a report, whose top-level records must all be length-delimited. The
+ * record at @a crashed_index among the thread records is marked as the crashed thread. */
+static void build_footer (NSData *report, uint32_t crashed_index, plcrash_report_footer_t *footer) {
+    const uint8_t *bytes = [report bytes];
+    size_t offset = 0;
+    uint32_t threads = 0;
+
+    memset(footer, 0, sizeof(*footer));
+    while (offset < [report length]) {
+        size_t start = offset;
+        uint32_t field = (uint32_t) (read_varint(bytes, &offset) >> 3);
+        offset += read_varint(bytes, &offset);
+
+        /* Extend the open section, or start a new one */
+        plcrash_report_section_t *section = footer->count > 0 ? &footer->sections[footer->count - 1] : NULL;
+        if (section != NULL && section->field == field) {
+            section->range.length = offset - section->range.offset;
+        } else {
+            section = &footer->sections[footer->count++];
+            section->field = field;
+            section->range.offset = start;
+            section->range.length = offset - start;
+        }
+
+        if (field == 3 && threads++ == crashed_index) {
+            footer->has_crashed_thread = true;
+            footer->crashed_thread_index = crashed_index;
+            footer->crashed_thread.offset = start;
+            footer->crashed_thread.length = offset - start;
+        }
+    }
+}
+
+@implementation PLCrashReportFingerprintTests
+
+/**
+ * Encode a minimal crash report message with a single image loaded at @a base, a crashed thread with a
+ * single frame at @a base + 0x10, and the given signal name.
+ */
+- (NSData *) reportWithImageBase: (uint64_t) base signal: (const char *) signalName {
+    static const uint8_t uuid[16] = { 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF, 0x10 };
+    NSMutableData *report = [NSMutableData data];
+
+    /* Non-crashed thread */
+    NSMutableData *frame = [NSMutableData data];
+    append_varint_field(frame, 3, base + 0x20);
+
+    NSMutableData *thread = [NSMutableData data];
+    append_varint_field(thread, 1, 0);
+    append_message_field(thread, 2, frame);
+    append_varint_field(thread, 3, 0);
+    append_message_field(report, 3, thread);
+
+    /* Crashed thread */
+    frame = [NSMutableData data];
+    append_varint_field(frame, 3, base + 0x10);
+
+    thread = [NSMutableData data];
+    append_varint_field(thread, 1, 1);
+    append_message_field(thread, 2, frame);
+    append_varint_field(thread, 3, 1);
+    append_message_field(report, 3, thread);
+
+    /* Image */
+    NSMutableData *image = [NSMutableData data];
+    append_varint_field(image, 1, base);
+    append_varint_field(image, 2, 0x1000);
+    append_string_field(image, 3, "/usr/lib/libtest.dylib");
+    append_bytes_field(image, 4, uuid, sizeof(uuid));
+    append_message_field(report, 4, image);
+
+    /* Signal */
+    NSMutableData *signal = [NSMutableData data];
+    append_string_field(signal, 1, signalName);
+    append_string_field(signal, 2, "SEGV_MAPERR");
+    append_varint_field(signal, 3, base + 0x500);
+    append_message_field(report, 6, signal);
+
+    return report;
+}
+
+- (uint64_t) fingerprintForReport: (NSData *) report {
+    uint64_t fingerprint = 0;
+    plcrash_error_t err = plcrash_report_fingerprint([report bytes], [report length], PLCRASH_REPORT_FINGERPRINT_DEFAULT_FRAMES, &fingerprint);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to compute fingerprint");
+    return fingerprint;
+}
+
+/**
+ * Verify that fingerprints are independent of image load addresses.
+ */
+- (void) testImageRelative {
+    uint64_t first = [self fingerprintForReport: [self reportWithImageBase: 0x1000 signal: "SIGSEGV"]];
+    uint64_t second = [self fingerprintForReport: [self reportWithImageBase: 0x8000 signal: "SIGSEGV"]];
+    STAssertEquals(first, second, @"Fingerprint should not depend on the image load address");
+}
+
+/**
+ * Verify that the signal info is included in the fingerprint.
+ */
+- (void) testSignal {
+    uint64_t first = [self fingerprintForReport: [self reportWithImageBase: 0x1000 signal: "SIGSEGV"]];
+    uint64_t second = [self fingerprintForReport: [self reportWithImageBase: 0x1000 signal: "SIGBUS"]];
+    STAssertNotEquals(first, second, @"Fingerprint should depend on the signal");
+}
+
+/**
+ * Verify that fingerprints computed from the footer's sections match those computed by scanning the report, and
+ * that out-of-range sections are rejected.
+ */
+- (void) testFooter {
+    NSData *report = [self reportWithImageBase: 0x1000 signal: "SIGSEGV"];
+    plcrash_report_footer_t footer;
+    uint64_t fingerprint;
+
+    build_footer(report, 1, &footer);
+    STAssertEquals(footer.count, (size_t) 3, @"Incorrect section count");
+
+    plcrash_error_t err = plcrash_report_fingerprint_footer([report bytes], [report length], &footer, PLCRASH_REPORT_FINGERPRINT_DEFAULT_FRAMES, &fingerprint);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to compute fingerprint");
+    STAssertEquals(fingerprint, [self fingerprintForReport: report], @"Footer fingerprint should match the scanned fingerprint");
+
+    footer.sections[footer.count - 1].range.length += 1;
+    err = plcrash_report_fingerprint_footer([report bytes], [report length], &footer, PLCRASH_REPORT_FINGERPRINT_DEFAULT_FRAMES, &fingerprint);
+    STAssertEquals(PLCRASH_EINVAL, err, @"Out-of-range section should be rejected");
+}
+
+/**
+ * Verify that malformed reports are rejected.
+ */
+- (void) testMalformed {
+    NSData *report = [self reportWithImageBase: 0x1000 signal: "SIGSEGV"];
+    uint64_t fingerprint;
+
+    plcrash_error_t err = plcrash_report_fingerprint([report bytes], [report length] - 1, PLCRASH_REPORT_FINGERPRINT_DEFAULT_FRAMES, &fingerprint);
+    STAssertEquals(PLCRASH_EINVAL, err, @"Truncated report should be rejected");
+}
+
+@end
@@ -0,0 +1,98 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "PLCrashReportStackFrameInfo.h"
+#import "PLCrashReportStringTable.h"
+#import "PLCrashReportStringPool.h"
+
+/** The symbol index of a frame with no symbol information. */
+#define PLCrashReportFrameTableNoSymbol UINT32_MAX
+
+@interface PLCrashReportFrameTable : NSObject {
+@private
+    /** The table used to intern symbol names, or nil. */
+    PLCrashReportStringTable *_strings;
+
+    /** The (borrowed) pool from which pool-resident symbol names are bridged without copying, or NULL. */
+    plcrash_report_string_pool_t *_stringPool;
+
+    /** Frame instruction pointers. */
+    uint64_t *_pcs;
+
+    /** Per-frame indices into _symbols, or PLCrashReportFrameTableNoSymbol. */
+    uint32_t *_symbolIndices;
+
+    /** Per-frame repeat and omission annotations, or NULL if no frame has been annotated. */
+    struct pl_frame_table_annotation *_annotations;
+
+    /** Per-frame PLCrashReportUnwindMethod values, or NULL if no frame has a known unwind method. */
+    uint8_t *_unwindMethods;
+
+    /** The number of frames in the table. */
+    NSUInteger _frameCount;
+
+    /** The allocated capacity of the frame arrays, in frames. */
+    NSUInteger _frameCapacity;
+
+    /** The table's unique symbols. */
+    struct pl_frame_table_symbol *_symbols;
+
+    /** The number of symbols in the table. */
+    uint32_t _symbolCount;
+
+    /** The allocated capacity of _symbols. */
+    uint32_t _symbolCapacity;
+
+    /** Maps symbol names and start addresses to symbol indices, while frames are being appended; NULL once
+     * appending has finished. */
+    CFMutableDictionaryRef _symbolLookup;
+}
+
+- (id) initWithStringTable: (PLCrashReportStringTable *) strings;
+- (id) initWithStringTable: (PLCrashReportStringTable *) strings stringPool: (plcrash_report_string_pool_t *) stringPool;
+
+- (uint32_t) indexForSymbolName: (const char *) name startAddress: (uint64_t) startAddress endAddress: (uint64_t) endAddress;
+
+- (BOOL) appendFrameWithInstructionPointer: (uint64_t) instructionPointer
+                               symbolIndex: (uint32_t) symbolIndex
+                              repeatLength: (NSUInteger) repeatLength
+                               repeatCount: (NSUInteger) repeatCount
+                         omittedFrameCount: (NSUInteger) omittedFrameCount
+                              unwindMethod: (PLCrashReportUnwindMethod) unwindMethod;
+
+- (void) finishAppending;
+
+- (uint64_t) instructionPointerAtIndex: (NSUInteger) index;
+- (NSArray *) stackFramesInRange: (NSRange) range;
+
+/** The number of frames in the table. */
+@property(nonatomic, readonly) NSUInteger frameCount;
+
+@end
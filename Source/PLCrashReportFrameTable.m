@@ -0,0 +1,383 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportFrameTable.h"
+
+#import <string.h>
+#import <stdlib.h>
+
+/* FNV-1a 32-bit parameters */
+#define FNV_OFFSET_BASIS 0x811c9dc5U
+#define FNV_PRIME 0x01000193U
+
+/**
+ * @internal
+ *
+ * A unique symbol.
+ */
+struct pl_frame_table_symbol {
+    /** The symbol name. */
+    NSString *name;
+
+    /** The symbol start address. */
+    uint64_t startAddress;
+
+    /** The symbol end address, or 0 if unknown. */
+    uint64_t endAddress;
+
+    /** The symbol's info instance, created on first use, or nil. */
+    PLCrashReportSymbolInfo *info;
+};
+
+/**
+ * @internal
+ *
+ * A frame's repeat and omission annotations; see PLCrashReportStackFrameInfo.
+ */
+struct pl_frame_table_annotation {
+    NSUInteger repeatLength;
+    NSUInteger repeatCount;
+    NSUInteger omittedFrameCount;
+};
+
+/**
+ * @internal
+ *
+ * A symbol lookup key. Keys are copied on insertion, such that lookups may be performed directly against the decoded
+ * protobuf strings.
+ */
+struct pl_frame_table_symbol_key {
+    uint64_t startAddress;
+    const char *name;
+};
+
+static const void *pl_symbol_key_retain (CFAllocatorRef allocator, const void *value) {
+    const struct pl_frame_table_symbol_key *key = value;
+    size_t length = strlen(key->name) + 1;
+
+    struct pl_frame_table_symbol_key *copy = malloc(sizeof(*copy) + length);
+    if (copy == NULL)
+        return NULL;
+
+    char *name = (char *) (copy + 1);
+    memcpy(name, key->name, length);
+    copy->startAddress = key->startAddress;
+    copy->name = name;
+
+    return copy;
+}
+
+static void pl_symbol_key_release (CFAllocatorRef allocator, const void *value) {
+    free((void *) value);
+}
+
+static Boolean pl_symbol_key_equal (const void *value1, const void *value2) {
+    const struct pl_frame_table_symbol_key *lhs = value1;
+    const struct pl_frame_table_symbol_key *rhs = value2;
+
+    return lhs->startAddress == rhs->startAddress && strcmp(lhs->name, rhs->name) == 0;
+}
+
+static CFHashCode pl_symbol_key_hash (const void *value) {
+    const struct pl_frame_table_symbol_key *key = value;
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (const uint8_t *p = (const uint8_t *) key->name; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+
+    return hash ^ (CFHashCode) key->startAddress;
+}
+
+/**
+ * @internal
+ *
+ * Compact storage for the stack frames of all threads within a report. Frames are stored as parallel arrays of
+ * instruction pointers and indices into the table's unique symbols; the corresponding PLCrashReportStackFrameInfo
+ * and PLCrashReportSymbolInfo instances are only created when a thread's frames are requested.
+ *
+ * Frames are appended by a single thread while decoding the report. Once appending has finished, the table is
+ * immutable, and safe for use from multiple threads.
+ */
+@implementation PLCrashReportFrameTable
+
+/**
+ * Initialize an empty frame table.
+ *
+ * @param strings The table to be used to intern symbol names, or nil.
+ */
+- (id) initWithStringTable: (PLCrashReportStringTable *) strings {
+    return [self initWithStringTable: strings stringPool: NULL];
+}
+
+/**
+ * Initialize an empty frame table.
+ *
+ * @param strings The table to be used to intern symbol names, or nil.
+ * @param stringPool If non-NULL, symbol names allocated from this pool are bridged to NSString without copying.
+ * The pool is borrowed, and must remain valid until finishAppending is called. Ignored if @a strings is non-nil.
+ */
+- (id) initWithStringTable: (PLCrashReportStringTable *) strings stringPool: (plcrash_report_string_pool_t *) stringPool {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    CFDictionaryKeyCallBacks keyCallbacks = {
+        .version = 0,
+        .retain = pl_symbol_key_retain,
+        .release = pl_symbol_key_release,
+        .copyDescription = NULL,
+        .equal = pl_symbol_key_equal,
+        .hash = pl_symbol_key_hash
+    };
+
+    _symbolLookup = CFDictionaryCreateMutable(NULL, 0, &keyCallbacks, NULL);
+    if (_symbolLookup == NULL) {
+        [self release];
+        return nil;
+    }
+
+    _strings = [strings retain];
+    _stringPool = stringPool;
+    return self;
+}
+
+- (void) dealloc {
+    if (_symbolLookup != NULL)
+        CFRelease(_symbolLookup);
+
+    for (uint32_t i = 0; i < _symbolCount; i++) {
+        [_symbols[i].name release];
+        [_symbols[i].info release];
+    }
+
+    free(_symbols);
+    free(_pcs);
+    free(_symbolIndices);
+    free(_annotations);
+    free(_unwindMethods);
+    [_strings release];
+
+    [super dealloc];
+}
+
+/**
+ * Return the index of the symbol with the given @a name and @a startAddress, adding it to the table if necessary.
+ *
+ * @param name The symbol's NUL-terminated UTF-8 name.
+ * @param startAddress The symbol's start address.
+ * @param endAddress The symbol's end address, or 0 if unknown.
+ *
+ * @return Returns the symbol index, or PLCrashReportFrameTableNoSymbol if the symbol could not be added.
+ */
+- (uint32_t) indexForSymbolName: (const char *) name startAddress: (uint64_t) startAddress endAddress: (uint64_t) endAddress {
+    struct pl_frame_table_symbol_key key = { .startAddress = startAddress, .name = name };
+    const void *value;
+
+    NSAssert(_symbolLookup != NULL, @"Symbols added after appending has finished");
+    if (CFDictionaryGetValueIfPresent(_symbolLookup, &key, &value))
+        return (uint32_t) (uintptr_t) value;
+
+    if (_symbolCount == PLCrashReportFrameTableNoSymbol)
+        return PLCrashReportFrameTableNoSymbol;
+
+    NSString *symbolName;
+    if (_strings != nil)
+        symbolName = [_strings stringWithUTF8String: name];
+    else if (_stringPool != NULL)
+        symbolName = [(NSString *) plcrash_report_string_pool_create_string(_stringPool, name) autorelease];
+    else
+        symbolName = [NSString stringWithUTF8String: name];
+
+    if (symbolName == nil)
+        return PLCrashReportFrameTableNoSymbol;
+
+    if (_symbolCount == _symbolCapacity) {
+        uint32_t capacity = (_symbolCapacity == 0) ? 64 : _symbolCapacity * 2;
+        struct pl_frame_table_symbol *symbols = realloc(_symbols, capacity * sizeof(*symbols));
+        if (symbols == NULL)
+            return PLCrashReportFrameTableNoSymbol;
+
+        _symbols = symbols;
+        _symbolCapacity = capacity;
+    }
+
+    uint32_t index = _symbolCount++;
+    _symbols[index].name = [symbolName retain];
+    _symbols[index].startAddress = startAddress;
+    _symbols[index].endAddress = endAddress;
+    _symbols[index].info = nil;
+
+    CFDictionarySetValue(_symbolLookup, &key, (const void *) (uintptr_t) index);
+    return index;
+}
+
+/**
+ * Append a frame to the table.
+ *
+ * @param instructionPointer The frame's instruction pointer.
+ * @param symbolIndex The frame's symbol index, as returned by indexForSymbolName:startAddress:endAddress:, or
+ * PLCrashReportFrameTableNoSymbol.
+ * @param repeatLength The length of the repeated sequence ending at this frame, or 0.
+ * @param repeatCount The number of additional repetitions of the sequence ending at this frame.
+ * @param omittedFrameCount The number of frames omitted following this frame.
+ * @param unwindMethod The method by which the frame was unwound.
+ *
+ * @return Returns NO if the frame could not be allocated.
+ */
+- (BOOL) appendFrameWithInstructionPointer: (uint64_t) instructionPointer
+                               symbolIndex: (uint32_t) symbolIndex
+                              repeatLength: (NSUInteger) repeatLength
+                               repeatCount: (NSUInteger) repeatCount
+                         omittedFrameCount: (NSUInteger) omittedFrameCount
+                              unwindMethod: (PLCrashReportUnwindMethod) unwindMethod
+{
+    if (_frameCount == _frameCapacity) {
+        NSUInteger capacity = (_frameCapacity == 0) ? 256 : _frameCapacity * 2;
+        uint64_t *pcs = realloc(_pcs, capacity * sizeof(*pcs));
+        if (pcs == NULL)
+            return NO;
+        _pcs = pcs;
+
+        uint32_t *symbolIndices = realloc(_symbolIndices, capacity * sizeof(*symbolIndices));
+        if (symbolIndices == NULL)
+            return NO;
+        _symbolIndices = symbolIndices;
+
+        if (_annotations != NULL) {
+            struct pl_frame_table_annotation *annotations = realloc(_annotations, capacity * sizeof(*annotations));
+            if (annotations == NULL)
+                return NO;
+            _annotations = annotations;
+        }
+
+        if (_unwindMethods != NULL) {
+            uint8_t *unwindMethods = realloc(_unwindMethods, capacity * sizeof(*unwindMethods));
+            if (unwindMethods == NULL)
+                return NO;
+            _unwindMethods = unwindMethods;
+        }
+
+        _frameCapacity = capacity;
+    }
+
+    /* Annotations are rare; the array is only allocated once the first annotated frame is appended */
+    if (_annotations == NULL && (repeatLength != 0 || omittedFrameCount != 0)) {
+        if ((_annotations = calloc(_frameCapacity, sizeof(*_annotations))) == NULL)
+            return NO;
+    }
+
+    /* Reports written by earlier versions of the library do not record unwind methods */
+    if (_unwindMethods == NULL && unwindMethod != PLCrashReportUnwindMethodUnknown) {
+        if ((_unwindMethods = calloc(_frameCapacity, sizeof(*_unwindMethods))) == NULL)
+            return NO;
+    }
+
+    _pcs[_frameCount] = instructionPointer;
+    _symbolIndices[_frameCount] = symbolIndex;
+    if (_annotations != NULL) {
+        _annotations[_frameCount].repeatLength = repeatLength;
+        _annotations[_frameCount].repeatCount = repeatCount;
+        _annotations[_frameCount].omittedFrameCount = omittedFrameCount;
+    }
+    if (_unwindMethods != NULL)
+        _unwindMethods[_frameCount] = (uint8_t) unwindMethod;
+
+    _frameCount++;
+    return YES;
+}
+
+/**
+ * Release the state used to append frames. No further frames or symbols may be added to the table.
+ */
+- (void) finishAppending {
+    if (_symbolLookup != NULL) {
+        CFRelease(_symbolLookup);
+        _symbolLookup = NULL;
+        _stringPool = NULL;
+    }
+}
+
+/**
+ * Return the instruction pointer of the frame at @a index.
+ *
+ * @param index The frame index. Must be less than frameCount.
+ */
+- (uint64_t) instructionPointerAtIndex: (NSUInteger) index {
+    NSParameterAssert(index < _frameCount);
+    return _pcs[index];
+}
+
+/**
+ * Return PLCrashReportStackFrameInfo instances for the frames within @a range. Symbol information instances are
+ * created once per unique symbol, and are shared by all frames referencing the symbol.
+ *
+ * @param range The range of frames to return. Must be within the table's frames.
+ */
+- (NSArray *) stackFramesInRange: (NSRange) range {
+    NSParameterAssert(NSMaxRange(range) <= _frameCount);
+    NSMutableArray *frames = [NSMutableArray arrayWithCapacity: range.length];
+
+    @synchronized (self) {
+        for (NSUInteger i = range.location; i < NSMaxRange(range); i++) {
+            PLCrashReportSymbolInfo *symbolInfo = nil;
+            uint32_t symbolIndex = _symbolIndices[i];
+            if (symbolIndex != PLCrashReportFrameTableNoSymbol) {
+                struct pl_frame_table_symbol *symbol = &_symbols[symbolIndex];
+                if (symbol->info == nil) {
+                    symbol->info = [[PLCrashReportSymbolInfo alloc] initWithSymbolName: symbol->name
+                                                                          startAddress: symbol->startAddress
+                                                                            endAddress: symbol->endAddress];
+                }
+                symbolInfo = symbol->info;
+            }
+
+            PLCrashReportStackFrameInfo *frame;
+            if (_annotations != NULL || _unwindMethods != NULL) {
+                struct pl_frame_table_annotation none = { 0, 0, 0 };
+                struct pl_frame_table_annotation *annotation = (_annotations != NULL) ? &_annotations[i] : &none;
+                frame = [[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: _pcs[i]
+                                                                             symbolInfo: symbolInfo
+                                                                           repeatLength: annotation->repeatLength
+                                                                            repeatCount: annotation->repeatCount
+                                                                      omittedFrameCount: annotation->omittedFrameCount
+                                                                           unwindMethod: (_unwindMethods != NULL) ? _unwindMethods[i] : PLCrashReportUnwindMethodUnknown];
+            } else {
+                frame = [[PLCrashReportStackFrameInfo alloc] initWithInstructionPointer: _pcs[i] symbolInfo: symbolInfo];
+            }
+
+            [frames addObject: frame];
+            [frame release];
+        }
+    }
+
+    return frames;
+}
+
+@synthesize frameCount = _frameCount;
+
+@end
@@ -0,0 +1,54 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import <Foundation/Foundation.h>
+
+#import "PLCrashReportHangSample.h"
+
+@interface PLCrashReportHangInfo : NSObject {
+@private
+    /** Hang duration */
+    NSTimeInterval _duration;
+
+    /** Stack samples (PLCrashReportHangSample instances) */
+    NSArray *_samples;
+}
+
+- (id) initWithDuration: (NSTimeInterval) duration samples: (NSArray *) samples;
+
+/**
+ * The length of time for which the thread had been unresponsive when the report was generated.
+ */
+@property(nonatomic, readonly) NSTimeInterval duration;
+
+/**
+ * Stack samples of the unresponsive thread taken during the hang, as an array of PLCrashReportHangSample instances,
+ * ordered from oldest to newest.
+ */
+@property(nonatomic, readonly) NSArray *samples;
+
+@end
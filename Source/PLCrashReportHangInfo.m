@@ -0,0 +1,61 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashReportHangInfo.h"
+
+/**
+ * Provides access to the details of an application hang, as recorded by the hang detector.
+ *
+ * @sa PLCrashReporter::enableHangDetectionWithThreshold:reportThreshold:error:
+ */
+@implementation PLCrashReportHangInfo
+
+/**
+ * Initialize with the provided hang data.
+ *
+ * @param duration The length of time for which the thread had been unresponsive.
+ * @param samples The stack samples taken during the hang (PLCrashReportHangSample instances), oldest first.
+ */
+- (id) initWithDuration: (NSTimeInterval) duration samples: (NSArray *) samples {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _duration = duration;
+    _samples = [samples retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_samples release];
+    [super dealloc];
+}
+
+@synthesize duration = _duration;
+@synthesize samples = _samples;
+
+@end
@@ -0,0 +1,111 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import "PLCrashReportMemoryRegionInfo.h"
+
+@interface PLCrashReportMemoryInfo : NSObject {
+@private
+    /** YES if the physical footprint is available */
+    BOOL _hasPhysicalFootprint;
+
+    /** Physical footprint */
+    uint64_t _physicalFootprint;
+
+    /** Resident size */
+    uint64_t _residentSize;
+
+    /** Peak resident size */
+    uint64_t _peakResidentSize;
+
+    /** Compressed size */
+    uint64_t _compressedSize;
+
+    /** Virtual size */
+    uint64_t _virtualSize;
+
+    /** Region summaries (PLCrashReportMemoryRegionInfo instances) */
+    NSArray *_regions;
+
+    /** YES if the region summaries are incomplete */
+    BOOL _regionsTruncated;
+}
+
+- (id) initWithPhysicalFootprint: (uint64_t) physicalFootprint
+            hasPhysicalFootprint: (BOOL) hasPhysicalFootprint
+                    residentSize: (uint64_t) residentSize
+                peakResidentSize: (uint64_t) peakResidentSize
+                  compressedSize: (uint64_t) compressedSize
+                     virtualSize: (uint64_t) virtualSize
+                         regions: (NSArray *) regions
+                regionsTruncated: (BOOL) regionsTruncated;
+
+/**
+ * YES if the process' physical footprint is available. Requires iOS 9, Mac OS X 10.11, or later.
+ */
+@property(nonatomic, readonly) BOOL hasPhysicalFootprint;
+
+/**
+ * The process' physical footprint, in bytes. This is the value used by the kernel to enforce per-process memory
+ * limits. Only valid if hasPhysicalFootprint is YES.
+ */
+@property(nonatomic, readonly) uint64_t physicalFootprint;
+
+/**
+ * The process' resident size, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t residentSize;
+
+/**
+ * The process' peak resident size, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t peakResidentSize;
+
+/**
+ * The size of the process' compressed memory, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t compressedSize;
+
+/**
+ * The process' virtual size, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t virtualSize;
+
+/**
+ * The process' VM regions totalled by user tag, as an array of PLCrashReportMemoryRegionInfo instances.
+ */
+@property(nonatomic, readonly) NSArray *regions;
+
+/**
+ * YES if the process contained more VM regions than could be visited at crash time, in which case the region
+ * totals are incomplete.
+ */
+@property(nonatomic, readonly) BOOL regionsTruncated;
+
+@end
@@ -0,0 +1,86 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportMemoryInfo.h"
+
+/**
+ * Provides access to the memory usage of the crashed process at the time of the crash.
+ */
+@implementation PLCrashReportMemoryInfo
+
+/**
+ * Initialize with the provided memory usage data.
+ *
+ * @param physicalFootprint The process' physical footprint, in bytes.
+ * @param hasPhysicalFootprint YES if @a physicalFootprint is valid.
+ * @param residentSize The process' resident size, in bytes.
+ * @param peakResidentSize The process' peak resident size, in bytes.
+ * @param compressedSize The size of the process' compressed memory, in bytes.
+ * @param virtualSize The process' virtual size, in bytes.
+ * @param regions The process' VM region totals (PLCrashReportMemoryRegionInfo instances).
+ * @param regionsTruncated YES if the region totals are incomplete.
+ */
+- (id) initWithPhysicalFootprint: (uint64_t) physicalFootprint
+            hasPhysicalFootprint: (BOOL) hasPhysicalFootprint
+                    residentSize: (uint64_t) residentSize
+                peakResidentSize: (uint64_t) peakResidentSize
+                  compressedSize: (uint64_t) compressedSize
+                     virtualSize: (uint64_t) virtualSize
+                         regions: (NSArray *) regions
+                regionsTruncated: (BOOL) regionsTruncated
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _physicalFootprint = physicalFootprint;
+    _hasPhysicalFootprint = hasPhysicalFootprint;
+    _residentSize = residentSize;
+    _peakResidentSize = peakResidentSize;
+    _compressedSize = compressedSize;
+    _virtualSize = virtualSize;
+    _regions = [regions retain];
+    _regionsTruncated = regionsTruncated;
+
+    return self;
+}
+
+- (void) dealloc {
+    [_regions release];
+    [super dealloc];
+}
+
+@synthesize hasPhysicalFootprint = _hasPhysicalFootprint;
+@synthesize physicalFootprint = _physicalFootprint;
+@synthesize residentSize = _residentSize;
+@synthesize peakResidentSize = _peakResidentSize;
+@synthesize compressedSize = _compressedSize;
+@synthesize virtualSize = _virtualSize;
+@synthesize regions = _regions;
+@synthesize regionsTruncated = _regionsTruncated;
+
+@end
@@ -0,0 +1,98 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+@interface PLCrashReportMemoryRegionInfo : NSObject {
+@private
+    /** VM user tag */
+    uint32_t _tag;
+
+    /** YES if the regions are untagged file mappings */
+    BOOL _mappedFile;
+
+    /** Number of regions */
+    uint32_t _regionCount;
+
+    /** Total virtual size */
+    uint64_t _virtualSize;
+
+    /** Total resident size */
+    uint64_t _residentSize;
+
+    /** Total dirty size */
+    uint64_t _dirtySize;
+
+    /** Total swapped size */
+    uint64_t _swappedSize;
+}
+
+- (id) initWithTag: (uint32_t) tag
+        mappedFile: (BOOL) mappedFile
+       regionCount: (uint32_t) regionCount
+       virtualSize: (uint64_t) virtualSize
+      residentSize: (uint64_t) residentSize
+         dirtySize: (uint64_t) dirtySize
+       swappedSize: (uint64_t) swappedSize;
+
+/**
+ * The regions' VM_MEMORY_* user tag, or 0 if untagged.
+ */
+@property(nonatomic, readonly) uint32_t tag;
+
+/**
+ * YES if the regions are untagged file-backed mappings, such as mapped images or the dyld shared cache.
+ */
+@property(nonatomic, readonly) BOOL mappedFile;
+
+/**
+ * The number of regions.
+ */
+@property(nonatomic, readonly) uint32_t regionCount;
+
+/**
+ * The total virtual size of the regions, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t virtualSize;
+
+/**
+ * The total size of the regions' resident pages, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t residentSize;
+
+/**
+ * The total size of the regions' dirtied pages, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t dirtySize;
+
+/**
+ * The total size of the regions' swapped out or compressed pages, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t swappedSize;
+
+@end
@@ -0,0 +1,77 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportMemoryRegionInfo.h"
+
+/**
+ * Provides the total size of a crashed process' VM regions sharing a user tag.
+ */
+@implementation PLCrashReportMemoryRegionInfo
+
+/**
+ * Initialize with the provided region totals.
+ *
+ * @param tag The regions' VM_MEMORY_* user tag, or 0 if untagged.
+ * @param mappedFile YES if the regions are untagged file-backed mappings.
+ * @param regionCount The number of regions.
+ * @param virtualSize The total virtual size of the regions, in bytes.
+ * @param residentSize The total size of the regions' resident pages, in bytes.
+ * @param dirtySize The total size of the regions' dirtied pages, in bytes.
+ * @param swappedSize The total size of the regions' swapped out or compressed pages, in bytes.
+ */
+- (id) initWithTag: (uint32_t) tag
+        mappedFile: (BOOL) mappedFile
+       regionCount: (uint32_t) regionCount
+       virtualSize: (uint64_t) virtualSize
+      residentSize: (uint64_t) residentSize
+         dirtySize: (uint64_t) dirtySize
+       swappedSize: (uint64_t) swappedSize
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _tag = tag;
+    _mappedFile = mappedFile;
+    _regionCount = regionCount;
+    _virtualSize = virtualSize;
+    _residentSize = residentSize;
+    _dirtySize = dirtySize;
+    _swappedSize = swappedSize;
+
+    return self;
+}
+
+@synthesize tag = _tag;
+@synthesize mappedFile = _mappedFile;
+@synthesize regionCount = _regionCount;
+@synthesize virtualSize = _virtualSize;
+@synthesize residentSize = _residentSize;
+@synthesize dirtySize = _dirtySize;
+@synthesize swappedSize = _swappedSize;
+
+@end
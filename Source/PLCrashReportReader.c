@@ -0,0 +1,488 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashReportReader.h"
+#include "PLCrashAsyncLZ4.h"
+#include "PLCrashAsyncCRC32C.h"
+
+#include "protobuf-c.h"
+#include "crash_report.pb-c.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_report_reader
+ * @{
+ */
+
+/* File header values. These must be kept in sync with PLCrashReport.h */
+#define READER_FILE_MAGIC "plcrash"
+#define READER_FILE_MAGIC_LENGTH 7
+#define READER_FILE_VERSION 1
+#define READER_FILE_VERSION_COMPACT 2
+#define READER_FILE_FLAG_COMPRESSED 0x80
+#define READER_FILE_FLAG_FOOTER 0x40
+
+/* Top-level CrashReport field numbers. These must be kept in sync with crash_report.proto */
+enum {
+    FIELD_REPORT_THREADS = 3,
+    FIELD_REPORT_BINARY_IMAGES = 4,
+    FIELD_REPORT_CHECKSUM = 13
+};
+
+/* Protobuf wire types */
+enum {
+    WIRETYPE_VARINT = 0,
+    WIRETYPE_64BIT = 1,
+    WIRETYPE_LENGTH_PREFIXED = 2,
+    WIRETYPE_32BIT = 5
+};
+
+/**
+ * @internal
+ *
+ * Read a base-128 varint from @a cursor, advancing @a cursor past the value. Returns false if the varint is
+ * truncated or malformed.
+ */
+static bool read_varint (const uint8_t **cursor, const uint8_t *end, uint64_t *result) {
+    uint64_t value = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (*cursor >= end)
+            return false;
+
+        uint8_t byte = *(*cursor)++;
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+        if ((byte & 0x80) == 0) {
+            *result = value;
+            return true;
+        }
+    }
+
+    /* Exceeds 64 bits */
+    return false;
+}
+
+/* Read a little-endian 32-bit value from @a bytes */
+static uint32_t read_uint32_le (const uint8_t *bytes) {
+    return (uint32_t) bytes[0] | ((uint32_t) bytes[1] << 8) | ((uint32_t) bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+}
+
+/**
+ * @internal
+ *
+ * Append a new range to @a list. Returns false if the list could not be grown.
+ */
+static bool range_list_append (plcrash_report_range_list_t *list, size_t offset, size_t length) {
+    if (list->count == list->capacity) {
+        size_t capacity = list->capacity == 0 ? 16 : list->capacity * 2;
+        plcrash_report_range_t *ranges = realloc(list->ranges, capacity * sizeof(*ranges));
+        if (ranges == NULL)
+            return false;
+
+        list->ranges = ranges;
+        list->capacity = capacity;
+    }
+
+    list->ranges[list->count].offset = offset;
+    list->ranges[list->count].length = length;
+    list->count++;
+    return true;
+}
+
+/**
+ * Free all ranges allocated by @a list, resetting the list to empty.
+ */
+void plcrash_report_range_list_free (plcrash_report_range_list_t *list) {
+    free(list->ranges);
+    list->ranges = NULL;
+    list->count = 0;
+    list->capacity = 0;
+}
+
+/**
+ * Verify that @a data begins with a supported, uncompressed crash report file header, and is sufficiently large to
+ * contain a report. The PLCRASH_REPORT_FILE_FLAG_FOOTER flag is permitted, and is not included in the returned
+ * version; any footer must have already been removed with plcrash_report_reader_read_footer().
+ *
+ * @param data The encoded report, including its file header.
+ * @param length The length of @a data.
+ * @param version If non-NULL, on success, will be set to the report's file version.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if @a data is truncated or does not begin with
+ * a crash report file header, or PLCRASH_ENOTSUP if the report's file version is not supported.
+ */
+plcrash_error_t plcrash_report_reader_check_header (const uint8_t *data, size_t length, uint8_t *version) {
+    if (length <= PLCRASH_REPORT_READER_HEADER_SIZE)
+        return PLCRASH_EINVAL;
+
+    if (memcmp(data, READER_FILE_MAGIC, READER_FILE_MAGIC_LENGTH) != 0)
+        return PLCRASH_EINVAL;
+
+    /* The footer flag does not affect the encoding of the message, and is ignored once the footer has been read */
+    uint8_t file_version = data[READER_FILE_MAGIC_LENGTH] & ~READER_FILE_FLAG_FOOTER;
+    if (file_version != READER_FILE_VERSION && file_version != READER_FILE_VERSION_COMPACT)
+        return PLCRASH_ENOTSUP;
+
+    if (version != NULL)
+        *version = file_version;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/* Verify that @a range lies within a message of @a length bytes */
+static bool range_is_valid (const plcrash_report_range_t *range, size_t length) {
+    return range->offset <= length && range->length <= length - range->offset;
+}
+
+/**
+ * If @a data is a report written with a footer (see PLCRASH_REPORT_FILE_FLAG_FOOTER), decode the footer, and
+ * determine the length of the report that precedes it. The footer must be removed prior to decompressing, validating
+ * or decoding the report.
+ *
+ * The section ranges of a compressed report are relative to the decompressed message, and can't be checked against
+ * the message's length until it is decompressed; they must be range checked by the caller. The ranges of an
+ * uncompressed report are verified to lie within the report message.
+ *
+ * @param data The encoded report, including its file header.
+ * @param length The length of @a data.
+ * @param footer If non-NULL, on success, will be populated with the decoded footer.
+ * @param report_length On return, will be set to the length of @a data preceding the footer, or to @a length if the
+ * report has no valid footer.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_ENOTFOUND if the report was not written with a footer, or
+ * PLCRASH_EINVAL if the report is flagged as having a footer, but the footer is missing or malformed; this is
+ * expected of reports whose writing was interrupted, which may still be salvaged.
+ */
+plcrash_error_t plcrash_report_reader_read_footer (const uint8_t *data, size_t length, plcrash_report_footer_t *footer, size_t *report_length) {
+    const size_t header_size = PLCRASH_REPORT_READER_HEADER_SIZE;
+    const size_t magic_length = sizeof(PLCRASH_REPORT_FOOTER_MAGIC) - 1;
+
+    *report_length = length;
+
+    if (length <= header_size || (data[READER_FILE_MAGIC_LENGTH] & READER_FILE_FLAG_FOOTER) == 0)
+        return PLCRASH_ENOTFOUND;
+
+    if (length - header_size < PLCRASH_REPORT_FOOTER_TRAILER_SIZE)
+        return PLCRASH_EINVAL;
+
+    const uint8_t *trailer = data + length - PLCRASH_REPORT_FOOTER_TRAILER_SIZE;
+    if (memcmp(trailer + PLCRASH_REPORT_FOOTER_TRAILER_SIZE - magic_length, PLCRASH_REPORT_FOOTER_MAGIC, magic_length) != 0)
+        return PLCRASH_EINVAL;
+
+    uint32_t count = read_uint32_le(trailer);
+    if (count > PLCRASH_REPORT_FOOTER_MAX_SECTIONS)
+        return PLCRASH_EINVAL;
+
+    size_t footer_size = PLCRASH_REPORT_FOOTER_TRAILER_SIZE + count * PLCRASH_REPORT_FOOTER_SECTION_SIZE;
+    if (length - header_size < footer_size)
+        return PLCRASH_EINVAL;
+
+    /* Decode the footer */
+    plcrash_report_footer_t result;
+    const uint8_t *entry = data + length - footer_size;
+    for (uint32_t i = 0; i < count; i++) {
+        result.sections[i].field = read_uint32_le(entry);
+        result.sections[i].range.offset = read_uint32_le(entry + 4);
+        result.sections[i].range.length = read_uint32_le(entry + 8);
+        entry += PLCRASH_REPORT_FOOTER_SECTION_SIZE;
+    }
+    result.count = count;
+
+    result.crashed_thread_index = read_uint32_le(trailer + 4);
+    result.crashed_thread.offset = read_uint32_le(trailer + 8);
+    result.crashed_thread.length = read_uint32_le(trailer + 12);
+    result.has_crashed_thread = (result.crashed_thread_index != PLCRASH_REPORT_FOOTER_NO_THREAD);
+
+    /* If the message is not compressed, its length is known, and the ranges can be verified */
+    if ((data[READER_FILE_MAGIC_LENGTH] & READER_FILE_FLAG_COMPRESSED) == 0) {
+        size_t message_length = length - footer_size - header_size;
+        for (uint32_t i = 0; i < count; i++) {
+            if (!range_is_valid(&result.sections[i].range, message_length))
+                return PLCRASH_EINVAL;
+        }
+
+        if (result.has_crashed_thread && !range_is_valid(&result.crashed_thread, message_length))
+            return PLCRASH_EINVAL;
+    }
+
+    if (footer != NULL)
+        *footer = result;
+
+    *report_length = length - footer_size;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Find the first section of @a footer containing records of @a field.
+ *
+ * @param footer The footer to search.
+ * @param field The CrashReport field number.
+ * @param range On success, will be set to the section's byte range, relative to the start of the report message.
+ *
+ * @return Returns true if the section was found, or false if it is not listed by the footer.
+ */
+bool plcrash_report_footer_find (const plcrash_report_footer_t *footer, uint32_t field, plcrash_report_range_t *range) {
+    for (size_t i = 0; i < footer->count; i++) {
+        if (footer->sections[i].field == field) {
+            *range = footer->sections[i].range;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * If @a data is a compressed report, decompress the report, returning a newly allocated buffer containing the file
+ * header, with the compression flag cleared, followed by the decompressed message.
+ *
+ * @param data The encoded report, including its file header.
+ * @param length The length of @a data.
+ * @param output On success, will be set to the decompressed report, which must be freed by the caller with free(), or
+ * to NULL if @a data is not compressed.
+ * @param output_length On success, will be set to the length of @a output.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if the compressed report is malformed, or PLCRASH_ENOMEM
+ * if the decompressed report could not be allocated.
+ */
+plcrash_error_t plcrash_report_reader_decompress (const uint8_t *data, size_t length, uint8_t **output, size_t *output_length) {
+    const size_t header_size = PLCRASH_REPORT_READER_HEADER_SIZE;
+
+    *output = NULL;
+    *output_length = 0;
+
+    /* Uncompressed and truncated headers are handled by plcrash_report_reader_check_header() */
+    if (length <= header_size || (data[READER_FILE_MAGIC_LENGTH] & READER_FILE_FLAG_COMPRESSED) == 0)
+        return PLCRASH_ESUCCESS;
+
+    const uint8_t *compressed = data + header_size;
+    size_t compressed_length = length - header_size;
+    if (compressed_length < sizeof(uint32_t))
+        return PLCRASH_EINVAL;
+
+    /* LZ4 can't expand its input by more than a factor of 255; reject implausible lengths before allocating */
+    uint32_t message_length = read_uint32_le(compressed);
+    if (message_length / 255 > compressed_length)
+        return PLCRASH_EINVAL;
+
+    uint8_t *result = malloc(header_size + message_length);
+    if (result == NULL)
+        return PLCRASH_ENOMEM;
+
+    size_t written;
+    plcrash_error_t err = plcrash_async_lz4_decompress(compressed + sizeof(uint32_t), compressed_length - sizeof(uint32_t),
+                                                       result + header_size, message_length, &written);
+    if (err != PLCRASH_ESUCCESS || written != message_length) {
+        free(result);
+        return PLCRASH_EINVAL;
+    }
+
+    /* Copy the header, clearing the compression flag */
+    memcpy(result, data, header_size);
+    result[READER_FILE_MAGIC_LENGTH] &= ~READER_FILE_FLAG_COMPRESSED;
+
+    *output = result;
+    *output_length = header_size + message_length;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Verify the integrity of an uncompressed report against the checksum written at the end of the report. The report's
+ * header must have already been validated with plcrash_report_reader_check_header().
+ *
+ * @param data The encoded report, including its file header.
+ * @param length The length of @a data.
+ *
+ * @return Returns PLCRASH_ESUCCESS if the checksum is present and correct, PLCRASH_ENOTFOUND if the report is
+ * truncated or does not include a checksum, or PLCRASH_EINVAL if the checksum does not match the report's contents.
+ */
+plcrash_error_t plcrash_report_reader_validate (const uint8_t *data, size_t length) {
+    /* The checksum is always appended as a single-byte tag, followed by the fixed 32-bit value */
+    const uint8_t tag = (FIELD_REPORT_CHECKSUM << 3) | WIRETYPE_32BIT;
+    const size_t trailer_size = 1 + sizeof(uint32_t);
+
+    if (length < PLCRASH_REPORT_READER_HEADER_SIZE + trailer_size || data[length - trailer_size] != tag)
+        return PLCRASH_ENOTFOUND;
+
+    uint32_t expected = read_uint32_le(data + length - sizeof(uint32_t));
+    if (plcrash_async_crc32c_update(0, data, length - trailer_size) != expected)
+        return PLCRASH_EINVAL;
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return the length of the longest prefix of @a data consisting of the file header and complete, individually
+ * decodable top-level CrashReport records, discarding the first incomplete or malformed record and all data that
+ * follows it. A record whose length was never back-patched (see plcrash_writer_pack_begin_message()) is encoded as
+ * an empty message, and is rejected as missing its required fields.
+ *
+ * @param data The encoded report, including its file header.
+ * @param length The length of @a data.
+ *
+ * @return Returns @a length if no records must be discarded, or the length of the salvageable prefix.
+ */
+size_t plcrash_report_reader_salvage_length (const uint8_t *data, size_t length) {
+    /* Headers too short to be valid are rejected by plcrash_report_reader_check_header() */
+    if (length <= PLCRASH_REPORT_READER_HEADER_SIZE)
+        return length;
+
+    const uint8_t *end = data + length;
+    const uint8_t *cursor = data + PLCRASH_REPORT_READER_HEADER_SIZE;
+    const uint8_t *complete = cursor;
+
+    while (cursor < end) {
+        const uint8_t *value_start;
+        uint64_t tag;
+        uint64_t value;
+
+        if (!read_varint(&cursor, end, &tag) || (tag >> 3) == 0)
+            break;
+
+        if ((tag & 0x7) == WIRETYPE_VARINT) {
+            if (!read_varint(&cursor, end, &value))
+                break;
+        } else if ((tag & 0x7) == WIRETYPE_64BIT) {
+            if ((size_t) (end - cursor) < 8)
+                break;
+            cursor += 8;
+        } else if ((tag & 0x7) == WIRETYPE_32BIT) {
+            if ((size_t) (end - cursor) < 4)
+                break;
+            cursor += 4;
+        } else if ((tag & 0x7) == WIRETYPE_LENGTH_PREFIXED) {
+            if (!read_varint(&cursor, end, &value) || value > (uint64_t) (end - cursor))
+                break;
+            value_start = cursor;
+            cursor += value;
+
+            /* Verify that the record decodes on its own */
+            const ProtobufCFieldDescriptor *field = protobuf_c_message_descriptor_get_field(&plcrash__crash_report__descriptor, (unsigned) (tag >> 3));
+            if (field != NULL && field->type == PROTOBUF_C_TYPE_MESSAGE) {
+                ProtobufCMessage *record = protobuf_c_message_unpack(field->descriptor, NULL, (size_t) value, value_start);
+                if (record == NULL)
+                    break;
+                protobuf_c_message_free_unpacked(record, NULL);
+            }
+        } else {
+            /* Groups are not used by crash_report.proto */
+            break;
+        }
+
+        complete = cursor;
+    }
+
+    return (size_t) (complete - data);
+}
+
+/**
+ * Walk the top-level fields of an encoded CrashReport message, recording the value ranges of the thread and
+ * binary image records in @a threads and @a images, and copying all other fields, unmodified, to @a core.
+ *
+ * @param message The encoded CrashReport message.
+ * @param length The length of @a message.
+ * @param core The buffer to which all non-deferred fields will be written. The buffer must be at least @a length
+ * bytes in size.
+ * @param core_length On success, will be set to the number of bytes written to @a core.
+ * @param threads The list to which thread record ranges (relative to @a message) will be appended.
+ * @param images The list to which binary image record ranges (relative to @a message) will be appended.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, PLCRASH_EINVAL if the message is malformed, or PLCRASH_ENOMEM if
+ * a range list could not be grown. On failure, @a threads and @a images may contain partial results, and must still be
+ * freed by the caller.
+ */
+plcrash_error_t plcrash_report_reader_split (const uint8_t *message, size_t length, uint8_t *core, size_t *core_length,
+                                             plcrash_report_range_list_t *threads, plcrash_report_range_list_t *images)
+{
+    const uint8_t *end = message + length;
+    const uint8_t *cursor = message;
+    size_t written = 0;
+
+    while (cursor < end) {
+        const uint8_t *field_start = cursor;
+        const uint8_t *value_start;
+        uint64_t tag;
+        uint64_t value;
+
+        if (!read_varint(&cursor, end, &tag) || (tag >> 3) == 0)
+            return PLCRASH_EINVAL;
+
+        value_start = cursor;
+        switch (tag & 0x7) {
+            case WIRETYPE_VARINT:
+                if (!read_varint(&cursor, end, &value))
+                    return PLCRASH_EINVAL;
+                break;
+
+            case WIRETYPE_64BIT:
+                if ((size_t) (end - cursor) < 8)
+                    return PLCRASH_EINVAL;
+                cursor += 8;
+                break;
+
+            case WIRETYPE_LENGTH_PREFIXED:
+                if (!read_varint(&cursor, end, &value) || value > (uint64_t) (end - cursor))
+                    return PLCRASH_EINVAL;
+                value_start = cursor;
+                cursor += value;
+                break;
+
+            case WIRETYPE_32BIT:
+                if ((size_t) (end - cursor) < 4)
+                    return PLCRASH_EINVAL;
+                cursor += 4;
+                break;
+
+            default:
+                /* Groups are not used by crash_report.proto */
+                return PLCRASH_EINVAL;
+        }
+
+        /* Defer any thread or image records; everything else is passed through to the core message. */
+        if ((tag & 0x7) == WIRETYPE_LENGTH_PREFIXED && (tag >> 3) == FIELD_REPORT_THREADS) {
+            if (!range_list_append(threads, value_start - message, cursor - value_start))
+                return PLCRASH_ENOMEM;
+        } else if ((tag & 0x7) == WIRETYPE_LENGTH_PREFIXED && (tag >> 3) == FIELD_REPORT_BINARY_IMAGES) {
+            if (!range_list_append(images, value_start - message, cursor - value_start))
+                return PLCRASH_ENOMEM;
+        } else {
+            memcpy(core + written, field_start, cursor - field_start);
+            written += cursor - field_start;
+        }
+    }
+
+    *core_length = written;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @} plcrash_report_reader
+ */
@@ -0,0 +1,185 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_REPORT_READER_H
+#define PLCRASH_REPORT_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_report_reader Crash Report Reader
+ *
+ * Implements the handling of an encoded report's file envelope -- header validation, decompression, checksum
+ * validation and the salvaging of truncated reports -- and the splitting of a report's thread and binary image records
+ * from the remainder of its message, such that they may be decoded on demand.
+ *
+ * These functions depend only on the C library, protobuf-c and the LZ4 decoder, and are shared by PLCrashReport and
+ * non-Foundation report processing.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ * The size of the crash report file header. This must be kept in sync with PLCrashReportFileHeader.
+ */
+#define PLCRASH_REPORT_READER_HEADER_SIZE 8
+
+/**
+ * @internal
+ * The byte range of an encoded protobuf field value, relative to the start of the encoded report message.
+ */
+typedef struct plcrash_report_range {
+    /** Offset of the field's value. */
+    size_t offset;
+
+    /** Length of the field's value. */
+    size_t length;
+} plcrash_report_range_t;
+
+/**
+ * @internal
+ * A list of deferred (undecoded) repeated field values.
+ */
+typedef struct plcrash_report_range_list {
+    /** Field value ranges */
+    plcrash_report_range_t *ranges;
+
+    /** Number of entries in @a ranges. */
+    size_t count;
+
+    /** Allocated capacity of @a ranges. */
+    size_t capacity;
+} plcrash_report_range_list_t;
+
+/**
+ * @internal
+ * The maximum number of sections listed by a report footer. Sections beyond this limit are not listed, and must be
+ * located by scanning the report message.
+ */
+#define PLCRASH_REPORT_FOOTER_MAX_SECTIONS 32
+
+/**
+ * @internal
+ * The size of an encoded footer section entry; the section's field number, offset and length, each encoded as a
+ * little-endian 32-bit value.
+ */
+#define PLCRASH_REPORT_FOOTER_SECTION_SIZE 12
+
+/**
+ * @internal
+ * The size of the encoded footer trailer; the section count, the crashed thread's record index, offset and length,
+ * each encoded as a little-endian 32-bit value, followed by #PLCRASH_REPORT_FOOTER_MAGIC.
+ */
+#define PLCRASH_REPORT_FOOTER_TRAILER_SIZE 20
+
+/**
+ * @internal
+ * The footer magic identifier, not NULL terminated, which terminates a report written with a footer.
+ */
+#define PLCRASH_REPORT_FOOTER_MAGIC "plft"
+
+/**
+ * @internal
+ * The crashed thread record index written if the report contains no crashed thread.
+ */
+#define PLCRASH_REPORT_FOOTER_NO_THREAD UINT32_MAX
+
+/**
+ * @internal
+ * A contiguous run of top-level records of a single field, as listed by a report footer. The range includes the
+ * records' tags and length prefixes, and is itself a valid encoding of a CrashReport message containing only those
+ * records.
+ */
+typedef struct plcrash_report_section {
+    /** The CrashReport field number of the section's records. */
+    uint32_t field;
+
+    /** The section's byte range, relative to the start of the (uncompressed) report message. */
+    plcrash_report_range_t range;
+} plcrash_report_section_t;
+
+/**
+ * @internal
+ * A decoded report footer (see PLCRASH_REPORT_FILE_FLAG_FOOTER).
+ *
+ * The footer is appended to the report file, following the report message (or its compressed representation), and
+ * consists of the section entries, in written order, followed by the trailer. As the trailer is of fixed size and
+ * terminates the file, the footer may be located without reading the report message.
+ */
+typedef struct plcrash_report_footer {
+    /** The report's sections, in written order. A field may be listed more than once if its records are not
+     * contiguous. */
+    plcrash_report_section_t sections[PLCRASH_REPORT_FOOTER_MAX_SECTIONS];
+
+    /** Number of entries in @a sections. */
+    size_t count;
+
+    /** If true, the report contains a crashed thread, and @a crashed_thread_index and @a crashed_thread are valid. */
+    bool has_crashed_thread;
+
+    /** The index of the crashed thread's record among the report's thread records, in written order. */
+    uint32_t crashed_thread_index;
+
+    /** The byte range of the crashed thread's record, including its tag and length prefix, relative to the start of
+     * the report message. */
+    plcrash_report_range_t crashed_thread;
+} plcrash_report_footer_t;
+
+void plcrash_report_range_list_free (plcrash_report_range_list_t *list);
+
+plcrash_error_t plcrash_report_reader_read_footer (const uint8_t *data, size_t length, plcrash_report_footer_t *footer, size_t *report_length);
+bool plcrash_report_footer_find (const plcrash_report_footer_t *footer, uint32_t field, plcrash_report_range_t *range);
+
+plcrash_error_t plcrash_report_reader_check_header (const uint8_t *data, size_t length, uint8_t *version);
+plcrash_error_t plcrash_report_reader_decompress (const uint8_t *data, size_t length, uint8_t **output, size_t *output_length);
+plcrash_error_t plcrash_report_reader_validate (const uint8_t *data, size_t length);
+size_t plcrash_report_reader_salvage_length (const uint8_t *data, size_t length);
+
+plcrash_error_t plcrash_report_reader_split (const uint8_t *message, size_t length, uint8_t *core, size_t *core_length,
+                                             plcrash_report_range_list_t *threads, plcrash_report_range_list_t *images);
+
+/**
+ * @} plcrash_report_reader
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_REPORT_READER_H */
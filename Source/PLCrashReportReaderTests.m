@@ -0,0 +1,227 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashReportReader.h"
+#import "PLCrashAsyncCRC32C.h"
+
+@interface PLCrashReportReaderTests : SenTestCase {
+@private
+}
+
+@end
+
+/* Append a varint to @a data */
+static void append_varint (NSMutableData *data, uint64_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0)
+            byte |= 0x80;
+        [data appendBytes: &byte length: 1];
+    } while (value != 0);
+}
+
+/* Append a varint field */
+static void append_varint_field (NSMutableData *data, uint32_t field, uint64_t value) {
+    append_varint(data, (field << 3) | 0);
+    append_varint(data, value);
+}
+
+/* Append a length-delimited field */
+static void append_bytes_field (NSMutableData *data, uint32_t field, const void *bytes, size_t length) {
+    append_varint(data, (field << 3) | 2);
+    append_varint(data, length);
+    [data appendBytes: bytes length: length];
+}
+
+@implementation PLCrashReportReaderTests
+
+/**
+ * Encode a report file containing a thread record, a non-deferred field, a binary image record, and a trailing
+ * checksum.
+ */
+- (NSData *) report {
+    static const uint8_t record[] = { 0x08, 0x01 };
+    NSMutableData *report = [NSMutableData dataWithBytes: "plcrash\x01" length: PLCRASH_REPORT_READER_HEADER_SIZE];
+
+    append_bytes_field(report, 3, record, sizeof(record));
+    append_varint_field(report, 8, 5);
+    append_bytes_field(report, 4, record, sizeof(record));
+
+    uint8_t tag = (13 << 3) | 5;
+    [report appendBytes: &tag length: 1];
+
+    uint32_t crc = plcrash_async_crc32c_update(0, [report bytes], [report length] - 1);
+    uint8_t checksum[] = { crc & 0xFF, (crc >> 8) & 0xFF, (crc >> 16) & 0xFF, (crc >> 24) & 0xFF };
+    [report appendBytes: checksum length: sizeof(checksum)];
+
+    return report;
+}
+
+/**
+ * Verify file header validation.
+ */
+- (void) testCheckHeader {
+    NSMutableData *report = [[[self report] mutableCopy] autorelease];
+    uint8_t *bytes = [report mutableBytes];
+    uint8_t version = 0;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_check_header(bytes, [report length], &version), @"Failed to validate header");
+    STAssertEquals((uint8_t) 1, version, @"Incorrect version");
+
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_check_header(bytes, PLCRASH_REPORT_READER_HEADER_SIZE, NULL), @"Truncated report accepted");
+
+    bytes[7] = 0x7F;
+    STAssertEquals(PLCRASH_ENOTSUP, plcrash_report_reader_check_header(bytes, [report length], NULL), @"Unsupported version accepted");
+
+    bytes[0] = 'x';
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_check_header(bytes, [report length], NULL), @"Invalid magic accepted");
+}
+
+/**
+ * Verify that thread and image records are split from the remainder of the message.
+ */
+- (void) testSplit {
+    NSData *report = [self report];
+    const uint8_t *message = (const uint8_t *) [report bytes] + PLCRASH_REPORT_READER_HEADER_SIZE;
+    size_t length = [report length] - PLCRASH_REPORT_READER_HEADER_SIZE;
+
+    plcrash_report_range_list_t threads = { NULL, 0, 0 };
+    plcrash_report_range_list_t images = { NULL, 0, 0 };
+    uint8_t core[length];
+    size_t coreLength;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_split(message, length, core, &coreLength, &threads, &images), @"Failed to split report");
+
+    STAssertEquals((size_t) 1, threads.count, @"Incorrect thread count");
+    STAssertEquals((size_t) 2, threads.ranges[0].offset, @"Incorrect thread offset");
+    STAssertEquals((size_t) 2, threads.ranges[0].length, @"Incorrect thread length");
+
+    STAssertEquals((size_t) 1, images.count, @"Incorrect image count");
+    STAssertEquals((size_t) 8, images.ranges[0].offset, @"Incorrect image offset");
+
+    /* The remaining field and the checksum trailer are passed through */
+    STAssertEquals((size_t) 7, coreLength, @"Incorrect core length");
+    STAssertTrue(memcmp(core, message + 4, 2) == 0, @"Incorrect core contents");
+
+    plcrash_report_range_list_free(&threads);
+    plcrash_report_range_list_free(&images);
+
+    /* Truncated records are rejected */
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_split(message, 3, core, &coreLength, &threads, &images), @"Truncated report accepted");
+    plcrash_report_range_list_free(&threads);
+    plcrash_report_range_list_free(&images);
+}
+
+/**
+ * Verify checksum validation.
+ */
+- (void) testValidate {
+    NSMutableData *report = [[[self report] mutableCopy] autorelease];
+    uint8_t *bytes = [report mutableBytes];
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_validate(bytes, [report length]), @"Failed to validate report");
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_report_reader_validate(bytes, [report length] - 1), @"Truncated report accepted");
+
+    bytes[PLCRASH_REPORT_READER_HEADER_SIZE + 3] ^= 0x1;
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_validate(bytes, [report length]), @"Corrupt report accepted");
+}
+
+/* Append a little-endian 32-bit value to @a data */
+static void append_uint32 (NSMutableData *data, uint32_t value) {
+    uint8_t bytes[] = { value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (value >> 24) & 0xFF };
+    [data appendBytes: bytes length: sizeof(bytes)];
+}
+
+/**
+ * Verify footer decoding.
+ */
+- (void) testReadFooter {
+    NSMutableData *report = [[[self report] mutableCopy] autorelease];
+    size_t length = [report length];
+    plcrash_report_footer_t footer;
+    plcrash_report_range_t range;
+    size_t reportLength;
+
+    /* Reports without the footer flag are returned unmodified */
+    STAssertEquals(PLCRASH_ENOTFOUND, plcrash_report_reader_read_footer([report bytes], length, &footer, &reportLength), @"Footer found in unflagged report");
+    STAssertEquals(length, reportLength, @"Incorrect report length");
+
+    /* Append a footer listing the thread section, and the thread as the crashed thread */
+    ((uint8_t *) [report mutableBytes])[7] |= 0x40;
+    append_uint32(report, 3);
+    append_uint32(report, 0);
+    append_uint32(report, 4);
+    append_uint32(report, 1);
+    append_uint32(report, 0);
+    append_uint32(report, 0);
+    append_uint32(report, 4);
+    [report appendBytes: PLCRASH_REPORT_FOOTER_MAGIC length: strlen(PLCRASH_REPORT_FOOTER_MAGIC)];
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_read_footer([report bytes], [report length], &footer, &reportLength), @"Failed to read footer");
+    STAssertEquals(length, reportLength, @"Incorrect report length");
+    STAssertEquals((size_t) 1, footer.count, @"Incorrect section count");
+    STAssertTrue(footer.has_crashed_thread, @"Crashed thread not found");
+    STAssertEquals((uint32_t) 0, footer.crashed_thread_index, @"Incorrect crashed thread index");
+    STAssertEquals((size_t) 4, footer.crashed_thread.length, @"Incorrect crashed thread length");
+
+    STAssertTrue(plcrash_report_footer_find(&footer, 3, &range), @"Thread section not found");
+    STAssertEquals((size_t) 0, range.offset, @"Incorrect section offset");
+    STAssertEquals((size_t) 4, range.length, @"Incorrect section length");
+    STAssertFalse(plcrash_report_footer_find(&footer, 4, &range), @"Unlisted section found");
+
+    /* The footer flag is accepted once the footer has been removed */
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_check_header([report bytes], reportLength, NULL), @"Footer flag rejected");
+
+    /* Sections outside of the message are rejected */
+    uint8_t *bytes = [report mutableBytes];
+    bytes[length + 8] = 0xFF;
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_read_footer(bytes, [report length], &footer, &reportLength), @"Invalid section accepted");
+
+    /* Missing footers are rejected, leaving the report intact */
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_read_footer(bytes, length, &footer, &reportLength), @"Missing footer accepted");
+    STAssertEquals(length, reportLength, @"Incorrect report length");
+}
+
+/**
+ * Verify that uncompressed reports are not modified, and that malformed compressed reports are rejected.
+ */
+- (void) testDecompress {
+    NSMutableData *report = [[[self report] mutableCopy] autorelease];
+    uint8_t *output;
+    size_t outputLength;
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_report_reader_decompress([report bytes], [report length], &output, &outputLength), @"Failed to decompress");
+    STAssertTrue(output == NULL, @"Uncompressed report was copied");
+
+    ((uint8_t *) [report mutableBytes])[7] |= 0x80;
+    STAssertEquals(PLCRASH_EINVAL, plcrash_report_reader_decompress([report bytes], [report length], &output, &outputLength), @"Malformed report accepted");
+}
+
+@end
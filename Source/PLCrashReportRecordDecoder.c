@@ -0,0 +1,746 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashReportRecordDecoder.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_report_record_decoder
+ * @{
+ */
+
+/* Protobuf wire types */
+#define WIRETYPE_VARINT 0
+#define WIRETYPE_64BIT 1
+#define WIRETYPE_LENGTH_PREFIXED 2
+#define WIRETYPE_32BIT 5
+
+/** Form the encoded tag of field @a number with wire type @a type. These must be kept in sync with crash_report.proto. */
+#define FIELD_TAG(number, type) (((number) << 3) | (type))
+
+/* Thread field tags */
+#define THREAD_NUMBER_TAG           FIELD_TAG(1, WIRETYPE_VARINT)
+#define THREAD_FRAMES_TAG           FIELD_TAG(2, WIRETYPE_LENGTH_PREFIXED)
+#define THREAD_CRASHED_TAG          FIELD_TAG(3, WIRETYPE_VARINT)
+
+/* Thread.StackFrame field tags */
+#define FRAME_PC_TAG                FIELD_TAG(3, WIRETYPE_VARINT)
+#define FRAME_SYMBOL_TAG            FIELD_TAG(6, WIRETYPE_LENGTH_PREFIXED)
+#define FRAME_IMAGE_INDEX_TAG       FIELD_TAG(7, WIRETYPE_VARINT)
+#define FRAME_OFFSET_DELTA_TAG      FIELD_TAG(8, WIRETYPE_VARINT)
+#define FRAME_REPEAT_LENGTH_TAG     FIELD_TAG(9, WIRETYPE_VARINT)
+#define FRAME_REPEAT_COUNT_TAG      FIELD_TAG(10, WIRETYPE_VARINT)
+#define FRAME_OMITTED_COUNT_TAG     FIELD_TAG(11, WIRETYPE_VARINT)
+#define FRAME_UNWIND_METHOD_TAG     FIELD_TAG(12, WIRETYPE_VARINT)
+
+/* Symbol field tags */
+#define SYMBOL_NAME_TAG             FIELD_TAG(1, WIRETYPE_LENGTH_PREFIXED)
+#define SYMBOL_START_ADDRESS_TAG    FIELD_TAG(2, WIRETYPE_VARINT)
+#define SYMBOL_END_ADDRESS_TAG      FIELD_TAG(3, WIRETYPE_VARINT)
+
+/* BinaryImage field tags */
+#define IMAGE_BASE_ADDRESS_TAG      FIELD_TAG(1, WIRETYPE_VARINT)
+#define IMAGE_SIZE_TAG              FIELD_TAG(2, WIRETYPE_VARINT)
+#define IMAGE_NAME_TAG              FIELD_TAG(3, WIRETYPE_LENGTH_PREFIXED)
+#define IMAGE_UUID_TAG              FIELD_TAG(4, WIRETYPE_LENGTH_PREFIXED)
+#define IMAGE_CODE_TYPE_TAG         FIELD_TAG(5, WIRETYPE_LENGTH_PREFIXED)
+#define IMAGE_DIRECTORY_INDEX_TAG   FIELD_TAG(6, WIRETYPE_VARINT)
+
+/* Processor field tags */
+#define PROCESSOR_ENCODING_TAG      FIELD_TAG(1, WIRETYPE_VARINT)
+#define PROCESSOR_TYPE_TAG          FIELD_TAG(2, WIRETYPE_VARINT)
+#define PROCESSOR_SUBTYPE_TAG       FIELD_TAG(3, WIRETYPE_VARINT)
+
+/** Size of the on-stack buffer used to strip the frames from a Thread record; see decode_thread_fields(). */
+#define THREAD_FIELDS_STACK_BUFFER_SIZE 1024
+
+/**
+ * Read a base-128 varint from @a cursor, advancing @a cursor past the value. Returns false if the varint is
+ * truncated or exceeds 64 bits.
+ */
+static inline bool read_varint (const uint8_t **cursor, const uint8_t *end, uint64_t *result) {
+    const uint8_t *p = *cursor;
+    uint64_t value = 0;
+
+    /* Nearly all tags and many values fit in a single byte */
+    if (p < end && (*p & 0x80) == 0) {
+        *result = *p;
+        *cursor = p + 1;
+        return true;
+    }
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (p >= end)
+            return false;
+
+        uint8_t byte = *p++;
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+        if ((byte & 0x80) == 0) {
+            *result = value;
+            *cursor = p;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Read the length prefix of a length-delimited value from @a cursor, advancing @a cursor to the start of the value.
+ * Returns false if the length is malformed, or exceeds the available data.
+ */
+static inline bool read_length (const uint8_t **cursor, const uint8_t *end, size_t *length) {
+    uint64_t value;
+    if (!read_varint(cursor, end, &value) || value > (uint64_t) (end - *cursor))
+        return false;
+
+    *length = (size_t) value;
+    return true;
+}
+
+/**
+ * Skip the value of a field with the given wire @a type. Returns false if the value is malformed, or the wire type
+ * is not supported.
+ */
+static bool skip_value (const uint8_t **cursor, const uint8_t *end, uint64_t type) {
+    uint64_t value;
+    size_t length;
+
+    switch (type) {
+        case WIRETYPE_VARINT:
+            return read_varint(cursor, end, &value);
+
+        case WIRETYPE_64BIT:
+            if ((size_t) (end - *cursor) < 8)
+                return false;
+            *cursor += 8;
+            return true;
+
+        case WIRETYPE_LENGTH_PREFIXED:
+            if (!read_length(cursor, end, &length))
+                return false;
+            *cursor += length;
+            return true;
+
+        case WIRETYPE_32BIT:
+            if ((size_t) (end - *cursor) < 4)
+                return false;
+            *cursor += 4;
+            return true;
+
+        default:
+            /* Groups are not used by crash_report.proto */
+            return false;
+    }
+}
+
+/**
+ * Allocate a NUL-terminated copy of the @a length bytes at @a data from @a strings, or from @a allocator if
+ * @a strings is NULL. Returns NULL on failure.
+ */
+static char *copy_string (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings, const uint8_t *data, size_t length) {
+    if (strings != NULL)
+        return plcrash_report_string_pool_copy(strings, data, length);
+
+    char *str = allocator->alloc(allocator->allocator_data, length + 1);
+    if (str == NULL)
+        return NULL;
+
+    memcpy(str, data, length);
+    str[length] = '\0';
+    return str;
+}
+
+/**
+ * Discard the partially decoded @a message. If string values were allocated from a string pool, they can not be
+ * passed to @a allocator, and the message is instead abandoned to @a allocator; see plcrash_report_decode_thread().
+ */
+static void discard_message (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings, ProtobufCMessage *message) {
+    if (strings == NULL)
+        protobuf_c_message_free_unpacked(message, allocator);
+}
+
+/**
+ * Decode a Processor message. Returns NULL if the message can not be decoded by the specialized decoder.
+ */
+static Plcrash__CrashReport__Processor *decode_processor (ProtobufCAllocator *allocator, const uint8_t *cursor, const uint8_t *end) {
+    Plcrash__CrashReport__Processor *processor;
+    bool has_type = false;
+    bool has_subtype = false;
+    uint64_t tag;
+    uint64_t value;
+
+    if ((processor = allocator->alloc(allocator->allocator_data, sizeof(*processor))) == NULL)
+        return NULL;
+    *processor = (Plcrash__CrashReport__Processor) PLCRASH__CRASH_REPORT__PROCESSOR__INIT;
+
+    while (cursor < end) {
+        if (!read_varint(&cursor, end, &tag) || !read_varint(&cursor, end, &value))
+            goto error;
+
+        switch (tag) {
+            case PROCESSOR_ENCODING_TAG:
+                processor->has_encoding = 1;
+                processor->encoding = (Plcrash__CrashReport__Processor__TypeEncoding) (uint32_t) value;
+                break;
+
+            case PROCESSOR_TYPE_TAG:
+                processor->type = value;
+                has_type = true;
+                break;
+
+            case PROCESSOR_SUBTYPE_TAG:
+                processor->subtype = value;
+                has_subtype = true;
+                break;
+
+            default:
+                goto error;
+        }
+    }
+
+    if (!has_type || !has_subtype)
+        goto error;
+
+    return processor;
+
+error:
+    protobuf_c_message_free_unpacked(&processor->base, allocator);
+    return NULL;
+}
+
+/**
+ * Decode a Symbol message. Returns NULL if the message can not be decoded by the specialized decoder.
+ */
+static Plcrash__CrashReport__Symbol *decode_symbol (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                     const uint8_t *cursor, const uint8_t *end)
+{
+    Plcrash__CrashReport__Symbol *symbol;
+    bool has_start_address = false;
+    uint64_t tag;
+    uint64_t value;
+    size_t length;
+
+    if ((symbol = allocator->alloc(allocator->allocator_data, sizeof(*symbol))) == NULL)
+        return NULL;
+    *symbol = (Plcrash__CrashReport__Symbol) PLCRASH__CRASH_REPORT__SYMBOL__INIT;
+
+    while (cursor < end) {
+        if (!read_varint(&cursor, end, &tag))
+            goto error;
+
+        switch (tag) {
+            case SYMBOL_NAME_TAG:
+                if (symbol->name != NULL || !read_length(&cursor, end, &length))
+                    goto error;
+                if ((symbol->name = copy_string(allocator, strings, cursor, length)) == NULL)
+                    goto error;
+                cursor += length;
+                break;
+
+            case SYMBOL_START_ADDRESS_TAG:
+                if (!read_varint(&cursor, end, &value))
+                    goto error;
+                symbol->start_address = value;
+                has_start_address = true;
+                break;
+
+            case SYMBOL_END_ADDRESS_TAG:
+                if (!read_varint(&cursor, end, &value))
+                    goto error;
+                symbol->has_end_address = 1;
+                symbol->end_address = value;
+                break;
+
+            default:
+                goto error;
+        }
+    }
+
+    if (symbol->name == NULL || !has_start_address)
+        goto error;
+
+    return symbol;
+
+error:
+    discard_message(allocator, strings, &symbol->base);
+    return NULL;
+}
+
+/**
+ * Decode a Thread.StackFrame message into @a frame, which must have been initialized with
+ * PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__INIT. Returns false if the message can not be decoded by the
+ * specialized decoder, in which case @a frame may have been partially populated.
+ */
+static bool decode_stack_frame (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings, Plcrash__CrashReport__Thread__StackFrame *frame,
+                                const uint8_t *cursor, const uint8_t *end)
+{
+    uint64_t tag;
+    uint64_t value;
+    size_t length;
+
+    while (cursor < end) {
+        if (!read_varint(&cursor, end, &tag))
+            return false;
+
+        /* The symbol is the frame's only length-delimited field */
+        if (tag == FRAME_SYMBOL_TAG) {
+            if (frame->symbol != NULL || !read_length(&cursor, end, &length))
+                return false;
+            if ((frame->symbol = decode_symbol(allocator, strings, cursor, cursor + length)) == NULL)
+                return false;
+            cursor += length;
+            continue;
+        }
+
+        if (!read_varint(&cursor, end, &value))
+            return false;
+
+        switch (tag) {
+            case FRAME_PC_TAG:
+                frame->has_pc = 1;
+                frame->pc = value;
+                break;
+
+            case FRAME_IMAGE_INDEX_TAG:
+                frame->has_image_index = 1;
+                frame->image_index = (uint32_t) value;
+                break;
+
+            case FRAME_OFFSET_DELTA_TAG:
+                /* sint64; zigzag encoded */
+                frame->has_offset_delta = 1;
+                frame->offset_delta = (int64_t) ((value >> 1) ^ (~(value & 1) + 1));
+                break;
+
+            case FRAME_REPEAT_LENGTH_TAG:
+                frame->has_repeat_length = 1;
+                frame->repeat_length = (uint32_t) value;
+                break;
+
+            case FRAME_REPEAT_COUNT_TAG:
+                frame->has_repeat_count = 1;
+                frame->repeat_count = (uint32_t) value;
+                break;
+
+            case FRAME_OMITTED_COUNT_TAG:
+                frame->has_omitted_count = 1;
+                frame->omitted_count = (uint32_t) value;
+                break;
+
+            case FRAME_UNWIND_METHOD_TAG:
+                frame->has_unwind_method = 1;
+                frame->unwind_method = (Plcrash__CrashReport__Thread__StackFrame__UnwindMethod) (uint32_t) value;
+                break;
+
+            default:
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Decode the non-frame fields of the Thread record at @a data. If the record contains only the thread number and
+ * crashed flag, these are decoded directly; otherwise, all non-frame fields are copied to a temporary buffer and
+ * unpacked by protobuf-c.
+ *
+ * On success, returns the thread with no frames, and the number of frame records in @a frame_count. Returns NULL
+ * if the record is malformed, or could not be decoded.
+ */
+static Plcrash__CrashReport__Thread *decode_thread_fields (ProtobufCAllocator *allocator, size_t length, const uint8_t *data,
+                                                           size_t *frame_count)
+{
+    const uint8_t *end = data + length;
+    const uint8_t *cursor = data;
+    Plcrash__CrashReport__Thread *thread;
+    bool has_other_fields = false;
+    bool has_thread_number = false;
+    bool has_crashed = false;
+    uint32_t thread_number = 0;
+    protobuf_c_boolean crashed = 0;
+    uint8_t stack_buffer[THREAD_FIELDS_STACK_BUFFER_SIZE];
+    uint8_t *buffer;
+    size_t buffer_length = 0;
+
+    /* Count the frames, and determine whether protobuf-c is required to decode the remaining fields */
+    *frame_count = 0;
+    while (cursor < end) {
+        uint64_t tag;
+        uint64_t value;
+
+        if (!read_varint(&cursor, end, &tag))
+            return NULL;
+
+        switch (tag) {
+            case THREAD_FRAMES_TAG:
+                if (!skip_value(&cursor, end, tag & 0x7))
+                    return NULL;
+                (*frame_count)++;
+                break;
+
+            case THREAD_NUMBER_TAG:
+                if (!read_varint(&cursor, end, &value))
+                    return NULL;
+                thread_number = (uint32_t) value;
+                has_thread_number = true;
+                break;
+
+            case THREAD_CRASHED_TAG:
+                if (!read_varint(&cursor, end, &value))
+                    return NULL;
+                crashed = value != 0;
+                has_crashed = true;
+                break;
+
+            default:
+                if (!skip_value(&cursor, end, tag & 0x7))
+                    return NULL;
+                has_other_fields = true;
+                break;
+        }
+    }
+
+    /* Fast path; no registers or other optional thread state */
+    if (!has_other_fields) {
+        if (!has_thread_number || !has_crashed)
+            return NULL;
+
+        if ((thread = allocator->alloc(allocator->allocator_data, sizeof(*thread))) == NULL)
+            return NULL;
+        *thread = (Plcrash__CrashReport__Thread) PLCRASH__CRASH_REPORT__THREAD__INIT;
+        thread->thread_number = thread_number;
+        thread->crashed = crashed;
+        return thread;
+    }
+
+    /* Otherwise, strip the frames, and hand the remainder to protobuf-c. */
+    if (length <= sizeof(stack_buffer)) {
+        buffer = stack_buffer;
+    } else if ((buffer = malloc(length)) == NULL) {
+        return NULL;
+    }
+
+    cursor = data;
+    while (cursor < end) {
+        const uint8_t *field_start = cursor;
+        uint64_t tag;
+
+        /* The record was validated above */
+        read_varint(&cursor, end, &tag);
+        skip_value(&cursor, end, tag & 0x7);
+
+        if (tag != THREAD_FRAMES_TAG) {
+            memcpy(buffer + buffer_length, field_start, cursor - field_start);
+            buffer_length += cursor - field_start;
+        }
+    }
+
+    thread = (Plcrash__CrashReport__Thread *) protobuf_c_message_unpack(&plcrash__crash_report__thread__descriptor, allocator, buffer_length, buffer);
+
+    if (buffer != stack_buffer)
+        free(buffer);
+
+    return thread;
+}
+
+/**
+ * Decode a Thread record with the specialized decoders. Returns NULL if the record can not be decoded by the
+ * specialized decoders.
+ */
+static Plcrash__CrashReport__Thread *decode_thread (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                     size_t length, const uint8_t *data)
+{
+    Plcrash__CrashReport__Thread *thread;
+    const uint8_t *end = data + length;
+    const uint8_t *cursor = data;
+    size_t frame_count;
+
+    if ((thread = decode_thread_fields(allocator, length, data, &frame_count)) == NULL)
+        return NULL;
+
+    if (frame_count == 0)
+        return thread;
+
+    /* Allocate the frame table and the frames. protobuf_c_message_free_unpacked() requires that each frame be
+     * individually allocated. */
+    if ((thread->frames = allocator->alloc(allocator->allocator_data, frame_count * sizeof(*thread->frames))) == NULL)
+        goto error;
+
+    while (cursor < end) {
+        Plcrash__CrashReport__Thread__StackFrame *frame;
+        uint64_t tag;
+        size_t frame_length;
+
+        /* The record was validated by decode_thread_fields() */
+        read_varint(&cursor, end, &tag);
+        if (tag != THREAD_FRAMES_TAG) {
+            skip_value(&cursor, end, tag & 0x7);
+            continue;
+        }
+
+        read_length(&cursor, end, &frame_length);
+        if ((frame = allocator->alloc(allocator->allocator_data, sizeof(*frame))) == NULL)
+            goto error;
+        *frame = (Plcrash__CrashReport__Thread__StackFrame) PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__INIT;
+        thread->frames[thread->n_frames++] = frame;
+
+        if (!decode_stack_frame(allocator, strings, frame, cursor, cursor + frame_length))
+            goto error;
+        cursor += frame_length;
+    }
+
+    return thread;
+
+error:
+    discard_message(allocator, strings, &thread->base);
+    return NULL;
+}
+
+/**
+ * Decode a BinaryImage record with the specialized decoder. Returns NULL if the record can not be decoded by the
+ * specialized decoder.
+ */
+static Plcrash__CrashReport__BinaryImage *decode_binary_image (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                               size_t length, const uint8_t *data)
+{
+    Plcrash__CrashReport__BinaryImage *image;
+    const uint8_t *end = data + length;
+    const uint8_t *cursor = data;
+    bool has_base_address = false;
+    bool has_size = false;
+
+    if ((image = allocator->alloc(allocator->allocator_data, sizeof(*image))) == NULL)
+        return NULL;
+    *image = (Plcrash__CrashReport__BinaryImage) PLCRASH__CRASH_REPORT__BINARY_IMAGE__INIT;
+
+    while (cursor < end) {
+        uint64_t tag;
+        uint64_t value;
+        size_t value_length;
+
+        if (!read_varint(&cursor, end, &tag))
+            goto error;
+
+        /* Length-delimited fields */
+        if ((tag & 0x7) == WIRETYPE_LENGTH_PREFIXED) {
+            if (!read_length(&cursor, end, &value_length))
+                goto error;
+
+            switch (tag) {
+                case IMAGE_NAME_TAG:
+                    if (image->name != NULL)
+                        goto error;
+                    if ((image->name = copy_string(allocator, strings, cursor, value_length)) == NULL)
+                        goto error;
+                    break;
+
+                case IMAGE_UUID_TAG:
+                    if (image->has_uuid)
+                        goto error;
+                    if (value_length > 0) {
+                        if ((image->uuid.data = allocator->alloc(allocator->allocator_data, value_length)) == NULL)
+                            goto error;
+                        memcpy(image->uuid.data, cursor, value_length);
+                    }
+                    image->uuid.len = value_length;
+                    image->has_uuid = 1;
+                    break;
+
+                case IMAGE_CODE_TYPE_TAG:
+                    if (image->code_type != NULL)
+                        goto error;
+                    if ((image->code_type = decode_processor(allocator, cursor, cursor + value_length)) == NULL)
+                        goto error;
+                    break;
+
+                default:
+                    goto error;
+            }
+
+            cursor += value_length;
+            continue;
+        }
+
+        /* Varint fields */
+        if (!read_varint(&cursor, end, &value))
+            goto error;
+
+        switch (tag) {
+            case IMAGE_BASE_ADDRESS_TAG:
+                image->base_address = value;
+                has_base_address = true;
+                break;
+
+            case IMAGE_SIZE_TAG:
+                image->size = value;
+                has_size = true;
+                break;
+
+            case IMAGE_DIRECTORY_INDEX_TAG:
+                image->has_directory_index = 1;
+                image->directory_index = (uint32_t) value;
+                break;
+
+            default:
+                goto error;
+        }
+    }
+
+    if (!has_base_address || !has_size || image->name == NULL)
+        goto error;
+
+    return image;
+
+error:
+    discard_message(allocator, strings, &image->base);
+    return NULL;
+}
+
+/**
+ * @} plcrash_report_record_decoder
+ */
+
+/**
+ * @internal
+ *
+ * Decode an encoded Thread record, using the specialized stack frame decoder where possible, and falling back
+ * to protobuf-c otherwise.
+ *
+ * @param allocator The allocator from which the thread will be allocated.
+ * @param strings If non-NULL, the pool from which the symbol names of specialized-decoded frames will be allocated.
+ * As these strings are not owned by @a allocator, the returned thread must not be freed with
+ * protobuf_c_message_free_unpacked(), and @a allocator must be an arena that is released in its entirety.
+ * @param length The length of @a data.
+ * @param data The encoded Thread message.
+ *
+ * @return Returns the decoded thread, or NULL if the record is malformed.
+ */
+Plcrash__CrashReport__Thread *plcrash_report_decode_thread (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                           size_t length, const uint8_t *data)
+{
+    Plcrash__CrashReport__Thread *thread = decode_thread(allocator, strings, length, data);
+    if (thread != NULL)
+        return thread;
+
+    return (Plcrash__CrashReport__Thread *) protobuf_c_message_unpack(&plcrash__crash_report__thread__descriptor, allocator, length, data);
+}
+
+/**
+ * @internal
+ *
+ * Decode an encoded BinaryImage record, using the specialized decoder where possible, and falling back to
+ * protobuf-c otherwise.
+ *
+ * @param allocator The allocator from which the image will be allocated.
+ * @param strings If non-NULL, the pool from which the image name will be allocated. See
+ * plcrash_report_decode_thread().
+ * @param length The length of @a data.
+ * @param data The encoded BinaryImage message.
+ *
+ * @return Returns the decoded image, or NULL if the record is malformed.
+ */
+Plcrash__CrashReport__BinaryImage *plcrash_report_decode_binary_image (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                                       size_t length, const uint8_t *data)
+{
+    Plcrash__CrashReport__BinaryImage *image = decode_binary_image(allocator, strings, length, data);
+    if (image != NULL)
+        return image;
+
+    return (Plcrash__CrashReport__BinaryImage *) protobuf_c_message_unpack(&plcrash__crash_report__binary_image__descriptor, allocator, length, data);
+}
+
+/**
+ * @internal
+ *
+ * Decode an encoded record of type @a descriptor, using the specialized Thread or BinaryImage decoders where
+ * applicable, and protobuf_c_message_unpack() for all other message types.
+ *
+ * @param descriptor The record's message descriptor.
+ * @param allocator The allocator from which the record will be allocated.
+ * @param strings If non-NULL, the pool from which thread and image strings will be allocated. See
+ * plcrash_report_decode_thread().
+ * @param length The length of @a data.
+ * @param data The encoded message.
+ *
+ * @return Returns the decoded record, or NULL if the record is malformed.
+ */
+ProtobufCMessage *plcrash_report_decode_record (const ProtobufCMessageDescriptor *descriptor, ProtobufCAllocator *allocator,
+                                                plcrash_report_string_pool_t *strings, size_t length, const uint8_t *data)
+{
+    if (descriptor == &plcrash__crash_report__thread__descriptor)
+        return (ProtobufCMessage *) plcrash_report_decode_thread(allocator, strings, length, data);
+
+    if (descriptor == &plcrash__crash_report__binary_image__descriptor)
+        return (ProtobufCMessage *) plcrash_report_decode_binary_image(allocator, strings, length, data);
+
+    return protobuf_c_message_unpack(descriptor, allocator, length, data);
+}
+
+/**
+ * @internal
+ *
+ * Determine whether an encoded Thread record is marked as crashed, without decoding the record. The record's
+ * fields are skipped by wire type; its frames, registers and other nested messages are not examined.
+ *
+ * @param length The length of @a data.
+ * @param data The encoded Thread message.
+ * @param crashed On success, the value of the record's crashed field.
+ *
+ * @return Returns true on success, or false if the record is malformed, or has no crashed field.
+ */
+bool plcrash_report_thread_crashed (size_t length, const uint8_t *data, bool *crashed) {
+    const uint8_t *cursor = data;
+    const uint8_t *end = data + length;
+    bool found = false;
+
+    while (cursor < end) {
+        uint64_t tag;
+        if (!read_varint(&cursor, end, &tag))
+            return false;
+
+        if (tag == THREAD_CRASHED_TAG) {
+            uint64_t value;
+            if (!read_varint(&cursor, end, &value))
+                return false;
+
+            /* The last value of a repeated singular field takes precedence */
+            *crashed = (value != 0);
+            found = true;
+        } else if (!skip_value(&cursor, end, tag & 0x7)) {
+            return false;
+        }
+    }
+
+    return found;
+}
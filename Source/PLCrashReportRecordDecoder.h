@@ -0,0 +1,84 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_REPORT_RECORD_DECODER_H
+#define PLCRASH_REPORT_RECORD_DECODER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "protobuf-c.h"
+#include "crash_report.pb-c.h"
+#include "PLCrashReportStringPool.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_report_record_decoder Crash Report Record Decoder
+ *
+ * Implements schema-specialized decoders for the thread and binary image records that make up the bulk of an
+ * encoded crash report. The generic protobuf-c decoder performs a descriptor lookup and indirect member store for
+ * every field; these decoders instead switch directly on the encoded field tags of Thread.StackFrame, Symbol,
+ * BinaryImage and Processor, producing the same protobuf-c message structures.
+ *
+ * Any record that the specialized decoders do not fully understand -- an unknown field, an unexpected wire type,
+ * a repeated singular message, or a missing required field -- is decoded by protobuf_c_message_unpack() instead.
+ * The remaining Thread fields (registers, register state, scheduling, and stack memory) are always decoded by
+ * protobuf-c.
+ *
+ * The returned messages may be freed with protobuf_c_message_free_unpacked(), but are expected to be allocated
+ * from a plcrash_report_arena. Image and symbol names may instead be allocated from a plcrash_report_string_pool,
+ * allowing them to be bridged to NSString without a further copy.
+ *
+ * @{
+ */
+
+Plcrash__CrashReport__Thread *plcrash_report_decode_thread (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                           size_t length, const uint8_t *data);
+Plcrash__CrashReport__BinaryImage *plcrash_report_decode_binary_image (ProtobufCAllocator *allocator, plcrash_report_string_pool_t *strings,
+                                                                       size_t length, const uint8_t *data);
+
+ProtobufCMessage *plcrash_report_decode_record (const ProtobufCMessageDescriptor *descriptor, ProtobufCAllocator *allocator,
+                                                plcrash_report_string_pool_t *strings, size_t length, const uint8_t *data);
+
+bool plcrash_report_thread_crashed (size_t length, const uint8_t *data, bool *crashed);
+
+/**
+ * @} plcrash_report_record_decoder
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_REPORT_RECORD_DECODER_H */
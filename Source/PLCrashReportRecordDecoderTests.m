@@ -0,0 +1,242 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashReportRecordDecoder.h"
+#import "PLCrashReportArena.h"
+
+@interface PLCrashReportRecordDecoderTests : SenTestCase {
+@private
+    /** Arena used to decode test records. */
+    plcrash_report_arena_t *_arena;
+
+    /** The arena's allocator. */
+    ProtobufCAllocator *_allocator;
+}
+
+@end
+
+/* Pack @a message into a new data object */
+static NSData *pack_message (const ProtobufCMessage *message) {
+    NSMutableData *data = [NSMutableData dataWithLength: protobuf_c_message_get_packed_size(message)];
+    protobuf_c_message_pack(message, [data mutableBytes]);
+    return data;
+}
+
+@implementation PLCrashReportRecordDecoderTests
+
+- (void) setUp {
+    _arena = plcrash_report_arena_new(0);
+    _allocator = plcrash_report_arena_allocator(_arena);
+}
+
+- (void) tearDown {
+    plcrash_report_arena_free(_arena);
+}
+
+/**
+ * Test decoding of a thread containing only frames, which is handled entirely by the specialized decoder.
+ */
+- (void) testDecodeThread {
+    Plcrash__CrashReport__Thread thread = PLCRASH__CRASH_REPORT__THREAD__INIT;
+    Plcrash__CrashReport__Thread__StackFrame frames[3] = {
+        PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__INIT,
+        PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__INIT,
+        PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__INIT
+    };
+    Plcrash__CrashReport__Thread__StackFrame *framePtrs[3] = { &frames[0], &frames[1], &frames[2] };
+    Plcrash__CrashReport__Symbol symbol = PLCRASH__CRASH_REPORT__SYMBOL__INIT;
+
+    symbol.name = "main";
+    symbol.start_address = 0x1000;
+    symbol.has_end_address = 1;
+    symbol.end_address = 0x1100;
+
+    frames[0].has_pc = 1;
+    frames[0].pc = 0x1010;
+    frames[0].symbol = &symbol;
+    frames[0].has_unwind_method = 1;
+    frames[0].unwind_method = PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__UNWIND_METHOD__UNWIND_DWARF;
+
+    frames[1].has_image_index = 1;
+    frames[1].image_index = 3;
+    frames[1].has_offset_delta = 1;
+    frames[1].offset_delta = -17;
+    frames[1].has_repeat_length = 1;
+    frames[1].repeat_length = 2;
+    frames[1].has_repeat_count = 1;
+    frames[1].repeat_count = 9;
+
+    frames[2].has_pc = 1;
+    frames[2].pc = UINT64_MAX;
+    frames[2].has_omitted_count = 1;
+    frames[2].omitted_count = 4;
+
+    thread.thread_number = 7;
+    thread.crashed = 1;
+    thread.n_frames = 3;
+    thread.frames = framePtrs;
+
+    NSData *data = pack_message(&thread.base);
+    Plcrash__CrashReport__Thread *decoded = plcrash_report_decode_thread(_allocator, NULL, [data length], [data bytes]);
+    STAssertNotNULL(decoded, @"Failed to decode thread");
+
+    STAssertEquals(decoded->thread_number, (uint32_t) 7, @"Incorrect thread number");
+    STAssertTrue(decoded->crashed, @"Thread should be marked as crashed");
+    STAssertEquals(decoded->n_frames, (size_t) 3, @"Incorrect frame count");
+
+    STAssertTrue(decoded->frames[0]->has_pc, @"Missing pc");
+    STAssertEquals(decoded->frames[0]->pc, (uint64_t) 0x1010, @"Incorrect pc");
+    STAssertNotNULL(decoded->frames[0]->symbol, @"Missing symbol");
+    STAssertEqualCStrings(decoded->frames[0]->symbol->name, "main", @"Incorrect symbol name");
+    STAssertEquals(decoded->frames[0]->symbol->start_address, (uint64_t) 0x1000, @"Incorrect symbol start");
+    STAssertTrue(decoded->frames[0]->symbol->has_end_address, @"Missing symbol end");
+    STAssertEquals(decoded->frames[0]->symbol->end_address, (uint64_t) 0x1100, @"Incorrect symbol end");
+    STAssertTrue(decoded->frames[0]->has_unwind_method, @"Missing unwind method");
+    STAssertEquals(decoded->frames[0]->unwind_method, PLCRASH__CRASH_REPORT__THREAD__STACK_FRAME__UNWIND_METHOD__UNWIND_DWARF, @"Incorrect unwind method");
+
+    STAssertFalse(decoded->frames[1]->has_pc, @"Unexpected pc");
+    STAssertNULL(decoded->frames[1]->symbol, @"Unexpected symbol");
+    STAssertTrue(decoded->frames[1]->has_image_index, @"Missing image index");
+    STAssertEquals(decoded->frames[1]->image_index, (uint32_t) 3, @"Incorrect image index");
+    STAssertTrue(decoded->frames[1]->has_offset_delta, @"Missing offset delta");
+    STAssertEquals(decoded->frames[1]->offset_delta, (int64_t) -17, @"Incorrect zigzag decoding");
+    STAssertEquals(decoded->frames[1]->repeat_length, (uint32_t) 2, @"Incorrect repeat length");
+    STAssertEquals(decoded->frames[1]->repeat_count, (uint32_t) 9, @"Incorrect repeat count");
+    STAssertFalse(decoded->frames[1]->has_unwind_method, @"Unexpected unwind method");
+
+    STAssertEquals(decoded->frames[2]->pc, UINT64_MAX, @"Incorrect 10-byte varint decoding");
+    STAssertTrue(decoded->frames[2]->has_omitted_count, @"Missing omitted count");
+    STAssertEquals(decoded->frames[2]->omitted_count, (uint32_t) 4, @"Incorrect omitted count");
+
+    /* Register values are passed through to protobuf-c, and must not disturb the specialized frame decoding */
+    Plcrash__CrashReport__Thread__RegisterValue reg = PLCRASH__CRASH_REPORT__THREAD__REGISTER_VALUE__INIT;
+    Plcrash__CrashReport__Thread__RegisterValue *regPtr = &reg;
+    reg.name = "pc";
+    reg.value = 0x1010;
+    thread.n_registers = 1;
+    thread.registers = &regPtr;
+
+    data = pack_message(&thread.base);
+    decoded = plcrash_report_decode_thread(_allocator, NULL, [data length], [data bytes]);
+    STAssertNotNULL(decoded, @"Failed to decode thread");
+    STAssertEquals(decoded->thread_number, (uint32_t) 7, @"Incorrect thread number");
+    STAssertEquals(decoded->n_registers, (size_t) 1, @"Incorrect register count");
+    STAssertEqualCStrings(decoded->registers[0]->name, "pc", @"Incorrect register name");
+    STAssertEquals(decoded->registers[0]->value, (uint64_t) 0x1010, @"Incorrect register value");
+    STAssertEquals(decoded->n_frames, (size_t) 3, @"Incorrect frame count");
+    STAssertEquals(decoded->frames[1]->offset_delta, (int64_t) -17, @"Incorrect frame decoding");
+}
+
+/**
+ * Test decoding of a binary image.
+ */
+- (void) testDecodeBinaryImage {
+    Plcrash__CrashReport__BinaryImage image = PLCRASH__CRASH_REPORT__BINARY_IMAGE__INIT;
+    Plcrash__CrashReport__Processor codeType = PLCRASH__CRASH_REPORT__PROCESSOR__INIT;
+    uint8_t uuid[16] = { 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF };
+
+    codeType.has_encoding = 1;
+    codeType.encoding = PLCRASH__CRASH_REPORT__PROCESSOR__TYPE_ENCODING__TYPE_ENCODING_MACH;
+    codeType.type = 16777228;
+    codeType.subtype = 2;
+
+    image.base_address = 0x100000000ULL;
+    image.size = 8192;
+    image.name = "libSystem.B.dylib";
+    image.has_uuid = 1;
+    image.uuid.len = sizeof(uuid);
+    image.uuid.data = uuid;
+    image.code_type = &codeType;
+    image.has_directory_index = 1;
+    image.directory_index = 5;
+
+    NSData *data = pack_message(&image.base);
+    Plcrash__CrashReport__BinaryImage *decoded = plcrash_report_decode_binary_image(_allocator, NULL, [data length], [data bytes]);
+    STAssertNotNULL(decoded, @"Failed to decode image");
+
+    STAssertEquals(decoded->base_address, (uint64_t) 0x100000000ULL, @"Incorrect base address");
+    STAssertEquals(decoded->size, (uint64_t) 8192, @"Incorrect size");
+    STAssertEqualCStrings(decoded->name, "libSystem.B.dylib", @"Incorrect name");
+    STAssertTrue(decoded->has_uuid, @"Missing UUID");
+    STAssertEquals(decoded->uuid.len, sizeof(uuid), @"Incorrect UUID length");
+    STAssertTrue(memcmp(decoded->uuid.data, uuid, sizeof(uuid)) == 0, @"Incorrect UUID");
+    STAssertNotNULL(decoded->code_type, @"Missing code type");
+    STAssertEquals(decoded->code_type->encoding, PLCRASH__CRASH_REPORT__PROCESSOR__TYPE_ENCODING__TYPE_ENCODING_MACH, @"Incorrect encoding");
+    STAssertEquals(decoded->code_type->type, (uint64_t) 16777228, @"Incorrect CPU type");
+    STAssertEquals(decoded->code_type->subtype, (uint64_t) 2, @"Incorrect CPU subtype");
+    STAssertTrue(decoded->has_directory_index, @"Missing directory index");
+    STAssertEquals(decoded->directory_index, (uint32_t) 5, @"Incorrect directory index");
+}
+
+/**
+ * Test decoding of image names into a string pool.
+ */
+- (void) testDecodeIntoStringPool {
+    Plcrash__CrashReport__BinaryImage image = PLCRASH__CRASH_REPORT__BINARY_IMAGE__INIT;
+    image.base_address = 0x1000;
+    image.size = 4096;
+    image.name = "/usr/lib/libobjc.A.dylib";
+
+    plcrash_report_string_pool_t *pool = plcrash_report_string_pool_new();
+    STAssertNotNULL(pool, @"Failed to allocate pool");
+
+    NSData *data = pack_message(&image.base);
+    Plcrash__CrashReport__BinaryImage *decoded = plcrash_report_decode_binary_image(_allocator, pool, [data length], [data bytes]);
+    STAssertNotNULL(decoded, @"Failed to decode image");
+    STAssertEqualCStrings(decoded->name, image.name, @"Incorrect name");
+    STAssertTrue(plcrash_report_string_pool_contains(pool, decoded->name), @"Name was not allocated from the pool");
+
+    plcrash_report_string_pool_release(pool);
+}
+
+/**
+ * Test that malformed records are rejected, both by the specialized decoders and the protobuf-c fallback.
+ */
+- (void) testDecodeMalformed {
+    Plcrash__CrashReport__BinaryImage image = PLCRASH__CRASH_REPORT__BINARY_IMAGE__INIT;
+    image.base_address = 0x1000;
+    image.size = 4096;
+    image.name = "image";
+
+    NSData *data = pack_message(&image.base);
+
+    /* Truncated */
+    STAssertNULL(plcrash_report_decode_binary_image(_allocator, NULL, [data length] - 1, [data bytes]), @"Decoded a truncated image");
+
+    /* Missing the required name, which is the last field written */
+    NSData *noName = [data subdataWithRange: NSMakeRange(0, [data length] - (strlen(image.name) + 2))];
+    STAssertNULL(plcrash_report_decode_binary_image(_allocator, NULL, [noName length], [noName bytes]), @"Decoded an image with no name");
+
+    /* A thread with a thread_number, but missing its required crashed flag */
+    const uint8_t noCrashed[] = { 0x08, 0x01 };
+    STAssertNULL(plcrash_report_decode_thread(_allocator, NULL, sizeof(noCrashed), noCrashed), @"Decoded a thread with no crashed flag");
+}
+
+@end
@@ -35,10 +35,29 @@
     
     /** Register value */
     uint64_t _registerValue;
+
+    /** YES if the value is an address within a binary image */
+    BOOL _hasImageIndex;
+
+    /** The containing binary image's index */
+    NSUInteger _imageIndex;
+
+    /** YES if the value is an address within a symbol */
+    BOOL _hasSymbolStart;
+
+    /** The containing symbol's start address */
+    uint64_t _symbolStart;
 }
 
 - (id) initWithRegisterName: (NSString *) registerName registerValue: (uint64_t) registerValue;
 
+- (id) initWithRegisterName: (NSString *) registerName
+              registerValue: (uint64_t) registerValue
+              hasImageIndex: (BOOL) hasImageIndex
+                 imageIndex: (NSUInteger) imageIndex
+             hasSymbolStart: (BOOL) hasSymbolStart
+                symbolStart: (uint64_t) symbolStart;
+
 /**
  * Register name.
  */
@@ -49,4 +68,27 @@
  */
 @property(nonatomic, readonly) uint64_t registerValue;
 
+/**
+ * YES if the register value is an address within one of the report's binary images. Only recorded for the
+ * crashed thread.
+ */
+@property(nonatomic, readonly) BOOL hasImageIndex;
+
+/**
+ * The index of the binary image containing the register value within the report's binary images. Only valid if
+ * hasImageIndex is YES.
+ */
+@property(nonatomic, readonly) NSUInteger imageIndex;
+
+/**
+ * YES if the register value is an address within a symbol of its containing image's text segment. Only recorded
+ * for the crashed thread.
+ */
+@property(nonatomic, readonly) BOOL hasSymbolStart;
+
+/**
+ * The start address of the symbol containing the register value. Only valid if hasSymbolStart is YES.
+ */
+@property(nonatomic, readonly) uint64_t symbolStart;
+
 @end
@@ -38,11 +38,35 @@
  * Initialize with the provided name and value.
  */
 - (id) initWithRegisterName: (NSString *) registerName registerValue: (uint64_t) registerValue {
+    return [self initWithRegisterName: registerName registerValue: registerValue hasImageIndex: NO imageIndex: 0 hasSymbolStart: NO symbolStart: 0];
+}
+
+/**
+ * Initialize with the provided name, value, and containing image and symbol.
+ *
+ * @param registerName The register name.
+ * @param registerValue The register value.
+ * @param hasImageIndex YES if @a imageIndex is valid.
+ * @param imageIndex The index of the binary image containing @a registerValue.
+ * @param hasSymbolStart YES if @a symbolStart is valid.
+ * @param symbolStart The start address of the symbol containing @a registerValue.
+ */
+- (id) initWithRegisterName: (NSString *) registerName
+              registerValue: (uint64_t) registerValue
+              hasImageIndex: (BOOL) hasImageIndex
+                 imageIndex: (NSUInteger) imageIndex
+             hasSymbolStart: (BOOL) hasSymbolStart
+                symbolStart: (uint64_t) symbolStart
+{
     if ((self = [super init]) == nil)
         return nil;
     
     _registerName = [registerName retain];
     _registerValue = registerValue;
+    _hasImageIndex = hasImageIndex;
+    _imageIndex = imageIndex;
+    _hasSymbolStart = hasSymbolStart;
+    _symbolStart = symbolStart;
     
     return self;
 }
@@ -54,5 +78,9 @@
 
 @synthesize registerName = _registerName;
 @synthesize registerValue = _registerValue;
+@synthesize hasImageIndex = _hasImageIndex;
+@synthesize imageIndex = _imageIndex;
+@synthesize hasSymbolStart = _hasSymbolStart;
+@synthesize symbolStart = _symbolStart;
 
 @end
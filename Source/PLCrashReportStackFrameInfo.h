@@ -29,6 +29,35 @@
 #import <Foundation/Foundation.h>
 #import "PLCrashReportSymbolInfo.h"
 
+/**
+ * @ingroup constants
+ *
+ * Indicates the method by which a stack frame was unwound.
+ *
+ * @internal
+ * These enum values match the protobuf values. Keep them synchronized.
+ */
+typedef enum {
+    /** Unknown. The frame was not walked (eg, an exception backtrace frame), or was written by an earlier version
+     * of the library. */
+    PLCrashReportUnwindMethodUnknown = 0,
+
+    /** The frame was derived from the thread's register state, rather than read from the stack. */
+    PLCrashReportUnwindMethodThreadState = 1,
+
+    /** Compact unwind information */
+    PLCrashReportUnwindMethodCompactUnwind = 2,
+
+    /** DWARF call frame information */
+    PLCrashReportUnwindMethodDWARF = 3,
+
+    /** Frame pointer walking */
+    PLCrashReportUnwindMethodFramePointer = 4,
+
+    /** Heuristic stack scanning */
+    PLCrashReportUnwindMethodStackScan = 5,
+} PLCrashReportUnwindMethod;
+
 @interface PLCrashReportStackFrameInfo : NSObject {
 @private
     /** Frame instruction pointer. */
@@ -36,10 +65,35 @@
 
     /** Symbol information, if available. Otherwise, will be nil. */
     PLCrashReportSymbolInfo *_symbolInfo;
+
+    /** The length of the repeated frame sequence ending at this frame, or 0. */
+    NSUInteger _repeatLength;
+
+    /** The number of additional repetitions of the sequence ending at this frame. */
+    NSUInteger _repeatCount;
+
+    /** The number of frames omitted following this frame. */
+    NSUInteger _omittedFrameCount;
+
+    /** The method by which the frame was unwound. */
+    PLCrashReportUnwindMethod _unwindMethod;
 }
 
 - (id) initWithInstructionPointer: (uint64_t) instructionPointer symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo;
 
+- (id) initWithInstructionPointer: (uint64_t) instructionPointer
+                       symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo
+                     repeatLength: (NSUInteger) repeatLength
+                      repeatCount: (NSUInteger) repeatCount
+                omittedFrameCount: (NSUInteger) omittedFrameCount;
+
+- (id) initWithInstructionPointer: (uint64_t) instructionPointer
+                       symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo
+                     repeatLength: (NSUInteger) repeatLength
+                      repeatCount: (NSUInteger) repeatCount
+                omittedFrameCount: (NSUInteger) omittedFrameCount
+                     unwindMethod: (PLCrashReportUnwindMethod) unwindMethod;
+
 /**
  * Frame's instruction pointer.
  */
@@ -49,4 +103,29 @@
  * This may be unavailable, and this property will be nil. */
 @property(nonatomic, readonly) PLCrashReportSymbolInfo *symbolInfo;
 
+/**
+ * If non-zero, this frame ends a sequence of repeatLength frames (including this frame) that repeats
+ * repeatCount additional times following this frame, such as the frames of an unbounded recursion. The repeated
+ * frames are not included in the thread's stack frames.
+ */
+@property(nonatomic, readonly) NSUInteger repeatLength;
+
+/**
+ * The number of additional times that the sequence ending at this frame repeats, or 0. See repeatLength.
+ */
+@property(nonatomic, readonly) NSUInteger repeatCount;
+
+/**
+ * The number of frames immediately following this frame that were walked, but not included in the thread's
+ * stack frames, as the stack exceeded the thread's frame limit. The following frames are the outermost frames of
+ * the stack.
+ */
+@property(nonatomic, readonly) NSUInteger omittedFrameCount;
+
+/**
+ * The method by which this frame was unwound at crash time, or PLCrashReportUnwindMethodUnknown if not recorded.
+ * Frames produced by the less precise frame pointer and stack scanning fallbacks may be inaccurate.
+ */
+@property(nonatomic, readonly) PLCrashReportUnwindMethod unwindMethod;
+
 @end
@@ -35,6 +35,10 @@
 
 @synthesize instructionPointer = _instructionPointer;
 @synthesize symbolInfo = _symbolInfo;
+@synthesize repeatLength = _repeatLength;
+@synthesize repeatCount = _repeatCount;
+@synthesize omittedFrameCount = _omittedFrameCount;
+@synthesize unwindMethod = _unwindMethod;
 
 /**
  * Initialize with the provided frame info.
@@ -43,11 +47,58 @@
  * @param symbolInfo Symbol information for this frame, if available. May be nil.
  */
 - (id) initWithInstructionPointer: (uint64_t) instructionPointer symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo {
+    return [self initWithInstructionPointer: instructionPointer symbolInfo: symbolInfo repeatLength: 0 repeatCount: 0 omittedFrameCount: 0];
+}
+
+/**
+ * Initialize with the provided frame info.
+ *
+ * @param instructionPointer The instruction pointer value for this frame.
+ * @param symbolInfo Symbol information for this frame, if available. May be nil.
+ * @param repeatLength The length of the repeated frame sequence ending at this frame, or 0.
+ * @param repeatCount The number of additional times the sequence ending at this frame repeats, or 0.
+ * @param omittedFrameCount The number of frames omitted following this frame, or 0.
+ */
+- (id) initWithInstructionPointer: (uint64_t) instructionPointer
+                       symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo
+                     repeatLength: (NSUInteger) repeatLength
+                      repeatCount: (NSUInteger) repeatCount
+                omittedFrameCount: (NSUInteger) omittedFrameCount
+{
+    return [self initWithInstructionPointer: instructionPointer
+                                 symbolInfo: symbolInfo
+                               repeatLength: repeatLength
+                                repeatCount: repeatCount
+                          omittedFrameCount: omittedFrameCount
+                               unwindMethod: PLCrashReportUnwindMethodUnknown];
+}
+
+/**
+ * Initialize with the provided frame info.
+ *
+ * @param instructionPointer The instruction pointer value for this frame.
+ * @param symbolInfo Symbol information for this frame, if available. May be nil.
+ * @param repeatLength The length of the repeated frame sequence ending at this frame, or 0.
+ * @param repeatCount The number of additional times the sequence ending at this frame repeats, or 0.
+ * @param omittedFrameCount The number of frames omitted following this frame, or 0.
+ * @param unwindMethod The method by which the frame was unwound.
+ */
+- (id) initWithInstructionPointer: (uint64_t) instructionPointer
+                       symbolInfo: (PLCrashReportSymbolInfo *) symbolInfo
+                     repeatLength: (NSUInteger) repeatLength
+                      repeatCount: (NSUInteger) repeatCount
+                omittedFrameCount: (NSUInteger) omittedFrameCount
+                     unwindMethod: (PLCrashReportUnwindMethod) unwindMethod
+{
     if ((self = [super init]) == nil)
         return nil;
     
     _instructionPointer = instructionPointer;
     _symbolInfo = [symbolInfo retain];
+    _repeatLength = repeatLength;
+    _repeatCount = repeatCount;
+    _omittedFrameCount = omittedFrameCount;
+    _unwindMethod = unwindMethod;
     
     return self;
 }
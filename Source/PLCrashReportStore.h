@@ -0,0 +1,91 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+#import <pthread.h>
+
+#import "PLCrashAsyncReportIndex.h"
+
+@interface PLCrashReportStore : NSObject {
+@private
+    /** The store directory. */
+    NSString *_directory;
+
+    /** The index file name, relative to @a _directory. */
+    NSString *_indexName;
+
+    /** The maximum number of reports, or 0 for no limit. */
+    NSUInteger _maximumCount;
+
+    /** The maximum total report size, in bytes, or 0 for no limit. */
+    NSUInteger _maximumBytes;
+
+    /** The maximum report age, in seconds, or 0 for no limit. */
+    NSTimeInterval _maximumAge;
+
+    /** The store index. */
+    plcrash_async_report_index_t _index;
+
+    /** Serializes all access to the store. */
+    pthread_mutex_t _lock;
+
+    /** The stored reports, oldest first. Each entry is an array containing the report's file name, NSNumber size,
+     * and NSNumber write time. Valid only while @a _loaded is YES and the index is in sync. */
+    NSMutableArray *_reports;
+
+    /** The total size of @a _reports, in bytes. */
+    unsigned long long _totalBytes;
+
+    /** The number of records in the index. */
+    size_t _recordCount;
+
+    /** YES if @a _reports has been loaded. */
+    BOOL _loaded;
+
+    /** The number of reports evicted by the capacity policy. */
+    uint64_t _evictionCount;
+}
+
+- (id) initWithDirectory: (NSString *) directory
+               indexName: (NSString *) indexName
+            maximumCount: (NSUInteger) maximumCount
+            maximumBytes: (NSUInteger) maximumBytes
+              maximumAge: (NSTimeInterval) maximumAge
+                   error: (NSError **) outError;
+
+- (BOOL) writeReportData: (NSData *) data error: (NSError **) outError;
+- (BOOL) moveReportAtPath: (NSString *) path error: (NSError **) outError;
+- (BOOL) removeReportAtPath: (NSString *) path error: (NSError **) outError;
+
+- (NSArray *) reportPaths;
+
+/** The number of reports evicted by the capacity policy. */
+@property(nonatomic, readonly) uint64_t evictionCount;
+
+@end
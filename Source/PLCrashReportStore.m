@@ -0,0 +1,395 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportStore.h"
+#import "PLCrashReporterNSError.h"
+#import "PLCrashAsync.h"
+
+/**
+ * @internal
+ *
+ * The number of stale index records that may accumulate, beyond twice the number of stored reports, before the
+ * index is compacted.
+ */
+#define PLCRASH_REPORT_STORE_COMPACTION_SLACK 64
+
+/**
+ * @internal
+ *
+ * A directory of reports bounded by a capacity policy.
+ *
+ * The capacity policy limits the number of stored reports, their total size, and their age. Reports are stored
+ * oldest first, and the policy is enforced as each report is added, by evicting the oldest reports; as reports are
+ * added in approximately chronological order, adding a report requires a constant number of directory operations
+ * and index appends, regardless of the number of stored reports. The store is described by a pending report index
+ * (see PLCrashAsyncReportIndex.h), and the directory is only scanned if it has been modified by other means -- for
+ * example, by an EXC_RESOURCE report written at crash time.
+ *
+ * All methods are thread-safe.
+ */
+@implementation PLCrashReportStore
+
+@synthesize evictionCount = _evictionCount;
+
+/**
+ * Initialize a new store.
+ *
+ * @param directory The store directory. The directory must exist.
+ * @param indexName The name of the store index, within @a directory.
+ * @param maximumCount The maximum number of stored reports, or 0 for no limit.
+ * @param maximumBytes The maximum total size of the stored reports, in bytes, or 0 for no limit.
+ * @param maximumAge The maximum age of a stored report, in seconds, or 0 for no limit.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the store could not be opened.
+ *
+ * @return Returns the initialized store, or nil if the store index could not be opened.
+ */
+- (id) initWithDirectory: (NSString *) directory
+               indexName: (NSString *) indexName
+            maximumCount: (NSUInteger) maximumCount
+            maximumBytes: (NSUInteger) maximumBytes
+              maximumAge: (NSTimeInterval) maximumAge
+                   error: (NSError **) outError
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _directory = [directory copy];
+    _indexName = [indexName copy];
+    _maximumCount = maximumCount;
+    _maximumBytes = maximumBytes;
+    _maximumAge = maximumAge;
+    _reports = [[NSMutableArray alloc] init];
+    pthread_mutex_init(&_lock, NULL);
+
+    _index.fd = -1;
+    NSString *path = [directory stringByAppendingPathComponent: indexName];
+    if (plcrash_nasync_report_index_open(&_index, [directory fileSystemRepresentation], [path fileSystemRepresentation]) != PLCRASH_ESUCCESS) {
+        _index.fd = -1;
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not open the report store index", nil);
+        [self release];
+        return nil;
+    }
+
+    return self;
+}
+
+- (void) dealloc {
+    if (_index.fd >= 0)
+        plcrash_nasync_report_index_close(&_index);
+    pthread_mutex_destroy(&_lock);
+
+    [_directory release];
+    [_indexName release];
+    [_reports release];
+
+    [super dealloc];
+}
+
+/**
+ * Append a record to the store index. Must be called with @a _lock held.
+ */
+- (void) appendRecord: (plcrash_async_report_index_state_t) state name: (NSString *) name size: (uint64_t) size timestamp: (int64_t) timestamp synced: (bool) synced {
+    plcrash_async_report_index_append(&_index, state, [name fileSystemRepresentation], size, timestamp, synced);
+    _recordCount++;
+}
+
+/**
+ * Insert a report into @a _reports, maintaining the oldest-first order. Reports are generally added in
+ * chronological order, and are inserted at (or near) the end of the list. Must be called with @a _lock held.
+ */
+- (void) insertReport: (NSString *) name size: (uint64_t) size timestamp: (int64_t) timestamp {
+    NSUInteger i = [_reports count];
+    while (i > 0 && [[[_reports objectAtIndex: i - 1] objectAtIndex: 2] longLongValue] > timestamp)
+        i--;
+
+    [_reports insertObject: [NSArray arrayWithObjects: name, [NSNumber numberWithUnsignedLongLong: size], [NSNumber numberWithLongLong: timestamp], nil] atIndex: i];
+    _totalBytes += size;
+}
+
+/**
+ * Evict the oldest reports, until the store satisfies its capacity policy, and compact the index if the majority of
+ * its records describe reports that are no longer stored. Must be called with @a _lock held.
+ */
+- (void) enforceCapacity {
+    int64_t now = time(NULL);
+
+    while ([_reports count] > 0) {
+        NSArray *oldest = [_reports objectAtIndex: 0];
+        BOOL evict = NO;
+
+        /* The most recent report is retained regardless of its size */
+        if (_maximumCount != 0 && [_reports count] > _maximumCount)
+            evict = YES;
+        else if (_maximumBytes != 0 && [_reports count] > 1 && _totalBytes > _maximumBytes)
+            evict = YES;
+        else if (_maximumAge != 0 && now - [[oldest objectAtIndex: 2] longLongValue] > _maximumAge)
+            evict = YES;
+
+        if (!evict)
+            break;
+
+        NSString *name = [oldest objectAtIndex: 0];
+        NSError *error;
+        bool synced = plcrash_async_report_index_synced(&_index);
+        if (![[NSFileManager defaultManager] removeItemAtPath: [_directory stringByAppendingPathComponent: name] error: &error])
+            NSLog(@"Could not evict stored report %@: %@", name, error);
+
+        [self appendRecord: PLCRASH_ASYNC_REPORT_INDEX_PURGED name: name size: 0 timestamp: 0 synced: synced];
+        _totalBytes -= [[oldest objectAtIndex: 1] unsignedLongLongValue];
+        _evictionCount++;
+        [_reports removeObjectAtIndex: 0];
+    }
+
+    /* Compact the index */
+    plcrash_async_report_index_stamp_t stamp;
+    size_t count = [_reports count];
+    if (_recordCount > (2 * count) + PLCRASH_REPORT_STORE_COMPACTION_SLACK && plcrash_async_report_index_synced(&_index) &&
+        plcrash_async_report_index_stamp(&_index, &stamp) == PLCRASH_ESUCCESS)
+    {
+        plcrash_async_report_index_entry_t *entries = calloc(count + 1, sizeof(*entries));
+        if (entries == NULL)
+            return;
+
+        for (size_t i = 0; i < count; i++) {
+            NSArray *report = [_reports objectAtIndex: i];
+            strlcpy(entries[i].name, [[report objectAtIndex: 0] fileSystemRepresentation], sizeof(entries[i].name));
+            entries[i].state = PLCRASH_ASYNC_REPORT_INDEX_WRITTEN;
+            entries[i].size = [[report objectAtIndex: 1] unsignedLongLongValue];
+            entries[i].timestamp = [[report objectAtIndex: 2] longLongValue];
+        }
+
+        if (plcrash_nasync_report_index_rewrite(&_index, entries, count, &stamp) == PLCRASH_ESUCCESS)
+            _recordCount = count + 1;
+
+        free(entries);
+    }
+}
+
+/**
+ * Load the stored reports from the index, if they have not been loaded, or the directory has been modified by
+ * other means since they were loaded. If the index is stale, the directory is scanned, and the index rebuilt. Must be
+ * called with @a _lock held.
+ */
+- (void) loadReports {
+    if (_loaded && plcrash_async_report_index_synced(&_index))
+        return;
+
+    [_reports removeAllObjects];
+    _totalBytes = 0;
+    _loaded = YES;
+
+    /* Try the index; entries are returned newest first */
+    plcrash_async_report_index_entry_t *entries;
+    size_t count;
+    if (plcrash_nasync_report_index_read(&_index, &entries, &count, &_recordCount) == PLCRASH_ESUCCESS) {
+        for (size_t i = count; i > 0; i--) {
+            plcrash_async_report_index_entry_t *entry = &entries[i - 1];
+            NSString *name = [[NSFileManager defaultManager] stringWithFileSystemRepresentation: entry->name length: strlen(entry->name)];
+            [self insertReport: name size: entry->size timestamp: entry->timestamp];
+        }
+
+        free(entries);
+        [self enforceCapacity];
+        return;
+    }
+
+    /* Scan the directory. The directory's modification time is fetched prior to the scan, such that a change made
+     * during the scan leaves the rebuilt index stale. */
+    plcrash_async_report_index_stamp_t stamp;
+    bool stamped = plcrash_async_report_index_stamp(&_index, &stamp) == PLCRASH_ESUCCESS;
+
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSArray *files = [fm contentsOfDirectoryAtPath: _directory error: NULL];
+    for (NSString *name in files) {
+        if ([name isEqualToString: _indexName])
+            continue;
+
+        NSDictionary *attributes = [fm attributesOfItemAtPath: [_directory stringByAppendingPathComponent: name] error: NULL];
+        if (attributes == nil || ![[attributes fileType] isEqualToString: NSFileTypeRegular])
+            continue;
+
+        [self insertReport: name size: [attributes fileSize] timestamp: (int64_t) [[attributes fileModificationDate] timeIntervalSince1970]];
+    }
+
+    /* Rebuild the index, if every report can be named in the index */
+    count = [_reports count];
+    entries = stamped ? calloc(count + 1, sizeof(*entries)) : NULL;
+    for (size_t i = 0; entries != NULL && i < count; i++) {
+        NSArray *report = [_reports objectAtIndex: i];
+        if (strlcpy(entries[i].name, [[report objectAtIndex: 0] fileSystemRepresentation], sizeof(entries[i].name)) >= sizeof(entries[i].name)) {
+            free(entries);
+            entries = NULL;
+            break;
+        }
+        entries[i].state = PLCRASH_ASYNC_REPORT_INDEX_WRITTEN;
+        entries[i].size = [[report objectAtIndex: 1] unsignedLongLongValue];
+        entries[i].timestamp = [[report objectAtIndex: 2] longLongValue];
+    }
+
+    if (entries != NULL) {
+        if (plcrash_nasync_report_index_rewrite(&_index, entries, count, &stamp) == PLCRASH_ESUCCESS)
+            _recordCount = count + 1;
+        free(entries);
+    }
+
+    [self enforceCapacity];
+}
+
+/**
+ * Return a new, unique report file name.
+ */
+- (NSString *) uniqueReportName {
+    CFUUIDRef uuid = CFUUIDCreate(NULL);
+    NSString *name = [(NSString *) CFUUIDCreateString(NULL, uuid) autorelease];
+    CFRelease(uuid);
+
+    return [name stringByAppendingPathExtension: @"plcrash"];
+}
+
+/**
+ * Write @a data to the store as a new report, evicting the oldest reports as required by the capacity policy.
+ *
+ * @param data The report data.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be written.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) writeReportData: (NSData *) data error: (NSError **) outError {
+    NSString *name = [self uniqueReportName];
+    BOOL result;
+
+    pthread_mutex_lock(&_lock); {
+        [self loadReports];
+
+        bool synced = plcrash_async_report_index_synced(&_index);
+        result = [data writeToFile: [_directory stringByAppendingPathComponent: name] options: NSDataWritingAtomic error: outError];
+        if (result) {
+            int64_t timestamp = time(NULL);
+            [self appendRecord: PLCRASH_ASYNC_REPORT_INDEX_WRITTEN name: name size: [data length] timestamp: timestamp synced: synced];
+            [self insertReport: name size: [data length] timestamp: timestamp];
+            [self enforceCapacity];
+        }
+    } pthread_mutex_unlock(&_lock);
+
+    return result;
+}
+
+/**
+ * Move the report at @a path into the store, evicting the oldest reports as required by the capacity policy. The
+ * report is assigned a unique name; its modification date, and thus its position in the store, is preserved.
+ *
+ * @param path The report to be moved.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be moved.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) moveReportAtPath: (NSString *) path error: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSString *name = [self uniqueReportName];
+    BOOL result;
+
+    NSDictionary *attributes = [fm attributesOfItemAtPath: path error: outError];
+    if (attributes == nil)
+        return NO;
+
+    uint64_t size = [attributes fileSize];
+    int64_t timestamp = (int64_t) [[attributes fileModificationDate] timeIntervalSince1970];
+
+    pthread_mutex_lock(&_lock); {
+        [self loadReports];
+
+        bool synced = plcrash_async_report_index_synced(&_index);
+        result = [fm moveItemAtPath: path toPath: [_directory stringByAppendingPathComponent: name] error: outError];
+        if (result) {
+            [self appendRecord: PLCRASH_ASYNC_REPORT_INDEX_WRITTEN name: name size: size timestamp: timestamp synced: synced];
+            [self insertReport: name size: size timestamp: timestamp];
+            [self enforceCapacity];
+        }
+    } pthread_mutex_unlock(&_lock);
+
+    return result;
+}
+
+/**
+ * Remove the stored report at @a path; for example, once it has been uploaded.
+ *
+ * @param path The path of the report, as returned by reportPaths.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be removed.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) removeReportAtPath: (NSString *) path error: (NSError **) outError {
+    NSString *name = [path lastPathComponent];
+    BOOL result;
+
+    pthread_mutex_lock(&_lock); {
+        [self loadReports];
+
+        bool synced = plcrash_async_report_index_synced(&_index);
+        result = [[NSFileManager defaultManager] removeItemAtPath: path error: outError];
+        if (result) {
+            [self appendRecord: PLCRASH_ASYNC_REPORT_INDEX_UPLOADED name: name size: 0 timestamp: 0 synced: synced];
+
+            /* Reports are generally removed oldest first */
+            for (NSUInteger i = 0; i < [_reports count]; i++) {
+                NSArray *report = [_reports objectAtIndex: i];
+                if ([[report objectAtIndex: 0] isEqualToString: name]) {
+                    _totalBytes -= [[report objectAtIndex: 1] unsignedLongLongValue];
+                    [_reports removeObjectAtIndex: i];
+                    break;
+                }
+            }
+        }
+    } pthread_mutex_unlock(&_lock);
+
+    return result;
+}
+
+/**
+ * Return the paths of the stored reports, oldest first. Reports that have exceeded the maximum age are evicted.
+ */
+- (NSArray *) reportPaths {
+    NSMutableArray *paths;
+
+    pthread_mutex_lock(&_lock); {
+        [self loadReports];
+        [self enforceCapacity];
+
+        paths = [NSMutableArray arrayWithCapacity: [_reports count]];
+        for (NSArray *report in _reports)
+            [paths addObject: [_directory stringByAppendingPathComponent: [report objectAtIndex: 0]]];
+    } pthread_mutex_unlock(&_lock);
+
+    return paths;
+}
+
+@end
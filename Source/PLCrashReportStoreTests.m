@@ -0,0 +1,151 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "GTMSenTestCase.h"
+#import "PLCrashReportStore.h"
+
+@interface PLCrashReportStoreTests : SenTestCase {
+@private
+    /** Store directory */
+    NSString *_directory;
+}
+@end
+
+@implementation PLCrashReportStoreTests
+
+- (void) setUp {
+    _directory = [[NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    STAssertTrue([[NSFileManager defaultManager] createDirectoryAtPath: _directory withIntermediateDirectories: YES attributes: nil error: NULL], @"Could not create directory");
+}
+
+- (void) tearDown {
+    [[NSFileManager defaultManager] removeItemAtPath: _directory error: NULL];
+    [_directory release];
+}
+
+/* Open a store in _directory with the given capacity */
+- (PLCrashReportStore *) storeWithCount: (NSUInteger) count bytes: (NSUInteger) bytes age: (NSTimeInterval) age {
+    NSError *error;
+    PLCrashReportStore *store = [[[PLCrashReportStore alloc] initWithDirectory: _directory indexName: @"index" maximumCount: count maximumBytes: bytes maximumAge: age error: &error] autorelease];
+    STAssertNotNil(store, @"Failed to open store: %@", error);
+    return store;
+}
+
+/* Return the contents of the given stored reports */
+- (NSArray *) contentsOfReports: (NSArray *) paths {
+    NSMutableArray *contents = [NSMutableArray array];
+    for (NSString *path in paths)
+        [contents addObject: [NSString stringWithContentsOfFile: path encoding: NSUTF8StringEncoding error: NULL]];
+    return contents;
+}
+
+/**
+ * Verify that the oldest reports are evicted once the maximum report count is reached.
+ */
+- (void) testCountLimit {
+    PLCrashReportStore *store = [self storeWithCount: 2 bytes: 0 age: 0];
+    NSError *error;
+
+    for (int i = 0; i < 4; i++) {
+        NSData *data = [[NSString stringWithFormat: @"%d", i] dataUsingEncoding: NSUTF8StringEncoding];
+        STAssertTrue([store writeReportData: data error: &error], @"Failed to write report: %@", error);
+    }
+
+    NSArray *expected = [NSArray arrayWithObjects: @"2", @"3", nil];
+    STAssertEqualObjects([self contentsOfReports: [store reportPaths]], expected, @"Incorrect reports retained");
+    STAssertEquals([store evictionCount], (uint64_t) 2, @"Incorrect eviction count");
+
+    /* The evicted reports are removed from disk, and a new store instance sees the same reports */
+    NSArray *files = [[[NSFileManager defaultManager] contentsOfDirectoryAtPath: _directory error: NULL] pathsMatchingExtensions: [NSArray arrayWithObject: @"plcrash"]];
+    STAssertEquals([files count], (NSUInteger) 2, @"Evicted reports were not deleted");
+    STAssertEqualObjects([self contentsOfReports: [[self storeWithCount: 2 bytes: 0 age: 0] reportPaths]], expected, @"Incorrect reports loaded");
+}
+
+/**
+ * Verify that the oldest reports are evicted once the maximum total size is exceeded, and that the most recent
+ * report is always retained.
+ */
+- (void) testByteLimit {
+    PLCrashReportStore *store = [self storeWithCount: 0 bytes: 8 age: 0];
+    NSError *error;
+
+    STAssertTrue([store writeReportData: [@"aaaa" dataUsingEncoding: NSUTF8StringEncoding] error: &error], @"Failed to write report: %@", error);
+    STAssertTrue([store writeReportData: [@"bbbb" dataUsingEncoding: NSUTF8StringEncoding] error: &error], @"Failed to write report: %@", error);
+    STAssertEquals([[store reportPaths] count], (NSUInteger) 2, @"Reports within the limit should be retained");
+
+    STAssertTrue([store writeReportData: [@"cccccccccccc" dataUsingEncoding: NSUTF8StringEncoding] error: &error], @"Failed to write report: %@", error);
+    NSArray *expected = [NSArray arrayWithObject: @"cccccccccccc"];
+    STAssertEqualObjects([self contentsOfReports: [store reportPaths]], expected, @"Incorrect reports retained");
+}
+
+/**
+ * Verify that moved reports retain their modification date, and are evicted once they exceed the maximum age.
+ */
+- (void) testAgeLimit {
+    PLCrashReportStore *store = [self storeWithCount: 0 bytes: 0 age: 60];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSError *error;
+
+    NSString *source = [NSTemporaryDirectory() stringByAppendingPathComponent: [[NSProcessInfo processInfo] globallyUniqueString]];
+    STAssertTrue([@"old" writeToFile: source atomically: NO encoding: NSUTF8StringEncoding error: &error], @"Could not write report: %@", error);
+    NSDictionary *attributes = [NSDictionary dictionaryWithObject: [NSDate dateWithTimeIntervalSinceNow: -3600] forKey: NSFileModificationDate];
+    STAssertTrue([fm setAttributes: attributes ofItemAtPath: source error: &error], @"Could not set date: %@", error);
+
+    STAssertTrue([store writeReportData: [@"new" dataUsingEncoding: NSUTF8StringEncoding] error: &error], @"Failed to write report: %@", error);
+    STAssertTrue([store moveReportAtPath: source error: &error], @"Failed to move report: %@", error);
+    STAssertFalse([fm fileExistsAtPath: source], @"Report was not moved");
+
+    NSArray *expected = [NSArray arrayWithObject: @"new"];
+    STAssertEqualObjects([self contentsOfReports: [store reportPaths]], expected, @"Expired report was not evicted");
+}
+
+/**
+ * Verify that reports added to, and removed from, the directory by other means are found.
+ */
+- (void) testExternalModification {
+    PLCrashReportStore *store = [self storeWithCount: 0 bytes: 0 age: 0];
+    NSError *error;
+
+    STAssertTrue([store writeReportData: [@"a" dataUsingEncoding: NSUTF8StringEncoding] error: &error], @"Failed to write report: %@", error);
+    STAssertEquals([[store reportPaths] count], (NSUInteger) 1, @"Incorrect report count");
+
+    /* Sleep to ensure that the directory's modification time changes even on coarse-grained file systems */
+    sleep(1);
+    NSString *external = [_directory stringByAppendingPathComponent: @"external.plcrash"];
+    STAssertTrue([@"b" writeToFile: external atomically: NO encoding: NSUTF8StringEncoding error: &error], @"Could not write report: %@", error);
+
+    NSArray *expected = [NSArray arrayWithObjects: @"a", @"b", nil];
+    NSArray *paths = [store reportPaths];
+    STAssertEqualObjects([self contentsOfReports: paths], expected, @"External report was not found");
+
+    /* Remove (upload) the reports */
+    for (NSString *path in paths)
+        STAssertTrue([store removeReportAtPath: path error: &error], @"Failed to remove report: %@", error);
+    STAssertEquals([[store reportPaths] count], (NSUInteger) 0, @"Reports were not removed");
+}
+
+@end
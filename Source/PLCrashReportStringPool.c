@@ -0,0 +1,222 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashReportStringPool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_report_string_pool
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A pool chunk. The chunk's string data immediately follows the chunk header.
+ */
+struct plcrash_report_string_pool_chunk {
+    /** The next (previously exhausted) chunk, or NULL. */
+    struct plcrash_report_string_pool_chunk *next;
+
+    /** Size of the chunk's string data. */
+    size_t size;
+
+    /** Number of bytes allocated from this chunk. */
+    size_t used;
+
+    /** The chunk's string data. */
+    char data[];
+};
+
+/**
+ * @internal
+ *
+ * A string pool.
+ */
+struct plcrash_report_string_pool {
+    /** The contents deallocator of all strings created from the pool. The pool is freed when this allocator is
+     * deallocated; see string_pool_allocator_release(). */
+    CFAllocatorRef allocator;
+
+    /** The current chunk, followed by any previously exhausted chunks, or NULL if no strings have been copied. */
+    struct plcrash_report_string_pool_chunk *chunks;
+};
+
+/* CFAllocator deallocate() implementation. String contents are owned by the pool, and are freed with it. */
+static void string_pool_allocator_deallocate (void *ptr, void *info) {
+    // no-op
+}
+
+/* CFAllocator allocate() implementation. The allocator is only used as a contents deallocator, and never
+ * allocates. */
+static void *string_pool_allocator_allocate (CFIndex size, CFOptionFlags hint, void *info) {
+    return NULL;
+}
+
+/* CFAllocator context release() implementation; called once, when the allocator itself is deallocated. */
+static void string_pool_allocator_release (const void *info) {
+    plcrash_report_string_pool_t *pool = (plcrash_report_string_pool_t *) info;
+    struct plcrash_report_string_pool_chunk *chunk = pool->chunks;
+
+    while (chunk != NULL) {
+        struct plcrash_report_string_pool_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    free(pool);
+}
+
+/**
+ * @} plcrash_report_string_pool
+ */
+
+/**
+ * @internal
+ *
+ * Allocate a new, empty string pool. Returns NULL on failure. The pool must be released with
+ * plcrash_report_string_pool_release().
+ */
+plcrash_report_string_pool_t *plcrash_report_string_pool_new (void) {
+    plcrash_report_string_pool_t *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL)
+        return NULL;
+
+    /* The allocator does not retain the pool; the pool is instead freed when the allocator is deallocated, which
+     * occurs only once the owner and all created strings have released it. */
+    CFAllocatorContext context = {
+        .version = 0,
+        .info = pool,
+        .retain = NULL,
+        .release = string_pool_allocator_release,
+        .copyDescription = NULL,
+        .allocate = string_pool_allocator_allocate,
+        .reallocate = NULL,
+        .deallocate = string_pool_allocator_deallocate,
+        .preferredSize = NULL
+    };
+
+    pool->allocator = CFAllocatorCreate(kCFAllocatorDefault, &context);
+    if (pool->allocator == NULL) {
+        free(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+/**
+ * @internal
+ *
+ * Copy the @a length bytes at @a bytes into @a pool, appending a NUL terminator. The copy remains valid until
+ * the pool is freed.
+ *
+ * @param pool The pool into which the string will be copied.
+ * @param bytes The string's UTF-8 bytes; need not be NUL-terminated.
+ * @param length The length of @a bytes.
+ *
+ * @return Returns the pool-resident NUL-terminated copy, or NULL if allocation fails.
+ */
+char *plcrash_report_string_pool_copy (plcrash_report_string_pool_t *pool, const uint8_t *bytes, size_t length) {
+    struct plcrash_report_string_pool_chunk *chunk = pool->chunks;
+    size_t size = length + 1;
+    char *str;
+
+    /* Strings are packed without alignment. Start a new chunk if the current chunk is exhausted; chunk sizes are
+     * doubled to bound the number of chunks searched by plcrash_report_string_pool_contains(). */
+    if (chunk == NULL || chunk->size - chunk->used < size) {
+        size_t chunk_size = (chunk == NULL) ? PLCRASH_REPORT_STRING_POOL_MIN_CHUNK_SIZE : chunk->size * 2;
+        if (chunk_size < size)
+            chunk_size = size;
+
+        struct plcrash_report_string_pool_chunk *next = malloc(sizeof(*next) + chunk_size);
+        if (next == NULL)
+            return NULL;
+
+        next->next = chunk;
+        next->size = chunk_size;
+        next->used = 0;
+        pool->chunks = chunk = next;
+    }
+
+    str = chunk->data + chunk->used;
+    chunk->used += size;
+
+    memcpy(str, bytes, length);
+    str[length] = '\0';
+    return str;
+}
+
+/**
+ * @internal
+ *
+ * Return true if @a string was allocated from @a pool by plcrash_report_string_pool_copy().
+ */
+bool plcrash_report_string_pool_contains (plcrash_report_string_pool_t *pool, const char *string) {
+    for (struct plcrash_report_string_pool_chunk *chunk = pool->chunks; chunk != NULL; chunk = chunk->next) {
+        if (string >= chunk->data && string < chunk->data + chunk->used)
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @internal
+ *
+ * Create a CFString for the NUL-terminated UTF-8 @a string. If @a string was allocated from @a pool, the returned
+ * string references the pool-resident bytes directly, and keeps the pool's storage alive until it is deallocated;
+ * otherwise, the string's contents are copied.
+ *
+ * @param pool The string pool.
+ * @param string A NUL-terminated UTF-8 string.
+ *
+ * @return Returns a new CFString, which must be released by the caller, or NULL if @a string is not valid UTF-8.
+ */
+CFStringRef plcrash_report_string_pool_create_string (plcrash_report_string_pool_t *pool, const char *string) {
+    if (!plcrash_report_string_pool_contains(pool, string))
+        return CFStringCreateWithCString(kCFAllocatorDefault, string, kCFStringEncodingUTF8);
+
+    /* If CFString must convert the contents to its internal representation (eg, for non-ASCII strings), the
+     * original bytes are immediately handed to our no-op deallocator. */
+    return CFStringCreateWithBytesNoCopy(kCFAllocatorDefault, (const UInt8 *) string, (CFIndex) strlen(string), kCFStringEncodingUTF8,
+                                         false, pool->allocator);
+}
+
+/**
+ * @internal
+ *
+ * Release the owner's reference to @a pool. No further strings may be copied into or created from the pool; the
+ * pool's storage is freed once all strings created from it have been deallocated.
+ */
+void plcrash_report_string_pool_release (plcrash_report_string_pool_t *pool) {
+    CFRelease(pool->allocator);
+}
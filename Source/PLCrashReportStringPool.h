@@ -0,0 +1,85 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_REPORT_STRING_POOL_H
+#define PLCRASH_REPORT_STRING_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <CoreFoundation/CoreFoundation.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_report_string_pool Crash Report String Pool
+ *
+ * Implements a bump-allocated pool of NUL-terminated UTF-8 strings, from which CFString instances may be created
+ * without copying the string's contents. Strings created from the pool reference the pool's storage directly,
+ * and the pool is only freed once its owner has released it and all strings created from it have been deallocated.
+ *
+ * Decoded report strings that are numerous -- binary image and symbol names -- are copied once, from the encoded
+ * report into the pool, and the PLCrashReport objects then share that single copy.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * The minimum pool chunk size.
+ */
+#define PLCRASH_REPORT_STRING_POOL_MIN_CHUNK_SIZE (4 * 1024)
+
+/**
+ * @internal
+ *
+ * An opaque string pool.
+ */
+typedef struct plcrash_report_string_pool plcrash_report_string_pool_t;
+
+plcrash_report_string_pool_t *plcrash_report_string_pool_new (void);
+char *plcrash_report_string_pool_copy (plcrash_report_string_pool_t *pool, const uint8_t *bytes, size_t length);
+bool plcrash_report_string_pool_contains (plcrash_report_string_pool_t *pool, const char *string);
+CFStringRef plcrash_report_string_pool_create_string (plcrash_report_string_pool_t *pool, const char *string);
+void plcrash_report_string_pool_release (plcrash_report_string_pool_t *pool);
+
+/**
+ * @} plcrash_report_string_pool
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_REPORT_STRING_POOL_H */
@@ -0,0 +1,110 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashReportStringPool.h"
+
+@interface PLCrashReportStringPoolTests : SenTestCase {
+@private
+}
+
+@end
+
+@implementation PLCrashReportStringPoolTests
+
+/**
+ * Test copying strings into the pool, including growth beyond the initial chunk.
+ */
+- (void) testCopy {
+    plcrash_report_string_pool_t *pool = plcrash_report_string_pool_new();
+    STAssertNotNULL(pool, @"Failed to allocate pool");
+
+    /* Not NUL-terminated */
+    const uint8_t bytes[] = { 'a', 'b', 'c', 'd' };
+    char *first = plcrash_report_string_pool_copy(pool, bytes, 3);
+    STAssertNotNULL(first, @"Copy failed");
+    STAssertEqualCStrings(first, "abc", @"Incorrect copy");
+
+    /* Exceed the initial chunk */
+    NSMutableData *large = [NSMutableData dataWithLength: PLCRASH_REPORT_STRING_POOL_MIN_CHUNK_SIZE * 2];
+    memset([large mutableBytes], 'x', [large length]);
+    char *second = plcrash_report_string_pool_copy(pool, [large bytes], [large length]);
+    STAssertNotNULL(second, @"Copy failed");
+    STAssertEquals(strlen(second), [large length], @"Incorrect copy length");
+
+    STAssertTrue(plcrash_report_string_pool_contains(pool, first), @"String not found in initial chunk");
+    STAssertTrue(plcrash_report_string_pool_contains(pool, second), @"String not found in grown chunk");
+    STAssertFalse(plcrash_report_string_pool_contains(pool, "abc"), @"Foreign string reported as pool-resident");
+
+    plcrash_report_string_pool_release(pool);
+}
+
+/**
+ * Test that strings created from the pool remain valid after the owner releases the pool.
+ */
+- (void) testCreateString {
+    plcrash_report_string_pool_t *pool = plcrash_report_string_pool_new();
+    const char *utf8 = "/System/Library/Frameworks/Foundation.framework/Foundation";
+    const char *nonASCII = "caf\xc3\xa9";
+
+    char *copy = plcrash_report_string_pool_copy(pool, (const uint8_t *) utf8, strlen(utf8));
+    char *nonASCIICopy = plcrash_report_string_pool_copy(pool, (const uint8_t *) nonASCII, strlen(nonASCII));
+
+    NSString *bridged = (NSString *) plcrash_report_string_pool_create_string(pool, copy);
+    NSString *converted = (NSString *) plcrash_report_string_pool_create_string(pool, nonASCIICopy);
+    NSString *foreign = (NSString *) plcrash_report_string_pool_create_string(pool, utf8);
+    STAssertNotNil(bridged, @"Failed to create pool string");
+    STAssertNotNil(converted, @"Failed to create non-ASCII pool string");
+    STAssertNotNil(foreign, @"Failed to create non-pool string");
+
+    /* The pool's storage must outlive the owner's reference */
+    plcrash_report_string_pool_release(pool);
+
+    STAssertEqualStrings(bridged, @"/System/Library/Frameworks/Foundation.framework/Foundation", @"Incorrect pool string");
+    STAssertEqualStrings(converted, @"caf\u00e9", @"Incorrect non-ASCII pool string");
+    STAssertEqualStrings(foreign, bridged, @"Incorrect non-pool string");
+
+    [bridged release];
+    [converted release];
+    [foreign release];
+}
+
+/**
+ * Test that invalid UTF-8 is rejected.
+ */
+- (void) testInvalidUTF8 {
+    plcrash_report_string_pool_t *pool = plcrash_report_string_pool_new();
+    const uint8_t invalid[] = { 0xC3, 0x28 };
+
+    char *copy = plcrash_report_string_pool_copy(pool, invalid, sizeof(invalid));
+    STAssertNULL(plcrash_report_string_pool_create_string(pool, copy), @"Created a string from invalid UTF-8");
+
+    plcrash_report_string_pool_release(pool);
+}
+
+@end
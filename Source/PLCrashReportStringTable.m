@@ -0,0 +1,151 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashReportStringTable.h"
+
+#import <string.h>
+#import <stdlib.h>
+
+/* FNV-1a 32-bit parameters */
+#define FNV_OFFSET_BASIS 0x811c9dc5U
+#define FNV_PRIME 0x01000193U
+
+/* CFDictionary key callbacks for NUL-terminated C string keys. Keys are copied on insertion, allowing lookups to
+ * be performed directly against the decoded protobuf strings, without allocating. */
+static const void *pl_cstring_retain (CFAllocatorRef allocator, const void *value) {
+    return strdup(value);
+}
+
+static void pl_cstring_release (CFAllocatorRef allocator, const void *value) {
+    free((void *) value);
+}
+
+static Boolean pl_cstring_equal (const void *value1, const void *value2) {
+    return strcmp(value1, value2) == 0;
+}
+
+static CFHashCode pl_cstring_hash (const void *value) {
+    uint32_t hash = FNV_OFFSET_BASIS;
+    for (const uint8_t *p = value; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/**
+ * @internal
+ *
+ * A thread-safe table of interned strings, shared by reports decoded together (see
+ * +[PLCrashReport reportsWithDataArray:options:errors:]), such that values repeated across reports -- such as
+ * image paths and OS versions -- are represented by a single NSString instance.
+ */
+@implementation PLCrashReportStringTable
+
+- (id) init {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    CFDictionaryKeyCallBacks keyCallbacks = {
+        .version = 0,
+        .retain = pl_cstring_retain,
+        .release = pl_cstring_release,
+        .copyDescription = NULL,
+        .equal = pl_cstring_equal,
+        .hash = pl_cstring_hash
+    };
+
+    _strings = CFDictionaryCreateMutable(NULL, 0, &keyCallbacks, &kCFTypeDictionaryValueCallBacks);
+    if (_strings == NULL) {
+        [self release];
+        return nil;
+    }
+
+    pthread_mutex_init(&_lock, NULL);
+    return self;
+}
+
+- (void) dealloc {
+    if (_strings != NULL) {
+        CFRelease(_strings);
+        pthread_mutex_destroy(&_lock);
+    }
+
+    [super dealloc];
+}
+
+/**
+ * Return the interned string for the given NUL-terminated UTF-8 @a string, creating it if necessary. Existing
+ * strings are returned without allocation.
+ *
+ * The returned string is retained by the table, and remains valid for the lifetime of the table.
+ *
+ * @param string A NUL-terminated UTF-8 string.
+ *
+ * @return Returns the interned string, or nil if @a string is not valid UTF-8.
+ */
+- (NSString *) stringWithUTF8String: (const char *) string {
+    NSString *result;
+
+    pthread_mutex_lock(&_lock);
+    result = (NSString *) CFDictionaryGetValue(_strings, string);
+    if (result == nil) {
+        result = [[NSString alloc] initWithUTF8String: string];
+        if (result != nil) {
+            CFDictionarySetValue(_strings, string, result);
+            [result release];
+        }
+    }
+    pthread_mutex_unlock(&_lock);
+
+    return result;
+}
+
+/**
+ * Return the interned equivalent of @a string, adding @a string to the table if necessary.
+ *
+ * The returned string is retained by the table, and remains valid for the lifetime of the table.
+ *
+ * @param string The string to intern.
+ */
+- (NSString *) internString: (NSString *) string {
+    const char *key = [string UTF8String];
+    NSString *result;
+
+    pthread_mutex_lock(&_lock);
+    result = (NSString *) CFDictionaryGetValue(_strings, key);
+    if (result == nil) {
+        result = [[string copy] autorelease];
+        CFDictionarySetValue(_strings, key, result);
+    }
+    pthread_mutex_unlock(&_lock);
+
+    return result;
+}
+
+@end
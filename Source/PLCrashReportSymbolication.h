@@ -0,0 +1,72 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_REPORT_SYMBOLICATION_H
+#define PLCRASH_REPORT_SYMBOLICATION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncImageList.h"
+#include "PLCrashAsyncSymbolication.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_report_symbolication Deferred Crash Report Symbolication
+ *
+ * Symbolicates the stack frames of a crash report that was written without crash-time symbolication, using
+ * the binary images loaded in the current process.
+ *
+ * Report binary images are matched against the current process' images by UUID, and images elided from the
+ * report as members of the dyld shared cache are matched by the shared cache's UUID. Reports written by a
+ * different build of the application or different OS release will simply be left unsymbolicated.
+ *
+ * These functions are not async-safe, and must not be called at crash time.
+ *
+ * @{
+ */
+
+plcrash_error_t plcrash_report_symbolicate (const void *report, size_t length,
+                                            plcrash_async_image_list_t *image_list,
+                                            plcrash_async_symbol_strategy_t strategy,
+                                            void **output, size_t *output_length);
+
+/**
+ * @} plcrash_report_symbolication
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_REPORT_SYMBOLICATION_H */
@@ -0,0 +1,331 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportSymbolication.h"
+#import "PLCrashReport.h"
+#import "PLCrashAsyncSharedCache.h"
+
+#import "crash_report.pb-c.h"
+
+#import <string.h>
+#import <stdlib.h>
+#import <mach-o/loader.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_report_symbolication
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * A report binary image, and its matching image within the current process.
+ */
+typedef struct plcrash_symbolicate_image {
+    /** The report image's base address. */
+    uint64_t base_address;
+
+    /** The report image's size. */
+    uint64_t size;
+
+    /** The matching local image, or NULL if the image is not loaded in the current process. */
+    plcrash_async_image_t *local;
+} plcrash_symbolicate_image_t;
+
+/**
+ * @internal
+ *
+ * Report symbolication state.
+ */
+typedef struct plcrash_symbolicate_ctx {
+    /** The local image list. Must be held for reading. */
+    plcrash_async_image_list_t *image_list;
+
+    /** The symbolication strategy. */
+    plcrash_async_symbol_strategy_t strategy;
+
+    /** Symbol lookup cache. */
+    plcrash_async_symbol_cache_t cache;
+
+    /** The report's binary images. */
+    plcrash_symbolicate_image_t *images;
+
+    /** Number of elements in @a images. */
+    size_t image_count;
+
+    /** If true, the report's shared cache matches the current process' shared cache. */
+    bool shared_cache_match;
+
+    /** If @a shared_cache_match is true, the difference between the local and report shared cache slides. */
+    int64_t shared_cache_delta;
+
+    /** The number of frames symbolicated. */
+    size_t symbolicated;
+} plcrash_symbolicate_ctx_t;
+
+/**
+ * @internal
+ *
+ * Symbol lookup result.
+ */
+typedef struct plcrash_symbolicate_result {
+    /** The symbol's start address, within the current process. */
+    pl_vm_address_t address;
+
+    /** The symbol's name, or NULL if not found. Must be freed by the caller. */
+    char *name;
+} plcrash_symbolicate_result_t;
+
+/* plcrash_async_find_symbol() callback */
+static void plcrash_symbolicate_found_symbol (pl_vm_address_t address, const char *name, void *ctx) {
+    plcrash_symbolicate_result_t *result = ctx;
+
+    /* Only the first (best) match is used */
+    if (result->name != NULL)
+        return;
+
+    result->address = address;
+    result->name = strdup(name);
+}
+
+/**
+ * Return true if the UUID of @a local matches @a uuid. 
+ */
+static bool plcrash_symbolicate_uuid_matches (plcrash_async_image_t *local, const ProtobufCBinaryData *uuid) {
+    struct uuid_command *cmd = plcrash_async_macho_find_command(&local->macho_image, LC_UUID);
+    if (cmd == NULL || uuid->len != sizeof(cmd->uuid))
+        return false;
+
+    return memcmp(cmd->uuid, uuid->data, sizeof(cmd->uuid)) == 0;
+}
+
+/**
+ * Match all of @a report's binary images against the images loaded in the current process.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the image table could not be allocated.
+ */
+static plcrash_error_t plcrash_symbolicate_match_images (plcrash_symbolicate_ctx_t *ctx, Plcrash__CrashReport *report) {
+    ctx->image_count = report->n_binary_images;
+    if (ctx->image_count > 0 && (ctx->images = calloc(ctx->image_count, sizeof(ctx->images[0]))) == NULL)
+        return PLCRASH_ENOMEM;
+
+    for (size_t i = 0; i < report->n_binary_images; i++) {
+        Plcrash__CrashReport__BinaryImage *image = report->binary_images[i];
+        ctx->images[i].base_address = image->base_address;
+        ctx->images[i].size = image->size;
+
+        /* Images without a UUID can not be safely matched */
+        if (!image->has_uuid)
+            continue;
+
+        plcrash_async_image_t *local = NULL;
+        while ((local = plcrash_async_image_list_next(ctx->image_list, local)) != NULL) {
+            if (plcrash_symbolicate_uuid_matches(local, &image->uuid)) {
+                ctx->images[i].local = local;
+                break;
+            }
+        }
+    }
+
+    /* Images elided as members of the shared cache may be found via the local shared cache, if it matches */
+    plcrash_async_shared_cache_t shared_cache;
+    if (report->shared_cache != NULL &&
+        report->shared_cache->uuid.len == sizeof(shared_cache.uuid) &&
+        plcrash_async_shared_cache_init(&shared_cache, mach_task_self()) == PLCRASH_ESUCCESS &&
+        memcmp(shared_cache.uuid, report->shared_cache->uuid.data, sizeof(shared_cache.uuid)) == 0)
+    {
+        ctx->shared_cache_match = true;
+        ctx->shared_cache_delta = (int64_t) shared_cache.slide - report->shared_cache->slide;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Symbolicate @a frame, if it has not already been symbolicated.
+ */
+static void plcrash_symbolicate_frame (plcrash_symbolicate_ctx_t *ctx, Plcrash__CrashReport__Thread__StackFrame *frame) {
+    if (frame->symbol != NULL || !frame->has_pc)
+        return;
+
+    /* Map the report PC to the matching local image */
+    plcrash_async_image_t *local = NULL;
+    int64_t delta = 0;
+    bool in_report_image = false;
+
+    for (size_t i = 0; i < ctx->image_count; i++) {
+        plcrash_symbolicate_image_t *image = &ctx->images[i];
+        if (frame->pc < image->base_address || frame->pc - image->base_address >= image->size)
+            continue;
+
+        in_report_image = true;
+        if (image->local != NULL) {
+            local = image->local;
+            delta = (int64_t) local->macho_image.header_addr - (int64_t) image->base_address;
+        }
+        break;
+    }
+
+    if (!in_report_image && ctx->shared_cache_match) {
+        delta = ctx->shared_cache_delta;
+        local = plcrash_async_image_containing_address(ctx->image_list, (pl_vm_address_t) (frame->pc + delta));
+    }
+
+    if (local == NULL)
+        return;
+
+    /* Look up the symbol within the local image */
+    plcrash_symbolicate_result_t result = { .address = 0, .name = NULL };
+    if (plcrash_async_find_symbol(&local->macho_image, ctx->strategy, &ctx->cache, (pl_vm_address_t) (frame->pc + delta), plcrash_symbolicate_found_symbol, &result) != PLCRASH_ESUCCESS || result.name == NULL) {
+        free(result.name);
+        return;
+    }
+
+    /* Attach the symbol, mapped back to the report's address space. The symbol is freed along with the
+     * unpacked report via the system allocator. */
+    Plcrash__CrashReport__Symbol *symbol = malloc(sizeof(*symbol));
+    if (symbol == NULL) {
+        free(result.name);
+        return;
+    }
+
+    Plcrash__CrashReport__Symbol init = PLCRASH__CRASH_REPORT__SYMBOL__INIT;
+    *symbol = init;
+    symbol->name = result.name;
+    symbol->start_address = (uint64_t) ((int64_t) result.address - delta);
+
+    frame->symbol = symbol;
+    ctx->symbolicated++;
+}
+
+/**
+ * Symbolicate all unsymbolicated stack frames within the encoded crash report @a report, using the binary images
+ * loaded in the current process.
+ *
+ * Only frames whose binary image (matched by UUID) or dyld shared cache (matched by shared cache UUID) is loaded
+ * in the current process will be symbolicated; all other frames are left unmodified.
+ *
+ * @param report The crash report data, including its file header.
+ * @param length The length of @a report, in bytes.
+ * @param image_list The current process' image list.
+ * @param strategy The symbolication strategies to be used.
+ * @param[out] output On success, a newly allocated buffer containing the symbolicated crash report, including its file
+ * header. The caller is responsible for freeing this buffer via free().
+ * @param[out] output_length On success, the length of @a output, in bytes.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success. If the report uses the compact (v2) encoding, PLCRASH_ENOTSUP will
+ * be returned, and the report must be used unmodified. If the report can not be decoded, PLCRASH_EINVAL will be
+ * returned. If no frames could be symbolicated, PLCRASH_ENOTFOUND will be returned.
+ */
+plcrash_error_t plcrash_report_symbolicate (const void *report, size_t length,
+                                            plcrash_async_image_list_t *image_list,
+                                            plcrash_async_symbol_strategy_t strategy,
+                                            void **output, size_t *output_length)
+{
+    const struct PLCrashReportFileHeader *header = report;
+    size_t header_length = sizeof(struct PLCrashReportFileHeader);
+    plcrash_error_t err;
+
+    /* Validate the file header */
+    if (length < header_length || memcmp(header->magic, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) != 0)
+        return PLCRASH_EINVAL;
+
+    /* Compact reports reference frames by image offset, and are better symbolicated off-device */
+    if (header->version != PLCRASH_REPORT_FILE_VERSION)
+        return PLCRASH_ENOTSUP;
+
+    if (strategy == PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE)
+        return PLCRASH_ENOTFOUND;
+
+    /* Decode the report */
+    Plcrash__CrashReport *crashReport = plcrash__crash_report__unpack(&protobuf_c_system_allocator, length - header_length, header->data);
+    if (crashReport == NULL) {
+        PLCF_DEBUG("Could not decode crash report for symbolication");
+        return PLCRASH_EINVAL;
+    }
+
+    plcrash_symbolicate_ctx_t ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.image_list = image_list;
+    ctx.strategy = strategy;
+
+    if ((err = plcrash_async_symbol_cache_init(&ctx.cache)) != PLCRASH_ESUCCESS) {
+        protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+        return err;
+    }
+
+    plcrash_async_image_list_set_reading(image_list, true);
+
+    if ((err = plcrash_symbolicate_match_images(&ctx, crashReport)) != PLCRASH_ESUCCESS)
+        goto cleanup;
+
+    /* Symbolicate all thread and exception frames */
+    for (size_t i = 0; i < crashReport->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thread = crashReport->threads[i];
+        for (size_t j = 0; j < thread->n_frames; j++)
+            plcrash_symbolicate_frame(&ctx, thread->frames[j]);
+    }
+
+    if (crashReport->exception != NULL) {
+        for (size_t i = 0; i < crashReport->exception->n_frames; i++)
+            plcrash_symbolicate_frame(&ctx, crashReport->exception->frames[i]);
+    }
+
+    if (ctx.symbolicated == 0) {
+        err = PLCRASH_ENOTFOUND;
+        goto cleanup;
+    }
+
+    /* Re-encode the report */
+    size_t packed_length = protobuf_c_message_get_packed_size((ProtobufCMessage *) crashReport);
+    uint8_t *buffer = malloc(header_length + packed_length);
+    if (buffer == NULL) {
+        err = PLCRASH_ENOMEM;
+        goto cleanup;
+    }
+
+    memcpy(buffer, header, header_length);
+    protobuf_c_message_pack((ProtobufCMessage *) crashReport, buffer + header_length);
+
+    *output = buffer;
+    *output_length = header_length + packed_length;
+    err = PLCRASH_ESUCCESS;
+
+cleanup:
+    plcrash_async_image_list_set_reading(image_list, false);
+    plcrash_async_symbol_cache_free(&ctx.cache);
+    free(ctx.images);
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) crashReport, &protobuf_c_system_allocator);
+
+    return err;
+}
+
+/**
+ * @} plcrash_report_symbolication
+ */
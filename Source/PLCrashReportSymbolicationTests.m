@@ -0,0 +1,174 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashReportSymbolication.h"
+#import "PLCrashLogWriter.h"
+#import "PLCrashAsyncImageList.h"
+#import "PLCrashReport.h"
+
+#import <fcntl.h>
+#import <mach-o/dyld.h>
+
+#import "crash_report.pb-c.h"
+#import "PLCrashTestThread.h"
+
+@interface PLCrashReportSymbolicationTests : SenTestCase {
+@private
+    /* Path to crash log */
+    NSString *_logPath;
+
+    /* Test thread */
+    plcrash_test_thread_t _thr_args;
+
+    /* Image list */
+    plcrash_async_image_list_t _image_list;
+}
+
+@end
+
+@implementation PLCrashReportSymbolicationTests
+
+- (void) setUp {
+    _logPath = [[NSTemporaryDirectory() stringByAppendingString: [[NSProcessInfo processInfo] globallyUniqueString]] retain];
+    plcrash_test_thread_spawn(&_thr_args);
+
+    plcrash_nasync_image_list_init(&_image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&_image_list, (pl_vm_address_t) _dyld_get_image_header(i), _dyld_get_image_name(i));
+}
+
+- (void) tearDown {
+    if ([[NSFileManager defaultManager] fileExistsAtPath: _logPath])
+        [[NSFileManager defaultManager] removeItemAtPath: _logPath error: NULL];
+    [_logPath release];
+
+    plcrash_nasync_image_list_free(&_image_list);
+    plcrash_test_thread_stop(&_thr_args);
+}
+
+/* Write an unsymbolicated report of the test thread, returning the report data */
+- (NSData *) writeUnsymbolicatedReport {
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+
+    int fd = open([_logPath UTF8String], O_RDWR|O_CREAT|O_EXCL, 0644);
+    STAssertTrue(fd >= 0, @"Could not open output file");
+    plcrash_async_file_init(&file, fd, 0);
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_init(&writer, @"test.id", @"1.0", PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, true), @"Initialization failed");
+
+    plcrash_log_bsd_signal_info_t bsd_info = { .signo = SIGTRAP, .code = TRAP_TRACE, .address = NULL };
+    plcrash_log_signal_info_t info = { .bsd_info = &bsd_info, .mach_info = NULL };
+    thread_t thread = pthread_mach_thread_np(_thr_args.thread);
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_log_writer_write(&writer, thread, &_image_list, &file, &info, NULL), @"Crash log failed");
+
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+
+    plcrash_async_file_flush(&file);
+    plcrash_async_file_close(&file);
+
+    return [NSData dataWithContentsOfFile: _logPath];
+}
+
+/* Decode the given report data */
+- (Plcrash__CrashReport *) decodeReport: (const void *) data length: (size_t) length {
+    const struct PLCrashReportFileHeader *header = data;
+    return plcrash__crash_report__unpack(&protobuf_c_system_allocator, length - sizeof(struct PLCrashReportFileHeader), header->data);
+}
+
+/**
+ * Verify that an unsymbolicated report is symbolicated using the images loaded in the current process.
+ */
+- (void) testSymbolicate {
+    NSData *data = [self writeUnsymbolicatedReport];
+    STAssertNotNil(data, @"Could not read report");
+
+    /* Verify that the report was written without symbols */
+    Plcrash__CrashReport *report = [self decodeReport: [data bytes] length: [data length]];
+    STAssertNotNULL(report, @"Could not decode report");
+    for (size_t i = 0; i < report->n_threads; i++) {
+        for (size_t j = 0; j < report->threads[i]->n_frames; j++)
+            STAssertNULL(report->threads[i]->frames[j]->symbol, @"Report was symbolicated at write time");
+    }
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) report, &protobuf_c_system_allocator);
+
+    /* Symbolicate the report */
+    void *output;
+    size_t output_length;
+    plcrash_error_t err = plcrash_report_symbolicate([data bytes], [data length], &_image_list, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &output, &output_length);
+    STAssertEquals(err, PLCRASH_ESUCCESS, @"Symbolication failed");
+    if (err != PLCRASH_ESUCCESS)
+        return;
+
+    STAssertTrue(memcmp(output, [data bytes], sizeof(struct PLCrashReportFileHeader)) == 0, @"File header was not preserved");
+
+    /* Verify that the symbols are valid for their frames */
+    report = [self decodeReport: output length: output_length];
+    STAssertNotNULL(report, @"Could not decode symbolicated report");
+
+    size_t symbolicated = 0;
+    for (size_t i = 0; i < report->n_threads; i++) {
+        Plcrash__CrashReport__Thread *thread = report->threads[i];
+        for (size_t j = 0; j < thread->n_frames; j++) {
+            Plcrash__CrashReport__Thread__StackFrame *frame = thread->frames[j];
+            if (frame->symbol == NULL)
+                continue;
+
+            symbolicated++;
+            STAssertNotNULL(frame->symbol->name, @"Missing symbol name");
+            STAssertTrue(frame->symbol->start_address <= frame->pc, @"Symbol start address is above the frame's PC");
+        }
+    }
+    STAssertTrue(symbolicated > 0, @"No frames were symbolicated");
+
+    protobuf_c_message_free_unpacked((ProtobufCMessage *) report, &protobuf_c_system_allocator);
+    free(output);
+}
+
+/**
+ * Verify that invalid and compact reports are rejected.
+ */
+- (void) testUnsupportedReports {
+    void *output;
+    size_t output_length;
+
+    struct PLCrashReportFileHeader header;
+    memcpy(header.magic, PLCRASH_REPORT_FILE_MAGIC, sizeof(header.magic));
+
+    header.version = PLCRASH_REPORT_FILE_VERSION_COMPACT;
+    STAssertEquals(plcrash_report_symbolicate(&header, sizeof(header), &_image_list, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &output, &output_length), PLCRASH_ENOTSUP, @"Compact report was not rejected");
+
+    header.magic[0] = 'x';
+    header.version = PLCRASH_REPORT_FILE_VERSION;
+    STAssertEquals(plcrash_report_symbolicate(&header, sizeof(header), &_image_list, PLCRASH_ASYNC_SYMBOL_STRATEGY_ALL, &output, &output_length), PLCRASH_EINVAL, @"Invalid magic was not rejected");
+}
+
+@end
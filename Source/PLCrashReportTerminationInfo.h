@@ -0,0 +1,122 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import <Foundation/Foundation.h>
+
+/**
+ * @ingroup constants
+ *
+ * The inferred causes of a termination for which no crash report was written.
+ */
+typedef enum {
+    /** The process was terminated while its main thread was hung, most likely by the system watchdog. */
+    PLCrashReportTerminationReasonWatchdog = 1,
+
+    /** The process was terminated in the foreground, most likely for exceeding its memory limit. */
+    PLCrashReportTerminationReasonOutOfMemory = 2,
+
+    /** The process was terminated in the background. */
+    PLCrashReportTerminationReasonBackground = 3
+} PLCrashReportTerminationReason;
+
+@interface PLCrashReportTerminationInfo : NSObject {
+@private
+    /** Termination reason */
+    PLCrashReportTerminationReason _reason;
+
+    /** Terminated process ID */
+    NSUInteger _processID;
+
+    /** Launch date (may be nil) */
+    NSDate *_launchDate;
+
+    /** YES if in the foreground */
+    BOOL _foreground;
+
+    /** YES if the main thread was hung */
+    BOOL _hung;
+
+    /** YES if a low memory warning was received */
+    BOOL _receivedMemoryWarning;
+
+    /** Most recent footprint sample, or 0 */
+    uint64_t _footprint;
+
+    /** Footprint sample date (may be nil) */
+    NSDate *_footprintDate;
+}
+
+- (id) initWithReason: (PLCrashReportTerminationReason) reason
+            processID: (NSUInteger) processID
+           launchDate: (NSDate *) launchDate
+           foreground: (BOOL) foreground
+                 hung: (BOOL) hung
+receivedMemoryWarning: (BOOL) receivedMemoryWarning
+            footprint: (uint64_t) footprint
+        footprintDate: (NSDate *) footprintDate;
+
+/**
+ * The inferred cause of the termination.
+ */
+@property(nonatomic, readonly) PLCrashReportTerminationReason reason;
+
+/**
+ * The terminated process' ID.
+ */
+@property(nonatomic, readonly) NSUInteger processID;
+
+/**
+ * The date at which the terminated process was launched, or nil if unknown.
+ */
+@property(nonatomic, readonly) NSDate *launchDate;
+
+/**
+ * YES if the process was in the foreground when it was terminated.
+ */
+@property(nonatomic, readonly, getter = isForeground) BOOL foreground;
+
+/**
+ * YES if the process' main thread was hung when it was terminated.
+ */
+@property(nonatomic, readonly, getter = isHung) BOOL hung;
+
+/**
+ * YES if the process had received a low memory warning since last entering the foreground.
+ */
+@property(nonatomic, readonly) BOOL receivedMemoryWarning;
+
+/**
+ * The process' most recently sampled physical footprint, in bytes, or 0 if the footprint was never sampled.
+ */
+@property(nonatomic, readonly) uint64_t footprint;
+
+/**
+ * The date at which the footprint was sampled, or nil if the footprint was never sampled.
+ */
+@property(nonatomic, readonly) NSDate *footprintDate;
+
+@end
@@ -0,0 +1,89 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#import "PLCrashReportTerminationInfo.h"
+
+/**
+ * Provides access to the details of a termination that could not be reported by the terminated process, as inferred
+ * from the state it recorded prior to the termination.
+ *
+ * @sa PLCrashReporter::enableTerminationReportsAndReturnError:
+ */
+@implementation PLCrashReportTerminationInfo
+
+/**
+ * Initialize with the provided termination data.
+ *
+ * @param reason The inferred cause of the termination.
+ * @param processID The terminated process' ID.
+ * @param launchDate The date at which the terminated process was launched, or nil if unknown.
+ * @param foreground YES if the process was in the foreground.
+ * @param hung YES if the process' main thread was hung.
+ * @param receivedMemoryWarning YES if the process had received a low memory warning.
+ * @param footprint The process' most recently sampled physical footprint, or 0 if never sampled.
+ * @param footprintDate The date at which @a footprint was sampled, or nil if never sampled.
+ */
+- (id) initWithReason: (PLCrashReportTerminationReason) reason
+            processID: (NSUInteger) processID
+           launchDate: (NSDate *) launchDate
+           foreground: (BOOL) foreground
+                 hung: (BOOL) hung
+receivedMemoryWarning: (BOOL) receivedMemoryWarning
+            footprint: (uint64_t) footprint
+        footprintDate: (NSDate *) footprintDate
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _reason = reason;
+    _processID = processID;
+    _launchDate = [launchDate retain];
+    _foreground = foreground;
+    _hung = hung;
+    _receivedMemoryWarning = receivedMemoryWarning;
+    _footprint = footprint;
+    _footprintDate = [footprintDate retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_launchDate release];
+    [_footprintDate release];
+    [super dealloc];
+}
+
+@synthesize reason = _reason;
+@synthesize processID = _processID;
+@synthesize launchDate = _launchDate;
+@synthesize foreground = _foreground;
+@synthesize hung = _hung;
+@synthesize receivedMemoryWarning = _receivedMemoryWarning;
+@synthesize footprint = _footprint;
+@synthesize footprintDate = _footprintDate;
+
+@end
@@ -29,10 +29,13 @@
 #import "GTMSenTestCase.h"
 #import "PLCrashReport.h"
 #import "PLCrashReporter.h"
+#import "PLCrashReportTextFormatter.h"
 #import "PLCrashFrameWalker.h"
 #import "PLCrashLogWriter.h"
 #import "PLCrashAsyncImageList.h"
 #import "PLCrashTestThread.h"
+#import "PLCrashHangDetector.h"
+#import "PLCrashReportFrameTable.h"
 
 #import <fcntl.h>
 #import <dlfcn.h>
@@ -149,6 +152,7 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
 
     /* Report info */
     STAssertNotNULL(crashLog.uuidRef, @"No report UUID");
+    STAssertEquals(crashLog.reportType, PLCrashReportTypeLanguageException, @"Incorrect report type");
     
     /* System info */
     STAssertNotNil(crashLog.systemInfo, @"No system information available");
@@ -272,8 +276,240 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
         struct mach_header *hdr = info.dli_fbase;
         STAssertEquals(imageInfo.codeType.type, (uint64_t)(uint32_t)hdr->cputype, @"Incorrect CPU type");
         STAssertEquals(imageInfo.codeType.subtype, (uint64_t)(uint32_t)hdr->cpusubtype, @"Incorrect CPU subtype");
+
+        /* Verify image lookup at the image bounds */
+        STAssertEquals([crashLog imageForAddress: imageInfo.imageBaseAddress], imageInfo, @"Lookup of image base address failed");
+        STAssertEquals([crashLog imageForAddress: imageInfo.imageBaseAddress + imageInfo.imageSize - 1], imageInfo, @"Lookup of image end address failed");
+    }
+    STAssertNil([crashLog imageForAddress: 0], @"Lookup of NULL address should fail");
+
+    /* Formatting directly to a file descriptor must match the string formatter output */
+    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: crashLog withTextFormat: PLCrashReportTextFormatiOS];
+    STAssertNotNil(text, @"Failed to format report");
+
+    NSString *textPath = [_logPath stringByAppendingPathExtension: @"txt"];
+    int textFd = open([textPath fileSystemRepresentation], O_RDWR|O_CREAT|O_TRUNC, 0644);
+    STAssertTrue(textFd >= 0, @"Could not open text output file: %s", strerror(errno));
+    STAssertTrue([PLCrashReportTextFormatter writeCrashReport: crashLog withTextFormat: PLCrashReportTextFormatiOS toFileDescriptor: textFd error: &error],
+                 @"Failed to write formatted report: %@", error);
+    close(textFd);
+
+    NSData *textData = [NSData dataWithContentsOfFile: textPath];
+    STAssertEqualObjects(textData, [text dataUsingEncoding: NSUTF8StringEncoding], @"Formatted output does not match");
+    [[NSFileManager defaultManager] removeItemAtPath: textPath error: NULL];
+
+    /* The JSON format must produce a single line of well-formed JSON describing the report */
+    NSString *json = [PLCrashReportTextFormatter stringValueForCrashReport: crashLog withTextFormat: PLCrashReportTextFormatJSON];
+    STAssertNotNil(json, @"Failed to format JSON report");
+    STAssertEquals([json rangeOfString: @"\n"].location, (NSUInteger) NSNotFound, @"JSON report contains a line break");
+
+    NSDictionary *jsonReport = [NSJSONSerialization JSONObjectWithData: [json dataUsingEncoding: NSUTF8StringEncoding] options: 0 error: &error];
+    STAssertNotNil(jsonReport, @"Failed to parse JSON report: %@", error);
+    STAssertEqualStrings([[jsonReport objectForKey: @"signal"] objectForKey: @"name"], crashLog.signalInfo.name, @"Incorrect signal");
+    STAssertEquals([[jsonReport objectForKey: @"threads"] count], [crashLog.threads count], @"Incorrect thread count");
+    STAssertEquals([[jsonReport objectForKey: @"images"] count], [crashLog.images count], @"Incorrect image count");
+
+    /* Fingerprinting must succeed on a well-formed report */
+    NSData *fingerprint = [PLCrashReport fingerprintForData: [NSData dataWithContentsOfMappedFile: _logPath] frameCount: 5 error: &error];
+    STAssertNotNil(fingerprint, @"Failed to compute fingerprint: %@", error);
+
+    /* Lazy decoding must produce identical thread and image records */
+    PLCrashReport *lazyLog = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfMappedFile: _logPath]
+                                                          options: PLCrashReportDecodingOptionLazy
+                                                            error: &error] autorelease];
+    STAssertNotNil(lazyLog, @"Could not lazily decode crash log: %@", error);
+    STAssertEqualStrings(lazyLog.systemInfo.operatingSystemVersion, crashLog.systemInfo.operatingSystemVersion, @"Incorrect OS version");
+    STAssertEqualStrings(lazyLog.signalInfo.name, crashLog.signalInfo.name, @"Incorrect signal");
+
+    STAssertEquals([lazyLog.threads count], [crashLog.threads count], @"Incorrect thread count");
+    for (NSUInteger i = 0; i < [crashLog.threads count]; i++) {
+        PLCrashReportThreadInfo *expected = [crashLog.threads objectAtIndex: i];
+        PLCrashReportThreadInfo *actual = [lazyLog.threads objectAtIndex: i];
+        STAssertEquals(actual.threadNumber, expected.threadNumber, @"Incorrect thread number");
+        STAssertEquals(actual.crashed, expected.crashed, @"Incorrect crashed flag");
+        STAssertEquals([actual.stackFrames count], [expected.stackFrames count], @"Incorrect frame count");
+        STAssertEquals([actual.registers count], [expected.registers count], @"Incorrect register count");
+    }
+
+    STAssertEquals([lazyLog.images count], [crashLog.images count], @"Incorrect image count");
+    for (NSUInteger i = 0; i < [crashLog.images count]; i++) {
+        PLCrashReportBinaryImageInfo *expected = [crashLog.images objectAtIndex: i];
+        PLCrashReportBinaryImageInfo *actual = [lazyLog.images objectAtIndex: i];
+        STAssertEqualStrings(actual.imageName, expected.imageName, @"Incorrect image name");
+        STAssertEquals(actual.imageBaseAddress, expected.imageBaseAddress, @"Incorrect image base address");
+    }
+
+    /* The crashed thread must be resolvable from a lazily decoded report without decoding the other threads */
+    PLCrashReportThreadInfo *expectedCrashed = nil;
+    for (PLCrashReportThreadInfo *thread in crashLog.threads) {
+        if (thread.crashed) {
+            expectedCrashed = thread;
+            break;
+        }
+    }
+
+    lazyLog = [[[PLCrashReport alloc] initWithData: [NSData dataWithContentsOfMappedFile: _logPath]
+                                           options: PLCrashReportDecodingOptionLazy
+                                             error: &error] autorelease];
+    STAssertNotNil(lazyLog, @"Could not lazily decode crash log: %@", error);
+    STAssertNotNil(lazyLog.crashedThread, @"No crashed thread");
+    STAssertEquals(lazyLog.crashedThread.threadNumber, expectedCrashed.threadNumber, @"Incorrect crashed thread");
+    STAssertEquals([lazyLog.crashedThread.stackFrames count], [expectedCrashed.stackFrames count], @"Incorrect frame count");
+
+    /* The summary format describes only the crashed thread */
+    NSString *summary = [PLCrashReportTextFormatter stringValueForCrashReport: lazyLog withTextFormat: PLCrashReportTextFormatSummary];
+    STAssertNotNil(summary, @"Failed to format summary");
+    STAssertTrue([summary rangeOfString: @"Crashed Thread:"].location != NSNotFound, @"Summary is missing the crashed thread");
+    STAssertEquals([summary rangeOfString: @"Binary Images:"].location, (NSUInteger) NSNotFound, @"Summary contains binary images");
+}
+
+
+/**
+ * Verify that live and hang reports are typed, and that watchdog summaries omit the stalled thread's registers.
+ */
+- (void) testReportType {
+    PLCrashReporter *reporter = [PLCrashReporter sharedReporter];
+    NSError *error;
+
+    NSData *live = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(live, @"Failed to generate live report: %@", error);
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: live error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode live report: %@", error);
+    STAssertEquals(report.reportType, PLCrashReportTypeLive, @"Incorrect live report type");
+
+    /* Hang reports are watchdog reports, regardless of having been written on request */
+    plcrash_log_writer_hang_info_t hang = { .duration = 5000, .samples = NULL, .sample_count = 0 };
+    NSData *data = [reporter generateLiveReportWithThread: pl_mach_thread_self() hang: &hang error: &error];
+    STAssertNotNil(data, @"Failed to generate hang report: %@", error);
+
+    report = [[[PLCrashReport alloc] initWithData: data error: &error] autorelease];
+    STAssertNotNil(report, @"Could not decode hang report: %@", error);
+    STAssertEquals(report.reportType, PLCrashReportTypeWatchdog, @"Incorrect hang report type");
+
+    PLCrashReport *summary = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionWatchdogSummary error: &error] autorelease];
+    STAssertNotNil(summary, @"Could not decode hang report summary: %@", error);
+    STAssertEquals([summary.threads count], [report.threads count], @"Threads were omitted from the summary");
+    for (PLCrashReportThreadInfo *thread in summary.threads) {
+        STAssertEquals([thread.registers count], (NSUInteger) 0, @"Registers were decoded for thread %ld", (long) thread.threadNumber);
+        if (thread.crashed)
+            STAssertTrue([thread.stackFrames count] > 0, @"The stalled thread's frames were not decoded");
     }
 }
 
+/**
+ * Verify that the frame table deduplicates symbols, and vends frames sharing a single symbol info instance per symbol.
+ */
+- (void) testFrameTable {
+    PLCrashReportFrameTable *table = [[[PLCrashReportFrameTable alloc] initWithStringTable: nil] autorelease];
+    STAssertNotNil(table, @"Failed to allocate the frame table");
+
+    uint32_t first = [table indexForSymbolName: "main" startAddress: 0x1000 endAddress: 0];
+    STAssertEquals([table indexForSymbolName: "main" startAddress: 0x1000 endAddress: 0], first, @"Symbol was not deduplicated");
+    uint32_t second = [table indexForSymbolName: "main" startAddress: 0x2000 endAddress: 0x2100];
+    STAssertFalse(first == second, @"Symbols with differing start addresses were merged");
+
+    STAssertTrue([table appendFrameWithInstructionPointer: 0x1010 symbolIndex: first repeatLength: 0 repeatCount: 0 omittedFrameCount: 0 unwindMethod: PLCrashReportUnwindMethodUnknown], @"Failed to append frame");
+    STAssertTrue([table appendFrameWithInstructionPointer: 0x1020 symbolIndex: first repeatLength: 1 repeatCount: 5 omittedFrameCount: 0 unwindMethod: PLCrashReportUnwindMethodUnknown], @"Failed to append frame");
+    STAssertTrue([table appendFrameWithInstructionPointer: 0x3000 symbolIndex: PLCrashReportFrameTableNoSymbol repeatLength: 0 repeatCount: 0 omittedFrameCount: 0 unwindMethod: PLCrashReportUnwindMethodUnknown], @"Failed to append frame");
+    STAssertTrue([table appendFrameWithInstructionPointer: 0x2010 symbolIndex: second repeatLength: 0 repeatCount: 0 omittedFrameCount: 0 unwindMethod: PLCrashReportUnwindMethodFramePointer], @"Failed to append frame");
+    [table finishAppending];
+
+    STAssertEquals(table.frameCount, (NSUInteger) 4, @"Incorrect frame count");
+    STAssertEquals([table instructionPointerAtIndex: 2], (uint64_t) 0x3000, @"Incorrect instruction pointer");
+
+    NSArray *frames = [table stackFramesInRange: NSMakeRange(0, 4)];
+    STAssertEquals([frames count], (NSUInteger) 4, @"Incorrect frame count");
+
+    PLCrashReportStackFrameInfo *frame = [frames objectAtIndex: 1];
+    STAssertEquals(frame.instructionPointer, (uint64_t) 0x1020, @"Incorrect instruction pointer");
+    STAssertEquals(frame.repeatLength, (NSUInteger) 1, @"Incorrect repeat length");
+    STAssertEquals(frame.repeatCount, (NSUInteger) 5, @"Incorrect repeat count");
+    STAssertTrue(frame.symbolInfo == [[frames objectAtIndex: 0] symbolInfo], @"Symbol info was not shared");
+    STAssertEqualStrings(frame.symbolInfo.symbolName, @"main", @"Incorrect symbol name");
+
+    STAssertNil([[frames objectAtIndex: 2] symbolInfo], @"Unexpected symbol info");
+    STAssertEquals([[[frames objectAtIndex: 3] symbolInfo] endAddress], (uint64_t) 0x2100, @"Incorrect end address");
+
+    /* Frames appended before the first known unwind method are unknown */
+    STAssertEquals([[frames objectAtIndex: 0] unwindMethod], PLCrashReportUnwindMethodUnknown, @"Incorrect unwind method");
+    STAssertEquals([[frames objectAtIndex: 3] unwindMethod], PLCrashReportUnwindMethodFramePointer, @"Incorrect unwind method");
+
+    /* Threads vend the frames within their range */
+    PLCrashReportThreadInfo *thread = [[[PLCrashReportThreadInfo alloc] initWithThreadNumber: 0
+                                                                                  frameTable: table
+                                                                                  frameRange: NSMakeRange(2, 2)
+                                                                                     crashed: NO
+                                                                                   registers: [NSArray array]
+                                                                              schedulingInfo: nil] autorelease];
+    STAssertEquals(thread.stackFrameCount, (NSUInteger) 2, @"Incorrect thread frame count");
+    STAssertEquals([[thread.stackFrames objectAtIndex: 0] instructionPointer], (uint64_t) 0x3000, @"Incorrect thread frame");
+}
+
+/**
+ * Verify that the complete records of a truncated report are salvaged, and that complete reports are decoded
+ * unmodified.
+ */
+- (void) testSalvageTruncatedReport {
+    NSError *error;
+    NSData *data = [[PLCrashReporter sharedReporter] generateLiveReportAndReturnError: &error];
+    STAssertNotNil(data, @"Failed to generate live report: %@", error);
+
+    PLCrashReport *complete = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionSalvage error: &error] autorelease];
+    STAssertNotNil(complete, @"Could not decode complete report: %@", error);
+    STAssertFalse(complete.truncated, @"Complete report was marked as truncated");
+
+    /* Terminate the report partway through its trailing records */
+    NSData *partial = [data subdataWithRange: NSMakeRange(0, [data length] - ([data length] / 4))];
+    PLCrashReport *salvaged = [[[PLCrashReport alloc] initWithData: partial options: PLCrashReportDecodingOptionSalvage error: &error] autorelease];
+    STAssertNotNil(salvaged, @"Could not salvage truncated report: %@", error);
+    STAssertTrue(salvaged.truncated, @"Salvaged report was not marked as truncated");
+    STAssertEqualStrings(salvaged.signalInfo.name, complete.signalInfo.name, @"Incorrect signal");
+    STAssertTrue([salvaged.threads count] + [salvaged.images count] < [complete.threads count] + [complete.images count], @"No records were discarded");
+
+    /* Salvaging requires the report's required records */
+    NSData *header = [data subdataWithRange: NSMakeRange(0, 16)];
+    STAssertNil([[[PLCrashReport alloc] initWithData: header options: PLCrashReportDecodingOptionSalvage error: NULL] autorelease], @"Report without required records was decoded");
+}
+
+/**
+ * Verify that batch decoding returns a report or error for each input, in order, and interns strings shared
+ * across the batch's reports.
+ */
+- (void) testBatchDecode {
+    NSMutableArray *inputs = [NSMutableArray array];
+    NSError *error;
+
+    for (NSUInteger i = 0; i < 8; i++) {
+        NSData *data = [[PLCrashReporter sharedReporter] generateLiveReportAndReturnError: &error];
+        STAssertNotNil(data, @"Failed to generate live report: %@", error);
+        [inputs addObject: data];
+    }
+
+    /* Insert an invalid report */
+    [inputs insertObject: [NSData dataWithBytes: "invalid" length: 7] atIndex: 3];
+
+    NSArray *errors = nil;
+    NSArray *reports = [PLCrashReport reportsWithDataArray: inputs options: PLCrashReportDecodingOptionNone errors: &errors];
+    STAssertEquals([reports count], [inputs count], @"Incorrect report count");
+    STAssertEquals([errors count], [inputs count], @"Incorrect error count");
+
+    for (NSUInteger i = 0; i < [inputs count]; i++) {
+        if (i == 3) {
+            STAssertEqualObjects([reports objectAtIndex: i], [NSNull null], @"Invalid report was decoded");
+            STAssertTrue([[errors objectAtIndex: i] isKindOfClass: [NSError class]], @"Missing decoding error");
+            continue;
+        }
+
+        PLCrashReport *report = [reports objectAtIndex: i];
+        STAssertTrue([report isKindOfClass: [PLCrashReport class]], @"Report %lu was not decoded: %@", (unsigned long) i, [errors objectAtIndex: i]);
+        STAssertEqualObjects([errors objectAtIndex: i], [NSNull null], @"Unexpected error");
+    }
+
+    /* Equal strings are shared across the batch */
+    PLCrashReport *first = [reports objectAtIndex: 0];
+    PLCrashReport *last = [reports lastObject];
+    STAssertTrue(first.systemInfo.operatingSystemVersion == last.systemInfo.operatingSystemVersion, @"OS version was not interned");
+    STAssertTrue([[first.images objectAtIndex: 0] imageName] == [[last.images objectAtIndex: 0] imageName], @"Image name was not interned");
+}
 
 @end
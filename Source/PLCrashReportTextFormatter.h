@@ -42,9 +42,48 @@
 typedef enum {
     /** An iOS-compatible crash log text format. Compatible with the crash logs generated by the device and available
      * through iTunes Connect. */
-    PLCrashReportTextFormatiOS = 0
+    PLCrashReportTextFormatiOS = 0,
+
+    /**
+     * A structured JSON format. Each report is written as a single-line JSON object, and so reports written
+     * one per line form newline-delimited JSON (NDJSON). Addresses are written as "0x"-prefixed hexadecimal
+     * strings; timestamps as integer seconds since the UNIX epoch. Stack frames refer to their binary image by
+     * index within the report's "images" array.
+     */
+    PLCrashReportTextFormatJSON = 1,
+
+    /**
+     * An abbreviated, iOS-style summary, intended for displaying large numbers of reports. Only the report header,
+     * the signal and exception information, and the top frames of the crashed thread are written; the crashed
+     * thread's frames are not attributed to their binary images.
+     *
+     * The remaining threads and the binary images are never accessed. Combined with
+     * PLCrashReportDecodingOptionLazy, only the crashed thread's record is decoded (see
+     * PLCrashReport::crashedThread).
+     */
+    PLCrashReportTextFormatSummary = 2
 } PLCrashReportTextFormat;
 
+/**
+ * Text formatting options.
+ *
+ * @ingroup enums
+ */
+typedef NS_OPTIONS(NSUInteger, PLCrashReportTextFormatterOptions) {
+    /** Format symbol names as recorded in the report. */
+    PLCrashReportTextFormatterOptionNone = 0,
+
+    /**
+     * Demangle C++ and Swift symbol names. Demangled names are memoized in a bounded, process-wide cache shared
+     * by all formatters, and so the cost of demangling is paid once per unique symbol.
+     *
+     * The demanglers are resolved from the current process; C++ names are demangled if the C++ runtime is
+     * loaded, and Swift names if the Swift runtime is loaded. Names that can not be demangled are formatted as
+     * recorded.
+     */
+    PLCrashReportTextFormatterOptionDemangleSymbols = 1 << 0,
+};
+
 
 @interface PLCrashReportTextFormatter : NSObject <PLCrashReportFormatter> {
 @private
@@ -53,10 +92,29 @@ typedef enum {
 
     /** Encoding to use for string output. */
     NSStringEncoding _stringEncoding;
+
+    /** Formatting options. */
+    PLCrashReportTextFormatterOptions _options;
 }
 
 + (NSString *) stringValueForCrashReport: (PLCrashReport *) report withTextFormat: (PLCrashReportTextFormat) textFormat;
++ (NSString *) stringValueForCrashReport: (PLCrashReport *) report
+                          withTextFormat: (PLCrashReportTextFormat) textFormat
+                                 options: (PLCrashReportTextFormatterOptions) options;
+
++ (BOOL) writeCrashReport: (PLCrashReport *) report
+           withTextFormat: (PLCrashReportTextFormat) textFormat
+         toFileDescriptor: (int) fd
+                    error: (NSError **) outError;
++ (BOOL) writeCrashReport: (PLCrashReport *) report
+           withTextFormat: (PLCrashReportTextFormat) textFormat
+                  options: (PLCrashReportTextFormatterOptions) options
+         toFileDescriptor: (int) fd
+                    error: (NSError **) outError;
 
 - (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding;
+- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat
+           stringEncoding: (NSStringEncoding) stringEncoding
+                  options: (PLCrashReportTextFormatterOptions) options;
 
 @end
@@ -32,15 +32,151 @@
 #import "CrashReporter/CrashReporter.h"
 
 #import "PLCrashReportTextFormatter.h"
+#import "PLCrashSymbolDemangler.h"
+
+#import <unistd.h>
+#import <errno.h>
+#import <math.h>
+
+/**
+ * @internal
+ *
+ * A growable UTF-8 output buffer. If a file descriptor is provided, the buffer is flushed to the descriptor
+ * whenever it reaches PL_TEXT_BUFFER_FLUSH_SIZE.
+ */
+typedef struct pl_text_buffer {
+    /** Buffered data. */
+    uint8_t *data;
+
+    /** Number of bytes buffered. */
+    size_t length;
+
+    /** Allocated size of @a data. */
+    size_t capacity;
+
+    /** The output file descriptor, or -1 if output is only buffered. */
+    int fd;
+
+    /** The errno value of the first failed write or allocation, or 0. Once set, all further output is discarded. */
+    int error;
+} pl_text_buffer_t;
+
+/** Initial buffer capacity; sufficient for most reports without reallocation. */
+#define PL_TEXT_BUFFER_INITIAL_SIZE (64 * 1024)
+
+/** File descriptor output flush threshold. */
+#define PL_TEXT_BUFFER_FLUSH_SIZE (64 * 1024)
+
+/** The version of the JSON report layout, written as the report's "version" member. */
+#define PL_JSON_FORMAT_VERSION 1
+
+/** Maximum number of the crashed thread's frames written by the summary format. */
+#define PL_SUMMARY_FRAME_COUNT 16
+
+/** Maximum JSON object and array nesting depth supported by pl_json_writer_t. */
+#define PL_JSON_WRITER_MAX_DEPTH 64
+
+/**
+ * @internal
+ *
+ * A streaming JSON writer. Values are written directly to the output buffer as they are supplied; the writer
+ * only tracks whether each open object or array has been populated, so that member separators may be written.
+ */
+typedef struct pl_json_writer {
+    /** The output buffer. */
+    pl_text_buffer_t *buffer;
+
+    /** The number of open objects and arrays. */
+    uint32_t depth;
+
+    /** Bit n is set if the open object or array at depth n + 1 contains at least one member. */
+    uint64_t populated;
+} pl_json_writer_t;
+
+/**
+ * @internal
+ *
+ * Cached per-image formatting values.
+ */
+typedef struct pl_image_format_cache {
+    /** The UTF-8 encoded last path component of the image name. */
+    char *name;
+
+    /** Length of @a name, in bytes. */
+    size_t nameLength;
+
+    /** Length of the image name's last path component in UTF-16 characters, used for column padding. */
+    NSUInteger nameCharacters;
+} pl_image_format_cache_t;
 
 @interface PLCrashReportTextFormatter (PrivateAPI)
 NSInteger binaryImageSort(id binary1, id binary2, void *context);
-+ (NSString *) formatStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
-                     frameIndex: (NSUInteger) frameIndex
-                         report: (PLCrashReport *) report
-                           lp64: (BOOL) lp64;
++ (void) formatReport: (PLCrashReport *) report
+           textFormat: (PLCrashReportTextFormat) textFormat
+              options: (PLCrashReportTextFormatterOptions) options
+               buffer: (pl_text_buffer_t *) buffer;
++ (void) formatStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
+               frameIndex: (NSUInteger) frameIndex
+                   report: (PLCrashReport *) report
+                     lp64: (BOOL) lp64
+               imageCache: (CFMutableDictionaryRef) imageCache
+                demangler: (plcrash_demangle_cache_t *) demangler
+                   buffer: (pl_text_buffer_t *) buffer;
++ (void) formatSymbolForStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
+                            report: (PLCrashReport *) report
+                         demangler: (plcrash_demangle_cache_t *) demangler
+                            buffer: (pl_text_buffer_t *) buffer;
++ (void) formatSummaryReport: (PLCrashReport *) report
+                     options: (PLCrashReportTextFormatterOptions) options
+                      buffer: (pl_text_buffer_t *) buffer;
++ (void) formatJSONReport: (PLCrashReport *) report
+                  options: (PLCrashReportTextFormatterOptions) options
+                   buffer: (pl_text_buffer_t *) buffer;
++ (void) formatJSONStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
+                       report: (PLCrashReport *) report
+                 imageIndices: (CFDictionaryRef) imageIndices
+                    demangler: (plcrash_demangle_cache_t *) demangler
+                       writer: (pl_json_writer_t *) writer;
 @end
 
+static void pl_text_buffer_init (pl_text_buffer_t *buffer, int fd);
+static void pl_text_buffer_free (pl_text_buffer_t *buffer);
+static BOOL pl_text_buffer_flush (pl_text_buffer_t *buffer);
+static void pl_text_buffer_append (pl_text_buffer_t *buffer, const void *bytes, size_t length);
+static void pl_text_buffer_append_string (pl_text_buffer_t *buffer, NSString *string);
+static void pl_text_buffer_append_format (pl_text_buffer_t *buffer, NSString *format, ...) NS_FORMAT_FUNCTION(2,3);
+static void pl_text_buffer_append_padding (pl_text_buffer_t *buffer, size_t count);
+static void pl_text_buffer_append_hex (pl_text_buffer_t *buffer, uint64_t value, unsigned int width);
+static void pl_text_buffer_append_signed (pl_text_buffer_t *buffer, int64_t value);
+static void pl_text_buffer_append_address (pl_text_buffer_t *buffer, uint64_t value, unsigned int width);
+
+static void pl_json_writer_open (pl_json_writer_t *writer, const char *key, char opener);
+static void pl_json_writer_close (pl_json_writer_t *writer, char closer);
+static void pl_json_writer_cstring (pl_json_writer_t *writer, const char *key, const char *value);
+static void pl_json_writer_string (pl_json_writer_t *writer, const char *key, NSString *value);
+static void pl_json_writer_integer (pl_json_writer_t *writer, const char *key, int64_t value);
+static void pl_json_writer_address (pl_json_writer_t *writer, const char *key, uint64_t value);
+static void pl_json_writer_bool (pl_json_writer_t *writer, const char *key, BOOL value);
+static void pl_json_writer_double (pl_json_writer_t *writer, const char *key, double value);
+static void pl_json_writer_date (pl_json_writer_t *writer, const char *key, NSDate *date);
+
+static NSString *pl_report_code_type (PLCrashReport *report, boolean_t *lp64);
+static NSString *pl_report_machine_code_type (PLCrashReport *report, boolean_t *lp64);
+static const char *pl_image_arch_name (PLCrashReportBinaryImageInfo *imageInfo);
+
+static pl_image_format_cache_t *pl_image_format_cache_get (CFMutableDictionaryRef cache, PLCrashReportBinaryImageInfo *image);
+static void pl_image_format_cache_free (CFMutableDictionaryRef cache);
+
+static NSInteger pl_compare_thread_cpu_usage (id lhs, id rhs, void *context);
+static NSInteger pl_compare_region_resident_size (id lhs, id rhs, void *context);
+static NSString *pl_format_memory_size (uint64_t size);
+static NSString *pl_vm_region_tag_name (PLCrashReportMemoryRegionInfo *region);
+static NSString *pl_thread_run_state_name (PLCrashReportThreadRunState state);
+static NSString *pl_thread_qos_class_name (PLCrashReportThreadQoSClass qosClass);
+static NSString *pl_termination_reason_name (PLCrashReportTerminationReason reason);
+static const char *pl_report_type_name (PLCrashReportType type);
+static const char *pl_json_unwind_method_name (PLCrashReportUnwindMethod method);
+
 
 /**
  * Formats PLCrashReport data as human-readable text.
@@ -58,9 +194,179 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
  * @return Returns the formatted result on success, or nil if an error occurs.
  */
 + (NSString *) stringValueForCrashReport: (PLCrashReport *) report withTextFormat: (PLCrashReportTextFormat) textFormat {
-	NSMutableString* text = [NSMutableString string];
+    return [self stringValueForCrashReport: report withTextFormat: textFormat options: PLCrashReportTextFormatterOptionNone];
+}
+
+/**
+ * Formats the provided @a report as human-readable text in the given @a textFormat, using the given formatting
+ * @a options, and return the formatted result as a string.
+ *
+ * @param report The report to format.
+ * @param textFormat The text format to use.
+ * @param options The formatting options to use.
+ *
+ * @return Returns the formatted result on success, or nil if an error occurs.
+ */
++ (NSString *) stringValueForCrashReport: (PLCrashReport *) report
+                          withTextFormat: (PLCrashReportTextFormat) textFormat
+                                 options: (PLCrashReportTextFormatterOptions) options
+{
+    pl_text_buffer_t buffer;
+    NSString *result = nil;
+
+    pl_text_buffer_init(&buffer, -1);
+    [self formatReport: report textFormat: textFormat options: options buffer: &buffer];
+
+    if (buffer.error == 0)
+        result = [[[NSString alloc] initWithBytes: buffer.data length: buffer.length encoding: NSUTF8StringEncoding] autorelease];
+
+    pl_text_buffer_free(&buffer);
+    return result;
+}
+
+/**
+ * Formats the provided @a report as human-readable text in the given @a textFormat, writing the UTF-8 encoded
+ * result directly to @a fd.
+ *
+ * @param report The report to format.
+ * @param textFormat The text format to use.
+ * @param fd The file descriptor to which the formatted report will be written.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the report could
+ * not be written. If no error occurs, this parameter will be left unmodified. You may specify NULL for this parameter,
+ * and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if an error occurs.
+ */
++ (BOOL) writeCrashReport: (PLCrashReport *) report
+           withTextFormat: (PLCrashReportTextFormat) textFormat
+         toFileDescriptor: (int) fd
+                    error: (NSError **) outError
+{
+    return [self writeCrashReport: report withTextFormat: textFormat options: PLCrashReportTextFormatterOptionNone toFileDescriptor: fd error: outError];
+}
+
+/**
+ * Formats the provided @a report as human-readable text in the given @a textFormat, using the given formatting
+ * @a options, writing the UTF-8 encoded result directly to @a fd.
+ *
+ * @param report The report to format.
+ * @param textFormat The text format to use.
+ * @param options The formatting options to use.
+ * @param fd The file descriptor to which the formatted report will be written.
+ * @param outError If an error occurs, this pointer will contain an NSError object indicating why the report could
+ * not be written. If no error occurs, this parameter will be left unmodified. You may specify NULL for this parameter,
+ * and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if an error occurs.
+ */
++ (BOOL) writeCrashReport: (PLCrashReport *) report
+           withTextFormat: (PLCrashReportTextFormat) textFormat
+                  options: (PLCrashReportTextFormatterOptions) options
+         toFileDescriptor: (int) fd
+                    error: (NSError **) outError
+{
+    pl_text_buffer_t buffer;
+    BOOL result;
+
+    pl_text_buffer_init(&buffer, fd);
+    [self formatReport: report textFormat: textFormat options: options buffer: &buffer];
+    result = pl_text_buffer_flush(&buffer);
+
+    if (!result && outError != NULL) {
+        NSError *cause = [NSError errorWithDomain: NSPOSIXErrorDomain code: buffer.error userInfo: nil];
+        NSDictionary *userInfo = [NSDictionary dictionaryWithObjectsAndKeys:
+                                  NSLocalizedString(@"Could not write the formatted crash report", @"Report formatting error message"), NSLocalizedDescriptionKey,
+                                  cause, NSUnderlyingErrorKey,
+                                  nil];
+        *outError = [NSError errorWithDomain: PLCrashReporterErrorDomain code: PLCrashReporterErrorOperatingSystem userInfo: userInfo];
+    }
+
+    pl_text_buffer_free(&buffer);
+    return result;
+}
+
+/**
+ * Initialize with the request string encoding and output format.
+ *
+ * @param textFormat Format to use for the generated text crash report.
+ * @param stringEncoding Encoding to use when writing to the output stream.
+ */
+- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding {
+    return [self initWithTextFormat: textFormat stringEncoding: stringEncoding options: PLCrashReportTextFormatterOptionNone];
+}
+
+/**
+ * Initialize with the request string encoding, output format, and formatting options.
+ *
+ * @param textFormat Format to use for the generated text crash report.
+ * @param stringEncoding Encoding to use when writing to the output stream.
+ * @param options Formatting options to use for the generated text crash report.
+ */
+- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat
+           stringEncoding: (NSStringEncoding) stringEncoding
+                  options: (PLCrashReportTextFormatterOptions) options
+{
+    if ((self = [super init]) == nil)
+        return nil;
+    
+    _textFormat = textFormat;
+    _stringEncoding = stringEncoding;
+    _options = options;
+
+    return self;
+}
+
+// from PLCrashReportFormatter protocol
+- (NSData *) formatReport: (PLCrashReport *) report error: (NSError **) outError {
+    /* The formatter produces UTF-8 natively; avoid the round trip through NSString */
+    if (_stringEncoding == NSUTF8StringEncoding) {
+        pl_text_buffer_t buffer;
+        NSData *data = nil;
+
+        pl_text_buffer_init(&buffer, -1);
+        [PLCrashReportTextFormatter formatReport: report textFormat: _textFormat options: _options buffer: &buffer];
+        if (buffer.error == 0)
+            data = [NSData dataWithBytes: buffer.data length: buffer.length];
+
+        pl_text_buffer_free(&buffer);
+        return data;
+    }
+
+    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: _textFormat options: _options];
+    return [text dataUsingEncoding: _stringEncoding allowLossyConversion: YES];
+}
+		 
+@end
+
+
+@implementation PLCrashReportTextFormatter (PrivateMethods)
+
+/**
+ * Format @a report in @a textFormat with @a options, appending the result to @a buffer.
+ */
++ (void) formatReport: (PLCrashReport *) report
+           textFormat: (PLCrashReportTextFormat) textFormat
+              options: (PLCrashReportTextFormatterOptions) options
+               buffer: (pl_text_buffer_t *) buffer
+{
+    if (textFormat == PLCrashReportTextFormatJSON) {
+        [self formatJSONReport: report options: options buffer: buffer];
+        return;
+    } else if (textFormat == PLCrashReportTextFormatSummary) {
+        [self formatSummaryReport: report options: options buffer: buffer];
+        return;
+    }
+
 	boolean_t lp64 = true; // quiesce GCC uninitialized value warning
 
+    /* Per-image formatting values, keyed by (borrowed) PLCrashReportBinaryImageInfo references */
+    CFMutableDictionaryRef imageCache = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+
+    /* The shared demangle cache, if demangling is enabled (and the cache is available) */
+    plcrash_demangle_cache_t *demangler = NULL;
+    if (options & PLCrashReportTextFormatterOptionDemangleSymbols)
+        demangler = plcrash_demangle_cache_shared();
+
 	/* Header */
 	
     /* Map to apple style OS nane */
@@ -81,76 +387,7 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
     }
     
     /* Map to Apple-style code type, and mark whether architecture is LP64 (64-bit) */
-    NSString *codeType = nil;
-    {
-        /* Attempt to derive the code type from the binary images */
-        for (PLCrashReportBinaryImageInfo *image in report.images) {
-            /* Skip images with no specified type */
-            if (image.codeType == nil)
-                continue;
-
-            /* Skip unknown encodings */
-            if (image.codeType.typeEncoding != PLCrashReportProcessorTypeEncodingMach)
-                continue;
-            
-            switch (image.codeType.type) {
-                case CPU_TYPE_ARM:
-                    codeType = @"ARM";
-                    lp64 = false;
-                    break;
-
-                case CPU_TYPE_X86:
-                    codeType = @"X86";
-                    lp64 = false;
-                    break;
-
-                case CPU_TYPE_X86_64:
-                    codeType = @"X86-64";
-                    lp64 = true;
-                    break;
-
-                case CPU_TYPE_POWERPC:
-                    codeType = @"PPC";
-                    lp64 = false;
-                    break;
-                    
-                default:
-                    // Do nothing, handled below.
-                    break;
-            }
-
-            /* Stop immediately if code type was discovered */
-            if (codeType != nil)
-                break;
-        }
-
-        /* If we were unable to determine the code type, fall back on the legacy architecture value. */
-        if (codeType == nil) {
-            switch (report.systemInfo.architecture) {
-                case PLCrashReportArchitectureARMv6:
-                case PLCrashReportArchitectureARMv7:
-                    codeType = @"ARM";
-                    lp64 = false;
-                    break;
-                case PLCrashReportArchitectureX86_32:
-                    codeType = @"X86";
-                    lp64 = false;
-                    break;
-                case PLCrashReportArchitectureX86_64:
-                    codeType = @"X86-64";
-                    lp64 = true;
-                    break;
-                case PLCrashReportArchitecturePPC:
-                    codeType = @"PPC";
-                    lp64 = false;
-                    break;
-                default:
-                    codeType = [NSString stringWithFormat: @"Unknown (%d)", report.systemInfo.architecture];
-                    lp64 = true;
-                    break;
-            }
-        }
-    }
+    NSString *codeType = pl_report_code_type(report, &lp64);
 
     {
         NSString *hardwareModel = @"???";
@@ -163,9 +400,9 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
             [incidentIdentifier autorelease];
         }
     
-        [text appendFormat: @"Incident Identifier: %@\n", incidentIdentifier];
-        [text appendFormat: @"CrashReporter Key:   TODO\n"];
-        [text appendFormat: @"Hardware Model:      %@\n", hardwareModel];
+        pl_text_buffer_append_format(buffer, @"Incident Identifier: %@\n", incidentIdentifier);
+        pl_text_buffer_append_format(buffer, @"CrashReporter Key:   TODO\n");
+        pl_text_buffer_append_format(buffer, @"Hardware Model:      %@\n", hardwareModel);
     }
     
     /* Application and process info */
@@ -199,15 +436,15 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
             parentProcessId = [[NSNumber numberWithUnsignedInteger: report.processInfo.parentProcessID] stringValue];
         }
         
-        [text appendFormat: @"Process:         %@ [%@]\n", processName, processId];
-        [text appendFormat: @"Path:            %@\n", processPath];
-        [text appendFormat: @"Identifier:      %@\n", report.applicationInfo.applicationIdentifier];
-        [text appendFormat: @"Version:         %@\n", report.applicationInfo.applicationVersion];
-        [text appendFormat: @"Code Type:       %@\n", codeType];
-        [text appendFormat: @"Parent Process:  %@ [%@]\n", parentProcessName, parentProcessId];
+        pl_text_buffer_append_format(buffer, @"Process:         %@ [%@]\n", processName, processId);
+        pl_text_buffer_append_format(buffer, @"Path:            %@\n", processPath);
+        pl_text_buffer_append_format(buffer, @"Identifier:      %@\n", report.applicationInfo.applicationIdentifier);
+        pl_text_buffer_append_format(buffer, @"Version:         %@\n", report.applicationInfo.applicationVersion);
+        pl_text_buffer_append_format(buffer, @"Code Type:       %@\n", codeType);
+        pl_text_buffer_append_format(buffer, @"Parent Process:  %@ [%@]\n", parentProcessName, parentProcessId);
     }
     
-    [text appendString: @"\n"];
+    pl_text_buffer_append_string(buffer, @"\n");
     
     /* System info */
     {
@@ -215,33 +452,61 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
         if (report.systemInfo.operatingSystemBuild != nil)
             osBuild = report.systemInfo.operatingSystemBuild;
         
-        [text appendFormat: @"Date/Time:       %@\n", report.systemInfo.timestamp];
-        [text appendFormat: @"OS Version:      %@ %@ (%@)\n", osName, report.systemInfo.operatingSystemVersion, osBuild];
-        [text appendFormat: @"Report Version:  104\n"];        
+        pl_text_buffer_append_format(buffer, @"Date/Time:       %@\n", report.systemInfo.timestamp);
+        pl_text_buffer_append_format(buffer, @"OS Version:      %@ %@ (%@)\n", osName, report.systemInfo.operatingSystemVersion, osBuild);
+        pl_text_buffer_append_format(buffer, @"Report Version:  104\n");
     }
 
-    [text appendString: @"\n"];
+    pl_text_buffer_append_string(buffer, @"\n");
 
     /* Exception code */
-    [text appendFormat: @"Exception Type:  %@\n", report.signalInfo.name];
-    [text appendFormat: @"Exception Codes: %@ at 0x%" PRIx64 "\n", report.signalInfo.code, report.signalInfo.address];
+    pl_text_buffer_append_format(buffer, @"Exception Type:  %@\n", report.signalInfo.name);
+    pl_text_buffer_append_format(buffer, @"Exception Codes: %@ at 0x%" PRIx64 "\n", report.signalInfo.code, report.signalInfo.address);
+
+#ifdef EXC_RESOURCE
+    /* Resource reports are written for non-fatal EXC_RESOURCE exceptions; the resource type is encoded in the
+     * top three bits of the first code. */
+    if (report.machExceptionInfo != nil && report.machExceptionInfo.type == EXC_RESOURCE && [report.machExceptionInfo.codes count] > 0) {
+        static NSString *resourceNames[] = { nil, @"CPU", @"WAKEUPS", @"MEMORY", @"IO", @"THREADS", nil, nil };
+        uint64_t code = [[report.machExceptionInfo.codes objectAtIndex: 0] unsignedLongLongValue];
+        NSString *resource = resourceNames[(code >> 61) & 0x7];
+        if (resource == nil)
+            resource = @"UNKNOWN";
+
+        pl_text_buffer_append_format(buffer, @"Exception Note:  EXC_RESOURCE -> %@ (NON-FATAL CONDITION)\n", resource);
+    }
+#endif
+
+    /* Synthesized reports describe a termination that could not be reported by the terminated process */
+    if (report.terminationInfo != nil) {
+        PLCrashReportTerminationInfo *termination = report.terminationInfo;
+
+        pl_text_buffer_append_format(buffer, @"Exception Note:  %@ (INFERRED ON NEXT LAUNCH)\n", pl_termination_reason_name(termination.reason));
+        pl_text_buffer_append_format(buffer, @"Terminated PID:  %lu\n", (unsigned long) termination.processID);
+        if (termination.launchDate != nil)
+            pl_text_buffer_append_format(buffer, @"Launch Time:     %@\n", termination.launchDate);
+        pl_text_buffer_append_format(buffer, @"App State:       %@%@\n", termination.foreground ? @"foreground" : @"background",
+                                     termination.receivedMemoryWarning ? @", memory warning received" : @"");
+        if (termination.footprint != 0)
+            pl_text_buffer_append_format(buffer, @"Last Footprint:  %@ at %@\n", pl_format_memory_size(termination.footprint), termination.footprintDate);
+    }
     
     for (PLCrashReportThreadInfo *thread in report.threads) {
         if (thread.crashed) {
-            [text appendFormat: @"Crashed Thread:  %ld\n", (long) thread.threadNumber];
+            pl_text_buffer_append_format(buffer, @"Crashed Thread:  %ld\n", (long) thread.threadNumber);
             break;
         }
     }
     
-    [text appendString: @"\n"];
+    pl_text_buffer_append_string(buffer, @"\n");
     
     /* Uncaught Exception */
     if (report.hasExceptionInfo) {
-        [text appendFormat: @"Application Specific Information:\n"];
-        [text appendFormat: @"*** Terminating app due to uncaught exception '%@', reason: '%@'\n",
-                report.exceptionInfo.exceptionName, report.exceptionInfo.exceptionReason];
+        pl_text_buffer_append_format(buffer, @"Application Specific Information:\n");
+        pl_text_buffer_append_format(buffer, @"*** Terminating app due to uncaught exception '%@', reason: '%@'\n",
+                report.exceptionInfo.exceptionName, report.exceptionInfo.exceptionReason);
         
-        [text appendString: @"\n"];
+        pl_text_buffer_append_string(buffer, @"\n");
     }
 
     /* If an exception stack trace is available, output an Apple-compatible backtrace. */
@@ -249,51 +514,88 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
         PLCrashReportExceptionInfo *exception = report.exceptionInfo;
         
         /* Create the header. */
-        [text appendString: @"Last Exception Backtrace:\n"];
+        pl_text_buffer_append_string(buffer, @"Last Exception Backtrace:\n");
 
         /* Write out the frames. In raw reports, Apple writes this out as a simple list of PCs. In the minimally
          * post-processed report, Apple writes this out as full frame entries. We use the latter format. */
         for (NSUInteger frame_idx = 0; frame_idx < [exception.stackFrames count]; frame_idx++) {
             PLCrashReportStackFrameInfo *frameInfo = [exception.stackFrames objectAtIndex: frame_idx];
-            [text appendString: [self formatStackFrame: frameInfo frameIndex: frame_idx report: report lp64: lp64]];
+            [self formatStackFrame: frameInfo frameIndex: frame_idx report: report lp64: lp64 imageCache: imageCache demangler: demangler buffer: buffer];
         }
-        [text appendString: @"\n"];
+        pl_text_buffer_append_string(buffer, @"\n");
+    }
+
+    /* Threads with recorded CPU usage, busiest first */
+    NSMutableArray *busyThreads = [NSMutableArray array];
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        if (thread.schedulingInfo != nil && thread.schedulingInfo.cpuUsage > 0)
+            [busyThreads addObject: thread];
+    }
+
+    if ([busyThreads count] > 0) {
+        [busyThreads sortUsingFunction: pl_compare_thread_cpu_usage context: NULL];
+
+        pl_text_buffer_append_string(buffer, @"Threads by CPU Usage:\n");
+        for (PLCrashReportThreadInfo *thread in busyThreads)
+            pl_text_buffer_append_format(buffer, @"Thread %ld:  %.1f%%\n", (long) thread.threadNumber, thread.schedulingInfo.cpuUsage * 100.0);
+        pl_text_buffer_append_string(buffer, @"\n");
     }
 
     /* Threads */
     PLCrashReportThreadInfo *crashed_thread = nil;
     NSInteger maxThreadNum = 0;
     for (PLCrashReportThreadInfo *thread in report.threads) {
+        /* Scheduling state, if recorded */
+        PLCrashReportThreadSchedulingInfo *sched = thread.schedulingInfo;
+        if (sched != nil) {
+            if (sched.name != nil)
+                pl_text_buffer_append_format(buffer, @"Thread %ld name:  %@\n", (long) thread.threadNumber, sched.name);
+
+            pl_text_buffer_append_format(buffer, @"Thread %ld state:  %@, cpu %.1f%%, user %.3fs, system %.3fs",
+                                         (long) thread.threadNumber, pl_thread_run_state_name(sched.runState),
+                                         sched.cpuUsage * 100.0, sched.userTime, sched.systemTime);
+            if (sched.hasQoSClass)
+                pl_text_buffer_append_format(buffer, @", qos %@", pl_thread_qos_class_name(sched.qosClass));
+            if (sched.hasPriority)
+                pl_text_buffer_append_format(buffer, @", priority %ld", (long) sched.currentPriority);
+            pl_text_buffer_append_string(buffer, @"\n");
+        }
+
         if (thread.crashed) {
-            [text appendFormat: @"Thread %ld Crashed:\n", (long) thread.threadNumber];
+            pl_text_buffer_append_format(buffer, @"Thread %ld Crashed:\n", (long) thread.threadNumber);
             crashed_thread = thread;
         } else {
-            [text appendFormat: @"Thread %ld:\n", (long) thread.threadNumber];
+            pl_text_buffer_append_format(buffer, @"Thread %ld:\n", (long) thread.threadNumber);
         }
+        /* Frames are numbered by their depth, including any repeated or omitted frames that were not written */
+        NSUInteger depth = 0;
         for (NSUInteger frame_idx = 0; frame_idx < [thread.stackFrames count]; frame_idx++) {
             PLCrashReportStackFrameInfo *frameInfo = [thread.stackFrames objectAtIndex: frame_idx];
-            [text appendString: [self formatStackFrame: frameInfo frameIndex: frame_idx report: report lp64: lp64]];
+            [self formatStackFrame: frameInfo frameIndex: depth++ report: report lp64: lp64 imageCache: imageCache demangler: demangler buffer: buffer];
+
+            if (frameInfo.repeatLength > 0 && frameInfo.repeatCount > 0) {
+                pl_text_buffer_append_format(buffer, @"... %lu frames repeated %lu more times ...\n",
+                                             (unsigned long) frameInfo.repeatLength, (unsigned long) frameInfo.repeatCount);
+                depth += frameInfo.repeatLength * frameInfo.repeatCount;
+            }
+
+            if (frameInfo.omittedFrameCount > 0) {
+                pl_text_buffer_append_format(buffer, @"... %lu frames omitted ...\n", (unsigned long) frameInfo.omittedFrameCount);
+                depth += frameInfo.omittedFrameCount;
+            }
         }
-        [text appendString: @"\n"];
+        pl_text_buffer_append_string(buffer, @"\n");
 
         /* Track the highest thread number */
         maxThreadNum = MAX(maxThreadNum, thread.threadNumber);
     }
 
-    /* Registers */
-    if (crashed_thread != nil) {
-        [text appendFormat: @"Thread %ld crashed with %@ Thread State:\n", (long) crashed_thread.threadNumber, codeType];
+    /* Registers. The stalled thread of a watchdog report has not crashed, and its register state is of no interest. */
+    if (crashed_thread != nil && report.reportType != PLCrashReportTypeWatchdog) {
+        pl_text_buffer_append_format(buffer, @"Thread %ld crashed with %@ Thread State:\n", (long) crashed_thread.threadNumber, codeType);
         
         int regColumn = 0;
         for (PLCrashReportRegisterInfo *reg in crashed_thread.registers) {
-            NSString *reg_fmt;
-            
-            /* Use 32-bit or 64-bit fixed width format for the register values */
-            if (lp64)
-                reg_fmt = @"%6s: 0x%016" PRIx64 " ";
-            else
-                reg_fmt = @"%6s: 0x%08" PRIx64 " ";
-            
             /* Remap register names to match Apple's crash reports */
             NSString *regName = reg.registerName;
             if (report.machineInfo != nil && report.machineInfo.processorInfo.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
@@ -305,23 +607,32 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
                     regName = @"ip";
                 }
             }
-            [text appendFormat: reg_fmt, [regName UTF8String], reg.registerValue];
+
+            /* "%6s: 0x%016" PRIx64 " ", using a 32-bit or 64-bit fixed width format for the register values */
+            const char *regNameBytes = [regName UTF8String];
+            size_t regNameLength = strlen(regNameBytes);
+            if (regNameLength < 6)
+                pl_text_buffer_append_padding(buffer, 6 - regNameLength);
+            pl_text_buffer_append(buffer, regNameBytes, regNameLength);
+            pl_text_buffer_append(buffer, ": 0x", 4);
+            pl_text_buffer_append_hex(buffer, reg.registerValue, lp64 ? 16 : 8);
+            pl_text_buffer_append(buffer, " ", 1);
 
             regColumn++;
             if (regColumn == 4) {
-                [text appendString: @"\n"];
+                pl_text_buffer_append_string(buffer, @"\n");
                 regColumn = 0;
             }
         }
         
         if (regColumn != 0)
-            [text appendString: @"\n"];
+            pl_text_buffer_append_string(buffer, @"\n");
         
-        [text appendString: @"\n"];
+        pl_text_buffer_append_string(buffer, @"\n");
     }
     
     /* Images. The iPhone crash report format sorts these in ascending order, by the base address */
-    [text appendString: @"Binary Images:\n"];
+    pl_text_buffer_append_string(buffer, @"Binary Images:\n");
     for (PLCrashReportBinaryImageInfo *imageInfo in [report.images sortedArrayUsingFunction: binaryImageSort context: nil]) {
         NSString *uuid;
         /* Fetch the UUID if it exists */
@@ -331,182 +642,1452 @@ NSInteger binaryImageSort(id binary1, id binary2, void *context);
             uuid = @"???";
         
         /* Determine the architecture string */
-        NSString *archName = @"???";
-        if (imageInfo.codeType != nil && imageInfo.codeType.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
-            switch (imageInfo.codeType.type) {
-                case CPU_TYPE_ARM:
-                    /* Apple includes subtype for ARM binaries. */
-                    switch (imageInfo.codeType.subtype) {
-                        case CPU_SUBTYPE_ARM_V6:
-                            archName = @"armv6";
-                            break;
-
-                        case CPU_SUBTYPE_ARM_V7:
-                            archName = @"armv7";
-                            break;
-                            
-                        case CPU_SUBTYPE_ARM_V7S:
-                            archName = @"armv7s";
-                            break;
-
-                        default:
-                            archName = @"arm-unknown";
-                            break;
-                    }
-                    break;
-                    
-                case CPU_TYPE_X86:
-                    archName = @"i386";
-                    break;
-                    
-                case CPU_TYPE_X86_64:
-                    archName = @"x86_64";
-                    break;
-
-                case CPU_TYPE_POWERPC:
-                    archName = @"powerpc";
-                    break;
-
-                default:
-                    // Use the default archName value (initialized above).
-                    break;
-            }
-        }
+        const char *archName = pl_image_arch_name(imageInfo);
 
         /* Determine if this is the main executable */
-        NSString *binaryDesignator = @" ";
+        const char *binaryDesignator = " ";
         if ([imageInfo.imageName isEqual: report.processInfo.processPath])
-            binaryDesignator = @"+";
+            binaryDesignator = "+";
         
-        /* base_address - terminating_address [designator]file_name arch <uuid> file_path */
-        NSString *fmt = nil;
-        if (lp64) {
-            fmt = @"%18#" PRIx64 " - %18#" PRIx64 " %@%@ %@  <%@> %@\n";
-        } else {
-            fmt = @"%10#" PRIx64 " - %10#" PRIx64 " %@%@ %@  <%@> %@\n";
-        }
+        /* base_address - terminating_address [designator]file_name arch <uuid> file_path
+         *
+         * This is equivalent to "%18#" PRIx64 " - %18#" PRIx64 " %@%@ %@  <%@> %@\n" (or %10# for 32-bit
+         * reports). The Apple format uses an inclusive range. */
+        pl_image_format_cache_t *cached = pl_image_format_cache_get(imageCache, imageInfo);
+        unsigned int addressWidth = lp64 ? 18 : 10;
 
-        [text appendFormat: fmt,
-                            imageInfo.imageBaseAddress,
-                            imageInfo.imageBaseAddress + (MAX(1, imageInfo.imageSize) - 1), // The Apple format uses an inclusive range
-                            binaryDesignator,
-                            [imageInfo.imageName lastPathComponent],
-                            archName,
-                            uuid,
-                            imageInfo.imageName];
+        pl_text_buffer_append_address(buffer, imageInfo.imageBaseAddress, addressWidth);
+        pl_text_buffer_append(buffer, " - ", 3);
+        pl_text_buffer_append_address(buffer, imageInfo.imageBaseAddress + (MAX(1, imageInfo.imageSize) - 1), addressWidth);
+        pl_text_buffer_append(buffer, " ", 1);
+        pl_text_buffer_append(buffer, binaryDesignator, 1);
+        if (cached != NULL)
+            pl_text_buffer_append(buffer, cached->name, cached->nameLength);
+        pl_text_buffer_append(buffer, " ", 1);
+        pl_text_buffer_append(buffer, archName, strlen(archName));
+        pl_text_buffer_append(buffer, "  <", 3);
+        pl_text_buffer_append_string(buffer, uuid);
+        pl_text_buffer_append(buffer, "> ", 2);
+        pl_text_buffer_append_string(buffer, imageInfo.imageName);
+        pl_text_buffer_append(buffer, "\n", 1);
     }
-    
-
-    return text;
-}
 
-/**
- * Initialize with the request string encoding and output format.
- *
- * @param textFormat Format to use for the generated text crash report.
- * @param stringEncoding Encoding to use when writing to the output stream.
- */
-- (id) initWithTextFormat: (PLCrashReportTextFormat) textFormat stringEncoding: (NSStringEncoding) stringEncoding {
-    if ((self = [super init]) == nil)
-        return nil;
-    
-    _textFormat = textFormat;
-    _stringEncoding = stringEncoding;
+    /* Memory usage, with the VM regions ordered by descending resident size */
+    if (report.memoryInfo != nil) {
+        PLCrashReportMemoryInfo *memory = report.memoryInfo;
 
-    return self;
-}
+        pl_text_buffer_append_string(buffer, @"\nVM Region Summary:\n");
+        if (memory.hasPhysicalFootprint)
+            pl_text_buffer_append_format(buffer, @"Physical footprint:  %@\n", pl_format_memory_size(memory.physicalFootprint));
+        pl_text_buffer_append_format(buffer, @"Resident size:       %@ (peak %@)\n", pl_format_memory_size(memory.residentSize), pl_format_memory_size(memory.peakResidentSize));
+        pl_text_buffer_append_format(buffer, @"Compressed size:     %@\n", pl_format_memory_size(memory.compressedSize));
+        pl_text_buffer_append_format(buffer, @"Virtual size:        %@\n", pl_format_memory_size(memory.virtualSize));
 
-// from PLCrashReportFormatter protocol
-- (NSData *) formatReport: (PLCrashReport *) report error: (NSError **) outError {
-    NSString *text = [PLCrashReportTextFormatter stringValueForCrashReport: report withTextFormat: _textFormat];
-    return [text dataUsingEncoding: _stringEncoding allowLossyConversion: YES];
-}
-		 
-@end
+        if ([memory.regions count] > 0) {
+            pl_text_buffer_append_format(buffer, @"\n%-28s %10s %10s %10s %10s %8s\n", "REGION TYPE", "VIRTUAL", "RESIDENT", "DIRTY", "SWAPPED", "COUNT");
+            for (PLCrashReportMemoryRegionInfo *region in [memory.regions sortedArrayUsingFunction: pl_compare_region_resident_size context: NULL]) {
+                pl_text_buffer_append_format(buffer, @"%-28s %10s %10s %10s %10s %8u\n",
+                                             [pl_vm_region_tag_name(region) UTF8String],
+                                             [pl_format_memory_size(region.virtualSize) UTF8String],
+                                             [pl_format_memory_size(region.residentSize) UTF8String],
+                                             [pl_format_memory_size(region.dirtySize) UTF8String],
+                                             [pl_format_memory_size(region.swappedSize) UTF8String],
+                                             region.regionCount);
+            }
+        }
 
+        if (memory.regionsTruncated)
+            pl_text_buffer_append_string(buffer, @"(region summary truncated)\n");
+    }
 
-@implementation PLCrashReportTextFormatter (PrivateMethods)
+    pl_image_format_cache_free(imageCache);
+}
 
 /**
- * Format a stack frame for display in a thread backtrace.
+ * Format a stack frame for display in a thread backtrace, appending the formatted frame line to @a buffer.
  *
  * @param frameInfo The stack frame to format
  * @param frameIndex The frame's index
  * @param report The report from which this frame was acquired.
  * @param lp64 If YES, the report was generated by an LP64 system.
- *
- * @return Returns a formatted frame line.
+ * @param imageCache The per-image formatting cache.
+ * @param demangler The demangle cache to be used to demangle symbol names, or NULL to disable demangling.
+ * @param buffer The output buffer.
  */
-+ (NSString *) formatStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
-                     frameIndex: (NSUInteger) frameIndex
-                         report: (PLCrashReport *) report
-                           lp64: (BOOL) lp64
++ (void) formatStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
+               frameIndex: (NSUInteger) frameIndex
+                   report: (PLCrashReport *) report
+                     lp64: (BOOL) lp64
+               imageCache: (CFMutableDictionaryRef) imageCache
+                demangler: (plcrash_demangle_cache_t *) demangler
+                   buffer: (pl_text_buffer_t *) buffer
 {
     /* Base image address containing instrumention pointer, offset of the IP from that base
      * address, and the associated image name */
     uint64_t baseAddress = 0x0;
     uint64_t pcOffset = 0x0;
-    NSString *imageName = @"\?\?\?";
-    NSString *symbolString = nil;
+    const char *imageName = "???";
+    size_t imageNameLength = 3;
+    NSUInteger imageNameCharacters = 3;
     
     PLCrashReportBinaryImageInfo *imageInfo = [report imageForAddress: frameInfo.instructionPointer];
     if (imageInfo != nil) {
-        imageName = [imageInfo.imageName lastPathComponent];
+        pl_image_format_cache_t *cached = pl_image_format_cache_get(imageCache, imageInfo);
+        if (cached != NULL) {
+            imageName = cached->name;
+            imageNameLength = cached->nameLength;
+            imageNameCharacters = cached->nameCharacters;
+        }
         baseAddress = imageInfo.imageBaseAddress;
         pcOffset = frameInfo.instructionPointer - imageInfo.imageBaseAddress;
     }
 
+    /* Equivalent to "%-4ld%-35S 0x%0*" PRIx64 " ". The name column is padded by character count, matching the
+     * UTF-16 %S formatting used by earlier releases. */
+    char frameNumber[24];
+    int indexLength = snprintf(frameNumber, sizeof(frameNumber), "%ld", (long) frameIndex);
+    pl_text_buffer_append(buffer, frameNumber, indexLength);
+    if (indexLength < 4)
+        pl_text_buffer_append_padding(buffer, 4 - indexLength);
+
+    pl_text_buffer_append(buffer, imageName, imageNameLength);
+    if (imageNameCharacters < 35)
+        pl_text_buffer_append_padding(buffer, 35 - imageNameCharacters);
+
+    pl_text_buffer_append(buffer, " 0x", 3);
+    pl_text_buffer_append_hex(buffer, frameInfo.instructionPointer, lp64 ? 16 : 8);
+    pl_text_buffer_append(buffer, " ", 1);
+
     /* If symbol info is available, the format used in Apple's reports is Sym + OffsetFromSym. Otherwise,
      * the format used is imageBaseAddress + offsetToIP */
     if (frameInfo.symbolInfo != nil) {
-        NSString *symbolName = frameInfo.symbolInfo.symbolName;
+        [self formatSymbolForStackFrame: frameInfo report: report demangler: demangler buffer: buffer];
+    } else {
+        pl_text_buffer_append(buffer, "0x", 2);
+        pl_text_buffer_append_hex(buffer, baseAddress, 0);
+        pl_text_buffer_append(buffer, " + ", 3);
+        pl_text_buffer_append_signed(buffer, pcOffset);
+    }
 
-        /* Apple strips the _ symbol prefix in their reports. Only OS X makes use of an
-         * underscore symbol prefix by default. */
-        if ([symbolName rangeOfString: @"_"].location == 0 && [symbolName length] > 1) {
-            switch (report.systemInfo.operatingSystem) {
-                case PLCrashReportOperatingSystemMacOSX:
-                case PLCrashReportOperatingSystemiPhoneOS:
-                case PLCrashReportOperatingSystemiPhoneSimulator:
-                    symbolName = [symbolName substringFromIndex: 1];
-                    break;
-
-                default:
-                    NSLog(@"Symbol prefix rules are unknown for this OS!");
-                    break;
-            }
+    pl_text_buffer_append(buffer, "\n", 1);
+}
+
+/**
+ * Format the symbol name of @a frameInfo and the frame's offset from the symbol start, appending the result to
+ * @a buffer. The frame must have symbol info.
+ *
+ * @param frameInfo The stack frame.
+ * @param report The report from which this frame was acquired.
+ * @param demangler The demangle cache to be used to demangle symbol names, or NULL to disable demangling.
+ * @param buffer The output buffer.
+ */
++ (void) formatSymbolForStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
+                            report: (PLCrashReport *) report
+                         demangler: (plcrash_demangle_cache_t *) demangler
+                            buffer: (pl_text_buffer_t *) buffer
+{
+    NSString *symbolName = frameInfo.symbolInfo.symbolName;
+
+    /* Apple strips the _ symbol prefix in their reports. Only OS X makes use of an
+     * underscore symbol prefix by default. */
+    if ([symbolName rangeOfString: @"_"].location == 0 && [symbolName length] > 1) {
+        switch (report.systemInfo.operatingSystem) {
+            case PLCrashReportOperatingSystemMacOSX:
+            case PLCrashReportOperatingSystemiPhoneOS:
+            case PLCrashReportOperatingSystemiPhoneSimulator:
+                symbolName = [symbolName substringFromIndex: 1];
+                break;
+
+            default:
+                NSLog(@"Symbol prefix rules are unknown for this OS!");
+                break;
         }
-        
-        
-        uint64_t symOffset = frameInfo.instructionPointer - frameInfo.symbolInfo.startAddress;
-        symbolString = [NSString stringWithFormat: @"%@ + %" PRId64, symbolName, symOffset];
-    } else {
-        symbolString = [NSString stringWithFormat: @"0x%" PRIx64 " + %" PRId64, baseAddress, pcOffset];
     }
 
-    /* Note that width specifiers are ignored for %@, but work for C strings.
-     * UTF-8 is not correctly handled with %s (it depends on the system encoding), but
-     * UTF-16 is supported via %S, so we use it here */
-    return [NSString stringWithFormat: @"%-4ld%-35S 0x%0*" PRIx64 " %@\n",
-            (long) frameIndex,
-            (const uint16_t *)[imageName cStringUsingEncoding: NSUTF16StringEncoding],
-            lp64 ? 16 : 8, frameInfo.instructionPointer,
-            symbolString];
+    uint64_t symOffset = frameInfo.instructionPointer - frameInfo.symbolInfo.startAddress;
+
+    /* Demangled names are appended directly, avoiding an intermediate NSString */
+    char *demangled = NULL;
+    if (demangler != NULL) {
+        const char *utf8 = [symbolName UTF8String];
+        if (utf8 != NULL && plcrash_demangle_is_mangled(utf8))
+            demangled = plcrash_demangle_cache_copy(demangler, utf8);
+    }
+
+    if (demangled != NULL) {
+        pl_text_buffer_append(buffer, demangled, strlen(demangled));
+        free(demangled);
+    } else {
+        pl_text_buffer_append_string(buffer, symbolName);
+    }
+    pl_text_buffer_append(buffer, " + ", 3);
+    pl_text_buffer_append_signed(buffer, symOffset);
 }
 
 /**
- * Sort PLCrashReportBinaryImageInfo instances by their starting address.
+ * Format a summary of @a report with @a options, appending the result to @a buffer. Only the report's header,
+ * signal, exception and crashed thread are formatted; the remaining threads and the binary images are not
+ * accessed, and so are never decoded by a lazily decoded report.
  */
-NSInteger binaryImageSort(id binary1, id binary2, void *context) {
-    uint64_t addr1 = [binary1 imageBaseAddress];
-    uint64_t addr2 = [binary2 imageBaseAddress];
-    
-    if (addr1 < addr2)
-        return NSOrderedAscending;
-    else if (addr1 > addr2)
-        return NSOrderedDescending;
-    else
-        return NSOrderedSame;
++ (void) formatSummaryReport: (PLCrashReport *) report
+                     options: (PLCrashReportTextFormatterOptions) options
+                      buffer: (pl_text_buffer_t *) buffer
+{
+    boolean_t lp64 = true;
+
+    /* The shared demangle cache, if demangling is enabled (and the cache is available) */
+    plcrash_demangle_cache_t *demangler = NULL;
+    if (options & PLCrashReportTextFormatterOptionDemangleSymbols)
+        demangler = plcrash_demangle_cache_shared();
+
+    /* The code type must be determined without reference to the binary images */
+    NSString *codeType = pl_report_machine_code_type(report, &lp64);
+
+    /* Header */
+    NSString *incidentIdentifier = @"???";
+    if (report.uuidRef != NULL) {
+        incidentIdentifier = (NSString *) CFUUIDCreateString(NULL, report.uuidRef);
+        [incidentIdentifier autorelease];
+    }
+
+    pl_text_buffer_append_format(buffer, @"Incident Identifier: %@\n", incidentIdentifier);
+    if (report.hasProcessInfo && report.processInfo.processName != nil)
+        pl_text_buffer_append_format(buffer, @"Process:         %@ [%lu]\n", report.processInfo.processName, (unsigned long) report.processInfo.processID);
+    pl_text_buffer_append_format(buffer, @"Identifier:      %@\n", report.applicationInfo.applicationIdentifier);
+    pl_text_buffer_append_format(buffer, @"Version:         %@\n", report.applicationInfo.applicationVersion);
+    pl_text_buffer_append_format(buffer, @"Code Type:       %@\n", codeType);
+    pl_text_buffer_append_format(buffer, @"Date/Time:       %@\n", report.systemInfo.timestamp);
+    pl_text_buffer_append_format(buffer, @"OS Version:      %@ (%@)\n", report.systemInfo.operatingSystemVersion,
+                                 report.systemInfo.operatingSystemBuild != nil ? report.systemInfo.operatingSystemBuild : @"???");
+    pl_text_buffer_append_string(buffer, @"\n");
+
+    /* Exception code */
+    pl_text_buffer_append_format(buffer, @"Exception Type:  %@\n", report.signalInfo.name);
+    pl_text_buffer_append_format(buffer, @"Exception Codes: %@ at 0x%" PRIx64 "\n", report.signalInfo.code, report.signalInfo.address);
+
+    PLCrashReportThreadInfo *crashedThread = report.crashedThread;
+    if (crashedThread != nil)
+        pl_text_buffer_append_format(buffer, @"Crashed Thread:  %ld\n", (long) crashedThread.threadNumber);
+    pl_text_buffer_append_string(buffer, @"\n");
+
+    /* Uncaught Exception */
+    if (report.hasExceptionInfo) {
+        pl_text_buffer_append_format(buffer, @"Application Specific Information:\n");
+        pl_text_buffer_append_format(buffer, @"*** Terminating app due to uncaught exception '%@', reason: '%@'\n",
+                                     report.exceptionInfo.exceptionName, report.exceptionInfo.exceptionReason);
+        pl_text_buffer_append_string(buffer, @"\n");
+    }
+
+    if (crashedThread == nil)
+        return;
+
+    /* The top frames of the crashed thread. Frames are not attributed to their images, as that requires the
+     * binary images to be decoded. */
+    pl_text_buffer_append_format(buffer, @"Thread %ld Crashed:\n", (long) crashedThread.threadNumber);
+
+    NSArray *frames = crashedThread.stackFrames;
+    NSUInteger frameCount = MIN([frames count], (NSUInteger) PL_SUMMARY_FRAME_COUNT);
+    for (NSUInteger frame_idx = 0; frame_idx < frameCount; frame_idx++) {
+        PLCrashReportStackFrameInfo *frameInfo = [frames objectAtIndex: frame_idx];
+
+        /* Equivalent to "%-4ld0x%0*" PRIx64 " " */
+        char frameNumber[24];
+        int indexLength = snprintf(frameNumber, sizeof(frameNumber), "%lu", (unsigned long) frame_idx);
+        pl_text_buffer_append(buffer, frameNumber, indexLength);
+        if (indexLength < 4)
+            pl_text_buffer_append_padding(buffer, 4 - indexLength);
+
+        pl_text_buffer_append(buffer, "0x", 2);
+        pl_text_buffer_append_hex(buffer, frameInfo.instructionPointer, lp64 ? 16 : 8);
+        if (frameInfo.symbolInfo != nil) {
+            pl_text_buffer_append(buffer, " ", 1);
+            [self formatSymbolForStackFrame: frameInfo report: report demangler: demangler buffer: buffer];
+        }
+        pl_text_buffer_append(buffer, "\n", 1);
+    }
+
+    if ([frames count] > frameCount)
+        pl_text_buffer_append_format(buffer, @"... %lu more frames ...\n", (unsigned long) ([frames count] - frameCount));
 }
 
-@end
+/**
+ * Format @a report as a single-line JSON object with @a options, appending the result to @a buffer. The object
+ * is written without any line breaks, and so a sequence of reports written with a trailing newline forms
+ * newline-delimited JSON.
+ */
++ (void) formatJSONReport: (PLCrashReport *) report
+                  options: (PLCrashReportTextFormatterOptions) options
+                   buffer: (pl_text_buffer_t *) buffer
+{
+    pl_json_writer_t writer = { .buffer = buffer, .depth = 0, .populated = 0 };
+    boolean_t lp64 = true;
+
+    /* The shared demangle cache, if demangling is enabled (and the cache is available) */
+    plcrash_demangle_cache_t *demangler = NULL;
+    if (options & PLCrashReportTextFormatterOptionDemangleSymbols)
+        demangler = plcrash_demangle_cache_shared();
+
+    /* Frames refer to their images by index within the report's image list; the image indices are keyed by
+     * (borrowed) PLCrashReportBinaryImageInfo references, offset by one to distinguish them from NULL. */
+    NSArray *images = report.images;
+    CFMutableDictionaryRef imageIndices = CFDictionaryCreateMutable(NULL, [images count], NULL, NULL);
+    for (NSUInteger i = 0; i < [images count]; i++)
+        CFDictionarySetValue(imageIndices, [images objectAtIndex: i], (const void *) (uintptr_t) (i + 1));
+
+    pl_json_writer_open(&writer, NULL, '{');
+    pl_json_writer_integer(&writer, "version", PL_JSON_FORMAT_VERSION);
+
+    if (report.uuidRef != NULL) {
+        CFStringRef uuid = CFUUIDCreateString(NULL, report.uuidRef);
+        pl_json_writer_string(&writer, "incident_identifier", (NSString *) uuid);
+        CFRelease(uuid);
+    }
+    pl_json_writer_bool(&writer, "truncated", report.truncated);
+    pl_json_writer_cstring(&writer, "type", pl_report_type_name(report.reportType));
+
+    /* System info */
+    {
+        PLCrashReportSystemInfo *system = report.systemInfo;
+        const char *osName;
+        switch (system.operatingSystem) {
+            case PLCrashReportOperatingSystemMacOSX:
+                osName = "macosx";
+                break;
+            case PLCrashReportOperatingSystemiPhoneOS:
+                osName = "iphoneos";
+                break;
+            case PLCrashReportOperatingSystemiPhoneSimulator:
+                osName = "iphonesimulator";
+                break;
+            default:
+                osName = "unknown";
+                break;
+        }
+
+        pl_json_writer_open(&writer, "system", '{');
+        pl_json_writer_cstring(&writer, "os", osName);
+        pl_json_writer_string(&writer, "os_version", system.operatingSystemVersion);
+        pl_json_writer_string(&writer, "os_build", system.operatingSystemBuild);
+        pl_json_writer_date(&writer, "timestamp", system.timestamp);
+        pl_json_writer_string(&writer, "code_type", pl_report_code_type(report, &lp64));
+        pl_json_writer_close(&writer, '}');
+    }
+
+    if (report.hasMachineInfo) {
+        PLCrashReportMachineInfo *machine = report.machineInfo;
+
+        pl_json_writer_open(&writer, "machine", '{');
+        pl_json_writer_string(&writer, "model", machine.modelName);
+        pl_json_writer_integer(&writer, "processor_count", machine.processorCount);
+        pl_json_writer_integer(&writer, "logical_processor_count", machine.logicalProcessorCount);
+        pl_json_writer_close(&writer, '}');
+    }
+
+    pl_json_writer_open(&writer, "application", '{');
+    pl_json_writer_string(&writer, "identifier", report.applicationInfo.applicationIdentifier);
+    pl_json_writer_string(&writer, "version", report.applicationInfo.applicationVersion);
+    pl_json_writer_close(&writer, '}');
+
+    if (report.hasProcessInfo) {
+        PLCrashReportProcessInfo *process = report.processInfo;
+
+        pl_json_writer_open(&writer, "process", '{');
+        pl_json_writer_string(&writer, "name", process.processName);
+        pl_json_writer_integer(&writer, "pid", process.processID);
+        pl_json_writer_string(&writer, "path", process.processPath);
+        pl_json_writer_date(&writer, "start_time", process.processStartTime);
+        pl_json_writer_string(&writer, "parent_name", process.parentProcessName);
+        pl_json_writer_integer(&writer, "parent_pid", process.parentProcessID);
+        pl_json_writer_bool(&writer, "native", process.native);
+        pl_json_writer_close(&writer, '}');
+    }
+
+    /* Signal and Mach exception */
+    pl_json_writer_open(&writer, "signal", '{');
+    pl_json_writer_string(&writer, "name", report.signalInfo.name);
+    pl_json_writer_string(&writer, "code", report.signalInfo.code);
+    pl_json_writer_address(&writer, "address", report.signalInfo.address);
+    pl_json_writer_close(&writer, '}');
+
+    if (report.machExceptionInfo != nil) {
+        pl_json_writer_open(&writer, "mach_exception", '{');
+        pl_json_writer_integer(&writer, "type", report.machExceptionInfo.type);
+        pl_json_writer_open(&writer, "codes", '[');
+        for (NSNumber *code in report.machExceptionInfo.codes)
+            pl_json_writer_address(&writer, NULL, [code unsignedLongLongValue]);
+        pl_json_writer_close(&writer, ']');
+        pl_json_writer_close(&writer, '}');
+    }
+
+    /* Synthesized termination */
+    if (report.terminationInfo != nil) {
+        PLCrashReportTerminationInfo *termination = report.terminationInfo;
+
+        pl_json_writer_open(&writer, "termination", '{');
+        pl_json_writer_string(&writer, "reason", pl_termination_reason_name(termination.reason));
+        pl_json_writer_integer(&writer, "pid", termination.processID);
+        pl_json_writer_date(&writer, "launch_time", termination.launchDate);
+        pl_json_writer_bool(&writer, "foreground", termination.foreground);
+        pl_json_writer_bool(&writer, "hung", termination.hung);
+        pl_json_writer_bool(&writer, "memory_warning", termination.receivedMemoryWarning);
+        if (termination.footprint != 0) {
+            pl_json_writer_integer(&writer, "footprint", termination.footprint);
+            pl_json_writer_date(&writer, "footprint_time", termination.footprintDate);
+        }
+        pl_json_writer_close(&writer, '}');
+    }
+
+    /* Uncaught exception */
+    if (report.hasExceptionInfo) {
+        PLCrashReportExceptionInfo *exception = report.exceptionInfo;
+
+        pl_json_writer_open(&writer, "exception", '{');
+        pl_json_writer_string(&writer, "name", exception.exceptionName);
+        pl_json_writer_string(&writer, "reason", exception.exceptionReason);
+        if ([exception.stackFrames count] > 0) {
+            pl_json_writer_open(&writer, "frames", '[');
+            for (PLCrashReportStackFrameInfo *frameInfo in exception.stackFrames)
+                [self formatJSONStackFrame: frameInfo report: report imageIndices: imageIndices demangler: demangler writer: &writer];
+            pl_json_writer_close(&writer, ']');
+        }
+        pl_json_writer_close(&writer, '}');
+    }
+
+    /* Threads */
+    pl_json_writer_open(&writer, "threads", '[');
+    for (PLCrashReportThreadInfo *thread in report.threads) {
+        pl_json_writer_open(&writer, NULL, '{');
+        pl_json_writer_integer(&writer, "number", thread.threadNumber);
+        pl_json_writer_bool(&writer, "crashed", thread.crashed);
+
+        PLCrashReportThreadSchedulingInfo *sched = thread.schedulingInfo;
+        if (sched != nil) {
+            pl_json_writer_string(&writer, "name", sched.name);
+            pl_json_writer_string(&writer, "state", pl_thread_run_state_name(sched.runState));
+            pl_json_writer_double(&writer, "cpu_usage", sched.cpuUsage);
+            pl_json_writer_double(&writer, "user_time", sched.userTime);
+            pl_json_writer_double(&writer, "system_time", sched.systemTime);
+            if (sched.hasQoSClass)
+                pl_json_writer_string(&writer, "qos", pl_thread_qos_class_name(sched.qosClass));
+            if (sched.hasPriority)
+                pl_json_writer_integer(&writer, "priority", sched.currentPriority);
+        }
+
+        pl_json_writer_open(&writer, "frames", '[');
+        for (PLCrashReportStackFrameInfo *frameInfo in thread.stackFrames)
+            [self formatJSONStackFrame: frameInfo report: report imageIndices: imageIndices demangler: demangler writer: &writer];
+        pl_json_writer_close(&writer, ']');
+
+        if ([thread.registers count] > 0) {
+            pl_json_writer_open(&writer, "registers", '{');
+            for (PLCrashReportRegisterInfo *reg in thread.registers) {
+                /* Register names are ASCII identifiers, and are written as keys verbatim */
+                const char *regName = [reg.registerName UTF8String];
+                if (regName != NULL)
+                    pl_json_writer_address(&writer, regName, reg.registerValue);
+            }
+            pl_json_writer_close(&writer, '}');
+        }
+
+        pl_json_writer_close(&writer, '}');
+    }
+    pl_json_writer_close(&writer, ']');
+
+    /* Images, in report order */
+    pl_json_writer_open(&writer, "images", '[');
+    for (PLCrashReportBinaryImageInfo *imageInfo in images) {
+        pl_json_writer_open(&writer, NULL, '{');
+        pl_json_writer_address(&writer, "base", imageInfo.imageBaseAddress);
+        pl_json_writer_integer(&writer, "size", imageInfo.imageSize);
+        pl_json_writer_string(&writer, "path", imageInfo.imageName);
+        pl_json_writer_string(&writer, "uuid", imageInfo.hasImageUUID ? imageInfo.imageUUID : nil);
+        pl_json_writer_cstring(&writer, "arch", pl_image_arch_name(imageInfo));
+        pl_json_writer_close(&writer, '}');
+    }
+    pl_json_writer_close(&writer, ']');
+
+    /* Memory usage */
+    if (report.memoryInfo != nil) {
+        PLCrashReportMemoryInfo *memory = report.memoryInfo;
+
+        pl_json_writer_open(&writer, "memory", '{');
+        if (memory.hasPhysicalFootprint)
+            pl_json_writer_integer(&writer, "physical_footprint", memory.physicalFootprint);
+        pl_json_writer_integer(&writer, "resident_size", memory.residentSize);
+        pl_json_writer_integer(&writer, "peak_resident_size", memory.peakResidentSize);
+        pl_json_writer_integer(&writer, "compressed_size", memory.compressedSize);
+        pl_json_writer_integer(&writer, "virtual_size", memory.virtualSize);
+
+        pl_json_writer_open(&writer, "regions", '[');
+        for (PLCrashReportMemoryRegionInfo *region in memory.regions) {
+            pl_json_writer_open(&writer, NULL, '{');
+            pl_json_writer_string(&writer, "type", pl_vm_region_tag_name(region));
+            pl_json_writer_integer(&writer, "tag", region.tag);
+            pl_json_writer_integer(&writer, "count", region.regionCount);
+            pl_json_writer_integer(&writer, "virtual_size", region.virtualSize);
+            pl_json_writer_integer(&writer, "resident_size", region.residentSize);
+            pl_json_writer_integer(&writer, "dirty_size", region.dirtySize);
+            pl_json_writer_integer(&writer, "swapped_size", region.swappedSize);
+            pl_json_writer_close(&writer, '}');
+        }
+        pl_json_writer_close(&writer, ']');
+        pl_json_writer_bool(&writer, "regions_truncated", memory.regionsTruncated);
+        pl_json_writer_close(&writer, '}');
+    }
+
+    pl_json_writer_close(&writer, '}');
+
+    CFRelease(imageIndices);
+}
+
+/**
+ * Format a stack frame as a JSON object, appending it as the next element of the writer's current array.
+ *
+ * @param frameInfo The stack frame to format.
+ * @param report The report from which this frame was acquired.
+ * @param imageIndices The report's image indices, offset by one, keyed by image.
+ * @param demangler The demangle cache to be used to demangle symbol names, or NULL to disable demangling.
+ * @param writer The JSON writer.
+ */
++ (void) formatJSONStackFrame: (PLCrashReportStackFrameInfo *) frameInfo
+                       report: (PLCrashReport *) report
+                 imageIndices: (CFDictionaryRef) imageIndices
+                    demangler: (plcrash_demangle_cache_t *) demangler
+                       writer: (pl_json_writer_t *) writer
+{
+    pl_json_writer_open(writer, NULL, '{');
+    pl_json_writer_address(writer, "pc", frameInfo.instructionPointer);
+
+    PLCrashReportBinaryImageInfo *imageInfo = [report imageForAddress: frameInfo.instructionPointer];
+    uintptr_t imageIndex = imageInfo != nil ? (uintptr_t) CFDictionaryGetValue(imageIndices, imageInfo) : 0;
+    if (imageIndex != 0) {
+        pl_json_writer_integer(writer, "image", imageIndex - 1);
+        pl_json_writer_integer(writer, "image_offset", frameInfo.instructionPointer - imageInfo.imageBaseAddress);
+    }
+
+    /* Symbol names are written as recorded, with the demangled name alongside */
+    if (frameInfo.symbolInfo != nil) {
+        NSString *symbolName = frameInfo.symbolInfo.symbolName;
+        pl_json_writer_string(writer, "symbol", symbolName);
+        pl_json_writer_integer(writer, "symbol_offset", frameInfo.instructionPointer - frameInfo.symbolInfo.startAddress);
+
+        if (demangler != NULL) {
+            const char *utf8 = [symbolName UTF8String];
+            char *demangled = NULL;
+            if (utf8 != NULL && plcrash_demangle_is_mangled(utf8))
+                demangled = plcrash_demangle_cache_copy(demangler, utf8);
+
+            if (demangled != NULL) {
+                pl_json_writer_cstring(writer, "demangled_symbol", demangled);
+                free(demangled);
+            }
+        }
+    }
+
+    if (frameInfo.repeatLength > 0 && frameInfo.repeatCount > 0) {
+        pl_json_writer_integer(writer, "repeat_length", frameInfo.repeatLength);
+        pl_json_writer_integer(writer, "repeat_count", frameInfo.repeatCount);
+    }
+
+    if (frameInfo.omittedFrameCount > 0)
+        pl_json_writer_integer(writer, "omitted_frames", frameInfo.omittedFrameCount);
+
+    const char *unwindMethod = pl_json_unwind_method_name(frameInfo.unwindMethod);
+    if (unwindMethod != NULL)
+        pl_json_writer_cstring(writer, "unwind_method", unwindMethod);
+
+    pl_json_writer_close(writer, '}');
+}
+
+/**
+ * Sort PLCrashReportBinaryImageInfo instances by their starting address.
+ */
+NSInteger binaryImageSort(id binary1, id binary2, void *context) {
+    uint64_t addr1 = [binary1 imageBaseAddress];
+    uint64_t addr2 = [binary2 imageBaseAddress];
+    
+    if (addr1 < addr2)
+        return NSOrderedAscending;
+    else if (addr1 > addr2)
+        return NSOrderedDescending;
+    else
+        return NSOrderedSame;
+}
+
+@end
+
+/**
+ * @internal
+ *
+ * Initialize a text buffer. If @a fd is not -1, buffered output will be written to @a fd.
+ */
+static void pl_text_buffer_init (pl_text_buffer_t *buffer, int fd) {
+    buffer->length = 0;
+    buffer->capacity = PL_TEXT_BUFFER_INITIAL_SIZE;
+    buffer->fd = fd;
+    buffer->error = 0;
+
+    buffer->data = malloc(buffer->capacity);
+    if (buffer->data == NULL) {
+        buffer->capacity = 0;
+        buffer->error = ENOMEM;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Free all resources associated with @a buffer.
+ */
+static void pl_text_buffer_free (pl_text_buffer_t *buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+}
+
+/**
+ * @internal
+ *
+ * Write all buffered data to the buffer's file descriptor, if any. Returns NO if an error has occured.
+ */
+static BOOL pl_text_buffer_flush (pl_text_buffer_t *buffer) {
+    if (buffer->error != 0)
+        return NO;
+
+    if (buffer->fd == -1)
+        return YES;
+
+    size_t written = 0;
+    while (written < buffer->length) {
+        ssize_t ret = write(buffer->fd, buffer->data + written, buffer->length - written);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+
+            buffer->error = errno;
+            return NO;
+        }
+
+        written += ret;
+    }
+
+    buffer->length = 0;
+    return YES;
+}
+
+/**
+ * @internal
+ *
+ * Ensure that at least @a length bytes are available in @a buffer. Returns NO on failure.
+ */
+static BOOL pl_text_buffer_reserve (pl_text_buffer_t *buffer, size_t length) {
+    if (buffer->error != 0)
+        return NO;
+
+    if (buffer->capacity - buffer->length >= length)
+        return YES;
+
+    /* Prefer flushing to growing the buffer */
+    if (buffer->fd != -1 && buffer->length >= PL_TEXT_BUFFER_FLUSH_SIZE) {
+        if (!pl_text_buffer_flush(buffer))
+            return NO;
+
+        if (buffer->capacity >= length)
+            return YES;
+    }
+
+    size_t capacity = buffer->capacity;
+    while (capacity - buffer->length < length)
+        capacity *= 2;
+
+    uint8_t *data = realloc(buffer->data, capacity);
+    if (data == NULL) {
+        buffer->error = ENOMEM;
+        return NO;
+    }
+
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return YES;
+}
+
+/**
+ * @internal
+ *
+ * Append @a length bytes to @a buffer.
+ */
+static void pl_text_buffer_append (pl_text_buffer_t *buffer, const void *bytes, size_t length) {
+    if (!pl_text_buffer_reserve(buffer, length))
+        return;
+
+    memcpy(buffer->data + buffer->length, bytes, length);
+    buffer->length += length;
+}
+
+/**
+ * @internal
+ *
+ * Append the UTF-8 representation of @a string to @a buffer.
+ */
+static void pl_text_buffer_append_string (pl_text_buffer_t *buffer, NSString *string) {
+    const char *bytes = [string UTF8String];
+    if (bytes == NULL)
+        return;
+
+    pl_text_buffer_append(buffer, bytes, strlen(bytes));
+}
+
+/**
+ * @internal
+ *
+ * Append the UTF-8 representation of the formatted string to @a buffer.
+ */
+static void pl_text_buffer_append_format (pl_text_buffer_t *buffer, NSString *format, ...) {
+    va_list ap;
+
+    va_start(ap, format);
+    NSString *string = [[NSString alloc] initWithFormat: format arguments: ap];
+    va_end(ap);
+
+    pl_text_buffer_append_string(buffer, string);
+    [string release];
+}
+
+/**
+ * @internal
+ *
+ * Append @a count spaces to @a buffer.
+ */
+static void pl_text_buffer_append_padding (pl_text_buffer_t *buffer, size_t count) {
+    if (!pl_text_buffer_reserve(buffer, count))
+        return;
+
+    memset(buffer->data + buffer->length, ' ', count);
+    buffer->length += count;
+}
+
+/**
+ * @internal
+ *
+ * Append the lowercase hexadecimal representation of @a value to @a buffer, zero-padded to @a width digits.
+ * Equivalent to "%0*" PRIx64.
+ */
+static void pl_text_buffer_append_hex (pl_text_buffer_t *buffer, uint64_t value, unsigned int width) {
+    static const char digits[] = "0123456789abcdef";
+    char output[16];
+    unsigned int count = 0;
+
+    /* Write the digits in reverse */
+    do {
+        output[sizeof(output) - 1 - count] = digits[value & 0xF];
+        value >>= 4;
+        count++;
+    } while (value != 0);
+
+    if (width > sizeof(output))
+        width = sizeof(output);
+
+    while (count < width) {
+        output[sizeof(output) - 1 - count] = '0';
+        count++;
+    }
+
+    pl_text_buffer_append(buffer, output + sizeof(output) - count, count);
+}
+
+/**
+ * @internal
+ *
+ * Append the decimal representation of @a value to @a buffer. Equivalent to "%" PRId64.
+ */
+static void pl_text_buffer_append_signed (pl_text_buffer_t *buffer, int64_t value) {
+    char output[21];
+    unsigned int count = 0;
+    uint64_t magnitude = value < 0 ? -(uint64_t) value : (uint64_t) value;
+
+    do {
+        output[sizeof(output) - 1 - count] = '0' + (magnitude % 10);
+        magnitude /= 10;
+        count++;
+    } while (magnitude != 0);
+
+    if (value < 0) {
+        output[sizeof(output) - 1 - count] = '-';
+        count++;
+    }
+
+    pl_text_buffer_append(buffer, output + sizeof(output) - count, count);
+}
+
+/**
+ * @internal
+ *
+ * Append @a value to @a buffer as an alternate-form hexadecimal value, right aligned within @a width
+ * columns. Equivalent to "%*#" PRIx64; as with printf(), a zero value is written without a 0x prefix.
+ */
+static void pl_text_buffer_append_address (pl_text_buffer_t *buffer, uint64_t value, unsigned int width) {
+    unsigned int digits = 1;
+    for (uint64_t v = value >> 4; v != 0; v >>= 4)
+        digits++;
+
+    unsigned int length = value == 0 ? 1 : digits + 2;
+    if (length < width)
+        pl_text_buffer_append_padding(buffer, width - length);
+
+    if (value == 0) {
+        pl_text_buffer_append(buffer, "0", 1);
+    } else {
+        pl_text_buffer_append(buffer, "0x", 2);
+        pl_text_buffer_append_hex(buffer, value, 0);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Begin a JSON member (or, if @a key is NULL, an array element), writing any required separator and the
+ * member's key.
+ *
+ * @param writer The JSON writer.
+ * @param key The member's key, or NULL. Keys are written verbatim, and must not require escaping.
+ */
+static void pl_json_writer_member (pl_json_writer_t *writer, const char *key) {
+    if (writer->depth > 0) {
+        uint64_t mask = 1ULL << (writer->depth - 1);
+        if (writer->populated & mask)
+            pl_text_buffer_append(writer->buffer, ",", 1);
+        writer->populated |= mask;
+    }
+
+    if (key != NULL) {
+        pl_text_buffer_append(writer->buffer, "\"", 1);
+        pl_text_buffer_append(writer->buffer, key, strlen(key));
+        pl_text_buffer_append(writer->buffer, "\":", 2);
+    }
+}
+
+/**
+ * @internal
+ *
+ * Open a JSON object or array (as selected by @a opener) as the member @a key.
+ */
+static void pl_json_writer_open (pl_json_writer_t *writer, const char *key, char opener) {
+    PLCF_ASSERT(writer->depth < PL_JSON_WRITER_MAX_DEPTH);
+
+    pl_json_writer_member(writer, key);
+    pl_text_buffer_append(writer->buffer, &opener, 1);
+
+    writer->depth++;
+    writer->populated &= ~(1ULL << (writer->depth - 1));
+}
+
+/**
+ * @internal
+ *
+ * Close the innermost JSON object or array, writing @a closer.
+ */
+static void pl_json_writer_close (pl_json_writer_t *writer, char closer) {
+    PLCF_ASSERT(writer->depth > 0);
+
+    writer->depth--;
+    pl_text_buffer_append(writer->buffer, &closer, 1);
+}
+
+/**
+ * @internal
+ *
+ * Append @a length bytes of UTF-8 @a bytes to the writer's buffer as a quoted, escaped JSON string. Runs of
+ * bytes that do not require escaping are copied directly.
+ */
+static void pl_json_writer_append_quoted (pl_json_writer_t *writer, const char *bytes, size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    pl_text_buffer_t *buffer = writer->buffer;
+    size_t run = 0;
+
+    pl_text_buffer_append(buffer, "\"", 1);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = bytes[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+
+        pl_text_buffer_append(buffer, bytes + run, i - run);
+        run = i + 1;
+
+        switch (c) {
+            case '"':  pl_text_buffer_append(buffer, "\\\"", 2); break;
+            case '\\': pl_text_buffer_append(buffer, "\\\\", 2); break;
+            case '\n': pl_text_buffer_append(buffer, "\\n", 2); break;
+            case '\r': pl_text_buffer_append(buffer, "\\r", 2); break;
+            case '\t': pl_text_buffer_append(buffer, "\\t", 2); break;
+            default: {
+                char escape[6] = { '\\', 'u', '0', '0', digits[c >> 4], digits[c & 0xF] };
+                pl_text_buffer_append(buffer, escape, sizeof(escape));
+                break;
+            }
+        }
+    }
+    pl_text_buffer_append(buffer, bytes + run, length - run);
+    pl_text_buffer_append(buffer, "\"", 1);
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with the UTF-8 C string @a value, or a JSON null if @a value is NULL.
+ */
+static void pl_json_writer_cstring (pl_json_writer_t *writer, const char *key, const char *value) {
+    pl_json_writer_member(writer, key);
+    if (value == NULL) {
+        pl_text_buffer_append(writer->buffer, "null", 4);
+        return;
+    }
+
+    pl_json_writer_append_quoted(writer, value, strlen(value));
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with the string @a value, or a JSON null if @a value is nil. The string's
+ * backing UTF-8 storage is used directly where available.
+ */
+static void pl_json_writer_string (pl_json_writer_t *writer, const char *key, NSString *value) {
+    const char *bytes = NULL;
+    if (value != nil) {
+        bytes = CFStringGetCStringPtr((CFStringRef) value, kCFStringEncodingUTF8);
+        if (bytes == NULL)
+            bytes = [value UTF8String];
+    }
+
+    pl_json_writer_cstring(writer, key, bytes);
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with the signed integer @a value.
+ */
+static void pl_json_writer_integer (pl_json_writer_t *writer, const char *key, int64_t value) {
+    pl_json_writer_member(writer, key);
+    pl_text_buffer_append_signed(writer->buffer, value);
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with the address @a value, as a "0x"-prefixed hexadecimal string. Addresses are
+ * written as strings as they may not be exactly representable by the double-precision numbers used by many
+ * JSON parsers.
+ */
+static void pl_json_writer_address (pl_json_writer_t *writer, const char *key, uint64_t value) {
+    pl_json_writer_member(writer, key);
+    pl_text_buffer_append(writer->buffer, "\"0x", 3);
+    pl_text_buffer_append_hex(writer->buffer, value, 0);
+    pl_text_buffer_append(writer->buffer, "\"", 1);
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with the boolean @a value.
+ */
+static void pl_json_writer_bool (pl_json_writer_t *writer, const char *key, BOOL value) {
+    pl_json_writer_member(writer, key);
+    if (value)
+        pl_text_buffer_append(writer->buffer, "true", 4);
+    else
+        pl_text_buffer_append(writer->buffer, "false", 5);
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with the floating point @a value. Non-finite values, which are not representable
+ * in JSON, are written as null.
+ */
+static void pl_json_writer_double (pl_json_writer_t *writer, const char *key, double value) {
+    pl_json_writer_member(writer, key);
+    if (!isfinite(value)) {
+        pl_text_buffer_append(writer->buffer, "null", 4);
+        return;
+    }
+
+    char output[32];
+    int length = snprintf(output, sizeof(output), "%.6g", value);
+    pl_text_buffer_append(writer->buffer, output, length);
+}
+
+/**
+ * @internal
+ *
+ * Write the member @a key with @a date as a number of seconds since the UNIX epoch, or null if @a date is nil.
+ */
+static void pl_json_writer_date (pl_json_writer_t *writer, const char *key, NSDate *date) {
+    if (date == nil) {
+        pl_json_writer_member(writer, key);
+        pl_text_buffer_append(writer->buffer, "null", 4);
+        return;
+    }
+
+    pl_json_writer_integer(writer, key, (int64_t) [date timeIntervalSince1970]);
+}
+
+/**
+ * @internal
+ *
+ * Return the Apple-style code type of the Mach CPU @a type, and set @a lp64 to true if the type is LP64 (64-bit).
+ * Returns nil if the type is unknown.
+ */
+static NSString *pl_mach_code_type (uint64_t type, boolean_t *lp64) {
+    switch (type) {
+        case CPU_TYPE_ARM:
+            *lp64 = false;
+            return @"ARM";
+
+#ifdef CPU_TYPE_ARM64
+        case CPU_TYPE_ARM64:
+            *lp64 = true;
+            return @"ARM-64";
+#endif
+
+        case CPU_TYPE_X86:
+            *lp64 = false;
+            return @"X86";
+
+        case CPU_TYPE_X86_64:
+            *lp64 = true;
+            return @"X86-64";
+
+        case CPU_TYPE_POWERPC:
+            *lp64 = false;
+            return @"PPC";
+
+        default:
+            return nil;
+    }
+}
+
+/**
+ * @internal
+ *
+ * Return the Apple-style code type of @a report derived from its legacy system architecture value, and set @a lp64
+ * to true if the report was generated by an LP64 (64-bit) process.
+ */
+static NSString *pl_architecture_code_type (PLCrashReport *report, boolean_t *lp64) {
+    switch (report.systemInfo.architecture) {
+        case PLCrashReportArchitectureARMv6:
+        case PLCrashReportArchitectureARMv7:
+            *lp64 = false;
+            return @"ARM";
+        case PLCrashReportArchitectureX86_32:
+            *lp64 = false;
+            return @"X86";
+        case PLCrashReportArchitectureX86_64:
+            *lp64 = true;
+            return @"X86-64";
+        case PLCrashReportArchitecturePPC:
+            *lp64 = false;
+            return @"PPC";
+        default:
+            *lp64 = true;
+            return [NSString stringWithFormat: @"Unknown (%d)", report.systemInfo.architecture];
+    }
+}
+
+/**
+ * @internal
+ *
+ * Return the Apple-style code type of @a report, and set @a lp64 to true if the report was generated by an
+ * LP64 (64-bit) process.
+ */
+static NSString *pl_report_code_type (PLCrashReport *report, boolean_t *lp64) {
+    /* Attempt to derive the code type from the binary images */
+    for (PLCrashReportBinaryImageInfo *image in report.images) {
+        /* Skip images with no specified type, and unknown encodings */
+        if (image.codeType == nil || image.codeType.typeEncoding != PLCrashReportProcessorTypeEncodingMach)
+            continue;
+
+        /* Stop immediately if code type was discovered */
+        NSString *codeType = pl_mach_code_type(image.codeType.type, lp64);
+        if (codeType != nil)
+            return codeType;
+    }
+
+    /* If we were unable to determine the code type, fall back on the legacy architecture value. */
+    return pl_architecture_code_type(report, lp64);
+}
+
+/**
+ * @internal
+ *
+ * Return the Apple-style code type of @a report without accessing its binary images, and set @a lp64 to true if
+ * the report was generated by an LP64 (64-bit) process. The code type is derived from the report's machine info,
+ * if available, and otherwise from the legacy architecture value.
+ */
+static NSString *pl_report_machine_code_type (PLCrashReport *report, boolean_t *lp64) {
+    PLCrashReportProcessorInfo *processor = report.machineInfo.processorInfo;
+    if (processor != nil && processor.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
+        NSString *codeType = pl_mach_code_type(processor.type, lp64);
+        if (codeType != nil)
+            return codeType;
+    }
+
+    return pl_architecture_code_type(report, lp64);
+}
+
+/**
+ * @internal
+ *
+ * Return the Apple-style architecture name of @a imageInfo, or "???" if unknown.
+ */
+static const char *pl_image_arch_name (PLCrashReportBinaryImageInfo *imageInfo) {
+    const char *archName = "???";
+    if (imageInfo.codeType != nil && imageInfo.codeType.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
+        switch (imageInfo.codeType.type) {
+            case CPU_TYPE_ARM:
+                /* Apple includes subtype for ARM binaries. */
+                switch (imageInfo.codeType.subtype) {
+                    case CPU_SUBTYPE_ARM_V6:
+                        archName = "armv6";
+                        break;
+
+                    case CPU_SUBTYPE_ARM_V7:
+                        archName = "armv7";
+                        break;
+                        
+                    case CPU_SUBTYPE_ARM_V7S:
+                        archName = "armv7s";
+                        break;
+
+                    default:
+                        archName = "arm-unknown";
+                        break;
+                }
+                break;
+                
+#ifdef CPU_TYPE_ARM64
+            case CPU_TYPE_ARM64:
+                archName = "arm64";
+                break;
+#endif
+
+            case CPU_TYPE_X86:
+                archName = "i386";
+                break;
+                
+            case CPU_TYPE_X86_64:
+                archName = "x86_64";
+                break;
+
+            case CPU_TYPE_POWERPC:
+                archName = "powerpc";
+                break;
+
+            default:
+                // Use the default archName value (initialized above).
+                break;
+        }
+    }
+
+    return archName;
+}
+
+/**
+ * @internal
+ *
+ * Fetch the cached formatting values for @a image, populating the cache entry if required. Returns NULL
+ * if the entry could not be allocated.
+ */
+static pl_image_format_cache_t *pl_image_format_cache_get (CFMutableDictionaryRef cache, PLCrashReportBinaryImageInfo *image) {
+    pl_image_format_cache_t *entry = (pl_image_format_cache_t *) CFDictionaryGetValue(cache, image);
+    if (entry != NULL)
+        return entry;
+
+    NSString *name = [image.imageName lastPathComponent];
+    const char *bytes = [name UTF8String];
+    if (bytes == NULL)
+        bytes = "";
+
+    if ((entry = malloc(sizeof(*entry))) == NULL)
+        return NULL;
+
+    entry->nameLength = strlen(bytes);
+    entry->nameCharacters = [name length];
+    if ((entry->name = strdup(bytes)) == NULL) {
+        free(entry);
+        return NULL;
+    }
+
+    CFDictionarySetValue(cache, image, entry);
+    return entry;
+}
+
+/* CFDictionaryApplierFunction used to free cache entries */
+static void pl_image_format_cache_free_entry (const void *key, const void *value, void *context) {
+    pl_image_format_cache_t *entry = (pl_image_format_cache_t *) value;
+    free(entry->name);
+    free(entry);
+}
+
+/**
+ * @internal
+ *
+ * Free @a cache and all of its entries.
+ */
+static void pl_image_format_cache_free (CFMutableDictionaryRef cache) {
+    CFDictionaryApplyFunction(cache, pl_image_format_cache_free_entry, NULL);
+    CFRelease(cache);
+}
+
+/**
+ * @internal
+ *
+ * Sort comparator ordering PLCrashReportThreadInfo instances by descending CPU usage, and then by thread number.
+ */
+static NSInteger pl_compare_thread_cpu_usage (id lhs, id rhs, void *context) {
+    PLCrashReportThreadInfo *lthread = lhs;
+    PLCrashReportThreadInfo *rthread = rhs;
+    double lusage = lthread.schedulingInfo.cpuUsage;
+    double rusage = rthread.schedulingInfo.cpuUsage;
+
+    if (lusage > rusage)
+        return NSOrderedAscending;
+    else if (lusage < rusage)
+        return NSOrderedDescending;
+
+    if (lthread.threadNumber < rthread.threadNumber)
+        return NSOrderedAscending;
+    else if (lthread.threadNumber > rthread.threadNumber)
+        return NSOrderedDescending;
+
+    return NSOrderedSame;
+}
+
+/**
+ * @internal
+ *
+ * Return a human-readable name for the thread run @a state.
+ */
+static NSString *pl_thread_run_state_name (PLCrashReportThreadRunState state) {
+    switch (state) {
+        case PLCrashReportThreadRunStateRunning:
+            return @"running";
+        case PLCrashReportThreadRunStateStopped:
+            return @"stopped";
+        case PLCrashReportThreadRunStateWaiting:
+            return @"waiting";
+        case PLCrashReportThreadRunStateUninterruptible:
+            return @"uninterruptible";
+        case PLCrashReportThreadRunStateHalted:
+            return @"halted";
+        case PLCrashReportThreadRunStateUnknown:
+            break;
+    }
+
+    return @"unknown";
+}
+
+/**
+ * @internal
+ *
+ * Return a human-readable name for the thread's @a qosClass.
+ */
+static NSString *pl_thread_qos_class_name (PLCrashReportThreadQoSClass qosClass) {
+    switch (qosClass) {
+        case PLCrashReportThreadQoSClassUnspecified:
+            return @"unspecified";
+        case PLCrashReportThreadQoSClassMaintenance:
+            return @"maintenance";
+        case PLCrashReportThreadQoSClassBackground:
+            return @"background";
+        case PLCrashReportThreadQoSClassUtility:
+            return @"utility";
+        case PLCrashReportThreadQoSClassDefault:
+            return @"default";
+        case PLCrashReportThreadQoSClassUserInitiated:
+            return @"user-initiated";
+        case PLCrashReportThreadQoSClassUserInteractive:
+            return @"user-interactive";
+    }
+
+    return @"unknown";
+}
+
+/**
+ * @internal
+ *
+ * Return a human-readable description of the termination @a reason.
+ */
+static NSString *pl_termination_reason_name (PLCrashReportTerminationReason reason) {
+    switch (reason) {
+        case PLCrashReportTerminationReasonWatchdog:
+            return @"PROBABLE WATCHDOG TERMINATION";
+        case PLCrashReportTerminationReasonOutOfMemory:
+            return @"PROBABLE OUT OF MEMORY TERMINATION";
+        case PLCrashReportTerminationReasonBackground:
+            return @"BACKGROUND TERMINATION";
+    }
+
+    return @"UNKNOWN TERMINATION";
+}
+
+/**
+ * @internal
+ *
+ * Return the JSON name of a report type.
+ */
+static const char *pl_report_type_name (PLCrashReportType type) {
+    switch (type) {
+        case PLCrashReportTypeCrash:
+            return "crash";
+        case PLCrashReportTypeLanguageException:
+            return "language_exception";
+        case PLCrashReportTypeWatchdog:
+            return "watchdog";
+        case PLCrashReportTypeLive:
+            return "live";
+    }
+
+    return "unknown";
+}
+
+/**
+ * @internal
+ *
+ * Return the JSON name of a frame unwind method, or NULL if the method is unknown.
+ */
+static const char *pl_json_unwind_method_name (PLCrashReportUnwindMethod method) {
+    switch (method) {
+        case PLCrashReportUnwindMethodUnknown:
+            return NULL;
+        case PLCrashReportUnwindMethodThreadState:
+            return "thread_state";
+        case PLCrashReportUnwindMethodCompactUnwind:
+            return "compact_unwind";
+        case PLCrashReportUnwindMethodDWARF:
+            return "dwarf";
+        case PLCrashReportUnwindMethodFramePointer:
+            return "frame_pointer";
+        case PLCrashReportUnwindMethodStackScan:
+            return "stack_scan";
+    }
+
+    return NULL;
+}
+
+/**
+ * @internal
+ *
+ * Sort comparator ordering PLCrashReportMemoryRegionInfo instances by descending resident size, and then by tag.
+ */
+static NSInteger pl_compare_region_resident_size (id lhs, id rhs, void *context) {
+    PLCrashReportMemoryRegionInfo *lregion = lhs;
+    PLCrashReportMemoryRegionInfo *rregion = rhs;
+
+    if (lregion.residentSize > rregion.residentSize)
+        return NSOrderedAscending;
+    else if (lregion.residentSize < rregion.residentSize)
+        return NSOrderedDescending;
+
+    if (lregion.tag < rregion.tag)
+        return NSOrderedAscending;
+    else if (lregion.tag > rregion.tag)
+        return NSOrderedDescending;
+
+    return NSOrderedSame;
+}
+
+/**
+ * @internal
+ *
+ * Format a byte @a size using the largest whole binary unit (eg, 1.5M).
+ */
+static NSString *pl_format_memory_size (uint64_t size) {
+    static const char units[] = { 'K', 'M', 'G', 'T' };
+
+    if (size < 1024)
+        return [NSString stringWithFormat: @"%llu", (unsigned long long) size];
+
+    double value = size / 1024.0;
+    size_t unit = 0;
+    while (value >= 1024.0 && unit + 1 < sizeof(units)) {
+        value /= 1024.0;
+        unit++;
+    }
+
+    return [NSString stringWithFormat: @"%.1f%c", value, units[unit]];
+}
+
+/**
+ * @internal
+ *
+ * Return a human-readable name for the VM user tag of @a region. The names match those used by the vmmap tool.
+ */
+static NSString *pl_vm_region_tag_name (PLCrashReportMemoryRegionInfo *region) {
+    if (region.mappedFile)
+        return @"mapped file";
+
+    switch (region.tag) {
+        case 0: return @"VM_ALLOCATE";
+        case 1: return @"MALLOC";
+        case 2: return @"MALLOC_SMALL";
+        case 3: return @"MALLOC_LARGE";
+        case 4: return @"MALLOC_HUGE";
+        case 5: return @"SBRK";
+        case 6: return @"MALLOC_REALLOC";
+        case 7: return @"MALLOC_TINY";
+        case 8: return @"MALLOC_LARGE (reusable)";
+        case 9: return @"MALLOC_LARGE (reused)";
+        case 10: return @"Performance tool data";
+        case 11: return @"MALLOC_NANO";
+        case 20: return @"Mach message";
+        case 21: return @"IOKit";
+        case 30: return @"Stack";
+        case 31: return @"Guard";
+        case 32: return @"Shared pmap";
+        case 33: return @"dylib";
+        case 34: return @"ObjC dispatchers";
+        case 35: return @"Unshared pmap";
+        case 40: return @"AppKit";
+        case 41: return @"Foundation";
+        case 42: return @"CoreGraphics";
+        case 43: return @"CoreServices";
+        case 44: return @"Java";
+        case 45: return @"CoreData";
+        case 46: return @"CoreData Object IDs";
+        case 50: return @"ATS (font support)";
+        case 51: return @"CoreAnimation";
+        case 52: return @"CG image";
+        case 53: return @"TCMalloc";
+        case 54: return @"CG raster data";
+        case 55: return @"CG shared images";
+        case 56: return @"CG framebuffers";
+        case 57: return @"CG backing stores";
+        case 58: return @"CG xalloc";
+        case 60: return @"dyld private memory";
+        case 61: return @"dyld malloc memory";
+        case 62: return @"SQLite page cache";
+        case 63: return @"JavaScriptCore";
+        case 64: return @"JS JIT generated code";
+        case 65: return @"JS VM register file";
+        case 66: return @"OpenGL GLSL";
+        case 67: return @"OpenCL";
+        case 68: return @"CoreImage";
+        case 69: return @"WebCore purgeable data";
+        case 70: return @"Image IO";
+        case 71: return @"CoreProfile";
+        case 72: return @"Assetsd";
+        case 73: return @"OS Alloc Once";
+        case 74: return @"Dispatch continuations";
+        case 75: return @"Accelerate framework";
+        case 76: return @"CoreUI image data";
+        case 77: return @"CoreUI image file";
+        default:
+            break;
+    }
+
+    /* Tags 240-255 are reserved for application use */
+    if (region.tag >= 240)
+        return [NSString stringWithFormat: @"Memory Tag %u", region.tag - 240 + 1];
+
+    return [NSString stringWithFormat: @"VM tag %u", region.tag];
+}
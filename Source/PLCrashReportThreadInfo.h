@@ -30,20 +30,33 @@
 
 #import "PLCrashReportStackFrameInfo.h"
 #import "PLCrashReportRegisterInfo.h"
+#import "PLCrashReportThreadSchedulingInfo.h"
+
+@class PLCrashReportFrameTable;
 
 @interface PLCrashReportThreadInfo : NSObject {
 @private
     /** The thread number. Should be unique within a given crash log. */
     NSInteger _threadNumber;
 
-    /** Ordered list of PLCrashReportStackFrame instances */
+    /** Ordered list of PLCrashReportStackFrame instances. If the thread was decoded from a report, this is created
+     * from _frameTable on first access. */
     NSArray *_stackFrames;
 
+    /** The report's frame storage, or nil if the stack frames were supplied at initialization time. */
+    PLCrashReportFrameTable *_frameTable;
+
+    /** The range of this thread's frames within _frameTable. */
+    NSRange _frameRange;
+
     /** YES if this thread crashed. */
     BOOL _crashed;
 
     /** List of PLCrashReportRegister instances. Will be empty if _crashed is NO. */
     NSArray *_registers;
+
+    /** Scheduling state, or nil if not available. */
+    PLCrashReportThreadSchedulingInfo *_schedulingInfo;
 }
 
 - (id) initWithThreadNumber: (NSInteger) threadNumber
@@ -51,6 +64,19 @@
                     crashed: (BOOL) crashed
                   registers: (NSArray *) registers;
 
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                stackFrames: (NSArray *) stackFrames
+                    crashed: (BOOL) crashed
+                  registers: (NSArray *) registers
+             schedulingInfo: (PLCrashReportThreadSchedulingInfo *) schedulingInfo;
+
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameTable: (PLCrashReportFrameTable *) frameTable
+                 frameRange: (NSRange) frameRange
+                    crashed: (BOOL) crashed
+                  registers: (NSArray *) registers
+             schedulingInfo: (PLCrashReportThreadSchedulingInfo *) schedulingInfo;
+
 /**
  * Application thread number.
  */
@@ -62,6 +88,12 @@
  */
 @property(nonatomic, readonly) NSArray *stackFrames;
 
+/**
+ * The number of frames in the thread's backtrace. Unlike stackFrames, this does not require the creation of
+ * the thread's PLCrashReportStackFrameInfo instances.
+ */
+@property(nonatomic, readonly) NSUInteger stackFrameCount;
+
 /**
  * If this thread crashed, set to YES.
  */
@@ -74,4 +106,9 @@
  */
 @property(nonatomic, readonly) NSArray *registers;
 
+/**
+ * The thread's scheduling and CPU accounting state at the time the report was written, or nil if not recorded.
+ */
+@property(nonatomic, readonly) PLCrashReportThreadSchedulingInfo *schedulingInfo;
+
 @end
@@ -27,6 +27,7 @@
  */
 
 #import "PLCrashReportThreadInfo.h"
+#import "PLCrashReportFrameTable.h"
 
 /**
  * Crash log per-thread state information.
@@ -42,6 +43,24 @@
                 stackFrames: (NSArray *) stackFrames
                     crashed: (BOOL) crashed
                   registers: (NSArray *) registers
+{
+    return [self initWithThreadNumber: threadNumber stackFrames: stackFrames crashed: crashed registers: registers schedulingInfo: nil];
+}
+
+/**
+ * Initialize the crash log thread information.
+ *
+ * @param threadNumber The thread number.
+ * @param stackFrames The thread's backtrace (PLCrashReportStackFrameInfo instances).
+ * @param crashed YES if this thread crashed.
+ * @param registers The thread's register state (PLCrashReportRegisterInfo instances).
+ * @param schedulingInfo The thread's scheduling state, or nil if not available.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                stackFrames: (NSArray *) stackFrames
+                    crashed: (BOOL) crashed
+                  registers: (NSArray *) registers
+             schedulingInfo: (PLCrashReportThreadSchedulingInfo *) schedulingInfo
 {
     if ((self = [super init]) == nil)
         return nil;
@@ -50,20 +69,68 @@
     _stackFrames = [stackFrames retain];
     _crashed = crashed;
     _registers = [registers retain];
+    _schedulingInfo = [schedulingInfo retain];
+
+    return self;
+}
+
+/**
+ * Initialize the crash log thread information, with stack frames stored in a report's frame table. The thread's
+ * PLCrashReportStackFrameInfo instances are not created until stackFrames is first accessed.
+ *
+ * @param threadNumber The thread number.
+ * @param frameTable The report's frame table, to which all of the thread's frames have been appended.
+ * @param frameRange The range of the thread's frames within @a frameTable.
+ * @param crashed YES if this thread crashed.
+ * @param registers The thread's register state (PLCrashReportRegisterInfo instances).
+ * @param schedulingInfo The thread's scheduling state, or nil if not available.
+ */
+- (id) initWithThreadNumber: (NSInteger) threadNumber
+                 frameTable: (PLCrashReportFrameTable *) frameTable
+                 frameRange: (NSRange) frameRange
+                    crashed: (BOOL) crashed
+                  registers: (NSArray *) registers
+             schedulingInfo: (PLCrashReportThreadSchedulingInfo *) schedulingInfo
+{
+    if ((self = [self initWithThreadNumber: threadNumber stackFrames: nil crashed: crashed registers: registers schedulingInfo: schedulingInfo]) == nil)
+        return nil;
+
+    _frameTable = [frameTable retain];
+    _frameRange = frameRange;
 
     return self;
 }
 
 - (void) dealloc {
     [_stackFrames release];
+    [_frameTable release];
     [_registers release];
+    [_schedulingInfo release];
     [super dealloc];
 }
 
 @synthesize threadNumber = _threadNumber;
-@synthesize stackFrames = _stackFrames;
 @synthesize crashed = _crashed;
 @synthesize registers = _registers;
+@synthesize schedulingInfo = _schedulingInfo;
+
+// property getter. Creates the frame instances from the report's frame table on first access.
+- (NSArray *) stackFrames {
+    @synchronized (self) {
+        if (_stackFrames == nil && _frameTable != nil)
+            _stackFrames = [[_frameTable stackFramesInRange: _frameRange] retain];
+
+        return _stackFrames;
+    }
+}
+
+// property getter.
+- (NSUInteger) stackFrameCount {
+    if (_frameTable != nil)
+        return _frameRange.length;
+
+    return [_stackFrames count];
+}
 
 
 @end
@@ -0,0 +1,187 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+/**
+ * @ingroup constants
+ *
+ * Thread run states.
+ */
+typedef enum {
+    /** The run state is unknown. */
+    PLCrashReportThreadRunStateUnknown = 0,
+
+    /** The thread is running, or runnable. */
+    PLCrashReportThreadRunStateRunning = 1,
+
+    /** The thread is stopped. */
+    PLCrashReportThreadRunStateStopped = 2,
+
+    /** The thread is waiting interruptibly. */
+    PLCrashReportThreadRunStateWaiting = 3,
+
+    /** The thread is waiting uninterruptibly. */
+    PLCrashReportThreadRunStateUninterruptible = 4,
+
+    /** The thread has halted. */
+    PLCrashReportThreadRunStateHalted = 5
+} PLCrashReportThreadRunState;
+
+/**
+ * @ingroup constants
+ *
+ * Thread quality of service classes.
+ */
+typedef enum {
+    /** No QoS class was assigned. */
+    PLCrashReportThreadQoSClassUnspecified = 0,
+
+    /** Maintenance QoS. */
+    PLCrashReportThreadQoSClassMaintenance = 1,
+
+    /** Background QoS. */
+    PLCrashReportThreadQoSClassBackground = 2,
+
+    /** Utility QoS. */
+    PLCrashReportThreadQoSClassUtility = 3,
+
+    /** Default (legacy) QoS. */
+    PLCrashReportThreadQoSClassDefault = 4,
+
+    /** User initiated QoS. */
+    PLCrashReportThreadQoSClassUserInitiated = 5,
+
+    /** User interactive QoS. */
+    PLCrashReportThreadQoSClassUserInteractive = 6
+} PLCrashReportThreadQoSClass;
+
+@interface PLCrashReportThreadSchedulingInfo : NSObject {
+@private
+    /** User run time */
+    NSTimeInterval _userTime;
+
+    /** System run time */
+    NSTimeInterval _systemTime;
+
+    /** CPU usage */
+    double _cpuUsage;
+
+    /** Run state */
+    PLCrashReportThreadRunState _runState;
+
+    /** Sleep time */
+    NSTimeInterval _sleepTime;
+
+    /** YES if the priorities are available */
+    BOOL _hasPriority;
+
+    /** Base scheduling priority */
+    NSInteger _basePriority;
+
+    /** Current scheduling priority */
+    NSInteger _currentPriority;
+
+    /** Thread name, or nil */
+    NSString *_name;
+
+    /** YES if the QoS class is available */
+    BOOL _hasQoSClass;
+
+    /** QoS class */
+    PLCrashReportThreadQoSClass _qosClass;
+}
+
+- (id) initWithUserTime: (NSTimeInterval) userTime
+             systemTime: (NSTimeInterval) systemTime
+               cpuUsage: (double) cpuUsage
+               runState: (PLCrashReportThreadRunState) runState
+              sleepTime: (NSTimeInterval) sleepTime
+            hasPriority: (BOOL) hasPriority
+           basePriority: (NSInteger) basePriority
+        currentPriority: (NSInteger) currentPriority
+                   name: (NSString *) name
+            hasQoSClass: (BOOL) hasQoSClass
+               qosClass: (PLCrashReportThreadQoSClass) qosClass;
+
+/**
+ * The total time the thread has spent executing in user space.
+ */
+@property(nonatomic, readonly) NSTimeInterval userTime;
+
+/**
+ * The total time the thread has spent executing in the kernel.
+ */
+@property(nonatomic, readonly) NSTimeInterval systemTime;
+
+/**
+ * The thread's recent CPU usage, as a fraction of a single CPU (1.0 = 100%).
+ */
+@property(nonatomic, readonly) double cpuUsage;
+
+/**
+ * The thread's run state.
+ */
+@property(nonatomic, readonly) PLCrashReportThreadRunState runState;
+
+/**
+ * The length of time the thread has been sleeping.
+ */
+@property(nonatomic, readonly) NSTimeInterval sleepTime;
+
+/**
+ * YES if the thread's scheduling priorities are available.
+ */
+@property(nonatomic, readonly) BOOL hasPriority;
+
+/**
+ * The thread's base scheduling priority. Only valid if hasPriority is YES.
+ */
+@property(nonatomic, readonly) NSInteger basePriority;
+
+/**
+ * The thread's current scheduling priority. Only valid if hasPriority is YES.
+ */
+@property(nonatomic, readonly) NSInteger currentPriority;
+
+/**
+ * The thread's name, or nil if the thread is unnamed.
+ */
+@property(nonatomic, readonly) NSString *name;
+
+/**
+ * YES if the thread's QoS class is available.
+ */
+@property(nonatomic, readonly) BOOL hasQoSClass;
+
+/**
+ * The thread's QoS class. Only valid if hasQoSClass is YES.
+ */
+@property(nonatomic, readonly) PLCrashReportThreadQoSClass qosClass;
+
+@end
@@ -0,0 +1,98 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportThreadSchedulingInfo.h"
+
+/**
+ * Provides access to a thread's scheduling and CPU accounting state at the time the report was written.
+ */
+@implementation PLCrashReportThreadSchedulingInfo
+
+/**
+ * Initialize with the provided scheduling state.
+ *
+ * @param userTime The total time the thread has spent executing in user space.
+ * @param systemTime The total time the thread has spent executing in the kernel.
+ * @param cpuUsage The thread's recent CPU usage, as a fraction of a single CPU.
+ * @param runState The thread's run state.
+ * @param sleepTime The length of time the thread has been sleeping.
+ * @param hasPriority YES if @a basePriority and @a currentPriority are valid.
+ * @param basePriority The thread's base scheduling priority.
+ * @param currentPriority The thread's current scheduling priority.
+ * @param name The thread's name, or nil.
+ * @param hasQoSClass YES if @a qosClass is valid.
+ * @param qosClass The thread's QoS class.
+ */
+- (id) initWithUserTime: (NSTimeInterval) userTime
+             systemTime: (NSTimeInterval) systemTime
+               cpuUsage: (double) cpuUsage
+               runState: (PLCrashReportThreadRunState) runState
+              sleepTime: (NSTimeInterval) sleepTime
+            hasPriority: (BOOL) hasPriority
+           basePriority: (NSInteger) basePriority
+        currentPriority: (NSInteger) currentPriority
+                   name: (NSString *) name
+            hasQoSClass: (BOOL) hasQoSClass
+               qosClass: (PLCrashReportThreadQoSClass) qosClass
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _userTime = userTime;
+    _systemTime = systemTime;
+    _cpuUsage = cpuUsage;
+    _runState = runState;
+    _sleepTime = sleepTime;
+    _hasPriority = hasPriority;
+    _basePriority = basePriority;
+    _currentPriority = currentPriority;
+    _name = [name copy];
+    _hasQoSClass = hasQoSClass;
+    _qosClass = qosClass;
+
+    return self;
+}
+
+- (void) dealloc {
+    [_name release];
+    [super dealloc];
+}
+
+@synthesize userTime = _userTime;
+@synthesize systemTime = _systemTime;
+@synthesize cpuUsage = _cpuUsage;
+@synthesize runState = _runState;
+@synthesize sleepTime = _sleepTime;
+@synthesize hasPriority = _hasPriority;
+@synthesize basePriority = _basePriority;
+@synthesize currentPriority = _currentPriority;
+@synthesize name = _name;
+@synthesize hasQoSClass = _hasQoSClass;
+@synthesize qosClass = _qosClass;
+
+@end
@@ -0,0 +1,72 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReportUserRegionInfo.h"
+
+/**
+ * Provides the contents of a memory region registered by the crashed application.
+ *
+ * @sa PLCrashReporter::registerMemoryRegion:length:tag:
+ */
+@implementation PLCrashReportUserRegionInfo
+
+/**
+ * Initialize with the provided region.
+ *
+ * @param tag The application-defined tag the region was registered with.
+ * @param address The region's address in the crashed process.
+ * @param length The region's registered length, in bytes.
+ * @param data The region's contents, or nil if the region could not be read.
+ */
+- (id) initWithTag: (uint32_t) tag
+           address: (uint64_t) address
+            length: (uint64_t) length
+              data: (NSData *) data
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _tag = tag;
+    _address = address;
+    _length = length;
+    _data = [data retain];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_data release];
+    [super dealloc];
+}
+
+@synthesize tag = _tag;
+@synthesize address = _address;
+@synthesize length = _length;
+@synthesize data = _data;
+
+@end
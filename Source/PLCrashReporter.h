@@ -30,9 +30,14 @@
 #import <mach/mach.h>
 
 #import "PLCrashReporterConfig.h"
+#import "PLCrashReporterStatistics.h"
 
 @class PLCrashMachExceptionServer;
 @class PLCrashMachExceptionPortSet;
+@class PLCrashHangDetector;
+@class PLCrashCaptureService;
+@class PLCrashPathWarmer;
+@class PLCrashReportStore;
 
 /**
  * @ingroup functions
@@ -94,6 +99,41 @@ typedef enum PLExceptionHandling {
     PLExceptionHandlingUncaughtOnly
 } PLExceptionHandling;
 
+@class PLCrashReporter;
+
+/**
+ * The PLCrashReporterUploadDelegate protocol is adopted by objects that submit batches of queued crash reports
+ * on behalf of PLCrashReporter.
+ *
+ * @sa PLCrashReporter::uploadQueuedCrashReportsWithDelegate:maximumBatchCount:
+ */
+@protocol PLCrashReporterUploadDelegate <NSObject>
+
+/**
+ * Upload a batch of crash reports. This method is called on a low priority background thread, and may block
+ * until the upload completes.
+ *
+ * The batch is a gzip-compressed stream of records, each consisting of a 32-bit big-endian length followed by
+ * that many bytes of crash report data, and is suitable for use as an HTTP request body with a
+ * <tt>Content-Encoding</tt> of <tt>gzip</tt>. The records may be recovered with
+ * PLCrashReporter::crashReportDataFromUploadBatch:error:.
+ *
+ * @param reporter The crash reporter that queued the reports.
+ * @param batch The compressed batch.
+ * @param count The number of crash reports in @a batch.
+ * @param outError A pointer to an NSError object variable. If the upload fails, this pointer may be set to an
+ * error object describing the failure.
+ *
+ * @return Return YES if the batch was uploaded, in which case its reports will be deleted. Return NO to leave the
+ * reports queued; no further batches will be submitted until the next upload is started.
+ */
+- (BOOL) crashReporter: (PLCrashReporter *) reporter
+uploadCrashReportBatch: (NSData *) batch
+           reportCount: (NSUInteger) count
+                 error: (NSError **) outError;
+
+@end
+
 @interface PLCrashReporter : NSObject {
 @private
     /** Reporter configuration */
@@ -109,6 +149,10 @@ typedef enum PLExceptionHandling {
     
     /** Previously registered Mach exception ports, if any. */
     PLCrashMachExceptionPortSet *_previousMachPorts;
+
+    /** EXC_RESOURCE exception ports registered prior to enabling resource reports, or nil if resource reports have
+     * never been enabled. */
+    PLCrashMachExceptionPortSet *_previousResourcePorts;
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
 
     /** Application identifier */
@@ -119,6 +163,39 @@ typedef enum PLExceptionHandling {
 
     /** Path to the crash reporter internal data directory */
     NSString *_crashReportDirectory;
+
+    /** Index of the pending reports in the crash reporter directory, or NULL if not yet opened. */
+    struct plcrash_async_report_index *_reportIndex;
+
+    /** The capacity-bounded store of queued reports, or nil if not yet opened. */
+    PLCrashReportStore *_queuedReportStore;
+
+    /** Worker pool used when generating live reports, or NULL if live report threads are captured serially. */
+    struct plcrash_log_writer_workers *_liveReportWorkers;
+
+    /** Reusable live report writers, each initialized on first use. */
+    struct plcr_live_report_writer *_liveReportWriter;
+
+    /** Non-zero while a background upload of queued reports is running. */
+    volatile int32_t _uploadInProgress;
+
+    /** Breadcrumb ring buffer copied into each report, or NULL if breadcrumbs have not been enabled. */
+    struct plcrash_async_breadcrumb_buffer *_breadcrumbs;
+
+    /** Registry of application memory regions copied into each report. */
+    struct plcrash_async_user_regions *_userRegions;
+
+    /** The main thread hang detector, or nil if hang detection is disabled. */
+    PLCrashHangDetector *_hangDetector;
+
+    /** The out-of-process capture service hosted by this reporter, or nil if no service has been started. */
+    PLCrashCaptureService *_captureService;
+
+    /** The crash path warmer, or nil if crash path warming is disabled. */
+    PLCrashPathWarmer *_crashPathWarmer;
+
+    /** Pending report fingerprints, keyed by report path, as computed when collapsing crash loops. */
+    NSDictionary *_pendingReportFingerprints;
 }
 
 + (PLCrashReporter *) sharedReporter;
@@ -129,6 +206,18 @@ typedef enum PLExceptionHandling {
 
 - (void) loadPendingCrashReportData: (void (^)(NSData *data, BOOL *purge)) block;
 - (void) loadPendingCrashReportData: (void (^)(NSData *data, BOOL *purge)) block andReturnError: (NSError **) outError;
+- (BOOL) loadPendingCrashReportDataWithMaximumBytes: (unsigned long long) maxBytes
+                                              block: (void (^)(NSData *data, BOOL *purge, BOOL *stop)) block
+                                              error: (NSError **) outError;
+- (BOOL) loadPendingCrashReportDataWithMaximumBytes: (unsigned long long) maxBytes
+                                    occurrenceBlock: (void (^)(NSData *data, NSUInteger occurrences, BOOL *purge, BOOL *stop)) block
+                                              error: (NSError **) outError;
+
+- (BOOL) queuePendingCrashReportsAndReturnError: (NSError **) outError;
+- (BOOL) uploadQueuedCrashReportsWithDelegate: (id<PLCrashReporterUploadDelegate>) delegate
+                            maximumBatchCount: (NSUInteger) maxCount
+                                        error: (NSError **) outError;
++ (NSArray *) crashReportDataFromUploadBatch: (NSData *) batch error: (NSError **) outError;
 
 - (NSData *) generateLiveReportWithThread: (thread_t) thread;
 - (NSData *) generateLiveReportWithThread: (thread_t) thread error: (NSError **) outError;
@@ -136,11 +225,38 @@ typedef enum PLExceptionHandling {
 - (NSData *) generateLiveReport;
 - (NSData *) generateLiveReportAndReturnError: (NSError **) outError;
 
+- (PLCrashReporterStatistics *) statistics;
+
+- (BOOL) sampleStackForThread: (thread_t) thread pcs: (uint64_t *) pcs maxCount: (NSUInteger) maxCount count: (NSUInteger *) outCount error: (NSError **) outError;
++ (NSUInteger) captureBacktrace: (uint64_t *) pcs maxCount: (NSUInteger) maxCount skipCount: (NSUInteger) skipCount;
+
+- (BOOL) enableBreadcrumbsWithCapacity: (NSUInteger) capacity recordSize: (NSUInteger) recordSize error: (NSError **) outError;
+- (BOOL) appendBreadcrumb: (const void *) bytes length: (size_t) length;
+
+- (BOOL) registerMemoryRegion: (const void *) address length: (size_t) length tag: (uint32_t) tag;
+- (BOOL) unregisterMemoryRegion: (const void *) address;
+
+- (BOOL) enableHangDetectionWithThreshold: (NSTimeInterval) threshold reportThreshold: (NSTimeInterval) reportThreshold error: (NSError **) outError;
+- (void) disableHangDetection;
+
+- (BOOL) enableResourceReportsWithMinimumInterval: (NSTimeInterval) interval error: (NSError **) outError;
+- (void) disableResourceReports;
+
+- (BOOL) enableTerminationReportsAndReturnError: (NSError **) outError;
+
+- (BOOL) exportImageListWithMemoryEntry: (mach_port_t *) outEntry size: (size_t *) outSize error: (NSError **) outError;
+
+- (BOOL) startCaptureServiceWithName: (NSString *) serviceName workerCount: (NSUInteger) workerCount error: (NSError **) outError;
+- (void) stopCaptureService;
+- (BOOL) registerWithCaptureServiceNamed: (NSString *) serviceName error: (NSError **) outError;
+
 - (BOOL) purgePendingCrashReports;
 - (BOOL) purgePendingCrashReportsAndReturnError: (NSError **) outError;
 
 - (BOOL) enableCrashReporterWithExceptionHandling: (PLExceptionHandling)handling;
 - (BOOL) enableCrashReporterWithExceptionHandling: (PLExceptionHandling)handling andReturnError: (NSError **) outError;
+- (BOOL) enableCrashReporterDeferringSetupWithExceptionHandling: (PLExceptionHandling) handling error: (NSError **) outError;
+- (BOOL) isSetupComplete;
 
 - (void) setCrashCallbacks: (PLCrashReporterCallbacks *) callbacks;
 
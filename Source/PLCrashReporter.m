@@ -38,19 +38,40 @@
 
 #import "PLCrashAsync.h"
 #import "PLCrashLogWriter.h"
+#import "PLCrashReportSymbolication.h"
 #import "PLCrashFrameWalker.h"
 
 #import "PLCrashAsyncMachExceptionInfo.h"
 
 #import "PLCrashReporterNSError.h"
+#import "PLCrashHangDetector.h"
+#import "PLCrashPathWarmer.h"
+#import "PLCrashCaptureService.h"
+#import "PLCrashAsyncAppState.h"
+#import "PLCrashAsyncReportIndex.h"
+#import "PLCrashReportStore.h"
+#import "PLCrashReportFingerprint.h"
+#import "PLCrashSysctl.h"
+#import "PLCrashProcessInfo.h"
+#import "PLCrashProbes.h"
+
+#if TARGET_OS_IPHONE
+#import <UIKit/UIKit.h> // For the UIApplication state notifications
+#endif
 
 #if TARGET_OS_MAC && !TARGET_IPHONE_SIMULATOR && !TARGET_OS_IPHONE
 #import <ExceptionHandling/ExceptionHandling.h>
 #endif
 
 #import <fcntl.h>
+#import <inttypes.h>
+#import <sys/mman.h>
+#import <sys/sysctl.h>
 #import <dlfcn.h>
 #import <mach-o/dyld.h>
+#import <libkern/OSAtomic.h>
+#import <servers/bootstrap.h>
+#import <zlib.h>
 
 #define NSDEBUG(msg, args...) {\
     NSLog(@"[PLCrashReporter] " msg, ## args); \
@@ -61,13 +82,37 @@
 static NSString *PLCRASH_CACHE_DIR = @"com.plausiblelabs.crashreporter.data";
 
 /** @internal
- * Crash Report file name. */
-static NSString *PLCRASH_LIVE_CRASHREPORT = @"live_report.plcrash";
+ * Crash report slot file name prefix. Each slot file is created and opened when the reporter is enabled; the
+ * report is written to a slot at crash time, and the slot is then renamed to its reserved report path. Files with
+ * this prefix are never complete reports. */
+static NSString *PLCRASH_REPORT_SLOT_PREFIX = @"live_report.plcrash.";
+
+/** @internal
+ * Pre-sized, memory mapped crash report slot file name. */
+static NSString *PLCRASH_MAPPED_CRASHREPORT = @"live_report.plcrash.mapped";
 
 /** @internal
  * Directory containing crash reports queued for sending. */
 static NSString *PLCRASH_QUEUED_DIR = @"queued_reports";
 
+/** @internal
+ * Name of the directory, relative to the crash report directory, in which persisted image indices are stored. */
+static NSString *PLCRASH_INDEX_STORE_DIR = @"index_cache";
+
+/** @internal
+ * Resource report output file name. Resource reports are written to this file, and then renamed into the queued
+ * report directory; the slot prefix ensures that an incomplete report is never loaded as a pending report. */
+static NSString *PLCRASH_RESOURCE_REPORT = @"live_report.plcrash.resource";
+
+/** @internal
+ * App state journal file name. The slot prefix ensures that the journal is never loaded as a pending report. */
+static NSString *PLCRASH_APP_STATE_JOURNAL = @"live_report.plcrash.app_state";
+
+/** @internal
+ * Pending report index file name; see PLCrashAsyncReportIndex.h. The slot prefix ensures that the index is never
+ * loaded as a pending report. */
+static NSString *PLCRASH_REPORT_INDEX = @"live_report.plcrash.index";
+
 /** @internal
  * Maximum number of bytes that will be written to the crash report.
  * Used as a safety measure in case of implementation malfunction.
@@ -77,6 +122,39 @@ static NSString *PLCRASH_QUEUED_DIR = @"queued_reports";
  */
 #define MAX_REPORT_BYTES (64 * 1024)
 
+/** @internal
+ * Size of the pre-allocated output buffer used when writing a fatal crash report. This is sufficient to hold
+ * most reports in their entirety, allowing the report to be written with a minimal number of write(2) calls.
+ */
+#define REPORT_FILE_BUFFER_BYTES (16 * 1024)
+
+/** @internal
+ * Number of crash report slot files opened when the reporter is enabled. The first slot is memory mapped, if
+ * possible; the remainder are pre-allocated and written via buffered output. Each fatal report written by the
+ * process claims its own slot, such that no report may overwrite another.
+ */
+#define PLCRASH_REPORT_SLOT_COUNT 3
+
+/** @internal
+ * Number of frames retained from the bottom of any stack that exceeds its frame limit. The outermost frames identify
+ * the thread's entry point, and are more useful than the innermost frames of a deep stack's middle.
+ */
+#define PLCRASH_REPORTER_TAIL_FRAMES 32
+
+/** @internal
+ * Maximum number of threads captured in parallel by the crash-time worker pool; see
+ * PLCrashReporterConfig::crashWorkerCount. Reports of processes with more threads are captured serially. The
+ * capture storage for these threads is reserved, but not touched, when the pool is created.
+ */
+#define PLCRASH_CRASH_WORKER_MAX_THREADS 256
+
+/** @internal
+ * Number of live report writers retained for reuse across calls to -generateLiveReportWithThread:error:. Each
+ * concurrent live report uses its own writer; reports beyond this number of concurrent calls use a transient writer
+ * that is initialized for the call.
+ */
+#define PLCRASH_LIVE_REPORT_WRITER_COUNT 4
+
 /**
  * @internal
  * Fatal signals to be monitored.
@@ -94,6 +172,26 @@ static int monitored_signals[] = {
  * number of signals in the fatal signals list */
 static int monitored_signals_count = (sizeof(monitored_signals) / sizeof(monitored_signals[0]));
 
+/**
+ * @internal
+ * A crash report output file, created, opened and sized when the reporter is enabled, such that writing a report at
+ * crash time requires no path lookup or file allocation.
+ */
+typedef struct plcrash_report_slot {
+    /** Path to the slot file. */
+    const char *path;
+
+    /** The path to which the slot file will be renamed once its report is complete. Each slot is assigned a unique
+     * report path, such that reports written by successive crashes do not overwrite one another. */
+    const char *report_path;
+
+    /** Open descriptor for @a path. */
+    int fd;
+
+    /** Shared writable mapping of MAX_REPORT_BYTES of @a fd, or NULL if the slot is written via buffered output. */
+    void *mapping;
+} plcrash_report_slot_t;
+
 /**
  * @internal
  * Signal handler context
@@ -102,9 +200,35 @@ typedef struct signal_handler_ctx {
     /** PLCrashLogWriter instance */
     plcrash_log_writer_t writer;
 
-    /** Path to the output file */
+    /** Minimal writer used until @a writer is fully configured, or uninitialized if setup was not deferred. See
+     * PLCrashReporter::enableCrashReporterDeferringSetupWithExceptionHandling:error:. */
+    plcrash_log_writer_t minimal_writer;
+
+    /** Non-zero once @a writer and the report slots have been fully configured. */
+    volatile uint32_t setup_complete;
+
+    /** Path to the output file, used if all report slots have been claimed */
     const char *path;
 
+    /** Pending report index, to which each completed report is recorded, or NULL if the index is unavailable. */
+    plcrash_async_report_index_t *report_index;
+
+    /** Pre-allocated output buffer of REPORT_FILE_BUFFER_BYTES, or NULL if unavailable. */
+    void *file_buffer;
+
+    /** Pre-opened report slots. See plcrash_open_report_slots(). */
+    plcrash_report_slot_t slots[PLCRASH_REPORT_SLOT_COUNT];
+
+    /** The number of valid entries in @a slots. */
+    uint32_t slot_count;
+
+    /** The number of report slots claimed at crash time. */
+    volatile int32_t slots_claimed;
+
+    /** The number of bytes of crash-time memory pre-faulted and wired. See
+     * PLCrashReporterConfig::wireCrashTimeMemory. */
+    volatile int64_t wired_size;
+
 #if PLCRASH_FEATURE_MACH_EXCEPTIONS
     /* Previously registered Mach exception ports, if any. Will be left uninitialized if PLCrashReporterSignalHandlerTypeMach
      * is not enabled. */
@@ -119,6 +243,28 @@ typedef struct signal_handler_ctx {
  */
 static plcrash_async_image_list_t shared_image_list;
 
+/**
+ * @internal
+ *
+ * Shared image list population state; see plcrash_populate_shared_image_list().
+ */
+static pthread_once_t shared_image_list_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @internal
+ *
+ * Shared memory journal of the shared image list, or NULL if the image list has not been exported. See
+ * -[PLCrashReporter exportImageListWithMemoryEntry:size:error:].
+ */
+static plcrash_async_image_journal_t *shared_image_journal = NULL;
+
+/**
+ * @internal
+ *
+ * Serializes creation of the shared image journal.
+ */
+static pthread_mutex_t shared_image_journal_lock = PTHREAD_MUTEX_INITIALIZER;
+
 
 /**
  * @internal
@@ -127,6 +273,89 @@ static plcrash_async_image_list_t shared_image_list;
  */
 static plcrashreporter_handler_ctx_t signal_handler_context;
 
+/**
+ * @internal
+ *
+ * App state journal (singleton) storage.
+ */
+static plcrash_async_app_state_t app_state_storage;
+
+/**
+ * @internal
+ *
+ * The app state journal, or NULL if termination reports have not been enabled. See
+ * -[PLCrashReporter enableTerminationReportsAndReturnError:].
+ */
+static plcrash_async_app_state_t *app_state_journal = NULL;
+
+/**
+ * @internal
+ *
+ * Serializes opening of each reporter's pending report index. See -[PLCrashReporter reportIndex].
+ */
+static pthread_mutex_t report_index_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @internal
+ *
+ * Serializes opening of each reporter's queued report store. See -[PLCrashReporter queuedReportStore].
+ */
+static pthread_mutex_t queued_report_store_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @internal
+ *
+ * Serializes the collapsing of crash loops within the pending reports. See
+ * -[PLCrashReporter collapseCrashLoopEntries:].
+ */
+static pthread_mutex_t crash_loop_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+/**
+ * @internal
+ * Non-fatal resource report context. See -[PLCrashReporter enableResourceReportsWithMinimumInterval:error:].
+ */
+typedef struct plcrash_resource_report_ctx {
+    /** Resource report writer. Reports are written while the thread that raised the EXC_RESOURCE exception remains
+     * suspended, and the writer is configured such that no allocation is required. */
+    plcrash_log_writer_t writer;
+
+    /** Pre-allocated output buffer of REPORT_FILE_BUFFER_BYTES. */
+    void *file_buffer;
+
+    /** Path to which an in-progress report is written. */
+    const char *path;
+
+    /** Path prefix, within the queued report directory, to which completed reports are renamed. */
+    const char *report_prefix;
+
+    /** The number of reports queued, used to derive each report's unique path. */
+    uint32_t report_count;
+
+    /** The minimum interval between reports, in mach_absolute_time() units. */
+    uint64_t min_interval;
+
+    /** The time at which the last report was written, in mach_absolute_time() units, or 0. */
+    uint64_t last_report_time;
+
+    /** Non-zero while a report is being written. */
+    volatile int32_t busy;
+
+    /** If false, EXC_RESOURCE exceptions are forwarded without writing a report. */
+    volatile bool enabled;
+
+    /** EXC_RESOURCE exception ports registered prior to enabling resource reports. */
+    plcrash_mach_exception_port_set_t port_set;
+} plcrash_resource_report_ctx_t;
+
+/**
+ * @internal
+ *
+ * Resource report context (singleton)
+ */
+static plcrash_resource_report_ctx_t resource_report_context;
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
 
 /**
  * @internal
@@ -139,6 +368,48 @@ static PLCrashReporterCallbacks crashCallbacks = {
     .handleSignal = NULL
 };
 
+/**
+ * @internal
+ *
+ * Return the writer to be used at crash time: the fully configured writer once setup has completed, or otherwise
+ * the minimal writer initialized when setup was deferred.
+ *
+ * @param sigctx Fatal handler context.
+ */
+static plcrash_log_writer_t *plcrash_handler_writer (plcrashreporter_handler_ctx_t *sigctx) {
+    if (sigctx->setup_complete)
+        return &sigctx->writer;
+
+    return &sigctx->minimal_writer;
+}
+
+/**
+ * @internal
+ *
+ * Record a change to the report at @a path in @a index. This function is async-safe.
+ *
+ * @param index The pending report index, or NULL.
+ * @param path The report's path, within the index's report directory.
+ * @param state The report's new state.
+ * @param size The report's size, in bytes.
+ * @param timestamp The time at which the report was written.
+ * @param synced The value of plcrash_async_report_index_synced(), as determined prior to the change.
+ */
+static void plcrash_report_index_record (plcrash_async_report_index_t *index, const char *path, plcrash_async_report_index_state_t state,
+                                         uint64_t size, int64_t timestamp, bool synced)
+{
+    if (index == NULL)
+        return;
+
+    const char *name = path;
+    for (const char *p = path; *p != '\0'; p++) {
+        if (*p == '/')
+            name = p + 1;
+    }
+
+    plcrash_async_report_index_append(index, state, name, size, timestamp, synced);
+}
+
 /**
  * Write a fatal crash report.
  *
@@ -153,21 +424,47 @@ static plcrash_error_t plcrash_write_report (plcrashreporter_handler_ctx_t *sigc
     plcrash_async_file_t file;
     plcrash_error_t err;
 
-    /* Open the output file */
-    int fd = open(sigctx->path, O_RDWR|O_CREAT|O_TRUNC, 0644);
-    if (fd < 0) {
-        PLCF_DEBUG("Could not open the crashlog output file: %s", strerror(errno));
-        return PLCRASH_EINTERNAL;
+    /* Mark the session as crashed, such that the termination is not also reported on the next launch */
+    if (app_state_journal != NULL)
+        plcrash_async_app_state_set_crashed(app_state_journal);
+
+    /* Until setup has completed, the report slots may be partially opened; the report is written via buffered
+     * output to the standard output path. */
+    plcrash_log_writer_t *writer = plcrash_handler_writer(sigctx);
+    bool setup_complete = (writer == &sigctx->writer);
+
+    /* Claim the next pre-opened report slot, if any remain; each slot may only be used once. */
+    plcrash_report_slot_t *slot = NULL;
+    if (setup_complete) {
+        uint32_t slot_index = (uint32_t) OSAtomicIncrement32Barrier(&sigctx->slots_claimed) - 1;
+        if (slot_index < sigctx->slot_count)
+            slot = &sigctx->slots[slot_index];
+    }
+
+    /* Determine whether the index reflects the report directory before the report is added to it */
+    bool synced = sigctx->report_index != NULL && plcrash_async_report_index_synced(sigctx->report_index);
+
+    if (slot != NULL && slot->mapping != NULL) {
+        plcrash_async_file_init_mapped(&file, slot->fd, slot->mapping, MAX_REPORT_BYTES);
+    } else if (slot != NULL) {
+        plcrash_async_file_init_buffer(&file, slot->fd, MAX_REPORT_BYTES, sigctx->file_buffer, REPORT_FILE_BUFFER_BYTES);
+    } else {
+        /* Open the output file */
+        int fd = open(sigctx->path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+        if (fd < 0) {
+            PLCF_DEBUG("Could not open the crashlog output file: %s", strerror(errno));
+            return PLCRASH_EINTERNAL;
+        }
+
+        /* Initialize the output context */
+        plcrash_async_file_init_buffer(&file, fd, MAX_REPORT_BYTES, sigctx->file_buffer, REPORT_FILE_BUFFER_BYTES);
     }
-    
-    /* Initialize the output context */
-    plcrash_async_file_init(&file, fd, MAX_REPORT_BYTES);
     
     /* Write the crash log using the already-initialized writer */
-    err = plcrash_log_writer_write(&sigctx->writer, crashed_thread, &shared_image_list, &file, siginfo, thread_state);
+    err = plcrash_log_writer_write(writer, crashed_thread, &shared_image_list, &file, siginfo, thread_state);
 
     /* Close the writer; this may also fail (but shouldn't) */
-    if (plcrash_log_writer_close(&sigctx->writer) != PLCRASH_ESUCCESS) {
+    if (plcrash_log_writer_close(writer) != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Failed to close the log writer");
         plcrash_async_file_close(&file);
         return PLCRASH_EINTERNAL;
@@ -179,15 +476,111 @@ static plcrash_error_t plcrash_write_report (plcrashreporter_handler_ctx_t *sigc
         plcrash_async_file_close(&file);
         return PLCRASH_EINTERNAL;
     }
+
+    off_t size = plcrash_async_file_tell(&file);
     
     if (!plcrash_async_file_close(&file)) {
         PLCF_DEBUG("Failed to close output file");
         return PLCRASH_EINTERNAL;
     }
 
+    /* Move the completed report into place */
+    if (slot != NULL && rename(slot->path, slot->report_path) != 0) {
+        PLCF_DEBUG("Failed to move the crash log into place: %s", strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Record the report; a report that could not be written in full is still pending, and is recorded as truncated */
+    plcrash_report_index_record(sigctx->report_index, (slot != NULL) ? slot->report_path : sigctx->path,
+                                (err == PLCRASH_ESUCCESS) ? PLCRASH_ASYNC_REPORT_INDEX_WRITTEN : PLCRASH_ASYNC_REPORT_INDEX_TRUNCATED,
+                                (uint64_t) size, time(NULL), synced);
+
     return err;
 }
 
+/**
+ * @internal
+ *
+ * Create and pre-allocate MAX_REPORT_BYTES of storage for the crash report slot file @a fd. Failure is not fatal;
+ * the file's storage will be allocated as the report is written.
+ *
+ * @param fd The slot file descriptor.
+ */
+static void plcrash_preallocate_report_slot (int fd) {
+#ifdef F_PREALLOCATE
+    fstore_t store = {
+        .fst_flags = F_ALLOCATECONTIG,
+        .fst_posmode = F_PEOFPOSMODE,
+        .fst_offset = 0,
+        .fst_length = MAX_REPORT_BYTES
+    };
+
+    if (fcntl(fd, F_PREALLOCATE, &store) == 0)
+        return;
+
+    /* Fall back to non-contiguous allocation */
+    store.fst_flags = F_ALLOCATEALL;
+    if (fcntl(fd, F_PREALLOCATE, &store) != 0)
+        PLCF_DEBUG("Could not pre-allocate the crashlog output file: %s", strerror(errno));
+#endif
+}
+
+/**
+ * @internal
+ *
+ * Create and open the crash report slot files at @a paths, such that reports may be written at crash time without
+ * issuing an open(2), or allocating file storage. The first slot is sized and memory mapped, allowing the report to be
+ * written without issuing any write(2) calls; if mapping fails, the slot is written via buffered output. Slots that
+ * can't be opened are skipped; if no slot remains at crash time, the report will be written to the standard output
+ * path via buffered output.
+ *
+ * @param sigctx The signal handler context to be configured.
+ * @param paths The paths at which the slot files should be created.
+ * @param report_paths The unique paths to which each slot will be renamed once its report is complete.
+ * @param count The number of entries in @a paths and @a report_paths. Must not exceed PLCRASH_REPORT_SLOT_COUNT.
+ *
+ * @warning This method is not async safe.
+ */
+static void plcrash_open_report_slots (plcrashreporter_handler_ctx_t *sigctx, const char *paths[], const char *report_paths[], uint32_t count) {
+    PLCF_ASSERT(count <= PLCRASH_REPORT_SLOT_COUNT);
+
+    sigctx->slot_count = 0;
+    sigctx->slots_claimed = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        plcrash_report_slot_t *slot = &sigctx->slots[sigctx->slot_count];
+
+        int fd = open(paths[i], O_RDWR|O_CREAT|O_TRUNC, 0644);
+        if (fd < 0) {
+            PLCF_DEBUG("Could not open the crashlog output file %s: %s", paths[i], strerror(errno));
+            continue;
+        }
+
+        plcrash_preallocate_report_slot(fd);
+
+        /* Map the first slot, if possible */
+        void *mapping = NULL;
+        if (i == 0) {
+            if (ftruncate(fd, MAX_REPORT_BYTES) != 0) {
+                PLCF_DEBUG("Could not size the mapped crashlog output file: %s", strerror(errno));
+            } else if ((mapping = mmap(NULL, MAX_REPORT_BYTES, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+                PLCF_DEBUG("Could not map the crashlog output file: %s", strerror(errno));
+                mapping = NULL;
+            }
+
+            /* Buffered output must start from an empty file */
+            if (mapping == NULL)
+                ftruncate(fd, 0);
+        }
+
+        slot->path = strdup(paths[i]); // NOTE: would leak if this were not a singleton struct
+        slot->report_path = strdup(report_paths[i]);
+        slot->fd = fd;
+        slot->mapping = mapping;
+        sigctx->slot_count++;
+    }
+}
+
 /**
  * @internal
  *
@@ -254,6 +647,95 @@ static plcrash_error_t mach_exception_callback_live_cb (plcrash_async_thread_sta
     return plcrash_write_report(plcr_ctx->sigctx, plcr_ctx->crashed_thread, state, plcr_ctx->siginfo);
 }
 
+/**
+ * @internal
+ *
+ * Write a non-fatal resource report for @a thread to @a ctx's output path, and move the completed report into the
+ * queued report directory.
+ *
+ * @param ctx Resource report context.
+ * @param thread The thread that raised the exception. The thread is suspended for the duration of the call.
+ * @param code Mach exception codes.
+ * @param code_count The number of codes provided.
+ */
+static plcrash_error_t plcrash_write_resource_report (plcrash_resource_report_ctx_t *ctx, thread_t thread, mach_exception_data_t code, mach_msg_type_number_t code_count) {
+    plcrash_log_signal_info_t signal_info;
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    plcrash_log_mach_signal_info_t mach_signal_info;
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+
+    /* There is no signal equivalent of EXC_RESOURCE; as with live reports, mock up a SIGTRAP-based signal info */
+    bsd_signal_info.signo = SIGTRAP;
+    bsd_signal_info.code = TRAP_TRACE;
+    bsd_signal_info.address = NULL;
+    signal_info.bsd_info = &bsd_signal_info;
+
+    mach_signal_info.type = EXC_RESOURCE;
+    mach_signal_info.code = code;
+    mach_signal_info.code_count = code_count;
+    signal_info.mach_info = &mach_signal_info;
+
+    int fd = open(ctx->path, O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0) {
+        PLCF_DEBUG("Could not open the resource report output file: %s", strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+    plcrash_async_file_init_buffer(&file, fd, MAX_REPORT_BYTES, ctx->file_buffer, REPORT_FILE_BUFFER_BYTES);
+
+    /* Write the report; the writer fetches the suspended thread's state directly */
+    plcrash_log_writer_reset_async(&ctx->writer);
+    err = plcrash_log_writer_write(&ctx->writer, thread, &shared_image_list, &file, &signal_info, NULL);
+    plcrash_log_writer_close(&ctx->writer);
+
+    if (!plcrash_async_file_flush(&file) && err == PLCRASH_ESUCCESS)
+        err = PLCRASH_EINTERNAL;
+
+    if (!plcrash_async_file_close(&file) && err == PLCRASH_ESUCCESS)
+        err = PLCRASH_EINTERNAL;
+
+    if (err != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Failed to write resource report: %d", err);
+        return err;
+    }
+
+    /* Move the completed report into the queue */
+    char report_path[PATH_MAX];
+    snprintf(report_path, sizeof(report_path), "%s-%" PRIu32 ".plcrash", ctx->report_prefix, ctx->report_count++);
+    if (rename(ctx->path, report_path) != 0) {
+        PLCF_DEBUG("Failed to move the resource report into place: %s", strerror(errno));
+        return PLCRASH_EINTERNAL;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ *
+ * Handle a non-fatal EXC_RESOURCE exception, writing a resource report if enabled, and permitted by the configured
+ * minimum report interval. The exception is then forwarded to any previously registered EXC_RESOURCE handler, and
+ * the thread resumed.
+ */
+static kern_return_t mach_exception_resource_callback (task_t task, thread_t thread, mach_exception_data_t code, mach_msg_type_number_t code_count) {
+    plcrash_resource_report_ctx_t *ctx = &resource_report_context;
+
+    /* Reports are written serially; exceptions raised while a report is in progress are not reported */
+    if (ctx->enabled && OSAtomicCompareAndSwap32Barrier(0, 1, &ctx->busy)) {
+        uint64_t now = mach_absolute_time();
+        if (ctx->last_report_time == 0 || now - ctx->last_report_time >= ctx->min_interval) {
+            ctx->last_report_time = now;
+            plcrash_write_resource_report(ctx, thread, code, code_count);
+        }
+
+        OSAtomicCompareAndSwap32Barrier(1, 0, &ctx->busy);
+    }
+
+    /* The exception is non-fatal; the thread is resumed regardless of any previous handler's result */
+    PLCrashMachExceptionForward(task, thread, EXC_RESOURCE, code, code_count, &ctx->port_set);
+    return KERN_SUCCESS;
+}
+
 static kern_return_t mach_exception_callback (task_t task, thread_t thread, exception_type_t exception_type, mach_exception_data_t code, mach_msg_type_number_t code_count, void *context) {
     plcrashreporter_handler_ctx_t *sigctx = context;
     plcrash_log_signal_info_t signal_info;
@@ -261,6 +743,10 @@ static kern_return_t mach_exception_callback (task_t task, thread_t thread, exce
     plcrash_log_mach_signal_info_t mach_signal_info;
     plcrash_error_t err;
 
+    /* EXC_RESOURCE is only delivered once resource reports have been enabled */
+    if (exception_type == EXC_RESOURCE)
+        return mach_exception_resource_callback(task, thread, code, code_count);
+
     /* Let any other registered server attempt to handle the exception */
     if (PLCrashMachExceptionForward(task, thread, exception_type, code, code_count, &sigctx->port_set) == KERN_SUCCESS)
         return KERN_SUCCESS;
@@ -326,6 +812,10 @@ static kern_return_t mach_exception_callback (task_t task, thread_t thread, exce
  */
 static void image_add_callback (const struct mach_header *mh, intptr_t vmaddr_slide) {
     Dl_info info;
+
+    /* Skip images that were already registered in bulk by +initialize */
+    if (plcrash_nasync_image_list_contains(&shared_image_list, (pl_vm_address_t) mh))
+        return;
     
     /* Look up the image info */
     if (dladdr(mh, &info) == 0) {
@@ -335,6 +825,7 @@ static void image_add_callback (const struct mach_header *mh, intptr_t vmaddr_sl
 
     /* Register the image */
     plcrash_nasync_image_list_append(&shared_image_list, (pl_vm_address_t) mh, info.dli_fname);
+    plcrash_probe_event(PLCRASH_PROBE_PHASE_IMAGE_ADD, (uint64_t) (uintptr_t) mh, plcrash_async_image_list_count(&shared_image_list));
 }
 
 /**
@@ -343,9 +834,20 @@ static void image_add_callback (const struct mach_header *mh, intptr_t vmaddr_sl
  */
 static void image_remove_callback (const struct mach_header *mh, intptr_t vmaddr_slide) {
     plcrash_nasync_image_list_remove(&shared_image_list, (uintptr_t) mh);
+    plcrash_probe_event(PLCRASH_PROBE_PHASE_IMAGE_REMOVE, (uint64_t) (uintptr_t) mh, plcrash_async_image_list_count(&shared_image_list));
 }
 
 
+/**
+ * @internal
+ *
+ * atexit() handler; marks the session as having exited normally.
+ */
+static void app_state_exit_handler (void) {
+    if (app_state_journal != NULL)
+        plcrash_async_app_state_set_clean_exit(app_state_journal);
+}
+
 /**
  * @internal
  *
@@ -358,37 +860,198 @@ static void image_remove_callback (const struct mach_header *mh, intptr_t vmaddr
  */
 static void uncaught_exception_handler (NSException *exception) {
     /* Set the uncaught exception */
-    plcrash_log_writer_set_exception(&signal_handler_context.writer, exception);
+    plcrash_log_writer_set_exception(plcrash_handler_writer(&signal_handler_context), exception);
 
     /* Synchronously trigger the crash handler */
     abort();
 }
 
 
-@interface PLCrashReporter (PrivateMethods)
+/**
+ * @internal
+ *
+ * Maximum uncompressed size of a single upload batch. Reports are added to a batch until this
+ * limit would be exceeded; a single larger report is always submitted alone.
+ */
+#define PLCRASH_UPLOAD_BATCH_MAX_BYTES (1024 * 1024)
 
-- (id) initWithBundle: (NSBundle *) bundle configuration: (PLCrashReporterConfig *) configuration;
-- (id) initWithApplicationIdentifier: (NSString *) applicationIdentifier appVersion: (NSString *) applicationVersion configuration: (PLCrashReporterConfig *) configuration;
+/**
+ * @internal
+ *
+ * Compress @a length bytes from @a data into @a stream, appending any output to @a output.
+ *
+ * @param stream An initialized deflate stream.
+ * @param data The data to compress.
+ * @param length The number of bytes at @a data.
+ * @param flush The zlib flush mode; pass Z_FINISH to terminate the stream.
+ * @param output The buffer to which compressed output will be appended.
+ *
+ * @return Returns Z_OK on success, or a zlib error code on failure.
+ */
+static int pl_batch_deflate (z_stream *stream, const void *data, size_t length, int flush, NSMutableData *output) {
+    uint8_t buffer[16 * 1024];
 
-- (PLCrashMachExceptionServer *) enableMachExceptionServerWithPreviousPortSet: (PLCrashMachExceptionPortSet **) previousPortSet
-                                                                     callback: (PLCrashMachExceptionHandlerCallback) callback
-                                                                      context: (void *) context
-                                                                        error: (NSError **) outError;
+    stream->next_in = (Bytef *) data;
+    stream->avail_in = (uInt) length;
 
-- (plcrash_async_symbol_strategy_t) mapToAsyncSymbolicationStrategy: (PLCrashReporterSymbolicationStrategy) strategy;
+    do {
+        stream->next_out = buffer;
+        stream->avail_out = sizeof(buffer);
 
-- (BOOL) populateCrashReportDirectoryAndReturnError: (NSError **) outError;
-- (NSString *) crashReportDirectory;
-- (NSString *) queuedCrashReportDirectory;
-- (NSString *) crashReportPath;
+        if (deflate(stream, flush) == Z_STREAM_ERROR)
+            return Z_STREAM_ERROR;
 
-@end
+        [output appendBytes: buffer length: sizeof(buffer) - stream->avail_out];
+    } while (stream->avail_out == 0);
 
+    return Z_OK;
+}
 
 /**
- * Crash Reporter.
+ * @internal
  *
- * A PLCrashReporter instance manages process-wide handling of crashes.
+ * Encode @a reports as a gzip-compressed upload batch; refer to PLCrashReporterUploadDelegate for a
+ * description of the batch format.
+ *
+ * @param reports The crash report data to be included in the batch.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an
+ * error object indicating why the batch could not be encoded.
+ *
+ * @return Returns the compressed batch, or nil on error.
+ */
+static NSData *pl_batch_encode (NSArray *reports, NSError **outError) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    /* A windowBits value of 15 + 16 selects the gzip wrapper */
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Could not initialize the upload batch compressor", nil);
+        return nil;
+    }
+
+    NSMutableData *output = [NSMutableData data];
+    int ret = Z_OK;
+
+    for (NSData *report in reports) {
+        uint32_t header = OSSwapHostToBigInt32((uint32_t) [report length]);
+
+        ret = pl_batch_deflate(&stream, &header, sizeof(header), Z_NO_FLUSH, output);
+        if (ret == Z_OK)
+            ret = pl_batch_deflate(&stream, [report bytes], [report length], Z_NO_FLUSH, output);
+
+        if (ret != Z_OK)
+            break;
+    }
+
+    if (ret == Z_OK)
+        ret = pl_batch_deflate(&stream, NULL, 0, Z_FINISH, output);
+
+    deflateEnd(&stream);
+
+    if (ret != Z_OK) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Could not compress the upload batch", nil);
+        return nil;
+    }
+
+    return output;
+}
+
+@interface PLCrashReporter (PrivateMethods)
+
+- (id) initWithBundle: (NSBundle *) bundle configuration: (PLCrashReporterConfig *) configuration;
+- (id) initWithApplicationIdentifier: (NSString *) applicationIdentifier appVersion: (NSString *) applicationVersion configuration: (PLCrashReporterConfig *) configuration;
+
+- (PLCrashMachExceptionServer *) enableMachExceptionServerWithPreviousPortSet: (PLCrashMachExceptionPortSet **) previousPortSet
+                                                                     callback: (PLCrashMachExceptionHandlerCallback) callback
+                                                                      context: (void *) context
+                                                                        error: (NSError **) outError;
+
+- (plcrash_async_symbol_strategy_t) mapToAsyncSymbolicationStrategy: (PLCrashReporterSymbolicationStrategy) strategy;
+- (plcrash_async_symbol_strategy_t) crashTimeSymbolicationStrategy;
+- (NSData *) symbolicateDeferredReportData: (NSData *) data path: (NSString *) path timestamp: (int64_t) timestamp;
+- (void) configureCapturePolicyForWriter: (plcrash_log_writer_t *) writer;
+- (BOOL) enableCrashReporterWithExceptionHandling: (PLExceptionHandling) handling deferSetup: (BOOL) deferSetup error: (NSError **) outError;
+- (BOOL) installCrashReporterWithExceptionHandling: (PLExceptionHandling) handling deferSetup: (BOOL) deferSetup error: (NSError **) outError;
+- (void) completeSetup;
+- (void) completeDeferredSetup;
+- (void) startCrashPathWarmer;
+
+- (BOOL) populateCrashReportDirectoryAndReturnError: (NSError **) outError;
+- (NSString *) crashReportDirectory;
+- (NSString *) queuedCrashReportDirectory;
+- (NSString *) indexStoreDirectory;
+- (NSString *) uniqueCrashReportPath;
+- (NSArray *) sortedCrashReportEntriesInDirectory: (NSString *) directory error: (NSError **) outError;
+- (plcrash_async_report_index_t *) reportIndex;
+- (PLCrashReportStore *) queuedReportStore;
+- (NSArray *) pendingCrashReportEntriesAndReturnError: (NSError **) outError;
+- (NSArray *) indexedCrashReportEntriesAndReturnError: (NSError **) outError;
+- (NSArray *) collapseCrashLoopEntries: (NSArray *) entries;
+- (void) uploadQueuedCrashReportsWithArguments: (NSArray *) arguments;
+
+- (NSData *) generateTerminationReportForSession: (const plcrash_async_app_state_record_t *) session
+                                          reason: (plcrash_async_app_state_termination_t) reason
+                                           error: (NSError **) outError;
+- (void) registerAppStateObservers;
+
+@end
+
+
+/**
+ * @internal
+ *
+ * Register all loaded images with the shared image list, and enable dyld image monitoring.
+ */
+static void shared_image_list_populate (void) {
+    /* Map the dyld shared cache's LINKEDIT region once, to be shared by all cached system images. Failure is
+     * non-fatal; cached images will map their own LINKEDIT segments. */
+    plcrash_nasync_image_list_map_shared_cache(&shared_image_list);
+
+    /* Register all currently loaded images in bulk. dyld will also invoke the add callback for each of these
+     * images upon registration; the callback skips images that are already present. */
+    uint32_t count = _dyld_image_count();
+    pl_vm_address_t *headers = malloc(sizeof(headers[0]) * count);
+    const char **names = malloc(sizeof(names[0]) * count);
+    if (headers != NULL && names != NULL) {
+        size_t found = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            /* An image may be concurrently unloaded, in which case dyld will return NULL */
+            const struct mach_header *header = _dyld_get_image_header(i);
+            const char *name = _dyld_get_image_name(i);
+            if (header == NULL || name == NULL)
+                continue;
+
+            headers[found] = (pl_vm_address_t) header;
+            names[found] = name;
+            found++;
+        }
+
+        plcrash_nasync_image_list_append_all(&shared_image_list, headers, names, found);
+    }
+    free(headers);
+    free(names);
+
+    _dyld_register_func_for_add_image(image_add_callback);
+    _dyld_register_func_for_remove_image(image_remove_callback);
+}
+
+/**
+ * @internal
+ *
+ * Populate the shared image list, if it has not already been populated. Registering and pre-encoding every loaded
+ * image is the most expensive part of enabling the reporter, and is deferred until the list is first required;
+ * concurrent callers block until population completes.
+ *
+ * @warning This function is not async safe.
+ */
+static void plcrash_populate_shared_image_list (void) {
+    pthread_once(&shared_image_list_once, shared_image_list_populate);
+}
+
+/**
+ * Crash Reporter.
+ *
+ * A PLCrashReporter instance manages process-wide handling of crashes.
  */
 @implementation PLCrashReporter
 
@@ -396,13 +1059,22 @@ static void uncaught_exception_handler (NSException *exception) {
     if (![[self class] isEqual: [PLCrashReporter class]])
         return;
 
-    /* Enable dyld image monitoring */
+    /* Reserve address space for memory object mappings; on failure, mappings fall back to individual allocations */
+    plcrash_nasync_mobject_pool_init();
+
+    /* Set up the dyld image list; the list is populated on first use. See plcrash_populate_shared_image_list(). */
     plcrash_nasync_image_list_init(&shared_image_list, mach_task_self());
-    _dyld_register_func_for_add_image(image_add_callback);
-    _dyld_register_func_for_remove_image(image_remove_callback);
+
+    /* Image records are retained for the life of the process; pack their load commands into a shared arena, and
+     * borrow dyld's image paths, rather than holding a mapping and a name copy per image. */
+    plcrash_nasync_image_list_set_compact(&shared_image_list, true);
+
+    /* Pre-encode each image's binary image record at registration time, reducing crash-time output to a copy */
+    plcrash_nasync_image_list_set_record_encoder(&shared_image_list, plcrash_log_writer_encode_binary_image);
 }
 
 
+
 /* (Deprecated) Crash reporter singleton. */
 static PLCrashReporter *sharedReporter = nil;
 
@@ -446,8 +1118,8 @@ static PLCrashReporter *sharedReporter = nil;
  * Returns YES if the application has one or more pending crash reports.
  */
 - (BOOL) hasPendingCrashReports {
-    /* Check for a live crash report file */
-    return [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:[self crashReportDirectory] error:nil] count] > 0;
+    /* Check the report index, falling back on a directory scan if the index is stale */
+    return [[self pendingCrashReportEntriesAndReturnError: NULL] count] > 0;
 }
 
 
@@ -486,33 +1158,332 @@ static PLCrashReporter *sharedReporter = nil;
  * @return Returns nil if the crash report data could not be loaded.
  */
 - (void) loadPendingCrashReportData: (void (^)(NSData *data, BOOL *purge)) block andReturnError: (NSError **) outError {
+    [self loadPendingCrashReportDataWithMaximumBytes: 0 block: ^(NSData *data, BOOL *purge, BOOL *stop) {
+        block(data, purge);
+    } error: outError];
+}
+
+/**
+ * Incrementally load pending crash reports, oldest first, executing the block on the data for each crash
+ * report.
+ *
+ * Each report is memory mapped where possible, and is unmapped once the block returns; only one report is
+ * resident at a time, regardless of the number of pending reports.
+ *
+ * @param maxBytes The maximum total size, in bytes, of the reports to load. Loading stops once this many bytes
+ * have been provided to the block; remaining reports are left pending. A single report larger than @a maxBytes
+ * will still be provided if it is the first report loaded. Pass 0 for no limit.
+ * @param block A block to execute on each crash report. If purge is set to YES, the crash report will be deleted
+ * after the block completes. If stop is set to YES, no further reports will be loaded.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash report could not be
+ * loaded. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns NO if an error occurs loading or purging the pending reports, YES otherwise.
+ */
+- (BOOL) loadPendingCrashReportDataWithMaximumBytes: (unsigned long long) maxBytes
+                                              block: (void (^)(NSData *data, BOOL *purge, BOOL *stop)) block
+                                              error: (NSError **) outError
+{
+    return [self loadPendingCrashReportDataWithMaximumBytes: maxBytes occurrenceBlock: ^(NSData *data, NSUInteger occurrences, BOOL *purge, BOOL *stop) {
+        block(data, purge, stop);
+    } error: outError];
+}
+
+/**
+ * Incrementally load pending crash reports, oldest first, executing the block on the data and occurrence count of
+ * each crash report.
+ *
+ * If PLCrashReporterConfig::crashLoopDeduplicationWindow is non-zero, pending reports with equal fingerprints that
+ * were written within the window of one another are collapsed into the oldest such report prior to loading, and
+ * the number of crashes it describes is provided as its occurrence count. Otherwise, the occurrence count of each
+ * report is 1.
+ *
+ * @param maxBytes The maximum total size, in bytes, of the reports to load. See
+ * loadPendingCrashReportDataWithMaximumBytes:block:error:. Pass 0 for no limit.
+ * @param block A block to execute on each crash report. If purge is set to YES, the crash report (and thus all of
+ * its occurrences) will be deleted after the block completes. If stop is set to YES, no further reports will be
+ * loaded.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash report could not be
+ * loaded. If no error occurs, this parameter will be left unmodified. You may specify
+ * nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns NO if an error occurs loading or purging the pending reports, YES otherwise.
+ */
+- (BOOL) loadPendingCrashReportDataWithMaximumBytes: (unsigned long long) maxBytes
+                                    occurrenceBlock: (void (^)(NSData *data, NSUInteger occurrences, BOOL *purge, BOOL *stop)) block
+                                              error: (NSError **) outError
+{
+    NSFileManager *fm = [NSFileManager defaultManager];
     NSError *error = nil;
-    NSArray *files = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:[self crashReportDirectory] error:&error];
-    if (error) {
-        *outError = error;
-        return;
-    }
 
-    /* Load the (memory mapped) data */
-    [files enumerateObjectsUsingBlock:^(NSString *filename, NSUInteger index, BOOL *stop) {
-        NSString *file = [[self crashReportDirectory] stringByAppendingPathComponent:filename];
-        NSError *err = nil;
-        NSData *contents = [[NSData alloc] initWithContentsOfFile:file options:0 error:&err];
-        if (err) {
-            *stop = YES;
+    NSArray *entries = [self pendingCrashReportEntriesAndReturnError: &error];
+    if (entries == nil) {
+        if (outError != NULL)
             *outError = error;
-        } else {
-            BOOL purge = NO;
-            block(contents, &purge);
-            if (purge) [[NSFileManager defaultManager] removeItemAtPath:file error:&err];
-            if (err) {
-                *stop = YES;
-                *outError = error;
+        return NO;
+    }
+
+    plcrash_async_report_index_t *index = [self reportIndex];
+    unsigned long long loaded = 0;
+    BOOL result = YES;
+
+    /* Entries are returned newest first */
+    for (NSArray *entry in [entries reverseObjectEnumerator]) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSString *file = [entry objectAtIndex: 0];
+        unsigned long long size = [[entry objectAtIndex: 1] unsignedLongLongValue];
+        int64_t timestamp = [[entry objectAtIndex: 2] longLongValue];
+        NSUInteger occurrences = [[entry objectAtIndex: 3] unsignedIntegerValue];
+        BOOL stop = NO;
+
+        /* Enforce the byte cap prior to mapping the report, where its size is known */
+        if (maxBytes != 0 && loaded != 0 && loaded + size > maxBytes) {
+            [pool release];
+            break;
+        }
+
+        /* Map the data; this is released (and unmapped) with the pool */
+        NSData *contents = [NSData dataWithContentsOfFile: file options: NSDataReadingMappedIfSafe error: &error];
+        if (contents == nil) {
+            result = NO;
+            [error retain];
+            [pool release];
+            [error autorelease];
+            break;
+        }
+
+        /* Symbolicate the report, if symbolication was deferred at crash time */
+        contents = [self symbolicateDeferredReportData: contents path: file timestamp: timestamp];
+
+        /* Enforce the byte cap */
+        if (maxBytes != 0 && loaded != 0 && loaded + [contents length] > maxBytes) {
+            [pool release];
+            break;
+        }
+        loaded += [contents length];
+
+        BOOL purge = NO;
+        block(contents, occurrences, &purge, &stop);
+        if (purge) {
+            bool synced = index != NULL && plcrash_async_report_index_synced(index);
+            if (![fm removeItemAtPath: file error: &error]) {
+                result = NO;
+                [error retain];
+                [pool release];
+                [error autorelease];
+                break;
             }
+            plcrash_report_index_record(index, [file fileSystemRepresentation], PLCRASH_ASYNC_REPORT_INDEX_PURGED, 0, 0, synced);
         }
-    }];
+
+        [pool release];
+        if (stop)
+            break;
+    }
+
+    if (!result && outError != NULL)
+        *outError = error;
+
+    return result;
+}
+
+
+/**
+ * Move all pending crash reports to the reporter's upload queue, from which they may be submitted
+ * in the background via uploadQueuedCrashReportsWithDelegate:maximumBatchCount:error:.
+ *
+ * Queuing a report requires only a rename; the report data is not read. Queued reports are no longer
+ * considered pending, and will not be returned by loadPendingCrashReportData:.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending crash reports could not be queued.
+ * If no error occurs, this parameter will be left unmodified. You may specify nil for this parameter,
+ * and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) queuePendingCrashReportsAndReturnError: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+
+    /* Nothing to queue if the crash reporter directory has not yet been created */
+    if (![fm fileExistsAtPath: [self crashReportDirectory]])
+        return YES;
+
+    NSArray *entries = [self pendingCrashReportEntriesAndReturnError: outError];
+    if (entries == nil)
+        return NO;
+
+    if ([entries count] == 0)
+        return YES;
+
+    if (![self populateCrashReportDirectoryAndReturnError: outError])
+        return NO;
+
+    PLCrashReportStore *store = [self queuedReportStore];
+    if (store == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not open the queued report store", nil);
+        return NO;
+    }
+
+    plcrash_async_report_index_t *index = [self reportIndex];
+    for (NSArray *entry in [entries reverseObjectEnumerator]) {
+        NSString *path = [entry objectAtIndex: 0];
+
+        /* The store assigns each queued report a unique name; the modification date (and thus the upload order) is
+         * preserved by the move. Older queued reports are evicted as required by the configured capacity. */
+        bool synced = index != NULL && plcrash_async_report_index_synced(index);
+        if (![store moveReportAtPath: path error: outError])
+            return NO;
+        plcrash_report_index_record(index, [path fileSystemRepresentation], PLCRASH_ASYNC_REPORT_INDEX_UPLOADED, 0, 0, synced);
+    }
+
+    return YES;
+}
+
+/**
+ * Write @a data to the queued crash report directory, to be submitted along with the other queued reports by
+ * uploadQueuedCrashReportsWithDelegate:maximumBatchCount:error:.
+ *
+ * @param data The encoded report to be queued.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be queued. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO on error.
+ */
+- (BOOL) queueReportData: (NSData *) data error: (NSError **) outError {
+    if (![self populateCrashReportDirectoryAndReturnError: outError])
+        return NO;
+
+    PLCrashReportStore *store = [self queuedReportStore];
+    if (store == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not open the queued report store", nil);
+        return NO;
+    }
+
+    return [store writeReportData: data error: outError];
+}
+
+/**
+ * Queue any pending crash reports, and then submit all queued crash reports to @a delegate from a low priority
+ * background thread.
+ *
+ * Queued reports are read oldest first, and are compressed into batches of at most @a maxCount reports; refer
+ * to PLCrashReporterUploadDelegate for a description of the batch format. The reports in each batch are deleted
+ * once the delegate reports that the batch was uploaded. If an upload fails, the remaining reports are left queued,
+ * to be submitted by a later call to this method.
+ *
+ * The caller's thread performs no I/O beyond that required by queuePendingCrashReportsAndReturnError:, allowing
+ * this method to be called at application launch.
+ *
+ * @param delegate The delegate to which batches will be submitted. The delegate is retained until the background
+ * upload completes.
+ * @param maxCount The maximum number of reports to include in a single batch, or 0 for no limit. Regardless of
+ * @a maxCount, batches are limited to approximately 1MB of uncompressed report data.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the upload could not be started. If no error occurs,
+ * this parameter will be left unmodified. You may specify nil for this parameter, and no error information
+ * will be provided.
+ *
+ * @return Returns YES if the background upload was started, or NO on error. If an upload is already in progress,
+ * NO will be returned with an error code of PLCrashReporterErrorResourceBusy.
+ */
+- (BOOL) uploadQueuedCrashReportsWithDelegate: (id<PLCrashReporterUploadDelegate>) delegate
+                            maximumBatchCount: (NSUInteger) maxCount
+                                        error: (NSError **) outError
+{
+    if (!OSAtomicCompareAndSwap32Barrier(0, 1, &_uploadInProgress)) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"An upload of queued crash reports is already in progress", nil);
+        return NO;
+    }
+
+    if (![self queuePendingCrashReportsAndReturnError: outError]) {
+        OSAtomicCompareAndSwap32Barrier(1, 0, &_uploadInProgress);
+        return NO;
+    }
+
+    /* The thread retains both the receiver and its arguments until it exits */
+    NSArray *arguments = [NSArray arrayWithObjects: delegate, [NSNumber numberWithUnsignedInteger: maxCount], nil];
+    [NSThread detachNewThreadSelector: @selector(uploadQueuedCrashReportsWithArguments:) toTarget: self withObject: arguments];
+
+    return YES;
 }
 
+/**
+ * Decode an upload batch produced by uploadQueuedCrashReportsWithDelegate:maximumBatchCount:error:.
+ *
+ * @param batch The compressed batch, as provided to PLCrashReporterUploadDelegate.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the batch could not be decoded. If no error occurs,
+ * this parameter will be left unmodified. You may specify nil for this parameter, and no error information
+ * will be provided.
+ *
+ * @return Returns an array containing the NSData of each crash report in @a batch, in order, or nil on error.
+ */
++ (NSArray *) crashReportDataFromUploadBatch: (NSData *) batch error: (NSError **) outError {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    /* A windowBits value of 15 + 32 accepts either a zlib or gzip wrapper */
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Could not initialize the upload batch decompressor", nil);
+        return nil;
+    }
+
+    NSMutableData *records = [NSMutableData dataWithCapacity: [batch length] * 4];
+    uint8_t buffer[16 * 1024];
+    int ret;
+
+    stream.next_in = (Bytef *) [batch bytes];
+    stream.avail_in = (uInt) [batch length];
+
+    do {
+        stream.next_out = buffer;
+        stream.avail_out = sizeof(buffer);
+
+        ret = inflate(&stream, Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END)
+            break;
+
+        [records appendBytes: buffer length: sizeof(buffer) - stream.avail_out];
+    } while (ret != Z_STREAM_END);
+
+    inflateEnd(&stream);
+
+    if (ret != Z_STREAM_END) {
+        plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"Could not decompress the upload batch", nil);
+        return nil;
+    }
+
+    /* Split the records */
+    NSMutableArray *reports = [NSMutableArray array];
+    const uint8_t *bytes = [records bytes];
+    size_t offset = 0;
+
+    while (offset < [records length]) {
+        uint32_t length;
+
+        if ([records length] - offset < sizeof(length)) {
+            plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"The upload batch is truncated", nil);
+            return nil;
+        }
+        memcpy(&length, bytes + offset, sizeof(length));
+        length = OSSwapBigToHostInt32(length);
+        offset += sizeof(length);
+
+        if ([records length] - offset < length) {
+            plcrash_populate_error(outError, PLCrashReporterErrorCrashReportInvalid, @"The upload batch is truncated", nil);
+            return nil;
+        }
+        [reports addObject: [records subdataWithRange: NSMakeRange(offset, length)]];
+        offset += length;
+    }
+
+    return reports;
+}
 
 /**
  * Purge all pending crash reports.
@@ -539,6 +1510,14 @@ static PLCrashReporter *sharedReporter = nil;
 
     __block BOOL wasError = NO;
     [reports enumerateObjectsUsingBlock:^(NSString *filename, NSUInteger index, BOOL *stop) {
+        /* The index is retained, and emptied below */
+        if ([filename isEqualToString: PLCRASH_REPORT_INDEX])
+            return;
+
+        /* Persisted image indices are not reports, and remain valid */
+        if ([filename isEqualToString: PLCRASH_INDEX_STORE_DIR])
+            return;
+
         NSString *file = [[self crashReportDirectory] stringByAppendingPathComponent:filename];
         NSError *err = nil;
         [[NSFileManager defaultManager] removeItemAtPath:file error:&err];
@@ -549,6 +1528,18 @@ static PLCrashReporter *sharedReporter = nil;
         }
     }];
 
+    /* The queued report directory, and its store index, have been removed; the store is re-opened on next use */
+    pthread_mutex_lock(&queued_report_store_lock); {
+        [_queuedReportStore release];
+        _queuedReportStore = nil;
+    } pthread_mutex_unlock(&queued_report_store_lock);
+
+    /* No reports remain; mark the now-empty index as in sync with the directory */
+    plcrash_async_report_index_t *reportIndex = [self reportIndex];
+    plcrash_async_report_index_stamp_t stamp;
+    if (!wasError && reportIndex != NULL && plcrash_async_report_index_stamp(reportIndex, &stamp) == PLCRASH_ESUCCESS)
+        plcrash_nasync_report_index_rewrite(reportIndex, NULL, 0, &stamp);
+
     return wasError;
 }
 
@@ -599,6 +1590,77 @@ static PLCrashReporter *sharedReporter = nil;
  * This restriction may be removed in a future release.
  */
 - (BOOL) enableCrashReporterWithExceptionHandling: (PLExceptionHandling)handling andReturnError: (NSError **) outError {
+    return [self enableCrashReporterWithExceptionHandling: handling deferSetup: NO error: outError];
+}
+
+/**
+ * Enable the crash reporter, deferring all but the minimal setup required to report a crash to a background thread.
+ *
+ * The signal and Mach exception handlers, and the uncaught exception handler, are installed synchronously, as per
+ * enableCrashReporterWithExceptionHandling:andReturnError:. Registration and pre-encoding of the loaded images,
+ * pre-opening of the crash report files, allocation of the crash-time caches and memory budget, and symbol indexing
+ * are then completed on a background thread, reducing the cost of enabling the reporter at launch.
+ *
+ * @par Degraded Mode
+ *
+ * A crash that occurs before the background setup has completed (see PLCrashReporter::isSetupComplete) is still
+ * reported, with the following limitations:
+ *
+ * - The report is written via buffered write(2) calls to a newly opened file, rather than to a pre-opened and mapped
+ *   report file.
+ * - Only the images registered at the time of the crash are written; frames within images that have not yet been
+ *   registered are not symbolicated, and are walked without the benefit of their unwind information.
+ * - The report is not compressed, and includes no memory summary, regardless of the reporter's configuration. No
+ *   crash-time memory budget is reserved.
+ *
+ * @param handling Determines what kinds of @a NSException instances will be handled by the crash reporter.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error in
+ * the PLCrashReporterErrorDomain indicating why the Crash Reporter could not be enabled. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the crash reporter could not be enabled.
+ *
+ * @sa PLCrashReporter::enableCrashReporterWithExceptionHandling:andReturnError:
+ */
+- (BOOL) enableCrashReporterDeferringSetupWithExceptionHandling: (PLExceptionHandling) handling error: (NSError **) outError {
+    return [self enableCrashReporterWithExceptionHandling: handling deferSetup: YES error: outError];
+}
+
+/**
+ * Return YES if the crash reporter has been enabled, and its setup has completed. If enabled via
+ * enableCrashReporterDeferringSetupWithExceptionHandling:error:, crashes prior to the completion of setup are
+ * reported in a degraded mode.
+ */
+- (BOOL) isSetupComplete {
+    return _enabled && signal_handler_context.setup_complete != 0;
+}
+
+/**
+ * @internal
+ *
+ * Enable the crash reporter, as per enableCrashReporterWithExceptionHandling:andReturnError:.
+ *
+ * @param handling Determines what kinds of @a NSException instances will be handled by the crash reporter.
+ * @param deferSetup If YES, setup is completed on a background thread; see
+ * enableCrashReporterDeferringSetupWithExceptionHandling:error:.
+ * @param outError A pointer to an NSError object variable, or nil.
+ */
+- (BOOL) enableCrashReporterWithExceptionHandling: (PLExceptionHandling) handling deferSetup: (BOOL) deferSetup error: (NSError **) outError {
+    plcrash_probe_interval_t probe;
+
+    plcrash_probe_begin(&probe, PLCRASH_PROBE_PHASE_ENABLE, deferSetup);
+    BOOL result = [self installCrashReporterWithExceptionHandling: handling deferSetup: deferSetup error: outError];
+    plcrash_probe_end(&probe, result, plcrash_async_image_list_count(&shared_image_list), 0, 0);
+
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Register the crash reporter's handlers, as per enableCrashReporterWithExceptionHandling:deferSetup:error:.
+ */
+- (BOOL) installCrashReporterWithExceptionHandling: (PLExceptionHandling) handling deferSetup: (BOOL) deferSetup error: (NSError **) outError {
     /* Prevent enabling more than one crash reporter, process wide. We can not support multiple chained reporters
      * due to the use of NSUncaughtExceptionHandler (it doesn't support chaining or assocation of context with the callbacks), as
      * well as our legacy approach of deregistering any signal handlers upon the first signal. Once PLCrashUncaughtExceptionHandler is
@@ -621,16 +1683,26 @@ static PLCrashReporter *sharedReporter = nil;
     if (_enabled)
         [NSException raise: PLCrashReporterException format: @"The crash reporter has alread been enabled"];
 
-    /* Create the directory tree */
+    /* Create the directory tree. This is always performed synchronously, as a crash during deferred setup is written
+     * to the report directory; once the tree exists, this requires only a stat(2) per directory. */
     if (![self populateCrashReportDirectoryAndReturnError: outError])
         return NO;
 
     /* Set up the signal handler context */
-    signal_handler_context.path = strdup([[self crashReportPath] UTF8String]); // NOTE: would leak if this were not a singleton struct
+    signal_handler_context.path = strdup([[self uniqueCrashReportPath] UTF8String]); // NOTE: would leak if this were not a singleton struct
+    signal_handler_context.report_index = [self reportIndex];
+    signal_handler_context.file_buffer = malloc(REPORT_FILE_BUFFER_BYTES); // NOTE: If NULL, the file's default buffer will be used
     assert(_applicationIdentifier != nil);
     assert(_applicationVersion != nil);
-    plcrash_log_writer_init(&signal_handler_context.writer, _applicationIdentifier, _applicationVersion, [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy], false);
-    
+
+    /* If setup is deferred, a crash prior to its completion is written by a minimal writer; otherwise, setup is
+     * completed before any handler is registered. */
+    if (deferSetup) {
+        plcrash_log_writer_init(&signal_handler_context.minimal_writer, _applicationIdentifier, _applicationVersion, [self crashTimeSymbolicationStrategy], false);
+        [self configureCapturePolicyForWriter: &signal_handler_context.minimal_writer];
+    } else {
+        [self completeSetup];
+    }
     
     /* Enable the signal handler */
     switch (_config.signalHandlerType) {
@@ -639,6 +1711,14 @@ static PLCrashReporter *sharedReporter = nil;
                 if (![[PLCrashSignalHandler sharedHandler] registerHandlerForSignal: monitored_signals[i] callback: &signal_handler_callback context: &signal_handler_context error: outError])
                     return NO;
             }
+
+            /* Provide alternate signal stacks to new threads; this is non-fatal, as only stack overflows on
+             * threads other than the current thread will go unreported. */
+            if (_config.threadSignalStackCount > 0) {
+                NSError *stackError;
+                if (![[PLCrashSignalHandler sharedHandler] enableThreadSignalStacks: _config.threadSignalStackCount error: &stackError])
+                    NSLog(@"Could not enable thread signal stacks: %@", stackError);
+            }
             break;
 
 #if PLCRASH_FEATURE_MACH_EXCEPTIONS
@@ -685,6 +1765,16 @@ static PLCrashReporter *sharedReporter = nil;
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
     }
 
+    /* Pre-fault and wire the alternate signal stacks; this is non-fatal, as the stacks will have been faulted in
+     * regardless. */
+    if (_config.wireCrashTimeMemory) {
+        size_t wired = 0;
+        NSError *wireError;
+        if (![[PLCrashSignalHandler sharedHandler] wireSignalStacks: &wired error: &wireError])
+            NSLog(@"Could not wire the alternate signal stacks: %@", wireError);
+        OSAtomicAdd64Barrier(wired, &signal_handler_context.wired_size);
+    }
+
     /* Set the uncaught exception handler */
     if (handling == PLExceptionHandlingUncaughtOnly)
         NSSetUncaughtExceptionHandler(&uncaught_exception_handler);
@@ -704,6 +1794,11 @@ static PLCrashReporter *sharedReporter = nil;
 
     /* Success */
     _enabled = YES;
+
+    /* Complete setup in the background; the thread retains the receiver until it exits */
+    if (deferSetup)
+        [NSThread detachNewThreadSelector: @selector(completeDeferredSetup) toTarget: self withObject: nil];
+
     return YES;
 }
 
@@ -723,9 +1818,131 @@ static PLCrashReporter *sharedReporter = nil;
 }
 
 
-/* State and callback used by -generateLiveReportWithThread */
-struct plcr_live_report_context {
-    plcrash_log_writer_t *writer;
+/**
+ * @internal
+ *
+ * A reusable live report writer. The writer is initialized on first use and then reset for each subsequent report,
+ * avoiding the cost of re-fetching the process, machine and system information for every live report.
+ */
+struct plcr_live_report_slot {
+    /** Held for the duration of each report written with @a writer. */
+    pthread_mutex_t lock;
+
+    /** If true, @a writer has been initialized. */
+    bool initialized;
+
+    /** The live report writer. */
+    plcrash_log_writer_t writer;
+};
+
+/**
+ * @internal
+ *
+ * The live report writers, shared across calls to -generateLiveReportWithThread:error:. Each live report claims an
+ * idle writer slot, allowing live reports to be generated concurrently from multiple threads; all per-report state,
+ * including the writer's symbol and unwind caches, is owned by the claimed slot.
+ */
+struct plcr_live_report_writer {
+    /** The reusable writers. */
+    struct plcr_live_report_slot slots[PLCRASH_LIVE_REPORT_WRITER_COUNT];
+
+    /** The slot at which the next live report begins its search for an idle writer. */
+    volatile uint32_t next_slot;
+
+    /** Protects @a report_count and @a latency_histogram. */
+    pthread_mutex_t stats_lock;
+
+    /** The number of live reports successfully generated. */
+    uint64_t report_count;
+
+    /** Live report latency histogram; see PLCrashReporterStatistics::liveReportLatencyHistogram. */
+    uint64_t latency_histogram[PLCRASH_STATISTICS_LATENCY_BUCKETS];
+};
+
+/**
+ * @internal
+ *
+ * Convert a mach_absolute_time() interval to nanoseconds.
+ */
+static uint64_t plcr_mach_time_to_ns (uint64_t interval) {
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0 && (mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.denom == 0))
+        return interval;
+
+    return (interval * timebase.numer) / timebase.denom;
+}
+
+/**
+ * @internal
+ *
+ * Record a live report generated in @a elapsed mach_absolute_time() units.
+ */
+static void plcr_live_report_record (struct plcr_live_report_writer *live, uint64_t elapsed) {
+    uint64_t ms = plcr_mach_time_to_ns(elapsed) / NSEC_PER_MSEC;
+
+    /* Bucket i counts latencies < 2^i ms; the final bucket is unbounded */
+    size_t bucket = 0;
+    while (bucket < PLCRASH_STATISTICS_LATENCY_BUCKETS - 1 && ms >= (1ULL << bucket))
+        bucket++;
+
+    pthread_mutex_lock(&live->stats_lock);
+    live->report_count++;
+    live->latency_histogram[bucket]++;
+    pthread_mutex_unlock(&live->stats_lock);
+}
+
+/**
+ * @internal
+ *
+ * Claim an idle writer slot from @a live, returning with the slot's lock held. If all slots are in use, a transient
+ * slot is allocated; it must be freed via plcr_live_report_slot_release().
+ *
+ * @param live The live report writers.
+ *
+ * @return Returns the claimed slot, or NULL if all slots are in use and a transient slot could not be allocated.
+ */
+static struct plcr_live_report_slot *plcr_live_report_slot_claim (struct plcr_live_report_writer *live) {
+    /* Spread concurrent callers across the slots, rather than having all callers contend for the first slot */
+    uint32_t first = (uint32_t) OSAtomicIncrement32((volatile int32_t *) &live->next_slot);
+    for (uint32_t i = 0; i < PLCRASH_LIVE_REPORT_WRITER_COUNT; i++) {
+        struct plcr_live_report_slot *slot = &live->slots[(first + i) % PLCRASH_LIVE_REPORT_WRITER_COUNT];
+        if (pthread_mutex_trylock(&slot->lock) == 0)
+            return slot;
+    }
+
+    /* All writers are busy; rather than waiting on another report, write the report with a new writer */
+    struct plcr_live_report_slot *slot = calloc(1, sizeof(*slot));
+    if (slot == NULL)
+        return NULL;
+
+    pthread_mutex_init(&slot->lock, NULL);
+    pthread_mutex_lock(&slot->lock);
+    return slot;
+}
+
+/**
+ * @internal
+ *
+ * Release a @a slot claimed via plcr_live_report_slot_claim(), freeing the slot if it is transient.
+ *
+ * @param live The live report writers from which @a slot was claimed.
+ * @param slot The slot to be released.
+ */
+static void plcr_live_report_slot_release (struct plcr_live_report_writer *live, struct plcr_live_report_slot *slot) {
+    pthread_mutex_unlock(&slot->lock);
+
+    if (slot >= live->slots && slot < live->slots + PLCRASH_LIVE_REPORT_WRITER_COUNT)
+        return;
+
+    if (slot->initialized)
+        plcrash_log_writer_free(&slot->writer);
+    pthread_mutex_destroy(&slot->lock);
+    free(slot);
+}
+
+/* State and callback used by -generateLiveReportWithThread */
+struct plcr_live_report_context {
+    plcrash_log_writer_t *writer;
     plcrash_async_file_t *file;
     plcrash_log_signal_info_t *info;
 };
@@ -740,6 +1957,10 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
  * This may be used to log current process state without actually crashing. The crash report data will be
  * returned on success.
  *
+ * This method is thread-safe, and may be called concurrently from multiple threads; each call writes its report
+ * with its own writer and caches. The threads of the process are suspended only while their state is captured, and
+ * concurrent calls serialize only this capture.
+ *
  * @param thread The thread which will be marked as the failing thread in the generated report.
  * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
  * will contain an error object indicating why the crash report could not be generated or loaded. If no
@@ -747,29 +1968,96 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
  * error information will be provided.
  *
  * @return Returns nil if the crash report data could not be loaded.
- *
- * @todo Implement in-memory, rather than requiring writing of the report to disk.
  */
 - (NSData *) generateLiveReportWithThread: (thread_t) thread error: (NSError **) outError {
-    plcrash_log_writer_t writer;
+    return [self generateLiveReportWithThread: thread hang: NULL error: outError];
+}
+
+/**
+ * Generate a live crash report for a given @a thread, as per generateLiveReportWithThread:error:, optionally
+ * including the details of a hang detected on @a thread.
+ *
+ * @param thread The thread which will be marked as the failing thread in the generated report.
+ * @param hang The hang details to be included in the report, or NULL.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be generated. If no error occurs, this parameter will be left
+ * unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns nil if the crash report data could not be generated.
+ */
+- (NSData *) generateLiveReportWithThread: (thread_t) thread hang: (const plcrash_log_writer_hang_info_t *) hang error: (NSError **) outError {
+    struct plcr_live_report_writer *live = _liveReportWriter;
+    struct plcr_live_report_slot *slot;
+    plcrash_probe_interval_t probe;
     plcrash_async_file_t file;
     plcrash_error_t err;
 
-    /* Open the output file */
-    NSString *templateStr = [NSTemporaryDirectory() stringByAppendingPathComponent: @"live_crash_report.XXXXXX"];
-    char *path = strdup([templateStr fileSystemRepresentation]);
-    
-    int fd = mkstemp(path);
-    if (fd < 0) {
-        plcrash_populate_posix_error(outError, errno, NSLocalizedString(@"Failed to create temporary path", @"Error opening temporary output path"));
-        free(path);
+    plcrash_probe_begin(&probe, PLCRASH_PROBE_PHASE_LIVE_REPORT, thread);
+    uint64_t start = mach_absolute_time();
 
+    /* The report requires the full image list */
+    plcrash_populate_shared_image_list();
+
+    /* Write the report directly to memory; the output buffer bounds the report size, as MAX_REPORT_BYTES
+     * does for on-disk reports. */
+    NSMutableData *data = [NSMutableData dataWithLength: MAX_REPORT_BYTES];
+    if (data == nil) {
+        plcrash_probe_end(&probe, PLCRASH_ENOMEM, 0, 0, 0);
+        plcrash_populate_posix_error(outError, ENOMEM, NSLocalizedString(@"Failed to allocate the live report buffer", @"Error allocating live report output"));
         return nil;
     }
 
-    /* Initialize the output context */
-    plcrash_log_writer_init(&writer, _applicationIdentifier, _applicationVersion, [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy], true);
-    plcrash_async_file_init(&file, fd, MAX_REPORT_BYTES);
+    /* Claim a writer for this report */
+    if ((slot = plcr_live_report_slot_claim(live)) == NULL) {
+        plcrash_probe_end(&probe, PLCRASH_ENOMEM, 0, 0, 0);
+        plcrash_populate_posix_error(outError, ENOMEM, NSLocalizedString(@"Failed to allocate the live report writer", @"Error allocating live report writer"));
+        return nil;
+    }
+
+    /* Initialize the writer on first use; otherwise, reset it for a new report */
+    if (!slot->initialized) {
+        err = plcrash_log_writer_init(&slot->writer, _applicationIdentifier, _applicationVersion, [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy], true);
+        if (err != PLCRASH_ESUCCESS) {
+            plcrash_log_writer_free(&slot->writer);
+            plcr_live_report_slot_release(live, slot);
+
+            plcrash_probe_end(&probe, err, 0, 0, 0);
+            NSLog(@"Writer initialization failed with error %s", plcrash_async_strerror(err));
+            plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to initialize the crash report writer", nil);
+            return nil;
+        }
+
+        [self configureCapturePolicyForWriter: &slot->writer];
+        plcrash_log_writer_set_workers(&slot->writer, _liveReportWorkers);
+
+        /* Other live reports may be written concurrently */
+        plcrash_log_writer_set_reentrant(&slot->writer, true);
+
+        /* Resume the target threads as soon as their state has been captured, rather than stalling them for
+         * the duration of the report */
+        plcrash_log_writer_set_snapshot_threads(&slot->writer, true);
+
+        /* Retain unwind data across live reports */
+        plcrash_log_writer_set_persistent_unwind(&slot->writer, true);
+
+        /* Record which threads were running, for use in diagnosing hangs */
+        if (plcrash_log_writer_set_thread_info(&slot->writer, true) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Could not allocate the live report thread info table");
+
+        /* Repeated live reports, such as those of the hang detector, reuse the frames of threads that have not moved */
+        if (plcrash_log_writer_set_unwind_cache(&slot->writer, true) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Could not allocate the live report unwind cache");
+
+        if (_config.captureMemorySummary && plcrash_log_writer_set_memory_summary(&slot->writer, true) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Could not allocate the live report memory summary");
+
+        slot->initialized = true;
+    } else {
+        plcrash_log_writer_reset(&slot->writer);
+    }
+
+    plcrash_async_file_init_memory(&file, [data mutableBytes], [data length]);
+    plcrash_log_writer_set_hang(&slot->writer, hang);
     
     /* Mock up a SIGTRAP-based signal info */
     plcrash_log_bsd_signal_info_t bsd_signal_info;
@@ -784,46 +2072,36 @@ static plcrash_error_t plcr_live_report_callback (plcrash_async_thread_state_t *
     /* Write the crash log using the already-initialized writer */
     if (thread == pl_mach_thread_self()) {
         struct plcr_live_report_context ctx = {
-            .writer = &writer,
+            .writer = &slot->writer,
             .file = &file,
             .info = &signal_info
         };
         err = plcrash_async_thread_state_current(plcr_live_report_callback, &ctx);
     } else {
-        err = plcrash_log_writer_write(&writer, thread, &shared_image_list, &file, &signal_info, NULL);
+        err = plcrash_log_writer_write(&slot->writer, thread, &shared_image_list, &file, &signal_info, NULL);
     }
-    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_set_hang(&slot->writer, NULL);
+    plcrash_log_writer_close(&slot->writer);
+    plcrash_log_writer_report_summary_t summary = slot->writer.last_report;
+    if (err == PLCRASH_ESUCCESS)
+        plcr_live_report_record(live, mach_absolute_time() - start);
+    plcr_live_report_slot_release(live, slot);
 
-    /* Flush the data */
-    plcrash_async_file_flush(&file);
-    plcrash_async_file_close(&file);
+    /* Index the DWARF data of any images that required a linear FDE scan while writing the report, allowing
+     * future lookups within those images -- including at crash time -- to be performed via binary search. */
+    plcrash_nasync_image_list_index_dwarf(&shared_image_list);
+
+    plcrash_probe_end(&probe, err, summary.thread_count, summary.frame_count, plcrash_async_image_list_count(&shared_image_list));
 
     /* Check for write failure */
-    NSData *data;
     if (err != PLCRASH_ESUCCESS) {
         NSLog(@"Write failed with error %s", plcrash_async_strerror(err));
-        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the crash report to disk", nil);
-        data = nil;
-        goto cleanup;
-    }
-
-    data = [NSData dataWithContentsOfFile: [NSString stringWithUTF8String: path]];
-    if (data == nil) {
-        /* This should only happen if our data is deleted out from under us */
-        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, NSLocalizedString(@"Unable to open live crash report for reading", nil), nil);
-        goto cleanup;
-    }
-
-cleanup:
-    /* Finished -- clean up. */
-    plcrash_log_writer_free(&writer);
-
-    if (unlink(path) != 0) {
-        /* This shouldn't fail, but if it does, there's no use in returning nil */
-        NSLog(@"Failure occured deleting live crash report: %s", strerror(errno));
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the crash report", nil);
+        return nil;
     }
 
-    free(path);
+    /* Trim the buffer to the written report */
+    [data setLength: (NSUInteger) plcrash_async_file_tell(&file)];
     return data;
 }
 
@@ -852,10 +2130,1002 @@ cleanup:
  * 
  * @return Returns nil if the crash report data could not be loaded.
  */
-- (NSData *) generateLiveReportAndReturnError: (NSError **) outError {
-    return [self generateLiveReportWithThread: pl_mach_thread_self() error: outError];
+- (NSData *) generateLiveReportAndReturnError: (NSError **) outError {
+    return [self generateLiveReportWithThread: pl_mach_thread_self() error: outError];
+}
+
+/**
+ * Return a snapshot of the counters maintained by the crash reporter, including the registered image list's
+ * memory footprint and index build costs, live report latency, and crash-time memory usage.
+ *
+ * @warning This method is not async safe, and acquires the image list's read lock; it should not be
+ * called at a high frequency.
+ */
+- (PLCrashReporterStatistics *) statistics {
+    plcrash_async_image_list_stats_t stats;
+    plcrash_nasync_image_list_get_stats(&shared_image_list, &stats);
+
+    /* Per-image index build times */
+    NSMutableDictionary *indexTimes = [NSMutableDictionary dictionary];
+    plcrash_async_image_list_set_reading(&shared_image_list, true); {
+        plcrash_async_image_t *image = NULL;
+        while ((image = plcrash_async_image_list_next(&shared_image_list, image)) != NULL) {
+            if (image->index_time == 0 || image->macho_image.name == NULL)
+                continue;
+
+            NSString *path = [NSString stringWithUTF8String: image->macho_image.name];
+            if (path == nil)
+                continue;
+
+            NSTimeInterval seconds = (NSTimeInterval) plcr_mach_time_to_ns((uint64_t) image->index_time) / NSEC_PER_SEC;
+            [indexTimes setObject: [NSNumber numberWithDouble: seconds] forKey: path];
+        }
+    } plcrash_async_image_list_set_reading(&shared_image_list, false);
+
+    /* Live report counters */
+    uint64_t reportCount = 0;
+    NSMutableArray *histogram = [NSMutableArray arrayWithCapacity: PLCRASH_STATISTICS_LATENCY_BUCKETS];
+    pthread_mutex_lock(&_liveReportWriter->stats_lock); {
+        reportCount = _liveReportWriter->report_count;
+        for (size_t i = 0; i < PLCRASH_STATISTICS_LATENCY_BUCKETS; i++)
+            [histogram addObject: [NSNumber numberWithUnsignedLongLong: _liveReportWriter->latency_histogram[i]]];
+    } pthread_mutex_unlock(&_liveReportWriter->stats_lock);
+
+    /* The crash-time allocator is only reserved once setup has completed */
+    size_t reserved = 0;
+    size_t used = 0;
+    if ([self isSetupComplete] && signal_handler_context.writer.allocator != NULL)
+        plcrash_async_allocator_get_usage(signal_handler_context.writer.allocator, &reserved, &used);
+
+    /* The warmer is created prior to setup completing */
+    uint64_t warmedSize = 0;
+    uint64_t pageInCount = 0;
+    if ([self isSetupComplete] && _crashPathWarmer != nil) {
+        warmedSize = _crashPathWarmer.warmedSize;
+        pageInCount = _crashPathWarmer.pageInCount;
+    }
+
+    NSTimeInterval indexTime = (NSTimeInterval) plcr_mach_time_to_ns(stats.index_time) / NSEC_PER_SEC;
+    return [[[PLCrashReporterStatistics alloc] initWithRegisteredImageCount: stats.image_count
+                                                         imageListFootprint: stats.footprint
+                                                            imageIndexBytes: stats.index_bytes
+                                                             imageIndexTime: indexTime
+                                                            imageIndexTimes: indexTimes
+                                                            liveReportCount: reportCount
+                                                 liveReportLatencyHistogram: histogram
+                                                    crashTimeMemoryReserved: reserved
+                                                        crashTimeMemoryUsed: used
+                                                       crashTimeMemoryWired: (uint64_t) signal_handler_context.wired_size
+                                                        crashPathWarmedSize: warmedSize
+                                                       crashPathPageInCount: pageInCount
+                                                    symbolIndexMemoryBudget: stats.warmup_budget
+                                                      symbolIndexMemoryUsed: stats.warmup_used] autorelease];
+}
+
+
+/* State and callback used by -sampleStackForThread:pcs:maxCount:count:error: and +captureBacktrace:maxCount:skipCount: */
+struct plcr_stack_sample_context {
+    /** Output PC buffer. */
+    uint64_t *pcs;
+
+    /** Capacity of @a pcs. */
+    size_t max_count;
+
+    /** Number of innermost frames to be walked, but not written to @a pcs. */
+    size_t skip_count;
+
+    /** If true, the thread state was acquired from the calling thread via plcrash_async_thread_state_current(). */
+    bool current_thread;
+
+    /** Number of PCs written to @a pcs. */
+    size_t count;
+};
+static plcrash_error_t plcr_stack_sample_callback (plcrash_async_thread_state_t *state, void *ctx) {
+    struct plcr_stack_sample_context *sample_ctx = ctx;
+    plcrash_async_macho_section_cache_t local_cache;
+    plcrash_async_macho_section_cache_t *section_cache;
+    plframe_cursor_t cursor;
+    plframe_error_t ferr;
+    size_t skipped = 0;
+
+    sample_ctx->count = 0;
+
+    if (sample_ctx->current_thread)
+        ferr = plframe_cursor_current_thread_init(&cursor, state, &shared_image_list);
+    else
+        ferr = plframe_cursor_init(&cursor, mach_task_self(), state, &shared_image_list);
+
+    if (ferr != PLFRAME_ESUCCESS) {
+        plframe_cursor_free(&cursor);
+        PLCF_DEBUG("An error occured initializing the frame cursor: %s", plframe_strerror(ferr));
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Hold the image list for reading while the section cache is in use. The list's persistent cache is preferred;
+     * it may be held by another thread -- including a suspended target thread -- in which case a local cache is used. */
+    plcrash_async_image_list_set_reading(&shared_image_list, true);
+    if ((section_cache = plcrash_nasync_image_list_acquire_unwind_cache(&shared_image_list)) == NULL) {
+        plcrash_async_macho_section_cache_init(&local_cache);
+        section_cache = &local_cache;
+    }
+    plframe_cursor_set_section_cache(&cursor, section_cache);
+    plframe_cursor_set_pipeline(&cursor, PLFRAME_CURSOR_PIPELINE_FAST);
+
+    while (sample_ctx->count < sample_ctx->max_count && (ferr = plframe_cursor_next(&cursor)) == PLFRAME_ESUCCESS) {
+        plcrash_greg_t pc;
+        if ((ferr = plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc)) != PLFRAME_ESUCCESS)
+            break;
+
+        if (skipped < sample_ctx->skip_count) {
+            skipped++;
+            continue;
+        }
+
+        sample_ctx->pcs[sample_ctx->count++] = pc;
+    }
+
+    plframe_cursor_free(&cursor);
+    if (section_cache == &local_cache)
+        plcrash_async_macho_section_cache_free(&local_cache);
+    else
+        plcrash_nasync_image_list_release_unwind_cache(&shared_image_list, section_cache);
+    plcrash_async_image_list_set_reading(&shared_image_list, false);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Capture the call stack of @a thread as raw PC values, without symbolication, binary image enumeration, report
+ * encoding, or file IO. This is considerably cheaper than generating a live report, and is intended for use in
+ * frequent sampling (eg, hang detection).
+ *
+ * The target thread is suspended only for the duration of the stack walk. Other threads are not suspended.
+ *
+ * @param thread The thread to sample. This may be the current thread.
+ * @param pcs The buffer into which the thread's PC values will be written, ordered from the innermost frame outward.
+ * @param maxCount The maximum number of PC values to be written to @a pcs. Deeper stacks are truncated.
+ * @param outCount On success, will be set to the number of PC values written to @a pcs.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the stack could not be sampled. If no error occurs, this parameter
+ * will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the thread's stack could not be sampled.
+ */
+- (BOOL) sampleStackForThread: (thread_t) thread pcs: (uint64_t *) pcs maxCount: (NSUInteger) maxCount count: (NSUInteger *) outCount error: (NSError **) outError {
+    struct plcr_stack_sample_context ctx = {
+        .pcs = pcs,
+        .max_count = maxCount,
+        .skip_count = 0,
+        .current_thread = (thread == pl_mach_thread_self()),
+        .count = 0
+    };
+    plcrash_probe_interval_t probe;
+    plcrash_error_t err;
+
+    plcrash_probe_begin(&probe, PLCRASH_PROBE_PHASE_SAMPLE, thread);
+    plcrash_populate_shared_image_list();
+
+    if (ctx.current_thread) {
+        err = plcrash_async_thread_state_current(plcr_stack_sample_callback, &ctx);
+    } else {
+        plcrash_async_thread_state_t state;
+        kern_return_t kr;
+
+        if ((kr = thread_suspend(thread)) != KERN_SUCCESS) {
+            plcrash_probe_end(&probe, PLCRASH_EINTERNAL, 0, 0, 0);
+            plcrash_populate_mach_error(outError, kr, @"Failed to suspend the target thread");
+            return NO;
+        }
+
+        err = plcrash_async_thread_state_mach_thread_init(&state, thread);
+        if (err == PLCRASH_ESUCCESS)
+            err = plcr_stack_sample_callback(&state, &ctx);
+
+        thread_resume(thread);
+    }
+
+    plcrash_probe_end(&probe, err, ctx.count, 0, 0);
+
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to sample the thread's stack", nil);
+        return NO;
+    }
+
+    *outCount = ctx.count;
+    return YES;
+}
+
+/**
+ * Capture the calling thread's call stack as raw PC values, ordered from the caller of this method outward.
+ *
+ * This is intended as a replacement for backtrace(3) and -[NSThread callStackReturnAddresses] at instrumentation
+ * call sites (eg, breadcrumbs or slow-operation logging), and is cheap enough to be called thousands of times per
+ * second: the stack is walked in place using the fast frame reader pipeline and the shared unwind cache, no memory
+ * is allocated, no Mach traps are required once the unwind data of the walked images has been cached, and no crash
+ * reporter instance need be enabled. PC values are not symbolicated.
+ *
+ * @param pcs The buffer into which the PC values will be written.
+ * @param maxCount The maximum number of PC values to be written to @a pcs. Deeper stacks are truncated.
+ * @param skipCount The number of frames to omit above the caller of this method, eg, to exclude the frames of an
+ * instrumentation wrapper. If zero, the first PC is the return address into the calling function.
+ *
+ * @return Returns the number of PC values written to @a pcs, or 0 if the stack could not be walked.
+ */
++ (NSUInteger) captureBacktrace: (uint64_t *) pcs maxCount: (NSUInteger) maxCount skipCount: (NSUInteger) skipCount {
+    /* The initial frame is this method, and is always skipped */
+    struct plcr_stack_sample_context ctx = {
+        .pcs = pcs,
+        .max_count = maxCount,
+        .skip_count = skipCount + 1,
+        .current_thread = true,
+        .count = 0
+    };
+
+    if (maxCount == 0)
+        return 0;
+
+    plcrash_populate_shared_image_list();
+    if (plcrash_async_thread_state_current(plcr_stack_sample_callback, &ctx) != PLCRASH_ESUCCESS)
+        return 0;
+
+    return ctx.count;
+}
+
+/**
+ * Enable the capture of application breadcrumbs. A fixed-size ring buffer of @a capacity records, each of up to
+ * @a recordSize bytes, is allocated, and its most recent records are included in all subsequently written crash and
+ * live reports (see PLCrashReport::breadcrumbs).
+ *
+ * Breadcrumbs may be enabled before or after the crash reporter itself, but only once.
+ *
+ * @param capacity The number of records to retain. Will be rounded up to a power of two, and may not exceed 65536.
+ * @param recordSize The maximum size of a single record, in bytes. May not exceed 1024.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why breadcrumbs could not be enabled. If no error occurs, this parameter
+ * will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if breadcrumbs could not be enabled.
+ */
+- (BOOL) enableBreadcrumbsWithCapacity: (NSUInteger) capacity recordSize: (NSUInteger) recordSize error: (NSError **) outError {
+    if (_breadcrumbs != NULL) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"Breadcrumbs have already been enabled", nil);
+        return NO;
+    }
+
+    plcrash_async_breadcrumb_buffer_t *buffer = malloc(sizeof(*buffer));
+    if (buffer == NULL) {
+        plcrash_populate_posix_error(outError, ENOMEM, @"Failed to allocate the breadcrumb buffer");
+        return NO;
+    }
+
+    plcrash_error_t err = plcrash_nasync_breadcrumb_buffer_init(buffer, (uint32_t) MIN(capacity, UINT32_MAX), (uint32_t) MIN(recordSize, UINT32_MAX));
+    if (err != PLCRASH_ESUCCESS) {
+        free(buffer);
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to initialize the breadcrumb buffer", nil);
+        return NO;
+    }
+
+    /* Publish the buffer before attaching it to any writer */
+    _breadcrumbs = buffer;
+    OSMemoryBarrier();
+
+    /* Attach the buffer to any writers that have already been configured. If setup is still in progress, the
+     * buffer is attached to the crash-time writer once it is published. */
+    if (_enabled)
+        plcrash_log_writer_set_breadcrumbs(plcrash_handler_writer(&signal_handler_context), buffer);
+
+    if (_liveReportWriter != NULL) {
+        for (size_t i = 0; i < PLCRASH_LIVE_REPORT_WRITER_COUNT; i++) {
+            struct plcr_live_report_slot *slot = &_liveReportWriter->slots[i];
+            pthread_mutex_lock(&slot->lock);
+            if (slot->initialized)
+                plcrash_log_writer_set_breadcrumbs(&slot->writer, buffer);
+            pthread_mutex_unlock(&slot->lock);
+        }
+    }
+
+    return YES;
+}
+
+/**
+ * Append a breadcrumb record. If the breadcrumb buffer is full, the oldest record is replaced.
+ *
+ * @param bytes The record data.
+ * @param length The length of @a bytes. Records longer than the configured record size are truncated.
+ *
+ * @return Returns YES if the record was appended in full, or NO if breadcrumbs have not been enabled or the record was
+ * truncated.
+ *
+ * @par Async Safety
+ * This method is lock-free, does not allocate memory, and may be called concurrently from any thread.
+ *
+ * @sa PLCrashReporter::enableBreadcrumbsWithCapacity:recordSize:error:
+ */
+- (BOOL) appendBreadcrumb: (const void *) bytes length: (size_t) length {
+    if (_breadcrumbs == NULL)
+        return NO;
+
+    return plcrash_async_breadcrumb_buffer_append(_breadcrumbs, bytes, length) == PLCRASH_ESUCCESS;
+}
+
+/**
+ * Register a memory region whose contents will be copied verbatim into all subsequently written crash and live
+ * reports (see PLCrashReport::userRegions). This is intended for small, critical state structures -- such as the
+ * current screen, request identifier, or feature flags -- that would otherwise need to be encoded by a post-crash
+ * callback; the region is copied at crash time without any encoding or callback.
+ *
+ * The region is read at the time the report is written, and its memory must remain valid until it is unregistered.
+ * If the region has been deallocated at the time of the crash, the report will include its registration, but not its
+ * contents.
+ *
+ * @param address The region's address.
+ * @param length The region's length, in bytes. May not exceed 4096.
+ * @param tag An application-defined tag identifying the region in the report.
+ *
+ * @return Returns YES on success, or NO if the region is invalid, or the maximum of 16 regions are already registered.
+ *
+ * @par Async Safety
+ * This method is lock-free, does not allocate memory, and may be called concurrently from any thread.
+ *
+ * @sa PLCrashReporter::unregisterMemoryRegion:
+ */
+- (BOOL) registerMemoryRegion: (const void *) address length: (size_t) length tag: (uint32_t) tag {
+    return plcrash_async_user_regions_add(_userRegions, address, length, tag) == PLCRASH_ESUCCESS;
+}
+
+/**
+ * Unregister a memory region previously registered with PLCrashReporter::registerMemoryRegion:length:tag:. If the
+ * region was registered more than once, only one registration is removed.
+ *
+ * @param address The region's address.
+ *
+ * @return Returns YES on success, or NO if the region was not registered.
+ *
+ * @par Async Safety
+ * This method is lock-free, does not allocate memory, and may be called concurrently from any thread.
+ */
+- (BOOL) unregisterMemoryRegion: (const void *) address {
+    return plcrash_async_user_regions_remove(_userRegions, address) == PLCRASH_ESUCCESS;
+}
+
+
+/**
+ * Enable detection of main thread hangs.
+ *
+ * A run loop observer and a watchdog thread are used to detect run loop passes on the main thread that exceed
+ * @a threshold. While such a hang is in progress, the main thread's stack is periodically sampled using the same
+ * lightweight mechanism as sampleStackForThread:pcs:maxCount:count:error:. If the hang persists for
+ * @a reportThreshold, a live report is generated -- marking the main thread as the crashed thread, and including
+ * the samples recorded during the hang (see PLCrashReport::hangInfo) -- and is placed directly in the queue of
+ * reports to be submitted by uploadQueuedCrashReportsWithDelegate:maximumBatchCount:error:. At most one report is
+ * generated per hang.
+ *
+ * The detector's overhead is limited to two stores per main run loop pass, and a watchdog wakeup every
+ * @a threshold / 2 seconds; it is suitable for use in production.
+ *
+ * This method must be called from the main thread.
+ *
+ * @param threshold The minimum duration of a main run loop pass that is considered to be a hang, in seconds.
+ * @param reportThreshold The duration after which a hang is escalated to a live report, in seconds. Must be greater
+ * than or equal to @a threshold.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why hang detection could not be enabled. If no error occurs, this parameter
+ * will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if hang detection could not be enabled. If hang detection is already enabled,
+ * NO will be returned with an error code of PLCrashReporterErrorResourceBusy.
+ */
+- (BOOL) enableHangDetectionWithThreshold: (NSTimeInterval) threshold reportThreshold: (NSTimeInterval) reportThreshold error: (NSError **) outError {
+    if (_hangDetector != nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"Hang detection has already been enabled", nil);
+        return NO;
+    }
+
+    if (!pthread_main_np()) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Hang detection must be enabled from the main thread", nil);
+        return NO;
+    }
+
+    if (threshold <= 0 || reportThreshold < threshold) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Invalid hang detection threshold", nil);
+        return NO;
+    }
+
+    PLCrashHangDetector *detector = [[PLCrashHangDetector alloc] initWithReporter: self
+                                                                           thread: pl_mach_thread_self()
+                                                                          runLoop: CFRunLoopGetMain()
+                                                                        threshold: threshold
+                                                                  reportThreshold: reportThreshold];
+    if (detector == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Could not allocate the hang detector", nil);
+        return NO;
+    }
+
+    if (![detector startAndReturnError: outError]) {
+        [detector release];
+        return NO;
+    }
+
+    _hangDetector = detector;
+    return YES;
+}
+
+/**
+ * Disable main thread hang detection, as enabled by enableHangDetectionWithThreshold:reportThreshold:error:. If a hang
+ * report is being generated, this method blocks until it has been queued. If hang detection is not enabled, this
+ * method is a no-op.
+ */
+- (void) disableHangDetection {
+    [_hangDetector stop];
+    [_hangDetector release];
+    _hangDetector = nil;
+}
+
+/**
+ * Enable non-fatal resource reports.
+ *
+ * The kernel raises a non-fatal EXC_RESOURCE Mach exception when a thread or task exceeds a resource limit, such as
+ * the CPU usage or idle wakeup limits that iOS uses to identify, and eventually terminate, processes that drain the
+ * battery. Once enabled, the Mach exception handler writes a report for each such exception -- marking the thread
+ * that raised the exception as the crashed thread, and including its Mach exception codes (see
+ * PLCrashReport::machExceptionInfo) -- and places it directly in the queue of reports to be submitted by
+ * uploadQueuedCrashReportsWithDelegate:maximumBatchCount:error:. The thread is then resumed.
+ *
+ * Reports are written on the Mach exception server thread while the thread that raised the exception is suspended,
+ * using the same allocation-free path used for fatal crash reports; a crash on another thread will be handled once
+ * any in-progress resource report has been written.
+ *
+ * The crash reporter must have been enabled with PLCrashReporterSignalHandlerTypeMach. Requires iOS 5.1 or
+ * Mac OS X 10.8.
+ *
+ * @param interval The minimum interval between resource reports, in seconds. Exceptions raised within @a interval
+ * of the previous report are forwarded to any previously registered handler without writing a report.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why resource reports could not be enabled. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if resource reports could not be enabled.
+ */
+- (BOOL) enableResourceReportsWithMinimumInterval: (NSTimeInterval) interval error: (NSError **) outError {
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    plcrash_resource_report_ctx_t *ctx = &resource_report_context;
+
+    if (_machServer == nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Resource reports require that the Mach exception handler be enabled", nil);
+        return NO;
+    }
+
+    if (interval < 0) {
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Invalid resource report interval", nil);
+        return NO;
+    }
+
+    /* EXC_RESOURCE was added in xnu 12.x (iOS 5.1, Mac OS X 10.8) */
+    PLCrashHostInfo *hinfo = [PLCrashHostInfo currentHostInfo];
+    if (hinfo == nil || hinfo.darwinVersion.major < 12) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"EXC_RESOURCE is not supported by this operating system", nil);
+        return NO;
+    }
+
+    mach_timebase_info_data_t timebase;
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.numer == 0) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not fetch the mach timebase", nil);
+        return NO;
+    }
+
+    /* The writer and exception port are configured once, and retained for the lifetime of the process */
+    if (_previousResourcePorts == nil) {
+        if (![self populateCrashReportDirectoryAndReturnError: outError])
+            return NO;
+
+        CFUUIDRef uuid = CFUUIDCreate(NULL);
+        NSString *name = [(NSString *) CFUUIDCreateString(NULL, uuid) autorelease];
+        CFRelease(uuid);
+
+        ctx->path = strdup([[[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_RESOURCE_REPORT] UTF8String]); // NOTE: would leak if this were not a singleton struct
+        ctx->report_prefix = strdup([[[self queuedCrashReportDirectory] stringByAppendingPathComponent: name] UTF8String]);
+        ctx->file_buffer = malloc(REPORT_FILE_BUFFER_BYTES); // NOTE: If NULL, the file's default buffer will be used
+
+        /* Resource reports are written from the exception server thread, and require the full image list */
+        plcrash_populate_shared_image_list();
+
+        plcrash_error_t err = plcrash_log_writer_init(&ctx->writer, _applicationIdentifier, _applicationVersion, [self crashTimeSymbolicationStrategy], true);
+        if (err != PLCRASH_ESUCCESS) {
+            NSLog(@"Writer initialization failed with error %s", plcrash_async_strerror(err));
+            plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to initialize the resource report writer", nil);
+            return NO;
+        }
+        [self configureCapturePolicyForWriter: &ctx->writer];
+
+        /* Record each thread's CPU usage, identifying the threads responsible for the resource violation */
+        if (plcrash_log_writer_set_thread_info(&ctx->writer, true) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Could not allocate the resource report thread info table");
+
+        if (_config.captureMemorySummary && plcrash_log_writer_set_memory_summary(&ctx->writer, true) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Could not allocate the resource report memory summary");
+
+        NSError *osError;
+        PLCrashMachExceptionPort *port = [_machServer exceptionPortWithMask: EXC_MASK_RESOURCE error: &osError];
+        if (port == nil) {
+            plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to instantiate the Mach exception port.", osError);
+            return NO;
+        }
+
+        PLCrashMachExceptionPortSet *previous;
+        if (![port registerForTask: mach_task_self() previousPortSet: &previous error: &osError]) {
+            plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Failed to set the target task's mach exception ports.", osError);
+            return NO;
+        }
+
+        _previousResourcePorts = [previous retain];
+        ctx->port_set = [previous asyncSafeRepresentation];
+    }
+
+    ctx->min_interval = (uint64_t) (interval * 1000000000.0) * timebase.denom / timebase.numer;
+    ctx->last_report_time = 0;
+
+    /* Ensure that the exception handler has a consistent view of the above initialization */
+    OSMemoryBarrier();
+    ctx->enabled = true;
+
+    return YES;
+#else
+    plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Mach exception handling is not supported on this platform", nil);
+    return NO;
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+}
+
+/**
+ * Disable non-fatal resource reports, as enabled by enableResourceReportsWithMinimumInterval:error:. Subsequent
+ * EXC_RESOURCE exceptions are forwarded to any previously registered handler. If resource reports are not enabled,
+ * this method is a no-op.
+ */
+- (void) disableResourceReports {
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    resource_report_context.enabled = false;
+    OSMemoryBarrier();
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+}
+
+/**
+ * Enable reports for terminations that can not be observed by the crash reporter's signal and Mach exception
+ * handlers.
+ *
+ * The system terminates applications that exceed their memory limit (jetsam), or that fail to respond to the
+ * system watchdog, via SIGKILL; no crash report can be written for these terminations. Once enabled, the reporter
+ * maintains a small memory mapped journal of the application's state: whether it is in the foreground, whether the
+ * main thread is hung (if hang detection is enabled), whether a low memory warning has been received, its most
+ * recently sampled memory footprint, and whether the session exited normally or wrote a crash report. The journal
+ * is updated with plain stores to the mapping, and no system calls.
+ *
+ * When this method is called, the journal left by the previous session is read. If the previous session was
+ * terminated without writing a crash report, and the termination can not be explained by an application update,
+ * OS update, reboot or attached debugger, a report describing the probable cause of the termination -- see
+ * PLCrashReport::terminationInfo -- is written as a pending crash report, to be returned by
+ * loadPendingCrashReportData: and hasPendingCrashReports. Reports are written for sessions terminated while the
+ * main thread was hung (a probable watchdog termination), and for sessions terminated in the foreground (a probable
+ * out-of-memory termination); background terminations are routine, and are not reported.
+ *
+ * This method should be called early in the application's launch, from the main thread. The inferred reasons are
+ * heuristic: for example, a user force quitting a foreground application on Mac OS X will be reported as a probable
+ * out-of-memory termination.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why termination reports could not be enabled. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if termination reports could not be enabled. If termination reports are
+ * already enabled, NO will be returned with an error code of PLCrashReporterErrorResourceBusy.
+ */
+- (BOOL) enableTerminationReportsAndReturnError: (NSError **) outError {
+    if (app_state_journal != NULL) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"Termination reports have already been enabled", nil);
+        return NO;
+    }
+
+    if (![self populateCrashReportDirectoryAndReturnError: outError])
+        return NO;
+
+    /* Fetch the values used to identify benign terminations */
+    int64_t bootTime = 0;
+    {
+        struct timeval boottime;
+        size_t length = sizeof(boottime);
+        if (sysctlbyname("kern.boottime", &boottime, &length, NULL, 0) == 0 && length == sizeof(boottime))
+            bootTime = boottime.tv_sec;
+    }
+
+    char *osBuild = plcrash_sysctl_string("kern.osversion");
+    BOOL traced = [[PLCrashProcessInfo currentProcessInfo] isTraced];
+
+    /* Open the journal, fetching the previous session's record */
+    NSString *path = [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_APP_STATE_JOURNAL];
+    plcrash_async_app_state_record_t previous;
+    bool hasPrevious;
+    plcrash_error_t err = plcrash_nasync_app_state_open(&app_state_storage, [path fileSystemRepresentation], [_applicationVersion UTF8String],
+                                                        osBuild, bootTime, traced, &previous, &hasPrevious);
+    free(osBuild);
+
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not open the app state journal", nil);
+        return NO;
+    }
+
+    /* Report the previous session's termination, if it was not otherwise explained */
+    if (hasPrevious) {
+        plcrash_async_app_state_termination_t reason = plcrash_async_app_state_infer_termination(&previous, app_state_storage.record);
+        if (reason == PLCRASH_ASYNC_APP_STATE_TERMINATION_WATCHDOG || reason == PLCRASH_ASYNC_APP_STATE_TERMINATION_OOM) {
+            NSError *reportError = nil;
+            NSData *data = [self generateTerminationReportForSession: &previous reason: reason error: &reportError];
+            NSString *reportPath = [self uniqueCrashReportPath];
+            plcrash_async_report_index_t *index = [self reportIndex];
+            bool synced = index != NULL && plcrash_async_report_index_synced(index);
+            if (data == nil || ![data writeToFile: reportPath options: NSDataWritingAtomic error: &reportError])
+                NSLog(@"Could not write the termination report: %@", reportError);
+            else
+                plcrash_report_index_record(index, [reportPath fileSystemRepresentation], PLCRASH_ASYNC_REPORT_INDEX_WRITTEN, [data length], time(NULL), synced);
+        }
+    }
+
+    plcrash_nasync_app_state_sample_footprint(&app_state_storage);
+
+    /* Publish the journal before registering any observers */
+    OSMemoryBarrier();
+    app_state_journal = &app_state_storage;
+
+    [self registerAppStateObservers];
+    atexit(app_state_exit_handler);
+
+    return YES;
+}
+
+/**
+ * Export the process' binary image list to a shared memory region, for use by an out-of-process capture helper.
+ *
+ * The region contains an append-only journal of image loads and unloads (see PLCrashAsyncImageJournal.h), updated
+ * as images are loaded and unloaded for the remaining lifetime of the process. A helper that maps the region
+ * read-only, and replays its records, has an up-to-date image table at all times, and need not enumerate the
+ * process' images via TASK_DYLD_INFO and dyld_all_image_infos at crash time.
+ *
+ * The region is created, and populated with the currently loaded images, on the first call; subsequent calls return
+ * the same region.
+ *
+ * @param outEntry On success, a send right to a read-only Mach memory entry for the region. The caller is responsible
+ * for deallocating the right, typically after sending it to the helper process.
+ * @param outSize On success, the size of the region, in bytes.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the image list could not be exported. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the region could not be created.
+ */
+- (BOOL) exportImageListWithMemoryEntry: (mach_port_t *) outEntry size: (size_t *) outSize error: (NSError **) outError {
+    /* The journal mirrors the fully populated list */
+    plcrash_populate_shared_image_list();
+
+    pthread_mutex_lock(&shared_image_journal_lock);
+    if (shared_image_journal == NULL) {
+        plcrash_async_image_journal_t *journal = malloc(sizeof(*journal));
+        if (journal == NULL || plcrash_nasync_image_journal_init(journal, 0) != PLCRASH_ESUCCESS) {
+            pthread_mutex_unlock(&shared_image_journal_lock);
+            free(journal);
+            plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem, @"Could not allocate the shared image journal", nil);
+            return NO;
+        }
+
+        plcrash_nasync_image_list_set_journal(&shared_image_list, journal);
+        shared_image_journal = journal;
+    }
+    pthread_mutex_unlock(&shared_image_journal_lock);
+
+    mach_port_t entry = plcrash_nasync_image_journal_memory_entry(shared_image_journal);
+    kern_return_t kr = mach_port_mod_refs(mach_task_self(), entry, MACH_PORT_RIGHT_SEND, 1);
+    if (kr != KERN_SUCCESS) {
+        plcrash_populate_mach_error(outError, kr, @"Could not retain the shared image journal's memory entry");
+        return NO;
+    }
+
+    *outEntry = entry;
+    *outSize = shared_image_journal->size;
+    return YES;
+}
+
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+/**
+ * @internal
+ *
+ * Return the mask of the fatal exceptions for which crash reports are written.
+ */
+static exception_mask_t plcrash_fatal_exception_mask (void) {
+    /* Determine the target exception type mask. Note that unlike some other Mach exception-based
+     * crash reporting implementations, we do not monitor EXC_RESOURCE:
+     *
+     * EXC_RESOURCE wasn't added until iOS 5.1 and Mac OS X 10.8, and is used for
+     * kernel-based thread resource constraints on a per-thread/per-task basis. XNU
+     * supports either pausing threads that exceed the defined constraints (via the private
+     * ledger kernel APIs), or issueing a Mach exception that can be used to monitor the
+     * constraints.
+     *
+     * The EXC_RESOURCE resouce exception is used, for example, to implement the
+     * private posix_spawnattr_setcpumonitor() API, which allows for monitoring CPU utilization
+     * by observing issued EXC_RESOURCE exceptions. This appears to be used by launchd.
+     *
+     * Either way, EXC_RESOURCE is not fatal; the xnu ux_exception() handler should not deliver
+     * a signal for the exception and should return KERN_SUCCESS, letting exception_triage()
+     * consider it as handled. If non-fatal resource reports are enabled, EXC_RESOURCE is registered
+     * separately; see enableResourceReportsWithMinimumInterval:error:.
+     */
+    exception_mask_t exc_mask = EXC_MASK_BAD_ACCESS |       /* Memory access fail */
+                                EXC_MASK_BAD_INSTRUCTION |  /* Illegal instruction */
+                                EXC_MASK_ARITHMETIC |       /* Arithmetic exception (eg, divide by zero) */
+                                EXC_MASK_SOFTWARE |         /* Software exception (eg, as triggered by x86's bound instruction) */
+                                EXC_MASK_BREAKPOINT;        /* Trace or breakpoint */
+    
+    /* EXC_GUARD was added in xnu 13.x (iOS 6.0, Mac OS X 10.9) */
+#ifdef EXC_MASK_GUARD
+    PLCrashHostInfo *hinfo = [PLCrashHostInfo currentHostInfo];
+    
+    if (hinfo != nil && hinfo.darwinVersion.major >= 13)
+        exc_mask |= EXC_MASK_GUARD; /* Process accessed a guarded file descriptor. See also: https://devforums.apple.com/message/713907#713907 */
+#endif
+
+    return exc_mask;
+}
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+
+/**
+ * Start an out-of-process capture service, allowing the other processes of a multi-process application to register
+ * with this process, rather than each enabling its own crash reporter.
+ *
+ * The service is intended to be hosted by a launchd agent that declares @a serviceName in its MachServices
+ * dictionary. Client processes register via registerWithCaptureServiceNamed:error:; when a registered client
+ * crashes, its report is written by this process, out-of-process, and is queued alongside this reporter's own
+ * reports. Each report carries the client's application identifier, version and process info.
+ *
+ * The symbol and unwind indices of images loaded by several clients, including the system libraries of the dyld
+ * shared cache, are built once and shared across all clients' reports.
+ *
+ * @param serviceName The launchd Mach service name on which client registrations will be received.
+ * @param workerCount The number of threads on which reports are written, and so the number of concurrent client
+ * crashes that may be reported in parallel. Must be between 1 and 64.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the service could not be started. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES if the service was started, or NO on error. If a service has already been started, NO will
+ * be returned with an error code of PLCrashReporterErrorResourceBusy.
+ */
+- (BOOL) startCaptureServiceWithName: (NSString *) serviceName workerCount: (NSUInteger) workerCount error: (NSError **) outError {
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    if (_captureService != nil) {
+        plcrash_populate_error(outError, PLCrashReporterErrorResourceBusy, @"A capture service has already been started", nil);
+        return NO;
+    }
+
+    /* Reports are queued by this reporter */
+    if (![self populateCrashReportDirectoryAndReturnError: outError])
+        return NO;
+
+    _captureService = [[PLCrashCaptureService alloc] initWithReporter: self
+                                                        exceptionMask: plcrash_fatal_exception_mask()
+                                                          workerCount: workerCount
+                                                          serviceName: serviceName
+                                                                error: outError];
+    return (_captureService != nil);
+#else
+    plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Mach exception handling is not supported on this platform", nil);
+    return NO;
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+}
+
+/**
+ * Stop the capture service started via startCaptureServiceWithName:workerCount:error:, if any. The exception
+ * ports of all registered clients are restored, and any reports in progress are completed before this method returns.
+ */
+- (void) stopCaptureService {
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    [_captureService stop];
+    [_captureService release];
+    _captureService = nil;
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+}
+
+/**
+ * Register the current process with the capture service @a serviceName; see
+ * startCaptureServiceWithName:workerCount:error:. Once registered, the process' crashes are reported by the
+ * service, using this reporter's application identifier and version.
+ *
+ * This is an alternative to enableCrashReporterAndReturnError:; a registered process should not also enable
+ * in-process crash reporting. The process' image list is exported to the service (see
+ * exportImageListWithMemoryEntry:size:error:), and is kept up to date as images are loaded and unloaded.
+ *
+ * @param serviceName The launchd Mach service name of the capture service.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the process could not be registered. If no error occurs, this
+ * parameter will be left unmodified. You may specify nil for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES if the process was registered, or NO on error.
+ */
+- (BOOL) registerWithCaptureServiceNamed: (NSString *) serviceName error: (NSError **) outError {
+#if PLCRASH_FEATURE_MACH_EXCEPTIONS
+    mach_port_t entry;
+    size_t size;
+    if (![self exportImageListWithMemoryEntry: &entry size: &size error: outError])
+        return NO;
+
+    mach_port_t servicePort;
+    kern_return_t kr = bootstrap_look_up(bootstrap_port, [serviceName UTF8String], &servicePort);
+    if (kr != KERN_SUCCESS) {
+        mach_port_deallocate(mach_task_self(), entry);
+        plcrash_populate_error(outError, PLCrashReporterErrorOperatingSystem,
+                               [NSString stringWithFormat: @"Failed to look up the capture service %@: %s", serviceName, bootstrap_strerror(kr)], nil);
+        return NO;
+    }
+
+    BOOL registered = [PLCrashCaptureService registerTask: mach_task_self()
+                                          withServicePort: servicePort
+                                    applicationIdentifier: _applicationIdentifier
+                                       applicationVersion: _applicationVersion
+                                        imageJournalEntry: entry
+                                         imageJournalSize: size
+                                                    error: outError];
+
+    mach_port_deallocate(mach_task_self(), servicePort);
+    mach_port_deallocate(mach_task_self(), entry);
+    return registered;
+#else
+    plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Mach exception handling is not supported on this platform", nil);
+    return NO;
+#endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
+}
+
+/**
+ * @internal
+ *
+ * Generate a report describing the termination of a previous session.
+ *
+ * The report is written with a SIGKILL signal, as used by the system to perform jetsam and watchdog terminations,
+ * and without any threads or binary images; its system, machine, application and process info describe the current
+ * process.
+ *
+ * @param session The terminated session's journal record.
+ * @param reason The inferred cause of the termination.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the report could not be generated.
+ *
+ * @return Returns the report data, or nil on error.
+ */
+- (NSData *) generateTerminationReportForSession: (const plcrash_async_app_state_record_t *) session
+                                          reason: (plcrash_async_app_state_termination_t) reason
+                                           error: (NSError **) outError
+{
+    plcrash_log_writer_t writer;
+    plcrash_async_file_t file;
+    plcrash_error_t err;
+
+    plcrash_populate_shared_image_list();
+
+    NSMutableData *data = [NSMutableData dataWithLength: MAX_REPORT_BYTES];
+    if (data == nil) {
+        plcrash_populate_posix_error(outError, ENOMEM, @"Failed to allocate the termination report buffer");
+        return nil;
+    }
+
+    /* The report is neither user requested, nor symbolicated; it contains no frames */
+    err = plcrash_log_writer_init(&writer, _applicationIdentifier, _applicationVersion, PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE, false);
+    if (err != PLCRASH_ESUCCESS) {
+        plcrash_log_writer_free(&writer);
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to initialize the crash report writer", nil);
+        return nil;
+    }
+
+    plcrash_log_writer_termination_info_t termination = {
+        .reason = reason,
+        .session = session
+    };
+    plcrash_log_writer_set_termination(&writer, &termination);
+
+    plcrash_log_bsd_signal_info_t bsd_signal_info;
+    plcrash_log_signal_info_t signal_info;
+    bsd_signal_info.signo = SIGKILL;
+    bsd_signal_info.code = 0;
+    bsd_signal_info.address = 0;
+
+    signal_info.bsd_info = &bsd_signal_info;
+    signal_info.mach_info = NULL;
+
+    /* Marking the current thread as crashed, without a thread state, omits all threads and images */
+    plcrash_async_file_init_memory(&file, [data mutableBytes], [data length]);
+    err = plcrash_log_writer_write(&writer, pl_mach_thread_self(), &shared_image_list, &file, &signal_info, NULL);
+    plcrash_log_writer_close(&writer);
+    plcrash_log_writer_free(&writer);
+
+    if (err != PLCRASH_ESUCCESS) {
+        NSLog(@"Write failed with error %s", plcrash_async_strerror(err));
+        plcrash_populate_error(outError, PLCrashReporterErrorUnknown, @"Failed to write the termination report", nil);
+        return nil;
+    }
+
+    [data setLength: (NSUInteger) plcrash_async_file_tell(&file)];
+    return data;
+}
+
+/**
+ * @internal
+ *
+ * Register for the application state notifications recorded in the app state journal. On Mac OS X, the
+ * NSApplication notifications are observed by name, as AppKit is not linked.
+ */
+- (void) registerAppStateObservers {
+    NSNotificationCenter *center = [NSNotificationCenter defaultCenter];
+
+#if TARGET_OS_IPHONE
+    [center addObserver: self selector: @selector(appStateDidEnterForeground:) name: UIApplicationWillEnterForegroundNotification object: nil];
+    [center addObserver: self selector: @selector(appStateDidEnterBackground:) name: UIApplicationDidEnterBackgroundNotification object: nil];
+    [center addObserver: self selector: @selector(appStateDidReceiveMemoryWarning:) name: UIApplicationDidReceiveMemoryWarningNotification object: nil];
+    [center addObserver: self selector: @selector(appStateWillTerminate:) name: UIApplicationWillTerminateNotification object: nil];
+
+    /* The journal assumes that the session starts in the foreground */
+    if ([[UIApplication sharedApplication] applicationState] == UIApplicationStateBackground)
+        plcrash_async_app_state_set_foreground(app_state_journal, false);
+#else
+    [center addObserver: self selector: @selector(appStateDidEnterForeground:) name: @"NSApplicationDidBecomeActiveNotification" object: nil];
+    [center addObserver: self selector: @selector(appStateDidEnterBackground:) name: @"NSApplicationDidResignActiveNotification" object: nil];
+    [center addObserver: self selector: @selector(appStateWillTerminate:) name: @"NSApplicationWillTerminateNotification" object: nil];
+#endif
+}
+
+/**
+ * @internal
+ * Application state notification handler.
+ */
+- (void) appStateDidEnterForeground: (NSNotification *) notification {
+    plcrash_async_app_state_set_foreground(app_state_journal, true);
+    plcrash_nasync_app_state_sample_footprint(app_state_journal);
+}
+
+/**
+ * @internal
+ * Application state notification handler.
+ */
+- (void) appStateDidEnterBackground: (NSNotification *) notification {
+    plcrash_async_app_state_set_foreground(app_state_journal, false);
+    plcrash_nasync_app_state_sample_footprint(app_state_journal);
+}
+
+/**
+ * @internal
+ * Application state notification handler.
+ */
+- (void) appStateDidReceiveMemoryWarning: (NSNotification *) notification {
+    plcrash_async_app_state_set_memory_warning(app_state_journal);
+    plcrash_nasync_app_state_sample_footprint(app_state_journal);
+}
+
+/**
+ * @internal
+ * Application state notification handler.
+ */
+- (void) appStateWillTerminate: (NSNotification *) notification {
+    plcrash_async_app_state_set_clean_exit(app_state_journal);
 }
 
+/**
+ * @internal
+ *
+ * Record whether the main thread is hung in the app state journal, if enabled. Called by the hang detector's
+ * watchdog thread.
+ *
+ * @param hung YES if the main thread is hung.
+ */
+- (void) recordHangState: (BOOL) hung {
+    if (app_state_journal == NULL)
+        return;
+
+    plcrash_async_app_state_set_hang(app_state_journal, hung);
+    if (hung)
+        plcrash_nasync_app_state_sample_footprint(app_state_journal);
+}
 
 /**
  * Set the callbacks that will be executed by the receiver after a crash has occured and been recorded by PLCrashReporter.
@@ -922,6 +3192,33 @@ cleanup:
     NSArray *paths = NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES);
     NSString *cacheDir = [paths objectAtIndex: 0];
     _crashReportDirectory = [[[cacheDir stringByAppendingPathComponent: PLCRASH_CACHE_DIR] stringByAppendingPathComponent: appIdPath] retain];
+
+    /* Allocate the live report writers; the writers themselves are initialized on first use. */
+    _liveReportWriter = calloc(1, sizeof(*_liveReportWriter));
+    if (_liveReportWriter == NULL) {
+        [self release];
+        return nil;
+    }
+    for (size_t i = 0; i < PLCRASH_LIVE_REPORT_WRITER_COUNT; i++)
+        pthread_mutex_init(&_liveReportWriter->slots[i].lock, NULL);
+    pthread_mutex_init(&_liveReportWriter->stats_lock, NULL);
+
+    /* Allocate the user region registry; regions may be registered at any time, and are written to all reports. */
+    _userRegions = malloc(sizeof(*_userRegions));
+    if (_userRegions == NULL) {
+        [self release];
+        return nil;
+    }
+    plcrash_async_user_regions_init(_userRegions);
+
+    /* Spawn the live report workers; on failure, live reports fall back to serial thread capture. */
+    if (_config.liveReportWorkerCount > 0) {
+        plcrash_error_t err = plcrash_log_writer_workers_new(&_liveReportWorkers, (uint32_t) _config.liveReportWorkerCount);
+        if (err != PLCRASH_ESUCCESS) {
+            NSLog(@"Could not create the live report worker pool: %s", plcrash_async_strerror(err));
+            _liveReportWorkers = NULL;
+        }
+    }
     
     return self;
 }
@@ -978,36 +3275,7 @@ cleanup:
                                                                       context: (void *) context
                                                                         error: (NSError **) outError
 {
-    /* Determine the target exception type mask. Note that unlike some other Mach exception-based
-     * crash reporting implementations, we do not monitor EXC_RESOURCE:
-     *
-     * EXC_RESOURCE wasn't added until iOS 5.1 and Mac OS X 10.8, and is used for
-     * kernel-based thread resource constraints on a per-thread/per-task basis. XNU
-     * supports either pausing threads that exceed the defined constraints (via the private
-     * ledger kernel APIs), or issueing a Mach exception that can be used to monitor the
-     * constraints.
-     *
-     * The EXC_RESOURCE resouce exception is used, for example, to implement the
-     * private posix_spawnattr_setcpumonitor() API, which allows for monitoring CPU utilization
-     * by observing issued EXC_RESOURCE exceptions. This appears to be used by launchd.
-     *
-     * Either way, we're uninterested in EXC_RESOURCE; the xnu ux_exception() handler should not deliver
-     * a signal for the exception and should return KERN_SUCCESS, letting exception_triage()
-     * consider it as handled.
-     */
-    exception_mask_t exc_mask = EXC_MASK_BAD_ACCESS |       /* Memory access fail */
-                                EXC_MASK_BAD_INSTRUCTION |  /* Illegal instruction */
-                                EXC_MASK_ARITHMETIC |       /* Arithmetic exception (eg, divide by zero) */
-                                EXC_MASK_SOFTWARE |         /* Software exception (eg, as triggered by x86's bound instruction) */
-                                EXC_MASK_BREAKPOINT;        /* Trace or breakpoint */
-    
-    /* EXC_GUARD was added in xnu 13.x (iOS 6.0, Mac OS X 10.9) */
-#ifdef EXC_MASK_GUARD
-    PLCrashHostInfo *hinfo = [PLCrashHostInfo currentHostInfo];
-    
-    if (hinfo != nil && hinfo.darwinVersion.major >= 13)
-        exc_mask |= EXC_MASK_GUARD; /* Process accessed a guarded file descriptor. See also: https://devforums.apple.com/message/713907#713907 */
-#endif
+    exception_mask_t exc_mask = plcrash_fatal_exception_mask();
     
     /* Create the server */
     NSError *osError;
@@ -1036,16 +3304,59 @@ cleanup:
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
 
 - (void) dealloc {
+    /* The detector does not retain the reporter, and must be stopped before any reporter state is released */
+    [_hangDetector stop];
+    [_hangDetector release];
+
+    /* Likewise, the capture service does not retain the reporter */
+    [self stopCaptureService];
+
+    [_crashPathWarmer stop];
+    [_crashPathWarmer release];
+
+    [[NSNotificationCenter defaultCenter] removeObserver: self];
+
     [_config release];
 
 #if PLCRASH_FEATURE_MACH_EXCEPTIONS
     [_machServer release];
     [_previousMachPorts release];
+    [_previousResourcePorts release];
 #endif /* PLCRASH_FEATURE_MACH_EXCEPTIONS */
 
     [_crashReportDirectory release];
     [_applicationIdentifier release];
     [_applicationVersion release];
+    [_queuedReportStore release];
+    [_pendingReportFingerprints release];
+
+    /* The index of an enabled reporter remains in use by the crash handler */
+    if (_reportIndex != NULL && _reportIndex != signal_handler_context.report_index) {
+        plcrash_nasync_report_index_close(_reportIndex);
+        free(_reportIndex);
+    }
+
+    if (_liveReportWriter != NULL) {
+        for (size_t i = 0; i < PLCRASH_LIVE_REPORT_WRITER_COUNT; i++) {
+            struct plcr_live_report_slot *slot = &_liveReportWriter->slots[i];
+            if (slot->initialized)
+                plcrash_log_writer_free(&slot->writer);
+            pthread_mutex_destroy(&slot->lock);
+        }
+        pthread_mutex_destroy(&_liveReportWriter->stats_lock);
+        free(_liveReportWriter);
+    }
+
+    if (_liveReportWorkers != NULL)
+        plcrash_log_writer_workers_free(_liveReportWorkers);
+
+    if (_breadcrumbs != NULL) {
+        plcrash_nasync_breadcrumb_buffer_free(_breadcrumbs);
+        free(_breadcrumbs);
+    }
+
+    if (_userRegions != NULL)
+        free(_userRegions);
 
     [super dealloc];
 }
@@ -1070,6 +3381,288 @@ cleanup:
     return result;
 }
 
+/**
+ * Return the symbolication strategy to be used when writing reports at crash time. If symbolication has been
+ * deferred, no symbolication is performed at crash time.
+ */
+- (plcrash_async_symbol_strategy_t) crashTimeSymbolicationStrategy {
+    if (_config.symbolicationStrategy & PLCrashReporterSymbolicationStrategyDeferred)
+        return PLCRASH_ASYNC_SYMBOL_STRATEGY_NONE;
+
+    return [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy];
+}
+
+/**
+ * If symbolication has been deferred, symbolicate the pending crash report @a data using the binary images
+ * loaded in the current process, and replace the report at @a path with the symbolicated report.
+ *
+ * @param data The pending report's data.
+ * @param path The pending report's path.
+ * @param timestamp The time at which the pending report was written; the replacement report is indexed with the
+ * original write time, preserving the report's position in the pending report order.
+ *
+ * @return Returns the symbolicated report data, or @a data if the report was not or could not be symbolicated.
+ */
+- (NSData *) symbolicateDeferredReportData: (NSData *) data path: (NSString *) path timestamp: (int64_t) timestamp {
+    if (!(_config.symbolicationStrategy & PLCrashReporterSymbolicationStrategyDeferred))
+        return data;
+
+    plcrash_populate_shared_image_list();
+
+    plcrash_async_symbol_strategy_t strategy = [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy];
+    void *output;
+    size_t output_length;
+    plcrash_error_t err;
+
+    err = plcrash_report_symbolicate([data bytes], [data length], &shared_image_list, strategy, &output, &output_length);
+    if (err != PLCRASH_ESUCCESS) {
+        if (err != PLCRASH_ENOTFOUND && err != PLCRASH_ENOTSUP)
+            PLCF_DEBUG("Deferred symbolication of %s failed: %s", [path UTF8String], plcrash_async_strerror(err));
+        return data;
+    }
+
+    NSData *result = [NSData dataWithBytesNoCopy: output length: output_length freeWhenDone: YES];
+
+    /* Replace the pending report, so that the report need only be symbolicated once */
+    NSError *error;
+    plcrash_async_report_index_t *index = [self reportIndex];
+    bool synced = index != NULL && plcrash_async_report_index_synced(index);
+    if (![result writeToFile: path options: NSDataWritingAtomic error: &error])
+        PLCF_DEBUG("Could not write symbolicated report to %s: %s", [path UTF8String], [[error description] UTF8String]);
+    else
+        plcrash_report_index_record(index, [path fileSystemRepresentation], PLCRASH_ASYNC_REPORT_INDEX_WRITTEN, output_length, timestamp, synced);
+
+    return result;
+}
+
+/**
+ * @internal
+ *
+ * Populate the shared image list, open the report slots, and initialize and configure the crash-time writer. Once
+ * complete, crashes are written by the fully configured writer to the pre-opened report slots.
+ *
+ * This is performed synchronously by enableCrashReporterWithExceptionHandling:andReturnError:, and on a background
+ * thread by enableCrashReporterDeferringSetupWithExceptionHandling:error:.
+ */
+- (void) completeSetup {
+    plcrash_probe_interval_t probe;
+    plcrash_probe_begin(&probe, PLCRASH_PROBE_PHASE_SETUP, 0);
+
+    /* Register the loaded images */
+    plcrash_populate_shared_image_list();
+
+    /* Pre-open the report slots */
+    {
+        const char *slotPaths[PLCRASH_REPORT_SLOT_COUNT];
+        const char *reportPaths[PLCRASH_REPORT_SLOT_COUNT];
+        for (uint32_t i = 0; i < PLCRASH_REPORT_SLOT_COUNT; i++) {
+            NSString *name = (i == 0) ? PLCRASH_MAPPED_CRASHREPORT : [NSString stringWithFormat: @"%@slot.%u", PLCRASH_REPORT_SLOT_PREFIX, i];
+            slotPaths[i] = [[[self crashReportDirectory] stringByAppendingPathComponent: name] UTF8String];
+            reportPaths[i] = [[self uniqueCrashReportPath] UTF8String];
+        }
+
+        /* The slot files are not reports; if the index was in sync prior to their creation, it remains so */
+        plcrash_async_report_index_t *index = signal_handler_context.report_index;
+        bool synced = index != NULL && plcrash_async_report_index_synced(index);
+        plcrash_open_report_slots(&signal_handler_context, slotPaths, reportPaths, PLCRASH_REPORT_SLOT_COUNT);
+        if (index != NULL)
+            plcrash_async_report_index_append(index, PLCRASH_ASYNC_REPORT_INDEX_SYNC, NULL, 0, 0, synced);
+    }
+
+    /* Initialize the crash-time writer */
+    plcrash_log_writer_init(&signal_handler_context.writer, _applicationIdentifier, _applicationVersion, [self crashTimeSymbolicationStrategy], false);
+    [self configureCapturePolicyForWriter: &signal_handler_context.writer];
+
+    /* Compress reports written to the mapped report slot once complete */
+    if (_config.compressReports && plcrash_log_writer_set_compression(&signal_handler_context.writer, MAX_REPORT_BYTES) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Could not allocate the crash-time report compressor");
+
+    /* Record the process' memory usage */
+    if (_config.captureMemorySummary && plcrash_log_writer_set_memory_summary(&signal_handler_context.writer, true) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Could not allocate the crash-time memory summary");
+
+    /* Reserve storage for the uncaught exception, which is captured in a process that is about to terminate */
+    if (plcrash_log_writer_set_exception_buffers(&signal_handler_context.writer, true) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Could not allocate the crash-time exception buffers");
+
+    /* Serve crash-time reads of the suspended process from its readable regions, rather than a Mach trap per read */
+    if (plcrash_log_writer_set_local_region_map(&signal_handler_context.writer, true) != PLCRASH_ESUCCESS)
+        PLCF_DEBUG("Could not allocate the crash-time region map");
+
+    /* Reserve the crash-time memory budget, and move the writer's caches into it. On failure, the writer's
+     * individually allocated caches are used. */
+    if (_config.crashTimeMemoryBudget > 0) {
+        plcrash_async_allocator_t *allocator;
+        plcrash_error_t err = plcrash_async_allocator_new(&allocator, _config.crashTimeMemoryBudget, PLCrashAsyncGuardLowPage|PLCrashAsyncGuardHighPage);
+        if (err != PLCRASH_ESUCCESS) {
+            NSLog(@"Could not reserve the crash-time memory budget: %s", plcrash_async_strerror(err));
+        } else if ((err = plcrash_log_writer_set_allocator(&signal_handler_context.writer, allocator)) != PLCRASH_ESUCCESS) {
+            NSLog(@"Crash-time memory budget of %lu bytes is insufficient: %s", (unsigned long) _config.crashTimeMemoryBudget, plcrash_async_strerror(err));
+        }
+    }
+
+    /* Spawn the crash-time worker threads; they remain parked until woken by the crash handler. The pool is
+     * retained for the lifetime of the process. */
+    plcrash_log_writer_workers_t *crashWorkers = NULL;
+    if (_config.crashWorkerCount > 0) {
+        plcrash_error_t err = plcrash_log_writer_workers_new_async_safe(&crashWorkers, (uint32_t) _config.crashWorkerCount, PLCRASH_CRASH_WORKER_MAX_THREADS);
+        if (err != PLCRASH_ESUCCESS) {
+            NSLog(@"Could not create the crash-time worker pool: %s", plcrash_async_strerror(err));
+            crashWorkers = NULL;
+        } else {
+            plcrash_log_writer_set_workers(&signal_handler_context.writer, crashWorkers);
+        }
+    }
+
+    /* Pre-fault and wire the crash-time arena, worker capture storage, and report buffer; failure is non-fatal, as
+     * the pages will have been faulted in regardless. The signal stacks are wired once the handlers are enabled. */
+    if (_config.wireCrashTimeMemory) {
+        size_t wired = 0;
+        BOOL failed = NO;
+
+        if (signal_handler_context.writer.allocator != NULL) {
+            failed |= (plcrash_async_allocator_wire(signal_handler_context.writer.allocator, &wired) != PLCRASH_ESUCCESS);
+            OSAtomicAdd64Barrier(wired, &signal_handler_context.wired_size);
+        }
+
+        if (crashWorkers != NULL) {
+            failed |= (plcrash_log_writer_workers_wire(crashWorkers, &wired) != PLCRASH_ESUCCESS);
+            OSAtomicAdd64Barrier(wired, &signal_handler_context.wired_size);
+        }
+
+        if (signal_handler_context.file_buffer != NULL) {
+            if (plcrash_nasync_mem_wire(signal_handler_context.file_buffer, REPORT_FILE_BUFFER_BYTES) == PLCRASH_ESUCCESS)
+                OSAtomicAdd64Barrier(REPORT_FILE_BUFFER_BYTES, &signal_handler_context.wired_size);
+            else
+                failed = YES;
+        }
+
+        if (failed)
+            NSLog(@"Could not wire all crash-time memory; the wired memory limit may have been reached");
+    }
+
+    /* Periodically warm the crash path's text and crash-time buffers */
+    if (_config.crashPathWarmingInterval > 0)
+        [self startCrashPathWarmer];
+
+    /* Publish the configured writer and report slots to the crash handler */
+    OSMemoryBarrier();
+    signal_handler_context.setup_complete = 1;
+    OSMemoryBarrier();
+
+    /* The breadcrumb buffer may have been enabled after the writer was configured, but before it was published */
+    if (_breadcrumbs != NULL)
+        plcrash_log_writer_set_breadcrumbs(&signal_handler_context.writer, _breadcrumbs);
+
+    /* If a symbol index memory budget is configured, build the enabled strategies' indices on a background thread
+     * as images are loaded. Otherwise, if symbol table symbolication is enabled, index the image symbol tables now,
+     * rather than scanning each symbol table linearly at crash time. */
+    if (_config.symbolIndexMemoryBudget > 0) {
+        bool symbols = (_config.symbolicationStrategy & PLCrashReporterSymbolicationStrategySymbolTable) != 0;
+        bool objc = (_config.symbolicationStrategy & PLCrashReporterSymbolicationStrategyObjC) != 0;
+        plcrash_error_t err;
+
+        if ((symbols || objc) && _config.persistSymbolIndices) {
+            NSDictionary *attributes = [NSDictionary dictionaryWithObject: [NSNumber numberWithUnsignedLong: 0755] forKey: NSFilePosixPermissions];
+            NSString *directory = [self indexStoreDirectory];
+            NSError *error = nil;
+
+            if (![[NSFileManager defaultManager] createDirectoryAtPath: directory withIntermediateDirectories: YES attributes: attributes error: &error]) {
+                PLCF_DEBUG("Could not create the index store directory: %s", [[error description] UTF8String]);
+            } else if ((err = plcrash_nasync_image_list_set_index_store(&shared_image_list, [directory fileSystemRepresentation])) != PLCRASH_ESUCCESS) {
+                PLCF_DEBUG("Failed to configure the index store: %d", err);
+            }
+        }
+
+        if ((symbols || objc) && (err = plcrash_nasync_image_list_start_warmup(&shared_image_list, _config.symbolIndexMemoryBudget, symbols, objc)) != PLCRASH_ESUCCESS)
+            PLCF_DEBUG("Failed to start background symbol indexing: %d", err);
+    } else if (_config.symbolicationStrategy & PLCrashReporterSymbolicationStrategySymbolTable) {
+        plcrash_nasync_image_list_index_symbols(&shared_image_list);
+    }
+
+    plcrash_probe_end(&probe, plcrash_async_image_list_count(&shared_image_list), 0, 0, 0);
+}
+
+/**
+ * @internal
+ *
+ * Background setup thread entry point. See enableCrashReporterDeferringSetupWithExceptionHandling:error:.
+ */
+- (void) completeDeferredSetup {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    [self completeSetup];
+    [pool drain];
+}
+
+/**
+ * @internal
+ *
+ * Register the crash path's text and the crash-time arena and report buffer with a new crash path warmer, and
+ * start the warmer. Failure is non-fatal, and is logged.
+ */
+- (void) startCrashPathWarmer {
+    PLCrashPathWarmer *warmer = [[PLCrashPathWarmer alloc] initWithInterval: _config.crashPathWarmingInterval];
+    if (warmer == nil)
+        return;
+
+    if (![warmer addCrashPathText])
+        PLCF_DEBUG("Could not register the crash path text for warming");
+
+    if (signal_handler_context.writer.allocator != NULL) {
+        void *base;
+        size_t size;
+        plcrash_async_allocator_get_region(signal_handler_context.writer.allocator, &base, &size);
+        [warmer addRegion: base length: size];
+    }
+
+    if (signal_handler_context.file_buffer != NULL)
+        [warmer addRegion: signal_handler_context.file_buffer length: REPORT_FILE_BUFFER_BYTES];
+
+    NSError *error;
+    if (![warmer startAndReturnError: &error]) {
+        NSLog(@"Could not start the crash path warmer: %@", error);
+        [warmer release];
+        return;
+    }
+
+    _crashPathWarmer = warmer;
+}
+
+/**
+ * Apply the configured thread capture order, frame and symbolication limits, and report budgets to @a writer, and attach the user region
+ * registry and the breadcrumb buffer, if enabled.
+ *
+ * @param writer The writer to be configured.
+ */
+- (void) configureCapturePolicyForWriter: (plcrash_log_writer_t *) writer {
+    plcrash_log_writer_capture_policy_t policy;
+
+    switch (_config.threadCaptureOrder) {
+        case PLCrashReporterThreadCaptureOrderCrashedFirst:
+            policy.thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_CRASHED_FIRST;
+            break;
+
+        case PLCrashReporterThreadCaptureOrderKernel:
+        default:
+            policy.thread_order = PLCRASH_LOG_WRITER_THREAD_ORDER_KERNEL;
+            break;
+    }
+
+    policy.max_thread_frames = (uint32_t) MIN(_config.threadFrameLimit, UINT32_MAX);
+    policy.tail_frames = PLCRASH_REPORTER_TAIL_FRAMES;
+    policy.time_budget = (_config.reportTimeBudget > 0) ? (uint64_t) (_config.reportTimeBudget * 1000000000.0) : 0;
+    policy.size_budget = _config.reportSizeBudget;
+    policy.max_symbolicated_frames = (uint32_t) MIN(_config.symbolicatedThreadFrameLimit, UINT32_MAX);
+
+    plcrash_log_writer_set_capture_policy(writer, &policy);
+
+    if (plcrash_log_writer_set_user_regions(writer, _userRegions) != PLCRASH_ESUCCESS)
+        NSLog(@"Could not allocate the user region buffer; registered memory regions will not be reported");
+
+    if (_breadcrumbs != NULL)
+        plcrash_log_writer_set_breadcrumbs(writer, _breadcrumbs);
+}
+
 /**
  * Validate (and create if necessary) the crash reporter directory structure.
  */
@@ -1113,10 +3706,359 @@ cleanup:
 
 
 /**
- * Return the path to live crash report (which may not yet, or ever, exist).
+ * Return the path to the directory in which image indices are persisted across launches.
+ */
+- (NSString *) indexStoreDirectory {
+    return [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_INDEX_STORE_DIR];
+}
+
+
+/**
+ * Return a new, unique path at which a crash report may be written.
+ */
+- (NSString *) uniqueCrashReportPath {
+    CFUUIDRef uuid = CFUUIDCreate(NULL);
+    NSString *name = [(NSString *) CFUUIDCreateString(NULL, uuid) autorelease];
+    CFRelease(uuid);
+
+    return [[self crashReportDirectory] stringByAppendingPathComponent: [name stringByAppendingPathExtension: @"plcrash"]];
+}
+
+/**
+ * Return the crash reports in @a directory, sorted by modification date, oldest first. Each entry is an array
+ * containing the report's modification date, path, and NSNumber size.
+ *
+ * @param directory The directory to be enumerated. Subdirectories and the crash-time report slot files
+ * are ignored.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the directory could not be read.
+ *
+ * @return Returns the sorted report entries, or nil on error.
+ */
+- (NSArray *) sortedCrashReportEntriesInDirectory: (NSString *) directory error: (NSError **) outError {
+    NSFileManager *fm = [NSFileManager defaultManager];
+
+    NSArray *files = [fm contentsOfDirectoryAtPath: directory error: outError];
+    if (files == nil)
+        return nil;
+
+    /* Files whose attributes can't be read sort first, and will fail to load. */
+    NSMutableArray *entries = [NSMutableArray arrayWithCapacity: [files count]];
+    for (NSString *filename in files) {
+        /* Skip the crash-time report slot files; they are not complete reports */
+        if ([filename hasPrefix: PLCRASH_REPORT_SLOT_PREFIX])
+            continue;
+
+        NSString *file = [directory stringByAppendingPathComponent: filename];
+        NSDictionary *attributes = [fm attributesOfItemAtPath: file error: NULL];
+
+        /* Skip directories (eg, the queued report directory) */
+        if (attributes != nil && ![[attributes fileType] isEqualToString: NSFileTypeRegular])
+            continue;
+
+        NSDate *date = [attributes fileModificationDate];
+        if (date == nil)
+            date = [NSDate distantPast];
+
+        [entries addObject: [NSArray arrayWithObjects: date, file, [NSNumber numberWithUnsignedLongLong: [attributes fileSize]], nil]];
+    }
+    [entries sortUsingComparator: ^NSComparisonResult (NSArray *lhs, NSArray *rhs) {
+        return [[lhs objectAtIndex: 0] compare: [rhs objectAtIndex: 0]];
+    }];
+
+    return entries;
+}
+
+/**
+ * Return the queued report store, opening the store on first use.
+ *
+ * @return Returns the store, or nil if the store could not be opened; for example, if the queued report directory
+ * does not yet exist.
+ */
+- (PLCrashReportStore *) queuedReportStore {
+    PLCrashReportStore *store;
+
+    pthread_mutex_lock(&queued_report_store_lock); {
+        if (_queuedReportStore == nil) {
+            NSError *error = nil;
+            _queuedReportStore = [[PLCrashReportStore alloc] initWithDirectory: [self queuedCrashReportDirectory]
+                                                                     indexName: PLCRASH_REPORT_INDEX
+                                                                  maximumCount: _config.maximumQueuedReportCount
+                                                                  maximumBytes: _config.maximumQueuedReportBytes
+                                                                    maximumAge: _config.maximumQueuedReportAge
+                                                                         error: &error];
+            if (_queuedReportStore == nil)
+                PLCF_DEBUG("Could not open the queued report store: %s", [[error description] UTF8String]);
+        }
+        store = [[_queuedReportStore retain] autorelease];
+    } pthread_mutex_unlock(&queued_report_store_lock);
+
+    return store;
+}
+
+/**
+ * Return the pending crash reports, newest first. Each entry is an array containing the report's path, NSNumber
+ * size, NSNumber write time, in seconds since the epoch, NSNumber occurrence count, and the NSNumber write time of
+ * the report's most recent occurrence.
+ *
+ * If PLCrashReporterConfig::crashLoopDeduplicationWindow is non-zero, crash loops are collapsed prior to returning
+ * the entries; see collapseCrashLoopEntries:.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending reports could not be determined.
+ *
+ * @return Returns the pending report entries, or nil on error.
+ */
+- (NSArray *) pendingCrashReportEntriesAndReturnError: (NSError **) outError {
+    NSArray *entries = [self indexedCrashReportEntriesAndReturnError: outError];
+    if (entries == nil || _config.crashLoopDeduplicationWindow <= 0 || [entries count] < 2)
+        return entries;
+
+    return [self collapseCrashLoopEntries: entries];
+}
+
+/**
+ * Collapse crash loops within @a entries, as returned by indexedCrashReportEntriesAndReturnError:.
+ *
+ * Each report's fingerprint is computed from its section footer (see PLCrashReport::fingerprintForData:frameCount:error:).
+ * Walking the reports oldest first, a report whose fingerprint matches an earlier report, and that was written within
+ * PLCrashReporterConfig::crashLoopDeduplicationWindow of that report's most recent occurrence, is deleted, and its
+ * occurrences are added to the earlier report's. The updated count is recorded in the pending report index, and
+ * survives until the report is purged or queued; if the index is stale, the count is lost once the index is rebuilt,
+ * although the duplicates remain deleted. Reports that can't be read or fingerprinted are never collapsed.
+ *
+ * @param entries The pending report entries, newest first.
+ *
+ * @return Returns the collapsed entries, newest first.
+ */
+- (NSArray *) collapseCrashLoopEntries: (NSArray *) entries {
+    NSFileManager *fm = [NSFileManager defaultManager];
+    plcrash_async_report_index_t *index = [self reportIndex];
+    int64_t window = (int64_t) ceil(_config.crashLoopDeduplicationWindow);
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity: [entries count]];
+    NSMutableDictionary *loops = [NSMutableDictionary dictionaryWithCapacity: [entries count]];
+    NSMutableDictionary *fingerprints = [NSMutableDictionary dictionaryWithCapacity: [entries count]];
+
+    pthread_mutex_lock(&crash_loop_lock);
+    for (NSArray *entry in [entries reverseObjectEnumerator]) {
+        NSString *path = [entry objectAtIndex: 0];
+
+        /* Fingerprints are cached across calls; only reports that have not yet been examined are read */
+        NSData *fingerprint = [_pendingReportFingerprints objectForKey: path];
+        if (fingerprint == nil) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: NULL];
+            if (data != nil)
+                fingerprint = [[PLCrashReport fingerprintForData: data frameCount: PLCRASH_REPORT_FINGERPRINT_DEFAULT_FRAMES error: NULL] retain];
+            [pool release];
+            [fingerprint autorelease];
+        }
+
+        if (fingerprint == nil) {
+            [result addObject: entry];
+            continue;
+        }
+
+        /* Fold the report into an open loop, if any */
+        NSNumber *loop = [loops objectForKey: fingerprint];
+        if (loop != nil) {
+            NSArray *head = [result objectAtIndex: [loop unsignedIntegerValue]];
+            int64_t last = [[head objectAtIndex: 4] longLongValue];
+            int64_t timestamp = [[entry objectAtIndex: 2] longLongValue];
+
+            bool synced = index != NULL && plcrash_async_report_index_synced(index);
+            if (timestamp - last <= window && [fm removeItemAtPath: path error: NULL]) {
+                plcrash_report_index_record(index, [path fileSystemRepresentation], PLCRASH_ASYNC_REPORT_INDEX_PURGED, 0, 0, synced);
+
+                uint64_t occurrences = [[head objectAtIndex: 3] unsignedLongLongValue] + [[entry objectAtIndex: 3] unsignedLongLongValue];
+                int64_t occurrenceTimestamp = MAX(last, [[entry objectAtIndex: 4] longLongValue]);
+                NSString *headPath = [head objectAtIndex: 0];
+
+                synced = index != NULL && plcrash_async_report_index_synced(index);
+                plcrash_report_index_record(index, [headPath fileSystemRepresentation], PLCRASH_ASYNC_REPORT_INDEX_OCCURRENCE,
+                                            occurrences, occurrenceTimestamp, synced);
+
+                [result replaceObjectAtIndex: [loop unsignedIntegerValue] withObject: [NSArray arrayWithObjects: headPath,
+                                              [head objectAtIndex: 1], [head objectAtIndex: 2],
+                                              [NSNumber numberWithUnsignedLongLong: occurrences],
+                                              [NSNumber numberWithLongLong: occurrenceTimestamp], nil]];
+                continue;
+            }
+        }
+
+        /* Otherwise, the report opens a new loop */
+        [loops setObject: [NSNumber numberWithUnsignedInteger: [result count]] forKey: fingerprint];
+        [fingerprints setObject: fingerprint forKey: path];
+        [result addObject: entry];
+    }
+
+    /* Only the fingerprints of the remaining reports are retained */
+    [_pendingReportFingerprints release];
+    _pendingReportFingerprints = [fingerprints copy];
+    pthread_mutex_unlock(&crash_loop_lock);
+
+    return [[result reverseObjectEnumerator] allObjects];
+}
+
+/**
+ * Return the pending crash reports, newest first, in the format described by
+ * pendingCrashReportEntriesAndReturnError:, without collapsing crash loops.
+ *
+ * The reports are read from the pending report index where it is in sync with the crash report directory;
+ * otherwise, the directory is scanned, and the index rebuilt from the scan. Occurrence counts are only recorded by
+ * the index, and are reset to 1 by a rebuild.
+ *
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer
+ * will contain an error object indicating why the pending reports could not be determined.
+ *
+ * @return Returns the pending report entries, or nil on error.
+ */
+- (NSArray *) indexedCrashReportEntriesAndReturnError: (NSError **) outError {
+    NSString *directory = [self crashReportDirectory];
+    plcrash_async_report_index_t *index = [self reportIndex];
+    plcrash_async_report_index_entry_t *entries;
+    plcrash_async_report_index_stamp_t stamp;
+    size_t count;
+    size_t records;
+
+    /* Try the index */
+    if (index != NULL && plcrash_nasync_report_index_read(index, &entries, &count, &records) == PLCRASH_ESUCCESS) {
+        NSMutableArray *result = [NSMutableArray arrayWithCapacity: count];
+        for (size_t i = 0; i < count; i++) {
+            NSString *name = [[NSFileManager defaultManager] stringWithFileSystemRepresentation: entries[i].name length: strlen(entries[i].name)];
+            [result addObject: [NSArray arrayWithObjects: [directory stringByAppendingPathComponent: name],
+                                [NSNumber numberWithUnsignedLongLong: entries[i].size],
+                                [NSNumber numberWithLongLong: entries[i].timestamp],
+                                [NSNumber numberWithUnsignedLongLong: entries[i].occurrences],
+                                [NSNumber numberWithLongLong: entries[i].occurrence_timestamp], nil]];
+        }
+
+        /* Compact the index once most of its records describe reports that are no longer pending. The entries are
+         * rewritten oldest first, preserving their order. */
+        if (records > (2 * count) + 64 && plcrash_async_report_index_synced(index) && plcrash_async_report_index_stamp(index, &stamp) == PLCRASH_ESUCCESS) {
+            for (size_t i = 0; i < count / 2; i++) {
+                plcrash_async_report_index_entry_t tmp = entries[i];
+                entries[i] = entries[count - i - 1];
+                entries[count - i - 1] = tmp;
+            }
+            plcrash_nasync_report_index_rewrite(index, entries, count, &stamp);
+        }
+
+        free(entries);
+        return result;
+    }
+
+    /* The index is unavailable or stale; fall back on a directory scan. The directory's modification time is
+     * fetched prior to the scan, such that a change made during the scan leaves the rebuilt index stale. */
+    bool stamped = index != NULL && plcrash_async_report_index_stamp(index, &stamp) == PLCRASH_ESUCCESS;
+    NSArray *scanned = [self sortedCrashReportEntriesInDirectory: directory error: outError];
+    if (scanned == nil)
+        return nil;
+
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity: [scanned count]];
+    plcrash_async_report_index_entry_t *rebuilt = stamped ? calloc([scanned count] + 1, sizeof(*rebuilt)) : NULL;
+    size_t rebuiltCount = 0;
+
+    for (NSArray *entry in [scanned reverseObjectEnumerator]) {
+        NSString *path = [entry objectAtIndex: 1];
+        NSNumber *size = [entry objectAtIndex: 2];
+        int64_t timestamp = (int64_t) [[entry objectAtIndex: 0] timeIntervalSince1970];
+        [result addObject: [NSArray arrayWithObjects: path, size, [NSNumber numberWithLongLong: timestamp],
+                            [NSNumber numberWithUnsignedLongLong: 1], [NSNumber numberWithLongLong: timestamp], nil]];
+
+        /* A report that can't be named in the index can't be rebuilt */
+        const char *name = [[path lastPathComponent] fileSystemRepresentation];
+        if (rebuilt == NULL || strlen(name) >= sizeof(rebuilt->name)) {
+            free(rebuilt);
+            rebuilt = NULL;
+            continue;
+        }
+
+        /* The index is rebuilt oldest first; see below */
+        plcrash_async_report_index_entry_t *rebuiltEntry = &rebuilt[[scanned count] - ++rebuiltCount];
+        strlcpy(rebuiltEntry->name, name, sizeof(rebuiltEntry->name));
+        rebuiltEntry->state = PLCRASH_ASYNC_REPORT_INDEX_WRITTEN;
+        rebuiltEntry->timestamp = timestamp;
+        rebuiltEntry->size = [size unsignedLongLongValue];
+    }
+
+    if (rebuilt != NULL) {
+        plcrash_nasync_report_index_rewrite(index, rebuilt, rebuiltCount, &stamp);
+        free(rebuilt);
+    }
+
+    return result;
+}
+
+/**
+ * Background upload thread entry point.
+ *
+ * @param arguments An array containing the upload delegate and an NSNumber maximum batch count, as
+ * provided to uploadQueuedCrashReportsWithDelegate:maximumBatchCount:error:.
  */
-- (NSString *) crashReportPath {
-    return [[self crashReportDirectory] stringByAppendingPathComponent: PLCRASH_LIVE_CRASHREPORT];
+- (void) uploadQueuedCrashReportsWithArguments: (NSArray *) arguments {
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    id<PLCrashReporterUploadDelegate> delegate = [arguments objectAtIndex: 0];
+    NSUInteger maxCount = [[arguments objectAtIndex: 1] unsignedIntegerValue];
+    NSError *error = nil;
+
+    [NSThread setThreadPriority: 0.0];
+
+    PLCrashReportStore *store = [self queuedReportStore];
+    NSArray *paths = [store reportPaths];
+    if (paths == nil)
+        NSLog(@"Could not open the queued crash report store");
+
+    NSUInteger next = 0;
+    BOOL stop = NO;
+
+    while (!stop && next < [paths count]) {
+        NSAutoreleasePool *batchPool = [[NSAutoreleasePool alloc] init];
+        NSMutableArray *reports = [NSMutableArray array];
+        NSMutableArray *batchPaths = [NSMutableArray array];
+        NSUInteger batchBytes = 0;
+
+        /* Fill the batch */
+        for (; next < [paths count]; next++) {
+            if (maxCount != 0 && [reports count] >= maxCount)
+                break;
+
+            NSString *path = [paths objectAtIndex: next];
+            NSData *data = [NSData dataWithContentsOfFile: path options: NSDataReadingMappedIfSafe error: &error];
+            if (data == nil) {
+                NSLog(@"Skipping unreadable queued crash report %@: %@", path, error);
+                continue;
+            }
+
+            if ([reports count] > 0 && batchBytes + [data length] > PLCRASH_UPLOAD_BATCH_MAX_BYTES)
+                break;
+
+            [reports addObject: data];
+            [batchPaths addObject: path];
+            batchBytes += [data length];
+        }
+
+        if ([reports count] > 0) {
+            NSData *batch = pl_batch_encode(reports, &error);
+            if (batch == nil) {
+                NSLog(@"Could not encode crash report upload batch: %@", error);
+                stop = YES;
+            } else if ([delegate crashReporter: self uploadCrashReportBatch: batch reportCount: [reports count] error: &error]) {
+                for (NSString *path in batchPaths) {
+                    if (![store removeReportAtPath: path error: &error])
+                        NSLog(@"Could not delete uploaded crash report %@: %@", path, error);
+                }
+            } else {
+                /* Leave the remaining reports queued for the next upload */
+                stop = YES;
+            }
+        }
+
+        [batchPool release];
+    }
+
+    OSAtomicCompareAndSwap32Barrier(1, 0, &_uploadInProgress);
+    [pool release];
 }
 
 
@@ -1135,12 +4077,16 @@ cleanup:
     context.path = strdup([[[self crashReportDirectory] stringByAppendingPathComponent: filename] UTF8String]);
     [filename release];
 
-    plcrash_log_writer_init(&context.writer, _applicationIdentifier, _applicationVersion, [self mapToAsyncSymbolicationStrategy: _config.symbolicationStrategy], false);
+    plcrash_populate_shared_image_list();
+    plcrash_log_writer_init(&context.writer, _applicationIdentifier, _applicationVersion, [self crashTimeSymbolicationStrategy], false);
+    [self configureCapturePolicyForWriter: &context.writer];
     plcrash_log_writer_set_exception(&context.writer, exception);
 
     plcrash_async_file_t file;
 
     /* Open the output file */
+    plcrash_async_report_index_t *index = [self reportIndex];
+    bool synced = index != NULL && plcrash_async_report_index_synced(index);
     int fd = open(context.path, O_RDWR|O_CREAT|O_TRUNC, 0644);
     if (fd < 0) {
         PLCF_DEBUG("Could not open the crashlog output file: %s", strerror(errno));
@@ -1156,7 +4102,9 @@ cleanup:
 
     /* Finished */
     plcrash_async_file_flush(&file);
+    off_t size = plcrash_async_file_tell(&file);
     plcrash_async_file_close(&file);
+    plcrash_report_index_record(index, context.path, PLCRASH_ASYNC_REPORT_INDEX_WRITTEN, (uint64_t) size, time(NULL), synced);
 
     return YES;
 }
@@ -132,6 +132,17 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
      * it may return incorrect data should the runtime be changed incompatibly.
      */
     PLCrashReporterSymbolicationStrategyObjC = 1 << 1,
+
+    /**
+     * Defer the enabled symbolication strategies until the next launch. When set, crash reports are written
+     * without crash-time symbolication, minimizing the code executed within the crashed process. Pending reports
+     * are symbolicated when loaded via PLCrashReporter::loadPendingCrashReportData:, using the binary images of
+     * the relaunched process; frames from images that are no longer loaded, or whose UUID no longer matches,
+     * are left unsymbolicated.
+     *
+     * Live reports are always symbolicated immediately. This flag has no effect if no other strategy is enabled.
+     */
+    PLCrashReporterSymbolicationStrategyDeferred = 1 << 2,
     
     /**
      * Enable all available symbolication strategies.
@@ -139,6 +150,24 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
     PLCrashReporterSymbolicationStrategyAll = (PLCrashReporterSymbolicationStrategySymbolTable|PLCrashReporterSymbolicationStrategyObjC)
 };
 
+/**
+ * @ingroup enums
+ * The order in which threads are captured and written to a report.
+ *
+ * When a report time or size budget is configured, threads that have not been captured when the budget is
+ * exhausted are omitted from the report; ordering determines which threads are preserved.
+ */
+typedef NS_ENUM(NSUInteger, PLCrashReporterThreadCaptureOrder) {
+    /** Capture threads in the order returned by the kernel. */
+    PLCrashReporterThreadCaptureOrderKernel = 0,
+
+    /**
+     * Capture the crashed thread first, followed by the main thread, followed by all remaining threads in the order
+     * returned by the kernel. Each thread retains its kernel-ordered thread number.
+     */
+    PLCrashReporterThreadCaptureOrderCrashedFirst = 1
+};
+
 @interface PLCrashReporterConfig : NSObject {
 @private
     /** The configured signal handler type. */
@@ -146,6 +175,63 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
     
     /** The configured symbolication strategy. */
     PLCrashReporterSymbolicationStrategy _symbolicationStrategy;
+
+    /** The number of worker threads used to capture thread stacks when generating live reports. */
+    NSUInteger _liveReportWorkerCount;
+
+    /** The maximum number of bytes to be allocated for background-built symbol and ObjC indices. */
+    NSUInteger _symbolIndexMemoryBudget;
+
+    /** The number of bytes to be reserved at enable time for crash-time caches. */
+    NSUInteger _crashTimeMemoryBudget;
+
+    /** The number of pre-allocated alternate signal stacks to be provided to newly created threads. */
+    NSUInteger _threadSignalStackCount;
+
+    /** The order in which threads are captured. */
+    PLCrashReporterThreadCaptureOrder _threadCaptureOrder;
+
+    /** The maximum number of frames to be captured for each non-crashed thread. */
+    NSUInteger _threadFrameLimit;
+
+    /** The time after which no further non-crashed threads are captured. */
+    NSTimeInterval _reportTimeBudget;
+
+    /** The report size after which no further non-crashed threads are captured. */
+    NSUInteger _reportSizeBudget;
+
+    /** If YES, crash reports are compressed at crash time. */
+    BOOL _compressReports;
+
+    /** If YES, reports include a summary of the process' memory usage. */
+    BOOL _captureMemorySummary;
+
+    /** The number of helper threads used to capture thread stacks at crash time. */
+    NSUInteger _crashWorkerCount;
+
+    /** If YES, crash-time memory is pre-faulted and wired. */
+    BOOL _wireCrashTimeMemory;
+
+    /** The interval between crash path warming passes. */
+    NSTimeInterval _crashPathWarmingInterval;
+
+    /** The maximum number of queued reports. */
+    NSUInteger _maximumQueuedReportCount;
+
+    /** The maximum total size of the queued reports. */
+    NSUInteger _maximumQueuedReportBytes;
+
+    /** The maximum age of a queued report. */
+    NSTimeInterval _maximumQueuedReportAge;
+
+    /** The interval within which duplicate pending reports are collapsed. */
+    NSTimeInterval _crashLoopDeduplicationWindow;
+
+    /** The number of frames to be symbolicated for each thread other than the crashed and main threads. */
+    NSUInteger _symbolicatedThreadFrameLimit;
+
+    /** If YES, background-built indices are persisted across launches. */
+    BOOL _persistSymbolIndices;
 }
 
 + (instancetype) defaultConfiguration;
@@ -153,6 +239,177 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
 - (instancetype) init;
 - (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
                      symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+              crashLoopDeduplicationWindow: (NSTimeInterval) crashLoopDeduplicationWindow;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+              crashLoopDeduplicationWindow: (NSTimeInterval) crashLoopDeduplicationWindow
+              symbolicatedThreadFrameLimit: (NSUInteger) symbolicatedThreadFrameLimit;
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+              crashLoopDeduplicationWindow: (NSTimeInterval) crashLoopDeduplicationWindow
+              symbolicatedThreadFrameLimit: (NSUInteger) symbolicatedThreadFrameLimit
+                      persistSymbolIndices: (BOOL) persistSymbolIndices;
 
 /** The configured signal handler type. */
 @property(nonatomic, readonly) PLCrashReporterSignalHandlerType signalHandlerType;
@@ -160,6 +417,113 @@ typedef NS_OPTIONS(NSUInteger, PLCrashReporterSymbolicationStrategy) {
 /** The configured symbolication strategy. */
 @property(nonatomic, readonly) PLCrashReporterSymbolicationStrategy symbolicationStrategy;
 
+/** The number of worker threads used to unwind and symbolicate thread stacks in parallel when generating live
+ * reports. If 0, threads are walked serially. Crash reports use a separate pool; see crashWorkerCount. */
+@property(nonatomic, readonly) NSUInteger liveReportWorkerCount;
+
+/** The maximum number of bytes that may be allocated for symbol and Objective-C method indices built on a
+ * low-priority background thread as images are loaded. If 0, background indexing is disabled. Images that
+ * are not indexed within the budget are searched at crash time. */
+@property(nonatomic, readonly) NSUInteger symbolIndexMemoryBudget;
+
+/** The number of bytes to be reserved, within a single guarded region, when the crash reporter is enabled. The
+ * caches used while writing a crash report are carved from this region, and any memory allocated from it while
+ * writing a report is released once the report is complete. If 0, or if the budget is too small to hold the
+ * caches, they are allocated individually. */
+@property(nonatomic, readonly) NSUInteger crashTimeMemoryBudget;
+
+/** The number of alternate signal stacks to be pre-allocated when the crash reporter is enabled with
+ * PLCrashReporterSignalHandlerTypeBSD. Each thread subsequently created via pthread_create() is assigned a stack from
+ * this pool, allowing stack overflows on any such thread to be reported. If 0, only the thread on which the crash
+ * reporter is enabled is provided with an alternate signal stack. Requires Mac OS X 10.9 or iOS 7.0. */
+@property(nonatomic, readonly) NSUInteger threadSignalStackCount;
+
+/** The order in which threads are captured and written. */
+@property(nonatomic, readonly) PLCrashReporterThreadCaptureOrder threadCaptureOrder;
+
+/** The maximum number of frames to be captured for each thread other than the crashed thread. If 0, or if larger
+ * than the maximum supported frame count, all threads are captured to the maximum supported frame count. */
+@property(nonatomic, readonly) NSUInteger threadFrameLimit;
+
+/** The time, in seconds, that may be spent writing a report. Once exceeded, symbolication is skipped, and capture of
+ * non-crashed threads is stopped. The crashed thread is always captured, the remaining threads are omitted, and the
+ * written report is marked as truncated. If 0, no time budget is applied. */
+@property(nonatomic, readonly) NSTimeInterval reportTimeBudget;
+
+/** The report size, in bytes, after which capture of non-crashed threads is stopped. The crashed thread is always
+ * captured, and the remaining threads are omitted from the report. If 0, no size budget is applied. */
+@property(nonatomic, readonly) NSUInteger reportSizeBudget;
+
+/** If YES, crash reports are LZ4 compressed once written at crash time, reducing the amount of data written to
+ * storage. Compressed reports are decompressed transparently by PLCrashReport, but can't be read by decoders that
+ * predate PLCRASH_REPORT_FILE_FLAG_COMPRESSED. Live reports are never compressed. */
+@property(nonatomic, readonly) BOOL compressReports;
+
+/** If YES, each report includes the process' physical footprint, resident and compressed sizes, and the sizes of
+ * its VM regions totalled by region type (eg, the malloc zones, IOKit, and mapped images), allowing terminations
+ * caused by memory pressure to be correlated with the regions responsible. The regions are enumerated at crash time,
+ * which may add several milliseconds to the time required to write a report. */
+@property(nonatomic, readonly) BOOL captureMemorySummary;
+
+/** The number of helper threads used to unwind and symbolicate thread stacks in parallel when writing a crash report.
+ * The threads are spawned once setup has completed, and remain parked on a Mach semaphore until woken by the crash
+ * handler; they receive no other work. A helper that fails to complete within a short timeout is abandoned, and the
+ * thread it was capturing is omitted from the report. If 0, crash reports are captured serially. */
+@property(nonatomic, readonly) NSUInteger crashWorkerCount;
+
+/** If YES, the memory used at crash time is pre-faulted and wired (mlock(2)) when the crash reporter is enabled, such
+ * that the crash handler does not incur page-fault or decompression latency under memory pressure. This includes the
+ * crashTimeMemoryBudget region, the crashWorkerCount capture storage, the report buffer, and the alternate signal
+ * stacks, including the threadSignalStackCount pool. The wired memory is not released, and its total is reported
+ * by PLCrashReporterStatistics::crashTimeMemoryWired; size the budgets accordingly. If the wired memory limit is
+ * reached, the remaining memory is pre-faulted, but not wired. */
+@property(nonatomic, readonly) BOOL wireCrashTimeMemory;
+
+/** The interval, in seconds, at which a low-priority background thread warms the pages used at crash time: the text
+ * of the crash path (the log writer, frame readers, and unwind parsers), the crashTimeMemoryBudget region, and the
+ * report buffer. These pages are otherwise rarely touched, and are likely to have been evicted by the time a crash
+ * occurs. Only non-resident pages are faulted in; the warmed size and the number of pages faulted in are reported by
+ * PLCrashReporterStatistics. Intervals shorter than one second are rounded up. If 0, warming is disabled. */
+@property(nonatomic, readonly) NSTimeInterval crashPathWarmingInterval;
+
+/** The maximum number of reports retained in the upload queue; see
+ * PLCrashReporter::queuePendingCrashReportsAndReturnError:. Once the limit is reached, queuing a report evicts the
+ * oldest queued report. If 0, the number of queued reports is not limited. */
+@property(nonatomic, readonly) NSUInteger maximumQueuedReportCount;
+
+/** The maximum total size, in bytes, of the reports retained in the upload queue. Once the limit is exceeded, the
+ * oldest queued reports are evicted; the most recently queued report is always retained. If 0, the total size is
+ * not limited. */
+@property(nonatomic, readonly) NSUInteger maximumQueuedReportBytes;
+
+/** The maximum age, in seconds, of a report retained in the upload queue, as measured from the time at which the
+ * report was written. Expired reports are evicted as reports are queued and uploaded. If 0, the age of queued
+ * reports is not limited. */
+@property(nonatomic, readonly) NSTimeInterval maximumQueuedReportAge;
+
+/** The interval, in seconds, within which pending reports with equal fingerprints (see
+ * PLCrashReport::fingerprintForData:frameCount:error:) are considered to be a crash loop, and collapsed into a single
+ * report. The oldest report of each loop is retained, the remaining reports are deleted, and the number of crashes
+ * collapsed into the report is provided by
+ * PLCrashReporter::loadPendingCrashReportDataWithMaximumBytes:occurrenceBlock:error:. Each report is compared to the
+ * most recent occurrence of the loop, such that a loop may extend beyond the window. Duplicates are collapsed as the
+ * pending reports are enumerated, and reports that can't be fingerprinted are never collapsed. If 0, duplicate
+ * reports are not collapsed. */
+@property(nonatomic, readonly) NSTimeInterval crashLoopDeduplicationWindow;
+
+/** The number of innermost frames to be symbolicated for each thread other than the crashed thread and the main
+ * thread, which are always symbolicated in full. The remaining frames are written with their PCs alone, and may be
+ * symbolicated after the fact from the report's binary images; their symbols are not looked up at crash time,
+ * reducing the cost of writing reports for processes with many threads. If 0, all frames are symbolicated. */
+@property(nonatomic, readonly) NSUInteger symbolicatedThreadFrameLimit;
+
+/** If YES, the symbol, Objective-C and DWARF FDE indices built in the background (see symbolIndexMemoryBudget) for
+ * the application's own images -- those outside of the dyld shared cache -- are written to the crash reporter's data
+ * directory, keyed by image UUID. On subsequent launches, the stored indices are mapped in place of being rebuilt,
+ * until the image is updated. Stored indices that go unused for 30 days are removed. Has no effect if
+ * symbolIndexMemoryBudget is 0. */
+@property(nonatomic, readonly) BOOL persistSymbolIndices;
+
 
 @end
 
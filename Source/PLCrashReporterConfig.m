@@ -37,6 +37,25 @@
 
 @synthesize signalHandlerType = _signalHandlerType;
 @synthesize symbolicationStrategy = _symbolicationStrategy;
+@synthesize liveReportWorkerCount = _liveReportWorkerCount;
+@synthesize crashWorkerCount = _crashWorkerCount;
+@synthesize wireCrashTimeMemory = _wireCrashTimeMemory;
+@synthesize crashPathWarmingInterval = _crashPathWarmingInterval;
+@synthesize maximumQueuedReportCount = _maximumQueuedReportCount;
+@synthesize maximumQueuedReportBytes = _maximumQueuedReportBytes;
+@synthesize maximumQueuedReportAge = _maximumQueuedReportAge;
+@synthesize crashLoopDeduplicationWindow = _crashLoopDeduplicationWindow;
+@synthesize symbolicatedThreadFrameLimit = _symbolicatedThreadFrameLimit;
+@synthesize persistSymbolIndices = _persistSymbolIndices;
+@synthesize symbolIndexMemoryBudget = _symbolIndexMemoryBudget;
+@synthesize crashTimeMemoryBudget = _crashTimeMemoryBudget;
+@synthesize threadSignalStackCount = _threadSignalStackCount;
+@synthesize threadCaptureOrder = _threadCaptureOrder;
+@synthesize threadFrameLimit = _threadFrameLimit;
+@synthesize reportTimeBudget = _reportTimeBudget;
+@synthesize reportSizeBudget = _reportSizeBudget;
+@synthesize compressReports = _compressReports;
+@synthesize captureMemorySummary = _captureMemorySummary;
 
 /**
  * Return the default local configuration.
@@ -61,12 +80,722 @@
  */
 - (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
                      symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+{
+    return [self initWithSignalHandlerType: signalHandlerType symbolicationStrategy: symbolicationStrategy liveReportWorkerCount: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: PLCrashReporterThreadCaptureOrderKernel
+                          threadFrameLimit: 0
+                          reportTimeBudget: 0
+                          reportSizeBudget: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: NO];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: NO];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: crashWorkerCount
+                       wireCrashTimeMemory: NO];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ * @param wireCrashTimeMemory If YES, crash-time memory will be pre-faulted and wired.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: crashWorkerCount
+                       wireCrashTimeMemory: wireCrashTimeMemory
+                  crashPathWarmingInterval: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ * @param wireCrashTimeMemory If YES, crash-time memory will be pre-faulted and wired.
+ * @param crashPathWarmingInterval The interval, in seconds, between background warming passes over the crash path, or 0 to disable warming.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: crashWorkerCount
+                       wireCrashTimeMemory: wireCrashTimeMemory
+                  crashPathWarmingInterval: crashPathWarmingInterval
+                  maximumQueuedReportCount: 0
+                  maximumQueuedReportBytes: 0
+                    maximumQueuedReportAge: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ * @param wireCrashTimeMemory If YES, crash-time memory will be pre-faulted and wired.
+ * @param crashPathWarmingInterval The interval, in seconds, between background warming passes over the crash path, or 0 to disable warming.
+ * @param maximumQueuedReportCount The maximum number of queued reports, or 0 for no limit.
+ * @param maximumQueuedReportBytes The maximum total size of the queued reports, in bytes, or 0 for no limit.
+ * @param maximumQueuedReportAge The maximum age of a queued report, in seconds, or 0 for no limit.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: crashWorkerCount
+                       wireCrashTimeMemory: wireCrashTimeMemory
+                  crashPathWarmingInterval: crashPathWarmingInterval
+                  maximumQueuedReportCount: maximumQueuedReportCount
+                  maximumQueuedReportBytes: maximumQueuedReportBytes
+                    maximumQueuedReportAge: maximumQueuedReportAge
+              crashLoopDeduplicationWindow: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ * @param wireCrashTimeMemory If YES, crash-time memory will be pre-faulted and wired.
+ * @param crashPathWarmingInterval The interval, in seconds, between background warming passes over the crash path, or 0 to disable warming.
+ * @param maximumQueuedReportCount The maximum number of queued reports, or 0 for no limit.
+ * @param maximumQueuedReportBytes The maximum total size of the queued reports, in bytes, or 0 for no limit.
+ * @param maximumQueuedReportAge The maximum age of a queued report, in seconds, or 0 for no limit.
+ * @param crashLoopDeduplicationWindow The interval, in seconds, within which duplicate pending reports are collapsed
+ * into a single report, or 0 to disable collapsing.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+              crashLoopDeduplicationWindow: (NSTimeInterval) crashLoopDeduplicationWindow
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: crashWorkerCount
+                       wireCrashTimeMemory: wireCrashTimeMemory
+                  crashPathWarmingInterval: crashPathWarmingInterval
+                  maximumQueuedReportCount: maximumQueuedReportCount
+                  maximumQueuedReportBytes: maximumQueuedReportBytes
+                    maximumQueuedReportAge: maximumQueuedReportAge
+              crashLoopDeduplicationWindow: crashLoopDeduplicationWindow
+              symbolicatedThreadFrameLimit: 0];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ * @param wireCrashTimeMemory If YES, crash-time memory will be pre-faulted and wired.
+ * @param crashPathWarmingInterval The interval, in seconds, between background warming passes over the crash path, or 0 to disable warming.
+ * @param maximumQueuedReportCount The maximum number of queued reports, or 0 for no limit.
+ * @param maximumQueuedReportBytes The maximum total size of the queued reports, in bytes, or 0 for no limit.
+ * @param maximumQueuedReportAge The maximum age of a queued report, in seconds, or 0 for no limit.
+ * @param crashLoopDeduplicationWindow The interval, in seconds, within which duplicate pending reports are collapsed
+ * into a single report, or 0 to disable collapsing.
+ * @param symbolicatedThreadFrameLimit The number of frames to be symbolicated for each thread other than the crashed
+ * and main threads, or 0 to symbolicate all frames.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+              crashLoopDeduplicationWindow: (NSTimeInterval) crashLoopDeduplicationWindow
+              symbolicatedThreadFrameLimit: (NSUInteger) symbolicatedThreadFrameLimit
+{
+    return [self initWithSignalHandlerType: signalHandlerType
+                     symbolicationStrategy: symbolicationStrategy
+                     liveReportWorkerCount: liveReportWorkerCount
+                   symbolIndexMemoryBudget: symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: crashTimeMemoryBudget
+                    threadSignalStackCount: threadSignalStackCount
+                        threadCaptureOrder: threadCaptureOrder
+                          threadFrameLimit: threadFrameLimit
+                          reportTimeBudget: reportTimeBudget
+                          reportSizeBudget: reportSizeBudget
+                           compressReports: compressReports
+                      captureMemorySummary: captureMemorySummary
+                          crashWorkerCount: crashWorkerCount
+                       wireCrashTimeMemory: wireCrashTimeMemory
+                  crashPathWarmingInterval: crashPathWarmingInterval
+                  maximumQueuedReportCount: maximumQueuedReportCount
+                  maximumQueuedReportBytes: maximumQueuedReportBytes
+                    maximumQueuedReportAge: maximumQueuedReportAge
+              crashLoopDeduplicationWindow: crashLoopDeduplicationWindow
+              symbolicatedThreadFrameLimit: symbolicatedThreadFrameLimit
+                      persistSymbolIndices: NO];
+}
+
+/**
+ * Initialize a new PLCrashReporterConfig instance.
+ *
+ * @param signalHandlerType The requested signal handler type.
+ * @param symbolicationStrategy A local symbolication strategy.
+ * @param liveReportWorkerCount The number of worker threads to be used to capture thread stacks in parallel
+ * when generating live reports, or 0 to capture threads serially.
+ * @param symbolIndexMemoryBudget The maximum number of bytes to be allocated for symbol and Objective-C method
+ * indices built in the background as images are loaded, or 0 to disable background indexing.
+ * @param crashTimeMemoryBudget The number of bytes to be reserved when the crash reporter is enabled for use by
+ * crash-time caches, or 0 to allocate the caches individually.
+ * @param threadSignalStackCount The number of alternate signal stacks to be pre-allocated for newly created
+ * threads, or 0 to only provide an alternate signal stack to the thread on which the crash reporter is enabled.
+ * @param threadCaptureOrder The order in which threads are captured and written.
+ * @param threadFrameLimit The maximum number of frames to be captured for each non-crashed thread, or 0 to
+ * use the maximum supported frame count.
+ * @param reportTimeBudget The time, in seconds, after which the report is truncated, or 0 for no time budget.
+ * @param reportSizeBudget The report size, in bytes, after which no further non-crashed threads are captured, or 0
+ * for no size budget.
+ * @param compressReports If YES, crash reports will be compressed at crash time.
+ * @param captureMemorySummary If YES, reports will include a summary of the process' memory usage.
+ * @param crashWorkerCount The number of helper threads to be used to capture thread stacks in parallel at crash
+ * time, or 0 to capture threads serially.
+ * @param wireCrashTimeMemory If YES, crash-time memory will be pre-faulted and wired.
+ * @param crashPathWarmingInterval The interval, in seconds, between background warming passes over the crash path, or 0 to disable warming.
+ * @param maximumQueuedReportCount The maximum number of queued reports, or 0 for no limit.
+ * @param maximumQueuedReportBytes The maximum total size of the queued reports, in bytes, or 0 for no limit.
+ * @param maximumQueuedReportAge The maximum age of a queued report, in seconds, or 0 for no limit.
+ * @param crashLoopDeduplicationWindow The interval, in seconds, within which duplicate pending reports are collapsed
+ * into a single report, or 0 to disable collapsing.
+ * @param symbolicatedThreadFrameLimit The number of frames to be symbolicated for each thread other than the crashed
+ * and main threads, or 0 to symbolicate all frames.
+ * @param persistSymbolIndices If YES, indices built in the background will be persisted across launches.
+ */
+- (instancetype) initWithSignalHandlerType: (PLCrashReporterSignalHandlerType) signalHandlerType
+                     symbolicationStrategy: (PLCrashReporterSymbolicationStrategy) symbolicationStrategy
+                     liveReportWorkerCount: (NSUInteger) liveReportWorkerCount
+                   symbolIndexMemoryBudget: (NSUInteger) symbolIndexMemoryBudget
+                     crashTimeMemoryBudget: (NSUInteger) crashTimeMemoryBudget
+                    threadSignalStackCount: (NSUInteger) threadSignalStackCount
+                        threadCaptureOrder: (PLCrashReporterThreadCaptureOrder) threadCaptureOrder
+                          threadFrameLimit: (NSUInteger) threadFrameLimit
+                          reportTimeBudget: (NSTimeInterval) reportTimeBudget
+                          reportSizeBudget: (NSUInteger) reportSizeBudget
+                           compressReports: (BOOL) compressReports
+                      captureMemorySummary: (BOOL) captureMemorySummary
+                          crashWorkerCount: (NSUInteger) crashWorkerCount
+                       wireCrashTimeMemory: (BOOL) wireCrashTimeMemory
+                  crashPathWarmingInterval: (NSTimeInterval) crashPathWarmingInterval
+                  maximumQueuedReportCount: (NSUInteger) maximumQueuedReportCount
+                  maximumQueuedReportBytes: (NSUInteger) maximumQueuedReportBytes
+                    maximumQueuedReportAge: (NSTimeInterval) maximumQueuedReportAge
+              crashLoopDeduplicationWindow: (NSTimeInterval) crashLoopDeduplicationWindow
+              symbolicatedThreadFrameLimit: (NSUInteger) symbolicatedThreadFrameLimit
+                      persistSymbolIndices: (BOOL) persistSymbolIndices
 {
     if ((self = [super init]) == nil)
         return nil;
 
     _signalHandlerType = signalHandlerType;
     _symbolicationStrategy = symbolicationStrategy;
+    _liveReportWorkerCount = liveReportWorkerCount;
+    _symbolIndexMemoryBudget = symbolIndexMemoryBudget;
+    _crashTimeMemoryBudget = crashTimeMemoryBudget;
+    _threadSignalStackCount = threadSignalStackCount;
+    _threadCaptureOrder = threadCaptureOrder;
+    _threadFrameLimit = threadFrameLimit;
+    _reportTimeBudget = reportTimeBudget;
+    _reportSizeBudget = reportSizeBudget;
+    _compressReports = compressReports;
+    _captureMemorySummary = captureMemorySummary;
+    _crashWorkerCount = crashWorkerCount;
+    _wireCrashTimeMemory = wireCrashTimeMemory;
+    _crashPathWarmingInterval = crashPathWarmingInterval;
+    _maximumQueuedReportCount = maximumQueuedReportCount;
+    _maximumQueuedReportBytes = maximumQueuedReportBytes;
+    _maximumQueuedReportAge = maximumQueuedReportAge;
+    _crashLoopDeduplicationWindow = crashLoopDeduplicationWindow;
+    _symbolicatedThreadFrameLimit = symbolicatedThreadFrameLimit;
+    _persistSymbolIndices = persistSymbolIndices;
 
     return self;
 }
@@ -0,0 +1,172 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import <Foundation/Foundation.h>
+
+/** The number of buckets in PLCrashReporterStatistics::liveReportLatencyHistogram. */
+#define PLCRASH_STATISTICS_LATENCY_BUCKETS 12
+
+@interface PLCrashReporterStatistics : NSObject {
+@private
+    /** Number of registered images */
+    NSUInteger _registeredImageCount;
+
+    /** Estimated image list footprint, in bytes */
+    uint64_t _imageListFootprint;
+
+    /** Total image index allocation, in bytes */
+    uint64_t _imageIndexBytes;
+
+    /** Total image index build time */
+    NSTimeInterval _imageIndexTime;
+
+    /** Per-image index build times, keyed by image path */
+    NSDictionary *_imageIndexTimes;
+
+    /** Number of live reports generated */
+    uint64_t _liveReportCount;
+
+    /** Live report latency histogram (NSNumber instances) */
+    NSArray *_liveReportLatencyHistogram;
+
+    /** Crash-time memory reserved, in bytes */
+    uint64_t _crashTimeMemoryReserved;
+
+    /** Crash-time memory used, in bytes */
+    uint64_t _crashTimeMemoryUsed;
+
+    /** Crash-time memory wired, in bytes */
+    uint64_t _crashTimeMemoryWired;
+
+    /** Crash path memory warmed, in bytes */
+    uint64_t _crashPathWarmedSize;
+
+    /** Pages faulted in by the crash path warmer */
+    uint64_t _crashPathPageInCount;
+
+    /** Symbol index warm-up budget, in bytes */
+    uint64_t _symbolIndexMemoryBudget;
+
+    /** Symbol index warm-up allocation, in bytes */
+    uint64_t _symbolIndexMemoryUsed;
+}
+
+- (id) initWithRegisteredImageCount: (NSUInteger) registeredImageCount
+                 imageListFootprint: (uint64_t) imageListFootprint
+                    imageIndexBytes: (uint64_t) imageIndexBytes
+                     imageIndexTime: (NSTimeInterval) imageIndexTime
+                    imageIndexTimes: (NSDictionary *) imageIndexTimes
+                    liveReportCount: (uint64_t) liveReportCount
+         liveReportLatencyHistogram: (NSArray *) liveReportLatencyHistogram
+            crashTimeMemoryReserved: (uint64_t) crashTimeMemoryReserved
+                crashTimeMemoryUsed: (uint64_t) crashTimeMemoryUsed
+               crashTimeMemoryWired: (uint64_t) crashTimeMemoryWired
+                crashPathWarmedSize: (uint64_t) crashPathWarmedSize
+               crashPathPageInCount: (uint64_t) crashPathPageInCount
+            symbolIndexMemoryBudget: (uint64_t) symbolIndexMemoryBudget
+              symbolIndexMemoryUsed: (uint64_t) symbolIndexMemoryUsed;
+
+/**
+ * The number of images currently registered with the crash reporter.
+ */
+@property(nonatomic, readonly) NSUInteger registeredImageCount;
+
+/**
+ * An estimate of the memory allocated for the registered image list, in bytes, including the copied load
+ * commands, pre-encoded image records, and any symbol, Objective-C, or DWARF indices.
+ */
+@property(nonatomic, readonly) uint64_t imageListFootprint;
+
+/**
+ * The memory allocated for symbol, Objective-C, and DWARF indices of the registered images, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t imageIndexBytes;
+
+/**
+ * The total time spent building indices for the registered images.
+ */
+@property(nonatomic, readonly) NSTimeInterval imageIndexTime;
+
+/**
+ * The time spent building indices for each registered image for which an index has been built, as a dictionary
+ * of NSNumber time intervals keyed by image path.
+ */
+@property(nonatomic, readonly) NSDictionary *imageIndexTimes;
+
+/**
+ * The number of live reports generated by the reporter.
+ */
+@property(nonatomic, readonly) uint64_t liveReportCount;
+
+/**
+ * A histogram of live report generation latency, as an array of PLCRASH_STATISTICS_LATENCY_BUCKETS NSNumber
+ * counts. Bucket @a i counts reports generated in less than 2^i milliseconds (and, for i > 0, at least
+ * 2^(i-1) milliseconds); the final bucket counts all slower reports.
+ */
+@property(nonatomic, readonly) NSArray *liveReportLatencyHistogram;
+
+/**
+ * The memory reserved for use at crash time, in bytes, or 0 if setup is not yet complete.
+ */
+@property(nonatomic, readonly) uint64_t crashTimeMemoryReserved;
+
+/**
+ * The portion of crashTimeMemoryReserved allocated to the crash-time frame and CIE caches, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t crashTimeMemoryUsed;
+
+/**
+ * The crash-time memory pre-faulted and wired, in bytes, including the crash-time arena, worker capture storage,
+ * report buffer, and alternate signal stacks. This is 0 unless PLCrashReporterConfig::wireCrashTimeMemory is
+ * enabled.
+ */
+@property(nonatomic, readonly) uint64_t crashTimeMemoryWired;
+
+/**
+ * The size of the crash path text and crash-time buffers warmed in the background, in bytes. This is 0 unless
+ * PLCrashReporterConfig::crashPathWarmingInterval is non-zero.
+ */
+@property(nonatomic, readonly) uint64_t crashPathWarmedSize;
+
+/**
+ * The number of non-resident pages faulted in by background crash path warming; each would otherwise have been
+ * faulted in by the crash handler.
+ */
+@property(nonatomic, readonly) uint64_t crashPathPageInCount;
+
+/**
+ * The memory budget for background symbol index warm-up, in bytes, or 0 if warm-up is not enabled.
+ */
+@property(nonatomic, readonly) uint64_t symbolIndexMemoryBudget;
+
+/**
+ * The memory allocated by background symbol index warm-up, in bytes.
+ */
+@property(nonatomic, readonly) uint64_t symbolIndexMemoryUsed;
+
+@end
@@ -0,0 +1,111 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "PLCrashReporterStatistics.h"
+
+/**
+ * Provides access to the counters maintained by a PLCrashReporter instance; see PLCrashReporter::statistics.
+ */
+@implementation PLCrashReporterStatistics
+
+/**
+ * Initialize with the provided counters.
+ *
+ * @param registeredImageCount The number of registered images.
+ * @param imageListFootprint The estimated image list footprint, in bytes.
+ * @param imageIndexBytes The memory allocated for image indices, in bytes.
+ * @param imageIndexTime The total time spent building image indices.
+ * @param imageIndexTimes Per-image index build times (NSNumber instances), keyed by image path.
+ * @param liveReportCount The number of live reports generated.
+ * @param liveReportLatencyHistogram The live report latency histogram (NSNumber instances).
+ * @param crashTimeMemoryReserved The memory reserved for use at crash time, in bytes.
+ * @param crashTimeMemoryUsed The portion of @a crashTimeMemoryReserved in use, in bytes.
+ * @param crashTimeMemoryWired The crash-time memory pre-faulted and wired, in bytes.
+ * @param crashPathWarmedSize The size of the crash path memory warmed in the background, in bytes.
+ * @param crashPathPageInCount The number of pages faulted in by background crash path warming.
+ * @param symbolIndexMemoryBudget The symbol index warm-up budget, in bytes.
+ * @param symbolIndexMemoryUsed The memory allocated by symbol index warm-up, in bytes.
+ */
+- (id) initWithRegisteredImageCount: (NSUInteger) registeredImageCount
+                 imageListFootprint: (uint64_t) imageListFootprint
+                    imageIndexBytes: (uint64_t) imageIndexBytes
+                     imageIndexTime: (NSTimeInterval) imageIndexTime
+                    imageIndexTimes: (NSDictionary *) imageIndexTimes
+                    liveReportCount: (uint64_t) liveReportCount
+         liveReportLatencyHistogram: (NSArray *) liveReportLatencyHistogram
+            crashTimeMemoryReserved: (uint64_t) crashTimeMemoryReserved
+                crashTimeMemoryUsed: (uint64_t) crashTimeMemoryUsed
+               crashTimeMemoryWired: (uint64_t) crashTimeMemoryWired
+                crashPathWarmedSize: (uint64_t) crashPathWarmedSize
+               crashPathPageInCount: (uint64_t) crashPathPageInCount
+            symbolIndexMemoryBudget: (uint64_t) symbolIndexMemoryBudget
+              symbolIndexMemoryUsed: (uint64_t) symbolIndexMemoryUsed
+{
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _registeredImageCount = registeredImageCount;
+    _imageListFootprint = imageListFootprint;
+    _imageIndexBytes = imageIndexBytes;
+    _imageIndexTime = imageIndexTime;
+    _imageIndexTimes = [imageIndexTimes retain];
+    _liveReportCount = liveReportCount;
+    _liveReportLatencyHistogram = [liveReportLatencyHistogram retain];
+    _crashTimeMemoryReserved = crashTimeMemoryReserved;
+    _crashTimeMemoryUsed = crashTimeMemoryUsed;
+    _crashTimeMemoryWired = crashTimeMemoryWired;
+    _crashPathWarmedSize = crashPathWarmedSize;
+    _crashPathPageInCount = crashPathPageInCount;
+    _symbolIndexMemoryBudget = symbolIndexMemoryBudget;
+    _symbolIndexMemoryUsed = symbolIndexMemoryUsed;
+
+    return self;
+}
+
+- (void) dealloc {
+    [_imageIndexTimes release];
+    [_liveReportLatencyHistogram release];
+    [super dealloc];
+}
+
+@synthesize registeredImageCount = _registeredImageCount;
+@synthesize imageListFootprint = _imageListFootprint;
+@synthesize imageIndexBytes = _imageIndexBytes;
+@synthesize imageIndexTime = _imageIndexTime;
+@synthesize imageIndexTimes = _imageIndexTimes;
+@synthesize liveReportCount = _liveReportCount;
+@synthesize liveReportLatencyHistogram = _liveReportLatencyHistogram;
+@synthesize crashTimeMemoryReserved = _crashTimeMemoryReserved;
+@synthesize crashTimeMemoryUsed = _crashTimeMemoryUsed;
+@synthesize crashTimeMemoryWired = _crashTimeMemoryWired;
+@synthesize crashPathWarmedSize = _crashPathWarmedSize;
+@synthesize crashPathPageInCount = _crashPathPageInCount;
+@synthesize symbolIndexMemoryBudget = _symbolIndexMemoryBudget;
+@synthesize symbolIndexMemoryUsed = _symbolIndexMemoryUsed;
+
+@end
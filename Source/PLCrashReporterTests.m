@@ -33,6 +33,91 @@
 #import "PLCrashFrameWalker.h"
 #import "PLCrashTestThread.h"
 
+#import <dlfcn.h>
+
+@interface PLCrashReporter (UploadTests)
+- (NSString *) crashReportDirectory;
+- (NSString *) queuedCrashReportDirectory;
+@end
+
+/* Concurrent live report generation state; see -testGenerateConcurrentLiveReports */
+struct concurrent_live_report_args {
+    PLCrashReporter *reporter;
+    uint32_t iterations;
+    volatile int32_t failures;
+};
+
+/* Backtrace capture helper; see -testCaptureBacktrace */
+static NSUInteger __attribute__((noinline)) capture_backtrace_helper (uint64_t *pcs, NSUInteger maxCount, NSUInteger skipCount) {
+    NSUInteger count = [PLCrashReporter captureBacktrace: pcs maxCount: maxCount skipCount: skipCount];
+
+    /* Prevent a tail call, which would remove this function from the stack */
+    __asm__ __volatile__ ("");
+    return count;
+}
+
+static void *concurrent_live_report_thread (void *arg) {
+    struct concurrent_live_report_args *args = arg;
+
+    for (uint32_t i = 0; i < args->iterations; i++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+        NSData *reportData = [args->reporter generateLiveReportAndReturnError: NULL];
+        if (reportData == nil || [[[PLCrashReport alloc] initWithData: reportData error: NULL] autorelease] == nil)
+            OSAtomicIncrement32Barrier(&args->failures);
+
+        [pool release];
+    }
+
+    return NULL;
+}
+
+/* Upload delegate that records the batches it receives */
+@interface PLCrashReporterTestsUploadDelegate : NSObject <PLCrashReporterUploadDelegate> {
+@public
+    NSCondition *_condition;
+    NSMutableArray *_reports;
+    BOOL _done;
+}
+@end
+
+@implementation PLCrashReporterTestsUploadDelegate
+
+- (id) init {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _condition = [[NSCondition alloc] init];
+    _reports = [[NSMutableArray alloc] init];
+    return self;
+}
+
+- (void) dealloc {
+    [_condition release];
+    [_reports release];
+    [super dealloc];
+}
+
+- (BOOL) crashReporter: (PLCrashReporter *) reporter
+uploadCrashReportBatch: (NSData *) batch
+           reportCount: (NSUInteger) count
+                 error: (NSError **) outError
+{
+    NSArray *reports = [PLCrashReporter crashReportDataFromUploadBatch: batch error: outError];
+    if (reports == nil || [reports count] != count)
+        return NO;
+
+    [_condition lock];
+    [_reports addObjectsFromArray: reports];
+    _done = ([_reports count] == 3);
+    [_condition signal];
+    [_condition unlock];
+
+    return YES;
+}
+
+@end
+
 @interface PLCrashReporterTests : SenTestCase
 @end
 
@@ -82,4 +167,251 @@
     STAssertEqualStrings([[report signalInfo] code], @"TRAP_TRACE", @"Incorrect signal code");
 }
 
+/**
+ * Test that repeated live reports, generated with the reporter's reused writer, are assigned unique incident UUIDs.
+ */
+- (void) testGenerateRepeatedLiveReports {
+    NSError *error;
+    PLCrashReport *reports[2];
+
+    for (int i = 0; i < 2; i++) {
+        NSData *reportData = [[PLCrashReporter sharedReporter] generateLiveReportAndReturnError: &error];
+        STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+        reports[i] = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+        STAssertNotNil(reports[i], @"Could not parse geneated live report: %@", error);
+    }
+
+    STAssertNotNULL(reports[0].uuidRef, @"Missing report UUID");
+    STAssertNotNULL(reports[1].uuidRef, @"Missing report UUID");
+    STAssertFalse(CFEqual(reports[0].uuidRef, reports[1].uuidRef), @"Reused writer did not generate a new incident UUID");
+    STAssertEqualStrings(reports[0].processInfo.processName, reports[1].processInfo.processName, @"Process info was not retained");
+}
+
+/**
+ * Test that live reports may be generated concurrently from multiple threads, including more threads than there
+ * are reusable live report writers.
+ */
+- (void) testGenerateConcurrentLiveReports {
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    struct concurrent_live_report_args args = { .reporter = reporter, .iterations = 4, .failures = 0 };
+    pthread_t threads[8];
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+        STAssertEquals(pthread_create(&threads[i], NULL, concurrent_live_report_thread, &args), 0, @"Failed to spawn thread");
+
+    for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]); i++)
+        pthread_join(threads[i], NULL);
+
+    STAssertEquals(args.failures, (int32_t) 0, @"Concurrent live report generation failed");
+    STAssertEquals([[reporter statistics] liveReportCount], (uint64_t) (args.iterations * 8), @"Live reports not counted");
+}
+
+/**
+ * Test that the shared image list is populated on first use by a reporter that has not been enabled.
+ */
+- (void) testLiveReportPopulatesImageList {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+    STAssertFalse([reporter isSetupComplete], @"Setup reported as complete prior to enabling the reporter");
+
+    NSData *reportData = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(reportData, @"Failed to generate live report: %@", error);
+
+    PLCrashReport *report = [[[PLCrashReport alloc] initWithData: reportData error: &error] autorelease];
+    STAssertNotNil(report, @"Could not parse generated live report: %@", error);
+    STAssertNotNil([report imageForAddress: (uint64_t) (uintptr_t) [self methodForSelector: _cmd]], @"The test image was not registered");
+}
+
+/**
+ * Test that live report generation is reflected in the reporter's statistics.
+ */
+- (void) testStatistics {
+    NSError *error;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+
+    PLCrashReporterStatistics *stats = [reporter statistics];
+    STAssertEquals([stats liveReportCount], (uint64_t) 0, @"Unexpected live report count");
+    STAssertEquals([[stats liveReportLatencyHistogram] count], (NSUInteger) PLCRASH_STATISTICS_LATENCY_BUCKETS, @"Incorrect bucket count");
+    STAssertEquals([stats crashTimeMemoryReserved], (uint64_t) 0, @"Crash-time memory reported prior to setup");
+
+    STAssertNotNil([reporter generateLiveReportAndReturnError: &error], @"Failed to generate live report: %@", error);
+
+    stats = [reporter statistics];
+    STAssertEquals([stats liveReportCount], (uint64_t) 1, @"Live report not counted");
+    STAssertTrue([stats registeredImageCount] > 0, @"No registered images");
+    STAssertTrue([stats imageListFootprint] > 0, @"No image list footprint");
+
+    uint64_t total = 0;
+    for (NSNumber *count in [stats liveReportLatencyHistogram])
+        total += [count unsignedLongLongValue];
+    STAssertEquals(total, (uint64_t) 1, @"Live report latency not recorded");
+}
+
+/**
+ * Test that resource reports can't be enabled without the Mach exception handler.
+ */
+- (void) testEnableResourceReportsRequiresMachHandler {
+    NSError *error = nil;
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: [PLCrashReporterConfig defaultConfiguration]] autorelease];
+
+    STAssertFalse([reporter enableResourceReportsWithMinimumInterval: 60.0 error: &error], @"Resource reports enabled without a Mach exception server");
+    STAssertNotNil(error, @"No error returned");
+
+    /* Disabling is a no-op */
+    [reporter disableResourceReports];
+}
+
+/**
+ * Test queuing and batched upload of pending reports.
+ */
+- (void) testUploadQueuedCrashReports {
+    PLCrashReporter *reporter = [PLCrashReporter sharedReporter];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSError *error;
+
+    STAssertTrue([fm createDirectoryAtPath: [reporter queuedCrashReportDirectory] withIntermediateDirectories: YES attributes: nil error: &error], @"Could not create directory: %@", error);
+
+    /* Write three fake pending reports */
+    NSMutableArray *expected = [NSMutableArray array];
+    for (int i = 0; i < 3; i++) {
+        NSData *data = [[NSString stringWithFormat: @"report %d", i] dataUsingEncoding: NSUTF8StringEncoding];
+        NSString *path = [[reporter crashReportDirectory] stringByAppendingPathComponent: [NSString stringWithFormat: @"test_%d.plcrash", i]];
+        STAssertTrue([data writeToFile: path options: NSDataWritingAtomic error: &error], @"Could not write report: %@", error);
+
+        NSDictionary *attributes = [NSDictionary dictionaryWithObject: [NSDate dateWithTimeIntervalSinceNow: -100 + i] forKey: NSFileModificationDate];
+        STAssertTrue([fm setAttributes: attributes ofItemAtPath: path error: &error], @"Could not set date: %@", error);
+        [expected addObject: data];
+    }
+
+    /* Queue and upload, two reports per batch */
+    PLCrashReporterTestsUploadDelegate *delegate = [[[PLCrashReporterTestsUploadDelegate alloc] init] autorelease];
+    STAssertTrue([reporter uploadQueuedCrashReportsWithDelegate: delegate maximumBatchCount: 2 error: &error], @"Upload failed to start: %@", error);
+    STAssertFalse([reporter hasPendingCrashReports], @"Reports were not queued");
+
+    [delegate->_condition lock];
+    while (!delegate->_done) {
+        if (![delegate->_condition waitUntilDate: [NSDate dateWithTimeIntervalSinceNow: 10.0]])
+            break;
+    }
+    [delegate->_condition unlock];
+
+    STAssertEqualObjects(delegate->_reports, expected, @"Reports were not uploaded in order");
+
+    /* The upload thread deletes each batch after the delegate returns; wait for the queue to drain. The queue's
+     * index is retained. */
+    NSArray *extensions = [NSArray arrayWithObject: @"plcrash"];
+    for (int i = 0; i < 100 && [[[fm contentsOfDirectoryAtPath: [reporter queuedCrashReportDirectory] error: NULL] pathsMatchingExtensions: extensions] count] > 0; i++)
+        [NSThread sleepForTimeInterval: 0.1];
+    STAssertEquals([[[fm contentsOfDirectoryAtPath: [reporter queuedCrashReportDirectory] error: NULL] pathsMatchingExtensions: extensions] count], (NSUInteger) 0, @"Uploaded reports were not deleted");
+}
+
+/**
+ * Test collapsing of duplicate pending reports into a single report and occurrence count.
+ */
+- (void) testCrashLoopDeduplication {
+    PLCrashReporterConfig *config = [[[PLCrashReporterConfig alloc] initWithSignalHandlerType: PLCrashReporterSignalHandlerTypeBSD
+                                                                        symbolicationStrategy: PLCrashReporterSymbolicationStrategyNone
+                                                                        liveReportWorkerCount: 0
+                                                                      symbolIndexMemoryBudget: 0
+                                                                        crashTimeMemoryBudget: 0
+                                                                       threadSignalStackCount: 0
+                                                                           threadCaptureOrder: PLCrashReporterThreadCaptureOrderKernel
+                                                                             threadFrameLimit: 0
+                                                                             reportTimeBudget: 0
+                                                                             reportSizeBudget: 0
+                                                                              compressReports: NO
+                                                                         captureMemorySummary: NO
+                                                                             crashWorkerCount: 0
+                                                                          wireCrashTimeMemory: NO
+                                                                     crashPathWarmingInterval: 0
+                                                                     maximumQueuedReportCount: 0
+                                                                     maximumQueuedReportBytes: 0
+                                                                       maximumQueuedReportAge: 0
+                                                                 crashLoopDeduplicationWindow: 60] autorelease];
+    PLCrashReporter *reporter = [[[PLCrashReporter alloc] initWithConfiguration: config] autorelease];
+    NSFileManager *fm = [NSFileManager defaultManager];
+    NSError *error;
+
+    NSData *report = [reporter generateLiveReportAndReturnError: &error];
+    STAssertNotNil(report, @"Could not generate live report: %@", error);
+    STAssertTrue([fm createDirectoryAtPath: [reporter crashReportDirectory] withIntermediateDirectories: YES attributes: nil error: &error], @"Could not create directory: %@", error);
+
+    /* Discard any reports left pending by other tests */
+    [reporter loadPendingCrashReportData: ^(NSData *data, BOOL *purge) {
+        *purge = YES;
+    }];
+
+    /* Write three identical reports within the window, and a fourth outside of it */
+    NSTimeInterval offsets[] = { -300, -290, -280, -100 };
+    for (int i = 0; i < 4; i++) {
+        NSString *path = [[reporter crashReportDirectory] stringByAppendingPathComponent: [NSString stringWithFormat: @"loop_%d.plcrash", i]];
+        STAssertTrue([report writeToFile: path options: NSDataWritingAtomic error: &error], @"Could not write report: %@", error);
+
+        NSDictionary *attributes = [NSDictionary dictionaryWithObject: [NSDate dateWithTimeIntervalSinceNow: offsets[i]] forKey: NSFileModificationDate];
+        STAssertTrue([fm setAttributes: attributes ofItemAtPath: path error: &error], @"Could not set date: %@", error);
+    }
+
+    NSMutableArray *occurrences = [NSMutableArray array];
+    BOOL loaded = [reporter loadPendingCrashReportDataWithMaximumBytes: 0 occurrenceBlock: ^(NSData *data, NSUInteger count, BOOL *purge, BOOL *stop) {
+        [occurrences addObject: [NSNumber numberWithUnsignedInteger: count]];
+        *purge = YES;
+    } error: &error];
+    STAssertTrue(loaded, @"Could not load reports: %@", error);
+
+    NSArray *expected = [NSArray arrayWithObjects: [NSNumber numberWithUnsignedInteger: 3], [NSNumber numberWithUnsignedInteger: 1], nil];
+    STAssertEqualObjects(occurrences, expected, @"Duplicate reports were not collapsed");
+    STAssertFalse([reporter hasPendingCrashReports], @"Reports were not purged");
+}
+
+/**
+ * Test sampling of a thread's stack.
+ */
+- (void) testSampleStackForThread {
+    NSError *error;
+    plcrash_test_thread_t thr;
+    uint64_t pcs[128];
+    NSUInteger count = 0;
+
+    /* Sample a spawned thread */
+    plcrash_test_thread_spawn(&thr);
+    BOOL result = [[PLCrashReporter sharedReporter] sampleStackForThread: pthread_mach_thread_np(thr.thread) pcs: pcs maxCount: 128 count: &count error: &error];
+    plcrash_test_thread_stop(&thr);
+
+    STAssertTrue(result, @"Failed to sample thread: %@", error);
+    STAssertTrue(count > 0, @"No frames were sampled");
+
+    /* Sample the current thread, with truncation */
+    result = [[PLCrashReporter sharedReporter] sampleStackForThread: pl_mach_thread_self() pcs: pcs maxCount: 2 count: &count error: &error];
+    STAssertTrue(result, @"Failed to sample current thread: %@", error);
+    STAssertEquals(count, (NSUInteger) 2, @"Sample was not truncated to the requested depth");
+    for (NSUInteger i = 0; i < count; i++)
+        STAssertNotEquals(pcs[i], (uint64_t) 0, @"Sample includes a NULL pc");
+}
+
+/**
+ * Test capture of the current thread's backtrace.
+ */
+- (void) testCaptureBacktrace {
+    uint64_t pcs[128];
+    Dl_info info;
+
+    /* The first PC should be the return address into the caller */
+    NSUInteger count = capture_backtrace_helper(pcs, 128, 0);
+    STAssertTrue(count > 1, @"No frames were captured");
+    STAssertTrue(dladdr((void *) (uintptr_t) pcs[0], &info) != 0, @"Could not resolve the first pc");
+    STAssertEquals(info.dli_saddr, (void *) capture_backtrace_helper, @"The first pc is not within the calling function");
+
+    /* Skipping the helper should produce the remainder of the same backtrace */
+    uint64_t skipped[128];
+    NSUInteger skippedCount = capture_backtrace_helper(skipped, 128, 1);
+    STAssertEquals(skippedCount, count - 1, @"Incorrect number of frames after skipping");
+    for (NSUInteger i = 1; i < skippedCount; i++)
+        STAssertEquals(skipped[i], pcs[i + 1], @"Skipped backtrace differs at frame %lu", (unsigned long) i);
+
+    /* Truncation */
+    STAssertEquals(capture_backtrace_helper(pcs, 2, 0), (NSUInteger) 2, @"Backtrace was not truncated to the requested depth");
+    STAssertEquals(capture_backtrace_helper(pcs, 0, 0), (NSUInteger) 0, @"Empty buffer was written");
+}
+
 @end
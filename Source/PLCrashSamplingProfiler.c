@@ -0,0 +1,513 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashSamplingProfiler.h"
+
+#include "PLCrashFeatureConfig.h"
+#include "PLCrashFrameWalker.h"
+#include "PLCrashProbes.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <mach/mach_time.h>
+#include <libkern/OSAtomic.h>
+#include <libkern/OSThermalNotification.h>
+#include <notify.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_sampling_profiler
+ * @{
+ */
+
+/**
+ * The number of samples between polls of the thermal pressure level.
+ */
+#define PLCRASH_SAMPLING_PROFILER_THERMAL_POLL 16
+
+/**
+ * Initialize a sampling rate controller.
+ *
+ * The sampling interval is derived from a moving average of the measured per-sample cost such that sampling
+ * consumes at most @a budget_ppm of a single core; eg, a 50µs sample cost and a budget of 5000 (0.5%) yield a 10ms
+ * interval. The interval is clamped to [@a min_interval_usec, @a max_interval_usec].
+ *
+ * @param budget The controller to be initialized.
+ * @param budget_ppm The permitted CPU usage, in parts per million of a single core. If 0, the interval is fixed at
+ * @a min_interval_usec.
+ * @param min_interval_usec The minimum interval between samples, in microseconds.
+ * @param max_interval_usec The maximum interval between samples, in microseconds. Values less than
+ * @a min_interval_usec are treated as @a min_interval_usec.
+ */
+void plcrash_sampling_budget_init (plcrash_sampling_budget_t *budget, uint32_t budget_ppm, uint32_t min_interval_usec, uint32_t max_interval_usec) {
+    budget->budget_ppm = budget_ppm;
+    budget->min_interval_usec = min_interval_usec;
+    budget->max_interval_usec = (max_interval_usec < min_interval_usec) ? min_interval_usec : max_interval_usec;
+    budget->constrained = false;
+    budget->average_cost_nsec = 0;
+    budget->interval_usec = min_interval_usec;
+}
+
+/* Recompute the interval of @a budget from its average sample cost */
+static void plcrash_sampling_budget_update (plcrash_sampling_budget_t *budget) {
+    if (budget->budget_ppm == 0) {
+        budget->interval_usec = budget->min_interval_usec;
+        return;
+    }
+
+    uint64_t ppm = budget->budget_ppm;
+    if (budget->constrained)
+        ppm /= PLCRASH_SAMPLING_BUDGET_CONSTRAINED_DIVISOR;
+
+    /* interval = cost / (ppm / 10^6), converted from nanoseconds to microseconds */
+    uint64_t interval = (ppm > 0) ? budget->average_cost_nsec * 1000 / ppm : budget->max_interval_usec;
+    if (interval < budget->min_interval_usec)
+        interval = budget->min_interval_usec;
+    else if (interval > budget->max_interval_usec)
+        interval = budget->max_interval_usec;
+
+    budget->interval_usec = (uint32_t) interval;
+}
+
+/**
+ * Record the cost of a sample, and return the interval to be observed before the next sample.
+ *
+ * @param budget The rate controller.
+ * @param cost_nsec The time spent taking the sample, in nanoseconds.
+ *
+ * @return Returns the interval before the next sample, in microseconds.
+ */
+uint32_t plcrash_sampling_budget_record (plcrash_sampling_budget_t *budget, uint64_t cost_nsec) {
+    /* Exponential moving average, weighting each new sample by 1/8 */
+    if (budget->average_cost_nsec == 0)
+        budget->average_cost_nsec = cost_nsec;
+    else if (cost_nsec >= budget->average_cost_nsec)
+        budget->average_cost_nsec += (cost_nsec - budget->average_cost_nsec) / 8;
+    else
+        budget->average_cost_nsec -= (budget->average_cost_nsec - cost_nsec) / 8;
+
+    plcrash_sampling_budget_update(budget);
+    return budget->interval_usec;
+}
+
+/**
+ * Set whether the device is under thermal pressure or in low power mode. While constrained, the budget is reduced
+ * by PLCRASH_SAMPLING_BUDGET_CONSTRAINED_DIVISOR.
+ *
+ * @param budget The rate controller.
+ * @param constrained If true, the device is constrained.
+ */
+void plcrash_sampling_budget_set_constrained (plcrash_sampling_budget_t *budget, bool constrained) {
+    if (budget->constrained == constrained)
+        return;
+
+    budget->constrained = constrained;
+    plcrash_sampling_budget_update(budget);
+}
+
+/**
+ * Initialize a thermal pressure monitor.
+ *
+ * @param monitor The monitor to be initialized.
+ */
+void plcrash_sampling_thermal_monitor_init (plcrash_sampling_thermal_monitor_t *monitor) {
+    monitor->registered = notify_register_check(kOSThermalNotificationPressureLevelName, &monitor->token) == NOTIFY_STATUS_OK;
+}
+
+/**
+ * Return true if the system is under heavy (or worse) thermal pressure.
+ *
+ * @param monitor The monitor instance.
+ */
+bool plcrash_sampling_thermal_monitor_pressured (plcrash_sampling_thermal_monitor_t *monitor) {
+    uint64_t level = kOSThermalPressureLevelNominal;
+    if (monitor->registered && notify_get_state(monitor->token, &level) != NOTIFY_STATUS_OK)
+        return false;
+
+    return level >= kOSThermalPressureLevelHeavy;
+}
+
+/**
+ * Free all resources associated with @a monitor.
+ *
+ * @param monitor The monitor to be freed.
+ */
+void plcrash_sampling_thermal_monitor_free (plcrash_sampling_thermal_monitor_t *monitor) {
+    if (monitor->registered)
+        notify_cancel(monitor->token);
+    monitor->registered = false;
+}
+
+/**
+ * Initialize a new sampling profiler. The profiler will not begin sampling until plcrash_sampling_profiler_start()
+ * is called.
+ *
+ * @param profiler The profiler to be initialized.
+ * @param task The task containing @a thread.
+ * @param thread The thread to be sampled. This must not be the thread that will call plcrash_sampling_profiler_sample().
+ * @param image_list The task's image list. This is a borrowed reference, and must remain valid for the lifetime of the profiler.
+ * @param interval_usec The interval between samples, in microseconds. If a sampling budget is configured with
+ * plcrash_sampling_profiler_set_budget(), this is the minimum interval.
+ * @param capacity The number of samples retained in the ring buffer.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the ring buffer could not be allocated.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_sampling_profiler_init (plcrash_sampling_profiler_t *profiler, task_t task, thread_t thread,
+                                                plcrash_async_image_list_t *image_list, uint32_t interval_usec,
+                                                uint32_t capacity)
+{
+    memset(profiler, 0, sizeof(*profiler));
+
+    if (capacity == 0)
+        return PLCRASH_EINVAL;
+
+    if (mach_timebase_info(&profiler->timebase) != KERN_SUCCESS || profiler->timebase.denom == 0)
+        return PLCRASH_EINTERNAL;
+
+    profiler->samples = calloc(capacity, sizeof(profiler->samples[0]));
+    if (profiler->samples == NULL)
+        return PLCRASH_ENOMEM;
+
+    profiler->task = task;
+    profiler->thread = thread;
+    profiler->image_list = image_list;
+    profiler->interval_usec = interval_usec;
+    profiler->capacity = capacity;
+    profiler->sample_count = 0;
+    plcrash_sampling_budget_init(&profiler->budget, 0, interval_usec, interval_usec);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Limit the profiler's CPU usage. The sampling thread measures the cost of each sample -- suspending the thread,
+ * walking its stack and recording the sample -- and adjusts the sampling interval to remain within @a budget_ppm of a
+ * single core, backing off further while the device is under thermal pressure or in low power mode. The interval
+ * passed to plcrash_sampling_profiler_init() becomes the minimum interval.
+ *
+ * @param profiler The profiler instance.
+ * @param budget_ppm The permitted CPU usage, in parts per million of a single core (eg, 5000 for 0.5%), or 0 to
+ * sample at a fixed interval.
+ * @param max_interval_usec The maximum interval between samples, in microseconds.
+ *
+ * @warning This function is not async-safe, and must be called prior to plcrash_sampling_profiler_start().
+ */
+void plcrash_sampling_profiler_set_budget (plcrash_sampling_profiler_t *profiler, uint32_t budget_ppm, uint32_t max_interval_usec) {
+    plcrash_sampling_budget_init(&profiler->budget, budget_ppm, profiler->interval_usec, max_interval_usec);
+}
+
+/**
+ * Set whether the device is in low power mode. Thermal pressure is monitored by the profiler itself; low power
+ * mode is only available through Foundation, and must be supplied by the profiler's owner. This function may be
+ * called while the profiler is running.
+ *
+ * @param profiler The profiler instance.
+ * @param low_power If true, the device is in low power mode.
+ */
+void plcrash_sampling_profiler_set_low_power (plcrash_sampling_profiler_t *profiler, bool low_power) {
+    profiler->low_power = low_power;
+}
+
+/**
+ * Suspend the profiler's target thread, record a single sample of its stack, and resume the thread.
+ *
+ * The PLFRAME_CURSOR_PIPELINE_FAST reader pipeline is used; DWARF evaluation is too costly to perform at
+ * sampling rates.
+ *
+ * @param profiler The profiler instance.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the thread could not be sampled.
+ */
+plcrash_error_t plcrash_sampling_profiler_sample (plcrash_sampling_profiler_t *profiler) {
+    pl_vm_address_t pcs[PLCRASH_SAMPLING_PROFILER_MAX_FRAMES];
+    uint32_t frame_count = 0;
+    plcrash_probe_interval_t probe;
+    plcrash_error_t err;
+    kern_return_t kr;
+
+    plcrash_probe_begin(&probe, PLCRASH_PROBE_PHASE_SAMPLE, profiler->thread);
+
+    if ((kr = thread_suspend(profiler->thread)) != KERN_SUCCESS) {
+        PLCF_DEBUG("Failed to suspend the sampled thread: %d", kr);
+        plcrash_probe_end(&probe, PLCRASH_EINTERNAL, 0, 0, 0);
+        return PLCRASH_EINTERNAL;
+    }
+
+    /* Walk the stack. The thread state is fetched directly into the cursor's initial frame. */
+    plframe_cursor_t cursor;
+    if (plframe_cursor_thread_init(&cursor, profiler->task, profiler->thread, profiler->image_list) == PLFRAME_ESUCCESS) {
+        plcrash_async_macho_section_cache_t local_cache;
+        plcrash_async_macho_section_cache_t *section_cache;
+
+        /* Hold the image list for reading while the section cache is in use. The list's persistent cache
+         * is preferred; it may be held by the suspended thread, in which case a local cache is used. */
+        plcrash_async_image_list_set_reading(profiler->image_list, true);
+        if ((section_cache = plcrash_nasync_image_list_acquire_unwind_cache(profiler->image_list)) == NULL) {
+            plcrash_async_macho_section_cache_init(&local_cache);
+            section_cache = &local_cache;
+        }
+        plframe_cursor_set_section_cache(&cursor, section_cache);
+        plframe_cursor_set_pipeline(&cursor, PLFRAME_CURSOR_PIPELINE_FAST);
+
+        while (frame_count < PLCRASH_SAMPLING_PROFILER_MAX_FRAMES && plframe_cursor_next(&cursor) == PLFRAME_ESUCCESS) {
+            plcrash_greg_t pc;
+            if (plframe_cursor_get_reg(&cursor, PLCRASH_REG_IP, &pc) != PLFRAME_ESUCCESS)
+                break;
+
+            pcs[frame_count++] = (pl_vm_address_t) pc;
+        }
+
+        plframe_cursor_free(&cursor);
+        if (section_cache == &local_cache)
+            plcrash_async_macho_section_cache_free(&local_cache);
+        else
+            plcrash_nasync_image_list_release_unwind_cache(profiler->image_list, section_cache);
+        plcrash_async_image_list_set_reading(profiler->image_list, false);
+        err = PLCRASH_ESUCCESS;
+    } else {
+        plframe_cursor_free(&cursor);
+        err = PLCRASH_EINTERNAL;
+    }
+
+    thread_resume(profiler->thread);
+    plcrash_probe_end(&probe, err, frame_count, 0, 0);
+
+    if (err != PLCRASH_ESUCCESS)
+        return err;
+
+    /* Publish the sample. The sequence counter is odd while the slot is being written, allowing readers to discard
+     * samples that were overwritten while being read. */
+    plcrash_sampling_profiler_sample_t *sample = &profiler->samples[profiler->sample_count % profiler->capacity];
+
+    sample->sequence++;
+    OSMemoryBarrier();
+
+    sample->timestamp = mach_absolute_time();
+    sample->frame_count = frame_count;
+    memcpy(sample->pcs, pcs, frame_count * sizeof(pcs[0]));
+
+    OSMemoryBarrier();
+    sample->sequence++;
+
+    OSAtomicIncrement64Barrier(&profiler->sample_count);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * @internal
+ * Sampling thread entry point.
+ */
+static void *plcrash_sampling_profiler_main (void *arg) {
+    plcrash_sampling_profiler_t *profiler = arg;
+    plcrash_sampling_thermal_monitor_t thermal;
+    uint32_t sample_count = 0;
+
+    plcrash_sampling_thermal_monitor_init(&thermal);
+
+    while (!profiler->stop) {
+        uint64_t start = mach_absolute_time();
+        plcrash_sampling_profiler_sample(profiler);
+        uint64_t cost_nsec = (mach_absolute_time() - start) * profiler->timebase.numer / profiler->timebase.denom;
+
+        if (sample_count++ % PLCRASH_SAMPLING_PROFILER_THERMAL_POLL == 0) {
+            bool constrained = profiler->low_power || plcrash_sampling_thermal_monitor_pressured(&thermal);
+            plcrash_sampling_budget_set_constrained(&profiler->budget, constrained);
+        }
+
+        usleep(plcrash_sampling_budget_record(&profiler->budget, cost_nsec));
+    }
+
+    plcrash_sampling_thermal_monitor_free(&thermal);
+
+    return NULL;
+}
+
+/**
+ * Start the profiler's sampling thread.
+ *
+ * @param profiler The profiler instance.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or an error if the sampling thread could not be started.
+ *
+ * @warning This function is not async-safe.
+ */
+plcrash_error_t plcrash_sampling_profiler_start (plcrash_sampling_profiler_t *profiler) {
+    if (profiler->running)
+        return PLCRASH_ESUCCESS;
+
+    profiler->stop = false;
+    int perr = pthread_create(&profiler->sampler, NULL, plcrash_sampling_profiler_main, profiler);
+    if (perr != 0) {
+        PLCF_DEBUG("Failed to start the sampling thread: %s", strerror(perr));
+        return PLCRASH_EINTERNAL;
+    }
+
+    profiler->running = true;
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Stop the profiler's sampling thread, waiting for any in-progress sample to complete. Previously recorded samples
+ * remain available.
+ *
+ * @param profiler The profiler instance.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_sampling_profiler_stop (plcrash_sampling_profiler_t *profiler) {
+    if (!profiler->running)
+        return;
+
+    profiler->stop = true;
+    pthread_join(profiler->sampler, NULL);
+    profiler->running = false;
+}
+
+/**
+ * Stop the profiler, if running, and free all associated resources.
+ *
+ * @param profiler The profiler instance.
+ *
+ * @warning This function is not async-safe.
+ */
+void plcrash_sampling_profiler_free (plcrash_sampling_profiler_t *profiler) {
+    plcrash_sampling_profiler_stop(profiler);
+
+    if (profiler->samples != NULL)
+        free(profiler->samples);
+    profiler->samples = NULL;
+}
+
+/**
+ * @internal
+ * Return the child of @a parent with the given @a pc, inserting a new node if none exists and space is available.
+ *
+ * @return Returns the child's index, or 0 if the node table is full.
+ */
+static uint32_t plcrash_sampling_profiler_child (plcrash_sampling_profiler_node_t *nodes, size_t max_nodes, size_t *node_count,
+                                                 uint32_t parent, pl_vm_address_t pc)
+{
+    uint32_t *link = &nodes[parent].first_child;
+    while (*link != 0) {
+        if (nodes[*link].pc == pc)
+            return *link;
+        link = &nodes[*link].next_sibling;
+    }
+
+    if (*node_count >= max_nodes)
+        return 0;
+
+    uint32_t child = (uint32_t) (*node_count)++;
+    nodes[child].pc = pc;
+    nodes[child].sample_count = 0;
+    nodes[child].first_child = 0;
+    nodes[child].next_sibling = 0;
+    *link = child;
+
+    return child;
+}
+
+/**
+ * Aggregate the samples recorded within the last @a window_nsec nanoseconds into a deduplicated call tree.
+ *
+ * The tree is rooted at node 0, which has no PC value, and whose @a sample_count is the total number of samples
+ * aggregated. Each path from the root follows a sampled stack from the outermost frame inward. Paths that do not
+ * fit within @a max_nodes are truncated.
+ *
+ * This function does not allocate, and may be called while the profiler is running, including from a crash handler.
+ *
+ * @param profiler The profiler instance.
+ * @param window_nsec The age, in nanoseconds, of the oldest sample to be included.
+ * @param nodes The node table to be populated.
+ * @param max_nodes The number of entries available in @a nodes.
+ *
+ * @return Returns the number of nodes written to @a nodes, or 0 if @a max_nodes is 0.
+ */
+size_t plcrash_sampling_profiler_call_tree (plcrash_sampling_profiler_t *profiler, uint64_t window_nsec,
+                                            plcrash_sampling_profiler_node_t *nodes, size_t max_nodes)
+{
+    if (max_nodes == 0)
+        return 0;
+
+    /* Initialize the root */
+    size_t node_count = 1;
+    memset(&nodes[0], 0, sizeof(nodes[0]));
+
+    /* Convert the window to mach_absolute_time() units */
+    mach_timebase_info_data_t timebase;
+    if (mach_timebase_info(&timebase) != KERN_SUCCESS || timebase.numer == 0)
+        return node_count;
+
+    uint64_t now = mach_absolute_time();
+    uint64_t window = window_nsec / timebase.numer * timebase.denom;
+    uint64_t oldest = (window < now) ? now - window : 0;
+
+    /* Walk the samples from newest to oldest, stopping at the first sample outside the window */
+    int64_t total = profiler->sample_count;
+    int64_t available = (total < profiler->capacity) ? total : profiler->capacity;
+
+    for (int64_t i = 1; i <= available; i++) {
+        plcrash_sampling_profiler_sample_t *slot = &profiler->samples[(total - i) % profiler->capacity];
+        plcrash_sampling_profiler_sample_t sample;
+
+        /* Copy out the sample, discarding it if it was modified while being read */
+        uint32_t sequence = slot->sequence;
+        OSMemoryBarrier();
+        sample = *slot;
+        OSMemoryBarrier();
+
+        if ((sequence & 1) != 0 || slot->sequence != sequence)
+            continue;
+
+        if (sample.timestamp < oldest)
+            break;
+
+        /* Insert the sample's path */
+        nodes[0].sample_count++;
+
+        uint32_t parent = 0;
+        for (uint32_t frame = sample.frame_count; frame > 0 && frame <= PLCRASH_SAMPLING_PROFILER_MAX_FRAMES; frame--) {
+            uint32_t child = plcrash_sampling_profiler_child(nodes, max_nodes, &node_count, parent, sample.pcs[frame - 1]);
+            if (child == 0)
+                break;
+
+            nodes[child].sample_count++;
+            parent = child;
+        }
+    }
+
+    return node_count;
+}
+
+/**
+ * @} plcrash_sampling_profiler
+ */
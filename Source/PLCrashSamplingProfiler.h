@@ -0,0 +1,223 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_SAMPLING_PROFILER_H
+#define PLCRASH_SAMPLING_PROFILER_H
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <mach/mach.h>
+#include <mach/mach_time.h>
+
+#include "PLCrashAsync.h"
+#include "PLCrashAsyncImageList.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal
+ * @defgroup plcrash_sampling_profiler Sampling Profiler
+ * @ingroup plcrash_internal
+ *
+ * Implements a low-overhead sampling profiler. A dedicated thread periodically suspends a target thread, walks its
+ * stack using only the compact unwind and frame pointer readers, and records the raw PC values in a fixed-size ring
+ * buffer. The recorded samples may be aggregated into a call tree, either on demand or from a crash handler.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ * The maximum number of frames recorded per sample. Deeper stacks are truncated, retaining the innermost frames.
+ */
+#define PLCRASH_SAMPLING_PROFILER_MAX_FRAMES 64
+
+/**
+ * @internal
+ * The divisor applied to a sampling budget while the device is under thermal pressure or in low power mode.
+ */
+#define PLCRASH_SAMPLING_BUDGET_CONSTRAINED_DIVISOR 4
+
+/**
+ * @internal
+ *
+ * Adaptive sampling rate controller. Tracks the measured cost of each sample, and derives the sampling interval
+ * required to keep the sampler's CPU usage within a fixed fraction of a single core.
+ */
+typedef struct plcrash_sampling_budget {
+    /** The permitted CPU usage, in parts per million of a single core, or 0 to sample at the minimum interval. */
+    uint32_t budget_ppm;
+
+    /** The minimum interval between samples, in microseconds. */
+    uint32_t min_interval_usec;
+
+    /** The maximum interval between samples, in microseconds. */
+    uint32_t max_interval_usec;
+
+    /** If true, the device is under thermal pressure or in low power mode, and the budget is reduced by
+     * PLCRASH_SAMPLING_BUDGET_CONSTRAINED_DIVISOR. */
+    bool constrained;
+
+    /** Moving average of the per-sample cost, in nanoseconds, or 0 if no sample has been recorded. */
+    uint64_t average_cost_nsec;
+
+    /** The current interval between samples, in microseconds. */
+    uint32_t interval_usec;
+} plcrash_sampling_budget_t;
+
+/**
+ * @internal
+ *
+ * Polls the system thermal pressure level.
+ */
+typedef struct plcrash_sampling_thermal_monitor {
+    /** The notify(3) token of the thermal pressure level. */
+    int token;
+
+    /** If false, registration failed, and the pressure level is always reported as nominal. */
+    bool registered;
+} plcrash_sampling_thermal_monitor_t;
+
+void plcrash_sampling_budget_init (plcrash_sampling_budget_t *budget, uint32_t budget_ppm, uint32_t min_interval_usec, uint32_t max_interval_usec);
+uint32_t plcrash_sampling_budget_record (plcrash_sampling_budget_t *budget, uint64_t cost_nsec);
+void plcrash_sampling_budget_set_constrained (plcrash_sampling_budget_t *budget, bool constrained);
+
+void plcrash_sampling_thermal_monitor_init (plcrash_sampling_thermal_monitor_t *monitor);
+bool plcrash_sampling_thermal_monitor_pressured (plcrash_sampling_thermal_monitor_t *monitor);
+void plcrash_sampling_thermal_monitor_free (plcrash_sampling_thermal_monitor_t *monitor);
+
+/**
+ * @internal
+ *
+ * A single recorded stack sample.
+ */
+typedef struct plcrash_sampling_profiler_sample {
+    /** Sequence counter; odd while the sample is being written. Used by readers to detect torn reads. */
+    volatile uint32_t sequence;
+
+    /** The time at which the sample was taken, in mach_absolute_time() units. */
+    uint64_t timestamp;
+
+    /** The number of valid entries in @a pcs. */
+    uint32_t frame_count;
+
+    /** The sampled PC values, ordered from the innermost frame outward. */
+    pl_vm_address_t pcs[PLCRASH_SAMPLING_PROFILER_MAX_FRAMES];
+} plcrash_sampling_profiler_sample_t;
+
+/**
+ * @internal
+ *
+ * A call tree node, as produced by plcrash_sampling_profiler_call_tree().
+ */
+typedef struct plcrash_sampling_profiler_node {
+    /** The node's PC value. Unused for the root node. */
+    pl_vm_address_t pc;
+
+    /** The number of samples that include this node's call path. */
+    uint32_t sample_count;
+
+    /** The index of the node's first child, or 0 if none. */
+    uint32_t first_child;
+
+    /** The index of the node's next sibling, or 0 if none. */
+    uint32_t next_sibling;
+} plcrash_sampling_profiler_node_t;
+
+/**
+ * @internal
+ *
+ * Sampling profiler state.
+ */
+typedef struct plcrash_sampling_profiler {
+    /** The task containing the target thread. */
+    task_t task;
+
+    /** The thread to be sampled. */
+    thread_t thread;
+
+    /** The task's image list. This is a borrowed reference, and must remain valid for the lifetime of the profiler. */
+    plcrash_async_image_list_t *image_list;
+
+    /** The minimum interval between samples, in microseconds. */
+    uint32_t interval_usec;
+
+    /** The sampling rate controller. Only accessed by the sampling thread once started. */
+    plcrash_sampling_budget_t budget;
+
+    /** Set by the profiler's owner while the device is in low power mode. */
+    volatile bool low_power;
+
+    /** Timebase used to convert mach_absolute_time() values. */
+    mach_timebase_info_data_t timebase;
+
+    /** The number of entries in @a samples. */
+    uint32_t capacity;
+
+    /** The sample ring buffer. */
+    plcrash_sampling_profiler_sample_t *samples;
+
+    /** The total number of samples written. The most recent sample is at (sample_count - 1) % capacity. */
+    volatile int64_t sample_count;
+
+    /** The sampling thread. */
+    pthread_t sampler;
+
+    /** If true, the sampling thread is running. */
+    bool running;
+
+    /** Set to request that the sampling thread exit. */
+    volatile bool stop;
+} plcrash_sampling_profiler_t;
+
+plcrash_error_t plcrash_sampling_profiler_init (plcrash_sampling_profiler_t *profiler, task_t task, thread_t thread,
+                                                plcrash_async_image_list_t *image_list, uint32_t interval_usec,
+                                                uint32_t capacity);
+void plcrash_sampling_profiler_set_budget (plcrash_sampling_profiler_t *profiler, uint32_t budget_ppm, uint32_t max_interval_usec);
+void plcrash_sampling_profiler_set_low_power (plcrash_sampling_profiler_t *profiler, bool low_power);
+plcrash_error_t plcrash_sampling_profiler_start (plcrash_sampling_profiler_t *profiler);
+void plcrash_sampling_profiler_stop (plcrash_sampling_profiler_t *profiler);
+void plcrash_sampling_profiler_free (plcrash_sampling_profiler_t *profiler);
+
+plcrash_error_t plcrash_sampling_profiler_sample (plcrash_sampling_profiler_t *profiler);
+
+size_t plcrash_sampling_profiler_call_tree (plcrash_sampling_profiler_t *profiler, uint64_t window_nsec,
+                                            plcrash_sampling_profiler_node_t *nodes, size_t max_nodes);
+
+/**
+ * @} plcrash_sampling_profiler
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_SAMPLING_PROFILER_H */
@@ -0,0 +1,135 @@
+/*
+ * Author: Landon Fuller <landonf@plausiblelabs.com>
+ *
+ * Copyright (c) 2008-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+
+#import "PLCrashSamplingProfiler.h"
+#import "PLCrashTestThread.h"
+
+#import <mach-o/dyld.h>
+
+@interface PLCrashSamplingProfilerTests : SenTestCase {
+@private
+    plcrash_test_thread_t _thr_args;
+    plcrash_async_image_list_t _image_list;
+    plcrash_sampling_profiler_t _profiler;
+}
+@end
+
+@implementation PLCrashSamplingProfilerTests
+
+- (void) setUp {
+    plcrash_test_thread_spawn(&_thr_args);
+
+    plcrash_nasync_image_list_init(&_image_list, mach_task_self());
+    for (uint32_t i = 0; i < _dyld_image_count(); i++)
+        plcrash_nasync_image_list_append(&_image_list, (pl_vm_address_t) _dyld_get_image_header(i), _dyld_get_image_name(i));
+
+    plcrash_error_t err = plcrash_sampling_profiler_init(&_profiler, mach_task_self(), pthread_mach_thread_np(_thr_args.thread), &_image_list, 1000, 16);
+    STAssertEquals(PLCRASH_ESUCCESS, err, @"Failed to initialize the profiler");
+}
+
+- (void) tearDown {
+    plcrash_sampling_profiler_free(&_profiler);
+    plcrash_nasync_image_list_free(&_image_list);
+    plcrash_test_thread_stop(&_thr_args);
+}
+
+/**
+ * Verify that identical samples are merged into a single call path.
+ */
+- (void) testCallTree {
+    plcrash_sampling_profiler_node_t nodes[PLCRASH_SAMPLING_PROFILER_MAX_FRAMES * 4];
+
+    /* The test thread is blocked, so every sample should be identical */
+    for (int i = 0; i < 3; i++)
+        STAssertEquals(PLCRASH_ESUCCESS, plcrash_sampling_profiler_sample(&_profiler), @"Failed to sample the thread");
+
+    size_t count = plcrash_sampling_profiler_call_tree(&_profiler, NSEC_PER_SEC * 60, nodes, sizeof(nodes) / sizeof(nodes[0]));
+    STAssertTrue(count > 1, @"No frames were recorded");
+    STAssertEquals(nodes[0].sample_count, (uint32_t) 3, @"Incorrect root sample count");
+
+    /* Verify that the samples were deduplicated into a single path */
+    for (size_t i = 1; i < count; i++) {
+        STAssertEquals(nodes[i].sample_count, (uint32_t) 3, @"Samples were not merged");
+        STAssertEquals(nodes[i].next_sibling, (uint32_t) 0, @"Samples produced multiple paths");
+    }
+}
+
+/**
+ * Verify that the ring buffer retains only the most recent samples, and that the sampling thread records samples.
+ */
+- (void) testSamplingThread {
+    plcrash_sampling_profiler_node_t nodes[PLCRASH_SAMPLING_PROFILER_MAX_FRAMES * 4];
+
+    STAssertEquals(PLCRASH_ESUCCESS, plcrash_sampling_profiler_start(&_profiler), @"Failed to start the profiler");
+    usleep(100 * 1000);
+    plcrash_sampling_profiler_stop(&_profiler);
+
+    STAssertTrue(_profiler.sample_count > 0, @"No samples were recorded");
+
+    size_t count = plcrash_sampling_profiler_call_tree(&_profiler, NSEC_PER_SEC * 60, nodes, sizeof(nodes) / sizeof(nodes[0]));
+    STAssertTrue(count > 1, @"No frames were recorded");
+    STAssertTrue(nodes[0].sample_count <= _profiler.capacity, @"Aggregated more samples than the ring buffer holds");
+
+    /* An empty window should include no samples */
+    count = plcrash_sampling_profiler_call_tree(&_profiler, 0, nodes, sizeof(nodes) / sizeof(nodes[0]));
+    STAssertEquals(count, (size_t) 1, @"Samples outside of the window were included");
+}
+
+/**
+ * Verify that the sampling interval tracks the measured sample cost, within the configured bounds.
+ */
+- (void) testBudget {
+    plcrash_sampling_budget_t budget;
+
+    /* A 50µs sample at 0.5% of a core permits one sample every 10ms */
+    plcrash_sampling_budget_init(&budget, 5000, 1000, 100000);
+    STAssertEquals(plcrash_sampling_budget_record(&budget, 50000), (uint32_t) 10000, @"Incorrect interval");
+
+    /* Constraint reduces the budget */
+    plcrash_sampling_budget_set_constrained(&budget, true);
+    STAssertEquals(budget.interval_usec, (uint32_t) (10000 * PLCRASH_SAMPLING_BUDGET_CONSTRAINED_DIVISOR), @"Constraint was not applied");
+    plcrash_sampling_budget_set_constrained(&budget, false);
+    STAssertEquals(budget.interval_usec, (uint32_t) 10000, @"Constraint was not removed");
+
+    /* The interval is clamped to its bounds */
+    for (int i = 0; i < 64; i++)
+        plcrash_sampling_budget_record(&budget, 1);
+    STAssertEquals(budget.interval_usec, (uint32_t) 1000, @"Interval was not clamped to the minimum");
+
+    for (int i = 0; i < 64; i++)
+        plcrash_sampling_budget_record(&budget, NSEC_PER_SEC);
+    STAssertEquals(budget.interval_usec, (uint32_t) 100000, @"Interval was not clamped to the maximum");
+
+    /* Without a budget, the interval is fixed */
+    plcrash_sampling_budget_init(&budget, 0, 1000, 100000);
+    STAssertEquals(plcrash_sampling_budget_record(&budget, NSEC_PER_SEC), (uint32_t) 1000, @"Unbudgeted interval was adjusted");
+}
+
+@end
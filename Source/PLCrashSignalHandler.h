@@ -68,6 +68,10 @@ bool PLCrashSignalHandlerForward (PLCrashSignalHandlerCallback *next, int signal
                           context: (void *) context
                             error: (NSError **) outError;
 
+- (BOOL) enableThreadSignalStacks: (NSUInteger) stackCount error: (NSError **) outError;
+
+- (BOOL) wireSignalStacks: (size_t *) wiredSize error: (NSError **) outError;
+
 @end
 
 PLCR_C_END_DECLS
@@ -36,6 +36,10 @@
 
 #import <signal.h>
 #import <unistd.h>
+#import <dlfcn.h>
+#import <pthread.h>
+#import <sys/mman.h>
+#import <libkern/OSAtomic.h>
 
 using namespace plcrash::async;
 
@@ -99,6 +103,130 @@ static struct {
     async_list<plcrash_signal_handler_action> previous_actions;
 } shared_handler_context;
 
+/**
+ * @internal
+ *
+ * The size of each alternate signal stack. Only 64k is reserved, and the crash dump path must be sparing in its use
+ * of stack space.
+ */
+#define PLCRASH_SIGNAL_STACK_SIZE MAX(MINSIGSTKSZ, 64 * 1024)
+
+/*
+ * The pthread introspection API (pthread/introspection.h) is only available on Mac OS X 10.9 and iOS 7.0 and later,
+ * and is resolved at runtime.
+ */
+
+/** Introspection event issued on a new thread prior to executing its start routine. */
+#define PL_PTHREAD_INTROSPECTION_THREAD_START 2
+
+/** Introspection event issued on a terminating thread, after its TSD destructors have run. */
+#define PL_PTHREAD_INTROSPECTION_THREAD_TERMINATE 3
+
+/** A pthread introspection hook. */
+typedef void (*pl_pthread_introspection_hook_t) (unsigned int event, pthread_t thread, void *addr, size_t size);
+
+/**
+ * @internal
+ *
+ * Pre-allocated pool of alternate signal stacks, armed on each new thread via a pthread introspection hook. Each
+ * stack is preceded by an inaccessible guard page.
+ */
+static struct {
+    /** The base address of the pool's mapping, or NULL if the pool has not been enabled. */
+    uint8_t *base;
+
+    /** The size of each pool slot, including its guard page. */
+    size_t stride;
+
+    /** The size of the guard page preceding each stack. */
+    size_t guard_size;
+
+    /** The number of slots in the pool. */
+    uint32_t count;
+
+    /** Slot allocation bitmap, as manipulated by OSAtomicTestAndSet(). */
+    volatile uint8_t *slots;
+
+    /** The previously installed introspection hook, or NULL. */
+    pl_pthread_introspection_hook_t previous_hook;
+} thread_stack_pool;
+
+/**
+ * @internal
+ *
+ * Claim a stack from the thread stack pool, and register it as the calling thread's alternate signal stack. No
+ * changes are made if the thread already has an alternate signal stack, or if the pool is exhausted.
+ */
+static void thread_stack_pool_arm (void) {
+    stack_t current;
+    if (sigaltstack(NULL, &current) != 0 || !(current.ss_flags & SS_DISABLE))
+        return;
+
+    for (uint32_t i = 0; i < thread_stack_pool.count; i++) {
+        if (OSAtomicTestAndSetBarrier(i, thread_stack_pool.slots))
+            continue;
+
+        stack_t stk;
+        stk.ss_sp = thread_stack_pool.base + (i * thread_stack_pool.stride) + thread_stack_pool.guard_size;
+        stk.ss_size = thread_stack_pool.stride - thread_stack_pool.guard_size;
+        stk.ss_flags = 0;
+
+        if (sigaltstack(&stk, NULL) != 0) {
+            PLCF_DEBUG("Could not register a pooled signal stack: %d", errno);
+            OSAtomicTestAndClearBarrier(i, thread_stack_pool.slots);
+        }
+
+        return;
+    }
+
+    PLCF_DEBUG("Signal stack pool exhausted; thread stack overflows will not be reported");
+}
+
+/**
+ * @internal
+ *
+ * If the calling thread's alternate signal stack was claimed from the thread stack pool, disable it and return
+ * the stack to the pool.
+ */
+static void thread_stack_pool_disarm (void) {
+    stack_t current;
+    if (sigaltstack(NULL, &current) != 0 || (current.ss_flags & SS_DISABLE))
+        return;
+
+    uint8_t *sp = (uint8_t *) current.ss_sp;
+    if (sp < thread_stack_pool.base || sp >= thread_stack_pool.base + (thread_stack_pool.count * thread_stack_pool.stride))
+        return;
+
+    /* The stack can not be released while in use */
+    if (current.ss_flags & SS_ONSTACK)
+        return;
+
+    stack_t disable;
+    memset(&disable, 0, sizeof(disable));
+    disable.ss_flags = SS_DISABLE;
+    if (sigaltstack(&disable, NULL) != 0)
+        return;
+
+    uint32_t slot = (uint32_t) ((sp - thread_stack_pool.base) / thread_stack_pool.stride);
+    OSAtomicTestAndClearBarrier(slot, thread_stack_pool.slots);
+}
+
+/**
+ * @internal
+ *
+ * pthread introspection hook; arms and disarms pooled signal stacks as threads start and terminate.
+ */
+static void thread_stack_pool_hook (unsigned int event, pthread_t thread, void *addr, size_t size) {
+    if (event == PL_PTHREAD_INTROSPECTION_THREAD_START) {
+        thread_stack_pool_arm();
+    } else if (event == PL_PTHREAD_INTROSPECTION_THREAD_TERMINATE) {
+        thread_stack_pool_disarm();
+    }
+
+    if (thread_stack_pool.previous_hook != NULL)
+        thread_stack_pool.previous_hook(event, thread, addr, size);
+}
+
 /*
  * Finds and executes the first matching signal handler in the shared previous_actions list; this is used
  * to support executing process-wide POSIX signal handlers that were previously registered before being replaced by
@@ -287,7 +415,7 @@ static PLCrashSignalHandler *sharedHandler;
     
     /* Set up an alternate signal stack for crash dumps. Only 64k is reserved, and the
      * crash dump path must be sparing in its use of stack space. */
-    _sigstk.ss_size = MAX(MINSIGSTKSZ, 64 * 1024);
+    _sigstk.ss_size = PLCRASH_SIGNAL_STACK_SIZE;
     _sigstk.ss_sp = malloc(_sigstk.ss_size);
     _sigstk.ss_flags = 0;
 
@@ -392,6 +520,136 @@ static PLCrashSignalHandler *sharedHandler;
     return YES;
 }
 
+/**
+ * Enable pre-allocated alternate signal stacks for all threads subsequently created via pthread_create(). By default,
+ * only the thread on which the signal handlers are first registered is provided with an alternate signal stack,
+ * and stack overflows on any other thread can not be reported.
+ *
+ * All @a stackCount stacks are allocated immediately, each with a leading guard page. As threads start, each is
+ * assigned a stack from the pool; the stack is returned to the pool when the thread terminates. Threads started
+ * once the pool is exhausted are not provided with an alternate signal stack. Threads that were running prior to
+ * this call are not affected.
+ *
+ * @param stackCount The number of stacks to be allocated. Must be greater than 0.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the signal stacks could not be enabled. If no error occurs, this parameter will be left
+ * unmodified. You may specify NULL for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES on success, or NO if the pool could not be allocated, or the pthread introspection API is not
+ * available on the current OS release. If thread signal stacks have already been enabled, no changes will be made,
+ * and YES will be returned.
+ */
+- (BOOL) enableThreadSignalStacks: (NSUInteger) stackCount error: (NSError **) outError {
+    static pthread_mutex_t enableLock = PTHREAD_MUTEX_INITIALIZER;
+    BOOL result = NO;
+
+    if (stackCount == 0 || stackCount > UINT32_MAX) {
+        plcrash_populate_posix_error(outError, EINVAL, @"Invalid signal stack count");
+        return NO;
+    }
+
+    pthread_mutex_lock(&enableLock); {
+        pl_pthread_introspection_hook_t (*hook_install)(pl_pthread_introspection_hook_t);
+        size_t page_size = getpagesize();
+        size_t region_size;
+        void *region;
+
+        /* Already enabled */
+        if (thread_stack_pool.base != NULL) {
+            result = YES;
+            goto cleanup;
+        }
+
+        /* Resolve the introspection API */
+        hook_install = (pl_pthread_introspection_hook_t (*)(pl_pthread_introspection_hook_t)) dlsym(RTLD_DEFAULT, "pthread_introspection_hook_install");
+        if (hook_install == NULL) {
+            plcrash_populate_posix_error(outError, ENOTSUP, @"Thread signal stacks are not supported on this OS release");
+            goto cleanup;
+        }
+
+        /* Map the pool */
+        thread_stack_pool.guard_size = page_size;
+        thread_stack_pool.stride = round_page(PLCRASH_SIGNAL_STACK_SIZE) + page_size;
+        region_size = thread_stack_pool.stride * stackCount;
+
+        region = mmap(NULL, region_size, PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE, -1, 0);
+        if (region == MAP_FAILED) {
+            plcrash_populate_posix_error(outError, errno, @"Could not allocate the signal stack pool");
+            goto cleanup;
+        }
+
+        for (NSUInteger i = 0; i < stackCount; i++) {
+            if (mprotect((uint8_t *) region + (i * thread_stack_pool.stride), page_size, PROT_NONE) != 0)
+                PLCF_DEBUG("Could not protect signal stack guard page: %d", errno);
+        }
+
+        thread_stack_pool.slots = (volatile uint8_t *) calloc((stackCount + 7) / 8, 1);
+        if (thread_stack_pool.slots == NULL) {
+            plcrash_populate_posix_error(outError, ENOMEM, @"Could not allocate the signal stack pool");
+            munmap(region, region_size);
+            goto cleanup;
+        }
+
+        thread_stack_pool.count = (uint32_t) stackCount;
+        thread_stack_pool.base = (uint8_t *) region;
+
+        /* Ensure that the pool is visible prior to the hook's installation */
+        OSMemoryBarrier();
+
+        thread_stack_pool.previous_hook = hook_install(&thread_stack_pool_hook);
+        result = YES;
+
+cleanup:
+        ;
+    } pthread_mutex_unlock(&enableLock);
+
+    return result;
+}
+
+/**
+ * Pre-fault and wire the receiver's alternate signal stack, along with the thread signal stack pool if
+ * enabled via -enableThreadSignalStacks:error:, such that a crash handler running on these stacks does not incur
+ * page-fault or decompression latency. The pool's guard pages are not wired.
+ *
+ * @param wiredSize On return, the number of bytes wired. May be NULL.
+ * @param outError A pointer to an NSError object variable. If an error occurs, this pointer will contain an error
+ * object indicating why the stacks could not be wired. If no error occurs, this parameter will be left
+ * unmodified. You may specify NULL for this parameter, and no error information will be provided.
+ *
+ * @return Returns YES if all stacks were wired, or NO if wiring failed (eg, due to RLIMIT_MEMLOCK). Stacks that
+ * could not be wired will still have been faulted in.
+ */
+- (BOOL) wireSignalStacks: (size_t *) wiredSize error: (NSError **) outError {
+    size_t wired = 0;
+    BOOL result = YES;
+
+    if (plcrash_nasync_mem_wire(_sigstk.ss_sp, _sigstk.ss_size) == PLCRASH_ESUCCESS)
+        wired += _sigstk.ss_size;
+    else
+        result = NO;
+
+    /* The pool is immutable once published */
+    OSMemoryBarrier();
+    if (thread_stack_pool.base != NULL) {
+        size_t stack_size = thread_stack_pool.stride - thread_stack_pool.guard_size;
+        for (uint32_t i = 0; i < thread_stack_pool.count; i++) {
+            uint8_t *stack = thread_stack_pool.base + (i * thread_stack_pool.stride) + thread_stack_pool.guard_size;
+            if (plcrash_nasync_mem_wire(stack, stack_size) == PLCRASH_ESUCCESS)
+                wired += stack_size;
+            else
+                result = NO;
+        }
+    }
+
+    if (!result)
+        plcrash_populate_posix_error(outError, ENOMEM, @"Could not wire the alternate signal stacks");
+
+    if (wiredSize != NULL)
+        *wiredSize = wired;
+
+    return result;
+}
+
 /**
  * Register a new signal @a callback for @a signo.
  *
@@ -32,6 +32,7 @@
 #import "PLCrashProcessInfo.h"
 
 #import <sys/mman.h>
+#import <pthread.h>
 
 @interface PLCrashSignalHandlerTests : SenTestCase {
 }
@@ -147,4 +148,37 @@ static void sa_handler_cb (int signo) {
 }
 
 
+static void *signal_stack_thread (void *arg) {
+    stack_t *result = (stack_t *) arg;
+    sigaltstack(NULL, result);
+    return NULL;
+}
+
+/**
+ * Test that enabling thread signal stacks provides an alternate signal stack to new threads, and that stacks are
+ * returned to the pool on thread termination.
+ */
+- (void) testThreadSignalStacks {
+    NSError *error;
+
+    if (![[PLCrashSignalHandler sharedHandler] enableThreadSignalStacks: 2 error: &error]) {
+        /* Not supported on this OS release */
+        STAssertEquals((int) [error code], ENOTSUP, @"Failed to enable thread signal stacks: %@", error);
+        return;
+    }
+
+    /* Start more threads than there are stacks; each must be assigned a stack that was released by its predecessor */
+    for (int i = 0; i < 4; i++) {
+        stack_t stk;
+        pthread_t thr;
+
+        memset(&stk, 0, sizeof(stk));
+        STAssertEquals(0, pthread_create(&thr, NULL, signal_stack_thread, &stk), @"Failed to create thread");
+        pthread_join(thr, NULL);
+
+        STAssertFalse(stk.ss_flags & SS_DISABLE, @"No alternate signal stack was assigned to thread %d", i);
+        STAssertTrue(stk.ss_size >= MINSIGSTKSZ, @"Signal stack too small");
+    }
+}
+
 @end
@@ -0,0 +1,251 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashSymbolDemangler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_symbol_demangler
+ * @{
+ */
+
+/* Mangled symbol prefixes, with and without the Mach-O C symbol prefix */
+static const char *cxx_prefixes[] = { "_Z", "__Z" };
+static const char *swift_prefixes[] = { "$s", "$S", "$e", "_T0", "_$s", "_$S", "_$e", "__T0" };
+
+/*
+ * Return true if @a symbol begins with any of the @a count @a prefixes.
+ */
+static bool has_prefix (const char *symbol, const char **prefixes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (strncmp(symbol, prefixes[i], strlen(prefixes[i])) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+/*
+ * FNV-1a hash of @a symbol.
+ */
+static uint64_t symbol_hash (const char *symbol) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char *p = symbol; *p != '\0'; p++) {
+        hash ^= (uint8_t) *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+ * Demangle @a symbol, returning a malloc-allocated result, or NULL if the symbol could not be demangled.
+ */
+static char *demangle_symbol (plcrash_demangle_cache_t *cache, const char *symbol) {
+    if (has_prefix(symbol, cxx_prefixes, sizeof(cxx_prefixes) / sizeof(cxx_prefixes[0]))) {
+        if (cache->cxa_demangle == NULL)
+            return NULL;
+
+        /* The C++ ABI demangler does not accept the Mach-O symbol prefix */
+        const char *name = (symbol[1] == '_') ? symbol + 1 : symbol;
+        int status;
+        char *result = cache->cxa_demangle(name, NULL, NULL, &status);
+        if (status != 0) {
+            free(result);
+            return NULL;
+        }
+        return result;
+    }
+
+    if (cache->swift_demangle == NULL)
+        return NULL;
+
+    const char *name = (symbol[0] == '_' && symbol[1] == '$') ? symbol + 1 : symbol;
+    return cache->swift_demangle(name, strlen(name), NULL, NULL, 0);
+}
+
+/*
+ * Return a malloc-allocated copy of @a string, or NULL if @a string is NULL or the allocation fails.
+ */
+static char *copy_string (const char *string) {
+    if (string == NULL)
+        return NULL;
+
+    return strdup(string);
+}
+
+/**
+ * Initialize a demangle cache.
+ *
+ * @param cache The cache to initialize.
+ * @param capacity The maximum number of entries to retain. This will be rounded up to a multiple of
+ * PLCRASH_DEMANGLE_CACHE_WAYS.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the cache could not be allocated.
+ */
+plcrash_error_t plcrash_demangle_cache_init (plcrash_demangle_cache_t *cache, size_t capacity) {
+    memset(cache, 0, sizeof(*cache));
+
+    cache->set_count = (capacity + PLCRASH_DEMANGLE_CACHE_WAYS - 1) / PLCRASH_DEMANGLE_CACHE_WAYS;
+    if (cache->set_count == 0)
+        cache->set_count = 1;
+
+    cache->entries = calloc(cache->set_count * PLCRASH_DEMANGLE_CACHE_WAYS, sizeof(plcrash_demangle_cache_entry_t));
+    if (cache->entries == NULL)
+        return PLCRASH_ENOMEM;
+
+    cache->cxa_demangle = (plcrash_cxa_demangle_fn) dlsym(RTLD_DEFAULT, "__cxa_demangle");
+    cache->swift_demangle = (plcrash_swift_demangle_fn) dlsym(RTLD_DEFAULT, "swift_demangle");
+    pthread_mutex_init(&cache->lock, NULL);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Free all resources associated with @a cache.
+ */
+void plcrash_demangle_cache_free (plcrash_demangle_cache_t *cache) {
+    for (size_t i = 0; i < cache->set_count * PLCRASH_DEMANGLE_CACHE_WAYS; i++) {
+        free(cache->entries[i].symbol);
+        free(cache->entries[i].demangled);
+    }
+
+    free(cache->entries);
+    pthread_mutex_destroy(&cache->lock);
+}
+
+static pthread_once_t shared_cache_once = PTHREAD_ONCE_INIT;
+static plcrash_demangle_cache_t shared_cache;
+static bool shared_cache_valid = false;
+
+static void shared_cache_init (void) {
+    shared_cache_valid = (plcrash_demangle_cache_init(&shared_cache, PLCRASH_DEMANGLE_CACHE_DEFAULT_CAPACITY) == PLCRASH_ESUCCESS);
+}
+
+/**
+ * Return the process-wide demangle cache, or NULL if the cache could not be allocated. The cache is never freed.
+ */
+plcrash_demangle_cache_t *plcrash_demangle_cache_shared (void) {
+    pthread_once(&shared_cache_once, shared_cache_init);
+    return shared_cache_valid ? &shared_cache : NULL;
+}
+
+/**
+ * Return true if @a symbol appears to be a mangled C++ or Swift symbol name. This is a cheap prefix check, and
+ * may be used to avoid a cache lookup for the common case of an unmangled C or Objective-C symbol.
+ */
+bool plcrash_demangle_is_mangled (const char *symbol) {
+    return has_prefix(symbol, cxx_prefixes, sizeof(cxx_prefixes) / sizeof(cxx_prefixes[0])) ||
+           has_prefix(symbol, swift_prefixes, sizeof(swift_prefixes) / sizeof(swift_prefixes[0]));
+}
+
+/**
+ * Demangle @a symbol, returning a malloc-allocated copy of the demangled name; the caller is responsible for
+ * freeing the result. The result of demangling each unique symbol is memoized, including failures, and so the
+ * cost of demangling is paid once per unique symbol while it remains cached.
+ *
+ * @param cache The cache to use.
+ * @param symbol The (possibly) mangled symbol name. The symbol may include the Mach-O '_' C symbol prefix.
+ *
+ * @return Returns the demangled name, or NULL if @a symbol is not mangled, could not be demangled, or an
+ * allocation failed.
+ */
+char *plcrash_demangle_cache_copy (plcrash_demangle_cache_t *cache, const char *symbol) {
+    if (!plcrash_demangle_is_mangled(symbol))
+        return NULL;
+
+    uint64_t hash = symbol_hash(symbol);
+    plcrash_demangle_cache_entry_t *set = &cache->entries[(hash % cache->set_count) * PLCRASH_DEMANGLE_CACHE_WAYS];
+    char *result = NULL;
+
+    /* Look up the symbol */
+    pthread_mutex_lock(&cache->lock);
+    for (size_t i = 0; i < PLCRASH_DEMANGLE_CACHE_WAYS; i++) {
+        plcrash_demangle_cache_entry_t *entry = &set[i];
+        if (entry->symbol != NULL && entry->hash == hash && strcmp(entry->symbol, symbol) == 0) {
+            entry->last_used = ++cache->clock;
+            cache->hits++;
+
+            result = copy_string(entry->demangled);
+            pthread_mutex_unlock(&cache->lock);
+            return result;
+        }
+    }
+    cache->misses++;
+    pthread_mutex_unlock(&cache->lock);
+
+    /* Demangle without the lock held; concurrent misses on the same symbol may demangle it redundantly, but
+     * will produce the same result. */
+    char *demangled = demangle_symbol(cache, symbol);
+    char *key = strdup(symbol);
+    result = copy_string(demangled);
+
+    if (key == NULL) {
+        free(demangled);
+        return result;
+    }
+
+    /* Insert the result, replacing the least recently used entry of the set, unless another thread has
+     * inserted the symbol in the interim */
+    pthread_mutex_lock(&cache->lock);
+    plcrash_demangle_cache_entry_t *victim = &set[0];
+    for (size_t i = 0; i < PLCRASH_DEMANGLE_CACHE_WAYS; i++) {
+        plcrash_demangle_cache_entry_t *entry = &set[i];
+        if (entry->symbol != NULL && entry->hash == hash && strcmp(entry->symbol, symbol) == 0) {
+            victim = NULL;
+            break;
+        }
+
+        if (entry->symbol == NULL || (victim->symbol != NULL && entry->last_used < victim->last_used))
+            victim = entry;
+    }
+
+    if (victim != NULL) {
+        free(victim->symbol);
+        free(victim->demangled);
+
+        victim->hash = hash;
+        victim->symbol = key;
+        victim->demangled = demangled;
+        victim->last_used = ++cache->clock;
+        key = NULL;
+        demangled = NULL;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    free(key);
+    free(demangled);
+    return result;
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,145 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_SYMBOL_DEMANGLER_H
+#define PLCRASH_SYMBOL_DEMANGLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "PLCrashAsync.h"
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_symbol_demangler Symbol Demangling
+ *
+ * Demangles C++ and Swift symbol names for report formatting, memoizing the results in a bounded cache.
+ *
+ * The demanglers are resolved from the current process at runtime, and are not required to be present; C++
+ * demangling requires the C++ ABI runtime, and Swift demangling requires the Swift runtime to be loaded.
+ *
+ * These functions are not async-safe, and must not be called at crash time.
+ *
+ * @{
+ */
+
+/**
+ * @internal
+ *
+ * The default number of entries retained by a demangle cache.
+ */
+#define PLCRASH_DEMANGLE_CACHE_DEFAULT_CAPACITY 8192
+
+/** C++ ABI demangler, as per abi::__cxa_demangle() */
+typedef char *(*plcrash_cxa_demangle_fn) (const char *mangled, char *buffer, size_t *length, int *status);
+
+/** Swift runtime demangler, as per swift_demangle() */
+typedef char *(*plcrash_swift_demangle_fn) (const char *mangled, size_t mangled_length, char *buffer, size_t *length, uint32_t flags);
+
+/**
+ * @internal
+ *
+ * A single demangle cache entry.
+ */
+typedef struct plcrash_demangle_cache_entry {
+    /** The hash of @a symbol. */
+    uint64_t hash;
+
+    /** The mangled symbol, or NULL if the entry is unused. */
+    char *symbol;
+
+    /** The demangled symbol, or NULL if @a symbol could not be demangled. */
+    char *demangled;
+
+    /** The cache clock value at which the entry was last used. */
+    uint64_t last_used;
+} plcrash_demangle_cache_entry_t;
+
+/**
+ * @internal
+ *
+ * A bounded, thread-safe cache of demangled symbol names, keyed by the hash of the mangled name.
+ *
+ * The cache is set associative; each hash maps to a single set of PLCRASH_DEMANGLE_CACHE_WAYS entries, and the
+ * least recently used entry of the set is replaced on insertion.
+ */
+typedef struct plcrash_demangle_cache {
+    /** Lock protecting all cache state. Demangling is performed without the lock held. */
+    pthread_mutex_t lock;
+
+    /** The cache entries, grouped by set. */
+    plcrash_demangle_cache_entry_t *entries;
+
+    /** The number of sets in @a entries. */
+    size_t set_count;
+
+    /** Monotonic use counter. */
+    uint64_t clock;
+
+    /** Cache statistics. */
+    uint64_t hits;
+    uint64_t misses;
+
+    /** The C++ demangler, or NULL if unavailable. */
+    plcrash_cxa_demangle_fn cxa_demangle;
+
+    /** The Swift demangler, or NULL if unavailable. */
+    plcrash_swift_demangle_fn swift_demangle;
+} plcrash_demangle_cache_t;
+
+/**
+ * @internal
+ *
+ * The number of entries in each demangle cache set.
+ */
+#define PLCRASH_DEMANGLE_CACHE_WAYS 4
+
+plcrash_error_t plcrash_demangle_cache_init (plcrash_demangle_cache_t *cache, size_t capacity);
+void plcrash_demangle_cache_free (plcrash_demangle_cache_t *cache);
+
+plcrash_demangle_cache_t *plcrash_demangle_cache_shared (void);
+
+bool plcrash_demangle_is_mangled (const char *symbol);
+char *plcrash_demangle_cache_copy (plcrash_demangle_cache_t *cache, const char *symbol);
+
+/**
+ * @} plcrash_symbol_demangler
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_SYMBOL_DEMANGLER_H */
@@ -0,0 +1,104 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#import "GTMSenTestCase.h"
+#import "PLCrashSymbolDemangler.h"
+
+@interface PLCrashSymbolDemanglerTests : SenTestCase {
+@private
+    plcrash_demangle_cache_t _cache;
+}
+
+@end
+
+@implementation PLCrashSymbolDemanglerTests
+
+- (void) setUp {
+    STAssertEquals(plcrash_demangle_cache_init(&_cache, 8), PLCRASH_ESUCCESS, @"Failed to initialize cache");
+}
+
+- (void) tearDown {
+    plcrash_demangle_cache_free(&_cache);
+}
+
+- (void) testIsMangled {
+    STAssertTrue(plcrash_demangle_is_mangled("_ZN2ns3Foo3barEi"), @"C++ symbol not detected");
+    STAssertTrue(plcrash_demangle_is_mangled("__ZN2ns3Foo3barEi"), @"Darwin C++ symbol not detected");
+    STAssertTrue(plcrash_demangle_is_mangled("$s4main3fooyyF"), @"Swift symbol not detected");
+    STAssertFalse(plcrash_demangle_is_mangled("main"), @"C symbol detected as mangled");
+    STAssertFalse(plcrash_demangle_is_mangled("-[NSObject init]"), @"Objective-C symbol detected as mangled");
+}
+
+- (void) testDemangleCPlusPlus {
+    char *name = plcrash_demangle_cache_copy(&_cache, "_ZN2ns3Foo3barEi");
+    STAssertNotNULL(name, @"Failed to demangle symbol");
+    STAssertTrue(strcmp(name, "ns::Foo::bar(int)") == 0, @"Incorrect demangled name: %s", name);
+    free(name);
+
+    /* The second lookup must be served from the cache */
+    name = plcrash_demangle_cache_copy(&_cache, "_ZN2ns3Foo3barEi");
+    STAssertNotNULL(name, @"Failed to demangle cached symbol");
+    STAssertTrue(strcmp(name, "ns::Foo::bar(int)") == 0, @"Incorrect cached name: %s", name);
+    free(name);
+
+    STAssertEquals(_cache.misses, (uint64_t) 1, @"Unexpected miss count");
+    STAssertEquals(_cache.hits, (uint64_t) 1, @"Unexpected hit count");
+}
+
+- (void) testUnmangled {
+    STAssertNULL(plcrash_demangle_cache_copy(&_cache, "main"), @"Unmangled symbol returned a name");
+    STAssertEquals(_cache.misses, (uint64_t) 0, @"Unmangled symbols should bypass the cache");
+
+    /* Failures are memoized, too */
+    STAssertNULL(plcrash_demangle_cache_copy(&_cache, "_Zinvalid"), @"Invalid symbol returned a name");
+    STAssertNULL(plcrash_demangle_cache_copy(&_cache, "_Zinvalid"), @"Invalid symbol returned a name");
+    STAssertEquals(_cache.misses, (uint64_t) 1, @"Failed lookup was not memoized");
+}
+
+- (void) testEviction {
+    char symbol[64];
+    for (int i = 0; i < 64; i++) {
+        snprintf(symbol, sizeof(symbol), "_Z4fn%02dv", i);
+        free(plcrash_demangle_cache_copy(&_cache, symbol));
+    }
+
+    size_t occupied = 0;
+    for (size_t i = 0; i < _cache.set_count * PLCRASH_DEMANGLE_CACHE_WAYS; i++) {
+        if (_cache.entries[i].symbol != NULL)
+            occupied++;
+    }
+    STAssertTrue(occupied <= 8, @"Cache grew beyond its capacity: %zu", occupied);
+
+    /* Evicted names must still be demangled on demand */
+    char *name = plcrash_demangle_cache_copy(&_cache, "_Z4fn00v");
+    STAssertNotNULL(name, @"Failed to demangle evicted symbol");
+    STAssertTrue(strcmp(name, "fn00()") == 0, @"Incorrect demangled name: %s", name);
+    free(name);
+}
+
+@end
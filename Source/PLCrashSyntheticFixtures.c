@@ -0,0 +1,397 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "PLCrashSyntheticFixtures.h"
+
+#include <mach-o/loader.h>
+#include <mach-o/nlist.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_internal
+ * @defgroup plcrash_synthetic_fixtures Synthetic Scalability Fixtures
+ *
+ * Generators for synthetic Mach-O images and thread populations at scales beyond those of the test binaries: many
+ * images, huge symbol tables and FDE counts, and many threads. These are used by the benchmark suite to track
+ * scaling behavior. (For testing only!)
+ * @{
+ */
+
+/* Native Mach-O types */
+#ifdef __LP64__
+typedef struct mach_header_64 pl_synthetic_header_t;
+typedef struct segment_command_64 pl_synthetic_segment_t;
+typedef struct section_64 pl_synthetic_section_t;
+typedef struct nlist_64 pl_synthetic_nlist_t;
+#define PL_SYNTHETIC_MH_MAGIC MH_MAGIC_64
+#define PL_SYNTHETIC_LC_SEGMENT LC_SEGMENT_64
+#else
+typedef struct mach_header pl_synthetic_header_t;
+typedef struct segment_command pl_synthetic_segment_t;
+typedef struct section pl_synthetic_section_t;
+typedef struct nlist pl_synthetic_nlist_t;
+#define PL_SYNTHETIC_MH_MAGIC MH_MAGIC
+#define PL_SYNTHETIC_LC_SEGMENT LC_SEGMENT
+#endif
+
+/* Native CPU type, and the DWARF return address register */
+#if defined(__x86_64__)
+#define PL_SYNTHETIC_CPU_TYPE CPU_TYPE_X86_64
+#define PL_SYNTHETIC_CPU_SUBTYPE CPU_SUBTYPE_X86_64_ALL
+#define PL_SYNTHETIC_RA_REGISTER 16
+#elif defined(__i386__)
+#define PL_SYNTHETIC_CPU_TYPE CPU_TYPE_X86
+#define PL_SYNTHETIC_CPU_SUBTYPE CPU_SUBTYPE_X86_ALL
+#define PL_SYNTHETIC_RA_REGISTER 8
+#elif defined(__arm64__)
+#define PL_SYNTHETIC_CPU_TYPE CPU_TYPE_ARM64
+#define PL_SYNTHETIC_CPU_SUBTYPE CPU_SUBTYPE_ARM64_ALL
+#define PL_SYNTHETIC_RA_REGISTER 30
+#elif defined(__arm__)
+#define PL_SYNTHETIC_CPU_TYPE CPU_TYPE_ARM
+#define PL_SYNTHETIC_CPU_SUBTYPE CPU_SUBTYPE_ARM_ALL
+#define PL_SYNTHETIC_RA_REGISTER 14
+#else
+#error Unsupported target
+#endif
+
+/** The size of the synthetic CIE, including its length field and DW_CFA_nop padding. */
+#define PL_SYNTHETIC_CIE_SIZE 24
+
+/** The size of a synthetic FDE, including its length field and DW_CFA_nop padding. */
+#define PL_SYNTHETIC_FDE_SIZE 24
+
+/** The FDE pointer encoding: pc-relative, signed 32-bit values (DW_EH_PE_pcrel|DW_EH_PE_sdata4). */
+#define PL_SYNTHETIC_FDE_ENCODING 0x1B
+
+/** The size of the synthetic image's load commands. */
+#define PL_SYNTHETIC_CMDS_SIZE (sizeof(pl_synthetic_segment_t) + 2 * sizeof(pl_synthetic_section_t) + sizeof(pl_synthetic_segment_t) + \
+    sizeof(struct symtab_command) + sizeof(struct dysymtab_command) + sizeof(struct uuid_command))
+
+/* Round @a value up to a multiple of the page size */
+static pl_vm_size_t synthetic_round_page (pl_vm_size_t value) {
+    return (value + PAGE_SIZE - 1) & ~((pl_vm_size_t) PAGE_SIZE - 1);
+}
+
+/* Write a little-endian (native) 32-bit value to @a dest. */
+static void synthetic_write32 (uint8_t *dest, uint32_t value) {
+    memcpy(dest, &value, sizeof(value));
+}
+
+/* Initialize a segment command. */
+static void synthetic_segment_init (pl_synthetic_segment_t *seg, const char *name, pl_vm_size_t offset, pl_vm_size_t size, uint32_t nsects) {
+    memset(seg, 0, sizeof(*seg));
+    seg->cmd = PL_SYNTHETIC_LC_SEGMENT;
+    seg->cmdsize = (uint32_t) (sizeof(*seg) + nsects * sizeof(pl_synthetic_section_t));
+    strncpy(seg->segname, name, sizeof(seg->segname));
+    seg->vmaddr = offset;
+    seg->vmsize = size;
+    seg->fileoff = offset;
+    seg->filesize = size;
+    seg->maxprot = VM_PROT_READ | VM_PROT_EXECUTE;
+    seg->initprot = VM_PROT_READ | VM_PROT_EXECUTE;
+    seg->nsects = nsects;
+}
+
+/* Initialize a section header within the __TEXT segment. */
+static void synthetic_section_init (pl_synthetic_section_t *sect, const char *name, pl_vm_size_t offset, pl_vm_size_t size, uint32_t align, uint32_t flags) {
+    memset(sect, 0, sizeof(*sect));
+    strncpy(sect->sectname, name, sizeof(sect->sectname));
+    strncpy(sect->segname, SEG_TEXT, sizeof(sect->segname));
+    sect->addr = offset;
+    sect->size = size;
+    sect->offset = (uint32_t) offset;
+    sect->align = align;
+    sect->flags = flags;
+}
+
+/**
+ * Generate a synthetic Mach-O image in the current task. The image's __TEXT segment contains
+ * MAX(@a symbol_count, @a fde_count) functions of PLCRASH_SYNTHETIC_FUNCTION_SIZE bytes each.
+ *
+ * Symbol table entries are emitted in a fixed pseudo-random order, rather than sorted by address, as is the case in
+ * linked binaries. All FDEs share a single CIE, and use the pc-relative pointer encoding emitted by the linker.
+ *
+ * @param image The image to initialize. The image must be freed via plcrash_synthetic_image_free().
+ * @param index The image's index, used to derive a unique path and UUID.
+ * @param symbol_count The number of symbol table entries to generate.
+ * @param fde_count The number of FDEs to generate.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the image could not be allocated.
+ */
+plcrash_error_t plcrash_synthetic_image_init (plcrash_synthetic_image_t *image, uint32_t index, uint32_t symbol_count, uint32_t fde_count) {
+    uint32_t function_count = (symbol_count > fde_count) ? symbol_count : fde_count;
+    if (function_count == 0)
+        function_count = 1;
+    snprintf(image->path, sizeof(image->path), "/synthetic/image-%u.dylib", index);
+
+    /* Symbol names are of a fixed width, allowing the string table to be sized up front */
+    const char *name_format = "_synthetic_%u_%010u";
+    char name[64];
+    size_t name_size = (size_t) snprintf(name, sizeof(name), name_format, index, 0) + 1;
+
+    /* Compute the image layout; segment addresses are equal to their file offsets */
+    pl_vm_size_t text_offset = synthetic_round_page(sizeof(pl_synthetic_header_t) + PL_SYNTHETIC_CMDS_SIZE);
+    pl_vm_size_t text_size = (pl_vm_size_t) function_count * PLCRASH_SYNTHETIC_FUNCTION_SIZE;
+    pl_vm_size_t eh_offset = text_offset + text_size;
+    pl_vm_size_t eh_size = PL_SYNTHETIC_CIE_SIZE + (pl_vm_size_t) fde_count * PL_SYNTHETIC_FDE_SIZE + sizeof(uint32_t);
+    pl_vm_size_t text_seg_size = synthetic_round_page(eh_offset + eh_size);
+
+    pl_vm_size_t symoff = text_seg_size;
+    pl_vm_size_t stroff = symoff + (pl_vm_size_t) symbol_count * sizeof(pl_synthetic_nlist_t);
+    pl_vm_size_t strsize = 1 + (pl_vm_size_t) symbol_count * name_size;
+    pl_vm_size_t linkedit_size = synthetic_round_page(stroff - symoff + strsize);
+
+    /* Allocate the image; the memory is zero-filled */
+    vm_address_t base = 0;
+    if (vm_allocate(mach_task_self(), &base, text_seg_size + linkedit_size, VM_FLAGS_ANYWHERE) != KERN_SUCCESS)
+        return PLCRASH_ENOMEM;
+
+    uint8_t *bytes = (uint8_t *) base;
+    image->header = base;
+    image->size = text_seg_size + linkedit_size;
+    image->text_address = base + text_offset;
+    image->function_count = function_count;
+    image->symbol_count = symbol_count;
+    image->fde_count = fde_count;
+
+    /* Mach-O header */
+    pl_synthetic_header_t *header = (pl_synthetic_header_t *) bytes;
+    header->magic = PL_SYNTHETIC_MH_MAGIC;
+    header->cputype = PL_SYNTHETIC_CPU_TYPE;
+    header->cpusubtype = PL_SYNTHETIC_CPU_SUBTYPE;
+    header->filetype = MH_DYLIB;
+    header->ncmds = 5;
+    header->sizeofcmds = (uint32_t) PL_SYNTHETIC_CMDS_SIZE;
+    header->flags = MH_DYLDLINK | MH_TWOLEVEL;
+
+    /* __TEXT, with its __text and __eh_frame sections */
+    uint8_t *cmd = bytes + sizeof(*header);
+    synthetic_segment_init((pl_synthetic_segment_t *) cmd, SEG_TEXT, 0, text_seg_size, 2);
+    cmd += sizeof(pl_synthetic_segment_t);
+
+    synthetic_section_init((pl_synthetic_section_t *) cmd, SECT_TEXT, text_offset, text_size, 4, S_ATTR_PURE_INSTRUCTIONS | S_ATTR_SOME_INSTRUCTIONS);
+    cmd += sizeof(pl_synthetic_section_t);
+
+    synthetic_section_init((pl_synthetic_section_t *) cmd, "__eh_frame", eh_offset, eh_size, 3, S_COALESCED);
+    cmd += sizeof(pl_synthetic_section_t);
+
+    /* __LINKEDIT */
+    synthetic_segment_init((pl_synthetic_segment_t *) cmd, SEG_LINKEDIT, symoff, linkedit_size, 0);
+    ((pl_synthetic_segment_t *) cmd)->maxprot = VM_PROT_READ;
+    ((pl_synthetic_segment_t *) cmd)->initprot = VM_PROT_READ;
+    cmd += sizeof(pl_synthetic_segment_t);
+
+    /* Symbol tables; all symbols are external definitions */
+    struct symtab_command *symtab = (struct symtab_command *) cmd;
+    symtab->cmd = LC_SYMTAB;
+    symtab->cmdsize = sizeof(*symtab);
+    symtab->symoff = (uint32_t) symoff;
+    symtab->nsyms = symbol_count;
+    symtab->stroff = (uint32_t) stroff;
+    symtab->strsize = (uint32_t) strsize;
+    cmd += sizeof(*symtab);
+
+    struct dysymtab_command *dysymtab = (struct dysymtab_command *) cmd;
+    memset(dysymtab, 0, sizeof(*dysymtab));
+    dysymtab->cmd = LC_DYSYMTAB;
+    dysymtab->cmdsize = sizeof(*dysymtab);
+    dysymtab->iextdefsym = 0;
+    dysymtab->nextdefsym = symbol_count;
+    dysymtab->iundefsym = symbol_count;
+    cmd += sizeof(*dysymtab);
+
+    struct uuid_command *uuid = (struct uuid_command *) cmd;
+    uuid->cmd = LC_UUID;
+    uuid->cmdsize = sizeof(*uuid);
+    memset(uuid->uuid, 0x5A, sizeof(uuid->uuid));
+    memcpy(uuid->uuid, &index, sizeof(index));
+
+    /* Function bodies; each is filled with a trap instruction pattern, and is never executed */
+    memset(bytes + text_offset, 0xCC, text_size);
+
+    /* The CIE: version 1, "zR" augmentation, and no initial instructions. The remainder of the (zero-filled) record
+     * is DW_CFA_nop padding. */
+    uint8_t *eh = bytes + eh_offset;
+    synthetic_write32(eh, PL_SYNTHETIC_CIE_SIZE - sizeof(uint32_t));   /* length */
+    synthetic_write32(eh + 4, 0);                                       /* CIE_id */
+    eh[8] = 1;                                                          /* version */
+    memcpy(eh + 9, "zR", 3);                                            /* augmentation */
+    eh[12] = 1;                                                         /* code_alignment_factor (ULEB128) */
+    eh[13] = (uint8_t) (-(int) sizeof(void *) & 0x7F);                  /* data_alignment_factor (SLEB128) */
+    eh[14] = PL_SYNTHETIC_RA_REGISTER;                                  /* return_address_register */
+    eh[15] = 1;                                                         /* augmentation data length (ULEB128) */
+    eh[16] = PL_SYNTHETIC_FDE_ENCODING;                                 /* FDE pointer encoding */
+
+    /* The FDEs, each covering a single function, with no instructions. The section is terminated by the zero-length
+     * entry left by the zero-filled allocation. */
+    for (uint32_t i = 0; i < fde_count; i++) {
+        uint8_t *fde = eh + PL_SYNTHETIC_CIE_SIZE + (pl_vm_size_t) i * PL_SYNTHETIC_FDE_SIZE;
+        pl_vm_address_t fde_addr = base + eh_offset + PL_SYNTHETIC_CIE_SIZE + (pl_vm_address_t) i * PL_SYNTHETIC_FDE_SIZE;
+        pl_vm_address_t function = plcrash_synthetic_image_function_address(image, i);
+
+        synthetic_write32(fde, PL_SYNTHETIC_FDE_SIZE - sizeof(uint32_t));                  /* length */
+        synthetic_write32(fde + 4, (uint32_t) (fde + 4 - eh));                              /* CIE_pointer */
+        synthetic_write32(fde + 8, (uint32_t) (int32_t) (function - (fde_addr + 8)));       /* initial_location */
+        synthetic_write32(fde + 12, PLCRASH_SYNTHETIC_FUNCTION_SIZE);                       /* address_range */
+        fde[16] = 0;                                                                        /* augmentation data length */
+    }
+
+    /* Symbol and string tables */
+    pl_synthetic_nlist_t *nlist = (pl_synthetic_nlist_t *) (bytes + symoff);
+    char *strtab = (char *) (bytes + stroff);
+    strtab[0] = '\0';
+
+    uint32_t multiplier = (symbol_count % 7919 != 0) ? 7919 : 1;
+    for (uint32_t i = 0; i < symbol_count; i++) {
+        uint32_t function = (uint32_t) (((uint64_t) i * multiplier) % symbol_count);
+        uint32_t strx = (uint32_t) (1 + (pl_vm_size_t) i * name_size);
+
+        snprintf(strtab + strx, name_size, name_format, index, function);
+        nlist[i].n_un.n_strx = strx;
+        nlist[i].n_type = N_SECT | N_EXT;
+        nlist[i].n_sect = 1;
+        nlist[i].n_desc = 0;
+        nlist[i].n_value = text_offset + (pl_vm_size_t) function * PLCRASH_SYNTHETIC_FUNCTION_SIZE;
+    }
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Return the address of @a function within @a image.
+ *
+ * @param image A synthetic image.
+ * @param function The function index. Must be less than @a image->function_count.
+ */
+pl_vm_address_t plcrash_synthetic_image_function_address (plcrash_synthetic_image_t *image, uint32_t function) {
+    return image->text_address + (pl_vm_address_t) function * PLCRASH_SYNTHETIC_FUNCTION_SIZE;
+}
+
+/**
+ * Free all resources associated with @a image. The image must not be referenced by any image list or Mach-O parser.
+ *
+ * @param image The image to free.
+ */
+void plcrash_synthetic_image_free (plcrash_synthetic_image_t *image) {
+    vm_deallocate(mach_task_self(), (vm_address_t) image->header, (vm_size_t) image->size);
+}
+
+/* Descend @a remaining frames, and then park until the population is stopped. */
+static void __attribute__((noinline)) synthetic_thread_descend (plcrash_synthetic_threads_t *threads, uint32_t remaining) {
+    if (remaining > 0) {
+        synthetic_thread_descend(threads, remaining - 1);
+
+        /* Prevent a tail call, which would collapse the frames */
+        __asm__ __volatile__ ("");
+        return;
+    }
+
+    pthread_mutex_lock(&threads->lock);
+    threads->ready++;
+    pthread_cond_broadcast(&threads->cond);
+
+    while (!threads->stop)
+        pthread_cond_wait(&threads->cond, &threads->lock);
+    pthread_mutex_unlock(&threads->lock);
+}
+
+/* Thread entry point */
+static void *synthetic_thread_entry (void *arg) {
+    plcrash_synthetic_threads_t *threads = arg;
+    synthetic_thread_descend(threads, threads->depth);
+    return NULL;
+}
+
+/**
+ * Spawn @a count threads, each of which descends @a depth frames before parking. Returns once all threads have
+ * parked.
+ *
+ * @param threads The population to initialize. The population must be stopped via plcrash_synthetic_threads_stop().
+ * @param count The number of threads to spawn.
+ * @param depth The number of frames each thread descends before parking.
+ *
+ * @return Returns PLCRASH_ESUCCESS on success, or PLCRASH_ENOMEM if the threads could not be spawned. On failure,
+ * no threads remain running, and @a threads need not be stopped.
+ */
+plcrash_error_t plcrash_synthetic_threads_spawn (plcrash_synthetic_threads_t *threads, uint32_t count, uint32_t depth) {
+    threads->threads = calloc(count, sizeof(pthread_t));
+    if (threads->threads == NULL)
+        return PLCRASH_ENOMEM;
+
+    threads->count = 0;
+    threads->depth = depth;
+    threads->ready = 0;
+    threads->stop = false;
+    pthread_mutex_init(&threads->lock, NULL);
+    pthread_cond_init(&threads->cond, NULL);
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (pthread_create(&threads->threads[i], NULL, synthetic_thread_entry, threads) != 0) {
+            plcrash_synthetic_threads_stop(threads);
+            return PLCRASH_ENOMEM;
+        }
+        threads->count++;
+    }
+
+    /* Wait for all threads to park */
+    pthread_mutex_lock(&threads->lock);
+    while (threads->ready < threads->count)
+        pthread_cond_wait(&threads->cond, &threads->lock);
+    pthread_mutex_unlock(&threads->lock);
+
+    return PLCRASH_ESUCCESS;
+}
+
+/**
+ * Stop and join all threads of @a threads, and free all associated resources.
+ *
+ * @param threads The population to stop.
+ */
+void plcrash_synthetic_threads_stop (plcrash_synthetic_threads_t *threads) {
+    pthread_mutex_lock(&threads->lock);
+    threads->stop = true;
+    pthread_cond_broadcast(&threads->cond);
+    pthread_mutex_unlock(&threads->lock);
+
+    for (uint32_t i = 0; i < threads->count; i++)
+        pthread_join(threads->threads[i], NULL);
+
+    pthread_cond_destroy(&threads->cond);
+    pthread_mutex_destroy(&threads->lock);
+    free(threads->threads);
+    threads->threads = NULL;
+    threads->count = 0;
+}
+
+/**
+ * @}
+ */
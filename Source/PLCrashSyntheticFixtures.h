@@ -0,0 +1,128 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef PLCRASH_SYNTHETIC_FIXTURES_H
+#define PLCRASH_SYNTHETIC_FIXTURES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "PLCrashAsync.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @internal
+ * @ingroup plcrash_synthetic_fixtures
+ * @{
+ */
+
+/** The size of each synthetic function, in bytes. */
+#define PLCRASH_SYNTHETIC_FUNCTION_SIZE 16
+
+/**
+ * @internal
+ *
+ * A synthetic Mach-O image, generated in the current task's address space. The image is laid out as
+ * loaded by dyld, and may be parsed via plcrash_nasync_macho_init() and appended to an image list.
+ *
+ * The image's __TEXT,__text section consists of a run of fixed-size functions; the first @a symbol_count functions
+ * are named by the symbol table, and the first @a fde_count functions are described by an FDE in __TEXT,__eh_frame.
+ * The function bodies are not executable.
+ */
+typedef struct plcrash_synthetic_image {
+    /** The image's base (Mach-O header) address. */
+    pl_vm_address_t header;
+
+    /** The total size of the image's allocation, in bytes. */
+    pl_vm_size_t size;
+
+    /** The address of the first function within the image's __TEXT,__text section. */
+    pl_vm_address_t text_address;
+
+    /** The number of functions within the image's __TEXT,__text section. */
+    uint32_t function_count;
+
+    /** The number of symbol table entries. */
+    uint32_t symbol_count;
+
+    /** The number of FDEs within the image's __TEXT,__eh_frame section. */
+    uint32_t fde_count;
+
+    /** The image's path, as supplied to plcrash_nasync_image_list_append(). */
+    char path[64];
+} plcrash_synthetic_image_t;
+
+plcrash_error_t plcrash_synthetic_image_init (plcrash_synthetic_image_t *image, uint32_t index, uint32_t symbol_count, uint32_t fde_count);
+pl_vm_address_t plcrash_synthetic_image_function_address (plcrash_synthetic_image_t *image, uint32_t function);
+void plcrash_synthetic_image_free (plcrash_synthetic_image_t *image);
+
+/**
+ * @internal
+ *
+ * A population of parked threads, each of which has descended a fixed number of frames before blocking.
+ */
+typedef struct plcrash_synthetic_threads {
+    /** The spawned threads. */
+    pthread_t *threads;
+
+    /** The number of spawned threads. */
+    uint32_t count;
+
+    /** The number of frames each thread descends before blocking. */
+    uint32_t depth;
+
+    /** The number of threads that have reached their parking frame. Protected by @a lock. */
+    uint32_t ready;
+
+    /** If true, parked threads return. Protected by @a lock. */
+    bool stop;
+
+    /** Thread signaling lock */
+    pthread_mutex_t lock;
+
+    /** Thread signaling condition */
+    pthread_cond_t cond;
+} plcrash_synthetic_threads_t;
+
+plcrash_error_t plcrash_synthetic_threads_spawn (plcrash_synthetic_threads_t *threads, uint32_t count, uint32_t depth);
+void plcrash_synthetic_threads_stop (plcrash_synthetic_threads_t *threads);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_SYNTHETIC_FIXTURES_H */
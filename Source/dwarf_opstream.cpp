@@ -69,15 +69,15 @@ plcrash_error_t dwarf_opstream::init (plcrash_async_mobject_t *mobj,
         return PLCRASH_EINVAL;
     }
     
-    /* Map in the full instruction range */
-    _instr = plcrash_async_mobject_remap_address(mobj, _start, 0, _end-_start);
-    _instr_max = (uint8_t *)_instr + (_end - _start);
-    _p = _instr;
-    
-    if (_instr == NULL) {
+    /* Map in the full instruction range; reads within the range are then performed without further remapping */
+    if (plcrash_async_mobject_view_init(&_view, mobj, _start, 0, _end-_start) != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Could not map the DWARF instructions; range falls outside mapped pages");
         return PLCRASH_EINVAL;
     }
+
+    _instr = (void *) _view.base;
+    _instr_max = (uint8_t *)_instr + _view.length;
+    _p = _instr;
     
     return PLCRASH_ESUCCESS;
 }
@@ -62,6 +62,9 @@ class dwarf_opstream {
     /** Target-relative end address within the memory object */
     pl_vm_address_t _end;
 
+    /** The verified span of the full instruction range within the memory object. */
+    plcrash_async_mobject_view_t _view;
+
     /** Locally mapped starting address. */
     void *_instr;
 
@@ -110,13 +113,13 @@ template <typename V> inline bool dwarf_opstream::read_intU (V *result) {
     
     switch (sizeof(V)) {
         case 2:
-            *result = _byteorder->swap16(*result);
+            *result = plcrash_async_byteorder_swap16(_byteorder, *result);
             break;
         case 4:
-            *result = _byteorder->swap32(*result);
+            *result = plcrash_async_byteorder_swap32(_byteorder, *result);
             break;
         case 8:
-            *result = _byteorder->swap64(*result);
+            *result = plcrash_async_byteorder_swap64(_byteorder, *result);
             break;
         default:
             break;
@@ -138,10 +141,13 @@ template <typename V> inline bool dwarf_opstream::read_intU (V *result) {
  * @return Returns true on success, or false if the read would exceed the boundry specified by @a maxpos.
  */
 inline bool dwarf_opstream::read_uintmax64 (uint8_t data_size, uint64_t *result) {
-    pl_vm_off_t offset = ((uint8_t *)_p - (uint8_t *)_instr);
     plcrash_error_t err;
 
-    if ((err = plcrash_async_dwarf_read_uintmax64(_mobj, _byteorder, _start, offset, data_size, result)) != PLCRASH_ESUCCESS) {
+    if (_p < _instr)
+        return false;
+
+    /* The opstream's full range was verified on initialization; decode directly from the mapped bytes. */
+    if ((err = plcrash_async_dwarf_decode_uintmax64((const uint8_t *) _p, (uint8_t *)_instr_max - (uint8_t *)_p, _byteorder, data_size, result)) != PLCRASH_ESUCCESS) {
         PLCF_DEBUG("Read of integer value failed with %u", err);
         return false;
     }
@@ -165,19 +171,18 @@ inline bool dwarf_opstream::read_uintmax64 (uint8_t data_size, uint64_t *result)
  */
 inline bool dwarf_opstream::read_uleb128 (uint64_t *result) {
     plcrash_error_t err;
-    pl_vm_off_t offset = ((uint8_t *)_p - (uint8_t *)_instr);
     pl_vm_size_t lebsize;
 
-    if ((err = plcrash_async_dwarf_read_uleb128(_mobj, _start, offset, result, &lebsize)) != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Read of ULEB128 value failed with %u", err);
+    if (_p < _instr)
         return false;
-    }
 
-    /* Advance the position */
-    if (!skip(lebsize)) {
-        PLCF_DEBUG("ULEB128 value extends past end of opstream");
+    /* The opstream's full range was verified on initialization; decode directly from the mapped bytes. */
+    if ((err = plcrash_async_dwarf_decode_uleb128((const uint8_t *) _p, (uint8_t *)_instr_max - (uint8_t *)_p, result, &lebsize)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Read of ULEB128 value failed with %u", err);
         return false;
     }
+
+    _p = ((uint8_t *)_p) + lebsize;
     return true;
 }
 
@@ -191,19 +196,18 @@ inline bool dwarf_opstream::read_uleb128 (uint64_t *result) {
  */
 inline bool dwarf_opstream::read_sleb128 (int64_t *result) {
     plcrash_error_t err;
-    pl_vm_off_t offset = ((uint8_t *)_p - (uint8_t *)_instr);
     pl_vm_size_t lebsize;
-    
-    if ((err = plcrash_async_dwarf_read_sleb128(_mobj, _start, offset, result, &lebsize)) != PLCRASH_ESUCCESS) {
-        PLCF_DEBUG("Read of ULEB128 value failed with %u", err);
+
+    if (_p < _instr)
         return false;
-    }
-    
-    /* Advance the position */
-    if (!skip(lebsize)) {
-        PLCF_DEBUG("SLEB128 value extends past end of opstream");
+
+    /* The opstream's full range was verified on initialization; decode directly from the mapped bytes. */
+    if ((err = plcrash_async_dwarf_decode_sleb128((const uint8_t *) _p, (uint8_t *)_instr_max - (uint8_t *)_p, result, &lebsize)) != PLCRASH_ESUCCESS) {
+        PLCF_DEBUG("Read of SLEB128 value failed with %u", err);
         return false;
     }
+
+    _p = ((uint8_t *)_p) + lebsize;
     return true;
 }
 
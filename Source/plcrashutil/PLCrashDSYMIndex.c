@@ -0,0 +1,2055 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "PLCrashDSYMIndex.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/**
+ * @internal
+ * @defgroup plcrash_dsym_index dSYM Symbol Index
+ *
+ * Builds sorted function and line tables from the DWARF debug information of a dSYM debug file, for use by
+ * plcrashutil's offline symbolicator.
+ *
+ * The __debug_info and __debug_line sections are parsed once, and the subprogram address ranges and line table
+ * rows of all units are gathered into flat arrays sorted by address; all lookups are then binary searches over
+ * those arrays. DWARF versions 2 through 5 are supported. Subprograms split across multiple address ranges
+ * (DW_AT_ranges) are indexed once per range, and the ranges of inlined subroutines are recorded in a separate
+ * inline table, partitioned by the function into which they were inlined.
+ *
+ * As the index holds no pointers other than to its own tables, it may be written to an index file and later
+ * mapped directly, without parsing; see dsym_index_write() and dsym_index_map().
+ *
+ * @{
+ */
+
+/* DWARF constants used by the symbolicator */
+#define DW_TAG_inlined_subroutine   0x1d
+#define DW_TAG_subprogram           0x2e
+
+#define DW_AT_name                  0x03
+#define DW_AT_stmt_list             0x10
+#define DW_AT_low_pc                0x11
+#define DW_AT_high_pc               0x12
+#define DW_AT_comp_dir              0x1b
+#define DW_AT_abstract_origin       0x31
+#define DW_AT_specification         0x47
+#define DW_AT_call_file             0x58
+#define DW_AT_call_line             0x59
+#define DW_AT_linkage_name          0x6e
+#define DW_AT_str_offsets_base      0x72
+#define DW_AT_addr_base             0x73
+#define DW_AT_rnglists_base         0x74
+#define DW_AT_ranges                0x55
+#define DW_AT_MIPS_linkage_name     0x2007
+
+#define DW_FORM_addr                0x01
+#define DW_FORM_block2              0x03
+#define DW_FORM_block4              0x04
+#define DW_FORM_data2               0x05
+#define DW_FORM_data4               0x06
+#define DW_FORM_data8               0x07
+#define DW_FORM_string              0x08
+#define DW_FORM_block               0x09
+#define DW_FORM_block1              0x0a
+#define DW_FORM_data1               0x0b
+#define DW_FORM_flag                0x0c
+#define DW_FORM_sdata               0x0d
+#define DW_FORM_strp                0x0e
+#define DW_FORM_udata               0x0f
+#define DW_FORM_ref_addr            0x10
+#define DW_FORM_ref1                0x11
+#define DW_FORM_ref2                0x12
+#define DW_FORM_ref4                0x13
+#define DW_FORM_ref8                0x14
+#define DW_FORM_ref_udata           0x15
+#define DW_FORM_indirect            0x16
+#define DW_FORM_sec_offset          0x17
+#define DW_FORM_exprloc             0x18
+#define DW_FORM_flag_present        0x19
+#define DW_FORM_strx                0x1a
+#define DW_FORM_addrx               0x1b
+#define DW_FORM_ref_sup4            0x1c
+#define DW_FORM_strp_sup            0x1d
+#define DW_FORM_data16              0x1e
+#define DW_FORM_line_strp           0x1f
+#define DW_FORM_ref_sig8            0x20
+#define DW_FORM_implicit_const      0x21
+#define DW_FORM_loclistx            0x22
+#define DW_FORM_rnglistx            0x23
+#define DW_FORM_ref_sup8            0x24
+#define DW_FORM_strx1               0x25
+#define DW_FORM_strx2               0x26
+#define DW_FORM_strx3               0x27
+#define DW_FORM_strx4               0x28
+#define DW_FORM_addrx1              0x29
+#define DW_FORM_addrx2              0x2a
+#define DW_FORM_addrx3              0x2b
+#define DW_FORM_addrx4              0x2c
+
+#define DW_UT_type                  0x02
+#define DW_UT_skeleton              0x04
+#define DW_UT_split_compile         0x05
+#define DW_UT_split_type            0x06
+
+#define DW_LNS_copy                 0x01
+#define DW_LNS_advance_pc           0x02
+#define DW_LNS_advance_line         0x03
+#define DW_LNS_set_file             0x04
+#define DW_LNS_const_add_pc         0x08
+#define DW_LNS_fixed_advance_pc     0x09
+
+#define DW_LNE_end_sequence         0x01
+#define DW_LNE_set_address          0x02
+#define DW_LNE_define_file          0x03
+
+#define DW_RLE_end_of_list          0x00
+#define DW_RLE_base_addressx        0x01
+#define DW_RLE_startx_endx          0x02
+#define DW_RLE_startx_length        0x03
+#define DW_RLE_offset_pair          0x04
+#define DW_RLE_base_address         0x05
+#define DW_RLE_start_end            0x06
+#define DW_RLE_start_length         0x07
+
+#define DW_LNCT_path                0x01
+#define DW_LNCT_directory_index     0x02
+
+/* Maximum number of DW_AT_specification/DW_AT_abstract_origin references followed when resolving a function name */
+#define DSYM_ORIGIN_DEPTH_MAX 8
+
+/* Maximum DIE nesting depth tracked when recording inlined subroutines; deeper DIEs are not recorded */
+#define DSYM_DIE_DEPTH_MAX 128
+
+/* A bounds-checked reader over a mapped section. Reads past the end of the section return zero, and mark the
+ * cursor as overrun. */
+typedef struct dsym_cursor {
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool overrun;
+} dsym_cursor_t;
+
+/* A compilation unit header */
+typedef struct dsym_unit {
+    /* Offset of the unit header, and of the end of the unit, within __debug_info */
+    uint64_t offset;
+    uint64_t end;
+
+    /* Offset of the unit's first DIE */
+    uint64_t dies;
+
+    uint16_t version;
+    uint8_t offset_size;
+    uint8_t addr_size;
+    uint64_t abbrev_offset;
+
+    /* The unit's base address, from the unit DIE */
+    uint64_t low_pc;
+
+    /* DWARF 5 string offset, address, and range list table bases, from the unit DIE */
+    uint64_t str_offsets_base;
+    uint64_t addr_base;
+    uint64_t rnglists_base;
+} dsym_unit_t;
+
+/* A single abbreviation attribute specification */
+typedef struct dsym_attr_spec {
+    uint64_t name;
+    uint64_t form;
+    int64_t implicit_const;
+} dsym_attr_spec_t;
+
+/* An abbreviation declaration; its attributes are the @a count specs starting at @a spec */
+typedef struct dsym_abbrev {
+    uint64_t code;
+    uint64_t tag;
+    bool children;
+    size_t spec;
+    size_t count;
+} dsym_abbrev_t;
+
+/* A unit's abbreviation table */
+typedef struct dsym_abbrev_table {
+    dsym_abbrev_t *abbrevs;
+    size_t count;
+    dsym_attr_spec_t *specs;
+    size_t spec_count;
+} dsym_abbrev_table_t;
+
+/* A decoded attribute value. References are converted to absolute __debug_info offsets, and string forms are
+ * resolved to their (mapped) string. */
+typedef struct dsym_value {
+    uint64_t form;
+    uint64_t data;
+    const char *string;
+} dsym_value_t;
+
+/* The C++ ABI demangler; resolved at runtime, as plcrashutil does not otherwise link the C++ runtime */
+typedef char *(*dsym_demangle_fn) (const char *mangled, char *buffer, size_t *length, int *status);
+
+/* Mutable state used while building an index */
+typedef struct dsym_builder {
+    const dsym_dwarf_t *dwarf;
+
+    /* Unit headers and their abbreviation tables, in __debug_info order */
+    dsym_unit_t *units;
+    dsym_abbrev_table_t *tables;
+    size_t unit_count;
+    size_t unit_capacity;
+    size_t table_capacity;
+
+    dsym_function_t *functions;
+    size_t function_count;
+    size_t function_capacity;
+
+    dsym_inline_t *inlines;
+    size_t inline_count;
+    size_t inline_capacity;
+
+    dsym_line_t *lines;
+    size_t line_count;
+    size_t line_capacity;
+
+    uint32_t *files;
+    size_t file_count;
+    size_t file_capacity;
+
+    /* Open-addressed hash of file table indices (plus one; zero marks an empty slot), keyed by path */
+    uint32_t *file_hash;
+    size_t file_hash_capacity;
+
+    /* Scratch buffer used to join file paths */
+    char path[PATH_MAX * 2];
+
+    char *strings;
+    size_t strings_length;
+    size_t strings_capacity;
+
+    /* The C++ demangler, or NULL if unavailable */
+    dsym_demangle_fn demangle;
+} dsym_builder_t;
+
+/*
+ * Grow the array at @a array to hold at least @a count elements of @a size bytes. Returns false if the
+ * allocation fails.
+ */
+static bool dsym_reserve (void **array, size_t *capacity, size_t count, size_t size) {
+    if (count <= *capacity)
+        return true;
+
+    size_t newCapacity = MAX(*capacity * 2, MAX(count, (size_t) 64));
+    void *result = realloc(*array, newCapacity * size);
+    if (result == NULL)
+        return false;
+
+    *array = result;
+    *capacity = newCapacity;
+    return true;
+}
+
+static void dsym_cursor_init (dsym_cursor_t *cursor, const dsym_section_t *section, uint64_t offset) {
+    cursor->pos = section->data + MIN(offset, section->size);
+    cursor->end = section->data + section->size;
+    cursor->overrun = (offset > section->size);
+}
+
+static const uint8_t *dsym_read_bytes (dsym_cursor_t *cursor, uint64_t length) {
+    if (cursor->overrun || length > (uint64_t) (cursor->end - cursor->pos)) {
+        cursor->overrun = true;
+        cursor->pos = cursor->end;
+        return NULL;
+    }
+
+    const uint8_t *result = cursor->pos;
+    cursor->pos += length;
+    return result;
+}
+
+/* Read a little-endian unsigned integer of @a size bytes */
+static uint64_t dsym_read_uint (dsym_cursor_t *cursor, size_t size) {
+    const uint8_t *bytes = dsym_read_bytes(cursor, size);
+    if (bytes == NULL)
+        return 0;
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; i++)
+        result |= ((uint64_t) bytes[i]) << (i * 8);
+
+    return result;
+}
+
+static uint64_t dsym_read_uleb (dsym_cursor_t *cursor) {
+    uint64_t result = 0;
+    unsigned int shift = 0;
+
+    while (!cursor->overrun && cursor->pos < cursor->end) {
+        uint8_t byte = *cursor->pos++;
+        if (shift < 64)
+            result |= ((uint64_t) (byte & 0x7f)) << shift;
+        shift += 7;
+
+        if ((byte & 0x80) == 0)
+            return result;
+    }
+
+    cursor->overrun = true;
+    return 0;
+}
+
+static int64_t dsym_read_sleb (dsym_cursor_t *cursor) {
+    uint64_t result = 0;
+    unsigned int shift = 0;
+
+    while (!cursor->overrun && cursor->pos < cursor->end) {
+        uint8_t byte = *cursor->pos++;
+        if (shift < 64)
+            result |= ((uint64_t) (byte & 0x7f)) << shift;
+        shift += 7;
+
+        if ((byte & 0x80) == 0) {
+            if (shift < 64 && (byte & 0x40))
+                result |= -(((uint64_t) 1) << shift);
+            return (int64_t) result;
+        }
+    }
+
+    cursor->overrun = true;
+    return 0;
+}
+
+static const char *dsym_read_cstr (dsym_cursor_t *cursor) {
+    const uint8_t *nul = NULL;
+    if (!cursor->overrun)
+        nul = memchr(cursor->pos, '\0', cursor->end - cursor->pos);
+
+    if (nul == NULL) {
+        cursor->overrun = true;
+        cursor->pos = cursor->end;
+        return NULL;
+    }
+
+    const char *result = (const char *) cursor->pos;
+    cursor->pos = nul + 1;
+    return result;
+}
+
+/* Read an initial length field, returning the length and its offset size (4 or 8) */
+static uint64_t dsym_read_initial_length (dsym_cursor_t *cursor, uint8_t *offsetSize) {
+    uint64_t length = dsym_read_uint(cursor, 4);
+    *offsetSize = 4;
+
+    if (length == 0xffffffff) {
+        length = dsym_read_uint(cursor, 8);
+        *offsetSize = 8;
+    } else if (length >= 0xfffffff0) {
+        /* Reserved */
+        cursor->overrun = true;
+    }
+
+    return length;
+}
+
+/* Return the NUL-terminated string at @a offset within @a section, or NULL if it is out of bounds */
+static const char *dsym_section_string (const dsym_section_t *section, uint64_t offset) {
+    if (offset >= section->size || memchr(section->data + offset, '\0', section->size - offset) == NULL)
+        return NULL;
+
+    return (const char *) (section->data + offset);
+}
+
+/* Resolve a DWARF 5 string offset table index */
+static const char *dsym_unit_strx (const dsym_dwarf_t *dwarf, const dsym_unit_t *unit, uint64_t index) {
+    dsym_cursor_t cursor;
+    dsym_cursor_init(&cursor, &dwarf->str_offsets, unit->str_offsets_base + index * unit->offset_size);
+
+    uint64_t offset = dsym_read_uint(&cursor, unit->offset_size);
+    if (cursor.overrun)
+        return NULL;
+
+    return dsym_section_string(&dwarf->str, offset);
+}
+
+/* Resolve a DWARF 5 address table index */
+static uint64_t dsym_unit_addrx (const dsym_dwarf_t *dwarf, const dsym_unit_t *unit, uint64_t index) {
+    dsym_cursor_t cursor;
+    dsym_cursor_init(&cursor, &dwarf->addr, unit->addr_base + index * unit->addr_size);
+    return dsym_read_uint(&cursor, unit->addr_size);
+}
+
+/*
+ * Read the value of an attribute with the given @a form. Returns false if the form is unknown, in which case the
+ * remainder of the unit can not be parsed.
+ */
+static bool dsym_read_value (dsym_cursor_t *cursor, const dsym_dwarf_t *dwarf, const dsym_unit_t *unit, uint64_t form, int64_t implicitConst, dsym_value_t *value) {
+    value->form = form;
+    value->data = 0;
+    value->string = NULL;
+
+    switch (form) {
+        case DW_FORM_addr:
+            value->data = dsym_read_uint(cursor, unit->addr_size);
+            break;
+
+        case DW_FORM_addrx:
+            value->data = dsym_unit_addrx(dwarf, unit, dsym_read_uleb(cursor));
+            break;
+        case DW_FORM_addrx1:
+        case DW_FORM_addrx2:
+        case DW_FORM_addrx3:
+        case DW_FORM_addrx4:
+            value->data = dsym_unit_addrx(dwarf, unit, dsym_read_uint(cursor, form - DW_FORM_addrx1 + 1));
+            break;
+
+        case DW_FORM_data1:
+        case DW_FORM_ref1:
+        case DW_FORM_flag:
+            value->data = dsym_read_uint(cursor, 1);
+            break;
+        case DW_FORM_data2:
+        case DW_FORM_ref2:
+            value->data = dsym_read_uint(cursor, 2);
+            break;
+        case DW_FORM_data4:
+        case DW_FORM_ref4:
+        case DW_FORM_ref_sup4:
+            value->data = dsym_read_uint(cursor, 4);
+            break;
+        case DW_FORM_data8:
+        case DW_FORM_ref8:
+        case DW_FORM_ref_sig8:
+        case DW_FORM_ref_sup8:
+            value->data = dsym_read_uint(cursor, 8);
+            break;
+        case DW_FORM_data16:
+            dsym_read_bytes(cursor, 16);
+            break;
+
+        case DW_FORM_sdata:
+            value->data = (uint64_t) dsym_read_sleb(cursor);
+            break;
+        case DW_FORM_udata:
+        case DW_FORM_ref_udata:
+        case DW_FORM_loclistx:
+        case DW_FORM_rnglistx:
+            value->data = dsym_read_uleb(cursor);
+            break;
+        case DW_FORM_implicit_const:
+            value->data = (uint64_t) implicitConst;
+            break;
+        case DW_FORM_flag_present:
+            value->data = 1;
+            break;
+
+        case DW_FORM_string:
+            value->string = dsym_read_cstr(cursor);
+            break;
+        case DW_FORM_strp:
+            value->string = dsym_section_string(&dwarf->str, dsym_read_uint(cursor, unit->offset_size));
+            break;
+        case DW_FORM_line_strp:
+            value->string = dsym_section_string(&dwarf->line_str, dsym_read_uint(cursor, unit->offset_size));
+            break;
+        case DW_FORM_strp_sup:
+        case DW_FORM_sec_offset:
+            value->data = dsym_read_uint(cursor, unit->offset_size);
+            break;
+        case DW_FORM_strx:
+            value->string = dsym_unit_strx(dwarf, unit, dsym_read_uleb(cursor));
+            break;
+        case DW_FORM_strx1:
+        case DW_FORM_strx2:
+        case DW_FORM_strx3:
+        case DW_FORM_strx4:
+            value->string = dsym_unit_strx(dwarf, unit, dsym_read_uint(cursor, form - DW_FORM_strx1 + 1));
+            break;
+
+        case DW_FORM_ref_addr:
+            value->data = dsym_read_uint(cursor, unit->version <= 2 ? unit->addr_size : unit->offset_size);
+            break;
+
+        case DW_FORM_block1:
+            dsym_read_bytes(cursor, dsym_read_uint(cursor, 1));
+            break;
+        case DW_FORM_block2:
+            dsym_read_bytes(cursor, dsym_read_uint(cursor, 2));
+            break;
+        case DW_FORM_block4:
+            dsym_read_bytes(cursor, dsym_read_uint(cursor, 4));
+            break;
+        case DW_FORM_block:
+        case DW_FORM_exprloc:
+            dsym_read_bytes(cursor, dsym_read_uleb(cursor));
+            break;
+
+        case DW_FORM_indirect: {
+            uint64_t indirect = dsym_read_uleb(cursor);
+            if (indirect == DW_FORM_indirect || indirect == DW_FORM_implicit_const)
+                return false;
+            return dsym_read_value(cursor, dwarf, unit, indirect, 0, value);
+        }
+
+        default:
+            return false;
+    }
+
+    /* Unit-relative references are converted to absolute offsets */
+    switch (form) {
+        case DW_FORM_ref1:
+        case DW_FORM_ref2:
+        case DW_FORM_ref4:
+        case DW_FORM_ref8:
+        case DW_FORM_ref_udata:
+            value->data += unit->offset;
+            break;
+        default:
+            break;
+    }
+
+    return !cursor->overrun;
+}
+
+/*
+ * Parse the abbreviation table at @a offset.
+ */
+static bool dsym_abbrev_table_parse (const dsym_dwarf_t *dwarf, uint64_t offset, dsym_abbrev_table_t *table) {
+    size_t abbrevCapacity = 0;
+    size_t specCapacity = 0;
+    dsym_cursor_t cursor;
+
+    memset(table, 0, sizeof(*table));
+    dsym_cursor_init(&cursor, &dwarf->abbrev, offset);
+
+    while (true) {
+        uint64_t code = dsym_read_uleb(&cursor);
+        if (code == 0 || cursor.overrun)
+            break;
+
+        if (!dsym_reserve((void **) &table->abbrevs, &abbrevCapacity, table->count + 1, sizeof(dsym_abbrev_t)))
+            return false;
+
+        dsym_abbrev_t *abbrev = &table->abbrevs[table->count++];
+        abbrev->code = code;
+        abbrev->tag = dsym_read_uleb(&cursor);
+        abbrev->spec = table->spec_count;
+        abbrev->count = 0;
+
+        abbrev->children = (dsym_read_uint(&cursor, 1) != 0);
+
+        while (!cursor.overrun) {
+            uint64_t name = dsym_read_uleb(&cursor);
+            uint64_t form = dsym_read_uleb(&cursor);
+            int64_t implicitConst = 0;
+            if (form == DW_FORM_implicit_const)
+                implicitConst = dsym_read_sleb(&cursor);
+
+            if (name == 0 && form == 0)
+                break;
+
+            if (!dsym_reserve((void **) &table->specs, &specCapacity, table->spec_count + 1, sizeof(dsym_attr_spec_t)))
+                return false;
+
+            dsym_attr_spec_t *spec = &table->specs[table->spec_count++];
+            spec->name = name;
+            spec->form = form;
+            spec->implicit_const = implicitConst;
+            abbrev->count++;
+        }
+    }
+
+    return !cursor.overrun;
+}
+
+static void dsym_abbrev_table_free (dsym_abbrev_table_t *table) {
+    free(table->abbrevs);
+    free(table->specs);
+}
+
+/* Find the abbreviation with @a code. Codes are generally assigned sequentially, and are found directly. */
+static const dsym_abbrev_t *dsym_abbrev_find (const dsym_abbrev_table_t *table, uint64_t code) {
+    if (code > 0 && code <= table->count && table->abbrevs[code - 1].code == code)
+        return &table->abbrevs[code - 1];
+
+    for (size_t i = 0; i < table->count; i++) {
+        if (table->abbrevs[i].code == code)
+            return &table->abbrevs[i];
+    }
+
+    return NULL;
+}
+
+/*
+ * Append @a length bytes of @a string to the builder's string table, returning its offset, or UINT32_MAX if the
+ * string table can not be extended.
+ */
+static uint32_t dsym_builder_add_string (dsym_builder_t *builder, const char *string, size_t length) {
+    if (builder->strings_length + length + 1 > UINT32_MAX)
+        return UINT32_MAX;
+
+    if (!dsym_reserve((void **) &builder->strings, &builder->strings_capacity, builder->strings_length + length + 1, 1))
+        return UINT32_MAX;
+
+    uint32_t offset = (uint32_t) builder->strings_length;
+    memcpy(builder->strings + offset, string, length);
+    builder->strings[offset + length] = '\0';
+    builder->strings_length += length + 1;
+
+    return offset;
+}
+
+/*
+ * Append the function name for the given DW_AT_name and linkage name values. C++ functions are named using their
+ * demangled linkage name, which includes their scope and parameters; all other functions (including Objective-C
+ * methods) are named using DW_AT_name.
+ */
+static uint32_t dsym_builder_add_name (dsym_builder_t *builder, const char *name, const char *linkage) {
+    if (linkage != NULL && builder->demangle != NULL && strncmp(linkage, "_Z", 2) == 0) {
+        int status;
+        char *demangled = builder->demangle(linkage, NULL, NULL, &status);
+        if (demangled != NULL) {
+            uint32_t result = dsym_builder_add_string(builder, demangled, strlen(demangled));
+            free(demangled);
+            return result;
+        }
+    }
+
+    if (name == NULL)
+        name = linkage;
+
+    if (name == NULL)
+        return UINT32_MAX;
+
+    return dsym_builder_add_string(builder, name, strlen(name));
+}
+
+/* Return the index of the unit containing the absolute __debug_info @a offset, or SIZE_MAX */
+static size_t dsym_builder_unit_for_offset (dsym_builder_t *builder, uint64_t offset) {
+    size_t lo = 0;
+    size_t hi = builder->unit_count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (builder->units[mid].offset <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0 || offset >= builder->units[lo - 1].end)
+        return SIZE_MAX;
+
+    return lo - 1;
+}
+
+/*
+ * Resolve the name of the DIE at the absolute __debug_info @a offset, following its specification and abstract
+ * origin references. Returns the string table offset of the name, or UINT32_MAX if no name was found.
+ */
+static uint32_t dsym_builder_resolve_name (dsym_builder_t *builder, uint64_t offset) {
+    for (unsigned int depth = 0; depth < DSYM_ORIGIN_DEPTH_MAX; depth++) {
+        size_t unitIndex = dsym_builder_unit_for_offset(builder, offset);
+        if (unitIndex == SIZE_MAX)
+            return UINT32_MAX;
+
+        const dsym_unit_t *unit = &builder->units[unitIndex];
+        const dsym_abbrev_table_t *table = &builder->tables[unitIndex];
+        dsym_cursor_t cursor;
+        dsym_cursor_init(&cursor, &builder->dwarf->info, offset);
+
+        const dsym_abbrev_t *abbrev = dsym_abbrev_find(table, dsym_read_uleb(&cursor));
+        if (abbrev == NULL)
+            return UINT32_MAX;
+
+        const char *name = NULL;
+        const char *linkage = NULL;
+        uint64_t origin = 0;
+
+        for (size_t i = 0; i < abbrev->count; i++) {
+            const dsym_attr_spec_t *spec = &table->specs[abbrev->spec + i];
+            dsym_value_t value;
+            if (!dsym_read_value(&cursor, builder->dwarf, unit, spec->form, spec->implicit_const, &value))
+                return UINT32_MAX;
+
+            switch (spec->name) {
+                case DW_AT_name:
+                    name = value.string;
+                    break;
+                case DW_AT_linkage_name:
+                case DW_AT_MIPS_linkage_name:
+                    linkage = value.string;
+                    break;
+                case DW_AT_specification:
+                case DW_AT_abstract_origin:
+                    origin = value.data;
+                    break;
+            }
+        }
+
+        if (name != NULL || linkage != NULL)
+            return dsym_builder_add_name(builder, name, linkage);
+
+        if (origin == 0 || origin == offset)
+            return UINT32_MAX;
+
+        offset = origin;
+    }
+
+    return UINT32_MAX;
+}
+
+/* FNV-1a hash of a file path */
+static uint32_t dsym_path_hash (const char *path) {
+    uint32_t hash = 2166136261U;
+    for (const char *c = path; *c != '\0'; c++)
+        hash = (hash ^ (uint8_t) *c) * 16777619U;
+    return hash;
+}
+
+/* Rebuild the file path hash with @a capacity slots */
+static bool dsym_builder_rehash_files (dsym_builder_t *builder, size_t capacity) {
+    uint32_t *hash = calloc(capacity, sizeof(uint32_t));
+    if (hash == NULL)
+        return false;
+
+    for (size_t i = 0; i < builder->file_count; i++) {
+        size_t slot = dsym_path_hash(builder->strings + builder->files[i]) & (capacity - 1);
+        while (hash[slot] != 0)
+            slot = (slot + 1) & (capacity - 1);
+        hash[slot] = (uint32_t) i + 1;
+    }
+
+    free(builder->file_hash);
+    builder->file_hash = hash;
+    builder->file_hash_capacity = capacity;
+    return true;
+}
+
+/*
+ * Return the file table index for @a path, registering the path if necessary. Returns DSYM_NO_FILE if the path
+ * can not be registered.
+ */
+static uint32_t dsym_builder_file_index (dsym_builder_t *builder, const char *path) {
+    /* Keep the hash at most half full */
+    if ((builder->file_count + 1) * 2 > builder->file_hash_capacity) {
+        if (!dsym_builder_rehash_files(builder, MAX(builder->file_hash_capacity * 2, (size_t) 256)))
+            return DSYM_NO_FILE;
+    }
+
+    size_t mask = builder->file_hash_capacity - 1;
+    size_t slot = dsym_path_hash(path) & mask;
+    for (; builder->file_hash[slot] != 0; slot = (slot + 1) & mask) {
+        uint32_t index = builder->file_hash[slot] - 1;
+        if (strcmp(builder->strings + builder->files[index], path) == 0)
+            return index;
+    }
+
+    if (builder->file_count >= DSYM_NO_FILE - 1)
+        return DSYM_NO_FILE;
+
+    uint32_t offset = dsym_builder_add_string(builder, path, strlen(path));
+    if (offset == UINT32_MAX)
+        return DSYM_NO_FILE;
+
+    if (!dsym_reserve((void **) &builder->files, &builder->file_capacity, builder->file_count + 1, sizeof(uint32_t)))
+        return DSYM_NO_FILE;
+
+    uint32_t index = (uint32_t) builder->file_count;
+    builder->files[builder->file_count++] = offset;
+    builder->file_hash[slot] = index + 1;
+
+    return index;
+}
+
+/* Append @a component to the path of @a length bytes in @a buffer, returning the new length */
+static size_t dsym_path_append (char *buffer, size_t size, size_t length, const char *component) {
+    if (length > 0 && buffer[length - 1] != '/' && length + 1 < size)
+        buffer[length++] = '/';
+
+    size_t componentLength = strlen(component);
+    if (componentLength >= size - length)
+        componentLength = size - length - 1;
+
+    memcpy(buffer + length, component, componentLength);
+    length += componentLength;
+    buffer[length] = '\0';
+
+    return length;
+}
+
+/*
+ * Return the file table index of the line table file entry @a name, joined with its @a directory and the unit's
+ * compilation directory.
+ */
+static uint32_t dsym_builder_line_file (dsym_builder_t *builder, const char *compDir, const char *directory, const char *name) {
+    if (name == NULL || *name == '\0')
+        return DSYM_NO_FILE;
+
+    size_t length = 0;
+    builder->path[0] = '\0';
+
+    if (name[0] != '/') {
+        if ((directory == NULL || directory[0] != '/') && compDir != NULL)
+            length = dsym_path_append(builder->path, sizeof(builder->path), length, compDir);
+
+        if (directory != NULL && *directory != '\0')
+            length = dsym_path_append(builder->path, sizeof(builder->path), length, directory);
+    }
+
+    dsym_path_append(builder->path, sizeof(builder->path), length, name);
+    return dsym_builder_file_index(builder, builder->path);
+}
+
+static bool dsym_builder_add_line (dsym_builder_t *builder, uint64_t address, uint32_t file, uint64_t line) {
+    if (!dsym_reserve((void **) &builder->lines, &builder->line_capacity, builder->line_count + 1, sizeof(dsym_line_t)))
+        return false;
+
+    dsym_line_t *row = &builder->lines[builder->line_count++];
+    row->address = address;
+    row->file = file;
+    row->line = (uint32_t) MIN(line, (uint64_t) UINT32_MAX);
+    return true;
+}
+
+/* A DWARF 5 line table directory or file name entry */
+typedef struct dsym_line_entry {
+    const char *path;
+    uint64_t directory;
+} dsym_line_entry_t;
+
+/*
+ * Parse a DWARF 5 directory or file name entry format description, and the entries that follow it.
+ */
+static bool dsym_parse_line_entries (dsym_cursor_t *cursor, const dsym_dwarf_t *dwarf, const dsym_unit_t *unit, dsym_line_entry_t **entries, size_t *count) {
+    uint8_t formatCount = (uint8_t) dsym_read_uint(cursor, 1);
+    uint64_t types[UINT8_MAX];
+    uint64_t forms[UINT8_MAX];
+    size_t capacity = 0;
+
+    for (uint8_t i = 0; i < formatCount; i++) {
+        types[i] = dsym_read_uleb(cursor);
+        forms[i] = dsym_read_uleb(cursor);
+    }
+
+    *entries = NULL;
+    *count = 0;
+
+    uint64_t entryCount = dsym_read_uleb(cursor);
+    for (uint64_t i = 0; i < entryCount && !cursor->overrun; i++) {
+        dsym_line_entry_t entry = { NULL, 0 };
+
+        for (uint8_t f = 0; f < formatCount; f++) {
+            dsym_value_t value;
+            if (!dsym_read_value(cursor, dwarf, unit, forms[f], 0, &value))
+                return false;
+
+            if (types[f] == DW_LNCT_path)
+                entry.path = value.string;
+            else if (types[f] == DW_LNCT_directory_index)
+                entry.directory = value.data;
+        }
+
+        if (!dsym_reserve((void **) entries, &capacity, *count + 1, sizeof(dsym_line_entry_t)))
+            return false;
+        (*entries)[(*count)++] = entry;
+    }
+
+    return !cursor->overrun;
+}
+
+/*
+ * Parse the line table header directories and files at @a cursor, populating the @a fileMap from the program's
+ * file register values to the builder's file table.
+ */
+static bool dsym_builder_parse_line_files (dsym_builder_t *builder, dsym_cursor_t *cursor, const dsym_unit_t *lineUnit, uint16_t version,
+                                           const char *compDir, const char ***directories, size_t *directoryCount, uint32_t **fileMap, size_t *fileCount)
+{
+    size_t directoryCapacity = 0;
+    size_t fileCapacity = 0;
+
+    if (version >= 5) {
+        dsym_line_entry_t *entries = NULL;
+        size_t count;
+
+        if (!dsym_parse_line_entries(cursor, builder->dwarf, lineUnit, &entries, &count)) {
+            free(entries);
+            return false;
+        }
+
+        if (!dsym_reserve((void **) directories, &directoryCapacity, MAX(count, (size_t) 1), sizeof(const char *))) {
+            free(entries);
+            return false;
+        }
+
+        for (size_t i = 0; i < count; i++)
+            (*directories)[i] = entries[i].path;
+        *directoryCount = count;
+        free(entries);
+
+        if (!dsym_parse_line_entries(cursor, builder->dwarf, lineUnit, &entries, &count)) {
+            free(entries);
+            return false;
+        }
+
+        if (!dsym_reserve((void **) fileMap, &fileCapacity, MAX(count, (size_t) 1), sizeof(uint32_t))) {
+            free(entries);
+            return false;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            const char *dir = entries[i].directory < *directoryCount ? (*directories)[entries[i].directory] : NULL;
+            (*fileMap)[i] = dsym_builder_line_file(builder, compDir, dir, entries[i].path);
+        }
+        *fileCount = count;
+        free(entries);
+
+        return true;
+    }
+
+    /* Prior to DWARF 5, directory 0 is the compilation directory, and file indices start at 1 */
+    if (!dsym_reserve((void **) directories, &directoryCapacity, 1, sizeof(const char *)))
+        return false;
+    (*directories)[0] = compDir;
+    *directoryCount = 1;
+
+    const char *directory;
+    while ((directory = dsym_read_cstr(cursor)) != NULL && *directory != '\0') {
+        if (!dsym_reserve((void **) directories, &directoryCapacity, *directoryCount + 1, sizeof(const char *)))
+            return false;
+        (*directories)[(*directoryCount)++] = directory;
+    }
+
+    if (!dsym_reserve((void **) fileMap, &fileCapacity, 1, sizeof(uint32_t)))
+        return false;
+    (*fileMap)[0] = DSYM_NO_FILE;
+    *fileCount = 1;
+
+    const char *name;
+    while ((name = dsym_read_cstr(cursor)) != NULL && *name != '\0') {
+        uint64_t dir = dsym_read_uleb(cursor);
+        dsym_read_uleb(cursor); /* mtime */
+        dsym_read_uleb(cursor); /* length */
+
+        if (!dsym_reserve((void **) fileMap, &fileCapacity, *fileCount + 1, sizeof(uint32_t)))
+            return false;
+
+        /* Directory 0 is the compilation directory, which is applied by dsym_builder_line_file() */
+        const char *dirPath = (dir > 0 && dir < *directoryCount) ? (*directories)[dir] : NULL;
+        (*fileMap)[(*fileCount)++] = dsym_builder_line_file(builder, compDir, dirPath, name);
+    }
+
+    return !cursor->overrun;
+}
+
+/*
+ * Parse the line number program at @a offset within __debug_line, appending its rows to the builder's line table.
+ * The program's file table, mapping its file numbers to builder file indices, is returned via @a outFileMap and
+ * must be freed by the caller.
+ */
+static bool dsym_builder_parse_lines (dsym_builder_t *builder, const dsym_unit_t *unit, uint64_t offset, const char *compDir,
+                                      uint32_t **outFileMap, size_t *outFileCount)
+{
+    const dsym_dwarf_t *dwarf = builder->dwarf;
+    const char **directories = NULL;
+    size_t directoryCount = 0;
+    uint32_t *fileMap = NULL;
+    size_t fileCount = 0;
+    bool result = false;
+    dsym_cursor_t cursor;
+
+    dsym_cursor_init(&cursor, &dwarf->line, offset);
+
+    /* Header */
+    uint8_t offsetSize;
+    uint64_t length = dsym_read_initial_length(&cursor, &offsetSize);
+    if (cursor.overrun || length > (uint64_t) (cursor.end - cursor.pos))
+        goto cleanup;
+
+    const uint8_t *programEnd = cursor.pos + length;
+    uint16_t version = (uint16_t) dsym_read_uint(&cursor, 2);
+    if (version < 2 || version > 5)
+        goto cleanup;
+
+    /* File entry forms are decoded relative to the line table's own offset and address sizes */
+    dsym_unit_t lineUnit = *unit;
+    lineUnit.offset_size = offsetSize;
+
+    if (version >= 5) {
+        lineUnit.addr_size = (uint8_t) dsym_read_uint(&cursor, 1);
+        dsym_read_uint(&cursor, 1); /* segment_selector_size */
+    }
+
+    uint64_t headerLength = dsym_read_uint(&cursor, offsetSize);
+    if (cursor.overrun || headerLength > (uint64_t) (programEnd - cursor.pos))
+        goto cleanup;
+    const uint8_t *programStart = cursor.pos + headerLength;
+
+    uint8_t minInstructionLength = (uint8_t) dsym_read_uint(&cursor, 1);
+    if (version >= 4)
+        dsym_read_uint(&cursor, 1); /* maximum_operations_per_instruction */
+    dsym_read_uint(&cursor, 1); /* default_is_stmt */
+    int8_t lineBase = (int8_t) dsym_read_uint(&cursor, 1);
+    uint8_t lineRange = (uint8_t) dsym_read_uint(&cursor, 1);
+    uint8_t opcodeBase = (uint8_t) dsym_read_uint(&cursor, 1);
+    if (cursor.overrun || lineRange == 0 || opcodeBase == 0)
+        goto cleanup;
+
+    uint8_t opcodeLengths[UINT8_MAX + 1] = { 0 };
+    for (unsigned int i = 1; i < opcodeBase; i++)
+        opcodeLengths[i] = (uint8_t) dsym_read_uint(&cursor, 1);
+
+    if (!dsym_builder_parse_line_files(builder, &cursor, &lineUnit, version, compDir, &directories, &directoryCount, &fileMap, &fileCount))
+        goto cleanup;
+
+    /* Run the line number program */
+    cursor.pos = programStart;
+    cursor.end = programEnd;
+
+    uint64_t address = 0;
+    uint64_t file = 1;
+    int64_t line = 1;
+    size_t sequenceStart = builder->line_count;
+
+#define DSYM_ROW_FILE (file < fileCount ? fileMap[file] : DSYM_NO_FILE)
+#define DSYM_ROW_LINE ((uint64_t) MAX(line, (int64_t) 0))
+
+    while (cursor.pos < cursor.end && !cursor.overrun) {
+        uint8_t opcode = (uint8_t) dsym_read_uint(&cursor, 1);
+
+        /* Special opcodes advance the address and line, and append a row */
+        if (opcode >= opcodeBase) {
+            uint8_t adjusted = opcode - opcodeBase;
+            address += (adjusted / lineRange) * minInstructionLength;
+            line += lineBase + (adjusted % lineRange);
+            if (!dsym_builder_add_line(builder, address, DSYM_ROW_FILE, DSYM_ROW_LINE))
+                goto cleanup;
+            continue;
+        }
+
+        switch (opcode) {
+            case 0: {
+                uint64_t extendedLength = dsym_read_uleb(&cursor);
+                if (cursor.overrun || extendedLength == 0 || extendedLength > (uint64_t) (cursor.end - cursor.pos))
+                    goto cleanup;
+
+                const uint8_t *next = cursor.pos + extendedLength;
+                uint8_t extended = (uint8_t) dsym_read_uint(&cursor, 1);
+
+                switch (extended) {
+                    case DW_LNE_end_sequence:
+                        /* Drop any rows that end the sequence without covering an address */
+                        while (builder->line_count > sequenceStart && builder->lines[builder->line_count - 1].address >= address)
+                            builder->line_count--;
+
+                        if (!dsym_builder_add_line(builder, address, DSYM_NO_FILE, 0))
+                            goto cleanup;
+                        sequenceStart = builder->line_count;
+                        address = 0;
+                        file = 1;
+                        line = 1;
+                        break;
+
+                    case DW_LNE_set_address:
+                        address = dsym_read_uint(&cursor, (size_t) MIN(extendedLength - 1, (uint64_t) 8));
+                        break;
+
+                    case DW_LNE_define_file: {
+                        const char *name = dsym_read_cstr(&cursor);
+                        uint64_t dir = dsym_read_uleb(&cursor);
+                        if (name == NULL)
+                            goto cleanup;
+
+                        uint32_t *newMap = realloc(fileMap, sizeof(uint32_t) * (fileCount + 1));
+                        if (newMap == NULL)
+                            goto cleanup;
+                        fileMap = newMap;
+
+                        const char *dirPath = (dir > 0 && dir < directoryCount) ? directories[dir] : NULL;
+                        fileMap[fileCount++] = dsym_builder_line_file(builder, compDir, dirPath, name);
+                        break;
+                    }
+
+                    default:
+                        break;
+                }
+
+                cursor.pos = next;
+                break;
+            }
+
+            case DW_LNS_copy:
+                if (!dsym_builder_add_line(builder, address, DSYM_ROW_FILE, DSYM_ROW_LINE))
+                    goto cleanup;
+                break;
+
+            case DW_LNS_advance_pc:
+                address += dsym_read_uleb(&cursor) * minInstructionLength;
+                break;
+
+            case DW_LNS_advance_line:
+                line += dsym_read_sleb(&cursor);
+                break;
+
+            case DW_LNS_set_file:
+                file = dsym_read_uleb(&cursor);
+                break;
+
+            case DW_LNS_const_add_pc:
+                address += ((255 - opcodeBase) / lineRange) * minInstructionLength;
+                break;
+
+            case DW_LNS_fixed_advance_pc:
+                address += dsym_read_uint(&cursor, 2);
+                break;
+
+            default:
+                /* Skip the operands of all other standard opcodes */
+                for (uint8_t i = 0; i < opcodeLengths[opcode]; i++)
+                    dsym_read_uleb(&cursor);
+                break;
+        }
+    }
+
+#undef DSYM_ROW_FILE
+#undef DSYM_ROW_LINE
+
+    result = !cursor.overrun;
+
+cleanup:
+    free(directories);
+    *outFileMap = fileMap;
+    *outFileCount = fileCount;
+    return result;
+}
+
+/*
+ * Read the unit headers of __debug_info, and parse each unit's abbreviation table.
+ */
+static bool dsym_builder_read_units (dsym_builder_t *builder) {
+    const dsym_dwarf_t *dwarf = builder->dwarf;
+    uint64_t offset = 0;
+
+    while (offset < dwarf->info.size) {
+        dsym_cursor_t cursor;
+        dsym_unit_t unit = { 0 };
+
+        dsym_cursor_init(&cursor, &dwarf->info, offset);
+        uint64_t length = dsym_read_initial_length(&cursor, &unit.offset_size);
+        uint64_t start = (uint64_t) (cursor.pos - dwarf->info.data);
+        if (cursor.overrun || length > dwarf->info.size - start)
+            break;
+
+        unit.offset = offset;
+        unit.end = start + length;
+        unit.version = (uint16_t) dsym_read_uint(&cursor, 2);
+
+        uint8_t unitType = 0;
+        if (unit.version >= 5) {
+            unitType = (uint8_t) dsym_read_uint(&cursor, 1);
+            unit.addr_size = (uint8_t) dsym_read_uint(&cursor, 1);
+            unit.abbrev_offset = dsym_read_uint(&cursor, unit.offset_size);
+
+            if (unitType == DW_UT_skeleton || unitType == DW_UT_split_compile) {
+                dsym_read_uint(&cursor, 8);
+            } else if (unitType == DW_UT_type || unitType == DW_UT_split_type) {
+                dsym_read_uint(&cursor, 8);
+                dsym_read_uint(&cursor, unit.offset_size);
+            }
+        } else {
+            unit.abbrev_offset = dsym_read_uint(&cursor, unit.offset_size);
+            unit.addr_size = (uint8_t) dsym_read_uint(&cursor, 1);
+        }
+
+        offset = unit.end;
+
+        /* Skip units we can't parse */
+        if (cursor.overrun || unit.version < 2 || unit.version > 5 || (unit.addr_size != 4 && unit.addr_size != 8))
+            continue;
+
+        unit.dies = (uint64_t) (cursor.pos - dwarf->info.data);
+
+        if (!dsym_reserve((void **) &builder->units, &builder->unit_capacity, builder->unit_count + 1, sizeof(dsym_unit_t)))
+            return false;
+        if (!dsym_reserve((void **) &builder->tables, &builder->table_capacity, builder->unit_count + 1, sizeof(dsym_abbrev_table_t)))
+            return false;
+
+        if (!dsym_abbrev_table_parse(dwarf, unit.abbrev_offset, &builder->tables[builder->unit_count])) {
+            dsym_abbrev_table_free(&builder->tables[builder->unit_count]);
+            continue;
+        }
+
+        builder->units[builder->unit_count++] = unit;
+    }
+
+    return true;
+}
+
+/*
+ * Append an entry for the range [@a start, @a end) to the function table or, if @a inlined is non-NULL, to the
+ * inline table, using @a inlined as the template for the entry.
+ */
+static bool dsym_builder_add_range (dsym_builder_t *builder, uint64_t start, uint64_t end, uint32_t name, const dsym_inline_t *inlined) {
+    /* Skip empty and dead-stripped ranges */
+    if (end <= start || start == 0 || end - start > UINT32_MAX)
+        return true;
+
+    if (inlined != NULL) {
+        /* Inline entries are referenced by 32-bit index */
+        if (builder->inline_count >= UINT32_MAX)
+            return true;
+
+        if (!dsym_reserve((void **) &builder->inlines, &builder->inline_capacity, builder->inline_count + 1, sizeof(dsym_inline_t)))
+            return false;
+
+        dsym_inline_t *entry = &builder->inlines[builder->inline_count++];
+        memset(entry, 0, sizeof(*entry));
+        entry->start = start;
+        entry->size = (uint32_t) (end - start);
+        entry->name = name;
+        entry->call_file = inlined->call_file;
+        entry->call_line = inlined->call_line;
+        entry->depth = inlined->depth;
+        return true;
+    }
+
+    if (!dsym_reserve((void **) &builder->functions, &builder->function_capacity, builder->function_count + 1, sizeof(dsym_function_t)))
+        return false;
+
+    dsym_function_t *function = &builder->functions[builder->function_count++];
+    memset(function, 0, sizeof(*function));
+    function->start = start;
+    function->size = (uint32_t) (end - start);
+    function->name = name;
+    return true;
+}
+
+/*
+ * Append an entry for each address range of the DW_AT_ranges @a value, as per dsym_builder_add_range().
+ */
+static bool dsym_builder_add_ranges (dsym_builder_t *builder, const dsym_unit_t *unit, const dsym_value_t *value, uint32_t name, const dsym_inline_t *inlined) {
+    const dsym_dwarf_t *dwarf = builder->dwarf;
+    uint64_t base = unit->low_pc;
+    dsym_cursor_t cursor;
+
+    /* Prior to DWARF 5, ranges are a list of address pairs within __debug_ranges */
+    if (unit->version < 5) {
+        uint64_t maxAddress = unit->addr_size == 8 ? UINT64_MAX : UINT32_MAX;
+        dsym_cursor_init(&cursor, &dwarf->ranges, value->data);
+
+        while (!cursor.overrun) {
+            uint64_t start = dsym_read_uint(&cursor, unit->addr_size);
+            uint64_t end = dsym_read_uint(&cursor, unit->addr_size);
+
+            if (cursor.overrun || (start == 0 && end == 0))
+                break;
+
+            if (start == maxAddress) {
+                base = end;
+            } else if (!dsym_builder_add_range(builder, base + start, base + end, name, inlined)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /* DWARF 5 range lists. Indexed lists are located via the offset table at the unit's range list base. */
+    uint64_t offset = value->data;
+    if (value->form == DW_FORM_rnglistx) {
+        dsym_cursor_init(&cursor, &dwarf->rnglists, unit->rnglists_base + offset * unit->offset_size);
+        offset = unit->rnglists_base + dsym_read_uint(&cursor, unit->offset_size);
+        if (cursor.overrun)
+            return true;
+    }
+
+    dsym_cursor_init(&cursor, &dwarf->rnglists, offset);
+    while (!cursor.overrun) {
+        uint8_t kind = (uint8_t) dsym_read_uint(&cursor, 1);
+        uint64_t start = 0;
+        uint64_t end = 0;
+
+        switch (kind) {
+            case DW_RLE_end_of_list:
+                return true;
+
+            case DW_RLE_base_addressx:
+                base = dsym_unit_addrx(dwarf, unit, dsym_read_uleb(&cursor));
+                continue;
+
+            case DW_RLE_base_address:
+                base = dsym_read_uint(&cursor, unit->addr_size);
+                continue;
+
+            case DW_RLE_startx_endx:
+                start = dsym_unit_addrx(dwarf, unit, dsym_read_uleb(&cursor));
+                end = dsym_unit_addrx(dwarf, unit, dsym_read_uleb(&cursor));
+                break;
+
+            case DW_RLE_startx_length:
+                start = dsym_unit_addrx(dwarf, unit, dsym_read_uleb(&cursor));
+                end = start + dsym_read_uleb(&cursor);
+                break;
+
+            case DW_RLE_offset_pair:
+                start = base + dsym_read_uleb(&cursor);
+                end = base + dsym_read_uleb(&cursor);
+                break;
+
+            case DW_RLE_start_end:
+                start = dsym_read_uint(&cursor, unit->addr_size);
+                end = dsym_read_uint(&cursor, unit->addr_size);
+                break;
+
+            case DW_RLE_start_length:
+                start = dsym_read_uint(&cursor, unit->addr_size);
+                end = start + dsym_read_uleb(&cursor);
+                break;
+
+            default:
+                return true;
+        }
+
+        if (!cursor.overrun && !dsym_builder_add_range(builder, start, end, name, inlined))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Walk all DIEs of @a unit, recording its subprograms and inlined subroutines, and parsing its line table.
+ */
+static bool dsym_builder_parse_unit (dsym_builder_t *builder, size_t unitIndex) {
+    const dsym_dwarf_t *dwarf = builder->dwarf;
+    dsym_unit_t *unit = &builder->units[unitIndex];
+    const dsym_abbrev_table_t *table = &builder->tables[unitIndex];
+    uint32_t *fileMap = NULL;
+    size_t fileCount = 0;
+    bool result = true;
+    dsym_cursor_t cursor;
+
+    /* The unit DIE's string and address bases must be known before any of its indexed forms may be read, and
+     * so the unit DIE is read twice. */
+    const dsym_abbrev_t *abbrev;
+    for (int pass = 0; pass < 2; pass++) {
+        dsym_cursor_init(&cursor, &dwarf->info, unit->dies);
+        cursor.end = dwarf->info.data + unit->end;
+
+        if ((abbrev = dsym_abbrev_find(table, dsym_read_uleb(&cursor))) == NULL)
+            goto cleanup;
+
+        const char *compDir = NULL;
+        uint64_t stmtList = UINT64_MAX;
+
+        for (size_t i = 0; i < abbrev->count; i++) {
+            const dsym_attr_spec_t *spec = &table->specs[abbrev->spec + i];
+            dsym_value_t value;
+
+            /* Indexed values read in the first pass are ignored */
+            if (!dsym_read_value(&cursor, dwarf, unit, spec->form, spec->implicit_const, &value))
+                goto cleanup;
+
+            switch (spec->name) {
+                case DW_AT_str_offsets_base:
+                    unit->str_offsets_base = value.data;
+                    break;
+                case DW_AT_addr_base:
+                    unit->addr_base = value.data;
+                    break;
+                case DW_AT_rnglists_base:
+                    unit->rnglists_base = value.data;
+                    break;
+                case DW_AT_low_pc:
+                    unit->low_pc = value.data;
+                    break;
+                case DW_AT_comp_dir:
+                    compDir = value.string;
+                    break;
+                case DW_AT_stmt_list:
+                    stmtList = value.data;
+                    break;
+            }
+        }
+
+        /* A malformed line table is skipped; any rows appended prior to the error are retained */
+        if (pass == 1 && stmtList != UINT64_MAX)
+            dsym_builder_parse_lines(builder, unit, stmtList, compDir, &fileMap, &fileCount);
+    }
+
+    /* The number of inlined subroutines enclosing each open DIE, indexed by DIE depth. The unit DIE is at
+     * depth 0. */
+    uint32_t inlineDepth[DSYM_DIE_DEPTH_MAX];
+    size_t depth = abbrev->children ? 1 : 0;
+    inlineDepth[0] = 0;
+
+    /* Record all subprograms and inlined subroutines with an address range. The names of functions declared
+     * elsewhere are resolved via their specification or abstract origin. */
+    while (cursor.pos < cursor.end && !cursor.overrun && depth > 0) {
+        uint64_t code = dsym_read_uleb(&cursor);
+        if (code == 0) {
+            depth--;
+            continue;
+        }
+
+        if ((abbrev = dsym_abbrev_find(table, code)) == NULL)
+            goto cleanup;
+
+        bool isFunction = (abbrev->tag == DW_TAG_subprogram);
+        bool isInline = (abbrev->tag == DW_TAG_inlined_subroutine);
+        uint32_t enclosing = depth <= DSYM_DIE_DEPTH_MAX ? inlineDepth[depth - 1] : UINT32_MAX;
+
+        const char *name = NULL;
+        const char *linkage = NULL;
+        uint64_t origin = 0;
+        uint64_t lowPC = 0;
+        uint64_t highPC = 0;
+        bool hasLowPC = false;
+        bool hasHighPC = false;
+        bool highIsOffset = false;
+        dsym_value_t ranges = { 0, 0, NULL };
+        bool hasRanges = false;
+        uint64_t callFile = 0;
+        uint64_t callLine = 0;
+
+        for (size_t i = 0; i < abbrev->count; i++) {
+            const dsym_attr_spec_t *spec = &table->specs[abbrev->spec + i];
+            dsym_value_t value;
+            if (!dsym_read_value(&cursor, dwarf, unit, spec->form, spec->implicit_const, &value))
+                goto cleanup;
+
+            if (!isFunction && !isInline)
+                continue;
+
+            switch (spec->name) {
+                case DW_AT_name:
+                    name = value.string;
+                    break;
+                case DW_AT_linkage_name:
+                case DW_AT_MIPS_linkage_name:
+                    linkage = value.string;
+                    break;
+                case DW_AT_specification:
+                case DW_AT_abstract_origin:
+                    origin = value.data;
+                    break;
+                case DW_AT_low_pc:
+                    lowPC = value.data;
+                    hasLowPC = true;
+                    break;
+                case DW_AT_high_pc:
+                    highPC = value.data;
+                    hasHighPC = true;
+
+                    /* Since DWARF 4, a constant high PC is an offset from the low PC */
+                    highIsOffset = (value.form != DW_FORM_addr && (value.form < DW_FORM_addrx1 || value.form > DW_FORM_addrx4) && value.form != DW_FORM_addrx);
+                    break;
+                case DW_AT_ranges:
+                    ranges = value;
+                    hasRanges = true;
+                    break;
+                case DW_AT_call_file:
+                    callFile = value.data;
+                    break;
+                case DW_AT_call_line:
+                    callLine = value.data;
+                    break;
+            }
+        }
+
+        /* Track the inline nesting of the DIE's children */
+        if (abbrev->children) {
+            if (depth < DSYM_DIE_DEPTH_MAX)
+                inlineDepth[depth] = (isInline && enclosing != UINT32_MAX) ? enclosing + 1 : enclosing;
+            depth++;
+        }
+
+        if ((!isFunction && !isInline) || (!(hasLowPC && hasHighPC) && !hasRanges))
+            continue;
+
+        /* Inlined subroutines nested beyond the tracked depth are not recorded */
+        if (isInline && enclosing == UINT32_MAX)
+            continue;
+
+        uint32_t nameOffset;
+        if (name != NULL || linkage != NULL)
+            nameOffset = dsym_builder_add_name(builder, name, linkage);
+        else if (origin != 0)
+            nameOffset = dsym_builder_resolve_name(builder, origin);
+        else
+            continue;
+
+        if (nameOffset == UINT32_MAX)
+            continue;
+
+        dsym_inline_t inlined;
+        memset(&inlined, 0, sizeof(inlined));
+        inlined.call_file = callFile < fileCount ? fileMap[callFile] : DSYM_NO_FILE;
+        inlined.call_line = (uint32_t) MIN(callLine, (uint64_t) UINT32_MAX);
+        inlined.depth = enclosing;
+
+        bool added;
+        if (hasLowPC && hasHighPC)
+            added = dsym_builder_add_range(builder, lowPC, highIsOffset ? lowPC + highPC : highPC, nameOffset, isInline ? &inlined : NULL);
+        else
+            added = dsym_builder_add_ranges(builder, unit, &ranges, nameOffset, isInline ? &inlined : NULL);
+
+        if (!added) {
+            result = false;
+            goto cleanup;
+        }
+    }
+
+cleanup:
+    free(fileMap);
+    return result;
+}
+
+static int dsym_function_compare (const void *lhs, const void *rhs) {
+    const dsym_function_t *a = lhs;
+    const dsym_function_t *b = rhs;
+
+    if (a->start != b->start)
+        return a->start < b->start ? -1 : 1;
+
+    /* Prefer the larger range for identical start addresses */
+    if (a->size != b->size)
+        return a->size > b->size ? -1 : 1;
+
+    return 0;
+}
+
+static int dsym_inline_compare (const void *lhs, const void *rhs) {
+    const dsym_inline_t *a = lhs;
+    const dsym_inline_t *b = rhs;
+
+    if (a->start != b->start)
+        return a->start < b->start ? -1 : 1;
+
+    /* Outer subroutines precede those inlined into them */
+    if (a->depth != b->depth)
+        return a->depth < b->depth ? -1 : 1;
+
+    return 0;
+}
+
+static int dsym_line_compare (const void *lhs, const void *rhs) {
+    const dsym_line_t *a = lhs;
+    const dsym_line_t *b = rhs;
+
+    if (a->address != b->address)
+        return a->address < b->address ? -1 : 1;
+
+    /* A sequence that begins where another ends takes precedence over the terminating row */
+    bool aEnd = (a->file == DSYM_NO_FILE && a->line == 0);
+    bool bEnd = (b->file == DSYM_NO_FILE && b->line == 0);
+    if (aEnd != bEnd)
+        return aEnd ? -1 : 1;
+
+    return 0;
+}
+
+/**
+ * Build the symbol index of @a dwarf.
+ *
+ * @param dwarf The debug file's DWARF sections. The sections need only remain mapped for the duration of the call.
+ * @param index The index to be initialized. On success, the index must be freed via dsym_index_free().
+ *
+ * @return Returns true on success, or false if the index could not be allocated. Malformed units and line tables
+ * are skipped, and do not cause the build to fail.
+ */
+bool dsym_index_build (const dsym_dwarf_t *dwarf, dsym_index_t *index) {
+    dsym_builder_t builder = { 0 };
+    bool result = false;
+
+    memset(index, 0, sizeof(*index));
+    builder.dwarf = dwarf;
+    builder.demangle = (dsym_demangle_fn) dlsym(RTLD_DEFAULT, "__cxa_demangle");
+
+    if (!dsym_builder_read_units(&builder))
+        goto cleanup;
+
+    for (size_t i = 0; i < builder.unit_count; i++) {
+        if (!dsym_builder_parse_unit(&builder, i))
+            goto cleanup;
+    }
+
+    /* Sort the functions, dropping overlapping entries. Overlaps only arise from ICF-folded functions
+     * sharing a single range; the first entry is used for all of them. */
+    if (builder.function_count > 0)
+        qsort(builder.functions, builder.function_count, sizeof(dsym_function_t), dsym_function_compare);
+
+    size_t functionCount = 0;
+    for (size_t i = 0; i < builder.function_count; i++) {
+        const dsym_function_t *function = &builder.functions[i];
+        if (functionCount > 0) {
+            const dsym_function_t *prev = &builder.functions[functionCount - 1];
+            if (function->start < prev->start + prev->size)
+                continue;
+        }
+
+        builder.functions[functionCount++] = *function;
+    }
+
+    /* Sort the inline table, and assign each function the contiguous run of entries within its range */
+    if (builder.inline_count > 0)
+        qsort(builder.inlines, builder.inline_count, sizeof(dsym_inline_t), dsym_inline_compare);
+
+    size_t inlineIndex = 0;
+    for (size_t i = 0; i < functionCount; i++) {
+        dsym_function_t *function = &builder.functions[i];
+        uint64_t end = function->start + function->size;
+
+        while (inlineIndex < builder.inline_count && builder.inlines[inlineIndex].start < function->start)
+            inlineIndex++;
+
+        size_t first = inlineIndex;
+        while (inlineIndex < builder.inline_count && builder.inlines[inlineIndex].start < end)
+            inlineIndex++;
+
+        function->inline_first = (uint32_t) first;
+        function->inline_count = (uint32_t) (inlineIndex - first);
+    }
+
+    /* Sort the line table, preserving program order for rows with the same address, and merge adjacent rows
+     * that share a file and line */
+    if (builder.line_count > 0 && mergesort(builder.lines, builder.line_count, sizeof(dsym_line_t), dsym_line_compare) != 0)
+        goto cleanup;
+
+    size_t lineCount = 0;
+    for (size_t i = 0; i < builder.line_count; i++) {
+        const dsym_line_t *row = &builder.lines[i];
+
+        if (lineCount > 0) {
+            dsym_line_t *prev = &builder.lines[lineCount - 1];
+            if (prev->address == row->address) {
+                *prev = *row;
+                continue;
+            }
+
+            if (prev->file == row->file && prev->line == row->line)
+                continue;
+        }
+
+        builder.lines[lineCount++] = *row;
+    }
+
+    index->functions = builder.functions;
+    index->function_count = functionCount;
+    index->inlines = builder.inlines;
+    index->inline_count = builder.inline_count;
+    index->lines = builder.lines;
+    index->line_count = lineCount;
+    index->files = builder.files;
+    index->file_count = builder.file_count;
+    index->strings = builder.strings;
+    index->strings_length = builder.strings_length;
+
+    builder.functions = NULL;
+    builder.inlines = NULL;
+    builder.lines = NULL;
+    builder.files = NULL;
+    builder.strings = NULL;
+    result = true;
+
+cleanup:
+    for (size_t i = 0; i < builder.unit_count; i++)
+        dsym_abbrev_table_free(&builder.tables[i]);
+
+    free(builder.units);
+    free(builder.tables);
+    free(builder.functions);
+    free(builder.inlines);
+    free(builder.lines);
+    free(builder.files);
+    free(builder.strings);
+    free(builder.file_hash);
+
+    return result;
+}
+
+/* Index file magic, written in host byte order; a byte-swapped magic identifies a file of the wrong byte order */
+#define DSYM_INDEX_FILE_MAGIC 0x4d59534c /* 'LSYM' */
+
+/* Index file format version. Must be incremented for any change to the layout of the file or its tables. */
+#define DSYM_INDEX_FILE_VERSION 1
+
+/* Alignment of each table within an index file */
+#define DSYM_INDEX_FILE_ALIGN 8
+
+/* The location of a single table within an index file */
+typedef struct dsym_index_file_table {
+    uint64_t offset;
+    uint64_t count;
+} dsym_index_file_table_t;
+
+/* Index file header. The tables follow the header, in their in-memory layout. */
+typedef struct dsym_index_file_header {
+    uint32_t magic;
+    uint32_t version;
+    uint8_t uuid[16];
+    uint64_t text_address;
+
+    dsym_index_file_table_t functions;
+    dsym_index_file_table_t inlines;
+    dsym_index_file_table_t lines;
+    dsym_index_file_table_t files;
+    dsym_index_file_table_t strings;
+} dsym_index_file_header_t;
+
+/*
+ * Write @a length bytes of @a data to @a fd, retrying on short writes. Returns false on error.
+ */
+static bool dsym_write_fully (int fd, const void *data, size_t length) {
+    const uint8_t *p = data;
+    while (length > 0) {
+        ssize_t written = write(fd, p, length);
+        if (written < 0)
+            return false;
+
+        p += written;
+        length -= (size_t) written;
+    }
+    return true;
+}
+
+/*
+ * Assign @a table the aligned file offset at @a *offset for @a count elements of @a size bytes, and advance
+ * @a offset past the table.
+ */
+static void dsym_index_file_layout (dsym_index_file_table_t *table, uint64_t *offset, size_t count, size_t size) {
+    *offset = (*offset + DSYM_INDEX_FILE_ALIGN - 1) & ~((uint64_t) DSYM_INDEX_FILE_ALIGN - 1);
+    table->offset = *offset;
+    table->count = count;
+    *offset += (uint64_t) count * size;
+}
+
+/*
+ * Write the table described by @a table, padding from the current file offset @a *position as necessary.
+ */
+static bool dsym_index_file_write_table (int fd, const dsym_index_file_table_t *table, uint64_t *position, const void *data, size_t size) {
+    static const uint8_t padding[DSYM_INDEX_FILE_ALIGN] = { 0 };
+
+    if (!dsym_write_fully(fd, padding, (size_t) (table->offset - *position)))
+        return false;
+
+    size_t length = (size_t) table->count * size;
+    if (length > 0 && !dsym_write_fully(fd, data, length))
+        return false;
+
+    *position = table->offset + length;
+    return true;
+}
+
+/**
+ * Write @a index to an index file at @a path, from which it may later be mapped via dsym_index_map().
+ *
+ * The file is written to a temporary file in the same directory and atomically moved into place, and so
+ * concurrent writers of the same index (for example, workers sharing a cache directory) will not observe or
+ * produce a partially written file.
+ *
+ * @param index The index to write. The caller must have populated the index's UUID and text address.
+ * @param path The destination path.
+ *
+ * @return Returns true on success, or false if the file could not be written.
+ */
+bool dsym_index_write (const dsym_index_t *index, const char *path) {
+    dsym_index_file_header_t header;
+    uint64_t offset = sizeof(header);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = DSYM_INDEX_FILE_MAGIC;
+    header.version = DSYM_INDEX_FILE_VERSION;
+    memcpy(header.uuid, index->uuid, sizeof(header.uuid));
+    header.text_address = index->text_address;
+
+    dsym_index_file_layout(&header.functions, &offset, index->function_count, sizeof(dsym_function_t));
+    dsym_index_file_layout(&header.inlines, &offset, index->inline_count, sizeof(dsym_inline_t));
+    dsym_index_file_layout(&header.lines, &offset, index->line_count, sizeof(dsym_line_t));
+    dsym_index_file_layout(&header.files, &offset, index->file_count, sizeof(uint32_t));
+    dsym_index_file_layout(&header.strings, &offset, index->strings_length, sizeof(char));
+
+    char tempPath[PATH_MAX];
+    if (snprintf(tempPath, sizeof(tempPath), "%s.XXXXXX", path) >= (int) sizeof(tempPath))
+        return false;
+
+    int fd = mkstemp(tempPath);
+    if (fd < 0)
+        return false;
+
+    uint64_t position = sizeof(header);
+    bool result = dsym_write_fully(fd, &header, sizeof(header)) &&
+        dsym_index_file_write_table(fd, &header.functions, &position, index->functions, sizeof(dsym_function_t)) &&
+        dsym_index_file_write_table(fd, &header.inlines, &position, index->inlines, sizeof(dsym_inline_t)) &&
+        dsym_index_file_write_table(fd, &header.lines, &position, index->lines, sizeof(dsym_line_t)) &&
+        dsym_index_file_write_table(fd, &header.files, &position, index->files, sizeof(uint32_t)) &&
+        dsym_index_file_write_table(fd, &header.strings, &position, index->strings, sizeof(char));
+
+    /* mkstemp() creates the file with mode 0600; the index is not sensitive, and may be shared */
+    if (result)
+        result = (fchmod(fd, 0644) == 0);
+
+    if (close(fd) != 0)
+        result = false;
+
+    if (result)
+        result = (rename(tempPath, path) == 0);
+
+    if (!result)
+        unlink(tempPath);
+
+    return result;
+}
+
+/*
+ * Validate that the table described by @a table lies within a file of @a fileSize bytes, returning a pointer to
+ * the table within @a mapping, or NULL if invalid.
+ */
+static const void *dsym_index_file_table (const uint8_t *mapping, uint64_t fileSize, const dsym_index_file_table_t *table, size_t size) {
+    if (table->offset % DSYM_INDEX_FILE_ALIGN != 0 || table->offset > fileSize || table->count > SIZE_MAX / size)
+        return NULL;
+
+    if (table->count > (fileSize - table->offset) / size)
+        return NULL;
+
+    return mapping + table->offset;
+}
+
+/**
+ * Map the index file at @a path, written by dsym_index_write(). The tables are used in place, and are paged in
+ * on demand; no parsing is performed.
+ *
+ * The file's structure is validated, but the contents of its tables are not; all string and file lookups should
+ * be performed via dsym_index_string() and dsym_index_file(), which are bounds checked.
+ *
+ * @param path The index file path.
+ * @param uuid The expected debug file UUID.
+ * @param index The index to be initialized. On success, the index must be freed via dsym_index_free().
+ *
+ * @return Returns true on success, or false if the file does not exist, was written for a different UUID, byte
+ * order, or format version, or is malformed.
+ */
+bool dsym_index_map (const char *path, const uint8_t uuid[16], dsym_index_t *index) {
+    dsym_index_file_header_t header;
+    struct stat sb;
+
+    memset(index, 0, sizeof(*index));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    if (fstat(fd, &sb) != 0 || sb.st_size < (off_t) sizeof(header) || (uint64_t) sb.st_size > SIZE_MAX) {
+        close(fd);
+        return false;
+    }
+
+    uint64_t fileSize = (uint64_t) sb.st_size;
+    void *mapping = mmap(NULL, (size_t) fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+        return false;
+
+    memcpy(&header, mapping, sizeof(header));
+    if (header.magic != DSYM_INDEX_FILE_MAGIC || header.version != DSYM_INDEX_FILE_VERSION || memcmp(header.uuid, uuid, sizeof(header.uuid)) != 0)
+        goto error;
+
+    index->functions = (dsym_function_t *) dsym_index_file_table(mapping, fileSize, &header.functions, sizeof(dsym_function_t));
+    index->inlines = (dsym_inline_t *) dsym_index_file_table(mapping, fileSize, &header.inlines, sizeof(dsym_inline_t));
+    index->lines = (dsym_line_t *) dsym_index_file_table(mapping, fileSize, &header.lines, sizeof(dsym_line_t));
+    index->files = (uint32_t *) dsym_index_file_table(mapping, fileSize, &header.files, sizeof(uint32_t));
+    index->strings = (char *) dsym_index_file_table(mapping, fileSize, &header.strings, sizeof(char));
+
+    if (index->functions == NULL || index->inlines == NULL || index->lines == NULL || index->files == NULL || index->strings == NULL)
+        goto error;
+
+    /* The string table must be NUL-terminated for bounds-checked lookups to be safe */
+    if (header.strings.count > 0 && index->strings[header.strings.count - 1] != '\0')
+        goto error;
+
+    memcpy(index->uuid, header.uuid, sizeof(index->uuid));
+    index->text_address = header.text_address;
+    index->function_count = (size_t) header.functions.count;
+    index->inline_count = (size_t) header.inlines.count;
+    index->line_count = (size_t) header.lines.count;
+    index->file_count = (size_t) header.files.count;
+    index->strings_length = (size_t) header.strings.count;
+    index->mapping = mapping;
+    index->mapping_size = (size_t) fileSize;
+    return true;
+
+error:
+    munmap(mapping, (size_t) fileSize);
+    memset(index, 0, sizeof(*index));
+    return false;
+}
+
+/**
+ * Free all resources associated with @a index.
+ */
+void dsym_index_free (dsym_index_t *index) {
+    if (index->mapping != NULL) {
+        munmap(index->mapping, index->mapping_size);
+        return;
+    }
+
+    free(index->functions);
+    free(index->inlines);
+    free(index->lines);
+    free(index->files);
+    free(index->strings);
+}
+
+/**
+ * Return the function containing @a address, or NULL if none.
+ *
+ * @param index The index to search.
+ * @param address The link-time address to look up.
+ */
+const dsym_function_t *dsym_index_find_function (const dsym_index_t *index, uint64_t address) {
+    size_t lo = 0;
+    size_t hi = index->function_count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->functions[mid].start <= address)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0)
+        return NULL;
+
+    const dsym_function_t *function = &index->functions[lo - 1];
+    if (address - function->start >= function->size)
+        return NULL;
+
+    return function;
+}
+
+/**
+ * Return the line table row covering @a address, or NULL if the address is not covered by any line table sequence.
+ *
+ * @param index The index to search.
+ * @param address The link-time address to look up.
+ */
+const dsym_line_t *dsym_index_find_line (const dsym_index_t *index, uint64_t address) {
+    size_t lo = 0;
+    size_t hi = index->line_count;
+
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->lines[mid].address <= address)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    if (lo == 0 || index->lines[lo - 1].file == DSYM_NO_FILE)
+        return NULL;
+
+    return &index->lines[lo - 1];
+}
+
+/**
+ * Find the inlined subroutines of @a function containing @a address, writing up to @a max entries to @a chain,
+ * ordered from the outermost to the innermost.
+ *
+ * The innermost entry is the function executing at @a address, called from the call site of its entry; each
+ * entry's call site lies within the preceding entry, or for the first entry, within @a function.
+ *
+ * @param index The index to search.
+ * @param function The function containing @a address, as returned by dsym_index_find_function().
+ * @param address The link-time address to look up.
+ * @param chain The destination for the found entries.
+ * @param max The maximum number of entries to be written to @a chain.
+ *
+ * @return Returns the number of entries written to @a chain.
+ */
+size_t dsym_index_find_inlines (const dsym_index_t *index, const dsym_function_t *function, uint64_t address,
+                                const dsym_inline_t **chain, size_t max)
+{
+    size_t count = 0;
+
+    /* Entries from a mapped index are untrusted */
+    if (function->inline_first > index->inline_count || function->inline_count > index->inline_count - function->inline_first)
+        return 0;
+
+    /* Entries are sorted by start address, and so the enclosing entries of any address are found in order of
+     * depth; only entries that start at or before the address need be considered. */
+    for (size_t i = function->inline_first; i < function->inline_first + function->inline_count; i++) {
+        const dsym_inline_t *entry = &index->inlines[i];
+        if (entry->start > address)
+            break;
+
+        if (address - entry->start >= entry->size)
+            continue;
+
+        /* A subroutine with multiple ranges may be followed by a deeper entry from an earlier range; discard any
+         * entries that do not enclose this one */
+        while (count > 0 && chain[count - 1]->depth >= entry->depth)
+            count--;
+
+        if (count < max)
+            chain[count++] = entry;
+    }
+
+    return count;
+}
+
+/**
+ * Return the string at @a offset within the string table of @a index, or NULL if @a offset is out of range.
+ */
+const char *dsym_index_string (const dsym_index_t *index, uint32_t offset) {
+    if (offset >= index->strings_length)
+        return NULL;
+
+    return index->strings + offset;
+}
+
+/**
+ * Return the path of @a file within the file table of @a index, or NULL if @a file is out of range.
+ */
+const char *dsym_index_file (const dsym_index_t *index, uint32_t file) {
+    if (file >= index->file_count)
+        return NULL;
+
+    return dsym_index_string(index, index->files[file]);
+}
+
+/**
+ * @}
+ */
@@ -0,0 +1,219 @@
+/*
+ * Author: Landon Fuller <landonf@plausible.coop>
+ *
+ * Copyright (c) 2012-2013 Plausible Labs Cooperative, Inc.
+ * All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef PLCRASH_DSYM_INDEX_H
+#define PLCRASH_DSYM_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * File index used for line table rows that terminate a sequence.
+ */
+#define DSYM_NO_FILE UINT32_MAX
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * A mapped DWARF section.
+ */
+typedef struct dsym_section {
+    /** The section data. */
+    const uint8_t *data;
+
+    /** The section size, in bytes. */
+    uint64_t size;
+} dsym_section_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * The DWARF sections of a single debug file slice. Absent sections have a size of 0.
+ */
+typedef struct dsym_dwarf {
+    dsym_section_t info;
+    dsym_section_t abbrev;
+    dsym_section_t line;
+    dsym_section_t str;
+    dsym_section_t line_str;
+    dsym_section_t str_offsets;
+    dsym_section_t addr;
+    dsym_section_t ranges;
+    dsym_section_t rnglists;
+} dsym_dwarf_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * A function's address range. Addresses are the link-time addresses of the debug file.
+ */
+typedef struct dsym_function {
+    /** The function's start address. */
+    uint64_t start;
+
+    /** The size of the function's code, in bytes. */
+    uint32_t size;
+
+    /** Offset of the function's name within the index string table. */
+    uint32_t name;
+
+    /** Index of the first inline table entry within the function's range. */
+    uint32_t inline_first;
+
+    /** The number of inline table entries within the function's range. */
+    uint32_t inline_count;
+} dsym_function_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * The address range of an inlined subroutine.
+ */
+typedef struct dsym_inline {
+    /** The range's start address. */
+    uint64_t start;
+
+    /** The size of the range, in bytes. */
+    uint32_t size;
+
+    /** Offset of the inlined function's name within the index string table. */
+    uint32_t name;
+
+    /** The file of the call site into which the function was inlined, as an index into the index file table,
+     * or DSYM_NO_FILE. */
+    uint32_t call_file;
+
+    /** The line number of the call site, or 0 if unknown. */
+    uint32_t call_line;
+
+    /** The number of inlined subroutines enclosing this one; 0 if inlined directly into a function. */
+    uint32_t depth;
+
+    /** Reserved; always 0. */
+    uint32_t reserved;
+} dsym_inline_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * A line table row. The row applies from its address to the address of the next row; rows that terminate a
+ * sequence have a file of DSYM_NO_FILE.
+ */
+typedef struct dsym_line {
+    /** The row's start address. */
+    uint64_t address;
+
+    /** The row's file, as an index into the index file table. */
+    uint32_t file;
+
+    /** The row's line number, or 0 if unknown. */
+    uint32_t line;
+} dsym_line_t;
+
+/**
+ * @internal
+ * @ingroup plcrash_dsym_index
+ *
+ * The sorted symbol index of a debug file. All tables are flat arrays, and all strings are stored in a single
+ * string table; the index does not reference the DWARF data from which it was built, and may be written to and
+ * mapped from an index file in its in-memory layout.
+ */
+typedef struct dsym_index {
+    /** The UUID of the debug file slice. Not populated by dsym_index_build(); the caller must set the UUID
+     * prior to writing the index. */
+    uint8_t uuid[16];
+
+    /** The link-time address of the slice's __TEXT segment, used to map image addresses to the link-time
+     * addresses of the tables. As with @a uuid, this must be set by the caller. */
+    uint64_t text_address;
+
+    /** The function table, sorted by start address. Ranges do not overlap. */
+    dsym_function_t *functions;
+
+    /** The number of entries in @a functions. */
+    size_t function_count;
+
+    /** The inline table, sorted by start address and then depth. */
+    dsym_inline_t *inlines;
+
+    /** The number of entries in @a inlines. */
+    size_t inline_count;
+
+    /** The line table, sorted by address. */
+    dsym_line_t *lines;
+
+    /** The number of entries in @a lines. */
+    size_t line_count;
+
+    /** File path string table offsets, indexed by dsym_line_t::file. */
+    uint32_t *files;
+
+    /** The number of entries in @a files. */
+    size_t file_count;
+
+    /** NUL-terminated function names and file paths. */
+    char *strings;
+
+    /** The size of @a strings, in bytes. */
+    size_t strings_length;
+
+    /** If the index was mapped from an index file, the mapping and its size. Otherwise, NULL. */
+    void *mapping;
+    size_t mapping_size;
+} dsym_index_t;
+
+bool dsym_index_build (const dsym_dwarf_t *dwarf, dsym_index_t *index);
+bool dsym_index_write (const dsym_index_t *index, const char *path);
+bool dsym_index_map (const char *path, const uint8_t uuid[16], dsym_index_t *index);
+void dsym_index_free (dsym_index_t *index);
+
+const dsym_function_t *dsym_index_find_function (const dsym_index_t *index, uint64_t address);
+const dsym_line_t *dsym_index_find_line (const dsym_index_t *index, uint64_t address);
+size_t dsym_index_find_inlines (const dsym_index_t *index, const dsym_function_t *function, uint64_t address,
+                                const dsym_inline_t **chain, size_t max);
+
+const char *dsym_index_string (const dsym_index_t *index, uint32_t offset);
+const char *dsym_index_file (const dsym_index_t *index, uint32_t file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PLCRASH_DSYM_INDEX_H */
@@ -32,6 +32,16 @@
 #import <stdlib.h>
 #import <stdio.h>
 #import <getopt.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <pthread.h>
+#import <libkern/OSAtomic.h>
+#import <libkern/OSByteOrder.h>
+#import <mach-o/loader.h>
+#import <mach-o/fat.h>
+
+#import "PLCrashDSYMIndex.h"
+#import "PLCrashSymbolDemangler.h"
 
 /*
  * Print command line usage.
@@ -39,11 +49,454 @@
 void print_usage () {
     fprintf(stderr, "Usage: plcrashutil <command> <options>\n"
                     "Commands:\n"
-                    "  convert --format=<format> <file>\n"
-                    "      Covert a plcrash file to the given format.\n\n"
+                    "  convert --format=<format> [--demangle] <input> [<input> ...]\n"
+                    "      Covert one or more plcrash reports to the given format. Each input may be a\n"
+                    "      plcrash file, a report archive, a directory of .plcrash files, or '-' to read from\n"
+                    "      standard input.\n"
+                    "      Files and standard input may contain multiple concatenated reports.\n"
+                    "      If --demangle is given, C++ and Swift symbol names are demangled.\n\n"
+                    "  batch --format=<format> --output=<directory> [--demangle] [--jobs=<count>] <directory>\n"
+                    "      Convert all .plcrash files in a directory in parallel, writing each converted\n"
+                    "      report to a .crash (or, for JSON, .ndjson) file of the same name in the output\n"
+                    "      directory.\n\n"
                     "      Supported formats:\n"
                     "        ios - Standard Apple iOS-compatible text crash log\n"
-                    "        iphone - Synonym for 'iOS'.\n");
+                    "        iphone - Synonym for 'iOS'.\n"
+                    "        json - Structured JSON; one report object per line (NDJSON)\n"
+                    "        summary - Abbreviated summary of the crashed thread\n\n"
+                    "  profile --format=<format> [--output=<file>] [--jobs=<count>] <input> [<input> ...]\n"
+                    "      Aggregate the hang samples of all reports in the given files or directories into a\n"
+                    "      single profile, symbolicated using the symbols recorded across all reports.\n\n"
+                    "      Supported formats:\n"
+                    "        collapsed - Collapsed stack text, as used by flamegraph.pl (default)\n"
+                    "        pprof - Uncompressed pprof profile.proto\n\n"
+                    "  bucket [--top=<count>] [--frames=<count>] [--jobs=<count>] <input> [<input> ...]\n"
+                    "      Group the reports in the given files or directories by crash fingerprint, without\n"
+                    "      decoding the reports, and list the <count> largest buckets (default 20; 0 for all)\n"
+                    "      with their report count, fingerprint, and a representative report. The fingerprint\n"
+                    "      covers the top --frames frames of the crashed thread (default 5).\n\n"
+                    "  trace <input> [<input> ...]\n"
+                    "      Print the crash reporter's own debug trace events recorded in each report in the given\n"
+                    "      files, or '-' to read from standard input, oldest first.\n\n"
+                    "  symbolicate [--dsym=<path> ...] [--cache=<directory>] [--demangle] [--output=<file>] [--jobs=<count>]\n"
+                    "              <input> [<input> ...]\n"
+                    "      Symbolicate the backtraces of all reports in the given files or directories using the\n"
+                    "      DWARF debug information of the given dSYM bundles, debug files, or directories\n"
+                    "      containing dSYM bundles. Images are matched by UUID.\n"
+                    "      If a cache directory is given, the symbol index of each debug file is written to the\n"
+                    "      cache on first use and mapped directly by later runs; images with a cached index\n"
+                    "      are symbolicated even if their debug file is not supplied.\n"
+                    "      If --demangle is given, symbol names recorded in the reports are demangled.\n\n"
+                    "  pack --output=<archive> <input> [<input> ...]\n"
+                    "      Pack the reports in the given files or directories into a single indexed archive.\n\n"
+                    "  unpack --output=<directory> <archive>\n"
+                    "      Unpack all reports in an archive to individual .plcrash files.\n");
+}
+
+/* Size of the reads performed when streaming reports from a file descriptor */
+#define READER_CHUNK_SIZE (64 * 1024)
+
+/* Protobuf wire types */
+#define WIRETYPE_VARINT 0
+#define WIRETYPE_64BIT 1
+#define WIRETYPE_LENGTH_PREFIXED 2
+#define WIRETYPE_32BIT 5
+
+/*
+ * Report reader state. Reports are read either from a memory mapped file, or from a stream via a
+ * read buffer that is shared across readers; the buffer only grows to the size of the largest
+ * single report, regardless of the total size of the input.
+ */
+typedef struct report_reader {
+    /* The source stream, or NULL if reading from @a mapped. */
+    FILE *input;
+
+    /* The mapped file data, or nil if reading from @a input. */
+    NSData *mapped;
+
+    /* The read buffer (stream input only). */
+    NSMutableData *buffer;
+
+    /* Offset of the next report within the buffer or mapped data. */
+    size_t offset;
+
+    /* True once all data has been read from @a input. */
+    bool eof;
+} report_reader_t;
+
+/*
+ * Read a varint at @a pos. Returns 1 on success, 0 if the value is truncated, or -1 if the value is malformed.
+ */
+static int read_varint (const uint8_t *bytes, size_t avail, size_t *pos, uint64_t *result) {
+    uint64_t value = 0;
+
+    for (unsigned int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= avail)
+            return 0;
+
+        uint8_t byte = bytes[(*pos)++];
+        value |= ((uint64_t) (byte & 0x7F)) << shift;
+        if ((byte & 0x80) == 0) {
+            *result = value;
+            return 1;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Read an LZ4 length continuation from @a bytes at @a pos, adding it to @a length.
+ *
+ * Returns 1 on success, or 0 if more data is required.
+ */
+static int read_lz4_length (const uint8_t *bytes, size_t avail, size_t *pos, size_t *length) {
+    uint8_t byte;
+    do {
+        if (*pos >= avail)
+            return 0;
+        byte = bytes[(*pos)++];
+        *length += byte;
+    } while (byte == 255);
+
+    return 1;
+}
+
+/*
+ * Determine the length of the compressed report at the start of @a bytes (see PLCRASH_REPORT_FILE_FLAG_COMPRESSED).
+ * The LZ4 block is not length delimited; its sequences are walked until the decompressed message length has been
+ * produced.
+ *
+ * Returns 1 if the report is complete, 0 if more data is required, or -1 if the report is malformed.
+ */
+static int compressed_report_length (const uint8_t *bytes, size_t avail, bool eof, size_t *length) {
+    size_t pos = sizeof(struct PLCrashReportFileHeader);
+
+    if (avail - pos < sizeof(uint32_t))
+        return eof ? -1 : 0;
+
+    size_t remaining = OSReadLittleInt32(bytes, pos);
+    pos += sizeof(uint32_t);
+
+    while (remaining > 0) {
+        if (pos >= avail)
+            return eof ? -1 : 0;
+
+        uint8_t token = bytes[pos++];
+        size_t literals = token >> 4;
+        if (literals == 15 && read_lz4_length(bytes, avail, &pos, &literals) == 0)
+            return eof ? -1 : 0;
+
+        if (literals > remaining)
+            return -1;
+        if (literals > avail - pos)
+            return eof ? -1 : 0;
+
+        pos += literals;
+        remaining -= literals;
+        if (remaining == 0)
+            break;
+
+        /* Skip the match offset */
+        if (avail - pos < 2)
+            return eof ? -1 : 0;
+        pos += 2;
+
+        size_t match = token & 0xF;
+        if (match == 15 && read_lz4_length(bytes, avail, &pos, &match) == 0)
+            return eof ? -1 : 0;
+
+        match += 4;
+        if (match > remaining)
+            return -1;
+        remaining -= match;
+    }
+
+    *length = pos;
+    return 1;
+}
+
+/*
+ * Determine the length of the report at the start of @a bytes. Reports are not length delimited; the report
+ * ends either at the end of the input, or at the start of the next report's file header. The top-level protobuf
+ * fields are walked to find the end of the report, to avoid matching the header magic within field data.
+ *
+ * Returns 1 if the report is complete, 0 if more data is required, or -1 if the report is malformed.
+ */
+static int report_length (const uint8_t *bytes, size_t avail, bool eof, size_t *length) {
+    const size_t header_len = sizeof(struct PLCrashReportFileHeader);
+    size_t pos = header_len;
+
+    if (avail < header_len)
+        return eof ? -1 : 0;
+
+    if (memcmp(bytes, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) != 0)
+        return -1;
+
+    if (bytes[strlen(PLCRASH_REPORT_FILE_MAGIC)] & PLCRASH_REPORT_FILE_FLAG_COMPRESSED)
+        return compressed_report_length(bytes, avail, eof, length);
+
+    while (true) {
+        /* End of input */
+        if (pos == avail) {
+            if (!eof)
+                return 0;
+            *length = pos;
+            return 1;
+        }
+
+        /* Need enough data to rule out the start of the next report */
+        if (avail - pos < header_len && !eof)
+            return 0;
+
+        if (avail - pos >= header_len &&
+            memcmp(bytes + pos, PLCRASH_REPORT_FILE_MAGIC, strlen(PLCRASH_REPORT_FILE_MAGIC)) == 0 &&
+            ((bytes[pos + strlen(PLCRASH_REPORT_FILE_MAGIC)] & ~PLCRASH_REPORT_FILE_FLAG_COMPRESSED) == PLCRASH_REPORT_FILE_VERSION ||
+             (bytes[pos + strlen(PLCRASH_REPORT_FILE_MAGIC)] & ~PLCRASH_REPORT_FILE_FLAG_COMPRESSED) == PLCRASH_REPORT_FILE_VERSION_COMPACT))
+        {
+            *length = pos;
+            return 1;
+        }
+
+        /* Skip the next field */
+        uint64_t tag;
+        uint64_t value;
+        uint64_t skip = 0;
+        int ret;
+
+        if ((ret = read_varint(bytes, avail, &pos, &tag)) != 1)
+            return (ret == 0 && !eof) ? 0 : -1;
+
+        switch (tag & 0x7) {
+            case WIRETYPE_VARINT:
+                if ((ret = read_varint(bytes, avail, &pos, &value)) != 1)
+                    return (ret == 0 && !eof) ? 0 : -1;
+                break;
+
+            case WIRETYPE_64BIT:
+                skip = 8;
+                break;
+
+            case WIRETYPE_32BIT:
+                skip = 4;
+                break;
+
+            case WIRETYPE_LENGTH_PREFIXED:
+                if ((ret = read_varint(bytes, avail, &pos, &skip)) != 1)
+                    return (ret == 0 && !eof) ? 0 : -1;
+                break;
+
+            default:
+                return -1;
+        }
+
+        if (skip > avail - pos)
+            return eof ? -1 : 0;
+        pos += skip;
+    }
+}
+
+/*
+ * Read the next report from @a reader. The returned bytes remain valid until the next call to
+ * report_reader_next().
+ *
+ * Returns 1 if a report was returned, 0 if no further reports are available, or -1 on error.
+ */
+static int report_reader_next (report_reader_t *reader, const uint8_t **report, size_t *length) {
+    while (true) {
+        const uint8_t *bytes;
+        size_t avail;
+
+        if (reader->mapped != nil) {
+            bytes = [reader->mapped bytes];
+            avail = [reader->mapped length];
+        } else {
+            bytes = [reader->buffer bytes];
+            avail = [reader->buffer length];
+        }
+
+        if (reader->offset == avail && reader->eof)
+            return 0;
+
+        int ret = report_length(bytes + reader->offset, avail - reader->offset, reader->eof, length);
+        if (ret < 0)
+            return -1;
+
+        if (ret == 1) {
+            *report = bytes + reader->offset;
+            reader->offset += *length;
+            return 1;
+        }
+
+        /* Discard consumed data and read more from the stream */
+        [reader->buffer replaceBytesInRange: NSMakeRange(0, reader->offset) withBytes: NULL length: 0];
+        reader->offset = 0;
+
+        size_t used = [reader->buffer length];
+        [reader->buffer setLength: used + READER_CHUNK_SIZE];
+        size_t nread = fread((uint8_t *) [reader->buffer mutableBytes] + used, 1, READER_CHUNK_SIZE, reader->input);
+        [reader->buffer setLength: used + nread];
+
+        if (nread == 0) {
+            if (ferror(reader->input))
+                return -1;
+            reader->eof = true;
+        }
+    }
+}
+
+/*
+ * Parse the text format named @a format. Returns false if the format is not supported.
+ */
+static bool parse_text_format (const char *format, PLCrashReportTextFormat *textFormat) {
+    if (strcasecmp(format, "iphone") == 0 || strcasecmp(format, "ios") == 0) {
+        *textFormat = PLCrashReportTextFormatiOS;
+        return true;
+    } else if (strcasecmp(format, "json") == 0) {
+        *textFormat = PLCrashReportTextFormatJSON;
+        return true;
+    } else if (strcasecmp(format, "summary") == 0) {
+        *textFormat = PLCrashReportTextFormatSummary;
+        return true;
+    }
+
+    return false;
+}
+
+/*
+ * Write @a crashLog to @a output in @a textFormat, followed by a newline. The report is formatted directly
+ * to the output's file descriptor. Returns false on failure.
+ */
+static bool convert_write_report (PLCrashReport *crashLog, PLCrashReportTextFormat textFormat,
+                                  PLCrashReportTextFormatterOptions options, FILE *output)
+{
+    NSError *error;
+
+    /* Flush any stdio-buffered output, which would otherwise be written after the report */
+    fflush(output);
+    if (![PLCrashReportTextFormatter writeCrashReport: crashLog withTextFormat: textFormat options: options toFileDescriptor: fileno(output) error: &error]) {
+        fprintf(stderr, "Could not write crash log: %s\n", [[error localizedDescription] UTF8String]);
+        return false;
+    }
+
+    fputc('\n', output);
+    return true;
+}
+
+/*
+ * Convert all reports available from @a reader, writing the formatted reports to @a output. Returns 0 on success,
+ * or 1 if any report could not be converted.
+ */
+static int convert_reports (report_reader_t *reader, const char *source, PLCrashReportTextFormat textFormat,
+                            PLCrashReportTextFormatterOptions options, FILE *output)
+{
+    const uint8_t *bytes;
+    size_t length;
+    int ret = 0;
+    int read;
+
+    for (NSUInteger index = 0; (read = report_reader_next(reader, &bytes, &length)) == 1; index++) {
+        /* Scope all report allocations to this iteration */
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSError *error;
+
+        /* Decode directly from the reader's buffer; the report and its data are released before the buffer is
+         * next modified. */
+        NSData *data = [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO];
+        PLCrashReport *crashLog = [[[PLCrashReport alloc] initWithData: data
+                                                               options: PLCrashReportDecodingOptionLazy | PLCrashReportDecodingOptionWatchdogSummary
+                                                                 error: &error] autorelease];
+        if (crashLog == nil) {
+            fprintf(stderr, "Could not decode crash log %lu in %s: %s\n", (unsigned long) index, source,
+                    [[error localizedDescription] UTF8String]);
+            ret = 1;
+        } else if (!convert_write_report(crashLog, textFormat, options, output)) {
+            ret = 1;
+        }
+
+        [pool release];
+    }
+
+    if (read < 0) {
+        fprintf(stderr, "Could not read crash log data from %s\n", source);
+        ret = 1;
+    }
+
+    return ret;
+}
+
+/*
+ * Convert all reports within the archive @a data, writing the formatted reports to @a output. Returns 0 on success,
+ * or 1 if any report could not be converted.
+ */
+static int convert_archive (NSData *data, const char *source, PLCrashReportTextFormat textFormat,
+                            PLCrashReportTextFormatterOptions options, FILE *output)
+{
+    NSError *error;
+    int ret = 0;
+
+    PLCrashReportArchive *archive = [[[PLCrashReportArchive alloc] initWithData: data error: &error] autorelease];
+    if (archive == nil) {
+        fprintf(stderr, "Could not read archive %s: %s\n", source, [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    for (NSUInteger index = 0; index < [archive count]; index++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+        PLCrashReport *crashLog = [[[PLCrashReport alloc] initWithData: [archive reportDataAtIndex: index]
+                                                               options: PLCrashReportDecodingOptionLazy | PLCrashReportDecodingOptionWatchdogSummary
+                                                                 error: &error] autorelease];
+        if (crashLog == nil) {
+            fprintf(stderr, "Could not decode crash log %lu in %s: %s\n", (unsigned long) index, source,
+                    [[error localizedDescription] UTF8String]);
+            ret = 1;
+        } else if (!convert_write_report(crashLog, textFormat, options, output)) {
+            ret = 1;
+        }
+
+        [pool release];
+    }
+
+    return ret;
+}
+
+/*
+ * Convert a single input file or stream.
+ */
+static int convert_file (NSString *path, NSMutableData *buffer, PLCrashReportTextFormat textFormat,
+                         PLCrashReportTextFormatterOptions options, FILE *output)
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    report_reader_t reader = { 0 };
+    NSError *error;
+    int ret;
+
+    if ([path isEqualToString: @"-"]) {
+        reader.input = stdin;
+        reader.buffer = buffer;
+        [buffer setLength: 0];
+    } else {
+        reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+        if (reader.mapped == nil) {
+            fprintf(stderr, "Could not read input file: %s\n", [[error localizedDescription] UTF8String]);
+            [pool release];
+            return 1;
+        }
+        reader.eof = true;
+
+        /* Archives are converted via their index */
+        if ([PLCrashReportArchive isArchiveData: reader.mapped]) {
+            ret = convert_archive(reader.mapped, [path fileSystemRepresentation], textFormat, options, output);
+            [pool release];
+            return ret;
+        }
+    }
+
+    ret = convert_reports(&reader, [path fileSystemRepresentation], textFormat, options, output);
+
+    [pool release];
+    return ret;
 }
 
 /*
@@ -51,22 +504,27 @@ void print_usage () {
  */
 int convert_command (int argc, char *argv[]) {
     const char *format = "iphone";
-    const char *input_file;
+    PLCrashReportTextFormatterOptions options = PLCrashReportTextFormatterOptionNone;
     FILE *output = stdout;
+    int ret = 0;
 
     /* options descriptor */
     static struct option longopts[] = {
         { "format",     required_argument,      NULL,          'f' },
+        { "demangle",   no_argument,            NULL,          'D' },
         { NULL,         0,                      NULL,           0 }
     };    
 
     /* Read the options */
     char ch;
-    while ((ch = getopt_long(argc, argv, "f:", longopts, NULL)) != -1) {
+    while ((ch = getopt_long(argc, argv, "f:D", longopts, NULL)) != -1) {
         switch (ch) {
             case 'f':
                 format = optarg;
                 break;
+            case 'D':
+                options |= PLCrashReportTextFormatterOptionDemangleSymbols;
+                break;
             default:
                 print_usage();
                 return 1;
@@ -80,39 +538,2456 @@ int convert_command (int argc, char *argv[]) {
         fprintf(stderr, "No input file supplied\n");
         print_usage();
         return 1;
-    } else {
-        input_file = argv[0];
     }
     
-    /* Verify that the format is supported. Only one is actually supported currently */
+    /* Verify that the format is supported */
     PLCrashReportTextFormat textFormat;
-    if (strcasecmp(format, "iphone") == 0 || strcasecmp(format, "ios")) {
-        textFormat = PLCrashReportTextFormatiOS;
-    } else {
+    if (!parse_text_format(format, &textFormat)) {
+        fprintf(stderr, "Unsupported format requested\n");
+        print_usage();
+        return 1;
+    }
+
+    /* A single stream read buffer is shared by all inputs */
+    NSMutableData *buffer = [NSMutableData dataWithCapacity: READER_CHUNK_SIZE];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+
+    for (int i = 0; i < argc; i++) {
+        NSString *path = [fileManager stringWithFileSystemRepresentation: argv[i] length: strlen(argv[i])];
+        BOOL isDirectory = NO;
+
+        /* Plain file or stream */
+        if (![fileManager fileExistsAtPath: path isDirectory: &isDirectory] || !isDirectory) {
+            if (convert_file(path, buffer, textFormat, options, output) != 0)
+                ret = 1;
+            continue;
+        }
+
+        /* Directory; convert all .plcrash files, in a stable order */
+        NSError *error;
+        NSArray *entries = [fileManager contentsOfDirectoryAtPath: path error: &error];
+        if (entries == nil) {
+            fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
+            ret = 1;
+            continue;
+        }
+
+        for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+            if ([[entry pathExtension] caseInsensitiveCompare: @"plcrash"] != NSOrderedSame)
+                continue;
+
+            if (convert_file([path stringByAppendingPathComponent: entry], buffer, textFormat, options, output) != 0)
+                ret = 1;
+        }
+    }
+
+    return ret;
+}
+
+/*
+ * Shared batch conversion state. The input list is read-only once the workers have started; all other
+ * shared values are updated atomically.
+ */
+typedef struct batch_context {
+    /* Input file paths */
+    NSArray *inputs;
+
+    /* Output directory */
+    NSString *outputDirectory;
+
+    /* Output format and formatting options */
+    PLCrashReportTextFormat textFormat;
+    PLCrashReportTextFormatterOptions options;
+
+    /* Index of the next unclaimed input */
+    volatile int32_t next;
+
+    /* Number of reports converted */
+    volatile int64_t converted;
+
+    /* Number of reports (or input files) that could not be converted */
+    volatile int64_t failed;
+
+    /* Total number of input bytes processed */
+    volatile int64_t bytes;
+} batch_context_t;
+
+/*
+ * Convert a single batch input file, writing all of its reports to the corresponding output file.
+ */
+static void batch_convert_file (batch_context_t *ctx, NSString *path) {
+    report_reader_t reader = { 0 };
+    const uint8_t *bytes;
+    size_t length;
+    NSError *error;
+    int read;
+
+    reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+    reader.eof = true;
+    if (reader.mapped == nil) {
+        fprintf(stderr, "Could not read input file %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+        return;
+    }
+    OSAtomicAdd64Barrier([reader.mapped length], &ctx->bytes);
+
+    /* JSON reports are written one per line */
+    NSString *extension = ctx->textFormat == PLCrashReportTextFormatJSON ? @"ndjson" : @"crash";
+    NSString *name = [[[path lastPathComponent] stringByDeletingPathExtension] stringByAppendingPathExtension: extension];
+    NSString *outputPath = [ctx->outputDirectory stringByAppendingPathComponent: name];
+    int fd = open([outputPath fileSystemRepresentation], O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Could not open output file %s: %s\n", [outputPath fileSystemRepresentation], strerror(errno));
+        OSAtomicIncrement64Barrier(&ctx->failed);
+        return;
+    }
+
+    for (NSUInteger index = 0; (read = report_reader_next(&reader, &bytes, &length)) == 1; index++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+        NSData *data = [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO];
+        PLCrashReport *crashLog = [[[PLCrashReport alloc] initWithData: data
+                                                               options: PLCrashReportDecodingOptionLazy | PLCrashReportDecodingOptionWatchdogSummary
+                                                                 error: &error] autorelease];
+        if (crashLog == nil) {
+            fprintf(stderr, "Could not decode crash log %lu in %s: %s\n", (unsigned long) index, [path fileSystemRepresentation],
+                    [[error localizedDescription] UTF8String]);
+            OSAtomicIncrement64Barrier(&ctx->failed);
+        } else if (![PLCrashReportTextFormatter writeCrashReport: crashLog withTextFormat: ctx->textFormat options: ctx->options toFileDescriptor: fd error: &error] ||
+                   write(fd, "\n", 1) != 1)
+        {
+            fprintf(stderr, "Could not write %s\n", [outputPath fileSystemRepresentation]);
+            OSAtomicIncrement64Barrier(&ctx->failed);
+        } else {
+            OSAtomicIncrement64Barrier(&ctx->converted);
+        }
+
+        [pool release];
+    }
+
+    if (read < 0) {
+        fprintf(stderr, "Could not read crash log data from %s\n", [path fileSystemRepresentation]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+    }
+
+    close(fd);
+}
+
+/*
+ * Batch worker thread; claims and converts inputs until none remain.
+ */
+static void *batch_worker (void *arg) {
+    batch_context_t *ctx = arg;
+
+    while (true) {
+        int32_t idx = OSAtomicIncrement32Barrier(&ctx->next) - 1;
+        if (idx >= (int32_t) [ctx->inputs count])
+            break;
+
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        batch_convert_file(ctx, [ctx->inputs objectAtIndex: idx]);
+        [pool release];
+    }
+
+    return NULL;
+}
+
+/*
+ * Run a parallel batch conversion.
+ */
+int batch_command (int argc, char *argv[]) {
+    const char *format = "iphone";
+    PLCrashReportTextFormatterOptions options = PLCrashReportTextFormatterOptionNone;
+    const char *output = NULL;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "format",     required_argument,      NULL,          'f' },
+        { "demangle",   no_argument,            NULL,          'D' },
+        { "output",     required_argument,      NULL,          'o' },
+        { "jobs",       required_argument,      NULL,          'j' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "f:Do:j:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'f':
+                format = optarg;
+                break;
+            case 'D':
+                options |= PLCrashReportTextFormatterOptionDemangleSymbols;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1 || output == NULL) {
+        fprintf(stderr, "An input and output directory must be supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    if (jobs < 1) {
+        fprintf(stderr, "Invalid job count\n");
+        return 1;
+    }
+
+    /* Verify that the format is supported */
+    PLCrashReportTextFormat textFormat;
+    if (!parse_text_format(format, &textFormat)) {
         fprintf(stderr, "Unsupported format requested\n");
         print_usage();
         return 1;
     }
 
-    /* Try reading the file in */
+    /* Gather the inputs */
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *inputDirectory = [fileManager stringWithFileSystemRepresentation: argv[0] length: strlen(argv[0])];
+    NSString *outputDirectory = [fileManager stringWithFileSystemRepresentation: output length: strlen(output)];
     NSError *error;
-    NSData *data = [NSData dataWithContentsOfFile: [NSString stringWithUTF8String: input_file] 
-                                          options: NSMappedRead error: &error];
-    if (data == nil) {
-        fprintf(stderr, "Could not read input file: %s\n", [[error localizedDescription] UTF8String]);
+
+    NSArray *entries = [fileManager contentsOfDirectoryAtPath: inputDirectory error: &error];
+    if (entries == nil) {
+        fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
         return 1;
     }
-    
-    /* Decode it */
-    PLCrashReport *crashLog = [[PLCrashReport alloc] initWithData: data error: &error];
-    if (crashLog == nil) {
-        fprintf(stderr, "Could not decode crash log: %s\n", [[error localizedDescription] UTF8String]);
+
+    NSMutableArray *inputs = [NSMutableArray arrayWithCapacity: [entries count]];
+    for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+        if ([[entry pathExtension] caseInsensitiveCompare: @"plcrash"] == NSOrderedSame)
+            [inputs addObject: [inputDirectory stringByAppendingPathComponent: entry]];
+    }
+
+    if (![fileManager fileExistsAtPath: outputDirectory] &&
+        ![fileManager createDirectoryAtPath: outputDirectory withIntermediateDirectories: YES attributes: nil error: &error])
+    {
+        fprintf(stderr, "Could not create output directory: %s\n", [[error localizedDescription] UTF8String]);
         return 1;
     }
 
-    /* Format the report */
-    NSString* report = [PLCrashReportTextFormatter stringValueForCrashReport: crashLog withTextFormat: textFormat];
-    fprintf(output, "%s", [report UTF8String]);     
+    /* Run the workers */
+    batch_context_t ctx = {
+        .inputs = inputs,
+        .outputDirectory = outputDirectory,
+        .textFormat = textFormat,
+        .options = options,
+        .next = 0,
+        .converted = 0,
+        .failed = 0,
+        .bytes = 0
+    };
+
+    if ((NSUInteger) jobs > [inputs count])
+        jobs = MAX(1, [inputs count]);
+
+    pthread_t *threads = calloc(jobs, sizeof(pthread_t));
+    long started = 0;
+    CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
+
+    for (; started < jobs; started++) {
+        int err = pthread_create(&threads[started], NULL, batch_worker, &ctx);
+        if (err != 0) {
+            fprintf(stderr, "Could not create worker thread: %s\n", strerror(err));
+            break;
+        }
+    }
+
+    /* If no workers could be started, fall back on converting on this thread */
+    if (started == 0)
+        batch_worker(&ctx);
+
+    for (long i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    /* Report throughput */
+    CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - startTime;
+    if (elapsed <= 0)
+        elapsed = 1e-6;
+
+    fprintf(stderr, "Converted %lld reports (%lld failed) from %lu files using %ld workers in %.3f seconds\n",
+            (long long) ctx.converted, (long long) ctx.failed, (unsigned long) [inputs count], MAX(started, 1L), elapsed);
+    fprintf(stderr, "Throughput: %.1f reports/sec, %.2f MB/sec\n",
+            ctx.converted / elapsed, (ctx.bytes / (1024.0 * 1024.0)) / elapsed);
+
+    return ctx.failed == 0 ? 0 : 1;
+}
+
+/*
+ * A frame within an aggregated profile stack; the PC is recorded relative to its image, so that samples
+ * from different processes (and different ASLR slides) aggregate.
+ */
+typedef struct profile_frame {
+    /* Index of the frame's image within the profile's image table, or PROFILE_NO_IMAGE. */
+    uint32_t image;
+
+    /* The image-relative PC, or the absolute PC if the image is unknown. */
+    uint64_t offset;
+} profile_frame_t;
+
+/* Image index used for frames that could not be attributed to a binary image */
+#define PROFILE_NO_IMAGE UINT32_MAX
+
+/* Supported profile formats */
+typedef enum {
+    /* Collapsed stack text, as consumed by flamegraph.pl */
+    PROFILE_FORMAT_COLLAPSED,
+
+    /* pprof profile.proto */
+    PROFILE_FORMAT_PPROF
+} profile_format_t;
+
+/*
+ * A binary image referenced by a profile, and the symbol table gathered for it across all input reports.
+ * Images are keyed by UUID, and so symbols recorded by any report apply to the samples of all reports.
+ */
+@interface PLCrashProfileImage : NSObject {
+@public
+    /* The image's UUID (or path, if the UUID is unavailable) */
+    NSString *_key;
+
+    /* The image path */
+    NSString *_path;
+
+    /* The image's size */
+    uint64_t _size;
+
+    /* Observed symbols; maps the image-relative start address (NSNumber) to the symbol name. Only modified
+     * with the profile lock held. */
+    NSMutableDictionary *_symbols;
+
+    /* Symbol table built from _symbols by -buildSymbolTable, sorted by start address. */
+    uint64_t *_starts;
+    NSArray *_names;
+
+    /* Resolved frame labels, keyed by image-relative PC (NSNumber). */
+    NSMutableDictionary *_labels;
+}
+@end
+
+@implementation PLCrashProfileImage
+
+- (id) initWithKey: (NSString *) key path: (NSString *) path size: (uint64_t) size {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _key = [key copy];
+    _path = [path copy];
+    _size = size;
+    _symbols = [[NSMutableDictionary alloc] init];
+    _labels = [[NSMutableDictionary alloc] init];
+
+    return self;
+}
+
+- (void) dealloc {
+    [_key release];
+    [_path release];
+    [_symbols release];
+    [_names release];
+    [_labels release];
+    free(_starts);
+    [super dealloc];
+}
+
+/*
+ * Build the sorted symbol table from all observed symbols. Must be called once all inputs have been read.
+ */
+- (void) buildSymbolTable {
+    NSArray *starts = [[_symbols allKeys] sortedArrayUsingSelector: @selector(compare:)];
+    NSMutableArray *names = [NSMutableArray arrayWithCapacity: [starts count]];
+
+    _starts = malloc(sizeof(uint64_t) * ([starts count] + 1));
+    for (NSUInteger i = 0; i < [starts count]; i++) {
+        NSNumber *start = [starts objectAtIndex: i];
+        _starts[i] = [start unsignedLongLongValue];
+        [names addObject: [_symbols objectForKey: start]];
+    }
+
+    _names = [names copy];
+}
+
+/*
+ * Return the function label for the given image-relative @a offset, in "image`symbol" form. Frames that fall
+ * outside all known symbols are labeled with their image-relative address.
+ */
+- (NSString *) labelForOffset: (uint64_t) offset {
+    NSNumber *key = [NSNumber numberWithUnsignedLongLong: offset];
+    NSString *label = [_labels objectForKey: key];
+    if (label != nil)
+        return label;
+
+    /* Find the last symbol starting at or before the offset */
+    NSUInteger lo = 0;
+    NSUInteger hi = [_names count];
+    while (lo < hi) {
+        NSUInteger mid = lo + (hi - lo) / 2;
+        if (_starts[mid] <= offset)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    NSString *image = [_path lastPathComponent];
+    if (lo > 0 && offset < _size) {
+        label = [NSString stringWithFormat: @"%@`%@", image, [_names objectAtIndex: lo - 1]];
+    } else {
+        label = [NSString stringWithFormat: @"%@`0x%llx", image, (unsigned long long) offset];
+    }
+
+    [_labels setObject: label forKey: key];
+    return label;
+}
+
+@end
+
+/*
+ * Shared profile aggregation state. The input list is read-only once the workers have started; all other
+ * shared values are modified with @a lock held, or atomically.
+ */
+typedef struct profile_context {
+    /* Input file paths */
+    NSArray *inputs;
+
+    /* Index of the next unclaimed input */
+    volatile int32_t next;
+
+    /* Protects the values below */
+    pthread_mutex_t lock;
+
+    /* Profile images (PLCrashProfileImage), indexed by profile_frame_t.image */
+    NSMutableArray *images;
+
+    /* Maps image keys to their index within @a images */
+    NSMutableDictionary *imageIndex;
+
+    /* Sampled stacks; each entry is an NSData containing the innermost-first profile_frame_t array */
+    NSCountedSet *stacks;
+
+    /* Number of reports containing samples */
+    volatile int64_t reports;
+
+    /* Number of samples aggregated */
+    volatile int64_t samples;
+
+    /* Number of reports (or input files) that could not be read */
+    volatile int64_t failed;
+} profile_context_t;
+
+/*
+ * Return the profile image index for @a image, registering the image if necessary. Must be called with
+ * the profile lock held.
+ */
+static uint32_t profile_image_index (profile_context_t *ctx, PLCrashReportBinaryImageInfo *image) {
+    NSString *key = image.hasImageUUID ? image.imageUUID : image.imageName;
+    NSNumber *index = [ctx->imageIndex objectForKey: key];
+    if (index != nil)
+        return [index unsignedIntValue];
+
+    PLCrashProfileImage *profileImage = [[[PLCrashProfileImage alloc] initWithKey: key path: image.imageName size: image.imageSize] autorelease];
+    uint32_t result = (uint32_t) [ctx->images count];
+
+    [ctx->images addObject: profileImage];
+    [ctx->imageIndex setObject: [NSNumber numberWithUnsignedInt: result] forKey: key];
+    return result;
+}
+
+/*
+ * Aggregate the hang samples of @a crashLog into @a stacks, and record the symbols of all symbolicated frames in
+ * the report against their images' symbol tables.
+ */
+static void profile_add_report (profile_context_t *ctx, PLCrashReport *crashLog, NSCountedSet *stacks) {
+    NSArray *samples = crashLog.hangInfo.samples;
+    if ([samples count] == 0)
+        return;
+
+    /* Map the report's images to profile images. This is done once per report, amortizing the lock across all of
+     * the report's samples; the report's own values are decoded outside of the lock. */
+    NSArray *reportImages = crashLog.images;
+    NSMutableDictionary *indices = [NSMutableDictionary dictionaryWithCapacity: [reportImages count]];
+    NSMutableDictionary *profileImages = [NSMutableDictionary dictionaryWithCapacity: [reportImages count]];
+
+    pthread_mutex_lock(&ctx->lock);
+    for (PLCrashReportBinaryImageInfo *image in reportImages) {
+        uint32_t index = profile_image_index(ctx, image);
+        NSNumber *base = [NSNumber numberWithUnsignedLongLong: image.imageBaseAddress];
+
+        [indices setObject: [NSNumber numberWithUnsignedInt: index] forKey: base];
+        [profileImages setObject: [ctx->images objectAtIndex: index] forKey: base];
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    /* Gather the symbols of all symbolicated frames */
+    NSMutableArray *symbolImages = [NSMutableArray array];
+    NSMutableArray *symbolStarts = [NSMutableArray array];
+    NSMutableArray *symbolNames = [NSMutableArray array];
+
+    for (PLCrashReportThreadInfo *thread in crashLog.threads) {
+        for (PLCrashReportStackFrameInfo *frame in thread.stackFrames) {
+            PLCrashReportSymbolInfo *symbol = frame.symbolInfo;
+            if (symbol == nil)
+                continue;
+
+            PLCrashReportBinaryImageInfo *image = [crashLog imageForAddress: frame.instructionPointer];
+            if (image == nil || symbol.startAddress < image.imageBaseAddress)
+                continue;
+
+            [symbolImages addObject: [profileImages objectForKey: [NSNumber numberWithUnsignedLongLong: image.imageBaseAddress]]];
+            [symbolStarts addObject: [NSNumber numberWithUnsignedLongLong: symbol.startAddress - image.imageBaseAddress]];
+            [symbolNames addObject: symbol.symbolName];
+        }
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    for (NSUInteger i = 0; i < [symbolImages count]; i++) {
+        PLCrashProfileImage *profileImage = [symbolImages objectAtIndex: i];
+        [profileImage->_symbols setObject: [symbolNames objectAtIndex: i] forKey: [symbolStarts objectAtIndex: i]];
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    /* Convert each sample to image-relative frames */
+    for (PLCrashReportHangSample *sample in samples) {
+        NSArray *stackFrames = sample.stackFrames;
+        NSMutableData *stack = [NSMutableData dataWithLength: sizeof(profile_frame_t) * [stackFrames count]];
+        profile_frame_t *frames = [stack mutableBytes];
+
+        for (NSUInteger i = 0; i < [stackFrames count]; i++) {
+            uint64_t pc = [[stackFrames objectAtIndex: i] instructionPointer];
+            PLCrashReportBinaryImageInfo *image = [crashLog imageForAddress: pc];
+
+            if (image != nil) {
+                frames[i].image = [[indices objectForKey: [NSNumber numberWithUnsignedLongLong: image.imageBaseAddress]] unsignedIntValue];
+                frames[i].offset = pc - image.imageBaseAddress;
+            } else {
+                frames[i].image = PROFILE_NO_IMAGE;
+                frames[i].offset = pc;
+            }
+        }
+
+        [stacks addObject: stack];
+    }
+
+    OSAtomicIncrement64Barrier(&ctx->reports);
+    OSAtomicAdd64Barrier([samples count], &ctx->samples);
+}
+
+/*
+ * Aggregate all reports in a single profile input file.
+ */
+static void profile_file (profile_context_t *ctx, NSString *path) {
+    report_reader_t reader = { 0 };
+    const uint8_t *bytes;
+    size_t length;
+    NSError *error;
+    int read;
+
+    reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+    reader.eof = true;
+    if (reader.mapped == nil) {
+        fprintf(stderr, "Could not read input file %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+        return;
+    }
+
+    /* Stacks are aggregated locally, and merged into the shared profile once the file is complete */
+    NSCountedSet *stacks = [NSCountedSet set];
+
+    for (NSUInteger index = 0; (read = report_reader_next(&reader, &bytes, &length)) == 1; index++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+        NSData *data = [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO];
+        PLCrashReport *crashLog = [[[PLCrashReport alloc] initWithData: data
+                                                               options: PLCrashReportDecodingOptionLazy
+                                                                 error: &error] autorelease];
+        if (crashLog == nil) {
+            fprintf(stderr, "Could not decode crash log %lu in %s: %s\n", (unsigned long) index, [path fileSystemRepresentation],
+                    [[error localizedDescription] UTF8String]);
+            OSAtomicIncrement64Barrier(&ctx->failed);
+        } else {
+            profile_add_report(ctx, crashLog, stacks);
+        }
+
+        [pool release];
+    }
+
+    if (read < 0) {
+        fprintf(stderr, "Could not read crash log data from %s\n", [path fileSystemRepresentation]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+    }
+
+    pthread_mutex_lock(&ctx->lock);
+    for (NSData *stack in stacks) {
+        for (NSUInteger i = [stacks countForObject: stack]; i > 0; i--)
+            [ctx->stacks addObject: stack];
+    }
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+/*
+ * Profile worker thread; claims and aggregates inputs until none remain.
+ */
+static void *profile_worker (void *arg) {
+    profile_context_t *ctx = arg;
+
+    while (true) {
+        int32_t idx = OSAtomicIncrement32Barrier(&ctx->next) - 1;
+        if (idx >= (int32_t) [ctx->inputs count])
+            break;
+
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        profile_file(ctx, [ctx->inputs objectAtIndex: idx]);
+        [pool release];
+    }
+
+    return NULL;
+}
+
+/*
+ * Return the label for @a frame.
+ */
+static NSString *profile_frame_label (profile_context_t *ctx, const profile_frame_t *frame) {
+    if (frame->image == PROFILE_NO_IMAGE)
+        return [NSString stringWithFormat: @"0x%llx", (unsigned long long) frame->offset];
+
+    return [[ctx->images objectAtIndex: frame->image] labelForOffset: frame->offset];
+}
+
+/*
+ * Write the aggregated profile as collapsed stacks; one line per distinct stack, with frames ordered from the
+ * outermost to the innermost, followed by the stack's sample count.
+ */
+static NSData *profile_collapsed (profile_context_t *ctx) {
+    NSCountedSet *lines = [NSCountedSet set];
+
+    for (NSData *stack in ctx->stacks) {
+        const profile_frame_t *frames = [stack bytes];
+        NSUInteger count = [stack length] / sizeof(profile_frame_t);
+        NSMutableString *line = [NSMutableString string];
+
+        for (NSUInteger i = count; i > 0; i--) {
+            if (i != count)
+                [line appendString: @";"];
+            [line appendString: profile_frame_label(ctx, &frames[i - 1])];
+        }
+
+        /* Distinct PCs may resolve to the same function; aggregate by label */
+        for (NSUInteger i = [ctx->stacks countForObject: stack]; i > 0; i--)
+            [lines addObject: line];
+    }
+
+    NSMutableData *output = [NSMutableData data];
+    for (NSString *line in [[lines allObjects] sortedArrayUsingSelector: @selector(compare:)]) {
+        NSString *entry = [NSString stringWithFormat: @"%@ %lu\n", line, (unsigned long) [lines countForObject: line]];
+        [output appendData: [entry dataUsingEncoding: NSUTF8StringEncoding]];
+    }
+
+    return output;
+}
+
+/*
+ * Append a protobuf varint to @a output.
+ */
+static void pb_varint (NSMutableData *output, uint64_t value) {
+    uint8_t buf[10];
+    size_t len = 0;
+
+    while (value >= 0x80) {
+        buf[len++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    buf[len++] = (uint8_t) value;
+
+    [output appendBytes: buf length: len];
+}
+
+/*
+ * Append a protobuf varint field to @a output.
+ */
+static void pb_uint64 (NSMutableData *output, uint32_t field, uint64_t value) {
+    pb_varint(output, ((uint64_t) field << 3) | WIRETYPE_VARINT);
+    pb_varint(output, value);
+}
+
+/*
+ * Append a length-delimited protobuf field to @a output.
+ */
+static void pb_bytes (NSMutableData *output, uint32_t field, NSData *value) {
+    pb_varint(output, ((uint64_t) field << 3) | WIRETYPE_LENGTH_PREFIXED);
+    pb_varint(output, [value length]);
+    [output appendData: value];
+}
+
+/*
+ * Return the pprof string table index for @a string, adding it to the table if necessary.
+ */
+static uint64_t pprof_string (NSMutableArray *strings, NSMutableDictionary *index, NSString *string) {
+    NSNumber *existing = [index objectForKey: string];
+    if (existing != nil)
+        return [existing unsignedLongLongValue];
+
+    uint64_t result = [strings count];
+    [strings addObject: string];
+    [index setObject: [NSNumber numberWithUnsignedLongLong: result] forKey: string];
+    return result;
+}
+
+/* pprof profile.proto field numbers */
+enum {
+    PPROF_PROFILE_SAMPLE_TYPE = 1,
+    PPROF_PROFILE_SAMPLE = 2,
+    PPROF_PROFILE_MAPPING = 3,
+    PPROF_PROFILE_LOCATION = 4,
+    PPROF_PROFILE_FUNCTION = 5,
+    PPROF_PROFILE_STRING_TABLE = 6,
+    PPROF_PROFILE_COMMENT = 13,
+
+    PPROF_VALUE_TYPE_TYPE = 1,
+    PPROF_VALUE_TYPE_UNIT = 2,
+
+    PPROF_SAMPLE_LOCATION_ID = 1,
+    PPROF_SAMPLE_VALUE = 2,
+
+    PPROF_MAPPING_ID = 1,
+    PPROF_MAPPING_MEMORY_START = 2,
+    PPROF_MAPPING_MEMORY_LIMIT = 3,
+    PPROF_MAPPING_FILENAME = 5,
+    PPROF_MAPPING_BUILD_ID = 6,
+    PPROF_MAPPING_HAS_FUNCTIONS = 7,
+
+    PPROF_LOCATION_ID = 1,
+    PPROF_LOCATION_MAPPING_ID = 2,
+    PPROF_LOCATION_ADDRESS = 3,
+    PPROF_LOCATION_LINE = 4,
+
+    PPROF_LINE_FUNCTION_ID = 1,
+
+    PPROF_FUNCTION_ID = 1,
+    PPROF_FUNCTION_NAME = 2,
+    PPROF_FUNCTION_SYSTEM_NAME = 3,
+    PPROF_FUNCTION_FILENAME = 4,
+};
+
+/*
+ * Return the synthetic pprof mapping base address for the image at @a index. Each image is assigned a disjoint
+ * 4GB range, as the sampled processes' load addresses differ.
+ */
+static uint64_t pprof_mapping_base (uint32_t index) {
+    return ((uint64_t) index + 1) << 32;
+}
+
+/*
+ * Write the aggregated profile in the (uncompressed) pprof profile.proto format. Frames are pre-symbolicated
+ * using the per-image symbol tables, and image-relative PCs are mapped into synthetic, per-image address ranges.
+ */
+static NSData *profile_pprof (profile_context_t *ctx) {
+    NSMutableData *output = [NSMutableData data];
+    NSMutableArray *strings = [NSMutableArray arrayWithObject: @""];
+    NSMutableDictionary *stringIndex = [NSMutableDictionary dictionaryWithObject: [NSNumber numberWithUnsignedLongLong: 0] forKey: @""];
+
+    NSMutableDictionary *locations = [NSMutableDictionary dictionary];
+    NSMutableDictionary *functions = [NSMutableDictionary dictionary];
+    NSMutableIndexSet *mappings = [NSMutableIndexSet indexSet];
+
+    /* Sample type */
+    NSMutableData *valueType = [NSMutableData data];
+    pb_uint64(valueType, PPROF_VALUE_TYPE_TYPE, pprof_string(strings, stringIndex, @"samples"));
+    pb_uint64(valueType, PPROF_VALUE_TYPE_UNIT, pprof_string(strings, stringIndex, @"count"));
+    pb_bytes(output, PPROF_PROFILE_SAMPLE_TYPE, valueType);
+
+    /* Samples, locations, and functions */
+    for (NSData *stack in ctx->stacks) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        const profile_frame_t *frames = [stack bytes];
+        NSUInteger count = [stack length] / sizeof(profile_frame_t);
+        NSMutableData *locationIds = [NSMutableData data];
+
+        for (NSUInteger i = 0; i < count; i++) {
+            const profile_frame_t *frame = &frames[i];
+            uint64_t address = frame->image == PROFILE_NO_IMAGE ? frame->offset : pprof_mapping_base(frame->image) + frame->offset;
+
+            NSNumber *locationKey = [NSNumber numberWithUnsignedLongLong: address];
+            NSNumber *locationId = [locations objectForKey: locationKey];
+            if (locationId == nil) {
+                NSString *label = profile_frame_label(ctx, frame);
+                NSNumber *functionId = [functions objectForKey: label];
+                if (functionId == nil) {
+                    functionId = [NSNumber numberWithUnsignedLongLong: [functions count] + 1];
+                    [functions setObject: functionId forKey: label];
+
+                    NSMutableData *function = [NSMutableData data];
+                    NSString *path = frame->image == PROFILE_NO_IMAGE ? @"" : ((PLCrashProfileImage *) [ctx->images objectAtIndex: frame->image])->_path;
+                    uint64_t name = pprof_string(strings, stringIndex, label);
+
+                    pb_uint64(function, PPROF_FUNCTION_ID, [functionId unsignedLongLongValue]);
+                    pb_uint64(function, PPROF_FUNCTION_NAME, name);
+                    pb_uint64(function, PPROF_FUNCTION_SYSTEM_NAME, name);
+                    pb_uint64(function, PPROF_FUNCTION_FILENAME, pprof_string(strings, stringIndex, path));
+                    pb_bytes(output, PPROF_PROFILE_FUNCTION, function);
+                }
+
+                locationId = [NSNumber numberWithUnsignedLongLong: [locations count] + 1];
+                [locations setObject: locationId forKey: locationKey];
+
+                NSMutableData *line = [NSMutableData data];
+                pb_uint64(line, PPROF_LINE_FUNCTION_ID, [functionId unsignedLongLongValue]);
+
+                NSMutableData *location = [NSMutableData data];
+                pb_uint64(location, PPROF_LOCATION_ID, [locationId unsignedLongLongValue]);
+                if (frame->image != PROFILE_NO_IMAGE) {
+                    pb_uint64(location, PPROF_LOCATION_MAPPING_ID, frame->image + 1);
+                    [mappings addIndex: frame->image];
+                }
+                pb_uint64(location, PPROF_LOCATION_ADDRESS, address);
+                pb_bytes(location, PPROF_LOCATION_LINE, line);
+                pb_bytes(output, PPROF_PROFILE_LOCATION, location);
+            }
+
+            /* pprof orders sample locations from the leaf outward, matching the recorded frame order */
+            pb_varint(locationIds, [locationId unsignedLongLongValue]);
+        }
+
+        NSMutableData *values = [NSMutableData data];
+        pb_varint(values, [ctx->stacks countForObject: stack]);
+
+        NSMutableData *sample = [NSMutableData data];
+        pb_bytes(sample, PPROF_SAMPLE_LOCATION_ID, locationIds);
+        pb_bytes(sample, PPROF_SAMPLE_VALUE, values);
+        pb_bytes(output, PPROF_PROFILE_SAMPLE, sample);
+
+        [pool release];
+    }
+
+    /* Mappings */
+    for (NSUInteger index = [mappings firstIndex]; index != NSNotFound; index = [mappings indexGreaterThanIndex: index]) {
+        PLCrashProfileImage *image = [ctx->images objectAtIndex: index];
+        NSMutableData *mapping = [NSMutableData data];
+
+        pb_uint64(mapping, PPROF_MAPPING_ID, index + 1);
+        pb_uint64(mapping, PPROF_MAPPING_MEMORY_START, pprof_mapping_base((uint32_t) index));
+        pb_uint64(mapping, PPROF_MAPPING_MEMORY_LIMIT, pprof_mapping_base((uint32_t) index) + image->_size);
+        pb_uint64(mapping, PPROF_MAPPING_FILENAME, pprof_string(strings, stringIndex, image->_path));
+        pb_uint64(mapping, PPROF_MAPPING_BUILD_ID, pprof_string(strings, stringIndex, image->_key));
+        pb_uint64(mapping, PPROF_MAPPING_HAS_FUNCTIONS, 1);
+        pb_bytes(output, PPROF_PROFILE_MAPPING, mapping);
+    }
+
+    /* Comment */
+    NSString *comment = [NSString stringWithFormat: @"plcrashutil hang profile of %lld reports", (long long) ctx->reports];
+    pb_uint64(output, PPROF_PROFILE_COMMENT, pprof_string(strings, stringIndex, comment));
+
+    /* String table; must be written last, once all strings have been interned */
+    for (NSString *string in strings)
+        pb_bytes(output, PPROF_PROFILE_STRING_TABLE, [string dataUsingEncoding: NSUTF8StringEncoding]);
+
+    return output;
+}
+
+/*
+ * Run a profile export.
+ */
+int profile_command (int argc, char *argv[]) {
+    const char *format = "collapsed";
+    const char *output = NULL;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "format",     required_argument,      NULL,          'f' },
+        { "output",     required_argument,      NULL,          'o' },
+        { "jobs",       required_argument,      NULL,          'j' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "f:o:j:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'f':
+                format = optarg;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        fprintf(stderr, "No input file supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    if (jobs < 1) {
+        fprintf(stderr, "Invalid job count\n");
+        return 1;
+    }
+
+    profile_format_t profileFormat;
+    if (strcasecmp(format, "collapsed") == 0) {
+        profileFormat = PROFILE_FORMAT_COLLAPSED;
+    } else if (strcasecmp(format, "pprof") == 0) {
+        profileFormat = PROFILE_FORMAT_PPROF;
+    } else {
+        fprintf(stderr, "Unsupported format requested\n");
+        print_usage();
+        return 1;
+    }
+
+    /* Gather the inputs; directories are expanded to their .plcrash files, in a stable order */
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableArray *inputs = [NSMutableArray array];
+    NSError *error;
+
+    for (int i = 0; i < argc; i++) {
+        NSString *path = [fileManager stringWithFileSystemRepresentation: argv[i] length: strlen(argv[i])];
+        BOOL isDirectory = NO;
+
+        if (![fileManager fileExistsAtPath: path isDirectory: &isDirectory] || !isDirectory) {
+            [inputs addObject: path];
+            continue;
+        }
+
+        NSArray *entries = [fileManager contentsOfDirectoryAtPath: path error: &error];
+        if (entries == nil) {
+            fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+
+        for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+            if ([[entry pathExtension] caseInsensitiveCompare: @"plcrash"] == NSOrderedSame)
+                [inputs addObject: [path stringByAppendingPathComponent: entry]];
+        }
+    }
+
+    /* Run the workers */
+    profile_context_t ctx = {
+        .inputs = inputs,
+        .next = 0,
+        .images = [NSMutableArray array],
+        .imageIndex = [NSMutableDictionary dictionary],
+        .stacks = [NSCountedSet set],
+        .reports = 0,
+        .samples = 0,
+        .failed = 0
+    };
+    pthread_mutex_init(&ctx.lock, NULL);
+
+    if ((NSUInteger) jobs > [inputs count])
+        jobs = MAX(1, [inputs count]);
+
+    pthread_t *threads = calloc(jobs, sizeof(pthread_t));
+    long started = 0;
+
+    for (; started < jobs; started++) {
+        int err = pthread_create(&threads[started], NULL, profile_worker, &ctx);
+        if (err != 0) {
+            fprintf(stderr, "Could not create worker thread: %s\n", strerror(err));
+            break;
+        }
+    }
+
+    /* If no workers could be started, fall back on aggregating on this thread */
+    if (started == 0)
+        profile_worker(&ctx);
+
+    for (long i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&ctx.lock);
+
+    /* All symbols have been gathered; build the symbol tables and resolve */
+    for (PLCrashProfileImage *image in ctx.images)
+        [image buildSymbolTable];
+
+    NSData *result = nil;
+    switch (profileFormat) {
+        case PROFILE_FORMAT_COLLAPSED:
+            result = profile_collapsed(&ctx);
+            break;
+        case PROFILE_FORMAT_PPROF:
+            result = profile_pprof(&ctx);
+            break;
+    }
+
+    /* Write the profile */
+    if (output != NULL) {
+        NSString *outputPath = [fileManager stringWithFileSystemRepresentation: output length: strlen(output)];
+        if (![result writeToFile: outputPath options: NSDataWritingAtomic error: &error]) {
+            fprintf(stderr, "Could not write output file: %s\n", [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+    } else if (fwrite([result bytes], 1, [result length], stdout) != [result length]) {
+        fprintf(stderr, "Could not write profile\n");
+        return 1;
+    }
+
+    fprintf(stderr, "Aggregated %lld samples from %lld reports (%lld failed) using %ld workers\n",
+            (long long) ctx.samples, (long long) ctx.reports, (long long) ctx.failed, MAX(started, 1L));
+
+    return ctx.failed == 0 ? 0 : 1;
+}
+
+/* Number of independently locked bucket table shards; must be a power of two */
+#define BUCKET_SHARD_COUNT 64
+
+/* Initial capacity of a bucket table shard; must be a power of two */
+#define BUCKET_SHARD_INITIAL_CAPACITY 64
+
+/* Default number of buckets output */
+#define BUCKET_DEFAULT_TOP 20
+
+/* Default number of crashed thread frames included in each fingerprint; matches the library default */
+#define BUCKET_DEFAULT_FRAMES 5
+
+/*
+ * A single crash bucket.
+ */
+typedef struct bucket_entry {
+    /* The bucket fingerprint, in host byte order */
+    uint64_t fingerprint;
+
+    /* Number of reports with this fingerprint; zero if the table slot is unused */
+    uint64_t count;
+
+    /* Input index and report index (within the input) of the representative report. The earliest report in
+     * input order is used, such that the output does not depend on worker scheduling. */
+    uint32_t input;
+    uint32_t report;
+} bucket_entry_t;
+
+/*
+ * A shard of the concurrent bucket table; an open addressed hash table of bucket entries, protected by its
+ * own lock. Fingerprints are uniformly distributed, and are used directly as hash values.
+ */
+typedef struct bucket_shard {
+    /* Protects the values below */
+    pthread_mutex_t lock;
+
+    /* Table slots; @a capacity is always a power of two */
+    bucket_entry_t *entries;
+    size_t capacity;
+
+    /* Number of used slots */
+    size_t used;
+} bucket_shard_t;
+
+/*
+ * Shared bucketing state. The input list is read-only once the workers have started; all other shared
+ * values are modified with the owning shard's lock held, or atomically.
+ */
+typedef struct bucket_context {
+    /* Input file paths */
+    NSArray *inputs;
+
+    /* Number of crashed thread frames included in each fingerprint */
+    NSUInteger frameCount;
+
+    /* Index of the next unclaimed input */
+    volatile int32_t next;
+
+    /* Bucket table shards, selected by the high bits of the fingerprint */
+    bucket_shard_t shards[BUCKET_SHARD_COUNT];
+
+    /* Number of reports bucketed */
+    volatile int64_t reports;
+
+    /* Number of reports (or input files) that could not be read */
+    volatile int64_t failed;
+} bucket_context_t;
+
+/*
+ * Insert @a entry into @a entries without checking for an existing entry. The table must have a free slot.
+ */
+static void bucket_shard_place (bucket_entry_t *entries, size_t capacity, const bucket_entry_t *entry) {
+    size_t mask = capacity - 1;
+    for (size_t i = entry->fingerprint & mask; ; i = (i + 1) & mask) {
+        if (entries[i].count == 0) {
+            entries[i] = *entry;
+            return;
+        }
+    }
+}
+
+/*
+ * Record a report with @a fingerprint at the given input and report index.
+ */
+static void bucket_add (bucket_context_t *ctx, uint64_t fingerprint, uint32_t input, uint32_t report) {
+    bucket_shard_t *shard = &ctx->shards[fingerprint >> (64 - __builtin_ctz(BUCKET_SHARD_COUNT))];
+
+    pthread_mutex_lock(&shard->lock);
+
+    /* Grow at a 3/4 load factor */
+    if ((shard->used + 1) * 4 > shard->capacity * 3) {
+        size_t capacity = shard->capacity * 2;
+        bucket_entry_t *entries = calloc(capacity, sizeof(bucket_entry_t));
+        for (size_t i = 0; i < shard->capacity; i++) {
+            if (shard->entries[i].count != 0)
+                bucket_shard_place(entries, capacity, &shard->entries[i]);
+        }
+
+        free(shard->entries);
+        shard->entries = entries;
+        shard->capacity = capacity;
+    }
+
+    size_t mask = shard->capacity - 1;
+    for (size_t i = fingerprint & mask; ; i = (i + 1) & mask) {
+        bucket_entry_t *entry = &shard->entries[i];
+
+        if (entry->count == 0) {
+            entry->fingerprint = fingerprint;
+            entry->count = 1;
+            entry->input = input;
+            entry->report = report;
+            shard->used++;
+            break;
+        }
+
+        if (entry->fingerprint == fingerprint) {
+            entry->count++;
+            if (input < entry->input || (input == entry->input && report < entry->report)) {
+                entry->input = input;
+                entry->report = report;
+            }
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&shard->lock);
+}
+
+/*
+ * Fingerprint all reports in the input at @a index.
+ */
+static void bucket_file (bucket_context_t *ctx, uint32_t index) {
+    NSString *path = [ctx->inputs objectAtIndex: index];
+    report_reader_t reader = { 0 };
+    const uint8_t *bytes;
+    size_t length;
+    NSError *error;
+    int read;
+
+    reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+    reader.eof = true;
+    if (reader.mapped == nil) {
+        fprintf(stderr, "Could not read input file %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+        return;
+    }
+
+    for (uint32_t report = 0; (read = report_reader_next(&reader, &bytes, &length)) == 1; report++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+        /* Only the fingerprinted fields are visited; the report itself is never decoded */
+        NSData *data = [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO];
+        NSData *fingerprint = [PLCrashReport fingerprintForData: data frameCount: ctx->frameCount error: &error];
+        if (fingerprint == nil) {
+            fprintf(stderr, "Could not fingerprint crash log %lu in %s: %s\n", (unsigned long) report, [path fileSystemRepresentation],
+                    [[error localizedDescription] UTF8String]);
+            OSAtomicIncrement64Barrier(&ctx->failed);
+        } else {
+            uint64_t value;
+            [fingerprint getBytes: &value length: sizeof(value)];
+            bucket_add(ctx, OSSwapBigToHostInt64(value), index, report);
+            OSAtomicIncrement64Barrier(&ctx->reports);
+        }
+
+        [pool release];
+    }
+
+    if (read < 0) {
+        fprintf(stderr, "Could not read crash log data from %s\n", [path fileSystemRepresentation]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+    }
+}
+
+/*
+ * Bucketing worker thread; claims and fingerprints inputs until none remain.
+ */
+static void *bucket_worker (void *arg) {
+    bucket_context_t *ctx = arg;
+
+    while (true) {
+        int32_t idx = OSAtomicIncrement32Barrier(&ctx->next) - 1;
+        if (idx >= (int32_t) [ctx->inputs count])
+            break;
+
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        bucket_file(ctx, (uint32_t) idx);
+        [pool release];
+    }
+
+    return NULL;
+}
+
+/*
+ * Order buckets by descending report count, and then by fingerprint.
+ */
+static int bucket_entry_compare (const void *lhs, const void *rhs) {
+    const bucket_entry_t *a = lhs;
+    const bucket_entry_t *b = rhs;
+
+    if (a->count != b->count)
+        return a->count > b->count ? -1 : 1;
+
+    if (a->fingerprint != b->fingerprint)
+        return a->fingerprint < b->fingerprint ? -1 : 1;
+
+    return 0;
+}
+
+/*
+ * Run a bucketing pass.
+ */
+int bucket_command (int argc, char *argv[]) {
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    long top = BUCKET_DEFAULT_TOP;
+    long frames = BUCKET_DEFAULT_FRAMES;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "top",        required_argument,      NULL,          't' },
+        { "frames",     required_argument,      NULL,          'n' },
+        { "jobs",       required_argument,      NULL,          'j' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "t:n:j:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 't':
+                top = strtol(optarg, NULL, 10);
+                break;
+            case 'n':
+                frames = strtol(optarg, NULL, 10);
+                break;
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        fprintf(stderr, "No input file supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    if (jobs < 1) {
+        fprintf(stderr, "Invalid job count\n");
+        return 1;
+    }
+
+    if (top < 0) {
+        fprintf(stderr, "Invalid bucket count\n");
+        return 1;
+    }
+
+    if (frames < 1) {
+        fprintf(stderr, "Invalid frame count\n");
+        return 1;
+    }
+
+    /* Gather the inputs; directories are expanded to their .plcrash files, in a stable order */
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableArray *inputs = [NSMutableArray array];
+    NSError *error;
+
+    for (int i = 0; i < argc; i++) {
+        NSString *path = [fileManager stringWithFileSystemRepresentation: argv[i] length: strlen(argv[i])];
+        BOOL isDirectory = NO;
+
+        if (![fileManager fileExistsAtPath: path isDirectory: &isDirectory] || !isDirectory) {
+            [inputs addObject: path];
+            continue;
+        }
+
+        NSArray *entries = [fileManager contentsOfDirectoryAtPath: path error: &error];
+        if (entries == nil) {
+            fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+
+        for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+            if ([[entry pathExtension] caseInsensitiveCompare: @"plcrash"] == NSOrderedSame)
+                [inputs addObject: [path stringByAppendingPathComponent: entry]];
+        }
+    }
+
+    /* Set up the bucket table */
+    bucket_context_t *ctx = calloc(1, sizeof(bucket_context_t));
+    ctx->inputs = inputs;
+    ctx->frameCount = frames;
+    for (size_t i = 0; i < BUCKET_SHARD_COUNT; i++) {
+        pthread_mutex_init(&ctx->shards[i].lock, NULL);
+        ctx->shards[i].capacity = BUCKET_SHARD_INITIAL_CAPACITY;
+        ctx->shards[i].entries = calloc(BUCKET_SHARD_INITIAL_CAPACITY, sizeof(bucket_entry_t));
+    }
+
+    /* Run the workers */
+    NSTimeInterval start = [NSDate timeIntervalSinceReferenceDate];
+
+    if ((NSUInteger) jobs > [inputs count])
+        jobs = MAX(1, [inputs count]);
+
+    pthread_t *threads = calloc(jobs, sizeof(pthread_t));
+    long started = 0;
+
+    for (; started < jobs; started++) {
+        int err = pthread_create(&threads[started], NULL, bucket_worker, ctx);
+        if (err != 0) {
+            fprintf(stderr, "Could not create worker thread: %s\n", strerror(err));
+            break;
+        }
+    }
+
+    /* If no workers could be started, fall back on bucketing on this thread */
+    if (started == 0)
+        bucket_worker(ctx);
+
+    for (long i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+
+    NSTimeInterval elapsed = [NSDate timeIntervalSinceReferenceDate] - start;
+
+    /* Collect and rank the buckets */
+    size_t bucketCount = 0;
+    for (size_t i = 0; i < BUCKET_SHARD_COUNT; i++)
+        bucketCount += ctx->shards[i].used;
+
+    bucket_entry_t *buckets = calloc(MAX(bucketCount, 1), sizeof(bucket_entry_t));
+    size_t collected = 0;
+    for (size_t i = 0; i < BUCKET_SHARD_COUNT; i++) {
+        bucket_shard_t *shard = &ctx->shards[i];
+        for (size_t j = 0; j < shard->capacity; j++) {
+            if (shard->entries[j].count != 0)
+                buckets[collected++] = shard->entries[j];
+        }
+
+        free(shard->entries);
+        pthread_mutex_destroy(&shard->lock);
+    }
+
+    qsort(buckets, bucketCount, sizeof(bucket_entry_t), bucket_entry_compare);
+
+    /* Write the top buckets; a top count of zero writes all buckets */
+    size_t output = (top == 0 || (size_t) top > bucketCount) ? bucketCount : (size_t) top;
+    for (size_t i = 0; i < output; i++) {
+        const bucket_entry_t *bucket = &buckets[i];
+        const char *path = [[inputs objectAtIndex: bucket->input] fileSystemRepresentation];
+
+        if (bucket->report == 0) {
+            printf("%10llu  %016llx  %s\n", (unsigned long long) bucket->count, (unsigned long long) bucket->fingerprint, path);
+        } else {
+            printf("%10llu  %016llx  %s (report %lu)\n", (unsigned long long) bucket->count, (unsigned long long) bucket->fingerprint,
+                   path, (unsigned long) bucket->report);
+        }
+    }
+
+    fprintf(stderr, "Bucketed %lld reports (%lld failed) into %zu buckets in %.2fs using %ld workers\n",
+            (long long) ctx->reports, (long long) ctx->failed, bucketCount, elapsed, MAX(started, 1L));
+
+    int ret = ctx->failed == 0 ? 0 : 1;
+    free(buckets);
+    free(ctx);
+
+    return ret;
+}
+
+/*
+ * Print the debug trace of all reports available from @a reader. Returns 0 on success, or 1 if any report could not
+ * be decoded.
+ */
+static int trace_reports (report_reader_t *reader, const char *source) {
+    const uint8_t *bytes;
+    size_t length;
+    int ret = 0;
+    int read;
+
+    for (NSUInteger index = 0; (read = report_reader_next(reader, &bytes, &length)) == 1; index++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSError *error;
+
+        NSData *data = [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO];
+        PLCrashReport *crashLog = [[[PLCrashReport alloc] initWithData: data options: PLCrashReportDecodingOptionLazy error: &error] autorelease];
+        if (crashLog == nil) {
+            fprintf(stderr, "Could not decode crash log %lu in %s: %s\n", (unsigned long) index, source,
+                    [[error localizedDescription] UTF8String]);
+            ret = 1;
+        } else {
+            printf("%s [%lu]: %lu events\n", source, (unsigned long) index, (unsigned long) [crashLog.debugTrace count]);
+            for (NSString *event in crashLog.debugTrace)
+                printf("  %s\n", [event UTF8String]);
+        }
+
+        [pool release];
+    }
+
+    if (read < 0) {
+        fprintf(stderr, "Could not read crash log data from %s\n", source);
+        ret = 1;
+    }
+
+    return ret;
+}
+
+/*
+ * Print the crash reporter debug trace recorded in each report.
+ */
+int trace_command (int argc, char *argv[]) {
+    NSMutableData *buffer = [NSMutableData dataWithCapacity: READER_CHUNK_SIZE];
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    int ret = 0;
+
+    if (argc < 1) {
+        fprintf(stderr, "No input file supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    for (int i = 0; i < argc; i++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSString *path = [fileManager stringWithFileSystemRepresentation: argv[i] length: strlen(argv[i])];
+        report_reader_t reader = { 0 };
+        NSError *error;
+
+        if ([path isEqualToString: @"-"]) {
+            reader.input = stdin;
+            reader.buffer = buffer;
+            [buffer setLength: 0];
+        } else {
+            reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+            if (reader.mapped == nil) {
+                fprintf(stderr, "Could not read input file: %s\n", [[error localizedDescription] UTF8String]);
+                ret = 1;
+                [pool release];
+                continue;
+            }
+            reader.eof = true;
+        }
+
+        if (trace_reports(&reader, [path fileSystemRepresentation]) != 0)
+            ret = 1;
+
+        [pool release];
+    }
+
+    return ret;
+}
+
+/* Maximum number of inlined subroutines written for a single frame */
+#define SYMBOLICATE_INLINE_DEPTH_MAX 32
+
+/*
+ * A single architecture slice of a dSYM debug file. The symbol index is mapped from the index cache if
+ * available, and is otherwise built on first use (and written to the cache, if any).
+ */
+@interface PLCrashSymbolFile : NSObject {
+@public
+    /* The debug file path, or for an index loaded solely from the cache, the index file path */
+    NSString *_path;
+
+    /* The mapped debug file, or nil if only the cached index is available */
+    NSData *_data;
+
+    /* The slice's UUID */
+    uint8_t _uuid[16];
+
+    /* The index cache path for this slice, or nil if the cache is disabled */
+    NSString *_cachePath;
+
+    /* The slice's offset and size within the debug file */
+    uint64_t _sliceOffset;
+    uint64_t _sliceSize;
+
+    /* The link-time address of the slice's __TEXT segment */
+    uint64_t _textAddress;
+
+    /* The slice's DWARF sections */
+    dsym_dwarf_t _dwarf;
+
+    /* Protects lazy construction of the index */
+    pthread_mutex_t _lock;
+
+    /* True once construction of the index has been attempted */
+    volatile bool _built;
+
+    /* True if the index is valid */
+    bool _valid;
+
+    /* The symbol index; read-only once _built is set */
+    dsym_index_t _index;
+}
+@end
+
+@implementation PLCrashSymbolFile
+
+- (id) initWithPath: (NSString *) path data: (NSData *) data sliceOffset: (uint64_t) offset size: (uint64_t) size {
+    if ((self = [super init]) == nil)
+        return nil;
+
+    _path = [path copy];
+    _data = [data retain];
+    _sliceOffset = offset;
+    _sliceSize = size;
+    pthread_mutex_init(&_lock, NULL);
+
+    return self;
+}
+
+/*
+ * Initialize a symbol file with no debug file, backed solely by the cached index at @a cachePath.
+ */
+- (id) initWithUUID: (const uint8_t *) uuid cachePath: (NSString *) cachePath {
+    if ((self = [self initWithPath: cachePath data: nil sliceOffset: 0 size: 0]) == nil)
+        return nil;
+
+    memcpy(_uuid, uuid, sizeof(_uuid));
+    _cachePath = [cachePath copy];
+
+    return self;
+}
+
+- (void) dealloc {
+    if (_valid)
+        dsym_index_free(&_index);
+
+    pthread_mutex_destroy(&_lock);
+    [_cachePath release];
+    [_path release];
+    [_data release];
+    [super dealloc];
+}
+
+/*
+ * Return the slice's symbol index, mapping or building it if necessary, or NULL if no index is available.
+ */
+- (const dsym_index_t *) index {
+    if (!_built) {
+        pthread_mutex_lock(&_lock);
+        if (!_built) {
+            if (_cachePath != nil)
+                _valid = dsym_index_map([_cachePath fileSystemRepresentation], _uuid, &_index);
+
+            if (!_valid && _data != nil) {
+                _valid = dsym_index_build(&_dwarf, &_index);
+                if (!_valid) {
+                    fprintf(stderr, "Could not index the debug information in %s\n", [_path fileSystemRepresentation]);
+                } else {
+                    memcpy(_index.uuid, _uuid, sizeof(_index.uuid));
+                    _index.text_address = _textAddress;
+
+                    /* A cache write failure is not fatal; the index will be rebuilt by the next run */
+                    if (_cachePath != nil && !dsym_index_write(&_index, [_cachePath fileSystemRepresentation]))
+                        fprintf(stderr, "Could not write symbol index %s\n", [_cachePath fileSystemRepresentation]);
+                }
+            }
+
+            OSMemoryBarrier();
+            _built = true;
+        }
+        pthread_mutex_unlock(&_lock);
+    }
+
+    OSMemoryBarrier();
+    return _valid ? &_index : NULL;
+}
+
+@end
+
+/*
+ * Record the DWARF sections of the __DWARF segment load command @a cmd against @a dwarf. The section offsets are
+ * relative to @a slice, of @a size bytes. Returns false if the load command is malformed.
+ */
+static bool dsym_slice_add_sections (dsym_dwarf_t *dwarf, const uint8_t *slice, uint64_t size, const struct load_command *cmd) {
+    bool is64 = (cmd->cmd == LC_SEGMENT_64);
+    uint32_t nsects = is64 ? ((const struct segment_command_64 *) cmd)->nsects : ((const struct segment_command *) cmd)->nsects;
+    size_t segSize = is64 ? sizeof(struct segment_command_64) : sizeof(struct segment_command);
+    size_t sectSize = is64 ? sizeof(struct section_64) : sizeof(struct section);
+
+    if (cmd->cmdsize < segSize || nsects > (cmd->cmdsize - segSize) / sectSize)
+        return false;
+
+    for (uint32_t i = 0; i < nsects; i++) {
+        const uint8_t *sect = (const uint8_t *) cmd + segSize + i * sectSize;
+        const char *sectname = is64 ? ((const struct section_64 *) sect)->sectname : ((const struct section *) sect)->sectname;
+        uint64_t offset = is64 ? ((const struct section_64 *) sect)->offset : ((const struct section *) sect)->offset;
+        uint64_t length = is64 ? ((const struct section_64 *) sect)->size : ((const struct section *) sect)->size;
+
+        if (offset > size || length > size - offset)
+            continue;
+
+        /* Section names are not NUL-terminated if they fill the field */
+        char name[sizeof(((struct section *) NULL)->sectname) + 1] = { 0 };
+        memcpy(name, sectname, sizeof(name) - 1);
+        dsym_section_t section = { slice + offset, length };
+
+        if (strcmp(name, "__debug_info") == 0) {
+            dwarf->info = section;
+        } else if (strcmp(name, "__debug_abbrev") == 0) {
+            dwarf->abbrev = section;
+        } else if (strcmp(name, "__debug_line") == 0) {
+            dwarf->line = section;
+        } else if (strcmp(name, "__debug_str") == 0) {
+            dwarf->str = section;
+        } else if (strcmp(name, "__debug_line_str") == 0) {
+            dwarf->line_str = section;
+        } else if (strcmp(name, "__debug_str_offs") == 0) {
+            dwarf->str_offsets = section;
+        } else if (strcmp(name, "__debug_addr") == 0) {
+            dwarf->addr = section;
+        } else if (strcmp(name, "__debug_ranges") == 0) {
+            dwarf->ranges = section;
+        } else if (strcmp(name, "__debug_rnglists") == 0) {
+            dwarf->rnglists = section;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * Parse the Mach-O slice at @a offset within @a data, returning the slice's symbol file if it contains a UUID and
+ * DWARF debug information.
+ */
+static PLCrashSymbolFile *dsym_slice_parse (NSString *path, NSData *data, uint64_t offset, uint64_t size, NSString **outUUID) {
+    if (offset > [data length] || size > [data length] - offset || size < sizeof(struct mach_header))
+        return nil;
+
+    const uint8_t *slice = (const uint8_t *) [data bytes] + offset;
+    const struct mach_header *header = (const struct mach_header *) slice;
+    size_t headerSize;
+
+    if (header->magic == MH_MAGIC_64) {
+        headerSize = sizeof(struct mach_header_64);
+    } else if (header->magic == MH_MAGIC) {
+        headerSize = sizeof(struct mach_header);
+    } else {
+        return nil;
+    }
+
+    if (size < headerSize || header->sizeofcmds > size - headerSize)
+        return nil;
+
+    PLCrashSymbolFile *file = [[[PLCrashSymbolFile alloc] initWithPath: path data: data sliceOffset: offset size: size] autorelease];
+    const uint8_t *cmd = slice + headerSize;
+    const uint8_t *cmdEnd = cmd + header->sizeofcmds;
+    NSString *uuid = nil;
+
+    for (uint32_t i = 0; i < header->ncmds && sizeof(struct load_command) <= (size_t) (cmdEnd - cmd); i++) {
+        const struct load_command *lc = (const struct load_command *) cmd;
+        if (lc->cmdsize < sizeof(struct load_command) || lc->cmdsize > (size_t) (cmdEnd - cmd))
+            return nil;
+
+        if (lc->cmd == LC_UUID && lc->cmdsize >= sizeof(struct uuid_command)) {
+            const uint8_t *value = ((const struct uuid_command *) lc)->uuid;
+            memcpy(file->_uuid, value, sizeof(file->_uuid));
+            NSMutableString *hex = [NSMutableString stringWithCapacity: 32];
+            for (int b = 0; b < 16; b++)
+                [hex appendFormat: @"%02x", value[b]];
+            uuid = hex;
+        } else if (lc->cmd == LC_SEGMENT_64 && lc->cmdsize >= sizeof(struct segment_command_64)) {
+            const struct segment_command_64 *segment = (const struct segment_command_64 *) lc;
+            if (strncmp(segment->segname, SEG_TEXT, sizeof(segment->segname)) == 0)
+                file->_textAddress = segment->vmaddr;
+            else if (strncmp(segment->segname, "__DWARF", sizeof(segment->segname)) == 0 && !dsym_slice_add_sections(&file->_dwarf, slice, size, lc))
+                return nil;
+        } else if (lc->cmd == LC_SEGMENT && lc->cmdsize >= sizeof(struct segment_command)) {
+            const struct segment_command *segment = (const struct segment_command *) lc;
+            if (strncmp(segment->segname, SEG_TEXT, sizeof(segment->segname)) == 0)
+                file->_textAddress = segment->vmaddr;
+            else if (strncmp(segment->segname, "__DWARF", sizeof(segment->segname)) == 0 && !dsym_slice_add_sections(&file->_dwarf, slice, size, lc))
+                return nil;
+        }
+
+        cmd += lc->cmdsize;
+    }
+
+    if (uuid == nil || file->_dwarf.info.size == 0)
+        return nil;
+
+    *outUUID = uuid;
+    return file;
+}
+
+/*
+ * Register all architecture slices of the debug file at @a path with @a files, keyed by UUID. Returns the number
+ * of slices registered.
+ */
+static NSUInteger dsym_register_file (NSMutableDictionary *files, NSString *path) {
+    NSData *data = [NSData dataWithContentsOfFile: path options: NSMappedRead error: NULL];
+    if (data == nil || [data length] < sizeof(struct fat_header))
+        return 0;
+
+    const struct fat_header *fh = [data bytes];
+    NSUInteger registered = 0;
+    NSString *uuid;
+
+    if (fh->magic != FAT_CIGAM && fh->magic != FAT_CIGAM_64) {
+        PLCrashSymbolFile *file = dsym_slice_parse(path, data, 0, [data length], &uuid);
+        if (file != nil) {
+            [files setObject: file forKey: uuid];
+            registered++;
+        }
+        return registered;
+    }
+
+    bool fat64 = (fh->magic == FAT_CIGAM_64);
+    uint32_t count = OSSwapBigToHostInt32(fh->nfat_arch);
+    size_t archSize = fat64 ? sizeof(struct fat_arch_64) : sizeof(struct fat_arch);
+    if (count > ([data length] - sizeof(struct fat_header)) / archSize)
+        return 0;
+
+    const uint8_t *archs = (const uint8_t *) [data bytes] + sizeof(struct fat_header);
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t offset, size;
+        if (fat64) {
+            const struct fat_arch_64 *arch = (const struct fat_arch_64 *) (archs + i * archSize);
+            offset = OSSwapBigToHostInt64(arch->offset);
+            size = OSSwapBigToHostInt64(arch->size);
+        } else {
+            const struct fat_arch *arch = (const struct fat_arch *) (archs + i * archSize);
+            offset = OSSwapBigToHostInt32(arch->offset);
+            size = OSSwapBigToHostInt32(arch->size);
+        }
+
+        PLCrashSymbolFile *file = dsym_slice_parse(path, data, offset, size, &uuid);
+        if (file != nil) {
+            [files setObject: file forKey: uuid];
+            registered++;
+        }
+    }
+
+    return registered;
+}
+
+/*
+ * Register the debug files at @a path, which may be a dSYM bundle, a directory to be searched for dSYM bundles, or
+ * a single debug file. Returns the number of slices registered.
+ */
+static NSUInteger dsym_register_path (NSMutableDictionary *files, NSString *path) {
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    BOOL isDirectory = NO;
+
+    if (![fileManager fileExistsAtPath: path isDirectory: &isDirectory])
+        return 0;
+
+    if (!isDirectory)
+        return dsym_register_file(files, path);
+
+    /* A dSYM bundle; register its DWARF files */
+    if ([[path pathExtension] caseInsensitiveCompare: @"dSYM"] == NSOrderedSame) {
+        NSString *dwarfPath = [path stringByAppendingPathComponent: @"Contents/Resources/DWARF"];
+        NSUInteger registered = 0;
+
+        for (NSString *entry in [fileManager contentsOfDirectoryAtPath: dwarfPath error: NULL])
+            registered += dsym_register_file(files, [dwarfPath stringByAppendingPathComponent: entry]);
+
+        return registered;
+    }
+
+    /* Otherwise, search for dSYM bundles */
+    NSDirectoryEnumerator *enumerator = [fileManager enumeratorAtPath: path];
+    NSUInteger registered = 0;
+    NSString *entry;
+
+    while ((entry = [enumerator nextObject]) != nil) {
+        if ([[entry pathExtension] caseInsensitiveCompare: @"dSYM"] != NSOrderedSame)
+            continue;
+
+        [enumerator skipDescendents];
+        registered += dsym_register_path(files, [path stringByAppendingPathComponent: entry]);
+    }
+
+    return registered;
+}
+
+/*
+ * Shared symbolication state. The input list and symbol files are read-only once the workers have started.
+ */
+typedef struct symbolicate_context {
+    /* Input file paths */
+    NSArray *inputs;
+
+    /* Index of the next unclaimed input */
+    volatile int32_t next;
+
+    /* Debug file slices (PLCrashSymbolFile), keyed by UUID */
+    NSDictionary *files;
+
+    /* The index cache directory, or nil. Images with no debug file are symbolicated from the cache alone, via
+     * symbol files created on demand in @a cachedFiles, which is protected by @a cachedFilesLock. */
+    NSString *cacheDirectory;
+    NSMutableDictionary *cachedFiles;
+    pthread_mutex_t cachedFilesLock;
+
+    /* The demangle cache used for symbol names recorded in the reports, or NULL if demangling is disabled */
+    plcrash_demangle_cache_t *demangler;
+
+    /* Output stream, and the lock serializing writes to it */
+    FILE *output;
+    pthread_mutex_t lock;
+
+    /* Number of reports symbolicated */
+    volatile int64_t reports;
+
+    /* Number of frames written, and the number resolved via debug information */
+    volatile int64_t frames;
+    volatile int64_t resolved;
+
+    /* Number of reports (or input files) that could not be read */
+    volatile int64_t failed;
+} symbolicate_context_t;
+
+/*
+ * Return the symbol file for the image with @a uuid, or nil if none. Images with no registered debug file are
+ * looked up in the index cache.
+ */
+static PLCrashSymbolFile *symbolicate_symbol_file (symbolicate_context_t *ctx, NSString *uuid) {
+    PLCrashSymbolFile *file = [ctx->files objectForKey: uuid];
+    if (file != nil || ctx->cacheDirectory == nil)
+        return file;
+
+    /* Decode the UUID's hex representation */
+    uint8_t bytes[16];
+    const char *hex = [uuid UTF8String];
+    if (strlen(hex) != sizeof(bytes) * 2)
+        return nil;
+
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        unsigned int value;
+        if (sscanf(hex + (i * 2), "%2x", &value) != 1)
+            return nil;
+        bytes[i] = (uint8_t) value;
+    }
+
+    pthread_mutex_lock(&ctx->cachedFilesLock);
+    file = [ctx->cachedFiles objectForKey: uuid];
+    if (file == nil) {
+        NSString *cachePath = [ctx->cacheDirectory stringByAppendingPathComponent: [uuid stringByAppendingPathExtension: @"plsym"]];
+        file = [[[PLCrashSymbolFile alloc] initWithUUID: bytes cachePath: cachePath] autorelease];
+        [ctx->cachedFiles setObject: file forKey: uuid];
+    }
+    pthread_mutex_unlock(&ctx->cachedFilesLock);
+
+    return file;
+}
+
+/*
+ * Append the frame line prefix for the frame at @a pc to @a output.
+ */
+static void symbolicate_frame_prefix (NSUInteger frameIndex, NSString *imageName, BOOL lp64, uint64_t pc, NSMutableString *output) {
+    /* Equivalent to the text formatter's "%-4ld%-35S 0x%0*" PRIx64 " "; NSString does not support field widths
+     * for object arguments, and so the name is padded explicitly. */
+    [output appendFormat: @"%-4lu%@", (unsigned long) frameIndex, imageName];
+    for (NSUInteger i = [imageName length]; i < 35; i++)
+        [output appendString: @" "];
+    [output appendFormat: @" 0x%0*llx ", lp64 ? 16 : 8, (unsigned long long) pc];
+}
+
+/*
+ * Append the " (file:line)" source location of @a file and @a line to @a output, if the file is known.
+ */
+static void symbolicate_frame_location (const dsym_index_t *index, uint32_t file, uint32_t line, NSMutableString *output) {
+    const char *path = dsym_index_file(index, file);
+    if (path == NULL)
+        return;
+
+    const char *name = strrchr(path, '/');
+    [output appendFormat: @" (%s:%u)", name != NULL ? name + 1 : path, line];
+}
+
+/*
+ * Append the symbolicated frame line for @a frame to @a output. Functions inlined at the frame's address are
+ * written as additional lines with the same frame number, innermost first.
+ */
+static void symbolicate_frame (symbolicate_context_t *ctx, PLCrashReport *crashLog, PLCrashReportStackFrameInfo *frame, NSUInteger frameIndex, BOOL lp64, int64_t *resolved, NSMutableString *output) {
+    uint64_t pc = frame.instructionPointer;
+    PLCrashReportBinaryImageInfo *image = [crashLog imageForAddress: pc];
+    NSString *imageName = image != nil ? [image.imageName lastPathComponent] : @"???";
+
+    symbolicate_frame_prefix(frameIndex, imageName, lp64, pc, output);
+
+    /* Resolve via the image's debug information */
+    PLCrashSymbolFile *file = (image != nil && image.hasImageUUID) ? symbolicate_symbol_file(ctx, image.imageUUID) : nil;
+    const dsym_index_t *index = file != nil ? [file index] : NULL;
+    if (index != NULL) {
+        uint64_t address = index->text_address + (pc - image.imageBaseAddress);
+
+        /* Return addresses are attributed to their call instruction */
+        uint64_t lookup = (frameIndex > 0 && address > 0) ? address - 1 : address;
+
+        const dsym_function_t *function = dsym_index_find_function(index, lookup);
+        const char *functionName = function != NULL ? dsym_index_string(index, function->name) : NULL;
+        if (functionName != NULL) {
+            const dsym_inline_t *chain[SYMBOLICATE_INLINE_DEPTH_MAX];
+            size_t depth = dsym_index_find_inlines(index, function, lookup, chain, SYMBOLICATE_INLINE_DEPTH_MAX);
+
+            const dsym_line_t *line = dsym_index_find_line(index, lookup);
+            uint32_t lineFile = line != NULL ? line->file : DSYM_NO_FILE;
+            uint32_t lineNumber = line != NULL ? line->line : 0;
+
+            /* Each inlined function's location is within its callee's; the next location is its call site */
+            for (size_t i = depth; i > 0; i--) {
+                const char *name = dsym_index_string(index, chain[i - 1]->name);
+                [output appendFormat: @"%s [inlined]", name != NULL ? name : "???"];
+                symbolicate_frame_location(index, lineFile, lineNumber, output);
+                [output appendString: @"\n"];
+
+                symbolicate_frame_prefix(frameIndex, imageName, lp64, pc, output);
+                lineFile = chain[i - 1]->call_file;
+                lineNumber = chain[i - 1]->call_line;
+            }
+
+            [output appendFormat: @"%s + %llu", functionName, (unsigned long long) (address - function->start)];
+            symbolicate_frame_location(index, lineFile, lineNumber, output);
+            [output appendString: @"\n"];
+
+            (*resolved)++;
+            return;
+        }
+    }
+
+    /* Fall back on the symbol recorded in the report, with the '_' prefix stripped as per Apple's reports */
+    if (frame.symbolInfo != nil) {
+        NSString *symbolName = frame.symbolInfo.symbolName;
+        if ([symbolName hasPrefix: @"_"] && [symbolName length] > 1)
+            symbolName = [symbolName substringFromIndex: 1];
+
+        char *demangled = ctx->demangler != NULL ? plcrash_demangle_cache_copy(ctx->demangler, [symbolName UTF8String]) : NULL;
+        if (demangled != NULL) {
+            symbolName = [NSString stringWithUTF8String: demangled];
+            free(demangled);
+        }
+
+        [output appendFormat: @"%@ + %llu\n", symbolName, (unsigned long long) (pc - frame.symbolInfo.startAddress)];
+    } else if (image != nil) {
+        [output appendFormat: @"0x%llx + %llu\n", (unsigned long long) image.imageBaseAddress, (unsigned long long) (pc - image.imageBaseAddress)];
+    } else {
+        [output appendFormat: @"0x0 + %llu\n", (unsigned long long) pc];
+    }
+}
+
+/*
+ * Append the symbolicated backtraces of @a crashLog to @a output.
+ */
+static void symbolicate_report (symbolicate_context_t *ctx, PLCrashReport *crashLog, NSString *name, NSMutableString *output) {
+    int64_t frames = 0;
+    int64_t resolved = 0;
+
+    /* Determine the report's pointer width from its images */
+    BOOL lp64 = YES;
+    for (PLCrashReportBinaryImageInfo *image in crashLog.images) {
+        if (image.codeType != nil && image.codeType.typeEncoding == PLCrashReportProcessorTypeEncodingMach) {
+            lp64 = (image.codeType.type & CPU_ARCH_ABI64) != 0;
+            break;
+        }
+    }
+
+    [output appendFormat: @"Report: %@\n\n", name];
+
+    NSArray *exceptionFrames = crashLog.exceptionInfo.stackFrames;
+    if ([exceptionFrames count] > 0) {
+        [output appendString: @"Last Exception Backtrace:\n"];
+        for (NSUInteger i = 0; i < [exceptionFrames count]; i++, frames++)
+            symbolicate_frame(ctx, crashLog, [exceptionFrames objectAtIndex: i], i, lp64, &resolved, output);
+        [output appendString: @"\n"];
+    }
+
+    for (PLCrashReportThreadInfo *thread in crashLog.threads) {
+        if (thread.crashed)
+            [output appendFormat: @"Thread %ld Crashed:\n", (long) thread.threadNumber];
+        else
+            [output appendFormat: @"Thread %ld:\n", (long) thread.threadNumber];
+
+        /* Frames are numbered by their depth, as per the text formatter */
+        NSUInteger depth = 0;
+        for (PLCrashReportStackFrameInfo *frame in thread.stackFrames) {
+            symbolicate_frame(ctx, crashLog, frame, depth++, lp64, &resolved, output);
+            frames++;
+
+            if (frame.repeatLength > 0 && frame.repeatCount > 0) {
+                [output appendFormat: @"... %lu frames repeated %lu more times ...\n", (unsigned long) frame.repeatLength, (unsigned long) frame.repeatCount];
+                depth += frame.repeatLength * frame.repeatCount;
+            }
+
+            if (frame.omittedFrameCount > 0) {
+                [output appendFormat: @"... %lu frames omitted ...\n", (unsigned long) frame.omittedFrameCount];
+                depth += frame.omittedFrameCount;
+            }
+        }
+        [output appendString: @"\n"];
+    }
+
+    OSAtomicIncrement64Barrier(&ctx->reports);
+    OSAtomicAdd64Barrier(frames, &ctx->frames);
+    OSAtomicAdd64Barrier(resolved, &ctx->resolved);
+}
+
+/*
+ * Decode and symbolicate @a data, appending the result to @a output.
+ */
+static void symbolicate_data (symbolicate_context_t *ctx, NSData *data, NSString *path, NSUInteger index, NSMutableString *output) {
+    NSError *error;
+    PLCrashReport *crashLog = [[[PLCrashReport alloc] initWithData: data
+                                                           options: PLCrashReportDecodingOptionLazy
+                                                             error: &error] autorelease];
+    if (crashLog == nil) {
+        fprintf(stderr, "Could not decode crash log %lu in %s: %s\n", (unsigned long) index, [path fileSystemRepresentation],
+                [[error localizedDescription] UTF8String]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+        return;
+    }
+
+    symbolicate_report(ctx, crashLog, [NSString stringWithFormat: @"%@ #%lu", path, (unsigned long) index], output);
+}
+
+/*
+ * Symbolicate all reports in a single input file or archive. The file's output is written as a single block.
+ */
+static void symbolicate_file (symbolicate_context_t *ctx, NSString *path) {
+    report_reader_t reader = { 0 };
+    NSMutableString *output = [NSMutableString string];
+    NSError *error;
+
+    reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+    reader.eof = true;
+    if (reader.mapped == nil) {
+        fprintf(stderr, "Could not read input file %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+        OSAtomicIncrement64Barrier(&ctx->failed);
+        return;
+    }
+
+    if ([PLCrashReportArchive isArchiveData: reader.mapped]) {
+        PLCrashReportArchive *archive = [[[PLCrashReportArchive alloc] initWithData: reader.mapped error: &error] autorelease];
+        if (archive == nil) {
+            fprintf(stderr, "Could not read archive %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+            OSAtomicIncrement64Barrier(&ctx->failed);
+            return;
+        }
+
+        for (NSUInteger index = 0; index < [archive count]; index++) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            symbolicate_data(ctx, [archive reportDataAtIndex: index], path, index, output);
+            [pool release];
+        }
+    } else {
+        const uint8_t *bytes;
+        size_t length;
+        int read;
+
+        for (NSUInteger index = 0; (read = report_reader_next(&reader, &bytes, &length)) == 1; index++) {
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            symbolicate_data(ctx, [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO], path, index, output);
+            [pool release];
+        }
+
+        if (read < 0) {
+            fprintf(stderr, "Could not read crash log data from %s\n", [path fileSystemRepresentation]);
+            OSAtomicIncrement64Barrier(&ctx->failed);
+        }
+    }
+
+    const char *utf8 = [output UTF8String];
+    pthread_mutex_lock(&ctx->lock);
+    fputs(utf8, ctx->output);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+/*
+ * Symbolication worker thread; claims and symbolicates inputs until none remain.
+ */
+static void *symbolicate_worker (void *arg) {
+    symbolicate_context_t *ctx = arg;
+
+    while (true) {
+        int32_t idx = OSAtomicIncrement32Barrier(&ctx->next) - 1;
+        if (idx >= (int32_t) [ctx->inputs count])
+            break;
+
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        symbolicate_file(ctx, [ctx->inputs objectAtIndex: idx]);
+        [pool release];
+    }
+
+    return NULL;
+}
+
+int symbolicate_command (int argc, char *argv[]) {
+    const char *output = NULL;
+    NSString *cacheDirectory = nil;
+    BOOL demangle = NO;
+    long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSMutableDictionary *files = [NSMutableDictionary dictionary];
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "dsym",       required_argument,      NULL,          'd' },
+        { "cache",      required_argument,      NULL,          'c' },
+        { "demangle",   no_argument,            NULL,          'D' },
+        { "output",     required_argument,      NULL,          'o' },
+        { "jobs",       required_argument,      NULL,          'j' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "d:c:Do:j:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'd': {
+                NSString *path = [fileManager stringWithFileSystemRepresentation: optarg length: strlen(optarg)];
+                if (dsym_register_path(files, path) == 0)
+                    fprintf(stderr, "No debug information found in %s\n", optarg);
+                break;
+            }
+            case 'c':
+                cacheDirectory = [fileManager stringWithFileSystemRepresentation: optarg length: strlen(optarg)];
+                break;
+            case 'D':
+                demangle = YES;
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        fprintf(stderr, "No input file supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    if (jobs < 1) {
+        fprintf(stderr, "Invalid job count\n");
+        return 1;
+    }
+
+    /* Configure the index cache; each slice's index is stored as <uuid>.plsym */
+    if (cacheDirectory != nil) {
+        NSError *cacheError;
+        if (![fileManager createDirectoryAtPath: cacheDirectory withIntermediateDirectories: YES attributes: nil error: &cacheError]) {
+            fprintf(stderr, "Could not create cache directory: %s\n", [[cacheError localizedDescription] UTF8String]);
+            return 1;
+        }
+
+        for (NSString *uuid in files) {
+            PLCrashSymbolFile *file = [files objectForKey: uuid];
+            file->_cachePath = [[cacheDirectory stringByAppendingPathComponent: [uuid stringByAppendingPathExtension: @"plsym"]] retain];
+        }
+    }
+
+    /* Gather the inputs; directories are expanded to their .plcrash files, in a stable order */
+    NSMutableArray *inputs = [NSMutableArray array];
+    NSError *error;
+
+    for (int i = 0; i < argc; i++) {
+        NSString *path = [fileManager stringWithFileSystemRepresentation: argv[i] length: strlen(argv[i])];
+        BOOL isDirectory = NO;
+
+        if (![fileManager fileExistsAtPath: path isDirectory: &isDirectory] || !isDirectory) {
+            [inputs addObject: path];
+            continue;
+        }
+
+        NSArray *entries = [fileManager contentsOfDirectoryAtPath: path error: &error];
+        if (entries == nil) {
+            fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
+            return 1;
+        }
+
+        for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+            if ([[entry pathExtension] caseInsensitiveCompare: @"plcrash"] == NSOrderedSame)
+                [inputs addObject: [path stringByAppendingPathComponent: entry]];
+        }
+    }
+
+    FILE *outputFile = stdout;
+    if (output != NULL && (outputFile = fopen(output, "w")) == NULL) {
+        fprintf(stderr, "Could not open output file: %s\n", strerror(errno));
+        return 1;
+    }
+
+    /* Run the workers. Each file's output is written as a single block, in order of completion. */
+    symbolicate_context_t ctx = {
+        .inputs = inputs,
+        .next = 0,
+        .files = files,
+        .cacheDirectory = cacheDirectory,
+        .cachedFiles = [NSMutableDictionary dictionary],
+        .demangler = demangle ? plcrash_demangle_cache_shared() : NULL,
+        .output = outputFile,
+        .reports = 0,
+        .frames = 0,
+        .resolved = 0,
+        .failed = 0
+    };
+    pthread_mutex_init(&ctx.lock, NULL);
+    pthread_mutex_init(&ctx.cachedFilesLock, NULL);
+
+    if ((NSUInteger) jobs > [inputs count])
+        jobs = MAX(1, [inputs count]);
+
+    pthread_t *threads = calloc(jobs, sizeof(pthread_t));
+    long started = 0;
+
+    for (; started < jobs; started++) {
+        int err = pthread_create(&threads[started], NULL, symbolicate_worker, &ctx);
+        if (err != 0) {
+            fprintf(stderr, "Could not create worker thread: %s\n", strerror(err));
+            break;
+        }
+    }
+
+    /* If no workers could be started, fall back on symbolicating on this thread */
+    if (started == 0)
+        symbolicate_worker(&ctx);
+
+    for (long i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&ctx.lock);
+    pthread_mutex_destroy(&ctx.cachedFilesLock);
+
+    if (outputFile != stdout && fclose(outputFile) != 0) {
+        fprintf(stderr, "Could not write output file: %s\n", strerror(errno));
+        return 1;
+    }
+
+    fprintf(stderr, "Symbolicated %lld reports (%lld failed); resolved %lld of %lld frames using %lu debug files and %ld workers\n",
+            (long long) ctx.reports, (long long) ctx.failed, (long long) ctx.resolved, (long long) ctx.frames,
+            (unsigned long) [files count], MAX(started, 1L));
+
+    return ctx.failed == 0 ? 0 : 1;
+}
+
+
+/*
+ * Add all reports in @a path to @a writer. Returns 0 on success, or 1 if any report could not be added.
+ */
+static int pack_file (PLCrashReportArchiveWriter *writer, NSString *path) {
+    report_reader_t reader = { 0 };
+    const uint8_t *bytes;
+    size_t length;
+    NSError *error;
+    int ret = 0;
+    int read;
+
+    reader.mapped = [NSData dataWithContentsOfFile: path options: NSMappedRead error: &error];
+    reader.eof = true;
+    if (reader.mapped == nil) {
+        fprintf(stderr, "Could not read input file %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    for (NSUInteger index = 0; (read = report_reader_next(&reader, &bytes, &length)) == 1; index++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+
+        NSData *data = [NSData dataWithBytesNoCopy: (void *) bytes length: length freeWhenDone: NO];
+        if (![writer addReportData: data error: &error]) {
+            fprintf(stderr, "Could not archive crash log %lu in %s: %s\n", (unsigned long) index, [path fileSystemRepresentation],
+                    [[error localizedDescription] UTF8String]);
+            ret = 1;
+        }
+
+        [pool release];
+    }
+
+    if (read < 0) {
+        fprintf(stderr, "Could not read crash log data from %s\n", [path fileSystemRepresentation]);
+        ret = 1;
+    }
+
+    return ret;
+}
+
+/*
+ * Pack reports into an archive.
+ */
+int pack_command (int argc, char *argv[]) {
+    const char *output = NULL;
+    int ret = 0;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "output",     required_argument,      NULL,          'o' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "o:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1 || output == NULL) {
+        fprintf(stderr, "An input and output file must be supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *outputPath = [fileManager stringWithFileSystemRepresentation: output length: strlen(output)];
+    NSError *error;
+
+    PLCrashReportArchiveWriter *writer = [[[PLCrashReportArchiveWriter alloc] initWithPath: outputPath error: &error] autorelease];
+    if (writer == nil) {
+        fprintf(stderr, "Could not create archive: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    for (int i = 0; i < argc; i++) {
+        NSString *path = [fileManager stringWithFileSystemRepresentation: argv[i] length: strlen(argv[i])];
+        BOOL isDirectory = NO;
+
+        /* Plain file */
+        if (![fileManager fileExistsAtPath: path isDirectory: &isDirectory] || !isDirectory) {
+            if (pack_file(writer, path) != 0)
+                ret = 1;
+            continue;
+        }
+
+        /* Directory; pack all .plcrash files, in a stable order */
+        NSArray *entries = [fileManager contentsOfDirectoryAtPath: path error: &error];
+        if (entries == nil) {
+            fprintf(stderr, "Could not read input directory: %s\n", [[error localizedDescription] UTF8String]);
+            ret = 1;
+            continue;
+        }
+
+        for (NSString *entry in [entries sortedArrayUsingSelector: @selector(compare:)]) {
+            if ([[entry pathExtension] caseInsensitiveCompare: @"plcrash"] != NSOrderedSame)
+                continue;
+
+            NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+            if (pack_file(writer, [path stringByAppendingPathComponent: entry]) != 0)
+                ret = 1;
+            [pool release];
+        }
+    }
+
+    if (![writer finishAndReturnError: &error]) {
+        fprintf(stderr, "Could not write archive: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    fprintf(stderr, "Archived %lu reports\n", (unsigned long) [writer count]);
+    return ret;
+}
+
+/*
+ * Unpack an archive's reports into individual .plcrash files.
+ */
+int unpack_command (int argc, char *argv[]) {
+    const char *output = NULL;
+
+    /* options descriptor */
+    static struct option longopts[] = {
+        { "output",     required_argument,      NULL,          'o' },
+        { NULL,         0,                      NULL,           0 }
+    };
+
+    /* Read the options */
+    char ch;
+    while ((ch = getopt_long(argc, argv, "o:", longopts, NULL)) != -1) {
+        switch (ch) {
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                print_usage();
+                return 1;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1 || output == NULL) {
+        fprintf(stderr, "An input archive and output directory must be supplied\n");
+        print_usage();
+        return 1;
+    }
+
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    NSString *archivePath = [fileManager stringWithFileSystemRepresentation: argv[0] length: strlen(argv[0])];
+    NSString *outputDirectory = [fileManager stringWithFileSystemRepresentation: output length: strlen(output)];
+    NSError *error;
+
+    PLCrashReportArchive *archive = [[[PLCrashReportArchive alloc] initWithContentsOfFile: archivePath error: &error] autorelease];
+    if (archive == nil) {
+        fprintf(stderr, "Could not read archive: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    if (![fileManager fileExistsAtPath: outputDirectory] &&
+        ![fileManager createDirectoryAtPath: outputDirectory withIntermediateDirectories: YES attributes: nil error: &error])
+    {
+        fprintf(stderr, "Could not create output directory: %s\n", [[error localizedDescription] UTF8String]);
+        return 1;
+    }
+
+    /* Reports are named by their archive index */
+    for (NSUInteger index = 0; index < [archive count]; index++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSString *name = [NSString stringWithFormat: @"%08lu.plcrash", (unsigned long) index];
+        NSString *path = [outputDirectory stringByAppendingPathComponent: name];
+
+        if (![[archive reportDataAtIndex: index] writeToFile: path options: NSDataWritingAtomic error: &error]) {
+            fprintf(stderr, "Could not write %s: %s\n", [path fileSystemRepresentation], [[error localizedDescription] UTF8String]);
+            [pool release];
+            return 1;
+        }
+
+        [pool release];
+    }
+
+    fprintf(stderr, "Unpacked %lu reports\n", (unsigned long) [archive count]);
     return 0;
 }
 
@@ -128,6 +3003,20 @@ int main (int argc, char *argv[]) {
     /* Convert command */
     if (strcmp(argv[1], "convert") == 0) {
         ret = convert_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "batch") == 0) {
+        ret = batch_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "profile") == 0) {
+        ret = profile_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "bucket") == 0) {
+        ret = bucket_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "trace") == 0) {
+        ret = trace_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "symbolicate") == 0) {
+        ret = symbolicate_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "pack") == 0) {
+        ret = pack_command(argc - 2, argv + 2);
+    } else if (strcmp(argv[1], "unpack") == 0) {
+        ret = unpack_command(argc - 2, argv + 2);
     } else {
         print_usage();
         ret = 1;
@@ -0,0 +1,65 @@
+#!/bin/sh
+#
+# Measure the time from fault to a completed on-disk crash report, using the Crash Demo's latency
+# measurement mode.
+#
+# Usage: crash-latency.sh <path to DemoCrash binary> [iterations]
+#
+# The CRASH_TYPES, HANDLER_TYPES, THREAD_COUNTS and IMAGE_COUNTS environment variables may be used to
+# override the measured configurations.
+
+if [ $# -lt 1 ]; then
+    echo "Usage: $0 <path to DemoCrash binary> [iterations]" >&2
+    exit 1
+fi
+
+DEMO="$1"
+ITERATIONS="${2:-10}"
+
+CRASH_TYPES="${CRASH_TYPES:-segv bus exception overflow}"
+HANDLER_TYPES="${HANDLER_TYPES:-bsd mach}"
+THREAD_COUNTS="${THREAD_COUNTS:-0 16 64}"
+IMAGE_COUNTS="${IMAGE_COUNTS:-0 100}"
+
+if [ ! -x "$DEMO" ]; then
+    echo "$DEMO is not executable" >&2
+    exit 1
+fi
+
+printf "%-10s %-5s %8s %8s %6s %12s %12s %12s\n" "crash" "handler" "threads" "images" "runs" "p50 (us)" "p90 (us)" "max (us)"
+
+for crash in $CRASH_TYPES; do
+    for handler in $HANDLER_TYPES; do
+        for threads in $THREAD_COUNTS; do
+            for images in $IMAGE_COUNTS; do
+                results=""
+                loaded=""
+                i=0
+                while [ $i -lt "$ITERATIONS" ]; do
+                    line=`"$DEMO" -crashType "$crash" -handlerType "$handler" -threads "$threads" -images "$images" 2>/dev/null | grep 'latency_ns='`
+                    latency=`echo "$line" | sed -n 's/.*latency_ns=\([0-9]*\).*/\1/p'`
+                    if [ -n "$latency" ]; then
+                        results="$results $latency"
+                        loaded=`echo "$line" | sed -n 's/.* images=\([0-9]*\).*/\1/p'`
+                    fi
+                    i=`expr $i + 1`
+                done
+
+                if [ -z "$results" ]; then
+                    printf "%-10s %-5s %8s %8s %6s %12s %12s %12s\n" "$crash" "$handler" "$threads" "$images" 0 "-" "-" "-"
+                    continue
+                fi
+
+                # Nearest-rank percentiles of the collected samples
+                echo $results | tr ' ' '\n' | sort -n | awk -v crash="$crash" -v handler="$handler" -v threads="$threads" -v images="$loaded" '
+                    { v[NR] = $1 }
+                    END {
+                        p50 = int((50 * NR + 99) / 100); if (p50 < 1) p50 = 1
+                        p90 = int((90 * NR + 99) / 100); if (p90 < 1) p90 = 1
+                        printf "%-10s %-5s %8s %8s %6d %12.1f %12.1f %12.1f\n", crash, handler, threads, images, NR,
+                            v[p50] / 1000.0, v[p90] / 1000.0, v[NR] / 1000.0
+                    }'
+            done
+        done
+    done
+done